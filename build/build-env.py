@@ -135,7 +135,7 @@ def getCFLAGS(mode, backend, warn, warnings_as_errors, hostspblas, CC):
 
   # generate hostspblas code
   if hostspblas == 'mkl':
-    result.append('-DINTEL_MKL_SPBLAS')
+    result.append('-DCUSP_USE_MKL')
 
   return result
 
@@ -168,7 +168,7 @@ def getCXXFLAGS(mode, backend, warn, warnings_as_errors, hostspblas, CXX):
 
   # generate hostspblas code
   if hostspblas == 'mkl':
-    result.append('-DINTEL_MKL_SPBLAS')
+    result.append('-DCUSP_USE_MKL')
 
   return result
 
@@ -233,11 +233,33 @@ def Environment():
   # add a variable to filter source files by a regex
   vars.Add('tests', help='Filter test files using a regex')
 
-  # add a variable to handle the device backend
+  # add a variable to delegate host sparse and dense BLAS routines to MKL
   hostspblas_variable = EnumVariable('hostspblas', 'Host sparse math library', 'cusp',
                                   allowed_values = ('cusp', 'mkl'))
   vars.Add(hostspblas_variable)
 
+  # add a variable to parallelize the host backend
+  vars.Add(BoolVariable('hostomp', 'Use OpenMP for host_memory algorithms', 0))
+
+  # add a variable to delegate host BLAS routines to a CBLAS library
+  vars.Add(BoolVariable('cblas', 'Use a CBLAS library for host BLAS routines', 0))
+
+  # add a variable to delegate dense products to cuBLAS
+  vars.Add(BoolVariable('cublas', 'Use cuBLAS for dense matrix products', 0))
+
+  # add a variable to delegate sparse products and solves to cuSPARSE
+  vars.Add(BoolVariable('cusparse', 'Use cuSPARSE for sparse matrix products and solves', 0))
+
+  # add a variable to emit NVTX ranges of the profiler scopes
+  vars.Add(BoolVariable('nvtx', 'Emit NVTX ranges of profiled scopes', 0))
+
+  # add a variable to distribute matrices and arrays across MPI processes
+  vars.Add(BoolVariable('mpi', 'Use MPI for distributed matrices and arrays', 0))
+
+  # add variables to read compressed files
+  vars.Add(BoolVariable('zlib', 'Use zlib to read gzip-compressed files', 0))
+  vars.Add(BoolVariable('zstd', 'Use libzstd to read zstd-compressed files', 0))
+
   # create an Environment
   env = OldEnvironment(tools = getTools(), variables = vars)
 
@@ -260,6 +282,11 @@ def Environment():
   # get CXX compiler switches
   env.Append(CXXFLAGS = getCXXFLAGS(env['mode'], env['backend'], env['Wall'], env['Werror'], env['hostspblas'], env.subst('$CXX')))
 
+  # generate omp code for the host backend
+  if env['hostomp'] and env['backend'] != 'omp':
+    env.Append(CFLAGS = [gCompilerOptions[env.subst('$CC')]['omp']])
+    env.Append(CXXFLAGS = [gCompilerOptions[env.subst('$CXX')]['omp']])
+
   # get NVCC compiler switches
   env.Append(NVCCFLAGS = getNVCCFLAGS(env['mode'], env['backend'], env['arch']))
 
@@ -282,7 +309,8 @@ def Environment():
       env.Append(LIBPATH = ['/usr/local/lib'])
     else:
       raise ValueError, "Unknown OS.  What is the Ocelot library path?"
-  elif env['backend'] == 'omp':
+
+  if env['backend'] == 'omp' or env['hostomp']:
     if os.name == 'posix':
       env.Append(LIBS = ['gomp'])
     elif os.name == 'nt':
@@ -300,6 +328,40 @@ def Environment():
     env.Append(LIBPATH = [mkl_lib_path])
     env.Append(LIBS = ['mkl_core', 'mkl_gnu_thread', intel_lib])
 
+  if env['cblas'] and env['hostspblas'] != 'mkl':
+    env.Append(CPPDEFINES = ['CUSP_USE_CBLAS'])
+    env.Append(LIBS = ['cblas'])
+
+  if env['cublas']:
+    env.Append(CPPDEFINES = ['CUSP_USE_CUBLAS'])
+    env.Append(LIBS = ['cublas'])
+
+  if env['cusparse']:
+    env.Append(CPPDEFINES = ['CUSP_USE_CUSPARSE'])
+    env.Append(LIBS = ['cusparse'])
+
+  if env['nvtx']:
+    env.Append(CPPDEFINES = ['CUSP_PROFILE_NVTX'])
+    env.Append(LIBS = ['nvToolsExt'])
+
+  if env['mpi']:
+    env.Append(CPPDEFINES = ['CUSP_USE_MPI'])
+    env.Append(LIBS = ['mpi'])
+    if 'MPI_PATH' in os.environ:
+      env.Append(CPPPATH = [os.path.join(os.environ['MPI_PATH'], 'include')])
+      env.Append(LIBPATH = [os.path.join(os.environ['MPI_PATH'], 'lib')])
+
+  if env['zlib']:
+    env.Append(CPPDEFINES = ['CUSP_USE_ZLIB'])
+    env.Append(LIBS = ['z'])
+
+  if env['zstd']:
+    env.Append(CPPDEFINES = ['CUSP_USE_ZSTD'])
+    env.Append(LIBS = ['zstd'])
+
+  if (env['zlib'] or env['zstd']) and os.name == 'posix':
+    env.Append(LIBS = ['pthread'])
+
   # set thrust include path
   # this needs to come before the CUDA include path appended above,
   # which may include a different version of thrust
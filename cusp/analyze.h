@@ -0,0 +1,162 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file analyze.h
+ *  \brief Structural and numerical statistics of a sparse matrix
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p matrix_analysis : outcome of \p analyze.
+ *
+ *  The statistics that guide the choice of a storage format (row
+ *  lengths, occupied diagonals, bandwidth) and of a solver (symmetry,
+ *  diagonal dominance) in a single structure.
+ */
+struct matrix_analysis
+{
+    size_t num_rows;
+    size_t num_cols;
+    size_t num_entries;
+
+    /*! number of rows with \c k entries at index \c k, for \c k from 0
+     *  to \p max_row_length
+     */
+    std::vector<size_t> row_length_histogram;
+
+    size_t min_row_length;
+    size_t max_row_length;
+    double mean_row_length;
+
+    /*! largest \c i-j and \c j-i over the entries \c A(i,j)
+     */
+    size_t lower_bandwidth;
+    size_t upper_bandwidth;
+
+    /*! sum over the rows of the distance from the first entry of the row
+     *  to the diagonal, the storage of the lower envelope
+     */
+    size_t profile;
+
+    /*! number of occupied diagonals, the width of the DIA format
+     */
+    size_t num_diagonals;
+
+    /*! whether \c A(j,i) is stored for every stored \c A(i,j) and, in
+     *  addition, whether the two are equal
+     */
+    bool structurally_symmetric;
+    bool numerically_symmetric;
+
+    /*! number of rows with <tt>|A(i,i)| >= sum_{j != i} |A(i,j)|</tt>,
+     *  empty rows excluded
+     */
+    size_t num_dominant_rows;
+
+    /*! range of the absolute values of the entries
+     */
+    double min_abs_value;
+    double max_abs_value;
+
+    matrix_analysis(void)
+        : num_rows(0), num_cols(0), num_entries(0),
+          min_row_length(0), max_row_length(0), mean_row_length(0),
+          lower_bandwidth(0), upper_bandwidth(0), profile(0), num_diagonals(0),
+          structurally_symmetric(false), numerically_symmetric(false),
+          num_dominant_rows(0), min_abs_value(0), max_abs_value(0) {}
+
+    /*! number of entries that fit in an ELL matrix of the given width
+     */
+    size_t ell_entries(const size_t width) const
+    {
+        size_t entries = 0;
+
+        for (size_t k = 0; k < row_length_histogram.size(); k++)
+            entries += row_length_histogram[k] * (k < width ? k : width);
+
+        return entries;
+    }
+
+    /*! number of padding entries of an ELL matrix of the given width,
+     *  the entries of longer rows excluded
+     */
+    size_t ell_padding(const size_t width) const
+    {
+        return width * num_rows - ell_entries(width);
+    }
+
+    /*! width of the ELL part of a HYB matrix, as chosen by the conversion
+     *  to HYB with the same parameters
+     */
+    size_t hyb_entries_per_row(const float relative_speed = 3.0f, const size_t breakeven_threshold = 4096) const
+    {
+        for (size_t k = 0, rows = num_rows; k < max_row_length; k++)
+        {
+            rows -= row_length_histogram[k];  // number of rows longer than k
+
+            if (relative_speed * rows < num_rows || rows < breakeven_threshold)
+                return k;
+        }
+
+        return max_row_length;
+    }
+};
+
+/*! \p analyze : compute the statistics of a matrix.
+ *
+ *  The statistics are computed by sorts and reductions in the memory
+ *  space of the matrix, which is converted to CSR first unless it is a
+ *  CSR matrix, and only the results are copied to the host.  The
+ *  symmetry test sorts a copy of the entries and of their transpose, the
+ *  other statistics take a few passes over the entries.
+ *
+ * \param A matrix
+ * \return the statistics of \p A
+ * \tparam Matrix matrix type
+ *
+ *  \code
+ *  #include <cusp/analyze.h>
+ *  ...
+ *  cusp::matrix_analysis analysis = cusp::analyze(A);
+ *
+ *  if (analysis.numerically_symmetric && analysis.num_dominant_rows == A.num_rows)
+ *      cusp::krylov::cg(A, x, b);      // symmetric positive definite
+ *  else
+ *      cusp::krylov::bicgstab(A, x, b);
+ *  \endcode
+ */
+template <typename Matrix>
+matrix_analysis analyze(const Matrix& A);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/analyze.inl>
@@ -0,0 +1,193 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file any_matrix.h
+ *  \brief Sparse matrix whose format is chosen at runtime.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/auto_format_matrix.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/linear_operator.h>
+
+namespace cusp
+{
+namespace detail
+{
+  template <typename ValueType, typename MemorySpace, typename IndexType> class any_matrix_base;
+} // end namespace detail
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p any_matrix : sparse matrix container whose format is chosen at
+ *  runtime
+ *
+ *  An \p any_matrix holds a COO, CSR, DIA, ELL or HYB matrix behind a
+ *  single type.  \p cusp::multiply reaches the stored matrix through one
+ *  virtual call, so an algorithm applied to an \p any_matrix, e.g. a
+ *  Krylov solver, is compiled once for every format.  The multiplication
+ *  of each format is instantiated when a matrix of that format is first
+ *  stored in an \p any_matrix.
+ *
+ *  Matrices of the five formats are stored as they are, other matrices
+ *  are converted to CSR.  \p convert_to changes the format in place and
+ *  \p select_format moves the matrix to the format that \p cusp::select_format
+ *  predicts to be the fastest.
+ *
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ *
+ *  \code
+ *  #include <cusp/any_matrix.h>
+ *  #include <cusp/krylov/cg.h>
+ *  ...
+ *  cusp::any_matrix<float, cusp::device_memory> A;
+ *
+ *  if (use_dia)
+ *      A = cusp::dia_matrix<int, float, cusp::device_memory>(...);
+ *  else
+ *      A = cusp::coo_matrix<int, float, cusp::device_memory>(...);
+ *
+ *  // store A in the fastest format
+ *  A.select_format();
+ *
+ *  cusp::krylov::cg(A, x, b);
+ *  \endcode
+ */
+template <typename ValueType, typename MemorySpace, typename IndexType=int>
+class any_matrix : public cusp::linear_operator<ValueType,MemorySpace,IndexType>
+{
+  typedef cusp::linear_operator<ValueType,MemorySpace,IndexType> Parent;
+  typedef cusp::detail::any_matrix_base<ValueType,MemorySpace,IndexType> base_type;
+  public:
+    /*! formats an \p any_matrix stores
+     */
+    enum format_type { coo, csr, dia, ell, hyb };
+
+    /*! rebind matrix to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::any_matrix<ValueType, MemorySpace2, IndexType> type; };
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::any_matrix<ValueType, MemorySpace, IndexType> container;
+
+    typedef typename cusp::coo_matrix<IndexType, ValueType, MemorySpace> coo_matrix_type;
+    typedef typename cusp::csr_matrix<IndexType, ValueType, MemorySpace> csr_matrix_type;
+    typedef typename cusp::dia_matrix<IndexType, ValueType, MemorySpace> dia_matrix_type;
+    typedef typename cusp::ell_matrix<IndexType, ValueType, MemorySpace> ell_matrix_type;
+    typedef typename cusp::hyb_matrix<IndexType, ValueType, MemorySpace> hyb_matrix_type;
+
+    /*! vectors passed to the stored matrix
+     */
+    typedef typename cusp::array1d<ValueType, MemorySpace>::view       view_type;
+    typedef typename cusp::array1d<ValueType, MemorySpace>::const_view const_view_type;
+
+    /*! Construct an empty \p any_matrix, which holds an empty CSR matrix.
+     */
+    any_matrix(void);
+
+    /*! Construct an \p any_matrix from another matrix.
+     *  \param matrix Another sparse or dense matrix in MemorySpace or
+     *  another memory space.
+     */
+    template <typename MatrixType>
+    any_matrix(const MatrixType& matrix);
+
+    /*! Construct a copy of an \p any_matrix in the same format.
+     *  \param matrix Another \p any_matrix.
+     */
+    any_matrix(const any_matrix& matrix);
+
+    ~any_matrix(void);
+
+    /*! Assignment from another \p any_matrix.
+     *  \param matrix Another \p any_matrix.
+     */
+    any_matrix& operator=(const any_matrix& matrix);
+
+    /*! Assignment from another matrix.
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    any_matrix& operator=(const MatrixType& matrix);
+
+    /*! Swap the contents of two \p any_matrix objects.
+     *  \param matrix Another \p any_matrix with the same template arguments.
+     */
+    void swap(any_matrix& matrix);
+
+    /*! Format of the stored matrix.
+     */
+    format_type stored_format(void) const;
+
+    /*! Convert the stored matrix to another format.  The matrix is left
+     *  unchanged when the conversion throws, e.g. when a matrix has too
+     *  many diagonals for the DIA format.
+     *  \param format The new format.
+     */
+    void convert_to(format_type format);
+
+    /*! Convert the stored matrix to the format that \p cusp::select_format
+     *  selects for it.
+     *  \param options Selection parameters.
+     *  \return the selection
+     */
+    format_selection select_format(const format_selection_options& options = format_selection_options());
+
+    /*! The stored matrix.
+     *  \tparam MatrixType One of \p coo_matrix_type, \p csr_matrix_type,
+     *  \p dia_matrix_type, \p ell_matrix_type or \p hyb_matrix_type.
+     *  \throws cusp::invalid_input_exception when the stored matrix is not a \p MatrixType
+     */
+    template <typename MatrixType>
+    const MatrixType& get(void) const;
+
+    /*! Compute y = A * x with the stored matrix.
+     *  \param x Input vector of ValueType in MemorySpace.
+     *  \param y Output vector of ValueType in MemorySpace.
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+
+  private:
+    base_type * matrix;
+
+    void reset(base_type * new_matrix);
+}; // class any_matrix
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/any_matrix.inl>
@@ -26,6 +26,8 @@
 #include <cusp/format.h>
 #include <cusp/exception.h>
 
+#include <cusp/detail/strided_iterator.h>
+
 #include <thrust/host_vector.h>
 #include <thrust/device_vector.h>
 #include <thrust/detail/vector_base.h>
@@ -58,7 +60,7 @@ class array1d : public thrust::detail::vector_base<T, typename cusp::default_mem
         typedef typename thrust::detail::vector_base<T,Alloc> Parent;
 
     public:
-        typedef MemorySpace memory_space;
+        typedef typename cusp::detail::memory_space_of<MemorySpace>::type memory_space;
         typedef cusp::array1d_format format;
 
         template<typename MemorySpace2>
@@ -264,6 +266,40 @@ typename array1d<T,MemorySpace>::const_view make_array1d_view(const array1d<T,Me
 {
   return make_array1d_view(a.begin(), a.end());
 }
+
+/*! \p strided_array1d_view : type of a view of every stride-th element
+ *  of a range, e.g. a column of a row-major \p array2d or an offset and
+ *  strided vector of an external buffer.
+ *
+ * \tparam Iterator iterator of the underlying range
+ */
+template <typename Iterator>
+struct strided_array1d_view
+{
+  typedef array1d_view<typename cusp::detail::strided_iterator<Iterator>::type> type;
+};
+
+/*! \p make_strided_array1d_view : view of the elements
+ *  <tt>first[0], first[stride], ..., first[(size - 1) * stride]</tt>
+ *
+ *  The view references the underlying storage, which is neither copied
+ *  nor owned.  Device kernels that take contiguous vectors stage strided
+ *  views through a contiguous temporary (see \p cusp::scoped_no_copy).
+ *
+ * \param first beginning of the underlying range
+ * \param size number of elements of the view
+ * \param stride distance between consecutive elements of the view
+ */
+template <typename Iterator>
+typename strided_array1d_view<Iterator>::type
+make_strided_array1d_view(Iterator first, size_t size, size_t stride)
+{
+  typedef cusp::detail::strided_iterator<Iterator> Strided;
+
+  typename Strided::type begin = Strided::make(first, typename Strided::difference_type(stride));
+
+  return typename strided_array1d_view<Iterator>::type(begin, begin + size);
+}
 /*! \}
  */
   
@@ -157,6 +157,16 @@ namespace detail
     {}
   };
   
+  // rows of a column-major array are strided
+  template <typename Iterator>
+  struct row_view<Iterator,cusp::column_major> : public cusp::strided_array1d_view<Iterator>::type
+  {
+    template <typename Array>
+    row_view(Array& A, size_t n)
+      : cusp::strided_array1d_view<Iterator>::type(cusp::make_strided_array1d_view(A.values.begin() + n, A.num_cols, A.pitch))
+    {}
+  };
+
   template <typename Iterator, class Orientation>
   struct column_view {};
 
@@ -169,6 +179,16 @@ namespace detail
                                      A.values.begin() + A.pitch * n + A.num_rows)
     {}
   };
+
+  // columns of a row-major array are strided
+  template <typename Iterator>
+  struct column_view<Iterator,cusp::row_major> : public cusp::strided_array1d_view<Iterator>::type
+  {
+    template <typename Array>
+    column_view(Array& A, size_t n)
+      : cusp::strided_array1d_view<Iterator>::type(cusp::make_strided_array1d_view(A.values.begin() + n, A.num_rows, A.pitch))
+    {}
+  };
 } // end namespace detail
 
 // TODO document mapping of (i,j) onto values[pitch * i + j] or values[pitch * j + i]
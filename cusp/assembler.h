@@ -0,0 +1,170 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file assembler.h
+ *  \brief Assembly of finite element matrices with a fixed pattern
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ *  \{
+ */
+
+/*! \p assembler : repeated assembly of a sparse matrix from element
+ *  matrices on a fixed mesh.
+ *
+ *  The mesh is given by its connectivity: element \c e couples the
+ *  \p nodes_per_element nodes <tt>connectivity[e * nodes_per_element + a]</tt>,
+ *  and its element matrix \c K_e is stored row-major at offset
+ *  <tt>e * nodes_per_element^2</tt> of an array of element values, so that
+ *  <tt>K_e(a,b)</tt> is added to <tt>A(node_a, node_b)</tt>.
+ *
+ *  \p setup sorts the (row, column) pairs of all element entries once to
+ *  build the CSR pattern of A and the map from each element entry to its
+ *  position in \p csr_matrix::values.  Every \p assemble then zeroes the
+ *  values and scatter-adds the element matrices into them, without
+ *  sorting or reducing duplicates, with atomic additions on the device.
+ *  The order of the additions is not fixed, so the assembled values may
+ *  differ in rounding between calls.
+ *
+ *  \tparam IndexType Type used for matrix indices (e.g. \c int).
+ *  \tparam ValueType Type used for matrix values (e.g. \c float).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or \c cusp::device_memory)
+ *
+ *  \code
+ *  #include <cusp/assembler.h>
+ *
+ *  int main(void)
+ *  {
+ *      // 1d mesh of 4 linear elements on 5 nodes
+ *      cusp::array1d<int, cusp::device_memory> connectivity(8);
+ *      for (int e = 0; e < 4; e++)
+ *      {
+ *          connectivity[2 * e + 0] = e;
+ *          connectivity[2 * e + 1] = e + 1;
+ *      }
+ *
+ *      // build the pattern and the entry map once
+ *      cusp::assembler<int, float, cusp::device_memory> assembler(5, 2, connectivity);
+ *
+ *      // element stiffness matrices [1 -1; -1 1]
+ *      cusp::array1d<float, cusp::device_memory> K(16);
+ *      for (int e = 0; e < 4; e++)
+ *      {
+ *          K[4 * e + 0] =  1; K[4 * e + 1] = -1;
+ *          K[4 * e + 2] = -1; K[4 * e + 3] =  1;
+ *      }
+ *
+ *      // assemble, e.g. after each update of K
+ *      cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *      assembler.assemble(K, A);
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class assembler
+{
+    public:
+
+    typedef cusp::csr_matrix<IndexType,ValueType,MemorySpace> matrix_type;
+
+    /*! number of rows and columns of the assembled matrix
+     */
+    size_t num_nodes;
+
+    /*! number of nodes of each element
+     */
+    size_t nodes_per_element;
+
+    /*! number of elements of the mesh
+     */
+    size_t num_elements;
+
+    /*! row offsets of the pattern of the assembled matrix
+     */
+    cusp::array1d<IndexType,MemorySpace> row_offsets;
+
+    /*! column indices of the pattern of the assembled matrix
+     */
+    cusp::array1d<IndexType,MemorySpace> column_indices;
+
+    /*! position in the assembled values of each element matrix entry
+     */
+    cusp::array1d<IndexType,MemorySpace> slots;
+
+    /*! construct an empty \p assembler
+     */
+    assembler(void) : num_nodes(0), nodes_per_element(0), num_elements(0) {}
+
+    /*! construct an \p assembler for a mesh
+     *
+     *  \param num_nodes number of nodes, i.e. rows of the matrix
+     *  \param nodes_per_element number of nodes of each element
+     *  \param connectivity nodes of each element, element after element
+     */
+    template <typename Array>
+    assembler(const size_t num_nodes, const size_t nodes_per_element, const Array& connectivity);
+
+    /*! compute the pattern and the entry map of a mesh
+     *
+     *  \throws cusp::invalid_input_exception when the connectivity size
+     *  is not a multiple of \p nodes_per_element or a node is out of range
+     */
+    template <typename Array>
+    void setup(const size_t num_nodes, const size_t nodes_per_element, const Array& connectivity);
+
+    /*! number of entries of the assembled matrix
+     */
+    size_t num_entries(void) const { return column_indices.size(); }
+
+    /*! resize \p A to the assembled pattern, with zero values
+     */
+    template <typename MatrixType>
+    void initialize(MatrixType& A) const;
+
+    /*! A <- sum of the element matrices in \p element_values
+     *
+     *  \p A is initialized with the pattern unless its dimensions and
+     *  number of entries already match it, in which case its pattern is
+     *  assumed to be the one of a previous \p assemble or \p initialize.
+     *  \p element_values and \p A reside in \p MemorySpace.
+     *
+     *  \throws cusp::invalid_input_exception when \p element_values does
+     *  not hold <tt>num_elements * nodes_per_element^2</tt> values
+     */
+    template <typename Array, typename MatrixType>
+    void assemble(const Array& element_values, MatrixType& A) const;
+};
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/assembler.inl>
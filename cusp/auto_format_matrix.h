@@ -0,0 +1,275 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file auto_format_matrix.h
+ *  \brief Sparse matrix stored in the format selected for fast SpMV.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/format.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/detail/matrix_base.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p format_selection_options : parameters of \p select_format
+ *
+ *  The defaults match the parameters used by \p cusp::convert for the
+ *  DIA, ELL and HYB formats.
+ */
+struct format_selection_options
+{
+    /*! DIA and ELL are rejected when their storage, padding included,
+     *  exceeds this multiple of the number of entries and one million
+     */
+    float max_fill;
+
+    /*! speed of ELL relative to COO used to split a HYB matrix
+     */
+    float relative_speed;
+
+    /*! minimum number of rows of the ELL part of a HYB matrix
+     */
+    size_t breakeven_threshold;
+
+    /*! time SpMV in every admissible format instead of relying on the
+     *  estimated memory traffic alone
+     */
+    bool benchmark;
+
+    /*! number of SpMV timed per format when \p benchmark is set
+     */
+    size_t benchmark_iterations;
+
+    format_selection_options(void)
+        : max_fill(3.0), relative_speed(3.0), breakeven_threshold(4096),
+          benchmark(false), benchmark_iterations(10) {}
+};
+
+/*! \p format_selection : outcome of \p select_format
+ *
+ *  SpMV is bound by memory bandwidth, so each format is ranked by the
+ *  number of bytes a SpMV reads and writes, as in the \p performance/spmv
+ *  benchmark.  The estimate only requires the row lengths and the number
+ *  of occupied diagonals of the matrix.
+ */
+struct format_selection
+{
+    enum format_type { csr, dia, ell, hyb, num_formats };
+
+    /*! the selected format
+     */
+    format_type format;
+
+    /*! number of occupied diagonals
+     */
+    size_t num_diagonals;
+
+    /*! length of the longest row
+     */
+    size_t max_entries_per_row;
+
+    /*! width of the ELL part of the HYB format
+     */
+    size_t hyb_entries_per_row;
+
+    /*! whether each format satisfies \p format_selection_options::max_fill
+     */
+    bool admissible[num_formats];
+
+    /*! estimated bytes of memory traffic of a SpMV in each format
+     */
+    double bytes[num_formats];
+
+    /*! measured time of a SpMV in each admissible format, in milliseconds,
+     *  or zero when the selection was not benchmarked
+     */
+    double milliseconds[num_formats];
+
+    format_selection(void)
+        : format(csr), num_diagonals(0), max_entries_per_row(0), hyb_entries_per_row(0)
+    {
+        for(int i = 0; i < num_formats; i++)
+        {
+            admissible[i]   = false;
+            bytes[i]        = 0;
+            milliseconds[i] = 0;
+        }
+    }
+};
+
+/*! Choose the fastest SpMV format among CSR, DIA, ELL and HYB for a matrix.
+ *
+ *  \param A sparse or dense matrix
+ *  \param options selection parameters
+ *  \return the selected format and the statistics it was based on
+ *
+ *  \code
+ *  cusp::format_selection selection = cusp::select_format(A);
+ *
+ *  if (selection.format == cusp::format_selection::dia)
+ *      ...
+ *  \endcode
+ */
+template <typename Matrix>
+format_selection select_format(const Matrix& A,
+                               const format_selection_options& options = format_selection_options());
+
+/*! \p auto_format_matrix : matrix container that stores its entries in
+ *  the format chosen by \p select_format
+ *
+ *  Only the member of the selected format (\p csr, \p dia, \p ell or
+ *  \p hyb) holds the matrix; the others are empty.  \p cusp::multiply
+ *  dispatches to the selected member, so an \p auto_format_matrix can be
+ *  used wherever a matrix is multiplied, e.g. in the Krylov solvers.
+ *  Conversions out of an \p auto_format_matrix convert the selected
+ *  member.
+ *
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ *  \code
+ *  #include <cusp/auto_format_matrix.h>
+ *  #include <cusp/krylov/cg.h>
+ *  ...
+ *
+ *  cusp::coo_matrix<int,float,cusp::host_memory> A = ...;
+ *
+ *  cusp::format_selection_options options;
+ *  options.benchmark = true;
+ *
+ *  cusp::auto_format_matrix<int,float,cusp::device_memory> B(A, options);
+ *
+ *  cusp::krylov::cg(B, x, b);
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class auto_format_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::auto_format>
+{
+  typedef cusp::detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::auto_format> Parent;
+  public:
+    /*! rebind matrix to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::auto_format_matrix<IndexType, ValueType, MemorySpace2> type; };
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::auto_format_matrix<IndexType, ValueType, MemorySpace> container;
+
+    typedef cusp::format_selection selection_type;
+
+    typedef typename cusp::csr_matrix<IndexType, ValueType, MemorySpace> csr_matrix_type;
+    typedef typename cusp::dia_matrix<IndexType, ValueType, MemorySpace> dia_matrix_type;
+    typedef typename cusp::ell_matrix<IndexType, ValueType, MemorySpace> ell_matrix_type;
+    typedef typename cusp::hyb_matrix<IndexType, ValueType, MemorySpace> hyb_matrix_type;
+
+    /*! parameters used when a matrix is assigned
+     */
+    format_selection_options options;
+
+    /*! format of the stored matrix
+     */
+    selection_type selection;
+
+    csr_matrix_type csr;
+    dia_matrix_type dia;
+    ell_matrix_type ell;
+    hyb_matrix_type hyb;
+
+    /*! Construct an empty \p auto_format_matrix.
+     */
+    auto_format_matrix() {}
+
+    /*! Construct an \p auto_format_matrix from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    auto_format_matrix(const MatrixType& matrix);
+
+    /*! Construct an \p auto_format_matrix from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     *  \param options Selection parameters.
+     */
+    template <typename MatrixType>
+    auto_format_matrix(const MatrixType& matrix, const format_selection_options& options);
+
+    /*! Select a format for \p matrix with the current \p options and
+     *  store \p matrix in it.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    void select(const MatrixType& matrix);
+
+    /*! Store \p matrix in the format of \p selection without selecting
+     *  a format, e.g. with the selection that \p select_format or
+     *  \p cusp::benchmark::spmv_profile made for a matrix of the same
+     *  structure.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     *  \param selection A selection made for the structure of \p matrix.
+     */
+    template <typename MatrixType>
+    void select(const MatrixType& matrix, const selection_type& selection);
+
+    /*! Swap the contents of two \p auto_format_matrix objects.
+     *
+     *  \param matrix Another \p auto_format_matrix with the same IndexType and ValueType.
+     */
+    void swap(auto_format_matrix& matrix)
+    {
+      Parent::swap(matrix);
+      thrust::swap(options,   matrix.options);
+      thrust::swap(selection, matrix.selection);
+      csr.swap(matrix.csr);
+      dia.swap(matrix.dia);
+      ell.swap(matrix.ell);
+      hyb.swap(matrix.hyb);
+    }
+
+    /*! Assignment from another matrix.  An \p auto_format_matrix is
+     *  copied in its format, other matrices go through \p select.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    auto_format_matrix& operator=(const MatrixType& matrix);
+}; // class auto_format_matrix
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/auto_format_matrix.inl>
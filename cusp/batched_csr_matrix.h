@@ -0,0 +1,224 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file batched_csr_matrix.h
+ *  \brief Batch of CSR matrices sharing a sparsity pattern
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/format.h>
+#include <cusp/detail/matrix_base.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p batched_csr_matrix : batch of CSR matrices with a common pattern
+ *
+ * The \p num_batches items share the row offsets and column indices of
+ * a single CSR pattern, which is stored once, and differ only in their
+ * values.  The values are interleaved: \p values is a
+ * <tt>batch_num_entries() x num_batches</tt> row-major array, so that
+ * row \c k holds entry \c k of every item.  An SpMV loads each index
+ * once for all items, and consecutive threads read the values of
+ * consecutive items.
+ *
+ * The matrix is the block-diagonal operator of its items, i.e.
+ * \p num_rows, \p num_cols and \p num_entries are \p num_batches times
+ * those of an item, and the operand and result of item \c b are the
+ * ranges [b * batch_num_cols(), (b + 1) * batch_num_cols()) and
+ * [b * batch_num_rows(), (b + 1) * batch_num_rows()) of the vectors of
+ * \p cusp::multiply.  Hence it may be passed to \p batched_cg with
+ * uniform system offsets.
+ *
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ * \note The column indices within each row of the pattern must be sorted.
+ * \note A \p batched_csr_matrix may be copied to another memory space,
+ *  but not converted to or from other formats.
+ *
+ *  The following code snippet demonstrates how to build a batch of 1000
+ *  matrices with the pattern of a Poisson problem.
+ *
+ *  \code
+ *  #include <cusp/batched_csr_matrix.h>
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/multiply.h>
+ *  #include <cusp/gallery/poisson.h>
+ *
+ *  int main(void)
+ *  {
+ *      cusp::csr_matrix<int, float, cusp::host_memory> P;
+ *      cusp::gallery::poisson5pt(P, 4, 4);
+ *
+ *      // every item starts out with the values of P
+ *      cusp::batched_csr_matrix<int, float, cusp::host_memory> B(P, 1000);
+ *
+ *      // scale the first entry of item 7
+ *      B.values(0, 7) *= 2;
+ *
+ *      cusp::batched_csr_matrix<int, float, cusp::device_memory> A(B);
+ *
+ *      cusp::array1d<float, cusp::device_memory> x(A.num_cols, 1);
+ *      cusp::array1d<float, cusp::device_memory> y(A.num_rows);
+ *
+ *      cusp::multiply(A, x, y);
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class batched_csr_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::batched_csr_format>
+{
+  typedef cusp::detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::batched_csr_format> Parent;
+  public:
+    /*! rebind matrix to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::batched_csr_matrix<IndexType, ValueType, MemorySpace2> type; };
+
+    /*! type of row offsets indices array
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> row_offsets_array_type;
+
+    /*! type of column indices array
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> column_indices_array_type;
+
+    /*! type of values array
+     */
+    typedef typename cusp::array2d<ValueType, MemorySpace, cusp::row_major> values_array_type;
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::batched_csr_matrix<IndexType, ValueType, MemorySpace> container;
+
+    /*! Number of items.
+     */
+    size_t num_batches;
+
+    /*! Storage for the row offsets of the common pattern.
+     */
+    row_offsets_array_type row_offsets;
+
+    /*! Storage for the column indices of the common pattern.
+     */
+    column_indices_array_type column_indices;
+
+    /*! Storage for the values of the items, value \c k of item \c b is
+     *  <tt>values(k, b)</tt>.
+     */
+    values_array_type values;
+
+    /*! Construct an empty \p batched_csr_matrix.
+     */
+    batched_csr_matrix() : num_batches(0) {}
+
+    /*! Construct a \p batched_csr_matrix with a specific pattern shape and
+     *  number of items.
+     *
+     *  \param num_rows Number of rows of each item.
+     *  \param num_cols Number of columns of each item.
+     *  \param num_entries Number of nonzero entries of each item.
+     *  \param num_batches Number of items.
+     */
+    batched_csr_matrix(size_t num_rows, size_t num_cols, size_t num_entries, size_t num_batches)
+      : Parent(num_batches * num_rows, num_batches * num_cols, num_batches * num_entries),
+        num_batches(num_batches),
+        row_offsets(num_rows + 1),
+        column_indices(num_entries),
+        values(num_entries, num_batches) {}
+
+    /*! Construct a copy of another \p batched_csr_matrix.
+     *
+     *  \param matrix A \p batched_csr_matrix in any memory space.
+     */
+    template <typename MatrixType>
+    batched_csr_matrix(const MatrixType& matrix);
+
+    /*! Construct a \p batched_csr_matrix with the pattern of a CSR matrix,
+     *  each of whose items holds the values of the CSR matrix.
+     *
+     *  \param pattern A \p csr_matrix in any memory space.
+     *  \param num_batches Number of items.
+     */
+    template <typename MatrixType>
+    batched_csr_matrix(const MatrixType& pattern, size_t num_batches);
+
+    /*! Number of rows of each item.
+     */
+    size_t batch_num_rows(void) const { return row_offsets.size() - 1; }
+
+    /*! Number of columns of each item.
+     */
+    size_t batch_num_cols(void) const { return num_batches == 0 ? 0 : Parent::num_cols / num_batches; }
+
+    /*! Number of nonzero entries of each item.
+     */
+    size_t batch_num_entries(void) const { return column_indices.size(); }
+
+    /*! Resize the pattern, the number of items and the underlying storage
+     */
+    void resize(size_t num_rows, size_t num_cols, size_t num_entries, size_t num_batches)
+    {
+      Parent::resize(num_batches * num_rows, num_batches * num_cols, num_batches * num_entries);
+      this->num_batches = num_batches;
+      row_offsets.resize(num_rows + 1);
+      column_indices.resize(num_entries);
+      values.resize(num_entries, num_batches);
+    }
+
+    /*! Swap the contents of two \p batched_csr_matrix objects.
+     *
+     *  \param matrix Another \p batched_csr_matrix with the same IndexType and ValueType.
+     */
+    void swap(batched_csr_matrix& matrix)
+    {
+      Parent::swap(matrix);
+      thrust::swap(num_batches, matrix.num_batches);
+      row_offsets.swap(matrix.row_offsets);
+      column_indices.swap(matrix.column_indices);
+      values.swap(matrix.values);
+    }
+
+    /*! Assignment from another \p batched_csr_matrix.
+     *
+     *  \param matrix A \p batched_csr_matrix in any memory space.
+     */
+    template <typename MatrixType>
+    batched_csr_matrix& operator=(const MatrixType& matrix);
+}; // class batched_csr_matrix
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/batched_csr_matrix.inl>
@@ -0,0 +1,159 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file batched_multiply.h
+ *  \brief Products of many small sparse matrices in a single launch
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+namespace cusp
+{
+
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p batched_multiply : products y_b = A_b x_b of a batch of small,
+ *  distinct sparse matrices.
+ *
+ *  The matrices are stored one after the other in the CSR matrix \p A:
+ *  the rows of item b are the half-open range
+ *  [batch_offsets[b], batch_offsets[b+1]) of \p A, and its column
+ *  indices are local to the item, i.e. in [0, n_b) where
+ *  n_b = batch_offsets[b+1] - batch_offsets[b].  The operand x_b and
+ *  the result y_b of item b are the same ranges of \p x and \p y.
+ *
+ *  All items are multiplied by a single kernel launch, which assigns a
+ *  group of threads of a warp to each item.  Looping over separate
+ *  matrices with \p cusp::multiply costs a launch per matrix instead.
+ *
+ *  \param A CSR matrix holding the items
+ *  \param batch_offsets array of size num_items + 1 delimiting the items
+ *  \param x operands of the items
+ *  \param y results of the items (output)
+ *
+ *  \tparam Matrix \p csr_matrix or \p csr_matrix_view
+ *  \tparam IndexArray array of integers
+ *  \tparam Array1 array1d
+ *  \tparam Array2 array1d
+ *
+ *  \throws cusp::invalid_input_exception if the sizes do not match
+ *
+ *  The following code snippet demonstrates how to use \p batched_multiply
+ *  to multiply a 2x2 and a 1x1 matrix.
+ *
+ *  \code
+ *  #include <cusp/array2d.h>
+ *  #include <cusp/batched_multiply.h>
+ *  #include <cusp/csr_matrix.h>
+ *
+ *  int main(void)
+ *  {
+ *      // the items [1 2; 0 3] and [4] with local column indices
+ *      cusp::array2d<float, cusp::host_memory> M(3,2,0);
+ *      M(0,0) = 1; M(0,1) = 2; M(1,1) = 3;
+ *      M(2,0) = 4;
+ *
+ *      cusp::csr_matrix<int, float, cusp::device_memory> A(M);
+ *
+ *      cusp::array1d<int, cusp::device_memory> offsets(3);
+ *      offsets[0] = 0; offsets[1] = 2; offsets[2] = 3;
+ *
+ *      cusp::array1d<float, cusp::device_memory> x(3, 1);
+ *      cusp::array1d<float, cusp::device_memory> y(3);
+ *
+ *      // y = [3 3 4]
+ *      cusp::batched_multiply(A, offsets, x, y);
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ */
+template <typename Matrix,
+          typename IndexArray,
+          typename Array1,
+          typename Array2>
+void batched_multiply(const Matrix&     A,
+                      const IndexArray& batch_offsets,
+                      const Array1&     x,
+                            Array2&     y);
+
+/*! \p batched_multiply : products y_b = A_b x_b of a batch of small,
+ *  distinct, rectangular sparse matrices.
+ *
+ *  As above, except that the columns of item b, and its operand x_b,
+ *  are the range [column_offsets[b], column_offsets[b+1]), while its rows
+ *  and result y_b are the range [row_offsets[b], row_offsets[b+1]).
+ *
+ *  \param A CSR matrix holding the items
+ *  \param row_offsets array of size num_items + 1 delimiting the rows of the items
+ *  \param column_offsets array of size num_items + 1 delimiting the columns of the items
+ *  \param x operands of the items
+ *  \param y results of the items (output)
+ */
+template <typename Matrix,
+          typename IndexArray1,
+          typename IndexArray2,
+          typename Array1,
+          typename Array2>
+void batched_multiply(const Matrix&      A,
+                      const IndexArray1& row_offsets,
+                      const IndexArray2& column_offsets,
+                      const Array1&      x,
+                            Array2&      y);
+
+/*! \p batched_multiply_uniform : products y_b = A_b x_b of a batch of
+ *  sparse matrices that share a sparsity pattern.
+ *
+ *  Every item has the rows, columns and column indices of \p pattern,
+ *  whose values are ignored, and the values of item b are row b of
+ *  \p values, in the order of the entries of \p pattern.  The operand
+ *  and result of item b are the ranges [b * N, (b + 1) * N) of \p x and
+ *  [b * M, (b + 1) * M) of \p y, where \p pattern is M x N.  The pattern
+ *  is stored once, so that the batch reads only its values.  A
+ *  column-major \p values interleaves the values of the items.
+ *
+ *  \param pattern CSR matrix with the pattern of the items
+ *  \param values num_items x pattern.num_entries array of the values
+ *  \param x operands of the items
+ *  \param y results of the items (output)
+ *
+ *  \tparam Matrix \p csr_matrix or \p csr_matrix_view
+ *  \tparam Array2d array2d
+ *  \tparam Array1 array1d
+ *  \tparam Array2 array1d
+ *
+ *  \throws cusp::invalid_input_exception if the sizes do not match
+ */
+template <typename Matrix,
+          typename Array2d,
+          typename Array1,
+          typename Array2>
+void batched_multiply_uniform(const Matrix&  pattern,
+                              const Array2d& values,
+                              const Array1&  x,
+                                    Array2&  y);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/batched_multiply.inl>
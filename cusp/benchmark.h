@@ -0,0 +1,163 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file benchmark.h
+ *  \brief Measured SpMV performance of the sparse matrix formats
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/auto_format_matrix.h>
+
+#include <cstddef>
+#include <iostream>
+
+namespace cusp
+{
+namespace benchmark
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p spmv_format_profile : measured SpMV performance of one format
+ */
+struct spmv_format_profile
+{
+    /*! whether the matrix was stored and timed in this format
+     */
+    bool admissible;
+
+    /*! estimated bytes of memory traffic of a SpMV
+     */
+    double bytes;
+
+    /*! measured time of a SpMV in milliseconds
+     */
+    double milliseconds;
+
+    /*! achieved GFLOP/s, counting a multiply and an add per entry
+     */
+    double gflops;
+
+    /*! achieved bandwidth in GB/s, \p bytes over \p milliseconds
+     */
+    double bandwidth;
+
+    /*! \p bandwidth as a fraction of the measured peak bandwidth
+     */
+    double efficiency;
+
+    spmv_format_profile(void)
+        : admissible(false), bytes(0), milliseconds(0), gflops(0), bandwidth(0), efficiency(0) {}
+};
+
+/*! \p spmv_profile_result : outcome of \p spmv_profile
+ */
+struct spmv_profile_result
+{
+    /*! shape of the profiled matrix
+     */
+    size_t num_rows;
+    size_t num_cols;
+    size_t num_entries;
+
+    /*! memory bandwidth in GB/s measured by \p stream_bandwidth in the
+     *  memory space of the matrix
+     */
+    double peak_bandwidth;
+
+    /*! the benchmarked selection, whose \p format is the fastest format.
+     *  It may be passed to \p auto_format_matrix::select to store a matrix
+     *  of the same structure without timing the formats again.
+     */
+    cusp::format_selection selection;
+
+    /*! performance of each format, indexed by \p format_selection::format_type
+     */
+    spmv_format_profile formats[cusp::format_selection::num_formats];
+
+    spmv_profile_result(void)
+        : num_rows(0), num_cols(0), num_entries(0), peak_bandwidth(0) {}
+};
+
+/*! \p stream_bandwidth : memory bandwidth in GB/s of a STREAM triad
+ *  (a = b + s * c) on three arrays of doubles in \p MemorySpace
+ *
+ *  The best of \p iterations passes is reported, as in the STREAM
+ *  benchmark.  Device passes are timed with CUDA events and host passes
+ *  with \c std::clock.  The arrays occupy \p bytes in total, which should
+ *  well exceed the size of the caches.
+ *
+ *  \tparam MemorySpace \c cusp::host_memory or \c cusp::device_memory
+ *  \param bytes storage of the three arrays
+ *  \param iterations number of timed passes
+ */
+template <typename MemorySpace>
+double stream_bandwidth(size_t bytes = 3 * (size_t(1) << 25), size_t iterations = 10);
+
+/*! \p spmv_profile : time SpMV with \p A in each admissible format
+ *
+ *  The matrix is converted to each format admitted by \p options,
+ *  timed as \p select_format does with \p options.benchmark set, and
+ *  compared with the bandwidth measured by \p stream_bandwidth.  Since
+ *  SpMV is bound by memory bandwidth, the efficiency of the fastest format
+ *  tells how much any format could still gain on this matrix.
+ *
+ *  When Cusp is built with \c CUSP_PROFILE_ENABLED, each format is timed
+ *  in a profiler scope named after it that carries its memory traffic,
+ *  so the profiles are part of the profiler's text, JSON and trace output.
+ *
+ *  \param A sparse or dense matrix
+ *  \param options selection parameters, \p options.benchmark is implied
+ *  \return the timings, and the selection of the fastest format
+ *
+ *  \code
+ *  #include <cusp/benchmark.h>
+ *  ...
+ *
+ *  cusp::benchmark::spmv_profile_result profile = cusp::benchmark::spmv_profile(A);
+ *
+ *  cusp::benchmark::print(profile);
+ *
+ *  // store B, which shares the structure of A, in the fastest format
+ *  cusp::auto_format_matrix<int,float,cusp::device_memory> C;
+ *  C.select(B, profile.selection);
+ *  \endcode
+ */
+template <typename Matrix>
+spmv_profile_result spmv_profile(const Matrix& A,
+                                 const cusp::format_selection_options& options = cusp::format_selection_options());
+
+/*! \p format_name : name of a format of \p format_selection
+ */
+inline const char * format_name(const cusp::format_selection::format_type format);
+
+/*! \p print : write a table of the profile to \p output
+ */
+inline void print(const spmv_profile_result& profile, std::ostream& output = std::cout);
+
+/*! \}
+ */
+
+} // end namespace benchmark
+} // end namespace cusp
+
+#include <cusp/detail/benchmark.inl>
@@ -26,6 +26,9 @@
 #include <cusp/complex.h>
 
 #include <thrust/iterator/iterator_traits.h>
+#include <thrust/tuple.h>
+
+#include <cstddef>
 
 namespace cusp
 {
@@ -37,6 +40,11 @@ namespace blas
 
 /*! \addtogroup blas BLAS
  *  \ingroup algorithms
+ *
+ *  With \p CUSP_USE_CBLAS or \p CUSP_USE_MKL defined, \p axpy, \p dot,
+ *  \p nrm2 and \p scal of \c float and \c double arrays in host memory
+ *  call the vendor BLAS library, unless the environment variable
+ *  \c CUSP_HOST_VENDOR is \c 0.
  *  \{
  */
 
@@ -242,6 +250,39 @@ typename Array1::value_type
          const Array2& y);
 
 
+/*! \p dotc_n : conjugate dot products of two pairs of vectors,
+ *  (conjugate(x1)^T * y1, conjugate(x2)^T * y2), computed in a single
+ *  pass over the vectors with a single synchronization
+ *
+ *  \code
+ *  // the two inner products of the BiCGStab step length
+ *  thrust::tuple<float,float> t = cusp::blas::dotc_n(AMs, s, AMs, AMs);
+ *  float omega = thrust::get<0>(t) / thrust::get<1>(t);
+ *  \endcode
+ */
+template <typename Array1,
+          typename Array2,
+          typename Array3,
+          typename Array4>
+thrust::tuple<typename Array1::value_type, typename Array1::value_type>
+    dotc_n(const Array1& x1, const Array2& y1,
+           const Array3& x2, const Array4& y2);
+
+/*! \p dotc_n : conjugate dot products of three pairs of vectors in a
+ *  single pass
+ */
+template <typename Array1,
+          typename Array2,
+          typename Array3,
+          typename Array4,
+          typename Array5,
+          typename Array6>
+thrust::tuple<typename Array1::value_type, typename Array1::value_type, typename Array1::value_type>
+    dotc_n(const Array1& x1, const Array2& y1,
+           const Array3& x2, const Array4& y2,
+           const Array5& x3, const Array6& y3);
+
+
 template <typename ForwardIterator,
           typename ScalarType>
 CUSP_DEPRECATED
@@ -324,6 +365,144 @@ template <typename Array,
 void scal(const Array& x,
           ScalarType alpha);
 
+
+/*! \p device_scalar : a scalar in device memory.
+ *
+ *  The reductions \p dot_async, \p dotc_async, \p nrm2_async and
+ *  \p nrmmax_async store their result in a device scalar instead of
+ *  returning it to the host, and \p axpy, \p axpby and \p scal accept
+ *  device scalars of the value type of the arrays as coefficients.  On
+ *  device arrays neither one waits for the device, so that a sequence of
+ *  reductions and updates, such as an iteration of a Krylov method,
+ *  runs without a transfer to the host.  On host arrays the scalar is
+ *  copied to or from the device.
+ *
+ *  \code
+ *  cusp::array1d<float, cusp::device_memory> scalars(2);
+ *
+ *  cusp::blas::device_scalar<float> rr    = cusp::blas::make_device_scalar(scalars, 0);
+ *  cusp::blas::device_scalar<float> alpha = cusp::blas::make_device_scalar(scalars, 1);
+ *
+ *  // scalars[0] <- <r,r>
+ *  cusp::blas::dotc_async(r, r, rr);
+ *
+ *  // x <- x + scalars[1] * p
+ *  cusp::blas::axpy(p, x, alpha);
+ *  \endcode
+ */
+template <typename ValueType>
+struct device_scalar
+{
+    /*! location of the scalar in device memory
+     */
+    ValueType * ptr;
+
+    explicit device_scalar(ValueType * ptr) : ptr(ptr) {}
+};
+
+/*! \p make_device_scalar : the device scalar at element \p i of a device
+ *  array.  As with a view, the element may be written through a const
+ *  array.
+ */
+template <typename Array>
+device_scalar<typename Array::value_type>
+    make_device_scalar(const Array& array, const size_t i = 0);
+
+/*! \p dot_async : dot product (result = x^T * y) stored in device memory
+ */
+template <typename Array1,
+          typename Array2,
+          typename ValueType>
+void dot_async(const Array1& x,
+               const Array2& y,
+               device_scalar<ValueType> result);
+
+/*! \p dotc_async : conjugate dot product (result = conjugate(x)^T * y)
+ *  stored in device memory
+ */
+template <typename Array1,
+          typename Array2,
+          typename ValueType>
+void dotc_async(const Array1& x,
+                const Array2& y,
+                device_scalar<ValueType> result);
+
+/*! \p nrm2_async : vector 2-norm stored in device memory
+ */
+template <typename Array,
+          typename ValueType>
+void nrm2_async(const Array& x,
+                device_scalar<ValueType> result);
+
+/*! \p nrmmax_async : vector infinity norm stored in device memory
+ */
+template <typename Array,
+          typename ValueType>
+void nrmmax_async(const Array& x,
+                  device_scalar<ValueType> result);
+
+/*! \p axpy : scaled vector addition (y = alpha * x + y) with alpha in
+ *  device memory
+ */
+template <typename Array1,
+          typename Array2,
+          typename ValueType>
+void axpy(const Array1& x,
+                Array2& y,
+          device_scalar<ValueType> alpha);
+
+/*! \p axpy : scaled vector addition (y = alpha * x + y) with alpha in
+ *  device memory
+ */
+template <typename Array1,
+          typename Array2,
+          typename ValueType>
+void axpy(const Array1& x,
+          const Array2& y,
+          device_scalar<ValueType> alpha);
+
+/*! \p axpby : linear combination of two vectors (z = alpha * x + beta * y)
+ *  with alpha and beta in device memory
+ */
+template <typename Array1,
+          typename Array2,
+          typename Array3,
+          typename ValueType>
+void axpby(const Array1& x,
+           const Array2& y,
+                 Array3& z,
+           device_scalar<ValueType> alpha,
+           device_scalar<ValueType> beta);
+
+/*! \p axpby : linear combination of two vectors (z = alpha * x + beta * y)
+ *  with alpha and beta in device memory
+ */
+template <typename Array1,
+          typename Array2,
+          typename Array3,
+          typename ValueType>
+void axpby(const Array1& x,
+           const Array2& y,
+           const Array3& z,
+           device_scalar<ValueType> alpha,
+           device_scalar<ValueType> beta);
+
+/*! \p scal : scale vector (x[i] = alpha * x[i]) with alpha in device
+ *  memory
+ */
+template <typename Array,
+          typename ValueType>
+void scal(Array& x,
+          device_scalar<ValueType> alpha);
+
+/*! \p scal : scale vector (x[i] = alpha * x[i]) with alpha in device
+ *  memory
+ */
+template <typename Array,
+          typename ValueType>
+void scal(const Array& x,
+          device_scalar<ValueType> alpha);
+
 /*! \}
  */
 
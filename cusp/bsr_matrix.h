@@ -0,0 +1,200 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file bsr_matrix.h
+ *  \brief Block Compressed Sparse Row matrix format.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/format.h>
+#include <cusp/detail/matrix_base.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p bsr_matrix : Block Compressed Sparse Row matrix container
+ *
+ * The matrix is partitioned into square \p block_size by \p block_size
+ * blocks and every block containing a nonzero is stored densely.  The
+ * blocks are stored in CSR format over the block rows and columns, the
+ * values of each block are stored contiguously in row-major order.
+ *
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ * \note The number of rows and columns must be multiples of \p block_size.
+ * \note The blocks within each block row must be sorted by column index.
+ * \note \p num_entries is the number of stored values, i.e.
+ *  <tt>num_blocks() * block_size * block_size</tt>.
+ * \note Conversions into a \p bsr_matrix use the \p block_size of the
+ *  destination.
+ *
+ *  The following code snippet demonstrates how to convert a matrix
+ *  with 3 unknowns per grid point to BSR format on the device.
+ *
+ *  \code
+ *  #include <cusp/bsr_matrix.h>
+ *  #include <cusp/csr_matrix.h>
+ *  ...
+ *
+ *  cusp::csr_matrix<int,float,cusp::host_memory> A = ...;
+ *
+ *  // convert to 3x3 blocks
+ *  cusp::bsr_matrix<int,float,cusp::device_memory> B(A, 3);
+ *
+ *  // the block size is retained by copies
+ *  cusp::bsr_matrix<int,float,cusp::host_memory> C = B;
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class bsr_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::bsr_format>
+{
+  typedef cusp::detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::bsr_format> Parent;
+  public:
+    /*! rebind matrix to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::bsr_matrix<IndexType, ValueType, MemorySpace2> type; };
+
+    /*! type of block row offsets indices array
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> row_offsets_array_type;
+
+    /*! type of block column indices array
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> column_indices_array_type;
+
+    /*! type of values array
+     */
+    typedef typename cusp::array1d<ValueType, MemorySpace> values_array_type;
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::bsr_matrix<IndexType, ValueType, MemorySpace> container;
+
+    /*! Number of rows and columns of each block.
+     */
+    size_t block_size;
+
+    /*! Storage for the block row offsets of the BSR data structure.
+     */
+    row_offsets_array_type row_offsets;
+
+    /*! Storage for the block column indices of the BSR data structure.
+     */
+    column_indices_array_type column_indices;
+
+    /*! Storage for the values of the blocks of the BSR data structure.
+     */
+    values_array_type values;
+
+    /*! Construct an empty \p bsr_matrix with 1x1 blocks.
+     */
+    bsr_matrix() : block_size(1) {}
+
+    /*! Construct a \p bsr_matrix with a specific shape, number of
+     *  blocks and block size.
+     *
+     *  \param num_rows Number of rows.
+     *  \param num_cols Number of columns.
+     *  \param num_blocks Number of stored blocks.
+     *  \param block_size Number of rows and columns of each block.
+     */
+    bsr_matrix(size_t num_rows, size_t num_cols, size_t num_blocks, size_t block_size)
+      : Parent(num_rows, num_cols, num_blocks * block_size * block_size),
+        block_size(block_size),
+        row_offsets(num_rows / block_size + 1),
+        column_indices(num_blocks),
+        values(num_blocks * block_size * block_size) {}
+
+    /*! Construct a \p bsr_matrix with 1x1 blocks from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    bsr_matrix(const MatrixType& matrix);
+
+    /*! Construct a \p bsr_matrix from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     *  \param block_size Number of rows and columns of each block.
+     */
+    template <typename MatrixType>
+    bsr_matrix(const MatrixType& matrix, size_t block_size);
+
+    /*! Number of block rows.
+     */
+    size_t num_block_rows(void) const { return Parent::num_rows / block_size; }
+
+    /*! Number of block columns.
+     */
+    size_t num_block_cols(void) const { return Parent::num_cols / block_size; }
+
+    /*! Number of stored blocks.
+     */
+    size_t num_blocks(void) const { return column_indices.size(); }
+
+    /*! Resize matrix dimensions and underlying storage
+     */
+    void resize(size_t num_rows, size_t num_cols, size_t num_blocks, size_t block_size)
+    {
+      Parent::resize(num_rows, num_cols, num_blocks * block_size * block_size);
+      this->block_size = block_size;
+      row_offsets.resize(num_rows / block_size + 1);
+      column_indices.resize(num_blocks);
+      values.resize(num_blocks * block_size * block_size);
+    }
+
+    /*! Swap the contents of two \p bsr_matrix objects.
+     *
+     *  \param matrix Another \p bsr_matrix with the same IndexType and ValueType.
+     */
+    void swap(bsr_matrix& matrix)
+    {
+      Parent::swap(matrix);
+      thrust::swap(block_size, matrix.block_size);
+      row_offsets.swap(matrix.row_offsets);
+      column_indices.swap(matrix.column_indices);
+      values.swap(matrix.values);
+    }
+
+    /*! Assignment from another matrix.  The block size of this matrix
+     *  is retained unless \p matrix is a \p bsr_matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    bsr_matrix& operator=(const MatrixType& matrix);
+}; // class bsr_matrix
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/bsr_matrix.inl>
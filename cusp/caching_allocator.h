@@ -0,0 +1,141 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file caching_allocator.h
+ *  \brief Device allocator that caches freed blocks for reuse
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <thrust/device_malloc_allocator.h>
+#include <thrust/device_ptr.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p caching_allocator_statistics : usage summary of the device memory
+ *  pool behind \p caching_device_allocator.
+ */
+struct caching_allocator_statistics
+{
+    /*! bytes currently held by live allocations
+     */
+    size_t bytes_in_use;
+
+    /*! bytes of freed blocks retained for reuse
+     */
+    size_t bytes_cached;
+
+    /*! largest value of \p bytes_in_use observed
+     */
+    size_t peak_bytes_in_use;
+
+    /*! largest value of <tt>bytes_in_use + bytes_cached</tt> observed
+     */
+    size_t peak_bytes_reserved;
+
+    /*! number of requests satisfied by \p cudaMalloc
+     */
+    size_t num_device_allocations;
+
+    /*! number of requests satisfied from the cache
+     */
+    size_t num_cache_hits;
+};
+
+/*! \p caching_device_allocator : a device allocator that retains freed
+ *  blocks and hands them out again instead of calling \p cudaFree and
+ *  \p cudaMalloc.
+ *
+ *  Requests are rounded up to a size class (powers of two starting at
+ *  512 bytes, multiples of 2 MB above 256 MB) and served from a pool of
+ *  freed blocks of the same class that were allocated on the current
+ *  device.  A freed block is immediately
+ *  reusable on the stream that was current (see \p scoped_stream) when
+ *  it was freed; other streams reuse it once the work issued before the
+ *  free has completed.  When \p cudaMalloc fails, the cache is released
+ *  and the allocation retried.
+ *
+ *  The pool is shared by all instances and all host threads.
+ *
+ *  The allocator may be selected for an individual array by passing it
+ *  in place of the memory space, or for every device container by
+ *  defining \p CUSP_USE_CACHING_ALLOCATOR before including any Cusp
+ *  header.
+ *
+ *  \code
+ *  // a single array
+ *  cusp::array1d<float, cusp::caching_device_allocator<float> > x(N);
+ *
+ *  // all device containers
+ *  #define CUSP_USE_CACHING_ALLOCATOR
+ *  #include <cusp/csr_matrix.h>
+ *  \endcode
+ *
+ *  \see \p get_caching_allocator_statistics
+ *  \see \p free_cached_memory
+ */
+template <typename T>
+class caching_device_allocator : public thrust::device_malloc_allocator<T>
+{
+    typedef thrust::device_malloc_allocator<T> super_t;
+
+    public:
+
+    typedef typename super_t::pointer   pointer;
+    typedef typename super_t::size_type size_type;
+
+    template <typename U>
+    struct rebind { typedef caching_device_allocator<U> other; };
+
+    caching_device_allocator(void) {}
+
+    caching_device_allocator(const caching_device_allocator&) : super_t() {}
+
+    template <typename U>
+    caching_device_allocator(const caching_device_allocator<U>&) {}
+
+    pointer allocate(size_type n);
+
+    void deallocate(pointer p, size_type n);
+};
+
+/*! \p get_caching_allocator_statistics : current statistics of the
+ *  memory pool used by \p caching_device_allocator.
+ */
+inline caching_allocator_statistics get_caching_allocator_statistics(void);
+
+/*! \p free_cached_memory : release all cached blocks of the memory pool
+ *  used by \p caching_device_allocator to the device.  Live allocations
+ *  are not affected.
+ */
+inline void free_cached_memory(void);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/caching_allocator.inl>
+
@@ -0,0 +1,127 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file column_blocked_matrix.h
+ *  \brief Operator of a sparse matrix split into panels of columns
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/csr_matrix.h>
+#include <cusp/linear_operator.h>
+
+#include <vector>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ *  \{
+ */
+
+/*! \p column_blocked_matrix : an operator of a sparse matrix whose columns
+ *  are split into vertical panels, for very wide matrices.
+ *
+ *  The product of a matrix with many more columns than the cache holds
+ *  entries of \p x reads \p x at random, and nearly every read of the
+ *  SpMV kernels misses the cache.  The operator splits the matrix into
+ *  panels of \p panel_width consecutive columns, each stored as a
+ *  \p csr_matrix whose column indices are relative to the panel.  A
+ *  product multiplies one panel after the other and accumulates into
+ *  \p y with the fused update y = A_p x_p + y, so that each kernel reads
+ *  \p x only within the window of its panel.
+ *
+ *  Every panel stores the offsets of all rows, hence the split suits
+ *  matrices with many more columns than rows.  Empty panels are dropped.
+ *  The panels are built once, when the operator is constructed, and the
+ *  operator may be passed wherever a \p linear_operator is accepted.
+ *
+ *  \tparam IndexType Type used for matrix indices (e.g. \c int).
+ *  \tparam ValueType Type used for matrix values (e.g. \c float).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ *  \code
+ *  #include <cusp/column_blocked_matrix.h>
+ *  ...
+ *
+ *  // A has 1000 rows and 200M columns
+ *  cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *  ...
+ *
+ *  // panels whose part of x fits into the L2 cache of the device
+ *  cusp::column_blocked_matrix<int, float, cusp::device_memory> B(A);
+ *
+ *  cusp::multiply(B, x, y);
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class column_blocked_matrix : public cusp::linear_operator<ValueType, MemorySpace, IndexType>
+{
+    typedef cusp::linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+public:
+    /*! type of a panel
+     */
+    typedef cusp::csr_matrix<IndexType, ValueType, MemorySpace> panel_type;
+
+    /*! number of columns of the full panels
+     */
+    size_t panel_width;
+
+    /*! The nonempty panels, with column indices relative to the panel.
+     */
+    std::vector<panel_type> panels;
+
+    /*! first column of each panel
+     */
+    std::vector<size_t> panel_columns;
+
+    /*! construct an empty operator
+     */
+    column_blocked_matrix(void) : panel_width(0) {}
+
+    /*! construct the panels of a matrix
+     *
+     * \param matrix sparse matrix
+     * \param panel_width columns per panel, by default chosen such that
+     * the window of \p x of a panel fills half of the L2 cache of the
+     * current device, or of a typical host cache
+     */
+    template <typename MatrixType>
+    column_blocked_matrix(const MatrixType& matrix, size_t panel_width = 0);
+
+    /*! number of nonempty panels
+     */
+    size_t num_panels(void) const { return panels.size(); }
+
+    /*! apply the operator to vector \p x and store the result in \p y
+     *
+     * \param x input vector
+     * \param y ouput vector
+     * \tparam VectorType1 vector
+     * \tparam VectorType2 vector
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+};
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/column_blocked_matrix.inl>
@@ -0,0 +1,116 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file communicator.h
+ *  \brief Group of processes that share distributed arrays
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <vector>
+
+#if defined(CUSP_USE_MPI)
+#include <mpi.h>
+#endif
+
+namespace cusp
+{
+
+/*! \addtogroup arrays Arrays
+ */
+
+/*! \addtogroup array_containers Array Containers
+ *  \ingroup arrays
+ *  \{
+ */
+
+/*! \p communicator : group of processes over which a \p distribution
+ *  partitions its indices.
+ *
+ *  When Cusp is built with \p CUSP_USE_MPI a communicator wraps an
+ *  \c MPI_Comm, and the ranges of a distribution may reside on other
+ *  processes of the group, e.g. the nodes of a cluster.  MPI must be
+ *  initialized by the application.  Otherwise the only communicator is
+ *  the calling process, whose rank is 0.
+ *
+ *  The default communicator contains the calling process only, so
+ *  that the distributions of a single process do not communicate.
+ *
+ *  \code
+ *  #include <cusp/communicator.h>
+ *
+ *  // distribute over all processes of the job
+ *  cusp::communicator comm(MPI_COMM_WORLD);
+ *
+ *  std::vector<int> numbers;
+ *  comm.allgather(comm.rank(), numbers); // 0, 1, ..., comm.size() - 1
+ *  \endcode
+ */
+class communicator
+{
+    public:
+    /*! Construct a communicator of the calling process.
+     */
+    communicator(void);
+
+#if defined(CUSP_USE_MPI)
+    /*! Wrap an MPI communicator, which must outlive the object.
+     */
+    explicit communicator(MPI_Comm comm);
+
+    MPI_Comm get(void) const { return comm; }
+#endif
+
+    /*! rank of the calling process
+     */
+    int rank(void) const { return m_rank; }
+
+    /*! number of processes
+     */
+    int size(void) const { return m_size; }
+
+    bool operator==(const communicator& c) const;
+    bool operator!=(const communicator& c) const { return !(*this == c); }
+
+    /*! values[r] <- the value of process r.  T must be copyable
+     *  bytewise.  Collective on the communicator.
+     */
+    template <typename T>
+    void allgather(const T& value, std::vector<T>& values) const;
+
+    /*! recv[r] <- send[rank()] of process r.  T must be copyable
+     *  bytewise.  Collective on the communicator.
+     */
+    template <typename T>
+    void alltoallv(const std::vector< std::vector<T> >& send,
+                         std::vector< std::vector<T> >& recv) const;
+
+    private:
+#if defined(CUSP_USE_MPI)
+    MPI_Comm comm;
+#endif
+    int m_rank;
+    int m_size;
+};
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/communicator.inl>
@@ -22,6 +22,8 @@
 
 #include <cusp/detail/config.h>
 
+#include <cusp/detail/stream.h>
+
 namespace cusp
 {
 
@@ -40,6 +42,52 @@ namespace cusp
 template <typename T1, typename T2>
 void copy(const T1& src, T2& dst);
 
+/*! \p copy_async : Copy one array to another on a CUDA stream without
+ * waiting for the copy to complete
+ *
+ * Either array may reside in host or device memory.  The copy is issued
+ * with \p cudaMemcpyAsync on \p stream, so it is ordered with the other
+ * work of the stream and its result may only be read on the host after
+ * the stream has been synchronized.  The host array must not be modified
+ * or destroyed before then.
+ *
+ * Only copies from and to page-locked host memory (\p cusp::pinned_memory)
+ * overlap with the host and with work on other streams; the driver stages
+ * pageable memory and returns once the host array has been read.  Double
+ * buffering the transfers of consecutive right-hand sides on two streams
+ * thus overlaps the upload of one with the solve of the other.
+ *
+ * \code
+ * cusp::array1d<float, cusp::pinned_memory> b_host(N), x_host(N);
+ * cusp::array1d<float, cusp::device_memory> b(N), x(N);
+ *
+ * cusp::copy_async(b_host, b, stream);
+ * {
+ *     cusp::scoped_stream scope(stream);
+ *     cusp::krylov::fused_cg(A, x, b, monitor, M);
+ * }
+ * cusp::copy_async(x, x_host, stream);
+ * cudaStreamSynchronize(stream);
+ * \endcode
+ *
+ * \note T1 and T2 must be contiguous arrays (\p array1d or a view of
+ * one) of the same value type.  T2 is not resized.
+ *
+ * \throws cusp::invalid_input_exception if the sizes of the arrays differ
+ * \throws cusp::runtime_exception if the copy cannot be issued
+ *
+ * \see \p pinned_allocator
+ * \see \p scoped_stream
+ */
+template <typename T1, typename T2>
+void copy_async(const T1& src, T2& dst, cudaStream_t stream);
+
+/*! \p copy_async : Copy one array to another on the current stream (see
+ * \p scoped_stream) without waiting for the copy to complete
+ */
+template <typename T1, typename T2>
+void copy_async(const T1& src, T2& dst);
+
 /*! \}
  */
 
@@ -0,0 +1,212 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file csr16_matrix.h
+ *  \brief Compressed Sparse Row matrix format with 16-bit column offsets.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/format.h>
+#include <cusp/detail/matrix_base.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p csr16_matrix : CSR matrix container with compressed column indices
+ *
+ * The column index of each entry is stored as a 16-bit offset from the
+ * base column of its row, which halves the index traffic of SpMV for
+ * 32-bit indices.  The base column of a row is its smallest column index.
+ * Entries more than \p max_offset columns to the right of the base are
+ * stored in the \p overflow \p coo_matrix instead, as in the \p hyb_matrix.
+ * Matrices whose entries lie within a band of 65536 columns of each row,
+ * e.g. banded FEM matrices, have no overflow.
+ *
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ * \note The \p num_entries of a \p csr16_matrix includes the \p overflow entries.
+ * \note The \p overflow entries must be sorted by row index.
+ *
+ *  \code
+ *  #include <cusp/csr16_matrix.h>
+ *  ...
+ *
+ *  // allocate storage for (3,100000) matrix with 4 nonzeros, one of
+ *  // which is too far from the base column of its row
+ *  cusp::csr16_matrix<int,float,cusp::host_memory> A(3, 100000, 4, 1);
+ *
+ *  // Initialize A to represent the following matrix
+ *  // [10  0 ... 20]      (20 at column 99999)
+ *  // [ 0 30 ...  0]
+ *  // [ 0  0 ... 40]      (40 at column 99999)
+ *
+ *  A.row_offsets[0] = 0;  A.row_bases[0] = 0;
+ *  A.row_offsets[1] = 1;  A.row_bases[1] = 1;
+ *  A.row_offsets[2] = 2;  A.row_bases[2] = 99999;
+ *  A.row_offsets[3] = 3;
+ *
+ *  A.column_offsets[0] = 0; A.values[0] = 10;
+ *  A.column_offsets[1] = 0; A.values[1] = 30;
+ *  A.column_offsets[2] = 0; A.values[2] = 40;
+ *
+ *  A.overflow.row_indices[0] = 0; A.overflow.column_indices[0] = 99999; A.overflow.values[0] = 20;
+ *  \endcode
+ *
+ *  \see \p csr_matrix
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class csr16_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::csr16_format>
+{
+  typedef cusp::detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::csr16_format> Parent;
+  public:
+    /*! rebind matrix to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::csr16_matrix<IndexType, ValueType, MemorySpace2> type; };
+
+    /*! type of compressed column indices
+     */
+    typedef unsigned short offset_type;
+
+    /*! type of row offsets and row bases arrays
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> index_array_type;
+
+    /*! type of column offsets array
+     */
+    typedef typename cusp::array1d<offset_type, MemorySpace> column_offsets_array_type;
+
+    /*! type of values array
+     */
+    typedef typename cusp::array1d<ValueType, MemorySpace> values_array_type;
+
+    /*! type of the overflow portion
+     */
+    typedef typename cusp::coo_matrix<IndexType, ValueType, MemorySpace> coo_matrix_type;
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::csr16_matrix<IndexType, ValueType, MemorySpace> container;
+
+    /*! Largest column offset of a compressed entry.
+     */
+    const static size_t max_offset = 65535;
+
+    /*! Storage for the row offsets of the compressed entries.
+     */
+    index_array_type row_offsets;
+
+    /*! Base column of each row.
+     */
+    index_array_type row_bases;
+
+    /*! Column index minus the base column of the row of each compressed entry.
+     */
+    column_offsets_array_type column_offsets;
+
+    /*! Storage for the values of the compressed entries.
+     */
+    values_array_type values;
+
+    /*! Storage for the entries that are not compressed.
+     */
+    coo_matrix_type overflow;
+
+    /*! Construct an empty \p csr16_matrix.
+     */
+    csr16_matrix() {}
+
+    /*! Construct a \p csr16_matrix with a specific shape and number of
+     *  compressed and overflow entries.
+     *
+     *  \param num_rows Number of rows.
+     *  \param num_cols Number of columns.
+     *  \param num_entries Number of nonzero matrix entries, overflow included.
+     *  \param num_overflow_entries Number of entries in the \p overflow portion.
+     */
+    csr16_matrix(size_t num_rows, size_t num_cols, size_t num_entries, size_t num_overflow_entries = 0)
+      : Parent(num_rows, num_cols, num_entries),
+        row_offsets(num_rows + 1),
+        row_bases(num_rows),
+        column_offsets(num_entries - num_overflow_entries),
+        values(num_entries - num_overflow_entries),
+        overflow(num_rows, num_cols, num_overflow_entries) {}
+
+    /*! Construct a \p csr16_matrix from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    csr16_matrix(const MatrixType& matrix);
+
+    /*! Number of compressed entries.
+     */
+    size_t num_compressed_entries(void) const { return values.size(); }
+
+    /*! Resize matrix dimensions and underlying storage
+     */
+    void resize(size_t num_rows, size_t num_cols, size_t num_entries, size_t num_overflow_entries = 0)
+    {
+      Parent::resize(num_rows, num_cols, num_entries);
+      row_offsets.resize(num_rows + 1);
+      row_bases.resize(num_rows);
+      column_offsets.resize(num_entries - num_overflow_entries);
+      values.resize(num_entries - num_overflow_entries);
+      overflow.resize(num_rows, num_cols, num_overflow_entries);
+    }
+
+    /*! Swap the contents of two \p csr16_matrix objects.
+     *
+     *  \param matrix Another \p csr16_matrix with the same IndexType and ValueType.
+     */
+    void swap(csr16_matrix& matrix)
+    {
+      Parent::swap(matrix);
+      row_offsets.swap(matrix.row_offsets);
+      row_bases.swap(matrix.row_bases);
+      column_offsets.swap(matrix.column_offsets);
+      values.swap(matrix.values);
+      overflow.swap(matrix.overflow);
+    }
+
+    /*! Assignment from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    csr16_matrix& operator=(const MatrixType& matrix);
+}; // class csr16_matrix
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/csr16_matrix.inl>
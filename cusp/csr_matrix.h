@@ -25,6 +25,7 @@
 #include <cusp/array1d.h>
 #include <cusp/format.h>
 #include <cusp/detail/matrix_base.h>
+#include <cusp/detail/row_statistics.h>
 
 namespace cusp
 {
@@ -137,6 +138,10 @@ class csr_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cu
      */
     values_array_type values;
 
+    /*! Cached row length statistics used to select SpMV kernels.
+     */
+    mutable cusp::detail::row_statistics row_statistics;
+
 
     /*! Construct an empty \p csr_matrix.
      */
@@ -167,6 +172,7 @@ class csr_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cu
       row_offsets.resize(num_rows + 1);
       column_indices.resize(num_entries);
       values.resize(num_entries);
+      row_statistics.invalidate();
     }
 
     /*! Swap the contents of two \p csr_matrix objects.
@@ -179,6 +185,7 @@ class csr_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cu
       row_offsets.swap(matrix.row_offsets);
       column_indices.swap(matrix.column_indices);
       values.swap(matrix.values);
+      thrust::swap(row_statistics, matrix.row_statistics);
     }
     
     /*! Assignment from another matrix.
@@ -205,6 +212,10 @@ class csr_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cu
  * \tparam ValueType Type used for matrix values (e.g. \c float).
  * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
  *
+ * \note The value type of the \c row_offsets may be wider than that of the
+ * \c column_indices, e.g. 64-bit row offsets for matrices with more than
+ * 2^31 nonzeros and 32-bit column indices.  SpMV supports such views
+ * directly, without doubling the storage of the column indices.
  */
 template <typename Array1,
           typename Array2,
@@ -240,6 +251,10 @@ class csr_matrix_view : public cusp::detail::matrix_base<IndexType,ValueType,Mem
      */
     values_array_type values;
 
+    /*! Cached row length statistics used to select SpMV kernels.
+     */
+    mutable cusp::detail::row_statistics row_statistics;
+
     // construct empty view
     csr_matrix_view(void)
       : Parent() {}
@@ -250,7 +265,8 @@ class csr_matrix_view : public cusp::detail::matrix_base<IndexType,ValueType,Mem
       : Parent(A),
         row_offsets(A.row_offsets),
         column_indices(A.column_indices),
-        values(A.values) {}
+        values(A.values),
+        row_statistics(A.row_statistics) {}
 
     // TODO check sizes here
     csr_matrix_view(size_t num_rows,
@@ -272,6 +288,7 @@ class csr_matrix_view : public cusp::detail::matrix_base<IndexType,ValueType,Mem
       row_offsets.resize(num_rows + 1);
       column_indices.resize(num_entries);
       values.resize(num_entries);
+      row_statistics.invalidate();
     }
 };
 
@@ -0,0 +1,257 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/exception.h>
+
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/scan.h>
+#include <thrust/transform.h>
+
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// number of distinct column indices of row i of A and B, whose rows are
+// sorted, stored in Cp[i]
+template <typename IndexType>
+struct csr_merge_count_functor
+{
+    const IndexType * Ap;
+    const IndexType * Aj;
+    const IndexType * Bp;
+    const IndexType * Bj;
+          IndexType * Cp;
+
+    csr_merge_count_functor(const IndexType * Ap, const IndexType * Aj,
+                            const IndexType * Bp, const IndexType * Bj,
+                                  IndexType * Cp)
+        : Ap(Ap), Aj(Aj), Bp(Bp), Bj(Bj), Cp(Cp) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType a = Ap[i], a_end = Ap[i + 1];
+        IndexType b = Bp[i], b_end = Bp[i + 1];
+        IndexType count = 0;
+
+        while (a < a_end && b < b_end)
+        {
+            const IndexType Aj_a = Aj[a];
+            const IndexType Bj_b = Bj[b];
+
+            if (Aj_a <= Bj_b) a++;
+            if (Bj_b <= Aj_a) b++;
+
+            count++;
+        }
+
+        Cp[i] = count + (a_end - a) + (b_end - b);
+    }
+};
+
+// column indices of row i of C, and the positions of the entries of row
+// i of A and B in C
+template <typename IndexType>
+struct csr_merge_functor
+{
+    const IndexType * Ap;
+    const IndexType * Aj;
+    const IndexType * Bp;
+    const IndexType * Bj;
+    const IndexType * Cp;
+          IndexType * Cj;
+          IndexType * A_positions;
+          IndexType * B_positions;
+
+    csr_merge_functor(const IndexType * Ap, const IndexType * Aj,
+                      const IndexType * Bp, const IndexType * Bj,
+                      const IndexType * Cp,       IndexType * Cj,
+                            IndexType * A_positions, IndexType * B_positions)
+        : Ap(Ap), Aj(Aj), Bp(Bp), Bj(Bj), Cp(Cp), Cj(Cj), A_positions(A_positions), B_positions(B_positions) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType a = Ap[i], a_end = Ap[i + 1];
+        IndexType b = Bp[i], b_end = Bp[i + 1];
+        IndexType c = Cp[i];
+
+        while (a < a_end && b < b_end)
+        {
+            const IndexType Aj_a = Aj[a];
+            const IndexType Bj_b = Bj[b];
+
+            Cj[c] = Aj_a < Bj_b ? Aj_a : Bj_b;
+
+            if (Aj_a <= Bj_b) A_positions[a++] = c;
+            if (Bj_b <= Aj_a) B_positions[b++] = c;
+
+            c++;
+        }
+
+        for (; a < a_end; a++, c++)
+        {
+            Cj[c] = Aj[a];
+            A_positions[a] = c;
+        }
+
+        for (; b < b_end; b++, c++)
+        {
+            Cj[c] = Bj[b];
+            B_positions[b] = c;
+        }
+    }
+};
+
+// alpha * a
+template <typename ScalarType, typename ValueType>
+struct add_scale_functor
+{
+    ScalarType alpha;
+
+    add_scale_functor(ScalarType alpha) : alpha(alpha) {}
+
+    template <typename T>
+    __host__ __device__
+    ValueType operator()(const T& a) const
+    {
+        return ValueType(alpha * a);
+    }
+};
+
+// beta * b + c
+template <typename ScalarType, typename ValueType>
+struct add_axpy_functor
+{
+    ScalarType beta;
+
+    add_axpy_functor(ScalarType beta) : beta(beta) {}
+
+    template <typename T>
+    __host__ __device__
+    ValueType operator()(const T& b, const ValueType& c) const
+    {
+        return ValueType(beta * b) + c;
+    }
+};
+
+} // end namespace detail
+
+template <typename IndexType, class MemorySpace>
+template <typename Matrix1, typename Matrix2>
+add_plan<IndexType,MemorySpace>
+::add_plan(const Matrix1& A, const Matrix2& B)
+{
+    setup(A, B);
+}
+
+template <typename IndexType, class MemorySpace>
+template <typename Matrix1, typename Matrix2>
+void add_plan<IndexType,MemorySpace>
+::setup(const Matrix1& A, const Matrix2& B)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (A.num_rows != B.num_rows || A.num_cols != B.num_cols)
+        throw cusp::invalid_input_exception("array dimensions do not match");
+
+    num_rows = A.num_rows;
+    num_cols = A.num_cols;
+
+    row_offsets.resize(num_rows + 1);
+    A_positions.resize(A.num_entries);
+    B_positions.resize(B.num_entries);
+
+    // symbolic phase: count the union of each row and scan the counts
+    row_offsets[num_rows] = 0;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     cusp::detail::csr_merge_count_functor<IndexType>
+                        (thrust::raw_pointer_cast(&A.row_offsets[0]), thrust::raw_pointer_cast(&A.column_indices[0]),
+                         thrust::raw_pointer_cast(&B.row_offsets[0]), thrust::raw_pointer_cast(&B.column_indices[0]),
+                         thrust::raw_pointer_cast(&row_offsets[0])));
+
+    thrust::exclusive_scan(row_offsets.begin(), row_offsets.end(), row_offsets.begin());
+
+    column_indices.resize(row_offsets[num_rows]);
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     cusp::detail::csr_merge_functor<IndexType>
+                        (thrust::raw_pointer_cast(&A.row_offsets[0]), thrust::raw_pointer_cast(&A.column_indices[0]),
+                         thrust::raw_pointer_cast(&B.row_offsets[0]), thrust::raw_pointer_cast(&B.column_indices[0]),
+                         thrust::raw_pointer_cast(&row_offsets[0]),    thrust::raw_pointer_cast(&column_indices[0]),
+                         thrust::raw_pointer_cast(&A_positions[0]),    thrust::raw_pointer_cast(&B_positions[0])));
+}
+
+template <typename IndexType, class MemorySpace>
+template <typename Matrix1, typename Matrix2, typename Matrix3, typename ScalarType>
+void add_plan<IndexType,MemorySpace>
+::add(const Matrix1& A, const Matrix2& B, Matrix3& C, ScalarType alpha, ScalarType beta) const
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix3::value_type ValueType;
+
+    if (A.num_entries != A_positions.size() || B.num_entries != B_positions.size())
+        throw cusp::invalid_input_exception("matrix pattern does not match the add_plan");
+
+    if (C.num_rows != num_rows || C.num_cols != num_cols || C.num_entries != num_entries())
+    {
+        C.resize(num_rows, num_cols, num_entries());
+        cusp::copy(row_offsets,    C.row_offsets);
+        cusp::copy(column_indices, C.column_indices);
+    }
+
+    // numeric phase: C <- alpha * A, then C <- C + beta * B
+    thrust::fill(C.values.begin(), C.values.end(), ValueType(0));
+
+    thrust::transform(A.values.begin(), A.values.end(),
+                      thrust::make_permutation_iterator(C.values.begin(), A_positions.begin()),
+                      cusp::detail::add_scale_functor<ScalarType,ValueType>(alpha));
+
+    thrust::transform(B.values.begin(), B.values.end(),
+                      thrust::make_permutation_iterator(C.values.begin(), B_positions.begin()),
+                      thrust::make_permutation_iterator(C.values.begin(), B_positions.begin()),
+                      cusp::detail::add_axpy_functor<ScalarType,ValueType>(beta));
+}
+
+namespace detail
+{
+
+// C <- alpha * A + beta * B for CSR matrices
+template <typename Matrix1, typename Matrix2, typename Matrix3, typename ScalarType>
+void csr_add(const Matrix1& A, const Matrix2& B, Matrix3& C, ScalarType alpha, ScalarType beta)
+{
+    typedef typename Matrix3::index_type   IndexType;
+    typedef typename Matrix3::memory_space MemorySpace;
+
+    cusp::add_plan<IndexType,MemorySpace> plan(A, B);
+    plan.add(A, B, C, alpha, beta);
+}
+
+} // end namespace detail
+} // end namespace cusp
@@ -0,0 +1,355 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/complex.h>
+#include <cusp/format.h>
+#include <cusp/csr_matrix.h>
+
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/host/conversion_utils.h>
+#include <cusp/detail/device/conversion_utils.h>
+
+#include <thrust/adjacent_difference.h>
+#include <thrust/binary_search.h>
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/equal.h>
+#include <thrust/extrema.h>
+#include <thrust/functional.h>
+#include <thrust/reduce.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/tuple.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+template <typename Matrix>
+size_t count_diagonals(const Matrix& csr, cusp::host_memory)
+{
+    return cusp::detail::host::count_diagonals(csr);
+}
+
+template <typename Matrix>
+size_t count_diagonals(const Matrix& csr, cusp::device_memory)
+{
+    return cusp::detail::device::count_diagonals(csr);
+}
+
+template <typename T>
+__host__ __device__
+T analysis_abs(const T& a)
+{
+    return a < T(0) ? -a : a;
+}
+
+template <typename T>
+__host__ __device__
+T analysis_abs(const cusp::complex<T>& a)
+{
+    return cusp::abs(a);
+}
+
+template <typename ValueType>
+struct analysis_absolute
+{
+    typedef typename cusp::norm_type<ValueType>::type result_type;
+
+    __host__ __device__
+    result_type operator()(const ValueType& a) const
+    {
+        return analysis_abs(a);
+    }
+};
+
+// (i - j, j - i) of an entry (i,j), clamped to zero
+template <typename IndexType>
+struct analysis_distances
+{
+    typedef thrust::tuple<IndexType,IndexType> result_type;
+
+    template <typename Tuple>
+    __host__ __device__
+    result_type operator()(const Tuple& t) const
+    {
+        const IndexType i = thrust::get<0>(t);
+        const IndexType j = thrust::get<1>(t);
+
+        return i > j ? result_type(i - j, IndexType(0)) : result_type(IndexType(0), j - i);
+    }
+};
+
+template <typename IndexType>
+struct analysis_tuple_maximum
+{
+    typedef thrust::tuple<IndexType,IndexType> Tuple;
+
+    __host__ __device__
+    Tuple operator()(const Tuple& a, const Tuple& b) const
+    {
+        return Tuple(thrust::max(thrust::get<0>(a), thrust::get<0>(b)),
+                     thrust::max(thrust::get<1>(a), thrust::get<1>(b)));
+    }
+};
+
+// distance from the first entry (i,j) of row i to the diagonal
+template <typename IndexType>
+struct analysis_envelope
+{
+    typedef size_t result_type;
+
+    template <typename Tuple>
+    __host__ __device__
+    size_t operator()(const Tuple& t) const
+    {
+        const IndexType i = thrust::get<0>(t);
+        const IndexType j = thrust::get<1>(t);
+
+        return i > j ? size_t(i - j) : size_t(0);
+    }
+};
+
+// (|A(i,i)|, |A(i,j)|) of an entry, the other being zero
+template <typename IndexType, typename ValueType>
+struct analysis_split_diagonal
+{
+    typedef typename cusp::norm_type<ValueType>::type RealType;
+    typedef thrust::tuple<RealType,RealType>             result_type;
+
+    template <typename Tuple>
+    __host__ __device__
+    result_type operator()(const Tuple& t) const
+    {
+        const RealType a = analysis_abs(thrust::get<2>(t));
+
+        if (thrust::get<0>(t) == thrust::get<1>(t))
+            return result_type(a, RealType(0));
+        else
+            return result_type(RealType(0), a);
+    }
+};
+
+template <typename RealType>
+struct analysis_tuple_plus
+{
+    typedef thrust::tuple<RealType,RealType> Tuple;
+
+    __host__ __device__
+    Tuple operator()(const Tuple& a, const Tuple& b) const
+    {
+        return Tuple(thrust::get<0>(a) + thrust::get<0>(b), thrust::get<1>(a) + thrust::get<1>(b));
+    }
+};
+
+template <typename RealType>
+struct analysis_is_dominant
+{
+    typedef bool result_type;
+
+    __host__ __device__
+    bool operator()(const thrust::tuple<RealType,RealType>& t) const
+    {
+        return thrust::get<0>(t) >= thrust::get<1>(t);
+    }
+};
+
+// row lengths, bandwidth, profile and diagonals of a CSR matrix
+template <typename Matrix>
+void analyze_structure(const Matrix& A, matrix_analysis& analysis)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    analysis.num_rows    = A.num_rows;
+    analysis.num_cols    = A.num_cols;
+    analysis.num_entries = A.num_entries;
+
+    analysis.row_length_histogram.assign(1, A.num_rows);
+
+    if (A.num_rows == 0)
+        return;
+
+    analysis.mean_row_length = double(A.num_entries) / double(A.num_rows);
+
+    if (A.num_entries == 0)
+        return;
+
+    // histogram of the row lengths from the ends of the runs of equal lengths
+    cusp::array1d<IndexType,MemorySpace> lengths(A.num_rows);
+    thrust::transform(A.row_offsets.begin() + 1, A.row_offsets.end(), A.row_offsets.begin(), lengths.begin(), thrust::minus<IndexType>());
+    thrust::sort(lengths.begin(), lengths.end());
+
+    const IndexType min_length = lengths[0];
+    const IndexType max_length = lengths[A.num_rows - 1];
+
+    cusp::array1d<IndexType,MemorySpace> counts(max_length + 1);
+    thrust::upper_bound(lengths.begin(), lengths.end(),
+                        thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(max_length + 1),
+                        counts.begin());
+    thrust::adjacent_difference(counts.begin(), counts.end(), counts.begin());
+
+    const cusp::array1d<IndexType,cusp::host_memory> h_counts(counts);
+    analysis.row_length_histogram.assign(h_counts.begin(), h_counts.end());
+    analysis.min_row_length = min_length;
+    analysis.max_row_length = max_length;
+
+    // bandwidth from the distances of the entries to the diagonal
+    cusp::array1d<IndexType,MemorySpace> rows(A.num_entries);
+    cusp::detail::offsets_to_indices(A.row_offsets, rows);
+
+    const thrust::tuple<IndexType,IndexType> bandwidth =
+        thrust::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), A.column_indices.begin())),
+                                 thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   A.column_indices.end())),
+                                 analysis_distances<IndexType>(),
+                                 thrust::make_tuple(IndexType(0), IndexType(0)),
+                                 analysis_tuple_maximum<IndexType>());
+
+    analysis.lower_bandwidth = thrust::get<0>(bandwidth);
+    analysis.upper_bandwidth = thrust::get<1>(bandwidth);
+
+    // profile from the first column of each nonempty row
+    cusp::array1d<IndexType,MemorySpace> keys(A.num_rows);
+    cusp::array1d<IndexType,MemorySpace> first(A.num_rows);
+
+    const size_t num_nonempty_rows =
+        thrust::reduce_by_key(rows.begin(), rows.end(), A.column_indices.begin(),
+                              keys.begin(), first.begin(),
+                              thrust::equal_to<IndexType>(),
+                              thrust::minimum<IndexType>()).first - keys.begin();
+
+    analysis.profile =
+        thrust::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(keys.begin(), first.begin())),
+                                 thrust::make_zip_iterator(thrust::make_tuple(keys.begin(), first.begin())) + num_nonempty_rows,
+                                 analysis_envelope<IndexType>(),
+                                 size_t(0),
+                                 thrust::plus<size_t>());
+
+    analysis.num_diagonals = count_diagonals(A, MemorySpace());
+}
+
+// symmetry, diagonal dominance and value range of a CSR matrix
+template <typename Matrix>
+void analyze_values(const Matrix& A, matrix_analysis& analysis)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+    typedef typename cusp::norm_type<ValueType>::type RealType;
+
+    analysis.structurally_symmetric = A.num_rows == A.num_cols;
+    analysis.numerically_symmetric  = A.num_rows == A.num_cols;
+
+    if (A.num_entries == 0)
+        return;
+
+    // value range
+    analysis.min_abs_value = thrust::transform_reduce(A.values.begin(), A.values.end(), analysis_absolute<ValueType>(),
+                                                      analysis_absolute<ValueType>()(A.values[0]), thrust::minimum<RealType>());
+    analysis.max_abs_value = thrust::transform_reduce(A.values.begin(), A.values.end(), analysis_absolute<ValueType>(),
+                                                      RealType(0), thrust::maximum<RealType>());
+
+    cusp::array1d<IndexType,MemorySpace> rows(A.num_entries);
+    cusp::detail::offsets_to_indices(A.row_offsets, rows);
+
+    // diagonal dominance from the diagonal and off-diagonal sums of each row
+    {
+        cusp::array1d<IndexType,MemorySpace> keys(A.num_rows);
+        cusp::array1d<RealType,MemorySpace>  diagonal(A.num_rows);
+        cusp::array1d<RealType,MemorySpace>  off_diagonal(A.num_rows);
+
+        const size_t num_nonempty_rows =
+            thrust::reduce_by_key(rows.begin(), rows.end(),
+                                  thrust::make_transform_iterator(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), A.column_indices.begin(), A.values.begin())),
+                                                                  analysis_split_diagonal<IndexType,ValueType>()),
+                                  keys.begin(),
+                                  thrust::make_zip_iterator(thrust::make_tuple(diagonal.begin(), off_diagonal.begin())),
+                                  thrust::equal_to<IndexType>(),
+                                  analysis_tuple_plus<RealType>()).first - keys.begin();
+
+        // empty rows are not dominant
+        analysis.num_dominant_rows =
+            thrust::count_if(thrust::make_zip_iterator(thrust::make_tuple(diagonal.begin(), off_diagonal.begin())),
+                             thrust::make_zip_iterator(thrust::make_tuple(diagonal.begin(), off_diagonal.begin())) + num_nonempty_rows,
+                             analysis_is_dominant<RealType>());
+    }
+
+    if (A.num_rows != A.num_cols)
+        return;
+
+    // symmetry from the entries of A and of its transpose, both in row-major order
+    cusp::array1d<IndexType,MemorySpace> columns(A.column_indices);
+    cusp::array1d<ValueType,MemorySpace> values(A.values);
+    cusp::detail::sort_by_row_and_column(rows, columns, values);
+
+    cusp::array1d<IndexType,MemorySpace> transpose_rows(A.column_indices);
+    cusp::array1d<IndexType,MemorySpace> transpose_columns(A.num_entries);
+    cusp::array1d<ValueType,MemorySpace> transpose_values(A.values);
+    cusp::detail::offsets_to_indices(A.row_offsets, transpose_columns);
+    cusp::detail::sort_by_row_and_column(transpose_rows, transpose_columns, transpose_values);
+
+    analysis.structurally_symmetric =
+        thrust::equal(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin())),
+                      thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   columns.end())),
+                      thrust::make_zip_iterator(thrust::make_tuple(transpose_rows.begin(), transpose_columns.begin())));
+
+    analysis.numerically_symmetric =
+        analysis.structurally_symmetric && thrust::equal(values.begin(), values.end(), transpose_values.begin());
+}
+
+template <typename Matrix>
+void analyze(const Matrix& A, matrix_analysis& analysis, cusp::csr_format)
+{
+    analyze_structure(A, analysis);
+    analyze_values(A, analysis);
+}
+
+template <typename Matrix>
+void analyze(const Matrix& A, matrix_analysis& analysis, cusp::sparse_format)
+{
+    const cusp::csr_matrix<typename Matrix::index_type, typename Matrix::value_type, typename Matrix::memory_space> csr(A);
+
+    analyze(csr, analysis, cusp::csr_format());
+}
+
+template <typename Matrix>
+void analyze(const Matrix& A, matrix_analysis& analysis, cusp::array2d_format)
+{
+    analyze(A, analysis, cusp::sparse_format());
+}
+
+} // end namespace detail
+
+template <typename Matrix>
+matrix_analysis analyze(const Matrix& A)
+{
+    CUSP_PROFILE_SCOPED();
+
+    matrix_analysis analysis;
+
+    cusp::detail::analyze(A, analysis, typename Matrix::format());
+
+    return analysis;
+}
+
+} // end namespace cusp
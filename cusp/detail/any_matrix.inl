@@ -0,0 +1,301 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/exception.h>
+#include <cusp/format.h>
+#include <cusp/multiply.h>
+
+#include <thrust/swap.h>
+#include <thrust/detail/type_traits.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// interface of the matrix stored in an any_matrix
+template <typename ValueType, typename MemorySpace, typename IndexType>
+class any_matrix_base
+{
+  public:
+    typedef cusp::any_matrix<ValueType,MemorySpace,IndexType> matrix_type;
+    typedef typename matrix_type::format_type     format_type;
+    typedef typename matrix_type::view_type       view_type;
+    typedef typename matrix_type::const_view_type const_view_type;
+
+    size_t num_rows;
+    size_t num_cols;
+    size_t num_entries;
+
+    virtual ~any_matrix_base(void) {}
+
+    virtual format_type format(void) const = 0;
+
+    virtual any_matrix_base * clone(void) const = 0;
+
+    virtual any_matrix_base * convert(format_type format) const = 0;
+
+    virtual cusp::format_selection select(const cusp::format_selection_options& options) const = 0;
+
+    virtual void multiply(const const_view_type& x, view_type& y) const = 0;
+};
+
+// container and format_type of a format tag, other formats are stored as CSR
+template <typename ValueType, typename MemorySpace, typename IndexType, typename Format>
+struct any_matrix_member
+{
+    typedef cusp::any_matrix<ValueType,MemorySpace,IndexType> matrix_type;
+    typedef typename matrix_type::csr_matrix_type type;
+    static const typename matrix_type::format_type value = matrix_type::csr;
+};
+
+#define CUSP_ANY_MATRIX_MEMBER(FORMAT)                                                 \
+template <typename ValueType, typename MemorySpace, typename IndexType>                \
+struct any_matrix_member<ValueType,MemorySpace,IndexType,cusp::FORMAT##_format>        \
+{                                                                                      \
+    typedef cusp::any_matrix<ValueType,MemorySpace,IndexType> matrix_type;             \
+    typedef typename matrix_type::FORMAT##_matrix_type type;                           \
+    static const typename matrix_type::format_type value = matrix_type::FORMAT;        \
+};
+
+CUSP_ANY_MATRIX_MEMBER(coo)
+CUSP_ANY_MATRIX_MEMBER(dia)
+CUSP_ANY_MATRIX_MEMBER(ell)
+CUSP_ANY_MATRIX_MEMBER(hyb)
+
+#undef CUSP_ANY_MATRIX_MEMBER
+
+template <typename Matrix, typename ValueType, typename MemorySpace, typename IndexType>
+class any_matrix_holder : public any_matrix_base<ValueType,MemorySpace,IndexType>
+{
+    typedef any_matrix_base<ValueType,MemorySpace,IndexType> Parent;
+    typedef typename Parent::matrix_type matrix_type;
+  public:
+    typedef typename Parent::format_type     format_type;
+    typedef typename Parent::view_type       view_type;
+    typedef typename Parent::const_view_type const_view_type;
+
+    Matrix matrix;
+
+    template <typename MatrixType>
+    any_matrix_holder(const MatrixType& matrix)
+        : matrix(matrix)
+    {
+        Parent::num_rows    = this->matrix.num_rows;
+        Parent::num_cols    = this->matrix.num_cols;
+        Parent::num_entries = this->matrix.num_entries;
+    }
+
+    format_type format(void) const
+    {
+        return any_matrix_member<ValueType,MemorySpace,IndexType,typename Matrix::format>::value;
+    }
+
+    Parent * clone(void) const
+    {
+        return new any_matrix_holder(matrix);
+    }
+
+    Parent * convert(format_type format) const
+    {
+        switch (format)
+        {
+            case matrix_type::coo: return convert_as<typename matrix_type::coo_matrix_type>();
+            case matrix_type::csr: return convert_as<typename matrix_type::csr_matrix_type>();
+            case matrix_type::dia: return convert_as<typename matrix_type::dia_matrix_type>();
+            case matrix_type::ell: return convert_as<typename matrix_type::ell_matrix_type>();
+            case matrix_type::hyb: return convert_as<typename matrix_type::hyb_matrix_type>();
+            default: throw cusp::invalid_input_exception("unknown any_matrix format");
+        }
+    }
+
+    cusp::format_selection select(const cusp::format_selection_options& options) const
+    {
+        return cusp::select_format(matrix, options);
+    }
+
+    void multiply(const const_view_type& x, view_type& y) const
+    {
+        cusp::multiply(matrix, x, y);
+    }
+
+  private:
+    template <typename MatrixType>
+    Parent * convert_as(void) const
+    {
+        return new any_matrix_holder<MatrixType,ValueType,MemorySpace,IndexType>(matrix);
+    }
+};
+
+// store a copy of a matrix, converted to its container in MemorySpace
+template <typename ValueType, typename MemorySpace, typename IndexType, typename MatrixType>
+any_matrix_base<ValueType,MemorySpace,IndexType> *
+make_any_matrix(const MatrixType& matrix)
+{
+    typedef typename any_matrix_member<ValueType,MemorySpace,IndexType,typename MatrixType::format>::type Container;
+
+    return new any_matrix_holder<Container,ValueType,MemorySpace,IndexType>(matrix);
+}
+
+} // end namespace detail
+
+//////////////////
+// Constructors //
+//////////////////
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+any_matrix<ValueType,MemorySpace,IndexType>
+    ::any_matrix(void)
+    : matrix(0)
+    {
+        reset(cusp::detail::make_any_matrix<ValueType,MemorySpace,IndexType>(csr_matrix_type()));
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template <typename MatrixType>
+any_matrix<ValueType,MemorySpace,IndexType>
+    ::any_matrix(const MatrixType& matrix)
+    : matrix(0)
+    {
+        reset(cusp::detail::make_any_matrix<ValueType,MemorySpace,IndexType>(matrix));
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+any_matrix<ValueType,MemorySpace,IndexType>
+    ::any_matrix(const any_matrix& matrix)
+    : Parent(), matrix(0)
+    {
+        reset(matrix.matrix->clone());
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+any_matrix<ValueType,MemorySpace,IndexType>
+    ::~any_matrix(void)
+    {
+        delete matrix;
+    }
+
+//////////////////////
+// Member Functions //
+//////////////////////
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    any_matrix<ValueType,MemorySpace,IndexType>&
+    any_matrix<ValueType,MemorySpace,IndexType>
+    ::operator=(const any_matrix& matrix)
+    {
+        if (this != &matrix)
+            reset(matrix.matrix->clone());
+
+        return *this;
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template <typename MatrixType>
+    any_matrix<ValueType,MemorySpace,IndexType>&
+    any_matrix<ValueType,MemorySpace,IndexType>
+    ::operator=(const MatrixType& matrix)
+    {
+        reset(cusp::detail::make_any_matrix<ValueType,MemorySpace,IndexType>(matrix));
+
+        return *this;
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    void
+    any_matrix<ValueType,MemorySpace,IndexType>
+    ::swap(any_matrix& matrix)
+    {
+        Parent::swap(matrix);
+        thrust::swap(this->matrix, matrix.matrix);
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    typename any_matrix<ValueType,MemorySpace,IndexType>::format_type
+    any_matrix<ValueType,MemorySpace,IndexType>
+    ::stored_format(void) const
+    {
+        return matrix->format();
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    void
+    any_matrix<ValueType,MemorySpace,IndexType>
+    ::convert_to(format_type format)
+    {
+        if (format != stored_format())
+            reset(matrix->convert(format));
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    format_selection
+    any_matrix<ValueType,MemorySpace,IndexType>
+    ::select_format(const format_selection_options& options)
+    {
+        const format_selection selection = matrix->select(options);
+
+        switch (selection.format)
+        {
+            case format_selection::csr: convert_to(csr); break;
+            case format_selection::dia: convert_to(dia); break;
+            case format_selection::ell: convert_to(ell); break;
+            case format_selection::hyb: convert_to(hyb); break;
+            default: break;
+        }
+
+        return selection;
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template <typename MatrixType>
+    const MatrixType&
+    any_matrix<ValueType,MemorySpace,IndexType>
+    ::get(void) const
+    {
+        typedef cusp::detail::any_matrix_member<ValueType,MemorySpace,IndexType,typename MatrixType::format> Member;
+        typedef cusp::detail::any_matrix_holder<MatrixType,ValueType,MemorySpace,IndexType> Holder;
+
+        if (!thrust::detail::is_same<MatrixType, typename Member::type>::value || Member::value != stored_format())
+            throw cusp::invalid_input_exception("any_matrix does not store a matrix of the requested type");
+
+        return static_cast<const Holder *>(matrix)->matrix;
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template <typename VectorType1, typename VectorType2>
+    void
+    any_matrix<ValueType,MemorySpace,IndexType>
+    ::operator()(const VectorType1& x, VectorType2& y) const
+    {
+        const_view_type x_view(x.begin(), x.end());
+        view_type       y_view(y.begin(), y.end());
+
+        matrix->multiply(x_view, y_view);
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    void
+    any_matrix<ValueType,MemorySpace,IndexType>
+    ::reset(base_type * new_matrix)
+    {
+        delete matrix;
+        matrix = new_matrix;
+
+        Parent::resize(matrix->num_rows, matrix->num_cols, matrix->num_entries);
+    }
+
+} // end namespace cusp
@@ -0,0 +1,204 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/copy.h>
+#include <cusp/exception.h>
+
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/device/assemble.h>
+
+#include <thrust/extrema.h>
+#include <thrust/fill.h>
+#include <thrust/functional.h>
+#include <thrust/scan.h>
+#include <thrust/scatter.h>
+#include <thrust/sequence.h>
+#include <thrust/transform.h>
+#include <thrust/tuple.h>
+#include <thrust/unique.h>
+
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// (row, column) of entry t of the element matrices
+template <typename IndexType>
+struct element_entry_functor
+{
+    const IndexType * connectivity;
+    IndexType nodes_per_element;
+
+    element_entry_functor(const IndexType * connectivity, IndexType nodes_per_element)
+        : connectivity(connectivity), nodes_per_element(nodes_per_element) {}
+
+    __host__ __device__
+    thrust::tuple<IndexType,IndexType> operator()(const IndexType t) const
+    {
+        const IndexType size    = nodes_per_element * nodes_per_element;
+        const IndexType element = t / size;
+        const IndexType a       = (t % size) / nodes_per_element;
+        const IndexType b       = (t % size) % nodes_per_element;
+
+        return thrust::make_tuple(connectivity[element * nodes_per_element + a],
+                                  connectivity[element * nodes_per_element + b]);
+    }
+};
+
+template <typename Array1, typename Array2, typename Array3>
+void assemble_scatter_add(const Array1& slots, const Array2& x, Array3& y, cusp::host_memory)
+{
+    for (size_t n = 0; n < slots.size(); n++)
+        y[slots[n]] += x[n];
+}
+
+template <typename Array1, typename Array2, typename Array3>
+void assemble_scatter_add(const Array1& slots, const Array2& x, Array3& y, cusp::device_memory)
+{
+    if (slots.size() == 0)
+        return;
+
+    cusp::detail::device::assemble_scatter_add(slots.size(),
+                                               thrust::raw_pointer_cast(&slots[0]),
+                                               thrust::raw_pointer_cast(&x[0]),
+                                               thrust::raw_pointer_cast(&y[0]));
+}
+
+} // end namespace detail
+
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename Array>
+assembler<IndexType,ValueType,MemorySpace>
+::assembler(const size_t num_nodes, const size_t nodes_per_element, const Array& connectivity)
+{
+    setup(num_nodes, nodes_per_element, connectivity);
+}
+
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename Array>
+void assembler<IndexType,ValueType,MemorySpace>
+::setup(const size_t num_nodes, const size_t nodes_per_element, const Array& connectivity)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename cusp::detail::temporary_memory_space<IndexType,MemorySpace>::type TemporarySpace;
+
+    if (nodes_per_element == 0 || connectivity.size() % nodes_per_element != 0)
+        throw cusp::invalid_input_exception("connectivity size is not a multiple of nodes_per_element");
+
+    this->num_nodes         = num_nodes;
+    this->nodes_per_element = nodes_per_element;
+    this->num_elements      = connectivity.size() / nodes_per_element;
+
+    const size_t N = num_elements * nodes_per_element * nodes_per_element;
+
+    row_offsets.resize(num_nodes + 1);
+    slots.resize(N);
+
+    if (N == 0)
+    {
+        thrust::fill(row_offsets.begin(), row_offsets.end(), IndexType(0));
+        column_indices.resize(0);
+        return;
+    }
+
+    cusp::array1d<IndexType,TemporarySpace> nodes(connectivity);
+
+    if (*thrust::min_element(nodes.begin(), nodes.end()) < IndexType(0) ||
+        size_t(*thrust::max_element(nodes.begin(), nodes.end())) >= num_nodes)
+        throw cusp::invalid_input_exception("connectivity references a node out of range");
+
+    // (row, column) of every element entry, sorted with their positions
+    cusp::array1d<IndexType,TemporarySpace> rows(N);
+    cusp::array1d<IndexType,TemporarySpace> columns(N);
+    cusp::array1d<IndexType,TemporarySpace> permutation(N);
+
+    thrust::transform(thrust::counting_iterator<IndexType>(0),
+                      thrust::counting_iterator<IndexType>(N),
+                      thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin())),
+                      cusp::detail::element_entry_functor<IndexType>(thrust::raw_pointer_cast(&nodes[0]), IndexType(nodes_per_element)));
+
+    thrust::sequence(permutation.begin(), permutation.end());
+
+    cusp::detail::sort_by_row_and_column(rows, columns, permutation, num_nodes, num_nodes);
+
+    // number the distinct (row, column) pairs and map each entry to its pair
+    cusp::array1d<IndexType,TemporarySpace> sorted_slots(N);
+
+    sorted_slots[0] = 0;
+    thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin())) + 1,
+                      thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   columns.end())),
+                      thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin())),
+                      sorted_slots.begin() + 1,
+                      thrust::not_equal_to< thrust::tuple<IndexType,IndexType> >());
+    thrust::inclusive_scan(sorted_slots.begin(), sorted_slots.end(), sorted_slots.begin());
+
+    thrust::scatter(sorted_slots.begin(), sorted_slots.end(), permutation.begin(), slots.begin());
+
+    // pattern of the distinct pairs
+    const size_t num_entries = size_t(sorted_slots[N - 1]) + 1;
+
+    cusp::array1d<IndexType,TemporarySpace> row_indices(num_entries);
+    column_indices.resize(num_entries);
+
+    thrust::unique_copy(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin())),
+                        thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   columns.end())),
+                        thrust::make_zip_iterator(thrust::make_tuple(row_indices.begin(), column_indices.begin())));
+
+    cusp::detail::indices_to_offsets(row_indices, row_offsets);
+}
+
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+void assembler<IndexType,ValueType,MemorySpace>
+::initialize(MatrixType& A) const
+{
+    typedef typename MatrixType::value_type MatrixValueType;
+
+    A.resize(num_nodes, num_nodes, num_entries());
+
+    cusp::copy(row_offsets,    A.row_offsets);
+    cusp::copy(column_indices, A.column_indices);
+    thrust::fill(A.values.begin(), A.values.end(), MatrixValueType(0));
+}
+
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename Array, typename MatrixType>
+void assembler<IndexType,ValueType,MemorySpace>
+::assemble(const Array& element_values, MatrixType& A) const
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename MatrixType::value_type MatrixValueType;
+
+    if (element_values.size() != slots.size())
+        throw cusp::invalid_input_exception("element_values size does not match the mesh");
+
+    if (A.num_rows != num_nodes || A.num_cols != num_nodes || A.num_entries != num_entries())
+        initialize(A);
+    else
+        thrust::fill(A.values.begin(), A.values.end(), MatrixValueType(0));
+
+    cusp::detail::assemble_scatter_add(slots, element_values, A.values,
+                                       typename cusp::array1d<IndexType,MemorySpace>::memory_space());
+}
+
+} // end namespace cusp
@@ -0,0 +1,358 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/analyze.h>
+#include <cusp/array1d.h>
+#include <cusp/convert.h>
+#include <cusp/multiply.h>
+
+#include <cusp/detail/timer.h>
+#include <cusp/detail/host/conversion.h>
+#include <cusp/detail/device/conversion.h>
+
+#include <thrust/detail/type_traits.h>
+
+#include <algorithm>
+#include <ctime>
+
+namespace cusp
+{
+namespace detail
+{
+
+// convert a CSR matrix to the selected format without recomputing the
+// statistics that were gathered by the selection
+template <typename Matrix1, typename Matrix2>
+void convert_to_selection(const Matrix1& src, Matrix2& dst, const format_selection& selection, cusp::host_memory)
+{
+    switch (selection.format)
+    {
+        case format_selection::csr: cusp::copy(src, dst.csr); break;
+        case format_selection::dia: cusp::detail::host::csr_to_dia(src, dst.dia); break;
+        case format_selection::ell: cusp::detail::host::csr_to_ell(src, dst.ell, selection.max_entries_per_row); break;
+        case format_selection::hyb: cusp::detail::host::csr_to_hyb(src, dst.hyb, selection.hyb_entries_per_row); break;
+        default: break;
+    }
+}
+
+template <typename Matrix1, typename Matrix2>
+void convert_to_selection(const Matrix1& src, Matrix2& dst, const format_selection& selection, cusp::device_memory)
+{
+    switch (selection.format)
+    {
+        case format_selection::csr: cusp::copy(src, dst.csr); break;
+        case format_selection::dia: cusp::detail::device::csr_to_dia(src, dst.dia); break;
+        case format_selection::ell: cusp::detail::device::csr_to_ell(src, dst.ell, selection.max_entries_per_row); break;
+        case format_selection::hyb: cusp::detail::device::csr_to_hyb(src, dst.hyb, selection.hyb_entries_per_row); break;
+        default: break;
+    }
+}
+
+inline const char * benchmark_profile_name(const format_selection::format_type format)
+{
+    switch (format)
+    {
+        case format_selection::csr: return "select_format benchmark csr";
+        case format_selection::dia: return "select_format benchmark dia";
+        case format_selection::ell: return "select_format benchmark ell";
+        case format_selection::hyb: return "select_format benchmark hyb";
+        default: return "select_format benchmark";
+    }
+}
+
+// time SpMV with A in milliseconds per multiplication
+template <typename Matrix>
+double time_spmv(const Matrix& A, size_t iterations, cusp::host_memory)
+{
+    typedef typename Matrix::value_type ValueType;
+
+    cusp::array1d<ValueType, cusp::host_memory> x(A.num_cols, ValueType(1));
+    cusp::array1d<ValueType, cusp::host_memory> y(A.num_rows);
+
+    cusp::multiply(A, x, y); // warmup
+
+    std::clock_t start = std::clock();
+    for(size_t i = 0; i < iterations; i++)
+        cusp::multiply(A, x, y);
+    std::clock_t end = std::clock();
+
+    return 1000.0 * double(end - start) / double(CLOCKS_PER_SEC) / double(iterations);
+}
+
+template <typename Matrix>
+double time_spmv(const Matrix& A, size_t iterations, cusp::device_memory)
+{
+    typedef typename Matrix::value_type ValueType;
+
+    cusp::array1d<ValueType, cusp::device_memory> x(A.num_cols, ValueType(1));
+    cusp::array1d<ValueType, cusp::device_memory> y(A.num_rows);
+
+    cusp::multiply(A, x, y); // warmup
+
+    cusp::detail::timer t;
+    t.unpause();
+    for(size_t i = 0; i < iterations; i++)
+        cusp::multiply(A, x, y);
+    t.stop();
+
+    return t.milliseconds / double(iterations);
+}
+
+template <typename Matrix>
+format_selection select_format_csr(const Matrix& csr, const format_selection_options& options)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    format_selection selection;
+
+    matrix_analysis analysis;
+    analyze_structure(csr, analysis);
+
+    selection.max_entries_per_row = analysis.max_row_length;
+    selection.num_diagonals       = analysis.num_diagonals;
+    selection.hyb_entries_per_row = analysis.hyb_entries_per_row(options.relative_speed, options.breakeven_threshold);
+
+    const double I = sizeof(IndexType);
+    const double V = sizeof(ValueType);
+
+    const double num_rows    = csr.num_rows;
+    const double num_entries = csr.num_entries;
+
+    // storage of the DIA and ELL formats, padding included
+    const double dia_size = double(selection.num_diagonals)       * num_rows;
+    const double ell_size = double(selection.max_entries_per_row) * num_rows;
+
+    // the tolerance and threshold used by cusp::convert
+    const double threshold = 1e6; // 1M entries
+    const double max_size  = double(options.max_fill) * std::max(1.0, num_entries);
+
+    selection.admissible[format_selection::csr] = true;
+    selection.admissible[format_selection::dia] = dia_size <= max_size || dia_size <= threshold;
+    selection.admissible[format_selection::ell] = ell_size <= max_size || ell_size <= threshold;
+    selection.admissible[format_selection::hyb] = true;
+
+    // row offsets, column indices, A[i,j] and x[j], y[i]
+    selection.bytes[format_selection::csr] = 2 * I * num_rows + (I + 2 * V) * num_entries + 2 * V * num_rows;
+
+    // padded A[i,j], x[j] of the entries, y[i]
+    selection.bytes[format_selection::dia] = V * dia_size + V * num_entries + 2 * V * num_rows;
+
+    // padded column indices and A[i,j], x[j] of the entries, y[i]
+    selection.bytes[format_selection::ell] = (I + V) * ell_size + V * num_entries + 2 * V * num_rows;
+
+    // ELL part as above, COO part with row and column indices
+    {
+        const double ell_entries = analysis.ell_entries(selection.hyb_entries_per_row);
+        const double coo_entries = num_entries - ell_entries;
+
+        selection.bytes[format_selection::hyb] =
+            (I + V) * double(selection.hyb_entries_per_row) * num_rows + V * ell_entries +
+            (2 * I + 2 * V) * coo_entries + 2 * V * std::min(num_rows, coo_entries) +
+            2 * V * num_rows;
+    }
+
+    selection.format = format_selection::csr;
+
+    if (options.benchmark)
+    {
+        for(int i = 0; i < format_selection::num_formats; i++)
+        {
+            if (!selection.admissible[i])
+                continue;
+
+            format_selection candidate = selection;
+            candidate.format = format_selection::format_type(i);
+
+            cusp::auto_format_matrix<IndexType,ValueType,MemorySpace> A;
+            convert_to_selection(csr, A, candidate, MemorySpace());
+            A.selection = candidate;
+            A.resize(csr.num_rows, csr.num_cols, csr.num_entries);
+
+            const size_t iterations = std::max<size_t>(1, options.benchmark_iterations);
+
+            // a scope per format carries the estimated traffic, so that the
+            // profiler reports the bandwidth achieved by each format
+            CUSP_PROFILE_SCOPED_NAME(benchmark_profile_name(candidate.format));
+            CUSP_PROFILE_BYTES(size_t(selection.bytes[i]) * iterations);
+
+            selection.milliseconds[i] = time_spmv(A, iterations, MemorySpace());
+
+            if (selection.milliseconds[i] < selection.milliseconds[selection.format])
+                selection.format = candidate.format;
+        }
+    }
+    else
+    {
+        for(int i = 0; i < format_selection::num_formats; i++)
+            if (selection.admissible[i] && selection.bytes[i] < selection.bytes[selection.format])
+                selection.format = format_selection::format_type(i);
+    }
+
+    return selection;
+}
+
+template <typename Matrix>
+format_selection select_format(const Matrix& A, const format_selection_options& options, thrust::detail::true_type)
+{
+    return select_format_csr(A, options);
+}
+
+template <typename Matrix>
+format_selection select_format(const Matrix& A, const format_selection_options& options, thrust::detail::false_type)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> csr(A);
+
+    return select_format_csr(csr, options);
+}
+
+// store src in the format of a given selection, e.g. one that was
+// benchmarked for a matrix of the same structure
+template <typename Matrix1, typename Matrix2>
+void convert_to_given_selection(const Matrix1& src, Matrix2& dst, const format_selection& selection, thrust::detail::true_type)
+{
+    dst.selection = selection;
+
+    convert_to_selection(src, dst, dst.selection, typename Matrix2::memory_space());
+
+    dst.resize(src.num_rows, src.num_cols, src.num_entries);
+}
+
+template <typename Matrix1, typename Matrix2>
+void convert_to_given_selection(const Matrix1& src, Matrix2& dst, const format_selection& selection, thrust::detail::false_type)
+{
+    typename Matrix2::csr_matrix_type csr(src);
+
+    convert_to_given_selection(csr, dst, selection, thrust::detail::true_type());
+}
+
+template <typename Matrix1, typename Matrix2>
+void select_and_convert(const Matrix1& src, Matrix2& dst, thrust::detail::true_type)
+{
+    dst.selection = select_format_csr(src, dst.options);
+
+    convert_to_selection(src, dst, dst.selection, typename Matrix2::memory_space());
+
+    dst.resize(src.num_rows, src.num_cols, src.num_entries);
+}
+
+template <typename Matrix1, typename Matrix2>
+void select_and_convert(const Matrix1& src, Matrix2& dst, thrust::detail::false_type)
+{
+    typename Matrix2::csr_matrix_type csr(src);
+
+    dst.selection = select_format_csr(csr, dst.options);
+
+    dst.resize(csr.num_rows, csr.num_cols, csr.num_entries);
+
+    if (dst.selection.format == format_selection::csr)
+        dst.csr.swap(csr);
+    else
+        convert_to_selection(csr, dst, dst.selection, typename Matrix2::memory_space());
+}
+
+} // end namespace detail
+
+template <typename Matrix>
+format_selection select_format(const Matrix& A, const format_selection_options& options)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    return cusp::detail::select_format(A, options,
+        typename thrust::detail::is_same<Matrix, cusp::csr_matrix<IndexType,ValueType,MemorySpace> >::type());
+}
+
+//////////////////
+// Constructors //
+//////////////////
+
+// construct from a different matrix
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+auto_format_matrix<IndexType,ValueType,MemorySpace>
+    ::auto_format_matrix(const MatrixType& matrix)
+    {
+        cusp::convert(matrix, *this);
+    }
+
+// construct from a different matrix with given selection parameters
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+auto_format_matrix<IndexType,ValueType,MemorySpace>
+    ::auto_format_matrix(const MatrixType& matrix, const format_selection_options& options)
+    : options(options)
+    {
+        select(matrix);
+    }
+
+//////////////////////
+// Member Functions //
+//////////////////////
+
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+    void
+    auto_format_matrix<IndexType,ValueType,MemorySpace>
+    ::select(const MatrixType& matrix)
+    {
+        // release the storage of the previous format
+        csr_matrix_type().swap(csr);
+        dia_matrix_type().swap(dia);
+        ell_matrix_type().swap(ell);
+        hyb_matrix_type().swap(hyb);
+
+        cusp::detail::select_and_convert(matrix, *this,
+            typename thrust::detail::is_same<MatrixType, csr_matrix_type>::type());
+    }
+
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+    void
+    auto_format_matrix<IndexType,ValueType,MemorySpace>
+    ::select(const MatrixType& matrix, const selection_type& selection)
+    {
+        // release the storage of the previous format
+        csr_matrix_type().swap(csr);
+        dia_matrix_type().swap(dia);
+        ell_matrix_type().swap(ell);
+        hyb_matrix_type().swap(hyb);
+
+        cusp::detail::convert_to_given_selection(matrix, *this, selection,
+            typename thrust::detail::is_same<MatrixType, csr_matrix_type>::type());
+    }
+
+// assignment from another matrix
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+    auto_format_matrix<IndexType,ValueType,MemorySpace>&
+    auto_format_matrix<IndexType,ValueType,MemorySpace>
+    ::operator=(const MatrixType& matrix)
+    {
+        cusp::convert(matrix, *this);
+
+        return *this;
+    }
+
+} // end namespace cusp
@@ -0,0 +1,101 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/convert.h>
+
+#include <thrust/copy.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// entry of the pattern whose value is stored at a position of values.values
+template <typename IndexType>
+struct batched_csr_entry_functor
+{
+    IndexType pitch;
+
+    batched_csr_entry_functor(IndexType pitch) : pitch(pitch) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType n) const
+    {
+        return n / pitch;
+    }
+};
+
+} // end namespace detail
+
+//////////////////
+// Constructors //
+//////////////////
+
+// construct from another batched_csr_matrix
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+batched_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::batched_csr_matrix(const MatrixType& matrix)
+    : num_batches(0)
+    {
+        cusp::convert(matrix, *this);
+    }
+
+// construct from the pattern and values of a CSR matrix
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+batched_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::batched_csr_matrix(const MatrixType& pattern, size_t num_batches)
+    : Parent(num_batches * pattern.num_rows, num_batches * pattern.num_cols, num_batches * pattern.num_entries),
+      num_batches(num_batches),
+      row_offsets(pattern.row_offsets),
+      column_indices(pattern.column_indices),
+      values(pattern.num_entries, num_batches)
+    {
+        if (values.values.size() == 0)
+            return;
+
+        const cusp::array1d<ValueType, MemorySpace> pattern_values(pattern.values);
+
+        thrust::copy(thrust::make_permutation_iterator(pattern_values.begin(),
+                         thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0),
+                                                         cusp::detail::batched_csr_entry_functor<IndexType>(values.pitch))),
+                     thrust::make_permutation_iterator(pattern_values.begin(),
+                         thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(values.values.size()),
+                                                         cusp::detail::batched_csr_entry_functor<IndexType>(values.pitch))),
+                     values.values.begin());
+    }
+
+//////////////////////
+// Member Functions //
+//////////////////////
+
+// assignment from another batched_csr_matrix
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+    batched_csr_matrix<IndexType,ValueType,MemorySpace>&
+    batched_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::operator=(const MatrixType& matrix)
+    {
+        cusp::convert(matrix, *this);
+
+        return *this;
+    }
+
+} // end namespace cusp
@@ -0,0 +1,242 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/exception.h>
+#include <cusp/detail/profiler.h>
+#include <cusp/detail/device/spmv/batched_csr.h>
+
+#include <thrust/fill.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// items stored one after the other, with local column indices
+template <typename IndexType, typename OffsetType1, typename OffsetType2>
+struct batched_concatenated_layout
+{
+    const OffsetType1 * row_offsets;
+    const OffsetType2 * column_offsets;
+
+    batched_concatenated_layout(const OffsetType1 * row_offsets, const OffsetType2 * column_offsets)
+        : row_offsets(row_offsets), column_offsets(column_offsets) {}
+
+    __host__ __device__ IndexType row_begin(const IndexType item) const { return row_offsets[item]; }
+    __host__ __device__ IndexType row_end(const IndexType item)   const { return row_offsets[item + 1]; }
+
+    __host__ __device__ size_t column_offset(const IndexType item) const { return column_offsets[item]; }
+    __host__ __device__ size_t value_offset(const IndexType)       const { return 0; }
+    __host__ __device__ size_t value_stride(void)                 const { return 1; }
+
+    __host__ __device__ IndexType pattern_row(const IndexType, const IndexType row) const { return row; }
+};
+
+// items sharing a num_rows x num_cols pattern, the values of item b are
+// row b of a dense array
+template <typename IndexType>
+struct batched_uniform_layout
+{
+    IndexType num_rows;
+    IndexType num_cols;
+    size_t batch_stride;
+    size_t entry_stride;
+
+    batched_uniform_layout(IndexType num_rows, IndexType num_cols, size_t batch_stride, size_t entry_stride)
+        : num_rows(num_rows), num_cols(num_cols), batch_stride(batch_stride), entry_stride(entry_stride) {}
+
+    __host__ __device__ IndexType row_begin(const IndexType item) const { return item * num_rows; }
+    __host__ __device__ IndexType row_end(const IndexType item)   const { return (item + 1) * num_rows; }
+
+    __host__ __device__ size_t column_offset(const IndexType item) const { return size_t(item) * num_cols; }
+    __host__ __device__ size_t value_offset(const IndexType item)  const { return size_t(item) * batch_stride; }
+    __host__ __device__ size_t value_stride(void)                 const { return entry_stride; }
+
+    __host__ __device__ IndexType pattern_row(const IndexType item, const IndexType row) const { return row - item * num_rows; }
+};
+
+template <typename IndexType, typename ValueType, typename Layout>
+void batched_spmv(const IndexType  num_items,
+                  const size_t     num_rows,
+                  const IndexType* Ap,
+                  const IndexType* Aj,
+                  const ValueType* Ax,
+                  const ValueType* x,
+                        ValueType* y,
+                  Layout           layout,
+                  cusp::host_memory)
+{
+    for (IndexType item = 0; item < num_items; item++)
+    {
+        const ValueType * xb = x + layout.column_offset(item);
+        const ValueType * Ab = Ax + layout.value_offset(item);
+        const size_t stride  = layout.value_stride();
+
+        for (IndexType row = layout.row_begin(item); row < layout.row_end(item); row++)
+        {
+            const IndexType p = layout.pattern_row(item, row);
+
+            ValueType sum = 0;
+
+            for (IndexType jj = Ap[p]; jj < Ap[p + 1]; jj++)
+                sum += Ab[jj * stride] * xb[Aj[jj]];
+
+            y[row] = sum;
+        }
+    }
+}
+
+template <typename IndexType, typename ValueType, typename Layout>
+void batched_spmv(const IndexType  num_items,
+                  const size_t     num_rows,
+                  const IndexType* Ap,
+                  const IndexType* Aj,
+                  const ValueType* Ax,
+                  const ValueType* x,
+                        ValueType* y,
+                  Layout           layout,
+                  cusp::device_memory)
+{
+    cusp::detail::device::spmv_batched_csr(num_items, num_rows, Ap, Aj, Ax, x, y, layout);
+}
+
+template <typename Array>
+size_t last_offset(const Array& offsets)
+{
+    return offsets[offsets.size() - 1];
+}
+
+} // end namespace detail
+
+template <typename Matrix,
+          typename IndexArray,
+          typename Array1,
+          typename Array2>
+void batched_multiply(const Matrix&     A,
+                      const IndexArray& batch_offsets,
+                      const Array1&     x,
+                            Array2&     y)
+{
+    cusp::batched_multiply(A, batch_offsets, batch_offsets, x, y);
+}
+
+template <typename Matrix,
+          typename IndexArray1,
+          typename IndexArray2,
+          typename Array1,
+          typename Array2>
+void batched_multiply(const Matrix&      A,
+                      const IndexArray1& row_offsets,
+                      const IndexArray2& column_offsets,
+                      const Array1&      x,
+                            Array2&      y)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix::index_type    IndexType;
+    typedef typename Matrix::value_type    ValueType;
+    typedef typename Matrix::memory_space  MemorySpace;
+    typedef typename IndexArray1::value_type OffsetType1;
+    typedef typename IndexArray2::value_type OffsetType2;
+
+    if (row_offsets.size() == 0 || row_offsets.size() != column_offsets.size())
+        throw cusp::invalid_input_exception("row and column batch offsets must have num_items + 1 entries");
+
+    if (cusp::detail::last_offset(row_offsets) != A.num_rows || y.size() != A.num_rows)
+        throw cusp::invalid_input_exception("batch offsets must span the rows of the matrix and the result");
+
+    if (cusp::detail::last_offset(column_offsets) != x.size())
+        throw cusp::invalid_input_exception("batch offsets must span the operand");
+
+    const IndexType num_items = row_offsets.size() - 1;
+
+    if (num_items == 0 || A.num_rows == 0)
+        return;
+
+    if (A.num_entries == 0)
+    {
+        thrust::fill(y.begin(), y.end(), ValueType(0));
+        return;
+    }
+
+    cusp::detail::batched_concatenated_layout<IndexType, OffsetType1, OffsetType2>
+        layout(thrust::raw_pointer_cast(&row_offsets[0]), thrust::raw_pointer_cast(&column_offsets[0]));
+
+    cusp::detail::batched_spmv(num_items,
+                               A.num_rows,
+                               thrust::raw_pointer_cast(&A.row_offsets[0]),
+                               thrust::raw_pointer_cast(&A.column_indices[0]),
+                               thrust::raw_pointer_cast(&A.values[0]),
+                               thrust::raw_pointer_cast(&x[0]),
+                               thrust::raw_pointer_cast(&y[0]),
+                               layout,
+                               MemorySpace());
+}
+
+template <typename Matrix,
+          typename Array2d,
+          typename Array1,
+          typename Array2>
+void batched_multiply_uniform(const Matrix&  pattern,
+                              const Array2d& values,
+                              const Array1&  x,
+                                    Array2&  y)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix::index_type    IndexType;
+    typedef typename Matrix::value_type    ValueType;
+    typedef typename Matrix::memory_space  MemorySpace;
+    typedef typename Array2d::orientation  Orientation;
+
+    const size_t num_items = values.num_rows;
+
+    if (values.num_cols != pattern.num_entries)
+        throw cusp::invalid_input_exception("values must have a column per entry of the pattern");
+
+    if (x.size() != num_items * pattern.num_cols || y.size() != num_items * pattern.num_rows)
+        throw cusp::invalid_input_exception("operand and result must hold a vector per item");
+
+    if (num_items == 0 || pattern.num_rows == 0)
+        return;
+
+    if (pattern.num_entries == 0)
+    {
+        thrust::fill(y.begin(), y.end(), ValueType(0));
+        return;
+    }
+
+    // distance between the values of consecutive items and entries
+    const size_t batch_stride = cusp::detail::index_of(size_t(1), size_t(0), size_t(values.pitch), Orientation());
+    const size_t entry_stride = cusp::detail::index_of(size_t(0), size_t(1), size_t(values.pitch), Orientation());
+
+    cusp::detail::batched_uniform_layout<IndexType>
+        layout(pattern.num_rows, pattern.num_cols, batch_stride, entry_stride);
+
+    cusp::detail::batched_spmv(IndexType(num_items),
+                               num_items * pattern.num_rows,
+                               thrust::raw_pointer_cast(&pattern.row_offsets[0]),
+                               thrust::raw_pointer_cast(&pattern.column_indices[0]),
+                               thrust::raw_pointer_cast(&values.values[0]),
+                               thrust::raw_pointer_cast(&x[0]),
+                               thrust::raw_pointer_cast(&y[0]),
+                               layout,
+                               MemorySpace());
+}
+
+} // end namespace cusp
@@ -0,0 +1,167 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+
+#include <cusp/detail/timer.h>
+
+#include <algorithm>
+#include <ctime>
+#include <cstdio>
+
+namespace cusp
+{
+namespace benchmark
+{
+namespace detail
+{
+
+// milliseconds of one triad a = b + s * c
+template <typename Array>
+double time_triad(const Array& b, const Array& c, Array& a, cusp::host_memory)
+{
+    std::clock_t start = std::clock();
+    cusp::blas::axpby(b, c, a, 1.0, 3.0);
+    std::clock_t end = std::clock();
+
+    return 1000.0 * double(end - start) / double(CLOCKS_PER_SEC);
+}
+
+template <typename Array>
+double time_triad(const Array& b, const Array& c, Array& a, cusp::device_memory)
+{
+    cusp::detail::timer t;
+    t.unpause();
+    cusp::blas::axpby(b, c, a, 1.0, 3.0);
+    t.stop();
+
+    return t.milliseconds;
+}
+
+} // end namespace detail
+
+template <typename MemorySpace>
+double stream_bandwidth(size_t bytes, size_t iterations)
+{
+    CUSP_PROFILE_SCOPED();
+
+    const size_t N = std::max<size_t>(1, bytes / (3 * sizeof(double)));
+
+    cusp::array1d<double, MemorySpace> a(N, 0.0);
+    cusp::array1d<double, MemorySpace> b(N, 1.0);
+    cusp::array1d<double, MemorySpace> c(N, 2.0);
+
+    detail::time_triad(b, c, a, MemorySpace()); // warmup
+
+    double milliseconds = 0;
+
+    for(size_t i = 0; i < std::max<size_t>(1, iterations); i++)
+    {
+        const double t = detail::time_triad(b, c, a, MemorySpace());
+
+        if (i == 0 || t < milliseconds)
+            milliseconds = t;
+    }
+
+    if (milliseconds <= 0)
+        return 0;
+
+    // read b and c, write a
+    return 3.0 * sizeof(double) * double(N) / (1e6 * milliseconds);
+}
+
+template <typename Matrix>
+spmv_profile_result spmv_profile(const Matrix& A, const cusp::format_selection_options& options)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix::memory_space MemorySpace;
+
+    cusp::format_selection_options benchmark_options(options);
+    benchmark_options.benchmark = true;
+
+    spmv_profile_result profile;
+
+    profile.num_rows       = A.num_rows;
+    profile.num_cols       = A.num_cols;
+    profile.num_entries    = A.num_entries;
+    profile.selection      = cusp::select_format(A, benchmark_options);
+    profile.peak_bandwidth = stream_bandwidth<MemorySpace>();
+
+    for(int i = 0; i < cusp::format_selection::num_formats; i++)
+    {
+        spmv_format_profile& format = profile.formats[i];
+
+        format.admissible   = profile.selection.admissible[i];
+        format.bytes        = profile.selection.bytes[i];
+        format.milliseconds = profile.selection.milliseconds[i];
+
+        if (!format.admissible || format.milliseconds <= 0)
+            continue;
+
+        format.gflops    = 2.0 * double(A.num_entries) / (1e6 * format.milliseconds);
+        format.bandwidth = format.bytes / (1e6 * format.milliseconds);
+
+        if (profile.peak_bandwidth > 0)
+            format.efficiency = format.bandwidth / profile.peak_bandwidth;
+    }
+
+    return profile;
+}
+
+inline const char * format_name(const cusp::format_selection::format_type format)
+{
+    switch (format)
+    {
+        case cusp::format_selection::csr: return "csr";
+        case cusp::format_selection::dia: return "dia";
+        case cusp::format_selection::ell: return "ell";
+        case cusp::format_selection::hyb: return "hyb";
+        default: return "unknown";
+    }
+}
+
+inline void print(const spmv_profile_result& profile, std::ostream& output)
+{
+    char line[256];
+
+    output << "SpMV profile of a (" << profile.num_rows << "," << profile.num_cols << ") matrix with "
+           << profile.num_entries << " entries, peak bandwidth " << profile.peak_bandwidth << " GB/s\n";
+
+    for(int i = 0; i < cusp::format_selection::num_formats; i++)
+    {
+        const spmv_format_profile& format = profile.formats[i];
+        const char * name = format_name(cusp::format_selection::format_type(i));
+
+        if (!format.admissible)
+        {
+            sprintf(line, "\t%-4s: not admissible\n", name);
+        }
+        else
+        {
+            sprintf(line, "\t%-4s: %8.4f ms ( %5.2f GFLOP/s %5.1f GB/s %5.1f%% of peak)%s\n",
+                     name, format.milliseconds, format.gflops, format.bandwidth, 100.0 * format.efficiency,
+                     i == profile.selection.format ? " selected" : "");
+        }
+
+        output << line;
+    }
+}
+
+} // end namespace benchmark
+} // end namespace cusp
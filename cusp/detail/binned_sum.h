@@ -0,0 +1,254 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/complex.h>
+
+#include <cmath>
+
+// Reproducible summation.
+//
+// A floating point sum depends on the order of its terms, so a reduction
+// changes in the last bits with the number of blocks, threads or devices.
+// binned_sum makes the sum independent of the order: every term is split
+// into slices that lie on a fixed grid of exponents (bins of WIDTH bits),
+// the slices of a bin are added exactly, and only the final value()
+// rounds.  The grid does not depend on the data, so two partial sums can
+// be combined in any order with the same result.
+//
+// The BINS bins at and below the level of the largest term are kept, at
+// least (BINS - 1) * WIDTH = 60 bits below its leading bit, so the error
+// of a term is far below the rounding of a double precision sum.  The
+// bin sums are exact for up to 2^32 terms, and terms beyond 2^986 lose
+// reproducibility.  Single precision terms are summed in double
+// precision.
+
+namespace cusp
+{
+namespace detail
+{
+
+struct binned_sum
+{
+    static const int BINS  = 4;
+    static const int WIDTH = 20;
+
+    // exponent of the lowest bit of level 0, the levels above add WIDTH
+    static const int MIN_EXPONENT = -1074;
+    static const int MAX_LEVEL    = (1023 - 52 - MIN_EXPONENT) / WIDTH;
+
+    int    level;        // level of bins[0], -1 for an empty sum
+    double bins[BINS];   // bins[k] holds the slices of level - k
+
+    __host__ __device__
+    binned_sum(void) : level(-1)
+    {
+        for (int k = 0; k < BINS; k++)
+            bins[k] = 0;
+    }
+
+    // lowest level whose top bin holds |t|
+    __host__ __device__
+    static int level_of(const double t)
+    {
+        int exponent;
+        frexp(t, &exponent);                    // |t| < 2^exponent
+
+        const int level = (exponent - MIN_EXPONENT + WIDTH - 1) / WIDTH - 1;
+
+        return level < 0 ? 0 : (level > MAX_LEVEL ? MAX_LEVEL : level);
+    }
+
+    // 1.5 * 2^(b + 52) rounds a value of |r| < 2^(b + 51) to a multiple
+    // of 2^b, where b is the exponent of the lowest bit of the level
+    __host__ __device__
+    static double splitter(const int level)
+    {
+        return ldexp(1.5, MIN_EXPONENT + level * WIDTH + 52);
+    }
+
+    // separates the rounding of the sum from the subtraction, which the
+    // host compiler may otherwise contract or reassociate
+    __host__ __device__
+    static double slice(const double sigma, const double r)
+    {
+#if defined(__CUDA_ARCH__)
+        return __dsub_rn(__dadd_rn(sigma, r), sigma);
+#else
+        volatile double rounded = sigma + r;
+        return rounded - sigma;
+#endif
+    }
+
+    __host__ __device__
+    static binned_sum deposit(const double t)
+    {
+        binned_sum s;
+
+        if (t == 0)
+            return s;
+
+        // infinities and NaN propagate through the top bin
+        if (!(t - t == 0))
+        {
+            s.level   = MAX_LEVEL;
+            s.bins[0] = t;
+            return s;
+        }
+
+        s.level = level_of(t);
+
+        double r = t;
+
+        for (int k = 0; k < BINS && s.level - k >= 0; k++)
+        {
+            const double q = slice(splitter(s.level - k), r);
+            s.bins[k] = q;
+            r -= q;
+        }
+
+        return s;
+    }
+
+    // the sum of both, the same for combine(a, b) and combine(b, a)
+    __host__ __device__
+    static binned_sum combine(const binned_sum& a, const binned_sum& b)
+    {
+        binned_sum s = a.level < b.level ? b : a;
+        const binned_sum& t = a.level < b.level ? a : b;
+
+        if (t.level < 0)
+            return s;
+
+        for (int k = s.level - t.level; k < BINS; k++)
+            s.bins[k] += t.bins[k - (s.level - t.level)];
+
+        return s;
+    }
+
+    __host__ __device__
+    double value(void) const
+    {
+        double sum = 0;
+
+        for (int k = BINS - 1; k >= 0; k--)
+            sum += bins[k];
+
+        return sum;
+    }
+};
+
+// the product a * b rounded once, which a compiler may not fuse into the
+// slicing of the product
+__host__ __device__
+inline double binned_product(const double a, const double b)
+{
+#if defined(__CUDA_ARCH__)
+    return __dmul_rn(a, b);
+#else
+    volatile double product = a * b;
+    return product;
+#endif
+}
+
+// binned_accumulator<T> sums values of type T with binned_sum, complex
+// values with one binned_sum per component
+template <typename T>
+struct binned_accumulator
+{
+    typedef binned_sum type;
+
+    __host__ __device__
+    static type deposit(const T t)
+    {
+        return binned_sum::deposit(double(t));
+    }
+
+    // a * b
+    __host__ __device__
+    static type product(const T a, const T b)
+    {
+        return binned_sum::deposit(binned_product(double(a), double(b)));
+    }
+
+    __host__ __device__
+    static type combine(const type& a, const type& b)
+    {
+        return binned_sum::combine(a, b);
+    }
+
+    __host__ __device__
+    static T value(const type& s)
+    {
+        return T(s.value());
+    }
+};
+
+struct binned_complex_sum
+{
+    binned_sum real;
+    binned_sum imag;
+};
+
+template <typename T>
+struct binned_accumulator< cusp::complex<T> >
+{
+    typedef binned_complex_sum type;
+
+    __host__ __device__
+    static type deposit(const cusp::complex<T> t)
+    {
+        type s;
+        s.real = binned_sum::deposit(double(t.real()));
+        s.imag = binned_sum::deposit(double(t.imag()));
+        return s;
+    }
+
+    // a * b, the partial products of a component are summed exactly
+    __host__ __device__
+    static type product(const cusp::complex<T> a, const cusp::complex<T> b)
+    {
+        const double ar = a.real(), ai = a.imag();
+        const double br = b.real(), bi = b.imag();
+
+        type s;
+        s.real = binned_sum::combine(binned_sum::deposit(binned_product( ar, br)),
+                                     binned_sum::deposit(binned_product(-ai, bi)));
+        s.imag = binned_sum::combine(binned_sum::deposit(binned_product( ar, bi)),
+                                     binned_sum::deposit(binned_product( ai, br)));
+        return s;
+    }
+
+    __host__ __device__
+    static type combine(const type& a, const type& b)
+    {
+        type s;
+        s.real = binned_sum::combine(a.real, b.real);
+        s.imag = binned_sum::combine(a.imag, b.imag);
+        return s;
+    }
+
+    __host__ __device__
+    static cusp::complex<T> value(const type& s)
+    {
+        return cusp::complex<T>(T(s.real.value()), T(s.imag.value()));
+    }
+};
+
+} // end namespace detail
+} // end namespace cusp
+
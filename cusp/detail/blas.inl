@@ -17,7 +17,15 @@
 
 #include <cusp/array1d.h>
 
+#include <cusp/caching_allocator.h>
 #include <cusp/exception.h>
+#include <cusp/detail/binned_sum.h>
+#include <cusp/detail/distributed_blas.h>
+#include <cusp/detail/reduction_mode.h>
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/host/vendor_blas.h>
+#include <cusp/detail/device/transform_reduce.h>
 
 #include <thrust/copy.h>
 #include <thrust/fill.h>
@@ -27,6 +35,7 @@
 #include <thrust/inner_product.h>
 
 #include <thrust/iterator/transform_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
 
 #include <cmath>
 
@@ -141,6 +150,257 @@ namespace detail
   		    return x * conjugate<T>()(x);
                 }
         };    
+
+    // the conjugate dot products of the pairs (x1,y1), (x2,y2), ... of a
+    // zipped tuple (x1,y1,x2,y2,...)
+    template <typename T>
+        struct DOTC2 : public thrust::unary_function< thrust::tuple<T,T,T,T>, thrust::tuple<T,T> >
+        {
+            template <typename Tuple>
+            __host__ __device__
+                thrust::tuple<T,T> operator()(const Tuple& t) const
+                {
+                    return thrust::make_tuple(conjugate<T>()(thrust::get<0>(t)) * thrust::get<1>(t),
+                                              conjugate<T>()(thrust::get<2>(t)) * thrust::get<3>(t));
+                }
+        };
+
+    template <typename T>
+        struct DOTC3 : public thrust::unary_function< thrust::tuple<T,T,T,T,T,T>, thrust::tuple<T,T,T> >
+        {
+            template <typename Tuple>
+            __host__ __device__
+                thrust::tuple<T,T,T> operator()(const Tuple& t) const
+                {
+                    return thrust::make_tuple(conjugate<T>()(thrust::get<0>(t)) * thrust::get<1>(t),
+                                              conjugate<T>()(thrust::get<2>(t)) * thrust::get<3>(t),
+                                              conjugate<T>()(thrust::get<4>(t)) * thrust::get<5>(t));
+                }
+        };
+
+    template <typename T>
+        struct SUM2 : public thrust::binary_function< thrust::tuple<T,T>, thrust::tuple<T,T>, thrust::tuple<T,T> >
+        {
+            __host__ __device__
+                thrust::tuple<T,T> operator()(const thrust::tuple<T,T>& a, const thrust::tuple<T,T>& b) const
+                {
+                    return thrust::make_tuple(thrust::get<0>(a) + thrust::get<0>(b),
+                                              thrust::get<1>(a) + thrust::get<1>(b));
+                }
+        };
+
+    template <typename T>
+        struct SUM3 : public thrust::binary_function< thrust::tuple<T,T,T>, thrust::tuple<T,T,T>, thrust::tuple<T,T,T> >
+        {
+            __host__ __device__
+                thrust::tuple<T,T,T> operator()(const thrust::tuple<T,T,T>& a, const thrust::tuple<T,T,T>& b) const
+                {
+                    return thrust::make_tuple(thrust::get<0>(a) + thrust::get<0>(b),
+                                              thrust::get<1>(a) + thrust::get<1>(b),
+                                              thrust::get<2>(a) + thrust::get<2>(b));
+                }
+        };
+
+    // the transforms and the reduction of the reproducible mode, which
+    // accumulate the terms in binned sums (cusp/detail/binned_sum.h)
+    template <typename T>
+        struct binned_dot : public thrust::unary_function< thrust::tuple<T,T>, typename cusp::detail::binned_accumulator<T>::type >
+        {
+            template <typename Tuple>
+            __host__ __device__
+                typename cusp::detail::binned_accumulator<T>::type operator()(const Tuple& t) const
+                {
+                    return cusp::detail::binned_accumulator<T>::product(thrust::get<0>(t), thrust::get<1>(t));
+                }
+        };
+
+    template <typename T>
+        struct binned_dotc : public thrust::unary_function< thrust::tuple<T,T>, typename cusp::detail::binned_accumulator<T>::type >
+        {
+            template <typename Tuple>
+            __host__ __device__
+                typename cusp::detail::binned_accumulator<T>::type operator()(const Tuple& t) const
+                {
+                    return cusp::detail::binned_accumulator<T>::product(conjugate<T>()(thrust::get<0>(t)), thrust::get<1>(t));
+                }
+        };
+
+    template <typename T>
+        struct binned_norm_squared : public thrust::unary_function< T, typename cusp::detail::binned_accumulator<T>::type >
+        {
+            __host__ __device__
+                typename cusp::detail::binned_accumulator<T>::type operator()(const T x) const
+                {
+                    return cusp::detail::binned_accumulator<T>::product(conjugate<T>()(x), x);
+                }
+        };
+
+    template <typename T>
+        struct binned_plus
+        {
+            typedef typename cusp::detail::binned_accumulator<T>::type Sum;
+
+            __host__ __device__
+                Sum operator()(const Sum& a, const Sum& b) const
+                {
+                    return cusp::detail::binned_accumulator<T>::combine(a, b);
+                }
+        };
+
+    template <typename T>
+        struct binned_DOTC2
+        {
+            typedef typename cusp::detail::binned_accumulator<T>::type Sum;
+
+            template <typename Tuple>
+            __host__ __device__
+                thrust::tuple<Sum,Sum> operator()(const Tuple& t) const
+                {
+                    return thrust::make_tuple(cusp::detail::binned_accumulator<T>::product(conjugate<T>()(thrust::get<0>(t)), thrust::get<1>(t)),
+                                              cusp::detail::binned_accumulator<T>::product(conjugate<T>()(thrust::get<2>(t)), thrust::get<3>(t)));
+                }
+        };
+
+    template <typename T>
+        struct binned_DOTC3
+        {
+            typedef typename cusp::detail::binned_accumulator<T>::type Sum;
+
+            template <typename Tuple>
+            __host__ __device__
+                thrust::tuple<Sum,Sum,Sum> operator()(const Tuple& t) const
+                {
+                    return thrust::make_tuple(cusp::detail::binned_accumulator<T>::product(conjugate<T>()(thrust::get<0>(t)), thrust::get<1>(t)),
+                                              cusp::detail::binned_accumulator<T>::product(conjugate<T>()(thrust::get<2>(t)), thrust::get<3>(t)),
+                                              cusp::detail::binned_accumulator<T>::product(conjugate<T>()(thrust::get<4>(t)), thrust::get<5>(t)));
+                }
+        };
+
+    template <typename T>
+        struct binned_SUM2
+        {
+            typedef typename cusp::detail::binned_accumulator<T>::type Sum;
+
+            __host__ __device__
+                thrust::tuple<Sum,Sum> operator()(const thrust::tuple<Sum,Sum>& a, const thrust::tuple<Sum,Sum>& b) const
+                {
+                    return thrust::make_tuple(binned_plus<T>()(thrust::get<0>(a), thrust::get<0>(b)),
+                                              binned_plus<T>()(thrust::get<1>(a), thrust::get<1>(b)));
+                }
+        };
+
+    template <typename T>
+        struct binned_SUM3
+        {
+            typedef typename cusp::detail::binned_accumulator<T>::type Sum;
+
+            __host__ __device__
+                thrust::tuple<Sum,Sum,Sum> operator()(const thrust::tuple<Sum,Sum,Sum>& a, const thrust::tuple<Sum,Sum,Sum>& b) const
+                {
+                    return thrust::make_tuple(binned_plus<T>()(thrust::get<0>(a), thrust::get<0>(b)),
+                                              binned_plus<T>()(thrust::get<1>(a), thrust::get<1>(b)),
+                                              binned_plus<T>()(thrust::get<2>(a), thrust::get<2>(b)));
+                }
+        };
+
+    // transforms of the pairs (x[i], y[i]) reduced by
+    // cusp::detail::device::transform_reduce_async
+    template <typename T>
+    struct dot_transform
+    {
+        __host__ __device__
+        T operator()(const T a, const T b) const
+        {
+            return a * b;
+        }
+    };
+
+    template <typename T>
+    struct dotc_transform
+    {
+        __host__ __device__
+        T operator()(const T a, const T b) const
+        {
+            return conjugate<T>()(a) * b;
+        }
+    };
+
+    template <typename T>
+    struct absolute_transform
+    {
+        __host__ __device__
+        T operator()(const T a, const T) const
+        {
+            return absolute<T>()(a);
+        }
+    };
+
+    template <typename T>
+    struct norm_squared_transform
+    {
+        __host__ __device__
+        T operator()(const T a, const T) const
+        {
+            return norm_squared<T>()(a);
+        }
+    };
+
+    // sqrt(|x|), the norm of a reduced square
+    template <typename T>
+        struct sqrt_abs : public thrust::unary_function<T, typename norm_type<T>::type>
+        {
+            __host__ __device__
+                typename norm_type<T>::type operator()(const T x) const
+                {
+                    return sqrt(abs(x));
+                }
+        };
+
+    // the coefficients of the _SCALAR functors are read from device memory
+    // each time the functor is applied
+    template <typename T>
+        struct AXPY_SCALAR : public thrust::binary_function<T,T,T>
+        {
+            const T * alpha;
+
+            AXPY_SCALAR(const T * alpha) : alpha(alpha) {}
+
+            __host__ __device__
+                T operator()(const T x, const T y) const
+                {
+                    return *alpha * x + y;
+                }
+        };
+
+    template <typename T>
+        struct AXPBY_SCALAR : public thrust::binary_function<T,T,T>
+        {
+            const T * alpha;
+            const T * beta;
+
+            AXPBY_SCALAR(const T * alpha, const T * beta) : alpha(alpha), beta(beta) {}
+
+            __host__ __device__
+                T operator()(const T x, const T y) const
+                {
+                    return *alpha * x + *beta * y;
+                }
+        };
+
+    template <typename T>
+        struct SCAL_SCALAR : public thrust::unary_function<T,T>
+        {
+            const T * alpha;
+
+            SCAL_SCALAR(const T * alpha) : alpha(alpha) {}
+
+            __host__ __device__
+                T operator()(const T x) const
+                {
+                    return *alpha * x;
+                }
+        };
+
     template <typename T>
         struct SCAL
         {
@@ -232,7 +492,7 @@ namespace detail
 	    ScalarType alpha)
   {
     size_t N = last1 - first1;
-    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(first1, first2)),
+    cusp::detail::streamed::for_each(thrust::make_zip_iterator(thrust::make_tuple(first1, first2)),
                      thrust::make_zip_iterator(thrust::make_tuple(first1, first2)) + N,
                      detail::AXPY<ScalarType>(alpha));
   }
@@ -250,7 +510,7 @@ namespace detail
 	     ScalarType2 beta)
   {
     size_t N = last1 - first1;
-    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(first1, first2, output)),
+    cusp::detail::streamed::for_each(thrust::make_zip_iterator(thrust::make_tuple(first1, first2, output)),
                      thrust::make_zip_iterator(thrust::make_tuple(first1, first2, output)) + N,
                      detail::AXPBY<ScalarType1,ScalarType2>(alpha, beta));
   }
@@ -273,7 +533,7 @@ namespace detail
   {
     CUSP_PROFILE_SCOPED();
     size_t N = last1 - first1;
-    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, output)),
+    cusp::detail::streamed::for_each(thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, output)),
                      thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, output)) + N,
                      detail::AXPBYPCZ<ScalarType1,ScalarType2,ScalarType3>(alpha, beta, gamma));
   }
@@ -287,7 +547,7 @@ namespace detail
 	   OutputIterator output)
   {
     typedef typename thrust::iterator_value<OutputIterator>::type ScalarType;
-    thrust::transform(first1, last1, first2, output, detail::XMY<ScalarType>());
+    cusp::detail::streamed::transform(first1, last1, first2, output, detail::XMY<ScalarType>());
   }
   
   template <typename InputIterator,
@@ -296,9 +556,41 @@ namespace detail
 	    InputIterator   last1,
 	    ForwardIterator first2)
   {
-    thrust::copy(first1, last1, first2);
+    cusp::detail::streamed::copy(first1, last1, first2);
   }
   
+  // the binned sum of transform(x[i], y[i]) over [first1, last1)
+  template <typename OutputType,
+            typename InputIterator1,
+	    typename InputIterator2,
+            typename UnaryFunction>
+  OutputType binned_inner_product(InputIterator1 first1,
+                                  InputIterator1 last1,
+                                  InputIterator2 first2,
+                                  UnaryFunction transform)
+  {
+    typedef cusp::detail::binned_accumulator<OutputType> Accumulator;
+    const size_t N = thrust::distance(first1, last1);
+    return Accumulator::value(cusp::detail::streamed::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(first1, first2)),
+                                                                       thrust::make_zip_iterator(thrust::make_tuple(first1, first2)) + N,
+                                                                       transform,
+                                                                       typename Accumulator::type(),
+                                                                       detail::binned_plus<OutputType>()));
+  }
+
+  template <typename InputIterator>
+  typename thrust::iterator_value<InputIterator>::type
+  binned_norm_squared_sum(InputIterator first,
+                          InputIterator last)
+  {
+    typedef typename thrust::iterator_value<InputIterator>::type ValueType;
+    typedef cusp::detail::binned_accumulator<ValueType>          Accumulator;
+    return Accumulator::value(cusp::detail::streamed::transform_reduce(first, last,
+                                                                       detail::binned_norm_squared<ValueType>(),
+                                                                       typename Accumulator::type(),
+                                                                       detail::binned_plus<ValueType>()));
+  }
+
   template <typename InputIterator1,
 	    typename InputIterator2>
   typename thrust::iterator_value<InputIterator1>::type
@@ -307,7 +599,9 @@ namespace detail
       InputIterator2 first2)
   {
     typedef typename thrust::iterator_value<InputIterator1>::type OutputType;
-    return thrust::inner_product(first1, last1, first2, OutputType(0));
+    if (cusp::detail::reproducible_reductions())
+      return binned_inner_product<OutputType>(first1, last1, first2, detail::binned_dot<OutputType>());
+    return cusp::detail::streamed::inner_product(first1, last1, first2, OutputType(0));
   }
 
   template <typename InputIterator1,
@@ -318,19 +612,95 @@ namespace detail
        InputIterator2 first2)
   {
     typedef typename thrust::iterator_value<InputIterator1>::type OutputType;
-    return thrust::inner_product(thrust::make_transform_iterator(first1, detail::conjugate<OutputType>()),
+    if (cusp::detail::reproducible_reductions())
+      return binned_inner_product<OutputType>(first1, last1, first2, detail::binned_dotc<OutputType>());
+    return cusp::detail::streamed::inner_product(thrust::make_transform_iterator(first1, detail::conjugate<OutputType>()),
                                  thrust::make_transform_iterator(last1,  detail::conjugate<OutputType>()),
                                  first2,
                                  OutputType(0));
   }
 
+  template <typename InputIterator1,
+            typename InputIterator2,
+            typename InputIterator3,
+            typename InputIterator4>
+  thrust::tuple<typename thrust::iterator_value<InputIterator1>::type,
+                typename thrust::iterator_value<InputIterator1>::type>
+      dotc_n(InputIterator1 first1,
+             InputIterator1 last1,
+             InputIterator2 first2,
+             InputIterator3 first3,
+             InputIterator4 first4)
+  {
+      typedef typename thrust::iterator_value<InputIterator1>::type OutputType;
+      const size_t N = thrust::distance(first1, last1);
+      if (cusp::detail::reproducible_reductions())
+      {
+          typedef cusp::detail::binned_accumulator<OutputType> Accumulator;
+          typedef typename Accumulator::type                   Sum;
+          const thrust::tuple<Sum,Sum> sums =
+              cusp::detail::streamed::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, first4)),
+                                                       thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, first4)) + N,
+                                                       detail::binned_DOTC2<OutputType>(),
+                                                       thrust::make_tuple(Sum(), Sum()),
+                                                       detail::binned_SUM2<OutputType>());
+          return thrust::make_tuple(Accumulator::value(thrust::get<0>(sums)),
+                                    Accumulator::value(thrust::get<1>(sums)));
+      }
+      return cusp::detail::streamed::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, first4)),
+                                                      thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, first4)) + N,
+                                                      detail::DOTC2<OutputType>(),
+                                                      thrust::make_tuple(OutputType(0), OutputType(0)),
+                                                      detail::SUM2<OutputType>());
+  }
+
+  template <typename InputIterator1,
+            typename InputIterator2,
+            typename InputIterator3,
+            typename InputIterator4,
+            typename InputIterator5,
+            typename InputIterator6>
+  thrust::tuple<typename thrust::iterator_value<InputIterator1>::type,
+                typename thrust::iterator_value<InputIterator1>::type,
+                typename thrust::iterator_value<InputIterator1>::type>
+      dotc_n(InputIterator1 first1,
+             InputIterator1 last1,
+             InputIterator2 first2,
+             InputIterator3 first3,
+             InputIterator4 first4,
+             InputIterator5 first5,
+             InputIterator6 first6)
+  {
+      typedef typename thrust::iterator_value<InputIterator1>::type OutputType;
+      const size_t N = thrust::distance(first1, last1);
+      if (cusp::detail::reproducible_reductions())
+      {
+          typedef cusp::detail::binned_accumulator<OutputType> Accumulator;
+          typedef typename Accumulator::type                   Sum;
+          const thrust::tuple<Sum,Sum,Sum> sums =
+              cusp::detail::streamed::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, first4, first5, first6)),
+                                                       thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, first4, first5, first6)) + N,
+                                                       detail::binned_DOTC3<OutputType>(),
+                                                       thrust::make_tuple(Sum(), Sum(), Sum()),
+                                                       detail::binned_SUM3<OutputType>());
+          return thrust::make_tuple(Accumulator::value(thrust::get<0>(sums)),
+                                    Accumulator::value(thrust::get<1>(sums)),
+                                    Accumulator::value(thrust::get<2>(sums)));
+      }
+      return cusp::detail::streamed::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, first4, first5, first6)),
+                                                      thrust::make_zip_iterator(thrust::make_tuple(first1, first2, first3, first4, first5, first6)) + N,
+                                                      detail::DOTC3<OutputType>(),
+                                                      thrust::make_tuple(OutputType(0), OutputType(0), OutputType(0)),
+                                                      detail::SUM3<OutputType>());
+  }
+
   template <typename ForwardIterator,
 	    typename ScalarType>
   void fill(ForwardIterator first,
 	    ForwardIterator last,
 	    ScalarType alpha)
   {
-    thrust::fill(first, last, alpha);
+    cusp::detail::streamed::fill(first, last, alpha);
   }
   
   template <typename InputIterator>
@@ -345,7 +715,7 @@ namespace detail
     
     ValueType init = 0;
     
-    return abs(thrust::transform_reduce(first, last, unary_op, init, binary_op));
+    return abs(cusp::detail::streamed::transform_reduce(first, last, unary_op, init, binary_op));
   }
 
   template <typename InputIterator>
@@ -355,12 +725,15 @@ namespace detail
   {
     typedef typename thrust::iterator_value<InputIterator>::type ValueType;
 
+    if (cusp::detail::reproducible_reductions())
+      return std::sqrt( abs(binned_norm_squared_sum(first, last)) );
+
     detail::norm_squared<ValueType> unary_op;
     thrust::plus<ValueType>   binary_op;
 
     ValueType init = 0;
 
-    return std::sqrt( abs(thrust::transform_reduce(first, last, unary_op, init, binary_op)) );
+    return std::sqrt( abs(cusp::detail::streamed::transform_reduce(first, last, unary_op, init, binary_op)) );
   }
 
   template <typename InputIterator>
@@ -375,7 +748,7 @@ namespace detail
 
     ValueType init = 0;
 
-    return thrust::transform_reduce(first, last, unary_op, init, binary_op);
+    return cusp::detail::streamed::transform_reduce(first, last, unary_op, init, binary_op);
   }
 
   template <typename ForwardIterator,
@@ -384,10 +757,192 @@ namespace detail
 	    ForwardIterator last,
 	    ScalarType alpha)
   {
-    thrust::for_each(first,
+    cusp::detail::streamed::for_each(first,
                      last,
                      detail::SCAL<ScalarType>(alpha));
   }
+
+  // transfers between a device_scalar and the host, ordered after the
+  // work issued to the current stream
+  template <typename ValueType>
+  ValueType read_device_scalar(cusp::blas::device_scalar<ValueType> scalar)
+  {
+    cudaStream_t stream = cusp::detail::current_stream();
+    ValueType value;
+    cusp::detail::check_cuda(cudaMemcpyAsync(&value, scalar.ptr, sizeof(ValueType), cudaMemcpyDeviceToHost, stream), "cudaMemcpyAsync failed");
+    cusp::detail::check_cuda(cudaStreamSynchronize(stream), "cudaStreamSynchronize failed");
+    return value;
+  }
+
+  template <typename ValueType>
+  void write_device_scalar(cusp::blas::device_scalar<ValueType> scalar, const ValueType value)
+  {
+    cudaStream_t stream = cusp::detail::current_stream();
+    cusp::detail::check_cuda(cudaMemcpyAsync(scalar.ptr, &value, sizeof(ValueType), cudaMemcpyHostToDevice, stream), "cudaMemcpyAsync failed");
+    cusp::detail::check_cuda(cudaStreamSynchronize(stream), "cudaStreamSynchronize failed");
+  }
+
+  // *result <- reduce(init, transform(x[i], y[i]), ...) on the current
+  // stream, optionally followed by *result <- finalize(*result).  The
+  // partials come from the caching allocator, so that releasing them
+  // does not wait for the reduction.
+  template <typename Array1, typename Array2, typename ValueType,
+            typename BinaryFunction1, typename BinaryFunction2>
+  void transform_reduce_async(const Array1& x, const Array2& y,
+                              BinaryFunction1 transform, BinaryFunction2 reduce,
+                              const ValueType init, ValueType * result)
+  {
+    const unsigned int BLOCK_SIZE = cusp::detail::device::TRANSFORM_REDUCE_BLOCK_SIZE;
+
+    cusp::array1d<ValueType, cusp::caching_device_allocator<ValueType> > partials(BLOCK_SIZE);
+
+    cusp::detail::device::transform_reduce_async(x.size(),
+                                                 thrust::raw_pointer_cast(&x[0]),
+                                                 thrust::raw_pointer_cast(&y[0]),
+                                                 transform, reduce, init,
+                                                 thrust::raw_pointer_cast(&partials[0]),
+                                                 result);
+  }
+
+  template <typename Array1, typename Array2, typename ValueType,
+            typename BinaryFunction1, typename BinaryFunction2, typename UnaryFunction, typename OutputType>
+  void transform_reduce_async(const Array1& x, const Array2& y,
+                              BinaryFunction1 transform, BinaryFunction2 reduce,
+                              const ValueType init, UnaryFunction finalize, OutputType * result)
+  {
+    const unsigned int BLOCK_SIZE = cusp::detail::device::TRANSFORM_REDUCE_BLOCK_SIZE;
+
+    cusp::array1d<ValueType, cusp::caching_device_allocator<ValueType> > partials(BLOCK_SIZE + 1);
+
+    ValueType * partials_ptr = thrust::raw_pointer_cast(&partials[0]);
+
+    cusp::detail::device::transform_reduce_async(x.size(),
+                                                 thrust::raw_pointer_cast(&x[0]),
+                                                 thrust::raw_pointer_cast(&y[0]),
+                                                 transform, reduce, init,
+                                                 partials_ptr,
+                                                 partials_ptr + BLOCK_SIZE);
+
+    cusp::detail::device::apply_scalar_async(partials_ptr + BLOCK_SIZE, result, finalize);
+  }
+
+  template <typename Array1, typename Array2, typename ValueType>
+  void dot_async(const Array1& x, const Array2& y, cusp::blas::device_scalar<ValueType> result, cusp::host_memory)
+  {
+    write_device_scalar(result, ValueType(cusp::blas::dot(x, y)));
+  }
+
+  template <typename Array1, typename Array2, typename ValueType>
+  void dot_async(const Array1& x, const Array2& y, cusp::blas::device_scalar<ValueType> result, cusp::device_memory)
+  {
+    if (cusp::detail::reproducible_reductions())
+    {
+      write_device_scalar(result, ValueType(cusp::blas::dot(x, y)));
+      return;
+    }
+
+    transform_reduce_async(x, y, dot_transform<ValueType>(), thrust::plus<ValueType>(), ValueType(0), result.ptr);
+  }
+
+  template <typename Array1, typename Array2, typename ValueType>
+  void dotc_async(const Array1& x, const Array2& y, cusp::blas::device_scalar<ValueType> result, cusp::host_memory)
+  {
+    write_device_scalar(result, ValueType(cusp::blas::dotc(x, y)));
+  }
+
+  template <typename Array1, typename Array2, typename ValueType>
+  void dotc_async(const Array1& x, const Array2& y, cusp::blas::device_scalar<ValueType> result, cusp::device_memory)
+  {
+    if (cusp::detail::reproducible_reductions())
+    {
+      write_device_scalar(result, ValueType(cusp::blas::dotc(x, y)));
+      return;
+    }
+
+    transform_reduce_async(x, y, dotc_transform<ValueType>(), thrust::plus<ValueType>(), ValueType(0), result.ptr);
+  }
+
+  template <typename Array, typename ValueType>
+  void nrm2_async(const Array& x, cusp::blas::device_scalar<ValueType> result, cusp::host_memory)
+  {
+    write_device_scalar(result, ValueType(cusp::blas::nrm2(x)));
+  }
+
+  template <typename Array, typename ValueType>
+  void nrm2_async(const Array& x, cusp::blas::device_scalar<ValueType> result, cusp::device_memory)
+  {
+    typedef typename Array::value_type T;
+
+    if (cusp::detail::reproducible_reductions())
+    {
+      write_device_scalar(result, ValueType(cusp::blas::nrm2(x)));
+      return;
+    }
+
+    transform_reduce_async(x, x, norm_squared_transform<T>(), thrust::plus<T>(), T(0), sqrt_abs<T>(), result.ptr);
+  }
+
+  template <typename Array, typename ValueType>
+  void nrmmax_async(const Array& x, cusp::blas::device_scalar<ValueType> result, cusp::host_memory)
+  {
+    write_device_scalar(result, ValueType(cusp::blas::nrmmax(x)));
+  }
+
+  template <typename Array, typename ValueType>
+  void nrmmax_async(const Array& x, cusp::blas::device_scalar<ValueType> result, cusp::device_memory)
+  {
+    transform_reduce_async(x, x, absolute_transform<ValueType>(), maximum<ValueType>(), ValueType(0), result.ptr);
+  }
+
+  template <typename Array1, typename Array2, typename ValueType>
+  void axpy_device_scalar(const Array1& x, const Array2& y, cusp::blas::device_scalar<ValueType> alpha, cusp::host_memory)
+  {
+    cusp::blas::axpy(x, y, read_device_scalar(alpha));
+  }
+
+  template <typename Array1, typename Array2, typename ValueType>
+  void axpy_device_scalar(const Array1& x, const Array2& y, cusp::blas::device_scalar<ValueType> alpha, cusp::device_memory)
+  {
+    typedef typename Array2::value_type T;
+    typedef typename Array2::iterator   Iterator;
+
+    Iterator y_first = const_cast<Array2&>(y).begin();
+
+    cusp::detail::streamed::transform(x.begin(), x.end(), y_first, y_first, AXPY_SCALAR<T>(alpha.ptr));
+  }
+
+  template <typename Array1, typename Array2, typename Array3, typename ValueType>
+  void axpby_device_scalar(const Array1& x, const Array2& y, const Array3& z,
+             cusp::blas::device_scalar<ValueType> alpha, cusp::blas::device_scalar<ValueType> beta, cusp::host_memory)
+  {
+    cusp::blas::axpby(x, y, z, read_device_scalar(alpha), read_device_scalar(beta));
+  }
+
+  template <typename Array1, typename Array2, typename Array3, typename ValueType>
+  void axpby_device_scalar(const Array1& x, const Array2& y, const Array3& z,
+             cusp::blas::device_scalar<ValueType> alpha, cusp::blas::device_scalar<ValueType> beta, cusp::device_memory)
+  {
+    typedef typename Array3::value_type T;
+
+    cusp::detail::streamed::transform(x.begin(), x.end(), y.begin(), const_cast<Array3&>(z).begin(), AXPBY_SCALAR<T>(alpha.ptr, beta.ptr));
+  }
+
+  template <typename Array, typename ValueType>
+  void scal_device_scalar(const Array& x, cusp::blas::device_scalar<ValueType> alpha, cusp::host_memory)
+  {
+    cusp::blas::scal(x, read_device_scalar(alpha));
+  }
+
+  template <typename Array, typename ValueType>
+  void scal_device_scalar(const Array& x, cusp::blas::device_scalar<ValueType> alpha, cusp::device_memory)
+  {
+    typedef typename Array::value_type T;
+    typedef typename Array::iterator   Iterator;
+
+    Iterator first = const_cast<Array&>(x).begin();
+
+    cusp::detail::streamed::transform(first, first + x.size(), first, SCAL_SCALAR<T>(alpha.ptr));
+  }
 } // end namespace detail
 
 
@@ -410,7 +965,11 @@ void axpy(const Array1& x,
           ScalarType alpha)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(3 * x.size() * sizeof(typename Array2::value_type));
+    CUSP_PROFILE_FLOPS(2 * x.size());
     detail::assert_same_dimensions(x, y);
+    if (cusp::detail::host::vendor::axpy(x, y, alpha))
+        return;
     cusp::blas::detail::axpy(x.begin(), x.end(), y.begin(), alpha);
 }
 
@@ -422,7 +981,11 @@ void axpy(const Array1& x,
           ScalarType alpha)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(3 * x.size() * sizeof(typename Array2::value_type));
+    CUSP_PROFILE_FLOPS(2 * x.size());
     detail::assert_same_dimensions(x, y);
+    if (cusp::detail::host::vendor::axpy(x, y, alpha))
+        return;
     cusp::blas::detail::axpy(x.begin(), x.end(), y.begin(), alpha);
 }
 
@@ -453,6 +1016,8 @@ void axpby(const Array1& x,
            ScalarType2 beta)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(3 * x.size() * sizeof(typename Array3::value_type));
+    CUSP_PROFILE_FLOPS(3 * x.size());
     detail::assert_same_dimensions(x, y, z);
     cusp::blas::detail::axpby(x.begin(), x.end(), y.begin(), z.begin(), alpha, beta);
 }
@@ -469,6 +1034,8 @@ void axpby(const Array1& x,
            ScalarType2 beta)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(3 * x.size() * sizeof(typename Array3::value_type));
+    CUSP_PROFILE_FLOPS(3 * x.size());
     detail::assert_same_dimensions(x, y, z);
     cusp::blas::detail::axpby(x.begin(), x.end(), y.begin(), z.begin(), alpha, beta);
 }
@@ -507,6 +1074,8 @@ void axpbypcz(const Array1& x,
 	      ScalarType3 gamma)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(4 * x.size() * sizeof(typename Array4::value_type));
+    CUSP_PROFILE_FLOPS(5 * x.size());
     detail::assert_same_dimensions(x, y, z, output);
     cusp::blas::detail::axpbypcz(x.begin(), x.end(), y.begin(), z.begin(), output.begin(), alpha, beta, gamma);
 }
@@ -527,6 +1096,8 @@ void axpbypcz(const Array1& x,
 	      ScalarType3 gamma)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(4 * x.size() * sizeof(typename Array4::value_type));
+    CUSP_PROFILE_FLOPS(5 * x.size());
     detail::assert_same_dimensions(x, y, z, output);
     cusp::blas::detail::axpbypcz(x.begin(), x.end(), y.begin(), z.begin(), output.begin(), alpha, beta, gamma);
 }
@@ -541,7 +1112,7 @@ void xmy(InputIterator1 first1,
          OutputIterator output)
 {
     typedef typename thrust::iterator_value<OutputIterator>::type ScalarType;
-    thrust::transform(first1, last1, first2, output, detail::XMY<ScalarType>());
+    cusp::detail::streamed::transform(first1, last1, first2, output, detail::XMY<ScalarType>());
 }
 
 template <typename Array1,
@@ -552,6 +1123,8 @@ void xmy(const Array1& x,
                Array3& output)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(3 * x.size() * sizeof(typename Array3::value_type));
+    CUSP_PROFILE_FLOPS(x.size());
     detail::assert_same_dimensions(x, y, output);
     cusp::blas::detail::xmy(x.begin(), x.end(), y.begin(), output.begin());
 }
@@ -564,6 +1137,8 @@ void xmy(const Array1& x,
          const Array3& output)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(3 * x.size() * sizeof(typename Array3::value_type));
+    CUSP_PROFILE_FLOPS(x.size());
     detail::assert_same_dimensions(x, y, output);
     cusp::blas::detail::xmy(x.begin(), x.end(), y.begin(), output.begin());
 }
@@ -574,7 +1149,7 @@ void copy(InputIterator   first1,
           InputIterator   last1,
           ForwardIterator first2)
 {
-    thrust::copy(first1, last1, first2);
+    cusp::detail::streamed::copy(first1, last1, first2);
 }
 
 template <typename Array1,
@@ -583,6 +1158,7 @@ void copy(const Array1& x,
                 Array2& y)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * x.size() * sizeof(typename Array2::value_type));
     detail::assert_same_dimensions(x, y);
     cusp::blas::detail::copy(x.begin(), x.end(), y.begin());
 }
@@ -593,6 +1169,7 @@ void copy(const Array1& x,
           const Array2& y)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * x.size() * sizeof(typename Array2::value_type));
     detail::assert_same_dimensions(x, y);
     cusp::blas::detail::copy(x.begin(), x.end(), y.begin());
 }
@@ -607,7 +1184,9 @@ typename thrust::iterator_value<InputIterator1>::type
         InputIterator2 first2)
 {
     typedef typename thrust::iterator_value<InputIterator1>::type OutputType;
-    return thrust::inner_product(first1, last1, first2, OutputType(0));
+    if (cusp::detail::reproducible_reductions())
+        return detail::binned_inner_product<OutputType>(first1, last1, first2, detail::binned_dot<OutputType>());
+    return cusp::detail::streamed::inner_product(first1, last1, first2, OutputType(0));
 }
 
 // TODO properly harmonize heterogenous types
@@ -618,7 +1197,12 @@ typename Array1::value_type
         const Array2& y)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * x.size() * sizeof(typename Array1::value_type));
+    CUSP_PROFILE_FLOPS(2 * x.size());
     detail::assert_same_dimensions(x, y);
+    typename Array1::value_type result;
+    if (!cusp::detail::reproducible_reductions() && cusp::detail::host::vendor::dot(x, y, result))
+        return result;
     return cusp::blas::detail::dot(x.begin(), x.end(), y.begin());
 }
 
@@ -631,7 +1215,9 @@ typename thrust::iterator_value<InputIterator1>::type
          InputIterator2 first2)
 {
     typedef typename thrust::iterator_value<InputIterator1>::type OutputType;
-    return thrust::inner_product(thrust::make_transform_iterator(first1, detail::conjugate<OutputType>()),
+    if (cusp::detail::reproducible_reductions())
+        return detail::binned_inner_product<OutputType>(first1, last1, first2, detail::binned_dotc<OutputType>());
+    return cusp::detail::streamed::inner_product(thrust::make_transform_iterator(first1, detail::conjugate<OutputType>()),
                                  thrust::make_transform_iterator(last1,  detail::conjugate<OutputType>()),
                                  first2,
                                  OutputType(0));
@@ -645,10 +1231,46 @@ typename Array1::value_type
          const Array2& y)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * x.size() * sizeof(typename Array1::value_type));
+    CUSP_PROFILE_FLOPS(2 * x.size());
     detail::assert_same_dimensions(x, y);
     return cusp::blas::detail::dotc(x.begin(), x.end(), y.begin());
 }
 
+template <typename Array1,
+          typename Array2,
+          typename Array3,
+          typename Array4>
+thrust::tuple<typename Array1::value_type, typename Array1::value_type>
+    dotc_n(const Array1& x1, const Array2& y1,
+           const Array3& x2, const Array4& y2)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(4 * x1.size() * sizeof(typename Array1::value_type));
+    CUSP_PROFILE_FLOPS(4 * x1.size());
+    detail::assert_same_dimensions(x1, y1, x2, y2);
+    return cusp::blas::detail::dotc_n(x1.begin(), x1.end(), y1.begin(), x2.begin(), y2.begin());
+}
+
+template <typename Array1,
+          typename Array2,
+          typename Array3,
+          typename Array4,
+          typename Array5,
+          typename Array6>
+thrust::tuple<typename Array1::value_type, typename Array1::value_type, typename Array1::value_type>
+    dotc_n(const Array1& x1, const Array2& y1,
+           const Array3& x2, const Array4& y2,
+           const Array5& x3, const Array6& y3)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(6 * x1.size() * sizeof(typename Array1::value_type));
+    CUSP_PROFILE_FLOPS(6 * x1.size());
+    detail::assert_same_dimensions(x1, y1, x2, y2);
+    detail::assert_same_dimensions(x2, x3, y3);
+    return cusp::blas::detail::dotc_n(x1.begin(), x1.end(), y1.begin(), x2.begin(), y2.begin(), x3.begin(), y3.begin());
+}
+
 
 
 template <typename ForwardIterator,
@@ -657,7 +1279,7 @@ void fill(ForwardIterator first,
           ForwardIterator last,
           ScalarType alpha)
 {
-    thrust::fill(first, last, alpha);
+    cusp::detail::streamed::fill(first, last, alpha);
 }
 
 template <typename Array,
@@ -666,6 +1288,7 @@ void fill(Array& x,
 	  ScalarType alpha)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(x.size() * sizeof(typename Array::value_type));
     cusp::blas::detail::fill(x.begin(), x.end(), alpha);
 }
 
@@ -675,6 +1298,7 @@ void fill(const Array& x,
           ScalarType alpha)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(x.size() * sizeof(typename Array::value_type));
     cusp::blas::detail::fill(x.begin(), x.end(), alpha);
 }
 
@@ -691,7 +1315,7 @@ typename norm_type<typename thrust::iterator_value<InputIterator>::type>::type
 
     ValueType init = 0;
 
-    return thrust::transform_reduce(first, last, unary_op, init, binary_op);
+    return cusp::detail::streamed::transform_reduce(first, last, unary_op, init, binary_op);
 }
 
 template <typename Array>
@@ -699,6 +1323,8 @@ typename norm_type<typename Array::value_type>::type
     nrm1(const Array& x)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(x.size() * sizeof(typename Array::value_type));
+    CUSP_PROFILE_FLOPS(x.size());
     return cusp::blas::detail::nrm1(x.begin(), x.end());
 }
 
@@ -710,12 +1336,15 @@ typename norm_type<typename thrust::iterator_value<InputIterator>::type>::type
 {
     typedef typename thrust::iterator_value<InputIterator>::type ValueType;
 
+    if (cusp::detail::reproducible_reductions())
+        return std::sqrt( abs(detail::binned_norm_squared_sum(first, last)) );
+
     detail::norm_squared<ValueType> unary_op;
     thrust::plus<ValueType>   binary_op;
 
     ValueType init = 0;
 
-    return std::sqrt( thrust::transform_reduce(first, last, unary_op, init, binary_op) );
+    return std::sqrt( cusp::detail::streamed::transform_reduce(first, last, unary_op, init, binary_op) );
 }
 
 template <typename Array>
@@ -723,6 +1352,11 @@ typename norm_type<typename Array::value_type>::type
     nrm2(const Array& x)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(x.size() * sizeof(typename Array::value_type));
+    CUSP_PROFILE_FLOPS(2 * x.size());
+    typename norm_type<typename Array::value_type>::type result;
+    if (!cusp::detail::reproducible_reductions() && cusp::detail::host::vendor::nrm2(x, result))
+        return result;
     return cusp::blas::detail::nrm2(x.begin(), x.end());
 }
 
@@ -739,7 +1373,7 @@ typename thrust::iterator_value<InputIterator>::type
 
     ValueType init = 0;
 
-    return thrust::transform_reduce(first, last, unary_op, init, binary_op);
+    return cusp::detail::streamed::transform_reduce(first, last, unary_op, init, binary_op);
 }
 
 template <typename Array>
@@ -747,6 +1381,8 @@ typename Array::value_type
     nrmmax(const Array& x)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(x.size() * sizeof(typename Array::value_type));
+    CUSP_PROFILE_FLOPS(x.size());
     return cusp::blas::detail::nrmmax(x.begin(), x.end());
 }
 
@@ -758,7 +1394,7 @@ void scal(ForwardIterator first,
           ScalarType alpha)
 {
     typedef typename thrust::iterator_value<ForwardIterator>::type ValueType;
-    thrust::transform(first, last, first, detail::SCAL<ValueType>(alpha));
+    cusp::detail::streamed::transform(first, last, first, detail::SCAL<ValueType>(alpha));
 }
 
 template <typename Array,
@@ -767,6 +1403,10 @@ void scal(Array& x,
           ScalarType alpha)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * x.size() * sizeof(typename Array::value_type));
+    CUSP_PROFILE_FLOPS(x.size());
+    if (cusp::detail::host::vendor::scal(x, alpha))
+        return;
     cusp::blas::detail::scal(x.begin(), x.end(), alpha);
 }
 
@@ -776,9 +1416,158 @@ void scal(const Array& x,
           ScalarType alpha)
 {
     CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * x.size() * sizeof(typename Array::value_type));
+    CUSP_PROFILE_FLOPS(x.size());
+    if (cusp::detail::host::vendor::scal(x, alpha))
+        return;
     cusp::blas::detail::scal(x.begin(), x.end(), alpha);
 }
 
+
+template <typename Array>
+device_scalar<typename Array::value_type>
+    make_device_scalar(const Array& array, const size_t i)
+{
+    typedef typename Array::value_type ValueType;
+
+    // the scalar is written like an element of a view
+    return device_scalar<ValueType>(const_cast<ValueType *>(thrust::raw_pointer_cast(&array[0])) + i);
+}
+
+template <typename Array1,
+          typename Array2,
+          typename ValueType>
+void dot_async(const Array1& x,
+               const Array2& y,
+               device_scalar<ValueType> result)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * x.size() * sizeof(typename Array1::value_type));
+    CUSP_PROFILE_FLOPS(2 * x.size());
+    detail::assert_same_dimensions(x, y);
+    detail::dot_async(x, y, result, typename Array1::memory_space());
+}
+
+template <typename Array1,
+          typename Array2,
+          typename ValueType>
+void dotc_async(const Array1& x,
+                const Array2& y,
+                device_scalar<ValueType> result)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * x.size() * sizeof(typename Array1::value_type));
+    CUSP_PROFILE_FLOPS(2 * x.size());
+    detail::assert_same_dimensions(x, y);
+    detail::dotc_async(x, y, result, typename Array1::memory_space());
+}
+
+template <typename Array,
+          typename ValueType>
+void nrm2_async(const Array& x,
+                device_scalar<ValueType> result)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(x.size() * sizeof(typename Array::value_type));
+    CUSP_PROFILE_FLOPS(2 * x.size());
+    detail::nrm2_async(x, result, typename Array::memory_space());
+}
+
+template <typename Array,
+          typename ValueType>
+void nrmmax_async(const Array& x,
+                  device_scalar<ValueType> result)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(x.size() * sizeof(typename Array::value_type));
+    CUSP_PROFILE_FLOPS(x.size());
+    detail::nrmmax_async(x, result, typename Array::memory_space());
+}
+
+template <typename Array1,
+          typename Array2,
+          typename ValueType>
+void axpy(const Array1& x,
+                Array2& y,
+          device_scalar<ValueType> alpha)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(3 * x.size() * sizeof(typename Array2::value_type));
+    CUSP_PROFILE_FLOPS(2 * x.size());
+    detail::assert_same_dimensions(x, y);
+    detail::axpy_device_scalar(x, y, alpha, typename Array2::memory_space());
+}
+
+template <typename Array1,
+          typename Array2,
+          typename ValueType>
+void axpy(const Array1& x,
+          const Array2& y,
+          device_scalar<ValueType> alpha)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(3 * x.size() * sizeof(typename Array2::value_type));
+    CUSP_PROFILE_FLOPS(2 * x.size());
+    detail::assert_same_dimensions(x, y);
+    detail::axpy_device_scalar(x, y, alpha, typename Array2::memory_space());
+}
+
+template <typename Array1,
+          typename Array2,
+          typename Array3,
+          typename ValueType>
+void axpby(const Array1& x,
+           const Array2& y,
+                 Array3& z,
+           device_scalar<ValueType> alpha,
+           device_scalar<ValueType> beta)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(3 * x.size() * sizeof(typename Array3::value_type));
+    CUSP_PROFILE_FLOPS(3 * x.size());
+    detail::assert_same_dimensions(x, y, z);
+    detail::axpby_device_scalar(x, y, z, alpha, beta, typename Array3::memory_space());
+}
+
+template <typename Array1,
+          typename Array2,
+          typename Array3,
+          typename ValueType>
+void axpby(const Array1& x,
+           const Array2& y,
+           const Array3& z,
+           device_scalar<ValueType> alpha,
+           device_scalar<ValueType> beta)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(3 * x.size() * sizeof(typename Array3::value_type));
+    CUSP_PROFILE_FLOPS(3 * x.size());
+    detail::assert_same_dimensions(x, y, z);
+    detail::axpby_device_scalar(x, y, z, alpha, beta, typename Array3::memory_space());
+}
+
+template <typename Array,
+          typename ValueType>
+void scal(Array& x,
+          device_scalar<ValueType> alpha)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * x.size() * sizeof(typename Array::value_type));
+    CUSP_PROFILE_FLOPS(x.size());
+    detail::scal_device_scalar(x, alpha, typename Array::memory_space());
+}
+
+template <typename Array,
+          typename ValueType>
+void scal(const Array& x,
+          device_scalar<ValueType> alpha)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * x.size() * sizeof(typename Array::value_type));
+    CUSP_PROFILE_FLOPS(x.size());
+    detail::scal_device_scalar(x, alpha, typename Array::memory_space());
+}
+
 } // end namespace blas
 } // end namespace cusp
 
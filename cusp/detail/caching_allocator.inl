@@ -0,0 +1,274 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/memory_tracker.h>
+#include <cusp/detail/scoped_device.h>
+
+#include <cuda_runtime_api.h>
+
+#include <map>
+#include <new>
+#include <utility>
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+
+class caching_memory_pool
+{
+    struct block
+    {
+        void *       ptr;
+        size_t       bytes;
+        int          device;   // device that was current when the block was allocated
+        cudaStream_t stream;   // stream that was current when the block was freed
+        cudaEvent_t  ready;    // recorded on stream when the block was freed
+    };
+
+    // free blocks are binned by (device, size class) and only reused on
+    // the device that allocated them
+    typedef std::pair<int, size_t>              bin;
+    typedef std::multimap<bin, block>           cached_blocks;
+    typedef std::map<void *, block>      live_blocks;
+
+    cached_blocks cached;
+    live_blocks   live;
+
+    caching_allocator_statistics stats;
+
+    pool_mutex mutex;
+
+    static const size_t MIN_BIN_BYTES   = size_t(1) << 9;     // 512 B
+    static const size_t MAX_BIN_BYTES   = size_t(1) << 28;    // 256 MB
+    static const size_t LARGE_GRANULE   = size_t(1) << 21;    // 2 MB
+
+    static size_t round_up(size_t bytes)
+    {
+        if (bytes > MAX_BIN_BYTES)
+            return LARGE_GRANULE * ((bytes + LARGE_GRANULE - 1) / LARGE_GRANULE);
+
+        size_t bin = MIN_BIN_BYTES;
+        while (bin < bytes)
+            bin <<= 1;
+        return bin;
+    }
+
+    void update_peaks(void)
+    {
+        stats.peak_bytes_in_use   = std::max(stats.peak_bytes_in_use,   stats.bytes_in_use);
+        stats.peak_bytes_reserved = std::max(stats.peak_bytes_reserved, stats.bytes_in_use + stats.bytes_cached);
+    }
+
+    // release every cached block, must be called with the mutex held
+    void release_cached(void)
+    {
+        for (cached_blocks::iterator i = cached.begin(); i != cached.end(); ++i)
+        {
+            cusp::detail::scoped_device scope(i->second.device);
+
+            // the block may still be in use by work issued before it was freed
+            cudaEventSynchronize(i->second.ready);
+            cudaEventDestroy(i->second.ready);
+            cudaFree(i->second.ptr);
+        }
+
+        cached.clear();
+        stats.bytes_cached = 0;
+    }
+
+    public:
+
+    caching_memory_pool(void)
+    {
+        stats.bytes_in_use           = 0;
+        stats.bytes_cached           = 0;
+        stats.peak_bytes_in_use      = 0;
+        stats.peak_bytes_reserved    = 0;
+        stats.num_device_allocations = 0;
+        stats.num_cache_hits         = 0;
+    }
+
+    // cached blocks are intentionally not freed at exit: the CUDA context
+    // may already have been destroyed when static objects are destructed
+
+    void * allocate(size_t bytes)
+    {
+        pool_lock lock(mutex);
+
+        const size_t       rounded = round_up(std::max<size_t>(bytes, 1));
+        const cudaStream_t stream  = cusp::detail::current_stream();
+
+        int device = 0;
+        cudaGetDevice(&device);
+
+        // look for a freed block of this device and size class which is safe to use on this stream
+        std::pair<cached_blocks::iterator, cached_blocks::iterator> range = cached.equal_range(bin(device, rounded));
+
+        for (cached_blocks::iterator i = range.first; i != range.second; ++i)
+        {
+            if (i->second.stream == stream || cudaEventQuery(i->second.ready) == cudaSuccess)
+            {
+                block b = i->second;
+                cached.erase(i);
+
+                live[b.ptr] = b;
+
+                stats.bytes_cached -= b.bytes;
+                stats.bytes_in_use += b.bytes;
+                stats.num_cache_hits++;
+                update_peaks();
+
+                get_device_memory_tracker().allocated(b.bytes);
+
+                return b.ptr;
+            }
+        }
+
+        block b;
+        b.bytes  = rounded;
+        b.device = device;
+        b.stream = stream;
+        b.ptr    = 0;
+
+        if (cudaMalloc(&b.ptr, rounded) != cudaSuccess)
+        {
+            // clear the error, return cached memory to the device and retry
+            cudaGetLastError();
+            release_cached();
+
+            if (cudaMalloc(&b.ptr, rounded) != cudaSuccess)
+            {
+                cudaGetLastError();
+                throw std::bad_alloc();
+            }
+        }
+
+        cudaEventCreateWithFlags(&b.ready, cudaEventDisableTiming);
+
+        live[b.ptr] = b;
+
+        stats.bytes_in_use += b.bytes;
+        stats.num_device_allocations++;
+        update_peaks();
+
+        get_device_memory_tracker().allocated(b.bytes);
+
+        return b.ptr;
+    }
+
+    void deallocate(void * ptr)
+    {
+        if (ptr == 0)
+            return;
+
+        pool_lock lock(mutex);
+
+        live_blocks::iterator i = live.find(ptr);
+
+        if (i == live.end())
+        {
+            // not allocated by the pool
+            cudaFree(ptr);
+            return;
+        }
+
+        block b = i->second;
+        live.erase(i);
+
+        // the block may be reused by the freeing stream right away and by
+        // other streams once the preceding work on this stream completes.
+        // The current stream of another device cannot order the block, so
+        // a block freed while another device is current waits for its own
+        // device to finish its work.
+        int device = 0;
+        cudaGetDevice(&device);
+
+        {
+            cusp::detail::scoped_device scope(b.device);
+
+            if (device == b.device)
+            {
+                b.stream = cusp::detail::current_stream();
+            }
+            else
+            {
+                cudaDeviceSynchronize();
+                b.stream = 0;
+            }
+
+            cudaEventRecord(b.ready, b.stream);
+        }
+
+        cached.insert(std::make_pair(bin(b.device, b.bytes), b));
+
+        stats.bytes_in_use -= b.bytes;
+        stats.bytes_cached += b.bytes;
+
+        get_device_memory_tracker().freed(b.bytes);
+    }
+
+    void free_cached(void)
+    {
+        pool_lock lock(mutex);
+        release_cached();
+    }
+
+    caching_allocator_statistics statistics(void)
+    {
+        pool_lock lock(mutex);
+        return stats;
+    }
+};
+
+// the pool is shared by all allocators and never destroyed (see above)
+inline caching_memory_pool& get_caching_memory_pool(void)
+{
+    static once_value<caching_memory_pool *> pool;
+    return *initialize_once(pool, new_instance<caching_memory_pool>);
+}
+
+} // end namespace detail
+
+template <typename T>
+typename caching_device_allocator<T>::pointer
+caching_device_allocator<T>::allocate(size_type n)
+{
+    void * ptr = cusp::detail::get_caching_memory_pool().allocate(n * sizeof(T));
+
+    return pointer(static_cast<T*>(ptr));
+}
+
+template <typename T>
+void caching_device_allocator<T>::deallocate(pointer p, size_type n)
+{
+    cusp::detail::get_caching_memory_pool().deallocate(static_cast<void*>(thrust::raw_pointer_cast(p)));
+}
+
+inline caching_allocator_statistics get_caching_allocator_statistics(void)
+{
+    return cusp::detail::get_caching_memory_pool().statistics();
+}
+
+inline void free_cached_memory(void)
+{
+    cusp::detail::get_caching_memory_pool().free_cached();
+}
+
+} // end namespace cusp
+
@@ -0,0 +1,166 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/coo_matrix.h>
+#include <cusp/multiply.h>
+
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/device/arch.h>
+
+#include <thrust/binary_search.h>
+#include <thrust/copy.h>
+#include <thrust/fill.h>
+#include <thrust/functional.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+
+// columns whose entries of x fill half of a typical host or the device's L2 cache
+template <typename ValueType>
+size_t default_panel_width(cusp::host_memory)
+{
+    return (size_t(1) << 20) / sizeof(ValueType);
+}
+
+template <typename ValueType>
+size_t default_panel_width(cusp::device_memory)
+{
+    const size_t l2_cache_bytes = cusp::detail::device::arch::current_device_info().l2_cache_bytes;
+
+    if (l2_cache_bytes == 0)
+        return default_panel_width<ValueType>(cusp::host_memory());
+
+    return std::max<size_t>(l2_cache_bytes / (2 * sizeof(ValueType)), 1);
+}
+
+} // end namespace detail
+
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+column_blocked_matrix<IndexType,ValueType,MemorySpace>
+::column_blocked_matrix(const MatrixType& matrix, size_t panel_width)
+    : Parent(matrix.num_rows, matrix.num_cols, matrix.num_entries),
+      panel_width(panel_width)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename panel_type::memory_space MemorySpace2;
+
+    if (this->panel_width == 0)
+        this->panel_width = cusp::detail::default_panel_width<ValueType>(MemorySpace2());
+
+    const size_t width = this->panel_width;
+
+    cusp::coo_matrix<IndexType, ValueType, MemorySpace> coo(matrix);
+
+    // dense matrices count their zeros
+    this->num_entries = coo.num_entries;
+
+    if (coo.num_entries == 0)
+        return;
+
+    // order the entries by panel, and by row and column within a panel
+    coo.sort_by_row_and_column();
+
+    cusp::array1d<IndexType, MemorySpace> panel_of(coo.num_entries);
+    thrust::transform(coo.column_indices.begin(), coo.column_indices.end(),
+                      thrust::constant_iterator<IndexType>(IndexType(width)),
+                      panel_of.begin(),
+                      thrust::divides<IndexType>());
+
+    thrust::stable_sort_by_key(panel_of.begin(), panel_of.end(),
+                               thrust::make_zip_iterator(thrust::make_tuple(coo.row_indices.begin(), coo.column_indices.begin(), coo.values.begin())));
+
+    // the entries of panel p are [bounds[p], bounds[p + 1])
+    const size_t max_panels = (coo.num_cols + width - 1) / width;
+
+    cusp::array1d<IndexType, MemorySpace> bounds(max_panels + 1);
+    thrust::lower_bound(panel_of.begin(), panel_of.end(),
+                        thrust::counting_iterator<IndexType>(0),
+                        thrust::counting_iterator<IndexType>(max_panels + 1),
+                        bounds.begin());
+
+    cusp::array1d<IndexType, cusp::host_memory> h_bounds(bounds);
+
+    for (size_t p = 0; p < max_panels; p++)
+    {
+        const size_t begin = h_bounds[p];
+        const size_t end   = h_bounds[p + 1];
+
+        if (begin == end)
+            continue;
+
+        const size_t first_column = p * width;
+        const size_t num_columns  = std::min(width, coo.num_cols - first_column);
+
+        panels.push_back(panel_type());
+        panel_columns.push_back(first_column);
+
+        panel_type& panel = panels.back();
+        panel.resize(coo.num_rows, num_columns, end - begin);
+
+        cusp::detail::indices_to_offsets(cusp::make_array1d_view(coo.row_indices.begin() + begin, coo.row_indices.begin() + end),
+                                         panel.row_offsets);
+
+        thrust::transform(coo.column_indices.begin() + begin, coo.column_indices.begin() + end,
+                          thrust::constant_iterator<IndexType>(IndexType(first_column)),
+                          panel.column_indices.begin(),
+                          thrust::minus<IndexType>());
+
+        thrust::copy(coo.values.begin() + begin, coo.values.begin() + end, panel.values.begin());
+    }
+}
+
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename VectorType1, typename VectorType2>
+void column_blocked_matrix<IndexType,ValueType,MemorySpace>
+::operator()(const VectorType1& x, VectorType2& y) const
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename VectorType2::value_type ValueType2;
+
+    if (panels.empty())
+    {
+        thrust::fill(y.begin(), y.end(), ValueType2(0));
+        return;
+    }
+
+    for (size_t p = 0; p < panels.size(); p++)
+    {
+        // the panel reads x within its columns only
+        const cusp::array1d_view<typename VectorType1::const_iterator> x_panel(x.begin() + panel_columns[p],
+                                                                             x.begin() + panel_columns[p] + panels[p].num_cols);
+
+        if (p == 0)
+            cusp::multiply(panels[p], x_panel, y);
+        else
+            cusp::multiply(panels[p], x_panel, y, ValueType2(1), ValueType2(1));
+    }
+}
+
+} // end namespace cusp
+
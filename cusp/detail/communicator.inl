@@ -0,0 +1,140 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/exception.h>
+
+#include <cstring>
+
+namespace cusp
+{
+namespace detail
+{
+
+#if defined(CUSP_USE_MPI)
+inline void check_mpi(int status, const char * message)
+{
+    if (status != MPI_SUCCESS)
+        throw cusp::runtime_exception(message);
+}
+#endif
+
+} // end namespace detail
+
+#if defined(CUSP_USE_MPI)
+
+inline communicator::communicator(void)
+    : comm(MPI_COMM_SELF), m_rank(0), m_size(1) {}
+
+inline communicator::communicator(MPI_Comm comm)
+    : comm(comm)
+{
+    cusp::detail::check_mpi(MPI_Comm_rank(comm, &m_rank), "MPI_Comm_rank failed");
+    cusp::detail::check_mpi(MPI_Comm_size(comm, &m_size), "MPI_Comm_size failed");
+}
+
+inline bool communicator::operator==(const communicator& c) const
+{
+    return comm == c.comm;
+}
+
+template <typename T>
+void communicator::allgather(const T& value, std::vector<T>& values) const
+{
+    values.resize(m_size);
+
+    cusp::detail::check_mpi(MPI_Allgather(const_cast<T *>(&value), sizeof(T), MPI_BYTE,
+                                          &values[0], sizeof(T), MPI_BYTE, comm),
+                            "MPI_Allgather failed");
+}
+
+template <typename T>
+void communicator::alltoallv(const std::vector< std::vector<T> >& send,
+                                   std::vector< std::vector<T> >& recv) const
+{
+    if (send.size() != size_t(m_size))
+        throw cusp::invalid_input_exception("alltoallv requires one list per process");
+
+    // exchange the sizes, then the bytes of the lists
+    std::vector<int> send_counts(m_size), recv_counts(m_size);
+    std::vector<int> send_displs(m_size), recv_displs(m_size);
+
+    for (int r = 0; r < m_size; r++)
+        send_counts[r] = int(send[r].size() * sizeof(T));
+
+    cusp::detail::check_mpi(MPI_Alltoall(&send_counts[0], 1, MPI_INT, &recv_counts[0], 1, MPI_INT, comm),
+                            "MPI_Alltoall failed");
+
+    int send_total = 0, recv_total = 0;
+
+    for (int r = 0; r < m_size; r++)
+    {
+        send_displs[r] = send_total;
+        recv_displs[r] = recv_total;
+        send_total += send_counts[r];
+        recv_total += recv_counts[r];
+    }
+
+    std::vector<char> send_bytes(send_total + 1), recv_bytes(recv_total + 1);
+
+    for (int r = 0; r < m_size; r++)
+        if (!send[r].empty())
+            std::memcpy(&send_bytes[send_displs[r]], &send[r][0], send_counts[r]);
+
+    cusp::detail::check_mpi(MPI_Alltoallv(&send_bytes[0], &send_counts[0], &send_displs[0], MPI_BYTE,
+                                          &recv_bytes[0], &recv_counts[0], &recv_displs[0], MPI_BYTE, comm),
+                            "MPI_Alltoallv failed");
+
+    recv.resize(m_size);
+
+    for (int r = 0; r < m_size; r++)
+    {
+        recv[r].resize(recv_counts[r] / sizeof(T));
+
+        if (!recv[r].empty())
+            std::memcpy(&recv[r][0], &recv_bytes[recv_displs[r]], recv_counts[r]);
+    }
+}
+
+#else // CUSP_USE_MPI
+
+inline communicator::communicator(void)
+    : m_rank(0), m_size(1) {}
+
+inline bool communicator::operator==(const communicator&) const
+{
+    return true;
+}
+
+template <typename T>
+void communicator::allgather(const T& value, std::vector<T>& values) const
+{
+    values.assign(1, value);
+}
+
+template <typename T>
+void communicator::alltoallv(const std::vector< std::vector<T> >& send,
+                                   std::vector< std::vector<T> >& recv) const
+{
+    if (send.size() != 1)
+        throw cusp::invalid_input_exception("alltoallv requires one list per process");
+
+    recv = send;
+}
+
+#endif // CUSP_USE_MPI
+
+} // end namespace cusp
@@ -35,11 +35,19 @@
 #if defined(CUSP_PROFILE_ENABLED)
 // profiling enabled
 #define CUSP_PROFILE_SCOPED()  PROFILE_SCOPED()
+#define CUSP_PROFILE_SCOPED_DESC(desc)  PROFILE_SCOPED_DESC(desc)
 #define CUSP_PROFILE_DUMP()    cusp::detail::profiler::dump()
+#define CUSP_PROFILE_BYTES(bytes)  cusp::detail::profiler::add_bytes(bytes)
+#define CUSP_PROFILE_FLOPS(flops)  cusp::detail::profiler::add_flops(flops)
+#define CUSP_PROFILE_SCOPED_NAME(name)  PROFILE_SCOPED_RAW(name)
 #include <cusp/detail/profiler.h>
 #else
 // profiling disabled
 #define CUSP_PROFILE_SCOPED()
+#define CUSP_PROFILE_SCOPED_DESC(desc)
 #define CUSP_PROFILE_DUMP()
+#define CUSP_PROFILE_BYTES(bytes)
+#define CUSP_PROFILE_FLOPS(flops)
+#define CUSP_PROFILE_SCOPED_NAME(name)
 #endif
 
@@ -43,6 +43,146 @@ void convert(const SourceType& src, DestinationType& dst,
       typename DestinationType::memory_space());
 }
 
+// BSR, SELL and DIA/COO destinations
+//
+// The block size of a bsr_matrix, the slice parameters of a sell_matrix and
+// the min_fill of a dia_coo_matrix are chosen by the destination and would
+// be lost in the temporary containers used to convert between memory spaces,
+// so the source is first moved into the memory space of the destination.
+template <typename SourceType, typename DestinationType, typename MemorySpace>
+void convert_in_destination_space(const SourceType& src, DestinationType& dst,
+                                  MemorySpace, MemorySpace)
+{
+  cusp::detail::dispatch::convert(src, dst, MemorySpace(), MemorySpace());
+}
+
+template <typename SourceType, typename DestinationType,
+          typename MemorySpace1, typename MemorySpace2>
+void convert_in_destination_space(const SourceType& src, DestinationType& dst,
+                                  MemorySpace1, MemorySpace2)
+{
+  typedef typename SourceType::container SourceContainerType;
+  typedef typename SourceContainerType::template rebind<MemorySpace2>::type TemporaryType;
+
+  TemporaryType tmp(src);
+
+  cusp::detail::dispatch::convert(tmp, dst, MemorySpace2(), MemorySpace2());
+}
+
+template <typename SourceType, typename DestinationType,
+          typename T1>
+void convert(const SourceType& src, DestinationType& dst,
+             T1, cusp::bsr_format)
+{
+  cusp::detail::convert_in_destination_space(src, dst,
+      typename SourceType::memory_space(),
+      typename DestinationType::memory_space());
+}
+
+template <typename SourceType, typename DestinationType>
+void convert(const SourceType& src, DestinationType& dst,
+             cusp::bsr_format, cusp::bsr_format)
+{
+  cusp::copy(src, dst);
+}
+
+template <typename SourceType, typename DestinationType,
+          typename T1>
+void convert(const SourceType& src, DestinationType& dst,
+             T1, cusp::sell_format)
+{
+  cusp::detail::convert_in_destination_space(src, dst,
+      typename SourceType::memory_space(),
+      typename DestinationType::memory_space());
+}
+
+template <typename SourceType, typename DestinationType>
+void convert(const SourceType& src, DestinationType& dst,
+             cusp::sell_format, cusp::sell_format)
+{
+  cusp::copy(src, dst);
+}
+
+template <typename SourceType, typename DestinationType,
+          typename T1>
+void convert(const SourceType& src, DestinationType& dst,
+             T1, cusp::dia_coo_format)
+{
+  cusp::detail::convert_in_destination_space(src, dst,
+      typename SourceType::memory_space(),
+      typename DestinationType::memory_space());
+}
+
+template <typename SourceType, typename DestinationType>
+void convert(const SourceType& src, DestinationType& dst,
+             cusp::dia_coo_format, cusp::dia_coo_format)
+{
+  cusp::copy(src, dst);
+}
+
+// auto_format_matrix
+//
+// Conversions into an auto_format_matrix select a format for the source,
+// conversions out of it convert the member holding the matrix.
+template <typename SourceType, typename DestinationType>
+void convert_selected(const SourceType& src, DestinationType& dst)
+{
+  typedef typename SourceType::selection_type Selection;
+
+  switch (src.selection.format)
+  {
+    case Selection::csr: cusp::convert(src.csr, dst); break;
+    case Selection::dia: cusp::convert(src.dia, dst); break;
+    case Selection::ell: cusp::convert(src.ell, dst); break;
+    case Selection::hyb: cusp::convert(src.hyb, dst); break;
+    default: break;
+  }
+}
+
+template <typename SourceType, typename DestinationType,
+          typename T1>
+void convert(const SourceType& src, DestinationType& dst,
+             T1, cusp::auto_format)
+{
+  dst.select(src);
+}
+
+template <typename SourceType, typename DestinationType,
+          typename T2>
+void convert(const SourceType& src, DestinationType& dst,
+             cusp::auto_format, T2)
+{
+  cusp::detail::convert_selected(src, dst);
+}
+
+template <typename SourceType, typename DestinationType>
+void convert(const SourceType& src, DestinationType& dst,
+             cusp::auto_format, cusp::auto_format)
+{
+  cusp::copy(src, dst);
+}
+
+template <typename SourceType, typename DestinationType>
+void convert(const SourceType& src, DestinationType& dst,
+             cusp::auto_format, cusp::bsr_format)
+{
+  cusp::detail::convert_selected(src, dst);
+}
+
+template <typename SourceType, typename DestinationType>
+void convert(const SourceType& src, DestinationType& dst,
+             cusp::auto_format, cusp::sell_format)
+{
+  cusp::detail::convert_selected(src, dst);
+}
+
+template <typename SourceType, typename DestinationType>
+void convert(const SourceType& src, DestinationType& dst,
+             cusp::auto_format, cusp::dia_coo_format)
+{
+  cusp::detail::convert_selected(src, dst);
+}
+
 } // end namespace detail
 
 /////////////////
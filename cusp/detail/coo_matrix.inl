@@ -68,7 +68,7 @@ template <typename IndexType, typename ValueType, class MemorySpace>
     coo_matrix<IndexType,ValueType,MemorySpace>
     ::sort_by_row_and_column(void)
     {
-        cusp::detail::sort_by_row_and_column(row_indices, column_indices, values);
+        cusp::detail::sort_by_row_and_column(row_indices, column_indices, values, this->num_rows, this->num_cols);
     }
 
 // determine whether matrix elements are sorted by row index
@@ -110,7 +110,7 @@ template <typename Array1, typename Array2, typename Array3, typename IndexType,
     coo_matrix_view<Array1,Array2,Array3,IndexType,ValueType,MemorySpace>
     ::sort_by_row_and_column(void)
     {
-        cusp::detail::sort_by_row_and_column(row_indices, column_indices, values);
+        cusp::detail::sort_by_row_and_column(row_indices, column_indices, values, this->num_rows, this->num_cols);
     }
 
 // determine whether matrix elements are sorted by row index
@@ -14,8 +14,13 @@
  *  limitations under the License.
  */
 
+#include <cusp/exception.h>
 #include <cusp/format.h>
 
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/dispatch/dense_transpose.h>
+#include <cusp/detail/stream.h>
+
 // TODO replace with detail/array2d_utils.h or something
 #include <cusp/array2d.h>
 
@@ -89,6 +94,115 @@ void copy(const T1& src, T2& dst,
   cusp::copy(src.coo, dst.coo);
 }
 
+template <typename T1, typename T2>
+void copy(const T1& src, T2& dst,
+          cusp::bsr_format,
+          cusp::bsr_format)
+{
+  copy_matrix_dimensions(src, dst);
+  dst.block_size = src.block_size;
+  cusp::copy(src.row_offsets,    dst.row_offsets);
+  cusp::copy(src.column_indices, dst.column_indices);
+  cusp::copy(src.values,         dst.values);
+}
+
+template <typename T1, typename T2>
+void copy(const T1& src, T2& dst,
+          cusp::sell_format,
+          cusp::sell_format)
+{
+  copy_matrix_dimensions(src, dst);
+  dst.slice_size     = src.slice_size;
+  dst.sorting_window = src.sorting_window;
+  cusp::copy(src.row_permutation, dst.row_permutation);
+  cusp::copy(src.slice_offsets,   dst.slice_offsets);
+  cusp::copy(src.column_indices,  dst.column_indices);
+  cusp::copy(src.values,          dst.values);
+}
+
+template <typename T1, typename T2>
+void copy(const T1& src, T2& dst,
+          cusp::jds_format,
+          cusp::jds_format)
+{
+  copy_matrix_dimensions(src, dst);
+  cusp::copy(src.row_permutation,  dst.row_permutation);
+  cusp::copy(src.diagonal_offsets, dst.diagonal_offsets);
+  cusp::copy(src.column_indices,   dst.column_indices);
+  cusp::copy(src.values,           dst.values);
+}
+
+template <typename T1, typename T2>
+void copy(const T1& src, T2& dst,
+          cusp::csr16_format,
+          cusp::csr16_format)
+{
+  copy_matrix_dimensions(src, dst);
+  cusp::copy(src.row_offsets,    dst.row_offsets);
+  cusp::copy(src.row_bases,      dst.row_bases);
+  cusp::copy(src.column_offsets, dst.column_offsets);
+  cusp::copy(src.values,         dst.values);
+  cusp::copy(src.overflow,       dst.overflow);
+}
+
+template <typename T1, typename T2>
+void copy(const T1& src, T2& dst,
+          cusp::split_complex_format,
+          cusp::split_complex_format)
+{
+  copy_matrix_dimensions(src, dst);
+  cusp::copy(src.real, dst.real);
+  cusp::copy(src.imag, dst.imag);
+}
+
+template <typename T1, typename T2>
+void copy(const T1& src, T2& dst,
+          cusp::dia_coo_format,
+          cusp::dia_coo_format)
+{
+  copy_matrix_dimensions(src, dst);
+  dst.min_fill = src.min_fill;
+  cusp::copy(src.dia, dst.dia);
+  cusp::copy(src.coo, dst.coo);
+}
+
+template <typename T1, typename T2>
+void copy(const T1& src, T2& dst,
+          cusp::symmetric_csr_format,
+          cusp::symmetric_csr_format)
+{
+  copy_matrix_dimensions(src, dst);
+  cusp::copy(src.row_offsets,    dst.row_offsets);
+  cusp::copy(src.column_indices, dst.column_indices);
+  cusp::copy(src.values,         dst.values);
+}
+
+template <typename T1, typename T2>
+void copy(const T1& src, T2& dst,
+          cusp::batched_csr_format,
+          cusp::batched_csr_format)
+{
+  copy_matrix_dimensions(src, dst);
+  dst.num_batches = src.num_batches;
+  cusp::copy(src.row_offsets,    dst.row_offsets);
+  cusp::copy(src.column_indices, dst.column_indices);
+  cusp::copy(src.values,         dst.values);
+}
+
+template <typename T1, typename T2>
+void copy(const T1& src, T2& dst,
+          cusp::auto_format,
+          cusp::auto_format)
+{
+  copy_matrix_dimensions(src, dst);
+  dst.options   = src.options;
+  dst.selection = src.selection;
+  cusp::copy(src.csr, dst.csr);
+  cusp::copy(src.dia, dst.dia);
+  cusp::copy(src.ell, dst.ell);
+  cusp::copy(src.hyb, dst.hyb);
+}
+
 template <typename T1, typename T2>
 void copy(const T1& src, T2& dst,
           cusp::array1d_format,
@@ -129,6 +243,13 @@ void copy_array2d(const T1& src, T2& dst, Orientation1, Orientation2)
 {
   // note: pitch does not carry over when orientation differs
   dst.resize(src.num_rows, src.num_cols);
+
+  // the rows of src become the columns of dst
+  if (cusp::detail::dispatch::transpose_dense(src.values, dst.values,
+                                              cusp::detail::major_dimension(src.num_rows, src.num_cols, Orientation1()),
+                                              cusp::detail::minor_dimension(src.num_rows, src.num_cols, Orientation1()),
+                                              src.pitch, dst.pitch))
+    return;
   
   thrust::counting_iterator<size_t> begin(0);
   thrust::counting_iterator<size_t> end(src.num_entries);
@@ -152,6 +273,34 @@ void copy(const T1& src, T2& dst,
       typename T2::orientation());
 }
 
+inline cudaMemcpyKind memcpy_kind(cusp::host_memory,   cusp::host_memory)   { return cudaMemcpyHostToHost;     }
+inline cudaMemcpyKind memcpy_kind(cusp::host_memory,   cusp::device_memory) { return cudaMemcpyHostToDevice;   }
+inline cudaMemcpyKind memcpy_kind(cusp::device_memory, cusp::host_memory)   { return cudaMemcpyDeviceToHost;   }
+inline cudaMemcpyKind memcpy_kind(cusp::device_memory, cusp::device_memory) { return cudaMemcpyDeviceToDevice; }
+
+template <typename T1, typename T2>
+void copy_async(const T1& src, T2& dst, cudaStream_t stream,
+                cusp::array1d_format,
+                cusp::array1d_format)
+{
+  typedef typename T1::value_type ValueType;
+
+  if (src.size() != dst.size())
+    throw cusp::invalid_input_exception("copy_async requires arrays of the same size");
+
+  if (src.size() == 0)
+    return;
+
+  // arrays of different value types do not convert
+  const ValueType * src_ptr = thrust::raw_pointer_cast(&src[0]);
+        ValueType * dst_ptr = thrust::raw_pointer_cast(&dst[0]);
+
+  cusp::detail::check_cuda(cudaMemcpyAsync(dst_ptr, src_ptr, src.size() * sizeof(ValueType),
+                                           memcpy_kind(typename T1::memory_space(), typename T2::memory_space()),
+                                           stream),
+                           "cudaMemcpyAsync failed");
+}
+
 } // end namespace detail
 
 
@@ -167,5 +316,19 @@ void copy(const T1& src, T2& dst)
   cusp::detail::copy(src, dst, typename T1::format(), typename T2::format());
 }
 
+template <typename T1, typename T2>
+void copy_async(const T1& src, T2& dst, cudaStream_t stream)
+{
+  CUSP_PROFILE_SCOPED();
+
+  cusp::detail::copy_async(src, dst, stream, typename T1::format(), typename T2::format());
+}
+
+template <typename T1, typename T2>
+void copy_async(const T1& src, T2& dst)
+{
+  cusp::copy_async(src, dst, cusp::detail::current_stream());
+}
+
 } // end namespace cusp
 
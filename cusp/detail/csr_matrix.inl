@@ -44,6 +44,8 @@ template <typename MatrixType>
     ::operator=(const MatrixType& matrix)
     {
         cusp::convert(matrix, *this);
+
+        row_statistics.invalidate();
         
         return *this;
     }
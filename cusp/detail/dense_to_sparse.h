@@ -0,0 +1,315 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+
+#include <cusp/detail/format_utils.h>
+
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/gather.h>
+#include <thrust/scan.h>
+#include <thrust/scatter.h>
+#include <thrust/tuple.h>
+
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+// Compaction of a dense array2d into CSR or COO storage without a sort.
+//
+// The entries kept by predicate(i, j, A(i,j)) are counted per row, the
+// counts are scanned into row offsets and each row is compacted in order
+// of its columns.  A row_major array is processed in the order of its
+// values: the predicate is evaluated inside the scan that produces the
+// destination of every entry, the offset of row i is the destination of
+// its first value, and the kept entries are scattered to their
+// destinations.  The padding of the pitch is never kept.  A column_major
+// array is processed with one thread per row, so that consecutive
+// threads read consecutive values of each column.  Both passes work in
+// either memory space, dense_nonzero_predicate reproduces the plain
+// conversion and cusp::drop_tolerance thresholds in the same pass.
+
+namespace cusp
+{
+namespace detail
+{
+
+// keeps the nonzero entries
+struct dense_nonzero_predicate
+{
+    template <typename IndexType, typename ValueType>
+    __host__ __device__
+    bool operator()(const IndexType i, const IndexType j, const ValueType v) const
+    {
+        return v != ValueType(0);
+    }
+};
+
+// whether the value at physical position p of a row_major array is kept,
+// for p in [0, num_rows * pitch], where p = num_rows * pitch is not
+template <typename IndexType, typename ValueType, typename Predicate>
+struct dense_keep_functor
+{
+    IndexType num_values;
+    IndexType num_cols;
+    IndexType pitch;
+    const ValueType * Ax;
+    Predicate predicate;
+
+    dense_keep_functor(const IndexType num_values, const IndexType num_cols, const IndexType pitch,
+                       const ValueType * Ax, Predicate predicate)
+        : num_values(num_values), num_cols(num_cols), pitch(pitch), Ax(Ax), predicate(predicate) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType p) const
+    {
+        if (p >= num_values)
+            return 0;
+
+        const IndexType i = p / pitch;
+        const IndexType j = p % pitch;
+
+        return (j < num_cols && predicate(i, j, Ax[p])) ? 1 : 0;
+    }
+};
+
+template <typename IndexType>
+struct dense_column_functor
+{
+    IndexType pitch;
+
+    dense_column_functor(const IndexType pitch) : pitch(pitch) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType p) const
+    {
+        return p % pitch;
+    }
+};
+
+template <typename IndexType>
+struct dense_row_start_functor
+{
+    IndexType pitch;
+
+    dense_row_start_functor(const IndexType pitch) : pitch(pitch) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType i) const
+    {
+        return i * pitch;
+    }
+};
+
+// number of entries of row i of a column_major array kept by the predicate
+template <typename IndexType, typename ValueType, typename Predicate>
+struct dense_count_functor
+{
+    IndexType num_cols;
+    IndexType pitch;
+    const ValueType * Ax;
+          IndexType * Bp;
+    Predicate predicate;
+
+    dense_count_functor(const IndexType num_cols, const IndexType pitch, const ValueType * Ax,
+                        IndexType * Bp, Predicate predicate)
+        : num_cols(num_cols), pitch(pitch), Ax(Ax), Bp(Bp), predicate(predicate) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType count = 0;
+
+        for (IndexType j = 0; j < num_cols; j++)
+            if (predicate(i, j, Ax[j * pitch + i]))
+                count++;
+
+        Bp[i] = count;
+    }
+};
+
+// the entries of row i of a column_major array kept by the predicate
+template <typename IndexType, typename ValueType1, typename ValueType2, typename Predicate>
+struct dense_compact_functor
+{
+    IndexType num_cols;
+    IndexType pitch;
+    const ValueType1 * Ax;
+    const IndexType  * Bp;
+          IndexType  * Bj;
+          ValueType2 * Bx;
+    Predicate predicate;
+
+    dense_compact_functor(const IndexType num_cols, const IndexType pitch, const ValueType1 * Ax,
+                          const IndexType * Bp, IndexType * Bj, ValueType2 * Bx, Predicate predicate)
+        : num_cols(num_cols), pitch(pitch), Ax(Ax), Bp(Bp), Bj(Bj), Bx(Bx), predicate(predicate) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType n = Bp[i];
+
+        for (IndexType j = 0; j < num_cols; j++)
+        {
+            const ValueType1 v = Ax[j * pitch + i];
+
+            if (predicate(i, j, v))
+            {
+                Bj[n] = j;
+                Bx[n] = v;
+                n++;
+            }
+        }
+    }
+};
+
+template <typename Matrix, typename Predicate, typename Array1, typename Array2, typename Array3>
+void dense_to_csr_arrays(const Matrix& A, Predicate predicate,
+                         Array1& row_offsets, Array2& column_indices, Array3& values,
+                         cusp::row_major)
+{
+    typedef typename Array1::value_type    IndexType;
+    typedef typename Matrix::value_type    ValueType;
+    typedef typename Array1::memory_space  MemorySpace;
+
+    const IndexType num_values = A.num_rows * A.pitch;
+
+    row_offsets.resize(A.num_rows + 1);
+
+    if (num_values == 0)
+    {
+        thrust::fill(row_offsets.begin(), row_offsets.end(), IndexType(0));
+        column_indices.resize(0);
+        values.resize(0);
+        return;
+    }
+
+    dense_keep_functor<IndexType, ValueType, Predicate> keep(num_values, A.num_cols, A.pitch, thrust::raw_pointer_cast(&A.values[0]), predicate);
+
+    // destination of every value, the last one is the number of entries kept
+    cusp::array1d<IndexType, MemorySpace> positions(num_values + 1);
+
+    thrust::exclusive_scan(thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0), keep),
+                           thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(num_values + 1), keep),
+                           positions.begin());
+
+    // row i starts at the destination of its first value
+    thrust::gather(thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0), dense_row_start_functor<IndexType>(A.pitch)),
+                   thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(A.num_rows + 1), dense_row_start_functor<IndexType>(A.pitch)),
+                   positions.begin(),
+                   row_offsets.begin());
+
+    const IndexType num_kept = positions[num_values];
+
+    column_indices.resize(num_kept);
+    values.resize(num_kept);
+
+    thrust::scatter_if(thrust::make_zip_iterator(thrust::make_tuple(thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0), dense_column_functor<IndexType>(A.pitch)),
+                                                                    A.values.begin())),
+                       thrust::make_zip_iterator(thrust::make_tuple(thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(num_values), dense_column_functor<IndexType>(A.pitch)),
+                                                                    A.values.begin() + num_values)),
+                       positions.begin(),
+                       thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0), keep),
+                       thrust::make_zip_iterator(thrust::make_tuple(column_indices.begin(), values.begin())));
+}
+
+template <typename Matrix, typename Predicate, typename Array1, typename Array2, typename Array3>
+void dense_to_csr_arrays(const Matrix& A, Predicate predicate,
+                         Array1& row_offsets, Array2& column_indices, Array3& values,
+                         cusp::column_major)
+{
+    typedef typename Array1::value_type    IndexType;
+    typedef typename Matrix::value_type    ValueType1;
+    typedef typename Array3::value_type    ValueType2;
+
+    const size_t num_rows = A.num_rows;
+
+    row_offsets.resize(num_rows + 1);
+    row_offsets[num_rows] = 0;
+
+    if (num_rows == 0 || A.num_cols == 0)
+    {
+        thrust::fill(row_offsets.begin(), row_offsets.end(), IndexType(0));
+        column_indices.resize(0);
+        values.resize(0);
+        return;
+    }
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     dense_count_functor<IndexType, ValueType1, Predicate>
+                        (A.num_cols, A.pitch, thrust::raw_pointer_cast(&A.values[0]),
+                         thrust::raw_pointer_cast(&row_offsets[0]), predicate));
+
+    thrust::exclusive_scan(row_offsets.begin(), row_offsets.end(), row_offsets.begin());
+
+    const IndexType num_kept = row_offsets[num_rows];
+
+    column_indices.resize(num_kept);
+    values.resize(num_kept);
+
+    if (num_kept == 0)
+        return;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     dense_compact_functor<IndexType, ValueType1, ValueType2, Predicate>
+                        (A.num_cols, A.pitch, thrust::raw_pointer_cast(&A.values[0]),
+                         thrust::raw_pointer_cast(&row_offsets[0]),
+                         thrust::raw_pointer_cast(&column_indices[0]),
+                         thrust::raw_pointer_cast(&values[0]),
+                         predicate));
+}
+
+// B <- the entries of the array2d A kept by predicate(i, j, A(i,j))
+template <typename Matrix1, typename Matrix2, typename Predicate>
+void array2d_to_csr(const Matrix1& A, Matrix2& B, Predicate predicate)
+{
+    B.resize(A.num_rows, A.num_cols, 0);
+
+    dense_to_csr_arrays(A, predicate, B.row_offsets, B.column_indices, B.values,
+                        typename Matrix1::orientation());
+
+    B.num_entries = B.values.size();
+}
+
+template <typename Matrix1, typename Matrix2, typename Predicate>
+void array2d_to_coo(const Matrix1& A, Matrix2& B, Predicate predicate)
+{
+    typedef typename Matrix2::index_type   IndexType;
+    typedef typename Matrix2::memory_space MemorySpace;
+
+    cusp::array1d<IndexType, MemorySpace> row_offsets;
+
+    B.resize(A.num_rows, A.num_cols, 0);
+
+    dense_to_csr_arrays(A, predicate, row_offsets, B.column_indices, B.values,
+                        typename Matrix1::orientation());
+
+    B.num_entries = B.values.size();
+    B.row_indices.resize(B.num_entries);
+
+    if (B.num_entries > 0)
+        cusp::detail::offsets_to_indices(row_offsets, B.row_indices);
+}
+
+} // end namespace detail
+} // end namespace cusp
+
@@ -17,6 +17,12 @@
 #pragma once
 
 #include <cusp/detail/config.h>
+#include <cusp/detail/mutex.h>
+
+#include <cuda_runtime_api.h>
+
+#include <map>
+#include <vector>
 
 #if THRUST_VERSION >= 100600
 #include <thrust/system/cuda/detail/arch.h>
@@ -33,8 +39,53 @@ namespace device
 namespace arch
 {
 
+// Occupancy of the kernels.  The query reads the attributes of the
+// kernel and the properties of the device, which is too slow to repeat
+// on every launch, so the result is cached per kernel, block size,
+// dynamic shared memory and device.
+struct occupancy_key
+{
+    const void * kernel;
+    size_t       cta_size;
+    size_t       dynamic_smem_bytes;
+    int          device;
+
+    occupancy_key(const void * kernel, const size_t cta_size, const size_t dynamic_smem_bytes, const int device)
+        : kernel(kernel), cta_size(cta_size), dynamic_smem_bytes(dynamic_smem_bytes), device(device) {}
+
+    bool operator<(const occupancy_key& other) const
+    {
+        if (kernel             != other.kernel)             return kernel             < other.kernel;
+        if (cta_size           != other.cta_size)           return cta_size           < other.cta_size;
+        if (dynamic_smem_bytes != other.dynamic_smem_bytes) return dynamic_smem_bytes < other.dynamic_smem_bytes;
+        return device < other.device;
+    }
+};
+
+typedef std::map<occupancy_key, size_t> occupancy_map;
+
+// guards the caches of this file, which are shared by all host threads
+inline cusp::detail::pool_mutex& arch_mutex(void)
+{
+    static cusp::detail::once_value<cusp::detail::pool_mutex *> mutex;
+    return *cusp::detail::initialize_once(mutex, cusp::detail::new_instance<cusp::detail::pool_mutex>);
+}
+
+inline occupancy_map& occupancy_cache(void)
+{
+    static cusp::detail::once_value<occupancy_map *> cache;
+    return *cusp::detail::initialize_once(cache, cusp::detail::new_instance<occupancy_map>);
+}
+
+// number of occupancy results held by the cache
+inline size_t occupancy_cache_size(void)
+{
+    cusp::detail::pool_lock lock(arch_mutex());
+    return occupancy_cache().size();
+}
+
 template <typename KernelFunction>
-size_t max_active_blocks(KernelFunction kernel, const size_t CTA_SIZE, const size_t dynamic_smem_bytes)
+size_t query_max_active_blocks(KernelFunction kernel, const size_t CTA_SIZE, const size_t dynamic_smem_bytes)
 {
 #if THRUST_VERSION >= 100600
   return thrust::system::cuda::detail::arch::max_active_blocks(kernel, CTA_SIZE, dynamic_smem_bytes);
@@ -43,6 +94,216 @@ size_t max_active_blocks(KernelFunction kernel, const size_t CTA_SIZE, const siz
 #endif
 }
 
+template <typename KernelFunction>
+size_t max_active_blocks(KernelFunction kernel, const size_t CTA_SIZE, const size_t dynamic_smem_bytes)
+{
+    int device = 0;
+
+    if (cudaGetDevice(&device) != cudaSuccess)
+    {
+        cudaGetLastError();
+        device = -1;
+    }
+
+    const occupancy_key key((const void *) kernel, CTA_SIZE, dynamic_smem_bytes, device);
+
+    {
+        cusp::detail::pool_lock lock(arch_mutex());
+
+        occupancy_map::const_iterator iter = occupancy_cache().find(key);
+
+        if (iter != occupancy_cache().end())
+            return iter->second;
+    }
+
+    // query outside of the lock, two threads may store the same result
+    const size_t num_blocks = query_max_active_blocks(kernel, CTA_SIZE, dynamic_smem_bytes);
+
+    cusp::detail::pool_lock lock(arch_mutex());
+    occupancy_cache()[key] = num_blocks;
+
+    return num_blocks;
+}
+
+// Launch tuning per device.  The properties of a device are queried when
+// a kernel is first launched on it, and a kernel launch looks up the
+// tuning of the current device by its compute capability.  Kernels that
+// take their block size at runtime use block_size(), and grid-stride
+// kernels cap their grid at max_blocks() instead of a single round of
+// resident blocks.
+
+struct device_info
+{
+    int    sm_version;                       // 10 * major + minor, 0 if unknown
+    size_t num_multiprocessors;
+    size_t max_threads_per_multiprocessor;
+    size_t total_global_memory;              // bytes
+    size_t l2_cache_bytes;
+    bool   concurrent_managed_access;        // managed memory may be prefetched
+};
+
+struct launch_tuning
+{
+    int    sm_version;                       // least compute capability of the row
+    size_t block_size;                       // threads per block
+    size_t grid_waves;                       // rounds of resident blocks per grid
+};
+
+inline int device_count(void)
+{
+    int num_devices = 0;
+
+    if (cudaGetDeviceCount(&num_devices) != cudaSuccess)
+    {
+        cudaGetLastError();
+        num_devices = 0;
+    }
+
+    return num_devices;
+}
+
+inline device_info query_device_info(const int device)
+{
+    device_info info;
+    cudaDeviceProp properties;
+
+    if (cudaGetDeviceProperties(&properties, device) != cudaSuccess)
+    {
+        cudaGetLastError();
+        info.sm_version                     = 0;
+        info.num_multiprocessors            = 1;
+        info.max_threads_per_multiprocessor = 0;
+        info.total_global_memory            = 0;
+        info.l2_cache_bytes                 = 0;
+        info.concurrent_managed_access      = false;
+        return info;
+    }
+
+    info.sm_version                     = 10 * properties.major + properties.minor;
+    info.num_multiprocessors            = properties.multiProcessorCount;
+    info.max_threads_per_multiprocessor = properties.maxThreadsPerMultiProcessor;
+    info.total_global_memory            = properties.totalGlobalMem;
+    info.l2_cache_bytes                 = properties.l2CacheSize;
+#if CUDART_VERSION >= 8000
+    info.concurrent_managed_access      = properties.concurrentManagedAccess != 0;
+#else
+    info.concurrent_managed_access      = false;
+#endif
+
+    return info;
+}
+
+inline std::vector<device_info> query_device_info(void)
+{
+    const int num_devices = device_count();
+
+    std::vector<device_info> info(num_devices);
+
+    for (int i = 0; i < num_devices; i++)
+        info[i] = query_device_info(i);
+
+    return info;
+}
+
+// The slots are allocated once, so that the returned references remain
+// valid while other devices are queried.
+struct device_info_slots
+{
+    std::vector<device_info> info;
+    std::vector<char>        queried;
+};
+
+inline device_info_slots * new_device_info_slots(void)
+{
+    const int num_devices = device_count();
+
+    device_info_slots * slots = new device_info_slots;
+    slots->info.resize(num_devices);
+    slots->queried.resize(num_devices, 0);
+
+    return slots;
+}
+
+inline const device_info& current_device_info(void)
+{
+    static cusp::detail::once_value<device_info_slots *> slots;
+    static const device_info unknown = {0, 1, 0, 0, 0, false};
+
+    device_info_slots& cache = *cusp::detail::initialize_once(slots, new_device_info_slots);
+
+    std::vector<device_info>& info    = cache.info;
+    std::vector<char>&        queried = cache.queried;
+
+    int device = 0;
+
+    if (cudaGetDevice(&device) != cudaSuccess)
+    {
+        cudaGetLastError();
+        return unknown;
+    }
+
+    if (device < 0 || static_cast<size_t>(device) >= info.size())
+        return unknown;
+
+    cusp::detail::pool_lock lock(arch_mutex());
+
+    if (!queried[device])
+    {
+        info[device]    = query_device_info(device);
+        queried[device] = 1;
+    }
+
+    return info[device];
+}
+
+inline const launch_tuning& tuning(const int sm_version)
+{
+    static const launch_tuning table[] =
+    {
+        {  0, 256, 1 },   // GT200: 1024 threads and 8 blocks per multiprocessor
+        { 20, 192, 1 },   // Fermi: 1536 threads and 8 blocks per multiprocessor
+        { 30, 256, 1 },   // Kepler to Pascal: 2048 threads per multiprocessor
+        { 70, 256, 2 }    // Volta and newer: balance the grid-stride loops over
+                          // irregular rows across the many multiprocessors
+    };
+
+    const size_t num_rows = sizeof(table) / sizeof(table[0]);
+
+    size_t i = 0;
+    while (i + 1 < num_rows && table[i + 1].sm_version <= sm_version)
+        i++;
+
+    return table[i];
+}
+
+inline const launch_tuning& current_tuning(void)
+{
+    return tuning(current_device_info().sm_version);
+}
+
+// threads per block of a kernel whose block size is a runtime parameter
+inline size_t block_size(void)
+{
+    return current_tuning().block_size;
+}
+
+// maximum number of blocks of a grid-stride kernel on the current device
+template <typename KernelFunction>
+size_t max_blocks(KernelFunction kernel, const size_t CTA_SIZE, const size_t dynamic_smem_bytes)
+{
+    return current_tuning().grid_waves * max_active_blocks(kernel, CTA_SIZE, dynamic_smem_bytes);
+}
+
+// Matrices with at most this many rows (plus entries outside of a
+// regular structure) occupy at most one block per multiprocessor with a
+// thread per row, so that the cost of their product is dominated by the
+// number of launches rather than by the work of each launch.  Formats
+// with several kernels use a single one for them.
+inline size_t small_launch_size(void)
+{
+    return current_device_info().num_multiprocessors * block_size();
+}
+
 } // end namespace arch
 } // end namespace device
 } // end namespace detail
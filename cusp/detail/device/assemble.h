@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/array1d.h>
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/atomic.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/utils.h>
+
+#include <thrust/device_ptr.h>
+#include <thrust/reduce.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/permutation_iterator.h>
+
+#include <algorithm>
+
+// Scatter-add of element matrix entries into the values of an assembled
+// matrix, y[slots[t]] += x[t], with atomic additions.  Targets without
+// atomics sort the entries by slot and reduce them instead.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+template <typename IndexType, typename ValueType>
+__global__ void
+assemble_scatter_add_kernel(const IndexType num_entries,
+                            const IndexType * slots,
+                            const ValueType * x,
+                                  ValueType * y)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType n = thread_id; n < num_entries; n += grid_size)
+        atomic_add(y + slots[n], x[n]);
+}
+
+template <typename IndexType, typename ValueType>
+bool assemble_atomics_supported(void)
+{
+    static cusp::detail::once_value<bool> supported;
+
+    return cusp::detail::initialize_once(supported, make_atomic_add_query(assemble_scatter_add_kernel<IndexType, ValueType>));
+}
+
+// y[slots[t]] += x[t] for t < num_entries
+template <typename IndexType, typename ValueType>
+void assemble_scatter_add(const size_t num_entries,
+                          const IndexType * slots,
+                          const ValueType * x,
+                                ValueType * y)
+{
+    if (num_entries == 0)
+        return;
+
+    if (assemble_atomics_supported<IndexType,ValueType>())
+    {
+        const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+        const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(assemble_scatter_add_kernel<IndexType,ValueType>, BLOCK_SIZE, (size_t) 0);
+        const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(num_entries, BLOCK_SIZE));
+
+        assemble_scatter_add_kernel<IndexType,ValueType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+            (IndexType(num_entries), slots, x, y);
+    }
+    else
+    {
+        thrust::device_ptr<const IndexType> slots_ptr(slots);
+        thrust::device_ptr<const ValueType> x_ptr(x);
+        thrust::device_ptr<ValueType>       y_ptr(y);
+
+        cusp::array1d<IndexType, cusp::device_memory> keys(slots_ptr, slots_ptr + num_entries);
+        cusp::array1d<ValueType, cusp::device_memory> entries(x_ptr, x_ptr + num_entries);
+
+        thrust::sort_by_key(keys.begin(), keys.end(), entries.begin());
+
+        cusp::array1d<IndexType, cusp::device_memory> unique_slots(num_entries);
+        cusp::array1d<ValueType, cusp::device_memory> sums(num_entries);
+
+        const size_t num_slots =
+          thrust::reduce_by_key(keys.begin(), keys.end(),
+                                entries.begin(),
+                                unique_slots.begin(),
+                                sums.begin()).first - unique_slots.begin();
+
+        thrust::transform(sums.begin(), sums.begin() + num_slots,
+                          thrust::make_permutation_iterator(y_ptr, unique_slots.begin()),
+                          thrust::make_permutation_iterator(y_ptr, unique_slots.begin()),
+                          thrust::plus<ValueType>());
+    }
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
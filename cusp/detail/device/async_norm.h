@@ -0,0 +1,155 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/transform_reduce.h>
+
+#include <thrust/functional.h>
+
+#include <cmath>
+
+// Euclidean norms that are read back without blocking the host.
+//
+// launch() reduces ||r||^2 on the current stream into device memory and
+// enqueues a copy of the result to pinned host memory followed by an
+// event, so the host thread continues to issue work.  reduce() only
+// enqueues the reduction, into a given location in device memory, from
+// which launch_copy() may later copy it.  ready() polls the event and
+// wait() blocks on it; either one makes the norm available through
+// value().  At most one norm is in flight per object.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+template <typename ValueType>
+class async_norm
+{
+    public:
+    typedef typename norm_type<ValueType>::type Real;
+
+    async_norm(void)
+        : partials(TRANSFORM_REDUCE_BLOCK_SIZE + 1), result(0), event(0), pending(false), value_(0)
+    {}
+
+    // the state of an operation in flight is not copied
+    async_norm(const async_norm&)
+        : partials(TRANSFORM_REDUCE_BLOCK_SIZE + 1), result(0), event(0), pending(false), value_(0)
+    {}
+
+    ~async_norm(void)
+    {
+        if (pending)
+            cudaEventSynchronize(event);
+        if (event)
+            cudaEventDestroy(event);
+        if (result)
+            cudaFreeHost(result);
+    }
+
+    // enqueue ||r||^2 into square, a value in device memory
+    template <typename Array>
+    void reduce(const Array& r, ValueType * square)
+    {
+        const ValueType * r_ptr = thrust::raw_pointer_cast(&r[0]);
+
+        transform_reduce_async(r.size(), r_ptr, r_ptr,
+                               cusp::blas::detail::norm_squared_transform<ValueType>(), thrust::plus<ValueType>(), ValueType(0),
+                               thrust::raw_pointer_cast(&partials[0]), square);
+    }
+
+    // enqueue ||r|| and its copy to the host
+    template <typename Array>
+    void launch(const Array& r)
+    {
+        ValueType * square = thrust::raw_pointer_cast(&partials[0]) + TRANSFORM_REDUCE_BLOCK_SIZE;
+
+        reduce(r, square);
+        launch_copy(square);
+    }
+
+    // enqueue the copy of a square that was reduced into device memory
+    void launch_copy(const ValueType * square)
+    {
+        if (!result)
+        {
+            check_cuda(cudaMallocHost((void **) &result, sizeof(ValueType)), "cudaMallocHost failed");
+            check_cuda(cudaEventCreateWithFlags(&event, cudaEventDisableTiming), "cudaEventCreate failed");
+        }
+
+        cudaStream_t stream = cusp::detail::current_stream();
+
+        check_cuda(cudaMemcpyAsync(result, square, sizeof(ValueType), cudaMemcpyDeviceToHost, stream), "cudaMemcpyAsync failed");
+        check_cuda(cudaEventRecord(event, stream), "cudaEventRecord failed");
+
+        pending = true;
+    }
+
+    // whether a launched norm is not yet consumed
+    bool is_pending(void) const { return pending; }
+
+    // whether the launched norm has arrived, without blocking
+    bool ready(void)
+    {
+        if (!pending || cudaEventQuery(event) != cudaSuccess)
+            return false;
+
+        consume();
+        return true;
+    }
+
+    // block until the launched norm has arrived
+    void wait(void)
+    {
+        if (!pending)
+            return;
+
+        check_cuda(cudaEventSynchronize(event), "cudaEventSynchronize failed");
+        consume();
+    }
+
+    Real value(void) const { return value_; }
+
+    private:
+    cusp::array1d<ValueType, cusp::device_memory> partials;
+    ValueType * result;
+    cudaEvent_t event;
+    bool pending;
+    Real value_;
+
+    void consume(void)
+    {
+        using namespace std;
+        value_ = sqrt(abs(*result));
+        pending = false;
+    }
+
+    async_norm& operator=(const async_norm&);
+};
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
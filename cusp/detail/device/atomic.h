@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/complex.h>
+
+#include <thrust/detail/type_traits.h>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+// Atomic addition to a value in global or shared memory.  The float and
+// double versions require sm_20 and do nothing on earlier targets, callers
+// check atomic_add_supported() and use a different method there.
+
+__device__ __inline__ void atomic_add(float * address, const float value)
+{
+#if __CUDA_ARCH__ >= 200
+    atomicAdd(address, value);
+#endif
+}
+
+__device__ __inline__ void atomic_add(double * address, const double value)
+{
+#if __CUDA_ARCH__ >= 200
+    unsigned long long int * address_as_ull = reinterpret_cast<unsigned long long int *>(address);
+    unsigned long long int old = *address_as_ull;
+    unsigned long long int assumed;
+
+    do
+    {
+        assumed = old;
+        old = atomicCAS(address_as_ull, assumed, __double_as_longlong(value + __longlong_as_double(assumed)));
+    } while (assumed != old);
+#endif
+}
+
+template <typename RealType>
+__device__ __inline__ void atomic_add(cusp::complex<RealType> * address, const cusp::complex<RealType> value)
+{
+    // cusp::complex<T> has the layout T[2]
+    RealType * parts = reinterpret_cast<RealType *>(address);
+    atomic_add(parts + 0, value.real());
+    atomic_add(parts + 1, value.imag());
+}
+
+__device__ __inline__ void atomic_add(int * address, const int value)
+{
+    atomicAdd(address, value);
+}
+
+__device__ __inline__ void atomic_add(unsigned int * address, const unsigned int value)
+{
+    atomicAdd(address, value);
+}
+
+// value types with an atomic_add
+template <typename T> struct has_atomic_add : thrust::detail::false_type {};
+template <> struct has_atomic_add<int>          : thrust::detail::true_type {};
+template <> struct has_atomic_add<unsigned int> : thrust::detail::true_type {};
+template <> struct has_atomic_add<float>        : thrust::detail::true_type {};
+template <> struct has_atomic_add<double>       : thrust::detail::true_type {};
+template <typename RealType> struct has_atomic_add< cusp::complex<RealType> > : has_atomic_add<RealType> {};
+
+// true when kernel was compiled for a target on which atomic_add is available
+template <typename KernelFunction>
+bool atomic_add_supported(KernelFunction kernel)
+{
+    cudaFuncAttributes attributes;
+
+    if (cudaFuncGetAttributes(&attributes, kernel) == cudaSuccess)
+        return attributes.ptxVersion >= 20;
+
+    cudaGetLastError();
+    return false;
+}
+
+// atomic_add_supported(kernel) as an initializer of initialize_once()
+template <typename KernelFunction>
+struct atomic_add_query
+{
+    KernelFunction kernel;
+
+    atomic_add_query(KernelFunction kernel) : kernel(kernel) {}
+
+    bool operator()(void) const
+    {
+        return atomic_add_supported(kernel);
+    }
+};
+
+template <typename KernelFunction>
+atomic_add_query<KernelFunction> make_atomic_add_query(KernelFunction kernel)
+{
+    return atomic_add_query<KernelFunction>(kernel);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
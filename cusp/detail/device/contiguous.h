@@ -0,0 +1,121 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/format.h>
+
+#include <cusp/detail/implicit_copy.h>
+
+#include <thrust/copy.h>
+#include <thrust/device_ptr.h>
+#include <thrust/detail/type_traits.h>
+#include <thrust/iterator/detail/normal_iterator.h>
+
+// Device vectors whose storage may be handed to kernels as a raw
+// pointer: the device containers and the views of device pointers.  The
+// kernels take the address of the first element, which is wrong for
+// strided and other fancy iterators, so such vectors are staged through
+// contiguous temporaries.  Matrix operands are consumed in place.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+template <typename Iterator> struct is_device_contiguous_iterator                                         : thrust::detail::false_type {};
+template <typename T>        struct is_device_contiguous_iterator< thrust::device_ptr<T> >                : thrust::detail::true_type  {};
+template <typename Pointer>  struct is_device_contiguous_iterator< thrust::detail::normal_iterator<Pointer> > : thrust::detail::true_type  {};
+
+template <typename Operand, typename Format = typename Operand::format>
+struct is_device_contiguous_operand : thrust::detail::true_type {};
+
+template <typename Operand>
+struct is_device_contiguous_operand<Operand, cusp::array1d_format>
+  : is_device_contiguous_iterator<typename Operand::iterator> {};
+
+// An operand of a kernel: contiguous operands are referenced in place,
+// other vectors are copied to a contiguous temporary when they are read
+// and copied back by store() when they are written.
+template <typename Vector, bool Contiguous = is_device_contiguous_operand<Vector>::value>
+class contiguous_operand
+{
+    public:
+    typedef cusp::array1d<typename Vector::value_type, cusp::device_memory> vector_type;
+
+    // load the values of an input
+    explicit contiguous_operand(const Vector& v)
+        : vector(checked(v)) {}
+
+    // allocate an output of the same size without loading it
+    contiguous_operand(const Vector& v, bool)
+        : vector(checked_size(v)) {}
+
+    vector_type& get(void)
+    {
+        return vector;
+    }
+
+    void store(Vector& v) const
+    {
+        thrust::copy(vector.begin(), vector.end(), v.begin());
+    }
+
+    private:
+    vector_type vector;
+
+    static const Vector& checked(const Vector& v)
+    {
+        cusp::detail::check_implicit_copy("staging of a strided device vector");
+        return v;
+    }
+
+    static size_t checked_size(const Vector& v)
+    {
+        return checked(v).size();
+    }
+};
+
+template <typename Vector>
+class contiguous_operand<Vector, true>
+{
+    public:
+    typedef Vector vector_type;
+
+    explicit contiguous_operand(Vector& v)
+        : vector(v) {}
+
+    contiguous_operand(Vector& v, bool)
+        : vector(v) {}
+
+    Vector& get(void)
+    {
+        return vector;
+    }
+
+    void store(Vector&) const {}
+
+    private:
+    Vector& vector;
+};
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
@@ -22,25 +22,37 @@
 #include <cusp/format.h>
 #include <cusp/coo_matrix.h>
 #include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
 
 #include <cusp/detail/format_utils.h>
 #include <cusp/detail/device/conversion_utils.h>
 #include <cusp/detail/host/convert.h>
 
+#include <thrust/binary_search.h>
 #include <thrust/count.h>
+#include <thrust/equal.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
 #include <thrust/gather.h>
 #include <thrust/inner_product.h>
+#include <thrust/reduce.h>
 #include <thrust/replace.h>
 #include <thrust/scan.h>
 #include <thrust/scatter.h>
 #include <thrust/sequence.h>
+#include <thrust/sort.h>
 #include <thrust/tuple.h>
+#include <thrust/unique.h>
 
 #include <thrust/iterator/constant_iterator.h>
 #include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
 #include <thrust/iterator/zip_iterator.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace cusp
 {
@@ -54,6 +66,9 @@ namespace device
 //     <- ELL
 //     <- DIA
 //     <- HYB
+//     <- BSR
+//     <- SELL
+//     <- CSR16
 // CSR <- COO
 //     <- ELL
 //     <- DIA
@@ -64,6 +79,9 @@ namespace device
 // HYB <- CSR
 //     <- COO
 //     <- ELL
+// BSR <- COO
+// SELL <- COO
+// CSR16 <- COO
 
 template <typename IndexType>
 struct is_valid_ell_index
@@ -244,6 +262,26 @@ struct less_than
   __host__ __device__ bool operator()(const T &x) const {return x < num;}
 };
 
+// entries (i,j) with lower <= j - i <= upper
+template <typename IndexType>
+struct is_in_band
+{
+  const IndexType lower;
+  const IndexType upper;
+
+  is_in_band(const IndexType lower, const IndexType upper)
+    : lower(lower), upper(upper) {}
+
+  template <typename Tuple>
+    __host__ __device__
+  bool operator()(const Tuple& t) const
+  {
+    const IndexType offset = thrust::get<1>(t) - thrust::get<0>(t);
+
+    return lower <= offset && offset <= upper;
+  }
+};
+
 template <typename IndexType>
 struct is_positive
 {
@@ -254,6 +292,269 @@ struct is_positive
   }
 };
 
+template <typename IndexType>
+struct bsr_row_index_functor
+{
+  typedef IndexType result_type;
+
+  const IndexType block_size;
+
+  bsr_row_index_functor(const IndexType block_size)
+    : block_size(block_size) {}
+
+  template <typename Tuple>
+    __host__ __device__
+  IndexType operator()(const Tuple& t) const
+  {
+    const IndexType block_row = thrust::get<0>(t);
+    const IndexType n         = thrust::get<1>(t);
+
+    return block_row * block_size + (n % (block_size * block_size)) / block_size;
+  }
+};
+
+template <typename IndexType>
+struct bsr_column_index_functor
+{
+  typedef IndexType result_type;
+
+  const IndexType block_size;
+
+  bsr_column_index_functor(const IndexType block_size)
+    : block_size(block_size) {}
+
+  template <typename Tuple>
+    __host__ __device__
+  IndexType operator()(const Tuple& t) const
+  {
+    const IndexType block_col = thrust::get<0>(t);
+    const IndexType n         = thrust::get<1>(t);
+
+    return block_col * block_size + n % block_size;
+  }
+};
+
+template <typename IndexType>
+struct bsr_entry_offset_functor
+{
+  typedef IndexType result_type;
+
+  const IndexType block_size;
+
+  bsr_entry_offset_functor(const IndexType block_size)
+    : block_size(block_size) {}
+
+  template <typename Tuple>
+    __host__ __device__
+  IndexType operator()(const Tuple& t) const
+  {
+    const IndexType i     = thrust::get<0>(t);
+    const IndexType j     = thrust::get<1>(t);
+    const IndexType block = thrust::get<2>(t);
+
+    return block * block_size * block_size + (i % block_size) * block_size + j % block_size;
+  }
+};
+
+template <typename IndexType>
+struct sell_row_order
+{
+  // by window, then by decreasing row length
+  template <typename Tuple>
+    __host__ __device__
+  bool operator()(const Tuple& a, const Tuple& b) const
+  {
+    if (thrust::get<0>(a) != thrust::get<0>(b))
+      return thrust::get<0>(a) < thrust::get<0>(b);
+
+    return thrust::get<1>(a) > thrust::get<1>(b);
+  }
+};
+
+template <typename IndexType>
+struct sell_entry_index_functor
+{
+  typedef IndexType result_type;
+
+  const IndexType slice_size;
+
+  sell_entry_index_functor(const IndexType slice_size)
+    : slice_size(slice_size) {}
+
+  template <typename Tuple>
+    __host__ __device__
+  IndexType operator()(const Tuple& t) const
+  {
+    const IndexType k      = thrust::get<0>(t);  // position of the row
+    const IndexType n      = thrust::get<1>(t);  // position of the entry within the row
+    const IndexType offset = thrust::get<2>(t);  // offset of the slice
+
+    return offset + n * slice_size + k % slice_size;
+  }
+};
+
+template <typename IndexType>
+struct sell_row_position_functor
+{
+  typedef IndexType result_type;
+
+  const IndexType slice_size;
+
+  sell_row_position_functor(const IndexType slice_size)
+    : slice_size(slice_size) {}
+
+  template <typename Tuple>
+    __host__ __device__
+  IndexType operator()(const Tuple& t) const
+  {
+    const IndexType s      = thrust::get<0>(t);  // slice
+    const IndexType p      = thrust::get<1>(t);  // stored entry
+    const IndexType offset = thrust::get<2>(t);  // offset of the slice
+
+    return s * slice_size + (p - offset) % slice_size;
+  }
+};
+
+template <typename IndexType>
+struct is_valid_sell_index
+{
+  __host__ __device__
+  bool operator()(const IndexType j) const
+  {
+    return j != IndexType(-1);
+  }
+};
+
+template <typename IndexType>
+struct is_csr16_offset
+{
+  const size_t max_offset;
+  const bool   compressed;
+
+  is_csr16_offset(const size_t max_offset, const bool compressed)
+    : max_offset(max_offset), compressed(compressed) {}
+
+  // true if the column is within max_offset of the base of its row
+  template <typename Tuple>
+    __host__ __device__
+  bool operator()(const Tuple& t) const
+  {
+    const IndexType j    = thrust::get<0>(t);
+    const IndexType base = thrust::get<1>(t);
+
+    return (size_t(j - base) <= max_offset) == compressed;
+  }
+};
+
+template <typename IndexType, typename OffsetType>
+struct csr16_offset_functor
+{
+  typedef OffsetType result_type;
+
+  template <typename Tuple>
+    __host__ __device__
+  OffsetType operator()(const Tuple& t) const
+  {
+    return OffsetType(thrust::get<0>(t) - thrust::get<1>(t));
+  }
+};
+
+template <typename IndexType>
+struct csr16_column_functor
+{
+  typedef IndexType result_type;
+
+  template <typename Tuple>
+    __host__ __device__
+  IndexType operator()(const Tuple& t) const
+  {
+    return thrust::get<1>(t) + IndexType(thrust::get<0>(t));
+  }
+};
+
+// writes the first num_entries_per_row entries of row i of a CSR matrix
+// to column i of the ELL arrays and pads the remainder of the column
+template <typename OffsetType, typename IndexType, typename ValueType>
+struct csr_to_ell_row_functor
+{
+  const OffsetType * Ap;
+  const IndexType  * Aj;
+  const ValueType  * Ax;
+        IndexType  * Ej;
+        ValueType  * Ex;
+  const size_t pitch;
+  const size_t num_entries_per_row;
+
+  csr_to_ell_row_functor(const OffsetType * Ap, const IndexType * Aj, const ValueType * Ax,
+                         IndexType * Ej, ValueType * Ex,
+                         const size_t pitch, const size_t num_entries_per_row)
+    : Ap(Ap), Aj(Aj), Ax(Ax), Ej(Ej), Ex(Ex), pitch(pitch), num_entries_per_row(num_entries_per_row) {}
+
+  template <typename SizeType>
+    __host__ __device__
+  void operator()(const SizeType i) const
+  {
+    const OffsetType row_end = Ap[i + 1];
+
+    OffsetType jj = Ap[i];
+    size_t     n  = 0;
+
+    for (; jj < row_end && n < num_entries_per_row; jj++, n++)
+    {
+      Ej[i + n * pitch] = Aj[jj];
+      Ex[i + n * pitch] = Ax[jj];
+    }
+
+    for (; n < num_entries_per_row; n++)
+    {
+      Ej[i + n * pitch] = IndexType(-1);
+      Ex[i + n * pitch] = ValueType(0);
+    }
+  }
+};
+
+// number of entries of row i that do not fit in the ELL portion of a HYB matrix
+template <typename OffsetType, typename IndexType>
+struct csr_to_hyb_coo_length : public thrust::unary_function<IndexType,IndexType>
+{
+  const OffsetType * Ap;
+  const size_t num_entries_per_row;
+
+  csr_to_hyb_coo_length(const OffsetType * Ap, const size_t num_entries_per_row)
+    : Ap(Ap), num_entries_per_row(num_entries_per_row) {}
+
+    __host__ __device__
+  IndexType operator()(const IndexType i) const
+  {
+    const size_t length = Ap[i + 1] - Ap[i];
+
+    return length > num_entries_per_row ? IndexType(length - num_entries_per_row) : IndexType(0);
+  }
+};
+
+// CSR index of the n-th entry of the COO portion of a HYB matrix, given
+// its row i and the COO offset of each row
+template <typename OffsetType, typename IndexType>
+struct csr_to_hyb_coo_index : public thrust::unary_function<thrust::tuple<IndexType,IndexType>,OffsetType>
+{
+  const OffsetType * Ap;
+  const IndexType  * coo_offsets;
+  const size_t num_entries_per_row;
+
+  csr_to_hyb_coo_index(const OffsetType * Ap, const IndexType * coo_offsets, const size_t num_entries_per_row)
+    : Ap(Ap), coo_offsets(coo_offsets), num_entries_per_row(num_entries_per_row) {}
+
+  template <typename Tuple>
+    __host__ __device__
+  OffsetType operator()(const Tuple& t) const
+  {
+    const IndexType n = thrust::get<0>(t);
+    const IndexType i = thrust::get<1>(t);
+
+    return Ap[i] + OffsetType(num_entries_per_row) + OffsetType(n - coo_offsets[i]);
+  }
+};
+
 /////////
 // COO //
 /////////
@@ -378,11 +679,208 @@ void hyb_to_coo(const Matrix1& src, Matrix2& dst)
    thrust::copy(src.coo.values.begin(),         src.coo.values.end(),         dst.values.begin()         + temp.num_entries);
 
    if (temp.num_entries > 0 && src.coo.num_entries > 0)
-     cusp::detail::sort_by_row_and_column(dst.row_indices, dst.column_indices, dst.values); 
+     cusp::detail::sort_by_row_and_column(dst.row_indices, dst.column_indices, dst.values, dst.num_rows, dst.num_cols); 
+}
+
+template <typename Matrix1, typename Matrix2>
+void dia_coo_to_coo(const Matrix1& src, Matrix2& dst)
+{
+   typedef typename Matrix1::coo_matrix_type  CooMatrixType;
+   typedef typename CooMatrixType::container  CooMatrix;
+
+   // convert dia portion to coo
+   CooMatrix temp;
+   dia_to_coo(src.dia, temp);
+
+   // resize output
+   dst.resize(src.num_rows, src.num_cols, temp.num_entries + src.coo.num_entries);
+
+   // merge coo matrices together
+   thrust::copy(temp.row_indices.begin(),    temp.row_indices.end(),    dst.row_indices.begin());
+   thrust::copy(temp.column_indices.begin(), temp.column_indices.end(), dst.column_indices.begin());
+   thrust::copy(temp.values.begin(),         temp.values.end(),         dst.values.begin());
+   thrust::copy(src.coo.row_indices.begin(),    src.coo.row_indices.end(),    dst.row_indices.begin()    + temp.num_entries);
+   thrust::copy(src.coo.column_indices.begin(), src.coo.column_indices.end(), dst.column_indices.begin() + temp.num_entries);
+   thrust::copy(src.coo.values.begin(),         src.coo.values.end(),         dst.values.begin()         + temp.num_entries);
+
+   if (temp.num_entries > 0 && src.coo.num_entries > 0)
+     cusp::detail::sort_by_row_and_column(dst.row_indices, dst.column_indices, dst.values, dst.num_rows, dst.num_cols);
 }
    
 
 
+template <typename Matrix1, typename Matrix2>
+void symmetric_csr_to_coo(const Matrix1& src, Matrix2& dst)
+{
+   typedef typename Matrix1::index_type IndexType;
+
+   const size_t num_stored_entries = src.num_stored_entries();
+   const IndexType n = src.num_rows;
+
+   cusp::array1d<IndexType, cusp::device_memory> rows(num_stored_entries);
+   cusp::detail::offsets_to_indices(src.row_offsets, rows);
+
+   const size_t num_mirrored_entries =
+     thrust::count_if(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), src.column_indices.begin())),
+                      thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), src.column_indices.begin())) + num_stored_entries,
+                      is_in_band<IndexType>(1, n));
+
+   // resize output
+   dst.resize(src.num_rows, src.num_cols, num_stored_entries + num_mirrored_entries);
+
+   // copy the upper triangle followed by the mirrored strictly upper entries
+   thrust::copy(rows.begin(),               rows.end(),               dst.row_indices.begin());
+   thrust::copy(src.column_indices.begin(), src.column_indices.end(), dst.column_indices.begin());
+   thrust::copy(src.values.begin(),         src.values.end(),         dst.values.begin());
+
+   thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(src.column_indices.begin(), rows.begin(), src.values.begin())),
+                   thrust::make_zip_iterator(thrust::make_tuple(src.column_indices.begin(), rows.begin(), src.values.begin())) + num_stored_entries,
+                   thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), src.column_indices.begin())),
+                   thrust::make_zip_iterator(thrust::make_tuple(dst.row_indices.begin(), dst.column_indices.begin(), dst.values.begin())) + num_stored_entries,
+                   is_in_band<IndexType>(1, n));
+
+   if (num_mirrored_entries > 0)
+     cusp::detail::sort_by_row_and_column(dst.row_indices, dst.column_indices, dst.values, dst.num_rows, dst.num_cols);
+}
+
+template <typename Matrix1, typename Matrix2>
+void bsr_to_coo(const Matrix1& src, Matrix2& dst)
+{
+   typedef typename Matrix1::index_type IndexType;
+
+   const IndexType block_size = src.block_size;
+
+   // every value of a stored block becomes an entry, including zeros
+   dst.resize(src.num_rows, src.num_cols, src.num_entries);
+
+   if( src.num_entries == 0 ) return;
+
+   // expand block row offsets into block row indices
+   cusp::array1d<IndexType, cusp::device_memory> block_rows(src.num_blocks());
+   cusp::detail::offsets_to_indices(src.row_offsets, block_rows);
+
+   // define types used to programatically generate the block of each value
+   typedef typename thrust::counting_iterator<IndexType> IndexIterator;
+   typedef typename thrust::transform_iterator<divide_value<IndexType>, IndexIterator> BlockIndexIterator;
+
+   BlockIndexIterator block_index_begin(IndexIterator(0), divide_value<IndexType>(block_size * block_size));
+
+   thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(block_rows.begin(), block_index_begin), IndexIterator(0))),
+                     thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(block_rows.begin(), block_index_begin), IndexIterator(0))) + src.num_entries,
+                     dst.row_indices.begin(),
+                     bsr_row_index_functor<IndexType>(block_size));
+   thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(src.column_indices.begin(), block_index_begin), IndexIterator(0))),
+                     thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(src.column_indices.begin(), block_index_begin), IndexIterator(0))) + src.num_entries,
+                     dst.column_indices.begin(),
+                     bsr_column_index_functor<IndexType>(block_size));
+   cusp::copy(src.values, dst.values);
+
+   // the rows of a block row are interleaved across its blocks
+   if (block_size > 1)
+     cusp::detail::sort_by_row_and_column(dst.row_indices, dst.column_indices, dst.values, dst.num_rows, dst.num_cols);
+}
+
+
+template <typename Matrix1, typename Matrix2>
+void sell_to_coo(const Matrix1& src, Matrix2& dst)
+{
+   typedef typename Matrix1::index_type IndexType;
+
+   const IndexType slice_size = src.slice_size;
+   const size_t    num_stored = src.column_indices.size();
+
+   // allocate output storage
+   dst.resize(src.num_rows, src.num_cols, src.num_entries);
+
+   if( src.num_entries == 0 ) return;
+
+   // compute the slice and the position of the row of each stored entry
+   cusp::array1d<IndexType, cusp::device_memory> slices(num_stored);
+   cusp::detail::offsets_to_indices(src.slice_offsets, slices);
+
+   cusp::array1d<IndexType, cusp::device_memory> positions(num_stored);
+   thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(slices.begin(), thrust::counting_iterator<IndexType>(0), thrust::make_permutation_iterator(src.slice_offsets.begin(), slices.begin()))),
+                     thrust::make_zip_iterator(thrust::make_tuple(slices.begin(), thrust::counting_iterator<IndexType>(0), thrust::make_permutation_iterator(src.slice_offsets.begin(), slices.begin()))) + num_stored,
+                     positions.begin(),
+                     sell_row_position_functor<IndexType>(slice_size));
+
+   // copy valid entries to COO format, then map positions to rows
+   cusp::array1d<IndexType, cusp::device_memory> valid_positions(src.num_entries);
+   thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(positions.begin(), src.column_indices.begin(), src.values.begin())),
+                   thrust::make_zip_iterator(thrust::make_tuple(positions.begin(), src.column_indices.begin(), src.values.begin())) + num_stored,
+                   src.column_indices.begin(),
+                   thrust::make_zip_iterator(thrust::make_tuple(valid_positions.begin(), dst.column_indices.begin(), dst.values.begin())),
+                   is_valid_sell_index<IndexType>());
+   thrust::gather(valid_positions.begin(), valid_positions.end(),
+                  src.row_permutation.begin(),
+                  dst.row_indices.begin());
+
+   cusp::detail::sort_by_row_and_column(dst.row_indices, dst.column_indices, dst.values, dst.num_rows, dst.num_cols);
+}
+
+template <typename Matrix1, typename Matrix2>
+void jds_to_coo(const Matrix1& src, Matrix2& dst)
+{
+   typedef typename Matrix1::index_type IndexType;
+
+   // allocate output storage
+   dst.resize(src.num_rows, src.num_cols, src.num_entries);
+
+   if( src.num_entries == 0 ) return;
+
+   // the diagonal of each entry, and the position of its row
+   cusp::array1d<IndexType, cusp::device_memory> diagonals(src.num_entries);
+   cusp::detail::offsets_to_indices(src.diagonal_offsets, diagonals);
+
+   cusp::array1d<IndexType, cusp::device_memory> positions(src.num_entries);
+   thrust::transform(thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(src.num_entries),
+                     thrust::make_permutation_iterator(src.diagonal_offsets.begin(), diagonals.begin()),
+                     positions.begin(),
+                     thrust::minus<IndexType>());
+
+   // map positions to rows
+   thrust::gather(positions.begin(), positions.end(),
+                  src.row_permutation.begin(),
+                  dst.row_indices.begin());
+   cusp::copy(src.column_indices, dst.column_indices);
+   cusp::copy(src.values,         dst.values);
+
+   cusp::detail::sort_by_row_and_column(dst.row_indices, dst.column_indices, dst.values, dst.num_rows, dst.num_cols);
+}
+
+template <typename Matrix1, typename Matrix2>
+void csr16_to_coo(const Matrix1& src, Matrix2& dst)
+{
+   typedef typename Matrix1::index_type IndexType;
+
+   const size_t num_compressed = src.values.size();
+
+   // allocate output storage
+   dst.resize(src.num_rows, src.num_cols, src.num_entries);
+
+   if( src.num_entries == 0 ) return;
+
+   // expand the compressed entries
+   cusp::array1d<IndexType, cusp::device_memory> rows(num_compressed);
+   cusp::detail::offsets_to_indices(src.row_offsets, rows);
+
+   thrust::copy(rows.begin(), rows.end(), dst.row_indices.begin());
+   thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(src.column_offsets.begin(), thrust::make_permutation_iterator(src.row_bases.begin(), rows.begin()))),
+                     thrust::make_zip_iterator(thrust::make_tuple(src.column_offsets.begin(), thrust::make_permutation_iterator(src.row_bases.begin(), rows.begin()))) + num_compressed,
+                     dst.column_indices.begin(),
+                     csr16_column_functor<IndexType>());
+   thrust::copy(src.values.begin(), src.values.end(), dst.values.begin());
+
+   // append the overflow entries
+   thrust::copy(src.overflow.row_indices.begin(),    src.overflow.row_indices.end(),    dst.row_indices.begin()    + num_compressed);
+   thrust::copy(src.overflow.column_indices.begin(), src.overflow.column_indices.end(), dst.column_indices.begin() + num_compressed);
+   thrust::copy(src.overflow.values.begin(),         src.overflow.values.end(),         dst.values.begin()         + num_compressed);
+
+   if (src.overflow.num_entries > 0)
+     cusp::detail::sort_by_row_and_column(dst.row_indices, dst.column_indices, dst.values, dst.num_rows, dst.num_cols);
+}
+
+
 /////////
 // CSR //
 /////////
@@ -664,45 +1162,32 @@ void coo_to_ell(const Matrix1& src, Matrix2& dst,
                   dst.values.values.begin());
 }
 
+// The entries of each row are written directly to their ELL positions
+// (one thread per row), so that no temporaries of size num_entries are
+// needed and the padding is written in the same pass.
 template <typename Matrix1, typename Matrix2>
 void csr_to_ell(const Matrix1& src, Matrix2& dst,
                 const size_t num_entries_per_row, const size_t alignment = 32)
 {
+  typedef typename Matrix1::row_offsets_array_type::value_type OffsetType;
   typedef typename Matrix2::index_type IndexType;
   typedef typename Matrix2::value_type ValueType;
 
   // allocate output storage
   dst.resize(src.num_rows, src.num_cols, src.num_entries, num_entries_per_row, alignment);
 
-  // expand row offsets into row indices
-  cusp::array1d<IndexType, cusp::device_memory> row_indices(src.num_entries);
-  cusp::detail::offsets_to_indices(src.row_offsets, row_indices);
-
-  // compute permutation from CSR index to ELL index
-  // first enumerate the entries within each row, e.g. [0, 1, 2, 0, 1, 2, 3, ...]
-  cusp::array1d<IndexType, cusp::device_memory> permutation(src.num_entries);
-  thrust::exclusive_scan_by_key(row_indices.begin(), row_indices.end(),
-                                thrust::constant_iterator<IndexType>(1),
-                                permutation.begin(),
-                                IndexType(0));
-  
-  // next, scale by pitch and add row index
-  cusp::blas::axpby(permutation, row_indices,
-                    permutation,
-                    IndexType(dst.column_indices.pitch),
-                    IndexType(1));
-
-  // fill output with padding
-  thrust::fill(dst.column_indices.values.begin(), dst.column_indices.values.end(), IndexType(-1));
-  thrust::fill(dst.values.values.begin(),         dst.values.values.end(),         ValueType(0));
+  if (src.num_rows == 0)
+    return;
 
-  // scatter CSR entries to ELL
-  thrust::scatter(src.column_indices.begin(), src.column_indices.end(),
-                  permutation.begin(),
-                  dst.column_indices.values.begin());
-  thrust::scatter(src.values.begin(), src.values.end(),
-                  permutation.begin(),
-                  dst.values.values.begin());
+  thrust::for_each(thrust::counting_iterator<IndexType,cusp::device_memory>(0),
+                   thrust::counting_iterator<IndexType,cusp::device_memory>(src.num_rows),
+                   csr_to_ell_row_functor<OffsetType,IndexType,ValueType>
+                       (thrust::raw_pointer_cast(&src.row_offsets[0]),
+                        thrust::raw_pointer_cast(&src.column_indices[0]),
+                        thrust::raw_pointer_cast(&src.values[0]),
+                        thrust::raw_pointer_cast(&dst.column_indices.values[0]),
+                        thrust::raw_pointer_cast(&dst.values.values[0]),
+                        dst.column_indices.pitch, num_entries_per_row));
 }
 
 
@@ -771,58 +1256,64 @@ void coo_to_hyb(const Matrix1& src, Matrix2& dst,
 //                     less_than<size_t>(dst.ell.column_indices.values.size()));
 }
 
+// As in csr_to_ell, the ELL portion is written directly from the row
+// offsets.  The entries of each row beyond num_entries_per_row are then
+// gathered into the COO portion, whose row offsets are computed by a scan
+// over the rows; only temporaries of size num_rows are needed.
 template <typename Matrix1, typename Matrix2>
 void csr_to_hyb(const Matrix1& src, Matrix2& dst,
                 const size_t num_entries_per_row, const size_t alignment = 32)
 {
+  typedef typename Matrix1::row_offsets_array_type::value_type OffsetType;
   typedef typename Matrix2::index_type IndexType;
   typedef typename Matrix2::value_type ValueType;
 
-  // expand row offsets into row indices
-  cusp::array1d<IndexType, cusp::device_memory> row_indices(src.num_entries);
-  cusp::detail::offsets_to_indices(src.row_offsets, row_indices);
+  if (src.num_rows == 0)
+  {
+    dst.resize(src.num_rows, src.num_cols, 0, 0, num_entries_per_row, alignment);
+    return;
+  }
 
-  // TODO call coo_to_hyb with a coo_matrix_view
+  const OffsetType * Ap = thrust::raw_pointer_cast(&src.row_offsets[0]);
 
-  cusp::array1d<IndexType, cusp::device_memory> indices(src.num_entries);
-  thrust::exclusive_scan_by_key(row_indices.begin(), row_indices.end(),
-                                thrust::constant_iterator<IndexType>(1),
-                                indices.begin(),
-                                IndexType(0));
+  // compute the offset of each row in the COO portion
+  cusp::array1d<IndexType, cusp::device_memory> coo_offsets(src.num_rows + 1);
+  coo_offsets[0] = 0;
+  thrust::inclusive_scan(thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0),
+                                                         csr_to_hyb_coo_length<OffsetType,IndexType>(Ap, num_entries_per_row)),
+                         thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(src.num_rows),
+                                                         csr_to_hyb_coo_length<OffsetType,IndexType>(Ap, num_entries_per_row)),
+                         coo_offsets.begin() + 1);
 
-  size_t num_coo_entries = thrust::count_if(indices.begin(), indices.end(), greater_than_or_equal_to<size_t>(num_entries_per_row));
+  size_t num_coo_entries = coo_offsets[src.num_rows];
   size_t num_ell_entries = src.num_entries - num_coo_entries;
 
   // allocate output storage
   dst.resize(src.num_rows, src.num_cols, num_ell_entries, num_coo_entries, num_entries_per_row, alignment);
 
-  // fill output with padding
-  thrust::fill(dst.ell.column_indices.values.begin(), dst.ell.column_indices.values.end(), IndexType(-1));
-  thrust::fill(dst.ell.values.values.begin(),         dst.ell.values.values.end(),         ValueType(0));
-
-  thrust::copy_if(thrust::make_zip_iterator( thrust::make_tuple( row_indices.begin(), src.column_indices.begin(), src.values.begin() ) ),
-  		  thrust::make_zip_iterator( thrust::make_tuple( row_indices.end()  , src.column_indices.end()  , src.values.end()   ) ),
-                  indices.begin(),
-  		  thrust::make_zip_iterator( thrust::make_tuple( dst.coo.row_indices.begin(), dst.coo.column_indices.begin(), dst.coo.values.begin() ) ),
-		  greater_than_or_equal_to<size_t>(num_entries_per_row) );
+  // write the head of each row, and the padding, to the ELL portion
+  thrust::for_each(thrust::counting_iterator<IndexType,cusp::device_memory>(0),
+                   thrust::counting_iterator<IndexType,cusp::device_memory>(src.num_rows),
+                   csr_to_ell_row_functor<OffsetType,IndexType,ValueType>
+                       (Ap,
+                        thrust::raw_pointer_cast(&src.column_indices[0]),
+                        thrust::raw_pointer_cast(&src.values[0]),
+                        thrust::raw_pointer_cast(&dst.ell.column_indices.values[0]),
+                        thrust::raw_pointer_cast(&dst.ell.values.values[0]),
+                        dst.ell.column_indices.pitch, num_entries_per_row));
+
+  if (num_coo_entries == 0)
+    return;
 
-  // next, scale by pitch and add row index
-  cusp::blas::axpby(indices, row_indices,
-                    indices,
-                    IndexType(dst.ell.column_indices.pitch),
-                    IndexType(1));
+  // gather the tail of each row into the COO portion
+  cusp::detail::offsets_to_indices(coo_offsets, dst.coo.row_indices);
 
-  // scatter CSR entries to ELL
-  thrust::scatter_if(src.column_indices.begin(), src.column_indices.end(),
-                     indices.begin(),
-                     indices.begin(),
-                     dst.ell.column_indices.values.begin(),
-		     less_than<size_t>(dst.ell.column_indices.values.size()));
-  thrust::scatter_if(src.values.begin(), src.values.end(),
-                     indices.begin(),
-                     indices.begin(),
-                     dst.ell.values.values.begin(),
-		     less_than<size_t>(dst.ell.values.values.size()));
+  thrust::gather(thrust::make_transform_iterator(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), dst.coo.row_indices.begin())),
+                                                 csr_to_hyb_coo_index<OffsetType,IndexType>(Ap, thrust::raw_pointer_cast(&coo_offsets[0]), num_entries_per_row)),
+                 thrust::make_transform_iterator(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), dst.coo.row_indices.begin())),
+                                                 csr_to_hyb_coo_index<OffsetType,IndexType>(Ap, thrust::raw_pointer_cast(&coo_offsets[0]), num_entries_per_row)) + num_coo_entries,
+                 thrust::make_zip_iterator(thrust::make_tuple(src.column_indices.begin(), src.values.begin())),
+                 thrust::make_zip_iterator(thrust::make_tuple(dst.coo.column_indices.begin(), dst.coo.values.begin())));
 }
 
 template <typename Matrix1, typename Matrix2>
@@ -836,6 +1327,487 @@ void ell_to_hyb(const Matrix1& src, Matrix2& dst)
   cusp::copy(src, dst.ell);
 }
 
+/////////
+// BSR //
+/////////
+template <typename Matrix1, typename Matrix2>
+void coo_to_bsr(const Matrix1& src, Matrix2& dst,
+                const size_t block_size)
+{
+  typedef typename Matrix2::index_type IndexType;
+  typedef typename Matrix2::value_type ValueType;
+  typedef typename thrust::tuple<IndexType,IndexType> BlockCoordinate;
+
+  if (block_size == 0 || src.num_rows % block_size != 0 || src.num_cols % block_size != 0)
+    throw cusp::format_conversion_exception("bsr_matrix block size must divide the matrix dimensions");
+
+  const size_t N = src.num_entries;
+
+  if (N == 0)
+  {
+    dst.resize(src.num_rows, src.num_cols, 0, block_size);
+    thrust::fill(dst.row_offsets.begin(), dst.row_offsets.end(), IndexType(0));
+    return;
+  }
+
+  // compute the block coordinates of each entry and sort the entries by block
+  cusp::array1d<IndexType, cusp::device_memory> block_rows(N);
+  cusp::array1d<IndexType, cusp::device_memory> block_cols(N);
+  cusp::array1d<IndexType, cusp::device_memory> permutation(N);
+
+  thrust::transform(src.row_indices.begin(),    src.row_indices.end(),    block_rows.begin(), divide_value<IndexType>(block_size));
+  thrust::transform(src.column_indices.begin(), src.column_indices.end(), block_cols.begin(), divide_value<IndexType>(block_size));
+  thrust::sequence(permutation.begin(), permutation.end());
+
+  cusp::detail::sort_by_row_and_column(block_rows, block_cols, permutation);
+
+  // enumerate the distinct blocks, e.g. [0, 0, 0, 1, 1, 2, ...]
+  cusp::array1d<IndexType, cusp::device_memory> block_index(N);
+  block_index[0] = 0;
+  thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(block_rows.begin(), block_cols.begin())) + 1,
+                    thrust::make_zip_iterator(thrust::make_tuple(block_rows.end(),   block_cols.end())),
+                    thrust::make_zip_iterator(thrust::make_tuple(block_rows.begin(), block_cols.begin())),
+                    block_index.begin() + 1,
+                    thrust::not_equal_to<BlockCoordinate>());
+  thrust::inclusive_scan(block_index.begin(), block_index.end(), block_index.begin());
+
+  const size_t num_blocks = block_index[N - 1] + 1;
+
+  // allocate output storage
+  dst.resize(src.num_rows, src.num_cols, num_blocks, block_size);
+
+  // compress the block coordinates
+  cusp::array1d<IndexType, cusp::device_memory> unique_block_rows(num_blocks);
+  thrust::unique_copy(thrust::make_zip_iterator(thrust::make_tuple(block_rows.begin(), block_cols.begin())),
+                      thrust::make_zip_iterator(thrust::make_tuple(block_rows.end(),   block_cols.end())),
+                      thrust::make_zip_iterator(thrust::make_tuple(unique_block_rows.begin(), dst.column_indices.begin())));
+  cusp::detail::indices_to_offsets(unique_block_rows, dst.row_offsets);
+
+  // scatter the entries into the (row-major) blocks
+  thrust::fill(dst.values.begin(), dst.values.end(), ValueType(0));
+  thrust::scatter(thrust::make_permutation_iterator(src.values.begin(), permutation.begin()),
+                  thrust::make_permutation_iterator(src.values.begin(), permutation.end()),
+                  thrust::make_transform_iterator(
+                    thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(src.row_indices.begin(),    permutation.begin()),
+                                                                 thrust::make_permutation_iterator(src.column_indices.begin(), permutation.begin()),
+                                                                 block_index.begin())),
+                    bsr_entry_offset_functor<IndexType>(block_size)),
+                  dst.values.begin());
+}
+
+//////////
+// SELL //
+//////////
+template <typename Matrix1, typename Matrix2>
+void coo_to_sell(const Matrix1& src, Matrix2& dst,
+                 const size_t slice_size, const size_t sorting_window)
+{
+  typedef typename Matrix2::index_type IndexType;
+  typedef typename Matrix2::value_type ValueType;
+
+  if (slice_size == 0 || sorting_window == 0)
+    throw cusp::format_conversion_exception("sell_matrix slice size and sorting window must be positive");
+
+  const size_t num_rows   = src.num_rows;
+  const size_t num_slices = (num_rows + slice_size - 1) / slice_size;
+
+  // compute the length of each row
+  cusp::array1d<IndexType, cusp::device_memory> row_offsets(num_rows + 1);
+  cusp::detail::indices_to_offsets(src.row_indices, row_offsets);
+
+  cusp::array1d<IndexType, cusp::device_memory> row_lengths(num_rows);
+  thrust::transform(row_offsets.begin() + 1, row_offsets.end(),
+                    row_offsets.begin(),
+                    row_lengths.begin(),
+                    thrust::minus<IndexType>());
+
+  // sort the rows by decreasing length within each window
+  cusp::array1d<IndexType, cusp::device_memory> windows(num_rows);
+  thrust::transform(thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(num_rows),
+                    windows.begin(),
+                    divide_value<IndexType>(sorting_window));
+
+  cusp::array1d<IndexType, cusp::device_memory> permutation(num_rows);
+  thrust::sequence(permutation.begin(), permutation.end());
+
+  thrust::stable_sort_by_key(thrust::make_zip_iterator(thrust::make_tuple(windows.begin(), row_lengths.begin())),
+                             thrust::make_zip_iterator(thrust::make_tuple(windows.end(),   row_lengths.end())),
+                             permutation.begin(),
+                             sell_row_order<IndexType>());
+
+  // pad each slice to its longest row
+  cusp::array1d<IndexType, cusp::device_memory> slice_offsets(num_slices + 1, IndexType(0));
+  {
+    cusp::array1d<IndexType, cusp::device_memory> slices(num_slices);
+    thrust::reduce_by_key(thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0), divide_value<IndexType>(slice_size)),
+                          thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(num_rows), divide_value<IndexType>(slice_size)),
+                          row_lengths.begin(),
+                          slices.begin(),
+                          slice_offsets.begin(),
+                          thrust::equal_to<IndexType>(),
+                          thrust::maximum<IndexType>());
+  }
+  thrust::transform(slice_offsets.begin(), slice_offsets.end() - 1,
+                    slice_offsets.begin(),
+                    multiply_value<IndexType>(slice_size));
+  thrust::exclusive_scan(slice_offsets.begin(), slice_offsets.end(), slice_offsets.begin());
+
+  const size_t num_stored = slice_offsets[num_slices];
+
+  // allocate output storage
+  dst.resize(src.num_rows, src.num_cols, src.num_entries, num_stored, slice_size, sorting_window);
+
+  cusp::copy(permutation,   dst.row_permutation);
+  cusp::copy(slice_offsets, dst.slice_offsets);
+
+  thrust::fill(dst.column_indices.begin(), dst.column_indices.end(), IndexType(-1));
+  thrust::fill(dst.values.begin(),         dst.values.end(),         ValueType(0));
+
+  if (src.num_entries == 0)
+    return;
+
+  // position of each row in the sliced layout
+  cusp::array1d<IndexType, cusp::device_memory> positions(num_rows);
+  thrust::scatter(thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(num_rows),
+                  permutation.begin(),
+                  positions.begin());
+
+  cusp::array1d<IndexType, cusp::device_memory> entry_positions(src.num_entries);
+  thrust::gather(src.row_indices.begin(), src.row_indices.end(),
+                 positions.begin(),
+                 entry_positions.begin());
+
+  // enumerate the entries within each row, e.g. [0, 1, 2, 0, 1, 2, 3, ...]
+  cusp::array1d<IndexType, cusp::device_memory> entry_indices(src.num_entries);
+  thrust::exclusive_scan_by_key(src.row_indices.begin(), src.row_indices.end(),
+                                thrust::constant_iterator<IndexType>(1),
+                                entry_indices.begin(),
+                                IndexType(0));
+
+  // compute the destination of each entry and scatter COO entries to SELL
+  cusp::array1d<IndexType, cusp::device_memory> destinations(src.num_entries);
+  thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(entry_positions.begin(), entry_indices.begin(),
+                      thrust::make_permutation_iterator(dst.slice_offsets.begin(), thrust::make_transform_iterator(entry_positions.begin(), divide_value<IndexType>(slice_size))))),
+                    thrust::make_zip_iterator(thrust::make_tuple(entry_positions.end(), entry_indices.end(),
+                      thrust::make_permutation_iterator(dst.slice_offsets.begin(), thrust::make_transform_iterator(entry_positions.end(), divide_value<IndexType>(slice_size))))),
+                    destinations.begin(),
+                    sell_entry_index_functor<IndexType>(slice_size));
+
+  thrust::scatter(src.column_indices.begin(), src.column_indices.end(),
+                  destinations.begin(),
+                  dst.column_indices.begin());
+  thrust::scatter(src.values.begin(), src.values.end(),
+                  destinations.begin(),
+                  dst.values.begin());
+}
+
+/////////
+// JDS //
+/////////
+template <typename Matrix1, typename Matrix2>
+void coo_to_jds(const Matrix1& src, Matrix2& dst)
+{
+  typedef typename Matrix2::index_type IndexType;
+
+  const size_t num_rows = src.num_rows;
+
+  // compute the length of each row
+  cusp::array1d<IndexType, cusp::device_memory> row_offsets(num_rows + 1);
+  cusp::detail::indices_to_offsets(src.row_indices, row_offsets);
+
+  cusp::array1d<IndexType, cusp::device_memory> row_lengths(num_rows);
+  thrust::transform(row_offsets.begin() + 1, row_offsets.end(),
+                    row_offsets.begin(),
+                    row_lengths.begin(),
+                    thrust::minus<IndexType>());
+
+  // sort the rows by decreasing length
+  cusp::array1d<IndexType, cusp::device_memory> permutation(num_rows);
+  thrust::sequence(permutation.begin(), permutation.end());
+
+  thrust::stable_sort_by_key(row_lengths.begin(), row_lengths.end(),
+                             permutation.begin(),
+                             thrust::greater<IndexType>());
+
+  const size_t num_diagonals = num_rows == 0 ? 0 : IndexType(row_lengths[0]);
+
+  // diagonal n extends over the leading rows with more than n entries
+  cusp::array1d<IndexType, cusp::device_memory> diagonal_offsets(num_diagonals + 1, IndexType(0));
+  thrust::lower_bound(row_lengths.begin(), row_lengths.end(),
+                      thrust::counting_iterator<IndexType>(0),
+                      thrust::counting_iterator<IndexType>(num_diagonals),
+                      diagonal_offsets.begin(),
+                      thrust::greater<IndexType>());
+  thrust::exclusive_scan(diagonal_offsets.begin(), diagonal_offsets.end(), diagonal_offsets.begin());
+
+  // allocate output storage
+  dst.resize(src.num_rows, src.num_cols, src.num_entries, num_diagonals);
+
+  cusp::copy(permutation,      dst.row_permutation);
+  cusp::copy(diagonal_offsets, dst.diagonal_offsets);
+
+  if (src.num_entries == 0)
+    return;
+
+  // position of each row in the sorted order
+  cusp::array1d<IndexType, cusp::device_memory> positions(num_rows);
+  thrust::scatter(thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(num_rows),
+                  permutation.begin(),
+                  positions.begin());
+
+  cusp::array1d<IndexType, cusp::device_memory> entry_positions(src.num_entries);
+  thrust::gather(src.row_indices.begin(), src.row_indices.end(),
+                 positions.begin(),
+                 entry_positions.begin());
+
+  // enumerate the entries within each row, e.g. [0, 1, 2, 0, 1, 2, 3, ...]
+  cusp::array1d<IndexType, cusp::device_memory> entry_indices(src.num_entries);
+  thrust::exclusive_scan_by_key(src.row_indices.begin(), src.row_indices.end(),
+                                thrust::constant_iterator<IndexType>(1),
+                                entry_indices.begin(),
+                                IndexType(0));
+
+  // entry n of the row at position k is stored at diagonal_offsets[n] + k
+  cusp::array1d<IndexType, cusp::device_memory> destinations(src.num_entries);
+  thrust::transform(entry_positions.begin(), entry_positions.end(),
+                    thrust::make_permutation_iterator(dst.diagonal_offsets.begin(), entry_indices.begin()),
+                    destinations.begin(),
+                    thrust::plus<IndexType>());
+
+  thrust::scatter(src.column_indices.begin(), src.column_indices.end(),
+                  destinations.begin(),
+                  dst.column_indices.begin());
+  thrust::scatter(src.values.begin(), src.values.end(),
+                  destinations.begin(),
+                  dst.values.begin());
+}
+
+///////////
+// CSR16 //
+///////////
+template <typename Matrix1, typename Matrix2>
+void coo_to_csr16(const Matrix1& src, Matrix2& dst)
+{
+  typedef typename Matrix2::index_type  IndexType;
+  typedef typename Matrix2::offset_type OffsetType;
+
+  const size_t max_offset = Matrix2::max_offset;
+  const size_t num_rows   = src.num_rows;
+
+  // the base column of each row is its smallest column index
+  cusp::array1d<IndexType, cusp::device_memory> bases(num_rows, IndexType(0));
+
+  if (src.num_entries > 0)
+  {
+    cusp::array1d<IndexType, cusp::device_memory> rows(num_rows);
+    cusp::array1d<IndexType, cusp::device_memory> minima(num_rows);
+
+    const size_t num_occupied_rows =
+      thrust::reduce_by_key(src.row_indices.begin(), src.row_indices.end(),
+                            src.column_indices.begin(),
+                            rows.begin(),
+                            minima.begin(),
+                            thrust::equal_to<IndexType>(),
+                            thrust::minimum<IndexType>()).first - rows.begin();
+
+    thrust::scatter(minima.begin(), minima.begin() + num_occupied_rows,
+                    rows.begin(),
+                    bases.begin());
+  }
+
+  const size_t num_compressed =
+    thrust::count_if(thrust::make_zip_iterator(thrust::make_tuple(src.column_indices.begin(), thrust::make_permutation_iterator(bases.begin(), src.row_indices.begin()))),
+                     thrust::make_zip_iterator(thrust::make_tuple(src.column_indices.begin(), thrust::make_permutation_iterator(bases.begin(), src.row_indices.begin()))) + src.num_entries,
+                     is_csr16_offset<IndexType>(max_offset, true));
+
+  // allocate output storage
+  dst.resize(src.num_rows, src.num_cols, src.num_entries, src.num_entries - num_compressed);
+
+  cusp::copy(bases, dst.row_bases);
+
+  // split the entries into compressed and overflow entries, both remain sorted by row
+  cusp::array1d<IndexType, cusp::device_memory> rows(num_compressed);
+  cusp::array1d<IndexType, cusp::device_memory> columns(num_compressed);
+
+  thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin(), src.values.begin())),
+                  thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin(), src.values.begin())) + src.num_entries,
+                  thrust::make_zip_iterator(thrust::make_tuple(src.column_indices.begin(), thrust::make_permutation_iterator(bases.begin(), src.row_indices.begin()))),
+                  thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin(), dst.values.begin())),
+                  is_csr16_offset<IndexType>(max_offset, true));
+
+  thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin(), src.values.begin())),
+                  thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin(), src.values.begin())) + src.num_entries,
+                  thrust::make_zip_iterator(thrust::make_tuple(src.column_indices.begin(), thrust::make_permutation_iterator(bases.begin(), src.row_indices.begin()))),
+                  thrust::make_zip_iterator(thrust::make_tuple(dst.overflow.row_indices.begin(), dst.overflow.column_indices.begin(), dst.overflow.values.begin())),
+                  is_csr16_offset<IndexType>(max_offset, false));
+
+  cusp::detail::indices_to_offsets(rows, dst.row_offsets);
+
+  thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(columns.begin(), thrust::make_permutation_iterator(bases.begin(), rows.begin()))),
+                    thrust::make_zip_iterator(thrust::make_tuple(columns.begin(), thrust::make_permutation_iterator(bases.begin(), rows.begin()))) + num_compressed,
+                    dst.column_offsets.begin(),
+                    csr16_offset_functor<IndexType, OffsetType>());
+}
+
+///////////////////
+// Symmetric CSR //
+///////////////////
+template <typename Matrix1, typename Matrix2>
+void coo_to_symmetric_csr(const Matrix1& src, Matrix2& dst)
+{
+    typedef typename Matrix2::index_type IndexType;
+    typedef typename Matrix2::value_type ValueType;
+
+    if (src.num_rows != src.num_cols)
+        throw cusp::format_conversion_exception("symmetric_csr_matrix requires a square matrix");
+
+    const IndexType n = src.num_rows;
+
+    const size_t num_lower_entries =
+      thrust::count_if(thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin())),
+                       thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin())) + src.num_entries,
+                       is_in_band<IndexType>(-n, -1));
+    const size_t num_upper_entries = src.num_entries - num_lower_entries;
+
+    // the strictly lower triangle, transposed, must equal the strictly upper triangle
+    {
+      cusp::array1d<IndexType, cusp::device_memory> lower_rows(num_lower_entries);
+      cusp::array1d<IndexType, cusp::device_memory> lower_cols(num_lower_entries);
+      cusp::array1d<ValueType, cusp::device_memory> lower_vals(num_lower_entries);
+      cusp::array1d<IndexType, cusp::device_memory> upper_rows(num_lower_entries);
+      cusp::array1d<IndexType, cusp::device_memory> upper_cols(num_lower_entries);
+      cusp::array1d<ValueType, cusp::device_memory> upper_vals(num_lower_entries);
+
+      const size_t num_strictly_upper_entries =
+        thrust::count_if(thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin())),
+                         thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin())) + src.num_entries,
+                         is_in_band<IndexType>(1, n));
+
+      if (num_strictly_upper_entries != num_lower_entries)
+        throw cusp::format_conversion_exception("symmetric_csr_matrix requires a symmetric matrix");
+
+      thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(src.column_indices.begin(), src.row_indices.begin(), src.values.begin())),
+                      thrust::make_zip_iterator(thrust::make_tuple(src.column_indices.begin(), src.row_indices.begin(), src.values.begin())) + src.num_entries,
+                      thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin())),
+                      thrust::make_zip_iterator(thrust::make_tuple(lower_rows.begin(), lower_cols.begin(), lower_vals.begin())),
+                      is_in_band<IndexType>(-n, -1));
+
+      thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin(), src.values.begin())),
+                      thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin(), src.values.begin())) + src.num_entries,
+                      thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin())),
+                      thrust::make_zip_iterator(thrust::make_tuple(upper_rows.begin(), upper_cols.begin(), upper_vals.begin())),
+                      is_in_band<IndexType>(1, n));
+
+      if (num_lower_entries > 0)
+      {
+        cusp::detail::sort_by_row_and_column(lower_rows, lower_cols, lower_vals);
+        cusp::detail::sort_by_row_and_column(upper_rows, upper_cols, upper_vals);
+      }
+
+      if (!thrust::equal(thrust::make_zip_iterator(thrust::make_tuple(lower_rows.begin(), lower_cols.begin(), lower_vals.begin())),
+                         thrust::make_zip_iterator(thrust::make_tuple(lower_rows.begin(), lower_cols.begin(), lower_vals.begin())) + num_lower_entries,
+                         thrust::make_zip_iterator(thrust::make_tuple(upper_rows.begin(), upper_cols.begin(), upper_vals.begin()))))
+        throw cusp::format_conversion_exception("symmetric_csr_matrix requires a symmetric matrix");
+    }
+
+    // allocate output storage
+    dst.resize(src.num_rows, src.num_cols, src.num_entries, num_upper_entries);
+
+    // copy the upper triangle, it remains sorted by row
+    cusp::array1d<IndexType, cusp::device_memory> rows(num_upper_entries);
+
+    thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin(), src.values.begin())),
+                    thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin(), src.values.begin())) + src.num_entries,
+                    thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin())),
+                    thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), dst.column_indices.begin(), dst.values.begin())),
+                    is_in_band<IndexType>(0, n));
+
+    cusp::detail::indices_to_offsets(rows, dst.row_offsets);
+}
+
+/////////////
+// DIA/COO //
+/////////////
+template <typename Matrix1, typename Matrix2>
+void coo_to_dia_coo(const Matrix1& src, Matrix2& dst,
+                    const size_t alignment = 32)
+{
+    typedef typename Matrix2::index_type IndexType;
+    typedef typename Matrix2::value_type ValueType;
+
+    const size_t num_slots = src.num_rows + src.num_cols;
+
+    // compute the shifted diagonal of each entry
+    cusp::array1d<IndexType,cusp::device_memory> diag_map(src.num_entries);
+    thrust::transform(thrust::make_zip_iterator( thrust::make_tuple( src.row_indices.begin(), src.column_indices.begin() ) ),
+                      thrust::make_zip_iterator( thrust::make_tuple( src.row_indices.end()  , src.column_indices.end() ) )  ,
+                      diag_map.begin(),
+                      occupied_diagonal_functor<IndexType>(src.num_rows));
+
+    // count the entries of each diagonal
+    cusp::array1d<IndexType,cusp::device_memory> diag_count(num_slots, IndexType(0));
+    {
+        cusp::array1d<IndexType,cusp::device_memory> keys(diag_map);
+        thrust::sort(keys.begin(), keys.end());
+
+        cusp::array1d<IndexType,cusp::device_memory> diagonals(num_slots);
+        cusp::array1d<IndexType,cusp::device_memory> counts(num_slots);
+
+        const size_t num_occupied =
+          thrust::reduce_by_key(keys.begin(), keys.end(),
+                                thrust::constant_iterator<IndexType>(1),
+                                diagonals.begin(),
+                                counts.begin()).first - diagonals.begin();
+
+        thrust::scatter(counts.begin(), counts.begin() + num_occupied,
+                        diagonals.begin(),
+                        diag_count.begin());
+    }
+
+    // a diagonal is stored in the DIA portion when enough of its num_rows
+    // slots are occupied, otherwise its entries go to the COO portion
+    const IndexType min_entries = std::max<IndexType>(1, IndexType(std::ceil(double(dst.min_fill) * double(src.num_rows))));
+
+    cusp::array1d<IndexType,cusp::device_memory> selected(num_slots);
+    thrust::transform(diag_count.begin(), diag_count.end(),
+                      selected.begin(),
+                      greater_than_or_equal_to<IndexType>(min_entries));
+
+    const size_t num_diagonals   = thrust::reduce(selected.begin(), selected.end());
+    const size_t num_dia_entries = thrust::inner_product(selected.begin(), selected.end(), diag_count.begin(), IndexType(0));
+
+    // allocate DIA/COO structure
+    dst.resize(src.num_rows, src.num_cols, num_dia_entries, src.num_entries - num_dia_entries, num_diagonals, alignment);
+
+    // fill in diagonal_offsets array
+    thrust::copy_if(thrust::counting_iterator<IndexType>(-IndexType(src.num_rows)),
+                    thrust::counting_iterator<IndexType>(-IndexType(src.num_rows)) + num_slots,
+                    selected.begin(),
+                    dst.dia.diagonal_offsets.begin(),
+                    is_positive<IndexType>());
+
+    // index of each selected diagonal in the offsets array
+    cusp::array1d<IndexType,cusp::device_memory> diag_index(num_slots);
+    thrust::exclusive_scan(selected.begin(), selected.end(), diag_index.begin());
+
+    // copy values of the selected diagonals to the DIA portion
+    thrust::fill(dst.dia.values.values.begin(), dst.dia.values.values.end(), ValueType(0));
+
+    thrust::scatter_if(src.values.begin(), src.values.end(),
+                       thrust::make_transform_iterator(
+                            thrust::make_zip_iterator( thrust::make_tuple( src.row_indices.begin(), thrust::make_permutation_iterator(diag_index.begin(), diag_map.begin()) ) ),
+                            diagonal_index_functor<IndexType>(dst.dia.values.pitch)),
+                       thrust::make_permutation_iterator(selected.begin(), diag_map.begin()),
+                       dst.dia.values.values.begin());
+
+    // copy the remaining entries to the COO portion, they remain sorted by row
+    thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin(), src.values.begin())),
+                    thrust::make_zip_iterator(thrust::make_tuple(src.row_indices.begin(), src.column_indices.begin(), src.values.begin())) + src.num_entries,
+                    thrust::make_permutation_iterator(selected.begin(), diag_map.begin()),
+                    thrust::make_zip_iterator(thrust::make_tuple(dst.coo.row_indices.begin(), dst.coo.column_indices.begin(), dst.coo.values.begin())),
+                    thrust::logical_not<IndexType>());
+}
+
 ///////////
 // Array //
 ///////////
@@ -23,6 +23,7 @@
 #include <cusp/csr_matrix.h>
 
 #include <cusp/detail/format_utils.h>
+#include <cusp/detail/row_statistics.h>
 
 #include <thrust/adjacent_difference.h>
 #include <thrust/binary_search.h>
@@ -150,6 +151,8 @@ size_t compute_max_entries_per_row(const Matrix& coo, cusp::coo_format)
     return compute_max_entries_per_row(row_offsets);
 }
 
+// the ELL width sizes the output of a conversion, so it is computed
+// from the row offsets instead of the cached row statistics
 template <typename Matrix>
 size_t compute_max_entries_per_row(const Matrix& csr, cusp::csr_format)
 {
@@ -209,13 +212,40 @@ size_t compute_optimal_entries_per_row(const Matrix& coo,
   return compute_optimal_entries_per_row(row_offsets, relative_speed, breakeven_threshold);
 }
 
+// the result is cached with the row statistics of the matrix, so that
+// repeated conversions of the same matrix skip the histogram.  The cached
+// width is only reused while the longest row of the matrix, which is
+// recomputed here, is the one it was derived from.  Any width gives a
+// valid HYB matrix, since the entries beyond it are stored in the COO
+// portion, but a stale width could exceed the longest row.
 template <typename Matrix>
 size_t compute_optimal_entries_per_row(const Matrix& csr,
                                        float relative_speed,
                                        size_t breakeven_threshold,
                                        cusp::csr_format)
 {
-  return compute_optimal_entries_per_row(csr.row_offsets, relative_speed, breakeven_threshold);
+  const size_t max_length = compute_max_entries_per_row(csr.row_offsets);
+
+  {
+    cusp::detail::pool_lock lock(cusp::detail::row_statistics_mutex());
+
+    if (csr.row_statistics.is_hyb_valid(csr, relative_speed, breakeven_threshold, max_length))
+      return csr.row_statistics.hyb_entries_per_row;
+  }
+
+  const size_t entries_per_row = compute_optimal_entries_per_row(csr.row_offsets, relative_speed, breakeven_threshold);
+
+  cusp::detail::pool_lock lock(cusp::detail::row_statistics_mutex());
+
+  csr.row_statistics.hyb_num_rows            = csr.num_rows;
+  csr.row_statistics.hyb_num_entries         = csr.num_entries;
+  csr.row_statistics.hyb_max_length          = max_length;
+  csr.row_statistics.hyb_entries_per_row     = entries_per_row;
+  csr.row_statistics.hyb_relative_speed      = relative_speed;
+  csr.row_statistics.hyb_breakeven_threshold = breakeven_threshold;
+  csr.row_statistics.hyb_valid               = true;
+
+  return entries_per_row;
 }
 
 } // end namespace detail
@@ -21,6 +21,7 @@
 #include <cusp/array2d.h>
 #include <cusp/coo_matrix.h>
 
+#include <cusp/detail/dense_to_sparse.h>
 #include <cusp/detail/device/conversion.h>
 #include <cusp/detail/device/conversion_utils.h>
 
@@ -58,6 +59,42 @@ void convert(const Matrix1& src, Matrix2& dst,
              cusp::coo_format)
 {    cusp::detail::device::hyb_to_coo(src, dst);    }
 
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::bsr_format,
+             cusp::coo_format)
+{    cusp::detail::device::bsr_to_coo(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::sell_format,
+             cusp::coo_format)
+{    cusp::detail::device::sell_to_coo(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::jds_format,
+             cusp::coo_format)
+{    cusp::detail::device::jds_to_coo(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::csr16_format,
+             cusp::coo_format)
+{    cusp::detail::device::csr16_to_coo(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::dia_coo_format,
+             cusp::coo_format)
+{    cusp::detail::device::dia_coo_to_coo(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::symmetric_csr_format,
+             cusp::coo_format)
+{    cusp::detail::device::symmetric_csr_to_coo(src, dst);    }
+
 /////////
 // CSR //
 /////////
@@ -197,6 +234,89 @@ void convert(const Matrix1& src, Matrix2& dst,
     cusp::detail::device::ell_to_hyb(src, dst);
 }
 
+/////////
+// BSR //
+/////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::coo_format,
+             cusp::bsr_format)
+{    cusp::detail::device::coo_to_bsr(src, dst, dst.block_size);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::array2d_format,
+             cusp::bsr_format)
+{
+   typedef typename Matrix2::index_type IndexType;
+   typedef typename Matrix2::value_type ValueType;
+
+   // convert src -> coo_matrix -> dst to retain the block size of dst
+   cusp::coo_matrix<IndexType, ValueType, cusp::device_memory> tmp;
+   cusp::convert(src, tmp);
+   cusp::convert(tmp, dst);
+}
+
+//////////
+// SELL //
+//////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::coo_format,
+             cusp::sell_format)
+{    cusp::detail::device::coo_to_sell(src, dst, dst.slice_size, dst.sorting_window);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::array2d_format,
+             cusp::sell_format)
+{
+   typedef typename Matrix2::index_type IndexType;
+   typedef typename Matrix2::value_type ValueType;
+
+   // as for BSR, convert src -> coo_matrix -> dst to retain the slice parameters
+   cusp::coo_matrix<IndexType, ValueType, cusp::device_memory> tmp;
+   cusp::convert(src, tmp);
+   cusp::convert(tmp, dst);
+}
+
+/////////
+// JDS //
+/////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::coo_format,
+             cusp::jds_format)
+{    cusp::detail::device::coo_to_jds(src, dst);    }
+
+///////////
+// CSR16 //
+///////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::coo_format,
+             cusp::csr16_format)
+{    cusp::detail::device::coo_to_csr16(src, dst);    }
+
+///////////////////
+// Symmetric CSR //
+///////////////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::coo_format,
+             cusp::symmetric_csr_format)
+{    cusp::detail::device::coo_to_symmetric_csr(src, dst);    }
+
+/////////////
+// DIA/COO //
+/////////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::coo_format,
+             cusp::dia_coo_format,
+             const size_t alignment = 32)
+{    cusp::detail::device::coo_to_dia_coo(src, dst, alignment);    }
+
 /////////////
 // Array1d //
 /////////////
@@ -280,23 +400,27 @@ void convert(const Matrix1& src, Matrix2& dst,
 template <typename Matrix1, typename Matrix2>
 void convert(const Matrix1& src, Matrix2& dst,
              cusp::array2d_format,
-             cusp::sparse_format)
-{
-  // TODO do this natively on the device
-  
-  // transfer to host, convert on host, and transfer back to device
-  typedef typename Matrix1::container SourceContainerType;
-  typedef typename Matrix2::container DestinationContainerType;
-  typedef typename DestinationContainerType::template rebind<cusp::host_memory>::type HostDestinationContainerType;
-  typedef typename SourceContainerType::template      rebind<cusp::host_memory>::type HostSourceContainerType;
-
-  HostSourceContainerType tmp1(src);
+             cusp::csr_format)
+{    cusp::detail::array2d_to_csr(src, dst, cusp::detail::dense_nonzero_predicate());    }
 
-  HostDestinationContainerType tmp2;
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::array2d_format,
+             cusp::coo_format)
+{    cusp::detail::array2d_to_coo(src, dst, cusp::detail::dense_nonzero_predicate());    }
 
-  cusp::detail::host::convert(tmp1, tmp2);
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::array2d_format,
+             cusp::sparse_format)
+{
+   typedef typename Matrix2::index_type IndexType;
+   typedef typename Matrix2::value_type ValueType;
 
-  cusp::copy(tmp2, dst);
+   // convert src -> coo_matrix -> dst
+   cusp::coo_matrix<IndexType, ValueType, cusp::device_memory> tmp;
+   cusp::detail::array2d_to_coo(src, tmp, cusp::detail::dense_nonzero_predicate());
+   cusp::convert(tmp, dst);
 }
 
 template <typename Matrix1, typename Matrix2>
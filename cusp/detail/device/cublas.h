@@ -0,0 +1,212 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array2d.h>
+#include <cusp/exception.h>
+
+#include <cusp/detail/stream.h>
+
+#if defined(CUSP_USE_CUBLAS)
+#include <cublas_v2.h>
+#endif
+
+// Optional cuBLAS backend for the dense products of array2d operands.
+// gemv and gemm return false when the product is not delegated, i.e.
+// when Cusp is built without CUSP_USE_CUBLAS or for value types other
+// than float and double, and the caller then launches its own kernels.
+//
+// cuBLAS expects column-major operands.  A row-major matrix with pitch
+// lda is the column-major storage of its transpose with the same leading
+// dimension, so it is passed with the CUBLAS_OP_T operation.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+namespace cublas
+{
+
+template <typename ValueType, typename Orientation>
+bool gemv(size_t num_rows, size_t num_cols,
+          const ValueType * A, size_t pitch,
+          const ValueType * x, ValueType * y,
+          Orientation)
+{
+    return false;
+}
+
+template <typename ValueType, typename OrientationA, typename OrientationB, typename OrientationC>
+bool gemm(size_t num_rows, size_t num_cols, size_t num_inner,
+          const ValueType * A, size_t A_pitch, OrientationA,
+          const ValueType * B, size_t B_pitch, OrientationB,
+                ValueType * C, size_t C_pitch, OrientationC)
+{
+    return false;
+}
+
+#if defined(CUSP_USE_CUBLAS)
+
+// one handle per host thread, bound to the current stream
+inline cublasHandle_t handle(void)
+{
+    static CUSP_THREAD_LOCAL cublasHandle_t handle = 0;
+
+    if (handle == 0 && cublasCreate(&handle) != CUBLAS_STATUS_SUCCESS)
+        throw cusp::runtime_exception("cublasCreate failed");
+
+    cublasSetStream(handle, cusp::detail::current_stream());
+
+    return handle;
+}
+
+inline void check(cublasStatus_t status, const char * message)
+{
+    if (status != CUBLAS_STATUS_SUCCESS)
+        throw cusp::runtime_exception(message);
+}
+
+inline cublasOperation_t operation(cusp::column_major) { return CUBLAS_OP_N; }
+inline cublasOperation_t operation(cusp::row_major)    { return CUBLAS_OP_T; }
+
+inline cublasStatus_t xgemv(cublasHandle_t h, cublasOperation_t op, int m, int n,
+                            const float * alpha, const float * A, int lda,
+                            const float * x, const float * beta, float * y)
+{
+    return cublasSgemv(h, op, m, n, alpha, A, lda, x, 1, beta, y, 1);
+}
+
+inline cublasStatus_t xgemv(cublasHandle_t h, cublasOperation_t op, int m, int n,
+                            const double * alpha, const double * A, int lda,
+                            const double * x, const double * beta, double * y)
+{
+    return cublasDgemv(h, op, m, n, alpha, A, lda, x, 1, beta, y, 1);
+}
+
+inline cublasStatus_t xgemm(cublasHandle_t h, cublasOperation_t opA, cublasOperation_t opB,
+                            int m, int n, int k, const float * alpha,
+                            const float * A, int lda, const float * B, int ldb,
+                            const float * beta, float * C, int ldc)
+{
+    return cublasSgemm(h, opA, opB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+inline cublasStatus_t xgemm(cublasHandle_t h, cublasOperation_t opA, cublasOperation_t opB,
+                            int m, int n, int k, const double * alpha,
+                            const double * A, int lda, const double * B, int ldb,
+                            const double * beta, double * C, int ldc)
+{
+    return cublasDgemm(h, opA, opB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+template <typename ValueType, typename Orientation>
+bool __gemv(size_t num_rows, size_t num_cols,
+            const ValueType * A, size_t pitch,
+            const ValueType * x, ValueType * y,
+            Orientation)
+{
+    const ValueType alpha = 1;
+    const ValueType beta  = 0;
+
+    // dimensions of the column-major storage of A
+    const bool transposed = operation(Orientation()) == CUBLAS_OP_T;
+    const int  m = transposed ? num_cols : num_rows;
+    const int  n = transposed ? num_rows : num_cols;
+
+    check(xgemv(handle(), operation(Orientation()), m, n, &alpha, A, pitch, x, &beta, y), "cublas gemv failed");
+
+    return true;
+}
+
+template <typename ValueType, typename OrientationA, typename OrientationB>
+bool __gemm(size_t num_rows, size_t num_cols, size_t num_inner,
+            const ValueType * A, size_t A_pitch, OrientationA,
+            const ValueType * B, size_t B_pitch, OrientationB,
+                  ValueType * C, size_t C_pitch, cusp::column_major)
+{
+    const ValueType alpha = 1;
+    const ValueType beta  = 0;
+
+    check(xgemm(handle(), operation(OrientationA()), operation(OrientationB()),
+                num_rows, num_cols, num_inner,
+                &alpha, A, A_pitch, B, B_pitch,
+                &beta,  C, C_pitch), "cublas gemm failed");
+
+    return true;
+}
+
+template <typename ValueType, typename OrientationA, typename OrientationB>
+bool __gemm(size_t num_rows, size_t num_cols, size_t num_inner,
+            const ValueType * A, size_t A_pitch, OrientationA,
+            const ValueType * B, size_t B_pitch, OrientationB,
+                  ValueType * C, size_t C_pitch, cusp::row_major)
+{
+    const ValueType alpha = 1;
+    const ValueType beta  = 0;
+
+    // a row-major C is the column-major C^T = B^T A^T, and a transposed
+    // operand flips the operation of its orientation
+    const cublasOperation_t opA = operation(OrientationA()) == CUBLAS_OP_N ? CUBLAS_OP_T : CUBLAS_OP_N;
+    const cublasOperation_t opB = operation(OrientationB()) == CUBLAS_OP_N ? CUBLAS_OP_T : CUBLAS_OP_N;
+
+    check(xgemm(handle(), opB, opA,
+                num_cols, num_rows, num_inner,
+                &alpha, B, B_pitch, A, A_pitch,
+                &beta,  C, C_pitch), "cublas gemm failed");
+
+    return true;
+}
+
+template <typename Orientation>
+bool gemv(size_t num_rows, size_t num_cols, const float * A, size_t pitch, const float * x, float * y, Orientation)
+{
+    return __gemv(num_rows, num_cols, A, pitch, x, y, Orientation());
+}
+
+template <typename Orientation>
+bool gemv(size_t num_rows, size_t num_cols, const double * A, size_t pitch, const double * x, double * y, Orientation)
+{
+    return __gemv(num_rows, num_cols, A, pitch, x, y, Orientation());
+}
+
+template <typename OrientationA, typename OrientationB, typename OrientationC>
+bool gemm(size_t num_rows, size_t num_cols, size_t num_inner,
+          const float * A, size_t A_pitch, OrientationA,
+          const float * B, size_t B_pitch, OrientationB,
+                float * C, size_t C_pitch, OrientationC)
+{
+    return __gemm(num_rows, num_cols, num_inner, A, A_pitch, OrientationA(), B, B_pitch, OrientationB(), C, C_pitch, OrientationC());
+}
+
+template <typename OrientationA, typename OrientationB, typename OrientationC>
+bool gemm(size_t num_rows, size_t num_cols, size_t num_inner,
+          const double * A, size_t A_pitch, OrientationA,
+          const double * B, size_t B_pitch, OrientationB,
+                double * C, size_t C_pitch, OrientationC)
+{
+    return __gemm(num_rows, num_cols, num_inner, A, A_pitch, OrientationA(), B, B_pitch, OrientationB(), C, C_pitch, OrientationC());
+}
+
+#endif // CUSP_USE_CUBLAS
+
+} // end namespace cublas
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
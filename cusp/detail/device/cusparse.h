@@ -0,0 +1,542 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/caching_allocator.h>
+#include <cusp/exception.h>
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/sparse_engine.h>
+
+#include <thrust/copy.h>
+#include <thrust/fill.h>
+#include <thrust/detail/type_traits.h>
+
+#if defined(CUSP_USE_CUSPARSE)
+#include <cusparse.h>
+#endif
+
+// Optional cuSPARSE engine of the device sparse operations on CSR
+// operands.  Each function returns false when the operation is not
+// delegated, i.e. when the engine of the calling thread is not
+// cusparse_engine, when Cusp is built without CUSP_USE_CUSPARSE, or for
+// index and value types other than int with float or double, and the
+// caller then launches its own kernels.
+//
+// The descriptors are created on the storage of the operands and
+// destroyed when the operation returns, nothing is copied.  The generic
+// API requires cuSPARSE 11 (CUDA 11.2), the triangular solve cuSPARSE
+// 11.5 (CUDA 11.3).
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+namespace cusparse
+{
+
+template <typename IndexType, typename ValueType>
+struct is_supported : thrust::detail::false_type {};
+
+#if defined(CUSP_USE_CUSPARSE)
+template <> struct is_supported<int,float>  : thrust::detail::true_type {};
+template <> struct is_supported<int,double> : thrust::detail::true_type {};
+#endif
+
+// whether the operands of a matrix and its vectors (or dense matrices)
+// are delegated
+template <typename Matrix, typename ValueType1, typename ValueType2>
+struct is_supported_operation
+  : thrust::detail::integral_constant<bool,
+        is_supported<typename Matrix::index_type, typename Matrix::value_type>::value &&
+        thrust::detail::is_same<typename Matrix::value_type, ValueType1>::value &&
+        thrust::detail::is_same<typename Matrix::value_type, ValueType2>::value> {};
+
+inline bool enabled(void)
+{
+    return cusp::detail::current_sparse_engine() == cusp::cusparse_engine;
+}
+
+template <typename Matrix, typename Vector1, typename Vector2, typename Vector3, typename ScalarType>
+bool csrmv(const Matrix& A, const Vector1& x, const Vector2& z, Vector3& y,
+           ScalarType alpha, ScalarType beta, thrust::detail::false_type)
+{
+    return false;
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool csrmm(const Matrix1& A, const Matrix2& B, Matrix3& C, thrust::detail::false_type)
+{
+    return false;
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool spgemm(const Matrix1& A, const Matrix2& B, Matrix3& C, thrust::detail::false_type)
+{
+    return false;
+}
+
+template <typename Matrix1, typename Matrix2>
+bool transpose(const Matrix1& A, Matrix2& At, thrust::detail::false_type)
+{
+    return false;
+}
+
+template <typename Matrix, typename Vector1, typename Vector2>
+bool triangular_solve(const Matrix& T, const Vector1& b, Vector2& x,
+                      const bool lower, const bool unit, thrust::detail::false_type)
+{
+    return false;
+}
+
+#if defined(CUSP_USE_CUSPARSE)
+
+// one handle per host thread, bound to the current stream
+inline cusparseHandle_t handle(void)
+{
+    static CUSP_THREAD_LOCAL cusparseHandle_t handle = 0;
+
+    if (handle == 0 && cusparseCreate(&handle) != CUSPARSE_STATUS_SUCCESS)
+        throw cusp::runtime_exception("cusparseCreate failed");
+
+    cusparseSetStream(handle, cusp::detail::current_stream());
+
+    return handle;
+}
+
+inline void check(cusparseStatus_t status, const char * message)
+{
+    if (status != CUSPARSE_STATUS_SUCCESS)
+        throw cusp::runtime_exception(message);
+}
+
+inline cudaDataType data_type(float)  { return CUDA_R_32F; }
+inline cudaDataType data_type(double) { return CUDA_R_64F; }
+
+inline cusparseOrder_t order(cusp::column_major) { return CUSPARSE_ORDER_COL; }
+inline cusparseOrder_t order(cusp::row_major)    { return CUSPARSE_ORDER_ROW; }
+
+template <typename T>
+void * pointer(const T& array)
+{
+    return array.size() == 0 ? 0 : const_cast<void *>(static_cast<const void *>(thrust::raw_pointer_cast(&array[0])));
+}
+
+// temporary storage of an operation
+class workspace
+{
+    public:
+    void * get(size_t bytes)
+    {
+        buffer.resize(bytes);
+        return pointer(buffer);
+    }
+
+    private:
+    cusp::array1d<char, cusp::caching_device_allocator<char> > buffer;
+};
+
+// descriptor of a CSR matrix
+class csr_descriptor
+{
+    public:
+    template <typename Matrix>
+    explicit csr_descriptor(const Matrix& A)
+    {
+        typedef typename Matrix::value_type ValueType;
+
+        check(cusparseCreateCsr(&descr, A.num_rows, A.num_cols, A.num_entries,
+                                pointer(A.row_offsets), pointer(A.column_indices), pointer(A.values),
+                                CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I, CUSPARSE_INDEX_BASE_ZERO,
+                                data_type(ValueType())), "cusparseCreateCsr failed");
+    }
+
+    // an empty matrix, whose storage is set by the operation
+    template <typename ValueType>
+    csr_descriptor(size_t num_rows, size_t num_cols, ValueType)
+    {
+        check(cusparseCreateCsr(&descr, num_rows, num_cols, 0, 0, 0, 0,
+                                CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I, CUSPARSE_INDEX_BASE_ZERO,
+                                data_type(ValueType())), "cusparseCreateCsr failed");
+    }
+
+    ~csr_descriptor(void)
+    {
+        cusparseDestroySpMat(descr);
+    }
+
+    cusparseSpMatDescr_t get(void) const { return descr; }
+
+    private:
+    cusparseSpMatDescr_t descr;
+
+    // not copyable
+    csr_descriptor(const csr_descriptor&);
+    csr_descriptor& operator=(const csr_descriptor&);
+};
+
+// descriptor of a dense vector
+class vector_descriptor
+{
+    public:
+    template <typename Vector>
+    explicit vector_descriptor(const Vector& x)
+    {
+        typedef typename Vector::value_type ValueType;
+
+        check(cusparseCreateDnVec(&descr, x.size(), pointer(x), data_type(ValueType())), "cusparseCreateDnVec failed");
+    }
+
+    template <typename ValueType>
+    vector_descriptor(void * x, size_t size, ValueType)
+    {
+        check(cusparseCreateDnVec(&descr, size, x, data_type(ValueType())), "cusparseCreateDnVec failed");
+    }
+
+    ~vector_descriptor(void)
+    {
+        cusparseDestroyDnVec(descr);
+    }
+
+    cusparseDnVecDescr_t get(void) const { return descr; }
+
+    private:
+    cusparseDnVecDescr_t descr;
+
+    // not copyable
+    vector_descriptor(const vector_descriptor&);
+    vector_descriptor& operator=(const vector_descriptor&);
+};
+
+// descriptor of an array2d, the pitch is the leading dimension
+class matrix_descriptor
+{
+    public:
+    template <typename Matrix>
+    explicit matrix_descriptor(const Matrix& B)
+    {
+        typedef typename Matrix::value_type ValueType;
+
+        check(cusparseCreateDnMat(&descr, B.num_rows, B.num_cols, B.pitch, pointer(B.values),
+                                  data_type(ValueType()), order(typename Matrix::orientation())), "cusparseCreateDnMat failed");
+    }
+
+    ~matrix_descriptor(void)
+    {
+        cusparseDestroyDnMat(descr);
+    }
+
+    cusparseDnMatDescr_t get(void) const { return descr; }
+
+    private:
+    cusparseDnMatDescr_t descr;
+
+    // not copyable
+    matrix_descriptor(const matrix_descriptor&);
+    matrix_descriptor& operator=(const matrix_descriptor&);
+};
+
+// y <- alpha * A x + beta * z, where z may alias y
+template <typename Matrix, typename Vector1, typename Vector2, typename Vector3, typename ScalarType>
+bool csrmv(const Matrix& A, const Vector1& x, const Vector2& z, Vector3& y,
+           ScalarType alpha, ScalarType beta, thrust::detail::true_type)
+{
+    typedef typename Matrix::value_type ValueType;
+
+    const ValueType a(alpha);
+    const ValueType b(beta);
+
+    if (A.num_rows == 0)
+        return true;
+
+    // cuSPARSE accumulates into y, as in the BLAS z is not read when beta is zero
+    if (b != ValueType(0) && pointer(z) != pointer(y))
+        thrust::copy(z.begin(), z.end(), y.begin());
+
+    csr_descriptor    A_(A);
+    vector_descriptor x_(x);
+    vector_descriptor y_(y);
+
+    size_t bytes = 0;
+    check(cusparseSpMV_bufferSize(handle(), CUSPARSE_OPERATION_NON_TRANSPOSE, &a, A_.get(), x_.get(), &b, y_.get(),
+                                  data_type(ValueType()), CUSPARSE_SPMV_ALG_DEFAULT, &bytes), "cusparseSpMV_bufferSize failed");
+
+    workspace buffer;
+    check(cusparseSpMV(handle(), CUSPARSE_OPERATION_NON_TRANSPOSE, &a, A_.get(), x_.get(), &b, y_.get(),
+                       data_type(ValueType()), CUSPARSE_SPMV_ALG_DEFAULT, buffer.get(bytes)), "cusparseSpMV failed");
+
+    return true;
+}
+
+// C <- A B, B and C must have the same orientation
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool csrmm(const Matrix1& A, const Matrix2& B, Matrix3& C, thrust::detail::true_type)
+{
+    typedef typename Matrix1::value_type ValueType;
+
+    if (!thrust::detail::is_same<typename Matrix2::orientation, typename Matrix3::orientation>::value)
+        return false;
+
+    if (C.num_rows == 0 || C.num_cols == 0)
+        return true;
+
+    const ValueType alpha = 1;
+    const ValueType beta  = 0;
+
+    csr_descriptor    A_(A);
+    matrix_descriptor B_(B);
+    matrix_descriptor C_(C);
+
+    size_t bytes = 0;
+    check(cusparseSpMM_bufferSize(handle(), CUSPARSE_OPERATION_NON_TRANSPOSE, CUSPARSE_OPERATION_NON_TRANSPOSE,
+                                  &alpha, A_.get(), B_.get(), &beta, C_.get(),
+                                  data_type(ValueType()), CUSPARSE_SPMM_ALG_DEFAULT, &bytes), "cusparseSpMM_bufferSize failed");
+
+    workspace buffer;
+    check(cusparseSpMM(handle(), CUSPARSE_OPERATION_NON_TRANSPOSE, CUSPARSE_OPERATION_NON_TRANSPOSE,
+                       &alpha, A_.get(), B_.get(), &beta, C_.get(),
+                       data_type(ValueType()), CUSPARSE_SPMM_ALG_DEFAULT, buffer.get(bytes)), "cusparseSpMM failed");
+
+    return true;
+}
+
+// C <- A B into a csr_matrix, which is resized to the product
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool spgemm(const Matrix1& A, const Matrix2& B, Matrix3& C, thrust::detail::true_type)
+{
+    typedef typename Matrix1::value_type ValueType;
+
+    const ValueType alpha = 1;
+    const ValueType beta  = 0;
+
+    const cusparseOperation_t op   = CUSPARSE_OPERATION_NON_TRANSPOSE;
+    const cudaDataType        type = data_type(ValueType());
+
+    csr_descriptor A_(A);
+    csr_descriptor B_(B);
+    csr_descriptor C_(A.num_rows, B.num_cols, ValueType());
+
+    cusparseSpGEMMDescr_t descr;
+    check(cusparseSpGEMM_createDescr(&descr), "cusparseSpGEMM_createDescr failed");
+
+    try
+    {
+        size_t estimation_bytes = 0;
+        size_t compute_bytes    = 0;
+
+        workspace estimation_buffer;
+        workspace compute_buffer;
+
+        check(cusparseSpGEMM_workEstimation(handle(), op, op, &alpha, A_.get(), B_.get(), &beta, C_.get(), type,
+                                            CUSPARSE_SPGEMM_DEFAULT, descr, &estimation_bytes, 0), "cusparseSpGEMM_workEstimation failed");
+        check(cusparseSpGEMM_workEstimation(handle(), op, op, &alpha, A_.get(), B_.get(), &beta, C_.get(), type,
+                                            CUSPARSE_SPGEMM_DEFAULT, descr, &estimation_bytes, estimation_buffer.get(estimation_bytes)), "cusparseSpGEMM_workEstimation failed");
+
+        check(cusparseSpGEMM_compute(handle(), op, op, &alpha, A_.get(), B_.get(), &beta, C_.get(), type,
+                                     CUSPARSE_SPGEMM_DEFAULT, descr, &compute_bytes, 0), "cusparseSpGEMM_compute failed");
+        check(cusparseSpGEMM_compute(handle(), op, op, &alpha, A_.get(), B_.get(), &beta, C_.get(), type,
+                                     CUSPARSE_SPGEMM_DEFAULT, descr, &compute_bytes, compute_buffer.get(compute_bytes)), "cusparseSpGEMM_compute failed");
+
+        int64_t num_rows, num_cols, num_entries;
+        check(cusparseSpMatGetSize(C_.get(), &num_rows, &num_cols, &num_entries), "cusparseSpMatGetSize failed");
+
+        C.resize(A.num_rows, B.num_cols, num_entries);
+
+        check(cusparseCsrSetPointers(C_.get(), pointer(C.row_offsets), pointer(C.column_indices), pointer(C.values)),
+              "cusparseCsrSetPointers failed");
+
+        check(cusparseSpGEMM_copy(handle(), op, op, &alpha, A_.get(), B_.get(), &beta, C_.get(), type,
+                                  CUSPARSE_SPGEMM_DEFAULT, descr), "cusparseSpGEMM_copy failed");
+    }
+    catch (...)
+    {
+        cusparseSpGEMM_destroyDescr(descr);
+        throw;
+    }
+
+    cusparseSpGEMM_destroyDescr(descr);
+
+    return true;
+}
+
+// At <- A^T into a csr_matrix, which is resized to the transpose
+template <typename Matrix1, typename Matrix2>
+bool transpose(const Matrix1& A, Matrix2& At, thrust::detail::true_type)
+{
+    typedef typename Matrix1::value_type ValueType;
+
+    At.resize(A.num_cols, A.num_rows, A.num_entries);
+
+    if (A.num_entries == 0)
+    {
+        thrust::fill(At.row_offsets.begin(), At.row_offsets.end(), 0);
+        return true;
+    }
+
+    size_t bytes = 0;
+    check(cusparseCsr2cscEx2_bufferSize(handle(), A.num_rows, A.num_cols, A.num_entries,
+                                        pointer(A.values), static_cast<const int *>(pointer(A.row_offsets)), static_cast<const int *>(pointer(A.column_indices)),
+                                        pointer(At.values), static_cast<int *>(pointer(At.row_offsets)), static_cast<int *>(pointer(At.column_indices)),
+                                        data_type(ValueType()), CUSPARSE_ACTION_NUMERIC, CUSPARSE_INDEX_BASE_ZERO,
+                                        CUSPARSE_CSR2CSC_ALG1, &bytes), "cusparseCsr2cscEx2_bufferSize failed");
+
+    workspace buffer;
+    check(cusparseCsr2cscEx2(handle(), A.num_rows, A.num_cols, A.num_entries,
+                             pointer(A.values), static_cast<const int *>(pointer(A.row_offsets)), static_cast<const int *>(pointer(A.column_indices)),
+                             pointer(At.values), static_cast<int *>(pointer(At.row_offsets)), static_cast<int *>(pointer(At.column_indices)),
+                             data_type(ValueType()), CUSPARSE_ACTION_NUMERIC, CUSPARSE_INDEX_BASE_ZERO,
+                             CUSPARSE_CSR2CSC_ALG1, buffer.get(bytes)), "cusparseCsr2cscEx2 failed");
+
+    return true;
+}
+
+#if CUSPARSE_VERSION >= 11500
+
+// x <- T^-1 b over the lower or upper triangle of T
+template <typename Matrix, typename Vector1, typename Vector2>
+bool triangular_solve(const Matrix& T, const Vector1& b, Vector2& x,
+                      const bool lower, const bool unit, thrust::detail::true_type)
+{
+    typedef typename Matrix::value_type ValueType;
+
+    const ValueType alpha = 1;
+
+    const cusparseOperation_t op   = CUSPARSE_OPERATION_NON_TRANSPOSE;
+    const cudaDataType        type = data_type(ValueType());
+
+    if (T.num_rows == 0)
+        return true;
+
+    // x may alias b, the solve needs distinct vectors
+    cusp::array1d<ValueType, cusp::caching_device_allocator<ValueType> > b_copy;
+    if (pointer(b) == pointer(x))
+        b_copy.assign(b.begin(), b.end());
+
+    csr_descriptor    T_(T);
+    vector_descriptor b_(b_copy.empty() ? pointer(b) : pointer(b_copy), b.size(), ValueType());
+    vector_descriptor x_(x);
+
+    cusparseFillMode_t fill     = lower ? CUSPARSE_FILL_MODE_LOWER : CUSPARSE_FILL_MODE_UPPER;
+    cusparseDiagType_t diagonal = unit  ? CUSPARSE_DIAG_TYPE_UNIT  : CUSPARSE_DIAG_TYPE_NON_UNIT;
+
+    check(cusparseSpMatSetAttribute(T_.get(), CUSPARSE_SPMAT_FILL_MODE, &fill,     sizeof(fill)),     "cusparseSpMatSetAttribute failed");
+    check(cusparseSpMatSetAttribute(T_.get(), CUSPARSE_SPMAT_DIAG_TYPE, &diagonal, sizeof(diagonal)), "cusparseSpMatSetAttribute failed");
+
+    cusparseSpSVDescr_t descr;
+    check(cusparseSpSV_createDescr(&descr), "cusparseSpSV_createDescr failed");
+
+    try
+    {
+        size_t bytes = 0;
+        check(cusparseSpSV_bufferSize(handle(), op, &alpha, T_.get(), b_.get(), x_.get(), type,
+                                      CUSPARSE_SPSV_ALG_DEFAULT, descr, &bytes), "cusparseSpSV_bufferSize failed");
+
+        workspace buffer;
+        check(cusparseSpSV_analysis(handle(), op, &alpha, T_.get(), b_.get(), x_.get(), type,
+                                    CUSPARSE_SPSV_ALG_DEFAULT, descr, buffer.get(bytes)), "cusparseSpSV_analysis failed");
+        check(cusparseSpSV_solve(handle(), op, &alpha, T_.get(), b_.get(), x_.get(), type,
+                                 CUSPARSE_SPSV_ALG_DEFAULT, descr), "cusparseSpSV_solve failed");
+    }
+    catch (...)
+    {
+        cusparseSpSV_destroyDescr(descr);
+        throw;
+    }
+
+    cusparseSpSV_destroyDescr(descr);
+
+    return true;
+}
+
+#else
+
+template <typename Matrix, typename Vector1, typename Vector2>
+bool triangular_solve(const Matrix& T, const Vector1& b, Vector2& x,
+                      const bool lower, const bool unit, thrust::detail::true_type)
+{
+    return false;
+}
+
+#endif // CUSPARSE_VERSION >= 11500
+
+#endif // CUSP_USE_CUSPARSE
+
+// entry points, the index and value types select the implementation
+
+template <typename Matrix, typename Vector1, typename Vector2, typename Vector3, typename ScalarType>
+bool csrmv(const Matrix& A, const Vector1& x, const Vector2& z, Vector3& y, ScalarType alpha, ScalarType beta)
+{
+    typedef is_supported_operation<Matrix, typename Vector1::value_type, typename Vector3::value_type> supported;
+
+    return enabled() && csrmv(A, x, z, y, alpha, beta, typename supported::type());
+}
+
+template <typename Matrix, typename Vector1, typename Vector2>
+bool csrmv(const Matrix& A, const Vector1& x, Vector2& y)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    return csrmv(A, x, y, y, ValueType(1), ValueType(0));
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool csrmm(const Matrix1& A, const Matrix2& B, Matrix3& C)
+{
+    typedef is_supported_operation<Matrix1, typename Matrix2::value_type, typename Matrix3::value_type> supported;
+
+    return enabled() && csrmm(A, B, C, typename supported::type());
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool spgemm(const Matrix1& A, const Matrix2& B, Matrix3& C)
+{
+    // B and C must use the index type of A as well
+    typedef thrust::detail::integral_constant<bool,
+        is_supported_operation<Matrix1, typename Matrix2::value_type, typename Matrix3::value_type>::value &&
+        thrust::detail::is_same<typename Matrix1::index_type, typename Matrix2::index_type>::value &&
+        thrust::detail::is_same<typename Matrix1::index_type, typename Matrix3::index_type>::value> supported;
+
+    return enabled() && spgemm(A, B, C, typename supported::type());
+}
+
+template <typename Matrix1, typename Matrix2>
+bool transpose(const Matrix1& A, Matrix2& At)
+{
+    typedef thrust::detail::integral_constant<bool,
+        is_supported_operation<Matrix1, typename Matrix2::value_type, typename Matrix2::value_type>::value &&
+        thrust::detail::is_same<typename Matrix1::index_type, typename Matrix2::index_type>::value> supported;
+
+    return enabled() && transpose(A, At, typename supported::type());
+}
+
+template <typename Matrix, typename Vector1, typename Vector2>
+bool triangular_solve(const Matrix& T, const Vector1& b, Vector2& x, const bool lower, const bool unit)
+{
+    typedef is_supported_operation<Matrix, typename Vector1::value_type, typename Vector2::value_type> supported;
+
+    return enabled() && triangular_solve(T, b, x, lower, unit, typename supported::type());
+}
+
+} // end namespace cusparse
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,349 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array2d.h>
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/cublas.h>
+#include <cusp/detail/device/utils.h>
+
+#include <thrust/device_ptr.h>
+#include <thrust/extrema.h>
+#include <thrust/fill.h>
+
+#include <algorithm>
+
+// Dense matrix-vector (GEMV) and matrix-matrix (GEMM) products of array2d
+// operands.  Every kernel is arranged so that consecutive threads of a
+// warp read consecutive addresses of the dense matrices, whichever their
+// orientation and pitch.  When Cusp is built with CUSP_USE_CUBLAS the
+// float and double products are delegated to cuBLAS instead.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+template <typename Orientation> struct is_row_major                   { static const bool value = false; };
+template <>                     struct is_row_major<cusp::row_major> { static const bool value = true;  };
+
+//////////////////////////////////////////////////////////////////////////////
+// GEMV kernels
+//////////////////////////////////////////////////////////////////////////////
+//
+// gemv_row_major_kernel
+//   A vector of THREADS_PER_VECTOR threads computes y[i] = A[i,:] * x for
+//   a row-major A, reading the row contiguously, as spmv_csr_vector_kernel.
+//
+// gemv_column_major_kernel
+//   Each thread computes one y[i] for a column-major A.  The threads of a
+//   block read consecutive entries of each column, and x is staged through
+//   shared memory one BLOCK_SIZE tile at a time.
+//
+//  Note: THREADS_PER_VECTOR must be one of [2,4,8,16,32]
+
+template <typename IndexType, typename ValueType, unsigned int VECTORS_PER_BLOCK, unsigned int THREADS_PER_VECTOR>
+__launch_bounds__(VECTORS_PER_BLOCK * THREADS_PER_VECTOR,1)
+__global__ void
+gemv_row_major_kernel(const IndexType num_rows,
+                      const IndexType num_cols,
+                      const ValueType * A,
+                      const IndexType   pitch,
+                      const ValueType * x,
+                            ValueType * y)
+{
+    __shared__ volatile ValueType sdata[VECTORS_PER_BLOCK * THREADS_PER_VECTOR + THREADS_PER_VECTOR / 2];  // padded to avoid reduction conditionals
+
+    const IndexType THREADS_PER_BLOCK = VECTORS_PER_BLOCK * THREADS_PER_VECTOR;
+
+    const IndexType thread_id   = THREADS_PER_BLOCK * blockIdx.x + threadIdx.x;    // global thread index
+    const IndexType thread_lane = threadIdx.x & (THREADS_PER_VECTOR - 1);          // thread index within the vector
+    const IndexType vector_id   = thread_id   /  THREADS_PER_VECTOR;               // global vector index
+    const IndexType num_vectors = VECTORS_PER_BLOCK * gridDim.x;                   // total number of active vectors
+
+    for(IndexType row = vector_id; row < num_rows; row += num_vectors)
+    {
+        const ValueType * A_row = A + row * pitch;
+
+        // accumulate local sums
+        ValueType sum = 0;
+
+        for(IndexType j = thread_lane; j < num_cols; j += THREADS_PER_VECTOR)
+            sum += A_row[j] * x[j];
+
+        // store local sum in shared memory
+        sdata[threadIdx.x] = sum;
+
+        // reduce local sums to row sum
+        if (THREADS_PER_VECTOR > 16) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x + 16];
+        if (THREADS_PER_VECTOR >  8) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  8];
+        if (THREADS_PER_VECTOR >  4) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  4];
+        if (THREADS_PER_VECTOR >  2) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  2];
+        if (THREADS_PER_VECTOR >  1) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  1];
+
+        // first thread writes the result
+        if (thread_lane == 0)
+            y[row] = sdata[threadIdx.x];
+    }
+}
+
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+gemv_column_major_kernel(const IndexType num_rows,
+                         const IndexType num_cols,
+                         const ValueType * A,
+                         const IndexType   pitch,
+                         const ValueType * x,
+                               ValueType * y)
+{
+    __shared__ ValueType x_tile[BLOCK_SIZE];
+
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+
+    // the loop bounds are uniform across the block, so every thread
+    // reaches the barriers
+    for(IndexType base = BLOCK_SIZE * blockIdx.x; base < num_rows; base += grid_size)
+    {
+        const IndexType row = base + threadIdx.x;
+
+        ValueType sum = 0;
+
+        for(IndexType j0 = 0; j0 < num_cols; j0 += BLOCK_SIZE)
+        {
+            const IndexType tile_size = thrust::min<IndexType>(BLOCK_SIZE, num_cols - j0);
+
+            __syncthreads();
+
+            if (threadIdx.x < tile_size)
+                x_tile[threadIdx.x] = x[j0 + threadIdx.x];
+
+            __syncthreads();
+
+            if (row < num_rows)
+            {
+                const ValueType * A_col = A + j0 * pitch + row;
+
+                for(IndexType jj = 0; jj < tile_size; jj++)
+                    sum += A_col[jj * pitch] * x_tile[jj];
+            }
+        }
+
+        if (row < num_rows)
+            y[row] = sum;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// GEMM kernel
+//////////////////////////////////////////////////////////////////////////////
+//
+// gemm_tiled_kernel
+//   Each TILE_SIZE x TILE_SIZE thread block computes a tile of C = A * B,
+//   staging TILE_SIZE x TILE_SIZE tiles of A and B through shared memory.
+//   Each tile is loaded with threadIdx.x running along the contiguous
+//   dimension of the operand, and each thread writes the entry of C whose
+//   address follows threadIdx.x, so all global accesses are coalesced.
+//   The tiles are padded by one column to avoid shared memory bank
+//   conflicts when they are read along the other dimension.
+
+template <typename IndexType, typename ValueType,
+          typename OrientationA, typename OrientationB, typename OrientationC,
+          unsigned int TILE_SIZE>
+__launch_bounds__(TILE_SIZE * TILE_SIZE,1)
+__global__ void
+gemm_tiled_kernel(const IndexType num_rows,
+                  const IndexType num_cols,
+                  const IndexType num_inner,
+                  const ValueType * A, const IndexType A_pitch,
+                  const ValueType * B, const IndexType B_pitch,
+                        ValueType * C, const IndexType C_pitch)
+{
+    __shared__ ValueType A_tile[TILE_SIZE][TILE_SIZE + 1];   // A_tile[row][k]
+    __shared__ ValueType B_tile[TILE_SIZE][TILE_SIZE + 1];   // B_tile[k][col]
+
+    const IndexType tx = threadIdx.x;
+    const IndexType ty = threadIdx.y;
+
+    // position of this thread within each tile
+    const IndexType a_i = is_row_major<OrientationA>::value ? ty : tx;
+    const IndexType a_k = is_row_major<OrientationA>::value ? tx : ty;
+    const IndexType b_k = is_row_major<OrientationB>::value ? ty : tx;
+    const IndexType b_j = is_row_major<OrientationB>::value ? tx : ty;
+    const IndexType c_i = is_row_major<OrientationC>::value ? ty : tx;
+    const IndexType c_j = is_row_major<OrientationC>::value ? tx : ty;
+
+    for(IndexType row0 = TILE_SIZE * blockIdx.y; row0 < num_rows; row0 += TILE_SIZE * gridDim.y)
+    {
+        for(IndexType col0 = TILE_SIZE * blockIdx.x; col0 < num_cols; col0 += TILE_SIZE * gridDim.x)
+        {
+            ValueType sum = 0;
+
+            for(IndexType k0 = 0; k0 < num_inner; k0 += TILE_SIZE)
+            {
+                A_tile[a_i][a_k] = (row0 + a_i < num_rows && k0 + a_k < num_inner) ?
+                    A[cusp::detail::index_of(row0 + a_i, k0 + a_k, A_pitch, OrientationA())] : ValueType(0);
+
+                B_tile[b_k][b_j] = (k0 + b_k < num_inner && col0 + b_j < num_cols) ?
+                    B[cusp::detail::index_of(k0 + b_k, col0 + b_j, B_pitch, OrientationB())] : ValueType(0);
+
+                __syncthreads();
+
+                for(IndexType kk = 0; kk < TILE_SIZE; kk++)
+                    sum += A_tile[c_i][kk] * B_tile[kk][c_j];
+
+                __syncthreads();
+            }
+
+            if (row0 + c_i < num_rows && col0 + c_j < num_cols)
+                C[cusp::detail::index_of(row0 + c_i, col0 + c_j, C_pitch, OrientationC())] = sum;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// launchers
+//////////////////////////////////////////////////////////////////////////////
+
+template <unsigned int THREADS_PER_VECTOR, typename IndexType, typename ValueType>
+void __gemv_row_major(const IndexType num_rows, const IndexType num_cols,
+                      const ValueType * A, const IndexType pitch,
+                      const ValueType * x, ValueType * y)
+{
+    const size_t THREADS_PER_BLOCK  = 128;
+    const size_t VECTORS_PER_BLOCK  = THREADS_PER_BLOCK / THREADS_PER_VECTOR;
+
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(gemv_row_major_kernel<IndexType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR>, THREADS_PER_BLOCK, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(num_rows, VECTORS_PER_BLOCK));
+
+    gemv_row_major_kernel<IndexType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR> <<<NUM_BLOCKS, THREADS_PER_BLOCK, 0, cusp::detail::current_stream()>>>
+        (num_rows, num_cols, A, pitch, x, y);
+}
+
+template <typename IndexType, typename ValueType>
+void __gemv(const IndexType num_rows, const IndexType num_cols,
+            const ValueType * A, const IndexType pitch,
+            const ValueType * x, ValueType * y,
+            cusp::row_major)
+{
+    // the vector width is the smallest power of two in [2,32] that is not
+    // less than the row length
+    if (num_cols <=  2) { __gemv_row_major< 2>(num_rows, num_cols, A, pitch, x, y); return; }
+    if (num_cols <=  4) { __gemv_row_major< 4>(num_rows, num_cols, A, pitch, x, y); return; }
+    if (num_cols <=  8) { __gemv_row_major< 8>(num_rows, num_cols, A, pitch, x, y); return; }
+    if (num_cols <= 16) { __gemv_row_major<16>(num_rows, num_cols, A, pitch, x, y); return; }
+
+    __gemv_row_major<32>(num_rows, num_cols, A, pitch, x, y);
+}
+
+template <typename IndexType, typename ValueType>
+void __gemv(const IndexType num_rows, const IndexType num_cols,
+            const ValueType * A, const IndexType pitch,
+            const ValueType * x, ValueType * y,
+            cusp::column_major)
+{
+    const size_t BLOCK_SIZE = 256;
+
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(gemv_column_major_kernel<IndexType, ValueType, BLOCK_SIZE>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(num_rows, BLOCK_SIZE));
+
+    gemv_column_major_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (num_rows, num_cols, A, pitch, x, y);
+}
+
+// y <- A * x
+template <typename Matrix, typename Vector1, typename Vector2>
+void gemv(const Matrix& A, const Vector1& x, Vector2& y)
+{
+    typedef typename Matrix::value_type ValueType;
+    typedef typename Matrix::orientation Orientation;
+    typedef int IndexType;
+
+    if (A.num_rows == 0)
+        return;
+
+    ValueType * y_ptr = thrust::raw_pointer_cast(&y[0]);
+
+    if (A.num_cols == 0)
+    {
+        thrust::fill(thrust::device_pointer_cast(y_ptr), thrust::device_pointer_cast(y_ptr) + A.num_rows, ValueType(0));
+        return;
+    }
+
+    const ValueType * A_ptr = thrust::raw_pointer_cast(&A.values[0]);
+    const ValueType * x_ptr = thrust::raw_pointer_cast(&x[0]);
+
+    if (cusp::detail::device::cublas::gemv(A.num_rows, A.num_cols, A_ptr, A.pitch, x_ptr, y_ptr, Orientation()))
+        return;
+
+    __gemv(IndexType(A.num_rows), IndexType(A.num_cols), A_ptr, IndexType(A.pitch), x_ptr, y_ptr, Orientation());
+}
+
+// C <- A * B
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+void gemm(const Matrix1& A, const Matrix2& B, Matrix3& C)
+{
+    typedef typename Matrix3::value_type ValueType;
+    typedef typename Matrix1::orientation OrientationA;
+    typedef typename Matrix2::orientation OrientationB;
+    typedef typename Matrix3::orientation OrientationC;
+    typedef int IndexType;
+
+    C.resize(A.num_rows, B.num_cols);
+
+    if (C.num_rows == 0 || C.num_cols == 0)
+        return;
+
+    if (A.num_cols == 0)
+    {
+        thrust::fill(C.values.begin(), C.values.end(), ValueType(0));
+        return;
+    }
+
+    const ValueType * A_ptr = thrust::raw_pointer_cast(&A.values[0]);
+    const ValueType * B_ptr = thrust::raw_pointer_cast(&B.values[0]);
+          ValueType * C_ptr = thrust::raw_pointer_cast(&C.values[0]);
+
+    if (cusp::detail::device::cublas::gemm(C.num_rows, C.num_cols, A.num_cols,
+                                           A_ptr, A.pitch, OrientationA(),
+                                           B_ptr, B.pitch, OrientationB(),
+                                           C_ptr, C.pitch, OrientationC()))
+        return;
+
+    const unsigned int TILE_SIZE = 16;
+    const size_t MAX_GRID = 65535;
+
+    const dim3 block(TILE_SIZE, TILE_SIZE);
+    const dim3 grid(std::min<size_t>(MAX_GRID, DIVIDE_INTO(C.num_cols, TILE_SIZE)),
+                    std::min<size_t>(MAX_GRID, DIVIDE_INTO(C.num_rows, TILE_SIZE)));
+
+    gemm_tiled_kernel<IndexType, ValueType, OrientationA, OrientationB, OrientationC, TILE_SIZE> <<<grid, block, 0, cusp::detail::current_stream()>>>
+        (IndexType(C.num_rows), IndexType(C.num_cols), IndexType(A.num_cols),
+         A_ptr, IndexType(A.pitch),
+         B_ptr, IndexType(B.pitch),
+         C_ptr, IndexType(C.pitch));
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
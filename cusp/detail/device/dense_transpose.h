@@ -0,0 +1,115 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/utils.h>
+
+#include <algorithm>
+
+// Tiled transposition of a pitched dense array: row i of the
+// num_major x num_minor source, src[i * src_pitch + j], becomes column i
+// of the destination, dst[j * dst_pitch + i].
+//
+// A block reads a TRANSPOSE_TILE x TRANSPOSE_TILE tile of the source into
+// shared memory row by row and writes it to the destination row by row,
+// so the warps read and write consecutive addresses on both sides.  The
+// tile is padded by one column so that the columns read back from shared
+// memory fall into distinct banks.  A tile starts at a multiple of
+// TRANSPOSE_TILE within its row, hence the accesses are aligned to
+// whole segments when both pitches are multiples of TRANSPOSE_TILE.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+const unsigned int TRANSPOSE_TILE       = 32;
+const unsigned int TRANSPOSE_BLOCK_ROWS = 8;
+
+template <typename ValueType1, typename ValueType2>
+__global__ void
+transpose_dense_kernel(const size_t num_major,
+                       const size_t num_minor,
+                       const ValueType1 * src,
+                       const size_t src_pitch,
+                             ValueType2 * dst,
+                       const size_t dst_pitch)
+{
+    __shared__ ValueType1 tile[TRANSPOSE_TILE][TRANSPOSE_TILE + 1];
+
+    const size_t tiles_minor = DIVIDE_INTO(num_minor, TRANSPOSE_TILE);
+    const size_t num_tiles   = DIVIDE_INTO(num_major, TRANSPOSE_TILE) * tiles_minor;
+
+    for(size_t t = blockIdx.x; t < num_tiles; t += gridDim.x)
+    {
+        const size_t major_begin = (t / tiles_minor) * TRANSPOSE_TILE;
+        const size_t minor_begin = (t % tiles_minor) * TRANSPOSE_TILE;
+
+        // consecutive threads read consecutive entries of a source row
+        for(unsigned int k = threadIdx.y; k < TRANSPOSE_TILE; k += TRANSPOSE_BLOCK_ROWS)
+        {
+            const size_t i = major_begin + k;
+            const size_t j = minor_begin + threadIdx.x;
+
+            if(i < num_major && j < num_minor)
+                tile[k][threadIdx.x] = src[i * src_pitch + j];
+        }
+
+        __syncthreads();
+
+        // and write consecutive entries of a destination row
+        for(unsigned int k = threadIdx.y; k < TRANSPOSE_TILE; k += TRANSPOSE_BLOCK_ROWS)
+        {
+            const size_t j = minor_begin + k;
+            const size_t i = major_begin + threadIdx.x;
+
+            if(i < num_major && j < num_minor)
+                dst[j * dst_pitch + i] = ValueType2(tile[threadIdx.x][k]);
+        }
+
+        // wait until the tile has been written before it is overwritten
+        __syncthreads();
+    }
+}
+
+template <typename ValueType1, typename ValueType2>
+void transpose_dense(const size_t num_major, const size_t num_minor,
+                     const ValueType1 * src, const size_t src_pitch,
+                           ValueType2 * dst, const size_t dst_pitch)
+{
+    if (num_major == 0 || num_minor == 0)
+        return;
+
+    const size_t BLOCK_SIZE = TRANSPOSE_TILE * TRANSPOSE_BLOCK_ROWS;
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(transpose_dense_kernel<ValueType1, ValueType2>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_TILES  = DIVIDE_INTO(num_major, TRANSPOSE_TILE) * DIVIDE_INTO(num_minor, TRANSPOSE_TILE);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, NUM_TILES);
+
+    const dim3 block(TRANSPOSE_TILE, TRANSPOSE_BLOCK_ROWS);
+
+    transpose_dense_kernel<ValueType1, ValueType2> <<<NUM_BLOCKS, block, 0, cusp::detail::current_stream()>>>
+        (num_major, num_minor, src, src_pitch, dst, dst_pitch);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
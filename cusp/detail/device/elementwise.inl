@@ -62,6 +62,41 @@ void subtract(const Matrix1& A,
 }
 
 
+/////////
+// CSR //
+/////////
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void add(const Matrix1& A,
+         const Matrix2& B,
+               Matrix3& C,
+         cusp::csr_format,
+         cusp::csr_format,
+         cusp::csr_format)
+{
+    typedef typename Matrix3::value_type ValueType;
+
+    cusp::detail::csr_add(A, B, C, ValueType(1), ValueType(1));
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void subtract(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::csr_format,
+              cusp::csr_format,
+              cusp::csr_format)
+{
+    typedef typename Matrix3::value_type ValueType;
+
+    cusp::detail::csr_add(A, B, C, ValueType(1), ValueType(-1));
+}
+
+
 ///////////
 // Array //
 ///////////
@@ -0,0 +1,169 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/utils.h>
+
+#include <thrust/extrema.h>
+
+#include <algorithm>
+
+// Conversion between the compressed row offsets and the uncompressed
+// row indices of a sparse matrix, both single passes over the indices.
+//
+// indices_to_offsets detects the boundaries of the sorted indices: the
+// thread of position k writes offsets[r] = k for every row r in
+// (indices[k - 1], indices[k]], so each offset is written exactly once.
+//
+// offsets_to_indices expands the offsets along a merge path of the row
+// end offsets and the positions of the indices, as spmv_csr_merge does.
+// Each thread consumes OFFSETS_ITEMS_PER_THREAD items of the path, hence
+// the work is balanced regardless of the row lengths, and the threads of
+// a warp write consecutive segments of the indices.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+const size_t OFFSETS_ITEMS_PER_THREAD = 8;
+
+// the coordinate (row, nz) where 'diagonal' crosses the merge path
+template <typename OffsetType>
+__device__
+void offsets_merge_path_search(const size_t diagonal,
+                               const size_t num_rows,
+                               const size_t num_entries,
+                               const OffsetType * row_end_offsets,
+                                     size_t& row,
+                                     size_t& nz)
+{
+    size_t lo = diagonal > num_entries ? diagonal - num_entries : 0;
+    size_t hi = thrust::min(diagonal, num_rows);
+
+    while (lo < hi)
+    {
+        const size_t mid = (lo + hi) >> 1;
+
+        if (size_t(row_end_offsets[mid]) + mid + 1 <= diagonal)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    row = lo;
+    nz  = diagonal - lo;
+}
+
+template <typename IndexType, typename OffsetType>
+__global__ void
+indices_to_offsets_kernel(const size_t num_entries,
+                          const size_t num_rows,
+                          const IndexType * indices,
+                                OffsetType * offsets)
+{
+    const size_t thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const size_t grid_size = gridDim.x * blockDim.x;
+
+    for(size_t k = thread_id; k <= num_entries; k += grid_size)
+    {
+        const size_t first = k == 0           ? 0        : thrust::min<size_t>(indices[k - 1], num_rows) + 1;
+        const size_t last  = k == num_entries ? num_rows : thrust::min<size_t>(indices[k],     num_rows);
+
+        for(size_t r = first; r <= last; r++)
+            offsets[r] = OffsetType(k);
+    }
+}
+
+template <typename OffsetType, typename IndexType>
+__global__ void
+offsets_to_indices_kernel(const size_t num_rows,
+                          const size_t num_entries,
+                          const OffsetType * offsets,
+                                IndexType * indices)
+{
+    const size_t thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const size_t grid_size = gridDim.x * blockDim.x;
+
+    const OffsetType * row_end_offsets = offsets + 1;
+    const size_t num_items = num_rows + num_entries;
+
+    for(size_t diagonal = thread_id * OFFSETS_ITEMS_PER_THREAD; diagonal < num_items; diagonal += grid_size * OFFSETS_ITEMS_PER_THREAD)
+    {
+        const size_t diagonal_end = thrust::min(diagonal + OFFSETS_ITEMS_PER_THREAD, num_items);
+
+        size_t row, nz, row_end, nz_end;
+        offsets_merge_path_search(diagonal,     num_rows, num_entries, row_end_offsets, row,     nz);
+        offsets_merge_path_search(diagonal_end, num_rows, num_entries, row_end_offsets, row_end, nz_end);
+
+        // the rows that terminate inside this interval
+        for(; row < row_end; row++)
+        {
+            const size_t row_stop = thrust::min<size_t>(row_end_offsets[row], num_entries);
+
+            for(; nz < row_stop; nz++)
+                indices[nz] = IndexType(row);
+        }
+
+        // and the leading positions of the row that continues past it,
+        // positions past the last row belong to the last row
+        for(; nz < nz_end; nz++)
+            indices[nz] = IndexType(thrust::min(row, num_rows - 1));
+    }
+}
+
+// offsets[r] <- the first position k of the sorted indices with
+// indices[k] >= r, for r in [0, num_rows]
+template <typename IndexType, typename OffsetType>
+void indices_to_offsets(const size_t num_entries, const size_t num_rows,
+                        const IndexType * indices, OffsetType * offsets)
+{
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(indices_to_offsets_kernel<IndexType, OffsetType>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(num_entries + 1, BLOCK_SIZE));
+
+    indices_to_offsets_kernel<IndexType, OffsetType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (num_entries, num_rows, indices, offsets);
+}
+
+// indices[k] <- the row r of the num_rows offsets with
+// offsets[r] <= k < offsets[r + 1], for k in [0, num_entries)
+template <typename OffsetType, typename IndexType>
+void offsets_to_indices(const size_t num_rows, const size_t num_entries,
+                        const OffsetType * offsets, IndexType * indices)
+{
+    if (num_rows == 0 || num_entries == 0)
+        return;
+
+    const size_t NUM_THREADS = DIVIDE_INTO(num_rows + num_entries, OFFSETS_ITEMS_PER_THREAD);
+    const size_t BLOCK_SIZE  = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS  = cusp::detail::device::arch::max_blocks(offsets_to_indices_kernel<OffsetType, IndexType>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS  = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(NUM_THREADS, BLOCK_SIZE));
+
+    offsets_to_indices_kernel<OffsetType, IndexType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (num_rows, num_entries, offsets, indices);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
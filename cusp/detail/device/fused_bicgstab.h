@@ -0,0 +1,406 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/linear_operator.h>
+#include <cusp/multiply.h>
+
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/fused_cg.h>
+#include <cusp/detail/device/utils.h>
+
+#include <thrust/detail/type_traits.h>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// BiCGStab iteration with device-resident scalars
+//////////////////////////////////////////////////////////////////////////////
+//
+// As in fused_cg, the scalars (rho, alpha, omega, beta) never leave the
+// device: every inner product writes one partial sum per block and a
+// single-block kernel derives the next scalar from the partials.  The
+// inner products are fused with the vector updates that precede them,
+// and the two products of omega share one pass, such that an iteration
+// consists of
+//
+//    Mp    <- M p, AMp <- A Mp                (SpMV)
+//    alpha <- rho / <r*,AMp>                  (two launches)
+//    s     <- r - alpha AMp                   (one launch)
+//    Ms    <- M s, t <- A Ms                  (SpMV)
+//    omega <- <t,s> / <t,t>                   (two launches)
+//    x     <- x + alpha Mp + omega Ms,
+//    r     <- s - omega t, partial <r*,r>     (one launch)
+//    beta  <- (rho_new / rho) (alpha / omega) (one launch)
+//    p     <- r + beta (p - omega AMp)        (one launch)
+//
+// Without a preconditioner Mp = p and Ms = s.  The early exit of
+// bicgstab on a converged s requires the norm of s on the host, hence
+// it is omitted.  A vanishing denominator yields a zero scalar instead,
+// so an exactly converged iteration leaves x and r unchanged.
+//
+
+// layout of the scalar array
+enum { BICGSTAB_RHO = 0, BICGSTAB_ALPHA = 1, BICGSTAB_OMEGA = 2, BICGSTAB_BETA = 3, BICGSTAB_NUM_SCALARS = 4 };
+
+// alpha <- rho / sum(partials)
+template <typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+bicgstab_alpha_kernel(const unsigned int num_partials,
+                      const ValueType * partials,
+                            ValueType * scalars)
+{
+    __shared__ ValueType sdata[BLOCK_SIZE];
+
+    ValueType sum = 0;
+
+    for (unsigned int i = threadIdx.x; i < num_partials; i += BLOCK_SIZE)
+        sum = sum + partials[i];
+
+    sum = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata, sum);
+
+    if (threadIdx.x == 0)
+        scalars[BICGSTAB_ALPHA] = (sum == ValueType(0)) ? ValueType(0) : scalars[BICGSTAB_RHO] / sum;
+}
+
+// s <- r - alpha * AMp
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+bicgstab_update_s_kernel(const IndexType N,
+                         const ValueType * scalars,
+                         const ValueType * r,
+                         const ValueType * AMp,
+                               ValueType * s)
+{
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+    const ValueType alpha     = scalars[BICGSTAB_ALPHA];
+
+    for (IndexType i = BLOCK_SIZE * blockIdx.x + threadIdx.x; i < N; i += grid_size)
+        s[i] = r[i] - alpha * AMp[i];
+}
+
+// partials[2 * blockIdx.x] <- partial <t,s>, partials[2 * blockIdx.x + 1] <- partial <t,t>
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+bicgstab_omega_dots_kernel(const IndexType N,
+                           const ValueType * t,
+                           const ValueType * s,
+                                 ValueType * partials)
+{
+    __shared__ ValueType sdata_ts[BLOCK_SIZE];
+    __shared__ ValueType sdata_tt[BLOCK_SIZE];
+
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+
+    ValueType ts = 0;
+    ValueType tt = 0;
+
+    for (IndexType i = BLOCK_SIZE * blockIdx.x + threadIdx.x; i < N; i += grid_size)
+    {
+        const ValueType ti = cusp::blas::detail::conjugate<ValueType>()(t[i]);
+
+        ts = ts + ti * s[i];
+        tt = tt + ti * t[i];
+    }
+
+    ts = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata_ts, ts);
+    tt = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata_tt, tt);
+
+    if (threadIdx.x == 0)
+    {
+        partials[2 * blockIdx.x + 0] = ts;
+        partials[2 * blockIdx.x + 1] = tt;
+    }
+}
+
+// omega <- sum(<t,s> partials) / sum(<t,t> partials)
+template <typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+bicgstab_omega_kernel(const unsigned int num_partials,
+                      const ValueType * partials,
+                            ValueType * scalars)
+{
+    __shared__ ValueType sdata_ts[BLOCK_SIZE];
+    __shared__ ValueType sdata_tt[BLOCK_SIZE];
+
+    ValueType ts = 0;
+    ValueType tt = 0;
+
+    for (unsigned int i = threadIdx.x; i < num_partials; i += BLOCK_SIZE)
+    {
+        ts = ts + partials[2 * i + 0];
+        tt = tt + partials[2 * i + 1];
+    }
+
+    ts = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata_ts, ts);
+    tt = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata_tt, tt);
+
+    // t vanishes only with s
+    if (threadIdx.x == 0)
+        scalars[BICGSTAB_OMEGA] = (tt == ValueType(0)) ? ValueType(0) : ts / tt;
+}
+
+// x <- x + alpha * Mp + omega * Ms, r <- s - omega * t, and
+// partials[blockIdx.x] <- partial <r*,r>
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+bicgstab_update_xr_kernel(const IndexType N,
+                          const ValueType * scalars,
+                          const ValueType * Mp,
+                          const ValueType * Ms,
+                          const ValueType * s,
+                          const ValueType * t,
+                          const ValueType * r_star,
+                                ValueType * x,
+                                ValueType * r,
+                                ValueType * partials)
+{
+    __shared__ ValueType sdata[BLOCK_SIZE];
+
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+    const ValueType alpha     = scalars[BICGSTAB_ALPHA];
+    const ValueType omega     = scalars[BICGSTAB_OMEGA];
+
+    ValueType sum = 0;
+
+    for (IndexType i = BLOCK_SIZE * blockIdx.x + threadIdx.x; i < N; i += grid_size)
+    {
+        const ValueType ri = s[i] - omega * t[i];
+
+        x[i] = x[i] + alpha * Mp[i] + omega * Ms[i];
+        r[i] = ri;
+
+        sum = sum + cusp::blas::detail::conjugate<ValueType>()(r_star[i]) * ri;
+    }
+
+    sum = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata, sum);
+
+    if (threadIdx.x == 0)
+        partials[blockIdx.x] = sum;
+}
+
+// rho_new <- sum(partials), beta <- (rho_new / rho) * (alpha / omega),
+// rho <- rho_new.  With initialize, only rho is set.
+template <typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+bicgstab_beta_kernel(const unsigned int num_partials,
+                     const ValueType * partials,
+                           ValueType * scalars,
+                     const bool initialize)
+{
+    __shared__ ValueType sdata[BLOCK_SIZE];
+
+    ValueType sum = 0;
+
+    for (unsigned int i = threadIdx.x; i < num_partials; i += BLOCK_SIZE)
+        sum = sum + partials[i];
+
+    sum = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata, sum);
+
+    if (threadIdx.x == 0)
+    {
+        const ValueType rho   = scalars[BICGSTAB_RHO];
+        const ValueType omega = scalars[BICGSTAB_OMEGA];
+
+        if (!initialize)
+            scalars[BICGSTAB_BETA] = (rho == ValueType(0) || omega == ValueType(0)) ?
+                                     ValueType(0) : (sum / rho) * (scalars[BICGSTAB_ALPHA] / omega);
+        scalars[BICGSTAB_RHO] = sum;
+    }
+}
+
+// p <- r + beta * (p - omega * AMp)
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+bicgstab_update_p_kernel(const IndexType N,
+                         const ValueType * scalars,
+                         const ValueType * r,
+                         const ValueType * AMp,
+                               ValueType * p)
+{
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+    const ValueType omega     = scalars[BICGSTAB_OMEGA];
+    const ValueType beta      = scalars[BICGSTAB_BETA];
+
+    for (IndexType i = BLOCK_SIZE * blockIdx.x + threadIdx.x; i < N; i += grid_size)
+        p[i] = r[i] + beta * (p[i] - omega * AMp[i]);
+}
+
+// one iteration, issued on the current stream
+template <typename IndexType,
+          typename ValueType,
+          unsigned int BLOCK_SIZE,
+          class LinearOperator,
+          class Preconditioner,
+          class Vector,
+          class Array>
+void fused_bicgstab_iteration(LinearOperator& A,
+                              Preconditioner& M,
+                              const bool Unpreconditioned,
+                              const unsigned int NUM_BLOCKS,
+                              Vector& x,
+                              Array& r,
+                              Array& r_star,
+                              Array& p,
+                              Array& Mp,
+                              Array& AMp,
+                              Array& s,
+                              Array& Ms,
+                              Array& t,
+                              Array& partials,
+                              Array& scalars)
+{
+    cudaStream_t stream = cusp::detail::current_stream();
+
+    const IndexType N = A.num_rows;
+
+    // AMp <- A*M*p
+    if (!Unpreconditioned)
+        cusp::multiply(M, p, Mp);
+    cusp::multiply(A, Unpreconditioned ? p : Mp, AMp);
+
+    ValueType * x_ptr        = thrust::raw_pointer_cast(&x[0]);
+    ValueType * r_ptr        = thrust::raw_pointer_cast(&r[0]);
+    ValueType * r_star_ptr   = thrust::raw_pointer_cast(&r_star[0]);
+    ValueType * p_ptr        = thrust::raw_pointer_cast(&p[0]);
+    ValueType * AMp_ptr      = thrust::raw_pointer_cast(&AMp[0]);
+    ValueType * s_ptr        = thrust::raw_pointer_cast(&s[0]);
+    ValueType * t_ptr        = thrust::raw_pointer_cast(&t[0]);
+    ValueType * Mp_ptr       = Unpreconditioned ? p_ptr : thrust::raw_pointer_cast(&Mp[0]);
+    ValueType * Ms_ptr       = Unpreconditioned ? s_ptr : thrust::raw_pointer_cast(&Ms[0]);
+    ValueType * partials_ptr = thrust::raw_pointer_cast(&partials[0]);
+    ValueType * scalars_ptr  = thrust::raw_pointer_cast(&scalars[0]);
+
+    // alpha <- rho / <r*,AMp>
+    cg_dotc_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>(N, r_star_ptr, AMp_ptr, partials_ptr);
+    bicgstab_alpha_kernel<ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE, 0, stream>>>(NUM_BLOCKS, partials_ptr, scalars_ptr);
+
+    // s <- r - alpha * AMp
+    bicgstab_update_s_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>(N, scalars_ptr, r_ptr, AMp_ptr, s_ptr);
+
+    // t <- A*M*s
+    if (!Unpreconditioned)
+        cusp::multiply(M, s, Ms);
+    cusp::multiply(A, Unpreconditioned ? s : Ms, t);
+
+    // omega <- <t,s> / <t,t>, both products in one pass
+    bicgstab_omega_dots_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>(N, t_ptr, s_ptr, partials_ptr);
+    bicgstab_omega_kernel<ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE, 0, stream>>>(NUM_BLOCKS, partials_ptr, scalars_ptr);
+
+    // x <- x + alpha * Mp + omega * Ms, r <- s - omega * t, partial <r*,r>
+    bicgstab_update_xr_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>
+        (N, scalars_ptr, Mp_ptr, Ms_ptr, s_ptr, t_ptr, r_star_ptr, x_ptr, r_ptr, partials_ptr);
+
+    // beta <- (rho_new / rho) * (alpha / omega)
+    bicgstab_beta_kernel<ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE, 0, stream>>>(NUM_BLOCKS, partials_ptr, scalars_ptr, false);
+
+    // p <- r + beta * (p - omega * AMp)
+    bicgstab_update_p_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>(N, scalars_ptr, r_ptr, AMp_ptr, p_ptr);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void fused_bicgstab(LinearOperator& A,
+                    Vector& x,
+                    Vector& b,
+                    Monitor& monitor,
+                    Preconditioner& M,
+                    const size_t check_interval)
+{
+    typedef typename LinearOperator::index_type   IndexType;
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    // Mp = p and Ms = s without a preconditioner
+    const bool Unpreconditioned = thrust::detail::is_same<Preconditioner, cusp::identity_operator<ValueType,MemorySpace> >::value;
+
+    const unsigned int BLOCK_SIZE = 256;
+    const unsigned int MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(bicgstab_update_xr_kernel<IndexType, ValueType, BLOCK_SIZE>, BLOCK_SIZE, (size_t) 0);
+
+    const IndexType    N          = A.num_rows;
+    const unsigned int NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, std::max<size_t>(1, DIVIDE_INTO(N, BLOCK_SIZE)));
+
+    if (N == 0)
+    {
+        // empty system
+        monitor.finished(b);
+        return;
+    }
+
+    cudaStream_t stream = cusp::detail::current_stream();
+
+    // allocate workspace
+    cusp::array1d<ValueType,MemorySpace> r(N);
+    cusp::array1d<ValueType,MemorySpace> r_star(N);
+    cusp::array1d<ValueType,MemorySpace> p(N);
+    cusp::array1d<ValueType,MemorySpace> Mp(Unpreconditioned ? 0 : N);
+    cusp::array1d<ValueType,MemorySpace> AMp(N);
+    cusp::array1d<ValueType,MemorySpace> s(N);
+    cusp::array1d<ValueType,MemorySpace> Ms(Unpreconditioned ? 0 : N);
+    cusp::array1d<ValueType,MemorySpace> t(N);
+    cusp::array1d<ValueType,MemorySpace> partials(2 * NUM_BLOCKS);
+    cusp::array1d<ValueType,MemorySpace> scalars(BICGSTAB_NUM_SCALARS, ValueType(0));
+
+    // r <- b - A*x
+    cusp::multiply(A, x, t);
+    cusp::blas::axpby(b, t, r, ValueType(1), ValueType(-1));
+
+    // p <- r, r_star <- r
+    cusp::blas::copy(r, p);
+    cusp::blas::copy(r, r_star);
+
+    ValueType * r_ptr        = thrust::raw_pointer_cast(&r[0]);
+    ValueType * partials_ptr = thrust::raw_pointer_cast(&partials[0]);
+    ValueType * scalars_ptr  = thrust::raw_pointer_cast(&scalars[0]);
+
+    // rho <- <r*,r>
+    cg_dotc_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>(N, r_ptr, r_ptr, partials_ptr);
+    bicgstab_beta_kernel<ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE, 0, stream>>>(NUM_BLOCKS, partials_ptr, scalars_ptr, true);
+
+    // the residual is only examined every check_interval iterations
+    while (!monitor.finished(r))
+    {
+        for (size_t i = 0; i < check_interval && monitor.iteration_count() < monitor.iteration_limit(); i++)
+        {
+            fused_bicgstab_iteration<IndexType, ValueType, BLOCK_SIZE>(A, M, Unpreconditioned, NUM_BLOCKS,
+                                                                       x, r, r_star, p, Mp, AMp, s, Ms, t, partials, scalars);
+
+            ++monitor;
+        }
+    }
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
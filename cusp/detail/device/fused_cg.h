@@ -0,0 +1,396 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/linear_operator.h>
+#include <cusp/multiply.h>
+
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/graph.h>
+#include <cusp/detail/device/utils.h>
+
+#include <thrust/detail/type_traits.h>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// Conjugate Gradient iteration with device-resident scalars
+//////////////////////////////////////////////////////////////////////////////
+//
+// The scalars of the iteration (rz, alpha, beta) never leave the device.
+// Each inner product is computed by a grid-stride kernel that writes one
+// partial sum per block, followed by a single-block kernel that sums the
+// partials and derives the next scalar from the result.  The vector
+// updates read the scalars directly from device memory, so no iteration
+// requires a transfer to the host.
+//
+// Without a preconditioner (z = r) the update of x and r is fused with
+// the computation of <r,r>, such that an iteration consists of
+//
+//    y     <- A p                        (SpMV)
+//    pAp   <- <p,y>, alpha <- rz / pAp    (two launches)
+//    x     <- x + alpha p,
+//    r     <- r - alpha y, partial <r,r>  (one launch)
+//    rz    <- <r,r>, beta <- rz / rz_old  (one launch)
+//    p     <- r + beta p                  (one launch)
+//
+// With a preconditioner, z <- M r and <r,z> are computed separately.
+//
+// Since no iteration depends on the host, a block of check_interval
+// iterations may be captured into a CUDA graph and replayed for every
+// later block (capture_iterations).
+//
+
+// layout of the scalar array
+enum { CG_RZ = 0, CG_ALPHA = 1, CG_BETA = 2, CG_NUM_SCALARS = 3 };
+
+template <typename ValueType, unsigned int BLOCK_SIZE>
+__device__ ValueType cg_block_reduce(ValueType * sdata, ValueType sum)
+{
+    sdata[threadIdx.x] = sum;
+    __syncthreads();
+
+    for (unsigned int offset = BLOCK_SIZE / 2; offset > 0; offset >>= 1)
+    {
+        if (threadIdx.x < offset)
+            sdata[threadIdx.x] = sdata[threadIdx.x] + sdata[threadIdx.x + offset];
+        __syncthreads();
+    }
+
+    return sdata[0];
+}
+
+// partials[blockIdx.x] <- partial sum of conj(x[i]) * y[i]
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+cg_dotc_kernel(const IndexType N,
+               const ValueType * x,
+               const ValueType * y,
+                     ValueType * partials)
+{
+    __shared__ ValueType sdata[BLOCK_SIZE];
+
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+
+    ValueType sum = 0;
+
+    for (IndexType i = BLOCK_SIZE * blockIdx.x + threadIdx.x; i < N; i += grid_size)
+        sum = sum + cusp::blas::detail::conjugate<ValueType>()(x[i]) * y[i];
+
+    sum = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata, sum);
+
+    if (threadIdx.x == 0)
+        partials[blockIdx.x] = sum;
+}
+
+// x <- x + alpha * p, r <- r - alpha * y, and optionally
+// partials[blockIdx.x] <- partial sum of conj(r[i]) * r[i]
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE, bool ComputeRR>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+cg_update_xr_kernel(const IndexType N,
+                    const ValueType * scalars,
+                    const ValueType * p,
+                    const ValueType * y,
+                          ValueType * x,
+                          ValueType * r,
+                          ValueType * partials)
+{
+    __shared__ ValueType sdata[BLOCK_SIZE];
+
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+    const ValueType alpha     = scalars[CG_ALPHA];
+
+    ValueType sum = 0;
+
+    for (IndexType i = BLOCK_SIZE * blockIdx.x + threadIdx.x; i < N; i += grid_size)
+    {
+        const ValueType ri = r[i] - alpha * y[i];
+
+        x[i] = x[i] + alpha * p[i];
+        r[i] = ri;
+
+        if (ComputeRR)
+            sum = sum + cusp::blas::detail::conjugate<ValueType>()(ri) * ri;
+    }
+
+    if (ComputeRR)
+    {
+        sum = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata, sum);
+
+        if (threadIdx.x == 0)
+            partials[blockIdx.x] = sum;
+    }
+}
+
+// p <- z + beta * p
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+cg_update_p_kernel(const IndexType N,
+                   const ValueType * scalars,
+                   const ValueType * z,
+                         ValueType * p)
+{
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+    const ValueType beta      = scalars[CG_BETA];
+
+    for (IndexType i = BLOCK_SIZE * blockIdx.x + threadIdx.x; i < N; i += grid_size)
+        p[i] = z[i] + beta * p[i];
+}
+
+// pAp <- sum(partials), alpha <- rz / pAp
+template <typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+cg_alpha_kernel(const unsigned int num_partials,
+                const ValueType * partials,
+                      ValueType * scalars)
+{
+    __shared__ ValueType sdata[BLOCK_SIZE];
+
+    ValueType sum = 0;
+
+    for (unsigned int i = threadIdx.x; i < num_partials; i += BLOCK_SIZE)
+        sum = sum + partials[i];
+
+    sum = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata, sum);
+
+    // pAp vanishes only once the residual does
+    if (threadIdx.x == 0)
+        scalars[CG_ALPHA] = (sum == ValueType(0)) ? ValueType(0) : scalars[CG_RZ] / sum;
+}
+
+// rz_new <- sum(partials), beta <- rz_new / rz, rz <- rz_new
+template <typename ValueType, unsigned int BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+cg_beta_kernel(const unsigned int num_partials,
+               const ValueType * partials,
+                     ValueType * scalars)
+{
+    __shared__ ValueType sdata[BLOCK_SIZE];
+
+    ValueType sum = 0;
+
+    for (unsigned int i = threadIdx.x; i < num_partials; i += BLOCK_SIZE)
+        sum = sum + partials[i];
+
+    sum = cg_block_reduce<ValueType,BLOCK_SIZE>(sdata, sum);
+
+    if (threadIdx.x == 0)
+    {
+        const ValueType rz = scalars[CG_RZ];
+
+        scalars[CG_BETA] = (rz == ValueType(0)) ? ValueType(0) : sum / rz;
+        scalars[CG_RZ]   = sum;
+    }
+}
+
+// one iteration, issued on the current stream
+template <typename IndexType,
+          typename ValueType,
+          unsigned int BLOCK_SIZE,
+          class LinearOperator,
+          class Preconditioner,
+          class Vector,
+          class Array>
+void fused_cg_iteration(LinearOperator& A,
+                        Preconditioner& M,
+                        const bool Unpreconditioned,
+                        const unsigned int NUM_BLOCKS,
+                        Vector& x,
+                        Array& y,
+                        Array& z,
+                        Array& r,
+                        Array& p,
+                        Array& partials,
+                        Array& scalars)
+{
+    cudaStream_t stream = cusp::detail::current_stream();
+
+    const IndexType N = A.num_rows;
+
+    ValueType * y_ptr        = thrust::raw_pointer_cast(&y[0]);
+    ValueType * r_ptr        = thrust::raw_pointer_cast(&r[0]);
+    ValueType * p_ptr        = thrust::raw_pointer_cast(&p[0]);
+    ValueType * z_ptr        = Unpreconditioned ? r_ptr : thrust::raw_pointer_cast(&z[0]);
+    ValueType * x_ptr        = thrust::raw_pointer_cast(&x[0]);
+    ValueType * partials_ptr = thrust::raw_pointer_cast(&partials[0]);
+    ValueType * scalars_ptr  = thrust::raw_pointer_cast(&scalars[0]);
+
+    // y <- Ap
+    cusp::multiply(A, p, y);
+
+    // alpha <- <r,z>/<y,p>
+    cg_dotc_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>(N, y_ptr, p_ptr, partials_ptr);
+    cg_alpha_kernel<ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE, 0, stream>>>(NUM_BLOCKS, partials_ptr, scalars_ptr);
+
+    // x <- x + alpha * p, r <- r - alpha * y
+    if (Unpreconditioned)
+    {
+        cg_update_xr_kernel<IndexType, ValueType, BLOCK_SIZE, true> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>
+            (N, scalars_ptr, p_ptr, y_ptr, x_ptr, r_ptr, partials_ptr);
+    }
+    else
+    {
+        cg_update_xr_kernel<IndexType, ValueType, BLOCK_SIZE, false> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>
+            (N, scalars_ptr, p_ptr, y_ptr, x_ptr, r_ptr, partials_ptr);
+
+        // z <- M*r
+        cusp::multiply(M, r, z);
+
+        z_ptr = thrust::raw_pointer_cast(&z[0]);
+
+        cg_dotc_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>(N, r_ptr, z_ptr, partials_ptr);
+    }
+
+    // beta <- <r_{i+1},r_{i+1}>/<r,r>
+    cg_beta_kernel<ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE, 0, stream>>>(NUM_BLOCKS, partials_ptr, scalars_ptr);
+
+    // p <- r + beta*p
+    cg_update_p_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>(N, scalars_ptr, z_ptr, p_ptr);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void fused_cg(LinearOperator& A,
+              Vector& x,
+              Vector& b,
+              Monitor& monitor,
+              Preconditioner& M,
+              const size_t check_interval,
+              const bool capture_iterations)
+{
+    typedef typename LinearOperator::index_type   IndexType;
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    // z = r without a preconditioner, which permits fusing <r,r> with the update of r
+    const bool Unpreconditioned = thrust::detail::is_same<Preconditioner, cusp::identity_operator<ValueType,MemorySpace> >::value;
+
+    const unsigned int BLOCK_SIZE = 256;
+    const unsigned int MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(cg_update_xr_kernel<IndexType, ValueType, BLOCK_SIZE, true>, BLOCK_SIZE, (size_t) 0);
+
+    const IndexType    N          = A.num_rows;
+    const unsigned int NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, std::max<size_t>(1, DIVIDE_INTO(N, BLOCK_SIZE)));
+
+    if (N == 0)
+    {
+        // empty system
+        monitor.finished(b);
+        return;
+    }
+
+    cudaStream_t stream = cusp::detail::current_stream();
+
+    // allocate workspace
+    cusp::array1d<ValueType,MemorySpace> y(N);
+    cusp::array1d<ValueType,MemorySpace> z(Unpreconditioned ? 0 : N);
+    cusp::array1d<ValueType,MemorySpace> r(N);
+    cusp::array1d<ValueType,MemorySpace> p(N);
+    cusp::array1d<ValueType,MemorySpace> partials(NUM_BLOCKS);
+    cusp::array1d<ValueType,MemorySpace> scalars(CG_NUM_SCALARS, ValueType(0));
+
+    // y <- Ax
+    cusp::multiply(A, x, y);
+
+    // r <- b - A*x
+    cusp::blas::axpby(b, y, r, ValueType(1), ValueType(-1));
+
+    // z <- M*r
+    if (!Unpreconditioned)
+        cusp::multiply(M, r, z);
+
+    // p <- z
+    cusp::blas::copy(Unpreconditioned ? r : z, p);
+
+    ValueType * r_ptr        = thrust::raw_pointer_cast(&r[0]);
+    ValueType * z_ptr        = Unpreconditioned ? r_ptr : thrust::raw_pointer_cast(&z[0]);
+    ValueType * partials_ptr = thrust::raw_pointer_cast(&partials[0]);
+    ValueType * scalars_ptr  = thrust::raw_pointer_cast(&scalars[0]);
+
+    // rz = <r^H, z>
+    cg_dotc_kernel<IndexType, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>(N, r_ptr, z_ptr, partials_ptr);
+    cg_beta_kernel<ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE, 0, stream>>>(NUM_BLOCKS, partials_ptr, scalars_ptr);
+
+    // graph of a block of check_interval iterations (capture_iterations),
+    // captured from the second block on, once the operators have cached
+    // what they compute on first use
+    cusp::detail::device::captured_graph iterations;
+    bool first_block = true;
+
+    // the residual is only examined every check_interval iterations
+    while (!monitor.finished(r))
+    {
+        const bool full_block = monitor.iteration_count() + check_interval <= monitor.iteration_limit();
+
+        if (capture_iterations && full_block && !first_block &&
+            !iterations.ready() && !iterations.failed() && !cusp::detail::device::is_capturing())
+        {
+            iterations.begin_capture();
+
+            try
+            {
+                for (size_t i = 0; i < check_interval; i++)
+                    fused_cg_iteration<IndexType, ValueType, BLOCK_SIZE>(A, M, Unpreconditioned, NUM_BLOCKS, x, y, z, r, p, partials, scalars);
+            }
+            catch (...)
+            {
+                iterations.end_capture();
+                throw;
+            }
+
+            // on failure the blocks run directly from now on
+            iterations.end_capture();
+        }
+
+        if (full_block && iterations.ready())
+        {
+            iterations.launch();
+
+            for (size_t i = 0; i < check_interval; i++)
+                ++monitor;
+        }
+        else
+        {
+            for (size_t i = 0; i < check_interval && monitor.iteration_count() < monitor.iteration_limit(); i++)
+            {
+                fused_cg_iteration<IndexType, ValueType, BLOCK_SIZE>(A, M, Unpreconditioned, NUM_BLOCKS, x, y, z, r, p, partials, scalars);
+
+                ++monitor;
+            }
+        }
+
+        first_block = false;
+    }
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
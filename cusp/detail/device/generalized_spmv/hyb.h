@@ -19,8 +19,15 @@
 
 #include <cusp/hyb_matrix.h>
 
-#include <cusp/detail/device/spmv/ell.h>
-#include <cusp/detail/device/spmv/coo.h>
+#include <cusp/detail/device/generalized_spmv/coo_flat.h>
+#include <cusp/detail/device/generalized_spmv/ell.h>
+
+// Generalized HYB SpMV, which computes
+//
+//    z[i] = reduce(y[i], reduce_j combine(A(i,j), x[j]))
+//
+// from the ELL part with the shared kernel and then reduces the COO part
+// into z in place.  z may alias y.
 
 namespace cusp
 {
@@ -28,43 +35,60 @@ namespace detail
 {
 namespace device
 {
-
-// SpMV kernels for the hybrid ELL/COO matrix format.
-template <typename IndexType, typename ValueType>
-void spmv_hyb(const cusp::hyb_matrix<IndexType, ValueType, cusp::device_memory>& hyb, 
-              const ValueType * x, 
-                    ValueType * y)
+namespace cuda
 {
-    cusp::detail::device::spmv(hyb.ell, x, y);
-    cusp::detail::device::spmv(hyb.coo, x, y);
-}
 
-template <typename IndexType, typename ValueType>
-void spmv_hyb_tex(const cusp::hyb_matrix<IndexType, ValueType, cusp::device_memory>& hyb, 
-                  const ValueType * x, 
-                        ValueType * y)
+template <typename Matrix,
+          typename ValueType,
+          typename BinaryFunction1,
+          typename BinaryFunction2>
+void spmv_hyb(const Matrix&    A,
+              const ValueType* x,
+              const ValueType* y,
+                    ValueType* z,
+              BinaryFunction1  combine,
+              BinaryFunction2  reduce,
+              const ValueType  identity)
 {
-    cusp::detail::device::spmv_tex(hyb.ell, x, y);
-    cusp::detail::device::spmv_tex(hyb.coo, x, y);
-}
+    typedef typename Matrix::index_type IndexType;
 
-    
-template <typename IndexType, typename ValueType>
-void spmv(const cusp::hyb_matrix<IndexType, ValueType, cusp::device_memory>& hyb, 
-          const ValueType * x, 
-                ValueType * y)
-{
-    spmv_hyb(hyb, x, y);
+    cusp::detail::device::cuda::spmv_ell(A.ell, x, y, z, combine, reduce, identity);
+
+    cusp::detail::device::cuda::spmv_coo
+        (IndexType(A.num_rows), IndexType(A.coo.num_entries),
+         A.coo.row_indices.begin(), A.coo.column_indices.begin(), A.coo.values.begin(),
+         thrust::device_pointer_cast(x),
+         thrust::device_pointer_cast(z),
+         thrust::device_pointer_cast(z),
+         combine, reduce);
 }
 
-template <typename IndexType, typename ValueType>
-void spmv_tex(const cusp::hyb_matrix<IndexType, ValueType, cusp::device_memory>& hyb, 
-              const ValueType * x, 
-                    ValueType * y)
+template <typename Matrix,
+          typename ValueType,
+          typename BinaryFunction1,
+          typename BinaryFunction2>
+void spmv_hyb_tex(const Matrix&    A,
+                  const ValueType* x,
+                  const ValueType* y,
+                        ValueType* z,
+                  BinaryFunction1  combine,
+                  BinaryFunction2  reduce,
+                  const ValueType  identity)
 {
-    spmv_hyb_tex(hyb, x, y);
+    typedef typename Matrix::index_type IndexType;
+
+    cusp::detail::device::cuda::spmv_ell_tex(A.ell, x, y, z, combine, reduce, identity);
+
+    cusp::detail::device::cuda::spmv_coo
+        (IndexType(A.num_rows), IndexType(A.coo.num_entries),
+         A.coo.row_indices.begin(), A.coo.column_indices.begin(), A.coo.values.begin(),
+         thrust::device_pointer_cast(x),
+         thrust::device_pointer_cast(z),
+         thrust::device_pointer_cast(z),
+         combine, reduce);
 }
 
+} // end namespace cuda
 } // end namespace device
 } // end namespace detail
 } // end namespace cusp
@@ -0,0 +1,279 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/array1d.h>
+
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+
+#include <thrust/device_ptr.h>
+
+#include <cuda_runtime_api.h>
+
+#include <vector>
+
+#if CUDART_VERSION >= 10000
+#define CUSP_HAS_CUDA_GRAPHS
+#endif
+
+// Capture of device work into CUDA graphs.
+//
+// A captured_graph records the work that the calling host thread issues
+// between begin_capture and end_capture on the current stream, and
+// replays it with a single launch.  A graph refers to the addresses of
+// its arrays, so these must neither move nor be freed while the graph
+// is in use.  The temporaries of the SpMV kernels are therefore taken
+// from an arena of the graph while it is being captured (see
+// launch_buffer), which keeps them until the graph is reset.  Work that
+// cannot be captured, e.g. a Thrust algorithm issued on the legacy
+// default stream or a transfer to the host, makes end_capture fail.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+// device memory that lives as long as the graph that refers to it
+class graph_arena
+{
+    public:
+    graph_arena(void) {}
+
+    ~graph_arena(void)
+    {
+        release();
+    }
+
+    void * allocate(const size_t bytes)
+    {
+        void * ptr = 0;
+
+        if (bytes == 0)
+            return ptr;
+
+        cusp::detail::check_cuda(cudaMalloc(&ptr, bytes), "cudaMalloc failed");
+        blocks.push_back(ptr);
+
+        return ptr;
+    }
+
+    void release(void)
+    {
+        for (size_t i = 0; i < blocks.size(); i++)
+            cudaFree(blocks[i]);
+
+        blocks.clear();
+    }
+
+    private:
+    std::vector<void *> blocks;
+
+    // not copyable
+    graph_arena(const graph_arena&);
+    graph_arena& operator=(const graph_arena&);
+};
+
+// the arena of the graph that the calling host thread captures, if any
+inline graph_arena *& current_graph_arena_reference(void)
+{
+    static CUSP_THREAD_LOCAL graph_arena * arena = 0;
+    return arena;
+}
+
+inline bool is_capturing(void)
+{
+    return current_graph_arena_reference() != 0;
+}
+
+// Temporary device array of a kernel launch, e.g. the carries of the COO
+// and merge-path SpMV.  Taken from the arena of the graph under capture,
+// an ordinary array otherwise.
+template <typename T>
+class launch_buffer
+{
+    public:
+    typedef cusp::array1d_view< thrust::device_ptr<T> > view_type;
+
+    explicit launch_buffer(const size_t n)
+        : ptr(0), n(n)
+    {
+        if (graph_arena * arena = current_graph_arena_reference())
+        {
+            ptr = static_cast<T *>(arena->allocate(n * sizeof(T)));
+        }
+        else if (n > 0)
+        {
+            storage.resize(n);
+            ptr = thrust::raw_pointer_cast(&storage[0]);
+        }
+    }
+
+    T * get(void) const { return ptr; }
+
+    view_type view(void) const
+    {
+        return view_type(thrust::device_pointer_cast(ptr), thrust::device_pointer_cast(ptr + n));
+    }
+
+    private:
+    cusp::array1d<T,cusp::device_memory> storage;
+    T * ptr;
+    size_t n;
+
+    // not copyable
+    launch_buffer(const launch_buffer&);
+    launch_buffer& operator=(const launch_buffer&);
+};
+
+#if defined(CUSP_HAS_CUDA_GRAPHS)
+
+class captured_graph
+{
+    public:
+    captured_graph(void)
+        : graph(0), exec(0), stream(0), previous_stream(0), previous_arena(0), capture_failed(false) {}
+
+    // a copy captures a graph of its own
+    captured_graph(const captured_graph&)
+        : graph(0), exec(0), stream(0), previous_stream(0), previous_arena(0), capture_failed(false) {}
+
+    captured_graph& operator=(const captured_graph&)
+    {
+        reset();
+        return *this;
+    }
+
+    ~captured_graph(void)
+    {
+        reset();
+
+        if (stream)
+            cudaStreamDestroy(stream);
+    }
+
+    static bool supported(void) { return true; }
+
+    bool ready(void) const { return exec != 0; }
+
+    // the last capture failed, reset() permits another attempt
+    bool failed(void) const { return capture_failed; }
+
+    // issue the device work of the calling thread into the graph
+    void begin_capture(void)
+    {
+        reset();
+
+        // a blocking stream, so that work which escapes to the legacy
+        // default stream invalidates the capture instead of running early
+        if (!stream)
+            cusp::detail::check_cuda(cudaStreamCreate(&stream), "cudaStreamCreate failed");
+
+        // relaxed, such that the arena may allocate during the capture
+        cusp::detail::check_cuda(cudaStreamBeginCapture(stream, cudaStreamCaptureModeRelaxed), "cudaStreamBeginCapture failed");
+
+        previous_stream = cusp::detail::current_stream();
+        previous_arena  = current_graph_arena_reference();
+
+        cusp::detail::set_current_stream(stream);
+        current_graph_arena_reference() = &arena;
+    }
+
+    // Returns false if the work could not be captured, which leaves the
+    // graph empty.  None of the captured work has been performed.
+    bool end_capture(void)
+    {
+        cusp::detail::set_current_stream(previous_stream);
+        current_graph_arena_reference() = previous_arena;
+
+        cudaError_t status = cudaStreamEndCapture(stream, &graph);
+
+        if (status == cudaSuccess)
+#if CUDART_VERSION >= 12000
+            status = cudaGraphInstantiate(&exec, graph, 0);
+#else
+            status = cudaGraphInstantiate(&exec, graph, 0, 0, 0);
+#endif
+
+        if (status != cudaSuccess)
+        {
+            cudaGetLastError(); // clear the error
+            reset();
+            capture_failed = true;
+        }
+
+        return status == cudaSuccess;
+    }
+
+    // perform the captured work on the current stream
+    void launch(void) const
+    {
+        cusp::detail::check_cuda(cudaGraphLaunch(exec, cusp::detail::current_stream()), "cudaGraphLaunch failed");
+    }
+
+    void reset(void)
+    {
+        // launches in flight complete before the executable is released,
+        // cudaFree waits for them before the arena is released
+        if (exec)
+            cudaGraphExecDestroy(exec);
+
+        if (graph)
+            cudaGraphDestroy(graph);
+
+        exec  = 0;
+        graph = 0;
+        capture_failed = false;
+
+        arena.release();
+    }
+
+    private:
+    cudaGraph_t     graph;
+    cudaGraphExec_t exec;
+    cudaStream_t    stream;
+    cudaStream_t    previous_stream;
+    graph_arena *   previous_arena;
+    bool            capture_failed;
+    graph_arena     arena;
+};
+
+#else
+
+// CUDA 9 and older cannot capture graphs, the work is always issued directly
+class captured_graph
+{
+    public:
+    static bool supported(void) { return false; }
+
+    bool ready(void) const { return false; }
+    bool failed(void) const { return true; }
+
+    void begin_capture(void) {}
+    bool end_capture(void) { return false; }
+    void launch(void) const {}
+    void reset(void) {}
+};
+
+#endif // CUSP_HAS_CUDA_GRAPHS
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
@@ -0,0 +1,246 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/utils.h>
+
+#include <algorithm>
+
+// Updates of the shifted solutions of cg_m and bicgstab_m.
+//
+// The vectors of all shifts are stored one after another, element i of
+// shift s at s * N + i, and each update combines them with vectors of
+// length N that all shifts share.  A block updates BLOCK_SIZE rows of up
+// to SHIFT_TILE shifts: it loads the coefficients of its shifts to shared
+// memory once, and each thread reads the shared vectors at its row once
+// and then updates that row for every shift of the tile.  Consecutive
+// threads hence access consecutive elements of every shift, and neither
+// the index arithmetic nor the loads of the coefficients are repeated per
+// element.  The second grid dimension runs over the tiles of the list of
+// updated shifts, which excludes the shifts that have converged, or over
+// all shifts when the list is null.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+const unsigned int KRYLOV_M_BLOCK_SIZE = 256;
+const unsigned int KRYLOV_M_SHIFT_TILE = 32;
+
+// index of shift k of the tile of this block
+template <unsigned int SHIFT_TILE, typename IndexType>
+__device__ IndexType krylov_m_shift(const IndexType * active, const IndexType k)
+{
+    const IndexType s = blockIdx.y * SHIFT_TILE + k;
+    return active == 0 ? s : active[s];
+}
+
+// x^s <- x^s - beta^s p^s, p^s <- z^s r + alpha^s p^s
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE, unsigned int SHIFT_TILE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+cg_m_xp_kernel(const IndexType N,
+               const IndexType num_shifts,
+               const IndexType * active,
+               const ValueType * alpha_s,
+               const ValueType * beta_s,
+               const ValueType * z_s,
+               const ValueType * r,
+                     ValueType * x,
+                     ValueType * p)
+{
+    __shared__ size_t    s_offset[SHIFT_TILE];
+    __shared__ ValueType s_alpha[SHIFT_TILE];
+    __shared__ ValueType s_beta[SHIFT_TILE];
+    __shared__ ValueType s_z[SHIFT_TILE];
+
+    const IndexType tile_begin = blockIdx.y * SHIFT_TILE;
+    const IndexType tile_size  = num_shifts - tile_begin < SHIFT_TILE ? num_shifts - tile_begin : SHIFT_TILE;
+
+    if (threadIdx.x < tile_size)
+    {
+        const IndexType s = krylov_m_shift<SHIFT_TILE>(active, IndexType(threadIdx.x));
+
+        s_offset[threadIdx.x] = size_t(s) * N;
+        s_alpha[threadIdx.x]  = alpha_s[s];
+        s_beta[threadIdx.x]   = beta_s[s];
+        s_z[threadIdx.x]      = z_s[s];
+    }
+
+    __syncthreads();
+
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+
+    for (IndexType i = BLOCK_SIZE * blockIdx.x + threadIdx.x; i < N; i += grid_size)
+    {
+        const ValueType ri = r[i];
+
+        for (IndexType k = 0; k < tile_size; k++)
+        {
+            const size_t    j  = s_offset[k] + i;
+            const ValueType pj = p[j];
+
+            x[j] = x[j] - s_beta[k] * pj;
+            p[j] = s_z[k] * ri + s_alpha[k] * pj;
+        }
+    }
+}
+
+// x^s <- x^s - beta_0^s s^s + chi_0^s rho_0^s zeta_1^s w_1,
+// s^s <- zeta_1^s rho_1^s r_1
+//        + alpha_1^s (s^s - chi_0^s rho_0^s / beta_0^s (zeta_1^s w_1 - zeta_0^s r_0))
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE, unsigned int SHIFT_TILE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+bicgstab_m_xs_kernel(const IndexType N,
+                     const IndexType num_shifts,
+                     const IndexType * active,
+                     const ValueType * beta_0_s,
+                     const ValueType * chi_0_s,
+                     const ValueType * rho_0_s,
+                     const ValueType * zeta_0_s,
+                     const ValueType * alpha_1_s,
+                     const ValueType * rho_1_s,
+                     const ValueType * zeta_1_s,
+                     const ValueType * r_0,
+                     const ValueType * r_1,
+                     const ValueType * w_1,
+                           ValueType * s_s,
+                           ValueType * x)
+{
+    __shared__ size_t    s_offset[SHIFT_TILE];
+    __shared__ ValueType s_beta_0[SHIFT_TILE];
+    __shared__ ValueType s_chi_rho[SHIFT_TILE];
+    __shared__ ValueType s_zeta_0[SHIFT_TILE];
+    __shared__ ValueType s_alpha_1[SHIFT_TILE];
+    __shared__ ValueType s_zeta_rho_1[SHIFT_TILE];
+    __shared__ ValueType s_zeta_1[SHIFT_TILE];
+
+    const IndexType tile_begin = blockIdx.y * SHIFT_TILE;
+    const IndexType tile_size  = num_shifts - tile_begin < SHIFT_TILE ? num_shifts - tile_begin : SHIFT_TILE;
+
+    if (threadIdx.x < tile_size)
+    {
+        const IndexType s = krylov_m_shift<SHIFT_TILE>(active, IndexType(threadIdx.x));
+
+        s_offset[threadIdx.x]     = size_t(s) * N;
+        s_beta_0[threadIdx.x]     = beta_0_s[s];
+        s_chi_rho[threadIdx.x]    = chi_0_s[s] * rho_0_s[s];
+        s_zeta_0[threadIdx.x]     = zeta_0_s[s];
+        s_alpha_1[threadIdx.x]    = alpha_1_s[s];
+        s_zeta_rho_1[threadIdx.x] = zeta_1_s[s] * rho_1_s[s];
+        s_zeta_1[threadIdx.x]     = zeta_1_s[s];
+    }
+
+    __syncthreads();
+
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+
+    for (IndexType i = BLOCK_SIZE * blockIdx.x + threadIdx.x; i < N; i += grid_size)
+    {
+        const ValueType r0 = r_0[i];
+        const ValueType r1 = r_1[i];
+        const ValueType w1 = w_1[i];
+
+        for (IndexType k = 0; k < tile_size; k++)
+        {
+            const size_t    j  = s_offset[k] + i;
+            const ValueType sj = s_s[j];
+            const ValueType zw = s_zeta_1[k] * w1;
+
+            x[j]   = x[j] - s_beta_0[k] * sj + s_chi_rho[k] * zw;
+            s_s[j] = s_zeta_rho_1[k] * r1
+                   + s_alpha_1[k] * (sj - s_chi_rho[k] / s_beta_0[k] * (zw - s_zeta_0[k] * r0));
+        }
+    }
+}
+
+// grid of a shift update of num_shifts shifts of N rows
+template <typename KernelFunction>
+dim3 krylov_m_grid(KernelFunction kernel, const size_t N, const size_t num_shifts)
+{
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(kernel, KRYLOV_M_BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_TILES  = DIVIDE_INTO(num_shifts, KRYLOV_M_SHIFT_TILE);
+
+    // enough blocks along the rows to fill the device with all tiles
+    const size_t NUM_BLOCKS = std::min<size_t>(DIVIDE_INTO(N, KRYLOV_M_BLOCK_SIZE),
+                                               std::max<size_t>(1, DIVIDE_INTO(MAX_BLOCKS, NUM_TILES)));
+
+    return dim3(NUM_BLOCKS, NUM_TILES);
+}
+
+template <typename IndexType, typename ValueType>
+void cg_m_xp(const IndexType N,
+             const IndexType num_shifts,
+             const IndexType * active,
+             const ValueType * alpha_s,
+             const ValueType * beta_s,
+             const ValueType * z_s,
+             const ValueType * r,
+                   ValueType * x,
+                   ValueType * p)
+{
+    if (N == 0 || num_shifts == 0)
+        return;
+
+    const unsigned int BLOCK_SIZE = KRYLOV_M_BLOCK_SIZE;
+    const unsigned int SHIFT_TILE = KRYLOV_M_SHIFT_TILE;
+
+    const dim3 grid = krylov_m_grid(cg_m_xp_kernel<IndexType, ValueType, BLOCK_SIZE, SHIFT_TILE>, N, num_shifts);
+
+    cg_m_xp_kernel<IndexType, ValueType, BLOCK_SIZE, SHIFT_TILE> <<<grid, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (N, num_shifts, active, alpha_s, beta_s, z_s, r, x, p);
+}
+
+template <typename IndexType, typename ValueType>
+void bicgstab_m_xs(const IndexType N,
+                   const IndexType num_shifts,
+                   const IndexType * active,
+                   const ValueType * beta_0_s,
+                   const ValueType * chi_0_s,
+                   const ValueType * rho_0_s,
+                   const ValueType * zeta_0_s,
+                   const ValueType * alpha_1_s,
+                   const ValueType * rho_1_s,
+                   const ValueType * zeta_1_s,
+                   const ValueType * r_0,
+                   const ValueType * r_1,
+                   const ValueType * w_1,
+                         ValueType * s_s,
+                         ValueType * x)
+{
+    if (N == 0 || num_shifts == 0)
+        return;
+
+    const unsigned int BLOCK_SIZE = KRYLOV_M_BLOCK_SIZE;
+    const unsigned int SHIFT_TILE = KRYLOV_M_SHIFT_TILE;
+
+    const dim3 grid = krylov_m_grid(bicgstab_m_xs_kernel<IndexType, ValueType, BLOCK_SIZE, SHIFT_TILE>, N, num_shifts);
+
+    bicgstab_m_xs_kernel<IndexType, ValueType, BLOCK_SIZE, SHIFT_TILE> <<<grid, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (N, num_shifts, active, beta_0_s, chi_0_s, rho_0_s, zeta_0_s, alpha_1_s, rho_1_s, zeta_1_s, r_0, r_1, w_1, s_s, x);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/utils.h>
+
+#include <thrust/extrema.h>
+
+#include <algorithm>
+
+// Tiled evaluation of the powers A^k x, k = 1, ..., s, of a banded matrix.
+//
+// Each block owns tiles of TILE_ROWS rows.  The block gathers the entries
+// of x within ghost = s * bandwidth rows of its tile into shared memory and
+// computes the products of step k for the rows within (s - k) * bandwidth
+// of the tile, alternating between two buffers, so the rows the later steps
+// depend on are evaluated by the block itself.  The row functor computes
+// (A v)[i] from the buffer, whose first entry is v[lo].
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+template <typename IndexType, typename ValueType, typename RowProduct>
+__global__ void
+matrix_powers_tile_kernel(const IndexType num_rows,
+                          const IndexType bandwidth,
+                          const IndexType num_powers,
+                          const IndexType tile_rows,
+                          RowProduct      row,
+                          const ValueType * x,
+                                ValueType * V,
+                          const IndexType pitch)
+{
+    extern __shared__ int4 matrix_powers_storage[];
+
+    ValueType * buffers = reinterpret_cast<ValueType *>(matrix_powers_storage);
+
+    const IndexType ghost       = num_powers * bandwidth;
+    const IndexType buffer_size = tile_rows + 2 * ghost;
+
+    for(IndexType r0 = tile_rows * blockIdx.x; r0 < num_rows; r0 += tile_rows * gridDim.x)
+    {
+        const IndexType r1 = thrust::min(r0 + tile_rows, num_rows);
+        const IndexType lo = r0 > ghost ? r0 - ghost : 0;
+        const IndexType hi = thrust::min(r1 + ghost, num_rows);
+
+        for(IndexType i = lo + threadIdx.x; i < hi; i += blockDim.x)
+            buffers[i - lo] = x[i];
+
+        __syncthreads();
+
+        for(IndexType k = 1; k <= num_powers; k++)
+        {
+            const ValueType * in  = buffers + ((k - 1) % 2) * buffer_size;
+                  ValueType * out = buffers + (k % 2) * buffer_size;
+
+            // rows on which the remaining steps depend
+            const IndexType reach = (num_powers - k) * bandwidth;
+            const IndexType a     = r0 > reach ? r0 - reach : 0;
+            const IndexType b     = thrust::min(r1 + reach, num_rows);
+
+            for(IndexType i = a + threadIdx.x; i < b; i += blockDim.x)
+            {
+                const ValueType sum = row(i, in, lo);
+
+                out[i - lo] = sum;
+
+                if (r0 <= i && i < r1)
+                    V[size_t(k) * pitch + i] = sum;
+            }
+
+            __syncthreads();
+        }
+    }
+}
+
+// V[k * pitch + i] <- (A^k x)[i] for k = 1, ..., num_powers
+template <typename RowProduct, typename IndexType, typename ValueType>
+void matrix_powers_tiles(RowProduct      row,
+                         const IndexType num_rows,
+                         const IndexType bandwidth,
+                         const IndexType num_powers,
+                         const IndexType tile_rows,
+                         const ValueType * x,
+                               ValueType * V,
+                         const IndexType pitch)
+{
+    const size_t BLOCK_SIZE   = tile_rows;
+    const size_t SHARED_BYTES = 2 * (tile_rows + 2 * num_powers * bandwidth) * sizeof(ValueType);
+    const size_t MAX_BLOCKS   = cusp::detail::device::arch::max_blocks(matrix_powers_tile_kernel<IndexType, ValueType, RowProduct>, BLOCK_SIZE, SHARED_BYTES);
+    const size_t NUM_BLOCKS   = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(num_rows, tile_rows));
+
+    matrix_powers_tile_kernel<IndexType, ValueType, RowProduct> <<<NUM_BLOCKS, BLOCK_SIZE, SHARED_BYTES, cusp::detail::current_stream()>>>
+        (num_rows, bandwidth, num_powers, tile_rows, row, x, V, pitch);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
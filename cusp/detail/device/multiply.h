@@ -18,16 +18,41 @@
 
 #include <cusp/format.h>
 #include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+
+#include <cusp/detail/implicit_copy.h>
+#include <cusp/detail/spmspv.h>
+#include <cusp/detail/device/contiguous.h>
+#include <cusp/detail/device/cusparse.h>
+#include <cusp/detail/device/graph.h>
+
+// GEMV and GEMM
+#include <cusp/detail/device/dense.h>
 
 // SpMV
 #include <cusp/detail/device/spmv/coo_flat.h>
 #include <cusp/detail/device/spmv/csr_vector.h>
+#include <cusp/detail/device/spmv/csr_merge.h>
+#include <cusp/detail/device/spmv/csr_blocked.h>
 #include <cusp/detail/device/spmv/dia.h>
 #include <cusp/detail/device/spmv/ell.h>
 #include <cusp/detail/device/spmv/hyb.h>
+#include <cusp/detail/device/spmv/batched_csr.h>
+#include <cusp/detail/device/spmv/bsr.h>
+#include <cusp/detail/device/spmv/sell.h>
+#include <cusp/detail/device/spmv/jds.h>
+#include <cusp/detail/device/spmv/csr16.h>
+#include <cusp/detail/device/spmv/split_complex.h>
+#include <cusp/detail/device/spmv/dia_coo.h>
+#include <cusp/detail/device/spmv/symmetric_csr.h>
+#include <cusp/detail/device/spmv/transpose.h>
+#include <cusp/detail/device/spmv/epilogue.h>
 
 // SpMM
 #include <cusp/detail/device/spmm/coo.h>
+#include <cusp/detail/device/spmm/csr_hash.h>
+#include <cusp/detail/device/spmm/csr_numeric.h>
+#include <cusp/detail/device/spmm/dense.h>
 
 namespace cusp
 {
@@ -39,18 +64,18 @@ namespace device
 //////////////////////////////////
 // Dense Matrix-Vector Multiply //
 //////////////////////////////////
-//// TODO implement this for both row and column-major ordering
-//template <typename Matrix,
-//          typename Vector1,
-//          typename Vector2>
-//void multiply(const Matrix&  A,
-//              const Vector1& B,
-//                    Vector2& C,
-//              cusp::array2d_format,
-//              cusp::array1d_format,
-//              cusp::array1d_format)
-//{
-//}
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::array2d_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+    cusp::detail::device::gemv(A, B, C);
+}
 
 ///////////////////////////////////
 // Sparse Matrix-Vector Multiply //
@@ -82,11 +107,31 @@ void multiply(const Matrix&  A,
               cusp::array1d_format,
               cusp::array1d_format)
 {
+    typedef typename Vector2::value_type ValueType;
+
+    // managed matrices that exceed the memory of the device
+    if (cusp::detail::device::spmv_csr_oversubscribed(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]), spmv_store<ValueType>()))
+        return;
+
+    // cuSPARSE, when it is the engine of this thread
+    if (cusp::detail::device::cusparse::csrmv(A, B, C))
+        return;
+
+// CUSP_USE_CSR_MERGE_SPMV selects the load-balanced (merge-path) kernel
+// which is insensitive to the distribution of nonzeros among the rows
+#if defined(CUSP_USE_CSR_MERGE_SPMV)
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_csr_merge_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_csr_merge(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+#else
 #ifdef CUSP_USE_TEXTURE_MEMORY    
     cusp::detail::device::spmv_csr_vector_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
 #else
     cusp::detail::device::spmv_csr_vector(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
 #endif    
+#endif
 }
 
 template <typename Matrix,
@@ -140,37 +185,677 @@ void multiply(const Matrix&  A,
 #endif    
 }
 
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::bsr_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_bsr_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_bsr(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::sell_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_sell_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_sell(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::jds_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_jds_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_jds(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::csr16_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_csr16_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_csr16(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::split_complex_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_split_complex_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_split_complex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::dia_coo_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_dia_coo_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_dia_coo(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::symmetric_csr_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_symmetric_csr_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_symmetric_csr(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::batched_csr_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+    cusp::detail::device::spmv_interleaved_batched_csr(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+}
+
+//////////////////////////////////////////////////
+// Matrix-Vector Multiply with an AXPBY Epilogue //
+//////////////////////////////////////////////////
+//
+// y <- alpha * A x + beta * z, where z may alias y
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta,
+                    cusp::known_format)
+{
+    // other formats store the product and apply the epilogue afterwards
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::detail::device::spmv_axpby<ValueType> epilogue(alpha, beta, thrust::raw_pointer_cast(&z[0]));
+
+    cusp::detail::device::launch_buffer<ValueType> buffer(A.num_rows);
+    typename cusp::detail::device::launch_buffer<ValueType>::view_type temp(buffer.view());
+
+    cusp::detail::device::multiply(A, x, temp,
+            typename Matrix::format(),
+            typename Vector1::format(),
+            typename Vector3::format());
+
+    cusp::detail::device::spmv_apply_epilogue(A.num_rows, buffer.get(), thrust::raw_pointer_cast(&y[0]), epilogue);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta,
+                    cusp::csr_format)
+{
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::detail::device::spmv_axpby<ValueType> epilogue(alpha, beta, thrust::raw_pointer_cast(&z[0]));
+
+    // managed matrices that exceed the memory of the device
+    if (cusp::detail::device::spmv_csr_oversubscribed(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue))
+        return;
+
+    if (cusp::detail::device::cusparse::csrmv(A, x, z, y, alpha, beta))
+        return;
+
+#if defined(CUSP_USE_CSR_MERGE_SPMV)
+    cusp::detail::device::multiply_axpby(A, x, z, y, alpha, beta, cusp::known_format());
+#else
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_csr_vector_tex(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::spmv_csr_vector(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+#endif
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta,
+                    cusp::dia_format)
+{
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::detail::device::spmv_axpby<ValueType> epilogue(alpha, beta, thrust::raw_pointer_cast(&z[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_dia_tex(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::spmv_dia(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta,
+                    cusp::ell_format)
+{
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::detail::device::spmv_axpby<ValueType> epilogue(alpha, beta, thrust::raw_pointer_cast(&z[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_ell_tex(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::spmv_ell(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta,
+                    cusp::jds_format)
+{
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::detail::device::spmv_axpby<ValueType> epilogue(alpha, beta, thrust::raw_pointer_cast(&z[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_jds_tex(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::spmv_jds(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta,
+                    cusp::hyb_format)
+{
+    // only the fused kernels apply the epilogue
+    if (!cusp::detail::device::is_fused_hyb(A))
+    {
+        cusp::detail::device::multiply_axpby(A, x, z, y, alpha, beta, cusp::known_format());
+        return;
+    }
+
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::detail::device::spmv_axpby<ValueType> epilogue(alpha, beta, thrust::raw_pointer_cast(&z[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::__spmv_hyb_fused<true>(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::__spmv_hyb_fused<false>(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+}
+
+///////////////////////////////////////////////
+// Matrix-Vector Multiply with a Jacobi Epilogue //
+///////////////////////////////////////////////////
+//
+// y <- x + omega * D^-1 (b - A x), where y may not alias x
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename Vector4,
+          typename ScalarType,
+          typename Format>
+void multiply_jacobi(const Matrix&  A,
+                     const Vector1& x,
+                     const Vector2& b,
+                     const Vector3& diagonal,
+                           Vector4& y,
+                     ScalarType     omega,
+                     Format)
+{
+    // other formats store the product and apply the epilogue afterwards
+    typedef typename Vector4::value_type ValueType;
+
+    cusp::detail::device::spmv_jacobi<ValueType> epilogue(omega, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&b[0]), thrust::raw_pointer_cast(&diagonal[0]));
+
+    cusp::detail::device::launch_buffer<ValueType> buffer(A.num_rows);
+    typename cusp::detail::device::launch_buffer<ValueType>::view_type temp(buffer.view());
+
+    cusp::multiply(A, x, temp);
+
+    cusp::detail::device::spmv_apply_epilogue(A.num_rows, buffer.get(), thrust::raw_pointer_cast(&y[0]), epilogue);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename Vector4,
+          typename ScalarType>
+void multiply_jacobi(const Matrix&  A,
+                     const Vector1& x,
+                     const Vector2& b,
+                     const Vector3& diagonal,
+                           Vector4& y,
+                     ScalarType     omega,
+                     cusp::csr_format)
+{
+#if defined(CUSP_USE_CSR_MERGE_SPMV)
+    cusp::detail::device::multiply_jacobi(A, x, b, diagonal, y, omega, cusp::known_format());
+#else
+    typedef typename Vector4::value_type ValueType;
+
+    cusp::detail::device::spmv_jacobi<ValueType> epilogue(omega, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&b[0]), thrust::raw_pointer_cast(&diagonal[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_csr_vector_tex(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::spmv_csr_vector(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+#endif
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename Vector4,
+          typename ScalarType>
+void multiply_jacobi(const Matrix&  A,
+                     const Vector1& x,
+                     const Vector2& b,
+                     const Vector3& diagonal,
+                           Vector4& y,
+                     ScalarType     omega,
+                     cusp::dia_format)
+{
+    typedef typename Vector4::value_type ValueType;
+
+    cusp::detail::device::spmv_jacobi<ValueType> epilogue(omega, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&b[0]), thrust::raw_pointer_cast(&diagonal[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_dia_tex(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::spmv_dia(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename Vector4,
+          typename ScalarType>
+void multiply_jacobi(const Matrix&  A,
+                     const Vector1& x,
+                     const Vector2& b,
+                     const Vector3& diagonal,
+                           Vector4& y,
+                     ScalarType     omega,
+                     cusp::ell_format)
+{
+    typedef typename Vector4::value_type ValueType;
+
+    cusp::detail::device::spmv_jacobi<ValueType> epilogue(omega, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&b[0]), thrust::raw_pointer_cast(&diagonal[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_ell_tex(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::spmv_ell(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename Vector4,
+          typename ScalarType>
+void multiply_jacobi(const Matrix&  A,
+                     const Vector1& x,
+                     const Vector2& b,
+                     const Vector3& diagonal,
+                           Vector4& y,
+                     ScalarType     omega,
+                     cusp::hyb_format)
+{
+    typedef typename Vector4::value_type ValueType;
+
+    ValueType * y_ptr = thrust::raw_pointer_cast(&y[0]);
+
+    if (cusp::detail::device::is_fused_hyb(A))
+    {
+        // one kernel computes the whole row sum
+        cusp::detail::device::spmv_jacobi<ValueType> epilogue(omega, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&b[0]), thrust::raw_pointer_cast(&diagonal[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+        cusp::detail::device::__spmv_hyb_fused<true>(A, thrust::raw_pointer_cast(&x[0]), y_ptr, epilogue);
+#else
+        cusp::detail::device::__spmv_hyb_fused<false>(A, thrust::raw_pointer_cast(&x[0]), y_ptr, epilogue);
+#endif    
+        return;
+    }
+
+    // y <- A.coo * x, then the ELL kernel adds y to its row sums
+    cusp::detail::device::spmv_jacobi<ValueType> epilogue(omega, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&b[0]), thrust::raw_pointer_cast(&diagonal[0]), y_ptr);
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::__spmv_coo_flat<true, true>(A.coo, thrust::raw_pointer_cast(&x[0]), y_ptr);
+    cusp::detail::device::spmv_ell_tex(A.ell, thrust::raw_pointer_cast(&x[0]), y_ptr, epilogue);
+#else
+    cusp::detail::device::__spmv_coo_flat<false, true>(A.coo, thrust::raw_pointer_cast(&x[0]), y_ptr);
+    cusp::detail::device::spmv_ell(A.ell, thrust::raw_pointer_cast(&x[0]), y_ptr, epilogue);
+#endif    
+}
+
+/////////////////////////////////////////////////////////
+// Matrix-Vector Multiply with a Diagonal Scaling Epilogue //
+/////////////////////////////////////////////////////////////
+//
+// y <- D A x, where y may not alias x
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename Format>
+void multiply_scale(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& diagonal,
+                          Vector3& y,
+                    Format)
+{
+    // other formats store the product and scale it in place
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::detail::device::spmv_scale<ValueType> epilogue(thrust::raw_pointer_cast(&diagonal[0]));
+
+    cusp::multiply(A, x, y);
+
+    cusp::detail::device::spmv_apply_epilogue(A.num_rows, thrust::raw_pointer_cast(&y[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3>
+void multiply_scale(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& diagonal,
+                          Vector3& y,
+                    cusp::csr_format)
+{
+#if defined(CUSP_USE_CSR_MERGE_SPMV)
+    cusp::detail::device::multiply_scale(A, x, diagonal, y, cusp::known_format());
+#else
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::detail::device::spmv_scale<ValueType> epilogue(thrust::raw_pointer_cast(&diagonal[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_csr_vector_tex(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::spmv_csr_vector(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+#endif
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3>
+void multiply_scale(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& diagonal,
+                          Vector3& y,
+                    cusp::dia_format)
+{
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::detail::device::spmv_scale<ValueType> epilogue(thrust::raw_pointer_cast(&diagonal[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_dia_tex(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::spmv_dia(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3>
+void multiply_scale(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& diagonal,
+                          Vector3& y,
+                    cusp::ell_format)
+{
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::detail::device::spmv_scale<ValueType> epilogue(thrust::raw_pointer_cast(&diagonal[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_ell_tex(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#else
+    cusp::detail::device::spmv_ell(A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), epilogue);
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3>
+void multiply_scale(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& diagonal,
+                          Vector3& y,
+                    cusp::hyb_format)
+{
+    typedef typename Vector3::value_type ValueType;
+
+    ValueType * y_ptr = thrust::raw_pointer_cast(&y[0]);
+
+    if (cusp::detail::device::is_fused_hyb(A))
+    {
+        // one kernel computes the whole row sum
+        cusp::detail::device::spmv_scale<ValueType> epilogue(thrust::raw_pointer_cast(&diagonal[0]));
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+        cusp::detail::device::__spmv_hyb_fused<true>(A, thrust::raw_pointer_cast(&x[0]), y_ptr, epilogue);
+#else
+        cusp::detail::device::__spmv_hyb_fused<false>(A, thrust::raw_pointer_cast(&x[0]), y_ptr, epilogue);
+#endif    
+        return;
+    }
+
+    // y <- A.coo * x, then the ELL kernel adds y to its row sums
+    cusp::detail::device::spmv_scale<ValueType> epilogue(thrust::raw_pointer_cast(&diagonal[0]), y_ptr);
+
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::__spmv_coo_flat<true, true>(A.coo, thrust::raw_pointer_cast(&x[0]), y_ptr);
+    cusp::detail::device::spmv_ell_tex(A.ell, thrust::raw_pointer_cast(&x[0]), y_ptr, epilogue);
+#else
+    cusp::detail::device::__spmv_coo_flat<false, true>(A.coo, thrust::raw_pointer_cast(&x[0]), y_ptr);
+    cusp::detail::device::spmv_ell(A.ell, thrust::raw_pointer_cast(&x[0]), y_ptr, epilogue);
+#endif    
+}
+
 ////////////////////////////////////////
 // Sparse Matrix-BlockVector Multiply //
 ////////////////////////////////////////
-//// TODO implement this w/ repeated SpMVs and then specialize
-//template <typename Matrix,
-//          typename Vector1,
-//          typename Vector2>
-//void multiply(const Matrix&  A,
-//              const Vector1& B,
-//                    Vector2& C,
-//              cusp::sparse_format,
-//              cusp::array2d_format,
-//              cusp::array2d_format)
-//{
-//}
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void multiply(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::csr_format,
+              cusp::array2d_format,
+              cusp::array2d_format)
+{
+    if (cusp::detail::device::cusparse::csrmm(A, B, C))
+        return;
+
+    cusp::detail::device::spmm_csr_dense(A, B, C);
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void multiply(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::ell_format,
+              cusp::array2d_format,
+              cusp::array2d_format)
+{
+    cusp::detail::device::spmm_ell_dense(A, B, C);
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void multiply(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::hyb_format,
+              cusp::array2d_format,
+              cusp::array2d_format)
+{
+    cusp::detail::device::spmm_hyb_dense(A, B, C);
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void multiply(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::sparse_format,
+              cusp::array2d_format,
+              cusp::array2d_format)
+{
+    // other formats use CSR
+    const cusp::detail::csr_operand<Matrix1,cusp::device_memory> A_(A);
+
+    cusp::detail::device::multiply(A_.get(), B, C,
+                                   cusp::csr_format(),
+                                   cusp::array2d_format(),
+                                   cusp::array2d_format());
+}
 
 ////////////////////////////////////////
 // Dense Matrix-Matrix Multiplication //
 ////////////////////////////////////////
-// TODO implement
-//template <typename Matrix1,
-//          typename Matrix2,
-//          typename Matrix3>
-//void multiply(const Matrix1& A,
-//              const Matrix2& B,
-//                    Matrix3& C,
-//              cusp::array2d_format,
-//              cusp::array2d_format,
-//              cusp::array2d_format)
-//{
-//}
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void multiply(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::array2d_format,
+              cusp::array2d_format,
+              cusp::array2d_format)
+{
+    cusp::detail::device::gemm(A, B, C);
+}
 
 /////////////////////////////////////////
 // Sparse Matrix-Matrix Multiplication //
@@ -185,7 +870,80 @@ void multiply(const Matrix1& A,
               cusp::coo_format,
               cusp::coo_format)
 {
-    cusp::detail::device::spmm_coo(A,B,C);
+    if (cusp::detail::device::spmm_hash_supported())
+    {
+        typedef typename Matrix3::index_type IndexType;
+
+        cusp::array1d<IndexType,cusp::device_memory> A_row_offsets(A.num_rows + 1);
+        cusp::array1d<IndexType,cusp::device_memory> B_row_offsets(B.num_rows + 1);
+        cusp::array1d<IndexType,cusp::device_memory> C_row_offsets;
+
+        cusp::detail::indices_to_offsets(A.row_indices, A_row_offsets);
+        cusp::detail::indices_to_offsets(B.row_indices, B_row_offsets);
+
+        cusp::detail::device::spmm_csr_hash(A_row_offsets, A, B_row_offsets, B, C, C_row_offsets);
+
+        cusp::detail::offsets_to_indices(C_row_offsets, C.row_indices);
+    }
+    else
+    {
+        cusp::detail::device::spmm_coo(A,B,C);
+    }
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void multiply(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::csr_format,
+              cusp::csr_format,
+              cusp::csr_format)
+{
+    if (cusp::detail::device::cusparse::spgemm(A, B, C))
+        return;
+
+    if (cusp::detail::device::spmm_hash_supported())
+    {
+        cusp::detail::device::spmm_csr_hash(A.row_offsets, A, B.row_offsets, B, C, C.row_offsets);
+    }
+    else
+    {
+        cusp::detail::device::spmm_csr_esc(A,B,C);
+    }
+}
+
+// CSR * CSR into a CSR matrix, or into another format through a CSR temporary
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void spmm_csr_output(const Matrix1& A,
+                     const Matrix2& B,
+                           Matrix3& C,
+                     cusp::csr_format)
+{
+    cusp::detail::device::multiply(A, B, C,
+                                   cusp::csr_format(),
+                                   cusp::csr_format(),
+                                   cusp::csr_format());
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void spmm_csr_output(const Matrix1& A,
+                     const Matrix2& B,
+                           Matrix3& C,
+                     cusp::sparse_format)
+{
+    cusp::detail::check_implicit_copy("conversion from CSR");
+
+    cusp::csr_matrix<typename Matrix3::index_type,typename Matrix3::value_type,cusp::device_memory> C_;
+
+    cusp::detail::device::spmm_csr_output(A, B, C_, cusp::csr_format());
+
+    cusp::convert(C_, C);
 }
 
 template <typename Matrix1,
@@ -198,19 +956,172 @@ void multiply(const Matrix1& A,
               cusp::sparse_format,
               cusp::sparse_format)
 {
-    // other formats use COO * COO
-    cusp::coo_matrix<typename Matrix1::index_type,typename Matrix1::value_type,cusp::device_memory> A_(A);
-    cusp::coo_matrix<typename Matrix2::index_type,typename Matrix2::value_type,cusp::device_memory> B_(B);
-    cusp::coo_matrix<typename Matrix3::index_type,typename Matrix3::value_type,cusp::device_memory> C_;
+    // other formats use CSR * CSR, CSR operands are used in place
+    const cusp::detail::csr_operand<Matrix1,cusp::device_memory> A_(A);
+    const cusp::detail::csr_operand<Matrix2,cusp::device_memory> B_(B);
 
-    cusp::detail::device::spmm_coo(A_,B_,C_);
+    cusp::detail::device::spmm_csr_output(A_.get(), B_.get(), C, typename Matrix3::format());
+}
 
-    cusp::convert(C_, C);
+//////////////////////////////////////////
+// Sparse Matrix-Sparse Vector Multiply //
+//////////////////////////////////////////
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::csr_format,
+              cusp::sparse_vector_format,
+              cusp::sparse_vector_format)
+{
+    cusp::detail::spmspv(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::sparse_format,
+              cusp::sparse_vector_format,
+              cusp::sparse_vector_format)
+{
+    // other formats use CSR
+    const cusp::detail::csr_operand<Matrix,cusp::device_memory> A_(A);
+
+    cusp::detail::spmspv(A_.get(), B, C);
+}
+
+/////////////////////////////////////////////
+// Transposed Sparse Matrix-Vector Multiply //
+/////////////////////////////////////////////
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::coo_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_coo_transpose_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_coo_transpose(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::csr_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_csr_transpose_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_csr_transpose(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::ell_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_ell_transpose_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_ell_transpose(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::hyb_format)
+{
+#ifdef CUSP_USE_TEXTURE_MEMORY    
+    cusp::detail::device::spmv_hyb_transpose_tex(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#else
+    cusp::detail::device::spmv_hyb_transpose(A, thrust::raw_pointer_cast(&B[0]), thrust::raw_pointer_cast(&C[0]));
+#endif    
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::sparse_format)
+{
+    // other formats use COO
+    cusp::detail::check_implicit_copy("conversion to COO");
+
+    cusp::coo_matrix<typename Matrix::index_type,typename Matrix::value_type,cusp::device_memory> A_(A);
+
+    cusp::detail::device::multiply_transpose(A_, B, C, cusp::coo_format());
+}
+
+// a sparse vector times the columns of A, dense vectors dispatch on the
+// matrix format
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::csr_format,
+                        cusp::sparse_vector_format)
+{
+    cusp::detail::spmspv_transpose(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::sparse_format,
+                        cusp::sparse_vector_format)
+{
+    // other formats use CSR
+    const cusp::detail::csr_operand<Matrix,cusp::device_memory> A_(A);
+
+    cusp::detail::spmspv_transpose(A_.get(), B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Format>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        Format,
+                        cusp::array1d_format)
+{
+    cusp::detail::device::multiply_transpose(A, B, C, Format());
 }
 
 /////////////////
 // Entry Point //
 /////////////////
+//
+// Strided vectors are staged through contiguous temporaries, since the
+// kernels take the address of the first element.
 template <typename Matrix,
           typename MatrixOrVector1,
           typename MatrixOrVector2>
@@ -218,10 +1129,55 @@ void multiply(const Matrix&  A,
               const MatrixOrVector1& B,
                     MatrixOrVector2& C)
 {
-    cusp::detail::device::multiply(A, B, C,
+    cusp::detail::device::contiguous_operand<const MatrixOrVector1> B_(B);
+    cusp::detail::device::contiguous_operand<MatrixOrVector2>       C_(C, true);
+
+    cusp::detail::device::multiply(A, B_.get(), C_.get(),
             typename Matrix::format(),
             typename MatrixOrVector1::format(),
             typename MatrixOrVector2::format());
+
+    C_.store(C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C)
+{
+    cusp::detail::device::contiguous_operand<const Vector1> B_(B);
+    cusp::detail::device::contiguous_operand<Vector2>       C_(C, true);
+
+    cusp::detail::device::multiply_transpose(A, B_.get(), C_.get(),
+            typename Matrix::format(),
+            typename Vector1::format());
+
+    C_.store(C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta)
+{
+    // z is loaded before y is written, hence it may alias a staged y
+    cusp::detail::device::contiguous_operand<const Vector1> x_(x);
+    cusp::detail::device::contiguous_operand<const Vector2> z_(z);
+    cusp::detail::device::contiguous_operand<Vector3>       y_(y, true);
+
+    cusp::detail::device::multiply_axpby(A, x_.get(), z_.get(), y_.get(), alpha, beta,
+            typename Matrix::format());
+
+    y_.store(y);
 }
 
 } // end namespace device
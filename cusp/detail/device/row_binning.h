@@ -0,0 +1,207 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/exception.h>
+
+#include <cusp/detail/config.h>
+
+#include <thrust/binary_search.h>
+#include <thrust/functional.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/counting_iterator.h>
+
+#include <vector>
+
+// Rows of a sparse matrix grouped into buckets by a size per row, such as
+// the row length or the work of a row in a sparse product.
+//
+// An irregular kernel launches once per bucket with the strategy that suits
+// the sizes in it (a thread, a warp or a block per row) instead of balancing
+// its own load.  Bucket b holds the rows whose size lies in the range
+// [bounds[b], bounds[b+1]), the last bucket is unbounded above, and rows
+// smaller than bounds[0] are in no bucket.  The rows of each bucket are in
+// increasing order.
+//
+// The rows are classified with a single sort of their bucket numbers.  A
+// matrix that is applied repeatedly keeps its binning: is_valid() reports
+// whether the binning still matches the shape of the matrix, and the holder
+// calls invalidate() when the row offsets are modified in place.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+// largest number of buckets of a binning
+const size_t ROW_BINNING_MAX_BUCKETS = 8;
+
+// buckets of the binning by row length, from get_row_binning()
+enum row_length_class
+{
+    empty_rows  = 0,    // no entries
+    thread_rows = 1,    // up to 8 entries, a thread per row
+    warp_rows   = 2,    // up to 256 entries, a warp per row
+    block_rows  = 3     // longer rows, a block per row
+};
+
+template <typename IndexType, typename MemorySpace = cusp::device_memory>
+struct row_binning
+{
+    typedef cusp::array1d<IndexType,MemorySpace>   rows_array_type;
+    typedef typename rows_array_type::const_view   bucket_view_type;
+
+    bool   valid;
+    size_t num_rows;
+    size_t num_entries;
+
+    // lower bounds of the buckets
+    std::vector<IndexType> bounds;
+
+    // rows of bucket b are rows[offsets[b], offsets[b+1])
+    rows_array_type     rows;
+    std::vector<size_t> offsets;
+
+    row_binning(void)
+        : valid(false), num_rows(0), num_entries(0) {}
+
+    template <typename Matrix>
+    bool is_valid(const Matrix& A) const
+    {
+        return valid && num_rows == A.num_rows && num_entries == A.num_entries;
+    }
+
+    void invalidate(void) { valid = false; }
+
+    size_t num_buckets(void) const { return bounds.size(); }
+
+    size_t bucket_size(const size_t b) const { return offsets[b + 1] - offsets[b]; }
+
+    bucket_view_type bucket(const size_t b) const
+    {
+        return bucket_view_type(rows.begin() + offsets[b], rows.begin() + offsets[b + 1]);
+    }
+};
+
+// bucket number of a row plus one, zero for a row below the first bound
+template <typename IndexType>
+struct row_bin_number : public thrust::unary_function<IndexType,IndexType>
+{
+    IndexType bounds[ROW_BINNING_MAX_BUCKETS];
+    IndexType num_buckets;
+
+    __host__ __device__
+    IndexType operator()(const IndexType size) const
+    {
+        IndexType number = 0;
+
+        for (IndexType b = 0; b < num_buckets; b++)
+            if (bounds[b] <= size)
+                number = b + 1;
+
+        return number;
+    }
+};
+
+// Bin the rows 0, 1, ..., sizes.size() - 1 by sizes[i] into the buckets
+// with the increasing lower bounds bounds[0, num_buckets)
+template <typename Array, typename IndexType, typename MemorySpace>
+void bin_rows(const Array& sizes,
+              const IndexType * bounds,
+              const size_t num_buckets,
+              row_binning<IndexType,MemorySpace>& binning)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (num_buckets == 0 || num_buckets > ROW_BINNING_MAX_BUCKETS)
+        throw cusp::invalid_input_exception("row binning requires between 1 and 8 buckets");
+
+    for (size_t b = 1; b < num_buckets; b++)
+        if (!(bounds[b - 1] < bounds[b]))
+            throw cusp::invalid_input_exception("row binning bounds must be increasing");
+
+    const size_t num_rows = sizes.size();
+
+    row_bin_number<IndexType> number;
+    number.num_buckets = IndexType(num_buckets);
+    for (size_t b = 0; b < num_buckets; b++)
+        number.bounds[b] = bounds[b];
+
+    binning.valid    = false;
+    binning.num_rows = num_rows;
+    binning.bounds.assign(bounds, bounds + num_buckets);
+    binning.rows.resize(num_rows);
+
+    // sort the rows by bucket, rows below the first bound come first
+    cusp::array1d<IndexType,MemorySpace> numbers(num_rows);
+    thrust::transform(sizes.begin(), sizes.end(), numbers.begin(), number);
+    thrust::sequence(binning.rows.begin(), binning.rows.end(), IndexType(0));
+    thrust::stable_sort_by_key(numbers.begin(), numbers.end(), binning.rows.begin());
+
+    // bucket b begins at the first row with number b + 1
+    cusp::array1d<IndexType,MemorySpace> offsets(num_buckets + 1);
+    thrust::lower_bound(numbers.begin(), numbers.end(),
+                        thrust::counting_iterator<IndexType>(1),
+                        thrust::counting_iterator<IndexType>(num_buckets + 2),
+                        offsets.begin());
+
+    cusp::array1d<IndexType,cusp::host_memory> h_offsets(offsets);
+    binning.offsets.assign(h_offsets.begin(), h_offsets.end());
+
+    binning.valid = true;
+}
+
+// Bin the rows of a CSR matrix by length into the row_length_class buckets
+template <typename Matrix, typename IndexType, typename MemorySpace>
+void bin_rows_by_length(const Matrix& A,
+                        row_binning<IndexType,MemorySpace>& binning)
+{
+    const IndexType bounds[4] = {0, 1, 9, 257};
+
+    cusp::array1d<IndexType,MemorySpace> lengths(A.num_rows);
+
+    if (A.num_rows > 0)
+        thrust::transform(A.row_offsets.begin() + 1, A.row_offsets.end(),
+                          A.row_offsets.begin(), lengths.begin(), thrust::minus<IndexType>());
+
+    bin_rows(lengths, bounds, 4, binning);
+
+    binning.num_entries = A.num_entries;
+}
+
+// return the binning by row length of a CSR matrix, computing it when it
+// does not match the matrix
+template <typename Matrix, typename IndexType, typename MemorySpace>
+const row_binning<IndexType,MemorySpace>& get_row_binning(const Matrix& A,
+                                                          row_binning<IndexType,MemorySpace>& binning)
+{
+    if (!binning.is_valid(A))
+        bin_rows_by_length(A, binning);
+
+    return binning;
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
@@ -15,9 +15,12 @@
  */
 
 #include <cusp/array1d.h>
+#include <cusp/coo_matrix.h>
 
 #include <cusp/detail/format_utils.h>
+#include <cusp/detail/spgemm_budget.h>
 
+#include <thrust/copy.h>
 #include <thrust/gather.h>
 #include <thrust/scan.h>
 #include <thrust/scatter.h>
@@ -39,6 +42,7 @@ namespace device
 template <typename Matrix1,
           typename Matrix2,
           typename Matrix3,
+          typename OffsetArray,
           typename Array1,
           typename Array2>
 void coo_spmm_helper(size_t workspace_size,
@@ -49,7 +53,7 @@ void coo_spmm_helper(size_t workspace_size,
                      const Matrix1& A,
                      const Matrix2& B,
                            Matrix3& C,
-                     const Array1& B_row_offsets,
+                     const OffsetArray& B_row_offsets,
                      const Array1& segment_lengths,
                      const Array1& output_ptr,
                            Array1& A_gather_locations,
@@ -134,15 +138,21 @@ void coo_spmm_helper(size_t workspace_size,
 }
 
 
+// Expand-sort-contract SpGEMM of a COO matrix A, of which only the row
+// indices, column indices and values are read, and a matrix B, of which
+// only the column indices and values are read.  The row offsets of both
+// are given, so that CSR operands need not be converted.
 template <typename Matrix1,
           typename Matrix2,
-          typename Matrix3>
-void spmm_coo(const Matrix1& A,
+          typename Matrix3,
+          typename Array1,
+          typename Array2>
+void spmm_esc(const Matrix1& A,
+              const Array1&  A_row_offsets,
               const Matrix2& B,
+              const Array2&  B_row_offsets,
                     Matrix3& C)
 {
-    CUSP_PROFILE_SCOPED();
-
     typedef typename Matrix3::index_type   IndexType;
     typedef typename Matrix3::value_type   ValueType;
     typedef typename Matrix3::memory_space MemorySpace;
@@ -154,10 +164,6 @@ void spmm_coo(const Matrix1& A,
         return;
     }
 
-    // compute row offsets for B
-    cusp::array1d<IndexType,MemorySpace> B_row_offsets(B.num_rows + 1);
-    cusp::detail::indices_to_offsets(B.row_indices, B_row_offsets);
-
     // compute row lengths for B
     cusp::array1d<IndexType,MemorySpace> B_row_lengths(B.num_rows);
     thrust::transform(B_row_offsets.begin() + 1, B_row_offsets.end(), B_row_offsets.begin(), B_row_lengths.begin(), thrust::minus<IndexType>());
@@ -177,10 +183,20 @@ void spmm_coo(const Matrix1& A,
 
     size_t coo_num_nonzeros = output_ptr[A.num_entries];
 
-    size_t workspace_capacity = thrust::min<size_t>(coo_num_nonzeros, 16 << 20);
-    
+    // each intermediate product takes two gather locations, (I,J,V) and
+    // about as much again for the temporaries of the sort
+    const size_t bytes_per_product = 2 * (4 * sizeof(IndexType) + sizeof(ValueType));
+
+    size_t workspace_capacity = 0;
+
+    if (cusp::detail::spgemm_budget_bytes() > 0)
+    {
+      workspace_capacity = thrust::min<size_t>(coo_num_nonzeros, cusp::detail::spgemm_budget_capacity(bytes_per_product, 0));
+    }
+    else
     {
-      // TODO abstract this
+      workspace_capacity = thrust::min<size_t>(coo_num_nonzeros, 16 << 20);
+
       size_t free, total;
       cudaMemGetInfo(&free, &total);
 
@@ -215,6 +231,8 @@ void spmm_coo(const Matrix1& A,
                         segment_lengths, output_ptr,
                         A_gather_locations, B_gather_locations,
                         I, J, V);
+
+        cusp::detail::spgemm_count_slabs(1);
     }
     else
     {
@@ -225,10 +243,6 @@ void spmm_coo(const Matrix1& A,
         // storage for C[slice,:] partial results
         ContainerList slices;
 
-        // compute row offsets for A
-        cusp::array1d<IndexType,MemorySpace> A_row_offsets(A.num_rows + 1);
-        cusp::detail::indices_to_offsets(A.row_indices, A_row_offsets);
-    
         // compute worspace requirements for each row
         cusp::array1d<IndexType,MemorySpace> cummulative_row_workspace(A.num_rows);
         thrust::gather(A_row_offsets.begin() + 1, A_row_offsets.end(),
@@ -246,21 +260,16 @@ void spmm_coo(const Matrix1& A,
             size_t end_row = thrust::upper_bound(cummulative_row_workspace.begin() + begin_row, cummulative_row_workspace.end(),
                                                  total_work + IndexType(workspace_capacity)) - cummulative_row_workspace.begin();
 
+            // a row whose products exceed the capacity forms a slab of its own
+            end_row = thrust::max<size_t>(end_row, begin_row + 1);
+
             size_t begin_segment = A_row_offsets[begin_row];
             size_t end_segment   = A_row_offsets[end_row];
-        
-            // TODO throw exception signaling that there is insufficient memory (not necessarily bad_alloc)
-            //if (begin_row == end_row)
-            //    // workspace wasn't large enough, throw cusp::memory_allocation_failure?
 
             size_t workspace_size = output_ptr[end_segment] - output_ptr[begin_segment];
             
             total_work += workspace_size;
 
-            // TODO remove these when an exception is in place
-            assert(end_row > begin_row);
-            assert(workspace_size <= workspace_capacity);
-
             coo_spmm_helper(workspace_size,
                             begin_row, end_row,
                             begin_segment, end_segment,
@@ -273,6 +282,8 @@ void spmm_coo(const Matrix1& A,
             slices.push_back(Container());
             slices.back().swap(C_slice);
 
+            cusp::detail::spgemm_count_slabs(1);
+
             begin_row = end_row;
         }
 
@@ -291,18 +302,72 @@ void spmm_coo(const Matrix1& A,
         // resize output
         C.resize(A.num_rows, B.num_cols, C_num_entries);
        
-        // copy slices into output
+        // copy slices into output, releasing each one once it is copied
         size_t base = 0;
-        for(typename ContainerList::iterator iter = slices.begin(); iter != slices.end(); ++iter)
+        while (!slices.empty())
         {
-            thrust::copy(iter->row_indices.begin(),    iter->row_indices.end(),    C.row_indices.begin()    + base);
-            thrust::copy(iter->column_indices.begin(), iter->column_indices.end(), C.column_indices.begin() + base);
-            thrust::copy(iter->values.begin(),         iter->values.end(),         C.values.begin()         + base);
-            base += iter->num_entries;
+            Container& slice = slices.front();
+            thrust::copy(slice.row_indices.begin(),    slice.row_indices.end(),    C.row_indices.begin()    + base);
+            thrust::copy(slice.column_indices.begin(), slice.column_indices.end(), C.column_indices.begin() + base);
+            thrust::copy(slice.values.begin(),         slice.values.end(),         C.values.begin()         + base);
+            base += slice.num_entries;
+            slices.pop_front();
         }
     }
 }
 
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void spmm_coo(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix3::index_type   IndexType;
+    typedef typename Matrix3::memory_space MemorySpace;
+
+    cusp::array1d<IndexType,MemorySpace> A_row_offsets(A.num_rows + 1);
+    cusp::array1d<IndexType,MemorySpace> B_row_offsets(B.num_rows + 1);
+    cusp::detail::indices_to_offsets(A.row_indices, A_row_offsets);
+    cusp::detail::indices_to_offsets(B.row_indices, B_row_offsets);
+
+    cusp::detail::device::spmm_esc(A, A_row_offsets, B, B_row_offsets, C);
+}
+
+// CSR * CSR by expand-sort-contract.  Only the row indices of A and of C
+// are expanded: B and the other arrays of A are read in place.
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void spmm_csr_esc(const Matrix1& A,
+                  const Matrix2& B,
+                        Matrix3& C)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix3::index_type   IndexType;
+    typedef typename Matrix3::value_type   ValueType;
+    typedef typename Matrix3::memory_space MemorySpace;
+
+    cusp::array1d<IndexType,MemorySpace> A_row_indices(A.num_entries);
+    cusp::detail::offsets_to_indices(A.row_offsets, A_row_indices);
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> C_;
+
+    cusp::detail::device::spmm_esc(cusp::make_coo_matrix_view(A.num_rows, A.num_cols, A.num_entries,
+                                                              cusp::make_array1d_view(A_row_indices),
+                                                              cusp::make_array1d_view(A.column_indices),
+                                                              cusp::make_array1d_view(A.values)),
+                                   A.row_offsets, B, B.row_offsets, C_);
+
+    C.resize(C_.num_rows, C_.num_cols, C_.num_entries);
+    cusp::detail::indices_to_offsets(C_.row_indices, C.row_offsets);
+    thrust::copy(C_.column_indices.begin(), C_.column_indices.end(), C.column_indices.begin());
+    thrust::copy(C_.values.begin(),         C_.values.end(),         C.values.begin());
+}
+
 } // end namespace device
 } // end namespace detail
 } // end namespace cusp
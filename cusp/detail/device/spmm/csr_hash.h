@@ -0,0 +1,646 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/complex.h>
+#include <cusp/exception.h>
+
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/spgemm_budget.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/atomic.h>
+#include <cusp/detail/device/row_binning.h>
+#include <cusp/detail/device/utils.h>
+
+#include <thrust/copy.h>
+#include <thrust/scan.h>
+#include <thrust/binary_search.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// Hash-based CSR SpGEMM
+//////////////////////////////////////////////////////////////////////////////
+//
+// C = A * B is computed row by row in two passes over the intermediate
+// products A(i,k) * B(k,j):
+//
+//   symbolic: the column indices j of row i are inserted into a hash table
+//             to count the number of nonzeros of C(i,:)
+//   numeric:  the products are accumulated into a hash table keyed by j
+//             and the entries are written to C(i,:) in column order
+//
+// The work of a row (number of intermediate products) bounds the number of
+// distinct columns, so rows are grouped by work and each group is handled
+// by a kernel whose per-row hash table fits in shared memory.  Rows with
+// more work than the largest shared memory table use a table in global
+// memory, sized to the row and processed in batches of bounded size.
+//
+// Unlike the expand-sort-contract method (spmm_coo) no storage proportional
+// to the number of intermediate products is needed.
+//
+// The kernels rely on shared memory atomics and therefore require sm_20.
+// spmm_hash_supported() reports whether they were compiled for such a
+// target; otherwise the expand-sort-contract method is used.
+
+template <typename IndexType>
+__global__ void
+spmm_row_work_kernel(const IndexType num_rows,
+                     const IndexType * Ap,
+                     const IndexType * Aj,
+                     const IndexType * Bp,
+                           IndexType * work)
+{
+    const IndexType thread_id   = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType num_threads = blockDim.x * gridDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += num_threads)
+    {
+        IndexType sum = 0;
+
+        for(IndexType jj = Ap[row]; jj < Ap[row + 1]; jj++)
+        {
+            const IndexType j = Aj[jj];
+            sum += Bp[j + 1] - Bp[j];
+        }
+
+        work[row] = sum;
+    }
+}
+
+// Returns the slot of key in the open addressing table 'keys' of size
+// mask + 1, inserting key if necessary.  Empty slots hold -1.  The table
+// must have room for every key inserted.
+template <typename IndexType>
+__device__ __inline__ IndexType
+spmm_hash_insert(IndexType * keys, const IndexType mask, const IndexType key, IndexType * count)
+{
+#if __CUDA_ARCH__ >= 200
+    IndexType slot = IndexType((unsigned int) key * 107u) & mask;
+
+    while (true)
+    {
+        const IndexType current = static_cast<volatile IndexType *>(keys)[slot];
+
+        if (current == key)
+            return slot;
+
+        if (current == IndexType(-1))
+        {
+            const IndexType old = atomicCAS(keys + slot, IndexType(-1), key);
+
+            if (old == IndexType(-1))
+            {
+                atomicAdd(count, IndexType(1));
+                return slot;
+            }
+
+            if (old == key)
+                return slot;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+#else
+    return 0;
+#endif
+}
+
+// Inserts the intermediate products of row 'row' of A * B into a hash
+// table using 'num_threads' threads.  Each vector of VECTOR_WIDTH threads
+// processes one nonzero A(row,k) and traverses B(k,:).
+template <unsigned int VECTOR_WIDTH, bool Numeric, typename IndexType, typename ValueType>
+__device__ __inline__ void
+spmm_hash_row(const IndexType row,
+              const IndexType thread_lane,
+              const IndexType num_threads,
+              const IndexType * Ap, const IndexType * Aj, const ValueType * Ax,
+              const IndexType * Bp, const IndexType * Bj, const ValueType * Bx,
+                    IndexType * keys,
+                    ValueType * vals,
+              const IndexType   mask,
+                    IndexType * count)
+{
+    const IndexType vector_lane = thread_lane % VECTOR_WIDTH;
+    const IndexType vector_id   = thread_lane / VECTOR_WIDTH;
+    const IndexType num_vectors = num_threads / VECTOR_WIDTH;
+
+    for(IndexType jj = Ap[row] + vector_id; jj < Ap[row + 1]; jj += num_vectors)
+    {
+        const IndexType j = Aj[jj];
+
+        for(IndexType kk = Bp[j] + vector_lane; kk < Bp[j + 1]; kk += VECTOR_WIDTH)
+        {
+            const IndexType slot = spmm_hash_insert(keys, mask, Bj[kk], count);
+
+            if (Numeric)
+                atomic_add(vals + slot, Ax[jj] * Bx[kk]);
+        }
+    }
+}
+
+// Hash tables in shared memory.  Each group of THREADS_PER_ROW threads owns
+// a table of TABLE_SIZE entries.  The symbolic pass writes the number of
+// nonzeros of each row to row_nnz, the numeric pass writes the sorted row
+// at Cp[row].
+template <typename IndexType, typename ValueType,
+          unsigned int ROWS_PER_BLOCK, unsigned int THREADS_PER_ROW,
+          unsigned int TABLE_SIZE, unsigned int VECTOR_WIDTH, bool Numeric>
+__launch_bounds__(ROWS_PER_BLOCK * THREADS_PER_ROW,1)
+__global__ void
+spmm_hash_shared_kernel(const IndexType num_group_rows,
+                        const IndexType * rows,
+                        const IndexType * Ap, const IndexType * Aj, const ValueType * Ax,
+                        const IndexType * Bp, const IndexType * Bj, const ValueType * Bx,
+                              IndexType * row_nnz,
+                        const IndexType * Cp,
+                              IndexType * Cj,
+                              ValueType * Cx)
+{
+#if __CUDA_ARCH__ >= 200
+    __shared__ IndexType keys[ROWS_PER_BLOCK][TABLE_SIZE];
+    __shared__ ValueType vals[ROWS_PER_BLOCK][Numeric ? TABLE_SIZE : 1];
+    __shared__ IndexType count[ROWS_PER_BLOCK];
+
+    const IndexType thread_lane = threadIdx.x % THREADS_PER_ROW;   // thread index within the row
+    const IndexType row_lane    = threadIdx.x / THREADS_PER_ROW;   // row index within the block
+
+    for(IndexType base = ROWS_PER_BLOCK * blockIdx.x; base < num_group_rows; base += ROWS_PER_BLOCK * gridDim.x)
+    {
+        const IndexType group_row = base + row_lane;
+
+        for(IndexType t = thread_lane; t < IndexType(TABLE_SIZE); t += THREADS_PER_ROW)
+        {
+            keys[row_lane][t] = IndexType(-1);
+            if (Numeric)
+                vals[row_lane][t] = ValueType(0);
+        }
+
+        if (thread_lane == 0)
+            count[row_lane] = 0;
+
+        __syncthreads();
+
+        if (group_row < num_group_rows)
+            spmm_hash_row<VECTOR_WIDTH, Numeric>
+                (rows[group_row], thread_lane, IndexType(THREADS_PER_ROW),
+                 Ap, Aj, Ax, Bp, Bj, Bx,
+                 keys[row_lane], vals[row_lane], IndexType(TABLE_SIZE - 1), count + row_lane);
+
+        __syncthreads();
+
+        if (group_row < num_group_rows)
+        {
+            const IndexType row = rows[group_row];
+
+            if (!Numeric)
+            {
+                if (thread_lane == 0)
+                    row_nnz[row] = count[row_lane];
+            }
+            else
+            {
+                // the position of an entry within the row is the number of smaller keys
+                for(IndexType t = thread_lane; t < IndexType(TABLE_SIZE); t += THREADS_PER_ROW)
+                {
+                    const IndexType key = keys[row_lane][t];
+
+                    if (key == IndexType(-1))
+                        continue;
+
+                    IndexType rank = 0;
+                    for(IndexType s = 0; s < IndexType(TABLE_SIZE); s++)
+                    {
+                        const IndexType other = keys[row_lane][s];
+                        rank += (other != IndexType(-1) && other < key) ? 1 : 0;
+                    }
+
+                    Cj[Cp[row] + rank] = key;
+                    Cx[Cp[row] + rank] = vals[row_lane][t];
+                }
+            }
+        }
+
+        __syncthreads();
+    }
+#endif
+}
+
+// Hash tables in global memory, one thread block per row.  The table of the
+// i-th row is keys[table_offsets[i] - table_base, table_offsets[i+1] - table_base)
+// and its size is a power of two.  The numeric pass writes the row unsorted.
+template <typename IndexType, typename ValueType, unsigned int THREADS_PER_BLOCK, bool Numeric>
+__launch_bounds__(THREADS_PER_BLOCK,1)
+__global__ void
+spmm_hash_global_kernel(const IndexType num_group_rows,
+                        const IndexType * rows,
+                        const IndexType * table_offsets,
+                        const IndexType   table_base,
+                              IndexType * keys,
+                              ValueType * vals,
+                        const IndexType * Ap, const IndexType * Aj, const ValueType * Ax,
+                        const IndexType * Bp, const IndexType * Bj, const ValueType * Bx,
+                              IndexType * row_nnz,
+                        const IndexType * Cp,
+                              IndexType * Cj,
+                              ValueType * Cx)
+{
+#if __CUDA_ARCH__ >= 200
+    __shared__ IndexType count;
+
+    for(IndexType i = blockIdx.x; i < num_group_rows; i += gridDim.x)
+    {
+        const IndexType row        = rows[i];
+        const IndexType table_size = table_offsets[i + 1] - table_offsets[i];
+
+        IndexType * row_keys = keys + (table_offsets[i] - table_base);
+        ValueType * row_vals = vals + (table_offsets[i] - table_base);
+
+        for(IndexType t = threadIdx.x; t < table_size; t += THREADS_PER_BLOCK)
+        {
+            row_keys[t] = IndexType(-1);
+            if (Numeric)
+                row_vals[t] = ValueType(0);
+        }
+
+        if (threadIdx.x == 0)
+            count = 0;
+
+        __syncthreads();
+
+        spmm_hash_row<32, Numeric>
+            (row, IndexType(threadIdx.x), IndexType(THREADS_PER_BLOCK),
+             Ap, Aj, Ax, Bp, Bj, Bx,
+             row_keys, row_vals, table_size - 1, &count);
+
+        __syncthreads();
+
+        if (!Numeric)
+        {
+            if (threadIdx.x == 0)
+                row_nnz[row] = count;
+        }
+        else
+        {
+            if (threadIdx.x == 0)
+                count = 0;
+
+            __syncthreads();
+
+            for(IndexType t = threadIdx.x; t < table_size; t += THREADS_PER_BLOCK)
+            {
+                const IndexType key = static_cast<volatile IndexType *>(row_keys)[t];
+
+                if (key == IndexType(-1))
+                    continue;
+
+                const IndexType position = Cp[row] + atomicAdd(&count, IndexType(1));
+
+                Cj[position] = key;
+                Cx[position] = static_cast<volatile ValueType *>(row_vals)[t];
+            }
+        }
+
+        __syncthreads();
+    }
+#endif
+}
+
+// smallest power of two which is at least twice the work of a row
+template <typename IndexType>
+struct spmm_table_size : public thrust::unary_function<IndexType,IndexType>
+{
+    __host__ __device__
+    IndexType operator()(const IndexType work) const
+    {
+        IndexType size = 1;
+        while (size < 2 * work)
+            size <<= 1;
+        return size;
+    }
+};
+
+// true when the hash kernels were compiled for a target with shared memory atomics
+inline bool spmm_hash_supported(void)
+{
+    static cusp::detail::once_value<bool> supported;
+
+    return cusp::detail::initialize_once(supported, make_atomic_add_query(spmm_row_work_kernel<int>));
+}
+
+template <unsigned int ROWS_PER_BLOCK, unsigned int THREADS_PER_ROW,
+          unsigned int TABLE_SIZE, unsigned int VECTOR_WIDTH, bool Numeric,
+          typename Array, typename IndexType, typename ValueType>
+void __spmm_hash_shared(const Array& rows,
+                        const IndexType * Ap, const IndexType * Aj, const ValueType * Ax,
+                        const IndexType * Bp, const IndexType * Bj, const ValueType * Bx,
+                              IndexType * row_nnz,
+                        const IndexType * Cp,
+                              IndexType * Cj,
+                              ValueType * Cx)
+{
+    if (rows.size() == 0)
+        return;
+
+    const size_t THREADS_PER_BLOCK = ROWS_PER_BLOCK * THREADS_PER_ROW;
+
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmm_hash_shared_kernel<IndexType, ValueType, ROWS_PER_BLOCK, THREADS_PER_ROW, TABLE_SIZE, VECTOR_WIDTH, Numeric>, THREADS_PER_BLOCK, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(rows.size(), ROWS_PER_BLOCK));
+
+    spmm_hash_shared_kernel<IndexType, ValueType, ROWS_PER_BLOCK, THREADS_PER_ROW, TABLE_SIZE, VECTOR_WIDTH, Numeric> <<<NUM_BLOCKS, THREADS_PER_BLOCK, 0, cusp::detail::current_stream()>>>
+        (IndexType(rows.size()), thrust::raw_pointer_cast(&rows[0]),
+         Ap, Aj, Ax, Bp, Bj, Bx,
+         row_nnz, Cp, Cj, Cx);
+}
+
+// a second stream and an event, on which the batches of heavy rows
+// alternate with the current stream, created only when enabled
+class spmm_side_stream
+{
+    public:
+    explicit spmm_side_stream(const bool enabled)
+        : stream(0), event(0)
+    {
+        if (!enabled)
+            return;
+
+        check_cuda(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking), "cudaStreamCreateWithFlags failed");
+
+        if (cudaEventCreateWithFlags(&event, cudaEventDisableTiming) != cudaSuccess)
+        {
+            cudaStreamDestroy(stream);
+            throw cusp::runtime_exception("cudaEventCreateWithFlags failed");
+        }
+    }
+
+    ~spmm_side_stream(void)
+    {
+        if (event)
+            cudaEventDestroy(event);
+        if (stream)
+            cudaStreamDestroy(stream);
+    }
+
+    cudaStream_t stream;
+    cudaEvent_t  event;
+
+    private:
+    // not copyable
+    spmm_side_stream(const spmm_side_stream&);
+    spmm_side_stream& operator=(const spmm_side_stream&);
+};
+
+// Rows whose tables exceed shared memory are processed in batches whose
+// tables fit in TABLE_CAPACITY entries, or in the workspace budget of the
+// product.  When there is more than one batch, each of two table buffers
+// holds half the capacity and consecutive batches alternate between the
+// current stream and a second stream, so that the tables of one batch are
+// cleared while the other batch is hashed.
+template <bool Numeric, typename Array1, typename Array2, typename IndexType, typename ValueType>
+void __spmm_hash_global(const Array1& rows,
+                        const Array2& table_offsets,
+                        const IndexType * Ap, const IndexType * Aj, const ValueType * Ax,
+                        const IndexType * Bp, const IndexType * Bj, const ValueType * Bx,
+                              IndexType * row_nnz,
+                        const IndexType * Cp,
+                              IndexType * Cj,
+                              ValueType * Cx)
+{
+    const size_t num_rows = rows.size();
+
+    if (num_rows == 0)
+        return;
+
+    const size_t THREADS_PER_BLOCK = 256;
+
+    // largest total size of the tables (a single row may exceed it),
+    // bounded by the workspace budget of the product
+    const size_t TABLE_BYTES    = Numeric ? sizeof(IndexType) + sizeof(ValueType) : sizeof(IndexType);
+    const size_t TABLE_CAPACITY = std::min<size_t>(cusp::detail::spgemm_budget_capacity(TABLE_BYTES, 16 << 20),
+                                                   std::numeric_limits<IndexType>::max() / 2);
+
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmm_hash_global_kernel<IndexType, ValueType, THREADS_PER_BLOCK, Numeric>, THREADS_PER_BLOCK, (size_t) 0);
+
+    // the batches [batches[k], batches[k+1]) are split on the host
+    cusp::array1d<IndexType,cusp::host_memory> offsets(table_offsets);
+
+    const size_t total_size     = size_t(offsets[num_rows]);
+    const size_t batch_capacity = total_size <= TABLE_CAPACITY ? TABLE_CAPACITY : std::max<size_t>(TABLE_CAPACITY / 2, 1);
+
+    std::vector<size_t> batches(1, 0);
+    size_t max_table_size = 0;
+
+    while (batches.back() < num_rows)
+    {
+        const size_t begin = batches.back();
+
+        size_t end = std::upper_bound(offsets.begin() + begin + 1, offsets.end(), offsets[begin] + IndexType(batch_capacity)) - offsets.begin() - 1;
+        end = std::max(end, begin + 1);
+
+        max_table_size = std::max<size_t>(max_table_size, offsets[end] - offsets[begin]);
+        batches.push_back(end);
+    }
+
+    const size_t num_batches = batches.size() - 1;
+    const size_t num_buffers = num_batches > 1 ? 2 : 1;
+
+    cusp::array1d<IndexType,cusp::device_memory> keys[2];
+    cusp::array1d<ValueType,cusp::device_memory> vals[2];
+
+    for (size_t b = 0; b < num_buffers; b++)
+    {
+        keys[b].resize(max_table_size);
+        vals[b].resize(Numeric ? max_table_size : 1);
+    }
+
+    const cudaStream_t caller = cusp::detail::current_stream();
+
+    // the second stream starts after the work issued so far
+    spmm_side_stream side(num_buffers > 1);
+
+    if (num_buffers > 1)
+    {
+        check_cuda(cudaEventRecord(side.event, caller), "cudaEventRecord failed");
+        check_cuda(cudaStreamWaitEvent(side.stream, side.event, 0), "cudaStreamWaitEvent failed");
+    }
+
+    for (size_t k = 0; k < num_batches; k++)
+    {
+        const size_t       begin  = batches[k];
+        const size_t       end    = batches[k + 1];
+        const size_t       b      = k % num_buffers;
+        const cudaStream_t stream = b == 0 ? caller : side.stream;
+
+        const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, end - begin);
+
+        spmm_hash_global_kernel<IndexType, ValueType, THREADS_PER_BLOCK, Numeric> <<<NUM_BLOCKS, THREADS_PER_BLOCK, 0, stream>>>
+            (IndexType(end - begin),
+             thrust::raw_pointer_cast(&rows[0]) + begin,
+             thrust::raw_pointer_cast(&table_offsets[0]) + begin,
+             offsets[begin],
+             thrust::raw_pointer_cast(&keys[b][0]),
+             thrust::raw_pointer_cast(&vals[b][0]),
+             Ap, Aj, Ax, Bp, Bj, Bx,
+             row_nnz, Cp, Cj, Cx);
+    }
+
+    // the work that follows on the current stream waits for both streams
+    if (num_buffers > 1)
+    {
+        check_cuda(cudaEventRecord(side.event, side.stream), "cudaEventRecord failed");
+        check_cuda(cudaStreamWaitEvent(caller, side.event, 0), "cudaStreamWaitEvent failed");
+    }
+
+    // count the batches once, in the numeric pass
+    if (Numeric)
+        cusp::detail::spgemm_count_slabs(num_batches);
+}
+
+// Computes C = A * B where the row offsets of A and B are given separately
+// so that COO and CSR matrices can be used alike.  On return C holds the
+// column indices and values of the product and C_row_offsets its row offsets.
+template <typename Array1, typename Matrix1,
+          typename Array2, typename Matrix2,
+          typename Matrix3, typename Array3>
+void spmm_csr_hash(const Array1&  A_row_offsets,
+                   const Matrix1& A,
+                   const Array2&  B_row_offsets,
+                   const Matrix2& B,
+                         Matrix3& C,
+                         Array3&  C_row_offsets)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix3::index_type   IndexType;
+    typedef typename Matrix3::value_type   ValueType;
+    typedef cusp::device_memory            MemorySpace;
+
+    const size_t num_rows = A.num_rows;
+
+    // check whether matrices are empty
+    if (A.num_entries == 0 || B.num_entries == 0)
+    {
+        C.resize(A.num_rows, B.num_cols, 0);
+        C_row_offsets.resize(num_rows + 1);
+        thrust::fill(C_row_offsets.begin(), C_row_offsets.end(), IndexType(0));
+        return;
+    }
+
+    const IndexType * Ap = thrust::raw_pointer_cast(&A_row_offsets[0]);
+    const IndexType * Aj = thrust::raw_pointer_cast(&A.column_indices[0]);
+    const ValueType * Ax = thrust::raw_pointer_cast(&A.values[0]);
+    const IndexType * Bp = thrust::raw_pointer_cast(&B_row_offsets[0]);
+    const IndexType * Bj = thrust::raw_pointer_cast(&B.column_indices[0]);
+    const ValueType * Bx = thrust::raw_pointer_cast(&B.values[0]);
+
+    // number of intermediate products of each row
+    cusp::array1d<IndexType,MemorySpace> work(num_rows);
+    {
+        const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+        const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmm_row_work_kernel<IndexType>, BLOCK_SIZE, (size_t) 0);
+        const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(num_rows, BLOCK_SIZE));
+
+        spmm_row_work_kernel<IndexType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+            (IndexType(num_rows), Ap, Aj, Bp, thrust::raw_pointer_cast(&work[0]));
+    }
+
+    // group rows by work, each group is processed by the kernel whose table
+    // holds at least twice the work of the row (rows without work are empty
+    // and belong to no group)
+    const size_t    NUM_GROUPS = 5;
+    const IndexType group_bounds[NUM_GROUPS] = {1, 17, 129, 513, 1025};
+
+    cusp::detail::device::row_binning<IndexType,MemorySpace> groups;
+    cusp::detail::device::bin_rows(work, group_bounds, NUM_GROUPS, groups);
+
+    typedef typename cusp::detail::device::row_binning<IndexType,MemorySpace>::bucket_view_type GroupView;
+
+    const GroupView group_rows[NUM_GROUPS - 1] = {groups.bucket(0), groups.bucket(1), groups.bucket(2), groups.bucket(3)};
+    const GroupView heavy_rows = groups.bucket(NUM_GROUPS - 1);
+
+    // table offsets of the rows processed with global memory tables
+    cusp::array1d<IndexType,MemorySpace> table_offsets(heavy_rows.size() + 1, IndexType(0));
+    thrust::transform(thrust::make_permutation_iterator(work.begin(), heavy_rows.begin()),
+                      thrust::make_permutation_iterator(work.begin(), heavy_rows.end()),
+                      table_offsets.begin(),
+                      spmm_table_size<IndexType>());
+    thrust::exclusive_scan(table_offsets.begin(), table_offsets.end(), table_offsets.begin(), IndexType(0));
+
+    work.clear(); work.shrink_to_fit();
+
+    // symbolic pass
+    cusp::array1d<IndexType,MemorySpace> row_offsets(num_rows + 1, IndexType(0));
+    {
+        IndexType * row_nnz = thrust::raw_pointer_cast(&row_offsets[0]);
+
+        __spmm_hash_shared<32, 8,  32,  2, false>(group_rows[0], Ap, Aj, Ax, Bp, Bj, Bx, row_nnz, (IndexType *) 0, (IndexType *) 0, (ValueType *) 0);
+        __spmm_hash_shared< 8, 32, 256, 4, false>(group_rows[1], Ap, Aj, Ax, Bp, Bj, Bx, row_nnz, (IndexType *) 0, (IndexType *) 0, (ValueType *) 0);
+        __spmm_hash_shared< 2,128,1024, 8, false>(group_rows[2], Ap, Aj, Ax, Bp, Bj, Bx, row_nnz, (IndexType *) 0, (IndexType *) 0, (ValueType *) 0);
+        __spmm_hash_shared< 1,256,2048, 8, false>(group_rows[3], Ap, Aj, Ax, Bp, Bj, Bx, row_nnz, (IndexType *) 0, (IndexType *) 0, (ValueType *) 0);
+        __spmm_hash_global<false>(heavy_rows, table_offsets, Ap, Aj, Ax, Bp, Bj, Bx, row_nnz, (IndexType *) 0, (IndexType *) 0, (ValueType *) 0);
+    }
+
+    thrust::exclusive_scan(row_offsets.begin(), row_offsets.end(), row_offsets.begin(), IndexType(0));
+
+    const size_t NNZ = row_offsets[num_rows];
+
+    // allocate space for output
+    C.resize(A.num_rows, B.num_cols, NNZ);
+
+    // numeric pass
+    {
+        const IndexType * Cp = thrust::raw_pointer_cast(&row_offsets[0]);
+        IndexType       * Cj = thrust::raw_pointer_cast(&C.column_indices[0]);
+        ValueType       * Cx = thrust::raw_pointer_cast(&C.values[0]);
+
+        __spmm_hash_shared<32, 8,  32,  2, true>(group_rows[0], Ap, Aj, Ax, Bp, Bj, Bx, (IndexType *) 0, Cp, Cj, Cx);
+        __spmm_hash_shared< 8, 32, 256, 4, true>(group_rows[1], Ap, Aj, Ax, Bp, Bj, Bx, (IndexType *) 0, Cp, Cj, Cx);
+        __spmm_hash_shared< 2,128,1024, 8, true>(group_rows[2], Ap, Aj, Ax, Bp, Bj, Bx, (IndexType *) 0, Cp, Cj, Cx);
+        __spmm_hash_shared< 1,256,2048, 8, true>(group_rows[3], Ap, Aj, Ax, Bp, Bj, Bx, (IndexType *) 0, Cp, Cj, Cx);
+        __spmm_hash_global<true>(heavy_rows, table_offsets, Ap, Aj, Ax, Bp, Bj, Bx, (IndexType *) 0, Cp, Cj, Cx);
+    }
+
+    // rows processed with global memory tables are unsorted
+    if (heavy_rows.size() > 0)
+    {
+        cusp::array1d<IndexType,MemorySpace> C_row_indices(NNZ);
+        cusp::detail::offsets_to_indices(row_offsets, C_row_indices);
+        cusp::detail::sort_by_row_and_column(C_row_indices, C.column_indices, C.values, C.num_rows, C.num_cols);
+    }
+
+    C_row_offsets.resize(num_rows + 1);
+    thrust::copy(row_offsets.begin(), row_offsets.end(), C_row_offsets.begin());
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
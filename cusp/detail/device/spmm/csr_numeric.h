@@ -0,0 +1,139 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/utils.h>
+
+#include <thrust/device_ptr.h>
+#include <thrust/fill.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// Numeric CSR SpGEMM with a known output structure
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmm_csr_numeric_kernel
+//   Each row of C is assigned to a thread, which clears the values of the
+//   row and accumulates every product A(i,k) * B(k,j) into the entry found
+//   by a binary search of j among the (sorted) column indices of C(i,:).
+//   Since a row is owned by a single thread no atomics are needed.
+//   Products which do not fall on an entry of C are ignored.
+
+template <typename IndexType, typename ValueType>
+__global__ void
+spmm_csr_numeric_kernel(const IndexType num_rows,
+                        const IndexType * Ap, const IndexType * Aj, const ValueType * Ax,
+                        const IndexType * Bp, const IndexType * Bj, const ValueType * Bx,
+                        const IndexType * Cp, const IndexType * Cj,       ValueType * Cx)
+{
+    const IndexType thread_id   = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType num_threads = blockDim.x * gridDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += num_threads)
+    {
+        const IndexType row_start = Cp[row];
+        const IndexType row_end   = Cp[row + 1];
+
+        for(IndexType kk = row_start; kk < row_end; kk++)
+            Cx[kk] = ValueType(0);
+
+        for(IndexType jj = Ap[row]; jj < Ap[row + 1]; jj++)
+        {
+            const IndexType j = Aj[jj];
+            const ValueType a = Ax[jj];
+
+            for(IndexType kk = Bp[j]; kk < Bp[j + 1]; kk++)
+            {
+                const IndexType col = Bj[kk];
+
+                // binary search for col in Cj[row_start, row_end)
+                IndexType lo = row_start;
+                IndexType hi = row_end;
+
+                while (lo < hi)
+                {
+                    const IndexType mid = lo + (hi - lo) / 2;
+
+                    if (Cj[mid] < col)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+
+                if (lo < row_end && Cj[lo] == col)
+                    Cx[lo] += a * Bx[kk];
+            }
+        }
+    }
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Array1,
+          typename Array2,
+          typename Array3>
+void spmm_csr_numeric(const Matrix1& A,
+                      const Matrix2& B,
+                      const Array1&  C_row_offsets,
+                      const Array2&  C_column_indices,
+                            Array3&  C_values)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Array1::value_type IndexType;
+    typedef typename Array3::value_type ValueType;
+
+    if (A.num_rows == 0 || C_values.size() == 0)
+        return;
+
+    if (A.num_entries == 0 || B.num_entries == 0)
+    {
+        thrust::fill(C_values.begin(), C_values.end(), ValueType(0));
+        return;
+    }
+
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmm_csr_numeric_kernel<IndexType, ValueType>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+
+    spmm_csr_numeric_kernel<IndexType, ValueType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows),
+         thrust::raw_pointer_cast(&A.row_offsets[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         thrust::raw_pointer_cast(&B.row_offsets[0]),
+         thrust::raw_pointer_cast(&B.column_indices[0]),
+         thrust::raw_pointer_cast(&B.values[0]),
+         thrust::raw_pointer_cast(&C_row_offsets[0]),
+         thrust::raw_pointer_cast(&C_column_indices[0]),
+         thrust::raw_pointer_cast(&C_values[0]));
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
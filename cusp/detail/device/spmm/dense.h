@@ -0,0 +1,379 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/ell_matrix.h>
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/atomic.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/utils.h>
+
+#include <thrust/device_ptr.h>
+
+#include <algorithm>
+
+// Sparse matrix times dense multi-vector (array2d) kernels.  Each thread
+// or vector reads a nonzero A(i,j) once and applies it to CHUNK_SIZE
+// columns of X, so for k <= CHUNK_SIZE right-hand sides A is read once
+// instead of k times.  The dense operands are addressed through their row
+// and column strides, which handles both row-major and column-major
+// orientations and any pitch.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+// distance between consecutive rows and columns of an array2d
+template <typename Array2d>
+size_t spmm_row_stride(const Array2d& X)
+{
+    return cusp::detail::index_of(size_t(1), size_t(0), size_t(X.pitch), typename Array2d::orientation());
+}
+
+template <typename Array2d>
+size_t spmm_col_stride(const Array2d& X)
+{
+    return cusp::detail::index_of(size_t(0), size_t(1), size_t(X.pitch), typename Array2d::orientation());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// CSR SpMM kernel (one vector per row)
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmm_csr_dense_vector_kernel
+//   The spmv_csr_vector_kernel with CHUNK_SIZE sums per thread, which are
+//   reduced separately.  Columns of X beyond CHUNK_SIZE are handled by
+//   further passes over the row.
+//
+//  Note: THREADS_PER_VECTOR must be one of [2,4,8,16,32]
+
+template <typename IndexType, typename ValueType, unsigned int VECTORS_PER_BLOCK, unsigned int THREADS_PER_VECTOR, unsigned int CHUNK_SIZE>
+__launch_bounds__(VECTORS_PER_BLOCK * THREADS_PER_VECTOR,1)
+__global__ void
+spmm_csr_dense_vector_kernel(const IndexType num_rows,
+                             const IndexType num_vectors,
+                             const IndexType * Ap,
+                             const IndexType * Aj,
+                             const ValueType * Ax,
+                             const ValueType * X,
+                             const IndexType X_row_stride,
+                             const IndexType X_col_stride,
+                                   ValueType * Y,
+                             const IndexType Y_row_stride,
+                             const IndexType Y_col_stride)
+{
+    __shared__ volatile ValueType sdata[CHUNK_SIZE][VECTORS_PER_BLOCK * THREADS_PER_VECTOR + THREADS_PER_VECTOR / 2];  // padded to avoid reduction conditionals
+    __shared__ volatile IndexType ptrs[VECTORS_PER_BLOCK][2];
+
+    const IndexType THREADS_PER_BLOCK = VECTORS_PER_BLOCK * THREADS_PER_VECTOR;
+
+    const IndexType thread_id   = THREADS_PER_BLOCK * blockIdx.x + threadIdx.x;    // global thread index
+    const IndexType thread_lane = threadIdx.x & (THREADS_PER_VECTOR - 1);          // thread index within the vector
+    const IndexType vector_id   = thread_id   /  THREADS_PER_VECTOR;               // global vector index
+    const IndexType vector_lane = threadIdx.x /  THREADS_PER_VECTOR;               // vector index within the block
+    const IndexType num_warps   = VECTORS_PER_BLOCK * gridDim.x;                   // total number of active vectors
+
+    for(IndexType row = vector_id; row < num_rows; row += num_warps)
+    {
+        // use two threads to fetch Ap[row] and Ap[row+1]
+        if(thread_lane < 2)
+            ptrs[vector_lane][thread_lane] = Ap[row + thread_lane];
+
+        const IndexType row_start = ptrs[vector_lane][0];
+        const IndexType row_end   = ptrs[vector_lane][1];
+
+        for(IndexType base = 0; base < num_vectors; base += CHUNK_SIZE)
+        {
+            // initialize local sums
+            ValueType sum[CHUNK_SIZE];
+
+            for(unsigned int c = 0; c < CHUNK_SIZE; c++)
+                sum[c] = 0;
+
+            for(IndexType jj = row_start + thread_lane; jj < row_end; jj += THREADS_PER_VECTOR)
+            {
+                const IndexType j    = Aj[jj];
+                const ValueType A_ij = Ax[jj];
+
+                for(unsigned int c = 0; c < CHUNK_SIZE; c++)
+                    if (base + c < num_vectors)
+                        sum[c] += A_ij * X[j * X_row_stride + (base + c) * X_col_stride];
+            }
+
+            // reduce local sums to row sums
+            for(unsigned int c = 0; c < CHUNK_SIZE; c++)
+            {
+                sdata[c][threadIdx.x] = sum[c];
+
+                if (THREADS_PER_VECTOR > 16) sdata[c][threadIdx.x] = sum[c] = sum[c] + sdata[c][threadIdx.x + 16];
+                if (THREADS_PER_VECTOR >  8) sdata[c][threadIdx.x] = sum[c] = sum[c] + sdata[c][threadIdx.x +  8];
+                if (THREADS_PER_VECTOR >  4) sdata[c][threadIdx.x] = sum[c] = sum[c] + sdata[c][threadIdx.x +  4];
+                if (THREADS_PER_VECTOR >  2) sdata[c][threadIdx.x] = sum[c] = sum[c] + sdata[c][threadIdx.x +  2];
+                if (THREADS_PER_VECTOR >  1) sdata[c][threadIdx.x] = sum[c] = sum[c] + sdata[c][threadIdx.x +  1];
+
+                // first thread writes the result
+                if (thread_lane == 0 && base + c < num_vectors)
+                    Y[row * Y_row_stride + (base + c) * Y_col_stride] = sdata[c][threadIdx.x];
+            }
+        }
+    }
+}
+
+template <typename IndexType, typename ValueType, size_t BLOCK_SIZE, unsigned int CHUNK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+spmm_ell_dense_kernel(const IndexType num_rows,
+                      const IndexType num_vectors,
+                      const IndexType num_cols_per_row,
+                      const IndexType pitch,
+                      const IndexType * Aj,
+                      const ValueType * Ax,
+                      const ValueType * X,
+                      const IndexType X_row_stride,
+                      const IndexType X_col_stride,
+                            ValueType * Y,
+                      const IndexType Y_row_stride,
+                      const IndexType Y_col_stride)
+{
+    const IndexType invalid_index = cusp::ell_matrix<IndexType, ValueType, cusp::device_memory>::invalid_index;
+
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += grid_size)
+    {
+        for(IndexType base = 0; base < num_vectors; base += CHUNK_SIZE)
+        {
+            ValueType sum[CHUNK_SIZE];
+
+            for(unsigned int c = 0; c < CHUNK_SIZE; c++)
+                sum[c] = 0;
+
+            IndexType offset = row;
+
+            for(IndexType n = 0; n < num_cols_per_row; n++)
+            {
+                const IndexType col = Aj[offset];
+
+                if (col != invalid_index)
+                {
+                    const ValueType A_ij = Ax[offset];
+
+                    for(unsigned int c = 0; c < CHUNK_SIZE; c++)
+                        if (base + c < num_vectors)
+                            sum[c] += A_ij * X[col * X_row_stride + (base + c) * X_col_stride];
+                }
+
+                offset += pitch;
+            }
+
+            for(unsigned int c = 0; c < CHUNK_SIZE; c++)
+                if (base + c < num_vectors)
+                    Y[row * Y_row_stride + (base + c) * Y_col_stride] = sum[c];
+        }
+    }
+}
+
+// adds the products of the COO entries to Y, one thread per entry
+template <typename IndexType, typename ValueType, size_t BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+spmm_coo_dense_atomic_kernel(const IndexType num_entries,
+                             const IndexType num_vectors,
+                             const IndexType * Ai,
+                             const IndexType * Aj,
+                             const ValueType * Ax,
+                             const ValueType * X,
+                             const IndexType X_row_stride,
+                             const IndexType X_col_stride,
+                                   ValueType * Y,
+                             const IndexType Y_row_stride,
+                             const IndexType Y_col_stride)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType n = thread_id; n < num_entries; n += grid_size)
+    {
+        const IndexType i    = Ai[n];
+        const IndexType j    = Aj[n];
+        const ValueType A_ij = Ax[n];
+
+        for(IndexType c = 0; c < num_vectors; c++)
+            atomic_add(Y + i * Y_row_stride + c * Y_col_stride, A_ij * X[j * X_row_stride + c * X_col_stride]);
+    }
+}
+
+template <unsigned int THREADS_PER_VECTOR, unsigned int CHUNK_SIZE, typename Matrix1, typename Matrix2, typename Matrix3>
+void __spmm_csr_dense_vector(const Matrix1& A,
+                             const Matrix2& X,
+                                   Matrix3& Y)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix3::value_type ValueType;
+
+    const size_t THREADS_PER_BLOCK  = 128;
+    const size_t VECTORS_PER_BLOCK  = THREADS_PER_BLOCK / THREADS_PER_VECTOR;
+
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmm_csr_dense_vector_kernel<IndexType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, CHUNK_SIZE>, THREADS_PER_BLOCK, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, VECTORS_PER_BLOCK));
+
+    spmm_csr_dense_vector_kernel<IndexType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, CHUNK_SIZE> <<<NUM_BLOCKS, THREADS_PER_BLOCK, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows), IndexType(X.num_cols),
+         thrust::raw_pointer_cast(&A.row_offsets[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         thrust::raw_pointer_cast(&X.values[0]), IndexType(spmm_row_stride(X)), IndexType(spmm_col_stride(X)),
+         thrust::raw_pointer_cast(&Y.values[0]), IndexType(spmm_row_stride(Y)), IndexType(spmm_col_stride(Y)));
+}
+
+template <unsigned int CHUNK_SIZE, typename Matrix1, typename Matrix2, typename Matrix3>
+void __spmm_csr_dense_adaptive(const Matrix1& A,
+                               const Matrix2& X,
+                                     Matrix3& Y)
+{
+    const double mean = double(A.num_entries) / double(A.num_rows);
+
+    if      (mean <  3) __spmm_csr_dense_vector< 2, CHUNK_SIZE>(A, X, Y);
+    else if (mean <  5) __spmm_csr_dense_vector< 4, CHUNK_SIZE>(A, X, Y);
+    else if (mean <  9) __spmm_csr_dense_vector< 8, CHUNK_SIZE>(A, X, Y);
+    else if (mean < 17) __spmm_csr_dense_vector<16, CHUNK_SIZE>(A, X, Y);
+    else                __spmm_csr_dense_vector<32, CHUNK_SIZE>(A, X, Y);
+}
+
+template <unsigned int CHUNK_SIZE, typename Matrix1, typename Matrix2, typename Matrix3>
+void __spmm_ell_dense(const Matrix1& A,
+                      const Matrix2& X,
+                            Matrix3& Y)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix3::value_type ValueType;
+
+    const size_t BLOCK_SIZE = 256;
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmm_ell_dense_kernel<IndexType,ValueType,BLOCK_SIZE,CHUNK_SIZE>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+
+    const IndexType pitch               = A.column_indices.pitch;
+    const IndexType num_entries_per_row = A.column_indices.num_cols;
+
+    // the kernel indexes column_indices and values with one pitch
+    assert(A.column_indices.pitch == A.values.pitch);
+
+    spmm_ell_dense_kernel<IndexType,ValueType,BLOCK_SIZE,CHUNK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows), IndexType(X.num_cols),
+         num_entries_per_row, pitch,
+         thrust::raw_pointer_cast(&A.column_indices.values[0]),
+         thrust::raw_pointer_cast(&A.values.values[0]),
+         thrust::raw_pointer_cast(&X.values[0]), IndexType(spmm_row_stride(X)), IndexType(spmm_col_stride(X)),
+         thrust::raw_pointer_cast(&Y.values[0]), IndexType(spmm_row_stride(Y)), IndexType(spmm_col_stride(Y)));
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+void __spmm_coo_dense_atomic(const Matrix1& A,
+                             const Matrix2& X,
+                                   Matrix3& Y)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix3::value_type ValueType;
+
+    if (A.num_entries == 0)
+        return;
+
+    const size_t BLOCK_SIZE = 256;
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmm_coo_dense_atomic_kernel<IndexType,ValueType,BLOCK_SIZE>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_entries, BLOCK_SIZE));
+
+    spmm_coo_dense_atomic_kernel<IndexType,ValueType,BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_entries), IndexType(X.num_cols),
+         thrust::raw_pointer_cast(&A.row_indices[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         thrust::raw_pointer_cast(&X.values[0]), IndexType(spmm_row_stride(X)), IndexType(spmm_col_stride(X)),
+         thrust::raw_pointer_cast(&Y.values[0]), IndexType(spmm_row_stride(Y)), IndexType(spmm_col_stride(Y)));
+}
+
+template <typename IndexType, typename ValueType>
+bool spmm_dense_atomics_supported(void)
+{
+    static cusp::detail::once_value<bool> supported;
+
+    return cusp::detail::initialize_once(supported, make_atomic_add_query(spmm_coo_dense_atomic_kernel<IndexType, ValueType, 256>));
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+void spmm_csr_dense(const Matrix1& A,
+                    const Matrix2& X,
+                          Matrix3& Y)
+{
+    Y.resize(A.num_rows, X.num_cols);
+
+    if (A.num_rows == 0 || X.num_cols == 0)
+        return;
+
+    if      (X.num_cols <= 2) __spmm_csr_dense_adaptive<2>(A, X, Y);
+    else if (X.num_cols <= 4) __spmm_csr_dense_adaptive<4>(A, X, Y);
+    else                      __spmm_csr_dense_adaptive<8>(A, X, Y);
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+void spmm_ell_dense(const Matrix1& A,
+                    const Matrix2& X,
+                          Matrix3& Y)
+{
+    Y.resize(A.num_rows, X.num_cols);
+
+    if (A.num_rows == 0 || X.num_cols == 0)
+        return;
+
+    if      (X.num_cols <= 2) __spmm_ell_dense<2>(A, X, Y);
+    else if (X.num_cols <= 4) __spmm_ell_dense<4>(A, X, Y);
+    else                      __spmm_ell_dense<8>(A, X, Y);
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+void spmm_hyb_dense(const Matrix1& A,
+                    const Matrix2& X,
+                          Matrix3& Y)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix1::value_type ValueType;
+
+    if (spmm_dense_atomics_supported<IndexType,ValueType>())
+    {
+        spmm_ell_dense(A.ell, X, Y);
+
+        if (X.num_cols > 0)
+            __spmm_coo_dense_atomic(A.coo, X, Y);
+    }
+    else
+    {
+        // add the COO part through the CSR kernel instead
+        cusp::csr_matrix<IndexType, ValueType, cusp::device_memory> A_csr(A);
+        spmm_csr_dense(A_csr, X, Y);
+    }
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
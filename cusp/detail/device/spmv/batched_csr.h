@@ -0,0 +1,204 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/utils.h>
+
+#include <cusp/detail/stream.h>
+
+#include <thrust/device_ptr.h>
+
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////////
+// Batched CSR SpMV, y_b = A_b x_b for many small matrices A_b
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmv_batched_csr_kernel
+//   Each batch item is assigned to a vector of THREADS_PER_ITEM threads
+//   and each thread of the vector computes the rows of the item with a
+//   stride of THREADS_PER_ITEM.  A single launch covers all items, so a
+//   batch of small matrices costs one launch instead of one per matrix.
+//   The layout (see batched_multiply.inl) locates the rows, the pattern,
+//   the values and the operand of an item:
+//
+//     batched_concatenated_layout : the items are stored one after the
+//         other in a single CSR matrix whose column indices are local to
+//         the item, and batch offsets delimit their rows and columns.
+//     batched_uniform_layout      : all items share a CSR pattern and the
+//         values of item b are row b of a dense array.
+//
+//  Note: THREADS_PER_ITEM must be one of [2,4,8,16,32]
+//
+// spmv_interleaved_batched_csr_kernel
+//   The product of a batched_csr_matrix, whose items share the pattern
+//   and store their values interleaved.  Each thread computes one row of
+//   one item and consecutive threads take consecutive items of a row, so
+//   the threads of a warp load the same row offsets and column indices,
+//   which the hardware broadcasts, and adjacent values.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+template <typename IndexType, typename ValueType, typename Layout, unsigned int ITEMS_PER_BLOCK, unsigned int THREADS_PER_ITEM>
+__launch_bounds__(ITEMS_PER_BLOCK * THREADS_PER_ITEM,1)
+__global__ void
+spmv_batched_csr_kernel(const IndexType num_items,
+                        const IndexType * Ap,
+                        const IndexType * Aj,
+                        const ValueType * Ax,
+                        const ValueType * x,
+                              ValueType * y,
+                        Layout layout)
+{
+    const IndexType THREADS_PER_BLOCK = ITEMS_PER_BLOCK * THREADS_PER_ITEM;
+
+    const IndexType thread_id   = THREADS_PER_BLOCK * blockIdx.x + threadIdx.x;    // global thread index
+    const IndexType thread_lane = threadIdx.x & (THREADS_PER_ITEM - 1);            // thread index within the vector
+    const IndexType vector_id   = thread_id   /  THREADS_PER_ITEM;                 // global vector index
+    const IndexType num_vectors = ITEMS_PER_BLOCK * gridDim.x;                     // total number of active vectors
+
+    for(IndexType item = vector_id; item < num_items; item += num_vectors)
+    {
+        const IndexType row_end = layout.row_end(item);
+
+        const ValueType * xb = x + layout.column_offset(item);
+        const ValueType * Ab = Ax + layout.value_offset(item);
+        const size_t stride  = layout.value_stride();
+
+        for(IndexType row = layout.row_begin(item) + thread_lane; row < row_end; row += THREADS_PER_ITEM)
+        {
+            const IndexType p = layout.pattern_row(item, row);
+
+            ValueType sum = 0;
+
+            for(IndexType jj = Ap[p]; jj < Ap[p + 1]; jj++)
+                sum += Ab[jj * stride] * xb[Aj[jj]];
+
+            y[row] = sum;
+        }
+    }
+}
+
+template <unsigned int THREADS_PER_ITEM, typename IndexType, typename ValueType, typename Layout>
+void __spmv_batched_csr(const IndexType  num_items,
+                        const IndexType* Ap,
+                        const IndexType* Aj,
+                        const ValueType* Ax,
+                        const ValueType* x,
+                              ValueType* y,
+                        Layout           layout)
+{
+    const size_t THREADS_PER_BLOCK = 128;
+    const size_t ITEMS_PER_BLOCK   = THREADS_PER_BLOCK / THREADS_PER_ITEM;
+
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_batched_csr_kernel<IndexType, ValueType, Layout, ITEMS_PER_BLOCK, THREADS_PER_ITEM>, THREADS_PER_BLOCK, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(num_items, ITEMS_PER_BLOCK));
+
+    spmv_batched_csr_kernel<IndexType, ValueType, Layout, ITEMS_PER_BLOCK, THREADS_PER_ITEM> <<<NUM_BLOCKS, THREADS_PER_BLOCK, 0, cusp::detail::current_stream()>>>
+        (num_items, Ap, Aj, Ax, x, y, layout);
+}
+
+// the vector of an item is the narrowest that covers its mean number of rows
+template <typename IndexType, typename ValueType, typename Layout>
+void spmv_batched_csr(const IndexType  num_items,
+                      const size_t     num_rows,
+                      const IndexType* Ap,
+                      const IndexType* Aj,
+                      const ValueType* Ax,
+                      const ValueType* x,
+                            ValueType* y,
+                      Layout           layout)
+{
+    if (num_items == 0)
+        return;
+
+    const size_t rows_per_item = DIVIDE_INTO(num_rows, size_t(num_items));
+
+    if (rows_per_item <=  2) { __spmv_batched_csr< 2>(num_items, Ap, Aj, Ax, x, y, layout); return; }
+    if (rows_per_item <=  4) { __spmv_batched_csr< 4>(num_items, Ap, Aj, Ax, x, y, layout); return; }
+    if (rows_per_item <=  8) { __spmv_batched_csr< 8>(num_items, Ap, Aj, Ax, x, y, layout); return; }
+    if (rows_per_item <= 16) { __spmv_batched_csr<16>(num_items, Ap, Aj, Ax, x, y, layout); return; }
+
+    __spmv_batched_csr<32>(num_items, Ap, Aj, Ax, x, y, layout);
+}
+
+template <typename IndexType, typename ValueType>
+__global__ void
+spmv_interleaved_batched_csr_kernel(const IndexType num_batches,
+                                    const IndexType num_rows,
+                                    const IndexType num_cols,
+                                    const IndexType pitch,
+                                    const IndexType * Ap,
+                                    const IndexType * Aj,
+                                    const ValueType * Ax,
+                                    const ValueType * x,
+                                          ValueType * y)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType n = thread_id; n < num_rows * num_batches; n += grid_size)
+    {
+        const IndexType row  = n / num_batches;
+        const IndexType item = n - row * num_batches;
+
+        const ValueType * xb = x + item * num_cols;
+
+        ValueType sum = 0;
+
+        for(IndexType jj = Ap[row]; jj < Ap[row + 1]; jj++)
+            sum += Ax[jj * pitch + item] * xb[Aj[jj]];
+
+        y[item * num_rows + row] = sum;
+    }
+}
+
+template <typename Matrix, typename ValueType>
+void spmv_interleaved_batched_csr(const Matrix&    A,
+                                  const ValueType* x,
+                                        ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    if (A.num_rows == 0)
+        return;
+
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_interleaved_batched_csr_kernel<IndexType, ValueType>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+
+    spmv_interleaved_batched_csr_kernel<IndexType, ValueType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_batches),
+         IndexType(A.batch_num_rows()),
+         IndexType(A.batch_num_cols()),
+         IndexType(A.values.pitch),
+         thrust::raw_pointer_cast(&A.row_offsets[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values.values[0]),
+         x, y);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
@@ -0,0 +1,197 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/fixed_size.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/utils.h>
+#include <cusp/detail/device/texture.h>
+
+#include <thrust/device_ptr.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// BSR SpMV kernels (one thread per row)
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmv_bsr_kernel
+//   Row i = BLOCK_DIM * bi + r is computed by a single thread, which
+//   traverses the blocks of block row bi and accumulates row r of each
+//   block against the BLOCK_DIM entries of x selected by the block column.
+//   The threads of a block row read consecutive rows of the same
+//   (row-major) blocks, hence the loads of Ax are contiguous across the
+//   block row and each block column index is loaded once per block row.
+//
+//   BLOCK_DIM is a compile-time constant for the common block sizes (see
+//   dispatch_fixed_size) so that the row of a block is multiplied with
+//   fixed_dot, fully unrolled, and the index arithmetic reduces to shifts
+//   and multiplies by constants.  BLOCK_DIM == 0 selects the generic
+//   kernel where the block size is passed at run time.
+
+// x[j], read through the texture cache when UseCache is set
+template <bool UseCache, typename ValueType>
+struct bsr_fetch_x
+{
+    const ValueType * x;
+
+    __device__ bsr_fetch_x(const ValueType * x) : x(x) {}
+
+    template <typename IndexType>
+    __device__
+    ValueType operator[](const IndexType j) const
+    {
+        return fetch_x<UseCache>(j, x);
+    }
+};
+
+template <unsigned int BLOCK_DIM,
+          bool UseCache,
+          typename IndexType,
+          typename ValueType>
+__global__ void
+spmv_bsr_kernel(const IndexType num_rows,
+                const IndexType block_dim,
+                const IndexType * Ap,
+                const IndexType * Aj,
+                const ValueType * Ax,
+                const ValueType * x,
+                      ValueType * y)
+{
+    const IndexType bs = (BLOCK_DIM == 0) ? block_dim : IndexType(BLOCK_DIM);
+
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += grid_size)
+    {
+        const IndexType block_row = row / bs;
+        const IndexType r         = row % bs;
+
+        const IndexType row_start = Ap[block_row];
+        const IndexType row_end   = Ap[block_row + 1];
+
+        ValueType sum = 0;
+
+        for (IndexType kk = row_start; kk < row_end; kk++)
+        {
+            const IndexType   j     = Aj[kk] * bs;
+            const ValueType * block = Ax + kk * bs * bs + r * bs;
+
+            if (BLOCK_DIM == 0)
+            {
+                for (IndexType c = 0; c < bs; c++)
+                    sum += block[c] * fetch_x<UseCache>(j + c, x);
+            }
+            else
+            {
+                sum = cusp::detail::fixed_dot<BLOCK_DIM>::apply(block, bsr_fetch_x<UseCache,ValueType>(x), j, sum);
+            }
+        }
+
+        y[row] = sum;
+    }
+}
+
+template <unsigned int BLOCK_DIM,
+          bool UseCache,
+          typename Matrix,
+          typename ValueType>
+void __spmv_bsr_block(const Matrix&    A,
+                      const ValueType* x,
+                            ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_bsr_kernel<BLOCK_DIM, UseCache, IndexType, ValueType>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+
+    spmv_bsr_kernel<BLOCK_DIM, UseCache, IndexType, ValueType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows), IndexType(A.block_size),
+         thrust::raw_pointer_cast(&A.row_offsets[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         x, y);
+}
+
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType>
+struct spmv_bsr_launch
+{
+    const Matrix&    A;
+    const ValueType* x;
+          ValueType* y;
+
+    spmv_bsr_launch(const Matrix& A, const ValueType* x, ValueType* y)
+        : A(A), x(x), y(y) {}
+
+    template <int BLOCK_DIM>
+    void apply(void)
+    {
+        __spmv_bsr_block<BLOCK_DIM, UseCache>(A, x, y);
+    }
+};
+
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType>
+void __spmv_bsr(const Matrix&    A,
+                const ValueType* x,
+                      ValueType* y)
+{
+    if (A.num_rows == 0)
+        return;
+
+    // specialize the common block sizes (e.g. 3 and 5 for elasticity and
+    // compressible flow), other blocks use the generic kernel
+    spmv_bsr_launch<UseCache, Matrix, ValueType> launch(A, x, y);
+
+    cusp::detail::dispatch_fixed_size(A.block_size, launch);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_bsr(const Matrix&    A,
+              const ValueType* x,
+                    ValueType* y)
+{
+    __spmv_bsr<false>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_bsr_tex(const Matrix&    A,
+                  const ValueType* x,
+                        ValueType* y)
+{
+    __spmv_bsr<true>(A, x, y);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
@@ -19,10 +19,14 @@
 #include <thrust/extrema.h>
 
 #include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/atomic.h>
 #include <cusp/detail/device/common.h>
+#include <cusp/detail/device/graph.h>
 #include <cusp/detail/device/utils.h>
 #include <cusp/detail/device/texture.h>
+#include <cusp/detail/device/warp.h>
 #include <cusp/detail/device/spmv/coo_serial.h>
+#include <cusp/detail/storage_cast.h>
 
 #include <thrust/device_ptr.h>
 
@@ -81,7 +85,7 @@ __device__ void segreduce_block(const IndexType * idx, ValueType * val)
 //   sums.
 //
 // spmv_coo_flat_tex
-//   Same as spmv_coo_flat, except that the texture cache is 
+//   Same as spmv_coo_flat, except that the read-only data cache is 
 //   used for accessing the x vector.
 //
 
@@ -119,8 +123,8 @@ __device__ void segreduce_block(const IndexType * idx, ValueType * val)
 //     The row entry is stored in the shared memory array idx.
 //  2) Fetch the corresponding entry from the input vector.  Specifically, for a 
 //     nonzero entry (i,j) in the matrix, the thread must load the value x[j]
-//     from memory.  We use the function fetch_x to control whether the texture
-//     cache is used to load the value (UseCache == True) or whether a normal
+//     from memory.  We use the function fetch_x to control whether the read-only
+//     data cache is used to load the value (UseCache == True) or whether a normal
 //     global load is used (UseCache == False).
 //  3) The matrix value A(i,j) (which was stored in V[n]) is multiplied by the 
 //     value x[j] and stored in the shared memory array val.
@@ -158,36 +162,145 @@ __device__ void segreduce_block(const IndexType * idx, ValueType * val)
 //  The carry values at the end of each interval are written to arrays 
 //  temp_rows and temp_vals, which are processed by a second kernel.
 //
-template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE, bool UseCache>
+//  With AtomicCarries the second kernel is not needed.  Only the first and
+//  the last row of an interval may be shared with other warps, so the warp
+//  adds its carry out value to y with an atomic and updates the first row
+//  atomically when the previous interval ends in the same row.  All other
+//  rows are owned by a single warp and are updated as before.  The partial
+//  sums of a shared row are then added in no particular order.
+//
+//  On sm_30 and later the warp exchanges the row indices, partial sums and
+//  carry values with warp shuffles instead of the shared arrays idx, val
+//  and carry, which avoids relying on implicit warp synchronization.  Every
+//  interval is a multiple of 32 elements long, so all lanes of an active
+//  warp take part in each shuffle.  AtomicCarries is only honored by this
+//  version.
+//
+template <bool AtomicCarries>
+struct spmv_coo_row_update
+{
+    template <typename ValueType>
+    __device__ static void apply(ValueType * y, const ValueType value, const bool shared)
+    {
+        *y += value;
+    }
+};
+
+template <>
+struct spmv_coo_row_update<true>
+{
+    // rows shared with another interval are updated atomically
+    template <typename ValueType>
+    __device__ static void apply(ValueType * y, const ValueType value, const bool shared)
+    {
+        if (shared)
+            atomic_add(y, value);
+        else
+            *y += value;
+    }
+};
+
+template <typename IndexType, typename ValueType, typename StorageType, unsigned int BLOCK_SIZE, bool UseCache, bool AtomicCarries>
 __launch_bounds__(BLOCK_SIZE,1)
 __global__ void
 spmv_coo_flat_kernel(const IndexType num_nonzeros,
                      const IndexType interval_size,
                      const IndexType * I, 
                      const IndexType * J, 
-                     const ValueType * V, 
+                     const StorageType * V, 
                      const ValueType * x, 
                            ValueType * y,
                            IndexType * temp_rows,
                            ValueType * temp_vals)
 {
-    __shared__ volatile IndexType rows[48 *(BLOCK_SIZE/32)];
-    __shared__ volatile ValueType vals[BLOCK_SIZE];
-
     const IndexType thread_id   = BLOCK_SIZE * blockIdx.x + threadIdx.x;                         // global thread index
     const IndexType thread_lane = threadIdx.x & (WARP_SIZE-1);                                   // thread index within the warp
     const IndexType warp_id     = thread_id   / WARP_SIZE;                                       // global warp index
 
-    const IndexType interval_begin = warp_id * interval_size;                                    // warp's offset into I,J,V
-    const IndexType interval_end   = thrust::min(interval_begin + interval_size, num_nonzeros);  // end of warps's work
+#if __CUDA_ARCH__ >= 300
+    const unsigned int mask = segment_mask<WARP_SIZE>();
+
+    if(warp_id > (num_nonzeros - 1) / interval_size)                                            // warp has no work to do 
+        return;
+
+    const IndexType interval_begin  = warp_id * interval_size;                                   // warp's offset into I,J,V
+    const IndexType interval_length = thrust::min(interval_size, num_nonzeros - interval_begin); // size of warp's work
+
+    typedef spmv_coo_row_update<AtomicCarries> RowUpdate;
+
+    // the first row may continue the previous interval
+    const IndexType first_row = I[interval_begin];
+    const bool      shared    = AtomicCarries && interval_begin > 0 && I[interval_begin - 1] == first_row;
+
+    // every lane holds the carry in values
+    IndexType carry_row = first_row;
+    ValueType carry_val = ValueType(0);
+
+    for(IndexType n = thread_lane; n < interval_length; n += WARP_SIZE)
+    {
+        const IndexType k = interval_begin + n;                       // thread's index into I,J,V
+
+        IndexType row = I[k];                                         // row index (i)
+        ValueType val = storage_cast<ValueType>(V[k]) * fetch_x<UseCache>(J[k], x);            // A(i,j) * x(j)
+        
+        if (thread_lane == 0)
+        {
+            if(row == carry_row)
+                val += carry_val;                                     // row continues
+            else
+                RowUpdate::apply(y + carry_row, carry_val, shared && carry_row == first_row); // row terminated
+        }
+
+        // segmented scan of the partial sums
+#pragma unroll
+        for(int offset = 1; offset < WARP_SIZE; offset *= 2)
+        {
+            const IndexType left_row = shfl_up(mask, row, offset);
+            const ValueType left_val = shfl_up(mask, val, offset);
+
+            if(thread_lane >= IndexType(offset) && row == left_row)
+                val += left_val;
+        }
+
+        const IndexType next_row = shfl_down(mask, row, 1);
+
+        if(thread_lane < 31 && row != next_row)
+            RowUpdate::apply(y + row, val, shared && row == first_row); // row terminated
+
+        carry_row = shfl(mask, row, WARP_SIZE - 1);
+        carry_val = shfl(mask, val, WARP_SIZE - 1);
+    }
+
+    if(thread_lane == 31)
+    {
+        if (AtomicCarries)
+        {
+            // the next interval may continue the row
+            RowUpdate::apply(y + carry_row, carry_val, true);
+        }
+        else
+        {
+            // write the carry out values
+            temp_rows[warp_id] = carry_row;
+            temp_vals[warp_id] = carry_val;
+        }
+    }
+#else
+    __shared__ volatile IndexType rows[48 *(BLOCK_SIZE/32)];
+    __shared__ volatile ValueType vals[BLOCK_SIZE];
 
     const IndexType idx = 16 * (threadIdx.x/32 + 1) + threadIdx.x;                               // thread's index into padded rows array
 
     rows[idx - 16] = -1;                                                                         // fill padding with invalid row index
 
-    if(interval_begin >= interval_end)                                                           // warp has no work to do 
+    // test for idle warps before computing the interval, since warp_id * interval_size
+    // may overflow IndexType for warps beyond the last active warp
+    if(warp_id > (num_nonzeros - 1) / interval_size)                                            // warp has no work to do 
         return;
 
+    const IndexType interval_begin  = warp_id * interval_size;                                   // warp's offset into I,J,V
+    const IndexType interval_length = thrust::min(interval_size, num_nonzeros - interval_begin); // size of warp's work
+
     if (thread_lane == 31)
     {
         // initialize the carry in values
@@ -195,10 +308,14 @@ spmv_coo_flat_kernel(const IndexType num_nonzeros,
 	vals[threadIdx.x] = ValueType(0);
     }
   
-    for(IndexType n = interval_begin + thread_lane; n < interval_end; n += WARP_SIZE)
+    // iterate over offsets relative to interval_begin so that n + WARP_SIZE
+    // cannot overflow IndexType at the end of the last interval
+    for(IndexType n = thread_lane; n < interval_length; n += WARP_SIZE)
     {
-        IndexType row = I[n];                                         // row index (i)
-        ValueType val = V[n] * fetch_x<UseCache>(J[n], x);            // A(i,j) * x(j)
+        const IndexType k = interval_begin + n;                       // thread's index into I,J,V
+
+        IndexType row = I[k];                                         // row index (i)
+        ValueType val = storage_cast<ValueType>(V[k]) * fetch_x<UseCache>(J[k], x);            // A(i,j) * x(j)
         
         if (thread_lane == 0)
         {
@@ -227,6 +344,7 @@ spmv_coo_flat_kernel(const IndexType num_nonzeros,
         temp_rows[warp_id] = rows[idx];
         temp_vals[warp_id] = vals[threadIdx.x];
     }
+#endif
 }
 
 
@@ -292,6 +410,40 @@ spmv_coo_reduce_update_kernel(const IndexType num_warps,
 }
 
 
+// true when the single pass kernel, which needs shuffles and atomics, was
+// compiled for the device
+template <typename IndexType, typename ValueType, typename StorageType, bool UseCache>
+bool spmv_coo_flat_query_single_pass(void)
+{
+    cudaFuncAttributes attributes;
+
+    if (cudaFuncGetAttributes(&attributes, spmv_coo_flat_kernel<IndexType, ValueType, StorageType, 256, UseCache, true>) == cudaSuccess)
+        return attributes.ptxVersion >= 30;
+
+    cudaGetLastError();
+    return false;
+}
+
+template <typename IndexType, typename ValueType, typename StorageType, bool UseCache>
+bool spmv_coo_flat_single_pass_supported(void)
+{
+    static cusp::detail::once_value<bool> supported;
+
+    return cusp::detail::initialize_once(supported, spmv_coo_flat_query_single_pass<IndexType, ValueType, StorageType, UseCache>);
+}
+
+template <typename IndexType, typename ValueType, typename StorageType, bool UseCache>
+bool spmv_coo_flat_single_pass(thrust::detail::true_type)
+{
+    return spmv_coo_flat_single_pass_supported<IndexType, ValueType, StorageType, UseCache>();
+}
+
+template <typename IndexType, typename ValueType, typename StorageType, bool UseCache>
+bool spmv_coo_flat_single_pass(thrust::detail::false_type)
+{
+    return false;
+}
+
 template <bool UseCache,
           bool InitializeY,
           typename Matrix,
@@ -301,13 +453,14 @@ void __spmv_coo_flat(const Matrix&    A,
                            ValueType* y)
 {
     typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type StorageType;
 
-    const IndexType * I = thrust::raw_pointer_cast(&A.row_indices[0]);
-    const IndexType * J = thrust::raw_pointer_cast(&A.column_indices[0]);
-    const ValueType * V = thrust::raw_pointer_cast(&A.values[0]);
+    const IndexType   * I = thrust::raw_pointer_cast(&A.row_indices[0]);
+    const IndexType   * J = thrust::raw_pointer_cast(&A.column_indices[0]);
+    const StorageType * V = thrust::raw_pointer_cast(&A.values[0]);
 
     if (InitializeY)
-        thrust::fill(thrust::device_pointer_cast(y), thrust::device_pointer_cast(y) + A.num_rows, ValueType(0));
+        cudaMemsetAsync(y, 0, A.num_rows * sizeof(ValueType), cusp::detail::current_stream());
 
     if(A.num_entries == 0)
     {
@@ -317,44 +470,55 @@ void __spmv_coo_flat(const Matrix&    A,
     else if (A.num_entries < static_cast<size_t>(WARP_SIZE))
     {
         // small matrix
-        spmv_coo_serial_kernel<IndexType,ValueType> <<<1,1>>>
+        spmv_coo_serial_kernel<IndexType,ValueType,StorageType> <<<1, 1, 0, cusp::detail::current_stream()>>>
             (A.num_entries, I, J, V, x, y);
         return;
     }
 
+    // carries between the intervals are added atomically when the value type
+    // allows it, otherwise they are reduced by a second, single block kernel
+    const bool single_pass =
+        spmv_coo_flat_single_pass<IndexType, ValueType, StorageType, UseCache>(typename has_atomic_add<ValueType>::type());
+
     const unsigned int BLOCK_SIZE = 256;
-    const unsigned int MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_coo_flat_kernel<IndexType, ValueType, BLOCK_SIZE, UseCache>, BLOCK_SIZE, (size_t) 0);
+    const unsigned int MAX_BLOCKS = single_pass ?
+        cusp::detail::device::arch::max_active_blocks(spmv_coo_flat_kernel<IndexType, ValueType, StorageType, BLOCK_SIZE, UseCache, true>,  BLOCK_SIZE, (size_t) 0) :
+        cusp::detail::device::arch::max_active_blocks(spmv_coo_flat_kernel<IndexType, ValueType, StorageType, BLOCK_SIZE, UseCache, false>, BLOCK_SIZE, (size_t) 0);
     const unsigned int WARPS_PER_BLOCK = BLOCK_SIZE / WARP_SIZE;
 
-    const unsigned int num_units  = A.num_entries / WARP_SIZE; 
-    const unsigned int num_warps  = std::min(num_units, WARPS_PER_BLOCK * MAX_BLOCKS);
-    const unsigned int num_blocks = DIVIDE_INTO(num_warps, WARPS_PER_BLOCK);
-    const unsigned int num_iters  = DIVIDE_INTO(num_units, num_warps);
+    // the number of entries may exceed 2^32 for 64-bit IndexType, so the work
+    // decomposition is computed in size_t; only num_warps is bounded by the grid
+    const size_t num_units  = A.num_entries / WARP_SIZE; 
+    const size_t num_warps  = std::min<size_t>(num_units, WARPS_PER_BLOCK * MAX_BLOCKS);
+    const size_t num_blocks = DIVIDE_INTO(num_warps, WARPS_PER_BLOCK);
+    const size_t num_iters  = DIVIDE_INTO(num_units, num_warps);
     
-    const unsigned int interval_size = WARP_SIZE * num_iters;
+    const size_t interval_size = WARP_SIZE * num_iters;
 
-    const IndexType tail = num_units * WARP_SIZE; // do the last few nonzeros separately (fewer than WARP_SIZE elements)
+    const size_t tail = num_units * WARP_SIZE; // do the last few nonzeros separately (fewer than WARP_SIZE elements)
 
-    const unsigned int active_warps = (interval_size == 0) ? 0 : DIVIDE_INTO(tail, interval_size);
-
-    if (UseCache)
-        bind_x(x);
+    if (single_pass)
+    {
+        spmv_coo_flat_kernel<IndexType, ValueType, StorageType, BLOCK_SIZE, UseCache, true> <<<num_blocks, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+            (IndexType(tail), IndexType(interval_size), I, J, V, x, y, (IndexType *) 0, (ValueType *) 0);
+    }
+    else
+    {
+        const size_t active_warps = (interval_size == 0) ? 0 : DIVIDE_INTO(tail, interval_size);
 
-    cusp::array1d<IndexType,cusp::device_memory> temp_rows(active_warps);
-    cusp::array1d<ValueType,cusp::device_memory> temp_vals(active_warps);
+        cusp::detail::device::launch_buffer<IndexType> temp_rows(active_warps);
+        cusp::detail::device::launch_buffer<ValueType> temp_vals(active_warps);
 
-    spmv_coo_flat_kernel<IndexType, ValueType, BLOCK_SIZE, UseCache> <<<num_blocks, BLOCK_SIZE>>>
-        (tail, interval_size, I, J, V, x, y,
-         thrust::raw_pointer_cast(&temp_rows[0]), thrust::raw_pointer_cast(&temp_vals[0]));
+        spmv_coo_flat_kernel<IndexType, ValueType, StorageType, BLOCK_SIZE, UseCache, false> <<<num_blocks, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+            (IndexType(tail), IndexType(interval_size), I, J, V, x, y,
+             temp_rows.get(), temp_vals.get());
 
-    spmv_coo_reduce_update_kernel<IndexType, ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE>>>
-        (active_warps, thrust::raw_pointer_cast(&temp_rows[0]), thrust::raw_pointer_cast(&temp_vals[0]), y);
-    
-    spmv_coo_serial_kernel<IndexType,ValueType> <<<1,1>>>
-        (A.num_entries - tail, I + tail, J + tail, V + tail, x, y);
+        spmv_coo_reduce_update_kernel<IndexType, ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+            (IndexType(active_warps), temp_rows.get(), temp_vals.get(), y);
+    }
 
-    if (UseCache)
-        unbind_x(x);
+    spmv_coo_serial_kernel<IndexType,ValueType,StorageType> <<<1, 1, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_entries - tail), I + tail, J + tail, V + tail, x, y);
 }
 
 template <typename Matrix,
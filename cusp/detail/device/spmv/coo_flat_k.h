@@ -21,6 +21,7 @@
 #include <cusp/coo_matrix.h>
 #include <cusp/detail/device/arch.h>
 #include <cusp/detail/device/common.h>
+#include <cusp/detail/device/graph.h>
 #include <cusp/detail/device/utils.h>
 #include <cusp/detail/device/texture.h>
 #include <cusp/detail/device/spmv/coo_serial.h>
@@ -226,7 +227,7 @@ void __spmv_coo_flat_k(const coo_matrix<IndexType,ValueType,cusp::device_memory>
     const ValueType * V = thrust::raw_pointer_cast(&coo.values[0]);
 
     if (InitializeY)
-        thrust::fill(thrust::device_pointer_cast(d_y), thrust::device_pointer_cast(d_y) + coo.num_rows, ValueType(0));
+        cudaMemsetAsync(d_y, 0, coo.num_rows * sizeof(ValueType), cusp::detail::current_stream());
 
     if(coo.num_entries == 0)
     {
@@ -236,7 +237,7 @@ void __spmv_coo_flat_k(const coo_matrix<IndexType,ValueType,cusp::device_memory>
     else if (coo.num_entries < WARP_SIZE)
     {
         // small matrix
-        spmv_coo_serial_kernel<IndexType,ValueType> <<<1,1>>>
+        spmv_coo_serial_kernel<IndexType,ValueType,ValueType> <<<1, 1, 0, cusp::detail::current_stream()>>>
             (coo.num_entries, I, J, V, d_x, d_y);
         return;
     }
@@ -255,24 +256,18 @@ void __spmv_coo_flat_k(const coo_matrix<IndexType,ValueType,cusp::device_memory>
 
     const unsigned int interval_size = unit_size * num_iters;
 
-    if (UseCache)
-        bind_x(d_x);
+    cusp::detail::device::launch_buffer<IndexType> temp_rows(num_blocks);
+    cusp::detail::device::launch_buffer<ValueType> temp_vals(num_blocks);
 
-    cusp::array1d<IndexType,cusp::device_memory> temp_rows(num_blocks);
-    cusp::array1d<ValueType,cusp::device_memory> temp_vals(num_blocks);
-
-    spmv_coo_flat_k_kernel<CTA_SIZE,K,UseCache,IndexType,ValueType> <<<num_blocks,CTA_SIZE>>>
+    spmv_coo_flat_k_kernel<CTA_SIZE,K,UseCache,IndexType,ValueType> <<<num_blocks, CTA_SIZE, 0, cusp::detail::current_stream()>>>
         (N, interval_size, I, J, V, d_x, d_y,
-         thrust::raw_pointer_cast(&temp_rows[0]), thrust::raw_pointer_cast(&temp_vals[0]));
+         temp_rows.get(), temp_vals.get());
 
 //    spmv_coo_serial_kernel<IndexType,ValueType> <<<1,1>>>
 //        (coo.num_entries - tail, I + tail, J + tail, V + tail, d_x, d_y);
 
-    spmv_coo_reduce_update_kernel<IndexType, ValueType, 512> <<<1, 512>>>
-        (num_blocks, thrust::raw_pointer_cast(&temp_rows[0]), thrust::raw_pointer_cast(&temp_vals[0]), d_y);
-
-    if (UseCache)
-        unbind_x(d_x);
+    spmv_coo_reduce_update_kernel<IndexType, ValueType, 512> <<<1, 512, 0, cusp::detail::current_stream()>>>
+        (num_blocks, temp_rows.get(), temp_vals.get(), d_y);
 }
 
 template <typename IndexType, typename ValueType>
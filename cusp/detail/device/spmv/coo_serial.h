@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cusp/detail/storage_cast.h>
+
 #include <thrust/device_ptr.h>
 
 namespace cusp
@@ -30,18 +32,18 @@ namespace device
 // *extremely* small matrices, or a few elements at the end of a 
 // larger matrix
 
-template <typename IndexType, typename ValueType>
+template <typename IndexType, typename ValueType, typename StorageType>
 __global__ void
 spmv_coo_serial_kernel(const IndexType num_entries,
                        const IndexType * I, 
                        const IndexType * J, 
-                       const ValueType * V, 
+                       const StorageType * V, 
                        const ValueType * x, 
                              ValueType * y)
 {
     for(IndexType n = 0; n < num_entries; n++)
     {
-        y[I[n]] += V[n] * x[J[n]];
+        y[I[n]] += storage_cast<ValueType>(V[n]) * x[J[n]];
     }
 }
 
@@ -53,12 +55,13 @@ void spmv_coo_serial_device(const Matrix&    A,
                                   ValueType* y)
 {
     typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type StorageType;
 
-    const IndexType * I = thrust::raw_pointer_cast(&A.row_indices[0]);
-    const IndexType * J = thrust::raw_pointer_cast(&A.column_indices[0]);
-    const ValueType * V = thrust::raw_pointer_cast(&A.values[0]);
+    const IndexType   * I = thrust::raw_pointer_cast(&A.row_indices[0]);
+    const IndexType   * J = thrust::raw_pointer_cast(&A.column_indices[0]);
+    const StorageType * V = thrust::raw_pointer_cast(&A.values[0]);
 
-    spmv_coo_serial_kernel<IndexType,ValueType> <<<1,1>>>
+    spmv_coo_serial_kernel<IndexType,ValueType,StorageType> <<<1, 1, 0, cusp::detail::current_stream()>>>
         (A.num_entries, I, J, V, x, y);
 }
 
@@ -0,0 +1,170 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/utils.h>
+#include <cusp/detail/device/texture.h>
+#include <cusp/detail/device/spmv/coo_flat.h>
+
+#include <thrust/device_ptr.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// CSR16 SpMV kernel (one vector per row)
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmv_csr16_vector_kernel
+//   Same as spmv_csr_vector_kernel, except that the column index of an
+//   entry is the base column of the row plus a 16-bit offset, so half as
+//   many bytes of Aj are loaded per entry.  The entries of the overflow
+//   portion are added to y by the COO kernel afterwards, as for the HYB
+//   format.
+//
+//  Note: THREADS_PER_VECTOR must be one of [2,4,8,16,32]
+
+template <typename IndexType, typename OffsetType, typename ValueType, unsigned int VECTORS_PER_BLOCK, unsigned int THREADS_PER_VECTOR, bool UseCache>
+__launch_bounds__(VECTORS_PER_BLOCK * THREADS_PER_VECTOR,1)
+__global__ void
+spmv_csr16_vector_kernel(const IndexType num_rows,
+                         const IndexType  * Ap,
+                         const IndexType  * Ab,
+                         const OffsetType * Aj,
+                         const ValueType  * Ax,
+                         const ValueType  * x,
+                               ValueType  * y)
+{
+    __shared__ volatile ValueType sdata[VECTORS_PER_BLOCK * THREADS_PER_VECTOR + THREADS_PER_VECTOR / 2];  // padded to avoid reduction conditionals
+    __shared__ volatile IndexType ptrs[VECTORS_PER_BLOCK][2];
+
+    const IndexType THREADS_PER_BLOCK = VECTORS_PER_BLOCK * THREADS_PER_VECTOR;
+
+    const IndexType thread_id   = THREADS_PER_BLOCK * blockIdx.x + threadIdx.x;    // global thread index
+    const IndexType thread_lane = threadIdx.x & (THREADS_PER_VECTOR - 1);          // thread index within the vector
+    const IndexType vector_id   = thread_id   /  THREADS_PER_VECTOR;               // global vector index
+    const IndexType vector_lane = threadIdx.x /  THREADS_PER_VECTOR;               // vector index within the block
+    const IndexType num_vectors = VECTORS_PER_BLOCK * gridDim.x;                   // total number of active vectors
+
+    for(IndexType row = vector_id; row < num_rows; row += num_vectors)
+    {
+        // use two threads to fetch Ap[row] and Ap[row+1]
+        if(thread_lane < 2)
+            ptrs[vector_lane][thread_lane] = Ap[row + thread_lane];
+
+        const IndexType row_start = ptrs[vector_lane][0];
+        const IndexType row_end   = ptrs[vector_lane][1];
+        const IndexType row_base  = Ab[row];
+
+        // initialize local sum
+        ValueType sum = 0;
+
+        for(IndexType jj = row_start + thread_lane; jj < row_end; jj += THREADS_PER_VECTOR)
+            sum += Ax[jj] * fetch_x<UseCache>(row_base + IndexType(Aj[jj]), x);
+
+        // store local sum in shared memory
+        sdata[threadIdx.x] = sum;
+
+        // reduce local sums to row sum
+        if (THREADS_PER_VECTOR > 16) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x + 16];
+        if (THREADS_PER_VECTOR >  8) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  8];
+        if (THREADS_PER_VECTOR >  4) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  4];
+        if (THREADS_PER_VECTOR >  2) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  2];
+        if (THREADS_PER_VECTOR >  1) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  1];
+
+        // first thread writes the result
+        if (thread_lane == 0)
+            y[row] = sdata[threadIdx.x];
+    }
+}
+
+template <bool UseCache, unsigned int THREADS_PER_VECTOR, typename Matrix, typename ValueType>
+void __spmv_csr16_vector(const Matrix&    A,
+                         const ValueType* x,
+                               ValueType* y)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Matrix::offset_type OffsetType;
+
+    const size_t THREADS_PER_BLOCK  = 128;
+    const size_t VECTORS_PER_BLOCK  = THREADS_PER_BLOCK / THREADS_PER_VECTOR;
+
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_csr16_vector_kernel<IndexType, OffsetType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, UseCache>, THREADS_PER_BLOCK, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, VECTORS_PER_BLOCK));
+
+    spmv_csr16_vector_kernel<IndexType, OffsetType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, UseCache> <<<NUM_BLOCKS, THREADS_PER_BLOCK, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows),
+         thrust::raw_pointer_cast(&A.row_offsets[0]),
+         thrust::raw_pointer_cast(&A.row_bases[0]),
+         thrust::raw_pointer_cast(&A.column_offsets[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         x, y);
+}
+
+// THREADS_PER_VECTOR is selected from the mean row length as in
+// __spmv_csr_vector_adaptive.
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType>
+void __spmv_csr16(const Matrix&    A,
+                  const ValueType* x,
+                        ValueType* y)
+{
+    if (A.num_rows == 0)
+        return;
+
+    const double mean = double(A.num_compressed_entries()) / double(A.num_rows);
+
+    if      (mean <  3) __spmv_csr16_vector<UseCache, 2>(A, x, y);
+    else if (mean <  5) __spmv_csr16_vector<UseCache, 4>(A, x, y);
+    else if (mean <  9) __spmv_csr16_vector<UseCache, 8>(A, x, y);
+    else if (mean < 17) __spmv_csr16_vector<UseCache,16>(A, x, y);
+    else                __spmv_csr16_vector<UseCache,32>(A, x, y);
+
+    __spmv_coo_flat<UseCache, false>(A.overflow, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_csr16(const Matrix&    A,
+                const ValueType* x,
+                      ValueType* y)
+{
+    __spmv_csr16<false>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_csr16_tex(const Matrix&    A,
+                    const ValueType* x,
+                          ValueType* y)
+{
+    __spmv_csr16<true>(A, x, y);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
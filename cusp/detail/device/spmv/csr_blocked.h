@@ -0,0 +1,249 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/prefetch.h>
+
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/spmv/csr_vector.h>
+
+#include <thrust/binary_search.h>
+#include <thrust/detail/type_traits.h>
+
+#include <algorithm>
+#include <vector>
+
+// Product of a CSR matrix in managed memory that exceeds the memory of the
+// device.
+//
+// Multiplying such a matrix in one launch faults on every page of its
+// column indices and values, and the driver evicts pages in the order the
+// warps touch them.  Instead, the rows are split into blocks whose entries
+// occupy a fixed fraction of the device memory.  While the kernel of one
+// block runs on the current stream, the entries of the next block are
+// prefetched on a second stream, and the kernel of the next block waits
+// for its prefetch only.  The row offsets of a block view point into the
+// full column index and value arrays, so the blocks are multiplied in
+// place by the vector kernel.  Its width follows from the statistics of
+// the whole matrix, the merge-path kernel is not used since it requires
+// the offsets of a block to start at zero.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+// the epilogue of row (offset + row) of the full matrix, for the product
+// of a block of rows that starts at row offset
+template <typename Epilogue>
+struct spmv_block_epilogue
+{
+    Epilogue epilogue;
+    size_t   offset;
+
+    spmv_block_epilogue(Epilogue epilogue, const size_t offset)
+        : epilogue(epilogue), offset(offset) {}
+
+    template <typename IndexType, typename ValueType>
+    __host__ __device__
+    ValueType operator()(const IndexType row, const ValueType sum) const
+    {
+        return epilogue(IndexType(offset + row), sum);
+    }
+};
+
+// a non-blocking stream and an event, for the prefetches of the blocks
+class prefetch_pipeline
+{
+    public:
+    prefetch_pipeline(void)
+    {
+        check_cuda(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking), "cudaStreamCreateWithFlags failed");
+
+        if (cudaEventCreateWithFlags(&ready, cudaEventDisableTiming) != cudaSuccess)
+        {
+            cudaStreamDestroy(stream);
+            throw cusp::runtime_exception("cudaEventCreateWithFlags failed");
+        }
+    }
+
+    ~prefetch_pipeline(void)
+    {
+        cudaEventDestroy(ready);
+        cudaStreamDestroy(stream);
+    }
+
+    cudaStream_t stream;
+    cudaEvent_t  ready;
+
+    private:
+    // not copyable
+    prefetch_pipeline(const prefetch_pipeline&);
+    prefetch_pipeline& operator=(const prefetch_pipeline&);
+};
+
+template <typename Matrix>
+void prefetch_row_block(const Matrix& A, const size_t offset_begin, const size_t offset_end,
+                        const int device, cudaStream_t stream)
+{
+    typedef typename Matrix::column_indices_array_type::value_type IndexType;
+    typedef typename Matrix::values_array_type::value_type         StorageType;
+
+    if (offset_begin == offset_end)
+        return;
+
+    cusp::detail::prefetch_range(thrust::raw_pointer_cast(&A.column_indices[0]) + offset_begin,
+                                 (offset_end - offset_begin) * sizeof(IndexType), device, stream);
+    cusp::detail::prefetch_range(thrust::raw_pointer_cast(&A.values[0]) + offset_begin,
+                                 (offset_end - offset_begin) * sizeof(StorageType), device, stream);
+}
+
+template <bool UseCache, typename Matrix, typename ValueType, typename Semiring, typename Epilogue>
+void __spmv_csr_row_block(const Matrix&    A,
+                          const ValueType* x,
+                                ValueType* y,
+                          Semiring         semiring,
+                          Epilogue         epilogue,
+                          const double     mean)
+{
+    if (mean <   3) { __spmv_csr_vector<UseCache, 2>(A, x, y, semiring, epilogue); return; }
+    if (mean <   5) { __spmv_csr_vector<UseCache, 4>(A, x, y, semiring, epilogue); return; }
+    if (mean <   9) { __spmv_csr_vector<UseCache, 8>(A, x, y, semiring, epilogue); return; }
+    if (mean <  17) { __spmv_csr_vector<UseCache,16>(A, x, y, semiring, epilogue); return; }
+
+    __spmv_csr_vector<UseCache,32>(A, x, y, semiring, epilogue);
+}
+
+// y[i] <- epilogue(i, (A x)[i]) in blocks of rows with about
+// entries_per_block entries each
+template <typename Matrix, typename ValueType, typename Epilogue>
+void spmv_csr_row_blocks(const Matrix&    A,
+                         const ValueType* x,
+                               ValueType* y,
+                         Epilogue         epilogue,
+                         const size_t     entries_per_block)
+{
+    typedef typename Matrix::row_offsets_array_type::value_type OffsetType;
+
+    typedef cusp::array1d_view<typename Matrix::row_offsets_array_type::const_iterator>    RowOffsets;
+    typedef cusp::array1d_view<typename Matrix::column_indices_array_type::const_iterator> ColumnIndices;
+    typedef cusp::array1d_view<typename Matrix::values_array_type::const_iterator>         Values;
+
+    typedef cusp::csr_matrix_view<RowOffsets, ColumnIndices, Values> RowBlock;
+
+    if (A.num_rows == 0)
+        return;
+
+    const double mean = cusp::detail::get_row_statistics(A).mean;
+    const size_t block_entries = std::max<size_t>(entries_per_block, 1);
+
+    // the first row of each block, then A.num_rows
+    std::vector<size_t> rows(1, 0);
+    std::vector<size_t> offsets(1, size_t(A.row_offsets[0]));
+
+    while (rows.back() < A.num_rows)
+    {
+        // the last row that starts at most block_entries after the block
+        const OffsetType target = OffsetType(offsets.back() + block_entries);
+        size_t row = thrust::upper_bound(A.row_offsets.begin() + rows.back() + 1,
+                                         A.row_offsets.begin() + A.num_rows + 1,
+                                         target) - A.row_offsets.begin() - 1;
+
+        // a block holds at least one row, however long
+        row = std::min<size_t>(std::max<size_t>(row, rows.back() + 1), A.num_rows);
+
+        rows.push_back(row);
+        offsets.push_back(size_t(A.row_offsets[row]));
+    }
+
+    int device = 0;
+    check_cuda(cudaGetDevice(&device), "cudaGetDevice failed");
+
+    cudaStream_t stream = cusp::detail::current_stream();
+    prefetch_pipeline pipeline;
+
+    prefetch_row_block(A, offsets[0], offsets[1], device, stream);
+
+    for (size_t i = 0; i + 1 < rows.size(); i++)
+    {
+        if (i + 2 < rows.size())
+        {
+            prefetch_row_block(A, offsets[i + 1], offsets[i + 2], device, pipeline.stream);
+            check_cuda(cudaEventRecord(pipeline.ready, pipeline.stream), "cudaEventRecord failed");
+        }
+
+        RowBlock block(rows[i + 1] - rows[i], A.num_cols, offsets[i + 1] - offsets[i],
+                       RowOffsets(A.row_offsets.begin() + rows[i], A.row_offsets.begin() + rows[i + 1] + 1),
+                       ColumnIndices(A.column_indices.begin(), A.column_indices.end()),
+                       Values(A.values.begin(), A.values.end()));
+
+        __spmv_csr_row_block<false>(block, x, y + rows[i], spmv_plus_times<ValueType>(),
+                                    spmv_block_epilogue<Epilogue>(epilogue, rows[i]), mean);
+
+        // the next block waits for its own prefetch
+        if (i + 2 < rows.size())
+            check_cuda(cudaStreamWaitEvent(stream, pipeline.ready, 0), "cudaStreamWaitEvent failed");
+    }
+}
+
+// Multiply A in blocks of rows if it is a managed container that does not
+// fit into the memory of the device, returns false otherwise.
+template <typename Matrix, typename ValueType, typename Epilogue>
+bool spmv_csr_oversubscribed(const Matrix&    A,
+                             const ValueType* x,
+                                   ValueType* y,
+                             Epilogue         epilogue,
+                             thrust::detail::true_type)
+{
+    typedef typename Matrix::column_indices_array_type::value_type IndexType;
+    typedef typename Matrix::values_array_type::value_type         StorageType;
+
+    if (cusp::detail::fits_device_memory(A))
+        return false;
+
+    // two blocks in flight take an eighth of the device memory each
+    const size_t capacity = cusp::detail::device::arch::current_device_info().total_global_memory;
+
+    spmv_csr_row_blocks(A, x, y, epilogue, capacity / 8 / (sizeof(IndexType) + sizeof(StorageType)));
+
+    return true;
+}
+
+template <typename Matrix, typename ValueType, typename Epilogue>
+bool spmv_csr_oversubscribed(const Matrix&, const ValueType*, ValueType*, Epilogue, thrust::detail::false_type)
+{
+    return false;
+}
+
+template <typename Matrix, typename ValueType, typename Epilogue>
+bool spmv_csr_oversubscribed(const Matrix&    A,
+                             const ValueType* x,
+                                   ValueType* y,
+                             Epilogue         epilogue)
+{
+    return spmv_csr_oversubscribed(A, x, y, epilogue, typename cusp::detail::is_managed<Matrix>::type());
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
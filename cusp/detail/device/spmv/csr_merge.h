@@ -0,0 +1,241 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <thrust/extrema.h>
+
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/graph.h>
+#include <cusp/detail/device/utils.h>
+#include <cusp/detail/device/texture.h>
+#include <cusp/detail/device/spmv/coo_flat.h>
+#include <cusp/detail/storage_cast.h>
+
+#include <thrust/device_ptr.h>
+
+#include <limits>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// CSR SpMV kernels based on a merge-path decomposition
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmv_csr_merge
+//   The CSR matrix is viewed as a merge of two sorted lists: the row end
+//   offsets (Ap[1], ..., Ap[num_rows]) and the natural numbers indexing the
+//   nonzeros (0, 1, ..., num_entries - 1).  Consuming an item from the first
+//   list terminates the current row and consuming an item from the second
+//   list accumulates one nonzero into the current row.  The merge path has
+//   num_rows + num_entries items in total and is divided into equal-sized
+//   intervals, one per thread, regardless of how the nonzeros are
+//   distributed among the rows.  Unlike spmv_csr_vector, a row with 200k
+//   nonzeros is therefore processed by many threads while a run of empty
+//   rows costs no more than a single nonzero each.
+//
+//   Each thread locates the start of its interval with a binary search
+//   along the diagonal of the merge grid (merge_path_search), consumes its
+//   items sequentially and writes y[i] for every row it terminates.  The
+//   partial sum of the last (unterminated) row of each interval is written
+//   to a carry array which is subsequently folded into y by the second level
+//   of the COO segmented reduction (spmv_coo_reduce_update_kernel).
+//
+// spmv_csr_merge_tex
+//   Same as spmv_csr_merge, except that the read-only data cache is
+//   used for accessing the x vector.
+//
+
+// find the coordinate (row, nz) where diagonal 'diagonal' crosses the merge path
+template <typename PathType, typename OffsetType>
+__device__ void merge_path_search(const PathType diagonal,
+                                  const PathType num_rows,
+                                  const PathType num_entries,
+                                  const OffsetType * row_end_offsets,
+                                        PathType& row,
+                                        PathType& nz)
+{
+    PathType lo = thrust::max(diagonal - num_entries, PathType(0));
+    PathType hi = thrust::min(diagonal, num_rows);
+
+    while (lo < hi)
+    {
+        PathType mid = (lo + hi) >> 1;
+
+        if (PathType(row_end_offsets[mid]) <= diagonal - mid - 1)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    row = lo;
+    nz  = diagonal - lo;
+}
+
+// PathType holds coordinates along the merge path, which has num_rows + num_entries
+// items and so may not be representable by either the OffsetType of the row
+// offsets or the IndexType of the column indices
+template <typename PathType, typename OffsetType, typename IndexType, typename ValueType, typename StorageType, unsigned int BLOCK_SIZE, bool UseCache>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+spmv_csr_merge_kernel(const PathType num_rows,
+                      const PathType num_entries,
+                      const PathType items_per_thread,
+                      const PathType num_threads,
+                      const OffsetType * Ap,
+                      const IndexType  * Aj,
+                      const StorageType* Ax,
+                      const ValueType  * x,
+                            ValueType  * y,
+                            IndexType  * carry_rows,
+                            ValueType  * carry_vals)
+{
+    const PathType thread_id = BLOCK_SIZE * blockIdx.x + threadIdx.x;    // global thread index
+
+    if (thread_id >= num_threads)
+        return;
+
+    const OffsetType * row_end_offsets = Ap + 1;
+    const PathType     num_items       = num_rows + num_entries;
+
+    const PathType diagonal_begin = thrust::min(items_per_thread * thread_id, num_items);
+    const PathType diagonal_end   = thrust::min(items_per_thread, num_items - diagonal_begin) + diagonal_begin;
+
+    PathType row, nz, row_end, nz_end;
+    merge_path_search(diagonal_begin, num_rows, num_entries, row_end_offsets, row,     nz);
+    merge_path_search(diagonal_end,   num_rows, num_entries, row_end_offsets, row_end, nz_end);
+
+    ValueType sum = 0;
+
+    // consume every row that terminates inside this interval
+    for (; row < row_end; row++)
+    {
+        const PathType row_stop = row_end_offsets[row];
+
+        for (; nz < row_stop; nz++)
+            sum += storage_cast<ValueType>(Ax[nz]) * fetch_x<UseCache>(Aj[nz], x);
+
+        y[row] = sum;
+        sum    = 0;
+    }
+
+    // consume the leading nonzeros of the row that continues past this interval
+    for (; nz < nz_end; nz++)
+        sum += storage_cast<ValueType>(Ax[nz]) * fetch_x<UseCache>(Aj[nz], x);
+
+    // an interval ending at the end of the merge path carries nothing, but
+    // the segmented reduction still requires a valid row index
+    carry_rows[thread_id] = IndexType(thrust::min(row_end, num_rows - 1));
+    carry_vals[thread_id] = sum;
+}
+
+
+template <bool UseCache,
+          typename PathType,
+          typename Matrix,
+          typename ValueType>
+void __spmv_csr_merge_path(const Matrix&    A,
+                           const ValueType* x,
+                                 ValueType* y)
+{
+    typedef typename Matrix::row_offsets_array_type::value_type    OffsetType;
+    typedef typename Matrix::column_indices_array_type::value_type IndexType;
+    typedef typename Matrix::value_type                            StorageType;
+
+    const unsigned int BLOCK_SIZE       = 256;
+    const unsigned int ITEMS_PER_THREAD = 7;   // minimum length of each interval
+    const unsigned int MAX_BLOCKS       = cusp::detail::device::arch::max_active_blocks(spmv_csr_merge_kernel<PathType, OffsetType, IndexType, ValueType, StorageType, BLOCK_SIZE, UseCache>, BLOCK_SIZE, (size_t) 0);
+
+    const PathType num_items = PathType(A.num_rows) + PathType(A.num_entries);
+
+    // use as few intervals as are needed to fill the device: this bounds
+    // the number of carries and, hence, the cost of the second level
+    const PathType max_threads      = MAX_BLOCKS * BLOCK_SIZE;
+    const PathType items_per_thread = std::max<PathType>(ITEMS_PER_THREAD, num_items / max_threads + (num_items % max_threads != 0));
+    const PathType num_threads      = num_items / items_per_thread + (num_items % items_per_thread != 0);
+    const unsigned int num_blocks   = DIVIDE_INTO(num_threads, BLOCK_SIZE);
+
+    cusp::detail::device::launch_buffer<IndexType> carry_rows(num_threads);
+    cusp::detail::device::launch_buffer<ValueType> carry_vals(num_threads);
+
+    spmv_csr_merge_kernel<PathType, OffsetType, IndexType, ValueType, StorageType, BLOCK_SIZE, UseCache> <<<num_blocks, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (PathType(A.num_rows), PathType(A.num_entries),
+         items_per_thread, num_threads,
+         thrust::raw_pointer_cast(&A.row_offsets[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         x, y,
+         carry_rows.get(), carry_vals.get());
+
+    spmv_coo_reduce_update_kernel<IndexType, ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(num_threads), carry_rows.get(), carry_vals.get(), y);
+}
+
+// The merge path is indexed with the type of the row offsets unless
+// num_rows + num_entries (plus the slack of the last interval) is not
+// representable, in which case 64-bit coordinates are used.
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType>
+void __spmv_csr_merge(const Matrix&    A,
+                      const ValueType* x,
+                            ValueType* y)
+{
+    typedef typename Matrix::row_offsets_array_type::value_type OffsetType;
+
+    if (A.num_rows == 0)
+    {
+        // empty matrix
+        return;
+    }
+
+    const double num_items = double(A.num_rows) + double(A.num_entries);
+
+    if (num_items + 1024 < double(std::numeric_limits<OffsetType>::max()))
+        __spmv_csr_merge_path<UseCache, OffsetType>(A, x, y);
+    else
+        __spmv_csr_merge_path<UseCache, long long>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_csr_merge(const Matrix&    A,
+                    const ValueType* x,
+                          ValueType* y)
+{
+    __spmv_csr_merge<false>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_csr_merge_tex(const Matrix&    A,
+                        const ValueType* x,
+                              ValueType* y)
+{
+    __spmv_csr_merge<true>(A, x, y);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
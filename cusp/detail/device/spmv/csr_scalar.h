@@ -39,31 +39,32 @@ namespace device
 //   (the dot product of the i-th row of A with the x vector)
 //
 // spmv_csr_scalar_tex_device
-//   Same as spmv_csr_scalar_device, except x is accessed via texture cache.
+//   Same as spmv_csr_scalar_device, except x is accessed via the read-only data cache.
 //
 
 template <bool UseCache,
+          typename OffsetType,
           typename IndexType,
           typename ValueType>
 __global__ void
 spmv_csr_scalar_kernel(const IndexType num_rows,
-                       const IndexType * Ap, 
-                       const IndexType * Aj, 
-                       const ValueType * Ax, 
-                       const ValueType * x, 
-                             ValueType * y)
+                       const OffsetType * Ap, 
+                       const IndexType  * Aj, 
+                       const ValueType  * Ax, 
+                       const ValueType  * x, 
+                             ValueType  * y)
 {
     const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
     const IndexType grid_size = gridDim.x * blockDim.x;
 
     for(IndexType row = thread_id; row < num_rows; row += grid_size)
     {
-        const IndexType row_start = Ap[row];
-        const IndexType row_end   = Ap[row+1];
+        const OffsetType row_start = Ap[row];
+        const OffsetType row_end   = Ap[row+1];
         
         ValueType sum = 0;
     
-        for (IndexType jj = row_start; jj < row_end; jj++)
+        for (OffsetType jj = row_start; jj < row_end; jj++)
             sum += Ax[jj] * fetch_x<UseCache>(Aj[jj], x);       
 
         y[row] = sum;
@@ -78,24 +79,19 @@ void __spmv_csr_scalar(const Matrix&    A,
                        const ValueType* x, 
                              ValueType* y)
 {
-    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::row_offsets_array_type::value_type    OffsetType;
+    typedef typename Matrix::column_indices_array_type::value_type IndexType;
 
-    const size_t BLOCK_SIZE = 256;
-    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_csr_scalar_kernel<UseCache, IndexType, ValueType>, BLOCK_SIZE, (size_t) 0);
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_csr_scalar_kernel<UseCache, OffsetType, IndexType, ValueType>, BLOCK_SIZE, (size_t) 0);
     const size_t NUM_BLOCKS = std::min(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
     
-    if (UseCache)
-        bind_x(x);
-
-    spmv_csr_scalar_kernel<UseCache,IndexType,ValueType> <<<NUM_BLOCKS, BLOCK_SIZE>>> 
-        (A.num_rows,
+    spmv_csr_scalar_kernel<UseCache,OffsetType,IndexType,ValueType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>> 
+        (IndexType(A.num_rows),
          thrust::raw_pointer_cast(&A.row_offsets[0]),
          thrust::raw_pointer_cast(&A.column_indices[0]),
          thrust::raw_pointer_cast(&A.values[0]),
          x, y);
-
-    if (UseCache)
-        unbind_x(x);
 }
 
 template <typename Matrix,
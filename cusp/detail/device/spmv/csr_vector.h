@@ -17,10 +17,19 @@
 
 #pragma once
 
+#include <cusp/array1d.h>
+
 #include <cusp/detail/device/arch.h>
 #include <cusp/detail/device/common.h>
+#include <cusp/detail/device/graph.h>
 #include <cusp/detail/device/utils.h>
 #include <cusp/detail/device/texture.h>
+#include <cusp/detail/device/warp.h>
+#include <cusp/detail/device/spmv/csr_merge.h>
+#include <cusp/detail/device/spmv/epilogue.h>
+#include <cusp/detail/device/spmv/semiring.h>
+#include <cusp/detail/row_statistics.h>
+#include <cusp/detail/storage_cast.h>
 
 #include <thrust/device_ptr.h>
 
@@ -44,28 +53,48 @@ namespace device
 //   coalesced, unlike kernels based on the one-row-per-thread division of 
 //   work.  Since an entire 32-thread warp is assigned to each row, many 
 //   threads will remain idle when their row contains a small number 
-//   of elements.  This code relies on implicit synchronization among 
-//   threads in a warp.
+//   of elements.  The threads of a vector exchange the row offsets and
+//   reduce their partial sums with warp shuffles, on targets prior to
+//   sm_30 through shared memory with implicit synchronization among the
+//   threads of a warp.
 //
 // spmv_csr_vector_tex_device
-//   Same as spmv_csr_vector_tex_device, except that the texture cache is 
+//   Same as spmv_csr_vector_tex_device, except that the read-only data cache is 
 //   used for accessing the x vector.
 //  
 //  Note: THREADS_PER_VECTOR must be one of [2,4,8,16,32]
+//
+//  Note: the row offsets (OffsetType) may be wider than the column indices
+//  (IndexType), e.g. 64-bit offsets for matrices with more than 2^31
+//  nonzeros while the columns remain 32-bit.
+//
+//  Note: the entries are combined and reduced with a semiring (see
+//  semiring.h), and the row sum is passed through an epilogue (see
+//  epilogue.h) before it is stored, which fuses y = alpha*A*x + beta*z
+//  or the generalized z = reduce(y, A*x) into the kernel.
+//
+//  Note: the values of A (StorageType) may be narrower than the vectors
+//  (ValueType), see storage_cast.h.
 
 
-template <typename IndexType, typename ValueType, unsigned int VECTORS_PER_BLOCK, unsigned int THREADS_PER_VECTOR, bool UseCache>
+template <typename OffsetType, typename IndexType, typename ValueType, typename StorageType, unsigned int VECTORS_PER_BLOCK, unsigned int THREADS_PER_VECTOR, bool UseCache, typename Semiring, typename Epilogue>
 __launch_bounds__(VECTORS_PER_BLOCK * THREADS_PER_VECTOR,1)
 __global__ void
 spmv_csr_vector_kernel(const IndexType num_rows,
-                       const IndexType * Ap, 
-                       const IndexType * Aj, 
-                       const ValueType * Ax, 
-                       const ValueType * x, 
-                             ValueType * y)
+                       const OffsetType * Ap, 
+                       const IndexType  * Aj, 
+                       const StorageType* Ax, 
+                       const ValueType  * x, 
+                             ValueType  * y,
+                       Semiring semiring,
+                       Epilogue epilogue)
 {
-    __shared__ volatile ValueType sdata[VECTORS_PER_BLOCK * THREADS_PER_VECTOR + THREADS_PER_VECTOR / 2];  // padded to avoid reduction conditionals
-    __shared__ volatile IndexType ptrs[VECTORS_PER_BLOCK][2];
+#if __CUDA_ARCH__ >= 300
+    const unsigned int mask = segment_mask<THREADS_PER_VECTOR>();                 // lanes of this vector
+#else
+    __shared__ volatile ValueType  sdata[VECTORS_PER_BLOCK * THREADS_PER_VECTOR + THREADS_PER_VECTOR / 2];  // padded to avoid reduction conditionals
+    __shared__ volatile OffsetType ptrs[VECTORS_PER_BLOCK][2];
+#endif
     
     const IndexType THREADS_PER_BLOCK = VECTORS_PER_BLOCK * THREADS_PER_VECTOR;
 
@@ -79,77 +108,177 @@ spmv_csr_vector_kernel(const IndexType num_rows,
     {
         // use two threads to fetch Ap[row] and Ap[row+1]
         // this is considerably faster than the straightforward version
+#if __CUDA_ARCH__ >= 300
+        OffsetType ptr = 0;
+        if(thread_lane < 2)
+            ptr = Ap[row + thread_lane];
+
+        const OffsetType row_start = shfl(mask, ptr, 0, THREADS_PER_VECTOR);  //same as: row_start = Ap[row];
+        const OffsetType row_end   = shfl(mask, ptr, 1, THREADS_PER_VECTOR);  //same as: row_end   = Ap[row+1];
+#else
         if(thread_lane < 2)
             ptrs[vector_lane][thread_lane] = Ap[row + thread_lane];
 
-        const IndexType row_start = ptrs[vector_lane][0];                   //same as: row_start = Ap[row];
-        const IndexType row_end   = ptrs[vector_lane][1];                   //same as: row_end   = Ap[row+1];
+        const OffsetType row_start = ptrs[vector_lane][0];                  //same as: row_start = Ap[row];
+        const OffsetType row_end   = ptrs[vector_lane][1];                  //same as: row_end   = Ap[row+1];
+#endif
 
         // initialize local sum
-        ValueType sum = 0;
+        ValueType sum = semiring.identity;
      
         if (THREADS_PER_VECTOR == 32 && row_end - row_start > 32)
         {
             // ensure aligned memory access to Aj and Ax
 
-            IndexType jj = row_start - (row_start & (THREADS_PER_VECTOR - 1)) + thread_lane;
+            OffsetType jj = row_start - (row_start & (THREADS_PER_VECTOR - 1)) + thread_lane;
 
             // accumulate local sums
             if(jj >= row_start && jj < row_end)
-                sum += Ax[jj] * fetch_x<UseCache>(Aj[jj], x);
+                sum = semiring.reduce(sum, semiring.combine(storage_cast<ValueType>(Ax[jj]), fetch_x<UseCache>(Aj[jj], x)));
 
             // accumulate local sums
             for(jj += THREADS_PER_VECTOR; jj < row_end; jj += THREADS_PER_VECTOR)
-                sum += Ax[jj] * fetch_x<UseCache>(Aj[jj], x);
+                sum = semiring.reduce(sum, semiring.combine(storage_cast<ValueType>(Ax[jj]), fetch_x<UseCache>(Aj[jj], x)));
         }
         else
         {
             // accumulate local sums
-            for(IndexType jj = row_start + thread_lane; jj < row_end; jj += THREADS_PER_VECTOR)
-                sum += Ax[jj] * fetch_x<UseCache>(Aj[jj], x);
+            for(OffsetType jj = row_start + thread_lane; jj < row_end; jj += THREADS_PER_VECTOR)
+                sum = semiring.reduce(sum, semiring.combine(storage_cast<ValueType>(Ax[jj]), fetch_x<UseCache>(Aj[jj], x)));
         }
 
+#if __CUDA_ARCH__ >= 300
+        // reduce local sums to row sum
+#pragma unroll
+        for (unsigned int offset = THREADS_PER_VECTOR / 2; offset > 0; offset /= 2)
+            sum = semiring.reduce(sum, shfl_down(mask, sum, offset, THREADS_PER_VECTOR));
+
+        // first thread writes the result
+        if (thread_lane == 0)
+            y[row] = epilogue(row, sum);
+#else
         // store local sum in shared memory
         sdata[threadIdx.x] = sum;
         
         // reduce local sums to row sum
-        if (THREADS_PER_VECTOR > 16) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x + 16];
-        if (THREADS_PER_VECTOR >  8) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  8];
-        if (THREADS_PER_VECTOR >  4) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  4];
-        if (THREADS_PER_VECTOR >  2) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  2];
-        if (THREADS_PER_VECTOR >  1) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  1];
+        if (THREADS_PER_VECTOR > 16) sdata[threadIdx.x] = sum = semiring.reduce(sum, ValueType(sdata[threadIdx.x + 16]));
+        if (THREADS_PER_VECTOR >  8) sdata[threadIdx.x] = sum = semiring.reduce(sum, ValueType(sdata[threadIdx.x +  8]));
+        if (THREADS_PER_VECTOR >  4) sdata[threadIdx.x] = sum = semiring.reduce(sum, ValueType(sdata[threadIdx.x +  4]));
+        if (THREADS_PER_VECTOR >  2) sdata[threadIdx.x] = sum = semiring.reduce(sum, ValueType(sdata[threadIdx.x +  2]));
+        if (THREADS_PER_VECTOR >  1) sdata[threadIdx.x] = sum = semiring.reduce(sum, ValueType(sdata[threadIdx.x +  1]));
        
         // first thread writes the result
         if (thread_lane == 0)
-            y[row] = sdata[threadIdx.x];
+            y[row] = epilogue(row, ValueType(sdata[threadIdx.x]));
+#endif
     }
 }
 
-template <bool UseCache, unsigned int THREADS_PER_VECTOR, typename Matrix, typename ValueType>
+template <bool UseCache, unsigned int THREADS_PER_VECTOR, typename Matrix, typename ValueType, typename Semiring, typename Epilogue>
 void __spmv_csr_vector(const Matrix&    A, 
                        const ValueType* x, 
-                             ValueType* y)
+                             ValueType* y,
+                       Semiring         semiring,
+                       Epilogue         epilogue)
 {
-    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::row_offsets_array_type::value_type    OffsetType;
+    typedef typename Matrix::column_indices_array_type::value_type IndexType;
+    typedef typename Matrix::value_type                            StorageType;
 
     const size_t THREADS_PER_BLOCK  = 128;
     const size_t VECTORS_PER_BLOCK  = THREADS_PER_BLOCK / THREADS_PER_VECTOR;
 
-    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_csr_vector_kernel<IndexType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, UseCache>, THREADS_PER_BLOCK, (size_t) 0);
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_csr_vector_kernel<OffsetType, IndexType, ValueType, StorageType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, UseCache, Semiring, Epilogue>, THREADS_PER_BLOCK, (size_t) 0);
     const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, VECTORS_PER_BLOCK));
     
-    if (UseCache)
-        bind_x(x);
-
-    spmv_csr_vector_kernel<IndexType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, UseCache> <<<NUM_BLOCKS, THREADS_PER_BLOCK>>> 
-        (A.num_rows,
+    spmv_csr_vector_kernel<OffsetType, IndexType, ValueType, StorageType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, UseCache, Semiring, Epilogue> <<<NUM_BLOCKS, THREADS_PER_BLOCK, 0, cusp::detail::current_stream()>>> 
+        (IndexType(A.num_rows),
          thrust::raw_pointer_cast(&A.row_offsets[0]),
          thrust::raw_pointer_cast(&A.column_indices[0]),
          thrust::raw_pointer_cast(&A.values[0]),
-         x, y);
+         x, y, semiring, epilogue);
+}
+
+// The merge-path kernel combines the sums of rows that span several
+// blocks in a second pass, so an epilogue other than the store is
+// applied to its result afterwards.  It computes the numeric product
+// only, and other semirings use the widest vectors instead.
+template <bool UseCache, typename Matrix, typename ValueType>
+void __spmv_csr_merge(const Matrix&    A, 
+                      const ValueType* x, 
+                            ValueType* y,
+                      spmv_plus_times<ValueType>,
+                      spmv_store<ValueType>)
+{
+    __spmv_csr_merge<UseCache>(A, x, y);
+}
+
+template <bool UseCache, typename Matrix, typename ValueType, typename Semiring, typename Epilogue>
+void __spmv_csr_merge(const Matrix&    A, 
+                      const ValueType* x, 
+                            ValueType* y,
+                      Semiring         semiring,
+                      Epilogue         epilogue)
+{
+    __spmv_csr_vector<UseCache,32>(A, x, y, semiring, epilogue);
+}
+
+template <bool UseCache, typename Matrix, typename ValueType, typename Epilogue>
+void __spmv_csr_merge(const Matrix&    A, 
+                      const ValueType* x, 
+                            ValueType* y,
+                      spmv_plus_times<ValueType>,
+                      Epilogue         epilogue)
+{
+    cusp::detail::device::launch_buffer<ValueType> temp(A.num_rows);
+
+    __spmv_csr_merge<UseCache>(A, x, temp.get());
+
+    spmv_apply_epilogue(A.num_rows, temp.get(), y, epilogue);
+}
+
+// Select THREADS_PER_VECTOR from the (cached) distribution of row lengths.
+//
+// The vector width is the smallest power of two in [2,32] that is not less
+// than the (truncated) mean row length, so that few threads in a vector
+// idle on short rows.
+// When the row lengths are highly irregular (a few very long rows among
+// many short ones) no single width is appropriate and the load-balanced
+// merge-path kernel is used instead.
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void __spmv_csr_vector_adaptive(const Matrix&    A, 
+                                const ValueType* x, 
+                                      ValueType* y,
+                                Semiring         semiring,
+                                Epilogue         epilogue)
+{
+    if (A.num_rows == 0)
+    {
+        // empty matrix
+        return;
+    }
 
-    if (UseCache)
-        unbind_x(x);
+    const cusp::detail::row_statistics& stats = cusp::detail::get_row_statistics(A);
+
+    const double mean   = stats.mean;
+    const double stddev = stats.standard_deviation();
+
+    if (stats.max_length > 1024 && stddev > 4 * std::max(mean, 1.0))
+    {
+        __spmv_csr_merge<UseCache>(A, x, y, semiring, epilogue);
+        return;
+    }
+
+    if (mean <   3) { __spmv_csr_vector<UseCache, 2>(A, x, y, semiring, epilogue); return; }
+    if (mean <   5) { __spmv_csr_vector<UseCache, 4>(A, x, y, semiring, epilogue); return; }
+    if (mean <   9) { __spmv_csr_vector<UseCache, 8>(A, x, y, semiring, epilogue); return; }
+    if (mean <  17) { __spmv_csr_vector<UseCache,16>(A, x, y, semiring, epilogue); return; }
+
+    __spmv_csr_vector<UseCache,32>(A, x, y, semiring, epilogue);
 }
 
 template <typename Matrix,
@@ -158,16 +287,31 @@ void spmv_csr_vector(const Matrix&    A,
                      const ValueType* x, 
                            ValueType* y)
 {
-    typedef typename Matrix::index_type IndexType;
+    __spmv_csr_vector_adaptive<false>(A, x, y, spmv_plus_times<ValueType>(), spmv_store<ValueType>());
+}
 
-    const IndexType nnz_per_row = A.num_entries / A.num_rows;
+template <typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void spmv_csr_vector(const Matrix&    A, 
+                     const ValueType* x, 
+                           ValueType* y,
+                     Epilogue         epilogue)
+{
+    __spmv_csr_vector_adaptive<false>(A, x, y, spmv_plus_times<ValueType>(), epilogue);
+}
 
-    if (nnz_per_row <=  2) { __spmv_csr_vector<false, 2>(A, x, y); return; }
-    if (nnz_per_row <=  4) { __spmv_csr_vector<false, 4>(A, x, y); return; }
-    if (nnz_per_row <=  8) { __spmv_csr_vector<false, 8>(A, x, y); return; }
-    if (nnz_per_row <= 16) { __spmv_csr_vector<false,16>(A, x, y); return; }
-    
-    __spmv_csr_vector<false,32>(A, x, y);
+template <typename Matrix,
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void spmv_csr_vector(const Matrix&    A, 
+                     const ValueType* x, 
+                           ValueType* y,
+                     Semiring         semiring,
+                     Epilogue         epilogue)
+{
+    __spmv_csr_vector_adaptive<false>(A, x, y, semiring, epilogue);
 }
 
 template <typename Matrix,
@@ -176,16 +320,31 @@ void spmv_csr_vector_tex(const Matrix&    A,
                          const ValueType* x, 
                                ValueType* y)
 {
-    typedef typename Matrix::index_type IndexType;
-
-    const IndexType nnz_per_row = A.num_entries / A.num_rows;
+    __spmv_csr_vector_adaptive<true>(A, x, y, spmv_plus_times<ValueType>(), spmv_store<ValueType>());
+}
 
-    if (nnz_per_row <=  2) { __spmv_csr_vector<true, 2>(A, x, y); return; }
-    if (nnz_per_row <=  4) { __spmv_csr_vector<true, 4>(A, x, y); return; }
-    if (nnz_per_row <=  8) { __spmv_csr_vector<true, 8>(A, x, y); return; }
-    if (nnz_per_row <= 16) { __spmv_csr_vector<true,16>(A, x, y); return; }
+template <typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void spmv_csr_vector_tex(const Matrix&    A, 
+                         const ValueType* x, 
+                               ValueType* y,
+                         Epilogue         epilogue)
+{
+    __spmv_csr_vector_adaptive<true>(A, x, y, spmv_plus_times<ValueType>(), epilogue);
+}
 
-    __spmv_csr_vector<true,32>(A, x, y);
+template <typename Matrix,
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void spmv_csr_vector_tex(const Matrix&    A, 
+                         const ValueType* x, 
+                               ValueType* y,
+                         Semiring         semiring,
+                         Epilogue         epilogue)
+{
+    __spmv_csr_vector_adaptive<true>(A, x, y, semiring, epilogue);
 }
 
 } // end namespace device
@@ -21,8 +21,15 @@
 
 #include <cusp/detail/device/arch.h>
 #include <cusp/detail/device/common.h>
+#include <cusp/detail/device/graph.h>
 #include <cusp/detail/device/utils.h>
 #include <cusp/detail/device/texture.h>
+#include <cusp/detail/device/spmv/epilogue.h>
+#include <cusp/detail/device/spmv/semiring.h>
+#include <cusp/detail/device/spmv/vector_load.h>
+#include <cusp/detail/storage_cast.h>
+
+#include <cusp/array1d.h>
 
 #include <thrust/device_ptr.h>
 
@@ -50,11 +57,33 @@ namespace device
 //   (the dot product of the i-th row of A with the x vector)
 //
 // spmv_dia_tex
-//   Same as spmv_dia, except x is accessed via texture cache.
+//   Same as spmv_dia, except x is accessed via the read-only data cache.
+//
+// The diagonals are processed in chunks of BLOCK_SIZE and the partial sums
+// are accumulated in y, so the epilogue is applied by the last chunk.  The
+// epilogue may read y itself (y = alpha*A*x + beta*y), hence matrices with
+// more than one chunk store the product first and apply it afterwards.
+//
+// Each thread computes ROWS_PER_THREAD consecutive rows and loads their
+// values on one diagonal with a single wide load (see vector_load.h) when
+// the pitch and the values are suitably aligned.
+//
+// spmv_dia_tiled_kernel
+//   Stencil matrices read each entry of x once per diagonal, for instance
+//   27 times for a 27-point stencil.  The tiled kernel assigns a tile of
+//   rows to each block and groups the diagonals into bands whose offsets
+//   lie within DIA_TILE_SPAN of the first offset of the band.  The window
+//   of x that a band touches, the tile plus the span of its offsets, is
+//   staged in shared memory once, and all diagonals of the band read x
+//   from there.  Neighbouring diagonals of a stencil (offsets -1, 0, +1,
+//   and the neighbouring grid lines of small grids) fall into one band,
+//   so x is read about once per band rather than once per diagonal.  The
+//   kernel processes all diagonals in one pass and requires at most
+//   BLOCK_SIZE of them.
 //
 
 
-template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE, bool UseCache>
+template <typename IndexType, typename ValueType, typename StorageType, unsigned int ROWS_PER_THREAD, unsigned int BLOCK_SIZE, bool UseCache, typename Semiring, typename Epilogue>
 __launch_bounds__(BLOCK_SIZE,1)
 __global__ void
 spmv_dia_kernel(const IndexType num_rows, 
@@ -62,9 +91,11 @@ spmv_dia_kernel(const IndexType num_rows,
                 const IndexType num_diagonals,
                 const IndexType pitch,
                 const IndexType * diagonal_offsets,
-                const ValueType * values,
+                const StorageType * values,
                 const ValueType * x, 
-                      ValueType * y)
+                      ValueType * y,
+                Semiring semiring,
+                Epilogue epilogue)
 {
     __shared__ IndexType offsets[BLOCK_SIZE];
     
@@ -82,27 +113,40 @@ spmv_dia_kernel(const IndexType num_rows,
         __syncthreads();
    
         // process chunk
-        for(IndexType row = thread_id; row < num_rows; row += grid_size)
+        for(IndexType row = ROWS_PER_THREAD * thread_id; row < num_rows; row += ROWS_PER_THREAD * grid_size)
         {
-            ValueType sum = (base == 0) ? ValueType(0) : y[row];
+            // the rows past num_rows lie in the padding of the pitch
+            ValueType sum[ROWS_PER_THREAD];
+
+#pragma unroll
+            for(unsigned int r = 0; r < ROWS_PER_THREAD; r++)
+                sum[r] = (base == 0 || (ROWS_PER_THREAD > 1 && row + r >= num_rows)) ? semiring.identity : y[row + r];
     
             // index into values array
             IndexType idx = row + pitch * base;
     
             for(IndexType n = 0; n < chunk_size; n++)
             {
-                const IndexType col = row + offsets[n];
-        
-                if(col >= 0 && col < num_cols)
+                StorageType A_ij[ROWS_PER_THREAD];
+
+                load_vector<ROWS_PER_THREAD>(values + idx, A_ij);
+
+#pragma unroll
+                for(unsigned int r = 0; r < ROWS_PER_THREAD; r++)
                 {
-                    const ValueType A_ij = values[idx];
-                    sum += A_ij * fetch_x<UseCache>(col, x);
+                    const IndexType col = row + r + offsets[n];
+        
+                    if(col >= 0 && col < num_cols && (ROWS_PER_THREAD == 1 || row + r < num_rows))
+                        sum[r] = semiring.reduce(sum[r], semiring.combine(storage_cast<ValueType>(A_ij[r]), fetch_x<UseCache>(col, x)));
                 }
         
                 idx += pitch;
             }
     
-            y[row] = sum;
+#pragma unroll
+            for(unsigned int r = 0; r < ROWS_PER_THREAD; r++)
+                if (ROWS_PER_THREAD == 1 || row + r < num_rows)
+                    y[row + r] = (base + chunk_size < num_diagonals) ? sum[r] : epilogue(row + r, sum[r]);
         }
 
         // wait until all threads are done reading offsets 
@@ -110,42 +154,227 @@ spmv_dia_kernel(const IndexType num_rows,
     }
 }
 
+
+// largest difference of the offsets within a band of the tiled kernel
+const int DIA_TILE_SPAN = 256;
+
+// fewer diagonals do not share enough of x to pay for the staging
+const int DIA_TILE_MIN_DIAGONALS = 3;
+
+template <typename IndexType, typename ValueType, typename StorageType, unsigned int ROWS_PER_THREAD, unsigned int BLOCK_SIZE, bool UseCache, typename Semiring, typename Epilogue>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+spmv_dia_tiled_kernel(const IndexType num_rows, 
+                      const IndexType num_cols, 
+                      const IndexType num_diagonals,
+                      const IndexType pitch,
+                      const IndexType * diagonal_offsets,
+                      const StorageType * values,
+                      const ValueType * x, 
+                            ValueType * y,
+                      Semiring semiring,
+                      Epilogue epilogue)
+{
+    const IndexType TILE_SIZE   = ROWS_PER_THREAD * BLOCK_SIZE;
+
+    __shared__ IndexType offsets[BLOCK_SIZE];
+    __shared__ ValueType x_window[ROWS_PER_THREAD * BLOCK_SIZE + DIA_TILE_SPAN];
+
+    if(threadIdx.x < num_diagonals)
+        offsets[threadIdx.x] = diagonal_offsets[threadIdx.x];
+
+    __syncthreads();
+
+    for(IndexType tile = TILE_SIZE * blockIdx.x; tile < num_rows; tile += TILE_SIZE * gridDim.x)
+    {
+        // first row of this thread, relative to the tile
+        const IndexType local = ROWS_PER_THREAD * threadIdx.x;
+        const IndexType row   = tile + local;
+
+        ValueType sum[ROWS_PER_THREAD];
+
+#pragma unroll
+        for(unsigned int r = 0; r < ROWS_PER_THREAD; r++)
+            sum[r] = semiring.identity;
+
+        IndexType n = 0;
+
+        while(n < num_diagonals)
+        {
+            // diagonals [n, end) form a band, which every thread of the block
+            // determines in the same way
+            const IndexType first = offsets[n];
+
+            IndexType last = first;
+            IndexType end  = n + 1;
+
+            while(end < num_diagonals && offsets[end] >= first && offsets[end] - first <= DIA_TILE_SPAN)
+            {
+                last = thrust::max(last, offsets[end]);
+                end++;
+            }
+
+            // stage x[tile + first, tile + last + TILE_SIZE)
+            const IndexType window_begin = tile + first;
+            const IndexType window_size  = TILE_SIZE + last - first;
+
+            for(IndexType i = threadIdx.x; i < window_size; i += BLOCK_SIZE)
+            {
+                const IndexType col = window_begin + i;
+
+                if(col >= 0 && col < num_cols)
+                    x_window[i] = fetch_x<UseCache>(col, x);
+            }
+
+            __syncthreads();
+
+            if(row < num_rows)
+            {
+                for(IndexType m = n; m < end; m++)
+                {
+                    StorageType A_ij[ROWS_PER_THREAD];
+
+                    load_vector<ROWS_PER_THREAD>(values + row + pitch * m, A_ij);
+
+#pragma unroll
+                    for(unsigned int r = 0; r < ROWS_PER_THREAD; r++)
+                    {
+                        const IndexType col = row + r + offsets[m];
+
+                        if(col >= 0 && col < num_cols && (ROWS_PER_THREAD == 1 || row + r < num_rows))
+                            sum[r] = semiring.reduce(sum[r], semiring.combine(storage_cast<ValueType>(A_ij[r]), x_window[local + r + offsets[m] - first]));
+                    }
+                }
+            }
+
+            // wait until all threads are done reading the window
+            __syncthreads();
+
+            n = end;
+        }
+
+#pragma unroll
+        for(unsigned int r = 0; r < ROWS_PER_THREAD; r++)
+            if (row + r < num_rows)
+                y[row + r] = epilogue(row + r, sum[r]);
+    }
+}
     
 template <bool UseCache,
+          unsigned int ROWS_PER_THREAD,
           typename Matrix,
-          typename ValueType>
-void __spmv_dia(const Matrix&    A,
-                const ValueType* x, 
-                      ValueType* y)
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void __spmv_dia_tiled_rows(const Matrix&    A,
+                           const ValueType* x, 
+                                 ValueType* y,
+                           Semiring         semiring,
+                           Epilogue         epilogue)
 {
     typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type StorageType;
+
+    const size_t BLOCK_SIZE  = 256;
+    const size_t SHARED_SIZE = sizeof(IndexType) * BLOCK_SIZE + sizeof(ValueType) * (ROWS_PER_THREAD * BLOCK_SIZE + DIA_TILE_SPAN);
+    const size_t MAX_BLOCKS  = cusp::detail::device::arch::max_blocks(spmv_dia_tiled_kernel<IndexType, ValueType, StorageType, ROWS_PER_THREAD, BLOCK_SIZE, UseCache, Semiring, Epilogue>, BLOCK_SIZE, SHARED_SIZE);
+    const size_t NUM_BLOCKS  = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, ROWS_PER_THREAD * BLOCK_SIZE));
+   
+    const IndexType num_diagonals = A.values.num_cols;
+    const IndexType pitch         = A.values.pitch;
+
+    spmv_dia_tiled_kernel<IndexType, ValueType, StorageType, ROWS_PER_THREAD, BLOCK_SIZE, UseCache, Semiring, Epilogue> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (A.num_rows, A.num_cols, num_diagonals, pitch,
+         thrust::raw_pointer_cast(&A.diagonal_offsets[0]),
+         thrust::raw_pointer_cast(&A.values.values[0]),
+         x, y, semiring, epilogue);
+}
+
+template <bool UseCache,
+          unsigned int ROWS_PER_THREAD,
+          typename Matrix,
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void __spmv_dia_rows(const Matrix&    A,
+                     const ValueType* x, 
+                           ValueType* y,
+                     Semiring         semiring,
+                     Epilogue         epilogue)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type StorageType;
 
     const size_t BLOCK_SIZE = 256;
-    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_dia_kernel<IndexType, ValueType, BLOCK_SIZE, UseCache>, BLOCK_SIZE, (size_t) sizeof(IndexType) * BLOCK_SIZE);
-    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_dia_kernel<IndexType, ValueType, StorageType, ROWS_PER_THREAD, BLOCK_SIZE, UseCache, Semiring, Epilogue>, BLOCK_SIZE, (size_t) sizeof(IndexType) * BLOCK_SIZE);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, ROWS_PER_THREAD * BLOCK_SIZE));
    
     const IndexType num_diagonals = A.values.num_cols;
     const IndexType pitch         = A.values.pitch;
 
-    // TODO can this be removed?
+    spmv_dia_kernel<IndexType, ValueType, StorageType, ROWS_PER_THREAD, BLOCK_SIZE, UseCache, Semiring, Epilogue> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (A.num_rows, A.num_cols, num_diagonals, pitch,
+         thrust::raw_pointer_cast(&A.diagonal_offsets[0]),
+         thrust::raw_pointer_cast(&A.values.values[0]),
+         x, y, semiring, epilogue);
+}
+
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void __spmv_dia(const Matrix&    A,
+                const ValueType* x, 
+                      ValueType* y,
+                Semiring         semiring,
+                Epilogue         epilogue)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type StorageType;
+
+    const size_t       BLOCK_SIZE = 256;
+    const unsigned int WIDTH      = vector_width<StorageType>::value;
+
+    const IndexType num_diagonals = A.values.num_cols;
+
+    if (A.num_rows == 0)
+        return;
+
     if (num_diagonals == 0)
     {
         // empty matrix
-        thrust::fill(thrust::device_pointer_cast(y), thrust::device_pointer_cast(y) + A.num_rows, ValueType(0));
+        spmv_apply_epilogue(A.num_rows, (const ValueType *) 0, y, epilogue, semiring.identity);
         return;
     }
 
-    if (UseCache)
-        bind_x(x);
-  
-    spmv_dia_kernel<IndexType, ValueType, BLOCK_SIZE, UseCache> <<<NUM_BLOCKS, BLOCK_SIZE>>>
-        (A.num_rows, A.num_cols, num_diagonals, pitch,
-         thrust::raw_pointer_cast(&A.diagonal_offsets[0]),
-         thrust::raw_pointer_cast(&A.values.values[0]),
-         x, y);
+    if (num_diagonals > IndexType(BLOCK_SIZE) && !is_spmv_store<Epilogue>::value)
+    {
+        cusp::detail::device::launch_buffer<ValueType> temp(A.num_rows);
+
+        __spmv_dia<UseCache>(A, x, temp.get(), semiring, spmv_store<ValueType>());
 
-    if (UseCache)
-        unbind_x(x);
+        spmv_apply_epilogue(A.num_rows, temp.get(), y, epilogue);
+        return;
+    }
+
+    const bool wide  = WIDTH > 1 && is_vector_aligned<WIDTH>(thrust::raw_pointer_cast(&A.values.values[0]), A.values.pitch);
+    const bool tiled = num_diagonals >= IndexType(DIA_TILE_MIN_DIAGONALS) && num_diagonals <= IndexType(BLOCK_SIZE);
+
+    if (tiled)
+    {
+        if (wide)
+            __spmv_dia_tiled_rows<UseCache,WIDTH>(A, x, y, semiring, epilogue);
+        else
+            __spmv_dia_tiled_rows<UseCache,1>(A, x, y, semiring, epilogue);
+    }
+    else
+    {
+        if (wide)
+            __spmv_dia_rows<UseCache,WIDTH>(A, x, y, semiring, epilogue);
+        else
+            __spmv_dia_rows<UseCache,1>(A, x, y, semiring, epilogue);
+    }
 }
 
 template <typename Matrix,
@@ -154,7 +383,31 @@ void spmv_dia(const Matrix&    A,
               const ValueType* x, 
                     ValueType* y)
 {
-    __spmv_dia<false>(A, x, y);
+    __spmv_dia<false>(A, x, y, spmv_plus_times<ValueType>(), spmv_store<ValueType>());
+}
+
+template <typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void spmv_dia(const Matrix&    A, 
+              const ValueType* x, 
+                    ValueType* y,
+              Epilogue         epilogue)
+{
+    __spmv_dia<false>(A, x, y, spmv_plus_times<ValueType>(), epilogue);
+}
+
+template <typename Matrix,
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void spmv_dia(const Matrix&    A, 
+              const ValueType* x, 
+                    ValueType* y,
+              Semiring         semiring,
+              Epilogue         epilogue)
+{
+    __spmv_dia<false>(A, x, y, semiring, epilogue);
 }
 
 template <typename Matrix,
@@ -163,7 +416,31 @@ void spmv_dia_tex(const Matrix&    A,
                   const ValueType* x, 
                         ValueType* y)
 {
-    __spmv_dia<true>(A, x, y);
+    __spmv_dia<true>(A, x, y, spmv_plus_times<ValueType>(), spmv_store<ValueType>());
+}
+
+template <typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void spmv_dia_tex(const Matrix&    A, 
+                  const ValueType* x, 
+                        ValueType* y,
+                  Epilogue         epilogue)
+{
+    __spmv_dia<true>(A, x, y, spmv_plus_times<ValueType>(), epilogue);
+}
+
+template <typename Matrix,
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void spmv_dia_tex(const Matrix&    A, 
+                  const ValueType* x, 
+                        ValueType* y,
+                  Semiring         semiring,
+                  Epilogue         epilogue)
+{
+    __spmv_dia<true>(A, x, y, semiring, epilogue);
 }
 
 } // end namespace device
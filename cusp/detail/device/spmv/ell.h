@@ -21,10 +21,21 @@
 #include <cusp/detail/device/common.h>
 #include <cusp/detail/device/utils.h>
 #include <cusp/detail/device/texture.h>
+#include <cusp/detail/device/spmv/epilogue.h>
+#include <cusp/detail/device/spmv/semiring.h>
+#include <cusp/detail/device/spmv/vector_load.h>
+#include <cusp/detail/storage_cast.h>
 
 #include <thrust/device_ptr.h>
 
 // SpMV kernel for the ELLPACK/ITPACK matrix format.
+//
+// Each thread computes ROWS_PER_THREAD consecutive rows and loads their
+// column indices and values of one column with a single wide load (see
+// vector_load.h).  The wide kernel is used when the pitch and the arrays
+// are suitably aligned, otherwise each thread computes one row.  The
+// values may be stored in a narrower type than x and y (see
+// storage_cast.h).
 
 namespace cusp
 {
@@ -33,7 +44,7 @@ namespace detail
 namespace device
 {
 
-template <typename IndexType, typename ValueType, size_t BLOCK_SIZE, bool UseCache>
+template <typename IndexType, typename ValueType, typename StorageType, unsigned int ROWS_PER_THREAD, size_t BLOCK_SIZE, bool UseCache, typename Semiring, typename Epilogue>
 __launch_bounds__(BLOCK_SIZE,1)
 __global__ void
 spmv_ell_kernel(const IndexType num_rows, 
@@ -41,70 +52,110 @@ spmv_ell_kernel(const IndexType num_rows,
                 const IndexType num_cols_per_row,
                 const IndexType pitch,
                 const IndexType * Aj,
-                const ValueType * Ax, 
+                const StorageType * Ax, 
                 const ValueType * x, 
-                      ValueType * y)
+                      ValueType * y,
+                Semiring semiring,
+                Epilogue epilogue)
 {
-    const IndexType invalid_index = cusp::ell_matrix<IndexType, ValueType, cusp::device_memory>::invalid_index;
+    const IndexType invalid_index = cusp::ell_matrix<IndexType, StorageType, cusp::device_memory>::invalid_index;
 
     const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
     const IndexType grid_size = gridDim.x * blockDim.x;
 
-    for(IndexType row = thread_id; row < num_rows; row += grid_size)
+    for(IndexType row = ROWS_PER_THREAD * thread_id; row < num_rows; row += ROWS_PER_THREAD * grid_size)
     {
-        ValueType sum = 0;
+        ValueType sum[ROWS_PER_THREAD];
+
+#pragma unroll
+        for(unsigned int r = 0; r < ROWS_PER_THREAD; r++)
+            sum[r] = semiring.identity;
 
         IndexType offset = row;
 
         for(IndexType n = 0; n < num_cols_per_row; n++)
         {
-            const IndexType col = Aj[offset];
+            // the rows past num_rows lie in the padding of the pitch
+            IndexType col[ROWS_PER_THREAD];
+            StorageType A_ij[ROWS_PER_THREAD];
+
+            load_vector<ROWS_PER_THREAD>(Aj + offset, col);
+            load_vector<ROWS_PER_THREAD>(Ax + offset, A_ij);
 
-            if (col != invalid_index)
-            {
-                const ValueType A_ij = Ax[offset];
-                sum += A_ij * fetch_x<UseCache>(col, x);
-            }
+#pragma unroll
+            for(unsigned int r = 0; r < ROWS_PER_THREAD; r++)
+                if (col[r] != invalid_index && (ROWS_PER_THREAD == 1 || row + r < num_rows))
+                    sum[r] = semiring.reduce(sum[r], semiring.combine(storage_cast<ValueType>(A_ij[r]), fetch_x<UseCache>(col[r], x)));
 
             offset += pitch;
         }
 
-        y[row] = sum;
+#pragma unroll
+        for(unsigned int r = 0; r < ROWS_PER_THREAD; r++)
+            if (ROWS_PER_THREAD == 1 || row + r < num_rows)
+                y[row + r] = epilogue(row + r, sum[r]);
     }
 }
 
 
 template <bool UseCache,
+          unsigned int ROWS_PER_THREAD,
           typename Matrix,
-          typename ValueType>
-void __spmv_ell(const Matrix&    A, 
-                const ValueType* x, 
-                      ValueType* y)
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void __spmv_ell_rows(const Matrix&    A, 
+                     const ValueType* x, 
+                           ValueType* y,
+                     Semiring         semiring,
+                     Epilogue         epilogue)
 {
     typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type StorageType;
 
     const size_t BLOCK_SIZE = 256;
-    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_ell_kernel<IndexType,ValueType,BLOCK_SIZE,UseCache>, BLOCK_SIZE, (size_t) 0);
-    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_ell_kernel<IndexType,ValueType,StorageType,ROWS_PER_THREAD,BLOCK_SIZE,UseCache,Semiring,Epilogue>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, ROWS_PER_THREAD * BLOCK_SIZE));
 
     const IndexType pitch               = A.column_indices.pitch;
     const IndexType num_entries_per_row = A.column_indices.num_cols;
 
-    // TODO generalize this
-    assert(A.column_indices.pitch == A.values.pitch);
-    
-    if (UseCache)
-        bind_x(x);
-
-    spmv_ell_kernel<IndexType,ValueType,BLOCK_SIZE,UseCache> <<<NUM_BLOCKS, BLOCK_SIZE>>>
+    spmv_ell_kernel<IndexType,ValueType,StorageType,ROWS_PER_THREAD,BLOCK_SIZE,UseCache,Semiring,Epilogue> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
         (A.num_rows, A.num_cols,
          num_entries_per_row, pitch,
          thrust::raw_pointer_cast(&A.column_indices.values[0]), 
          thrust::raw_pointer_cast(&A.values.values[0]),
-         x, y);
+         x, y, semiring, epilogue);
+}
 
-    if (UseCache)
-        unbind_x(x);
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void __spmv_ell(const Matrix&    A, 
+                const ValueType* x, 
+                      ValueType* y,
+                Semiring         semiring,
+                Epilogue         epilogue)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type StorageType;
+
+    const unsigned int WIDTH = vector_width_pair<IndexType,StorageType>::value;
+
+    // the kernel indexes column_indices and values with one pitch
+    assert(A.column_indices.pitch == A.values.pitch);
+
+    if (A.num_rows == 0)
+        return;
+
+    if (WIDTH > 1 &&
+        is_vector_aligned<WIDTH>(thrust::raw_pointer_cast(&A.column_indices.values[0]), A.column_indices.pitch) &&
+        is_vector_aligned<WIDTH>(thrust::raw_pointer_cast(&A.values.values[0]),         A.values.pitch))
+        __spmv_ell_rows<UseCache,WIDTH>(A, x, y, semiring, epilogue);
+    else
+        __spmv_ell_rows<UseCache,1>(A, x, y, semiring, epilogue);
 }
 
 template <typename Matrix,
@@ -113,7 +164,31 @@ void spmv_ell(const Matrix&    A,
               const ValueType* x, 
                     ValueType* y)
 {
-    __spmv_ell<false>(A, x, y);
+    __spmv_ell<false>(A, x, y, spmv_plus_times<ValueType>(), spmv_store<ValueType>());
+}
+
+template <typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void spmv_ell(const Matrix&    A, 
+              const ValueType* x, 
+                    ValueType* y,
+              Epilogue         epilogue)
+{
+    __spmv_ell<false>(A, x, y, spmv_plus_times<ValueType>(), epilogue);
+}
+
+template <typename Matrix,
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void spmv_ell(const Matrix&    A, 
+              const ValueType* x, 
+                    ValueType* y,
+              Semiring         semiring,
+              Epilogue         epilogue)
+{
+    __spmv_ell<false>(A, x, y, semiring, epilogue);
 }
 
 template <typename Matrix,
@@ -122,7 +197,31 @@ void spmv_ell_tex(const Matrix&    A,
                   const ValueType* x, 
                         ValueType* y)
 {
-    __spmv_ell<true>(A, x, y);
+    __spmv_ell<true>(A, x, y, spmv_plus_times<ValueType>(), spmv_store<ValueType>());
+}
+
+template <typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void spmv_ell_tex(const Matrix&    A, 
+                  const ValueType* x, 
+                        ValueType* y,
+                  Epilogue         epilogue)
+{
+    __spmv_ell<true>(A, x, y, spmv_plus_times<ValueType>(), epilogue);
+}
+
+template <typename Matrix,
+          typename ValueType,
+          typename Semiring,
+          typename Epilogue>
+void spmv_ell_tex(const Matrix&    A, 
+                  const ValueType* x, 
+                        ValueType* y,
+                  Semiring         semiring,
+                  Epilogue         epilogue)
+{
+    __spmv_ell<true>(A, x, y, semiring, epilogue);
 }
 
 } // end namespace device
@@ -0,0 +1,187 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/utils.h>
+
+#include <thrust/detail/type_traits.h>
+
+// Epilogues of the SpMV kernels.
+//
+// A kernel computes the row sum (A x)[i] in registers and stores
+// epilogue(i, sum) to y[i].  The default epilogue stores the sum, while
+// spmv_axpby computes
+//
+//    y[i] <- alpha * (A x)[i] + beta * z[i]
+//
+// so that y = alpha*A*x + beta*y (z = y) and the residual r = b - A*x
+// (alpha = -1, beta = 1, z = b) avoid a separate pass over y.  Since each
+// row is stored exactly once, z may alias y.  As in the BLAS, z is not
+// read when beta is zero.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+template <typename ValueType>
+struct spmv_store
+{
+    template <typename IndexType>
+    __host__ __device__
+    ValueType operator()(const IndexType row, const ValueType sum) const
+    {
+        return sum;
+    }
+};
+
+template <typename ValueType>
+struct spmv_axpby
+{
+    ValueType alpha;
+    ValueType beta;
+    const ValueType * z;
+
+    spmv_axpby(const ValueType alpha, const ValueType beta, const ValueType * z)
+        : alpha(alpha), beta(beta), z(z) {}
+
+    template <typename IndexType>
+    __host__ __device__
+    ValueType operator()(const IndexType row, const ValueType sum) const
+    {
+        if (beta == ValueType(0))
+            return alpha * sum;
+        else
+            return alpha * sum + beta * z[row];
+    }
+};
+
+// y[i] <- x[i] + omega * (b[i] - (A x)[i] - z[i]) / d[i], a Jacobi sweep.
+// A null x stands for x = 0 and a null z for z = 0.  z holds the part of
+// the product that was accumulated beforehand, hence it may alias y.
+template <typename ValueType>
+struct spmv_jacobi
+{
+    ValueType omega;
+    const ValueType * x;
+    const ValueType * b;
+    const ValueType * diagonal;
+    const ValueType * z;
+
+    spmv_jacobi(const ValueType omega, const ValueType * x, const ValueType * b, const ValueType * diagonal, const ValueType * z = 0)
+        : omega(omega), x(x), b(b), diagonal(diagonal), z(z) {}
+
+    template <typename IndexType>
+    __host__ __device__
+    ValueType operator()(const IndexType row, const ValueType sum) const
+    {
+        const ValueType Ax = z == 0 ? sum : sum + z[row];
+
+        if (x == 0)
+            return omega * (b[row] - Ax) / diagonal[row];
+        else
+            return x[row] + omega * (b[row] - Ax) / diagonal[row];
+    }
+};
+
+// y[i] <- d[i] * ((A x)[i] + z[i]), the product scaled by a diagonal.
+// A null z stands for z = 0, otherwise z may alias y as in spmv_jacobi.
+template <typename ValueType>
+struct spmv_scale
+{
+    const ValueType * diagonal;
+    const ValueType * z;
+
+    spmv_scale(const ValueType * diagonal, const ValueType * z = 0)
+        : diagonal(diagonal), z(z) {}
+
+    template <typename IndexType>
+    __host__ __device__
+    ValueType operator()(const IndexType row, const ValueType sum) const
+    {
+        return diagonal[row] * (z == 0 ? sum : sum + z[row]);
+    }
+};
+
+// z[i] <- reduce(y[i], (A x)[i]), the generalized product of a semiring
+template <typename ValueType, typename BinaryFunction>
+struct spmv_reduce_epilogue
+{
+    BinaryFunction reduce;
+    const ValueType * y;
+
+    spmv_reduce_epilogue(BinaryFunction reduce, const ValueType * y)
+        : reduce(reduce), y(y) {}
+
+    template <typename IndexType>
+    __host__ __device__
+    ValueType operator()(const IndexType row, const ValueType sum) const
+    {
+        return reduce(y[row], sum);
+    }
+};
+
+template <typename Epilogue>
+struct is_spmv_store : thrust::detail::false_type {};
+
+template <typename ValueType>
+struct is_spmv_store< spmv_store<ValueType> > : thrust::detail::true_type {};
+
+// y[i] <- epilogue(i, t[i]), or epilogue(i, identity) when t is null
+template <typename IndexType, typename ValueType, typename Epilogue>
+__global__ void
+spmv_epilogue_kernel(const IndexType num_rows,
+                     const ValueType * t,
+                           ValueType * y,
+                     Epilogue epilogue,
+                     const ValueType identity)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += grid_size)
+        y[row] = epilogue(row, t == 0 ? identity : t[row]);
+}
+
+// Apply an epilogue to a product that was stored by an unfused kernel.
+// Used by formats, and by cases of the fused formats, whose kernels do
+// not produce each row sum in a single pass.
+template <typename ValueType, typename Epilogue>
+void spmv_apply_epilogue(const size_t num_rows,
+                         const ValueType * t,
+                               ValueType * y,
+                         Epilogue epilogue,
+                         const ValueType identity = ValueType(0))
+{
+    if (num_rows == 0)
+        return;
+
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_epilogue_kernel<size_t, ValueType, Epilogue>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(num_rows, BLOCK_SIZE));
+
+    spmv_epilogue_kernel<size_t, ValueType, Epilogue> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (num_rows, t, y, epilogue, identity);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
@@ -17,8 +17,37 @@
 
 #pragma once
 
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/texture.h>
 #include <cusp/detail/device/spmv/ell.h>
 #include <cusp/detail/device/spmv/coo_flat.h>
+#include <cusp/detail/device/spmv/epilogue.h>
+#include <cusp/detail/storage_cast.h>
+
+#include <thrust/device_ptr.h>
+
+// The product with a HYB matrix is the product with its ELL part followed
+// by that with its COO part, which takes up to four launches (the ELL,
+// COO and tail kernels, and the carry kernel where the COO kernel cannot
+// add its carries atomically) and reads and writes y twice.  Most
+// matrices are multiplied by a single kernel that stores each entry of y
+// once and applies the epilogue to it:
+//
+//   small matrices, e.g. the coarse levels of a multigrid hierarchy, use
+//   one thread per row.  The thread sums the ELL part of its row and the
+//   COO entries of the row, which it finds by a binary search of the
+//   sorted row indices.
+//
+//   other matrices use one block per BLOCK_SIZE rows.  Each thread sums
+//   the ELL part of its row, then the whole block reduces the COO entries
+//   of its rows BLOCK_SIZE at a time with a segmented reduction in shared
+//   memory, so that a row with many COO entries is shared by the threads
+//   of the block.  Blocks are scheduled as multiprocessors become free, but
+//   the COO entries of a block are not split further, hence the fused
+//   kernel is limited to COO parts whose worst block (all entries in the
+//   same rows) takes about as long as the ELL pass.  Longer COO parts use
+//   the separate kernels.
 
 namespace cusp
 {
@@ -27,12 +56,271 @@ namespace detail
 namespace device
 {
 
+// index of the first COO entry in a row at or after row
+template <typename IndexType>
+__device__ IndexType hyb_coo_lower_bound(const IndexType * I, const IndexType num_coo_entries, const IndexType row)
+{
+    IndexType first = 0;
+    IndexType last  = num_coo_entries;
+
+    while (first < last)
+    {
+        const IndexType middle = first + (last - first) / 2;
+
+        if (I[middle] < row)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    return first;
+}
+
+template <typename IndexType, typename ValueType, typename StorageType, size_t BLOCK_SIZE, bool UseCache, typename Epilogue>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+spmv_hyb_small_kernel(const IndexType num_rows,
+                      const IndexType num_entries_per_row,
+                      const IndexType pitch,
+                      const IndexType * Aj,
+                      const StorageType * Ax,
+                      const IndexType num_coo_entries,
+                      const IndexType * I,
+                      const IndexType * J,
+                      const StorageType * V,
+                      const ValueType * x,
+                            ValueType * y,
+                      Epilogue epilogue)
+{
+    const IndexType invalid_index = cusp::ell_matrix<IndexType, StorageType, cusp::device_memory>::invalid_index;
+
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += grid_size)
+    {
+        ValueType sum = 0;
+
+        IndexType offset = row;
+
+        for(IndexType n = 0; n < num_entries_per_row; n++)
+        {
+            const IndexType col = Aj[offset];
+
+            if (col != invalid_index)
+                sum = sum + storage_cast<ValueType>(Ax[offset]) * fetch_x<UseCache>(col, x);
+
+            offset += pitch;
+        }
+
+        // first COO entry of the row
+        const IndexType first = hyb_coo_lower_bound(I, num_coo_entries, row);
+
+        for(IndexType n = first; n < num_coo_entries && I[n] == row; n++)
+            sum = sum + storage_cast<ValueType>(V[n]) * fetch_x<UseCache>(J[n], x);
+
+        y[row] = epilogue(row, sum);
+    }
+}
+
+template <typename IndexType, typename ValueType, typename StorageType, unsigned int BLOCK_SIZE, bool UseCache, typename Epilogue>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+spmv_hyb_fused_kernel(const IndexType num_rows,
+                      const IndexType num_entries_per_row,
+                      const IndexType pitch,
+                      const IndexType * Aj,
+                      const StorageType * Ax,
+                      const IndexType num_coo_entries,
+                      const IndexType * I,
+                      const IndexType * J,
+                      const StorageType * V,
+                      const ValueType * x,
+                            ValueType * y,
+                      Epilogue epilogue)
+{
+    const IndexType invalid_index = cusp::ell_matrix<IndexType, StorageType, cusp::device_memory>::invalid_index;
+
+    __shared__ IndexType coo_range[2];
+    __shared__ IndexType rows[BLOCK_SIZE];      // rows of a chunk, relative to the block's first row
+    __shared__ ValueType vals[BLOCK_SIZE];
+    __shared__ ValueType sums[BLOCK_SIZE];      // row sums of the block
+
+    for(IndexType first_row = BLOCK_SIZE * blockIdx.x; first_row < num_rows; first_row += BLOCK_SIZE * gridDim.x)
+    {
+        const IndexType row = first_row + threadIdx.x;
+
+        // ELL part of the thread's row
+        ValueType sum = 0;
+
+        if (row < num_rows)
+        {
+            IndexType offset = row;
+
+            for(IndexType n = 0; n < num_entries_per_row; n++)
+            {
+                const IndexType col = Aj[offset];
+
+                if (col != invalid_index)
+                    sum = sum + storage_cast<ValueType>(Ax[offset]) * fetch_x<UseCache>(col, x);
+
+                offset += pitch;
+            }
+        }
+
+        sums[threadIdx.x] = sum;
+
+        // COO entries of the block's rows
+        if (threadIdx.x < 2)
+            coo_range[threadIdx.x] = hyb_coo_lower_bound(I, num_coo_entries, first_row + IndexType(threadIdx.x * BLOCK_SIZE));
+
+        __syncthreads();
+
+        const IndexType coo_begin = coo_range[0];
+        const IndexType coo_end   = coo_range[1];
+
+        for(IndexType base = coo_begin; base < coo_end; base += BLOCK_SIZE)
+        {
+            const IndexType n = base + threadIdx.x;
+
+            if (n < coo_end)
+            {
+                rows[threadIdx.x] = I[n] - first_row;
+                vals[threadIdx.x] = storage_cast<ValueType>(V[n]) * fetch_x<UseCache>(J[n], x);
+            }
+            else
+            {
+                rows[threadIdx.x] = -1;
+                vals[threadIdx.x] = ValueType(0);
+            }
+
+            __syncthreads();
+
+            segreduce_block(rows, vals);
+
+            // the last entry of a row in the chunk holds the row's partial sum
+            if (n < coo_end && (threadIdx.x == BLOCK_SIZE - 1 || rows[threadIdx.x] != rows[threadIdx.x + 1]))
+                sums[rows[threadIdx.x]] += vals[threadIdx.x];
+
+            __syncthreads();
+        }
+
+        if (row < num_rows)
+            y[row] = epilogue(row, ValueType(sums[threadIdx.x]));
+
+        // before the next rows reuse the shared arrays
+        __syncthreads();
+    }
+}
+
+template <typename Matrix>
+bool is_small_hyb(const Matrix& A)
+{
+    return A.num_rows + A.coo.num_entries <= cusp::detail::device::arch::small_launch_size();
+}
+
+// a fused kernel applies, see above
+template <typename Matrix>
+bool is_fused_hyb(const Matrix& A)
+{
+    const size_t BLOCK_SIZE = 256;
+
+    if (is_small_hyb(A))
+        return true;
+
+    const cusp::detail::device::arch::device_info& info = cusp::detail::device::arch::current_device_info();
+
+    // the worst block reduces every COO entry, one chunk per BLOCK_SIZE of
+    // them, whereas each wave of resident blocks does one ELL pass
+    const size_t resident_blocks = info.num_multiprocessors * std::max<size_t>(info.max_threads_per_multiprocessor / BLOCK_SIZE, 1);
+    const size_t num_waves       = DIVIDE_INTO(DIVIDE_INTO(A.num_rows, BLOCK_SIZE), resident_blocks);
+    const size_t num_chunks      = DIVIDE_INTO(A.coo.num_entries, BLOCK_SIZE);
+
+    return num_chunks <= 4 * (A.ell.column_indices.num_cols + 1) * num_waves;
+}
+
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void __spmv_hyb_small(const Matrix&    A,
+                      const ValueType* x,
+                            ValueType* y,
+                      Epilogue         epilogue)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type StorageType;
+
+    if (A.num_rows == 0)
+        return;
+
+    const size_t BLOCK_SIZE = 256;
+    const size_t NUM_BLOCKS = DIVIDE_INTO(A.num_rows, BLOCK_SIZE);
+
+    const IndexType num_entries_per_row = A.ell.column_indices.num_cols;
+    const IndexType num_coo_entries     = A.coo.num_entries;
+
+    // either part may be empty
+    const IndexType   * Aj = num_entries_per_row == 0 ? 0 : thrust::raw_pointer_cast(&A.ell.column_indices.values[0]);
+    const StorageType * Ax = num_entries_per_row == 0 ? 0 : thrust::raw_pointer_cast(&A.ell.values.values[0]);
+    const IndexType   * I  = num_coo_entries == 0     ? 0 : thrust::raw_pointer_cast(&A.coo.row_indices[0]);
+    const IndexType   * J  = num_coo_entries == 0     ? 0 : thrust::raw_pointer_cast(&A.coo.column_indices[0]);
+    const StorageType * V  = num_coo_entries == 0     ? 0 : thrust::raw_pointer_cast(&A.coo.values[0]);
+
+    spmv_hyb_small_kernel<IndexType,ValueType,StorageType,BLOCK_SIZE,UseCache,Epilogue> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (A.num_rows, num_entries_per_row, IndexType(A.ell.column_indices.pitch), Aj, Ax,
+         num_coo_entries, I, J, V, x, y, epilogue);
+}
+
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void __spmv_hyb_fused(const Matrix&    A,
+                      const ValueType* x,
+                            ValueType* y,
+                      Epilogue         epilogue)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type StorageType;
+
+    if (is_small_hyb(A))
+    {
+        __spmv_hyb_small<UseCache>(A, x, y, epilogue);
+        return;
+    }
+
+    const unsigned int BLOCK_SIZE = 256;
+    const size_t MAX_BLOCKS = 65535; // the blocks are scheduled as multiprocessors become free
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+
+    const IndexType num_entries_per_row = A.ell.column_indices.num_cols;
+    const IndexType num_coo_entries     = A.coo.num_entries;
+
+    // either part may be empty
+    const IndexType   * Aj = num_entries_per_row == 0 ? 0 : thrust::raw_pointer_cast(&A.ell.column_indices.values[0]);
+    const StorageType * Ax = num_entries_per_row == 0 ? 0 : thrust::raw_pointer_cast(&A.ell.values.values[0]);
+    const IndexType   * I  = num_coo_entries == 0     ? 0 : thrust::raw_pointer_cast(&A.coo.row_indices[0]);
+    const IndexType   * J  = num_coo_entries == 0     ? 0 : thrust::raw_pointer_cast(&A.coo.column_indices[0]);
+    const StorageType * V  = num_coo_entries == 0     ? 0 : thrust::raw_pointer_cast(&A.coo.values[0]);
+
+    spmv_hyb_fused_kernel<IndexType,ValueType,StorageType,BLOCK_SIZE,UseCache,Epilogue> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (A.num_rows, num_entries_per_row, IndexType(A.ell.column_indices.pitch), Aj, Ax,
+         num_coo_entries, I, J, V, x, y, epilogue);
+}
+
 template <typename Matrix,
           typename ValueType>
 void spmv_hyb(const Matrix&    A, 
               const ValueType* x, 
                     ValueType* y)
 {
+    if (is_fused_hyb(A))
+    {
+        __spmv_hyb_fused<false>(A, x, y, spmv_store<ValueType>());
+        return;
+    }
+
     spmv_ell(A.ell, x, y);
     __spmv_coo_flat<false, false>(A.coo, x, y);
 }
@@ -43,6 +331,12 @@ void spmv_hyb_tex(const Matrix&    A,
                   const ValueType* x, 
                         ValueType* y)
 {
+    if (is_fused_hyb(A))
+    {
+        __spmv_hyb_fused<true>(A, x, y, spmv_store<ValueType>());
+        return;
+    }
+
     spmv_ell_tex(A.ell, x, y);
     __spmv_coo_flat<true, false>(A.coo, x, y);
 }
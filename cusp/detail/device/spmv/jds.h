@@ -0,0 +1,158 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/utils.h>
+#include <cusp/detail/device/texture.h>
+#include <cusp/detail/device/spmv/epilogue.h>
+
+#include <thrust/device_ptr.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// JDS SpMV kernel (one thread per row)
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmv_jds_kernel
+//   Thread k processes the k-th longest row, i.e. row permutation[k] of
+//   the matrix.  Entry n of the rows is stored in jagged diagonal n, so
+//   the loads of Aj and Ax are coalesced as in the ELL kernel, while the
+//   diagonals only cover the rows that are long enough and no padding is
+//   read.  The result is scattered to its row by the epilogue, which
+//   therefore also fuses y = alpha*A*x + beta*z into the same pass.
+
+template <bool UseCache,
+          typename IndexType,
+          typename ValueType,
+          typename Epilogue>
+__global__ void
+spmv_jds_kernel(const IndexType num_rows,
+                const IndexType num_diagonals,
+                const IndexType * permutation,
+                const IndexType * offsets,
+                const IndexType * Aj,
+                const ValueType * Ax,
+                const ValueType * x,
+                      ValueType * y,
+                Epilogue epilogue)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType k = thread_id; k < num_rows; k += grid_size)
+    {
+        ValueType sum = 0;
+
+        // rows are sorted by decreasing length, so the diagonals that
+        // contain row k are the leading ones
+        for(IndexType n = 0; n < num_diagonals; n++)
+        {
+            const IndexType jj = offsets[n] + k;
+
+            if (jj >= offsets[n + 1])
+                break;
+
+            sum += Ax[jj] * fetch_x<UseCache>(Aj[jj], x);
+        }
+
+        const IndexType row = permutation[k];
+
+        y[row] = epilogue(row, sum);
+    }
+}
+
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void __spmv_jds(const Matrix&    A,
+                const ValueType* x,
+                      ValueType* y,
+                Epilogue         epilogue)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    if (A.num_rows == 0)
+        return;
+
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_jds_kernel<UseCache, IndexType, ValueType, Epilogue>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+
+    spmv_jds_kernel<UseCache, IndexType, ValueType, Epilogue> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows), IndexType(A.num_diagonals()),
+         thrust::raw_pointer_cast(&A.row_permutation[0]),
+         thrust::raw_pointer_cast(&A.diagonal_offsets[0]),
+         A.num_entries == 0 ? (const IndexType *) 0 : thrust::raw_pointer_cast(&A.column_indices[0]),
+         A.num_entries == 0 ? (const ValueType *) 0 : thrust::raw_pointer_cast(&A.values[0]),
+         x, y, epilogue);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_jds(const Matrix&    A,
+              const ValueType* x,
+                    ValueType* y)
+{
+    __spmv_jds<false>(A, x, y, spmv_store<ValueType>());
+}
+
+template <typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void spmv_jds(const Matrix&    A,
+              const ValueType* x,
+                    ValueType* y,
+              Epilogue         epilogue)
+{
+    __spmv_jds<false>(A, x, y, epilogue);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_jds_tex(const Matrix&    A,
+                  const ValueType* x,
+                        ValueType* y)
+{
+    __spmv_jds<true>(A, x, y, spmv_store<ValueType>());
+}
+
+template <typename Matrix,
+          typename ValueType,
+          typename Epilogue>
+void spmv_jds_tex(const Matrix&    A,
+                  const ValueType* x,
+                        ValueType* y,
+                  Epilogue         epilogue)
+{
+    __spmv_jds<true>(A, x, y, epilogue);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,135 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/utils.h>
+#include <cusp/detail/device/texture.h>
+
+#include <thrust/device_ptr.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// SELL-C-sigma SpMV kernel (one thread per row)
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmv_sell_kernel
+//   Thread k processes the k-th row of the sliced layout, i.e. row
+//   permutation[k] of the matrix.  As in the ELL kernel, the entries of
+//   consecutive rows of a slice are adjacent in memory, so the loads of
+//   Aj and Ax are coalesced when the slice size is a multiple of the warp
+//   size.  Each slice is only as wide as its longest row, and since rows
+//   are sorted by length within windows, the threads of a warp execute
+//   roughly the same number of iterations.
+
+template <bool UseCache,
+          typename IndexType,
+          typename ValueType>
+__global__ void
+spmv_sell_kernel(const IndexType num_rows,
+                 const IndexType slice_size,
+                 const IndexType * permutation,
+                 const IndexType * offsets,
+                 const IndexType * Aj,
+                 const ValueType * Ax,
+                 const ValueType * x,
+                       ValueType * y)
+{
+    const IndexType invalid_index = static_cast<IndexType>(-1);
+
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType k = thread_id; k < num_rows; k += grid_size)
+    {
+        const IndexType slice = k / slice_size;
+        const IndexType start = offsets[slice];
+        const IndexType end   = offsets[slice + 1];
+
+        ValueType sum = 0;
+
+        for(IndexType jj = start + k % slice_size; jj < end; jj += slice_size)
+        {
+            const IndexType col = Aj[jj];
+
+            // rows are shifted to the left, the remainder is padding
+            if (col == invalid_index)
+                break;
+
+            sum += Ax[jj] * fetch_x<UseCache>(col, x);
+        }
+
+        y[permutation[k]] = sum;
+    }
+}
+
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType>
+void __spmv_sell(const Matrix&    A,
+                 const ValueType* x,
+                       ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    if (A.num_rows == 0)
+        return;
+
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_sell_kernel<UseCache, IndexType, ValueType>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+
+    spmv_sell_kernel<UseCache, IndexType, ValueType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows), IndexType(A.slice_size),
+         thrust::raw_pointer_cast(&A.row_permutation[0]),
+         thrust::raw_pointer_cast(&A.slice_offsets[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_sell(const Matrix&    A,
+               const ValueType* x,
+                     ValueType* y)
+{
+    __spmv_sell<false>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_sell_tex(const Matrix&    A,
+                   const ValueType* x,
+                         ValueType* y)
+{
+    __spmv_sell<true>(A, x, y);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,98 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/functional.h>
+
+// Semirings of the SpMV kernels.
+//
+// A kernel computes the row sum
+//
+//    sum = reduce(... reduce(identity, combine(A_ij, x_j)) ...)
+//
+// over the entries of a row, so the numeric product uses (*, +, 0) and
+// graph algorithms substitute e.g. (+, min, inf) or (and, or, false).
+// The entries of a row are reduced in an unspecified order, hence reduce
+// must be associative and commutative, and identity must be its neutral
+// element.  Only the numeric semiring uses the merge-path CSR kernel.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+template <typename ValueType>
+struct spmv_plus_times
+{
+    ValueType identity;
+
+    spmv_plus_times(void) : identity(0) {}
+
+    // a is a real scalar when a real matrix is applied to complex vectors
+    template <typename OperandType>
+    __host__ __device__
+    ValueType combine(const OperandType a, const ValueType b) const
+    {
+        return a * b;
+    }
+
+    __host__ __device__
+    ValueType reduce(const ValueType a, const ValueType b) const
+    {
+        return a + b;
+    }
+};
+
+template <typename ValueType,
+          typename BinaryFunction1,
+          typename BinaryFunction2>
+struct spmv_semiring
+{
+    BinaryFunction1 combine_op;
+    BinaryFunction2 reduce_op;
+    ValueType       identity;
+
+    spmv_semiring(BinaryFunction1 combine, BinaryFunction2 reduce, const ValueType identity)
+        : combine_op(combine), reduce_op(reduce), identity(identity) {}
+
+    template <typename OperandType>
+    __host__ __device__
+    ValueType combine(const OperandType a, const ValueType b) const
+    {
+        return combine_op(a, b);
+    }
+
+    __host__ __device__
+    ValueType reduce(const ValueType a, const ValueType b) const
+    {
+        return reduce_op(a, b);
+    }
+};
+
+template <typename ValueType, typename BinaryFunction1, typename BinaryFunction2>
+spmv_semiring<ValueType,BinaryFunction1,BinaryFunction2>
+make_spmv_semiring(BinaryFunction1 combine, BinaryFunction2 reduce, const ValueType identity)
+{
+    return spmv_semiring<ValueType,BinaryFunction1,BinaryFunction2>(combine, reduce, identity);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,359 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/format.h>
+#include <cusp/ell_matrix.h>
+
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/atomic.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/utils.h>
+#include <cusp/detail/device/texture.h>
+#include <cusp/detail/device/warp.h>
+#include <cusp/detail/row_statistics.h>
+
+#include <thrust/device_ptr.h>
+
+// SpMV of a split_complex_matrix.
+//
+// The real parts Ar and the imaginary parts Ai of the entries are stored
+// in separate arrays with the layout of the values of the underlying CSR,
+// ELL or HYB matrix, so each part is loaded with unit stride, and every
+// row accumulates the real and imaginary parts of its sum in two real
+// registers.  The reductions of the CSR kernel shuffle real values rather
+// than pairs.  The vectors x and y hold cusp::complex values.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+// (re, im) += (a + i b) * x
+template <typename RealType, typename ValueType>
+__device__ __forceinline__
+void split_complex_accumulate(RealType& re, RealType& im, const RealType a, const RealType b, const ValueType& x)
+{
+    re += a * x.real() - b * x.imag();
+    im += a * x.imag() + b * x.real();
+}
+
+template <typename OffsetType, typename IndexType, typename RealType, typename ValueType, unsigned int VECTORS_PER_BLOCK, unsigned int THREADS_PER_VECTOR, bool UseCache>
+__launch_bounds__(VECTORS_PER_BLOCK * THREADS_PER_VECTOR,1)
+__global__ void
+spmv_split_complex_csr_kernel(const IndexType num_rows,
+                              const OffsetType * Ap,
+                              const IndexType  * Aj,
+                              const RealType   * Ar,
+                              const RealType   * Ai,
+                              const ValueType  * x,
+                                    ValueType  * y)
+{
+#if __CUDA_ARCH__ >= 300
+    const unsigned int mask = segment_mask<THREADS_PER_VECTOR>();                 // lanes of this vector
+#else
+    __shared__ volatile RealType   sre[VECTORS_PER_BLOCK * THREADS_PER_VECTOR + THREADS_PER_VECTOR / 2];  // padded to avoid reduction conditionals
+    __shared__ volatile RealType   sim[VECTORS_PER_BLOCK * THREADS_PER_VECTOR + THREADS_PER_VECTOR / 2];
+    __shared__ volatile OffsetType ptrs[VECTORS_PER_BLOCK][2];
+#endif
+
+    const IndexType THREADS_PER_BLOCK = VECTORS_PER_BLOCK * THREADS_PER_VECTOR;
+
+    const IndexType thread_id   = THREADS_PER_BLOCK * blockIdx.x + threadIdx.x;    // global thread index
+    const IndexType thread_lane = threadIdx.x & (THREADS_PER_VECTOR - 1);          // thread index within the vector
+    const IndexType vector_id   = thread_id   /  THREADS_PER_VECTOR;               // global vector index
+    const IndexType vector_lane = threadIdx.x /  THREADS_PER_VECTOR;               // vector index within the block
+    const IndexType num_vectors = VECTORS_PER_BLOCK * gridDim.x;                   // total number of active vectors
+
+    for(IndexType row = vector_id; row < num_rows; row += num_vectors)
+    {
+#if __CUDA_ARCH__ >= 300
+        OffsetType ptr = 0;
+        if(thread_lane < 2)
+            ptr = Ap[row + thread_lane];
+
+        const OffsetType row_start = shfl(mask, ptr, 0, THREADS_PER_VECTOR);
+        const OffsetType row_end   = shfl(mask, ptr, 1, THREADS_PER_VECTOR);
+#else
+        if(thread_lane < 2)
+            ptrs[vector_lane][thread_lane] = Ap[row + thread_lane];
+
+        const OffsetType row_start = ptrs[vector_lane][0];
+        const OffsetType row_end   = ptrs[vector_lane][1];
+#endif
+
+        RealType re = 0;
+        RealType im = 0;
+
+        for(OffsetType jj = row_start + thread_lane; jj < row_end; jj += THREADS_PER_VECTOR)
+            split_complex_accumulate(re, im, Ar[jj], Ai[jj], fetch_x<UseCache>(Aj[jj], x));
+
+#if __CUDA_ARCH__ >= 300
+        // reduce the parts separately
+#pragma unroll
+        for (unsigned int offset = THREADS_PER_VECTOR / 2; offset > 0; offset /= 2)
+        {
+            re += shfl_down(mask, re, offset, THREADS_PER_VECTOR);
+            im += shfl_down(mask, im, offset, THREADS_PER_VECTOR);
+        }
+
+        if (thread_lane == 0)
+            y[row] = ValueType(re, im);
+#else
+        sre[threadIdx.x] = re;
+        sim[threadIdx.x] = im;
+
+        if (THREADS_PER_VECTOR > 16) { sre[threadIdx.x] = re = re + sre[threadIdx.x + 16]; sim[threadIdx.x] = im = im + sim[threadIdx.x + 16]; }
+        if (THREADS_PER_VECTOR >  8) { sre[threadIdx.x] = re = re + sre[threadIdx.x +  8]; sim[threadIdx.x] = im = im + sim[threadIdx.x +  8]; }
+        if (THREADS_PER_VECTOR >  4) { sre[threadIdx.x] = re = re + sre[threadIdx.x +  4]; sim[threadIdx.x] = im = im + sim[threadIdx.x +  4]; }
+        if (THREADS_PER_VECTOR >  2) { sre[threadIdx.x] = re = re + sre[threadIdx.x +  2]; sim[threadIdx.x] = im = im + sim[threadIdx.x +  2]; }
+        if (THREADS_PER_VECTOR >  1) { sre[threadIdx.x] = re = re + sre[threadIdx.x +  1]; sim[threadIdx.x] = im = im + sim[threadIdx.x +  1]; }
+
+        if (thread_lane == 0)
+            y[row] = ValueType(RealType(sre[threadIdx.x]), RealType(sim[threadIdx.x]));
+#endif
+    }
+}
+
+template <typename IndexType, typename RealType, typename ValueType, bool UseCache>
+__global__ void
+spmv_split_complex_ell_kernel(const IndexType num_rows,
+                              const IndexType num_cols_per_row,
+                              const IndexType pitch,
+                              const IndexType * Aj,
+                              const RealType  * Ar,
+                              const RealType  * Ai,
+                              const ValueType * x,
+                                    ValueType * y)
+{
+    const IndexType invalid_index = cusp::ell_matrix<IndexType, RealType, cusp::device_memory>::invalid_index;
+
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += grid_size)
+    {
+        RealType re = 0;
+        RealType im = 0;
+
+        IndexType offset = row;
+
+        for(IndexType n = 0; n < num_cols_per_row; n++)
+        {
+            const IndexType col = Aj[offset];
+
+            if (col != invalid_index)
+                split_complex_accumulate(re, im, Ar[offset], Ai[offset], fetch_x<UseCache>(col, x));
+
+            offset += pitch;
+        }
+
+        y[row] = ValueType(re, im);
+    }
+}
+
+// y[i] += the COO entries of row i, which the ELL kernel has written
+template <typename IndexType, typename RealType, typename ValueType, bool UseCache>
+__global__ void
+spmv_split_complex_coo_kernel(const IndexType num_entries,
+                              const IndexType * I,
+                              const IndexType * J,
+                              const RealType  * Ar,
+                              const RealType  * Ai,
+                              const ValueType * x,
+                                    ValueType * y)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType n = thread_id; n < num_entries; n += grid_size)
+    {
+        RealType re = 0;
+        RealType im = 0;
+
+        split_complex_accumulate(re, im, Ar[n], Ai[n], fetch_x<UseCache>(J[n], x));
+
+        atomic_add(y + I[n], ValueType(re, im));
+    }
+}
+
+// serial version of spmv_split_complex_coo_kernel for targets without atomics
+template <typename IndexType, typename RealType, typename ValueType>
+__global__ void
+spmv_split_complex_coo_serial_kernel(const IndexType num_entries,
+                                     const IndexType * I,
+                                     const IndexType * J,
+                                     const RealType  * Ar,
+                                     const RealType  * Ai,
+                                     const ValueType * x,
+                                           ValueType * y)
+{
+    for(IndexType n = 0; n < num_entries; n++)
+    {
+        RealType re = y[I[n]].real();
+        RealType im = y[I[n]].imag();
+
+        split_complex_accumulate(re, im, Ar[n], Ai[n], x[J[n]]);
+
+        y[I[n]] = ValueType(re, im);
+    }
+}
+
+template <bool UseCache, unsigned int THREADS_PER_VECTOR, typename Matrix, typename Array, typename ValueType>
+void __spmv_split_complex_csr(const Matrix&    A,
+                              const Array&     imag,
+                              const ValueType* x,
+                                    ValueType* y)
+{
+    typedef typename Matrix::row_offsets_array_type::value_type    OffsetType;
+    typedef typename Matrix::column_indices_array_type::value_type IndexType;
+    typedef typename Matrix::value_type                            RealType;
+
+    const size_t THREADS_PER_BLOCK  = 128;
+    const size_t VECTORS_PER_BLOCK  = THREADS_PER_BLOCK / THREADS_PER_VECTOR;
+
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_split_complex_csr_kernel<OffsetType, IndexType, RealType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, UseCache>, THREADS_PER_BLOCK, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, VECTORS_PER_BLOCK));
+
+    spmv_split_complex_csr_kernel<OffsetType, IndexType, RealType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, UseCache> <<<NUM_BLOCKS, THREADS_PER_BLOCK, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows),
+         thrust::raw_pointer_cast(&A.row_offsets[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         thrust::raw_pointer_cast(&imag[0]),
+         x, y);
+}
+
+// the vector width follows the mean row length as in spmv_csr_vector
+template <bool UseCache, typename Matrix, typename Array, typename ValueType>
+void __spmv_split_complex(const Matrix&    A,
+                          const Array&     imag,
+                          const ValueType* x,
+                                ValueType* y,
+                          cusp::csr_format)
+{
+    if (A.num_rows == 0)
+        return;
+
+    const double mean = cusp::detail::get_row_statistics(A).mean;
+
+    if (mean <   3) { __spmv_split_complex_csr<UseCache, 2>(A, imag, x, y); return; }
+    if (mean <   5) { __spmv_split_complex_csr<UseCache, 4>(A, imag, x, y); return; }
+    if (mean <   9) { __spmv_split_complex_csr<UseCache, 8>(A, imag, x, y); return; }
+    if (mean <  17) { __spmv_split_complex_csr<UseCache,16>(A, imag, x, y); return; }
+
+    __spmv_split_complex_csr<UseCache,32>(A, imag, x, y);
+}
+
+template <bool UseCache, typename Matrix, typename Array, typename ValueType>
+void __spmv_split_complex_ell(const Matrix&    A,
+                              const Array&     imag,
+                              const ValueType* x,
+                                    ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type RealType;
+
+    if (A.num_rows == 0)
+        return;
+
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_split_complex_ell_kernel<IndexType, RealType, ValueType, UseCache>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+
+    // the imaginary parts share the pitch of the column indices and real parts
+    spmv_split_complex_ell_kernel<IndexType, RealType, ValueType, UseCache> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows),
+         IndexType(A.column_indices.num_cols),
+         IndexType(A.column_indices.pitch),
+         thrust::raw_pointer_cast(&A.column_indices.values[0]),
+         thrust::raw_pointer_cast(&A.values.values[0]),
+         thrust::raw_pointer_cast(&imag[0]),
+         x, y);
+}
+
+template <bool UseCache, typename Matrix, typename Array, typename ValueType>
+void __spmv_split_complex(const Matrix&    A,
+                          const Array&     imag,
+                          const ValueType* x,
+                                ValueType* y,
+                          cusp::ell_format)
+{
+    __spmv_split_complex_ell<UseCache>(A, imag, x, y);
+}
+
+template <bool UseCache, typename Matrix, typename Array, typename ValueType>
+void __spmv_split_complex(const Matrix&    A,
+                          const Array&     imag,
+                          const ValueType* x,
+                                ValueType* y,
+                          cusp::hyb_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type RealType;
+
+    __spmv_split_complex_ell<UseCache>(A.ell, imag, x, y);
+
+    if (A.coo.num_entries == 0)
+        return;
+
+    // the imaginary parts of the COO entries follow the ELL storage
+    const IndexType  num_entries = A.coo.num_entries;
+    const IndexType* I           = thrust::raw_pointer_cast(&A.coo.row_indices[0]);
+    const IndexType* J           = thrust::raw_pointer_cast(&A.coo.column_indices[0]);
+    const RealType*  Ar          = thrust::raw_pointer_cast(&A.coo.values[0]);
+    const RealType*  Ai          = thrust::raw_pointer_cast(&imag[0]) + A.ell.values.values.size();
+
+    if (!atomic_add_supported(spmv_split_complex_coo_kernel<IndexType, RealType, ValueType, UseCache>))
+    {
+        spmv_split_complex_coo_serial_kernel<IndexType, RealType, ValueType> <<<1, 1, 0, cusp::detail::current_stream()>>>
+            (num_entries, I, J, Ar, Ai, x, y);
+        return;
+    }
+
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_split_complex_coo_kernel<IndexType, RealType, ValueType, UseCache>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(num_entries, BLOCK_SIZE));
+
+    spmv_split_complex_coo_kernel<IndexType, RealType, ValueType, UseCache> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (num_entries, I, J, Ar, Ai, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_split_complex(const Matrix&    A,
+                        const ValueType* x,
+                              ValueType* y)
+{
+    __spmv_split_complex<false>(A.real, A.imag, x, y, typename Matrix::real_matrix_type::format());
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_split_complex_tex(const Matrix&    A,
+                            const ValueType* x,
+                                  ValueType* y)
+{
+    __spmv_split_complex<true>(A.real, A.imag, x, y, typename Matrix::real_matrix_type::format());
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
@@ -0,0 +1,175 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/utils.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+////////////////////////////////////////////////////////////////////////
+// Matrix-free stencil SpMV
+///////////////////////////////////////////////////////////////////////
+//
+// y[p] = sum_k values[k] * x[p + offsets[k]] over a grid of up to three
+// dimensions, where points outside of the grid contribute zero.
+//
+// Each block computes a TILE_X by TILE_Y tile of one plane of the grid,
+// one point per thread.  The block first loads the tile of x, extended by
+// the stencil radius in every direction (including the neighboring planes),
+// into shared memory, so that every value of x is read from memory about
+// once instead of once per stencil point.  The blocks loop over the planes.
+//
+// Stencils whose extended tile does not fit in shared memory, and grids
+// too large for the launch, use one thread per point without tiling.
+//
+
+const unsigned int STENCIL_TILE_X = 32;
+const unsigned int STENCIL_TILE_Y = 8;
+
+// the extended tile: (TILE_X + 2 rx) x (TILE_Y + 2 ry) x (2 rz + 1)
+template <typename Stencil>
+size_t stencil_tile_size(const Stencil& s)
+{
+    return (STENCIL_TILE_X + 2 * s.radius[0]) * (STENCIL_TILE_Y + 2 * s.radius[1]) * (2 * s.radius[2] + 1);
+}
+
+template <unsigned int TILE_X, unsigned int TILE_Y, typename IndexType, typename ValueType, typename Stencil>
+__launch_bounds__(TILE_X * TILE_Y)
+__global__ void
+spmv_stencil_tiled_kernel(const Stencil s,
+                          const ValueType * x,
+                                ValueType * y)
+{
+    // int4 ensures the alignment of any ValueType
+    extern __shared__ int4 stencil_shared[];
+    ValueType * tile = reinterpret_cast<ValueType *>(stencil_shared);
+
+    const int rx = s.radius[0];
+    const int ry = s.radius[1];
+    const int rz = s.radius[2];
+
+    const int wx = TILE_X + 2 * rx;
+    const int wy = TILE_Y + 2 * ry;
+    const int tile_size = wx * wy * (2 * rz + 1);
+
+    const int nx = s.grid[0];
+    const int ny = s.grid[1];
+    const int nz = s.grid[2];
+
+    const int x0 = blockIdx.x * TILE_X;
+    const int y0 = blockIdx.y * TILE_Y;
+
+    const int thread_id = threadIdx.y * TILE_X + threadIdx.x;
+
+    const int gx = x0 + threadIdx.x;
+    const int gy = y0 + threadIdx.y;
+
+    for (int z = blockIdx.z; z < nz; z += gridDim.z)
+    {
+        // the previous plane has been consumed
+        __syncthreads();
+
+        for (int k = thread_id; k < tile_size; k += TILE_X * TILE_Y)
+        {
+            const int tx = x0 + k % wx - rx;
+            const int ty = y0 + (k / wx) % wy - ry;
+            const int tz = z + k / (wx * wy) - rz;
+
+            if (tx >= 0 && tx < nx && ty >= 0 && ty < ny && tz >= 0 && tz < nz)
+                tile[k] = x[tx + IndexType(nx) * (ty + IndexType(ny) * tz)];
+            else
+                tile[k] = ValueType(0);
+        }
+
+        __syncthreads();
+
+        if (gx < nx && gy < ny)
+        {
+            ValueType sum = 0;
+
+            for (int p = 0; p < s.num_points; p++)
+                sum += s.values[p] * tile[(threadIdx.x + rx + s.offsets[p][0]) +
+                                          wx * ((threadIdx.y + ry + s.offsets[p][1]) + wy * (rz + s.offsets[p][2]))];
+
+            y[gx + IndexType(nx) * (gy + IndexType(ny) * z)] = sum;
+        }
+    }
+}
+
+template <typename IndexType, typename ValueType, typename Stencil>
+__global__ void
+spmv_stencil_kernel(const IndexType num_rows,
+                    const Stencil s,
+                    const ValueType * x,
+                          ValueType * y)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for (IndexType row = thread_id; row < num_rows; row += grid_size)
+        y[row] = s.template row_product<IndexType>(row, x);
+}
+
+template <typename IndexType, typename ValueType, typename Stencil>
+void spmv_stencil(const Stencil& s,
+                  const ValueType * x,
+                        ValueType * y)
+{
+    const IndexType num_rows = IndexType(s.grid[0]) * s.grid[1] * s.grid[2];
+
+    if (num_rows == 0)
+        return;
+
+    const size_t MAX_SHARED_BYTES = 48 * 1024;
+    const size_t MAX_GRID_DIMENSION = 65535;
+
+    const size_t tile_bytes = stencil_tile_size(s) * sizeof(ValueType);
+    const size_t num_tiles_y = DIVIDE_INTO(s.grid[1], STENCIL_TILE_Y);
+
+    if (tile_bytes <= MAX_SHARED_BYTES && num_tiles_y <= MAX_GRID_DIMENSION)
+    {
+        const dim3 block(STENCIL_TILE_X, STENCIL_TILE_Y, 1);
+        const dim3 grid(DIVIDE_INTO(s.grid[0], STENCIL_TILE_X), num_tiles_y, std::min<size_t>(s.grid[2], MAX_GRID_DIMENSION));
+
+        spmv_stencil_tiled_kernel<STENCIL_TILE_X, STENCIL_TILE_Y, IndexType, ValueType, Stencil> <<<grid, block, tile_bytes, cusp::detail::current_stream()>>>
+            (s, x, y);
+    }
+    else
+    {
+        const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+        const size_t MAX_BLOCKS = cusp::detail::device::arch::max_blocks(spmv_stencil_kernel<IndexType, ValueType, Stencil>, BLOCK_SIZE, (size_t) 0);
+        const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(num_rows, BLOCK_SIZE));
+
+        spmv_stencil_kernel<IndexType, ValueType, Stencil> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+            (num_rows, s, x, y);
+    }
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
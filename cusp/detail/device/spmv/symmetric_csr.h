@@ -0,0 +1,275 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array1d.h>
+
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/atomic.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/utils.h>
+#include <cusp/detail/device/texture.h>
+
+#include <thrust/device_ptr.h>
+#include <thrust/functional.h>
+#include <thrust/reduce.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// Symmetric CSR SpMV kernel (one vector per row)
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmv_symmetric_csr_vector_kernel
+//   Same as spmv_csr_vector_kernel on the stored upper triangle.  With
+//   Transpose each strictly upper entry A(i,j) also adds A(i,j) * x[i] to
+//   y[j], so rows receive contributions from other rows and all updates
+//   of y are atomic; y must be zero on entry.  Without Transpose the row
+//   sums are stored in y and the lower triangle is applied separately.
+//
+//  Note: THREADS_PER_VECTOR must be one of [2,4,8,16,32]
+
+template <typename IndexType, typename ValueType, unsigned int VECTORS_PER_BLOCK, unsigned int THREADS_PER_VECTOR, bool Transpose, bool UseCache>
+__launch_bounds__(VECTORS_PER_BLOCK * THREADS_PER_VECTOR,1)
+__global__ void
+spmv_symmetric_csr_vector_kernel(const IndexType num_rows,
+                                 const IndexType * Ap,
+                                 const IndexType * Aj,
+                                 const ValueType * Ax,
+                                 const ValueType * x,
+                                       ValueType * y)
+{
+    __shared__ volatile ValueType sdata[VECTORS_PER_BLOCK * THREADS_PER_VECTOR + THREADS_PER_VECTOR / 2];  // padded to avoid reduction conditionals
+    __shared__ volatile IndexType ptrs[VECTORS_PER_BLOCK][2];
+
+    const IndexType THREADS_PER_BLOCK = VECTORS_PER_BLOCK * THREADS_PER_VECTOR;
+
+    const IndexType thread_id   = THREADS_PER_BLOCK * blockIdx.x + threadIdx.x;    // global thread index
+    const IndexType thread_lane = threadIdx.x & (THREADS_PER_VECTOR - 1);          // thread index within the vector
+    const IndexType vector_id   = thread_id   /  THREADS_PER_VECTOR;               // global vector index
+    const IndexType vector_lane = threadIdx.x /  THREADS_PER_VECTOR;               // vector index within the block
+    const IndexType num_vectors = VECTORS_PER_BLOCK * gridDim.x;                   // total number of active vectors
+
+    for(IndexType row = vector_id; row < num_rows; row += num_vectors)
+    {
+        // use two threads to fetch Ap[row] and Ap[row+1]
+        if(thread_lane < 2)
+            ptrs[vector_lane][thread_lane] = Ap[row + thread_lane];
+
+        const IndexType row_start = ptrs[vector_lane][0];
+        const IndexType row_end   = ptrs[vector_lane][1];
+
+        const ValueType x_row = Transpose ? fetch_x<UseCache>(row, x) : ValueType(0);
+
+        // initialize local sum
+        ValueType sum = 0;
+
+        for(IndexType jj = row_start + thread_lane; jj < row_end; jj += THREADS_PER_VECTOR)
+        {
+            const IndexType col  = Aj[jj];
+            const ValueType A_ij = Ax[jj];
+
+            sum += A_ij * fetch_x<UseCache>(col, x);
+
+            // transposed contribution of a strictly upper entry
+            if (Transpose && col != row)
+                atomic_add(y + col, A_ij * x_row);
+        }
+
+        // store local sum in shared memory
+        sdata[threadIdx.x] = sum;
+
+        // reduce local sums to row sum
+        if (THREADS_PER_VECTOR > 16) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x + 16];
+        if (THREADS_PER_VECTOR >  8) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  8];
+        if (THREADS_PER_VECTOR >  4) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  4];
+        if (THREADS_PER_VECTOR >  2) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  2];
+        if (THREADS_PER_VECTOR >  1) sdata[threadIdx.x] = sum = sum + sdata[threadIdx.x +  1];
+
+        // first thread writes the result
+        if (thread_lane == 0)
+        {
+            if (Transpose)
+                atomic_add(y + row, ValueType(sdata[threadIdx.x]));
+            else
+                y[row] = sdata[threadIdx.x];
+        }
+    }
+}
+
+template <bool UseCache, bool Transpose, unsigned int THREADS_PER_VECTOR, typename Matrix, typename ValueType>
+void __spmv_symmetric_csr_vector(const Matrix&    A,
+                                 const ValueType* x,
+                                       ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    const size_t THREADS_PER_BLOCK  = 128;
+    const size_t VECTORS_PER_BLOCK  = THREADS_PER_BLOCK / THREADS_PER_VECTOR;
+
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_symmetric_csr_vector_kernel<IndexType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, Transpose, UseCache>, THREADS_PER_BLOCK, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, VECTORS_PER_BLOCK));
+
+    spmv_symmetric_csr_vector_kernel<IndexType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, Transpose, UseCache> <<<NUM_BLOCKS, THREADS_PER_BLOCK, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows),
+         thrust::raw_pointer_cast(&A.row_offsets[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         x, y);
+}
+
+// THREADS_PER_VECTOR is selected from the mean stored row length as in
+// __spmv_csr_vector_adaptive.
+template <bool UseCache, bool Transpose, typename Matrix, typename ValueType>
+void __spmv_symmetric_csr_adaptive(const Matrix&    A,
+                                   const ValueType* x,
+                                         ValueType* y)
+{
+    const double mean = double(A.num_stored_entries()) / double(A.num_rows);
+
+    if      (mean <  3) __spmv_symmetric_csr_vector<UseCache, Transpose, 2>(A, x, y);
+    else if (mean <  5) __spmv_symmetric_csr_vector<UseCache, Transpose, 4>(A, x, y);
+    else if (mean <  9) __spmv_symmetric_csr_vector<UseCache, Transpose, 8>(A, x, y);
+    else if (mean < 17) __spmv_symmetric_csr_vector<UseCache, Transpose,16>(A, x, y);
+    else                __spmv_symmetric_csr_vector<UseCache, Transpose,32>(A, x, y);
+}
+
+template <typename ValueType>
+struct symmetric_csr_transpose_product
+{
+  typedef ValueType result_type;
+
+  template <typename Tuple>
+    __host__ __device__
+  ValueType operator()(const Tuple& t) const
+  {
+    // A(i,j) * x[i] for strictly upper entries, zero on the diagonal
+    return thrust::get<0>(t) == thrust::get<1>(t) ? ValueType(0) : ValueType(thrust::get<2>(t) * thrust::get<3>(t));
+  }
+};
+
+// Applies the lower triangle without atomics: the products A(i,j) * x[i]
+// of the strictly upper entries are sorted by j and reduced, then added
+// to y, as in the expand-sort-contract SpGEMM.
+template <typename Matrix, typename ValueType>
+void __spmv_symmetric_csr_lower(const Matrix&    A,
+                                const ValueType* x,
+                                      ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    const size_t num_stored_entries = A.num_stored_entries();
+
+    thrust::device_ptr<const ValueType> x_ptr(x);
+    thrust::device_ptr<ValueType>       y_ptr(y);
+
+    cusp::array1d<IndexType, cusp::device_memory> rows(num_stored_entries);
+    cusp::detail::offsets_to_indices(A.row_offsets, rows);
+
+    cusp::array1d<IndexType, cusp::device_memory> keys(A.column_indices);
+    cusp::array1d<ValueType, cusp::device_memory> products(num_stored_entries);
+
+    thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), A.column_indices.begin(), A.values.begin(), thrust::make_permutation_iterator(x_ptr, rows.begin()))),
+                      thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), A.column_indices.begin(), A.values.begin(), thrust::make_permutation_iterator(x_ptr, rows.begin()))) + num_stored_entries,
+                      products.begin(),
+                      symmetric_csr_transpose_product<ValueType>());
+
+    thrust::sort_by_key(keys.begin(), keys.end(), products.begin());
+
+    cusp::array1d<IndexType, cusp::device_memory> columns(num_stored_entries);
+    cusp::array1d<ValueType, cusp::device_memory> sums(num_stored_entries);
+
+    const size_t num_columns =
+      thrust::reduce_by_key(keys.begin(), keys.end(),
+                            products.begin(),
+                            columns.begin(),
+                            sums.begin()).first - columns.begin();
+
+    thrust::transform(sums.begin(), sums.begin() + num_columns,
+                      thrust::make_permutation_iterator(y_ptr, columns.begin()),
+                      thrust::make_permutation_iterator(y_ptr, columns.begin()),
+                      thrust::plus<ValueType>());
+}
+
+template <typename Matrix>
+bool spmv_symmetric_csr_atomics_supported(void)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    static cusp::detail::once_value<bool> supported;
+
+    return cusp::detail::initialize_once(supported, make_atomic_add_query(spmv_symmetric_csr_vector_kernel<IndexType, ValueType, 4, 32, true, false>));
+}
+
+template <bool UseCache,
+          typename Matrix,
+          typename ValueType>
+void __spmv_symmetric_csr(const Matrix&    A,
+                          const ValueType* x,
+                                ValueType* y)
+{
+    if (A.num_rows == 0)
+        return;
+
+    if (spmv_symmetric_csr_atomics_supported<Matrix>())
+    {
+        cudaMemsetAsync(y, 0, A.num_rows * sizeof(ValueType), cusp::detail::current_stream());
+        __spmv_symmetric_csr_adaptive<UseCache, true>(A, x, y);
+    }
+    else
+    {
+        __spmv_symmetric_csr_adaptive<UseCache, false>(A, x, y);
+        __spmv_symmetric_csr_lower(A, x, y);
+    }
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_symmetric_csr(const Matrix&    A,
+                        const ValueType* x,
+                              ValueType* y)
+{
+    __spmv_symmetric_csr<false>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_symmetric_csr_tex(const Matrix&    A,
+                            const ValueType* x,
+                                  ValueType* y)
+{
+    __spmv_symmetric_csr<true>(A, x, y);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
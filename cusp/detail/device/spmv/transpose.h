@@ -0,0 +1,517 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/ell_matrix.h>
+
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/atomic.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/utils.h>
+#include <cusp/detail/device/texture.h>
+
+#include <thrust/device_ptr.h>
+#include <thrust/functional.h>
+#include <thrust/reduce.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/permutation_iterator.h>
+
+#include <algorithm>
+
+// Transposed SpMV kernels, y += A^T x, for the COO, CSR and ELL formats.
+// The matrix is traversed in its storage order and every product
+// A(i,j) * x[i] is added to y[j] atomically, so A^T is never formed.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+template <typename IndexType, typename ValueType, size_t BLOCK_SIZE, bool UseCache>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+spmv_coo_transpose_kernel(const IndexType num_entries,
+                          const IndexType * Ai,
+                          const IndexType * Aj,
+                          const ValueType * Ax,
+                          const ValueType * x,
+                                ValueType * y)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType n = thread_id; n < num_entries; n += grid_size)
+        atomic_add(y + Aj[n], Ax[n] * fetch_x<UseCache>(Ai[n], x));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// CSR transposed SpMV kernel (one vector per row)
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmv_csr_transpose_vector_kernel
+//   Each vector loads x[row] once and scatters the products of the entries
+//   of the row to y.  The vector width is selected from the mean row length
+//   as in __spmv_csr_vector_adaptive.
+//
+//  Note: THREADS_PER_VECTOR must be one of [2,4,8,16,32]
+
+template <typename IndexType, typename ValueType, unsigned int VECTORS_PER_BLOCK, unsigned int THREADS_PER_VECTOR, bool UseCache>
+__launch_bounds__(VECTORS_PER_BLOCK * THREADS_PER_VECTOR,1)
+__global__ void
+spmv_csr_transpose_vector_kernel(const IndexType num_rows,
+                                 const IndexType * Ap,
+                                 const IndexType * Aj,
+                                 const ValueType * Ax,
+                                 const ValueType * x,
+                                       ValueType * y)
+{
+    __shared__ volatile IndexType ptrs[VECTORS_PER_BLOCK][2];
+
+    const IndexType THREADS_PER_BLOCK = VECTORS_PER_BLOCK * THREADS_PER_VECTOR;
+
+    const IndexType thread_id   = THREADS_PER_BLOCK * blockIdx.x + threadIdx.x;    // global thread index
+    const IndexType thread_lane = threadIdx.x & (THREADS_PER_VECTOR - 1);          // thread index within the vector
+    const IndexType vector_id   = thread_id   /  THREADS_PER_VECTOR;               // global vector index
+    const IndexType vector_lane = threadIdx.x /  THREADS_PER_VECTOR;               // vector index within the block
+    const IndexType num_vectors = VECTORS_PER_BLOCK * gridDim.x;                   // total number of active vectors
+
+    for(IndexType row = vector_id; row < num_rows; row += num_vectors)
+    {
+        // use two threads to fetch Ap[row] and Ap[row+1]
+        if(thread_lane < 2)
+            ptrs[vector_lane][thread_lane] = Ap[row + thread_lane];
+
+        const IndexType row_start = ptrs[vector_lane][0];
+        const IndexType row_end   = ptrs[vector_lane][1];
+
+        const ValueType x_row = fetch_x<UseCache>(row, x);
+
+        for(IndexType jj = row_start + thread_lane; jj < row_end; jj += THREADS_PER_VECTOR)
+            atomic_add(y + Aj[jj], Ax[jj] * x_row);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// CSR residual fused with a transposed CSR product
+//////////////////////////////////////////////////////////////////////////////
+//
+// spmv_csr_residual_transpose_kernel
+//   Each thread computes the residual b[row] - (A x)[row] of a row in a
+//   register and scatters it through the same row of P, hence y += P^T r
+//   is computed without storing r.  P has the rows of A, as the
+//   prolongator of a multigrid level.
+
+template <typename IndexType, typename ValueType, size_t BLOCK_SIZE>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+spmv_csr_residual_transpose_kernel(const IndexType num_rows,
+                                   const IndexType * Ap,
+                                   const IndexType * Aj,
+                                   const ValueType * Ax,
+                                   const IndexType * Pp,
+                                   const IndexType * Pj,
+                                   const ValueType * Px,
+                                   const ValueType * x,
+                                   const ValueType * b,
+                                         ValueType * y)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += grid_size)
+    {
+        ValueType r = b[row];
+
+        for(IndexType jj = Ap[row]; jj < Ap[row + 1]; jj++)
+            r -= Ax[jj] * x[Aj[jj]];
+
+        for(IndexType jj = Pp[row]; jj < Pp[row + 1]; jj++)
+            atomic_add(y + Pj[jj], Px[jj] * r);
+    }
+}
+
+template <typename IndexType, typename ValueType, size_t BLOCK_SIZE, bool UseCache>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+spmv_ell_transpose_kernel(const IndexType num_rows,
+                          const IndexType num_cols_per_row,
+                          const IndexType pitch,
+                          const IndexType * Aj,
+                          const ValueType * Ax,
+                          const ValueType * x,
+                                ValueType * y)
+{
+    const IndexType invalid_index = cusp::ell_matrix<IndexType, ValueType, cusp::device_memory>::invalid_index;
+
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += grid_size)
+    {
+        const ValueType x_row = fetch_x<UseCache>(row, x);
+
+        IndexType offset = row;
+
+        for(IndexType n = 0; n < num_cols_per_row; n++)
+        {
+            const IndexType col = Aj[offset];
+
+            if (col != invalid_index)
+                atomic_add(y + col, Ax[offset] * x_row);
+
+            offset += pitch;
+        }
+    }
+}
+
+template <bool UseCache, typename Matrix, typename ValueType>
+void __spmv_coo_transpose_atomic(const Matrix&    A,
+                                 const ValueType* x,
+                                       ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    if (A.num_entries == 0)
+        return;
+
+    const size_t BLOCK_SIZE = 256;
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_coo_transpose_kernel<IndexType,ValueType,BLOCK_SIZE,UseCache>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_entries, BLOCK_SIZE));
+
+    spmv_coo_transpose_kernel<IndexType,ValueType,BLOCK_SIZE,UseCache> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_entries),
+         thrust::raw_pointer_cast(&A.row_indices[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         x, y);
+}
+
+template <bool UseCache, unsigned int THREADS_PER_VECTOR, typename Matrix, typename ValueType>
+void __spmv_csr_transpose_vector(const Matrix&    A,
+                                 const ValueType* x,
+                                       ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    const size_t THREADS_PER_BLOCK  = 128;
+    const size_t VECTORS_PER_BLOCK  = THREADS_PER_BLOCK / THREADS_PER_VECTOR;
+
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_csr_transpose_vector_kernel<IndexType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, UseCache>, THREADS_PER_BLOCK, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, VECTORS_PER_BLOCK));
+
+    spmv_csr_transpose_vector_kernel<IndexType, ValueType, VECTORS_PER_BLOCK, THREADS_PER_VECTOR, UseCache> <<<NUM_BLOCKS, THREADS_PER_BLOCK, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows),
+         thrust::raw_pointer_cast(&A.row_offsets[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         x, y);
+}
+
+template <bool UseCache, typename Matrix, typename ValueType>
+void __spmv_csr_transpose_atomic(const Matrix&    A,
+                                 const ValueType* x,
+                                       ValueType* y)
+{
+    if (A.num_rows == 0)
+        return;
+
+    const double mean = double(A.num_entries) / double(A.num_rows);
+
+    if      (mean <  3) __spmv_csr_transpose_vector<UseCache, 2>(A, x, y);
+    else if (mean <  5) __spmv_csr_transpose_vector<UseCache, 4>(A, x, y);
+    else if (mean <  9) __spmv_csr_transpose_vector<UseCache, 8>(A, x, y);
+    else if (mean < 17) __spmv_csr_transpose_vector<UseCache,16>(A, x, y);
+    else                __spmv_csr_transpose_vector<UseCache,32>(A, x, y);
+}
+
+template <bool UseCache, typename Matrix, typename ValueType>
+void __spmv_ell_transpose_atomic(const Matrix&    A,
+                                 const ValueType* x,
+                                       ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    if (A.num_rows == 0 || A.column_indices.num_cols == 0)
+        return;
+
+    const size_t BLOCK_SIZE = 256;
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_ell_transpose_kernel<IndexType,ValueType,BLOCK_SIZE,UseCache>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+
+    const IndexType pitch               = A.column_indices.pitch;
+    const IndexType num_entries_per_row = A.column_indices.num_cols;
+
+    // the kernel indexes column_indices and values with one pitch
+    assert(A.column_indices.pitch == A.values.pitch);
+
+    spmv_ell_transpose_kernel<IndexType,ValueType,BLOCK_SIZE,UseCache> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows),
+         num_entries_per_row, pitch,
+         thrust::raw_pointer_cast(&A.column_indices.values[0]),
+         thrust::raw_pointer_cast(&A.values.values[0]),
+         x, y);
+}
+
+// Adds A^T x to y without atomics: the products A(i,j) * x[i] are sorted
+// by j and reduced, then added to y, as in __spmv_symmetric_csr_lower.
+template <typename Array1, typename Array2, typename Array3, typename ValueType>
+void __spmv_transpose_sort(const Array1&    row_indices,
+                           const Array2&    column_indices,
+                           const Array3&    values,
+                           const ValueType* x,
+                                 ValueType* y)
+{
+    typedef typename Array1::value_type IndexType;
+
+    const size_t num_entries = values.size();
+
+    if (num_entries == 0)
+        return;
+
+    thrust::device_ptr<const ValueType> x_ptr(x);
+    thrust::device_ptr<ValueType>       y_ptr(y);
+
+    cusp::array1d<IndexType, cusp::device_memory> keys(column_indices);
+    cusp::array1d<ValueType, cusp::device_memory> products(num_entries);
+
+    thrust::transform(values.begin(), values.end(),
+                      thrust::make_permutation_iterator(x_ptr, row_indices.begin()),
+                      products.begin(),
+                      thrust::multiplies<ValueType>());
+
+    thrust::sort_by_key(keys.begin(), keys.end(), products.begin());
+
+    cusp::array1d<IndexType, cusp::device_memory> columns(num_entries);
+    cusp::array1d<ValueType, cusp::device_memory> sums(num_entries);
+
+    const size_t num_columns =
+      thrust::reduce_by_key(keys.begin(), keys.end(),
+                            products.begin(),
+                            columns.begin(),
+                            sums.begin()).first - columns.begin();
+
+    thrust::transform(sums.begin(), sums.begin() + num_columns,
+                      thrust::make_permutation_iterator(y_ptr, columns.begin()),
+                      thrust::make_permutation_iterator(y_ptr, columns.begin()),
+                      thrust::plus<ValueType>());
+}
+
+template <typename IndexType, typename ValueType>
+bool spmv_transpose_atomics_supported(void)
+{
+    static cusp::detail::once_value<bool> supported;
+
+    return cusp::detail::initialize_once(supported, make_atomic_add_query(spmv_coo_transpose_kernel<IndexType, ValueType, 256, false>));
+}
+
+template <bool UseCache, typename Matrix, typename ValueType>
+void __spmv_coo_transpose(const Matrix&    A,
+                          const ValueType* x,
+                                ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    cudaMemsetAsync(y, 0, A.num_cols * sizeof(ValueType), cusp::detail::current_stream());
+
+    if (spmv_transpose_atomics_supported<IndexType,ValueType>())
+        __spmv_coo_transpose_atomic<UseCache>(A, x, y);
+    else
+        __spmv_transpose_sort(A.row_indices, A.column_indices, A.values, x, y);
+}
+
+template <bool UseCache, typename Matrix, typename ValueType>
+void __spmv_csr_transpose(const Matrix&    A,
+                          const ValueType* x,
+                                ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    cudaMemsetAsync(y, 0, A.num_cols * sizeof(ValueType), cusp::detail::current_stream());
+
+    if (spmv_transpose_atomics_supported<IndexType,ValueType>())
+    {
+        __spmv_csr_transpose_atomic<UseCache>(A, x, y);
+    }
+    else
+    {
+        cusp::array1d<IndexType, cusp::device_memory> rows(A.num_entries);
+        cusp::detail::offsets_to_indices(A.row_offsets, rows);
+        __spmv_transpose_sort(rows, A.column_indices, A.values, x, y);
+    }
+}
+
+template <bool UseCache, typename Matrix, typename ValueType>
+void __spmv_ell_transpose(const Matrix&    A,
+                          const ValueType* x,
+                                ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    cudaMemsetAsync(y, 0, A.num_cols * sizeof(ValueType), cusp::detail::current_stream());
+
+    if (spmv_transpose_atomics_supported<IndexType,ValueType>())
+    {
+        __spmv_ell_transpose_atomic<UseCache>(A, x, y);
+    }
+    else
+    {
+        cusp::coo_matrix<IndexType, ValueType, cusp::device_memory> B(A);
+        __spmv_transpose_sort(B.row_indices, B.column_indices, B.values, x, y);
+    }
+}
+
+template <bool UseCache, typename Matrix, typename ValueType>
+void __spmv_hyb_transpose(const Matrix&    A,
+                          const ValueType* x,
+                                ValueType* y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    cudaMemsetAsync(y, 0, A.num_cols * sizeof(ValueType), cusp::detail::current_stream());
+
+    if (spmv_transpose_atomics_supported<IndexType,ValueType>())
+    {
+        __spmv_ell_transpose_atomic<UseCache>(A.ell, x, y);
+        __spmv_coo_transpose_atomic<UseCache>(A.coo, x, y);
+    }
+    else
+    {
+        cusp::coo_matrix<IndexType, ValueType, cusp::device_memory> B(A.ell);
+        __spmv_transpose_sort(B.row_indices, B.column_indices, B.values, x, y);
+        __spmv_transpose_sort(A.coo.row_indices, A.coo.column_indices, A.coo.values, x, y);
+    }
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_coo_transpose(const Matrix&    A,
+                        const ValueType* x,
+                              ValueType* y)
+{
+    __spmv_coo_transpose<false>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_coo_transpose_tex(const Matrix&    A,
+                            const ValueType* x,
+                                  ValueType* y)
+{
+    __spmv_coo_transpose<true>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_csr_transpose(const Matrix&    A,
+                        const ValueType* x,
+                              ValueType* y)
+{
+    __spmv_csr_transpose<false>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_csr_transpose_tex(const Matrix&    A,
+                            const ValueType* x,
+                                  ValueType* y)
+{
+    __spmv_csr_transpose<true>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_ell_transpose(const Matrix&    A,
+                        const ValueType* x,
+                              ValueType* y)
+{
+    __spmv_ell_transpose<false>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_ell_transpose_tex(const Matrix&    A,
+                            const ValueType* x,
+                                  ValueType* y)
+{
+    __spmv_ell_transpose<true>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_hyb_transpose(const Matrix&    A,
+                        const ValueType* x,
+                              ValueType* y)
+{
+    __spmv_hyb_transpose<false>(A, x, y);
+}
+
+template <typename Matrix,
+          typename ValueType>
+void spmv_hyb_transpose_tex(const Matrix&    A,
+                            const ValueType* x,
+                                  ValueType* y)
+{
+    __spmv_hyb_transpose<true>(A, x, y);
+}
+
+// y <- P^T (b - A x), false when the target has no atomic additions
+template <typename Matrix1,
+          typename Matrix2,
+          typename ValueType>
+bool spmv_csr_residual_transpose(const Matrix1&   A,
+                                 const ValueType* x,
+                                 const ValueType* b,
+                                 const Matrix2&   P,
+                                       ValueType* y)
+{
+    typedef typename Matrix1::index_type IndexType;
+
+    if (!spmv_transpose_atomics_supported<IndexType,ValueType>())
+        return false;
+
+    cudaMemsetAsync(y, 0, P.num_cols * sizeof(ValueType), cusp::detail::current_stream());
+
+    if (A.num_rows == 0)
+        return true;
+
+    const size_t BLOCK_SIZE = 256;
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(spmv_csr_residual_transpose_kernel<IndexType,ValueType,BLOCK_SIZE>, BLOCK_SIZE, (size_t) 0);
+    const size_t NUM_BLOCKS = std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(A.num_rows, BLOCK_SIZE));
+
+    spmv_csr_residual_transpose_kernel<IndexType,ValueType,BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+        (IndexType(A.num_rows),
+         thrust::raw_pointer_cast(&A.row_offsets[0]),
+         thrust::raw_pointer_cast(&A.column_indices[0]),
+         thrust::raw_pointer_cast(&A.values[0]),
+         thrust::raw_pointer_cast(&P.row_offsets[0]),
+         thrust::raw_pointer_cast(&P.column_indices[0]),
+         thrust::raw_pointer_cast(&P.values[0]),
+         x, b, y);
+
+    return true;
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+// Wide loads of the padded column-major arrays of the ELL and DIA formats.
+//
+// A vectorized kernel assigns WIDTH consecutive rows to each thread and
+// fetches their entries in one column with a single 8 or 16-byte load.
+// This requires the pitch to be a multiple of WIDTH and the arrays to be
+// aligned to the size of the load, which the caller checks before it
+// launches the wide kernel.  The width follows from the index and value
+// types when the kernel is instantiated, other types use WIDTH = 1.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+template <typename T, unsigned int WIDTH> struct vector_type        { };
+template <typename T>                     struct vector_type<T,1>   { typedef T       type; };
+template <>                               struct vector_type<int,2>    { typedef int2    type; };
+template <>                               struct vector_type<int,4>    { typedef int4    type; };
+template <>                               struct vector_type<float,2>  { typedef float2  type; };
+template <>                               struct vector_type<float,4>  { typedef float4  type; };
+template <>                               struct vector_type<double,2> { typedef double2 type; };
+
+// number of values of type T in a 16-byte load
+template <typename T> struct vector_width         { static const unsigned int value = 1; };
+template <>           struct vector_width<int>    { static const unsigned int value = 4; };
+template <>           struct vector_width<float>  { static const unsigned int value = 4; };
+template <>           struct vector_width<double> { static const unsigned int value = 2; };
+
+// rows per thread when an index and a value array are loaded together
+template <typename IndexType, typename ValueType>
+struct vector_width_pair
+{
+    static const unsigned int value = vector_width<IndexType>::value < vector_width<ValueType>::value ?
+                                      vector_width<IndexType>::value : vector_width<ValueType>::value;
+};
+
+template <unsigned int WIDTH, typename T>
+__device__ __forceinline__
+void load_vector(const T * ptr, T (&values)[WIDTH])
+{
+    typedef typename vector_type<T,WIDTH>::type Vector;
+
+    const Vector v = *reinterpret_cast<const Vector *>(ptr);
+    const T * parts = reinterpret_cast<const T *>(&v);
+
+#pragma unroll
+    for(unsigned int i = 0; i < WIDTH; i++)
+        values[i] = parts[i];
+}
+
+template <unsigned int WIDTH, typename T>
+bool is_vector_aligned(const T * ptr, const size_t pitch)
+{
+    return pitch % WIDTH == 0 && reinterpret_cast<size_t>(ptr) % (WIDTH * sizeof(T)) == 0;
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
@@ -21,158 +21,74 @@
 #include <cusp/exception.h>
 #include <cusp/detail/device/utils.h>
 
-#ifdef CUSP_USE_TEXTURE_MEMORY    
-// These textures are (optionally) used to cache the 'x' vector in y += A*x
-texture<float,1> tex_x_float;
-texture<int2,1>  tex_x_double;
-#endif
-
-inline void bind_x(const float * x)
-{   
-#ifdef CUSP_USE_TEXTURE_MEMORY    
-    size_t offset = size_t(-1);
-    CUDA_SAFE_CALL(cudaBindTexture(&offset, tex_x_float, x));
-    if (offset != 0)
-        throw cusp::invalid_input_exception("memory is not aligned, refusing to use texture cache");
-#else
-    throw cusp::runtime_exception("texture support was not enabled");
-#endif
-}
-
-// Use int2 to pull doubles through texture cache
-inline void bind_x(const double * x)
-{   
-#ifdef CUSP_USE_TEXTURE_MEMORY    
-    size_t offset = size_t(-1);
-    CUDA_SAFE_CALL(cudaBindTexture(&offset, tex_x_double, x));
-    if (offset != 0)
-        throw cusp::invalid_input_exception("memory is not aligned, refusing to use texture cache");
-#else
-    throw cusp::runtime_exception("texture support was not enabled");
-#endif
-}
-
-
-inline void bind_x(const cusp::complex<float> * x)
-{   
-#ifdef CUSP_USE_TEXTURE_MEMORY    
-    size_t offset = size_t(-1);
-    CUDA_SAFE_CALL(cudaBindTexture(&offset, tex_x_float, x));
-    if (offset != 0)
-        throw cusp::invalid_input_exception("memory is not aligned, refusing to use texture cache");
-#else
-    throw cusp::runtime_exception("texture support was not enabled");
-#endif
-}
-
-// Use int2 to pull doubles through texture cache
-inline void bind_x(const cusp::complex<double> * x)
-{   
-#ifdef CUSP_USE_TEXTURE_MEMORY    
-    size_t offset = size_t(-1);
-    CUDA_SAFE_CALL(cudaBindTexture(&offset, tex_x_double, x));
-    if (offset != 0)
-        throw cusp::invalid_input_exception("memory is not aligned, refusing to use texture cache");
-#else
-    throw cusp::runtime_exception("texture support was not enabled");
-#endif
-}
-
-
-// Note: x is unused, but distinguishes the two unbind functions
-inline void unbind_x(const float * x)
-{
-#ifdef CUSP_USE_TEXTURE_MEMORY
-    CUDA_SAFE_CALL(cudaUnbindTexture(tex_x_float));
-#else
-    throw cusp::runtime_exception("texture support was not enabled");
-#endif
-}
-inline void unbind_x(const double * x)
-{
-#ifdef CUSP_USE_TEXTURE_MEMORY
-    CUDA_SAFE_CALL(cudaUnbindTexture(tex_x_double));
-#else
-    throw cusp::runtime_exception("texture support was not enabled");
-#endif
-}
-inline void unbind_x(const cusp::complex<float> * x)
-{
-#ifdef CUSP_USE_TEXTURE_MEMORY
-    CUDA_SAFE_CALL(cudaUnbindTexture(tex_x_float));
-#else
-    throw cusp::runtime_exception("texture support was not enabled");
-#endif
-}
-
-inline void unbind_x(const cusp::complex<double> * x)
-{
-#ifdef CUSP_USE_TEXTURE_MEMORY
-    CUDA_SAFE_CALL(cudaUnbindTexture(tex_x_double));
-#else
-    throw cusp::runtime_exception("texture support was not enabled");
-#endif
-}
-
-template <bool UseCache>
-__inline__ __device__ float fetch_x(const int& i, const float * x)
+// The 'x' vector in y += A*x is (optionally) loaded through the read-only
+// data cache.  Loads are issued per call with __ldg() on devices of
+// Compute Capability 3.5 or greater and fall back to ordinary global
+// loads otherwise.  Unlike the texture references used previously, no
+// global state is bound to 'x', hence
+//   - kernels using the cache may run concurrently on several streams
+//     or from multiple host threads,
+//   - 'x' need not be aligned (e.g. views into the middle of an array).
+//
+// bind_x() and unbind_x() are retained for source compatibility and
+// have no effect.
+
+template <typename ValueType>
+inline void bind_x(const ValueType * x) {}
+
+// Note: x is unused, but distinguishes the unbind functions
+template <typename ValueType>
+inline void unbind_x(const ValueType * x) {}
+
+template <bool UseCache, typename IndexType>
+__inline__ __device__ float fetch_x(const IndexType& i, const float * x)
 {
-#ifdef CUSP_USE_TEXTURE_MEMORY
+#if __CUDA_ARCH__ >= 350
     if (UseCache)
-        return tex1Dfetch(tex_x_float, i);
+        return __ldg(x + i);
     else
 #endif
         return x[i];
 }
 
-template <bool UseCache>
-__inline__ __device__ double fetch_x(const int& i, const double * x)
+template <bool UseCache, typename IndexType>
+__inline__ __device__ double fetch_x(const IndexType& i, const double * x)
 {
-#if __CUDA_ARCH__ >= 130
-#ifdef CUSP_USE_TEXTURE_MEMORY
-    // double requires Compute Capability 1.3 or greater
+#if __CUDA_ARCH__ >= 350
     if (UseCache)
-    {
-        int2 v = tex1Dfetch(tex_x_double, i);
-        return __hiloint2double(v.y, v.x);
-    }
+        return __ldg(x + i);
     else
-#endif // CUSP_USE_TEXTURE_MEMORY
-        return x[i];
-#else 
-    return 1.0f;
 #endif
+        return x[i];
 }
 
-
-template <bool UseCache>
-__inline__ __device__ cusp::complex<float> fetch_x(const int& i, const cusp::complex<float> * x)
+template <bool UseCache, typename IndexType>
+__inline__ __device__ cusp::complex<float> fetch_x(const IndexType& i, const cusp::complex<float> * x)
 {
-#ifdef CUSP_USE_TEXTURE_MEMORY
+#if __CUDA_ARCH__ >= 350
     if (UseCache)
-      return cusp::complex<float>(tex1Dfetch(tex_x_float, i*2),tex1Dfetch(tex_x_float, i*2+1));
+    {
+        // cusp::complex<float> has the same layout as float2
+        float2 v = __ldg(reinterpret_cast<const float2 *>(x) + i);
+        return cusp::complex<float>(v.x, v.y);
+    }
     else
 #endif
         return x[i];
 }
 
-template <bool UseCache>
-__inline__ __device__ cusp::complex<double> fetch_x(const int& i, const cusp::complex<double> * x)
+template <bool UseCache, typename IndexType>
+__inline__ __device__ cusp::complex<double> fetch_x(const IndexType& i, const cusp::complex<double> * x)
 {
-#if __CUDA_ARCH__ >= 130
-#ifdef CUSP_USE_TEXTURE_MEMORY
-    // double requires Compute Capability 1.3 or greater
+#if __CUDA_ARCH__ >= 350
     if (UseCache)
-      {
-	int2 vr = tex1Dfetch(tex_x_double, i*2);
-	int2 vi = tex1Dfetch(tex_x_double, i*2+1);
-        return cusp::complex<double<(__hiloint2double(vr.y, vr.x),__hiloint2double(vr.y, vr.x));
+    {
+        // cusp::complex<double> has the same layout as double2
+        double2 v = __ldg(reinterpret_cast<const double2 *>(x) + i);
+        return cusp::complex<double>(v.x, v.y);
     }
     else
-#endif // CUSP_USE_TEXTURE_MEMORY
-        return x[i];
-#else 
-    return 1.0f;
 #endif
+        return x[i];
 }
 
@@ -0,0 +1,160 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/utils.h>
+
+#include <algorithm>
+
+// Reductions that leave their result in device memory.
+//
+// The Thrust reductions return their result to the host, which blocks
+// the calling thread until the device is idle.  A reduction over the
+// slices of a distributed array instead launches transform_reduce_async
+// on every device and only then reads back the partial results, so the
+// devices reduce their slices concurrently.  Each launch writes one
+// partial result per block, followed by a single-block kernel that
+// combines the partials.
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+const unsigned int TRANSFORM_REDUCE_BLOCK_SIZE = 256;
+
+template <typename ValueType, unsigned int BLOCK_SIZE, typename BinaryFunction>
+__device__ ValueType block_reduce(ValueType * sdata, ValueType value, BinaryFunction reduce)
+{
+    sdata[threadIdx.x] = value;
+    __syncthreads();
+
+    for (unsigned int offset = BLOCK_SIZE / 2; offset > 0; offset >>= 1)
+    {
+        if (threadIdx.x < offset)
+            sdata[threadIdx.x] = reduce(sdata[threadIdx.x], sdata[threadIdx.x + offset]);
+        __syncthreads();
+    }
+
+    return sdata[0];
+}
+
+// partials[blockIdx.x] <- reduction of transform(x[i], y[i]) over the
+// elements of the block
+template <typename IndexType, typename ValueType, unsigned int BLOCK_SIZE,
+          typename BinaryFunction1, typename BinaryFunction2>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+transform_reduce_kernel(const IndexType N,
+                        const ValueType * x,
+                        const ValueType * y,
+                        BinaryFunction1 transform,
+                        BinaryFunction2 reduce,
+                        const ValueType init,
+                              ValueType * partials)
+{
+    __shared__ ValueType sdata[BLOCK_SIZE];
+
+    const IndexType grid_size = BLOCK_SIZE * gridDim.x;
+
+    ValueType sum = init;
+
+    for (IndexType i = BLOCK_SIZE * blockIdx.x + threadIdx.x; i < N; i += grid_size)
+        sum = reduce(sum, transform(x[i], y[i]));
+
+    sum = block_reduce<ValueType,BLOCK_SIZE>(sdata, sum, reduce);
+
+    if (threadIdx.x == 0)
+        partials[blockIdx.x] = sum;
+}
+
+// result[0] <- reduction of the partials
+template <typename ValueType, unsigned int BLOCK_SIZE, typename BinaryFunction>
+__launch_bounds__(BLOCK_SIZE,1)
+__global__ void
+reduce_partials_kernel(const unsigned int num_partials,
+                       const ValueType * partials,
+                       BinaryFunction reduce,
+                       const ValueType init,
+                             ValueType * result)
+{
+    __shared__ ValueType sdata[BLOCK_SIZE];
+
+    ValueType sum = init;
+
+    for (unsigned int i = threadIdx.x; i < num_partials; i += BLOCK_SIZE)
+        sum = reduce(sum, partials[i]);
+
+    sum = block_reduce<ValueType,BLOCK_SIZE>(sdata, sum, reduce);
+
+    if (threadIdx.x == 0)
+        result[0] = sum;
+}
+
+// result[0] <- reduce(init, transform(x[0], y[0]), ..., transform(x[N-1], y[N-1]))
+// on the current stream, where partials holds TRANSFORM_REDUCE_BLOCK_SIZE
+// values and init is the identity of reduce
+template <typename ValueType, typename BinaryFunction1, typename BinaryFunction2>
+void transform_reduce_async(const size_t N,
+                            const ValueType * x,
+                            const ValueType * y,
+                            BinaryFunction1 transform,
+                            BinaryFunction2 reduce,
+                            const ValueType init,
+                                  ValueType * partials,
+                                  ValueType * result)
+{
+    const unsigned int BLOCK_SIZE = TRANSFORM_REDUCE_BLOCK_SIZE;
+    const unsigned int NUM_BLOCKS = std::min<size_t>(BLOCK_SIZE, DIVIDE_INTO(N, BLOCK_SIZE));
+
+    cudaStream_t stream = cusp::detail::current_stream();
+
+    if (NUM_BLOCKS > 0)
+        transform_reduce_kernel<size_t, ValueType, BLOCK_SIZE> <<<NUM_BLOCKS, BLOCK_SIZE, 0, stream>>>
+            (N, x, y, transform, reduce, init, partials);
+
+    reduce_partials_kernel<ValueType, BLOCK_SIZE> <<<1, BLOCK_SIZE, 0, stream>>>
+        (NUM_BLOCKS, partials, reduce, init, result);
+}
+
+// result[0] <- f(x[0])
+template <typename ValueType, typename OutputType, typename UnaryFunction>
+__global__ void
+apply_scalar_kernel(const ValueType * x,
+                          OutputType * result,
+                    UnaryFunction f)
+{
+    result[0] = f(x[0]);
+}
+
+// result[0] <- f(x[0]) on the current stream, used to finish a reduction
+// such as the square root of a norm without reading it back
+template <typename ValueType, typename OutputType, typename UnaryFunction>
+void apply_scalar_async(const ValueType * x,
+                              OutputType * result,
+                        UnaryFunction f)
+{
+    apply_scalar_kernel<ValueType, OutputType, UnaryFunction> <<<1, 1, 0, cusp::detail::current_stream()>>>(x, result, f);
+}
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
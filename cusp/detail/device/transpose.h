@@ -19,18 +19,41 @@
 #include <cusp/array2d.h>
 #include <cusp/coo_matrix.h>
 #include <cusp/csr_matrix.h>
+#include <cusp/caching_allocator.h>
 
 #include <cusp/detail/utils.h>
 #include <cusp/detail/format_utils.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/device/common.h>
+#include <cusp/detail/device/cusparse.h>
+#include <cusp/detail/device/utils.h>
 
+#include <thrust/copy.h>
+#include <thrust/device_ptr.h>
+#include <thrust/extrema.h>
+#include <thrust/fill.h>
 #include <thrust/functional.h>
 #include <thrust/gather.h>
+#include <thrust/scan.h>
 #include <thrust/sequence.h>
 #include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/detail/type_traits.h>
 #include <thrust/iterator/counting_iterator.h>
 #include <thrust/iterator/transform_iterator.h>
 #include <thrust/iterator/zip_iterator.h>
 
+#include <algorithm>
+
+// Transposition by counting sort.  The entries of each column of A are
+// counted with atomics, a scan of the counts gives the row offsets of
+// A^T and each entry is scattered to the next free position of its row
+// in A^T.  Since the atomics fix no order within a row of A^T, each row
+// is then sorted by column index, with one thread per row when the rows
+// are short and by a packed-key sort of all entries otherwise.  Index
+// types without 32-bit atomics fall back to sorting the entries by row.
+
 namespace cusp
 {
 namespace detail
@@ -38,11 +61,191 @@ namespace detail
 namespace device
 {
 
+// rows of A^T up to this length are sorted by a thread with an insertion sort
+const size_t TRANSPOSE_SEGMENT_SORT_LENGTH = 64;
+
+template <typename IndexType> struct has_transpose_atomics               { static const bool value = false; };
+template <>                   struct has_transpose_atomics<int>          { static const bool value = true;  };
+template <>                   struct has_transpose_atomics<unsigned int> { static const bool value = true;  };
+
+// counts[Aj[n] + 1] += 1
+template <typename IndexType>
+__global__ void
+transpose_count_kernel(const IndexType num_entries,
+                       const IndexType * Aj,
+                             IndexType * counts)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType n = thread_id; n < num_entries; n += grid_size)
+        atomicAdd(counts + Aj[n] + 1, IndexType(1));
+}
+
+// entry n of row Ai[n] and column Aj[n] of A goes to row Aj[n] of A^T
+template <typename IndexType, typename ValueType>
+__global__ void
+transpose_coo_scatter_kernel(const IndexType num_entries,
+                             const IndexType * Ai,
+                             const IndexType * Aj,
+                             const ValueType * Ax,
+                                   IndexType * next,
+                                   IndexType * Bj,
+                                   ValueType * Bx)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType n = thread_id; n < num_entries; n += grid_size)
+    {
+        const IndexType position = atomicAdd(next + Aj[n], IndexType(1));
+
+        Bj[position] = Ai[n];
+        Bx[position] = Ax[n];
+    }
+}
+
+// the rows of A with one thread per row
+template <typename IndexType, typename ValueType>
+__global__ void
+transpose_csr_scatter_kernel(const IndexType num_rows,
+                             const IndexType * Ap,
+                             const IndexType * Aj,
+                             const ValueType * Ax,
+                                   IndexType * next,
+                                   IndexType * Bj,
+                                   ValueType * Bx)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += grid_size)
+    {
+        const IndexType row_end = Ap[row + 1];
+
+        for(IndexType jj = Ap[row]; jj < row_end; jj++)
+        {
+            const IndexType position = atomicAdd(next + Aj[jj], IndexType(1));
+
+            Bj[position] = row;
+            Bx[position] = Ax[jj];
+        }
+    }
+}
+
+// sort each row of (Bp, Bj, Bx) by column index
+template <typename IndexType, typename ValueType>
+__global__ void
+transpose_segment_sort_kernel(const IndexType num_rows,
+                              const IndexType * Bp,
+                                    IndexType * Bj,
+                                    ValueType * Bx)
+{
+    const IndexType thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const IndexType grid_size = gridDim.x * blockDim.x;
+
+    for(IndexType row = thread_id; row < num_rows; row += grid_size)
+    {
+        const IndexType row_start = Bp[row];
+        const IndexType row_end   = Bp[row + 1];
+
+        for(IndexType jj = row_start + 1; jj < row_end; jj++)
+        {
+            const IndexType col = Bj[jj];
+            const ValueType val = Bx[jj];
+
+            IndexType kk = jj;
+
+            while (kk > row_start && Bj[kk - 1] > col)
+            {
+                Bj[kk] = Bj[kk - 1];
+                Bx[kk] = Bx[kk - 1];
+                kk--;
+            }
+
+            Bj[kk] = col;
+            Bx[kk] = val;
+        }
+    }
+}
+
+template <typename KernelFunction>
+size_t transpose_num_blocks(KernelFunction kernel, const size_t BLOCK_SIZE, const size_t N)
+{
+    const size_t MAX_BLOCKS = cusp::detail::device::arch::max_active_blocks(kernel, BLOCK_SIZE, (size_t) 0);
+
+    return std::min<size_t>(MAX_BLOCKS, DIVIDE_INTO(N, BLOCK_SIZE));
+}
+
+// Bp <- offsets of the rows of A^T from the column indices of A, and
+// next <- Bp[0:num_cols], the positions at which the rows are filled
+template <typename Array1, typename Array2, typename Array3>
+void transpose_row_offsets(const Array1& column_indices, const size_t num_cols, Array2& row_offsets, Array3& next)
+{
+    typedef typename Array2::value_type IndexType;
+
+    const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+    const size_t N          = column_indices.size();
+
+    thrust::fill(row_offsets.begin(), row_offsets.end(), IndexType(0));
+
+    if (N > 0)
+    {
+        const size_t NUM_BLOCKS = transpose_num_blocks(transpose_count_kernel<IndexType>, BLOCK_SIZE, N);
+
+        transpose_count_kernel<IndexType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+            (IndexType(N), thrust::raw_pointer_cast(&column_indices[0]), thrust::raw_pointer_cast(&row_offsets[0]));
+    }
+
+    thrust::inclusive_scan(row_offsets.begin(), row_offsets.end(), row_offsets.begin());
+
+    thrust::copy(row_offsets.begin(), row_offsets.begin() + num_cols, next.begin());
+}
+
+// sort the rows of A^T by column index, given its row offsets
+template <typename Array1, typename Array2, typename Array3>
+void transpose_sort_rows(const Array1& row_offsets, Array2& column_indices, Array3& values, const size_t num_cols)
+{
+    typedef typename Array1::value_type IndexType;
+    typedef typename Array3::value_type ValueType;
+
+    const size_t num_rows = row_offsets.size() - 1;
+
+    if (num_rows == 0 || column_indices.size() == 0)
+        return;
+
+    // longest row of A^T
+    cusp::array1d<IndexType, cusp::caching_device_allocator<IndexType> > lengths(num_rows);
+    thrust::transform(row_offsets.begin() + 1, row_offsets.end(), row_offsets.begin(), lengths.begin(), thrust::minus<IndexType>());
+    const size_t max_length = *thrust::max_element(lengths.begin(), lengths.end());
+
+    if (max_length <= 1)
+        return;
+
+    if (max_length <= TRANSPOSE_SEGMENT_SORT_LENGTH)
+    {
+        const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+        const size_t NUM_BLOCKS = transpose_num_blocks(transpose_segment_sort_kernel<IndexType,ValueType>, BLOCK_SIZE, num_rows);
+
+        transpose_segment_sort_kernel<IndexType,ValueType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+            (IndexType(num_rows),
+             thrust::raw_pointer_cast(&row_offsets[0]),
+             thrust::raw_pointer_cast(&column_indices[0]),
+             thrust::raw_pointer_cast(&values[0]));
+    }
+    else
+    {
+        cusp::array1d<IndexType, cusp::caching_device_allocator<IndexType> > row_indices(column_indices.size());
+        cusp::detail::offsets_to_indices(row_offsets, row_indices);
+        cusp::detail::sort_by_row_and_column(row_indices, column_indices, values, num_rows, num_cols);
+    }
+}
+
 // COO format
 template <typename MatrixType1,   typename MatrixType2>
-void transpose(const MatrixType1& A, MatrixType2& At,
-               cusp::coo_format,
-               cusp::coo_format)
+void transpose_by_sort(const MatrixType1& A, MatrixType2& At,
+                       cusp::coo_format,
+                       cusp::coo_format)
 {
     At.resize(A.num_cols, A.num_rows, A.num_entries);
 
@@ -53,12 +256,11 @@ void transpose(const MatrixType1& A, MatrixType2& At,
     At.sort_by_row();
 }
 
-
 // CSR format
 template <typename MatrixType1,   typename MatrixType2>
-void transpose(const MatrixType1& A, MatrixType2& At,
-               cusp::csr_format,
-               cusp::csr_format)
+void transpose_by_sort(const MatrixType1& A, MatrixType2& At,
+                       cusp::csr_format,
+                       cusp::csr_format)
 {
     typedef typename MatrixType2::index_type   IndexType2;
     typedef typename MatrixType2::memory_space MemorySpace2;
@@ -75,6 +277,125 @@ void transpose(const MatrixType1& A, MatrixType2& At,
     cusp::detail::indices_to_offsets(At_row_indices, At.row_offsets);
 }
 
+// COO format
+template <typename MatrixType1,   typename MatrixType2>
+void transpose_by_count(const MatrixType1& A, MatrixType2& At,
+                        cusp::coo_format)
+{
+    typedef typename MatrixType2::index_type IndexType;
+    typedef typename MatrixType2::value_type ValueType;
+
+    At.resize(A.num_cols, A.num_rows, A.num_entries);
+
+    cusp::array1d<IndexType, cusp::caching_device_allocator<IndexType> > row_offsets(A.num_cols + 1);
+    cusp::array1d<IndexType, cusp::caching_device_allocator<IndexType> > next(A.num_cols);
+
+    transpose_row_offsets(A.column_indices, A.num_cols, row_offsets, next);
+
+    if (A.num_entries > 0)
+    {
+        const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+        const size_t NUM_BLOCKS = transpose_num_blocks(transpose_coo_scatter_kernel<IndexType,ValueType>, BLOCK_SIZE, A.num_entries);
+
+        transpose_coo_scatter_kernel<IndexType,ValueType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+            (IndexType(A.num_entries),
+             thrust::raw_pointer_cast(&A.row_indices[0]),
+             thrust::raw_pointer_cast(&A.column_indices[0]),
+             thrust::raw_pointer_cast(&A.values[0]),
+             thrust::raw_pointer_cast(&next[0]),
+             thrust::raw_pointer_cast(&At.column_indices[0]),
+             thrust::raw_pointer_cast(&At.values[0]));
+    }
+
+    transpose_sort_rows(row_offsets, At.column_indices, At.values, A.num_rows);
+
+    cusp::detail::offsets_to_indices(row_offsets, At.row_indices);
+}
+
+// CSR format
+template <typename MatrixType1,   typename MatrixType2>
+void transpose_by_count(const MatrixType1& A, MatrixType2& At,
+                        cusp::csr_format)
+{
+    typedef typename MatrixType2::index_type IndexType;
+    typedef typename MatrixType2::value_type ValueType;
+
+    At.resize(A.num_cols, A.num_rows, A.num_entries);
+
+    cusp::array1d<IndexType, cusp::caching_device_allocator<IndexType> > next(A.num_cols);
+
+    transpose_row_offsets(A.column_indices, A.num_cols, At.row_offsets, next);
+
+    if (A.num_entries > 0)
+    {
+        const size_t BLOCK_SIZE = cusp::detail::device::arch::block_size();
+        const size_t NUM_BLOCKS = transpose_num_blocks(transpose_csr_scatter_kernel<IndexType,ValueType>, BLOCK_SIZE, A.num_rows);
+
+        transpose_csr_scatter_kernel<IndexType,ValueType> <<<NUM_BLOCKS, BLOCK_SIZE, 0, cusp::detail::current_stream()>>>
+            (IndexType(A.num_rows),
+             thrust::raw_pointer_cast(&A.row_offsets[0]),
+             thrust::raw_pointer_cast(&A.column_indices[0]),
+             thrust::raw_pointer_cast(&A.values[0]),
+             thrust::raw_pointer_cast(&next[0]),
+             thrust::raw_pointer_cast(&At.column_indices[0]),
+             thrust::raw_pointer_cast(&At.values[0]));
+    }
+
+    transpose_sort_rows(At.row_offsets, At.column_indices, At.values, A.num_rows);
+}
+
+// counting transpose of a matrix in device memory with 32-bit indices
+template <typename MatrixType1, typename MatrixType2, typename Format>
+void transpose(const MatrixType1& A, MatrixType2& At,
+               Format, cusp::device_memory, thrust::detail::true_type)
+{
+    transpose_by_count(A, At, Format());
+}
+
+// a source in host memory is first copied to the device
+template <typename MatrixType1, typename MatrixType2, typename Format>
+void transpose(const MatrixType1& A, MatrixType2& At,
+               Format, cusp::host_memory, thrust::detail::true_type)
+{
+    MatrixType2 A_device(A);
+
+    transpose_by_count(A_device, At, Format());
+}
+
+template <typename MatrixType1, typename MatrixType2, typename Format, typename MemorySpace>
+void transpose(const MatrixType1& A, MatrixType2& At,
+               Format, MemorySpace, thrust::detail::false_type)
+{
+    transpose_by_sort(A, At, Format(), Format());
+}
+
+// COO format
+template <typename MatrixType1,   typename MatrixType2>
+void transpose(const MatrixType1& A, MatrixType2& At,
+               cusp::coo_format,
+               cusp::coo_format)
+{
+    typedef typename MatrixType2::index_type IndexType;
+
+    cusp::detail::device::transpose(A, At, cusp::coo_format(), typename MatrixType1::memory_space(),
+                                    thrust::detail::integral_constant<bool, has_transpose_atomics<IndexType>::value>());
+}
+
+// CSR format
+template <typename MatrixType1,   typename MatrixType2>
+void transpose(const MatrixType1& A, MatrixType2& At,
+               cusp::csr_format,
+               cusp::csr_format)
+{
+    typedef typename MatrixType2::index_type IndexType;
+
+    if (cusp::detail::device::cusparse::transpose(A, At))
+        return;
+
+    cusp::detail::device::transpose(A, At, cusp::csr_format(), typename MatrixType1::memory_space(),
+                                    thrust::detail::integral_constant<bool, has_transpose_atomics<IndexType>::value>());
+}
+
 
 } // end namespace device
 } // end namespace detail
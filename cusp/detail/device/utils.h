@@ -19,6 +19,8 @@
 
 #include <thrust/pair.h>
 
+#include <cusp/detail/stream.h>
+
 #define CUDA_SAFE_CALL_NO_SYNC( call) do {                                \
  cudaError err = call;                                                    \
  if( cudaSuccess != err) {                                                \
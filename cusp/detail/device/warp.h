@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/device/common.h>
+
+// Warp shuffles of arbitrary value types.  A value is exchanged as a
+// sequence of 32-bit words, so 64-bit indices and complex values may be
+// shuffled as well.  Shuffles require sm_30: kernels use them under
+// __CUDA_ARCH__ >= 300 and keep a shared memory version for earlier
+// targets.  The mask names the lanes that execute the shuffle, each of
+// which must pass the same mask (CUDA 9 and later).
+
+namespace cusp
+{
+namespace detail
+{
+namespace device
+{
+
+// mask of the WIDTH-lane segment of the warp that contains this thread,
+// for blocks whose size is a multiple of WARP_SIZE
+template <unsigned int WIDTH>
+__device__ __forceinline__ unsigned int segment_mask(void)
+{
+    if (WIDTH >= WARP_SIZE)
+        return 0xffffffff;
+
+    const unsigned int lane = threadIdx.x & (WARP_SIZE - 1);
+
+    return ((1u << WIDTH) - 1) << (lane & ~(WIDTH - 1));
+}
+
+#if __CUDA_ARCH__ >= 300
+
+struct shfl_idx_op
+{
+    __device__ __forceinline__
+    static int apply(const unsigned int mask, const int word, const int lane, const int width)
+    {
+#if CUDART_VERSION >= 9000
+        return __shfl_sync(mask, word, lane, width);
+#else
+        return __shfl(word, lane, width);
+#endif
+    }
+};
+
+struct shfl_up_op
+{
+    __device__ __forceinline__
+    static int apply(const unsigned int mask, const int word, const int delta, const int width)
+    {
+#if CUDART_VERSION >= 9000
+        return __shfl_up_sync(mask, word, delta, width);
+#else
+        return __shfl_up(word, delta, width);
+#endif
+    }
+};
+
+struct shfl_down_op
+{
+    __device__ __forceinline__
+    static int apply(const unsigned int mask, const int word, const int delta, const int width)
+    {
+#if CUDART_VERSION >= 9000
+        return __shfl_down_sync(mask, word, delta, width);
+#else
+        return __shfl_down(word, delta, width);
+#endif
+    }
+};
+
+template <typename Shuffle, typename T>
+__device__ __forceinline__
+T warp_shuffle(const unsigned int mask, const T& value, const int arg, const int width)
+{
+    const int WORDS = (sizeof(T) + sizeof(int) - 1) / sizeof(int);
+
+    int words[WORDS];
+    memcpy(words, &value, sizeof(T));
+
+#pragma unroll
+    for (int i = 0; i < WORDS; i++)
+        words[i] = Shuffle::apply(mask, words[i], arg, width);
+
+    T result;
+    memcpy(&result, words, sizeof(T));
+
+    return result;
+}
+
+// value of lane src_lane of the segment
+template <typename T>
+__device__ __forceinline__
+T shfl(const unsigned int mask, const T& value, const int src_lane, const int width = WARP_SIZE)
+{
+    return warp_shuffle<shfl_idx_op>(mask, value, src_lane, width);
+}
+
+// value of the lane delta below this one, or this lane's own value
+template <typename T>
+__device__ __forceinline__
+T shfl_up(const unsigned int mask, const T& value, const int delta, const int width = WARP_SIZE)
+{
+    return warp_shuffle<shfl_up_op>(mask, value, delta, width);
+}
+
+// value of the lane delta above this one, or this lane's own value
+template <typename T>
+__device__ __forceinline__
+T shfl_down(const unsigned int mask, const T& value, const int delta, const int width = WARP_SIZE)
+{
+    return warp_shuffle<shfl_down_op>(mask, value, delta, width);
+}
+
+#endif // __CUDA_ARCH__ >= 300
+
+} // end namespace device
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,108 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/detail/format_utils.h>
+
+#include <thrust/functional.h>
+#include <thrust/transform.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+template <typename T>
+struct diagonal_reciprocal : public thrust::unary_function<T,T>
+{
+    __host__ __device__
+    T operator()(const T& v) const
+    {
+        return T(1) / v;
+    }
+};
+
+// Main diagonal D of a matrix and its reciprocals D^-1, each extracted on
+// first use.  Setup code that needs the diagonal of one matrix several
+// times (strength of connection, spectral radius estimate, prolongator
+// smoothing and smoothers) shares an instance instead of passing over the
+// entries of the matrix in every step.
+//
+// Unlike row_statistics the cache depends on the values of the matrix, so
+// it is not held by the containers: its owner calls invalidate() whenever
+// it changes the values, and always passes the same matrix.
+template <typename ValueType, typename MemorySpace>
+class diagonal_cache
+{
+    cusp::array1d<ValueType,MemorySpace> D;
+    cusp::array1d<ValueType,MemorySpace> Dinv;
+    bool has_diagonal;
+    bool has_inverse;
+
+    public:
+
+    diagonal_cache(void) : has_diagonal(false), has_inverse(false) {}
+
+    template <typename MatrixType>
+    const cusp::array1d<ValueType,MemorySpace>& diagonal(const MatrixType& A)
+    {
+        if (!has_diagonal || D.size() != A.num_rows)
+        {
+            cusp::detail::extract_diagonal(A, D);
+            has_diagonal = true;
+        }
+
+        return D;
+    }
+
+    template <typename MatrixType>
+    const cusp::array1d<ValueType,MemorySpace>& inverse_diagonal(const MatrixType& A)
+    {
+        if (!has_inverse || Dinv.size() != A.num_rows)
+        {
+            const cusp::array1d<ValueType,MemorySpace>& d = diagonal(A);
+
+            Dinv.resize(d.size());
+            thrust::transform(d.begin(), d.end(), Dinv.begin(), diagonal_reciprocal<ValueType>());
+            has_inverse = true;
+        }
+
+        return Dinv;
+    }
+
+    // the values of the matrix changed
+    void invalidate(void)
+    {
+        has_diagonal = false;
+        has_inverse  = false;
+    }
+
+    // release the storage, e.g. once the setup that needed it is done
+    void clear(void)
+    {
+        invalidate();
+        D.resize(0);
+        Dinv.resize(0);
+    }
+};
+
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/memory.h>
+
+#include <cusp/detail/host/contiguous.h>
+#include <cusp/detail/host/dense_transpose.h>
+#include <cusp/detail/device/contiguous.h>
+#include <cusp/detail/device/dense_transpose.h>
+
+#include <thrust/device_ptr.h>
+#include <thrust/detail/type_traits.h>
+
+// Transposition of the values of pitched dense arrays, the common step of
+// cusp::transpose of an array2d and of the conversion between row_major
+// and column_major.  The tiled kernels require contiguous arrays in one
+// memory space and return false otherwise, in which case the caller
+// falls back to an index-mapped copy.
+
+namespace cusp
+{
+namespace detail
+{
+namespace dispatch
+{
+
+template <typename Array1, typename Array2, typename MemorySpace1, typename MemorySpace2>
+bool transpose_dense(const Array1& src, Array2& dst,
+                     const size_t num_major, const size_t num_minor,
+                     const size_t src_pitch, const size_t dst_pitch,
+                     MemorySpace1, MemorySpace2, thrust::detail::false_type)
+{
+    return false;
+}
+
+template <typename Array1, typename Array2>
+bool transpose_dense(const Array1& src, Array2& dst,
+                     const size_t num_major, const size_t num_minor,
+                     const size_t src_pitch, const size_t dst_pitch,
+                     cusp::host_memory, cusp::host_memory, thrust::detail::true_type)
+{
+    if (num_major > 0 && num_minor > 0)
+        cusp::detail::host::transpose_dense(num_major, num_minor,
+                                            cusp::detail::host::host_contiguous_pointer(src), src_pitch,
+                                            cusp::detail::host::host_contiguous_pointer(dst), dst_pitch);
+    return true;
+}
+
+template <typename Array1, typename Array2>
+bool transpose_dense(const Array1& src, Array2& dst,
+                     const size_t num_major, const size_t num_minor,
+                     const size_t src_pitch, const size_t dst_pitch,
+                     cusp::device_memory, cusp::device_memory, thrust::detail::true_type)
+{
+    if (num_major > 0 && num_minor > 0)
+        cusp::detail::device::transpose_dense(num_major, num_minor,
+                                              thrust::raw_pointer_cast(&src[0]), src_pitch,
+                                              thrust::raw_pointer_cast(&dst[0]), dst_pitch);
+    return true;
+}
+
+template <typename Array1, typename Array2, typename MemorySpace1, typename MemorySpace2>
+struct is_dense_transpose_contiguous : thrust::detail::false_type {};
+
+template <typename Array1, typename Array2>
+struct is_dense_transpose_contiguous<Array1, Array2, cusp::host_memory, cusp::host_memory>
+  : thrust::detail::integral_constant<bool,
+      cusp::detail::host::is_host_contiguous_array<Array1, typename Array1::value_type>::value &&
+      cusp::detail::host::is_host_contiguous_array<Array2, typename Array2::value_type>::value> {};
+
+template <typename Array1, typename Array2>
+struct is_dense_transpose_contiguous<Array1, Array2, cusp::device_memory, cusp::device_memory>
+  : thrust::detail::integral_constant<bool,
+      cusp::detail::device::is_device_contiguous_iterator<typename Array1::iterator>::value &&
+      cusp::detail::device::is_device_contiguous_iterator<typename Array2::iterator>::value> {};
+
+// dst[j * dst_pitch + i] <- src[i * src_pitch + j] for the num_major x
+// num_minor source, returns false if the arrays are not supported
+template <typename Array1, typename Array2>
+bool transpose_dense(const Array1& src, Array2& dst,
+                     const size_t num_major, const size_t num_minor,
+                     const size_t src_pitch, const size_t dst_pitch)
+{
+    typedef typename Array1::memory_space MemorySpace1;
+    typedef typename Array2::memory_space MemorySpace2;
+
+    return transpose_dense(src, dst, num_major, num_minor, src_pitch, dst_pitch,
+                           MemorySpace1(), MemorySpace2(),
+                           typename is_dense_transpose_contiguous<Array1, Array2, MemorySpace1, MemorySpace2>::type());
+}
+
+} // end namespace dispatch
+} // end namespace detail
+} // end namespace cusp
+
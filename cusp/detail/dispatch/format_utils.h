@@ -0,0 +1,142 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/memory.h>
+
+#include <cusp/detail/host/contiguous.h>
+#include <cusp/detail/host/format_utils.h>
+#include <cusp/detail/device/contiguous.h>
+#include <cusp/detail/device/format_utils.h>
+
+#include <thrust/device_ptr.h>
+#include <thrust/detail/type_traits.h>
+
+// Conversion between row offsets and row indices with the dedicated
+// host and device loops.  These require contiguous arrays in one memory
+// space and return false otherwise, in which case the caller falls back
+// to the generic Thrust sequences.
+
+namespace cusp
+{
+namespace detail
+{
+namespace dispatch
+{
+
+template <typename Array1, typename Array2, typename MemorySpace1, typename MemorySpace2>
+struct is_offsets_contiguous : thrust::detail::false_type {};
+
+template <typename Array1, typename Array2>
+struct is_offsets_contiguous<Array1, Array2, cusp::host_memory, cusp::host_memory>
+  : thrust::detail::integral_constant<bool,
+      cusp::detail::host::is_host_contiguous_array<Array1, typename Array1::value_type>::value &&
+      cusp::detail::host::is_host_contiguous_array<Array2, typename Array2::value_type>::value> {};
+
+template <typename Array1, typename Array2>
+struct is_offsets_contiguous<Array1, Array2, cusp::device_memory, cusp::device_memory>
+  : thrust::detail::integral_constant<bool,
+      cusp::detail::device::is_device_contiguous_iterator<typename Array1::iterator>::value &&
+      cusp::detail::device::is_device_contiguous_iterator<typename Array2::iterator>::value> {};
+
+template <typename IndexArray, typename OffsetArray, typename MemorySpace1, typename MemorySpace2>
+bool indices_to_offsets(const IndexArray& indices, OffsetArray& offsets,
+                        MemorySpace1, MemorySpace2, thrust::detail::false_type)
+{
+    return false;
+}
+
+template <typename IndexArray, typename OffsetArray>
+bool indices_to_offsets(const IndexArray& indices, OffsetArray& offsets,
+                        cusp::host_memory, cusp::host_memory, thrust::detail::true_type)
+{
+    if (offsets.size() > 0)
+        cusp::detail::host::indices_to_offsets(indices.size(), offsets.size() - 1,
+                                               cusp::detail::host::host_contiguous_pointer(indices),
+                                               cusp::detail::host::host_contiguous_pointer(offsets));
+    return true;
+}
+
+template <typename IndexArray, typename OffsetArray>
+bool indices_to_offsets(const IndexArray& indices, OffsetArray& offsets,
+                        cusp::device_memory, cusp::device_memory, thrust::detail::true_type)
+{
+    if (offsets.size() > 0)
+        cusp::detail::device::indices_to_offsets(indices.size(), offsets.size() - 1,
+                                                 indices.size() == 0 ? 0 : thrust::raw_pointer_cast(&indices[0]),
+                                                 thrust::raw_pointer_cast(&offsets[0]));
+    return true;
+}
+
+template <typename OffsetArray, typename IndexArray, typename MemorySpace1, typename MemorySpace2>
+bool offsets_to_indices(const OffsetArray& offsets, IndexArray& indices,
+                        MemorySpace1, MemorySpace2, thrust::detail::false_type)
+{
+    return false;
+}
+
+template <typename OffsetArray, typename IndexArray>
+bool offsets_to_indices(const OffsetArray& offsets, IndexArray& indices,
+                        cusp::host_memory, cusp::host_memory, thrust::detail::true_type)
+{
+    if (offsets.size() > 1)
+        cusp::detail::host::offsets_to_indices(offsets.size() - 1, indices.size(),
+                                               cusp::detail::host::host_contiguous_pointer(offsets),
+                                               cusp::detail::host::host_contiguous_pointer(indices));
+    return offsets.size() > 1 || indices.size() == 0;
+}
+
+template <typename OffsetArray, typename IndexArray>
+bool offsets_to_indices(const OffsetArray& offsets, IndexArray& indices,
+                        cusp::device_memory, cusp::device_memory, thrust::detail::true_type)
+{
+    if (offsets.size() > 1 && indices.size() > 0)
+        cusp::detail::device::offsets_to_indices(offsets.size() - 1, indices.size(),
+                                                 thrust::raw_pointer_cast(&offsets[0]),
+                                                 thrust::raw_pointer_cast(&indices[0]));
+    return offsets.size() > 1 || indices.size() == 0;
+}
+
+// offsets[r] <- lower_bound(indices, r), returns false if the arrays
+// are not supported
+template <typename IndexArray, typename OffsetArray>
+bool indices_to_offsets(const IndexArray& indices, OffsetArray& offsets)
+{
+    typedef typename IndexArray::memory_space  MemorySpace1;
+    typedef typename OffsetArray::memory_space MemorySpace2;
+
+    return indices_to_offsets(indices, offsets, MemorySpace1(), MemorySpace2(),
+                              typename is_offsets_contiguous<IndexArray, OffsetArray, MemorySpace1, MemorySpace2>::type());
+}
+
+// indices[k] <- the row of position k, returns false if the arrays are
+// not supported
+template <typename OffsetArray, typename IndexArray>
+bool offsets_to_indices(const OffsetArray& offsets, IndexArray& indices)
+{
+    typedef typename OffsetArray::memory_space MemorySpace1;
+    typedef typename IndexArray::memory_space  MemorySpace2;
+
+    return offsets_to_indices(offsets, indices, MemorySpace1(), MemorySpace2(),
+                              typename is_offsets_contiguous<OffsetArray, IndexArray, MemorySpace1, MemorySpace2>::type());
+}
+
+} // end namespace dispatch
+} // end namespace detail
+} // end namespace cusp
+
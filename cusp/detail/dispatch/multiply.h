@@ -42,6 +42,37 @@ void multiply(const LinearOperator&  A,
     cusp::detail::host::multiply(A, B, C);
 }
 
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::host_memory,
+                        cusp::host_memory,
+                        cusp::host_memory)
+{
+    cusp::detail::host::multiply_transpose(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta,
+                    cusp::host_memory,
+                    cusp::host_memory,
+                    cusp::host_memory)
+{
+    cusp::detail::host::multiply_axpby(A, x, z, y, alpha, beta);
+}
+
 //////////////////
 // Device Paths //
 //////////////////
@@ -58,6 +89,37 @@ void multiply(const LinearOperator&  A,
     cusp::detail::device::multiply(A, B, C);
 }
 
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::device_memory,
+                        cusp::device_memory,
+                        cusp::device_memory)
+{
+    cusp::detail::device::multiply_transpose(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta,
+                    cusp::device_memory,
+                    cusp::device_memory,
+                    cusp::device_memory)
+{
+    cusp::detail::device::multiply_axpby(A, x, z, y, alpha, beta);
+}
+
 } // end namespace dispatch
 } // end namespace detail
 } // end namespace cusp
@@ -0,0 +1,241 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/exception.h>
+
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/transform_reduce.h>
+
+#include <thrust/copy.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// distribution of the arrays constructed by the calling host thread
+inline const cusp::distribution *& current_distribution_reference(void)
+{
+    static CUSP_THREAD_LOCAL const cusp::distribution * d = 0;
+    return d;
+}
+
+// the current distribution if it has N indices, otherwise an even split
+inline cusp::distribution default_distribution(size_t N)
+{
+    const cusp::distribution * d = current_distribution_reference();
+
+    if (d != 0 && d->size() == N)
+        return *d;
+    else
+        return cusp::distribution(N);
+}
+
+} // end namespace detail
+
+/////////////////////////
+// scoped_distribution //
+/////////////////////////
+
+inline scoped_distribution::scoped_distribution(const cusp::distribution& d)
+    : value(d), previous(cusp::detail::current_distribution_reference())
+{
+    cusp::detail::current_distribution_reference() = &value;
+}
+
+inline scoped_distribution::~scoped_distribution(void)
+{
+    cusp::detail::current_distribution_reference() = previous;
+}
+
+/////////////////////////
+// distributed_array1d //
+/////////////////////////
+
+template <typename ValueType>
+distributed_array1d<ValueType>::distributed_array1d(void) {}
+
+template <typename ValueType>
+distributed_array1d<ValueType>::distributed_array1d(size_type n)
+{
+    allocate(cusp::detail::default_distribution(n));
+}
+
+template <typename ValueType>
+distributed_array1d<ValueType>::distributed_array1d(size_type n, const value_type& value)
+{
+    allocate(cusp::detail::default_distribution(n));
+    cusp::blas::fill(*this, value);
+}
+
+template <typename ValueType>
+distributed_array1d<ValueType>::distributed_array1d(const cusp::distribution& d)
+{
+    allocate(d);
+}
+
+template <typename ValueType>
+distributed_array1d<ValueType>::distributed_array1d(const cusp::distribution& d, const value_type& value)
+{
+    allocate(d);
+    cusp::blas::fill(*this, value);
+}
+
+template <typename ValueType>
+distributed_array1d<ValueType>::distributed_array1d(const distributed_array1d& a)
+{
+    *this = a;
+}
+
+template <typename ValueType>
+template <typename Array>
+distributed_array1d<ValueType>::distributed_array1d(const Array& a,
+                                                    typename thrust::detail::enable_if<!thrust::detail::is_convertible<Array,size_type>::value>::type *)
+{
+    *this = a;
+}
+
+template <typename ValueType>
+distributed_array1d<ValueType>::~distributed_array1d(void)
+{
+    release();
+}
+
+template <typename ValueType>
+distributed_array1d<ValueType>& distributed_array1d<ValueType>::operator=(const distributed_array1d& a)
+{
+    if (this == &a)
+        return *this;
+
+    if (dist != a.get_distribution())
+        allocate(a.get_distribution());
+
+    cusp::blas::copy(a, *this);
+
+    return *this;
+}
+
+namespace detail
+{
+
+template <typename ValueType, typename Array>
+void assign(cusp::distributed_array1d<ValueType>& x, const Array& a, cusp::distributed_memory)
+{
+    x = static_cast<const cusp::distributed_array1d<ValueType>&>(a);
+}
+
+template <typename ValueType, typename Array, typename MemorySpace>
+void assign(cusp::distributed_array1d<ValueType>& x, const Array& a, MemorySpace)
+{
+    if (x.size() != a.size())
+        x.resize(a.size());
+
+    const cusp::distribution& d = x.get_distribution();
+
+    for (size_t p = 0; p < x.num_partitions(); p++)
+    {
+        if (!d.local(p))
+            continue;
+
+        cusp::detail::scoped_device scope(d.device(p));
+
+        thrust::copy(a.begin() + d.begin(p), a.begin() + d.end(p), x.slice(p).begin());
+    }
+}
+
+} // end namespace detail
+
+template <typename ValueType>
+template <typename Array>
+distributed_array1d<ValueType>& distributed_array1d<ValueType>::operator=(const Array& a)
+{
+    cusp::detail::assign(*this, a, typename Array::memory_space());
+
+    return *this;
+}
+
+template <typename ValueType>
+template <typename Array>
+void distributed_array1d<ValueType>::gather(Array& a) const
+{
+    a.resize(size());
+
+    for (size_t p = 0; p < num_partitions(); p++)
+    {
+        if (!dist.local(p))
+            continue;
+
+        cusp::detail::scoped_device scope(dist.device(p));
+
+        thrust::copy(slice(p).begin(), slice(p).end(), a.begin() + dist.begin(p));
+    }
+}
+
+template <typename ValueType>
+void distributed_array1d<ValueType>::resize(size_type n)
+{
+    if (n != size() || slices.empty())
+        allocate(cusp::detail::default_distribution(n));
+}
+
+template <typename ValueType>
+void distributed_array1d<ValueType>::allocate(const cusp::distribution& d)
+{
+    release();
+
+    dist = d;
+
+    // the slices of other processes are not stored
+    for (size_t p = 0; p < d.num_partitions(); p++)
+    {
+        slices.push_back(0);
+        reduction.push_back(0);
+
+        if (!d.local(p))
+            continue;
+
+        cusp::detail::scoped_device scope(d.device(p));
+
+        slices.back()    = new slice_type(d.end(p) - d.begin(p));
+        reduction.back() = new slice_type(cusp::detail::device::TRANSFORM_REDUCE_BLOCK_SIZE + 1);
+    }
+}
+
+template <typename ValueType>
+void distributed_array1d<ValueType>::release(void)
+{
+    for (size_t p = 0; p < slices.size(); p++)
+    {
+        if (slices[p] == 0 && reduction[p] == 0)
+            continue;
+
+        cusp::detail::scoped_device scope(dist.device(p));
+
+        delete slices[p];
+        delete reduction[p];
+    }
+
+    slices.clear();
+    reduction.clear();
+
+    dist = cusp::distribution();
+}
+
+} // end namespace cusp
+
+#include <cusp/detail/distributed_blas.inl>
+
@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/complex.h>
+
+// The functions in cusp::blas forward arrays to the iterator functions
+// in cusp::blas::detail.  The overloads below process the ranges of a
+// distributed_array1d slice by slice instead.  They are declared before
+// the generic functions, which call them with qualified names, and are
+// defined in distributed_blas.inl.
+
+namespace cusp
+{
+
+template <typename Array> class distributed_iterator;
+
+namespace blas
+{
+namespace detail
+{
+
+template <typename Array1, typename Array2, typename ScalarType>
+void axpy(cusp::distributed_iterator<Array1> first1,
+          cusp::distributed_iterator<Array1> last1,
+          cusp::distributed_iterator<Array2> first2,
+          ScalarType alpha);
+
+template <typename Array1, typename Array2, typename Array3, typename ScalarType1, typename ScalarType2>
+void axpby(cusp::distributed_iterator<Array1> first1,
+           cusp::distributed_iterator<Array1> last1,
+           cusp::distributed_iterator<Array2> first2,
+           cusp::distributed_iterator<Array3> output,
+           ScalarType1 alpha,
+           ScalarType2 beta);
+
+template <typename Array1, typename Array2, typename Array3, typename Array4,
+          typename ScalarType1, typename ScalarType2, typename ScalarType3>
+void axpbypcz(cusp::distributed_iterator<Array1> first1,
+              cusp::distributed_iterator<Array1> last1,
+              cusp::distributed_iterator<Array2> first2,
+              cusp::distributed_iterator<Array3> first3,
+              cusp::distributed_iterator<Array4> output,
+              ScalarType1 alpha,
+              ScalarType2 beta,
+              ScalarType3 gamma);
+
+template <typename Array1, typename Array2, typename Array3>
+void xmy(cusp::distributed_iterator<Array1> first1,
+         cusp::distributed_iterator<Array1> last1,
+         cusp::distributed_iterator<Array2> first2,
+         cusp::distributed_iterator<Array3> output);
+
+template <typename Array1, typename Array2>
+void copy(cusp::distributed_iterator<Array1> first1,
+          cusp::distributed_iterator<Array1> last1,
+          cusp::distributed_iterator<Array2> first2);
+
+template <typename Array1, typename Array2>
+typename Array1::value_type
+dot(cusp::distributed_iterator<Array1> first1,
+    cusp::distributed_iterator<Array1> last1,
+    cusp::distributed_iterator<Array2> first2);
+
+template <typename Array1, typename Array2>
+typename Array1::value_type
+dotc(cusp::distributed_iterator<Array1> first1,
+     cusp::distributed_iterator<Array1> last1,
+     cusp::distributed_iterator<Array2> first2);
+
+template <typename Array, typename ScalarType>
+void fill(cusp::distributed_iterator<Array> first,
+          cusp::distributed_iterator<Array> last,
+          ScalarType alpha);
+
+template <typename Array>
+typename cusp::norm_type<typename Array::value_type>::type
+nrm1(cusp::distributed_iterator<Array> first,
+     cusp::distributed_iterator<Array> last);
+
+template <typename Array>
+typename cusp::norm_type<typename Array::value_type>::type
+nrm2(cusp::distributed_iterator<Array> first,
+     cusp::distributed_iterator<Array> last);
+
+template <typename Array>
+typename Array::value_type
+nrmmax(cusp::distributed_iterator<Array> first,
+       cusp::distributed_iterator<Array> last);
+
+template <typename Array, typename ScalarType>
+void scal(cusp::distributed_iterator<Array> first,
+          cusp::distributed_iterator<Array> last,
+          ScalarType alpha);
+
+} // end namespace detail
+} // end namespace blas
+} // end namespace cusp
+
@@ -0,0 +1,463 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/exception.h>
+#include <cusp/stream.h>
+
+#include <cusp/detail/binned_sum.h>
+#include <cusp/detail/reduction_mode.h>
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/transform_reduce.h>
+
+#include <thrust/functional.h>
+#include <thrust/detail/type_traits.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace cusp
+{
+namespace blas
+{
+namespace detail
+{
+
+// The range [first, last) of a distributed array is processed slice by
+// slice, each on the default stream of the device of the slice.  The
+// arrays of a function must have the same distribution and the ranges
+// must start at the same index.  A process only processes its own
+// slices, and reductions combine the results of all processes.
+
+template <typename Array1, typename Array2>
+void assert_same_distribution(const cusp::distributed_iterator<Array1>& first1,
+                              const cusp::distributed_iterator<Array2>& first2)
+{
+    if (first1.array()->get_distribution() != first2.array()->get_distribution() ||
+        first1.index() != first2.index())
+        throw cusp::invalid_input_exception("array distributions do not match");
+}
+
+// [lo, hi) <- indices of slice p within [first, last), false if the
+// range is empty or the slice resides on another process
+template <typename Array>
+bool distributed_range(const cusp::distributed_iterator<Array>& first,
+                       const cusp::distributed_iterator<Array>& last,
+                       const size_t p,
+                       size_t& lo, size_t& hi)
+{
+    const cusp::distribution& d = first.array()->get_distribution();
+
+    if (!d.local(p))
+        return false;
+
+    lo = std::max(first.index(), d.begin(p)) - d.begin(p);
+    hi = std::min(last.index(),  d.end(p))   - d.begin(p);
+
+    return first.index() < d.end(p) && d.begin(p) < last.index() && lo < hi;
+}
+
+// slice p of the array of an iterator, which the const overloads of the
+// BLAS functions write like a view
+template <typename Array>
+typename Array::slice_type& distributed_slice(const cusp::distributed_iterator<Array>& it, const size_t p)
+{
+    typedef typename thrust::detail::remove_const<Array>::type Container;
+
+    return const_cast<Container *>(it.array())->slice(p);
+}
+
+// issues work on the default stream of the device of slice p
+class distributed_scope
+{
+    public:
+    template <typename Array>
+    distributed_scope(const cusp::distributed_iterator<Array>& it, const size_t p)
+        : device(it.array()->get_distribution().device(p)), stream(0) {}
+
+    private:
+    cusp::detail::scoped_device device;
+    cusp::scoped_stream         stream;
+};
+
+// reduce(init, transform(x[i], y[i]), ...) over [first1, last1)
+template <typename Array1, typename Array2, typename BinaryFunction1, typename BinaryFunction2>
+typename Array1::value_type
+distributed_transform_reduce(cusp::distributed_iterator<Array1> first1,
+                             cusp::distributed_iterator<Array1> last1,
+                             cusp::distributed_iterator<Array2> first2,
+                             BinaryFunction1 transform,
+                             BinaryFunction2 reduce,
+                             typename Array1::value_type init)
+{
+    typedef typename Array1::value_type ValueType;
+
+    assert_same_distribution(first1, first2);
+
+    const size_t num_parts = first1.array()->num_partitions();
+
+    size_t lo, hi;
+
+    // reduce every slice before waiting for any of them
+    for (size_t p = 0; p < num_parts; p++)
+    {
+        if (!distributed_range(first1, last1, p, lo, hi))
+            continue;
+
+        distributed_scope scope(first1, p);
+
+        ValueType * partials = thrust::raw_pointer_cast(&first1.array()->partials(p)[0]);
+
+        cusp::detail::device::transform_reduce_async(hi - lo,
+                                                     thrust::raw_pointer_cast(&distributed_slice(first1, p)[0]) + lo,
+                                                     thrust::raw_pointer_cast(&distributed_slice(first2, p)[0]) + lo,
+                                                     transform, reduce, init,
+                                                     partials,
+                                                     partials + cusp::detail::device::TRANSFORM_REDUCE_BLOCK_SIZE);
+    }
+
+    ValueType result = init;
+
+    for (size_t p = 0; p < num_parts; p++)
+    {
+        if (!distributed_range(first1, last1, p, lo, hi))
+            continue;
+
+        distributed_scope scope(first1, p);
+
+        ValueType partial;
+
+        cusp::detail::check_cuda(cudaMemcpy(&partial,
+                                            thrust::raw_pointer_cast(&first1.array()->partials(p)[0]) + cusp::detail::device::TRANSFORM_REDUCE_BLOCK_SIZE,
+                                            sizeof(ValueType), cudaMemcpyDeviceToHost),
+                                 "distributed reduction failed");
+
+        result = reduce(result, partial);
+    }
+
+    // combine the results of the processes in the same order everywhere
+    const cusp::communicator& comm = first1.array()->get_distribution().get_communicator();
+
+    if (comm.size() > 1)
+    {
+        std::vector<ValueType> results;
+        comm.allgather(result, results);
+
+        result = init;
+
+        for (size_t r = 0; r < results.size(); r++)
+            result = reduce(result, results[r]);
+    }
+
+    return result;
+}
+
+// the binned sum of transform((x[i], y[i])) over [first1, last1) of the
+// reproducible mode.  The sums of the slices and of the processes are
+// combined exactly, so the result does not depend on the partitioning.
+// Each slice is reduced before the next one is issued.
+template <typename Array1, typename Array2, typename UnaryFunction>
+typename Array1::value_type
+distributed_binned_reduce(cusp::distributed_iterator<Array1> first1,
+                          cusp::distributed_iterator<Array1> last1,
+                          cusp::distributed_iterator<Array2> first2,
+                          UnaryFunction transform)
+{
+    typedef typename Array1::value_type                    ValueType;
+    typedef cusp::detail::binned_accumulator<ValueType>    Accumulator;
+    typedef typename Accumulator::type                     Sum;
+
+    assert_same_distribution(first1, first2);
+
+    size_t lo, hi;
+
+    Sum sum;
+
+    for (size_t p = 0; p < first1.array()->num_partitions(); p++)
+    {
+        if (!distributed_range(first1, last1, p, lo, hi))
+            continue;
+
+        distributed_scope scope(first1, p);
+
+        sum = Accumulator::combine(sum,
+            cusp::detail::streamed::transform_reduce(
+                thrust::make_zip_iterator(thrust::make_tuple(distributed_slice(first1, p).begin() + lo, distributed_slice(first2, p).begin() + lo)),
+                thrust::make_zip_iterator(thrust::make_tuple(distributed_slice(first1, p).begin() + hi, distributed_slice(first2, p).begin() + hi)),
+                transform, Sum(), binned_plus<ValueType>()));
+    }
+
+    const cusp::communicator& comm = first1.array()->get_distribution().get_communicator();
+
+    if (comm.size() > 1)
+    {
+        std::vector<Sum> sums;
+        comm.allgather(sum, sums);
+
+        sum = Sum();
+
+        for (size_t r = 0; r < sums.size(); r++)
+            sum = Accumulator::combine(sum, sums[r]);
+    }
+
+    return Accumulator::value(sum);
+}
+
+template <typename Array1, typename Array2, typename ScalarType>
+void axpy(cusp::distributed_iterator<Array1> first1,
+          cusp::distributed_iterator<Array1> last1,
+          cusp::distributed_iterator<Array2> first2,
+          ScalarType alpha)
+{
+    assert_same_distribution(first1, first2);
+
+    size_t lo, hi;
+
+    for (size_t p = 0; p < first1.array()->num_partitions(); p++)
+    {
+        if (!distributed_range(first1, last1, p, lo, hi))
+            continue;
+
+        distributed_scope scope(first1, p);
+
+        cusp::blas::detail::axpy(distributed_slice(first1, p).begin() + lo,
+                                 distributed_slice(first1, p).begin() + hi,
+                                 distributed_slice(first2, p).begin() + lo,
+                                 alpha);
+    }
+}
+
+template <typename Array1, typename Array2, typename Array3, typename ScalarType1, typename ScalarType2>
+void axpby(cusp::distributed_iterator<Array1> first1,
+           cusp::distributed_iterator<Array1> last1,
+           cusp::distributed_iterator<Array2> first2,
+           cusp::distributed_iterator<Array3> output,
+           ScalarType1 alpha,
+           ScalarType2 beta)
+{
+    assert_same_distribution(first1, first2);
+    assert_same_distribution(first1, output);
+
+    size_t lo, hi;
+
+    for (size_t p = 0; p < first1.array()->num_partitions(); p++)
+    {
+        if (!distributed_range(first1, last1, p, lo, hi))
+            continue;
+
+        distributed_scope scope(first1, p);
+
+        cusp::blas::detail::axpby(distributed_slice(first1, p).begin() + lo,
+                                  distributed_slice(first1, p).begin() + hi,
+                                  distributed_slice(first2, p).begin() + lo,
+                                  distributed_slice(output, p).begin() + lo,
+                                  alpha, beta);
+    }
+}
+
+template <typename Array1, typename Array2, typename Array3, typename Array4,
+          typename ScalarType1, typename ScalarType2, typename ScalarType3>
+void axpbypcz(cusp::distributed_iterator<Array1> first1,
+              cusp::distributed_iterator<Array1> last1,
+              cusp::distributed_iterator<Array2> first2,
+              cusp::distributed_iterator<Array3> first3,
+              cusp::distributed_iterator<Array4> output,
+              ScalarType1 alpha,
+              ScalarType2 beta,
+              ScalarType3 gamma)
+{
+    assert_same_distribution(first1, first2);
+    assert_same_distribution(first1, first3);
+    assert_same_distribution(first1, output);
+
+    size_t lo, hi;
+
+    for (size_t p = 0; p < first1.array()->num_partitions(); p++)
+    {
+        if (!distributed_range(first1, last1, p, lo, hi))
+            continue;
+
+        distributed_scope scope(first1, p);
+
+        cusp::blas::detail::axpbypcz(distributed_slice(first1, p).begin() + lo,
+                                     distributed_slice(first1, p).begin() + hi,
+                                     distributed_slice(first2, p).begin() + lo,
+                                     distributed_slice(first3, p).begin() + lo,
+                                     distributed_slice(output, p).begin() + lo,
+                                     alpha, beta, gamma);
+    }
+}
+
+template <typename Array1, typename Array2, typename Array3>
+void xmy(cusp::distributed_iterator<Array1> first1,
+         cusp::distributed_iterator<Array1> last1,
+         cusp::distributed_iterator<Array2> first2,
+         cusp::distributed_iterator<Array3> output)
+{
+    assert_same_distribution(first1, first2);
+    assert_same_distribution(first1, output);
+
+    size_t lo, hi;
+
+    for (size_t p = 0; p < first1.array()->num_partitions(); p++)
+    {
+        if (!distributed_range(first1, last1, p, lo, hi))
+            continue;
+
+        distributed_scope scope(first1, p);
+
+        cusp::blas::detail::xmy(distributed_slice(first1, p).begin() + lo,
+                                distributed_slice(first1, p).begin() + hi,
+                                distributed_slice(first2, p).begin() + lo,
+                                distributed_slice(output, p).begin() + lo);
+    }
+}
+
+template <typename Array1, typename Array2>
+void copy(cusp::distributed_iterator<Array1> first1,
+          cusp::distributed_iterator<Array1> last1,
+          cusp::distributed_iterator<Array2> first2)
+{
+    assert_same_distribution(first1, first2);
+
+    size_t lo, hi;
+
+    for (size_t p = 0; p < first1.array()->num_partitions(); p++)
+    {
+        if (!distributed_range(first1, last1, p, lo, hi))
+            continue;
+
+        distributed_scope scope(first1, p);
+
+        cusp::blas::detail::copy(distributed_slice(first1, p).begin() + lo,
+                                 distributed_slice(first1, p).begin() + hi,
+                                 distributed_slice(first2, p).begin() + lo);
+    }
+}
+
+template <typename Array1, typename Array2>
+typename Array1::value_type
+dot(cusp::distributed_iterator<Array1> first1,
+    cusp::distributed_iterator<Array1> last1,
+    cusp::distributed_iterator<Array2> first2)
+{
+    typedef typename Array1::value_type ValueType;
+
+    if (cusp::detail::reproducible_reductions())
+        return distributed_binned_reduce(first1, last1, first2, binned_dot<ValueType>());
+
+    return distributed_transform_reduce(first1, last1, first2,
+                                        dot_transform<ValueType>(), thrust::plus<ValueType>(), ValueType(0));
+}
+
+template <typename Array1, typename Array2>
+typename Array1::value_type
+dotc(cusp::distributed_iterator<Array1> first1,
+     cusp::distributed_iterator<Array1> last1,
+     cusp::distributed_iterator<Array2> first2)
+{
+    typedef typename Array1::value_type ValueType;
+
+    if (cusp::detail::reproducible_reductions())
+        return distributed_binned_reduce(first1, last1, first2, binned_dotc<ValueType>());
+
+    return distributed_transform_reduce(first1, last1, first2,
+                                        dotc_transform<ValueType>(), thrust::plus<ValueType>(), ValueType(0));
+}
+
+template <typename Array, typename ScalarType>
+void fill(cusp::distributed_iterator<Array> first,
+          cusp::distributed_iterator<Array> last,
+          ScalarType alpha)
+{
+    size_t lo, hi;
+
+    for (size_t p = 0; p < first.array()->num_partitions(); p++)
+    {
+        if (!distributed_range(first, last, p, lo, hi))
+            continue;
+
+        distributed_scope scope(first, p);
+
+        cusp::blas::detail::fill(distributed_slice(first, p).begin() + lo,
+                                 distributed_slice(first, p).begin() + hi,
+                                 alpha);
+    }
+}
+
+template <typename Array>
+typename cusp::norm_type<typename Array::value_type>::type
+nrm1(cusp::distributed_iterator<Array> first,
+     cusp::distributed_iterator<Array> last)
+{
+    typedef typename Array::value_type ValueType;
+
+    return abs(distributed_transform_reduce(first, last, first,
+                                            absolute_transform<ValueType>(), thrust::plus<ValueType>(), ValueType(0)));
+}
+
+template <typename Array>
+typename cusp::norm_type<typename Array::value_type>::type
+nrm2(cusp::distributed_iterator<Array> first,
+     cusp::distributed_iterator<Array> last)
+{
+    typedef typename Array::value_type ValueType;
+
+    // conj(x[i]) * x[i], as in the binned norm of a single array
+    if (cusp::detail::reproducible_reductions())
+        return std::sqrt( abs(distributed_binned_reduce(first, last, first, binned_dotc<ValueType>())) );
+
+    return std::sqrt( abs(distributed_transform_reduce(first, last, first,
+                                                       norm_squared_transform<ValueType>(), thrust::plus<ValueType>(), ValueType(0))) );
+}
+
+template <typename Array>
+typename Array::value_type
+nrmmax(cusp::distributed_iterator<Array> first,
+       cusp::distributed_iterator<Array> last)
+{
+    typedef typename Array::value_type ValueType;
+
+    return distributed_transform_reduce(first, last, first,
+                                        absolute_transform<ValueType>(), maximum<ValueType>(), ValueType(0));
+}
+
+template <typename Array, typename ScalarType>
+void scal(cusp::distributed_iterator<Array> first,
+          cusp::distributed_iterator<Array> last,
+          ScalarType alpha)
+{
+    size_t lo, hi;
+
+    for (size_t p = 0; p < first.array()->num_partitions(); p++)
+    {
+        if (!distributed_range(first, last, p, lo, hi))
+            continue;
+
+        distributed_scope scope(first, p);
+
+        cusp::blas::detail::scal(distributed_slice(first, p).begin() + lo,
+                                 distributed_slice(first, p).begin() + hi,
+                                 alpha);
+    }
+}
+
+} // end namespace detail
+} // end namespace blas
+} // end namespace cusp
+
@@ -0,0 +1,846 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/communicator.h>
+#include <cusp/convert.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/stream.h>
+
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+
+#include <thrust/detail/type_traits.h>
+#include <thrust/iterator/permutation_iterator.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace cusp
+{
+
+// halo values of a partition that come from one source: the vector on the
+// home device, or the slice of another partition for distributed vectors.
+// Values exchanged with another process are staged in pinned host memory:
+// a partition imports them from process rank, and the matrix exports the
+// values of its slices that other processes import.
+template <typename IndexType, typename ValueType, typename MemorySpace>
+struct distributed_csr_matrix<IndexType,ValueType,MemorySpace>::halo_segment
+{
+    size_t source; // partition owning the values (distributed vectors)
+    int    device; // device of the values, or of the importing partition
+    size_t offset; // position of the values in x_halo
+    size_t count;  // number of values
+
+    int rank;      // process of the other end, -1 within this process
+    int tag;       // message tag of the exchange with that process
+
+    // on the source device: indices of the values in the source vector
+    // and the gathered values (not for imports)
+    cusp::array1d<IndexType,cusp::device_memory> indices;
+    cusp::array1d<ValueType,cusp::device_memory> send_buffer;
+
+    ValueType * host_buffer;
+
+    cudaEvent_t gathered;
+
+    halo_segment(void)
+        : source(0), device(0), offset(0), count(0),
+          rank(-1), tag(0), host_buffer(0), gathered(0) {}
+};
+
+// rows [row_begin, row_end) of the matrix, stored on one device
+template <typename IndexType, typename ValueType, typename MemorySpace>
+struct distributed_csr_matrix<IndexType,ValueType,MemorySpace>::partition
+{
+    int device;
+    IndexType row_begin;
+    IndexType row_end;
+
+    cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> local;
+    cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> off;
+
+    // copies of the rows of x and y on the home device
+    cusp::array1d<ValueType,cusp::device_memory> x_local;
+    cusp::array1d<ValueType,cusp::device_memory> y_local;
+
+    // halo values, ordered like the columns of off
+    cusp::array1d<ValueType,cusp::device_memory> x_halo;
+
+    std::vector<halo_segment *> segments;
+    size_t num_imports; // segments received from other processes
+
+    cudaStream_t stream;      // local product, off-process product and y
+    cudaStream_t halo_stream; // transfer of the halo values
+
+    cudaEvent_t halo_arrived;
+    cudaEvent_t done;
+
+    partition(void)
+        : device(0), row_begin(0), row_end(0), num_imports(0),
+          stream(0), halo_stream(0), halo_arrived(0), done(0) {}
+};
+
+//////////////////
+// Constructors //
+//////////////////
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename MatrixType>
+distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::distributed_csr_matrix(const MatrixType& matrix)
+    : Parent(), home(0), x_ready(0)
+{
+    int num_devices = 0;
+    cusp::detail::check_cuda(cudaGetDeviceCount(&num_devices), "cudaGetDeviceCount failed");
+
+    std::vector<int> devices;
+    for (int d = 0; d < num_devices; d++)
+        devices.push_back(d);
+
+    initialize(matrix, devices);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename MatrixType>
+distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::distributed_csr_matrix(const MatrixType& matrix, const std::vector<int>& devices)
+    : Parent(), home(0), x_ready(0)
+{
+    initialize(matrix, devices);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename MatrixType>
+distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::distributed_csr_matrix(const MatrixType& rows, const cusp::distribution& d)
+    : Parent(), home(0), x_ready(0)
+{
+    cudaGetDevice(&home);
+
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> A;
+    cusp::convert(rows, A);
+
+    build(A, d);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::~distributed_csr_matrix(void)
+{
+    release();
+}
+
+//////////////////////
+// Member Functions //
+//////////////////////
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+int distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::device(size_t p) const
+{
+    return dist.device(p);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+IndexType distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::row_begin(size_t p) const
+{
+    return IndexType(dist.begin(p));
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+IndexType distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::row_end(size_t p) const
+{
+    return IndexType(dist.end(p));
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+size_t distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::num_halo_columns(size_t p) const
+{
+    return partitions[p] ? partitions[p]->off.num_cols : 0;
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename MatrixType>
+void distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::initialize(const MatrixType& matrix, const std::vector<int>& devices)
+{
+    if (matrix.num_rows != matrix.num_cols)
+        throw cusp::invalid_input_exception("distributed_csr_matrix requires a square matrix");
+
+    if (devices.empty())
+        throw cusp::invalid_input_exception("distributed_csr_matrix requires at least one device");
+
+    cudaGetDevice(&home);
+
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> A;
+    cusp::convert(matrix, A);
+
+    const size_t num_parts = devices.size();
+
+    // split the rows into ranges with about the same number of entries
+    std::vector<IndexType> bounds(num_parts + 1, IndexType(0));
+    bounds[num_parts] = A.num_rows;
+
+    for (size_t p = 1; p < num_parts; p++)
+    {
+        if (A.num_entries == 0)
+        {
+            bounds[p] = IndexType((p * A.num_rows) / num_parts);
+        }
+        else
+        {
+            const IndexType target = IndexType((p * A.num_entries) / num_parts);
+            bounds[p] = IndexType(std::lower_bound(A.row_offsets.begin(), A.row_offsets.end(), target) - A.row_offsets.begin());
+            bounds[p] = std::min<IndexType>(std::max<IndexType>(bounds[p], bounds[p - 1]), A.num_rows);
+        }
+    }
+
+    build(A, cusp::distribution(devices, std::vector<size_t>(bounds.begin(), bounds.end())));
+}
+
+// A holds the rows of the partitions of this process, in order, with
+// global column indices
+template <typename IndexType, typename ValueType, typename MemorySpace>
+void distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::build(const cusp::csr_matrix<IndexType,ValueType,cusp::host_memory>& A, const cusp::distribution& d)
+{
+    // halo values come from the slices of the other partitions
+    const bool distributed = thrust::detail::is_same<MemorySpace, cusp::distributed_memory>::value;
+
+    const cusp::communicator& comm = d.get_communicator();
+    const size_t num_parts = d.num_partitions();
+
+    if (num_parts == 0)
+        throw cusp::invalid_input_exception("distributed_csr_matrix requires at least one device");
+
+    if (A.num_cols != d.size())
+        throw cusp::invalid_input_exception("matrix columns do not match the distribution");
+
+    int num_devices = 0;
+    cusp::detail::check_cuda(cudaGetDeviceCount(&num_devices), "cudaGetDeviceCount failed");
+
+    size_t num_rows = 0;
+
+    for (size_t p = 0; p < num_parts; p++)
+    {
+        if (!d.local(p))
+        {
+            if (!distributed)
+                throw cusp::invalid_input_exception("distributed_csr_matrix with device_memory vectors requires the partitions to reside on the calling process");
+
+            continue;
+        }
+
+        if (d.device(p) < 0 || d.device(p) >= num_devices)
+            throw cusp::invalid_input_exception("invalid device of distributed_csr_matrix");
+
+        num_rows += d.end(p) - d.begin(p);
+    }
+
+    if (A.num_rows != num_rows)
+        throw cusp::invalid_input_exception("matrix rows do not match the distribution");
+
+    std::vector<size_t> num_entries;
+    comm.allgather(size_t(A.num_entries), num_entries);
+
+    Parent::resize(d.size(), d.size(), std::accumulate(num_entries.begin(), num_entries.end(), size_t(0)));
+
+    dist = d;
+
+    // for each process: the owner and the indices of the halo values that
+    // are imported from it, one message per segment
+    std::vector< std::vector<size_t> > requests(comm.size());
+    std::vector<int> num_messages(comm.size(), 0);
+
+    try
+    {
+        cusp::detail::check_cuda(cudaEventCreateWithFlags(&x_ready, cudaEventDisableTiming), "cudaEventCreate failed");
+
+        // first row of the current partition in A
+        IndexType first = 0;
+
+        for (size_t p = 0; p < num_parts; p++)
+        {
+            partitions.push_back(0);
+
+            if (!d.local(p))
+                continue;
+
+            partitions.back() = new partition;
+
+            partition& part = *partitions.back();
+            part.device    = d.device(p);
+            part.row_begin = IndexType(d.begin(p));
+            part.row_end   = IndexType(d.end(p));
+
+            const IndexType num_local_rows = part.row_end - part.row_begin;
+            const IndexType last = first + num_local_rows;
+
+            // sorted distinct columns outside the row range
+            std::vector<IndexType> halo;
+            size_t num_local_entries = 0;
+
+            for (IndexType jj = A.row_offsets[first]; jj < A.row_offsets[last]; jj++)
+            {
+                const IndexType j = A.column_indices[jj];
+
+                if (part.row_begin <= j && j < part.row_end)
+                    num_local_entries++;
+                else
+                    halo.push_back(j);
+            }
+
+            std::sort(halo.begin(), halo.end());
+            halo.erase(std::unique(halo.begin(), halo.end()), halo.end());
+
+            const size_t num_off_entries = (A.row_offsets[last] - A.row_offsets[first]) - num_local_entries;
+
+            cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> local(num_local_rows, num_local_rows, num_local_entries);
+            cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> off(num_local_rows, halo.size(), num_off_entries);
+
+            local.row_offsets[0] = 0;
+            off.row_offsets[0]   = 0;
+
+            IndexType nl = 0;
+            IndexType no = 0;
+
+            for (IndexType i = first; i < last; i++)
+            {
+                for (IndexType jj = A.row_offsets[i]; jj < A.row_offsets[i + 1]; jj++)
+                {
+                    const IndexType j = A.column_indices[jj];
+
+                    if (part.row_begin <= j && j < part.row_end)
+                    {
+                        local.column_indices[nl] = j - part.row_begin;
+                        local.values[nl]         = A.values[jj];
+                        nl++;
+                    }
+                    else
+                    {
+                        off.column_indices[no] = IndexType(std::lower_bound(halo.begin(), halo.end(), j) - halo.begin());
+                        off.values[no]         = A.values[jj];
+                        no++;
+                    }
+                }
+
+                local.row_offsets[i - first + 1] = nl;
+                off.row_offsets[i - first + 1]   = no;
+            }
+
+            first = last;
+
+            // the halo columns owned by one partition are consecutive
+            for (size_t begin = 0, end = 0; begin < halo.size(); begin = end)
+            {
+                cusp::array1d<IndexType,cusp::host_memory> indices;
+
+                part.segments.push_back(new halo_segment);
+
+                halo_segment& segment = *part.segments.back();
+                segment.offset = begin;
+
+                if (distributed)
+                {
+                    segment.source = d.owner(halo[begin]);
+                    segment.device = d.device(segment.source);
+
+                    for (end = begin; end < halo.size() && size_t(halo[end]) < d.end(segment.source); end++)
+                        indices.push_back(IndexType(halo[end] - d.begin(segment.source)));
+                }
+                else
+                {
+                    segment.device = home;
+
+                    end = halo.size();
+                    indices.assign(halo.begin(), halo.end());
+                }
+
+                segment.count = indices.size();
+
+                if (!d.local(segment.source))
+                {
+                    // request the values from the owning process
+                    segment.rank   = d.rank(segment.source);
+                    segment.tag    = num_messages[segment.rank]++;
+                    segment.device = part.device;
+
+                    std::vector<size_t>& request = requests[segment.rank];
+                    request.push_back(segment.source);
+                    request.push_back(segment.count);
+                    request.insert(request.end(), indices.begin(), indices.end());
+
+                    cusp::detail::scoped_device scope(part.device);
+
+                    cusp::detail::check_cuda(cudaMallocHost((void **) &segment.host_buffer, segment.count * sizeof(ValueType)), "cudaMallocHost failed");
+
+                    part.num_imports++;
+
+                    continue;
+                }
+
+                cusp::detail::enable_peer_access(part.device, segment.device);
+                cusp::detail::enable_peer_access(segment.device, part.device);
+
+                cusp::detail::scoped_device scope(segment.device);
+
+                segment.indices = indices;
+                segment.send_buffer.resize(indices.size());
+
+                cusp::detail::check_cuda(cudaEventCreateWithFlags(&segment.gathered, cudaEventDisableTiming), "cudaEventCreate failed");
+            }
+
+            if (!distributed)
+            {
+                cusp::detail::enable_peer_access(part.device, home);
+                cusp::detail::enable_peer_access(home, part.device);
+            }
+
+            cusp::detail::scoped_device scope(part.device);
+
+            part.local = local;
+            part.off   = off;
+
+            if (!distributed)
+            {
+                part.x_local.resize(num_local_rows);
+                part.y_local.resize(num_local_rows);
+            }
+
+            part.x_halo.resize(halo.size());
+
+            cusp::detail::check_cuda(cudaStreamCreateWithFlags(&part.stream,      cudaStreamNonBlocking), "cudaStreamCreate failed");
+            cusp::detail::check_cuda(cudaStreamCreateWithFlags(&part.halo_stream, cudaStreamNonBlocking), "cudaStreamCreate failed");
+            cusp::detail::check_cuda(cudaEventCreateWithFlags(&part.halo_arrived, cudaEventDisableTiming), "cudaEventCreate failed");
+            cusp::detail::check_cuda(cudaEventCreateWithFlags(&part.done,         cudaEventDisableTiming), "cudaEventCreate failed");
+        }
+
+        // the exchange plan: export the values that the other processes
+        // request, in the order of their messages
+        std::vector< std::vector<size_t> > received;
+        comm.alltoallv(requests, received);
+
+        for (size_t r = 0; r < received.size(); r++)
+        {
+            for (size_t pos = 0, tag = 0; pos < received[r].size(); tag++)
+            {
+                exports.push_back(new halo_segment);
+
+                halo_segment& segment = *exports.back();
+                segment.source = received[r][pos];
+                segment.device = d.device(segment.source);
+                segment.count  = received[r][pos + 1];
+                segment.rank   = int(r);
+                segment.tag    = int(tag);
+
+                cusp::array1d<IndexType,cusp::host_memory> indices(received[r].begin() + pos + 2,
+                                                                   received[r].begin() + pos + 2 + segment.count);
+                pos += 2 + segment.count;
+
+                cusp::detail::scoped_device scope(segment.device);
+
+                segment.indices = indices;
+                segment.send_buffer.resize(segment.count);
+
+                cusp::detail::check_cuda(cudaMallocHost((void **) &segment.host_buffer, segment.count * sizeof(ValueType)), "cudaMallocHost failed");
+                cusp::detail::check_cuda(cudaEventCreateWithFlags(&segment.gathered, cudaEventDisableTiming), "cudaEventCreate failed");
+            }
+        }
+    }
+    catch (...)
+    {
+        release();
+        throw;
+    }
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+void distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::release(void)
+{
+    cusp::detail::scoped_device scope(home);
+
+    for (size_t p = 0; p < partitions.size(); p++)
+    {
+        partition * part = partitions[p];
+
+        if (part == 0)
+            continue;
+
+        {
+            cusp::detail::scoped_device part_scope(part->device);
+
+            if (part->stream)       cudaStreamSynchronize(part->stream);
+            if (part->halo_stream)  cudaStreamSynchronize(part->halo_stream);
+
+            if (part->stream)       cudaStreamDestroy(part->stream);
+            if (part->halo_stream)  cudaStreamDestroy(part->halo_stream);
+            if (part->halo_arrived) cudaEventDestroy(part->halo_arrived);
+            if (part->done)         cudaEventDestroy(part->done);
+
+            // free the storage of the partition device
+            part->local   = cusp::csr_matrix<IndexType,ValueType,cusp::device_memory>();
+            part->off     = cusp::csr_matrix<IndexType,ValueType,cusp::device_memory>();
+            part->x_local = cusp::array1d<ValueType,cusp::device_memory>();
+            part->y_local = cusp::array1d<ValueType,cusp::device_memory>();
+            part->x_halo  = cusp::array1d<ValueType,cusp::device_memory>();
+        }
+
+        for (size_t s = 0; s < part->segments.size(); s++)
+        {
+            halo_segment * segment = part->segments[s];
+
+            cusp::detail::scoped_device segment_scope(segment->device);
+
+            if (segment->gathered)    cudaEventDestroy(segment->gathered);
+            if (segment->host_buffer) cudaFreeHost(segment->host_buffer);
+
+            delete segment;
+        }
+
+        delete part;
+    }
+
+    partitions.clear();
+
+    for (size_t s = 0; s < exports.size(); s++)
+    {
+        halo_segment * segment = exports[s];
+
+        cusp::detail::scoped_device segment_scope(segment->device);
+
+        if (segment->gathered)
+        {
+            cudaEventSynchronize(segment->gathered);
+            cudaEventDestroy(segment->gathered);
+        }
+
+        if (segment->host_buffer) cudaFreeHost(segment->host_buffer);
+
+        delete segment;
+    }
+
+    exports.clear();
+
+    if (x_ready)
+        cudaEventDestroy(x_ready);
+
+    x_ready = 0;
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename VectorType1, typename VectorType2>
+void distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::operator()(const VectorType1& x, VectorType2& y) const
+{
+    if (Parent::num_rows == 0)
+        return;
+
+    multiply(x, y, typename VectorType1::memory_space());
+}
+
+// y = A*x, issued on the current stream of the home device
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename VectorType1, typename VectorType2>
+void distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::multiply(const VectorType1& x, VectorType2& y, cusp::device_memory) const
+{
+    cusp::detail::scoped_device scope(home);
+
+    const cudaStream_t stream = cusp::detail::current_stream();
+
+    const ValueType * x_ptr = thrust::raw_pointer_cast(&x[0]);
+          ValueType * y_ptr = thrust::raw_pointer_cast(&y[0]);
+
+    cusp::detail::check_cuda(cudaEventRecord(x_ready, stream), "cudaEventRecord failed");
+
+    // gather the halo values on the home device and start the transfers
+    for (size_t p = 0; p < partitions.size(); p++)
+    {
+        partition& part = *partitions[p];
+
+        for (size_t s = 0; s < part.segments.size(); s++)
+        {
+            halo_segment& segment = *part.segments[s];
+
+            cusp::detail::streamed::copy(thrust::make_permutation_iterator(x.begin(), segment.indices.begin()),
+                                         thrust::make_permutation_iterator(x.begin(), segment.indices.end()),
+                                         segment.send_buffer.begin());
+
+            cudaEventRecord(segment.gathered, stream);
+
+            cudaStreamWaitEvent(part.halo_stream, segment.gathered, 0);
+            cudaMemcpyPeerAsync(thrust::raw_pointer_cast(&part.x_halo[0]) + segment.offset, part.device,
+                                thrust::raw_pointer_cast(&segment.send_buffer[0]), segment.device,
+                                segment.send_buffer.size() * sizeof(ValueType), part.halo_stream);
+        }
+
+        if (!part.segments.empty())
+            cudaEventRecord(part.halo_arrived, part.halo_stream);
+    }
+
+    // multiply by the local blocks while the halo values are in flight
+    for (size_t p = 0; p < partitions.size(); p++)
+    {
+        partition& part = *partitions[p];
+
+        const size_t num_local_rows = part.row_end - part.row_begin;
+
+        if (num_local_rows == 0)
+            continue;
+
+        cusp::detail::scoped_device part_scope(part.device);
+
+        cudaStreamWaitEvent(part.stream, x_ready, 0);
+        cudaMemcpyPeerAsync(thrust::raw_pointer_cast(&part.x_local[0]), part.device,
+                            x_ptr + part.row_begin, home,
+                            num_local_rows * sizeof(ValueType), part.stream);
+
+        cusp::scoped_stream stream_scope(part.stream);
+
+        cusp::multiply(part.local, part.x_local, part.y_local);
+
+        if (!part.segments.empty())
+        {
+            cudaStreamWaitEvent(part.stream, part.halo_arrived, 0);
+            cusp::multiply(part.off, part.x_halo, part.y_local, ValueType(1), ValueType(1));
+        }
+
+        cudaMemcpyPeerAsync(y_ptr + part.row_begin, home,
+                            thrust::raw_pointer_cast(&part.y_local[0]), part.device,
+                            num_local_rows * sizeof(ValueType), part.stream);
+        cudaEventRecord(part.done, part.stream);
+    }
+
+    // y is complete once every partition has copied its rows
+    for (size_t p = 0; p < partitions.size(); p++)
+    {
+        partition& part = *partitions[p];
+
+        if (part.row_end != part.row_begin)
+            cudaStreamWaitEvent(stream, part.done, 0);
+    }
+}
+
+// y = A*x for vectors distributed like the rows, issued on the default
+// stream of each device.  Values from other processes are received while
+// the local blocks are multiplied.
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename VectorType1, typename VectorType2>
+void distributed_csr_matrix<IndexType,ValueType,MemorySpace>
+    ::multiply(const VectorType1& x, VectorType2& y, cusp::distributed_memory) const
+{
+    if (x.get_distribution() != dist || y.get_distribution() != dist)
+        throw cusp::invalid_input_exception("vector distribution does not match distributed_csr_matrix");
+
+#if defined(CUSP_USE_MPI)
+    const MPI_Comm comm = dist.get_communicator().get();
+
+    std::vector<MPI_Request> receives;
+    std::vector<MPI_Request> sends;
+
+    // post the receives once the previous transfers out of the host
+    // buffers are complete
+    for (size_t p = 0; p < partitions.size(); p++)
+    {
+        if (partitions[p] == 0 || partitions[p]->num_imports == 0)
+            continue;
+
+        partition& part = *partitions[p];
+
+        cusp::detail::scoped_device part_scope(part.device);
+
+        cudaEventSynchronize(part.halo_arrived);
+
+        for (size_t s = 0; s < part.segments.size(); s++)
+        {
+            halo_segment& segment = *part.segments[s];
+
+            if (segment.rank < 0)
+                continue;
+
+            receives.push_back(MPI_REQUEST_NULL);
+            cusp::detail::check_mpi(MPI_Irecv(segment.host_buffer, int(segment.count * sizeof(ValueType)), MPI_BYTE,
+                                              segment.rank, segment.tag, comm, &receives.back()),
+                                    "MPI_Irecv failed");
+        }
+    }
+#endif
+
+    // gather the halo values on the devices that own them
+    for (size_t p = 0; p < partitions.size(); p++)
+    {
+        if (partitions[p] == 0)
+            continue;
+
+        partition& part = *partitions[p];
+
+        for (size_t s = 0; s < part.segments.size(); s++)
+        {
+            halo_segment& segment = *part.segments[s];
+
+            if (segment.rank >= 0)
+                continue;
+
+            cusp::detail::scoped_device segment_scope(segment.device);
+            cusp::scoped_stream stream_scope(0);
+
+            // the previous transfer out of the send buffer is complete
+            cudaStreamWaitEvent(0, part.halo_arrived, 0);
+
+            cusp::detail::streamed::copy(thrust::make_permutation_iterator(x.slice(segment.source).begin(), segment.indices.begin()),
+                                         thrust::make_permutation_iterator(x.slice(segment.source).begin(), segment.indices.end()),
+                                         segment.send_buffer.begin());
+
+            cudaEventRecord(segment.gathered, 0);
+        }
+    }
+
+    // stage the values that other processes import in host memory
+    for (size_t s = 0; s < exports.size(); s++)
+    {
+        halo_segment& segment = *exports[s];
+
+        cusp::detail::scoped_device segment_scope(segment.device);
+        cusp::scoped_stream stream_scope(0);
+
+        cusp::detail::streamed::copy(thrust::make_permutation_iterator(x.slice(segment.source).begin(), segment.indices.begin()),
+                                     thrust::make_permutation_iterator(x.slice(segment.source).begin(), segment.indices.end()),
+                                     segment.send_buffer.begin());
+
+        cudaMemcpyAsync(segment.host_buffer, thrust::raw_pointer_cast(&segment.send_buffer[0]),
+                        segment.count * sizeof(ValueType), cudaMemcpyDeviceToHost, 0);
+        cudaEventRecord(segment.gathered, 0);
+    }
+
+    // transfer the halo values between the devices of this process
+    for (size_t p = 0; p < partitions.size(); p++)
+    {
+        if (partitions[p] == 0 || partitions[p]->segments.empty())
+            continue;
+
+        partition& part = *partitions[p];
+
+        cusp::detail::scoped_device part_scope(part.device);
+
+        // the previous off-process product is done with x_halo
+        cudaStreamWaitEvent(part.halo_stream, part.done, 0);
+
+        for (size_t s = 0; s < part.segments.size(); s++)
+        {
+            halo_segment& segment = *part.segments[s];
+
+            if (segment.rank >= 0)
+                continue;
+
+            cudaStreamWaitEvent(part.halo_stream, segment.gathered, 0);
+            cudaMemcpyPeerAsync(thrust::raw_pointer_cast(&part.x_halo[0]) + segment.offset, part.device,
+                                thrust::raw_pointer_cast(&segment.send_buffer[0]), segment.device,
+                                segment.send_buffer.size() * sizeof(ValueType), part.halo_stream);
+        }
+
+        if (part.num_imports == 0)
+            cudaEventRecord(part.halo_arrived, part.halo_stream);
+    }
+
+    // multiply by the local blocks while the halo values are in flight
+    for (size_t p = 0; p < partitions.size(); p++)
+    {
+        if (partitions[p] == 0 || partitions[p]->row_end == partitions[p]->row_begin)
+            continue;
+
+        partition& part = *partitions[p];
+
+        cusp::detail::scoped_device part_scope(part.device);
+        cusp::scoped_stream stream_scope(0);
+
+        cusp::multiply(part.local, x.slice(p), y.slice(p));
+    }
+
+#if defined(CUSP_USE_MPI)
+    // send the staged values and copy the received ones to the devices
+    for (size_t s = 0; s < exports.size(); s++)
+    {
+        halo_segment& segment = *exports[s];
+
+        cusp::detail::scoped_device segment_scope(segment.device);
+
+        cudaEventSynchronize(segment.gathered);
+
+        sends.push_back(MPI_REQUEST_NULL);
+        cusp::detail::check_mpi(MPI_Isend(segment.host_buffer, int(segment.count * sizeof(ValueType)), MPI_BYTE,
+                                          segment.rank, segment.tag, comm, &sends.back()),
+                                "MPI_Isend failed");
+    }
+
+    if (!receives.empty())
+        cusp::detail::check_mpi(MPI_Waitall(int(receives.size()), &receives[0], MPI_STATUSES_IGNORE), "MPI_Waitall failed");
+
+    for (size_t p = 0; p < partitions.size(); p++)
+    {
+        if (partitions[p] == 0 || partitions[p]->num_imports == 0)
+            continue;
+
+        partition& part = *partitions[p];
+
+        cusp::detail::scoped_device part_scope(part.device);
+
+        for (size_t s = 0; s < part.segments.size(); s++)
+        {
+            halo_segment& segment = *part.segments[s];
+
+            if (segment.rank < 0)
+                continue;
+
+            cudaMemcpyAsync(thrust::raw_pointer_cast(&part.x_halo[0]) + segment.offset, segment.host_buffer,
+                            segment.count * sizeof(ValueType), cudaMemcpyHostToDevice, part.halo_stream);
+        }
+
+        cudaEventRecord(part.halo_arrived, part.halo_stream);
+    }
+#endif
+
+    // add the products of the off-process blocks
+    for (size_t p = 0; p < partitions.size(); p++)
+    {
+        if (partitions[p] == 0 || partitions[p]->row_end == partitions[p]->row_begin)
+            continue;
+
+        partition& part = *partitions[p];
+
+        cusp::detail::scoped_device part_scope(part.device);
+        cusp::scoped_stream stream_scope(0);
+
+        if (!part.segments.empty())
+        {
+            cudaStreamWaitEvent(0, part.halo_arrived, 0);
+            cusp::multiply(part.off, part.x_halo, y.slice(p), ValueType(1), ValueType(1));
+        }
+
+        cudaEventRecord(part.done, 0);
+    }
+
+#if defined(CUSP_USE_MPI)
+    if (!sends.empty())
+        cusp::detail::check_mpi(MPI_Waitall(int(sends.size()), &sends[0], MPI_STATUSES_IGNORE), "MPI_Waitall failed");
+#endif
+}
+
+} // end namespace cusp
@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/exception.h>
+
+#include <cusp/detail/scoped_device.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+
+//////////////////
+// distribution //
+//////////////////
+
+inline distribution::distribution(void) {}
+
+inline distribution::distribution(size_t N)
+{
+    int num_devices = 0;
+    cusp::detail::check_cuda(cudaGetDeviceCount(&num_devices), "cudaGetDeviceCount failed");
+
+    for (int d = 0; d < num_devices; d++)
+        devices.push_back(d);
+
+    split(N);
+}
+
+inline distribution::distribution(size_t N, const std::vector<int>& devices)
+    : devices(devices)
+{
+    if (devices.empty())
+        throw cusp::invalid_input_exception("distribution requires at least one device");
+
+    split(N);
+}
+
+inline distribution::distribution(const std::vector<int>& devices, const std::vector<size_t>& offsets)
+    : devices(devices), offsets(offsets), ranks(devices.size(), 0)
+{
+    validate();
+}
+
+inline distribution::distribution(const std::vector<int>& devices,
+                                  const std::vector<size_t>& offsets,
+                                  const std::vector<int>& ranks,
+                                  const cusp::communicator& comm)
+    : devices(devices), offsets(offsets), ranks(ranks), comm(comm)
+{
+    validate();
+}
+
+inline distribution::distribution(size_t N, int device, const cusp::communicator& comm)
+    : comm(comm)
+{
+    comm.allgather(device, devices);
+
+    split(N);
+
+    for (size_t p = 0; p < ranks.size(); p++)
+        ranks[p] = int(p);
+}
+
+inline size_t distribution::owner(size_t i) const
+{
+    return std::upper_bound(offsets.begin(), offsets.end(), i) - offsets.begin() - 1;
+}
+
+inline void distribution::validate(void) const
+{
+    if (devices.empty() || offsets.size() != devices.size() + 1 || offsets[0] != 0)
+        throw cusp::invalid_input_exception("invalid distribution offsets");
+
+    for (size_t p = 0; p < devices.size(); p++)
+        if (offsets[p] > offsets[p + 1])
+            throw cusp::invalid_input_exception("invalid distribution offsets");
+
+    if (ranks.size() != devices.size())
+        throw cusp::invalid_input_exception("invalid distribution ranks");
+
+    for (size_t p = 0; p < ranks.size(); p++)
+        if (ranks[p] < 0 || ranks[p] >= comm.size())
+            throw cusp::invalid_input_exception("invalid distribution ranks");
+}
+
+inline void distribution::split(size_t N)
+{
+    const size_t num_parts = devices.size();
+
+    offsets.resize(num_parts + 1);
+    ranks.assign(num_parts, 0);
+
+    for (size_t p = 0; p <= num_parts; p++)
+        offsets[p] = (p * N) / num_parts;
+}
+
+} // end namespace cusp
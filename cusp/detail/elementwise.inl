@@ -14,26 +14,18 @@
  *  limitations under the License.
  */
 
+#include <cusp/csr_matrix.h>
+#include <cusp/convert.h>
+#include <cusp/exception.h>
+#include <cusp/format.h>
+
+#include <cusp/detail/add_plan.inl>
+#include <cusp/detail/transform_elementwise.inl>
 #include <cusp/detail/dispatch/elementwise.h>
 
 namespace cusp
 {
 
-//template <typename Matrix1,
-//          typename Matrix2,
-//          typename Matrix3,
-//          typename BinaryFunction>
-//void transform_elementwise(const Matrix1& A,
-//                           const Matrix2& B,
-//                                 Matrix3& C,
-//                                 BinaryFunction op)
-//{
-//    cusp::detail::dispatch::transform_elementwise(A, B, C, op,
-//            typename Matrix1::memory_space(),
-//            typename Matrix2::memory_space(),
-//            typename Matrix3::memory_space());
-//}
-
 template <typename Matrix1,
           typename Matrix2,
           typename Matrix3>
@@ -73,5 +65,57 @@ void subtract(const Matrix1& A,
             typename Matrix3::memory_space());
 }
 
+namespace detail
+{
+
+template <typename Matrix1, typename Matrix2, typename Matrix3, typename ScalarType>
+void add(const Matrix1& A, const Matrix2& B, Matrix3& C, ScalarType alpha, ScalarType beta,
+         cusp::csr_format, cusp::csr_format, cusp::csr_format)
+{
+    cusp::detail::csr_add(A, B, C, alpha, beta);
+}
+
+// other formats are added in CSR and converted
+template <typename Matrix1, typename Matrix2, typename Matrix3, typename ScalarType,
+          typename Format1, typename Format2, typename Format3>
+void add(const Matrix1& A, const Matrix2& B, Matrix3& C, ScalarType alpha, ScalarType beta,
+         Format1, Format2, Format3)
+{
+    typedef typename Matrix3::index_type   IndexType;
+    typedef typename Matrix3::value_type   ValueType;
+    typedef typename Matrix3::memory_space MemorySpace;
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> A_(A);
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> B_(B);
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> C_;
+
+    cusp::detail::csr_add(A_, B_, C_, alpha, beta);
+
+    cusp::convert(C_, C);
+}
+
+} // end namespace detail
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3,
+          typename ScalarType>
+void add(const Matrix1& A,
+         const Matrix2& B,
+               Matrix3& C,
+         ScalarType alpha,
+         ScalarType beta)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if(A.num_rows != B.num_rows || A.num_cols != B.num_cols)
+        throw cusp::invalid_input_exception("array dimensions do not match");
+
+    cusp::detail::add(A, B, C, alpha, beta,
+            typename Matrix1::format(),
+            typename Matrix2::format(),
+            typename Matrix3::format());
+}
+
 } // end namespace cusp
 
@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+
+// Fixed-size arithmetic of small dense blocks.
+//
+// The kernels for blocked formats spend most of their time in products of
+// small dense blocks, e.g. the 3x3 or 5x5 blocks of elasticity and flow
+// problems.  The templates below unroll such products at compile time,
+// like the host reference in host/reference/fixed_size.h, so that the
+// entries of a block row stay in registers and the index arithmetic is
+// free of loop control.  They run on the host and the device, and x may
+// be any object with operator[], e.g. a texture fetch in a device kernel.
+//
+// dispatch_fixed_size selects the instantiation for a block size that is
+// only known at run time.
+
+namespace cusp
+{
+namespace detail
+{
+
+// sum + A[0] * x[j] + A[1] * x[j+1] + ... + A[N-1] * x[j+N-1]
+template <int N>
+struct fixed_dot
+{
+    template <typename StorageType, typename Vector, typename IndexType, typename ValueType>
+    __host__ __device__
+    static ValueType apply(const StorageType * A, const Vector& x, const IndexType j, const ValueType sum)
+    {
+        return fixed_dot<N-1>::apply(A + 1, x, j + 1, sum + A[0] * x[j]);
+    }
+};
+
+template <>
+struct fixed_dot<0>
+{
+    template <typename StorageType, typename Vector, typename IndexType, typename ValueType>
+    __host__ __device__
+    static ValueType apply(const StorageType * A, const Vector& x, const IndexType j, const ValueType sum)
+    {
+        return sum;
+    }
+};
+
+// y[0:M] += A * x[j:j+N] for the M-by-N row-major block A
+template <int M, int N>
+struct fixed_gemv
+{
+    template <typename StorageType, typename Vector, typename IndexType, typename ValueType>
+    __host__ __device__
+    static void apply(const StorageType * A, const Vector& x, const IndexType j, ValueType * y)
+    {
+        y[0] = fixed_dot<N>::apply(A, x, j, y[0]);
+
+        fixed_gemv<M-1,N>::apply(A + N, x, j, y + 1);
+    }
+};
+
+template <int N>
+struct fixed_gemv<0,N>
+{
+    template <typename StorageType, typename Vector, typename IndexType, typename ValueType>
+    __host__ __device__
+    static void apply(const StorageType * A, const Vector& x, const IndexType j, ValueType * y) {}
+};
+
+// Calls op.template apply<B>() with the compile-time block size B equal
+// to block_size, or op.template apply<0>() when block_size is not one of
+// the specialized sizes.
+template <typename Operation>
+void dispatch_fixed_size(const size_t block_size, Operation& op)
+{
+    switch (block_size)
+    {
+        case 1:  op.template apply<1>(); break;
+        case 2:  op.template apply<2>(); break;
+        case 3:  op.template apply<3>(); break;
+        case 4:  op.template apply<4>(); break;
+        case 5:  op.template apply<5>(); break;
+        case 6:  op.template apply<6>(); break;
+        case 8:  op.template apply<8>(); break;
+        default: op.template apply<0>(); break;
+    }
+}
+
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/convert.h>
+#include <cusp/transpose.h>
+#include <cusp/detail/format_utils.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// At <- src^T, recording where each value of At comes from
+template <typename Matrix, typename IndexType, typename ValueType, typename MemorySpace>
+void transpose_values(const Matrix& src,
+                      cusp::csr_matrix<IndexType,ValueType,MemorySpace>& At,
+                      cusp::value_permutation<IndexType,MemorySpace>& permutation)
+{
+    typedef typename cusp::detail::index_valued_matrix<Matrix,IndexType,MemorySpace>::type SourcePattern;
+
+    // transpose the numbered pattern, then gather the values in its order
+    SourcePattern S;
+    cusp::detail::number_values(src, S, typename Matrix::format());
+
+    cusp::csr_matrix<IndexType,IndexType,MemorySpace> T;
+    cusp::transpose(S, T);
+
+    permutation.num_source_values = src.num_entries;
+    permutation.indices.resize(T.num_entries);
+
+    cusp::detail::record_values(T, permutation.indices, cusp::csr_format());
+
+    At.resize(T.num_rows, T.num_cols, T.num_entries);
+    At.row_offsets.swap(T.row_offsets);
+    At.column_indices.swap(T.column_indices);
+
+    cusp::update_values(At, src.values, permutation);
+}
+
+} // end namespace detail
+
+template <typename MatrixType>
+format_cache<MatrixType>
+::format_cache(const MatrixType& matrix)
+    : Parent(matrix.num_rows, matrix.num_cols, matrix.num_entries),
+      matrix(matrix), has_hyb(false), has_transpose(false), has_diagonal(false)
+{}
+
+template <typename MatrixType>
+const typename format_cache<MatrixType>::hyb_matrix_type&
+format_cache<MatrixType>
+::hyb(void) const
+{
+    cusp::detail::pool_lock lock(mutex);
+
+    if (!has_hyb)
+    {
+        cusp::convert(matrix, hyb_matrix, hyb_permutation);
+        has_hyb = true;
+    }
+
+    return hyb_matrix;
+}
+
+template <typename MatrixType>
+const typename format_cache<MatrixType>::csr_matrix_type&
+format_cache<MatrixType>
+::transpose(void) const
+{
+    cusp::detail::pool_lock lock(mutex);
+
+    if (!has_transpose)
+    {
+        cusp::detail::transpose_values(matrix, transpose_matrix, transpose_permutation);
+        has_transpose = true;
+    }
+
+    return transpose_matrix;
+}
+
+template <typename MatrixType>
+const typename format_cache<MatrixType>::diagonal_type&
+format_cache<MatrixType>
+::diagonal(void) const
+{
+    cusp::detail::pool_lock lock(mutex);
+
+    if (!has_diagonal)
+    {
+        cusp::detail::extract_diagonal(matrix, diagonal_values);
+        has_diagonal = true;
+    }
+
+    return diagonal_values;
+}
+
+template <typename MatrixType>
+void format_cache<MatrixType>
+::update_values(void)
+{
+    cusp::detail::pool_lock lock(mutex);
+
+    if (has_hyb)
+        cusp::update_values(hyb_matrix, matrix.values, hyb_permutation);
+
+    if (has_transpose)
+        cusp::update_values(transpose_matrix, matrix.values, transpose_permutation);
+
+    if (has_diagonal)
+        cusp::detail::extract_diagonal(matrix, diagonal_values);
+}
+
+template <typename MatrixType>
+void format_cache<MatrixType>
+::invalidate(void)
+{
+    cusp::detail::pool_lock lock(mutex);
+
+    Parent::resize(matrix.num_rows, matrix.num_cols, matrix.num_entries);
+
+    has_hyb       = false;
+    has_transpose = false;
+    has_diagonal  = false;
+
+    hyb_matrix       = hyb_matrix_type();
+    transpose_matrix = csr_matrix_type();
+    diagonal_values.resize(0);
+
+    hyb_permutation       = permutation_type();
+    transpose_permutation = permutation_type();
+}
+
+} // end namespace cusp
+
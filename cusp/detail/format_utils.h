@@ -36,6 +36,11 @@ void sort_by_row(Array1& rows, Array2& columns, Array3& values);
 
 template <typename Array1, typename Array2, typename Array3>
 void sort_by_row_and_column(Array1& rows, Array2& columns, Array3& values);
+
+// sort by (I,J) with the dimensions of the matrix, which bound the indices
+template <typename Array1, typename Array2, typename Array3>
+void sort_by_row_and_column(Array1& rows, Array2& columns, Array3& values,
+                            const size_t num_rows, const size_t num_cols);
     
 } // end namespace detail
 } // end namespace cusp
@@ -18,8 +18,12 @@
 #include <cusp/format.h>
 #include <cusp/array1d.h>
 
+#include <cusp/detail/dispatch/format_utils.h>
+
 #include <thrust/fill.h>
 #include <thrust/extrema.h>
+#include <thrust/find.h>
+#include <thrust/for_each.h>
 #include <thrust/binary_search.h>
 #include <thrust/transform.h>
 #include <thrust/gather.h>
@@ -27,6 +31,11 @@
 #include <thrust/sequence.h>
 #include <thrust/scan.h>
 #include <thrust/sort.h>
+#include <thrust/tuple.h>
+
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
 
 namespace cusp
 {
@@ -57,6 +66,10 @@ void offsets_to_indices(const OffsetArray& offsets, IndexArray& indices)
 
     typedef typename OffsetArray::value_type OffsetType;
 
+    // expand contiguous arrays along a balanced merge path
+    if (cusp::detail::dispatch::offsets_to_indices(offsets, indices))
+        return;
+
     // convert compressed row offsets into uncompressed row indices
     thrust::fill(indices.begin(), indices.end(), OffsetType(0));
     thrust::scatter_if( thrust::counting_iterator<OffsetType>(0),
@@ -76,6 +89,10 @@ void indices_to_offsets(const IndexArray& indices, OffsetArray& offsets)
 
     typedef typename OffsetArray::value_type OffsetType;
 
+    // detect the row boundaries of contiguous arrays in a single pass
+    if (cusp::detail::dispatch::indices_to_offsets(indices, offsets))
+        return;
+
     // convert uncompressed row indices into compressed row offsets
     thrust::lower_bound(indices.begin(),
                         indices.end(),
@@ -84,22 +101,6 @@ void indices_to_offsets(const IndexArray& indices, OffsetArray& offsets)
                         offsets.begin());
 }
 
-template<typename IndexType>
-struct row_operator : public std::unary_function<size_t,IndexType>
-{
-    size_t pitch;
-
-    row_operator(size_t pitch)
-        : pitch(pitch) {}
-
-    __host__ __device__
-    IndexType operator()(const size_t & linear_index) const
-    {
-        return linear_index % pitch;
-    }
-};
-
-
 template <typename IndexType>
 struct tuple_equal_to : public thrust::unary_function<thrust::tuple<IndexType,IndexType>,bool>
 {
@@ -129,95 +130,159 @@ void extract_diagonal(const Matrix& A, Array& output, cusp::coo_format)
 }
 
 
-template <typename Matrix, typename Array>
-void extract_diagonal(const Matrix& A, Array& output, cusp::csr_format)
+// The row functors of extract_diagonal visit the rows that hold an entry
+// of the main diagonal, one thread per row.
+
+// d[i] <- A(i,i), found by a binary search of the sorted columns of row i
+template <typename IndexType, typename ValueType1, typename ValueType2>
+struct csr_diagonal_functor
 {
-    typedef typename Matrix::index_type  IndexType;
-    typedef typename Array::value_type   ValueType;
-    typedef typename Array::memory_space MemorySpace;
-    
-    // first expand the compressed row offsets into row indices
-    cusp::array1d<IndexType,MemorySpace> row_indices(A.num_entries);
-    offsets_to_indices(A.row_offsets, row_indices);
+    const IndexType  * Ap;
+    const IndexType  * Aj;
+    const ValueType1 * Ax;
+          ValueType2 * d;
 
-    // initialize output to zero
-    thrust::fill(output.begin(), output.end(), ValueType(0));
+    csr_diagonal_functor(const IndexType * Ap, const IndexType * Aj, const ValueType1 * Ax, ValueType2 * d)
+        : Ap(Ap), Aj(Aj), Ax(Ax), d(d) {}
 
-    // scatter the diagonal values to output
-    thrust::scatter_if(A.values.begin(), A.values.end(),
-                       row_indices.begin(),
-                       thrust::make_transform_iterator(thrust::make_zip_iterator(thrust::make_tuple(row_indices.begin(), A.column_indices.begin())), tuple_equal_to<IndexType>()),
-                       output.begin());
-}
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType first = Ap[i];
+        IndexType last  = Ap[i + 1];
+
+        while (first < last)
+        {
+            const IndexType middle = first + (last - first) / 2;
 
+            if (Aj[middle] < i)
+                first = middle + 1;
+            else
+                last  = middle;
+        }
 
-template <typename Matrix, typename Array>
-void extract_diagonal(const Matrix& A, Array& output, cusp::dia_format)
+        d[i] = (first < Ap[i + 1] && Aj[first] == i) ? ValueType2(Ax[first]) : ValueType2(0);
+    }
+};
+
+// d[i] <- A(i,i), found by a scan of the sorted, left-shifted slots of
+// row i, which ends at the first padded slot or column past i
+template <typename IndexType, typename ValueType1, typename ValueType2>
+struct ell_diagonal_functor
 {
-    typedef typename Matrix::index_type  IndexType;
-    typedef typename Array::value_type   ValueType;
-    
-    // copy diagonal_offsets to host (sometimes unnecessary)
-    cusp::array1d<IndexType,cusp::host_memory> diagonal_offsets(A.diagonal_offsets);
+    const IndexType  * Aj;
+    const ValueType1 * Ax;
+          ValueType2 * d;
+    size_t num_slots;
+    size_t pitch;
+    IndexType invalid_index;
 
-    for(size_t i = 0; i < diagonal_offsets.size(); i++)
+    ell_diagonal_functor(const IndexType * Aj, const ValueType1 * Ax, ValueType2 * d,
+                         const size_t num_slots, const size_t pitch, const IndexType invalid_index)
+        : Aj(Aj), Ax(Ax), d(d), num_slots(num_slots), pitch(pitch), invalid_index(invalid_index) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
     {
-        if(diagonal_offsets[i] == 0)
+        ValueType2 Aii = 0;
+
+        for (size_t n = 0, offset = i; n < num_slots; n++, offset += pitch)
         {
-            // diagonal found, copy to output and return
-            thrust::copy(A.values.values.begin() + A.values.pitch * i,
-                         A.values.values.begin() + A.values.pitch * i + output.size(),
-                         output.begin());
-            return;
+            const IndexType j = Aj[offset];
+
+            if (j == i)
+            {
+                Aii = Ax[offset];
+                break;
+            }
+
+            if (j == invalid_index || j > i)
+                break;
         }
+
+        d[i] = Aii;
     }
+};
 
-    // no diagonal found
-    thrust::fill(output.begin(), output.end(), ValueType(0));
+template <typename Array>
+typename Array::value_type * diagonal_pointer(Array& a)
+{
+    return a.empty() ? 0 : thrust::raw_pointer_cast(&a[0]);
 }
 
+template <typename Array>
+const typename Array::value_type * diagonal_pointer(const Array& a)
+{
+    return a.empty() ? 0 : thrust::raw_pointer_cast(&a[0]);
+}
 
 template <typename Matrix, typename Array>
-void extract_diagonal(const Matrix& A, Array& output, cusp::ell_format)
+void extract_diagonal(const Matrix& A, Array& output, cusp::csr_format)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Matrix::value_type  ValueType1;
+    typedef typename Array::value_type   ValueType2;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(output.size()),
+                     csr_diagonal_functor<IndexType,ValueType1,ValueType2>
+                        (diagonal_pointer(A.row_offsets), diagonal_pointer(A.column_indices),
+                         diagonal_pointer(A.values), diagonal_pointer(output)));
+}
+
+
+template <typename Matrix, typename Array>
+void extract_diagonal(const Matrix& A, Array& output, cusp::dia_format)
 {
     typedef typename Matrix::index_type  IndexType;
     typedef typename Array::value_type   ValueType;
-    
-    // initialize output to zero
-    thrust::fill(output.begin(), output.end(), ValueType(0));
 
-    thrust::scatter_if
-        (A.values.values.begin(), A.values.values.end(),
-         thrust::make_transform_iterator(thrust::counting_iterator<size_t>(0), row_operator<IndexType>(A.column_indices.pitch)),
-         thrust::make_zip_iterator(thrust::make_tuple
-             (thrust::make_transform_iterator(thrust::counting_iterator<size_t>(0), row_operator<IndexType>(A.column_indices.pitch)),
-              A.column_indices.values.begin())),
-         output.begin(),
-         tuple_equal_to<IndexType>());
+    // the position of offset 0 is the only value read back
+    const size_t i = thrust::find(A.diagonal_offsets.begin(), A.diagonal_offsets.end(), IndexType(0)) - A.diagonal_offsets.begin();
 
-    // TODO ignore padded values in column_indices
+    if (i < A.diagonal_offsets.size())
+        thrust::copy(A.values.values.begin() + A.values.pitch * i,
+                     A.values.values.begin() + A.values.pitch * i + output.size(),
+                     output.begin());
+    else
+        thrust::fill(output.begin(), output.end(), ValueType(0));
+}
+
+
+template <typename Matrix, typename Array>
+void extract_ell_diagonal(const Matrix& A, Array& output)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Matrix::value_type  ValueType1;
+    typedef typename Array::value_type   ValueType2;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(output.size()),
+                     ell_diagonal_functor<IndexType,ValueType1,ValueType2>
+                        (diagonal_pointer(A.column_indices.values), diagonal_pointer(A.values.values),
+                         diagonal_pointer(output), A.column_indices.num_cols, A.column_indices.pitch,
+                         IndexType(Matrix::invalid_index)));
+}
+
+template <typename Matrix, typename Array>
+void extract_diagonal(const Matrix& A, Array& output, cusp::ell_format)
+{
+    extract_ell_diagonal(A, output);
 }
 
 template <typename Matrix, typename Array>
 void extract_diagonal(const Matrix& A, Array& output, cusp::hyb_format)
 {
     typedef typename Matrix::index_type  IndexType;
-    typedef typename Array::value_type   ValueType;
-    
-    // extract COO diagonal
-    cusp::detail::extract_diagonal(A.coo, output);
-
-    // extract ELL diagonal
-    thrust::scatter_if
-        (A.ell.values.values.begin(), A.ell.values.values.end(),
-         thrust::make_transform_iterator(thrust::counting_iterator<size_t>(0), row_operator<IndexType>(A.ell.column_indices.pitch)),
-         thrust::make_zip_iterator(thrust::make_tuple
-             (thrust::make_transform_iterator(thrust::counting_iterator<size_t>(0), row_operator<IndexType>(A.ell.column_indices.pitch)),
-              A.ell.column_indices.values.begin())),
-         output.begin(),
-         tuple_equal_to<IndexType>());
-
-    // TODO ignore padded values in column_indices
+
+    // every row from the ELL part
+    extract_ell_diagonal(A.ell, output);
+
+    // the COO part only holds the entries that spilled from full ELL rows
+    thrust::scatter_if(A.coo.values.begin(), A.coo.values.end(),
+                       A.coo.row_indices.begin(),
+                       thrust::make_transform_iterator(thrust::make_zip_iterator(thrust::make_tuple(A.coo.row_indices.begin(), A.coo.column_indices.begin())), tuple_equal_to<IndexType>()),
+                       output.begin());
 }
 
 
@@ -259,8 +324,77 @@ void sort_by_row(Array1& rows, Array2& columns, Array3& values)
                    thrust::make_zip_iterator(thrust::make_tuple(columns.begin(), values.begin())));
 }
 
+// number of bits needed to represent the nonnegative index i
+template <typename IndexType>
+unsigned int index_bits(IndexType i)
+{
+    unsigned int bits = 0;
+
+    while (i > 0)
+    {
+        i >>= 1;
+        bits++;
+    }
+
+    return bits;
+}
+
+// (row << shift) | column
+template <typename KeyType>
+struct pack_row_column_functor
+{
+    unsigned int shift;
+
+    pack_row_column_functor(unsigned int shift) : shift(shift) {}
+
+    template <typename IndexType1, typename IndexType2>
+    __host__ __device__
+    KeyType operator()(const IndexType1& row, const IndexType2& column) const
+    {
+        return (KeyType(row) << shift) | KeyType(column);
+    }
+};
+
+// (key >> shift, key & mask)
+template <typename KeyType, typename IndexType1, typename IndexType2>
+struct unpack_row_column_functor
+{
+    unsigned int shift;
+
+    unpack_row_column_functor(unsigned int shift) : shift(shift) {}
+
+    __host__ __device__
+    thrust::tuple<IndexType1,IndexType2> operator()(const KeyType& key) const
+    {
+        const KeyType mask = (KeyType(1) << shift) - KeyType(1);
+
+        return thrust::make_tuple(IndexType1(key >> shift), IndexType2(key & mask));
+    }
+};
+
+// sort (I,J,V) by a single radix sort of the packed keys (I << shift) | J
+template <typename KeyType, typename Array1, typename Array2, typename Array3>
+void sort_by_packed_row_and_column(Array1& rows, Array2& columns, Array3& values, const unsigned int shift)
+{
+    typedef typename Array1::value_type   IndexType1;
+    typedef typename Array2::value_type   IndexType2;
+    typedef typename Array1::memory_space MemorySpace;
+
+    cusp::array1d<KeyType, typename temporary_memory_space<KeyType,MemorySpace>::type> keys(rows.size());
+
+    thrust::transform(rows.begin(), rows.end(), columns.begin(), keys.begin(),
+                      pack_row_column_functor<KeyType>(shift));
+
+    thrust::stable_sort_by_key(keys.begin(), keys.end(), values.begin());
+
+    thrust::transform(keys.begin(), keys.end(),
+                      thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin())),
+                      unpack_row_column_functor<KeyType,IndexType1,IndexType2>(shift));
+}
+
 template <typename Array1, typename Array2, typename Array3>
-void sort_by_row_and_column(Array1& rows, Array2& columns, Array3& values)
+void sort_by_row_and_column(Array1& rows, Array2& columns, Array3& values,
+                            const size_t num_rows, const size_t num_cols)
 {
     CUSP_PROFILE_SCOPED();
 
@@ -270,29 +404,56 @@ void sort_by_row_and_column(Array1& rows, Array2& columns, Array3& values)
         
     size_t N = rows.size();
 
-    cusp::array1d<IndexType,MemorySpace> permutation(N);
-    thrust::sequence(permutation.begin(), permutation.end());
-  
-    // compute permutation and sort by (I,J)
-    {
-        cusp::array1d<IndexType,MemorySpace> temp(columns);
-        thrust::stable_sort_by_key(temp.begin(), temp.end(), permutation.begin());
+    if (N < 2)
+        return;
 
-        cusp::copy(rows, temp);
-        thrust::gather(permutation.begin(), permutation.end(), temp.begin(), rows.begin());
-        thrust::stable_sort_by_key(rows.begin(), rows.end(), permutation.begin());
+    const unsigned int row_bits = index_bits(num_rows > 0 ? num_rows - 1 : 0);
+    const unsigned int col_bits = index_bits(num_cols > 0 ? num_cols - 1 : 0);
+
+    // one stable radix sort of (I,J) packed into a 32 or 64-bit key, the
+    // values are carried along
+    if (row_bits + col_bits < 32)
+    {
+        sort_by_packed_row_and_column<unsigned int>(rows, columns, values, col_bits);
+        return;
+    }
 
-        cusp::copy(columns, temp);
-        thrust::gather(permutation.begin(), permutation.end(), temp.begin(), columns.begin());
+    if (row_bits + col_bits < 64)
+    {
+        sort_by_packed_row_and_column<unsigned long long>(rows, columns, values, col_bits);
+        return;
     }
 
+    // otherwise sort by J and then stably by I, carrying the permutation
+    // of the values through both passes
+    cusp::array1d<IndexType, typename temporary_memory_space<IndexType,MemorySpace>::type> permutation(N);
+    thrust::sequence(permutation.begin(), permutation.end());
+
+    thrust::stable_sort_by_key(columns.begin(), columns.end(),
+                               thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), permutation.begin())));
+    thrust::stable_sort_by_key(rows.begin(), rows.end(),
+                               thrust::make_zip_iterator(thrust::make_tuple(columns.begin(), permutation.begin())));
+
     // use permutation to reorder the values
     {
-        cusp::array1d<ValueType,MemorySpace> temp(values);
+        cusp::array1d<ValueType, typename temporary_memory_space<ValueType,MemorySpace>::type> temp(values);
         thrust::gather(permutation.begin(), permutation.end(), temp.begin(), values.begin());
     }
 }
 
+template <typename Array1, typename Array2, typename Array3>
+void sort_by_row_and_column(Array1& rows, Array2& columns, Array3& values)
+{
+    if (rows.size() == 0)
+        return;
+
+    // bound the indices when the dimensions of the matrix are not known
+    const size_t num_rows = size_t(*thrust::max_element(rows.begin(), rows.end())) + 1;
+    const size_t num_cols = size_t(*thrust::max_element(columns.begin(), columns.end())) + 1;
+
+    cusp::detail::sort_by_row_and_column(rows, columns, values, num_rows, num_cols);
+}
+
 } // end namespace detail
 } // end namespace cusp
 
@@ -26,6 +26,14 @@ template <typename IndexType, typename ValueType, typename MemorySpace> class cs
 template <typename IndexType, typename ValueType, typename MemorySpace> class dia_matrix;
 template <typename IndexType, typename ValueType, typename MemorySpace> class ell_matrix;
 template <typename IndexType, typename ValueType, typename MemorySpace> class hyb_matrix;
+template <typename IndexType, typename ValueType, typename MemorySpace> class bsr_matrix;
+template <typename IndexType, typename ValueType, typename MemorySpace> class sell_matrix;
+template <typename IndexType, typename ValueType, typename MemorySpace> class jds_matrix;
+template <typename IndexType, typename ValueType, typename MemorySpace> class csr16_matrix;
+template <typename IndexType, typename ValueType, typename MemorySpace> class dia_coo_matrix;
+template <typename IndexType, typename ValueType, typename MemorySpace> class symmetric_csr_matrix;
+template <typename IndexType, typename ValueType, typename MemorySpace> class auto_format_matrix;
+template <typename Matrix>                                              class split_complex_matrix;
 
 } // end namespace cusp
 
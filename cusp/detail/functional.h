@@ -37,6 +37,15 @@ template<typename T>
   __host__ __device__ T operator()(const T &x) const {return T(0);}
 }; // end minus
 
+// a * b where a may be of another type than b, e.g. a real matrix entry
+// times a complex vector entry, which is not promoted to T
+template<typename T>
+  struct scalar_multiplies
+{
+  template <typename S>
+  __host__ __device__ T operator()(const S &a, const T &b) const {return a * b;}
+}; // end scalar_multiplies
+
 } // end namespace detail
 } // end namespace cusp
 
@@ -0,0 +1,403 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/convert.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/format.h>
+#include <cusp/multiply.h>
+
+#include <cusp/detail/format_utils.h>
+
+#include <thrust/binary_search.h>
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/functional.h>
+#include <thrust/gather.h>
+#include <thrust/scan.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/unique.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+
+namespace cusp
+{
+namespace detail
+{
+
+// CSR matrices are used as they are, other formats are converted
+template <typename Matrix, typename Format = typename Matrix::format>
+class galerkin_csr_input
+{
+    public:
+    typedef cusp::csr_matrix<typename Matrix::index_type,
+                             typename Matrix::value_type,
+                             typename Matrix::memory_space> type;
+
+    galerkin_csr_input(const Matrix& M) : matrix(M) {}
+
+    const type& operator()(void) const { return matrix; }
+
+    private:
+    type matrix;
+};
+
+template <typename Matrix>
+class galerkin_csr_input<Matrix, cusp::csr_format>
+{
+    public:
+    typedef Matrix type;
+
+    galerkin_csr_input(const Matrix& M) : matrix(M) {}
+
+    const type& operator()(void) const { return matrix; }
+
+    private:
+    const Matrix& matrix;
+};
+
+template <typename IndexType>
+struct galerkin_in_range : public thrust::unary_function<IndexType,bool>
+{
+    const IndexType lower;
+    const IndexType upper;
+
+    galerkin_in_range(const IndexType lower, const IndexType upper)
+        : lower(lower), upper(upper) {}
+
+    __host__ __device__
+    bool operator()(const IndexType i) const
+    {
+        return lower <= i && i < upper;
+    }
+};
+
+// S = A(rows,:)
+template <typename Matrix1, typename Array, typename Matrix2>
+void galerkin_extract_rows(const Matrix1& A, const Array& rows, Matrix2& S)
+{
+    typedef typename Matrix2::index_type   IndexType;
+    typedef typename Matrix2::memory_space MemorySpace;
+
+    const size_t num_rows = rows.size();
+
+    // row offsets of S
+    cusp::array1d<IndexType,MemorySpace> offsets(num_rows + 1, IndexType(0));
+    thrust::transform(thrust::make_permutation_iterator(A.row_offsets.begin() + 1, rows.begin()),
+                      thrust::make_permutation_iterator(A.row_offsets.begin() + 1, rows.end()),
+                      thrust::make_permutation_iterator(A.row_offsets.begin(),     rows.begin()),
+                      offsets.begin(),
+                      thrust::minus<IndexType>());
+    thrust::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin(), IndexType(0));
+
+    const size_t num_entries = offsets[num_rows];
+
+    S.resize(num_rows, A.num_cols, num_entries);
+    thrust::copy(offsets.begin(), offsets.end(), S.row_offsets.begin());
+
+    if (num_entries == 0)
+        return;
+
+    // row of S holding each entry
+    cusp::array1d<IndexType,MemorySpace> source(num_entries);
+    thrust::upper_bound(offsets.begin() + 1, offsets.end(),
+                        thrust::counting_iterator<IndexType>(0),
+                        thrust::counting_iterator<IndexType>(num_entries),
+                        source.begin());
+
+    // distance between the entries of a row in A and in S
+    cusp::array1d<IndexType,MemorySpace> shift(num_rows);
+    thrust::transform(thrust::make_permutation_iterator(A.row_offsets.begin(), rows.begin()),
+                      thrust::make_permutation_iterator(A.row_offsets.begin(), rows.end()),
+                      offsets.begin(),
+                      shift.begin(),
+                      thrust::minus<IndexType>());
+
+    // position of each entry in A
+    thrust::transform(thrust::make_permutation_iterator(shift.begin(), source.begin()),
+                      thrust::make_permutation_iterator(shift.begin(), source.end()),
+                      thrust::counting_iterator<IndexType>(0),
+                      source.begin(),
+                      thrust::plus<IndexType>());
+
+    thrust::gather(source.begin(), source.end(), A.column_indices.begin(), S.column_indices.begin());
+    thrust::gather(source.begin(), source.end(), A.values.begin(),         S.values.begin());
+}
+
+// rows of an explicit restriction operator R
+template <typename Matrix>
+class galerkin_explicit_restriction
+{
+    const Matrix& R;
+
+    public:
+    galerkin_explicit_restriction(const Matrix& R) : R(R) {}
+
+    size_t num_rows(void)    const { return R.num_rows; }
+    size_t num_entries(void) const { return R.num_entries; }
+
+    // R_slab = R[begin:end,:]
+    template <typename Container>
+    void slab(const size_t begin, const size_t end, Container& R_slab) const
+    {
+        typedef typename Container::index_type   IndexType;
+        typedef typename Container::memory_space MemorySpace;
+
+        cusp::array1d<IndexType,MemorySpace> rows(end - begin);
+        thrust::sequence(rows.begin(), rows.end(), IndexType(begin));
+
+        galerkin_extract_rows(R, rows, R_slab);
+    }
+};
+
+// rows of the implicit restriction operator P^T
+template <typename Matrix>
+class galerkin_implicit_restriction
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    const Matrix& P;
+
+    cusp::array1d<IndexType,MemorySpace> P_row_indices;
+
+    public:
+    galerkin_implicit_restriction(const Matrix& P) : P(P), P_row_indices(P.num_entries)
+    {
+        cusp::detail::offsets_to_indices(P.row_offsets, P_row_indices);
+    }
+
+    size_t num_rows(void)    const { return P.num_cols; }
+    size_t num_entries(void) const { return P.num_entries; }
+
+    // R_slab = P[:,begin:end]^T
+    template <typename Container>
+    void slab(const size_t begin, const size_t end, Container& R_slab) const
+    {
+        typedef typename Container::value_type ValueType;
+
+        const galerkin_in_range<IndexType> in_slab(begin, end);
+
+        const size_t num_entries = thrust::count_if(P.column_indices.begin(), P.column_indices.end(), in_slab);
+
+        cusp::array1d<IndexType,MemorySpace> rows(num_entries);
+        cusp::array1d<IndexType,MemorySpace> cols(num_entries);
+        cusp::array1d<ValueType,MemorySpace> vals(num_entries);
+
+        // entries P(i,j) with j in [begin,end) become R(j - begin, i)
+        thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(P.column_indices.begin(), P_row_indices.begin(), P.values.begin())),
+                        thrust::make_zip_iterator(thrust::make_tuple(P.column_indices.end(),   P_row_indices.end(),   P.values.end())),
+                        P.column_indices.begin(),
+                        thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), cols.begin(), vals.begin())),
+                        in_slab);
+
+        thrust::transform(rows.begin(), rows.end(),
+                          thrust::constant_iterator<IndexType>(begin),
+                          rows.begin(),
+                          thrust::minus<IndexType>());
+
+        // a stable sort keeps the columns of each row in order
+        thrust::stable_sort_by_key(rows.begin(), rows.end(),
+                                   thrust::make_zip_iterator(thrust::make_tuple(cols.begin(), vals.begin())));
+
+        R_slab.resize(end - begin, P.num_rows, num_entries);
+        cusp::detail::indices_to_offsets(rows, R_slab.row_offsets);
+        R_slab.column_indices.swap(cols);
+        R_slab.values.swap(vals);
+    }
+};
+
+// RAP = R * A * P where each intermediate A * P holds about slab_capacity products
+template <typename Restriction, typename Matrix1, typename Matrix2, typename Matrix3>
+void galerkin_product_csr(const Restriction& R,
+                          const Matrix1& A,
+                          const Matrix2& P,
+                                Matrix3& RAP,
+                          const double slab_capacity = double(16 << 20))
+{
+    typedef typename Matrix3::index_type   IndexType;
+    typedef typename Matrix3::value_type   ValueType;
+    typedef typename Matrix3::memory_space MemorySpace;
+
+    typedef cusp::csr_matrix<IndexType,ValueType,MemorySpace> Container;
+    typedef typename std::list<Container>                     ContainerList;
+
+    const size_t num_coarse = R.num_rows();
+
+    // estimate the size of the rows of A * P referenced by R from the
+    // average number of entries per row of A and P
+    const double A_row_length = A.num_rows == 0 ? 0.0 : double(A.num_entries) / double(A.num_rows);
+    const double P_row_length = P.num_rows == 0 ? 0.0 : double(P.num_entries) / double(P.num_rows);
+    const double total_work   = double(R.num_entries()) * A_row_length * P_row_length;
+
+    size_t num_slabs = size_t(std::ceil(total_work / slab_capacity));
+    num_slabs = std::max<size_t>(num_slabs, 1);
+    num_slabs = std::min<size_t>(num_slabs, std::max<size_t>(num_coarse, 1));
+
+    ContainerList slabs;
+
+    for(size_t s = 0; s < num_slabs; s++)
+    {
+        const size_t begin = (s + 0) * num_coarse / num_slabs;
+        const size_t end   = (s + 1) * num_coarse / num_slabs;
+
+        Container R_slab;
+        R.slab(begin, end, R_slab);
+
+        // fine rows referenced by the slab
+        cusp::array1d<IndexType,MemorySpace> fine_rows(R_slab.column_indices);
+        thrust::sort(fine_rows.begin(), fine_rows.end());
+        fine_rows.resize(thrust::unique(fine_rows.begin(), fine_rows.end()) - fine_rows.begin());
+
+        // renumber the columns of the slab to the referenced rows
+        {
+            cusp::array1d<IndexType,MemorySpace> local_columns(R_slab.num_entries);
+            thrust::lower_bound(fine_rows.begin(), fine_rows.end(),
+                                R_slab.column_indices.begin(), R_slab.column_indices.end(),
+                                local_columns.begin());
+
+            R_slab.resize(R_slab.num_rows, fine_rows.size(), R_slab.num_entries);
+            R_slab.column_indices.swap(local_columns);
+        }
+
+        // rows of A * P referenced by the slab
+        Container AP_slab;
+        {
+            Container A_slab;
+            galerkin_extract_rows(A, fine_rows, A_slab);
+            cusp::multiply(A_slab, P, AP_slab);
+        }
+
+        slabs.push_back(Container());
+        cusp::multiply(R_slab, AP_slab, slabs.back());
+    }
+
+    if (slabs.size() == 1)
+    {
+        RAP.swap(slabs.front());
+        return;
+    }
+
+    // compute total output size
+    size_t RAP_num_entries = 0;
+    for(typename ContainerList::iterator iter = slabs.begin(); iter != slabs.end(); ++iter)
+        RAP_num_entries += iter->num_entries;
+
+    RAP.resize(num_coarse, P.num_cols, RAP_num_entries);
+    RAP.row_offsets[0] = 0;
+
+    // copy slabs into output
+    size_t row_base = 0;
+    size_t base     = 0;
+    for(typename ContainerList::iterator iter = slabs.begin(); iter != slabs.end(); ++iter)
+    {
+        thrust::transform(iter->row_offsets.begin() + 1, iter->row_offsets.end(),
+                          thrust::constant_iterator<IndexType>(base),
+                          RAP.row_offsets.begin() + row_base + 1,
+                          thrust::plus<IndexType>());
+        thrust::copy(iter->column_indices.begin(), iter->column_indices.end(), RAP.column_indices.begin() + base);
+        thrust::copy(iter->values.begin(),         iter->values.end(),         RAP.values.begin()         + base);
+
+        row_base += iter->num_rows;
+        base     += iter->num_entries;
+    }
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+void galerkin_assign(cusp::csr_matrix<IndexType,ValueType,MemorySpace>& src,
+                     cusp::csr_matrix<IndexType,ValueType,MemorySpace>& dst)
+{
+    dst.swap(src);
+}
+
+template <typename Matrix1, typename Matrix2>
+void galerkin_assign(Matrix1& src, Matrix2& dst)
+{
+    cusp::convert(src, dst);
+}
+
+} // end namespace detail
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3,
+          typename Matrix4>
+void galerkin_product(const Matrix1& R,
+                      const Matrix2& A,
+                      const Matrix3& P,
+                            Matrix4& RAP)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix2::index_type   IndexType;
+    typedef typename Matrix2::value_type   ValueType;
+    typedef typename Matrix2::memory_space MemorySpace;
+
+    if (R.num_cols != A.num_rows || A.num_cols != P.num_rows)
+        throw cusp::invalid_input_exception("matrix dimensions do not match");
+
+    cusp::detail::galerkin_csr_input<Matrix1> R_(R);
+    cusp::detail::galerkin_csr_input<Matrix2> A_(A);
+    cusp::detail::galerkin_csr_input<Matrix3> P_(P);
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> RAP_;
+
+    cusp::detail::galerkin_product_csr
+        (cusp::detail::galerkin_explicit_restriction<typename cusp::detail::galerkin_csr_input<Matrix1>::type>(R_()),
+         A_(), P_(), RAP_);
+
+    cusp::detail::galerkin_assign(RAP_, RAP);
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void galerkin_product(const Matrix1& A,
+                      const Matrix2& P,
+                            Matrix3& RAP)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix1::index_type   IndexType;
+    typedef typename Matrix1::value_type   ValueType;
+    typedef typename Matrix1::memory_space MemorySpace;
+
+    if (A.num_rows != P.num_rows || A.num_cols != P.num_rows)
+        throw cusp::invalid_input_exception("matrix dimensions do not match");
+
+    cusp::detail::galerkin_csr_input<Matrix1> A_(A);
+    cusp::detail::galerkin_csr_input<Matrix2> P_(P);
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> RAP_;
+
+    cusp::detail::galerkin_product_csr
+        (cusp::detail::galerkin_implicit_restriction<typename cusp::detail::galerkin_csr_input<Matrix2>::type>(P_()),
+         A_(), P_(), RAP_);
+
+    cusp::detail::galerkin_assign(RAP_, RAP);
+}
+
+} // end namespace cusp
+
@@ -0,0 +1,61 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <thrust/detail/type_traits.h>
+#include <thrust/iterator/detail/normal_iterator.h>
+
+// Contiguous host arrays, whose storage may be handed to kernels and
+// libraries that take raw pointers.  These are the host containers and
+// the views of raw pointers; device iterators and fancy iterators
+// (e.g. permutation or counting iterators) are excluded.
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+// contiguous host arrays of T
+template <typename Iterator, typename T> struct is_host_contiguous_iterator                                          : thrust::detail::false_type {};
+template <typename T>                    struct is_host_contiguous_iterator<T *, T>                                  : thrust::detail::true_type  {};
+template <typename T>                    struct is_host_contiguous_iterator<const T *, T>                            : thrust::detail::true_type  {};
+template <typename T>                    struct is_host_contiguous_iterator<thrust::detail::normal_iterator<T *>, T>       : thrust::detail::true_type  {};
+template <typename T>                    struct is_host_contiguous_iterator<thrust::detail::normal_iterator<const T *>, T> : thrust::detail::true_type  {};
+
+template <typename Array, typename T>
+struct is_host_contiguous_array : is_host_contiguous_iterator<typename Array::iterator, T> {};
+
+// pointer to the first element, or null for an empty array
+template <typename Array>
+const typename Array::value_type * host_contiguous_pointer(const Array& a)
+{
+    return a.size() == 0 ? 0 : &*a.begin();
+}
+
+template <typename Array>
+typename Array::value_type * host_contiguous_pointer(Array& a)
+{
+    return a.size() == 0 ? 0 : &*a.begin();
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
+
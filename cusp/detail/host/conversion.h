@@ -18,14 +18,21 @@
 
 #pragma once
 
+#include <cusp/array1d.h>
 #include <cusp/ell_matrix.h>
 #include <cusp/exception.h>
 
 #include <cusp/detail/host/conversion_utils.h>
+#include <cusp/detail/host/parallel.h>
 
 #include <thrust/fill.h>
 #include <thrust/extrema.h>
 #include <thrust/count.h>
+#include <thrust/sort.h>
+#include <thrust/binary_search.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace cusp
 {
@@ -45,6 +52,30 @@ void coo_to_csr(const Matrix1& src, Matrix2& dst)
     typedef typename Matrix2::value_type ValueType;
 
     dst.resize(src.num_rows, src.num_cols, src.num_entries);
+
+    // entries sorted by row are already in CSR order
+    if (is_parallel_work(src.num_entries) && thrust::is_sorted(src.row_indices.begin(), src.row_indices.end()))
+    {
+        const long num_rows    = src.num_rows;
+        const long num_entries = src.num_entries;
+
+#ifdef _OPENMP
+        #pragma omp parallel for
+#endif
+        for(long i = 0; i <= num_rows; i++)
+            dst.row_offsets[i] = thrust::lower_bound(src.row_indices.begin(), src.row_indices.end(), IndexType(i)) - src.row_indices.begin();
+
+#ifdef _OPENMP
+        #pragma omp parallel for
+#endif
+        for(long n = 0; n < num_entries; n++)
+        {
+            dst.column_indices[n] = src.column_indices[n];
+            dst.values[n]         = src.values[n];
+        }
+
+        return;
+    }
     
     // compute number of non-zero entries per row of A 
     thrust::fill(dst.row_offsets.begin(), dst.row_offsets.end(), IndexType(0));
@@ -111,8 +142,13 @@ void csr_to_coo(const Matrix1& src, Matrix2& dst)
 
     dst.resize(src.num_rows, src.num_cols, src.num_entries);
    
+    const long num_rows = src.num_rows;
+
     // TODO replace with offsets_to_indices
-    for(size_t i = 0; i < src.num_rows; i++)
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, HOST_ROW_BLOCK_SIZE) if (is_parallel_work(src.num_entries))
+#endif
+    for(long i = 0; i < num_rows; i++)
         for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i + 1]; jj++)
             dst.row_indices[jj] = i;
 
@@ -165,7 +201,12 @@ void csr_to_dia(const Matrix1& src, Matrix2& dst,
     // fill in values array
     thrust::fill(dst.values.values.begin(), dst.values.values.end(), ValueType(0));
 
-    for(size_t i = 0; i < src.num_rows; i++)
+    const long num_rows = src.num_rows;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, HOST_ROW_BLOCK_SIZE) if (is_parallel_work(src.num_entries))
+#endif
+    for(long i = 0; i < num_rows; i++)
     {
         for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
         {
@@ -254,7 +295,12 @@ void csr_to_ell(const Matrix1& src, Matrix2& dst,
     thrust::fill(dst.column_indices.values.begin(), dst.column_indices.values.end(), invalid_index);
     thrust::fill(dst.values.values.begin(),         dst.values.values.end(),         ValueType(0));
 
-    for(size_t i = 0; i < src.num_rows; i++)
+    const long num_rows = src.num_rows;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, HOST_ROW_BLOCK_SIZE) if (is_parallel_work(num_entries))
+#endif
+    for(long i = 0; i < num_rows; i++)
     {
         size_t n = 0;
         IndexType jj = src.row_offsets[i];
@@ -286,6 +332,415 @@ void csr_to_array2d(const Matrix1& src, Matrix2& dst)
 }
 
 
+template <typename Matrix1, typename Matrix2>
+void csr_to_bsr(const Matrix1& src, Matrix2& dst,
+                const size_t block_size)
+{
+    typedef typename Matrix2::index_type IndexType;
+    typedef typename Matrix2::value_type ValueType;
+
+    if (block_size == 0 || src.num_rows % block_size != 0 || src.num_cols % block_size != 0)
+        throw cusp::format_conversion_exception("bsr_matrix block size must divide the matrix dimensions");
+
+    const size_t num_block_rows = src.num_rows / block_size;
+    const size_t num_block_cols = src.num_cols / block_size;
+    const size_t block_entries  = block_size * block_size;
+
+    // last block row in which each block column was seen
+    cusp::array1d<IndexType,cusp::host_memory> last(num_block_cols, IndexType(-1));
+
+    // count the distinct blocks of each block row
+    size_t num_blocks = 0;
+    for(size_t bi = 0; bi < num_block_rows; bi++)
+        for(size_t i = bi * block_size; i < (bi + 1) * block_size; i++)
+            for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+            {
+                const IndexType bj = src.column_indices[jj] / block_size;
+
+                if (last[bj] != IndexType(bi))
+                {
+                    last[bj] = bi;
+                    num_blocks++;
+                }
+            }
+
+    dst.resize(src.num_rows, src.num_cols, num_blocks, block_size);
+
+    thrust::fill(dst.values.begin(), dst.values.end(), ValueType(0));
+    thrust::fill(last.begin(), last.end(), IndexType(-1));
+
+    // position of each block column in the current block row
+    cusp::array1d<IndexType,cusp::host_memory> position(num_block_cols);
+
+    IndexType nnz = 0;
+    dst.row_offsets[0] = 0;
+
+    for(size_t bi = 0; bi < num_block_rows; bi++)
+    {
+        const IndexType row_start = nnz;
+
+        for(size_t i = bi * block_size; i < (bi + 1) * block_size; i++)
+            for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+            {
+                const IndexType bj = src.column_indices[jj] / block_size;
+
+                if (last[bj] != IndexType(bi))
+                {
+                    last[bj] = bi;
+                    dst.column_indices[nnz++] = bj;
+                }
+            }
+
+        std::sort(dst.column_indices.begin() + row_start, dst.column_indices.begin() + nnz);
+
+        for(IndexType n = row_start; n < nnz; n++)
+            position[dst.column_indices[n]] = n;
+
+        // scatter the entries into the (row-major) blocks
+        for(size_t i = bi * block_size; i < (bi + 1) * block_size; i++)
+            for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+            {
+                const IndexType j = src.column_indices[jj];
+                const size_t offset = (i % block_size) * block_size + j % block_size;
+
+                dst.values[position[j / block_size] * block_entries + offset] += src.values[jj]; //sum duplicates
+            }
+
+        dst.row_offsets[bi + 1] = nnz;
+    }
+}
+
+
+template <typename Array>
+struct longer_row
+{
+    const Array& row_offsets;
+
+    longer_row(const Array& row_offsets)
+        : row_offsets(row_offsets) {}
+
+    template <typename IndexType>
+    bool operator()(const IndexType i, const IndexType j) const
+    {
+        return row_offsets[i + 1] - row_offsets[i] > row_offsets[j + 1] - row_offsets[j];
+    }
+};
+
+template <typename Matrix1, typename Matrix2>
+void csr_to_sell(const Matrix1& src, Matrix2& dst,
+                 const size_t slice_size, const size_t sorting_window)
+{
+    typedef typename Matrix2::index_type IndexType;
+    typedef typename Matrix2::value_type ValueType;
+    typedef typename Matrix1::row_offsets_array_type RowOffsetsArray;
+
+    if (slice_size == 0 || sorting_window == 0)
+        throw cusp::format_conversion_exception("sell_matrix slice size and sorting window must be positive");
+
+    const size_t num_slices = (src.num_rows + slice_size - 1) / slice_size;
+
+    // sort the rows by decreasing length within each window
+    cusp::array1d<IndexType,cusp::host_memory> permutation(src.num_rows);
+    for(size_t i = 0; i < src.num_rows; i++)
+        permutation[i] = i;
+
+    for(size_t i = 0; i < src.num_rows; i += sorting_window)
+        std::stable_sort(permutation.begin() + i,
+                         permutation.begin() + std::min(i + sorting_window, src.num_rows),
+                         longer_row<RowOffsetsArray>(src.row_offsets));
+
+    // pad each slice to its longest row
+    cusp::array1d<IndexType,cusp::host_memory> slice_offsets(num_slices + 1);
+    slice_offsets[0] = 0;
+    for(size_t s = 0; s < num_slices; s++)
+    {
+        IndexType width = 0;
+        for(size_t k = s * slice_size; k < std::min((s + 1) * slice_size, src.num_rows); k++)
+            width = std::max(width, src.row_offsets[permutation[k] + 1] - src.row_offsets[permutation[k]]);
+
+        slice_offsets[s + 1] = slice_offsets[s] + width * slice_size;
+    }
+
+    dst.resize(src.num_rows, src.num_cols, src.num_entries, slice_offsets[num_slices], slice_size, sorting_window);
+
+    cusp::copy(permutation,   dst.row_permutation);
+    cusp::copy(slice_offsets, dst.slice_offsets);
+
+    const IndexType invalid_index = Matrix2::invalid_index;
+
+    thrust::fill(dst.column_indices.begin(), dst.column_indices.end(), invalid_index);
+    thrust::fill(dst.values.begin(),         dst.values.end(),         ValueType(0));
+
+    for(size_t k = 0; k < src.num_rows; k++)
+    {
+        const IndexType i      = permutation[k];
+        const IndexType offset = slice_offsets[k / slice_size] + k % slice_size;
+
+        IndexType n = 0;
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++, n++)
+        {
+            dst.column_indices[offset + n * slice_size] = src.column_indices[jj];
+            dst.values[offset + n * slice_size]         = src.values[jj];
+        }
+    }
+}
+
+template <typename Matrix1, typename Matrix2>
+void csr_to_jds(const Matrix1& src, Matrix2& dst)
+{
+    typedef typename Matrix2::index_type IndexType;
+    typedef typename Matrix1::row_offsets_array_type RowOffsetsArray;
+
+    // sort the rows by decreasing length
+    cusp::array1d<IndexType,cusp::host_memory> permutation(src.num_rows);
+    for(size_t i = 0; i < src.num_rows; i++)
+        permutation[i] = i;
+
+    std::stable_sort(permutation.begin(), permutation.end(), longer_row<RowOffsetsArray>(src.row_offsets));
+
+    const size_t num_diagonals = src.num_rows == 0 ? 0 :
+        src.row_offsets[permutation[0] + 1] - src.row_offsets[permutation[0]];
+
+    // diagonal n extends over the leading rows with more than n entries
+    cusp::array1d<IndexType,cusp::host_memory> diagonal_offsets(num_diagonals + 1);
+    diagonal_offsets[0] = 0;
+
+    size_t width = src.num_rows;
+    for(size_t n = 0; n < num_diagonals; n++)
+    {
+        while (width > 0 && size_t(src.row_offsets[permutation[width - 1] + 1] - src.row_offsets[permutation[width - 1]]) <= n)
+            width--;
+
+        diagonal_offsets[n + 1] = diagonal_offsets[n] + width;
+    }
+
+    dst.resize(src.num_rows, src.num_cols, src.num_entries, num_diagonals);
+
+    cusp::copy(permutation,      dst.row_permutation);
+    cusp::copy(diagonal_offsets, dst.diagonal_offsets);
+
+    for(size_t k = 0; k < src.num_rows; k++)
+    {
+        const IndexType i = permutation[k];
+
+        IndexType n = 0;
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++, n++)
+        {
+            dst.column_indices[diagonal_offsets[n] + k] = src.column_indices[jj];
+            dst.values[diagonal_offsets[n] + k]         = src.values[jj];
+        }
+    }
+}
+
+template <typename Matrix1, typename Matrix2>
+void csr_to_csr16(const Matrix1& src, Matrix2& dst)
+{
+    typedef typename Matrix2::index_type  IndexType;
+    typedef typename Matrix2::offset_type OffsetType;
+
+    const size_t max_offset = Matrix2::max_offset;
+
+    // the base column of each row is its smallest column index
+    cusp::array1d<IndexType,cusp::host_memory> bases(src.num_rows, IndexType(0));
+
+    size_t num_overflow_entries = 0;
+
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        if (src.row_offsets[i] == src.row_offsets[i+1])
+            continue;
+
+        IndexType base = src.column_indices[src.row_offsets[i]];
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+            base = std::min(base, src.column_indices[jj]);
+
+        bases[i] = base;
+
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+            if (size_t(src.column_indices[jj] - base) > max_offset)
+                num_overflow_entries++;
+    }
+
+    dst.resize(src.num_rows, src.num_cols, src.num_entries, num_overflow_entries);
+
+    cusp::copy(bases, dst.row_bases);
+
+    IndexType nnz = 0;
+    IndexType num_overflow = 0;
+
+    dst.row_offsets[0] = 0;
+
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+        {
+            const IndexType j = src.column_indices[jj];
+
+            if (size_t(j - bases[i]) > max_offset)
+            {
+                dst.overflow.row_indices[num_overflow]    = i;
+                dst.overflow.column_indices[num_overflow] = j;
+                dst.overflow.values[num_overflow]         = src.values[jj];
+                num_overflow++;
+            }
+            else
+            {
+                dst.column_offsets[nnz] = OffsetType(j - bases[i]);
+                dst.values[nnz]         = src.values[jj];
+                nnz++;
+            }
+        }
+
+        dst.row_offsets[i + 1] = nnz;
+    }
+}
+
+
+template <typename Matrix1, typename Matrix2>
+void csr_to_dia_coo(const Matrix1& src, Matrix2& dst,
+                    const size_t alignment = 32)
+{
+    typedef typename Matrix2::index_type IndexType;
+    typedef typename Matrix2::value_type ValueType;
+
+    // count the entries of each diagonal
+    cusp::array1d<size_t,cusp::host_memory> diag_count(src.num_rows + src.num_cols, 0);
+
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+        {
+            size_t j         = src.column_indices[jj];
+            size_t map_index = (src.num_rows - i) + j; //offset shifted by + num_rows
+
+            diag_count[map_index]++;
+        }
+    }
+
+    // a diagonal is stored in the DIA portion when enough of its num_rows
+    // slots are occupied, otherwise its entries go to the COO portion
+    const size_t min_entries = std::max<size_t>(1, size_t(std::ceil(double(dst.min_fill) * double(src.num_rows))));
+
+    cusp::array1d<IndexType,cusp::host_memory> diag_map(src.num_rows + src.num_cols, IndexType(-1));
+
+    size_t num_diagonals   = 0;
+    size_t num_dia_entries = 0;
+
+    for(size_t n = 0; n < src.num_rows + src.num_cols; n++)
+    {
+        if(diag_count[n] >= min_entries)
+        {
+            diag_map[n] = num_diagonals++;
+            num_dia_entries += diag_count[n];
+        }
+    }
+
+    // allocate DIA/COO structure
+    dst.resize(src.num_rows, src.num_cols, num_dia_entries, src.num_entries - num_dia_entries, num_diagonals, alignment);
+
+    // fill in diagonal_offsets array
+    for(size_t n = 0; n < src.num_rows + src.num_cols; n++)
+        if(diag_map[n] != IndexType(-1))
+            dst.dia.diagonal_offsets[diag_map[n]] = (IndexType) n - (IndexType) src.num_rows;
+
+    // fill in DIA values and COO entries
+    thrust::fill(dst.dia.values.values.begin(), dst.dia.values.values.end(), ValueType(0));
+
+    size_t num_coo_entries = 0;
+
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+        {
+            size_t j         = src.column_indices[jj];
+            size_t map_index = (src.num_rows - i) + j; //offset shifted by + num_rows
+
+            if(diag_map[map_index] != IndexType(-1))
+            {
+                dst.dia.values(i, diag_map[map_index]) = src.values[jj];
+            }
+            else
+            {
+                dst.coo.row_indices[num_coo_entries]    = i;
+                dst.coo.column_indices[num_coo_entries] = j;
+                dst.coo.values[num_coo_entries]         = src.values[jj];
+                num_coo_entries++;
+            }
+        }
+    }
+}
+
+
+template <typename Matrix1, typename Matrix2>
+void csr_to_symmetric_csr(const Matrix1& src, Matrix2& dst)
+{
+    typedef typename Matrix2::index_type IndexType;
+
+    if (src.num_rows != src.num_cols)
+        throw cusp::format_conversion_exception("symmetric_csr_matrix requires a square matrix");
+
+    // every entry of the strictly lower triangle must be mirrored in the
+    // strictly upper triangle
+    size_t num_lower_entries    = 0;
+    size_t num_upper_entries    = 0;
+    size_t num_diagonal_entries = 0;
+
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+        {
+            const size_t j = src.column_indices[jj];
+
+            if (j == i)
+            {
+                num_diagonal_entries++;
+                continue;
+            }
+
+            if (j > i)
+            {
+                num_upper_entries++;
+                continue;
+            }
+
+            num_lower_entries++;
+
+            IndexType kk = src.row_offsets[j];
+            while (kk < src.row_offsets[j+1] && size_t(src.column_indices[kk]) != i)
+                kk++;
+
+            if (kk == src.row_offsets[j+1] || !(src.values[kk] == src.values[jj]))
+                throw cusp::format_conversion_exception("symmetric_csr_matrix requires a symmetric matrix");
+        }
+    }
+
+    if (num_lower_entries != num_upper_entries)
+        throw cusp::format_conversion_exception("symmetric_csr_matrix requires a symmetric matrix");
+
+    dst.resize(src.num_rows, src.num_cols, src.num_entries, num_diagonal_entries + num_upper_entries);
+
+    // copy the upper triangle
+    IndexType nnz = 0;
+
+    dst.row_offsets[0] = 0;
+
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+        {
+            if (size_t(src.column_indices[jj]) >= i)
+            {
+                dst.column_indices[nnz] = src.column_indices[jj];
+                dst.values[nnz]         = src.values[jj];
+                nnz++;
+            }
+        }
+
+        dst.row_offsets[i + 1] = nnz;
+    }
+}
+
+
 /////////////////////
 // DIA Conversions //
 /////////////////////
@@ -296,12 +751,21 @@ void dia_to_csr(const Matrix1& src, Matrix2& dst)
     typedef typename Matrix2::index_type IndexType;
     typedef typename Matrix2::value_type ValueType;
     
-    size_t num_entries = 0;
-    size_t num_diagonals = src.diagonal_offsets.size();
-    
-    // count nonzero entries
-    for(size_t i = 0; i < src.num_rows; i++)
+    const size_t num_diagonals = src.diagonal_offsets.size();
+    const long   num_rows      = src.num_rows;
+    const bool   parallel      = is_parallel_work(src.num_rows * num_diagonals);
+
+    // the row offsets are kept by the second resize
+    dst.resize(src.num_rows, src.num_cols, 0);
+
+    // count nonzero entries of each row
+#ifdef _OPENMP
+    #pragma omp parallel for if (parallel)
+#endif
+    for(long i = 0; i < num_rows; i++)
     {
+        IndexType num_entries = 0;
+
         for(size_t n = 0; n < num_diagonals; n++)
         {
             const IndexType j = i + src.diagonal_offsets[n];
@@ -309,16 +773,22 @@ void dia_to_csr(const Matrix1& src, Matrix2& dst)
             if(j >= 0 && static_cast<size_t>(j) < src.num_cols && src.values(i,n) != ValueType(0))
                 num_entries++;
         }
+
+        dst.row_offsets[i] = num_entries;
     }
 
-    dst.resize(src.num_rows, src.num_cols, num_entries);
+    const size_t num_entries = counts_to_offsets(dst.row_offsets, src.num_rows);
 
-    num_entries = 0;
-    dst.row_offsets[0] = 0;
+    dst.resize(src.num_rows, src.num_cols, num_entries);
 
     // copy nonzero entries to CSR structure
-    for(size_t i = 0; i < src.num_rows; i++)
+#ifdef _OPENMP
+    #pragma omp parallel for if (parallel)
+#endif
+    for(long i = 0; i < num_rows; i++)
     {
+        IndexType jj = dst.row_offsets[i];
+
         for(size_t n = 0; n < num_diagonals; n++)
         {
             const IndexType j = i + src.diagonal_offsets[n];
@@ -329,14 +799,12 @@ void dia_to_csr(const Matrix1& src, Matrix2& dst)
 
                 if (value != ValueType(0))
                 {
-                    dst.column_indices[num_entries] = j;
-                    dst.values[num_entries] = value;
-                    num_entries++;
+                    dst.column_indices[jj] = j;
+                    dst.values[jj] = value;
+                    jj++;
                 }
             }
         }
-
-        dst.row_offsets[i + 1] = num_entries;
     }
 }
 
@@ -384,15 +852,39 @@ void ell_to_csr(const Matrix1& src, Matrix2& dst)
     
     const IndexType invalid_index = cusp::ell_matrix<IndexType, ValueType, cusp::host_memory>::invalid_index;
 
-    dst.resize(src.num_rows, src.num_cols, src.num_entries);
+    const size_t num_entries_per_row = src.column_indices.num_cols;
+    const long   num_rows            = src.num_rows;
+    const bool   parallel            = is_parallel_work(src.num_rows * num_entries_per_row);
 
-    size_t num_entries = 0;
-    dst.row_offsets[0] = 0;
+    // the row offsets are kept by the second resize
+    dst.resize(src.num_rows, src.num_cols, 0);
 
-    const size_t num_entries_per_row = src.column_indices.num_cols;
+    // count the valid entries of each row
+#ifdef _OPENMP
+    #pragma omp parallel for if (parallel)
+#endif
+    for(long i = 0; i < num_rows; i++)
+    {
+        IndexType num_entries = 0;
 
-    for(size_t i = 0; i < src.num_rows; i++)
+        for(size_t n = 0; n < num_entries_per_row; n++)
+            if(src.column_indices(i,n) != invalid_index)
+                num_entries++;
+
+        dst.row_offsets[i] = num_entries;
+    }
+
+    const size_t num_entries = counts_to_offsets(dst.row_offsets, src.num_rows);
+
+    dst.resize(src.num_rows, src.num_cols, num_entries);
+
+#ifdef _OPENMP
+    #pragma omp parallel for if (parallel)
+#endif
+    for(long i = 0; i < num_rows; i++)
     {
+        IndexType jj = dst.row_offsets[i];
+
         for(size_t n = 0; n < num_entries_per_row; n++)
         {
             const IndexType j = src.column_indices(i,n);
@@ -400,13 +892,11 @@ void ell_to_csr(const Matrix1& src, Matrix2& dst)
 
             if(j != invalid_index)
             {
-                dst.column_indices[num_entries] = j;
-                dst.values[num_entries]         = v;
-                num_entries++;
+                dst.column_indices[jj] = j;
+                dst.values[jj]         = v;
+                jj++;
             }
         }
-
-        dst.row_offsets[i + 1] = num_entries;
     }
 }
 
@@ -507,6 +997,328 @@ void hyb_to_csr(const Matrix1& src, Matrix2& dst)
 }
 
 
+/////////////////////
+// BSR Conversions //
+/////////////////////
+
+template <typename Matrix1, typename Matrix2>
+void bsr_to_csr(const Matrix1& src, Matrix2& dst)
+{
+    typedef typename Matrix2::index_type IndexType;
+
+    const size_t block_size    = src.block_size;
+    const size_t block_entries = block_size * block_size;
+
+    // every value of a stored block becomes an entry, including zeros
+    dst.resize(src.num_rows, src.num_cols, src.num_entries);
+
+    IndexType nnz = 0;
+    dst.row_offsets[0] = 0;
+
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        const size_t bi = i / block_size;
+        const size_t r  = i % block_size;
+
+        for(IndexType kk = src.row_offsets[bi]; kk < src.row_offsets[bi+1]; kk++)
+        {
+            for(size_t c = 0; c < block_size; c++)
+            {
+                dst.column_indices[nnz] = src.column_indices[kk] * block_size + c;
+                dst.values[nnz]         = src.values[kk * block_entries + r * block_size + c];
+                nnz++;
+            }
+        }
+
+        dst.row_offsets[i + 1] = nnz;
+    }
+}
+
+//////////////////////
+// SELL Conversions //
+//////////////////////
+
+template <typename Matrix1, typename Matrix2>
+void sell_to_csr(const Matrix1& src, Matrix2& dst)
+{
+    typedef typename Matrix2::index_type IndexType;
+
+    const IndexType invalid_index = Matrix1::invalid_index;
+    const size_t    slice_size    = src.slice_size;
+
+    dst.resize(src.num_rows, src.num_cols, src.num_entries);
+
+    // compute number of non-zero entries per row
+    thrust::fill(dst.row_offsets.begin(), dst.row_offsets.end(), IndexType(0));
+
+    for(size_t k = 0; k < src.num_rows; k++)
+    {
+        const IndexType s      = k / slice_size;
+        const IndexType width  = (src.slice_offsets[s + 1] - src.slice_offsets[s]) / slice_size;
+        const IndexType offset = src.slice_offsets[s] + k % slice_size;
+
+        for(IndexType n = 0; n < width; n++)
+            if (src.column_indices[offset + n * slice_size] != invalid_index)
+                dst.row_offsets[src.row_permutation[k]]++;
+    }
+
+    // cumsum the num_entries per row to get dst.row_offsets[]
+    IndexType cumsum = 0;
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        IndexType temp = dst.row_offsets[i];
+        dst.row_offsets[i] = cumsum;
+        cumsum += temp;
+    }
+    dst.row_offsets[src.num_rows] = cumsum;
+
+    // write the entries of each row in order
+    for(size_t k = 0; k < src.num_rows; k++)
+    {
+        const IndexType s      = k / slice_size;
+        const IndexType width  = (src.slice_offsets[s + 1] - src.slice_offsets[s]) / slice_size;
+        const IndexType offset = src.slice_offsets[s] + k % slice_size;
+
+        IndexType dest = dst.row_offsets[src.row_permutation[k]];
+
+        for(IndexType n = 0; n < width; n++)
+        {
+            const IndexType j = src.column_indices[offset + n * slice_size];
+
+            if (j != invalid_index)
+            {
+                dst.column_indices[dest] = j;
+                dst.values[dest]         = src.values[offset + n * slice_size];
+                dest++;
+            }
+        }
+    }
+}
+
+/////////////////////
+// JDS Conversions //
+/////////////////////
+
+template <typename Matrix1, typename Matrix2>
+void jds_to_csr(const Matrix1& src, Matrix2& dst)
+{
+    typedef typename Matrix2::index_type IndexType;
+
+    const size_t num_diagonals = src.diagonal_offsets.size() - 1;
+
+    dst.resize(src.num_rows, src.num_cols, src.num_entries);
+
+    // the row at position k has an entry in each diagonal wider than k
+    for(size_t k = 0; k < src.num_rows; k++)
+    {
+        IndexType length = 0;
+        while (size_t(length) < num_diagonals && src.diagonal_offsets[length] + IndexType(k) < src.diagonal_offsets[length + 1])
+            length++;
+
+        dst.row_offsets[src.row_permutation[k]] = length;
+    }
+
+    // cumsum the num_entries per row to get dst.row_offsets[]
+    IndexType cumsum = 0;
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        IndexType temp = dst.row_offsets[i];
+        dst.row_offsets[i] = cumsum;
+        cumsum += temp;
+    }
+    dst.row_offsets[src.num_rows] = cumsum;
+
+    // write the entries of each row in order
+    for(size_t k = 0; k < src.num_rows; k++)
+    {
+        const IndexType i = src.row_permutation[k];
+
+        IndexType dest = dst.row_offsets[i];
+
+        for(IndexType n = 0; dest < dst.row_offsets[i + 1]; n++, dest++)
+        {
+            dst.column_indices[dest] = src.column_indices[src.diagonal_offsets[n] + k];
+            dst.values[dest]         = src.values[src.diagonal_offsets[n] + k];
+        }
+    }
+}
+
+///////////////////////
+// CSR16 Conversions //
+///////////////////////
+
+template <typename Matrix1, typename Matrix2>
+void csr16_to_csr(const Matrix1& src, Matrix2& dst)
+{
+    typedef typename Matrix2::index_type IndexType;
+
+    dst.resize(src.num_rows, src.num_cols, src.num_entries);
+
+    IndexType nnz = 0;
+    size_t    n   = 0;
+
+    dst.row_offsets[0] = 0;
+
+    // append the overflow entries of each row to its compressed entries
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+        {
+            dst.column_indices[nnz] = src.row_bases[i] + IndexType(src.column_offsets[jj]);
+            dst.values[nnz]         = src.values[jj];
+            nnz++;
+        }
+
+        for(; n < src.overflow.num_entries && size_t(src.overflow.row_indices[n]) == i; n++)
+        {
+            dst.column_indices[nnz] = src.overflow.column_indices[n];
+            dst.values[nnz]         = src.overflow.values[n];
+            nnz++;
+        }
+
+        dst.row_offsets[i + 1] = nnz;
+    }
+}
+
+/////////////////////////
+// DIA/COO Conversions //
+/////////////////////////
+
+template <typename Matrix1, typename Matrix2>
+void dia_coo_to_csr(const Matrix1& src, Matrix2& dst)
+{
+    typedef typename Matrix2::index_type IndexType;
+    typedef typename Matrix2::value_type ValueType;
+
+    const size_t num_diagonals = src.dia.diagonal_offsets.size();
+
+    // count nonzero DIA entries, padding is not distinguishable from zeros
+    size_t num_entries = src.coo.num_entries;
+
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        for(size_t n = 0; n < num_diagonals; n++)
+        {
+            const IndexType j = i + src.dia.diagonal_offsets[n];
+
+            if(j >= 0 && static_cast<size_t>(j) < src.num_cols && src.dia.values(i,n) != ValueType(0))
+                num_entries++;
+        }
+    }
+
+    dst.resize(src.num_rows, src.num_cols, num_entries);
+
+    num_entries = 0;
+    dst.row_offsets[0] = 0;
+
+    size_t m = 0;
+
+    // merge the DIA and COO entries of each row by column
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        size_t n = 0;
+
+        while(true)
+        {
+            // next nonzero DIA entry of the row
+            while(n < num_diagonals)
+            {
+                const IndexType j = i + src.dia.diagonal_offsets[n];
+
+                if(j >= 0 && static_cast<size_t>(j) < src.num_cols && src.dia.values(i,n) != ValueType(0))
+                    break;
+                n++;
+            }
+
+            const bool dia_entry = n < num_diagonals;
+            const bool coo_entry = m < src.coo.num_entries && size_t(src.coo.row_indices[m]) == i;
+
+            if(!dia_entry && !coo_entry)
+                break;
+
+            if(dia_entry && (!coo_entry || IndexType(i + src.dia.diagonal_offsets[n]) <= src.coo.column_indices[m]))
+            {
+                dst.column_indices[num_entries] = i + src.dia.diagonal_offsets[n];
+                dst.values[num_entries]         = src.dia.values(i,n);
+                n++;
+            }
+            else
+            {
+                dst.column_indices[num_entries] = src.coo.column_indices[m];
+                dst.values[num_entries]         = src.coo.values[m];
+                m++;
+            }
+
+            num_entries++;
+        }
+
+        dst.row_offsets[i + 1] = num_entries;
+    }
+}
+
+///////////////////////////////
+// Symmetric CSR Conversions //
+///////////////////////////////
+
+template <typename Matrix1, typename Matrix2>
+void symmetric_csr_to_csr(const Matrix1& src, Matrix2& dst)
+{
+    typedef typename Matrix2::index_type IndexType;
+
+    // count the strictly lower entries of each row, i.e. the mirrored
+    // strictly upper entries of each column
+    cusp::array1d<IndexType,cusp::host_memory> lower(src.num_rows, 0);
+
+    size_t num_entries = src.num_stored_entries();
+
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+        {
+            const size_t j = src.column_indices[jj];
+
+            if (j != i)
+            {
+                lower[j]++;
+                num_entries++;
+            }
+        }
+    }
+
+    dst.resize(src.num_rows, src.num_cols, num_entries);
+
+    dst.row_offsets[0] = 0;
+
+    for(size_t i = 0; i < src.num_rows; i++)
+        dst.row_offsets[i + 1] = dst.row_offsets[i] + lower[i] + (src.row_offsets[i+1] - src.row_offsets[i]);
+
+    // the mirrored entries of a row precede its stored entries and are
+    // appended in increasing column order
+    for(size_t i = 0; i < src.num_rows; i++)
+        lower[i] = dst.row_offsets[i];
+
+    for(size_t i = 0; i < src.num_rows; i++)
+    {
+        IndexType nnz = dst.row_offsets[i + 1] - (src.row_offsets[i+1] - src.row_offsets[i]);
+
+        for(IndexType jj = src.row_offsets[i]; jj < src.row_offsets[i+1]; jj++)
+        {
+            const IndexType j = src.column_indices[jj];
+
+            dst.column_indices[nnz] = j;
+            dst.values[nnz]         = src.values[jj];
+            nnz++;
+
+            if (size_t(j) != i)
+            {
+                dst.column_indices[lower[j]] = i;
+                dst.values[lower[j]]         = src.values[jj];
+                lower[j]++;
+            }
+        }
+    }
+}
+
 /////////////////////////
 // Array1d Conversions //
 /////////////////////////
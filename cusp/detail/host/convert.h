@@ -44,10 +44,18 @@ namespace host
 //     <- DIA
 //     <- ELL
 //     <- HYB
+//     <- BSR
+//     <- SELL
+//     <- JDS
+//     <- CSR16
 //     <- Array
 // DIA <- CSR
 // ELL <- CSR
 // HYB <- CSR
+// BSR <- CSR
+// SELL <- CSR
+// JDS <- CSR
+// CSR16 <- CSR
 // Array1d <- Array2d (under restrictions)
 // Array2d <- COO
 //         <- CSR
@@ -114,6 +122,42 @@ void convert(const Matrix1& src, Matrix2& dst,
              cusp::csr_format)
 {    cusp::detail::host::hyb_to_csr(src, dst);    }
 
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::bsr_format,
+             cusp::csr_format)
+{    cusp::detail::host::bsr_to_csr(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::sell_format,
+             cusp::csr_format)
+{    cusp::detail::host::sell_to_csr(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::jds_format,
+             cusp::csr_format)
+{    cusp::detail::host::jds_to_csr(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::csr16_format,
+             cusp::csr_format)
+{    cusp::detail::host::csr16_to_csr(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::dia_coo_format,
+             cusp::csr_format)
+{    cusp::detail::host::dia_coo_to_csr(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::symmetric_csr_format,
+             cusp::csr_format)
+{    cusp::detail::host::symmetric_csr_to_csr(src, dst);    }
+
 /////////
 // DIA //
 /////////
@@ -208,6 +252,133 @@ void convert(const Matrix1& src, Matrix2& dst,
     cusp::convert(csr, dst);
 }
 
+/////////
+// BSR //
+/////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::csr_format,
+             cusp::bsr_format)
+{    cusp::detail::host::csr_to_bsr(src, dst, dst.block_size);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::sparse_format,
+             cusp::bsr_format)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix1::value_type ValueType;
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> csr;
+    cusp::convert(src, csr);
+    cusp::convert(csr, dst);
+}
+
+//////////
+// SELL //
+//////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::csr_format,
+             cusp::sell_format)
+{    cusp::detail::host::csr_to_sell(src, dst, dst.slice_size, dst.sorting_window);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::sparse_format,
+             cusp::sell_format)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix1::value_type ValueType;
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> csr;
+    cusp::convert(src, csr);
+    cusp::convert(csr, dst);
+}
+
+/////////
+// JDS //
+/////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::csr_format,
+             cusp::jds_format)
+{    cusp::detail::host::csr_to_jds(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::sparse_format,
+             cusp::jds_format)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix1::value_type ValueType;
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> csr;
+    cusp::convert(src, csr);
+    cusp::convert(csr, dst);
+}
+
+///////////
+// CSR16 //
+///////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::csr_format,
+             cusp::csr16_format)
+{    cusp::detail::host::csr_to_csr16(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::sparse_format,
+             cusp::csr16_format)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix1::value_type ValueType;
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> csr;
+    cusp::convert(src, csr);
+    cusp::convert(csr, dst);
+}
+
+/////////////
+// DIA/COO //
+/////////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::csr_format,
+             cusp::dia_coo_format,
+             const size_t alignment = 32)
+{    cusp::detail::host::csr_to_dia_coo(src, dst, alignment);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::sparse_format,
+             cusp::dia_coo_format)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix1::value_type ValueType;
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> csr;
+    cusp::convert(src, csr);
+    cusp::convert(csr, dst);
+}
+
+///////////////////
+// Symmetric CSR //
+///////////////////
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::csr_format,
+             cusp::symmetric_csr_format)
+{    cusp::detail::host::csr_to_symmetric_csr(src, dst);    }
+
+template <typename Matrix1, typename Matrix2>
+void convert(const Matrix1& src, Matrix2& dst,
+             cusp::sparse_format,
+             cusp::symmetric_csr_format)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix1::value_type ValueType;
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> csr;
+    cusp::convert(src, csr);
+    cusp::convert(csr, dst);
+}
+
 /////////////
 // Array1d //
 /////////////
@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/host/parallel.h>
+
+#include <algorithm>
+#include <cstddef>
+
+// Cache-blocked transposition of a pitched dense array: row i of the
+// num_major x num_minor source, src[i * src_pitch + j], becomes column i
+// of the destination, dst[j * dst_pitch + i].  The array is traversed in
+// HOST_TRANSPOSE_TILE x HOST_TRANSPOSE_TILE tiles, whose rows of the
+// source and of the destination both stay in the cache while the tile
+// is copied.
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+const size_t HOST_TRANSPOSE_TILE = 32;
+
+template <typename ValueType1, typename ValueType2>
+void transpose_dense(const size_t num_major, const size_t num_minor,
+                     const ValueType1 * src, const size_t src_pitch,
+                           ValueType2 * dst, const size_t dst_pitch)
+{
+    const long num_tiles = long((num_major + HOST_TRANSPOSE_TILE - 1) / HOST_TRANSPOSE_TILE);
+
+#ifdef _OPENMP
+    #pragma omp parallel for if (is_parallel_work(num_major * num_minor))
+#endif
+    for(long t = 0; t < num_tiles; t++)
+    {
+        const size_t major_begin = t * HOST_TRANSPOSE_TILE;
+        const size_t major_end   = std::min(major_begin + HOST_TRANSPOSE_TILE, num_major);
+
+        for(size_t minor_begin = 0; minor_begin < num_minor; minor_begin += HOST_TRANSPOSE_TILE)
+        {
+            const size_t minor_end = std::min(minor_begin + HOST_TRANSPOSE_TILE, num_minor);
+
+            for(size_t i = major_begin; i < major_end; i++)
+                for(size_t j = minor_begin; j < minor_end; j++)
+                    dst[j * dst_pitch + i] = ValueType2(src[i * src_pitch + j]);
+        }
+    }
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
+
@@ -51,7 +51,8 @@ void spmm_coo(const Matrix1& A,
     IndexType estimated_nonzeros = 
         spmm_csr_pass1(A.num_rows, B.num_cols,
                        A_row_offsets, A.column_indices,
-                       B_row_offsets, B.column_indices);
+                       B_row_offsets, B.column_indices,
+                       C_row_offsets);
                          
     // Resize output
     C.resize(A.num_rows, B.num_cols, estimated_nonzeros);
@@ -18,6 +18,8 @@
 
 #include <cusp/array1d.h>
 
+#include <cusp/detail/host/parallel.h>
+
 namespace cusp
 {
 namespace detail
@@ -109,40 +111,60 @@ void csr_transform_elementwise(const Matrix1& A,
 } // csr_transform_elementwise
 
 
+// Row-parallel Gustavson product.  The first pass bounds the number of
+// entries of each row of C (including explicit zeros) and stores the
+// bounds as offsets in C_row_offsets.  The second pass computes every row
+// into its bounded range and then packs the rows when explicit zeros were
+// dropped.  Each thread keeps its own dense accumulators of one row.
 template <typename Array1, typename Array2,
-          typename Array3, typename Array4>
+          typename Array3, typename Array4,
+          typename Array5>
 size_t spmm_csr_pass1(const size_t num_rows, const size_t num_cols,
                          const Array1& A_row_offsets, const Array2& A_column_indices,
-                         const Array3& B_row_offsets, const Array4& B_column_indices)
+                         const Array3& B_row_offsets, const Array4& B_column_indices,
+                               Array5& C_row_offsets)
 {
     typedef typename Array1::value_type IndexType1;
     typedef typename Array2::value_type IndexType2;
-    
-    cusp::array1d<size_t, cusp::host_memory> mask(num_cols, static_cast<size_t>(-1));
+    typedef typename Array5::value_type IndexType;
 
-    // Compute nnz in C (including explicit zeros)
-    size_t num_nonzeros = 0;
+    const long num_rows_ = num_rows;
 
-    for(size_t i = 0; i < num_rows; i++)
+#ifdef _OPENMP
+    #pragma omp parallel if (is_parallel_work(A_column_indices.size()))
+#endif
     {
-        for(IndexType1 jj = A_row_offsets[i]; jj < A_row_offsets[i+1]; jj++)
+        cusp::array1d<size_t, cusp::host_memory> mask(num_cols, static_cast<size_t>(-1));
+
+        // Compute nnz in each row of C (including explicit zeros)
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, HOST_ROW_BLOCK_SIZE)
+#endif
+        for(long i = 0; i < num_rows_; i++)
         {
-            IndexType1 j = A_column_indices[jj];
+            IndexType num_nonzeros = 0;
 
-            for(IndexType2 kk = B_row_offsets[j]; kk < B_row_offsets[j+1]; kk++)
+            for(IndexType1 jj = A_row_offsets[i]; jj < A_row_offsets[i+1]; jj++)
             {
-                IndexType2 k = B_column_indices[kk];
+                IndexType1 j = A_column_indices[jj];
 
-                if(mask[k] != i)
+                for(IndexType2 kk = B_row_offsets[j]; kk < B_row_offsets[j+1]; kk++)
                 {
-                    mask[k] = i;                        
-                    num_nonzeros++;
+                    IndexType2 k = B_column_indices[kk];
+
+                    if(mask[k] != size_t(i))
+                    {
+                        mask[k] = i;
+                        num_nonzeros++;
+                    }
                 }
             }
+
+            C_row_offsets[i] = num_nonzeros;
         }
     }
 
-    return num_nonzeros;
+    return counts_to_offsets(C_row_offsets, num_rows);
 }
 
 template <typename Array1, typename Array2, typename Array3,
@@ -156,69 +178,96 @@ size_t spmm_csr_pass2(const size_t num_rows, const size_t num_cols,
     typedef typename Array7::value_type IndexType;
     typedef typename Array9::value_type ValueType;
 
-    size_t num_nonzeros = 0;
-
     const IndexType unseen = static_cast<IndexType>(-1);
     const IndexType init   = static_cast<IndexType>(-2);  
 
-    // Compute entries of C
-    cusp::array1d<IndexType,cusp::host_memory> next(num_cols, unseen);
-    cusp::array1d<ValueType,cusp::host_memory> sums(num_cols, ValueType(0));
-    
-    num_nonzeros = 0;
-    
-    C_row_offsets[0] = 0;
-    
-    for(size_t i = 0; i < num_rows; i++)
+    // number of entries of each row of C without explicit zeros
+    cusp::array1d<IndexType,cusp::host_memory> row_nonzeros(num_rows + 1, IndexType(0));
+
+    const long num_rows_ = num_rows;
+
+#ifdef _OPENMP
+    #pragma omp parallel if (is_parallel_work(A_column_indices.size()))
+#endif
     {
-        IndexType head   = init;
-        IndexType length =    0;
-    
-        IndexType jj_start = A_row_offsets[i];
-        IndexType jj_end   = A_row_offsets[i+1];
+        // Compute entries of C
+        cusp::array1d<IndexType,cusp::host_memory> next(num_cols, unseen);
+        cusp::array1d<ValueType,cusp::host_memory> sums(num_cols, ValueType(0));
 
-        for(IndexType jj = jj_start; jj < jj_end; jj++)
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, HOST_ROW_BLOCK_SIZE)
+#endif
+        for(long i = 0; i < num_rows_; i++)
         {
-            IndexType j = A_column_indices[jj];
-            ValueType v = A_values[jj];
-    
-            IndexType kk_start = B_row_offsets[j];
-            IndexType kk_end   = B_row_offsets[j+1];
+            IndexType head   = init;
+            IndexType length =    0;
+
+            IndexType jj_start = A_row_offsets[i];
+            IndexType jj_end   = A_row_offsets[i+1];
 
-            for(IndexType kk = kk_start; kk < kk_end; kk++)
+            for(IndexType jj = jj_start; jj < jj_end; jj++)
             {
-                IndexType k = B_column_indices[kk];
-    
-                sums[k] += v * B_values[kk];
-    
-                if(next[k] == unseen)
+                IndexType j = A_column_indices[jj];
+                ValueType v = A_values[jj];
+
+                IndexType kk_start = B_row_offsets[j];
+                IndexType kk_end   = B_row_offsets[j+1];
+
+                for(IndexType kk = kk_start; kk < kk_end; kk++)
                 {
-                    next[k] = head;                        
-                    head  = k;
-                    length++;
+                    IndexType k = B_column_indices[kk];
+
+                    sums[k] += v * B_values[kk];
+
+                    if(next[k] == unseen)
+                    {
+                        next[k] = head;                        
+                        head  = k;
+                        length++;
+                    }
                 }
             }
+
+            IndexType num_nonzeros = C_row_offsets[i];
+
+            for(IndexType jj = 0; jj < length; jj++)
+            {
+                if(sums[head] != ValueType(0))
+                {
+                    C_column_indices[num_nonzeros] = head;
+                    C_values[num_nonzeros]         = sums[head];
+                    num_nonzeros++;
+                }
+
+                IndexType temp = head; head = next[head];
+
+                // clear arrays
+                next[temp] = unseen; 
+                sums[temp] = ValueType(0);                              
+            }
+
+            row_nonzeros[i] = num_nonzeros - C_row_offsets[i];
         }
-    
-        for(IndexType jj = 0; jj < length; jj++)
+    }
+
+    const IndexType num_nonzeros = counts_to_offsets(row_nonzeros, num_rows);
+
+    // pack the rows, which only move towards the front
+    if(num_nonzeros != C_row_offsets[num_rows])
+    {
+        for(size_t i = 0; i < num_rows; i++)
         {
-            if(sums[head] != ValueType(0))
+            for(IndexType n = 0; n < row_nonzeros[i + 1] - row_nonzeros[i]; n++)
             {
-                C_column_indices[num_nonzeros] = head;
-                C_values[num_nonzeros]         = sums[head];
-                num_nonzeros++;
+                C_column_indices[row_nonzeros[i] + n] = C_column_indices[C_row_offsets[i] + n];
+                C_values[row_nonzeros[i] + n]         = C_values[C_row_offsets[i] + n];
             }
-    
-            IndexType temp = head; head = next[head];
-    
-            // clear arrays
-            next[temp] = unseen; 
-            sums[temp] = ValueType(0);                              
         }
-    
-        C_row_offsets[i+1] = num_nonzeros;
     }
-    
+
+    for(size_t i = 0; i <= num_rows; i++)
+        C_row_offsets[i] = row_nonzeros[i];
+
     // XXX note: entries of C are unsorted within each row
 
     return num_nonzeros;
@@ -233,12 +282,15 @@ void spmm_csr(const Matrix1& A,
 {
     typedef typename Matrix3::index_type IndexType;
 
+    C.resize(A.num_rows, B.num_cols, 0);
+
     IndexType num_nonzeros = 
         spmm_csr_pass1(A.num_rows, B.num_cols,
                        A.row_offsets, A.column_indices,
-                       B.row_offsets, B.column_indices);
+                       B.row_offsets, B.column_indices,
+                       C.row_offsets);
                          
-    // Resize output
+    // Resize output, which keeps the row offsets of pass1
     C.resize(A.num_rows, B.num_cols, num_nonzeros);
     
     num_nonzeros =
@@ -251,6 +303,64 @@ void spmm_csr(const Matrix1& A,
     C.resize(A.num_rows, B.num_cols, num_nonzeros);
 }
 
+// Recompute the values of C = A * B for a fixed structure of C.  Products
+// which do not fall on an entry of C are ignored.
+template <typename Matrix1,
+          typename Matrix2,
+          typename Array1,
+          typename Array2,
+          typename Array3>
+void spmm_csr_numeric(const Matrix1& A,
+                      const Matrix2& B,
+                      const Array1&  C_row_offsets,
+                      const Array2&  C_column_indices,
+                            Array3&  C_values)
+{
+    typedef typename Array1::value_type IndexType;
+    typedef typename Array3::value_type ValueType;
+
+    const IndexType unseen = static_cast<IndexType>(-1);
+
+    const long num_rows = A.num_rows;
+
+#ifdef _OPENMP
+    #pragma omp parallel if (is_parallel_work(A.num_entries))
+#endif
+    {
+        // position of each column of the current row in C
+        cusp::array1d<IndexType,cusp::host_memory> position(B.num_cols, unseen);
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, HOST_ROW_BLOCK_SIZE)
+#endif
+        for(long i = 0; i < num_rows; i++)
+        {
+            for(IndexType kk = C_row_offsets[i]; kk < C_row_offsets[i+1]; kk++)
+            {
+                position[C_column_indices[kk]] = kk;
+                C_values[kk] = ValueType(0);
+            }
+
+            for(IndexType jj = A.row_offsets[i]; jj < A.row_offsets[i+1]; jj++)
+            {
+                IndexType j = A.column_indices[jj];
+                ValueType v = A.values[jj];
+
+                for(IndexType kk = B.row_offsets[j]; kk < B.row_offsets[j+1]; kk++)
+                {
+                    IndexType k = position[B.column_indices[kk]];
+
+                    if (k != unseen)
+                        C_values[k] += v * B.values[kk];
+                }
+            }
+
+            for(IndexType kk = C_row_offsets[i]; kk < C_row_offsets[i+1]; kk++)
+                position[C_column_indices[kk]] = unseen;
+        }
+    }
+}
+
 } // end namespace detail
 } // end namespace host
 } // end namespace detail
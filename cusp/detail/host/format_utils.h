@@ -0,0 +1,124 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/detail/host/parallel.h>
+
+#include <algorithm>
+
+// Multithreaded conversion between the compressed row offsets and the
+// uncompressed row indices, see device/format_utils.h.  The positions of
+// the indices are partitioned among the threads for indices_to_offsets
+// and the merge path of the offsets is split into HOST_OFFSETS_CHUNK
+// items for offsets_to_indices, so that long rows do not serialize.
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+const size_t HOST_OFFSETS_CHUNK = 4096;
+
+template <typename OffsetType>
+void offsets_merge_path_search(const size_t diagonal,
+                               const size_t num_rows,
+                               const size_t num_entries,
+                               const OffsetType * row_end_offsets,
+                                     size_t& row,
+                                     size_t& nz)
+{
+    size_t lo = diagonal > num_entries ? diagonal - num_entries : 0;
+    size_t hi = std::min(diagonal, num_rows);
+
+    while (lo < hi)
+    {
+        const size_t mid = (lo + hi) >> 1;
+
+        if (size_t(row_end_offsets[mid]) + mid + 1 <= diagonal)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    row = lo;
+    nz  = diagonal - lo;
+}
+
+// offsets[r] <- the first position k of the sorted indices with
+// indices[k] >= r, for r in [0, num_rows]
+template <typename IndexType, typename OffsetType>
+void indices_to_offsets(const size_t num_entries, const size_t num_rows,
+                        const IndexType * indices, OffsetType * offsets)
+{
+#ifdef _OPENMP
+#pragma omp parallel for if (is_parallel_work(num_entries + num_rows))
+#endif
+    for(long k = 0; k <= long(num_entries); k++)
+    {
+        const size_t first = k == 0                 ? 0        : std::min<size_t>(indices[k - 1], num_rows) + 1;
+        const size_t last  = k == long(num_entries) ? num_rows : std::min<size_t>(indices[k],     num_rows);
+
+        for(size_t r = first; r <= last; r++)
+            offsets[r] = OffsetType(k);
+    }
+}
+
+// indices[k] <- the row r of the num_rows offsets with
+// offsets[r] <= k < offsets[r + 1], for k in [0, num_entries)
+template <typename OffsetType, typename IndexType>
+void offsets_to_indices(const size_t num_rows, const size_t num_entries,
+                        const OffsetType * offsets, IndexType * indices)
+{
+    if (num_rows == 0 || num_entries == 0)
+        return;
+
+    const OffsetType * row_end_offsets = offsets + 1;
+    const size_t num_items  = num_rows + num_entries;
+    const long   num_chunks = long((num_items + HOST_OFFSETS_CHUNK - 1) / HOST_OFFSETS_CHUNK);
+
+#ifdef _OPENMP
+#pragma omp parallel for if (is_parallel_work(num_items))
+#endif
+    for(long c = 0; c < num_chunks; c++)
+    {
+        const size_t diagonal     = size_t(c) * HOST_OFFSETS_CHUNK;
+        const size_t diagonal_end = std::min(diagonal + HOST_OFFSETS_CHUNK, num_items);
+
+        size_t row, nz, row_end, nz_end;
+        offsets_merge_path_search(diagonal,     num_rows, num_entries, row_end_offsets, row,     nz);
+        offsets_merge_path_search(diagonal_end, num_rows, num_entries, row_end_offsets, row_end, nz_end);
+
+        for(; row < row_end; row++)
+        {
+            const size_t row_stop = std::min<size_t>(row_end_offsets[row], num_entries);
+
+            for(; nz < row_stop; nz++)
+                indices[nz] = IndexType(row);
+        }
+
+        for(; nz < nz_end; nz++)
+            indices[nz] = IndexType(std::min(row, num_rows - 1));
+    }
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
+
@@ -20,12 +20,23 @@
 #include <cusp/csr_matrix.h>
 
 #include <cusp/detail/functional.h>
+#include <cusp/detail/implicit_copy.h>
+#include <cusp/detail/storage_cast.h>
+#include <cusp/detail/spmspv.h>
+#include <cusp/detail/host/parallel.h>
+
+#include <thrust/fill.h>
 
-#ifdef INTEL_MKL_SPBLAS
-#include <cusp/detail/host/spmv_mkl.h>
-#else
 #include <cusp/detail/host/spmv.h>
-#endif
+#include <cusp/detail/host/spmv_batched_csr.h>
+#include <cusp/detail/host/spmv_bsr.h>
+#include <cusp/detail/host/spmv_sell.h>
+#include <cusp/detail/host/spmv_jds.h>
+#include <cusp/detail/host/spmv_csr16.h>
+#include <cusp/detail/host/spmv_split_complex.h>
+#include <cusp/detail/host/spmv_symmetric_csr.h>
+#include <cusp/detail/host/spmv_transpose.h>
+#include <cusp/detail/host/vendor_blas.h>
 
 #include <cusp/detail/host/detail/coo.h>
 #include <cusp/detail/host/detail/csr.h>
@@ -52,7 +63,15 @@ void multiply(const Matrix&  A,
 {
     typedef typename Vector2::value_type ValueType;
 
-    for(size_t i = 0; i < A.num_rows; i++)
+    if (cusp::detail::host::vendor::gemv(A, B, C))
+        return;
+
+    const long num_rows = A.num_rows;
+
+#ifdef _OPENMP
+    #pragma omp parallel for if (is_parallel_work(A.num_rows * A.num_cols))
+#endif
+    for(long i = 0; i < num_rows; i++)
     {
         ValueType sum = 0;
         for(size_t j = 0; j < A.num_cols; j++)
@@ -89,6 +108,9 @@ void multiply(const Matrix&  A,
               cusp::array1d_format,
               cusp::array1d_format)
 {
+    if (cusp::detail::host::vendor::csrmv(A, B, C))
+        return;
+
     cusp::detail::host::spmv_csr(A, B, C);
 }
 
@@ -131,24 +153,177 @@ void multiply(const Matrix&  A,
     typedef typename Vector2::value_type ValueType;
 
     cusp::detail::host::spmv_ell(A.ell, B, C);
-    cusp::detail::host::spmv_coo(A.coo, B, C, thrust::identity<ValueType>(), thrust::multiplies<ValueType>(), thrust::plus<ValueType>());
+    cusp::detail::host::spmv_coo(A.coo, B, C, thrust::identity<ValueType>(), cusp::detail::scalar_multiplies<ValueType>(), thrust::plus<ValueType>());
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::bsr_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+    cusp::detail::host::spmv_bsr(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::sell_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+    cusp::detail::host::spmv_sell(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::jds_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+    cusp::detail::host::spmv_jds(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::csr16_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+    cusp::detail::host::spmv_csr16(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::split_complex_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+    cusp::detail::host::spmv_split_complex(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::dia_coo_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    cusp::detail::host::spmv_dia(A.dia, B, C);
+    cusp::detail::host::spmv_coo(A.coo, B, C, thrust::identity<ValueType>(), cusp::detail::scalar_multiplies<ValueType>(), thrust::plus<ValueType>());
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::symmetric_csr_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+    cusp::detail::host::spmv_symmetric_csr(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::batched_csr_format,
+              cusp::array1d_format,
+              cusp::array1d_format)
+{
+    cusp::detail::host::spmv_batched_csr(A, B, C);
 }
 
 ////////////////////////////////////////
 // Sparse Matrix-BlockVector Multiply //
 ////////////////////////////////////////
-//// TODO implement this w/ repeated SpMVs and then specialize
-//template <typename Matrix,
-//          typename Vector1,
-//          typename Vector2>
-//void multiply(const Matrix&  A,
-//              const Vector1& B,
-//                    Vector2& C,
-//              cusp::detail::sparse_format,
-//              cusp::detail::array2d_format,
-//              cusp::detail::array2d_format)
-//{
-//}
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void multiply(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::csr_format,
+              cusp::array2d_format,
+              cusp::array2d_format)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Matrix3::value_type ValueType;
+
+    C.resize(A.num_rows, B.num_cols);
+
+    if (cusp::detail::host::vendor::csrmm(A, B, C))
+        return;
+
+    const long num_rows = A.num_rows;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, HOST_ROW_BLOCK_SIZE) if (is_parallel_work(A.num_entries * B.num_cols))
+#endif
+    for(long i = 0; i < num_rows; i++)
+    {
+        for(size_t k = 0; k < C.num_cols; k++)
+            C(i,k) = ValueType(0);
+
+        // apply each nonzero of the row to all columns of B
+        for(IndexType jj = A.row_offsets[i]; jj < A.row_offsets[i + 1]; jj++)
+        {
+            const IndexType j    = A.column_indices[jj];
+            const ValueType A_ij = A.values[jj];
+
+            for(size_t k = 0; k < C.num_cols; k++)
+                C(i,k) += A_ij * B(j,k);
+        }
+    }
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void multiply(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::sparse_format,
+              cusp::array2d_format,
+              cusp::array2d_format)
+{
+    // other formats use CSR
+    const cusp::detail::csr_operand<Matrix1,cusp::host_memory> A_(A);
+
+    cusp::detail::host::multiply(A_.get(), B, C,
+                                 cusp::csr_format(),
+                                 cusp::array2d_format(),
+                                 cusp::array2d_format());
+}
 
 ////////////////////////////////////////
 // Dense Matrix-Matrix Multiplication //
@@ -167,7 +342,15 @@ void multiply(const Matrix1&  A,
 
     C.resize(A.num_rows, B.num_cols);
 
-    for(size_t i = 0; i < C.num_rows; i++)
+    if (cusp::detail::host::vendor::gemm(A, B, C))
+        return;
+
+    const long num_rows = C.num_rows;
+
+#ifdef _OPENMP
+    #pragma omp parallel for if (is_parallel_work(A.num_rows * A.num_cols * B.num_cols))
+#endif
+    for(long i = 0; i < num_rows; i++)
     {
         for(size_t j = 0; j < C.num_cols; j++)
         {
@@ -210,6 +393,35 @@ void multiply(const Matrix1& A,
     cusp::detail::host::detail::spmm_csr(A,B,C);
 }
 
+// CSR * CSR into a CSR matrix, or into another format through a CSR temporary
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void spmm_csr_output(const Matrix1& A,
+                     const Matrix2& B,
+                           Matrix3& C,
+                     cusp::csr_format)
+{
+    cusp::detail::host::detail::spmm_csr(A,B,C);
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void spmm_csr_output(const Matrix1& A,
+                     const Matrix2& B,
+                           Matrix3& C,
+                     cusp::sparse_format)
+{
+    cusp::detail::check_implicit_copy("conversion from CSR");
+
+    cusp::csr_matrix<typename Matrix3::index_type,typename Matrix3::value_type,cusp::host_memory> C_;
+
+    cusp::detail::host::detail::spmm_csr(A,B,C_);
+
+    cusp::convert(C_, C);
+}
+
 template <typename Matrix1,
           typename Matrix2,
           typename Matrix3>
@@ -220,16 +432,290 @@ void multiply(const Matrix1& A,
               cusp::sparse_format,
               cusp::sparse_format)
 {
-    // other formats use CSR * CSR
-    cusp::csr_matrix<typename Matrix1::index_type,typename Matrix1::value_type,cusp::host_memory> A_(A);
-    cusp::csr_matrix<typename Matrix2::index_type,typename Matrix2::value_type,cusp::host_memory> B_(B);
-    cusp::csr_matrix<typename Matrix3::index_type,typename Matrix3::value_type,cusp::host_memory> C_;
-
-    cusp::detail::host::detail::spmm_csr(A_,B_,C_);
+    // other formats use CSR * CSR, CSR operands are used in place
+    const cusp::detail::csr_operand<Matrix1,cusp::host_memory> A_(A);
+    const cusp::detail::csr_operand<Matrix2,cusp::host_memory> B_(B);
 
-    cusp::convert(C_, C);
+    cusp::detail::host::spmm_csr_output(A_.get(), B_.get(), C, typename Matrix3::format());
 }
   
+//////////////////////////////////////////
+// Sparse Matrix-Sparse Vector Multiply //
+//////////////////////////////////////////
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::csr_format,
+              cusp::sparse_vector_format,
+              cusp::sparse_vector_format)
+{
+    cusp::detail::spmspv(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply(const Matrix&  A,
+              const Vector1& B,
+                    Vector2& C,
+              cusp::sparse_format,
+              cusp::sparse_vector_format,
+              cusp::sparse_vector_format)
+{
+    // other formats use CSR
+    const cusp::detail::csr_operand<Matrix,cusp::host_memory> A_(A);
+
+    cusp::detail::spmspv(A_.get(), B, C);
+}
+
+///////////////////////////////////////
+// Transposed Matrix-Vector Multiply //
+///////////////////////////////////////
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::array2d_format)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    if (cusp::detail::host::vendor::gemv(A, B, C, true))
+        return;
+
+    for(size_t j = 0; j < A.num_cols; j++)
+    {
+        ValueType sum = 0;
+        for(size_t i = 0; i < A.num_rows; i++)
+        {
+            sum += A(i,j) * B[i];
+        }
+        C[j] = sum;
+    }
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::coo_format)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    thrust::fill(C.begin(), C.end(), ValueType(0));
+
+    cusp::detail::host::spmv_coo_transpose(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::csr_format)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    if (cusp::detail::host::vendor::csrmv(A, B, C, true))
+        return;
+
+    thrust::fill(C.begin(), C.end(), ValueType(0));
+
+    cusp::detail::host::spmv_csr_transpose(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::dia_format)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    thrust::fill(C.begin(), C.end(), ValueType(0));
+
+    cusp::detail::host::spmv_dia_transpose(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::ell_format)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    thrust::fill(C.begin(), C.end(), ValueType(0));
+
+    cusp::detail::host::spmv_ell_transpose(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::hyb_format)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    thrust::fill(C.begin(), C.end(), ValueType(0));
+
+    cusp::detail::host::spmv_ell_transpose(A.ell, B, C);
+    cusp::detail::host::spmv_coo_transpose(A.coo, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::sparse_format)
+{
+    // other formats use CSR
+    const cusp::detail::csr_operand<Matrix,cusp::host_memory> A_(A);
+
+    cusp::detail::host::multiply_transpose(A_.get(), B, C, cusp::csr_format());
+}
+
+//////////////////////////////////////////////////
+// Matrix-Vector Multiply with an AXPBY Epilogue //
+//////////////////////////////////////////////////
+//
+// y <- alpha * A x + beta * z, where z may alias y
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta,
+                    cusp::known_format)
+{
+    // other formats store the product and update y afterwards
+    typedef typename Vector3::value_type ValueType;
+
+    cusp::array1d<ValueType,cusp::host_memory> temp(A.num_rows);
+
+    cusp::detail::host::multiply(A, x, temp,
+                                 typename Matrix::format(),
+                                 typename Vector1::format(),
+                                 typename Vector3::format());
+
+    const long num_rows = A.num_rows;
+
+#ifdef _OPENMP
+    #pragma omp parallel for if (is_parallel_work(A.num_rows))
+#endif
+    for(long i = 0; i < num_rows; i++)
+    {
+        if (beta == ScalarType(0))
+            y[i] = ValueType(alpha) * temp[i];
+        else
+            y[i] = ValueType(alpha) * temp[i] + ValueType(beta) * z[i];
+    }
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta,
+                    cusp::csr_format)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Vector3::value_type ValueType;
+
+    if (cusp::detail::host::vendor::csrmv(A, x, z, y, alpha, beta))
+        return;
+
+    const long num_rows = A.num_rows;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, HOST_ROW_BLOCK_SIZE) if (is_parallel_work(A.num_entries))
+#endif
+    for(long i = 0; i < num_rows; i++)
+    {
+        const IndexType row_start = A.row_offsets[i];
+        const IndexType row_end   = A.row_offsets[i + 1];
+
+        ValueType sum = 0;
+
+        for (IndexType jj = row_start; jj < row_end; jj++)
+            sum += storage_cast<ValueType>(A.values[jj]) * x[A.column_indices[jj]];
+
+        if (beta == ScalarType(0))
+            y[i] = ValueType(alpha) * sum;
+        else
+            y[i] = ValueType(alpha) * sum + ValueType(beta) * z[i];
+    }
+}
+
+// a sparse vector times the columns of A, dense vectors dispatch on the
+// matrix format
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::csr_format,
+                        cusp::sparse_vector_format)
+{
+    cusp::detail::spmspv_transpose(A, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::sparse_format,
+                        cusp::sparse_vector_format)
+{
+    // other formats use CSR
+    const cusp::detail::csr_operand<Matrix,cusp::host_memory> A_(A);
+
+    cusp::detail::spmspv_transpose(A_.get(), B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Format>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        Format,
+                        cusp::array1d_format)
+{
+    cusp::detail::host::multiply_transpose(A, B, C, Format());
+}
+
 /////////////////
 // Entry Point //
 /////////////////
@@ -246,6 +732,34 @@ void multiply(const Matrix&  A,
                                typename MatrixOrVector2::format());
 }
 
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C)
+{
+  cusp::detail::host::multiply_transpose(A, B, C,
+                                         typename Matrix::format(),
+                                         typename Vector1::format());
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(const Matrix&  A,
+                    const Vector1& x,
+                    const Vector2& z,
+                          Vector3& y,
+                    ScalarType     alpha,
+                    ScalarType     beta)
+{
+  cusp::detail::host::multiply_axpby(A, x, z, y, alpha, beta,
+                                     typename Matrix::format());
+}
+
 } // end namespace host
 } // end namespace detail
 } // end namespace cusp
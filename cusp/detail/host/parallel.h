@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+
+// Multithreaded loops of the host backend.
+//
+// When cusp is compiled with OpenMP (the hostomp=1 or backend=omp build
+// options) the host_memory SpMV, SpGEMM and conversion loops partition
+// the rows of the matrix among the threads, otherwise they run serially.
+// Every row is processed by one thread in the serial order, so results do
+// not depend on the number of threads.  Loops over less work than
+// HOST_MIN_PARALLEL_WORK entries stay serial, where starting the threads
+// would cost more than the loop.  Formats that store their entries by
+// column (DIA, ELL) are traversed in blocks of HOST_ROW_BLOCK_SIZE rows so
+// that each thread streams through a contiguous part of every column.
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+const size_t HOST_MIN_PARALLEL_WORK = 1 << 15;
+const size_t HOST_ROW_BLOCK_SIZE    = 256;
+
+inline bool is_parallel_work(const size_t work)
+{
+#ifdef _OPENMP
+    return work >= HOST_MIN_PARALLEL_WORK;
+#else
+    return false;
+#endif
+}
+
+// number of blocks of HOST_ROW_BLOCK_SIZE rows
+inline long num_row_blocks(const size_t num_rows)
+{
+    return long((num_rows + HOST_ROW_BLOCK_SIZE - 1) / HOST_ROW_BLOCK_SIZE);
+}
+
+// replace counts[0,n) by their exclusive sum and store the total in counts[n]
+template <typename Array>
+typename Array::value_type counts_to_offsets(Array& counts, const size_t n)
+{
+    typedef typename Array::value_type IndexType;
+
+    IndexType sum = 0;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        IndexType count = counts[i];
+        counts[i] = sum;
+        sum += count;
+    }
+
+    counts[n] = sum;
+
+    return sum;
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
+
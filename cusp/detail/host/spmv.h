@@ -2,6 +2,14 @@
 
 #include <thrust/functional.h>
 #include <cusp/detail/functional.h>
+#include <cusp/detail/storage_cast.h>
+#include <cusp/detail/host/parallel.h>
+#include <cusp/detail/host/spmv_simd.h>
+
+#include <thrust/sort.h>
+#include <thrust/binary_search.h>
+
+#include <algorithm>
 
 namespace cusp
 {
@@ -28,6 +36,41 @@ void spmv_coo(const Matrix&  A,
 {
     typedef typename Matrix::index_type  IndexType;
     typedef typename Vector2::value_type ValueType;
+    typedef typename storage_operand<ValueType, typename Matrix::value_type>::type OperandType;
+
+    // blocks of rows own contiguous ranges of entries when the entries are
+    // sorted by row, as the device kernels require
+    if (is_parallel_work(A.num_entries) && thrust::is_sorted(A.row_indices.begin(), A.row_indices.end()))
+    {
+        const long num_blocks = num_row_blocks(A.num_rows);
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for(long b = 0; b < num_blocks; b++)
+        {
+            const IndexType row_start = b * HOST_ROW_BLOCK_SIZE;
+            const IndexType row_end   = std::min<size_t>(A.num_rows, (b + 1) * HOST_ROW_BLOCK_SIZE);
+
+            for(IndexType i = row_start; i < row_end; i++)
+                y[i] = initialize(y[i]);
+
+            const size_t n_start = thrust::lower_bound(A.row_indices.begin(), A.row_indices.end(), row_start) - A.row_indices.begin();
+            const size_t n_end   = thrust::lower_bound(A.row_indices.begin(), A.row_indices.end(), row_end)   - A.row_indices.begin();
+
+            for(size_t n = n_start; n < n_end; n++)
+            {
+                const IndexType& i   = A.row_indices[n];
+                const IndexType& j   = A.column_indices[n];
+                const OperandType Aij = storage_cast<ValueType>(A.values[n]);
+                const ValueType& xj  = x[j];
+
+                y[i] = reduce(y[i], combine(Aij, xj));
+            }
+        }
+
+        return;
+    }
 
     for(size_t i = 0; i < A.num_rows; i++)
         y[i] = initialize(y[i]);
@@ -36,7 +79,7 @@ void spmv_coo(const Matrix&  A,
     {
         const IndexType& i   = A.row_indices[n];
         const IndexType& j   = A.column_indices[n];
-        const ValueType& Aij = A.values[n];
+        const OperandType Aij = storage_cast<ValueType>(A.values[n]);
         const ValueType& xj  = x[j];
 
         y[i] = reduce(y[i], combine(Aij, xj));
@@ -54,7 +97,7 @@ void spmv_coo(const Matrix&  A,
 
     spmv_coo(A, x, y,
              cusp::detail::zero_function<ValueType>(),
-             thrust::multiplies<ValueType>(),
+             cusp::detail::scalar_multiplies<ValueType>(),
              thrust::plus<ValueType>());
 }
 
@@ -75,20 +118,28 @@ void spmv_csr(const Matrix&  A,
               BinaryFunction1 combine,
               BinaryFunction2 reduce)
 {
-    typedef typename Matrix::index_type  IndexType;
+    // the row offsets may be wider than the column indices
+    typedef typename Matrix::row_offsets_array_type::value_type    OffsetType;
+    typedef typename Matrix::column_indices_array_type::value_type IndexType;
     typedef typename Vector2::value_type ValueType;
- 
-    for(size_t i = 0; i < A.num_rows; i++)
+    typedef typename storage_operand<ValueType, typename Matrix::value_type>::type OperandType;
+
+    const long num_rows = A.num_rows;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, HOST_ROW_BLOCK_SIZE) if (is_parallel_work(A.num_entries))
+#endif
+    for(long i = 0; i < num_rows; i++)
     {
-        const IndexType& row_start = A.row_offsets[i];
-        const IndexType& row_end   = A.row_offsets[i+1];
+        const OffsetType& row_start = A.row_offsets[i];
+        const OffsetType& row_end   = A.row_offsets[i+1];
  
         ValueType accumulator = initialize(y[i]);
  
-        for (IndexType jj = row_start; jj < row_end; jj++)
+        for (OffsetType jj = row_start; jj < row_end; jj++)
         {
             const IndexType& j   = A.column_indices[jj];
-            const ValueType& Aij = A.values[jj];
+            const OperandType Aij = storage_cast<ValueType>(A.values[jj]);
             const ValueType& xj  = x[j];
  
             accumulator = reduce(accumulator, combine(Aij, xj));
@@ -110,7 +161,7 @@ void spmv_csr(const Matrix&  A,
 
     spmv_csr(A, x, y,
              cusp::detail::zero_function<ValueType>(),
-             thrust::multiplies<ValueType>(),
+             cusp::detail::scalar_multiplies<ValueType>(),
              thrust::plus<ValueType>());
 }
 
@@ -133,30 +184,40 @@ void spmv_dia(const Matrix&  A,
 {
     typedef typename Matrix::index_type  IndexType;
     typedef typename Vector2::value_type ValueType;
+    typedef typename storage_operand<ValueType, typename Matrix::value_type>::type OperandType;
 
     const size_t num_diagonals = A.values.num_cols;
+    const long   num_blocks    = num_row_blocks(A.num_rows);
 
-    for(size_t i = 0; i < A.num_rows; i++)
-        y[i] = initialize(y[i]);
-
-    for(size_t i = 0; i < num_diagonals; i++)
+    // each block of rows applies the diagonals in turn
+#ifdef _OPENMP
+    #pragma omp parallel for if (is_parallel_work(A.num_rows * num_diagonals))
+#endif
+    for(long b = 0; b < num_blocks; b++)
     {
-        const IndexType& k = A.diagonal_offsets[i];
+        const IndexType row_start = b * HOST_ROW_BLOCK_SIZE;
+        const IndexType row_end   = std::min<size_t>(A.num_rows, (b + 1) * HOST_ROW_BLOCK_SIZE);
 
-        const IndexType& i_start = std::max<IndexType>(0, -k);
-        const IndexType& j_start = std::max<IndexType>(0,  k);
+        for(IndexType i = row_start; i < row_end; i++)
+            y[i] = initialize(y[i]);
 
-        // number of elements to process in this diagonal
-        const IndexType N = std::min(A.num_rows - i_start, A.num_cols - j_start);
-
-        for(IndexType n = 0; n < N; n++)
+        for(size_t n = 0; n < num_diagonals; n++)
         {
-            const ValueType& Aij = A.values(i_start + n, i);
+            const IndexType& k = A.diagonal_offsets[n];
+
+            // rows of the block whose entry on this diagonal is in the matrix
+            const IndexType i_start = std::max<IndexType>(row_start, -k);
+            const IndexType i_end   = std::min<IndexType>(row_end, IndexType(A.num_cols) - k);
+
+            for(IndexType i = i_start; i < i_end; i++)
+            {
+                const OperandType Aij = storage_cast<ValueType>(A.values(i, n));
+
+                const ValueType& xj = x[i + k];
+                      ValueType& yi = y[i];
 
-            const ValueType& xj = x[j_start + n];
-                  ValueType& yi = y[i_start + n];
-    
-            yi = reduce(yi, combine(Aij, xj));
+                yi = reduce(yi, combine(Aij, xj));
+            }
         }
     }
 }
@@ -172,7 +233,7 @@ void spmv_dia(const Matrix&  A,
 
     spmv_dia(A, x, y,
              cusp::detail::zero_function<ValueType>(),
-             thrust::multiplies<ValueType>(),
+             cusp::detail::scalar_multiplies<ValueType>(),
              thrust::plus<ValueType>());
 }
 
@@ -194,25 +255,38 @@ void spmv_ell(const Matrix&  A,
 {
     typedef typename Matrix::index_type  IndexType;
     typedef typename Vector2::value_type ValueType;
+    typedef typename storage_operand<ValueType, typename Matrix::value_type>::type OperandType;
 
     const size_t& num_entries_per_row = A.column_indices.num_cols;
 
     const IndexType invalid_index = Matrix::invalid_index;
-    
-    for(size_t i = 0; i < A.num_rows; i++)
-        y[i] = initialize(y[i]);
 
-    for(size_t n = 0; n < num_entries_per_row; n++)
+    const long num_blocks = num_row_blocks(A.num_rows);
+
+    // each block of rows applies the columns of the ELL arrays in turn
+#ifdef _OPENMP
+    #pragma omp parallel for if (is_parallel_work(A.num_rows * num_entries_per_row))
+#endif
+    for(long b = 0; b < num_blocks; b++)
     {
-        for(size_t i = 0; i < A.num_rows; i++)
-        {
-            const IndexType& j   = A.column_indices(i, n);
-            const ValueType& Aij = A.values(i,n);
+        const size_t row_start = b * HOST_ROW_BLOCK_SIZE;
+        const size_t row_end   = std::min<size_t>(A.num_rows, (b + 1) * HOST_ROW_BLOCK_SIZE);
 
-            if (j != invalid_index)
+        for(size_t i = row_start; i < row_end; i++)
+            y[i] = initialize(y[i]);
+
+        for(size_t n = 0; n < num_entries_per_row; n++)
+        {
+            for(size_t i = row_start; i < row_end; i++)
             {
-                const ValueType& xj = x[j];
-                y[i] = reduce(y[i], combine(Aij, xj));
+                const IndexType& j   = A.column_indices(i, n);
+                const OperandType Aij = storage_cast<ValueType>(A.values(i,n));
+
+                if (j != invalid_index)
+                {
+                    const ValueType& xj = x[j];
+                    y[i] = reduce(y[i], combine(Aij, xj));
+                }
             }
         }
     }
@@ -228,9 +302,12 @@ void spmv_ell(const Matrix&  A,
 {
     typedef typename Vector2::value_type ValueType;
 
+    if (spmv_ell_simd(A, x, y))
+        return;
+
     spmv_ell(A, x, y,
              cusp::detail::zero_function<ValueType>(),
-             thrust::multiplies<ValueType>(),
+             cusp::detail::scalar_multiplies<ValueType>(),
              thrust::plus<ValueType>());
 }
 
@@ -0,0 +1,88 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/functional.h>
+#include <cusp/detail/functional.h>
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+//////////////////////
+// Batched CSR SpMV //
+//////////////////////
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename UnaryFunction,
+          typename BinaryFunction1,
+          typename BinaryFunction2>
+void spmv_batched_csr(const Matrix&  A,
+                      const Vector1& x,
+                            Vector2& y,
+                      UnaryFunction   initialize,
+                      BinaryFunction1 combine,
+                      BinaryFunction2 reduce)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Vector2::value_type ValueType;
+
+    const size_t num_batches = A.num_batches;
+    const size_t num_rows    = A.batch_num_rows();
+    const size_t num_cols    = A.batch_num_cols();
+    const size_t pitch       = A.values.pitch;
+
+    // the pattern of a row is read once for all items
+    for(size_t i = 0; i < num_rows; i++)
+    {
+        const IndexType& row_start = A.row_offsets[i];
+        const IndexType& row_end   = A.row_offsets[i + 1];
+
+        for(size_t b = 0; b < num_batches; b++)
+        {
+            ValueType accumulator = initialize(y[b * num_rows + i]);
+
+            for(IndexType jj = row_start; jj < row_end; jj++)
+                accumulator = reduce(accumulator, combine(A.values.values[jj * pitch + b], x[b * num_cols + A.column_indices[jj]]));
+
+            y[b * num_rows + i] = accumulator;
+        }
+    }
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void spmv_batched_csr(const Matrix&  A,
+                      const Vector1& x,
+                            Vector2& y)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    spmv_batched_csr(A, x, y,
+                     cusp::detail::zero_function<ValueType>(),
+                     thrust::multiplies<ValueType>(),
+                     thrust::plus<ValueType>());
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
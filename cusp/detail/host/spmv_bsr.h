@@ -0,0 +1,148 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/functional.h>
+#include <cusp/detail/functional.h>
+#include <cusp/detail/fixed_size.h>
+#include <cusp/detail/host/parallel.h>
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+//////////////
+// BSR SpMV //
+//////////////
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename UnaryFunction,
+          typename BinaryFunction1,
+          typename BinaryFunction2>
+void spmv_bsr(const Matrix&  A,
+              const Vector1& x,
+                    Vector2& y,
+              UnaryFunction   initialize,
+              BinaryFunction1 combine,
+              BinaryFunction2 reduce)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Vector2::value_type ValueType;
+
+    const size_t block_size    = A.block_size;
+    const size_t block_entries = block_size * block_size;
+
+    for(size_t i = 0; i < A.num_rows; i++)
+    {
+        const size_t bi = i / block_size;
+        const size_t r  = i % block_size;
+
+        const IndexType& row_start = A.row_offsets[bi];
+        const IndexType& row_end   = A.row_offsets[bi+1];
+
+        ValueType accumulator = initialize(y[i]);
+
+        for (IndexType kk = row_start; kk < row_end; kk++)
+        {
+            const size_t j      = A.column_indices[kk] * block_size;
+            const size_t offset = kk * block_entries + r * block_size;
+
+            for (size_t c = 0; c < block_size; c++)
+                accumulator = reduce(accumulator, combine(A.values[offset + c], x[j + c]));
+        }
+
+        y[i] = accumulator;
+    }
+}
+
+// y = A*x for blocks of BLOCK_DIM rows, where each block row is computed
+// with its BLOCK_DIM sums in registers and every block is multiplied with
+// the unrolled fixed_gemv.  BLOCK_DIM == 0 uses the generic loop.
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+struct spmv_bsr_fixed
+{
+    const Matrix&  A;
+    const Vector1& x;
+          Vector2& y;
+
+    spmv_bsr_fixed(const Matrix& A, const Vector1& x, Vector2& y)
+        : A(A), x(x), y(y) {}
+
+    template <int BLOCK_DIM>
+    void apply(void)
+    {
+        typedef typename Matrix::index_type  IndexType;
+        typedef typename Matrix::value_type  StorageType;
+        typedef typename Vector2::value_type ValueType;
+
+        if (BLOCK_DIM == 0)
+        {
+            spmv_bsr(A, x, y,
+                     cusp::detail::zero_function<ValueType>(),
+                     thrust::multiplies<ValueType>(),
+                     thrust::plus<ValueType>());
+            return;
+        }
+
+        const int  B              = BLOCK_DIM == 0 ? 1 : BLOCK_DIM;
+        const long num_block_rows = A.num_rows / B;
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, HOST_ROW_BLOCK_SIZE) if (is_parallel_work(A.num_entries))
+#endif
+        for(long bi = 0; bi < num_block_rows; bi++)
+        {
+            ValueType sum[B];
+
+            for (int r = 0; r < B; r++)
+                sum[r] = ValueType(0);
+
+            for (IndexType kk = A.row_offsets[bi]; kk < A.row_offsets[bi + 1]; kk++)
+            {
+                const StorageType * block = &A.values[0] + kk * B * B;
+
+                cusp::detail::fixed_gemv<BLOCK_DIM,BLOCK_DIM>::apply(block, x, A.column_indices[kk] * B, sum);
+            }
+
+            for (int r = 0; r < B; r++)
+                y[bi * B + r] = sum[r];
+        }
+    }
+};
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void spmv_bsr(const Matrix&  A,
+              const Vector1& x,
+                    Vector2& y)
+{
+    spmv_bsr_fixed<Matrix,Vector1,Vector2> op(A, x, y);
+
+    cusp::detail::dispatch_fixed_size(A.block_size, op);
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
+
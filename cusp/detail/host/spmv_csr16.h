@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/functional.h>
+#include <cusp/detail/functional.h>
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+////////////////
+// CSR16 SpMV //
+////////////////
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename UnaryFunction,
+          typename BinaryFunction1,
+          typename BinaryFunction2>
+void spmv_csr16(const Matrix&  A,
+                const Vector1& x,
+                      Vector2& y,
+                UnaryFunction   initialize,
+                BinaryFunction1 combine,
+                BinaryFunction2 reduce)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Vector2::value_type ValueType;
+
+    for(size_t i = 0; i < A.num_rows; i++)
+    {
+        const IndexType& row_start = A.row_offsets[i];
+        const IndexType& row_end   = A.row_offsets[i + 1];
+        const IndexType  row_base  = A.row_bases[i];
+
+        ValueType accumulator = initialize(y[i]);
+
+        for(IndexType jj = row_start; jj < row_end; jj++)
+        {
+            const IndexType j = row_base + IndexType(A.column_offsets[jj]);
+            accumulator = reduce(accumulator, combine(A.values[jj], x[j]));
+        }
+
+        y[i] = accumulator;
+    }
+
+    // add the overflow entries
+    for(size_t n = 0; n < A.overflow.num_entries; n++)
+    {
+        const IndexType& i = A.overflow.row_indices[n];
+        const IndexType& j = A.overflow.column_indices[n];
+
+        y[i] = reduce(y[i], combine(A.overflow.values[n], x[j]));
+    }
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void spmv_csr16(const Matrix&  A,
+                const Vector1& x,
+                      Vector2& y)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    spmv_csr16(A, x, y,
+               cusp::detail::zero_function<ValueType>(),
+               thrust::multiplies<ValueType>(),
+               thrust::plus<ValueType>());
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/functional.h>
+#include <cusp/detail/functional.h>
+#include <cusp/detail/host/spmv_simd.h>
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+///////////////
+// SELL SpMV //
+///////////////
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2,
+          typename UnaryFunction,
+          typename BinaryFunction1,
+          typename BinaryFunction2>
+void spmv_sell(const Matrix&  A,
+               const Vector1& x,
+                     Vector2& y,
+               UnaryFunction   initialize,
+               BinaryFunction1 combine,
+               BinaryFunction2 reduce)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Vector2::value_type ValueType;
+
+    const IndexType invalid_index = Matrix::invalid_index;
+    const size_t    slice_size    = A.slice_size;
+
+    for(size_t k = 0; k < A.num_rows; k++)
+    {
+        const IndexType  s   = k / slice_size;
+        const IndexType& end = A.slice_offsets[s + 1];
+        const IndexType  i   = A.row_permutation[k];
+
+        ValueType accumulator = initialize(y[i]);
+
+        for(IndexType jj = A.slice_offsets[s] + k % slice_size; jj < end; jj += slice_size)
+        {
+            const IndexType& j = A.column_indices[jj];
+
+            if (j == invalid_index)
+                break;
+
+            accumulator = reduce(accumulator, combine(A.values[jj], x[j]));
+        }
+
+        y[i] = accumulator;
+    }
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void spmv_sell(const Matrix&  A,
+               const Vector1& x,
+                     Vector2& y)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    if (spmv_sell_simd(A, x, y))
+        return;
+
+    spmv_sell(A, x, y,
+              cusp::detail::zero_function<ValueType>(),
+              thrust::multiplies<ValueType>(),
+              thrust::plus<ValueType>());
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,368 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/detail/mutex.h>
+#include <cusp/detail/host/contiguous.h>
+#include <cusp/detail/host/parallel.h>
+
+#include <thrust/detail/type_traits.h>
+
+#include <cstddef>
+
+// Vectorized host SpMV of the ELL and SELL formats.
+//
+// Both formats store groups of rows column by column, so one vector
+// register holds an entry of WIDTH consecutive rows: the column indices
+// and values are loaded contiguously, x is gathered and the products are
+// accumulated with fused multiply-adds.  Padding (invalid_index) is masked
+// out of the gather.  The kernels are compiled for AVX2 and AVX-512 with
+// target attributes and the widest instruction set supported by the CPU
+// is picked at run time, so the library needs no special compiler flags.
+// They apply to y = A x with int indices and float or double values on
+// contiguous host arrays; other cases, and compilers without target
+// attributes, use the scalar loops.  Define CUSP_NO_HOST_SIMD to disable
+// the vectorized kernels.  Rows are summed in the same order as the scalar
+// loops, although the fused multiply-adds round differently.
+
+#if !defined(CUSP_NO_HOST_SIMD) && !defined(__CUDA_ARCH__) && \
+    (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CUSP_HOST_SIMD
+#include <immintrin.h>
+#endif
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+enum host_simd_isa
+{
+    host_simd_none,
+    host_simd_avx2,
+    host_simd_avx512
+};
+
+inline host_simd_isa detect_host_simd_isa(void)
+{
+#ifdef CUSP_HOST_SIMD
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+        return host_simd_avx512;
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return host_simd_avx2;
+#endif
+
+    return host_simd_none;
+}
+
+// widest instruction set of the CPU, detected once
+inline host_simd_isa current_host_simd_isa(void)
+{
+    static cusp::detail::once_value<host_simd_isa> isa;
+    return cusp::detail::initialize_once(isa, detect_host_simd_isa);
+}
+
+#ifdef CUSP_HOST_SIMD
+
+// y[r] <- sum_n vals[n * stride + r] * x[cols[n * stride + r]] for the
+// WIDTH rows r of a group
+__attribute__((target("avx2,fma")))
+inline void simd_rows_avx2(const int * cols, const float * vals, const size_t stride, const size_t width,
+                           const int invalid_index, const float * x, float * y)
+{
+    const __m256i invalid = _mm256_set1_epi32(invalid_index);
+    const __m256i ones    = _mm256_set1_epi32(-1);
+
+    __m256 sum = _mm256_setzero_ps();
+
+    for (size_t n = 0; n < width; n++)
+    {
+        const __m256i j     = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cols + n * stride));
+        const __m256  valid = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(j, invalid), ones));
+        const __m256  a     = _mm256_and_ps(_mm256_loadu_ps(vals + n * stride), valid);
+        const __m256  xj    = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), x, j, valid, 4);
+
+        sum = _mm256_fmadd_ps(a, xj, sum);
+    }
+
+    _mm256_storeu_ps(y, sum);
+}
+
+__attribute__((target("avx2,fma")))
+inline void simd_rows_avx2(const int * cols, const double * vals, const size_t stride, const size_t width,
+                           const int invalid_index, const double * x, double * y)
+{
+    const __m128i invalid = _mm_set1_epi32(invalid_index);
+    const __m128i ones    = _mm_set1_epi32(-1);
+
+    __m256d sum = _mm256_setzero_pd();
+
+    for (size_t n = 0; n < width; n++)
+    {
+        const __m128i j     = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cols + n * stride));
+        const __m256d valid = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(_mm_xor_si128(_mm_cmpeq_epi32(j, invalid), ones)));
+        const __m256d a     = _mm256_and_pd(_mm256_loadu_pd(vals + n * stride), valid);
+        const __m256d xj    = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, j, valid, 8);
+
+        sum = _mm256_fmadd_pd(a, xj, sum);
+    }
+
+    _mm256_storeu_pd(y, sum);
+}
+
+__attribute__((target("avx512f")))
+inline void simd_rows_avx512(const int * cols, const float * vals, const size_t stride, const size_t width,
+                             const int invalid_index, const float * x, float * y)
+{
+    const __m512i invalid = _mm512_set1_epi32(invalid_index);
+
+    __m512 sum = _mm512_setzero_ps();
+
+    for (size_t n = 0; n < width; n++)
+    {
+        const __m512i   j     = _mm512_loadu_si512(cols + n * stride);
+        const __mmask16 valid = _mm512_cmpneq_epi32_mask(j, invalid);
+        const __m512    a     = _mm512_maskz_loadu_ps(valid, vals + n * stride);
+        const __m512    xj    = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), valid, j, x, 4);
+
+        sum = _mm512_fmadd_ps(a, xj, sum);
+    }
+
+    _mm512_storeu_ps(y, sum);
+}
+
+__attribute__((target("avx512f")))
+inline void simd_rows_avx512(const int * cols, const double * vals, const size_t stride, const size_t width,
+                             const int invalid_index, const double * x, double * y)
+{
+    const __m512i invalid = _mm512_set1_epi32(invalid_index);
+
+    __m512d sum = _mm512_setzero_pd();
+
+    for (size_t n = 0; n < width; n++)
+    {
+        // only the low eight lanes of the comparison are used
+        const __m256i  j     = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cols + n * stride));
+        const __mmask8 valid = __mmask8(_mm512_cmpneq_epi32_mask(_mm512_castsi256_si512(j), invalid) & 0xff);
+        const __m512d  a     = _mm512_maskz_loadu_pd(valid, vals + n * stride);
+        const __m512d  xj    = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), valid, j, x, 8);
+
+        sum = _mm512_fmadd_pd(a, xj, sum);
+    }
+
+    _mm512_storeu_pd(y, sum);
+}
+
+#endif // CUSP_HOST_SIMD
+
+// rows per group and the group kernel of each instruction set
+template <typename ValueType>
+struct host_simd_rows
+{
+    static size_t width(const host_simd_isa isa)
+    {
+        const size_t bytes = isa == host_simd_avx512 ? 64 : 32;
+        return bytes / sizeof(ValueType);
+    }
+
+    static void apply(const host_simd_isa isa,
+                      const int * cols, const ValueType * vals, const size_t stride, const size_t width,
+                      const int invalid_index, const ValueType * x, ValueType * y)
+    {
+#ifdef CUSP_HOST_SIMD
+        if (isa == host_simd_avx512)
+            simd_rows_avx512(cols, vals, stride, width, invalid_index, x, y);
+        else
+            simd_rows_avx2(cols, vals, stride, width, invalid_index, x, y);
+#endif
+    }
+};
+
+template <typename ValueType>
+bool spmv_ell_simd(const host_simd_isa isa,
+                   const size_t num_rows, const size_t num_entries_per_row, const size_t pitch,
+                   const int * cols, const ValueType * vals, const int invalid_index,
+                   const ValueType * x, ValueType * y)
+{
+#ifdef CUSP_HOST_SIMD
+    if (isa == host_simd_none)
+        return false;
+
+    const size_t WIDTH      = host_simd_rows<ValueType>::width(isa);
+    const long   num_groups = num_rows / WIDTH;
+
+#ifdef _OPENMP
+    #pragma omp parallel for if (is_parallel_work(num_rows * num_entries_per_row))
+#endif
+    for (long g = 0; g < num_groups; g++)
+        host_simd_rows<ValueType>::apply(isa, cols + g * WIDTH, vals + g * WIDTH, pitch, num_entries_per_row,
+                                         invalid_index, x, y + g * WIDTH);
+
+    // remaining rows
+    for (size_t i = num_groups * WIDTH; i < num_rows; i++)
+    {
+        ValueType sum = 0;
+
+        for (size_t n = 0; n < num_entries_per_row; n++)
+        {
+            const int j = cols[n * pitch + i];
+
+            if (j != invalid_index)
+                sum += vals[n * pitch + i] * x[j];
+        }
+
+        y[i] = sum;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+template <typename ValueType>
+bool spmv_sell_simd(const host_simd_isa isa,
+                    const size_t num_rows, const size_t slice_size,
+                    const int * slice_offsets, const int * row_permutation,
+                    const int * cols, const ValueType * vals, const int invalid_index,
+                    const ValueType * x, ValueType * y)
+{
+#ifdef CUSP_HOST_SIMD
+    if (isa == host_simd_none)
+        return false;
+
+    const size_t WIDTH = host_simd_rows<ValueType>::width(isa);
+
+    // the groups must not straddle slices
+    if (slice_size % WIDTH != 0)
+        return false;
+
+    const long num_slices = (num_rows + slice_size - 1) / slice_size;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) if (is_parallel_work(size_t(slice_offsets[num_slices])))
+#endif
+    for (long s = 0; s < num_slices; s++)
+    {
+        const size_t width = (slice_offsets[s + 1] - slice_offsets[s]) / slice_size;
+
+        ValueType sums[64 / sizeof(ValueType)];
+
+        for (size_t r = 0; r < slice_size && s * slice_size + r < num_rows; r += WIDTH)
+        {
+            host_simd_rows<ValueType>::apply(isa, cols + slice_offsets[s] + r, vals + slice_offsets[s] + r,
+                                             slice_size, width, invalid_index, x, sums);
+
+            for (size_t l = 0; l < WIDTH && s * slice_size + r + l < num_rows; l++)
+                y[row_permutation[s * slice_size + r + l]] = sums[l];
+        }
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+template <typename T> struct is_host_simd_value         : thrust::detail::false_type {};
+template <>           struct is_host_simd_value<float>  : thrust::detail::true_type  {};
+template <>           struct is_host_simd_value<double> : thrust::detail::true_type  {};
+
+template <typename IndexArray, typename ValueArray, typename Vector1, typename Vector2>
+struct is_host_simd_spmv
+{
+    typedef typename ValueArray::value_type ValueType;
+
+    static const bool value =
+        thrust::detail::is_same<typename IndexArray::value_type, int>::value &&
+        is_host_simd_value<ValueType>::value &&
+        is_host_contiguous_iterator<typename IndexArray::iterator, int>::value &&
+        is_host_contiguous_iterator<typename ValueArray::iterator, ValueType>::value &&
+        is_host_contiguous_iterator<typename Vector1::iterator, ValueType>::value &&
+        is_host_contiguous_iterator<typename Vector2::iterator, ValueType>::value;
+};
+
+template <bool Enabled>
+struct host_simd_spmv
+{
+    template <typename Matrix, typename Vector1, typename Vector2>
+    static bool ell(const Matrix&, const Vector1&, Vector2&, const host_simd_isa) { return false; }
+
+    template <typename Matrix, typename Vector1, typename Vector2>
+    static bool sell(const Matrix&, const Vector1&, Vector2&, const host_simd_isa) { return false; }
+};
+
+template <>
+struct host_simd_spmv<true>
+{
+    template <typename Matrix, typename Vector1, typename Vector2>
+    static bool ell(const Matrix& A, const Vector1& x, Vector2& y, const host_simd_isa isa)
+    {
+        if (A.column_indices.pitch != A.values.pitch || A.num_rows == 0)
+            return false;
+
+        return spmv_ell_simd(isa, A.num_rows, A.column_indices.num_cols, A.column_indices.pitch,
+                             host_contiguous_pointer(A.column_indices.values), host_contiguous_pointer(A.values.values),
+                             int(Matrix::invalid_index), host_contiguous_pointer(x), host_contiguous_pointer(y));
+    }
+
+    template <typename Matrix, typename Vector1, typename Vector2>
+    static bool sell(const Matrix& A, const Vector1& x, Vector2& y, const host_simd_isa isa)
+    {
+        if (A.num_rows == 0)
+            return false;
+
+        return spmv_sell_simd(isa, A.num_rows, A.slice_size,
+                              host_contiguous_pointer(A.slice_offsets), host_contiguous_pointer(A.row_permutation),
+                              host_contiguous_pointer(A.column_indices), host_contiguous_pointer(A.values),
+                              int(Matrix::invalid_index), host_contiguous_pointer(x), host_contiguous_pointer(y));
+    }
+};
+
+// y <- A x with the vectorized kernels, false when they do not apply
+template <typename Matrix, typename Vector1, typename Vector2>
+bool spmv_ell_simd(const Matrix& A, const Vector1& x, Vector2& y,
+                   const host_simd_isa isa = current_host_simd_isa())
+{
+    typedef is_host_simd_spmv<typename Matrix::column_indices_array_type::values_array_type,
+                              typename Matrix::values_array_type::values_array_type,
+                              Vector1, Vector2> Enabled;
+
+    return host_simd_spmv<Enabled::value>::ell(A, x, y, isa);
+}
+
+template <typename Matrix, typename Vector1, typename Vector2>
+bool spmv_sell_simd(const Matrix& A, const Vector1& x, Vector2& y,
+                    const host_simd_isa isa = current_host_simd_isa())
+{
+    typedef is_host_simd_spmv<typename Matrix::column_indices_array_type,
+                              typename Matrix::values_array_type,
+                              Vector1, Vector2> Enabled;
+
+    return host_simd_spmv<Enabled::value>::sell(A, x, y, isa);
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
+
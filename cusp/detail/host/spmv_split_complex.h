@@ -0,0 +1,166 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/format.h>
+#include <cusp/ell_matrix.h>
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+////////////////////////
+// Split Complex SpMV //
+////////////////////////
+
+// (re, im) += (a + i b) * x
+template <typename RealType, typename ValueType>
+void split_complex_accumulate(RealType& re, RealType& im, const RealType a, const RealType b, const ValueType& x)
+{
+    re += a * x.real() - b * x.imag();
+    im += a * x.imag() + b * x.real();
+}
+
+template <typename Matrix,
+          typename Array,
+          typename Vector1,
+          typename Vector2>
+void spmv_split_complex(const Matrix&  A,
+                        const Array&   imag,
+                        const Vector1& x,
+                              Vector2& y,
+                        cusp::csr_format)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Matrix::value_type  RealType;
+    typedef typename Vector2::value_type ValueType;
+
+    for(size_t i = 0; i < A.num_rows; i++)
+    {
+        RealType re = 0;
+        RealType im = 0;
+
+        for(IndexType jj = A.row_offsets[i]; jj < A.row_offsets[i + 1]; jj++)
+            split_complex_accumulate(re, im, A.values[jj], imag[jj], x[A.column_indices[jj]]);
+
+        y[i] = ValueType(re, im);
+    }
+}
+
+// the ELL entries of row i, imag holds the padded column-major layout
+template <typename Matrix,
+          typename Array,
+          typename Vector,
+          typename RealType>
+void spmv_split_complex_ell_row(const Matrix& A,
+                                const Array&  imag,
+                                const Vector& x,
+                                const size_t  i,
+                                RealType& re, RealType& im)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    const IndexType invalid_index = cusp::ell_matrix<IndexType, RealType, cusp::host_memory>::invalid_index;
+    const size_t    pitch         = A.values.pitch;
+
+    for(size_t n = 0; n < A.column_indices.num_cols; n++)
+    {
+        const IndexType j = A.column_indices(i, n);
+
+        if (j != invalid_index)
+            split_complex_accumulate(re, im, A.values(i, n), imag[n * pitch + i], x[j]);
+    }
+}
+
+template <typename Matrix,
+          typename Array,
+          typename Vector1,
+          typename Vector2>
+void spmv_split_complex(const Matrix&  A,
+                        const Array&   imag,
+                        const Vector1& x,
+                              Vector2& y,
+                        cusp::ell_format)
+{
+    typedef typename Matrix::value_type  RealType;
+    typedef typename Vector2::value_type ValueType;
+
+    for(size_t i = 0; i < A.num_rows; i++)
+    {
+        RealType re = 0;
+        RealType im = 0;
+
+        spmv_split_complex_ell_row(A, imag, x, i, re, im);
+
+        y[i] = ValueType(re, im);
+    }
+}
+
+template <typename Matrix,
+          typename Array,
+          typename Vector1,
+          typename Vector2>
+void spmv_split_complex(const Matrix&  A,
+                        const Array&   imag,
+                        const Vector1& x,
+                              Vector2& y,
+                        cusp::hyb_format)
+{
+    typedef typename Matrix::value_type  RealType;
+    typedef typename Vector2::value_type ValueType;
+
+    for(size_t i = 0; i < A.num_rows; i++)
+    {
+        RealType re = 0;
+        RealType im = 0;
+
+        spmv_split_complex_ell_row(A.ell, imag, x, i, re, im);
+
+        y[i] = ValueType(re, im);
+    }
+
+    // the imaginary parts of the COO entries follow the ELL storage
+    const size_t offset = A.ell.values.values.size();
+
+    for(size_t n = 0; n < A.coo.num_entries; n++)
+    {
+        RealType re = y[A.coo.row_indices[n]].real();
+        RealType im = y[A.coo.row_indices[n]].imag();
+
+        split_complex_accumulate(re, im, A.coo.values[n], imag[offset + n], x[A.coo.column_indices[n]]);
+
+        y[A.coo.row_indices[n]] = ValueType(re, im);
+    }
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void spmv_split_complex(const Matrix&  A,
+                        const Vector1& x,
+                              Vector2& y)
+{
+    spmv_split_complex(A.real, A.imag, x, y, typename Matrix::real_matrix_type::format());
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
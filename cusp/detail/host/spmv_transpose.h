@@ -0,0 +1,157 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/storage_cast.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+
+// Transposed SpMV, y += A^T x.  The entries are visited in storage order
+// and A(i,j) * x[i] is added to y[j], so A^T is never formed.
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void spmv_coo_transpose(const Matrix&  A,
+                        const Vector1& x,
+                              Vector2& y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    for(size_t n = 0; n < A.num_entries; n++)
+    {
+        const IndexType& i = A.row_indices[n];
+        const IndexType& j = A.column_indices[n];
+
+        y[j] += A.values[n] * x[i];
+    }
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void spmv_csr_transpose(const Matrix&  A,
+                        const Vector1& x,
+                              Vector2& y)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Vector2::value_type ValueType;
+
+    for(size_t i = 0; i < A.num_rows; i++)
+    {
+        const IndexType& row_start = A.row_offsets[i];
+        const IndexType& row_end   = A.row_offsets[i + 1];
+
+        const ValueType xi = x[i];
+
+        for(IndexType jj = row_start; jj < row_end; jj++)
+            y[A.column_indices[jj]] += A.values[jj] * xi;
+    }
+}
+
+// y <- P^T (b - A x), where P has the rows of A.  The residual of each
+// row is scattered through the same row of P as soon as it is computed.
+template <typename Matrix1,
+          typename Vector1,
+          typename Vector2,
+          typename Matrix2,
+          typename Vector3>
+void spmv_csr_residual_transpose(const Matrix1& A,
+                                 const Vector1& x,
+                                 const Vector2& b,
+                                 const Matrix2& P,
+                                       Vector3& y)
+{
+    typedef typename Matrix1::index_type IndexType;
+    typedef typename Vector3::value_type ValueType;
+
+    for(size_t j = 0; j < P.num_cols; j++)
+        y[j] = ValueType(0);
+
+    for(size_t i = 0; i < A.num_rows; i++)
+    {
+        ValueType r = b[i];
+
+        for(IndexType jj = A.row_offsets[i]; jj < A.row_offsets[i + 1]; jj++)
+            r -= storage_cast<ValueType>(A.values[jj]) * x[A.column_indices[jj]];
+
+        for(IndexType jj = P.row_offsets[i]; jj < P.row_offsets[i + 1]; jj++)
+            y[P.column_indices[jj]] += storage_cast<ValueType>(P.values[jj]) * r;
+    }
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void spmv_dia_transpose(const Matrix&  A,
+                        const Vector1& x,
+                              Vector2& y)
+{
+    typedef typename Matrix::index_type  IndexType;
+
+    const size_t num_diagonals = A.values.num_cols;
+
+    for(size_t i = 0; i < num_diagonals; i++)
+    {
+        const IndexType& k = A.diagonal_offsets[i];
+
+        const IndexType& i_start = std::max<IndexType>(0, -k);
+        const IndexType& j_start = std::max<IndexType>(0,  k);
+
+        // number of elements to process in this diagonal
+        const IndexType N = std::min(A.num_rows - i_start, A.num_cols - j_start);
+
+        for(IndexType n = 0; n < N; n++)
+            y[j_start + n] += A.values(i_start + n, i) * x[i_start + n];
+    }
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void spmv_ell_transpose(const Matrix&  A,
+                        const Vector1& x,
+                              Vector2& y)
+{
+    typedef typename Matrix::index_type  IndexType;
+
+    const size_t num_entries_per_row = A.column_indices.num_cols;
+
+    const IndexType invalid_index = Matrix::invalid_index;
+
+    for(size_t i = 0; i < A.num_rows; i++)
+    {
+        for(size_t n = 0; n < num_entries_per_row; n++)
+        {
+            const IndexType& j = A.column_indices(i, n);
+
+            if (j != invalid_index)
+                y[j] += A.values(i, n) * x[i];
+        }
+    }
+}
+
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
@@ -0,0 +1,575 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/format.h>
+#include <cusp/array2d.h>
+#include <cusp/exception.h>
+
+#include <cusp/detail/mutex.h>
+#include <cusp/detail/host/contiguous.h>
+
+#include <thrust/detail/type_traits.h>
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(CUSP_USE_MKL)
+#include <mkl_cblas.h>
+#include <mkl_spblas.h>
+#define CUSP_HOST_VENDOR_BLAS
+#elif defined(CUSP_USE_CBLAS)
+#include <cblas.h>
+#define CUSP_HOST_VENDOR_BLAS
+#endif
+
+// Optional vendor BLAS backend of the host algorithms.
+//
+// Defining CUSP_USE_CBLAS (and linking with a CBLAS library) delegates the
+// host BLAS1 routines axpy, dot, nrm2 and scal and the dense products of
+// array2d operands to the library.  CUSP_USE_MKL selects Intel MKL, which
+// additionally provides the CSR products y = A x, y = A^T x, y = alpha A x
+// + beta z and C = A B (B and C in array2d) through its inspector-executor
+// sparse BLAS.  The functions below return false when the operation is not
+// delegated, i.e. without a vendor library, for value types other than
+// float and double, for arrays that are not contiguous in host memory,
+// for index types other than MKL_INT, or when the backend is disabled at
+// run time, and the caller then uses its own loops.
+//
+// The backend is enabled by default when it is compiled in.  Setting the
+// environment variable CUSP_HOST_VENDOR to 0 or off disables it, and
+// enable() switches it at run time, e.g. to compare both paths.
+
+namespace cusp
+{
+namespace detail
+{
+namespace host
+{
+namespace vendor
+{
+
+// whether Cusp was built with a vendor library
+inline bool available(void)
+{
+#if defined(CUSP_HOST_VENDOR_BLAS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// the library is used unless CUSP_HOST_VENDOR is "0" or "off"
+inline bool environment_flag(void)
+{
+    const char * value = std::getenv("CUSP_HOST_VENDOR");
+
+    return !(value && (std::strcmp(value, "0") == 0 || std::strcmp(value, "off") == 0));
+}
+
+inline bool& enabled_flag(void)
+{
+    static cusp::detail::once_value<bool> flag;
+
+    return cusp::detail::initialize_once(flag, environment_flag);
+}
+
+// whether operations are delegated to the vendor library
+inline bool enabled(void)
+{
+    return available() && enabled_flag();
+}
+
+// select the vendor library (true) or the built-in loops (false)
+inline void enable(const bool flag)
+{
+    enabled_flag() = flag;
+}
+
+template <typename T> struct is_vendor_value         : thrust::detail::false_type {};
+template <>           struct is_vendor_value<float>  : thrust::detail::true_type  {};
+template <>           struct is_vendor_value<double> : thrust::detail::true_type  {};
+
+// contiguous host array of float or double values of type T
+template <typename Array, typename T>
+struct is_vendor_array
+    : thrust::detail::integral_constant<bool, is_vendor_value<T>::value &&
+                                              is_host_contiguous_array<Array,T>::value> {};
+
+template <typename Array>
+typename Array::value_type * vendor_pointer(const Array& a)
+{
+    // views are shallow, so the storage of a const view may be written
+    return const_cast<typename Array::value_type *>(host_contiguous_pointer(a));
+}
+
+inline bool is_vendor_size(const size_t n)
+{
+    return n > 0 && n <= size_t(INT_MAX);
+}
+
+#if defined(CUSP_HOST_VENDOR_BLAS)
+
+///////////
+// BLAS1 //
+///////////
+
+inline void xaxpy(int n, float  alpha, const float  * x, float  * y) { cblas_saxpy(n, alpha, x, 1, y, 1); }
+inline void xaxpy(int n, double alpha, const double * x, double * y) { cblas_daxpy(n, alpha, x, 1, y, 1); }
+
+inline float  xdot(int n, const float  * x, const float  * y) { return cblas_sdot(n, x, 1, y, 1); }
+inline double xdot(int n, const double * x, const double * y) { return cblas_ddot(n, x, 1, y, 1); }
+
+inline float  xnrm2(int n, const float  * x) { return cblas_snrm2(n, x, 1); }
+inline double xnrm2(int n, const double * x) { return cblas_dnrm2(n, x, 1); }
+
+inline void xscal(int n, float  alpha, float  * x) { cblas_sscal(n, alpha, x, 1); }
+inline void xscal(int n, double alpha, double * x) { cblas_dscal(n, alpha, x, 1); }
+
+template <typename Array1, typename Array2, typename ScalarType>
+bool __axpy(const Array1& x, const Array2& y, ScalarType alpha, thrust::detail::false_type) { return false; }
+
+template <typename Array1, typename Array2, typename ScalarType>
+bool __axpy(const Array1& x, const Array2& y, ScalarType alpha, thrust::detail::true_type)
+{
+    typedef typename Array2::value_type ValueType;
+
+    if (!enabled() || !is_vendor_size(x.size()))
+        return false;
+
+    xaxpy(x.size(), ValueType(alpha), vendor_pointer(x), vendor_pointer(y));
+
+    return true;
+}
+
+template <typename Array1, typename Array2, typename ValueType>
+bool __dot(const Array1& x, const Array2& y, ValueType& result, thrust::detail::false_type) { return false; }
+
+template <typename Array1, typename Array2, typename ValueType>
+bool __dot(const Array1& x, const Array2& y, ValueType& result, thrust::detail::true_type)
+{
+    if (!enabled() || !is_vendor_size(x.size()))
+        return false;
+
+    result = xdot(x.size(), vendor_pointer(x), vendor_pointer(y));
+
+    return true;
+}
+
+template <typename Array, typename ValueType>
+bool __nrm2(const Array& x, ValueType& result, thrust::detail::false_type) { return false; }
+
+template <typename Array, typename ValueType>
+bool __nrm2(const Array& x, ValueType& result, thrust::detail::true_type)
+{
+    if (!enabled() || !is_vendor_size(x.size()))
+        return false;
+
+    result = xnrm2(x.size(), vendor_pointer(x));
+
+    return true;
+}
+
+template <typename Array, typename ScalarType>
+bool __scal(const Array& x, ScalarType alpha, thrust::detail::false_type) { return false; }
+
+template <typename Array, typename ScalarType>
+bool __scal(const Array& x, ScalarType alpha, thrust::detail::true_type)
+{
+    typedef typename Array::value_type ValueType;
+
+    if (!enabled() || !is_vendor_size(x.size()))
+        return false;
+
+    xscal(x.size(), ValueType(alpha), vendor_pointer(x));
+
+    return true;
+}
+
+////////////////////
+// Dense Products //
+////////////////////
+
+inline CBLAS_ORDER order(cusp::row_major)    { return CblasRowMajor; }
+inline CBLAS_ORDER order(cusp::column_major) { return CblasColMajor; }
+
+inline void xgemv(CBLAS_ORDER o, CBLAS_TRANSPOSE op, int m, int n,
+                  const float * A, int lda, const float * x, float * y)
+{
+    cblas_sgemv(o, op, m, n, 1.0f, A, lda, x, 1, 0.0f, y, 1);
+}
+
+inline void xgemv(CBLAS_ORDER o, CBLAS_TRANSPOSE op, int m, int n,
+                  const double * A, int lda, const double * x, double * y)
+{
+    cblas_dgemv(o, op, m, n, 1.0, A, lda, x, 1, 0.0, y, 1);
+}
+
+inline void xgemm(CBLAS_ORDER o, CBLAS_TRANSPOSE opA, CBLAS_TRANSPOSE opB, int m, int n, int k,
+                  const float * A, int lda, const float * B, int ldb, float * C, int ldc)
+{
+    cblas_sgemm(o, opA, opB, m, n, k, 1.0f, A, lda, B, ldb, 0.0f, C, ldc);
+}
+
+inline void xgemm(CBLAS_ORDER o, CBLAS_TRANSPOSE opA, CBLAS_TRANSPOSE opB, int m, int n, int k,
+                  const double * A, int lda, const double * B, int ldb, double * C, int ldc)
+{
+    cblas_dgemm(o, opA, opB, m, n, k, 1.0, A, lda, B, ldb, 0.0, C, ldc);
+}
+
+template <typename Matrix>
+bool is_vendor_matrix(const Matrix& A)
+{
+    return A.num_rows > 0 && A.num_cols > 0 &&
+           A.num_rows <= size_t(INT_MAX) && A.num_cols <= size_t(INT_MAX) && A.pitch <= size_t(INT_MAX);
+}
+
+template <typename Matrix, typename Vector1, typename Vector2>
+bool __gemv(const Matrix& A, const Vector1& x, const Vector2& y, bool transpose, thrust::detail::false_type) { return false; }
+
+template <typename Matrix, typename Vector1, typename Vector2>
+bool __gemv(const Matrix& A, const Vector1& x, const Vector2& y, bool transpose, thrust::detail::true_type)
+{
+    typedef typename Matrix::orientation Orientation;
+
+    if (!enabled() || !is_vendor_matrix(A))
+        return false;
+
+    xgemv(order(Orientation()), transpose ? CblasTrans : CblasNoTrans,
+          A.num_rows, A.num_cols, vendor_pointer(A.values), A.pitch,
+          vendor_pointer(x), vendor_pointer(y));
+
+    return true;
+}
+
+// an operand stored in another orientation than C is the transpose of
+// a matrix in the orientation of C with the same leading dimension
+template <typename Orientation>
+CBLAS_TRANSPOSE operation(Orientation, Orientation) { return CblasNoTrans; }
+inline CBLAS_TRANSPOSE operation(cusp::row_major, cusp::column_major) { return CblasTrans; }
+inline CBLAS_TRANSPOSE operation(cusp::column_major, cusp::row_major) { return CblasTrans; }
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool __gemm(const Matrix1& A, const Matrix2& B, Matrix3& C, thrust::detail::false_type) { return false; }
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool __gemm(const Matrix1& A, const Matrix2& B, Matrix3& C, thrust::detail::true_type)
+{
+    typedef typename Matrix1::orientation OrientationA;
+    typedef typename Matrix2::orientation OrientationB;
+    typedef typename Matrix3::orientation OrientationC;
+
+    if (!enabled() || !is_vendor_matrix(A) || !is_vendor_matrix(B) || !is_vendor_matrix(C))
+        return false;
+
+    xgemm(order(OrientationC()),
+          operation(OrientationA(), OrientationC()),
+          operation(OrientationB(), OrientationC()),
+          C.num_rows, C.num_cols, A.num_cols,
+          vendor_pointer(A.values), A.pitch,
+          vendor_pointer(B.values), B.pitch,
+          vendor_pointer(C.values), C.pitch);
+
+    return true;
+}
+
+#endif // CUSP_HOST_VENDOR_BLAS
+
+#if defined(CUSP_USE_MKL)
+
+/////////////////
+// Sparse BLAS //
+/////////////////
+
+inline void check(sparse_status_t status, const char * message)
+{
+    if (status != SPARSE_STATUS_SUCCESS)
+        throw cusp::runtime_exception(message);
+}
+
+inline sparse_status_t xcreate_csr(sparse_matrix_t * A, MKL_INT rows, MKL_INT cols,
+                                   MKL_INT * row_offsets, MKL_INT * column_indices, float * values)
+{
+    return mkl_sparse_s_create_csr(A, SPARSE_INDEX_BASE_ZERO, rows, cols, row_offsets, row_offsets + 1, column_indices, values);
+}
+
+inline sparse_status_t xcreate_csr(sparse_matrix_t * A, MKL_INT rows, MKL_INT cols,
+                                   MKL_INT * row_offsets, MKL_INT * column_indices, double * values)
+{
+    return mkl_sparse_d_create_csr(A, SPARSE_INDEX_BASE_ZERO, rows, cols, row_offsets, row_offsets + 1, column_indices, values);
+}
+
+inline sparse_status_t xmv(sparse_operation_t op, float alpha, sparse_matrix_t A, matrix_descr descr,
+                           const float * x, float beta, float * y)
+{
+    return mkl_sparse_s_mv(op, alpha, A, descr, x, beta, y);
+}
+
+inline sparse_status_t xmv(sparse_operation_t op, double alpha, sparse_matrix_t A, matrix_descr descr,
+                           const double * x, double beta, double * y)
+{
+    return mkl_sparse_d_mv(op, alpha, A, descr, x, beta, y);
+}
+
+inline sparse_status_t xmm(sparse_operation_t op, float alpha, sparse_matrix_t A, matrix_descr descr, sparse_layout_t layout,
+                           const float * B, MKL_INT columns, MKL_INT ldb, float beta, float * C, MKL_INT ldc)
+{
+    return mkl_sparse_s_mm(op, alpha, A, descr, layout, B, columns, ldb, beta, C, ldc);
+}
+
+inline sparse_status_t xmm(sparse_operation_t op, double alpha, sparse_matrix_t A, matrix_descr descr, sparse_layout_t layout,
+                           const double * B, MKL_INT columns, MKL_INT ldb, double beta, double * C, MKL_INT ldc)
+{
+    return mkl_sparse_d_mm(op, alpha, A, descr, layout, B, columns, ldb, beta, C, ldc);
+}
+
+inline sparse_layout_t layout(cusp::row_major)    { return SPARSE_LAYOUT_ROW_MAJOR; }
+inline sparse_layout_t layout(cusp::column_major) { return SPARSE_LAYOUT_COLUMN_MAJOR; }
+
+// MKL handle of a CSR matrix, which references the arrays of the matrix
+template <typename Matrix>
+struct csr_handle
+{
+    sparse_matrix_t handle;
+    matrix_descr    descr;
+
+    csr_handle(const Matrix& A)
+    {
+        descr.type = SPARSE_MATRIX_TYPE_GENERAL;
+
+        check(xcreate_csr(&handle, A.num_rows, A.num_cols,
+                          vendor_pointer(A.row_offsets), vendor_pointer(A.column_indices), vendor_pointer(A.values)),
+              "mkl_sparse_create_csr failed");
+    }
+
+    ~csr_handle(void)
+    {
+        mkl_sparse_destroy(handle);
+    }
+};
+
+template <typename Matrix>
+struct is_vendor_csr_matrix
+{
+    typedef typename Matrix::value_type ValueType;
+
+    static const bool value =
+        thrust::detail::is_same<typename Matrix::index_type, MKL_INT>::value &&
+        is_host_contiguous_array<typename Matrix::row_offsets_array_type, MKL_INT>::value &&
+        is_vendor_value<ValueType>::value &&
+        is_host_contiguous_array<typename Matrix::column_indices_array_type, MKL_INT>::value &&
+        is_host_contiguous_array<typename Matrix::values_array_type, ValueType>::value;
+};
+
+template <typename Matrix>
+bool is_vendor_sparse(const Matrix& A)
+{
+    return A.num_rows > 0 && A.num_cols > 0 && A.num_entries > 0 &&
+           A.num_entries <= size_t(std::numeric_limits<MKL_INT>::max());
+}
+
+template <typename Matrix, typename Vector1, typename Vector2, typename Vector3, typename ScalarType>
+bool __csrmv(const Matrix& A, const Vector1& x, const Vector2& z, const Vector3& y,
+             ScalarType alpha, ScalarType beta, bool transpose, thrust::detail::false_type) { return false; }
+
+template <typename Matrix, typename Vector1, typename Vector2, typename Vector3, typename ScalarType>
+bool __csrmv(const Matrix& A, const Vector1& x, const Vector2& z, const Vector3& y,
+             ScalarType alpha, ScalarType beta, bool transpose, thrust::detail::true_type)
+{
+    typedef typename Matrix::value_type ValueType;
+
+    if (!enabled() || !is_vendor_sparse(A))
+        return false;
+
+    ValueType * y_ptr = vendor_pointer(y);
+
+    // MKL accumulates into y, so z is copied unless it aliases y
+    if (beta != ScalarType(0) && vendor_pointer(z) != y_ptr)
+        std::memcpy(y_ptr, vendor_pointer(z), y.size() * sizeof(ValueType));
+
+    csr_handle<Matrix> handle(A);
+
+    check(xmv(transpose ? SPARSE_OPERATION_TRANSPOSE : SPARSE_OPERATION_NON_TRANSPOSE,
+              ValueType(alpha), handle.handle, handle.descr, vendor_pointer(x), ValueType(beta), y_ptr),
+          "mkl_sparse_mv failed");
+
+    return true;
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool __csrmm(const Matrix1& A, const Matrix2& B, Matrix3& C, thrust::detail::false_type) { return false; }
+
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool __csrmm(const Matrix1& A, const Matrix2& B, Matrix3& C, thrust::detail::true_type)
+{
+    typedef typename Matrix1::value_type  ValueType;
+    typedef typename Matrix3::orientation Orientation;
+
+    if (!enabled() || !is_vendor_sparse(A) || !is_vendor_matrix(B) || !is_vendor_matrix(C))
+        return false;
+
+    csr_handle<Matrix1> handle(A);
+
+    check(xmm(SPARSE_OPERATION_NON_TRANSPOSE, ValueType(1), handle.handle, handle.descr, layout(Orientation()),
+              vendor_pointer(B.values), B.num_cols, B.pitch, ValueType(0), vendor_pointer(C.values), C.pitch),
+          "mkl_sparse_mm failed");
+
+    return true;
+}
+
+#endif // CUSP_USE_MKL
+
+//////////////////
+// Entry Points //
+//////////////////
+
+// y <- alpha * x + y
+template <typename Array1, typename Array2, typename ScalarType>
+bool axpy(const Array1& x, const Array2& y, ScalarType alpha)
+{
+#if defined(CUSP_HOST_VENDOR_BLAS)
+    typedef typename Array2::value_type ValueType;
+
+    return __axpy(x, y, alpha,
+                  thrust::detail::integral_constant<bool, is_vendor_array<Array1,ValueType>::value &&
+                                                          is_vendor_array<Array2,ValueType>::value>());
+#else
+    return false;
+#endif
+}
+
+// result <- x^T y
+template <typename Array1, typename Array2, typename ValueType>
+bool dot(const Array1& x, const Array2& y, ValueType& result)
+{
+#if defined(CUSP_HOST_VENDOR_BLAS)
+    return __dot(x, y, result,
+                 thrust::detail::integral_constant<bool, is_vendor_array<Array1,ValueType>::value &&
+                                                         is_vendor_array<Array2,ValueType>::value>());
+#else
+    return false;
+#endif
+}
+
+// result <- ||x||_2
+template <typename Array, typename ValueType>
+bool nrm2(const Array& x, ValueType& result)
+{
+#if defined(CUSP_HOST_VENDOR_BLAS)
+    return __nrm2(x, result, is_vendor_array<Array,ValueType>());
+#else
+    return false;
+#endif
+}
+
+// x <- alpha * x
+template <typename Array, typename ScalarType>
+bool scal(const Array& x, ScalarType alpha)
+{
+#if defined(CUSP_HOST_VENDOR_BLAS)
+    return __scal(x, alpha, is_vendor_array<Array,typename Array::value_type>());
+#else
+    return false;
+#endif
+}
+
+// y <- A x, or y <- A^T x, of an array2d A
+template <typename Matrix, typename Vector1, typename Vector2>
+bool gemv(const Matrix& A, const Vector1& x, Vector2& y, bool transpose = false)
+{
+#if defined(CUSP_HOST_VENDOR_BLAS)
+    typedef typename Matrix::value_type ValueType;
+
+    return __gemv(A, x, y, transpose,
+                  thrust::detail::integral_constant<bool, is_vendor_array<typename Matrix::values_array_type,ValueType>::value &&
+                                                          is_vendor_array<Vector1,ValueType>::value &&
+                                                          is_vendor_array<Vector2,ValueType>::value>());
+#else
+    return false;
+#endif
+}
+
+// C <- A B of array2d operands, where C has been resized
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool gemm(const Matrix1& A, const Matrix2& B, Matrix3& C)
+{
+#if defined(CUSP_HOST_VENDOR_BLAS)
+    typedef typename Matrix3::value_type ValueType;
+
+    return __gemm(A, B, C,
+                  thrust::detail::integral_constant<bool, is_vendor_array<typename Matrix1::values_array_type,ValueType>::value &&
+                                                          is_vendor_array<typename Matrix2::values_array_type,ValueType>::value &&
+                                                          is_vendor_array<typename Matrix3::values_array_type,ValueType>::value>());
+#else
+    return false;
+#endif
+}
+
+// y <- alpha * op(A) x + beta * z of a CSR matrix A, where z may alias y
+template <typename Matrix, typename Vector1, typename Vector2, typename Vector3, typename ScalarType>
+bool csrmv(const Matrix& A, const Vector1& x, const Vector2& z, Vector3& y,
+           ScalarType alpha, ScalarType beta, bool transpose = false)
+{
+#if defined(CUSP_USE_MKL)
+    typedef typename Matrix::value_type ValueType;
+
+    return __csrmv(A, x, z, y, alpha, beta, transpose,
+                   thrust::detail::integral_constant<bool, is_vendor_csr_matrix<Matrix>::value &&
+                                                           is_vendor_array<Vector1,ValueType>::value &&
+                                                           is_vendor_array<Vector2,ValueType>::value &&
+                                                           is_vendor_array<Vector3,ValueType>::value>());
+#else
+    return false;
+#endif
+}
+
+// y <- op(A) x of a CSR matrix A
+template <typename Matrix, typename Vector1, typename Vector2>
+bool csrmv(const Matrix& A, const Vector1& x, Vector2& y, bool transpose = false)
+{
+    typedef typename Matrix::value_type ValueType;
+
+    return csrmv(A, x, y, y, ValueType(1), ValueType(0), transpose);
+}
+
+// C <- A B of a CSR matrix A and array2d operands B and C of the same
+// orientation, where C has been resized
+template <typename Matrix1, typename Matrix2, typename Matrix3>
+bool csrmm(const Matrix1& A, const Matrix2& B, Matrix3& C)
+{
+#if defined(CUSP_USE_MKL)
+    typedef typename Matrix1::value_type ValueType;
+
+    return __csrmm(A, B, C,
+                   thrust::detail::integral_constant<bool, is_vendor_csr_matrix<Matrix1>::value &&
+                                                           thrust::detail::is_same<typename Matrix2::orientation,
+                                                                                   typename Matrix3::orientation>::value &&
+                                                           is_vendor_array<typename Matrix2::values_array_type,ValueType>::value &&
+                                                           is_vendor_array<typename Matrix3::values_array_type,ValueType>::value>());
+#else
+    return false;
+#endif
+}
+
+} // end namespace vendor
+} // end namespace host
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,105 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/exception.h>
+#include <cusp/format.h>
+#include <cusp/csr_matrix.h>
+
+#include <cusp/detail/stream.h>
+
+#include <string>
+
+// Copies made by algorithms on behalf of the caller.
+//
+// An algorithm that needs an operand in another format, or in contiguous
+// storage, converts it to a temporary.  Inside a scoped_no_copy such
+// conversions throw implicit_copy_exception instead, so that code which
+// wraps external buffers in views can check that they are consumed in
+// place.  Workspace that holds no copy of an operand, e.g. the product
+// of a fused epilogue, is not affected.  The setting is per host thread.
+
+namespace cusp
+{
+namespace detail
+{
+
+inline int& no_copy_depth_reference(void)
+{
+    static CUSP_THREAD_LOCAL int depth = 0;
+    return depth;
+}
+
+inline bool implicit_copies_allowed(void)
+{
+    return no_copy_depth_reference() == 0;
+}
+
+// call before an operand is copied
+inline void check_implicit_copy(const char * operation)
+{
+    if (!implicit_copies_allowed())
+        throw cusp::implicit_copy_exception(std::string(operation) + " requires a copy of an operand inside a scoped_no_copy");
+}
+
+// A CSR operand of an algorithm: CSR matrices and views are referenced
+// in place, other formats are converted.
+template <typename Matrix, typename MemorySpace, typename Format = typename Matrix::format>
+class csr_operand
+{
+    public:
+    typedef cusp::csr_matrix<typename Matrix::index_type, typename Matrix::value_type, MemorySpace> matrix_type;
+
+    explicit csr_operand(const Matrix& A)
+        : matrix(checked(A)) {}
+
+    const matrix_type& get(void) const
+    {
+        return matrix;
+    }
+
+    private:
+    matrix_type matrix;
+
+    static const Matrix& checked(const Matrix& A)
+    {
+        check_implicit_copy("conversion to CSR");
+        return A;
+    }
+};
+
+template <typename Matrix, typename MemorySpace>
+class csr_operand<Matrix, MemorySpace, cusp::csr_format>
+{
+    public:
+    typedef Matrix matrix_type;
+
+    explicit csr_operand(const Matrix& A)
+        : matrix(A) {}
+
+    const matrix_type& get(void) const
+    {
+        return matrix;
+    }
+
+    private:
+    const Matrix& matrix;
+};
+
+} // end namespace detail
+} // end namespace cusp
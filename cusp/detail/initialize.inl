@@ -0,0 +1,250 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/stream.h>
+#include <cusp/gallery/poisson.h>
+
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/wall_clock.h>
+#include <cusp/detail/device/arch.h>
+
+#include <cuda_runtime_api.h>
+
+#include <cmath>
+#include <exception>
+
+namespace cusp
+{
+namespace detail
+{
+
+inline void synchronize_current_stream(void)
+{
+    check_cuda(cudaStreamSynchronize(cusp::detail::current_stream()), "kernel warmup failed");
+}
+
+// time of the product of B in the format of Matrix, in seconds
+template <typename Matrix, typename HostMatrix>
+double warmup_multiply(const HostMatrix& B)
+{
+    typedef typename Matrix::value_type ValueType;
+
+    Matrix A(B);
+    cusp::array1d<ValueType, cusp::device_memory> x(A.num_cols, ValueType(1));
+    cusp::array1d<ValueType, cusp::device_memory> y(A.num_rows);
+
+    synchronize_current_stream();
+
+    const double start = wall_clock_milliseconds();
+
+    cusp::multiply(A, x, y);
+
+    synchronize_current_stream();
+
+    return 1e-3 * (wall_clock_milliseconds() - start);
+}
+
+// The small matrix is multiplied by the kernel for matrices with few
+// rows, the large one by the kernels that fill the device.
+template <typename Matrix, typename HostMatrix>
+void warmup_format(const HostMatrix& small, const HostMatrix& large, bool& first, initialize_report& report)
+{
+    const double seconds = warmup_multiply<Matrix>(small);
+
+    if (first)
+    {
+        report.first_multiply_seconds = seconds;
+        first = false;
+    }
+
+    warmup_multiply<Matrix>(large);
+}
+
+template <typename ValueType>
+void warmup_blas(const size_t N)
+{
+    cusp::array1d<ValueType, cusp::device_memory> x(N, ValueType(1));
+    cusp::array1d<ValueType, cusp::device_memory> y(N);
+
+    cusp::blas::fill(y, ValueType(0));
+    cusp::blas::copy(x, y);
+    cusp::blas::axpy(x, y, ValueType(1));
+    cusp::blas::axpby(x, y, y, ValueType(1), ValueType(-1));
+    cusp::blas::scal(y, ValueType(2));
+    cusp::blas::dot(x, y);
+    cusp::blas::dotc(x, y);
+    cusp::blas::nrm2(y);
+
+    synchronize_current_stream();
+}
+
+template <typename IndexType, typename ValueType>
+void warmup_kernels(const unsigned int kernels, initialize_report& report)
+{
+    typedef cusp::coo_matrix<IndexType, ValueType, cusp::host_memory> HostMatrix;
+
+    // the large matrix has more rows than small_launch_size()
+    const size_t large_size = 1 + static_cast<size_t>(std::sqrt(2.0 * cusp::detail::device::arch::small_launch_size()));
+
+    HostMatrix small;
+    HostMatrix large;
+
+    if (kernels & (warmup_all & ~warmup_blas))
+    {
+        cusp::gallery::poisson5pt(small, 8, 8);
+        cusp::gallery::poisson5pt(large, large_size, large_size);
+    }
+
+    bool first = true;
+
+    if (kernels & warmup_csr)
+        warmup_format< cusp::csr_matrix<IndexType, ValueType, cusp::device_memory> >(small, large, first, report);
+    if (kernels & warmup_coo)
+        warmup_format< cusp::coo_matrix<IndexType, ValueType, cusp::device_memory> >(small, large, first, report);
+    if (kernels & warmup_ell)
+        warmup_format< cusp::ell_matrix<IndexType, ValueType, cusp::device_memory> >(small, large, first, report);
+    if (kernels & warmup_hyb)
+        warmup_format< cusp::hyb_matrix<IndexType, ValueType, cusp::device_memory> >(small, large, first, report);
+    if (kernels & warmup_dia)
+        warmup_format< cusp::dia_matrix<IndexType, ValueType, cusp::device_memory> >(small, large, first, report);
+
+    if (kernels & warmup_blas)
+    {
+        warmup_blas<ValueType>(64);
+        warmup_blas<ValueType>(large_size * large_size);
+    }
+}
+
+} // end namespace detail
+
+template <typename IndexType, typename ValueType>
+initialize_report initialize(unsigned int kernels)
+{
+    initialize_report report;
+    report.context_seconds        = 0;
+    report.first_multiply_seconds = 0;
+    report.warmup_seconds         = 0;
+
+    const double start = cusp::detail::wall_clock_milliseconds();
+
+    // the runtime creates the context on the first call that needs it
+    cusp::detail::check_cuda(cudaFree(0), "unable to create the CUDA context");
+
+    const double context_end = cusp::detail::wall_clock_milliseconds();
+    report.context_seconds = 1e-3 * (context_end - start);
+
+    if (kernels == warmup_none)
+        return report;
+
+    // a stream of its own, so that the warmup neither waits for nor
+    // delays the work of the caller's streams
+    cudaStream_t stream;
+    cusp::detail::check_cuda(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking), "cudaStreamCreateWithFlags failed");
+
+    try
+    {
+        cusp::scoped_stream scope(stream);
+        cusp::detail::warmup_kernels<IndexType, ValueType>(kernels, report);
+    }
+    catch (...)
+    {
+        cudaStreamDestroy(stream);
+        throw;
+    }
+
+    cudaStreamDestroy(stream);
+
+    report.warmup_seconds = 1e-3 * (cusp::detail::wall_clock_milliseconds() - context_end);
+
+    return report;
+}
+
+template <typename IndexType, typename ValueType>
+initializer<IndexType,ValueType>
+::initializer(unsigned int kernels)
+    : kernels(kernels), device(0), failed(false), thread(0)
+{
+    report.context_seconds        = 0;
+    report.first_multiply_seconds = 0;
+    report.warmup_seconds         = 0;
+
+    cudaGetDevice(&device);
+
+    thread = new cusp::detail::host_thread(execute, this);
+}
+
+template <typename IndexType, typename ValueType>
+initializer<IndexType,ValueType>
+::~initializer(void)
+{
+    if (thread != 0)
+    {
+        thread->join();
+        delete thread;
+    }
+}
+
+template <typename IndexType, typename ValueType>
+const initialize_report&
+initializer<IndexType,ValueType>
+::wait(void)
+{
+    if (thread != 0)
+    {
+        thread->join();
+        delete thread;
+        thread = 0;
+    }
+
+    if (failed)
+        throw cusp::runtime_exception(error);
+
+    return report;
+}
+
+template <typename IndexType, typename ValueType>
+void initializer<IndexType,ValueType>
+::execute(void * self)
+{
+    initializer * s = static_cast<initializer *>(self);
+
+    try
+    {
+        cusp::detail::scoped_device scope(s->device);
+        s->report = cusp::initialize<IndexType, ValueType>(s->kernels);
+    }
+    catch (std::exception& e)
+    {
+        s->failed = true;
+        s->error  = e.what();
+    }
+    catch (...)
+    {
+        s->failed = true;
+        s->error  = "unknown exception in initialization";
+    }
+}
+
+} // end namespace cusp
@@ -19,7 +19,11 @@
 #include <cusp/array1d.h>
 #include <cusp/array2d.h>
 #include <cusp/linear_operator.h>
+#include <cusp/multiply.h>
 
+#include <thrust/copy.h>
+
+#include <algorithm>
 #include <cmath>
 
 namespace cusp
@@ -27,63 +31,259 @@ namespace cusp
 namespace detail
 {
 
-template <typename IndexType, typename ValueType, typename MemorySpace, typename Orientation>
-int lu_factor(cusp::array2d<ValueType,MemorySpace,Orientation>& A,
-              cusp::array1d<IndexType,MemorySpace>& pivot)
+// Block size of the factorizations.  A panel of LU_BLOCK_SIZE columns is
+// factored at a time and the trailing submatrix is updated with the whole
+// panel, so each row of the trailing submatrix is traversed once per panel
+// instead of once per column.
+const int LU_BLOCK_SIZE = 64;
+
+// Blocked right-looking LU factorization with partial pivoting of a dense
+// row-major n x n matrix with row stride lda.  Row k was interchanged with
+// row pivot[k] at step k.  Returns -1 if the matrix is singular.
+template <typename ValueType, typename IndexType>
+int lu_factor_row_major(ValueType * A, IndexType * pivot, const int n, const int lda)
 {
-    const int n = A.num_rows;
+    for (int k0 = 0; k0 < n; k0 += LU_BLOCK_SIZE)
+    {
+        const int k1 = std::min(k0 + LU_BLOCK_SIZE, n);
 
-    // For each row and column, k = 0, ..., n-1,
-    for (int k = 0; k < n; k++)
+        // factor the panel A[k0:n, k0:k1]
+        for (int k = k0; k < k1; k++)
+        {
+            // find the pivot row
+            int p = k;
+            ValueType max = std::fabs(A[k * lda + k]);
+
+            for (int i = k + 1; i < n; i++)
+            {
+                if (max < std::fabs(A[i * lda + k]))
+                {
+                    max = std::fabs(A[i * lda + k]);
+                    p = i;
+                }
+            }
+
+            pivot[k] = p;
+
+            // interchange entire rows
+            if (p != k)
+                std::swap_ranges(A + k * lda, A + k * lda + n, A + p * lda);
+
+            // and if the matrix is singular, return error
+            if (A[k * lda + k] == ValueType(0))
+                return -1;
+
+            const ValueType inv_pivot = ValueType(1) / A[k * lda + k];
+
+            // compute column k of L and update the remaining panel columns
+            for (int i = k + 1; i < n; i++)
+            {
+                ValueType * row = A + i * lda;
+
+                row[k] *= inv_pivot;
+
+                const ValueType l = row[k];
+                const ValueType * u = A + k * lda;
+
+                for (int j = k + 1; j < k1; j++)
+                    row[j] -= l * u[j];
+            }
+        }
+
+        if (k1 == n)
+            break;
+
+        // U12 = L11^-1 A12
+        for (int i = k0 + 1; i < k1; i++)
+        {
+            ValueType * row = A + i * lda;
+
+            for (int p = k0; p < i; p++)
+            {
+                const ValueType l = row[p];
+                const ValueType * u = A + p * lda;
+
+                for (int j = k1; j < n; j++)
+                    row[j] -= l * u[j];
+            }
+        }
+
+        // A22 -= L21 U12
+#ifdef _OPENMP
+        #pragma omp parallel for
+#endif
+        for (int i = k1; i < n; i++)
+        {
+            ValueType * row = A + i * lda;
+
+            for (int p = k0; p < k1; p++)
+            {
+                const ValueType l = row[p];
+                const ValueType * u = A + p * lda;
+
+                for (int j = k1; j < n; j++)
+                    row[j] -= l * u[j];
+            }
+        }
+    }
+
+    return 0;
+}
+
+// Blocked right-looking Cholesky factorization A = L L^T of a dense
+// row-major symmetric positive definite n x n matrix with row stride lda.
+// L overwrites the lower triangle and the strict upper triangle is set to
+// zero.  Returns -1 if the matrix is not positive definite.
+template <typename ValueType>
+int cholesky_factor_row_major(ValueType * A, const int n, const int lda)
+{
+    for (int k0 = 0; k0 < n; k0 += LU_BLOCK_SIZE)
     {
-        // find the pivot row
-        pivot[k] = k;
-        ValueType max = std::fabs(A(k,k));
-        
-        for (int j = k + 1; j < n; j++)
+        const int k1 = std::min(k0 + LU_BLOCK_SIZE, n);
+
+        // factor the panel A[k0:n, k0:k1]
+        for (int k = k0; k < k1; k++)
         {
-            if (max < std::fabs(A(j,k)))
+            ValueType * row_k = A + k * lda;
+
+            ValueType d = row_k[k];
+            for (int p = k0; p < k; p++)
+                d -= row_k[p] * row_k[p];
+
+            if (!(d > ValueType(0)))
+                return -1;
+
+            row_k[k] = std::sqrt(d);
+
+            const ValueType inv_diagonal = ValueType(1) / row_k[k];
+
+            for (int i = k + 1; i < n; i++)
             {
-                max = std::fabs(A(j,k));
-                pivot[k] = j;
+                ValueType * row_i = A + i * lda;
+
+                ValueType sum = row_i[k];
+                for (int p = k0; p < k; p++)
+                    sum -= row_i[p] * row_k[p];
+
+                row_i[k] = sum * inv_diagonal;
             }
         }
 
-        // and if the pivot row differs from the current row, then
-        // interchange the two rows.
-        if (pivot[k] != k)
-            for (int j = 0; j < n; j++)
-                std::swap(A(k,j), A(pivot[k],j));
+        // A22 -= L21 L21^T (lower triangle)
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for (int i = k1; i < n; i++)
+        {
+            ValueType * row_i = A + i * lda;
+
+            for (int j = k1; j <= i; j++)
+            {
+                const ValueType * row_j = A + j * lda;
+
+                ValueType sum = ValueType(0);
+                for (int p = k0; p < k1; p++)
+                    sum += row_i[p] * row_j[p];
+
+                row_i[j] -= sum;
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+        for (int j = i + 1; j < n; j++)
+            A[i * lda + j] = ValueType(0);
 
-        // and if the matrix is singular, return error
-        if (A(k,k) == 0.0)
+    return 0;
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace, typename Orientation>
+int lu_factor(cusp::array2d<ValueType,MemorySpace,Orientation>& A,
+              cusp::array1d<IndexType,MemorySpace>& pivot)
+{
+    const int n = A.num_rows;
+
+    if (n == 0)
+        return 0;
+
+    // factor a contiguous row-major copy
+    cusp::array2d<ValueType,cusp::host_memory,cusp::row_major> LU(A);
+
+    cusp::array1d<IndexType,cusp::host_memory> P(n);
+
+    int status = lu_factor_row_major(thrust::raw_pointer_cast(&LU.values[0]), thrust::raw_pointer_cast(&P[0]), n, LU.pitch);
+
+    A = LU;
+    pivot = P;
+
+    return status;
+}
+
+template <typename ValueType, typename MemorySpace, typename Orientation>
+int cholesky_factor(cusp::array2d<ValueType,MemorySpace,Orientation>& A)
+{
+    const int n = A.num_rows;
+
+    if (n == 0)
+        return 0;
+
+    // factor a contiguous row-major copy
+    cusp::array2d<ValueType,cusp::host_memory,cusp::row_major> L(A);
+
+    int status = cholesky_factor_row_major(thrust::raw_pointer_cast(&L.values[0]), n, L.pitch);
+
+    A = L;
+
+    return status;
+}
+
+template <typename ValueType, typename MemorySpace, typename Orientation,
+          typename Array1, typename Array2>
+int cholesky_solve(const cusp::array2d<ValueType,MemorySpace,Orientation>& L,
+                   const Array1& b,
+                         Array2& x)
+{
+    const int n = L.num_rows;
+
+    // copy rhs to x
+    thrust::copy(b.begin(), b.end(), x.begin());
+
+    // Solve L y = b
+    for (int k = 0; k < n; k++)
+    {
+        for (int i = 0; i < k; i++)
+            x[k] -= L(k,i) * x[i];
+
+        if (L(k,k) == 0)
             return -1;
 
-        // otherwise find the lower triangular matrix elements for column k. 
-        for (int i = k + 1; i < n; i++)
-            A(i,k) /= A(k,k);
+        x[k] /= L(k,k);
+    }
 
-        // update remaining matrix
+    // Solve L^T x = y
+    for (int k = n - 1; k >= 0; k--)
+    {
         for (int i = k + 1; i < n; i++)
-            for (int j = k + 1; j < n; j++)
-                A(i,j) -= A(i,k) * A(k,j);
+            x[k] -= L(i,k) * x[i];
+
+        x[k] /= L(k,k);
     }
 
     return 0;
 }
 
 
-
-template <typename IndexType, typename ValueType, typename MemorySpace, typename Orientation>
+template <typename IndexType, typename ValueType, typename MemorySpace, typename Orientation,
+          typename Array1, typename Array2>
 int lu_solve(const cusp::array2d<ValueType,MemorySpace,Orientation>& A,
              const cusp::array1d<IndexType,MemorySpace>& pivot,
-             const cusp::array1d<ValueType,MemorySpace>& b,
-                   cusp::array1d<ValueType,MemorySpace>& x)
+             const Array1& b,
+                   Array2& x)
 {
     const int n = A.num_rows;
    
     // copy rhs to x
-    x = b;
+    thrust::copy(b.begin(), b.end(), x.begin());
 
     // Solve the linear equation Lx = b for x, where L is a lower
     // triangular matrix with an implied 1 along the diagonal.
@@ -113,19 +313,62 @@ int lu_solve(const cusp::array2d<ValueType,MemorySpace,Orientation>& A,
 }
 
 
+// Dense direct solver for small systems.  The matrix is factored on the
+// host.  On the device the explicit inverse, formed from the factors at
+// construction, is kept as a dense array2d and applied with a single GEMV
+// so that a solve needs no host-device transfer or synchronization.  The
+// inverse takes n*n values, the same as the factors.
 template <typename ValueType, typename MemorySpace>
 class lu_solver : public cusp::linear_operator<ValueType,MemorySpace>
 {
     cusp::array2d<ValueType,cusp::host_memory> lu;
     cusp::array1d<int,cusp::host_memory>       pivot;
 
+    // inverse of the matrix (device only)
+    cusp::array2d<ValueType,MemorySpace> inverse;
+
+    void setup(cusp::host_memory) {}
+
+    void setup(cusp::device_memory)
+    {
+        const int n = lu.num_rows;
+
+        cusp::array2d<ValueType,cusp::host_memory> A_inv(n, n);
+        cusp::array1d<ValueType,cusp::host_memory> e(n, ValueType(0));
+        cusp::array1d<ValueType,cusp::host_memory> column(n);
+
+        for (int j = 0; j < n; j++)
+        {
+            e[j] = ValueType(1);
+            lu_solve(lu, pivot, e, column);
+            e[j] = ValueType(0);
+
+            for (int i = 0; i < n; i++)
+                A_inv(i,j) = column[i];
+        }
+
+        inverse = A_inv;
+    }
+
+    template <typename VectorType1, typename VectorType2>
+    void solve(const VectorType1& x, VectorType2& y, cusp::host_memory) const
+    {
+        lu_solve(lu, pivot, x, y);
+    }
+
+    template <typename VectorType1, typename VectorType2>
+    void solve(const VectorType1& x, VectorType2& y, cusp::device_memory) const
+    {
+        cusp::multiply(inverse, x, y);
+    }
+
     public:
     lu_solver()
         : linear_operator<ValueType,MemorySpace>()
     { }
 
-    template <typename Orientation>
-    lu_solver(const cusp::array2d<ValueType,MemorySpace,Orientation>& A) 
+    template <typename MemorySpace2, typename Orientation>
+    lu_solver(const cusp::array2d<ValueType,MemorySpace2,Orientation>& A) 
         : linear_operator<ValueType,MemorySpace>(A.num_rows, A.num_cols, A.num_entries)
     {
         CUSP_PROFILE_SCOPED();
@@ -134,15 +377,31 @@ class lu_solver : public cusp::linear_operator<ValueType,MemorySpace>
         lu = A;
         pivot.resize(A.num_rows);
         lu_factor(lu,pivot);
+
+        setup(MemorySpace());
     }
+
+    // reuse the factors and pivots of an earlier factorization
+    lu_solver(const cusp::array2d<ValueType,cusp::host_memory>& LU,
+              const cusp::array1d<int,cusp::host_memory>& P)
+        : linear_operator<ValueType,MemorySpace>(LU.num_rows, LU.num_cols, LU.num_entries),
+          lu(LU), pivot(P)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        setup(MemorySpace());
+    }
+
+    const cusp::array2d<ValueType,cusp::host_memory>& factors(void) const { return lu; }
+
+    const cusp::array1d<int,cusp::host_memory>& pivots(void) const { return pivot; }
    
-    // TODO handle host and device
     template <typename VectorType1, typename VectorType2>
     void operator()(const VectorType1& x, VectorType2& y) const
     {
         CUSP_PROFILE_SCOPED();
 
-        lu_solve(lu, pivot, x, y);
+        solve(x, y, MemorySpace());
     }
 };
 
@@ -0,0 +1,263 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/convert.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/format.h>
+#include <cusp/transpose.h>
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/implicit_copy.h>
+#include <cusp/detail/profiler.h>
+
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/functional.h>
+#include <thrust/transform.h>
+#include <thrust/detail/type_traits.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// (A x)[i]
+template <typename IndexType, typename MatrixValueType, typename ValueType>
+struct masked_spmv_row
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const MatrixValueType * values;
+    const ValueType * x;
+
+    masked_spmv_row(const IndexType * row_offsets, const IndexType * column_indices, const MatrixValueType * values, const ValueType * x)
+        : row_offsets(row_offsets), column_indices(column_indices), values(values), x(x) {}
+
+    __host__ __device__
+    ValueType operator()(const IndexType i) const
+    {
+        ValueType sum = 0;
+
+        for (IndexType jj = row_offsets[i]; jj < row_offsets[i + 1]; jj++)
+            sum += ValueType(values[jj]) * x[column_indices[jj]];
+
+        return sum;
+    }
+};
+
+// (stored, sum) of the dot product of row i of A and row j of B^T, whose
+// column indices are sorted
+template <typename IndexType, typename ValueType1, typename ValueType2, typename ValueType>
+struct masked_spgemm_entry
+{
+    const IndexType * A_row_offsets;
+    const IndexType * A_column_indices;
+    const ValueType1 * A_values;
+    const IndexType * Bt_row_offsets;
+    const IndexType * Bt_column_indices;
+    const ValueType2 * Bt_values;
+
+    masked_spgemm_entry(const IndexType * A_row_offsets, const IndexType * A_column_indices, const ValueType1 * A_values,
+                        const IndexType * Bt_row_offsets, const IndexType * Bt_column_indices, const ValueType2 * Bt_values)
+        : A_row_offsets(A_row_offsets), A_column_indices(A_column_indices), A_values(A_values),
+          Bt_row_offsets(Bt_row_offsets), Bt_column_indices(Bt_column_indices), Bt_values(Bt_values) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    thrust::tuple<bool,ValueType> operator()(const Tuple& t) const
+    {
+        const IndexType i = thrust::get<0>(t);
+        const IndexType j = thrust::get<1>(t);
+
+        IndexType a     = A_row_offsets[i];
+        IndexType a_end = A_row_offsets[i + 1];
+        IndexType b     = Bt_row_offsets[j];
+        IndexType b_end = Bt_row_offsets[j + 1];
+
+        bool stored = false;
+        ValueType sum = 0;
+
+        while (a < a_end && b < b_end)
+        {
+            const IndexType ka = A_column_indices[a];
+            const IndexType kb = Bt_column_indices[b];
+
+            if (ka < kb)
+            {
+                a++;
+            }
+            else if (kb < ka)
+            {
+                b++;
+            }
+            else
+            {
+                stored = true;
+                sum += ValueType(A_values[a]) * ValueType(Bt_values[b]);
+                a++;
+                b++;
+            }
+        }
+
+        return thrust::make_tuple(stored, sum);
+    }
+};
+
+// y[i] <- (A x)[i] for the rows i with mask[i] == true
+template <typename Matrix, typename Vector1, typename Vector2, typename Mask>
+void masked_spmv(const Matrix& A, const Vector1& x, Vector2& y, const Mask& mask,
+                 thrust::detail::true_type)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Matrix::value_type  MatrixValueType;
+    typedef typename Vector2::value_type ValueType;
+
+    if (mask.size() != A.num_rows)
+        throw cusp::invalid_input_exception("mask size must equal the number of rows");
+
+    thrust::transform_if(thrust::counting_iterator<IndexType>(0),
+                         thrust::counting_iterator<IndexType>(A.num_rows),
+                         mask.begin(),
+                         y.begin(),
+                         masked_spmv_row<IndexType,MatrixValueType,ValueType>
+                             (thrust::raw_pointer_cast(&A.row_offsets[0]),
+                              thrust::raw_pointer_cast(&A.column_indices[0]),
+                              thrust::raw_pointer_cast(&A.values[0]),
+                              thrust::raw_pointer_cast(&x[0])),
+                         thrust::identity<bool>());
+}
+
+// y[i] <- (A x)[i] for the rows i listed in mask
+template <typename Matrix, typename Vector1, typename Vector2, typename Mask>
+void masked_spmv(const Matrix& A, const Vector1& x, Vector2& y, const Mask& mask,
+                 thrust::detail::false_type)
+{
+    typedef typename Matrix::index_type  IndexType;
+    typedef typename Matrix::value_type  MatrixValueType;
+    typedef typename Vector2::value_type ValueType;
+
+    thrust::transform(mask.begin(), mask.end(),
+                      thrust::make_permutation_iterator(y.begin(), mask.begin()),
+                      masked_spmv_row<IndexType,MatrixValueType,ValueType>
+                          (thrust::raw_pointer_cast(&A.row_offsets[0]),
+                           thrust::raw_pointer_cast(&A.column_indices[0]),
+                           thrust::raw_pointer_cast(&A.values[0]),
+                           thrust::raw_pointer_cast(&x[0])));
+}
+
+template <typename Matrix, typename Vector1, typename Vector2, typename Mask>
+void masked_multiply(const Matrix& A, const Vector1& x, Vector2& y, const Mask& mask,
+                     cusp::array1d_format)
+{
+    typedef typename Matrix::memory_space MemorySpace;
+
+    if (A.num_cols != x.size() || A.num_rows != y.size())
+        throw cusp::invalid_input_exception("matrix and vector dimensions are incompatible");
+
+    // other formats use CSR
+    const cusp::detail::csr_operand<Matrix,MemorySpace> A_(A);
+
+    cusp::detail::masked_spmv(A_.get(), x, y, mask,
+                              typename thrust::detail::is_same<typename Mask::value_type, bool>::type());
+}
+
+// C <- M .* (A B)
+template <typename Matrix1, typename Matrix2, typename Matrix3, typename Mask>
+void masked_multiply(const Matrix1& A, const Matrix2& B, Matrix3& C, const Mask& M,
+                     cusp::sparse_format)
+{
+    typedef typename Matrix3::index_type   IndexType;
+    typedef typename Matrix3::value_type   ValueType;
+    typedef typename Matrix1::memory_space MemorySpace;
+
+    if (A.num_cols != B.num_rows)
+        throw cusp::invalid_input_exception("matrix dimensions are incompatible");
+
+    if (M.num_rows != A.num_rows || M.num_cols != B.num_cols)
+        throw cusp::invalid_input_exception("mask dimensions must equal the dimensions of the product");
+
+    const cusp::detail::csr_operand<Matrix1,MemorySpace> A_(A);
+    const cusp::detail::csr_operand<Matrix2,MemorySpace> B_(B);
+    const cusp::detail::csr_operand<Mask,MemorySpace>    M_(M);
+
+    // the columns of B are the rows of B^T
+    cusp::csr_matrix<typename Matrix2::index_type,typename Matrix2::value_type,MemorySpace> Bt;
+    cusp::transpose(B_.get(), Bt);
+
+    const size_t N = M_.get().num_entries;
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> C_(A.num_rows, B.num_cols, 0);
+
+    if (N > 0 && A.num_entries > 0 && Bt.num_entries > 0)
+    {
+        typedef typename Matrix1::value_type ValueType1;
+        typedef typename Matrix2::value_type ValueType2;
+        typedef typename Matrix1::index_type MatrixIndexType;
+
+        cusp::array1d<MatrixIndexType,MemorySpace> rows(N);
+        cusp::detail::offsets_to_indices(M_.get().row_offsets, rows);
+
+        cusp::array1d<bool,MemorySpace>      flags(N);
+        cusp::array1d<ValueType,MemorySpace> sums(N);
+
+        thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), M_.get().column_indices.begin())),
+                          thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   M_.get().column_indices.end())),
+                          thrust::make_zip_iterator(thrust::make_tuple(flags.begin(), sums.begin())),
+                          masked_spgemm_entry<MatrixIndexType,ValueType1,ValueType2,ValueType>
+                              (thrust::raw_pointer_cast(&A_.get().row_offsets[0]),
+                               thrust::raw_pointer_cast(&A_.get().column_indices[0]),
+                               thrust::raw_pointer_cast(&A_.get().values[0]),
+                               thrust::raw_pointer_cast(&Bt.row_offsets[0]),
+                               thrust::raw_pointer_cast(&Bt.column_indices[0]),
+                               thrust::raw_pointer_cast(&Bt.values[0])));
+
+        const size_t num_entries = thrust::count(flags.begin(), flags.end(), true);
+
+        C_.resize(A.num_rows, B.num_cols, num_entries);
+
+        thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), M_.get().column_indices.begin(), sums.begin())),
+                        thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   M_.get().column_indices.end(),   sums.end())),
+                        flags.begin(),
+                        thrust::make_zip_iterator(thrust::make_tuple(C_.row_indices.begin(), C_.column_indices.begin(), C_.values.begin())),
+                        thrust::identity<bool>());
+    }
+
+    cusp::convert(C_, C);
+}
+
+} // end namespace detail
+
+template <typename Matrix,
+          typename MatrixOrVector1,
+          typename MatrixOrVector2,
+          typename Mask>
+void masked_multiply(const Matrix&          A,
+                     const MatrixOrVector1& B,
+                           MatrixOrVector2& C,
+                     const Mask&            mask)
+{
+    CUSP_PROFILE_SCOPED();
+
+    cusp::detail::masked_multiply(A, B, C, mask,
+                                  typename MatrixOrVector1::format());
+}
+
+} // end namespace cusp
@@ -0,0 +1,312 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file matrix_powers.inl
+ *  \brief Inline file for matrix_powers.h
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/exception.h>
+#include <cusp/format.h>
+#include <cusp/multiply.h>
+#include <cusp/detail/profiler.h>
+#include <cusp/detail/device/matrix_powers.h>
+
+#include <thrust/copy.h>
+#include <thrust/functional.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/iterator/counting_iterator.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace cusp
+{
+namespace detail
+{
+
+// rows per tile of the tiled products, one thread per row on the device
+const size_t MATRIX_POWERS_TILE_ROWS = 256;
+
+// largest size of the two buffers of a tile
+const size_t MATRIX_POWERS_TILE_BYTES = 16384;
+
+// (A v)[i] of a CSR matrix, where buffer[0] holds v[lo]
+template <typename IndexType, typename MatrixValueType>
+struct matrix_powers_csr_row
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const MatrixValueType * values;
+
+    matrix_powers_csr_row(const IndexType * row_offsets, const IndexType * column_indices, const MatrixValueType * values)
+        : row_offsets(row_offsets), column_indices(column_indices), values(values) {}
+
+    template <typename ValueType>
+    __host__ __device__
+    ValueType operator()(const IndexType i, const ValueType * buffer, const IndexType lo) const
+    {
+        ValueType sum = ValueType(0);
+
+        for (IndexType jj = row_offsets[i]; jj < row_offsets[i + 1]; jj++)
+            sum += ValueType(values[jj]) * buffer[column_indices[jj] - lo];
+
+        return sum;
+    }
+};
+
+// (A v)[i] of a DIA matrix, where buffer[0] holds v[lo]
+template <typename IndexType, typename MatrixValueType>
+struct matrix_powers_dia_row
+{
+    const IndexType * diagonal_offsets;
+    const MatrixValueType * values;
+    IndexType num_diagonals;
+    IndexType pitch;
+    IndexType num_cols;
+
+    matrix_powers_dia_row(const IndexType * diagonal_offsets, const MatrixValueType * values,
+                          IndexType num_diagonals, IndexType pitch, IndexType num_cols)
+        : diagonal_offsets(diagonal_offsets), values(values),
+          num_diagonals(num_diagonals), pitch(pitch), num_cols(num_cols) {}
+
+    template <typename ValueType>
+    __host__ __device__
+    ValueType operator()(const IndexType i, const ValueType * buffer, const IndexType lo) const
+    {
+        ValueType sum = ValueType(0);
+
+        for (IndexType d = 0; d < num_diagonals; d++)
+        {
+            const IndexType offset = diagonal_offsets[d];
+
+            // entries outside the matrix are skipped
+            if ((offset < 0 && i < -offset) || (offset > 0 && i + offset >= num_cols))
+                continue;
+
+            sum += ValueType(values[d * pitch + i]) * buffer[i + offset - lo];
+        }
+
+        return sum;
+    }
+};
+
+// largest |i - j| over the entries of row i
+template <typename IndexType>
+struct csr_row_bandwidth : public thrust::unary_function<IndexType,IndexType>
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+
+    csr_row_bandwidth(const IndexType * row_offsets, const IndexType * column_indices)
+        : row_offsets(row_offsets), column_indices(column_indices) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType i) const
+    {
+        IndexType bandwidth = 0;
+
+        for (IndexType jj = row_offsets[i]; jj < row_offsets[i + 1]; jj++)
+        {
+            const IndexType j = column_indices[jj];
+            const IndexType distance = j > i ? j - i : i - j;
+
+            if (distance > bandwidth)
+                bandwidth = distance;
+        }
+
+        return bandwidth;
+    }
+};
+
+template <typename Array>
+const typename Array::value_type * matrix_powers_pointer(const Array& a)
+{
+    return a.empty() ? 0 : thrust::raw_pointer_cast(&a[0]);
+}
+
+// whether the ghost zones of a band of the given width fit in a tile
+template <typename ValueType>
+bool matrix_powers_tiled(const size_t bandwidth, const size_t s)
+{
+    const size_t ghost = s * bandwidth;
+
+    return ghost <= MATRIX_POWERS_TILE_ROWS &&
+           2 * (MATRIX_POWERS_TILE_ROWS + 2 * ghost) * sizeof(ValueType) <= MATRIX_POWERS_TILE_BYTES;
+}
+
+template <typename RowProduct, typename IndexType, typename ValueType>
+void matrix_powers_tiles(RowProduct row, const IndexType num_rows, const IndexType bandwidth, const IndexType s,
+                         const ValueType * x, ValueType * V, const IndexType pitch,
+                         cusp::host_memory)
+{
+    const IndexType tile_rows = MATRIX_POWERS_TILE_ROWS;
+    const IndexType ghost     = s * bandwidth;
+
+    std::vector<ValueType> buffers[2];
+
+    for (IndexType r0 = 0; r0 < num_rows; r0 += tile_rows)
+    {
+        const IndexType r1 = std::min(r0 + tile_rows, num_rows);
+        const IndexType lo = r0 > ghost ? r0 - ghost : 0;
+        const IndexType hi = std::min(r1 + ghost, num_rows);
+
+        buffers[0].assign(x + lo, x + hi);
+        buffers[1].resize(hi - lo);
+
+        for (IndexType k = 1; k <= s; k++)
+        {
+            const ValueType * in  = &buffers[(k - 1) % 2][0];
+                  ValueType * out = &buffers[k % 2][0];
+
+            // rows on which the remaining steps depend
+            const IndexType reach = (s - k) * bandwidth;
+            const IndexType a     = r0 > reach ? r0 - reach : 0;
+            const IndexType b     = std::min(r1 + reach, num_rows);
+
+            for (IndexType i = a; i < b; i++)
+            {
+                const ValueType sum = row(i, in, lo);
+
+                out[i - lo] = sum;
+
+                if (r0 <= i && i < r1)
+                    V[size_t(k) * pitch + i] = sum;
+            }
+        }
+    }
+}
+
+template <typename RowProduct, typename IndexType, typename ValueType>
+void matrix_powers_tiles(RowProduct row, const IndexType num_rows, const IndexType bandwidth, const IndexType s,
+                         const ValueType * x, ValueType * V, const IndexType pitch,
+                         cusp::device_memory)
+{
+    cusp::detail::device::matrix_powers_tiles(row, num_rows, bandwidth, s, IndexType(MATRIX_POWERS_TILE_ROWS), x, V, pitch);
+}
+
+// one product per step
+template <typename Matrix, typename Array2d>
+void matrix_powers_multiply(const Matrix& A, Array2d& V, const size_t s)
+{
+    typedef typename Array2d::column_view Column;
+
+    for (size_t k = 1; k <= s; k++)
+    {
+        Column x = V.column(k - 1);
+        Column y = V.column(k);
+        cusp::multiply(A, x, y);
+    }
+}
+
+template <typename Matrix, typename Array2d, typename Format>
+void matrix_powers(const Matrix& A, Array2d& V, const size_t s, Format)
+{
+    matrix_powers_multiply(A, V, s);
+}
+
+template <typename Matrix, typename Array2d>
+void matrix_powers(const Matrix& A, Array2d& V, const size_t s, cusp::csr_format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   MatrixValueType;
+    typedef typename Array2d::value_type  ValueType;
+    typedef typename Array2d::memory_space MemorySpace;
+
+    const IndexType * Ap = matrix_powers_pointer(A.row_offsets);
+    const IndexType * Aj = matrix_powers_pointer(A.column_indices);
+
+    // a pass over the column indices, the values are not read
+    const size_t bandwidth = thrust::transform_reduce(thrust::counting_iterator<IndexType>(0),
+                                                      thrust::counting_iterator<IndexType>(A.num_rows),
+                                                      csr_row_bandwidth<IndexType>(Ap, Aj),
+                                                      IndexType(0),
+                                                      thrust::maximum<IndexType>());
+
+    if (!matrix_powers_tiled<ValueType>(bandwidth, s))
+    {
+        matrix_powers_multiply(A, V, s);
+        return;
+    }
+
+    ValueType * Vx = thrust::raw_pointer_cast(&V.values[0]);
+
+    matrix_powers_tiles(matrix_powers_csr_row<IndexType,MatrixValueType>(Ap, Aj, matrix_powers_pointer(A.values)),
+                        IndexType(A.num_rows), IndexType(bandwidth), IndexType(s),
+                        Vx, Vx, IndexType(V.pitch), MemorySpace());
+}
+
+template <typename Matrix, typename Array2d>
+void matrix_powers(const Matrix& A, Array2d& V, const size_t s, cusp::dia_format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   MatrixValueType;
+    typedef typename Array2d::value_type  ValueType;
+    typedef typename Array2d::memory_space MemorySpace;
+
+    cusp::array1d<IndexType,cusp::host_memory> offsets(A.diagonal_offsets);
+
+    size_t bandwidth = 0;
+    for (size_t d = 0; d < offsets.size(); d++)
+        bandwidth = std::max<size_t>(bandwidth, offsets[d] < 0 ? -offsets[d] : offsets[d]);
+
+    if (!matrix_powers_tiled<ValueType>(bandwidth, s))
+    {
+        matrix_powers_multiply(A, V, s);
+        return;
+    }
+
+    ValueType * Vx = thrust::raw_pointer_cast(&V.values[0]);
+
+    matrix_powers_tiles(matrix_powers_dia_row<IndexType,MatrixValueType>(matrix_powers_pointer(A.diagonal_offsets),
+                                                                         matrix_powers_pointer(A.values.values),
+                                                                         IndexType(offsets.size()), IndexType(A.values.pitch), IndexType(A.num_cols)),
+                        IndexType(A.num_rows), IndexType(bandwidth), IndexType(s),
+                        Vx, Vx, IndexType(V.pitch), MemorySpace());
+}
+
+} // end namespace detail
+
+template <typename Matrix,
+          typename Vector,
+          typename ValueType,
+          typename MemorySpace>
+void matrix_powers(const Matrix& A,
+                   const Vector& x,
+                   const size_t  s,
+                   cusp::array2d<ValueType,MemorySpace,cusp::column_major>& V)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (A.num_rows != A.num_cols)
+        throw cusp::invalid_input_exception("matrix_powers requires a square matrix");
+
+    if (x.size() != A.num_cols)
+        throw cusp::invalid_input_exception("array dimensions do not match");
+
+    V.resize(A.num_rows, s + 1);
+
+    thrust::copy(x.begin(), x.end(), V.values.begin());
+
+    if (s == 0 || A.num_rows == 0)
+        return;
+
+    cusp::detail::matrix_powers(A, V, s, typename Matrix::format());
+}
+
+} // end namespace cusp
+
@@ -23,6 +23,11 @@
 #include <thrust/device_malloc_allocator.h>
 #endif
 
+#include <cusp/caching_allocator.h>
+#include <cusp/managed_allocator.h>
+#include <cusp/pinned_allocator.h>
+#include <cusp/detail/memory_tracker.h>
+
 namespace cusp
 {
 namespace detail
@@ -38,6 +43,56 @@ namespace detail
   struct minimum_space_impl<MemorySpace,any_memory>  { typedef MemorySpace type; };
   template <>
   struct minimum_space_impl<any_memory,any_memory>   { typedef any_memory  type; };
+
+  // an allocator passed in place of a memory space is rebound to T
+  template <typename Alloc, typename T>
+  struct rebind_allocator { typedef typename Alloc::template rebind<T>::other type; };
+
+  // the memory space of the storage obtained from an allocator
+  template <typename Alloc>
+  struct allocator_memory_space
+  {
+#if THRUST_VERSION >= 100600
+    typedef typename thrust::iterator_system<typename Alloc::pointer>::type type;
+#else
+    typedef typename thrust::iterator_space<typename Alloc::pointer>::type type;
+#endif
+  };
+
+  template <typename MemorySpace>
+  struct memory_space_of
+    : thrust::detail::eval_if<
+        thrust::detail::is_convertible<MemorySpace, host_memory>::value   ||
+        thrust::detail::is_convertible<MemorySpace, device_memory>::value ||
+        thrust::detail::is_convertible<MemorySpace, any_memory>::value,
+
+        thrust::detail::identity_< MemorySpace >,
+
+        allocator_memory_space< MemorySpace >
+      >
+  {};
+
+#if defined(CUSP_USE_CACHING_ALLOCATOR)
+  template <typename T>
+  struct default_device_allocator { typedef cusp::caching_device_allocator<T> type; };
+#else
+  template <typename T>
+  struct default_device_allocator { typedef cusp::detail::tracking_device_allocator<T> type; };
+#endif
+
+  // memory space of short-lived device temporaries, which are taken from
+  // the caching allocator so that repeated calls reuse the same blocks
+  template <typename T, typename MemorySpace>
+  struct temporary_memory_space
+    : thrust::detail::eval_if<
+        thrust::detail::is_convertible<MemorySpace, device_memory>::value &&
+        !thrust::detail::is_convertible<MemorySpace, host_memory>::value,
+
+        thrust::detail::identity_< cusp::caching_device_allocator<T> >,
+
+        thrust::detail::identity_< MemorySpace >
+      >
+  {};
   
 } // end namespace detail
    
@@ -53,9 +108,10 @@ namespace detail
           thrust::detail::eval_if<
             thrust::detail::is_convertible<MemorySpace, device_memory>::value,
   
-            thrust::detail::identity_< thrust::device_malloc_allocator<T> >,
+            detail::default_device_allocator<T>,
   
-            thrust::detail::identity_< MemorySpace >
+            // any other type is an allocator
+            detail::rebind_allocator<MemorySpace, T>
           >
         >
   {};
@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/detail/memory_tracker.h>
+#include <cusp/detail/storage_arrays.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+struct footprint_op
+{
+    size_t total;
+
+    footprint_op(void) : total(0) {}
+
+    template <typename Array>
+    void operator()(const Array& a)
+    {
+        typedef typename Array::value_type ValueType;
+
+        total += a.capacity() * sizeof(ValueType);
+    }
+};
+
+} // end namespace detail
+
+template <typename MatrixOrVector>
+size_t memory_footprint(const MatrixOrVector& A)
+{
+    cusp::detail::footprint_op op;
+
+    cusp::detail::for_each_storage_array(A, op);
+
+    return op.total;
+}
+
+inline device_memory_statistics get_device_memory_statistics(void)
+{
+    cusp::detail::device_memory_tracker& tracker = cusp::detail::get_device_memory_tracker();
+
+    device_memory_statistics stats;
+    stats.bytes_in_use      = tracker.bytes_in_use();
+    stats.peak_bytes_in_use = tracker.peak_bytes_in_use();
+
+    return stats;
+}
+
+inline void reset_device_memory_peak(void)
+{
+    cusp::detail::get_device_memory_tracker().reset_peak();
+}
+
+} // end namespace cusp
+
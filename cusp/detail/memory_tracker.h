@@ -0,0 +1,166 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/device_malloc_allocator.h>
+#include <thrust/device_ptr.h>
+
+#include <cusp/detail/mutex.h>
+
+#include <cstddef>
+#include <algorithm>
+
+// High-water mark of the device memory held by Cusp's allocators.
+//
+// The caching pool and the default device allocator report every
+// allocation and release to a single tracker, which keeps the bytes in
+// use, their peak since the last reset and the peak of the innermost open
+// window.  The profiler opens a window when a scope is entered and closes
+// it when the scope exits, which yields the peak of each scope.  The
+// tracker is process-wide: a scope is charged with the allocations of all
+// host threads while it is open.  Memory obtained from cudaMalloc
+// directly, e.g. by Thrust's temporaries, is not seen.
+
+namespace cusp
+{
+namespace detail
+{
+
+class device_memory_tracker
+{
+    size_t in_use;
+    size_t peak;
+    size_t window_peak;
+
+    pool_mutex mutex;
+
+    public:
+
+    device_memory_tracker(void) : in_use(0), peak(0), window_peak(0) {}
+
+    void allocated(const size_t bytes)
+    {
+        pool_lock lock(mutex);
+
+        in_use     += bytes;
+        peak        = std::max(peak, in_use);
+        window_peak = std::max(window_peak, in_use);
+    }
+
+    void freed(const size_t bytes)
+    {
+        pool_lock lock(mutex);
+
+        in_use -= std::min(in_use, bytes);
+    }
+
+    size_t bytes_in_use(void)
+    {
+        pool_lock lock(mutex);
+        return in_use;
+    }
+
+    size_t peak_bytes_in_use(void)
+    {
+        pool_lock lock(mutex);
+        return peak;
+    }
+
+    void reset_peak(void)
+    {
+        pool_lock lock(mutex);
+
+        peak        = in_use;
+        window_peak = in_use;
+    }
+
+    // start a nested window, the returned peak of the enclosing window
+    // must be passed to close_window
+    size_t open_window(void)
+    {
+        pool_lock lock(mutex);
+
+        const size_t outer = window_peak;
+        window_peak = in_use;
+
+        return outer;
+    }
+
+    // peak of the window that is closed, which also counts toward the
+    // enclosing window
+    size_t close_window(const size_t outer)
+    {
+        pool_lock lock(mutex);
+
+        const size_t inner = window_peak;
+        window_peak = std::max(outer, inner);
+
+        return inner;
+    }
+};
+
+// the tracker outlives every allocator and is never destroyed
+inline device_memory_tracker& get_device_memory_tracker(void)
+{
+    static once_value<device_memory_tracker *> tracker;
+    return *initialize_once(tracker, new_instance<device_memory_tracker>);
+}
+
+// thrust::device_malloc_allocator reporting to the tracker
+template <typename T>
+class tracking_device_allocator : public thrust::device_malloc_allocator<T>
+{
+    typedef thrust::device_malloc_allocator<T> super_t;
+
+    public:
+
+    typedef typename super_t::pointer   pointer;
+    typedef typename super_t::size_type size_type;
+
+    template <typename U>
+    struct rebind { typedef tracking_device_allocator<U> other; };
+
+    tracking_device_allocator(void) {}
+
+    tracking_device_allocator(const tracking_device_allocator&) : super_t() {}
+
+    template <typename U>
+    tracking_device_allocator(const tracking_device_allocator<U>&) {}
+
+    pointer allocate(size_type n)
+    {
+        pointer p = super_t::allocate(n);
+        get_device_memory_tracker().allocated(n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+        super_t::deallocate(p, n);
+        get_device_memory_tracker().freed(n * sizeof(T));
+    }
+};
+
+template <typename T1, typename T2>
+bool operator==(const tracking_device_allocator<T1>&, const tracking_device_allocator<T2>&) { return true; }
+
+template <typename T1, typename T2>
+bool operator!=(const tracking_device_allocator<T1>&, const tracking_device_allocator<T2>&) { return false; }
+
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/format.h>
+#include <cusp/memory.h>
+#include <cusp/multiply.h>
+
+#include <cusp/detail/host/spmv_transpose.h>
+#include <cusp/detail/device/spmv/transpose.h>
+
+#include <thrust/detail/type_traits.h>
+
+// Transfers between the levels of a multigrid cycle, fused with the
+// products around them.
+//
+// residual_and_restrict computes the coarse right-hand side P^T (b - A x)
+// in a single pass over the fine level when A and P are CSR matrices:
+// the residual of each row is scattered through the same row of P, so
+// it is never stored and read back.  Other formats compute the residual
+// into r and restrict it with the transposed product.
+//
+// prolong_and_correct adds the interpolated correction P x_coarse to x
+// in the epilogue of the product, rather than storing P x_coarse and
+// adding it with an axpy.
+
+namespace cusp
+{
+namespace detail
+{
+
+template <typename Matrix1, typename Vector1, typename Vector2, typename Matrix2, typename Vector3, typename Vector4,
+          typename Format1, typename Format2, typename MemorySpace>
+void residual_and_restrict(const Matrix1& A, const Vector1& x, const Vector2& b, const Matrix2& P,
+                           Vector3& r, Vector4& b_coarse,
+                           Format1, Format2, MemorySpace)
+{
+    cusp::residual(A, x, b, r);
+    cusp::multiply_transpose(P, r, b_coarse);
+}
+
+template <typename Matrix1, typename Vector1, typename Vector2, typename Matrix2, typename Vector3, typename Vector4>
+void residual_and_restrict(const Matrix1& A, const Vector1& x, const Vector2& b, const Matrix2& P,
+                           Vector3& r, Vector4& b_coarse,
+                           cusp::csr_format, cusp::csr_format, cusp::host_memory)
+{
+    cusp::detail::host::spmv_csr_residual_transpose(A, x, b, P, b_coarse);
+}
+
+template <typename Matrix1, typename Vector1, typename Vector2, typename Matrix2, typename Vector3, typename Vector4>
+void residual_and_restrict(const Matrix1& A, const Vector1& x, const Vector2& b, const Matrix2& P,
+                           Vector3& r, Vector4& b_coarse,
+                           thrust::detail::true_type)
+{
+    if (!cusp::detail::device::spmv_csr_residual_transpose(A,
+                                                           thrust::raw_pointer_cast(&x[0]),
+                                                           thrust::raw_pointer_cast(&b[0]),
+                                                           P,
+                                                           thrust::raw_pointer_cast(&b_coarse[0])))
+        residual_and_restrict(A, x, b, P, r, b_coarse, cusp::known_format(), cusp::known_format(), cusp::device_memory());
+}
+
+template <typename Matrix1, typename Vector1, typename Vector2, typename Matrix2, typename Vector3, typename Vector4>
+void residual_and_restrict(const Matrix1& A, const Vector1& x, const Vector2& b, const Matrix2& P,
+                           Vector3& r, Vector4& b_coarse,
+                           thrust::detail::false_type)
+{
+    residual_and_restrict(A, x, b, P, r, b_coarse, cusp::known_format(), cusp::known_format(), cusp::device_memory());
+}
+
+template <typename Matrix1, typename Vector1, typename Vector2, typename Matrix2, typename Vector3, typename Vector4>
+void residual_and_restrict(const Matrix1& A, const Vector1& x, const Vector2& b, const Matrix2& P,
+                           Vector3& r, Vector4& b_coarse,
+                           cusp::csr_format, cusp::csr_format, cusp::device_memory)
+{
+    typedef typename Vector4::value_type ValueType;
+
+    // the kernel reads every operand in the value and index types of A
+    typedef typename thrust::detail::integral_constant<bool,
+        thrust::detail::is_same<typename Matrix1::value_type, ValueType>::value &&
+        thrust::detail::is_same<typename Matrix2::value_type, ValueType>::value &&
+        thrust::detail::is_same<typename Vector1::value_type, ValueType>::value &&
+        thrust::detail::is_same<typename Vector2::value_type, ValueType>::value &&
+        thrust::detail::is_same<typename Matrix1::index_type, typename Matrix2::index_type>::value>::type Fused;
+
+    residual_and_restrict(A, x, b, P, r, b_coarse, Fused());
+}
+
+// b_coarse <- P^T (b - A x), r is the workspace of the unfused formats
+template <typename Matrix1, typename Vector1, typename Vector2, typename Matrix2, typename Vector3, typename Vector4>
+void residual_and_restrict(const Matrix1& A, const Vector1& x, const Vector2& b, const Matrix2& P,
+                           Vector3& r, Vector4& b_coarse)
+{
+    CUSP_PROFILE_SCOPED();
+
+    residual_and_restrict(A, x, b, P, r, b_coarse,
+                          typename Matrix1::format(),
+                          typename Matrix2::format(),
+                          typename Matrix1::memory_space());
+}
+
+// x <- x + P x_coarse
+template <typename Matrix, typename Vector1, typename Vector2>
+void prolong_and_correct(Matrix& P, Vector1& x_coarse, Vector2& x)
+{
+    typedef typename Vector2::value_type ValueType;
+
+    cusp::multiply(P, x_coarse, x, ValueType(1), ValueType(1));
+}
+
+} // end namespace detail
+} // end namespace cusp
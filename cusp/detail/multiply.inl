@@ -15,10 +15,18 @@
  */
 
 #include <cusp/detail/dispatch/multiply.h>
+#include <cusp/detail/operation_cost.h>
 
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
 #include <cusp/linear_operator.h>
+#include <cusp/prefetch.h>
+#include <cusp/detail/memory_tracker.h>
+#include <cusp/detail/spgemm_budget.h>
 #include <thrust/detail/type_traits.h>
 
+#include <algorithm>
+
 namespace cusp
 {
 namespace detail
@@ -44,6 +52,9 @@ void multiply(LinearOperator&  A,
               MatrixOrVector2& C,
               cusp::known_format)
 {
+  // migrate operands in managed memory to the device
+  cusp::detail::prefetch_product(A, B, C);
+
   // built-in format
   cusp::detail::dispatch::multiply(A, B, C,
                                    typename LinearOperator::memory_space(),
@@ -51,6 +62,247 @@ void multiply(LinearOperator&  A,
                                    typename MatrixOrVector2::memory_space());
 }
 
+template <typename LinearOperator,
+          typename MatrixOrVector1,
+          typename MatrixOrVector2>
+void multiply(LinearOperator&  A,
+              MatrixOrVector1& B,
+              MatrixOrVector2& C,
+              cusp::auto_format)
+{
+  // auto_format_matrix, multiply with the selected member
+  typedef typename LinearOperator::selection_type Selection;
+
+  switch (A.selection.format)
+  {
+    case Selection::csr: cusp::multiply(A.csr, B, C); break;
+    case Selection::dia: cusp::multiply(A.dia, B, C); break;
+    case Selection::ell: cusp::multiply(A.ell, B, C); break;
+    case Selection::hyb: cusp::multiply(A.hyb, B, C); break;
+    default: break;
+  }
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::known_format)
+{
+  cusp::detail::dispatch::multiply_transpose(A, B, C,
+                                             typename Matrix::memory_space(),
+                                             typename Vector1::memory_space(),
+                                             typename Vector2::memory_space());
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::auto_format)
+{
+  // auto_format_matrix, multiply with the selected member
+  typedef typename Matrix::selection_type Selection;
+
+  switch (A.selection.format)
+  {
+    case Selection::csr: cusp::multiply_transpose(A.csr, B, C); break;
+    case Selection::dia: cusp::multiply_transpose(A.dia, B, C); break;
+    case Selection::ell: cusp::multiply_transpose(A.ell, B, C); break;
+    case Selection::hyb: cusp::multiply_transpose(A.hyb, B, C); break;
+    default: break;
+  }
+}
+
+template <typename LinearOperator,
+          typename MatrixOrVector1,
+          typename MatrixOrVector2>
+void multiply(LinearOperator&  A,
+              MatrixOrVector1& B,
+              MatrixOrVector2& C,
+              cusp::transpose_format)
+{
+  // transpose_matrix_view, multiply with the transpose of the referenced matrix
+  cusp::multiply_transpose(A.matrix, B, C);
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::transpose_format)
+{
+  // the transpose of a transpose_matrix_view is the referenced matrix
+  cusp::multiply(A.matrix, B, C);
+}
+
+template <typename LinearOperator,
+          typename MatrixOrVector1,
+          typename MatrixOrVector2>
+void multiply_cached(LinearOperator&  A,
+                     MatrixOrVector1& B,
+                     MatrixOrVector2& C,
+                     cusp::array1d_format)
+{
+  cusp::multiply(A.hyb(), B, C);
+}
+
+template <typename LinearOperator,
+          typename MatrixOrVector1,
+          typename MatrixOrVector2>
+void multiply_cached(LinearOperator&  A,
+                     MatrixOrVector1& B,
+                     MatrixOrVector2& C,
+                     cusp::known_format)
+{
+  cusp::multiply(A.matrix, B, C);
+}
+
+template <typename LinearOperator,
+          typename MatrixOrVector1,
+          typename MatrixOrVector2>
+void multiply(LinearOperator&  A,
+              MatrixOrVector1& B,
+              MatrixOrVector2& C,
+              cusp::cached_format)
+{
+  // format_cache, SpMV with the cached HYB copy, other products with the matrix
+  cusp::detail::multiply_cached(A, B, C, typename MatrixOrVector1::format());
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cusp::cached_format)
+{
+  // format_cache, multiply with the cached transpose
+  cusp::multiply(A.transpose(), B, C);
+}
+
+template <typename LinearOperator,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(LinearOperator& A,
+                    Vector1&        x,
+                    Vector2&        z,
+                    Vector3&        y,
+                    ScalarType      alpha,
+                    ScalarType      beta,
+                    cusp::unknown_format)
+{
+  // user-defined LinearOperator, multiply into a temporary
+  typedef typename Vector3::value_type   ValueType;
+  typedef typename Vector3::memory_space MemorySpace;
+
+  cusp::array1d<ValueType,MemorySpace> temp(A.num_rows);
+
+  cusp::multiply(A, x, temp);
+
+  if (beta == ScalarType(0))
+  {
+    cusp::blas::copy(temp, y);
+    cusp::blas::scal(y, ValueType(alpha));
+  }
+  else
+  {
+    cusp::blas::axpby(temp, z, y, ValueType(alpha), ValueType(beta));
+  }
+}
+
+template <typename LinearOperator,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(LinearOperator& A,
+                    Vector1&        x,
+                    Vector2&        z,
+                    Vector3&        y,
+                    ScalarType      alpha,
+                    ScalarType      beta,
+                    cusp::known_format)
+{
+  // migrate operands in managed memory to the device
+  cusp::detail::prefetch_product(A, x, y);
+
+  // built-in format
+  cusp::detail::dispatch::multiply_axpby(A, x, z, y, alpha, beta,
+                                         typename LinearOperator::memory_space(),
+                                         typename Vector1::memory_space(),
+                                         typename Vector3::memory_space());
+}
+
+template <typename LinearOperator,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(LinearOperator& A,
+                    Vector1&        x,
+                    Vector2&        z,
+                    Vector3&        y,
+                    ScalarType      alpha,
+                    ScalarType      beta,
+                    cusp::auto_format)
+{
+  // auto_format_matrix, multiply with the selected member
+  typedef typename LinearOperator::selection_type Selection;
+
+  switch (A.selection.format)
+  {
+    case Selection::csr: cusp::detail::multiply_axpby(A.csr, x, z, y, alpha, beta, cusp::csr_format()); break;
+    case Selection::dia: cusp::detail::multiply_axpby(A.dia, x, z, y, alpha, beta, cusp::dia_format()); break;
+    case Selection::ell: cusp::detail::multiply_axpby(A.ell, x, z, y, alpha, beta, cusp::ell_format()); break;
+    case Selection::hyb: cusp::detail::multiply_axpby(A.hyb, x, z, y, alpha, beta, cusp::hyb_format()); break;
+    default: break;
+  }
+}
+
+template <typename LinearOperator,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(LinearOperator& A,
+                    Vector1&        x,
+                    Vector2&        z,
+                    Vector3&        y,
+                    ScalarType      alpha,
+                    ScalarType      beta,
+                    cusp::transpose_format)
+{
+  // transpose_matrix_view, the transposed product is not fused
+  cusp::detail::multiply_axpby(A, x, z, y, alpha, beta, cusp::unknown_format());
+}
+
+template <typename LinearOperator,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3,
+          typename ScalarType>
+void multiply_axpby(LinearOperator& A,
+                    Vector1&        x,
+                    Vector2&        z,
+                    Vector3&        y,
+                    ScalarType      alpha,
+                    ScalarType      beta,
+                    cusp::cached_format)
+{
+  // format_cache, the fused product of the cached HYB copy
+  cusp::detail::multiply_axpby(A.hyb(), x, z, y, alpha, beta, cusp::hyb_format());
+}
+
 } // end namespace detail
 
 template <typename LinearOperator,
@@ -60,7 +312,9 @@ void multiply(LinearOperator&  A,
               MatrixOrVector1& B,
               MatrixOrVector2& C)
 {
-  CUSP_PROFILE_SCOPED();
+  CUSP_PROFILE_SCOPED_NAME(cusp::detail::multiply_profile_name(typename LinearOperator::format()));
+  CUSP_PROFILE_BYTES(cusp::detail::multiply_cost(A, B).bytes);
+  CUSP_PROFILE_FLOPS(cusp::detail::multiply_cost(A, B).flops);
 
   // TODO check that dimensions are compatible
 
@@ -71,5 +325,109 @@ void multiply(LinearOperator&  A,
                          typename LinearOperator::format());
 }
 
+template <typename LinearOperator,
+          typename MatrixOrVector1,
+          typename MatrixOrVector2>
+void multiply(LinearOperator&  A,
+              MatrixOrVector1& B,
+              MatrixOrVector2& C,
+              cudaStream_t     stream)
+{
+  cusp::scoped_stream scope(stream);
+
+  cusp::multiply(A, B, C);
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void multiply(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::spgemm_workspace& workspace)
+{
+  cusp::detail::device_memory_tracker& tracker = cusp::detail::get_device_memory_tracker();
+
+  const size_t in_use     = tracker.bytes_in_use();
+  const size_t outer_peak = tracker.open_window();
+
+  cusp::detail::spgemm_budget budget = { workspace.budget_bytes, 0 };
+  {
+    cusp::detail::scoped_spgemm_budget scope(budget);
+
+    cusp::multiply(A, B, C);
+  }
+
+  const size_t peak = tracker.close_window(outer_peak);
+
+  workspace.peak_bytes = peak > in_use ? peak - in_use : 0;
+  workspace.num_slabs  = std::max<size_t>(budget.num_slabs, 1);
+}
+
+template <typename LinearOperator,
+          typename Vector1,
+          typename Vector2,
+          typename ScalarType>
+void multiply(LinearOperator& A,
+              Vector1&        x,
+              Vector2&        y,
+              ScalarType      alpha,
+              ScalarType      beta)
+{
+  CUSP_PROFILE_SCOPED_NAME(cusp::detail::multiply_profile_name(typename LinearOperator::format()));
+  CUSP_PROFILE_BYTES(cusp::detail::multiply_axpby_cost(A, x).bytes);
+  CUSP_PROFILE_FLOPS(cusp::detail::multiply_axpby_cost(A, x).flops);
+
+  cusp::detail::multiply_axpby(A, x, y, y, alpha, beta,
+                               typename LinearOperator::format());
+}
+
+template <typename LinearOperator,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3>
+void residual(LinearOperator& A,
+              Vector1&        x,
+              Vector2&        b,
+              Vector3&        r)
+{
+  CUSP_PROFILE_SCOPED();
+  CUSP_PROFILE_BYTES(cusp::detail::multiply_axpby_cost(A, x).bytes);
+  CUSP_PROFILE_FLOPS(cusp::detail::multiply_axpby_cost(A, x).flops);
+
+  typedef typename Vector3::value_type ValueType;
+
+  cusp::detail::multiply_axpby(A, x, b, r, ValueType(-1), ValueType(1),
+                               typename LinearOperator::format());
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C)
+{
+  CUSP_PROFILE_SCOPED();
+  CUSP_PROFILE_BYTES(cusp::detail::multiply_cost(A, B).bytes);
+  CUSP_PROFILE_FLOPS(cusp::detail::multiply_cost(A, B).flops);
+
+  cusp::detail::multiply_transpose(A, B, C,
+                                   typename Matrix::format());
+}
+
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& B,
+                              Vector2& C,
+                        cudaStream_t   stream)
+{
+  cusp::scoped_stream scope(stream);
+
+  cusp::multiply_transpose(A, B, C);
+}
+
 } // end namespace cusp
 
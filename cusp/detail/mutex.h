@@ -0,0 +1,156 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Mutex guarding the state shared by all host threads (the caching pool,
+// the memory tracker and the caches held by containers).
+//
+// Values that are computed on first use and then shared by all host
+// threads (device queries, environment switches and the singletons
+// above) are held by a once_value and read through initialize_once().
+// Function-local statics with dynamic initializers are only initialized
+// safely from several threads by C++11 compilers, and Cusp also supports
+// earlier ones (e.g. MSVC before 2015).  A once_value has no constructor,
+// so a static instance is zero-initialized before the program starts.
+// Its first initialize_once() computes the value, concurrent first calls
+// wait for it, and later calls return it.  Initializers may use other
+// once_values.  T must be default-constructible and assignable, and
+// singletons are held by pointer.
+
+namespace cusp
+{
+namespace detail
+{
+
+// minimal portable mutex
+class pool_mutex
+{
+#if defined(_WIN32)
+    CRITICAL_SECTION section;
+    public:
+    pool_mutex(void)  { InitializeCriticalSection(&section); }
+    ~pool_mutex(void) { DeleteCriticalSection(&section); }
+    void lock(void)   { EnterCriticalSection(&section); }
+    void unlock(void) { LeaveCriticalSection(&section); }
+#else
+    pthread_mutex_t mutex;
+    public:
+    pool_mutex(void)  { pthread_mutex_init(&mutex, 0); }
+    ~pool_mutex(void) { pthread_mutex_destroy(&mutex); }
+    void lock(void)   { pthread_mutex_lock(&mutex); }
+    void unlock(void) { pthread_mutex_unlock(&mutex); }
+#endif
+};
+
+class pool_lock
+{
+    pool_mutex& mutex;
+    public:
+    pool_lock(pool_mutex& m) : mutex(m) { mutex.lock(); }
+    ~pool_lock(void) { mutex.unlock(); }
+};
+
+template <typename T>
+struct once_value
+{
+    volatile long state;   // 0: empty, 1: being initialized, 2: initialized
+    T value;
+};
+
+// returns the previous state
+inline long once_compare_exchange(volatile long * state, const long expected, const long desired)
+{
+#if defined(_WIN32)
+    return InterlockedCompareExchange(state, desired, expected);
+#else
+    return __sync_val_compare_and_swap(state, expected, desired);
+#endif
+}
+
+inline void once_barrier(void)
+{
+#if defined(_WIN32)
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+inline void once_yield(void)
+{
+#if defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+// value.value <- init(), on the first call only
+template <typename T, typename Function>
+T& initialize_once(once_value<T>& value, Function init)
+{
+    while (value.state != 2)
+    {
+        if (once_compare_exchange(&value.state, 0, 1) != 0)
+        {
+            // another thread is initializing the value
+            once_yield();
+            continue;
+        }
+
+        try
+        {
+            value.value = init();
+        }
+        catch (...)
+        {
+            // a later call retries
+            once_barrier();
+            value.state = 0;
+            throw;
+        }
+
+        once_barrier();
+        value.state = 2;
+    }
+
+    once_barrier();
+
+    return value.value;
+}
+
+// initializer of a singleton held by a once_value<T *>, which is never
+// destroyed
+template <typename T>
+T * new_instance(void)
+{
+    return new T;
+}
+
+} // end namespace detail
+} // end namespace cusp
+
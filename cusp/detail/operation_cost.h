@@ -0,0 +1,228 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/format.h>
+
+#include <cstddef>
+
+// Memory traffic and floating point operations of the products, which the
+// profiler divides by the measured time to report the achieved bandwidth
+// and GFLOP/s of a scope.  The traffic follows the model of
+// performance/spmv/bytes_per_spmv.h: every stored entry and its index are
+// read once, x is read once per entry and y is read and written once per
+// row.  Reads of x that hit in cache are counted as well, so the figures
+// are upper bounds of the DRAM traffic.  Products of formats without a
+// model, and products with matrix operands, report no cost.
+
+namespace cusp
+{
+namespace detail
+{
+
+struct operation_cost
+{
+    size_t bytes;
+    size_t flops;
+
+    operation_cost(void) : bytes(0), flops(0) {}
+    operation_cost(size_t bytes, size_t flops) : bytes(bytes), flops(flops) {}
+};
+
+// scope names of the products, per format of A
+inline const char * multiply_profile_name(cusp::known_format)   { return "cusp::multiply"; }
+inline const char * multiply_profile_name(cusp::unknown_format) { return "cusp::multiply<linear_operator>"; }
+inline const char * multiply_profile_name(cusp::array2d_format) { return "cusp::multiply<array2d>"; }
+inline const char * multiply_profile_name(cusp::coo_format)     { return "cusp::multiply<coo>"; }
+inline const char * multiply_profile_name(cusp::csr_format)     { return "cusp::multiply<csr>"; }
+inline const char * multiply_profile_name(cusp::dia_format)     { return "cusp::multiply<dia>"; }
+inline const char * multiply_profile_name(cusp::ell_format)     { return "cusp::multiply<ell>"; }
+inline const char * multiply_profile_name(cusp::hyb_format)     { return "cusp::multiply<hyb>"; }
+inline const char * multiply_profile_name(cusp::bsr_format)     { return "cusp::multiply<bsr>"; }
+inline const char * multiply_profile_name(cusp::sell_format)    { return "cusp::multiply<sell>"; }
+inline const char * multiply_profile_name(cusp::jds_format)     { return "cusp::multiply<jds>"; }
+inline const char * multiply_profile_name(cusp::csr16_format)   { return "cusp::multiply<csr16>"; }
+inline const char * multiply_profile_name(cusp::dia_coo_format) { return "cusp::multiply<dia_coo>"; }
+inline const char * multiply_profile_name(cusp::split_complex_format) { return "cusp::multiply<split_complex>"; }
+inline const char * multiply_profile_name(cusp::symmetric_csr_format) { return "cusp::multiply<symmetric_csr>"; }
+inline const char * multiply_profile_name(cusp::batched_csr_format)   { return "cusp::multiply<batched_csr>"; }
+
+// traffic of the matrix in y = A x, without x and y
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::known_format)
+{
+    return 0;
+}
+
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::sparse_format)
+{
+    // an index and a value per entry
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    return (sizeof(IndexType) + sizeof(ValueType)) * A.num_entries;
+}
+
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::array2d_format)
+{
+    return sizeof(typename Matrix::value_type) * A.num_rows * A.num_cols;
+}
+
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::coo_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    return (2 * sizeof(IndexType) + sizeof(ValueType)) * A.num_entries;
+}
+
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::csr_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    return sizeof(IndexType) * (A.num_rows + 1) + (sizeof(IndexType) + sizeof(ValueType)) * A.num_entries;
+}
+
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::dia_format)
+{
+    // the padded diagonals, the offsets are negligible
+    return sizeof(typename Matrix::value_type) * A.values.num_rows * A.values.num_cols;
+}
+
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::ell_format)
+{
+    // the padded values and the indices of the entries
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    return sizeof(ValueType) * A.values.num_rows * A.values.num_cols + sizeof(IndexType) * A.num_entries;
+}
+
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::hyb_format)
+{
+    return matrix_bytes(A.ell, cusp::ell_format()) + matrix_bytes(A.coo, cusp::coo_format());
+}
+
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::sell_format)
+{
+    // the padded slices and the row permutation
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    return (sizeof(IndexType) + sizeof(ValueType)) * A.values.size() + sizeof(IndexType) * A.num_rows;
+}
+
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::jds_format)
+{
+    // the unpadded diagonals and the row permutation
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    return (sizeof(IndexType) + sizeof(ValueType)) * A.num_entries + sizeof(IndexType) * A.num_rows;
+}
+
+template <typename Matrix>
+size_t matrix_bytes(const Matrix& A, cusp::batched_csr_format)
+{
+    // the pattern is read once for all items
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    return sizeof(IndexType) * (A.row_offsets.size() + A.column_indices.size()) + sizeof(ValueType) * A.num_entries;
+}
+
+template <typename Matrix, typename Vector>
+operation_cost spmv_cost(const Matrix& A, const Vector& x, cusp::known_format)
+{
+    return operation_cost();
+}
+
+template <typename Matrix, typename Vector>
+operation_cost spmv_cost(const Matrix& A, const Vector& x, cusp::unknown_format)
+{
+    return operation_cost();
+}
+
+template <typename Matrix, typename Vector>
+operation_cost spmv_cost(const Matrix& A, const Vector& x, cusp::dense_format)
+{
+    typedef typename Matrix::value_type ValueType;
+
+    const size_t entries = A.num_rows * A.num_cols;
+
+    return operation_cost(matrix_bytes(A, cusp::array2d_format()) + sizeof(ValueType) * (A.num_cols + 2 * A.num_rows),
+                          2 * entries);
+}
+
+template <typename Matrix, typename Vector>
+operation_cost spmv_cost(const Matrix& A, const Vector& x, cusp::sparse_format)
+{
+    // x is gathered once per entry, y is read and written once per row
+    typedef typename Matrix::value_type ValueType;
+
+    return operation_cost(matrix_bytes(A, typename Matrix::format()) + sizeof(ValueType) * (A.num_entries + 2 * A.num_rows),
+                          2 * A.num_entries);
+}
+
+// cost of C = A B, when B is a vector
+template <typename Matrix, typename MatrixOrVector>
+operation_cost multiply_cost(const Matrix& A, const MatrixOrVector& B, cusp::known_format)
+{
+    return operation_cost();
+}
+
+template <typename Matrix, typename MatrixOrVector>
+operation_cost multiply_cost(const Matrix& A, const MatrixOrVector& B, cusp::array1d_format)
+{
+    return spmv_cost(A, B, typename Matrix::format());
+}
+
+template <typename Matrix, typename MatrixOrVector>
+operation_cost multiply_cost(const Matrix& A, const MatrixOrVector& B)
+{
+    return multiply_cost(A, B, typename MatrixOrVector::format());
+}
+
+// cost of y = alpha A x + beta z, which also reads z and scales the sum
+template <typename Matrix, typename Vector>
+operation_cost multiply_axpby_cost(const Matrix& A, const Vector& x)
+{
+    operation_cost cost = multiply_cost(A, x);
+
+    if (cost.flops)
+    {
+        cost.bytes += sizeof(typename Vector::value_type) * A.num_rows;
+        cost.flops += 3 * A.num_rows;
+    }
+
+    return cost;
+}
+
+} // end namespace detail
+} // end namespace cusp
+
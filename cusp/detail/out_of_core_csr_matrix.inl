@@ -0,0 +1,231 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/copy.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/stream.h>
+
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/arch.h>
+
+#include <thrust/functional.h>
+#include <thrust/iterator/constant_iterator.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+
+template <typename MatrixType>
+out_of_core_csr_matrix<MatrixType>
+::out_of_core_csr_matrix(const MatrixType& matrix, size_t buffer_bytes, size_t num_streams)
+    : Parent(matrix.num_rows, matrix.num_cols, matrix.num_entries),
+      matrix(matrix), panel_rows(1, 0), panel_offsets(1, 0), start(0)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (num_streams == 0)
+        throw cusp::invalid_input_exception("out_of_core_csr_matrix requires at least one stream");
+
+    if (buffer_bytes == 0)
+        buffer_bytes = cusp::detail::device::arch::current_device_info().total_global_memory / 4;
+
+    // each stream holds one panel
+    const size_t budget      = buffer_bytes / num_streams;
+    const size_t row_bytes   = sizeof(OffsetType);
+    const size_t entry_bytes = sizeof(IndexType) + sizeof(ValueType);
+
+    size_t max_rows    = 0;
+    size_t max_entries = 0;
+
+    if (matrix.num_rows > 0)
+        panel_offsets[0] = size_t(matrix.row_offsets[0]);
+
+    size_t row = 0;
+
+    while (row < matrix.num_rows)
+    {
+        const size_t first_row    = row;
+        const size_t first_offset = panel_offsets.back();
+
+        // a panel holds at least one row, however long
+        row++;
+
+        while (row < matrix.num_rows &&
+               (row + 2 - first_row) * row_bytes + (size_t(matrix.row_offsets[row + 1]) - first_offset) * entry_bytes <= budget)
+            row++;
+
+        panel_rows.push_back(row);
+        panel_offsets.push_back(size_t(matrix.row_offsets[row]));
+
+        // the statistics of a panel guide its kernel without a transfer
+        panel_statistics.push_back(cusp::detail::compute_row_statistics(
+            cusp::make_array1d_view(matrix.row_offsets.begin() + first_row, matrix.row_offsets.begin() + row + 1)));
+
+        max_rows    = std::max(max_rows,    row - first_row);
+        max_entries = std::max(max_entries, panel_offsets.back() - first_offset);
+    }
+
+    if (num_panels() == 0)
+        return;
+
+    buffers.resize(std::min(num_streams, num_panels()));
+
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+        buffers[i].row_offsets.resize(max_rows + 1);
+        buffers[i].column_indices.resize(max_entries);
+        buffers[i].values.resize(max_entries);
+    }
+
+    if (cudaEventCreateWithFlags(&start, cudaEventDisableTiming) != cudaSuccess)
+    {
+        start = 0;
+        throw cusp::runtime_exception("cudaEventCreateWithFlags failed");
+    }
+
+    // Blocking streams, so that Thrust algorithms which cannot select a
+    // stream remain ordered with the panels.
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+        cudaStream_t stream;
+        cudaEvent_t  event;
+
+        if (cudaStreamCreate(&stream) != cudaSuccess)
+        {
+            release();
+            throw cusp::runtime_exception("cudaStreamCreate failed");
+        }
+
+        streams.push_back(stream);
+
+        if (cudaEventCreateWithFlags(&event, cudaEventDisableTiming) != cudaSuccess)
+        {
+            release();
+            throw cusp::runtime_exception("cudaEventCreateWithFlags failed");
+        }
+
+        events.push_back(event);
+    }
+}
+
+template <typename MatrixType>
+out_of_core_csr_matrix<MatrixType>
+::~out_of_core_csr_matrix(void)
+{
+    release();
+}
+
+template <typename MatrixType>
+void out_of_core_csr_matrix<MatrixType>
+::release(void)
+{
+    for (size_t i = 0; i < events.size(); i++)
+        cudaEventDestroy(events[i]);
+
+    for (size_t i = 0; i < streams.size(); i++)
+        cudaStreamDestroy(streams[i]);
+
+    if (start != 0)
+        cudaEventDestroy(start);
+
+    events.clear();
+    streams.clear();
+    start = 0;
+}
+
+template <typename MatrixType>
+template <typename VectorType1, typename VectorType2>
+void out_of_core_csr_matrix<MatrixType>
+::operator()(const VectorType1& x, VectorType2& y) const
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename cusp::array1d<OffsetType, cusp::device_memory>::view OffsetView;
+    typedef typename cusp::array1d<IndexType,  cusp::device_memory>::view IndexView;
+    typedef typename cusp::array1d<ValueType,  cusp::device_memory>::view ValueView;
+
+    typedef cusp::csr_matrix_view<OffsetView, IndexView, ValueView,
+                                  IndexType, ValueType, cusp::device_memory> PanelView;
+
+    typedef typename MatrixType::row_offsets_array_type::const_iterator    HostOffsetIterator;
+    typedef typename MatrixType::column_indices_array_type::const_iterator HostIndexIterator;
+    typedef typename MatrixType::values_array_type::const_iterator         HostValueIterator;
+
+    if (num_panels() == 0)
+        return;
+
+    // the panels start after the work that produced x
+    const cudaStream_t caller = cusp::detail::current_stream();
+
+    cusp::detail::check_cuda(cudaEventRecord(start, caller), "cudaEventRecord failed");
+
+    for (size_t i = 0; i < streams.size(); i++)
+        cusp::detail::check_cuda(cudaStreamWaitEvent(streams[i], start, 0), "cudaStreamWaitEvent failed");
+
+    for (size_t p = 0; p < num_panels(); p++)
+    {
+        // a buffer is reused once the stream has multiplied its previous panel
+        const size_t        s      = p % streams.size();
+        const cudaStream_t  stream = streams[s];
+        panel_buffer&       buffer = buffers[s];
+
+        const size_t num_rows    = panel_rows[p + 1]    - panel_rows[p];
+        const size_t num_entries = panel_offsets[p + 1] - panel_offsets[p];
+
+        cusp::scoped_stream scope(stream);
+
+        const cusp::array1d_view<HostOffsetIterator> host_offsets(matrix.row_offsets.begin() + panel_rows[p],
+                                                                  matrix.row_offsets.begin() + panel_rows[p + 1] + 1);
+        const cusp::array1d_view<HostIndexIterator>  host_indices(matrix.column_indices.begin() + panel_offsets[p],
+                                                                  matrix.column_indices.begin() + panel_offsets[p + 1]);
+        const cusp::array1d_view<HostValueIterator>  host_values(matrix.values.begin() + panel_offsets[p],
+                                                                 matrix.values.begin() + panel_offsets[p + 1]);
+
+        OffsetView offsets(buffer.row_offsets.begin(),    buffer.row_offsets.begin()    + num_rows + 1);
+        IndexView  indices(buffer.column_indices.begin(), buffer.column_indices.begin() + num_entries);
+        ValueView  values(buffer.values.begin(),          buffer.values.begin()         + num_entries);
+
+        cusp::copy_async(host_offsets, offsets, stream);
+        cusp::copy_async(host_indices, indices, stream);
+        cusp::copy_async(host_values,  values,  stream);
+
+        // offsets of the panel start at zero
+        cusp::detail::streamed::transform(offsets.begin(), offsets.end(),
+                                          thrust::constant_iterator<OffsetType>(OffsetType(panel_offsets[p])),
+                                          offsets.begin(),
+                                          thrust::minus<OffsetType>());
+
+        PanelView panel(num_rows, this->num_cols, num_entries, offsets, indices, values);
+        panel.row_statistics = panel_statistics[p];
+
+        cusp::array1d_view<typename VectorType2::iterator> y_panel(y.begin() + panel_rows[p], y.begin() + panel_rows[p + 1]);
+
+        cusp::multiply(panel, x, y_panel);
+    }
+
+    // work issued on the caller's stream afterwards sees all of y
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        cusp::detail::check_cuda(cudaEventRecord(events[i], streams[i]), "cudaEventRecord failed");
+        cusp::detail::check_cuda(cudaStreamWaitEvent(caller, events[i], 0), "cudaStreamWaitEvent failed");
+    }
+}
+
+} // end namespace cusp
@@ -0,0 +1,164 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/convert.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/format.h>
+#include <cusp/detail/format_utils.h>
+
+#include <thrust/copy.h>
+#include <thrust/functional.h>
+#include <thrust/gather.h>
+#include <thrust/scan.h>
+#include <thrust/scatter.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// inverse[permutation[i]] = i
+template <typename Array1, typename Array2>
+void invert_permutation(const Array1& permutation, Array2& inverse)
+{
+    typedef typename Array2::value_type IndexType;
+
+    inverse.resize(permutation.size());
+
+    thrust::scatter(thrust::counting_iterator<IndexType>(0),
+                    thrust::counting_iterator<IndexType>(permutation.size()),
+                    permutation.begin(),
+                    inverse.begin());
+}
+
+// COO format
+template <typename MatrixType1, typename Array, typename MatrixType2, typename MemorySpace>
+void permute(const MatrixType1& A, const Array& permutation, MatrixType2& B,
+             cusp::coo_format, cusp::coo_format, MemorySpace, MemorySpace)
+{
+    typedef typename MatrixType2::index_type IndexType;
+
+    cusp::array1d<IndexType,MemorySpace> inverse;
+    invert_permutation(cusp::array1d<IndexType,MemorySpace>(permutation), inverse);
+
+    B.resize(A.num_rows, A.num_cols, A.num_entries);
+
+    // renumber the entries, then restore the order of the rows
+    thrust::gather(A.row_indices.begin(),    A.row_indices.end(),    inverse.begin(), B.row_indices.begin());
+    thrust::gather(A.column_indices.begin(), A.column_indices.end(), inverse.begin(), B.column_indices.begin());
+    thrust::copy(A.values.begin(), A.values.end(), B.values.begin());
+
+    B.sort_by_row_and_column();
+}
+
+// CSR format
+template <typename MatrixType1, typename Array, typename MatrixType2, typename MemorySpace>
+void permute(const MatrixType1& A, const Array& permutation, MatrixType2& B,
+             cusp::csr_format, cusp::csr_format, MemorySpace, MemorySpace)
+{
+    typedef typename MatrixType2::index_type IndexType;
+
+    const size_t N = A.num_rows;
+
+    cusp::array1d<IndexType,MemorySpace> P(permutation);
+    cusp::array1d<IndexType,MemorySpace> inverse;
+    invert_permutation(P, inverse);
+
+    B.resize(A.num_rows, A.num_cols, A.num_entries);
+
+    // the length of row i of B is that of row P[i] of A
+    thrust::transform(thrust::make_permutation_iterator(A.row_offsets.begin() + 1, P.begin()),
+                      thrust::make_permutation_iterator(A.row_offsets.begin() + 1, P.end()),
+                      thrust::make_permutation_iterator(A.row_offsets.begin(),     P.begin()),
+                      B.row_offsets.begin(),
+                      thrust::minus<IndexType>());
+    B.row_offsets[N] = 0;
+    thrust::exclusive_scan(B.row_offsets.begin(), B.row_offsets.end(), B.row_offsets.begin());
+
+    // entry n of row i of B is entry n + shift[i] of A
+    cusp::array1d<IndexType,MemorySpace> shift(N);
+    thrust::transform(thrust::make_permutation_iterator(A.row_offsets.begin(), P.begin()),
+                      thrust::make_permutation_iterator(A.row_offsets.begin(), P.end()),
+                      B.row_offsets.begin(),
+                      shift.begin(),
+                      thrust::minus<IndexType>());
+
+    cusp::array1d<IndexType,MemorySpace> rows(A.num_entries);
+    cusp::detail::offsets_to_indices(B.row_offsets, rows);
+
+    cusp::array1d<IndexType,MemorySpace> sources(A.num_entries);
+    thrust::transform(thrust::counting_iterator<IndexType>(0),
+                      thrust::counting_iterator<IndexType>(A.num_entries),
+                      thrust::make_permutation_iterator(shift.begin(), rows.begin()),
+                      sources.begin(),
+                      thrust::plus<IndexType>());
+
+    // gather the rows and renumber their columns
+    thrust::gather(sources.begin(), sources.end(),
+                   thrust::make_permutation_iterator(inverse.begin(), A.column_indices.begin()),
+                   B.column_indices.begin());
+    thrust::gather(sources.begin(), sources.end(), A.values.begin(), B.values.begin());
+
+    // sort the columns within the rows
+    cusp::detail::sort_by_row_and_column(rows, B.column_indices, B.values);
+}
+
+// Default case permutes a CSR matrix in the memory space of B
+template <typename MatrixType1, typename Array, typename MatrixType2,
+          typename MatrixFormat1, typename MatrixFormat2,
+          typename MemorySpace1, typename MemorySpace2>
+void permute(const MatrixType1& A, const Array& permutation, MatrixType2& B,
+             MatrixFormat1, MatrixFormat2, MemorySpace1, MemorySpace2)
+{
+    typedef typename MatrixType2::index_type IndexType;
+    typedef typename MatrixType2::value_type ValueType;
+
+    cusp::csr_matrix<IndexType, ValueType, MemorySpace2> A_csr(A);
+    cusp::csr_matrix<IndexType, ValueType, MemorySpace2> B_csr;
+    cusp::detail::permute(A_csr, permutation, B_csr, cusp::csr_format(), cusp::csr_format(), MemorySpace2(), MemorySpace2());
+
+    cusp::convert(B_csr, B);
+}
+
+} // end namespace detail
+
+template <typename MatrixType1, typename Array, typename MatrixType2>
+void permute(const MatrixType1& A, const Array& permutation, MatrixType2& B)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (A.num_rows != A.num_cols)
+        throw cusp::invalid_input_exception("matrix must be square");
+
+    if (permutation.size() != A.num_rows)
+        throw cusp::invalid_input_exception("permutation size does not match the matrix");
+
+    cusp::detail::permute(A, permutation, B,
+                          typename MatrixType1::format(),
+                          typename MatrixType2::format(),
+                          typename MatrixType1::memory_space(),
+                          typename MatrixType2::memory_space());
+}
+
+} // end namespace cusp
+
@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/complex.h>
+#include <cusp/convert.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/precond/smoothed_aggregation.h>
+
+// Instantiations compiled into the Cusp library.
+//
+// Each list takes a PREFIX, which is "template" in the sources of the
+// library (library/*.cu) and "extern template" in <cusp/precompiled.h>,
+// so the definitions and the declarations cannot drift apart.  The
+// products are instantiated for const and non-const operands, since
+// callers deduce either, with cusp::array1d vectors.  Other vector
+// types, e.g. views, are instantiated by the caller as usual.
+
+// Apply MACRO(PREFIX, IndexType, ValueType, MemorySpace) to every type combination
+#define CUSP_PRECOMPILED_TYPES(MACRO, PREFIX, MemorySpace)              \
+    MACRO(PREFIX, int,  float,                 MemorySpace)             \
+    MACRO(PREFIX, int,  double,                MemorySpace)             \
+    MACRO(PREFIX, int,  cusp::complex<float>,  MemorySpace)             \
+    MACRO(PREFIX, int,  cusp::complex<double>, MemorySpace)             \
+    MACRO(PREFIX, long, float,                 MemorySpace)             \
+    MACRO(PREFIX, long, double,                MemorySpace)             \
+    MACRO(PREFIX, long, cusp::complex<float>,  MemorySpace)             \
+    MACRO(PREFIX, long, cusp::complex<double>, MemorySpace)
+
+// the combinations with real values, for the AMG hierarchy
+#define CUSP_PRECOMPILED_REAL_TYPES(MACRO, PREFIX, MemorySpace)         \
+    MACRO(PREFIX, int,  float,                 MemorySpace)             \
+    MACRO(PREFIX, int,  double,                MemorySpace)             \
+    MACRO(PREFIX, long, float,                 MemorySpace)             \
+    MACRO(PREFIX, long, double,                MemorySpace)
+
+// Apply MACRO(PREFIX, FORMAT, IndexType, ValueType, MemorySpace) to every format
+#define CUSP_PRECOMPILED_FORMATS(MACRO, PREFIX, I, V, M)                \
+    MACRO(PREFIX, coo, I, V, M)                                         \
+    MACRO(PREFIX, csr, I, V, M)                                         \
+    MACRO(PREFIX, dia, I, V, M)                                         \
+    MACRO(PREFIX, ell, I, V, M)                                         \
+    MACRO(PREFIX, hyb, I, V, M)
+
+#define CUSP_PRECOMPILED_CONTAINER(PREFIX, FORMAT, I, V, M)             \
+    PREFIX class cusp::FORMAT##_matrix<I,V,M>;
+
+#define CUSP_PRECOMPILED_CONTAINERS(PREFIX, I, V, M)                    \
+    CUSP_PRECOMPILED_FORMATS(CUSP_PRECOMPILED_CONTAINER, PREFIX, I, V, M)
+
+// y = A * x and y = alpha * A * x + beta * y
+#define CUSP_PRECOMPILED_PRODUCT(PREFIX, FORMAT, I, V, M)                                                                        \
+    PREFIX void cusp::multiply(const cusp::FORMAT##_matrix<I,V,M>&, const cusp::array1d<V,M>&, cusp::array1d<V,M>&);             \
+    PREFIX void cusp::multiply(const cusp::FORMAT##_matrix<I,V,M>&,       cusp::array1d<V,M>&, cusp::array1d<V,M>&);             \
+    PREFIX void cusp::multiply(      cusp::FORMAT##_matrix<I,V,M>&, const cusp::array1d<V,M>&, cusp::array1d<V,M>&);             \
+    PREFIX void cusp::multiply(      cusp::FORMAT##_matrix<I,V,M>&,       cusp::array1d<V,M>&, cusp::array1d<V,M>&);             \
+    PREFIX void cusp::multiply(const cusp::FORMAT##_matrix<I,V,M>&, const cusp::array1d<V,M>&, cusp::array1d<V,M>&, V, V);       \
+    PREFIX void cusp::multiply(      cusp::FORMAT##_matrix<I,V,M>&,       cusp::array1d<V,M>&, cusp::array1d<V,M>&, V, V);
+
+#define CUSP_PRECOMPILED_MULTIPLY(PREFIX, I, V, M)                      \
+    CUSP_PRECOMPILED_FORMATS(CUSP_PRECOMPILED_PRODUCT, PREFIX, I, V, M)
+
+// conversions between the formats in one memory space
+#define CUSP_PRECOMPILED_CONVERSION(PREFIX, FORMAT, I, V, M)                                                  \
+    PREFIX void cusp::convert(const cusp::FORMAT##_matrix<I,V,M>&, cusp::coo_matrix<I,V,M>&);                 \
+    PREFIX void cusp::convert(const cusp::FORMAT##_matrix<I,V,M>&, cusp::csr_matrix<I,V,M>&);                 \
+    PREFIX void cusp::convert(const cusp::FORMAT##_matrix<I,V,M>&, cusp::dia_matrix<I,V,M>&);                 \
+    PREFIX void cusp::convert(const cusp::FORMAT##_matrix<I,V,M>&, cusp::ell_matrix<I,V,M>&);                 \
+    PREFIX void cusp::convert(const cusp::FORMAT##_matrix<I,V,M>&, cusp::hyb_matrix<I,V,M>&);
+
+#define CUSP_PRECOMPILED_CONVERT(PREFIX, I, V, M)                       \
+    CUSP_PRECOMPILED_FORMATS(CUSP_PRECOMPILED_CONVERSION, PREFIX, I, V, M)
+
+// copies of a format between host memory and MemorySpace
+#define CUSP_PRECOMPILED_COPY(PREFIX, FORMAT, I, V, M)                                                        \
+    PREFIX void cusp::convert(const cusp::FORMAT##_matrix<I,V,cusp::host_memory>&, cusp::FORMAT##_matrix<I,V,M>&); \
+    PREFIX void cusp::convert(const cusp::FORMAT##_matrix<I,V,M>&, cusp::FORMAT##_matrix<I,V,cusp::host_memory>&);
+
+#define CUSP_PRECOMPILED_TRANSFER(PREFIX, I, V, M)                      \
+    CUSP_PRECOMPILED_FORMATS(CUSP_PRECOMPILED_COPY, PREFIX, I, V, M)
+
+// smoothed aggregation hierarchies of CSR matrices
+#define CUSP_PRECOMPILED_AGGREGATION(PREFIX, I, V, M)                                                                          \
+    PREFIX class cusp::precond::smoothed_aggregation<I,V,M>;                                                                   \
+    PREFIX cusp::precond::smoothed_aggregation<I,V,M>::smoothed_aggregation(const cusp::csr_matrix<I,V,M>&, const V);           \
+    PREFIX cusp::precond::smoothed_aggregation<I,V,M>::smoothed_aggregation(const cusp::csr_matrix<I,V,M>&,                     \
+                                                                            const cusp::precond::amg_options&);                 \
+    PREFIX void cusp::precond::smoothed_aggregation<I,V,M>::operator()(const cusp::array1d<V,M>&, cusp::array1d<V,M>&);
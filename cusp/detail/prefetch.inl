@@ -0,0 +1,249 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/format.h>
+#include <cusp/managed_allocator.h>
+
+#include <cusp/detail/forward_definitions.h>
+#include <cusp/detail/storage_arrays.h>
+#include <cusp/detail/device/arch.h>
+
+#include <thrust/detail/type_traits.h>
+#include <thrust/device_ptr.h>
+
+#include <cuda_runtime_api.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// Containers whose storage is obtained from a managed_allocator.  The
+// allocator is a template argument of the container only, so views of
+// managed storage are indistinguishable from views of device memory.
+template <typename T>
+struct is_managed : thrust::detail::false_type {};
+
+template <typename T, typename U>
+struct is_managed< cusp::array1d<T, cusp::managed_allocator<U> > > : thrust::detail::true_type {};
+
+template <typename T, typename U, typename Orientation>
+struct is_managed< cusp::array2d<T, cusp::managed_allocator<U>, Orientation> > : thrust::detail::true_type {};
+
+template <typename IndexType, typename ValueType, typename U>
+struct is_managed< cusp::coo_matrix<IndexType, ValueType, cusp::managed_allocator<U> > > : thrust::detail::true_type {};
+
+template <typename IndexType, typename ValueType, typename U>
+struct is_managed< cusp::csr_matrix<IndexType, ValueType, cusp::managed_allocator<U> > > : thrust::detail::true_type {};
+
+template <typename IndexType, typename ValueType, typename U>
+struct is_managed< cusp::dia_matrix<IndexType, ValueType, cusp::managed_allocator<U> > > : thrust::detail::true_type {};
+
+template <typename IndexType, typename ValueType, typename U>
+struct is_managed< cusp::ell_matrix<IndexType, ValueType, cusp::managed_allocator<U> > > : thrust::detail::true_type {};
+
+template <typename IndexType, typename ValueType, typename U>
+struct is_managed< cusp::hyb_matrix<IndexType, ValueType, cusp::managed_allocator<U> > > : thrust::detail::true_type {};
+
+// Prefetches and advice are hints: they are skipped on devices without
+// concurrent managed access and their failures are ignored.
+inline bool managed_hints_supported(void)
+{
+    return cusp::detail::device::arch::current_device_info().concurrent_managed_access;
+}
+
+inline void prefetch_range(const void * ptr, const size_t bytes, const int device, cudaStream_t stream)
+{
+#if CUDART_VERSION >= 8000
+    if (bytes == 0 || !managed_hints_supported())
+        return;
+
+#if CUDART_VERSION >= 13000
+    cudaMemLocation location;
+    location.type = device == cudaCpuDeviceId ? cudaMemLocationTypeHost : cudaMemLocationTypeDevice;
+    location.id   = device == cudaCpuDeviceId ? 0 : device;
+
+    if (cudaMemPrefetchAsync(ptr, bytes, location, 0, stream) != cudaSuccess)
+        cudaGetLastError();
+#else
+    if (cudaMemPrefetchAsync(ptr, bytes, device, stream) != cudaSuccess)
+        cudaGetLastError();
+#endif
+#endif
+}
+
+inline void advise_range_read_mostly(const void * ptr, const size_t bytes)
+{
+#if CUDART_VERSION >= 8000
+    if (bytes == 0 || !managed_hints_supported())
+        return;
+
+#if CUDART_VERSION >= 13000
+    cudaMemLocation location;
+    location.type = cudaMemLocationTypeDevice;
+    location.id   = 0; // ignored by cudaMemAdviseSetReadMostly
+
+    if (cudaMemAdvise(ptr, bytes, cudaMemAdviseSetReadMostly, location) != cudaSuccess)
+        cudaGetLastError();
+#else
+    if (cudaMemAdvise(ptr, bytes, cudaMemAdviseSetReadMostly, 0) != cudaSuccess)
+        cudaGetLastError();
+#endif
+#endif
+}
+
+// operations applied to each contiguous array of a container
+struct prefetch_op
+{
+    int device;
+    cudaStream_t stream;
+
+    prefetch_op(const int device, cudaStream_t stream) : device(device), stream(stream) {}
+
+    void operator()(const void * ptr, const size_t bytes) const { prefetch_range(ptr, bytes, device, stream); }
+};
+
+struct advise_read_mostly_op
+{
+    void operator()(const void * ptr, const size_t bytes) const { advise_range_read_mostly(ptr, bytes); }
+};
+
+struct count_bytes_op
+{
+    size_t * total;
+
+    count_bytes_op(size_t * total) : total(total) {}
+
+    void operator()(const void *, const size_t bytes) const { *total += bytes; }
+};
+
+template <typename MatrixOrVector, typename Operation>
+void for_each_managed_range(const MatrixOrVector& A, Operation op, thrust::detail::true_type)
+{
+    for_each_storage_range(A, op);
+}
+
+template <typename MatrixOrVector, typename Operation>
+void for_each_managed_range(const MatrixOrVector&, Operation, thrust::detail::false_type)
+{
+    // not in managed memory
+}
+
+template <typename MatrixOrVector, typename Operation>
+void for_each_managed_range(const MatrixOrVector& A, Operation op)
+{
+    for_each_managed_range(A, op, typename is_managed<MatrixOrVector>::type());
+}
+
+// bytes of managed storage of a container, zero for other types
+template <typename MatrixOrVector>
+size_t managed_bytes(const MatrixOrVector& A)
+{
+    size_t total = 0;
+
+    for_each_managed_range(A, count_bytes_op(&total));
+
+    return total;
+}
+
+// Whether the storage of A may reside on the current device, with room
+// to spare for the operands of its product and for temporaries.  Only
+// managed containers can exceed the memory of the device.
+template <typename MatrixOrVector>
+bool fits_device_memory(const MatrixOrVector& A)
+{
+    if (!is_managed<MatrixOrVector>::value)
+        return true;
+
+    const size_t capacity = cusp::detail::device::arch::current_device_info().total_global_memory;
+
+    return capacity == 0 || managed_bytes(A) <= capacity / 4 * 3;
+}
+
+// Prefetch the managed operands of a product to the current device.  A
+// matrix that does not fit is left in place and migrates block by block
+// as it is multiplied.
+template <typename Matrix, typename Vector1, typename Vector2>
+void prefetch_product(const Matrix& A, const Vector1& x, const Vector2& y)
+{
+    if (!is_managed<Matrix>::value && !is_managed<Vector1>::value && !is_managed<Vector2>::value)
+        return;
+
+    int device = 0;
+
+    if (cudaGetDevice(&device) != cudaSuccess)
+    {
+        cudaGetLastError();
+        return;
+    }
+
+    if (fits_device_memory(A))
+        cusp::prefetch(A, device);
+
+    cusp::prefetch(x, device);
+    cusp::prefetch(y, device);
+}
+
+// Prepare the managed operands of a solver.  The matrix is read-mostly
+// for the duration of the solve: its pages are duplicated rather than
+// migrated, and the driver discards rather than writes back the pages it
+// evicts from an oversubscribed device.
+template <typename LinearOperator, typename Vector1, typename Vector2>
+void prefetch_solve(const LinearOperator& A, const Vector1& x, const Vector2& b)
+{
+    cusp::advise_read_mostly(A);
+
+    prefetch_product(A, x, b);
+}
+
+} // end namespace detail
+
+template <typename MatrixOrVector>
+void prefetch(const MatrixOrVector& A)
+{
+    if (!cusp::detail::is_managed<MatrixOrVector>::value)
+        return;
+
+    int device = 0;
+
+    if (cudaGetDevice(&device) != cudaSuccess)
+    {
+        cudaGetLastError();
+        return;
+    }
+
+    cusp::prefetch(A, device);
+}
+
+template <typename MatrixOrVector>
+void prefetch(const MatrixOrVector& A, int device)
+{
+    cusp::prefetch(A, device, cusp::detail::current_stream());
+}
+
+template <typename MatrixOrVector>
+void prefetch(const MatrixOrVector& A, int device, cudaStream_t stream)
+{
+    cusp::detail::for_each_managed_range(A, cusp::detail::prefetch_op(device, stream));
+}
+
+template <typename MatrixOrVector>
+void advise_read_mostly(const MatrixOrVector& A)
+{
+    cusp::detail::for_each_managed_range(A, cusp::detail::advise_read_mostly_op());
+}
+
+} // end namespace cusp
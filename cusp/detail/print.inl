@@ -16,11 +16,25 @@
 
 
 #include <cusp/format.h>
+#include <cusp/analyze.h>
 #include <cusp/complex.h>
 #include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/detail/format_utils.h>
 
+#include <thrust/binary_search.h>
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/functional.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+#include <thrust/detail/type_traits.h>
+
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 namespace cusp
 {
@@ -28,10 +42,8 @@ namespace detail
 {
 
 template <typename Printable, typename Stream>
-void print(const Printable& p, Stream& s, cusp::coo_format)
+void print_coo_entries(const Printable& p, Stream& s)
 {
-  s << "sparse matrix <" << p.num_rows << ", " << p.num_cols << "> with " << p.num_entries << " entries\n";
-
   for(size_t n = 0; n < p.num_entries; n++)
   {
     s << " " << std::setw(14) << p.row_indices[n];
@@ -40,6 +52,28 @@ void print(const Printable& p, Stream& s, cusp::coo_format)
   }
 }
 
+template <typename Printable, typename Stream>
+void print_coo(const Printable& p, Stream& s, thrust::detail::true_type)
+{
+  s << "sparse matrix <" << p.num_rows << ", " << p.num_cols << "> with " << p.num_entries << " entries\n";
+
+  print_coo_entries(p, s);
+}
+
+// copy the matrix to the host at once instead of reading every entry
+template <typename Printable, typename Stream>
+void print_coo(const Printable& p, Stream& s, thrust::detail::false_type)
+{
+  cusp::coo_matrix<typename Printable::index_type, typename Printable::value_type, cusp::host_memory> coo(p);
+  print_coo(coo, s, thrust::detail::true_type());
+}
+
+template <typename Printable, typename Stream>
+void print(const Printable& p, Stream& s, cusp::coo_format)
+{
+  print_coo(p, s, typename thrust::detail::is_same<typename Printable::memory_space, cusp::host_memory>::type());
+}
+
 template <typename Printable, typename Stream>
 void print(const Printable& p, Stream& s, cusp::sparse_format)
 {
@@ -73,6 +107,134 @@ void print(const Printable& p, Stream& s, cusp::array1d_format)
     s << std::setw(14) << p[i] << "\n";
 }
 
+////////////
+// Window //
+////////////
+
+template <typename IndexType>
+struct print_window_functor
+{
+  typedef bool result_type;
+
+  IndexType row_begin, row_end, column_begin, column_end;
+
+  print_window_functor(const IndexType row_begin, const IndexType row_end,
+                       const IndexType column_begin, const IndexType column_end)
+    : row_begin(row_begin), row_end(row_end), column_begin(column_begin), column_end(column_end) {}
+
+  template <typename Tuple>
+  __host__ __device__
+  bool operator()(const Tuple& t) const
+  {
+    const IndexType i = thrust::get<0>(t);
+    const IndexType j = thrust::get<1>(t);
+
+    return row_begin <= i && i < row_end && column_begin <= j && j < column_end;
+  }
+};
+
+template <typename IndexType>
+struct print_window_row
+{
+  IndexType row_begin;
+
+  print_window_row(const IndexType row_begin) : row_begin(row_begin) {}
+
+  __host__ __device__
+  IndexType operator()(const IndexType k) const
+  {
+    return row_begin + k - 1;
+  }
+};
+
+// entries of the window of a COO matrix, in the memory space of the matrix
+template <typename Matrix, typename IndexArray, typename ValueArray, typename Window>
+size_t print_window_select(const IndexArray& rows, const IndexArray& columns, const ValueArray& values,
+                           Matrix& W, const Window& window)
+{
+  const size_t num_entries =
+    thrust::count_if(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin())),
+                     thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   columns.end())),
+                     window);
+
+  W.resize(W.num_rows, W.num_cols, num_entries);
+
+  thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin(), values.begin())),
+                  thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   columns.end(),   values.end())),
+                  thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin())),
+                  thrust::make_zip_iterator(thrust::make_tuple(W.row_indices.begin(), W.column_indices.begin(), W.values.begin())),
+                  window);
+
+  return num_entries;
+}
+
+template <typename Matrix, typename Window>
+void print_window_entries(const Matrix& A, cusp::coo_matrix<typename Matrix::index_type, typename Matrix::value_type, typename Matrix::memory_space>& W,
+                          const Window& window, cusp::coo_format)
+{
+  print_window_select(A.row_indices, A.column_indices, A.values, W, window);
+}
+
+// only the entries of the rows of the window are expanded
+template <typename Matrix, typename Window>
+void print_window_entries(const Matrix& A, cusp::coo_matrix<typename Matrix::index_type, typename Matrix::value_type, typename Matrix::memory_space>& W,
+                          const Window& window, cusp::csr_format)
+{
+  typedef typename Matrix::index_type   IndexType;
+  typedef typename Matrix::value_type   ValueType;
+  typedef typename Matrix::memory_space MemorySpace;
+
+  if (window.row_begin >= window.row_end)
+    return;
+
+  const IndexType first = A.row_offsets[window.row_begin];
+  const IndexType last  = A.row_offsets[window.row_end];
+
+  cusp::array1d<IndexType,MemorySpace> rows(last - first);
+
+  thrust::upper_bound(A.row_offsets.begin() + window.row_begin, A.row_offsets.begin() + window.row_end + 1,
+                      thrust::counting_iterator<IndexType>(first), thrust::counting_iterator<IndexType>(last),
+                      rows.begin());
+  thrust::transform(rows.begin(), rows.end(), rows.begin(), print_window_row<IndexType>(window.row_begin));
+
+  const cusp::array1d<IndexType,MemorySpace> columns(A.column_indices.begin() + first, A.column_indices.begin() + last);
+  const cusp::array1d<ValueType,MemorySpace> values(A.values.begin() + first, A.values.begin() + last);
+
+  print_window_select(rows, columns, values,
+                      W, window);
+}
+
+template <typename Matrix, typename Window>
+void print_window_entries(const Matrix& A, cusp::coo_matrix<typename Matrix::index_type, typename Matrix::value_type, typename Matrix::memory_space>& W,
+                          const Window& window, cusp::sparse_format)
+{
+  const cusp::coo_matrix<typename Matrix::index_type, typename Matrix::value_type, typename Matrix::memory_space> coo(A);
+
+  print_window_entries(coo, W, window, cusp::coo_format());
+}
+
+template <typename Matrix, typename Window>
+void print_window_entries(const Matrix& A, cusp::coo_matrix<typename Matrix::index_type, typename Matrix::value_type, typename Matrix::memory_space>& W,
+                          const Window& window, cusp::array2d_format)
+{
+  print_window_entries(A, W, window, cusp::sparse_format());
+}
+
+/////////////
+// Summary //
+/////////////
+
+// bucket b > 0 holds the lengths in [2^(b-1), 2^b), bucket 0 the empty rows
+inline size_t row_length_bucket(size_t length)
+{
+  size_t bucket = 0;
+
+  for (; length > 0; length >>= 1)
+    bucket++;
+
+  return bucket;
+}
+
 } // end namespace detail
 
 
@@ -92,6 +254,89 @@ void print(const Printable& p, Stream& s)
   cusp::detail::print(p, s, typename Printable::format());
 }
 
+template <typename Matrix, typename Stream>
+void print_window(const Matrix& A,
+                  size_t row_begin, size_t row_end,
+                  size_t column_begin, size_t column_end,
+                  Stream& s)
+{
+  typedef typename Matrix::index_type   IndexType;
+  typedef typename Matrix::value_type   ValueType;
+  typedef typename Matrix::memory_space MemorySpace;
+
+  row_end    = std::min<size_t>(row_end,    A.num_rows);
+  column_end = std::min<size_t>(column_end, A.num_cols);
+  row_begin    = std::min(row_begin,    row_end);
+  column_begin = std::min(column_begin, column_end);
+
+  const cusp::detail::print_window_functor<IndexType> window(row_begin, row_end, column_begin, column_end);
+
+  cusp::coo_matrix<IndexType,ValueType,MemorySpace> W(A.num_rows, A.num_cols, 0);
+  cusp::detail::print_window_entries(A, W, window, typename Matrix::format());
+
+  const cusp::coo_matrix<IndexType,ValueType,cusp::host_memory> H(W);
+
+  s << "sparse matrix <" << A.num_rows << ", " << A.num_cols << "> with " << A.num_entries << " entries, ";
+  s << "window rows [" << row_begin << ", " << row_end << ") columns [" << column_begin << ", " << column_end << ")";
+  s << " with " << H.num_entries << " entries\n";
+
+  cusp::detail::print_coo_entries(H, s);
+}
+
+template <typename Matrix>
+void print_window(const Matrix& A,
+                  size_t row_begin, size_t row_end,
+                  size_t column_begin, size_t column_end)
+{
+  cusp::print_window(A, row_begin, row_end, column_begin, column_end, std::cout);
+}
+
+template <typename Matrix, typename Stream>
+void print_summary(const Matrix& A, Stream& s)
+{
+  const cusp::matrix_analysis analysis = cusp::analyze(A);
+
+  s << "sparse matrix <" << analysis.num_rows << ", " << analysis.num_cols << "> with " << analysis.num_entries << " entries\n";
+
+  if (analysis.num_rows == 0)
+    return;
+
+  s << "  row lengths: min " << analysis.min_row_length
+    << ", mean " << analysis.mean_row_length
+    << ", max " << analysis.max_row_length << "\n";
+
+  // rows per power-of-two bucket of the row lengths
+  std::vector<size_t> histogram(cusp::detail::row_length_bucket(analysis.max_row_length) + 1, 0);
+  for (size_t k = 0; k < analysis.row_length_histogram.size(); k++)
+    histogram[cusp::detail::row_length_bucket(k)] += analysis.row_length_histogram[k];
+
+  s << "  row length histogram:\n";
+  for (size_t b = 0; b < histogram.size(); b++)
+  {
+    if (histogram[b] == 0)
+      continue;
+
+    if (b == 0)
+      s << "    " << std::setw(26) << "empty";
+    else
+      s << "    [" << std::setw(11) << (1ull << (b - 1)) << ", " << std::setw(11) << (1ull << b) << ")";
+
+    s << " " << std::setw(14) << histogram[b] << "\n";
+  }
+
+  if (analysis.num_entries == 0)
+    return;
+
+  s << "  absolute values: min " << analysis.min_abs_value << ", max " << analysis.max_abs_value << "\n";
+  s << "  diagonally dominant rows: " << analysis.num_dominant_rows << " of " << analysis.num_rows << "\n";
+}
+
+template <typename Matrix>
+void print_summary(const Matrix& A)
+{
+  cusp::print_summary(A, std::cout);
+}
+
 template <typename Matrix>
 void print_matrix(const Matrix& A)
 {
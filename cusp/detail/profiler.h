@@ -21,10 +21,33 @@
  * Additional details:
  *   http://floodyberry.wordpress.com/2009/10/07/high-performance-cplusplus-profiling/
  *
+ * Each scope is timed with a pair of CUDA events recorded on the current
+ * stream, so it is charged with the device work issued inside it rather
+ * than with the host time until the next synchronization.  The events are
+ * resolved lazily and never stall the scope; define CUSP_PROFILE_SYNCHRONIZE
+ * to wait for them when each scope exits instead.  Every host thread has
+ * its own tree of scopes, entered with its first scope, and dump() and
+ * summary() may be called from any thread.  CUSP_PROFILE_BYTES(n) and
+ * CUSP_PROFILE_FLOPS(n) add n bytes of memory traffic and n floating point
+ * operations to the enclosing scope, from which the achieved bandwidth and
+ * GFLOP/s are reported next to the peak bandwidth of the device.  Each
+ * scope also reports the high-water mark of the device memory held by
+ * Cusp's allocators while it was open (see cusp/memory_footprint.h).
+ *
+ * dump() prints a text table, or with the environment variable
+ * CUSP_PROFILE_FORMAT set to "json" or "chrome" writes the scope trees as
+ * JSON or as Chrome trace events (chrome://tracing, Perfetto) to stdout
+ * or to the file named by CUSP_PROFILE_FILE.  Building with
+ * CUSP_PROFILE_NVTX (and linking with nvToolsExt) additionally brackets
+ * every scope with an NVTX range, which Nsight shows on its timeline;
+ * CUSP_PROFILE_NVTX=0 in the environment turns the ranges off.
  */
 
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 #define __PROFILER_ENABLED__
 #define __PROFILER_FULL_TYPE_EXPANSION__
 
@@ -96,13 +119,50 @@ namespace profiler
 
         void detect( int argc, const char *argv[] );
         void detect( const char *commandLine );
+        enum dump_format { dump_text, dump_json, dump_chrome_trace };
+
         void dump();
+        void dump( dump_format format, const char *filename = NULL );
         void fastcall enter( const char *name );
         void fastcall exit();
         void fastcall pause();
         void fastcall unpause();
         void reset();
 
+        // stop timing the root scope of this thread before it terminates
+        void exit_thread();
+
+        // add memory traffic or floating point operations to the active
+        // scope of this thread
+        void add_bytes( size_t bytes );
+        void add_flops( size_t flops );
+
+        // "prefix index" as a name that may be passed to enter(), e.g. to
+        // time each level of a multigrid hierarchy in its own scope
+        const char *intern( const char *prefix, size_t index );
+
+        // theoretical memory bandwidth of the current device in GB/s, or 0
+        // when it cannot be queried
+        double peak_bandwidth();
+
+        // statistics of a scope, summed over its call paths and threads
+        struct scope_summary
+	{
+                const char *name;
+                double milliseconds;   // device time, inclusive of nested scopes
+                unsigned long calls;
+                size_t bytes;
+                size_t flops;
+                size_t peak_device_bytes;   // largest device memory in use while the scope was open
+
+                scope_summary() : name(NULL), milliseconds(0.0), calls(0), bytes(0), flops(0), peak_device_bytes(0) {}
+
+                double bandwidth() const { return milliseconds > 0.0 ? bytes / ( 1e6 * milliseconds ) : 0.0; }  // GB/s
+                double gflops() const { return milliseconds > 0.0 ? flops / ( 1e6 * milliseconds ) : 0.0; }     // GFLOP/s
+        };
+
+        std::vector<scope_summary> summary();
+
         struct Scoped 
 	{
                 Scoped( const char *name ) { PROFILE_START_RAW( name ); }
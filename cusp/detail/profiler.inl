@@ -33,7 +33,16 @@
 #endif
 
 #include <time.h>
-#include <cusp/detail/timer.h>
+#include <stdlib.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/memory_tracker.h>
+
+#include <set>
+#include <string>
+
+#if defined(CUSP_PROFILE_NVTX)
+#include <nvToolsExt.h>
+#endif
 
 #if defined(__ICC) || defined(__ICL)
         #pragma warning( disable: 1684 ) // (size_t )name >> 5
@@ -54,6 +63,7 @@
 #else
         #include <sched.h>
         #define yield() sched_yield();
+        #define YIELD() sched_yield();
         #define printfu64() "%lu"
         #define PRINTFU64() "%lu"
         #define pathslash() '/'
@@ -61,11 +71,6 @@
         #define threadlocal __thread
 #endif
 
-#if !defined(__PROFILER_SMP__)
-        #undef threadlocal
-        #define threadlocal
-#endif
-
 namespace cusp
 {
 namespace detail
@@ -102,13 +107,18 @@ namespace profiler
         #undef min
         #undef max
 
+	// spin lock, which is only contended while the profile is dumped
 	struct CASLock {
-		void Acquire() {}
-		void Release() {}
-		bool TryAcquire() { return false; }
-		bool TryRelease() { return false; }
-		size_t Value() const { return 0; }
-		size_t dummy;
+		void Acquire() { while ( !TryAcquire() ) { YIELD() } }
+	#if defined(_MSC_VER)
+		void Release() { InterlockedExchange( &mValue, 0 ); }
+		bool TryAcquire() { return InterlockedCompareExchange( &mValue, 1, 0 ) == 0; }
+	#else
+		void Release() { __sync_lock_release( &mValue ); }
+		bool TryAcquire() { return __sync_bool_compare_and_swap( &mValue, 0, 1 ); }
+	#endif
+		size_t Value() const { return mValue; }
+		volatile long mValue;
 	};
 
 
@@ -142,6 +152,7 @@ namespace profiler
                 ~Buffer() { free( mBuffer ); }
 
                 void Clear() { mItems = ( 0 ); }
+                void Truncate( size_t items ) { mItems = ( items ); }
                 T* Data() { return ( mBuffer ); }
                 void EnsureCapacity( size_t capacity ) { if ( capacity >= mAlloc ) Resize( capacity * 2 ); }
                 T* Last() { return ( &mBuffer[ mItems - 1 ] ); }
@@ -204,6 +215,259 @@ namespace profiler
 
         };      
 
+        // rate in units of 1e9 per second
+        inline double gigaPerSecond( size_t count, double milliseconds ) 
+	{
+                return ( milliseconds > 0.0 ) ? double( count ) / ( 1e6 * milliseconds ) : 0.0;
+        }
+
+        // theoretical memory bandwidth of the current device in GB/s: the
+        // memory clock is in kHz and data moves on both clock edges
+        inline double queryPeakBandwidth() 
+	{
+                int device = 0, clockRate = 0, busWidth = 0;
+                if ( cudaGetDevice( &device ) == cudaSuccess &&
+                     cudaDeviceGetAttribute( &clockRate, cudaDevAttrMemoryClockRate, device ) == cudaSuccess &&
+                     cudaDeviceGetAttribute( &busWidth, cudaDevAttrGlobalMemoryBusWidth, device ) == cudaSuccess )
+                        return 2.0 * 1000.0 * double( clockRate ) * ( double( busWidth ) / 8.0 ) / 1e9;
+                else
+                        return 0.0;
+        }
+
+        inline double peakBandwidth() 
+	{
+                static cusp::detail::once_value<double> peak;
+
+                return cusp::detail::initialize_once( peak, queryPeakBandwidth );
+        }
+
+        /*
+        =============
+        ScopeTimer - Times a scope with a pair of CUDA events per entry. The
+        events are recorded on the current stream and resolved lazily, so
+        entering and leaving a scope never waits for the device. Completed
+        pairs are polled once enough of them are pending and the remaining
+        ones are waited for when the profile is dumped. With
+        CUSP_PROFILE_SYNCHRONIZE each scope waits for its events on exit.
+        =============
+        */
+
+        struct ScopeTimer
+	{
+                struct Interval
+		{
+                        cudaEvent_t start, end;
+                        cudaStream_t stream;
+                };
+
+                enum { MaxPending = 64 };
+
+                unsigned long calls;
+                bool paused;
+                double milliseconds;
+                size_t bytes;
+                size_t flops;
+                size_t peak_device_bytes;   // device memory high-water mark while the scope was open
+
+                ScopeTimer() : calls(0), paused(false), milliseconds(0.0), bytes(0), flops(0), peak_device_bytes(0), mOpen(false) {}
+
+                ~ScopeTimer()
+		{
+                        Release();
+                }
+
+                void operator+=( const ScopeTimer &b )
+		{
+                        milliseconds += b.milliseconds;
+                        calls += b.calls;
+                        bytes += b.bytes;
+                        flops += b.flops;
+                        if ( peak_device_bytes < b.peak_device_bytes )
+                                peak_device_bytes = b.peak_device_bytes;
+                }
+
+                bool is_empty() const { return calls == 0 && milliseconds == 0.0; }
+                bool is_paused() const { return paused; }
+
+                void start()
+		{
+                        ++calls;
+                        Begin();
+                }
+
+                void stop()
+		{
+                        End();
+                #if defined(CUSP_PROFILE_SYNCHRONIZE)
+                        resolve( true );
+                #endif
+                }
+
+                void pause()
+		{
+                        End();
+                        paused = true;
+                }
+
+                void unpause()
+		{
+                        Begin();
+                        paused = false;
+                }
+
+                // close the open interval and reopen it, so that the time of a
+                // running scope is included when the profile is dumped
+                void split()
+		{
+                        if ( !mOpen )
+                                return;
+
+                        cudaStream_t stream = mInterval.stream;
+                        End();
+                        Begin( stream );
+                }
+
+                // add the elapsed time of the completed intervals, or wait
+                // for all of them
+                void resolve( bool wait )
+		{
+                        size_t kept = 0;
+
+                        for ( size_t i = 0; i < mPending.Size(); i++ )
+			{
+                                Interval &interval = mPending[i];
+
+                                if ( wait )
+                                        cudaEventSynchronize( interval.end );
+                                else if ( cudaEventQuery( interval.end ) != cudaSuccess )
+				{
+                                        mPending[kept++] = interval;
+                                        continue;
+                                }
+
+                                float elapsed = 0.0f;
+                                if ( cudaEventElapsedTime( &elapsed, interval.start, interval.end ) == cudaSuccess )
+                                        milliseconds += elapsed;
+
+                                mFree.Push( interval.start );
+                                mFree.Push( interval.end );
+                        }
+
+                        mPending.Truncate( kept );
+                }
+
+                void soft_reset()
+		{
+                        resolve( true );
+                        calls = 0;
+                        milliseconds = 0.0;
+                        bytes = 0;
+                        flops = 0;
+                        peak_device_bytes = 0;
+                }
+
+                void reset()
+		{
+                        Release();
+                        calls = 0;
+                        paused = false;
+                        milliseconds = 0.0;
+                        bytes = 0;
+                        flops = 0;
+                        peak_device_bytes = 0;
+                }
+
+        protected:
+                Buffer<cudaEvent_t> mFree;
+                Buffer<Interval> mPending;
+                Interval mInterval;
+                bool mOpen;
+
+                cudaEvent_t Acquire()
+		{
+                        if ( mFree.Size() )
+                                return mFree.Pop();
+
+                        cudaEvent_t event;
+                        cudaEventCreate( &event );
+                        return event;
+                }
+
+                void Begin( cudaStream_t stream = cusp::detail::current_stream() )
+		{
+                        if ( mOpen )
+                                return;
+
+                        mInterval.start = Acquire();
+                        mInterval.end = Acquire();
+                        mInterval.stream = stream;
+                        cudaEventRecord( mInterval.start, stream );
+                        mOpen = true;
+                }
+
+                void End()
+		{
+                        if ( !mOpen )
+                                return;
+
+                        cudaEventRecord( mInterval.end, mInterval.stream );
+                        mPending.Push( mInterval );
+                        mOpen = false;
+
+                        if ( mPending.Size() >= MaxPending )
+                                resolve( false );
+                }
+
+                void Release()
+		{
+                        for ( size_t i = 0; i < mPending.Size(); i++ )
+			{
+                                cudaEventDestroy( mPending[i].start );
+                                cudaEventDestroy( mPending[i].end );
+                        }
+
+                        while ( mFree.Size() )
+                                cudaEventDestroy( mFree.Pop() );
+
+                        if ( mOpen )
+			{
+                                cudaEventDestroy( mInterval.start );
+                                cudaEventDestroy( mInterval.end );
+                        }
+
+                        mPending.Clear();
+                        mOpen = false;
+                }
+        };
+
+        // ", 12.00 MB, 95.3 GB/s (33% of peak), 4.12 GFLOP/s" for the text
+        // table, or nothing when the scope recorded no work
+        inline void formatRates( char *out, size_t size, const ScopeTimer &timer ) 
+	{
+                out[0] = '\0';
+                if ( !timer.bytes && !timer.flops )
+                        return;
+
+                size_t used = 0;
+                if ( timer.bytes )
+                        used += snprintf( out + used, size - used, ", %.2f MB", timer.bytes / 1e6 );
+
+                if ( timer.milliseconds <= 0.0 )
+                        return;
+
+                if ( timer.bytes ) {
+                        double bandwidth = gigaPerSecond( timer.bytes, timer.milliseconds );
+                        double peak = peakBandwidth();
+                        if ( peak > 0.0 )
+                                used += snprintf( out + used, size - used, ", %.1f GB/s (%.0f%% of peak)", bandwidth, 100.0 * bandwidth / peak );
+                        else
+                                used += snprintf( out + used, size - used, ", %.1f GB/s", bandwidth );
+                }
+
+                if ( timer.flops && used < size )
+                        snprintf( out + used, size - used, ", %.2f GFLOP/s", gigaPerSecond( timer.flops, timer.milliseconds ) );
+        }
+
         /*
         =============
         Caller
@@ -215,12 +479,13 @@ namespace profiler
 
 	protected:
                 const char *mName;
-                cusp::detail::timer mTimer;
+                ScopeTimer mTimer;
                 size_t mBucketCount, mNumChildren;
                 Caller **mBuckets, *mParent;
 
                 bool mActive;
                 unsigned long mChildTicks;
+                size_t mOuterPeak;   // peak of the enclosing memory window while this scope is open
 
         public:
                 // caller
@@ -253,15 +518,17 @@ namespace profiler
 
                 } maxStats;
 
-                // per thread state
+                // per thread state, which outlives its thread. The thread holds
+                // threadLock while it updates its callers, so the profile may
+                // be dumped from another thread
                 struct ThreadState 
 		{
                         CASLock threadLock;
-                        bool requireThreadLock;
                         Caller *activeCaller;
+                        Caller *root;
                 };
                
-                static threadlocal ThreadState thisThread;
+                static threadlocal ThreadState *thisThread;
 
                 struct foreach 
 		{
@@ -341,8 +608,16 @@ namespace profiler
 			{ 
                                 void operator()( Caller *item ) 
 				{ 
-                                        item->GetTimer().soft_reset();
-                                        //item->ForEach( soft_reset() );
+                                        item->SoftReset();
+                                } 
+                        };
+
+                        // Waits for the events of a Caller and its children
+                        struct Resolver 
+			{ 
+                                void operator()( Caller *item ) 
+				{ 
+                                        item->Resolve();
                                 } 
                         };
 
@@ -413,6 +688,10 @@ namespace profiler
                                 Caller &totalitem = ( *mTotals.FindOrCreate( item->mName ) );
                                 totalitem.mTimer.milliseconds += selfticks;
                                 totalitem.mTimer.calls += item->mTimer.calls;
+                                totalitem.mTimer.bytes += item->mTimer.bytes;
+                                totalitem.mTimer.flops += item->mTimer.flops;
+                                if ( totalitem.mTimer.peak_device_bytes < item->mTimer.peak_device_bytes )
+                                        totalitem.mTimer.peak_device_bytes = item->mTimer.peak_device_bytes;
                                 totalitem.SetParent( item->GetParent() );
 
                                 // don't include the root node in the max stats
@@ -442,10 +721,17 @@ namespace profiler
 			{
                                 double ms = item->mTimer.milliseconds;
 				const char * hyphen = strrchr(item->mName,'(');
-				int size = hyphen-item->mName;
+				int size = hyphen ? int(hyphen-item->mName) : int(strlen(item->mName));
 				
-                                printf( "%s %.2f ms, %lu calls: %.*s\n",
-                                        mPrefix, ms, item->mTimer.calls, size, item->mName );
+                                char rates[128];
+                                formatRates( rates, sizeof( rates ), item->mTimer );
+
+                                char peak[64] = "";
+                                if ( item->mTimer.peak_device_bytes )
+                                        snprintf( peak, sizeof( peak ), ", peak %.2f MB", item->mTimer.peak_device_bytes / 1e6 );
+
+                                printf( "%s %.2f ms, %lu calls%s%s: %.*s\n",
+                                        mPrefix, ms, item->mTimer.calls, rates, peak, size, item->mName );
                         }
                 };
 
@@ -527,7 +813,7 @@ namespace profiler
                         return mParent;
                 }
 
-                cusp::detail::timer &GetTimer() 
+                ScopeTimer &GetTimer() 
 		{
                         return mTimer;
                 }
@@ -617,6 +903,12 @@ namespace profiler
                         ForEach( foreach::SoftReset() );
                 }
 
+                void Resolve() 
+		{
+                        mTimer.resolve( true );
+                        ForEach( foreach::Resolver() );
+                }
+
                 void Start() 
 		{
                         mTimer.start();
@@ -627,6 +919,18 @@ namespace profiler
                         mTimer.stop();
                 }
 
+                void OpenMemoryWindow() 
+		{
+                        mOuterPeak = get_device_memory_tracker().open_window();
+                }
+
+                void CloseMemoryWindow() 
+		{
+                        size_t peak = get_device_memory_tracker().close_window( mOuterPeak );
+                        if ( mTimer.peak_device_bytes < peak )
+                                mTimer.peak_device_bytes = peak;
+                }
+
                 void *operator new ( size_t size ) 
 		{
                         return calloc( size, 1 );
@@ -665,7 +969,7 @@ namespace profiler
 
 
 	#if defined(__PROFILER_ENABLED__)
-        threadlocal Caller::ThreadState Caller::thisThread = { {0}, 0, 0 };
+        threadlocal Caller::ThreadState *Caller::thisThread = NULL;
         double Caller::mTimerOverhead = 0.0;
         double Caller::mGlobalDuration = 0.0;
         Caller::Max Caller::maxStats;
@@ -730,8 +1034,10 @@ namespace profiler
                         if ( list ) {
                                 Buffer<Root> &threadsref = *list;
                                 size_t cnt = threadsref.Size();
-                                for ( size_t i = 0; i < cnt; i++ )
+                                for ( size_t i = 0; i < cnt; i++ ) {
                                         delete threadsref[i].root;
+                                        delete threadsref[i].threadState;
+                                }
                         }
                         delete list;
                 }
@@ -754,7 +1060,6 @@ namespace profiler
 
         cudaEvent_t globalStart;
         GlobalThreadList threads = { NULL, {0} };
-        threadlocal Caller *root = NULL;
        
 
         /*
@@ -790,21 +1095,9 @@ namespace profiler
 
         };
 
-        template< class Dumper >
-        void dumpThreads( Dumper dumper ) {
-                float rawDuration;
-    		cudaEvent_t end;
-		cudaEventCreate(&end);
-		cudaEventRecord(end, 0);
-		cudaEventSynchronize(end);
-		cudaEventElapsedTime(&rawDuration, globalStart, end);
-
-                Caller *accumulate = new Caller( "/Top Callers" ), *packer = new Caller( "/Thread Packer" );
-                Buffer<Caller *> packedThreads;
-
-                dumper.Init();
-                dumper.GlobalInfo( rawDuration );
-
+        // copy the callers of all threads into packer, one root per thread
+        void gatherThreads( Caller *packer, Buffer<Caller *> &packedThreads )
+	{
                 threads.AcquireGlobalLock();    
 
                 // crawl the list of theads and store their data in to packer
@@ -812,15 +1105,11 @@ namespace profiler
                 for ( size_t i = 0; i < threadsref.Size(); i++ ) {
                         Root &thread = threadsref[i];
 
-                        // if the thread is no longer active, the lock won't be valid
-                        bool active = ( thread.root->IsActive() );
-                        if ( active ) {
-                                thread.threadState->threadLock.Acquire();
-                                // disable requiring our local lock in case the caller is in our thread, accumulate will try to set it otherwise
-                                Caller::thisThread.requireThreadLock = false;
-                                for ( Caller *walk = thread.threadState->activeCaller; walk; walk = walk->GetParent() )
-                                        walk->GetTimer().soft_stop();
-                        }
+                        // the scopes of a thread don't change while we hold its lock
+                        thread.threadState->threadLock.Acquire();
+                        for ( Caller *walk = thread.threadState->activeCaller; walk; walk = walk->GetParent() )
+                                walk->GetTimer().split();
+                        thread.root->Resolve();
 
                         // create a dummy entry for each thread (fake a name with the address of the thread root)
                         Caller *stub = packer->FindOrCreate( (const char *)thread.root );
@@ -829,14 +1118,188 @@ namespace profiler
                         stubroot->SetParent( NULL ); // for proper crawling
                         packedThreads.Push( stubroot );
 
-                        if ( active ) {
-                                Caller::thisThread.requireThreadLock = true;
-                                thread.threadState->threadLock.Release();
-                        }
+                        thread.threadState->threadLock.Release();
                 }
 
                 // working on local data now, don't need the threads lock any more
                 threads.ReleaseGlobalLock();    
+        }
+
+        // length of a scope name without its argument list
+        inline int scopeNameLength( const char *name ) 
+	{
+                const char *paren = strrchr( name, '(' );
+                return paren ? int( paren - name ) : int( strlen( name ) );
+        }
+
+        inline void writeJsonString( FILE *file, const char *name, int length ) 
+	{
+                fputc( '"', file );
+                for ( int i = 0; i < length; i++ ) {
+                        unsigned char c = (unsigned char)name[i];
+                        if ( c == '"' || c == '\\' )
+                                fprintf( file, "\\%c", c );
+                        else if ( c < 0x20 )
+                                fprintf( file, "\\u%04x", c );
+                        else
+                                fputc( c, file );
+                }
+                fputc( '"', file );
+        }
+
+        // children of a Caller with nonzero statistics, the longest first
+        inline void sortedChildren( Caller *item, Buffer<Caller *> &children ) 
+	{
+                item->CopyToListNonEmpty( children );
+                children.Sort( Caller::compare::Milliseconds() );
+        }
+
+        /*
+                JSON: the scope tree of each thread with inclusive device times
+        */
+
+        struct JsonDumper 
+	{
+                FILE *mFile;
+                bool mFirstThread;
+
+                JsonDumper( FILE *file ) : mFile(file), mFirstThread(true) {}
+
+                void Init() { fprintf( mFile, "{\n" ); }
+                void Finish() { fprintf( mFile, "\n  ]\n}\n" ); }
+
+                void GlobalInfo( float rawDuration ) 
+		{
+                        fprintf( mFile, "  \"milliseconds\": %.6f,\n", rawDuration );
+                }
+
+                void ThreadsInfo( unsigned long totalCalls, double timerOverhead ) 
+		{
+                        fprintf( mFile, "  \"calls\": %lu,\n  \"overhead_milliseconds\": %.6f,\n  \"threads\": [",
+                                 totalCalls, timerOverhead );
+                }
+
+                void WriteCaller( Caller *item, size_t indent ) 
+		{
+                        ScopeTimer &timer = item->GetTimer();
+
+                        fprintf( mFile, "\n%*s{\"name\": ", int(indent), "" );
+                        writeJsonString( mFile, item->GetName(), scopeNameLength( item->GetName() ) );
+                        fprintf( mFile, ", \"milliseconds\": %.6f, \"calls\": %lu, \"bytes\": %lu, \"flops\": %lu, \"peak_device_bytes\": %lu",
+                                 timer.milliseconds, timer.calls, (unsigned long)timer.bytes, (unsigned long)timer.flops,
+                                 (unsigned long)timer.peak_device_bytes );
+                        if ( timer.milliseconds > 0.0 && ( timer.bytes || timer.flops ) )
+                                fprintf( mFile, ", \"gbytes_per_second\": %.6f, \"gflops_per_second\": %.6f",
+                                         gigaPerSecond( timer.bytes, timer.milliseconds ), gigaPerSecond( timer.flops, timer.milliseconds ) );
+
+                        Buffer<Caller *> children;
+                        sortedChildren( item, children );
+
+                        if ( children.Size() ) {
+                                fprintf( mFile, ", \"children\": [" );
+                                for ( size_t i = 0; i < children.Size(); i++ ) {
+                                        WriteCaller( children[i], indent + 2 );
+                                        if ( i + 1 < children.Size() )
+                                                fputc( ',', mFile );
+                                }
+                                fprintf( mFile, "\n%*s]", int(indent), "" );
+                        }
+
+                        fputc( '}', mFile );
+                }
+
+                void PrintThread( Caller *root ) 
+		{
+                        if ( !mFirstThread )
+                                fputc( ',', mFile );
+                        mFirstThread = false;
+                        WriteCaller( root, 4 );
+                }
+
+                void PrintAccumulated( Caller *accumulated ) {}
+        };
+
+        /*
+                Chrome trace events (chrome://tracing, Perfetto): the scopes are
+                aggregated, so each scope becomes one complete event spanning its
+                total time, and the children of a scope are laid out one after
+                another from its start
+        */
+
+        struct ChromeTraceDumper 
+	{
+                FILE *mFile;
+                size_t mThread;
+                bool mFirstEvent;
+
+                ChromeTraceDumper( FILE *file ) : mFile(file), mThread(0), mFirstEvent(true) {}
+
+                void Init() { fprintf( mFile, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" ); }
+                void Finish() { fprintf( mFile, "\n]}\n" ); }
+
+                void GlobalInfo( float rawDuration ) {}
+                void ThreadsInfo( unsigned long totalCalls, double timerOverhead ) {}
+
+                void BeginEvent() 
+		{
+                        fprintf( mFile, mFirstEvent ? "\n" : ",\n" );
+                        mFirstEvent = false;
+                }
+
+                void WriteCaller( Caller *item, double start ) 
+		{
+                        ScopeTimer &timer = item->GetTimer();
+
+                        BeginEvent();
+                        fprintf( mFile, "{\"name\": " );
+                        writeJsonString( mFile, item->GetName(), scopeNameLength( item->GetName() ) );
+                        fprintf( mFile, ", \"ph\": \"X\", \"pid\": 0, \"tid\": %lu, \"ts\": %.3f, \"dur\": %.3f, "
+                                        "\"args\": {\"calls\": %lu, \"bytes\": %lu, \"flops\": %lu, \"peak_device_bytes\": %lu}}",
+                                 (unsigned long)mThread, 1000.0 * start, 1000.0 * timer.milliseconds,
+                                 timer.calls, (unsigned long)timer.bytes, (unsigned long)timer.flops,
+                                 (unsigned long)timer.peak_device_bytes );
+
+                        Buffer<Caller *> children;
+                        sortedChildren( item, children );
+
+                        for ( size_t i = 0; i < children.Size(); i++ ) {
+                                WriteCaller( children[i], start );
+                                start += children[i]->GetTimer().milliseconds;
+                        }
+                }
+
+                void PrintThread( Caller *root ) 
+		{
+                        BeginEvent();
+                        fprintf( mFile, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %lu, \"args\": {\"name\": ",
+                                 (unsigned long)mThread );
+                        writeJsonString( mFile, root->GetName(), scopeNameLength( root->GetName() ) );
+                        fprintf( mFile, "}}" );
+
+                        WriteCaller( root, 0.0 );
+                        mThread++;
+                }
+
+                void PrintAccumulated( Caller *accumulated ) {}
+        };
+
+        template< class Dumper >
+        void dumpThreads( Dumper dumper ) {
+                float rawDuration;
+    		cudaEvent_t end;
+		cudaEventCreate(&end);
+		cudaEventRecord(end, 0);
+		cudaEventSynchronize(end);
+		cudaEventElapsedTime(&rawDuration, globalStart, end);
+		cudaEventDestroy(end);
+
+                Caller *accumulate = new Caller( "/Top Callers" ), *packer = new Caller( "/Thread Packer" );
+                Buffer<Caller *> packedThreads;
+
+                dumper.Init();
+                dumper.GlobalInfo( rawDuration );
+
+                gatherThreads( packer, packedThreads );
 
                 // do the pre-computations on the gathered threads
                 Caller::ComputeChildTicks preprocessor( *accumulate );
@@ -864,74 +1327,237 @@ namespace profiler
                 delete packer;
         }
 
+        // sum the inclusive statistics of each scope over its call paths,
+        // without counting recursive entries twice
+        struct Summarizer 
+	{
+                std::vector<scope_summary> &mScopes;
+
+                Summarizer( std::vector<scope_summary> &scopes ) : mScopes(scopes) {}
+
+                void operator()( Caller *item ) 
+		{
+                        bool recursive = false;
+                        for ( Caller *walk = item->GetParent(); walk; walk = walk->GetParent() )
+                                recursive = recursive || ( walk->GetName() == item->GetName() );
+
+                        size_t i = 0;
+                        while ( i < mScopes.size() && mScopes[i].name != item->GetName() )
+                                i++;
+
+                        if ( i == mScopes.size() ) {
+                                mScopes.push_back( scope_summary() );
+                                mScopes[i].name = item->GetName();
+                        }
+
+                        ScopeTimer &timer = item->GetTimer();
+                        mScopes[i].calls += timer.calls;
+                        mScopes[i].bytes += timer.bytes;
+                        mScopes[i].flops += timer.flops;
+                        if ( mScopes[i].peak_device_bytes < timer.peak_device_bytes )
+                                mScopes[i].peak_device_bytes = timer.peak_device_bytes;
+                        if ( !recursive )
+                                mScopes[i].milliseconds += timer.milliseconds;
+
+                        item->ForEachNonEmpty( *this );
+                }
+        };
+
+        std::vector<scope_summary> summarizeThreads() 
+	{
+                Caller *packer = new Caller( "/Thread Packer" );
+                Buffer<Caller *> packedThreads;
+
+                gatherThreads( packer, packedThreads );
+
+                std::vector<scope_summary> scopes;
+                for ( size_t i = 0; i < packedThreads.Size(); i++ )
+                        packedThreads[i]->ForEachNonEmpty( Summarizer( scopes ) );
+
+                delete packer;
+
+                return scopes;
+        }
+
         void resetThreads() 
 	{
         	cudaEventDestroy(globalStart);
         	cudaEventCreate(&globalStart); 
+        	cudaEventRecord(globalStart,0);
 
-                if ( root )
-                        root->SoftReset();
+                Caller::ThreadState *state = Caller::thisThread;
+                if ( state ) {
+                        state->threadLock.Acquire();
+                        state->root->SoftReset();
+                        state->threadLock.Release();
+                }
         }
 
-        void enterThread( const char *name ) 
+        Caller::ThreadState *enterThread( const char *name ) 
 	{
                 Caller *tmp = new Caller( name );
+                Caller::ThreadState *state = new Caller::ThreadState();
 
                 threads.AcquireGlobalLock();
-                threads.list->Push( Root( tmp, &Caller::thisThread ) );
+                threads.list->Push( Root( tmp, state ) );
 
-                Caller::thisThread.activeCaller = tmp;
+                state->activeCaller = tmp;
+                state->root = tmp;
                 tmp->Start();
                 tmp->SetActive( true );
-                root = tmp;
+                Caller::thisThread = state;
 
                 threads.ReleaseGlobalLock();
+
+                return state;
         }
 
         void exitThread() 
 	{
-                threads.AcquireGlobalLock();
+                Caller::ThreadState *state = Caller::thisThread;
+                if ( !state )
+                        return;
 
-                root->Stop();
-                root->SetActive( false );
-                Caller::thisThread.activeCaller = NULL;
+                state->threadLock.Acquire();
 
-                threads.ReleaseGlobalLock();
+                state->root->Stop();
+                state->root->SetActive( false );
+                state->activeCaller = NULL;
+
+                state->threadLock.Release();
+        }
+
+        inline bool queryNvtxEnabled() 
+	{
+                const char *value = getenv( "CUSP_PROFILE_NVTX" );
+                return !( value && strcmp( value, "0" ) == 0 );
+        }
+
+        // NVTX ranges of the scopes, unless CUSP_PROFILE_NVTX is 0 at run time
+        inline bool nvtxEnabled() 
+	{
+	#if defined(CUSP_PROFILE_NVTX)
+                static cusp::detail::once_value<bool> enabled;
+                return cusp::detail::initialize_once( enabled, queryNvtxEnabled );
+	#else
+                return false;
+	#endif
+        }
+
+        inline void nvtxPush( const char *name ) 
+	{
+	#if defined(CUSP_PROFILE_NVTX)
+                if ( nvtxEnabled() )
+                        nvtxRangePushA( name );
+	#endif
+        }
+
+        inline void nvtxPop() 
+	{
+	#if defined(CUSP_PROFILE_NVTX)
+                if ( nvtxEnabled() )
+                        nvtxRangePop();
+	#endif
+        }
+
+        // the main thread is entered on start-up, other threads when
+        // they enter their first scope
+        inline Caller::ThreadState *currentThread() 
+	{
+                Caller::ThreadState *state = Caller::thisThread;
+                return state ? state : enterThread( "/Thread" );
         }
 
         inline void fastcall enterCaller( const char *name ) 
 	{
-                Caller *parent = Caller::thisThread.activeCaller;
+                Caller::ThreadState *state = currentThread();
+                Caller *parent = state->activeCaller;
                 if ( !parent )
                         return;
                
+                state->threadLock.Acquire();
                 Caller *active = parent->FindOrCreate( name );
                 active->Start();
-                Caller::thisThread.activeCaller = active;
+                active->OpenMemoryWindow();
+                state->activeCaller = active;
+                state->threadLock.Release();
+
+                nvtxPush( name );
         }
 
         inline void exitCaller() 
 	{
-                Caller *active = Caller::thisThread.activeCaller;
-                if ( !active )
+                Caller::ThreadState *state = Caller::thisThread;
+                Caller *active = state ? state->activeCaller : NULL;
+                if ( !active || active == state->root )
                         return;
                
+                state->threadLock.Acquire();
+                active->CloseMemoryWindow();
                 active->Stop();
-                Caller::thisThread.activeCaller = active->GetParent();
+                state->activeCaller = active->GetParent();
+                state->threadLock.Release();
+
+                nvtxPop();
         }
 
         inline void pauseCaller() 
 	{
-                Caller *iter = Caller::thisThread.activeCaller;
-                for ( ; iter; iter = iter->GetParent() )
+                Caller::ThreadState *state = currentThread();
+                state->threadLock.Acquire();
+                for ( Caller *iter = state->activeCaller; iter; iter = iter->GetParent() )
                         iter->GetTimer().pause();
+                state->threadLock.Release();
         }
 
         inline void unpauseCaller() 
 	{
-                Caller *iter = Caller::thisThread.activeCaller;
-                for ( ; iter; iter = iter->GetParent() )
+                Caller::ThreadState *state = currentThread();
+                state->threadLock.Acquire();
+                for ( Caller *iter = state->activeCaller; iter; iter = iter->GetParent() )
                         iter->GetTimer().unpause();
+                state->threadLock.Release();
+        }
+
+        inline void addBytes( size_t bytes ) 
+	{
+                Caller::ThreadState *state = currentThread();
+                if ( !state->activeCaller )
+                        return;
+
+                state->threadLock.Acquire();
+                state->activeCaller->GetTimer().bytes += bytes;
+                state->threadLock.Release();
+        }
+
+        inline void addFlops( size_t flops ) 
+	{
+                Caller::ThreadState *state = currentThread();
+                if ( !state->activeCaller )
+                        return;
+
+                state->threadLock.Acquire();
+                state->activeCaller->GetTimer().flops += flops;
+                state->threadLock.Release();
+        }
+
+        // names built at runtime live until the program exits, since scopes
+        // are keyed by the address of their name
+        inline const char *internName( const char *prefix, size_t index ) 
+	{
+                static CASLock lock;
+                static cusp::detail::once_value< std::set<std::string> * > interned;
+
+                std::set<std::string> *names = cusp::detail::initialize_once( interned, cusp::detail::new_instance< std::set<std::string> > );
+
+                char name[256];
+                snprintf( name, sizeof( name ), "%s %lu", prefix, (unsigned long)index );
+
+                lock.Acquire();
+                const char *result = names->insert( std::string( name ) ).first->c_str();
+                lock.Release();
+
+                return result;
         }
 
         // enter the main thread automatically
@@ -939,22 +1565,18 @@ namespace profiler
 	{
                 MakeRoot() 
 		{
-                        // get an idea of how long timer calls / rdtsc takes
+                        // get an idea of how long a timed scope takes on the device
                         const size_t reps = 1000;
-                        for ( size_t tries = 0; tries < 20; tries++ ) 
+                        ScopeTimer t1, t2;
+                        t1.start();
+                        for ( size_t i = 0; i < reps; i++ ) 
 			{
-                                cusp::detail::timer t1, t2;
-                                t1.start();
-                                for ( size_t i = 0; i < reps; i++ ) 
-				{
-                                        t2.start();
-                                        t2.stop();
-                                }
-                                t1.stop();
-                                double avg = double(t2.milliseconds)/double(reps);
-                                avg = double(t1.milliseconds)/double(reps);
-                                Caller::mTimerOverhead = avg;
+                                t2.start();
+                                t2.stop();
                         }
+                        t1.stop();
+                        t1.resolve( true );
+                        Caller::mTimerOverhead = double(t1.milliseconds)/double(reps);
 
         		cudaEventCreate(&globalStart); 
         		cudaEventRecord(globalStart,0);
@@ -970,21 +1592,69 @@ namespace profiler
 
         void detect( int argc, const char *argv[] ) { detectByArgs( argc, argv ); }
         void detect( const char *commandLine ) { detectWinMain( commandLine ); }
-        void dump() { dumpThreads( PrintfDumper() ); }
+        void dump( dump_format format, const char *filename ) 
+	{
+                // the text table is always printed to stdout
+                if ( format == dump_text ) {
+                        dumpThreads( PrintfDumper() );
+                        fflush( stdout );
+                        return;
+                }
+
+                FILE *file = filename ? fopen( filename, "w" ) : stdout;
+                if ( !file )
+                        return;
+
+                if ( format == dump_json )
+                        dumpThreads( JsonDumper( file ) );
+                else
+                        dumpThreads( ChromeTraceDumper( file ) );
+
+                if ( file != stdout )
+                        fclose( file );
+                else
+                        fflush( file );
+        }
+
+        void dump() 
+	{
+                const char *format = getenv( "CUSP_PROFILE_FORMAT" );
+                const char *filename = getenv( "CUSP_PROFILE_FILE" );
+
+                if ( format && strcmp( format, "json" ) == 0 )
+                        dump( dump_json, filename );
+                else if ( format && strcmp( format, "chrome" ) == 0 )
+                        dump( dump_chrome_trace, filename );
+                else
+                        dump( dump_text, NULL );
+        }
         void fastcall enter( const char *name ) { enterCaller( name ); }
         void fastcall exit() { exitCaller(); }
         void fastcall pause() { pauseCaller(); }
         void fastcall unpause() { unpauseCaller(); }
         void reset() { resetThreads(); }
+        void exit_thread() { exitThread(); }
+        void add_bytes( size_t bytes ) { addBytes( bytes ); }
+        void add_flops( size_t flops ) { addFlops( flops ); }
+        const char *intern( const char *prefix, size_t index ) { return internName( prefix, index ); }
+        double peak_bandwidth() { return peakBandwidth(); }
+        std::vector<scope_summary> summary() { return summarizeThreads(); }
 	#else
         void detect( int argc, const char *argv[] ) {}
         void detect( const char *commandLine ) {}
         void dump() {}
+        void dump( dump_format format, const char *filename ) {}
         void fastcall enter( const char *name ) {}
         void fastcall exit() {}
         void fastcall pause() {}
         void fastcall unpause() {}
         void reset() {}
+        void exit_thread() {}
+        void add_bytes( size_t bytes ) {}
+        void add_flops( size_t flops ) {}
+        const char *intern( const char *prefix, size_t index ) { return prefix; }
+        double peak_bandwidth() { return 0.0; }
+        std::vector<scope_summary> summary() { return std::vector<scope_summary>(); }
 	#endif
 
 } // end namespace profiler
@@ -21,7 +21,8 @@ namespace cusp
 namespace detail
 {
 
-// array view containing random integers
+// array view containing random integers, element i being the Philox
+// counter-based generator applied to i under the seed
 template <typename T>
 class random_integers;
 
@@ -30,7 +30,33 @@ namespace detail
 namespace detail
 {
 
-// Integer hash functions
+// Philox-2x32-10 counter-based generator of Salmon et al., "Parallel
+// Random Numbers: As Easy as 1, 2, 3" (SC 2011).  Ten rounds of a
+// multiply-xor network map the counter (c0,c1) to 64 random bits under a
+// 32-bit key, so every index of a sequence is generated independently of
+// the others, in any order and in either memory space.
+__host__ __device__
+inline void philox2x32(unsigned int& c0, unsigned int& c1, unsigned int key)
+{
+    const unsigned int M = 0xD256D193u;  // multiplier
+    const unsigned int W = 0x9E3779B9u;  // Weyl sequence of the key
+
+    for (int round = 0; round < 10; round++)
+    {
+#ifdef __CUDA_ARCH__
+        const unsigned int hi = __umulhi(M, c0);
+#else
+        const unsigned int hi = (unsigned int) (((unsigned long long) M * c0) >> 32);
+#endif
+        const unsigned int lo = M * c0;
+
+        c0   = hi ^ key ^ c1;
+        c1   = lo;
+        key += W;
+    }
+}
+
+// Random integer of index i in the sequence of a seed
 template <typename IndexType, typename T>
 struct random_integer_functor : public thrust::unary_function<IndexType,T>
 {
@@ -39,38 +65,19 @@ struct random_integer_functor : public thrust::unary_function<IndexType,T>
     random_integer_functor(const size_t seed)
         : seed(seed) {}
 
-    // source: http://www.concentric.net/~ttwang/tech/inthash.htm
     __host__ __device__
-    T hash(const IndexType i, thrust::detail::false_type) const
+    T operator()(const IndexType i) const
     {
-        unsigned int h = (unsigned int) i ^ (unsigned int) seed;
-        h = ~h + (h << 15);
-        h =  h ^ (h >> 12);
-        h =  h + (h <<  2);
-        h =  h ^ (h >>  4);
-        h =  h + (h <<  3) + (h << 11);
-        h =  h ^ (h >> 16);
-        return T(h);
-    }
+        const unsigned long long counter = (unsigned long long) i;
+        const unsigned long long key     = (unsigned long long) seed;
 
-    __host__ __device__
-    T hash(const IndexType i, thrust::detail::true_type) const
-    {
-        unsigned long long h = (unsigned long long) i ^ (unsigned long long) seed;
-        h = ~h + (h << 21);
-        h =  h ^ (h >> 24);
-        h = (h + (h <<  3)) + (h << 8);
-        h =  h ^ (h >> 14);
-        h = (h + (h <<  2)) + (h << 4);
-        h =  h ^ (h >> 28);
-        h =  h + (h << 31);
-        return T(h);
-    }
+        unsigned int c0 = (unsigned int) counter;
+        unsigned int c1 = (unsigned int) (counter >> 32);
 
-    __host__ __device__
-    T operator()(const IndexType i) const
-    {
-        return hash(i, typename thrust::detail::integral_constant<bool, sizeof(IndexType) == 8 || sizeof(T) == 8>::type());
+        philox2x32(c0, c1, (unsigned int) key ^ (unsigned int) (key >> 32));
+
+        // 64-bit types use both words, smaller types the low bits of c0
+        return T(((unsigned long long) c1 << 32) | c0);
     }
 };
 
@@ -0,0 +1,76 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+#include <cusp/detail/mutex.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace cusp
+{
+
+// summation of the BLAS reductions
+enum reduction_mode
+{
+    fast_reduction,          // the order of the reduction kernels
+    reproducible_reduction   // cusp/detail/binned_sum.h, independent of the order
+};
+
+namespace detail
+{
+
+// reproducible_reduction if CUSP_REPRODUCIBLE_REDUCTIONS is "1" or "on"
+inline reduction_mode environment_reduction_mode(void)
+{
+    const char * value = std::getenv("CUSP_REPRODUCIBLE_REDUCTIONS");
+
+    const bool enabled = value && (std::strcmp(value, "1") == 0 || std::strcmp(value, "on") == 0);
+
+    return enabled ? reproducible_reduction : fast_reduction;
+}
+
+// mode of the host threads that select none
+inline reduction_mode& default_reduction_mode_reference(void)
+{
+    static once_value<reduction_mode> mode;
+    return initialize_once(mode, environment_reduction_mode);
+}
+
+// mode selected by the calling thread, or -1 for the default
+inline int& thread_reduction_mode_reference(void)
+{
+    static CUSP_THREAD_LOCAL int mode = -1;
+    return mode;
+}
+
+inline reduction_mode current_reduction_mode(void)
+{
+    const int mode = thread_reduction_mode_reference();
+
+    return mode < 0 ? default_reduction_mode_reference() : reduction_mode(mode);
+}
+
+inline bool reproducible_reductions(void)
+{
+    return current_reduction_mode() == reproducible_reduction;
+}
+
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,573 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/cmath.h>
+#include <cusp/complex.h>
+#include <cusp/exception.h>
+#include <cusp/format.h>
+
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/reduce.h>
+#include <thrust/transform.h>
+#include <thrust/tuple.h>
+
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// The row operations are Thrust algorithms over the arrays of the
+// matrix, so they run in its memory space: one thread per row for the
+// CSR, ELL and DIA reductions, a segmented reduction for COO entries and
+// one thread per stored value for the scalings.  Row counters are zipped
+// with an array of the matrix, which selects the memory space.
+
+// transform, reduce and finalize of a row reduction into values of type T
+template <typename RowReduction, typename T>
+struct row_reduction {};
+
+template <typename T>
+struct row_reduction<cusp::row_sum, T>
+{
+    typedef T result_type;
+
+    template <typename ValueType>
+    __host__ __device__
+    T transform(const ValueType a) const { return T(a); }
+
+    __host__ __device__
+    T reduce(const T a, const T b) const { return a + b; }
+
+    __host__ __device__
+    T finalize(const T a) const { return a; }
+};
+
+template <typename T>
+struct row_reduction<cusp::row_max_abs, T>
+{
+    typedef T result_type;
+
+    template <typename ValueType>
+    __host__ __device__
+    T transform(const ValueType a) const { return T(cusp::abs(a)); }
+
+    __host__ __device__
+    T reduce(const T a, const T b) const { return a < b ? b : a; }
+
+    __host__ __device__
+    T finalize(const T a) const { return a; }
+};
+
+template <typename T>
+struct row_reduction<cusp::row_norm2, T>
+{
+    typedef T result_type;
+
+    template <typename ValueType>
+    __host__ __device__
+    T transform(const ValueType a) const
+    {
+        const T m = T(cusp::abs(a));
+        return m * m;
+    }
+
+    __host__ __device__
+    T reduce(const T a, const T b) const { return a + b; }
+
+    __host__ __device__
+    T finalize(const T a) const { return cusp::sqrt(a); }
+};
+
+template <typename Array>
+typename Array::value_type * row_operation_pointer(Array& a)
+{
+    return a.empty() ? 0 : thrust::raw_pointer_cast(&a[0]);
+}
+
+template <typename Array>
+const typename Array::value_type * row_operation_pointer(const Array& a)
+{
+    return a.empty() ? 0 : thrust::raw_pointer_cast(&a[0]);
+}
+
+template <typename Reduction, typename ValueType>
+struct row_reduction_transform
+{
+    typedef typename Reduction::result_type result_type;
+
+    Reduction reduction;
+
+    row_reduction_transform(Reduction reduction) : reduction(reduction) {}
+
+    __host__ __device__
+    result_type operator()(const ValueType a) const
+    {
+        return reduction.transform(a);
+    }
+};
+
+template <typename Reduction>
+struct row_reduction_reduce
+{
+    typedef typename Reduction::result_type T;
+
+    Reduction reduction;
+
+    row_reduction_reduce(Reduction reduction) : reduction(reduction) {}
+
+    __host__ __device__
+    T operator()(const T a, const T b) const
+    {
+        return reduction.reduce(a, b);
+    }
+};
+
+template <typename Reduction>
+struct row_reduction_finalize
+{
+    typedef typename Reduction::result_type T;
+    typedef T                               result_type;
+
+    Reduction reduction;
+
+    row_reduction_finalize(Reduction reduction) : reduction(reduction) {}
+
+    __host__ __device__
+    T operator()(const T a) const
+    {
+        return reduction.finalize(a);
+    }
+};
+
+// y[i] <- reduce(y[i], s) for the (i, s) of distinct rows
+template <typename Reduction>
+struct row_reduction_accumulate
+{
+    typedef typename Reduction::result_type T;
+
+    Reduction reduction;
+    T * y;
+
+    row_reduction_accumulate(Reduction reduction, T * y) : reduction(reduction), y(y) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(const Tuple& t) const
+    {
+        y[thrust::get<0>(t)] = reduction.reduce(y[thrust::get<0>(t)], thrust::get<1>(t));
+    }
+};
+
+// y_i <- reduce(y_i, A(i,j)...) over the entries of a CSR row
+template <typename IndexType, typename ValueType, typename Reduction>
+struct csr_row_reduce_functor
+{
+    const IndexType * Ap;
+    const ValueType * Ax;
+    Reduction reduction;
+
+    csr_row_reduce_functor(const IndexType * Ap, const ValueType * Ax, Reduction reduction)
+        : Ap(Ap), Ax(Ax), reduction(reduction) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(Tuple t) const
+    {
+        const IndexType i = thrust::get<0>(t);
+
+        typename Reduction::result_type sum = thrust::get<1>(t);
+
+        for (IndexType n = Ap[i]; n < Ap[i + 1]; n++)
+            sum = reduction.reduce(sum, reduction.transform(Ax[n]));
+
+        thrust::get<1>(t) = sum;
+    }
+};
+
+// the same over the slots of an ELL row, up to the first padded slot
+template <typename IndexType, typename ValueType, typename Reduction>
+struct ell_row_reduce_functor
+{
+    const IndexType * Aj;
+    const ValueType * Ax;
+    size_t num_slots;
+    size_t pitch;
+    IndexType invalid_index;
+    Reduction reduction;
+
+    ell_row_reduce_functor(const IndexType * Aj, const ValueType * Ax, const size_t num_slots,
+                           const size_t pitch, const IndexType invalid_index, Reduction reduction)
+        : Aj(Aj), Ax(Ax), num_slots(num_slots), pitch(pitch), invalid_index(invalid_index), reduction(reduction) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(Tuple t) const
+    {
+        const IndexType i = thrust::get<0>(t);
+
+        typename Reduction::result_type sum = thrust::get<1>(t);
+
+        for (size_t n = 0, offset = i; n < num_slots; n++, offset += pitch)
+        {
+            if (Aj[offset] == invalid_index)
+                break;
+
+            sum = reduction.reduce(sum, reduction.transform(Ax[offset]));
+        }
+
+        thrust::get<1>(t) = sum;
+    }
+};
+
+// the same over the diagonals of a DIA row that hold column i + offset
+template <typename IndexType, typename ValueType, typename Reduction>
+struct dia_row_reduce_functor
+{
+    const IndexType * offsets;
+    const ValueType * Ax;
+    size_t num_diagonals;
+    size_t pitch;
+    IndexType num_cols;
+    Reduction reduction;
+
+    dia_row_reduce_functor(const IndexType * offsets, const ValueType * Ax, const size_t num_diagonals,
+                           const size_t pitch, const IndexType num_cols, Reduction reduction)
+        : offsets(offsets), Ax(Ax), num_diagonals(num_diagonals), pitch(pitch), num_cols(num_cols), reduction(reduction) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(Tuple t) const
+    {
+        const IndexType i = thrust::get<0>(t);
+
+        typename Reduction::result_type sum = thrust::get<1>(t);
+
+        for (size_t n = 0; n < num_diagonals; n++)
+        {
+            const IndexType j = i + offsets[n];
+
+            if (j >= 0 && j < num_cols)
+                sum = reduction.reduce(sum, reduction.transform(Ax[n * pitch + i]));
+        }
+
+        thrust::get<1>(t) = sum;
+    }
+};
+
+template <typename Matrix, typename Array, typename Reduction>
+void row_reduce(const Matrix& A, Array& y, Reduction reduction, cusp::coo_format)
+{
+    typedef typename Matrix::index_type      IndexType;
+    typedef typename Matrix::value_type      ValueType;
+    typedef typename Matrix::memory_space    MemorySpace;
+    typedef typename Reduction::result_type  T;
+
+    if (A.num_entries == 0)
+        return;
+
+    cusp::array1d<IndexType, MemorySpace> rows(A.num_entries);
+    cusp::array1d<T, MemorySpace>         sums(A.num_entries);
+
+    // reduce the runs of the sorted rows, then add them to y
+    const size_t num_rows =
+        thrust::reduce_by_key(A.row_indices.begin(), A.row_indices.begin() + A.num_entries,
+                              thrust::make_transform_iterator(A.values.begin(), row_reduction_transform<Reduction, ValueType>(reduction)),
+                              rows.begin(), sums.begin(),
+                              thrust::equal_to<IndexType>(),
+                              row_reduction_reduce<Reduction>(reduction)).first - rows.begin();
+
+    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), sums.begin())),
+                     thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), sums.begin())) + num_rows,
+                     row_reduction_accumulate<Reduction>(reduction, row_operation_pointer(y)));
+}
+
+template <typename Matrix, typename Array, typename Reduction>
+void row_reduce(const Matrix& A, Array& y, Reduction reduction, cusp::csr_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), y.begin())),
+                     thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), y.begin())) + A.num_rows,
+                     csr_row_reduce_functor<IndexType, ValueType, Reduction>
+                        (row_operation_pointer(A.row_offsets), row_operation_pointer(A.values), reduction));
+}
+
+template <typename Matrix, typename Array, typename Reduction>
+void row_reduce(const Matrix& A, Array& y, Reduction reduction, cusp::ell_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), y.begin())),
+                     thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), y.begin())) + A.num_rows,
+                     ell_row_reduce_functor<IndexType, ValueType, Reduction>
+                        (row_operation_pointer(A.column_indices.values), row_operation_pointer(A.values.values),
+                         A.column_indices.num_cols, A.column_indices.pitch, IndexType(Matrix::invalid_index), reduction));
+}
+
+template <typename Matrix, typename Array, typename Reduction>
+void row_reduce(const Matrix& A, Array& y, Reduction reduction, cusp::dia_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), y.begin())),
+                     thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), y.begin())) + A.num_rows,
+                     dia_row_reduce_functor<IndexType, ValueType, Reduction>
+                        (row_operation_pointer(A.diagonal_offsets), row_operation_pointer(A.values.values),
+                         A.diagonal_offsets.size(), A.values.pitch, IndexType(A.num_cols), reduction));
+}
+
+template <typename Matrix, typename Array, typename Reduction>
+void row_reduce(const Matrix& A, Array& y, Reduction reduction, cusp::hyb_format)
+{
+    row_reduce(A.ell, y, reduction, cusp::ell_format());
+    row_reduce(A.coo, y, reduction, cusp::coo_format());
+}
+
+// v <- v * d[i] for the (v, i) of the stored values, skipping the
+// invalid indices of padded slots
+template <typename IndexType, typename ScaleType>
+struct scale_by_index
+{
+    const ScaleType * d;
+    IndexType invalid_index;
+
+    scale_by_index(const ScaleType * d, const IndexType invalid_index = IndexType(-1))
+        : d(d), invalid_index(invalid_index) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(Tuple t) const
+    {
+        const IndexType i = thrust::get<1>(t);
+
+        if (i != invalid_index)
+            thrust::get<0>(t) *= d[i];
+    }
+};
+
+// the same for the entry at position n of the column-major values of a
+// DIA or ELL matrix, whose row is n % pitch and, for DIA, whose column
+// is row + offsets[n / pitch]
+template <typename IndexType, typename ScaleType>
+struct scale_padded
+{
+    const ScaleType * d;
+    const IndexType * offsets;    // null to scale the rows
+    size_t pitch;
+    IndexType num_rows;
+    IndexType num_cols;
+
+    scale_padded(const ScaleType * d, const IndexType * offsets, const size_t pitch,
+                 const IndexType num_rows, const IndexType num_cols)
+        : d(d), offsets(offsets), pitch(pitch), num_rows(num_rows), num_cols(num_cols) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(Tuple t) const
+    {
+        const size_t    n = thrust::get<1>(t);
+        const IndexType i = IndexType(n % pitch);
+
+        if (i >= num_rows)
+            return;
+
+        if (offsets == 0)
+        {
+            thrust::get<0>(t) *= d[i];
+            return;
+        }
+
+        const IndexType j = i + offsets[n / pitch];
+
+        if (j >= 0 && j < num_cols)
+            thrust::get<0>(t) *= d[j];
+    }
+};
+
+template <typename Array1, typename Array2, typename Array3>
+void scale_values(Array1& values, const Array2& indices, const Array3& d, const size_t num_values,
+                  const typename Array2::value_type invalid_index)
+{
+    typedef typename Array2::value_type IndexType;
+    typedef typename Array3::value_type ScaleType;
+
+    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(values.begin(), indices.begin())),
+                     thrust::make_zip_iterator(thrust::make_tuple(values.begin(), indices.begin())) + num_values,
+                     scale_by_index<IndexType, ScaleType>(row_operation_pointer(d), invalid_index));
+}
+
+// scales the rows of an ELL or DIA matrix, or with the offsets of a DIA
+// matrix its columns
+template <typename Matrix, typename Array>
+void scale_padded_values(Matrix& A, const Array& d, const typename Matrix::index_type * offsets)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Array::value_type  ScaleType;
+
+    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(A.values.values.begin(), thrust::counting_iterator<size_t>(0))),
+                     thrust::make_zip_iterator(thrust::make_tuple(A.values.values.begin(), thrust::counting_iterator<size_t>(0))) + A.values.values.size(),
+                     scale_padded<IndexType, ScaleType>(row_operation_pointer(d), offsets,
+                                                        A.values.pitch, IndexType(A.num_rows), IndexType(A.num_cols)));
+}
+
+// v <- v * d[i] over the rows of a CSR matrix
+template <typename IndexType, typename ValueType, typename ScaleType>
+struct csr_scale_rows_functor
+{
+    const IndexType * Ap;
+    ValueType * Ax;
+
+    csr_scale_rows_functor(const IndexType * Ap, ValueType * Ax) : Ap(Ap), Ax(Ax) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(const Tuple& t) const
+    {
+        const IndexType i = thrust::get<0>(t);
+        const ScaleType s = thrust::get<1>(t);
+
+        for (IndexType n = Ap[i]; n < Ap[i + 1]; n++)
+            Ax[n] *= s;
+    }
+};
+
+template <typename Matrix, typename Array>
+void scale_rows(Matrix& A, const Array& d, cusp::coo_format)
+{
+    scale_values(A.values, A.row_indices, d, A.num_entries, typename Matrix::index_type(-1));
+}
+
+template <typename Matrix, typename Array>
+void scale_rows(Matrix& A, const Array& d, cusp::csr_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+    typedef typename Array::value_type  ScaleType;
+
+    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), d.begin())),
+                     thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), d.begin())) + A.num_rows,
+                     csr_scale_rows_functor<IndexType, ValueType, ScaleType>
+                        (row_operation_pointer(A.row_offsets), row_operation_pointer(A.values)));
+}
+
+template <typename Matrix, typename Array>
+void scale_rows(Matrix& A, const Array& d, cusp::ell_format)
+{
+    scale_padded_values(A, d, 0);
+}
+
+template <typename Matrix, typename Array>
+void scale_rows(Matrix& A, const Array& d, cusp::dia_format)
+{
+    scale_padded_values(A, d, 0);
+}
+
+template <typename Matrix, typename Array>
+void scale_rows(Matrix& A, const Array& d, cusp::hyb_format)
+{
+    scale_rows(A.ell, d, cusp::ell_format());
+    scale_rows(A.coo, d, cusp::coo_format());
+}
+
+template <typename Matrix, typename Array>
+void scale_columns(Matrix& A, const Array& d, cusp::coo_format)
+{
+    scale_values(A.values, A.column_indices, d, A.num_entries, typename Matrix::index_type(-1));
+}
+
+template <typename Matrix, typename Array>
+void scale_columns(Matrix& A, const Array& d, cusp::csr_format)
+{
+    scale_values(A.values, A.column_indices, d, A.num_entries, typename Matrix::index_type(-1));
+}
+
+template <typename Matrix, typename Array>
+void scale_columns(Matrix& A, const Array& d, cusp::ell_format)
+{
+    scale_values(A.values.values, A.column_indices.values, d, A.values.values.size(),
+                 typename Matrix::index_type(Matrix::invalid_index));
+}
+
+template <typename Matrix, typename Array>
+void scale_columns(Matrix& A, const Array& d, cusp::dia_format)
+{
+    scale_padded_values(A, d, row_operation_pointer(A.diagonal_offsets));
+}
+
+template <typename Matrix, typename Array>
+void scale_columns(Matrix& A, const Array& d, cusp::hyb_format)
+{
+    scale_columns(A.ell, d, cusp::ell_format());
+    scale_columns(A.coo, d, cusp::coo_format());
+}
+
+} // end namespace detail
+
+template <typename Matrix, typename Array, typename RowReduction>
+void row_reduce(const Matrix& A, Array& y, RowReduction)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Array::value_type T;
+    typedef cusp::detail::row_reduction<RowReduction, T> Reduction;
+
+    y.resize(A.num_rows);
+
+    thrust::fill(y.begin(), y.end(), T(0));
+
+    // dispatch on matrix format
+    cusp::detail::row_reduce(A, y, Reduction(), typename Matrix::format());
+
+    thrust::transform(y.begin(), y.end(), y.begin(), cusp::detail::row_reduction_finalize<Reduction>(Reduction()));
+}
+
+template <typename Matrix, typename Array>
+void scale_rows(Matrix& A, const Array& d)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (d.size() != A.num_rows)
+        throw cusp::invalid_input_exception("scaling factors do not match the number of rows");
+
+    // dispatch on matrix format
+    cusp::detail::scale_rows(A, d, typename Matrix::format());
+}
+
+template <typename Matrix, typename Array>
+void scale_columns(Matrix& A, const Array& d)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (d.size() != A.num_cols)
+        throw cusp::invalid_input_exception("scaling factors do not match the number of columns");
+
+    // dispatch on matrix format
+    cusp::detail::scale_columns(A, d, typename Matrix::format());
+}
+
+} // end namespace cusp
+
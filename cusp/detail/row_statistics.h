@@ -0,0 +1,185 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <thrust/functional.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/tuple.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <cusp/detail/mutex.h>
+#include <cusp/detail/stream.h>
+
+#include <cmath>
+#include <algorithm>
+
+namespace cusp
+{
+namespace detail
+{
+
+// Summary of the distribution of row lengths of a compressed sparse row
+// structure.  SpMV kernels use it to choose a launch configuration, and
+// conversions to HYB reuse the ELL width of an earlier conversion.
+//
+// Containers hold a mutable instance which is filled on first use and
+// is considered stale whenever the shape of the matrix changes.  Access
+// goes through get_row_statistics(), which serializes the threads that
+// share a container.  Since
+// the statistics only guide kernel selection, a stale instance (e.g.
+// after the row_offsets array is modified in place) affects performance
+// but never correctness.  Cached values are never used to size storage:
+// the ELL width of a conversion is computed from the row offsets, and
+// the cached HYB width is checked against the longest row first.
+struct row_statistics
+{
+    bool   valid;
+    size_t num_rows;
+    size_t num_entries;
+    size_t max_length;
+    double mean;
+    double variance;
+
+    // ELL width of the HYB format for the given conversion parameters,
+    // filled on the first conversion to HYB, and the shape and longest
+    // row of the matrix it was derived from
+    bool   hyb_valid;
+    size_t hyb_num_rows;
+    size_t hyb_num_entries;
+    size_t hyb_max_length;
+    float  hyb_relative_speed;
+    size_t hyb_breakeven_threshold;
+    size_t hyb_entries_per_row;
+
+    row_statistics()
+        : valid(false), num_rows(0), num_entries(0), max_length(0), mean(0), variance(0),
+          hyb_valid(false), hyb_num_rows(0), hyb_num_entries(0), hyb_max_length(0),
+          hyb_relative_speed(0), hyb_breakeven_threshold(0), hyb_entries_per_row(0) {}
+
+    template <typename Matrix>
+    bool is_valid(const Matrix& A) const
+    {
+        return valid && num_rows == A.num_rows && num_entries == A.num_entries;
+    }
+
+    void invalidate(void) { valid = false; hyb_valid = false; }
+
+    template <typename Matrix>
+    bool is_hyb_valid(const Matrix& A, const float relative_speed, const size_t breakeven_threshold,
+                      const size_t max_length) const
+    {
+        return hyb_valid && hyb_num_rows == A.num_rows && hyb_num_entries == A.num_entries &&
+               hyb_max_length == max_length &&
+               hyb_relative_speed == relative_speed && hyb_breakeven_threshold == breakeven_threshold;
+    }
+
+    double standard_deviation(void) const { return std::sqrt(variance); }
+};
+
+template <typename IndexType>
+struct row_length_moments
+  : public thrust::unary_function< thrust::tuple<IndexType,IndexType>, thrust::tuple<double,IndexType> >
+{
+    template <typename Tuple>
+    __host__ __device__
+    thrust::tuple<double,IndexType> operator()(const Tuple& t) const
+    {
+        const IndexType length = thrust::get<1>(t) - thrust::get<0>(t);
+        return thrust::make_tuple(double(length) * double(length), length);
+    }
+};
+
+template <typename IndexType>
+struct row_length_moments_reduce
+  : public thrust::binary_function< thrust::tuple<double,IndexType>, thrust::tuple<double,IndexType>, thrust::tuple<double,IndexType> >
+{
+    __host__ __device__
+    thrust::tuple<double,IndexType> operator()(const thrust::tuple<double,IndexType>& a,
+                                               const thrust::tuple<double,IndexType>& b) const
+    {
+        return thrust::make_tuple(thrust::get<0>(a) + thrust::get<0>(b),
+                                  thrust::get<1>(a) < thrust::get<1>(b) ? thrust::get<1>(b) : thrust::get<1>(a));
+    }
+};
+
+// compute row length statistics from a row offsets array of size num_rows + 1
+template <typename OffsetArray>
+row_statistics compute_row_statistics(const OffsetArray& offsets)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename OffsetArray::value_type IndexType;
+
+    row_statistics stats;
+
+    stats.valid       = true;
+    stats.num_rows    = offsets.size() == 0 ? 0 : offsets.size() - 1;
+    stats.num_entries = stats.num_rows == 0 ? 0 : size_t(offsets[stats.num_rows]) - size_t(offsets[0]);
+
+    if (stats.num_rows == 0)
+        return stats;
+
+    thrust::tuple<double,IndexType> moments =
+        cusp::detail::streamed::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(offsets.begin(), offsets.begin() + 1)),
+                                 thrust::make_zip_iterator(thrust::make_tuple(offsets.begin(), offsets.begin() + 1)) + stats.num_rows,
+                                 row_length_moments<IndexType>(),
+                                 thrust::make_tuple(double(0), IndexType(0)),
+                                 row_length_moments_reduce<IndexType>());
+
+    stats.mean       = double(stats.num_entries) / double(stats.num_rows);
+    stats.variance   = std::max(0.0, thrust::get<0>(moments) / double(stats.num_rows) - stats.mean * stats.mean);
+    stats.max_length = thrust::get<1>(moments);
+
+    return stats;
+}
+
+// guards the row statistics held by all containers, since a matrix may
+// be multiplied by several host threads at once
+inline pool_mutex& row_statistics_mutex(void)
+{
+    static once_value<pool_mutex *> mutex;
+    return *initialize_once(mutex, new_instance<pool_mutex>);
+}
+
+// return the cached row statistics of a CSR matrix, computing them if
+// necessary.  A copy is returned, since another thread may refresh the
+// cache meanwhile.
+template <typename Matrix>
+row_statistics get_row_statistics(const Matrix& A)
+{
+    {
+        pool_lock lock(row_statistics_mutex());
+
+        if (A.row_statistics.is_valid(A))
+            return A.row_statistics;
+    }
+
+    // threads that miss the cache at the same time compute the same
+    // statistics, the reduction itself runs unlocked
+    const row_statistics stats = compute_row_statistics(A.row_offsets);
+
+    pool_lock lock(row_statistics_mutex());
+    A.row_statistics = stats;
+
+    return stats;
+}
+
+} // end namespace detail
+} // end namespace cusp
+
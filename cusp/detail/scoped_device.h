@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/exception.h>
+
+#include <cuda_runtime_api.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// make a device current for the lifetime of the object
+class scoped_device
+{
+    public:
+    explicit scoped_device(int device)
+    {
+        cudaGetDevice(&previous);
+
+        if (device != previous)
+            cudaSetDevice(device);
+    }
+
+    ~scoped_device(void)
+    {
+        int device;
+        cudaGetDevice(&device);
+
+        if (device != previous)
+            cudaSetDevice(previous);
+    }
+
+    private:
+    int previous;
+
+    // not copyable
+    scoped_device(const scoped_device&);
+    scoped_device& operator=(const scoped_device&);
+};
+
+inline void check_cuda(cudaError_t status, const char * message)
+{
+    if (status != cudaSuccess)
+        throw cusp::runtime_exception(message);
+}
+
+// allow the devices of the copies to access each others' memory
+inline void enable_peer_access(int device, int peer)
+{
+    if (device == peer)
+        return;
+
+    int can_access = 0;
+    cudaDeviceCanAccessPeer(&can_access, device, peer);
+
+    if (!can_access)
+        return; // copies are staged through the host
+
+    scoped_device scope(device);
+
+    const cudaError_t status = cudaDeviceEnablePeerAccess(peer, 0);
+
+    if (status == cudaErrorPeerAccessAlreadyEnabled)
+        cudaGetLastError(); // clear the error
+    else
+        check_cuda(status, "cudaDeviceEnablePeerAccess failed");
+}
+
+} // end namespace detail
+} // end namespace cusp
+
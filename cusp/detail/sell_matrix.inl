@@ -0,0 +1,62 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/convert.h>
+
+namespace cusp
+{
+
+//////////////////
+// Constructors //
+//////////////////
+
+// construct from a different matrix
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+sell_matrix<IndexType,ValueType,MemorySpace>
+    ::sell_matrix(const MatrixType& matrix)
+    : slice_size(32), sorting_window(1024)
+    {
+        cusp::convert(matrix, *this);
+    }
+
+// construct from a different matrix with given slice parameters
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+sell_matrix<IndexType,ValueType,MemorySpace>
+    ::sell_matrix(const MatrixType& matrix, size_t slice_size, size_t sorting_window)
+    : slice_size(slice_size), sorting_window(sorting_window)
+    {
+        cusp::convert(matrix, *this);
+    }
+
+//////////////////////
+// Member Functions //
+//////////////////////
+
+// assignment from another matrix
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename MatrixType>
+    sell_matrix<IndexType,ValueType,MemorySpace>&
+    sell_matrix<IndexType,ValueType,MemorySpace>
+    ::operator=(const MatrixType& matrix)
+    {
+        cusp::convert(matrix, *this);
+
+        return *this;
+    }
+
+} // end namespace cusp
@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+#include <cusp/detail/mutex.h>
+
+#include <cusp/detail/stream.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace cusp
+{
+
+// engine of the device sparse operations
+enum sparse_engine
+{
+    builtin_engine,   // the kernels in cusp/detail/device
+    cusparse_engine   // cuSPARSE, when Cusp is built with CUSP_USE_CUSPARSE
+};
+
+namespace detail
+{
+
+// whether Cusp was built with cuSPARSE
+inline bool cusparse_available(void)
+{
+#if defined(CUSP_USE_CUSPARSE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// cuSPARSE when it is available, unless CUSP_DEVICE_VENDOR is "0" or "off"
+inline sparse_engine environment_sparse_engine(void)
+{
+    const char * value = std::getenv("CUSP_DEVICE_VENDOR");
+
+    const bool disabled = value && (std::strcmp(value, "0") == 0 || std::strcmp(value, "off") == 0);
+
+    return cusparse_available() && !disabled ? cusparse_engine : builtin_engine;
+}
+
+// engine of the host threads that select none
+inline sparse_engine& default_sparse_engine_reference(void)
+{
+    static once_value<sparse_engine> engine;
+    return initialize_once(engine, environment_sparse_engine);
+}
+
+// engine selected by the calling thread, or -1 for the default
+inline int& thread_sparse_engine_reference(void)
+{
+    static CUSP_THREAD_LOCAL int engine = -1;
+    return engine;
+}
+
+inline sparse_engine current_sparse_engine(void)
+{
+    const int engine = thread_sparse_engine_reference();
+
+    return engine < 0 ? default_sparse_engine_reference() : sparse_engine(engine);
+}
+
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,51 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+namespace cusp
+{
+
+//////////////////
+// Constructors //
+//////////////////
+
+// construct from a different sparse vector
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename IndexType2, typename ValueType2, typename MemorySpace2>
+sparse_vector<IndexType,ValueType,MemorySpace>
+    ::sparse_vector(const sparse_vector<IndexType2,ValueType2,MemorySpace2>& vector)
+    : length(vector.length), num_entries(vector.num_entries),
+      indices(vector.indices), values(vector.values) {}
+
+////////////////////////////////
+// Container Member Functions //
+////////////////////////////////
+
+// assignment from a different sparse vector
+template <typename IndexType, typename ValueType, class MemorySpace>
+template <typename IndexType2, typename ValueType2, typename MemorySpace2>
+    sparse_vector<IndexType,ValueType,MemorySpace>&
+    sparse_vector<IndexType,ValueType,MemorySpace>
+    ::operator=(const sparse_vector<IndexType2,ValueType2,MemorySpace2>& vector)
+    {
+        length      = vector.length;
+        num_entries = vector.num_entries;
+        indices     = vector.indices;
+        values      = vector.values;
+
+        return *this;
+    }
+
+} // end namespace cusp
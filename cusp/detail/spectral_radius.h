@@ -18,20 +18,28 @@
 #pragma once
 
 #include <cusp/blas.h>
+#include <cusp/copy.h>
 #include <cusp/multiply.h>
 #include <cusp/krylov/arnoldi.h>
 #include <cusp/array1d.h>
 #include <cusp/array2d.h>
 #include <cusp/detail/random.h>
 #include <cusp/detail/format_utils.h>
+#include <cusp/eigen/detail/symmetric_eigen.h>
 
 #include <thrust/extrema.h>
 #include <thrust/transform.h>
 #include <thrust/iterator/counting_iterator.h>
+#include <thrust/for_each.h>
 #include <thrust/reduce.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/iterator/zip_iterator.h>
 
 #include <thrust/detail/integer_traits.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace cusp
 {
 namespace detail
@@ -106,6 +114,220 @@ double ritz_spectral_radius_symmetric(const Matrix& A, size_t k = 10)
     return estimate_spectral_radius(H);
 }
 
+// |d| x^2
+template <typename ValueType>
+struct d_square
+{
+    template <typename Tuple>
+    __host__ __device__
+    ValueType operator()(const Tuple& t) const
+    {
+        const ValueType x = thrust::get<0>(t);
+        const ValueType d = thrust::get<1>(t);
+        return (d < 0 ? -d : d) * x * x;
+    }
+};
+
+// |d| (y / d) q, a term of the |D| inner product of D^-1 y and q
+template <typename ValueType>
+struct dinv_dot
+{
+    template <typename Tuple>
+    __host__ __device__
+    ValueType operator()(const Tuple& t) const
+    {
+        const ValueType yq = thrust::get<0>(t) * thrust::get<2>(t);
+        return thrust::get<1>(t) < 0 ? -yq : yq;
+    }
+};
+
+// p <- y / d - alpha * q - beta * p, where p is not read when beta is zero
+template <typename ValueType>
+struct dinv_lanczos_update
+{
+    ValueType alpha;
+    ValueType beta;
+
+    dinv_lanczos_update(ValueType alpha, ValueType beta) : alpha(alpha), beta(beta) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(Tuple t) const
+    {
+        const ValueType w = thrust::get<0>(t) / thrust::get<1>(t) - alpha * thrust::get<2>(t);
+
+        if (beta == ValueType(0))
+            thrust::get<3>(t) = w;
+        else
+            thrust::get<3>(t) = w - beta * thrust::get<3>(t);
+    }
+};
+
+// State of the estimate of the spectral radius of D^-1 A, where D is the
+// diagonal of A.  It is kept with the matrix (e.g. on a multigrid level),
+// so that an estimate for new values of A starts from the Ritz vector of
+// the previous estimate and reuses the storage of the vectors.
+template <typename ValueType, typename MemorySpace>
+struct rho_Dinv_A_state
+{
+    ValueType rho;                                  // last estimate
+    cusp::array1d<ValueType,MemorySpace> diagonal;  // D, unless the estimate is given D
+    cusp::array1d<ValueType,MemorySpace> x;         // Ritz vector of rho
+    cusp::array1d<ValueType,MemorySpace> p;         // Lanczos vectors
+    cusp::array1d<ValueType,MemorySpace> q;
+    cusp::array1d<ValueType,MemorySpace> y;         // A q
+
+    rho_Dinv_A_state(void) : rho(0) {}
+};
+
+namespace spectral_radius_detail
+{
+  template <typename Array>
+  typename Array::value_type d_norm(const Array& x, const Array& diagonal)
+  {
+    typedef typename Array::value_type ValueType;
+
+    return std::sqrt(thrust::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(x.begin(), diagonal.begin())),
+                                              thrust::make_zip_iterator(thrust::make_tuple(x.end(),   diagonal.end())),
+                                              d_square<ValueType>(), ValueType(0), thrust::plus<ValueType>()));
+  }
+
+  // q <- A q, p <- D^-1 y - alpha q - beta p, returns alpha = <D^-1 A q, q>
+  // when alpha is not given
+  template <typename MatrixType, typename Array, typename State, typename ValueType>
+  void lanczos_step(const MatrixType& A, const Array& diagonal, State& state, ValueType& alpha, const ValueType beta, const bool compute_alpha)
+  {
+    cusp::multiply(A, state.q, state.y);
+
+    if (compute_alpha)
+      alpha = thrust::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(state.y.begin(), diagonal.begin(), state.q.begin())),
+                                       thrust::make_zip_iterator(thrust::make_tuple(state.y.end(),   diagonal.end(),   state.q.end())),
+                                       dinv_dot<ValueType>(), ValueType(0), thrust::plus<ValueType>());
+
+    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(state.y.begin(), diagonal.begin(), state.q.begin(), state.p.begin())),
+                     thrust::make_zip_iterator(thrust::make_tuple(state.y.end(),   diagonal.end(),   state.q.end(),   state.p.end())),
+                     dinv_lanczos_update<ValueType>(alpha, beta));
+  }
+} // end namespace spectral_radius_detail
+
+// Spectral radius of D^-1 A for symmetric A, from k steps of the Lanczos
+// method in the |D| inner product, in which D^-1 A is symmetric when the
+// diagonal has a constant sign.  A step is a product with A, one fused
+// update of the three-term recurrence and two reductions, whose results
+// are the only values copied to the host.  The largest eigenvalue of the
+// k x k tridiagonal matrix is the estimate, and a second sweep of the
+// recurrence forms its Ritz vector in the state.  A state that holds the
+// Ritz vector of a matrix of the same size is warm-started from it with
+// warm_iterations steps, otherwise a random start vector takes
+// cold_iterations steps.  Only the first call allocates.  The diagonal D
+// of A is given, e.g. by a diagonal_cache shared with other setup steps,
+// and state.diagonal is left untouched.
+template <typename MatrixType, typename Array, typename ValueType, typename MemorySpace>
+double estimate_rho_Dinv_A(const MatrixType& A,
+                           const Array& diagonal,
+                           rho_Dinv_A_state<ValueType,MemorySpace>& state,
+                           size_t cold_iterations = 8,
+                           size_t warm_iterations = 4)
+{
+    CUSP_PROFILE_SCOPED();
+
+    namespace sr = spectral_radius_detail;
+
+    const size_t N = A.num_rows;
+
+    size_t k = warm_iterations;
+
+    // initialize x to random values in [0,1)
+    if (state.x.size() != N)
+    {
+        k = cold_iterations;
+        cusp::copy(cusp::detail::random_reals<ValueType>(N), state.x);
+    }
+
+    k = std::min(k, N);
+
+    state.p.resize(N);
+    state.q.resize(N);
+    state.y.resize(N);
+
+    const ValueType x_norm = sr::d_norm(state.x, diagonal);
+
+    if (k == 0 || x_norm == 0)
+    {
+        state.x.resize(0);
+        return state.rho = 0;
+    }
+
+    cusp::blas::scal(state.x, ValueType(1) / x_norm);
+
+    // tridiagonal matrix of the Lanczos method
+    cusp::array1d<ValueType,cusp::host_memory> alpha(k);
+    cusp::array1d<ValueType,cusp::host_memory> beta(k, ValueType(0));
+
+    cusp::blas::copy(state.x, state.q);
+
+    size_t m = 0;
+
+    while (m < k)
+    {
+        sr::lanczos_step(A, diagonal, state, alpha[m], m == 0 ? ValueType(0) : beta[m - 1], true);
+        m++;
+
+        if (m == k)
+            break;
+
+        beta[m - 1] = sr::d_norm(state.p, diagonal);
+
+        if (beta[m - 1] == ValueType(0))
+            break;
+
+        cusp::blas::scal(state.p, ValueType(1) / beta[m - 1]);
+        state.p.swap(state.q);
+    }
+
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> T(m, m, ValueType(0));
+    for (size_t i = 0; i < m; i++)
+    {
+        T(i,i) = alpha[i];
+        if (i + 1 < m)
+            T(i,i + 1) = T(i + 1,i) = beta[i];
+    }
+
+    cusp::array1d<ValueType,cusp::host_memory> theta;
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> Z;
+    cusp::eigen::detail::symmetric_eigen(T, theta, Z);
+
+    // the Ritz vector x <- sum_i Z(i,m-1) q_i from a second sweep
+    cusp::blas::copy(state.x, state.q);
+    cusp::blas::scal(state.x, Z(0,m - 1));
+
+    for (size_t i = 1; i < m; i++)
+    {
+        sr::lanczos_step(A, diagonal, state, alpha[i - 1], i == 1 ? ValueType(0) : beta[i - 2], false);
+
+        cusp::blas::scal(state.p, ValueType(1) / beta[i - 1]);
+        state.p.swap(state.q);
+
+        cusp::blas::axpy(state.q, state.x, Z(i,m - 1));
+    }
+
+    state.rho = theta[m - 1];
+
+    return state.rho;
+}
+
+// as above, with D extracted into state.diagonal
+template <typename MatrixType, typename ValueType, typename MemorySpace>
+double estimate_rho_Dinv_A(const MatrixType& A,
+                           rho_Dinv_A_state<ValueType,MemorySpace>& state,
+                           size_t cold_iterations = 8,
+                           size_t warm_iterations = 4)
+{
+    cusp::detail::extract_diagonal(A, state.diagonal);
+
+    return estimate_rho_Dinv_A(A, state.diagonal, state, cold_iterations, warm_iterations);
+}
+
 template <typename IndexType, typename ValueType, typename MemorySpace>    
 double disks_spectral_radius(const cusp::coo_matrix<IndexType,ValueType,MemorySpace>& A)
 {
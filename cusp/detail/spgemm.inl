@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/host/detail/csr.h>
+#include <cusp/detail/device/spmm/csr_numeric.h>
+
+#include <thrust/copy.h>
+#include <thrust/fill.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// the host product leaves the entries of each row unsorted
+template <typename Matrix>
+void sort_spgemm_pattern(Matrix& C, cusp::host_memory)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    cusp::array1d<IndexType,cusp::host_memory> row_indices(C.num_entries);
+    cusp::detail::offsets_to_indices(C.row_offsets, row_indices);
+    cusp::detail::sort_by_row_and_column(row_indices, C.column_indices, C.values, C.num_rows, C.num_cols);
+}
+
+template <typename Matrix>
+void sort_spgemm_pattern(Matrix& C, cusp::device_memory)
+{
+    // the device product is sorted
+}
+
+template <typename Matrix1, typename Matrix2, typename Array1, typename Array2, typename Array3>
+void spgemm_numeric(const Matrix1& A, const Matrix2& B,
+                    const Array1& C_row_offsets, const Array2& C_column_indices, Array3& C_values,
+                    cusp::host_memory)
+{
+    cusp::detail::host::detail::spmm_csr_numeric(A, B, C_row_offsets, C_column_indices, C_values);
+}
+
+template <typename Matrix1, typename Matrix2, typename Array1, typename Array2, typename Array3>
+void spgemm_numeric(const Matrix1& A, const Matrix2& B,
+                    const Array1& C_row_offsets, const Array2& C_column_indices, Array3& C_values,
+                    cusp::device_memory)
+{
+    cusp::detail::device::spmm_csr_numeric(A, B, C_row_offsets, C_column_indices, C_values);
+}
+
+} // end namespace detail
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename IndexType,
+          typename MemorySpace>
+void spgemm_symbolic(const Matrix1& A,
+                     const Matrix2& B,
+                     cusp::spgemm_plan<IndexType, MemorySpace>& plan)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (A.num_cols != B.num_rows)
+        throw cusp::invalid_input_exception("matrix dimensions do not match");
+
+    // the pattern of A * B is that of the product of the patterns of A and B
+    // with unit values, which cannot cancel
+    typedef cusp::csr_matrix<IndexType, float, MemorySpace> Pattern;
+
+    Pattern A_pattern(A.num_rows, A.num_cols, A.num_entries);
+    thrust::copy(A.row_offsets.begin(),    A.row_offsets.end(),    A_pattern.row_offsets.begin());
+    thrust::copy(A.column_indices.begin(), A.column_indices.end(), A_pattern.column_indices.begin());
+    thrust::fill(A_pattern.values.begin(), A_pattern.values.end(), 1.0f);
+
+    Pattern B_pattern(B.num_rows, B.num_cols, B.num_entries);
+    thrust::copy(B.row_offsets.begin(),    B.row_offsets.end(),    B_pattern.row_offsets.begin());
+    thrust::copy(B.column_indices.begin(), B.column_indices.end(), B_pattern.column_indices.begin());
+    thrust::fill(B_pattern.values.begin(), B_pattern.values.end(), 1.0f);
+
+    Pattern C_pattern;
+    cusp::multiply(A_pattern, B_pattern, C_pattern);
+
+    cusp::detail::sort_spgemm_pattern(C_pattern, MemorySpace());
+
+    plan.num_rows      = C_pattern.num_rows;
+    plan.num_cols      = C_pattern.num_cols;
+    plan.num_entries   = C_pattern.num_entries;
+    plan.A_num_entries = A.num_entries;
+    plan.B_num_entries = B.num_entries;
+
+    plan.row_offsets.swap(C_pattern.row_offsets);
+    plan.column_indices.swap(C_pattern.column_indices);
+}
+
+template <typename Matrix1,
+          typename Matrix2,
+          typename IndexType,
+          typename MemorySpace,
+          typename Matrix3>
+void spgemm_numeric(const Matrix1& A,
+                    const Matrix2& B,
+                    const cusp::spgemm_plan<IndexType, MemorySpace>& plan,
+                          Matrix3& C)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (A.num_rows != plan.num_rows || B.num_cols != plan.num_cols || A.num_cols != B.num_rows)
+        throw cusp::invalid_input_exception("matrix dimensions do not match the spgemm_plan");
+
+    if (A.num_entries != plan.A_num_entries || B.num_entries != plan.B_num_entries)
+        throw cusp::invalid_input_exception("matrix sparsity patterns do not match the spgemm_plan");
+
+    C.resize(plan.num_rows, plan.num_cols, plan.num_entries);
+
+    thrust::copy(plan.row_offsets.begin(),    plan.row_offsets.end(),    C.row_offsets.begin());
+    thrust::copy(plan.column_indices.begin(), plan.column_indices.end(), C.column_indices.begin());
+
+    cusp::detail::spgemm_numeric(A, B, C.row_offsets, C.column_indices, C.values, MemorySpace());
+}
+
+} // end namespace cusp
+
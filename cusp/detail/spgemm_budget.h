@@ -0,0 +1,101 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+#include <cusp/detail/stream.h>
+
+#include <cstddef>
+
+// Workspace budget of the sparse matrix-matrix products.
+//
+// multiply(A, B, C, workspace) installs the budget of its spgemm_workspace
+// for the calling host thread, in the same way as scoped_stream selects
+// the current stream, so that the SpGEMM kernels deep in the dispatch see
+// it without an extra argument at every level.  The kernels size their
+// workspace against the budget and count the slabs (row blocks of A) the
+// product was split into.
+
+namespace cusp
+{
+namespace detail
+{
+
+struct spgemm_budget
+{
+    size_t bytes;       // 0 lets each method choose from the free memory
+    size_t num_slabs;   // slabs processed since the budget was installed
+};
+
+inline spgemm_budget*& current_spgemm_budget_reference(void)
+{
+    static CUSP_THREAD_LOCAL spgemm_budget * budget = 0;
+    return budget;
+}
+
+// bytes the current product may use for its workspace, or 0
+inline size_t spgemm_budget_bytes(void)
+{
+    spgemm_budget * budget = current_spgemm_budget_reference();
+    return budget ? budget->bytes : 0;
+}
+
+// number of elements of element_bytes each that fit in the budget, at
+// least one, or default_capacity without a budget
+inline size_t spgemm_budget_capacity(const size_t element_bytes, const size_t default_capacity)
+{
+    const size_t bytes = spgemm_budget_bytes();
+
+    if (bytes == 0)
+        return default_capacity;
+
+    return bytes / element_bytes > 0 ? bytes / element_bytes : 1;
+}
+
+inline void spgemm_count_slabs(const size_t num_slabs)
+{
+    spgemm_budget * budget = current_spgemm_budget_reference();
+
+    if (budget)
+        budget->num_slabs += num_slabs;
+}
+
+class scoped_spgemm_budget
+{
+    public:
+    explicit scoped_spgemm_budget(spgemm_budget& budget)
+        : previous(current_spgemm_budget_reference())
+    {
+        current_spgemm_budget_reference() = &budget;
+    }
+
+    ~scoped_spgemm_budget(void)
+    {
+        current_spgemm_budget_reference() = previous;
+    }
+
+    private:
+    spgemm_budget * previous;
+
+    // not copyable
+    scoped_spgemm_budget(const scoped_spgemm_budget&);
+    scoped_spgemm_budget& operator=(const scoped_spgemm_budget&);
+};
+
+} // end namespace detail
+} // end namespace cusp
+
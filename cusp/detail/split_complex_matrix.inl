@@ -0,0 +1,223 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/convert.h>
+#include <cusp/detail/stream.h>
+
+#include <thrust/functional.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+template <typename RealType>
+struct complex_real_part : public thrust::unary_function<cusp::complex<RealType>, RealType>
+{
+    __host__ __device__
+    RealType operator()(const cusp::complex<RealType>& z) const
+    {
+        return z.real();
+    }
+};
+
+template <typename RealType>
+struct complex_imag_part : public thrust::unary_function<cusp::complex<RealType>, RealType>
+{
+    __host__ __device__
+    RealType operator()(const cusp::complex<RealType>& z) const
+    {
+        return z.imag();
+    }
+};
+
+template <typename RealType>
+struct make_complex_value : public thrust::binary_function<RealType, RealType, cusp::complex<RealType> >
+{
+    __host__ __device__
+    cusp::complex<RealType> operator()(const RealType& re, const RealType& im) const
+    {
+        return cusp::complex<RealType>(re, im);
+    }
+};
+
+// split an array of complex values into real parts and imaginary parts at imag
+template <typename Array1, typename Array2, typename Iterator>
+void split_complex_values(const Array1& values, Array2& real, Iterator imag)
+{
+    typedef typename Array2::value_type RealType;
+
+    cusp::detail::streamed::transform(values.begin(), values.end(), real.begin(), complex_real_part<RealType>());
+    cusp::detail::streamed::transform(values.begin(), values.end(), imag,        complex_imag_part<RealType>());
+}
+
+template <typename Array1, typename Iterator, typename Array2>
+void merge_complex_values(const Array1& real, Iterator imag, Array2& values)
+{
+    typedef typename Array1::value_type RealType;
+
+    cusp::detail::streamed::transform(real.begin(), real.end(), imag, values.begin(), make_complex_value<RealType>());
+}
+
+// complex matrix * real matrix + imaginary parts
+template <typename ComplexMatrix, typename RealMatrix, typename Array>
+void split_complex(const ComplexMatrix& src, RealMatrix& real, Array& imag, cusp::csr_format)
+{
+    real.resize(src.num_rows, src.num_cols, src.num_entries);
+    real.row_offsets    = src.row_offsets;
+    real.column_indices = src.column_indices;
+
+    imag.resize(src.values.size());
+
+    split_complex_values(src.values, real.values, imag.begin());
+}
+
+template <typename ComplexMatrix, typename RealMatrix, typename Array>
+void split_complex(const ComplexMatrix& src, RealMatrix& real, Array& imag, cusp::ell_format)
+{
+    real.resize(src.num_rows, src.num_cols, src.num_entries, 0);
+    real.column_indices = src.column_indices;
+    real.values.resize(src.values.num_rows, src.values.num_cols, src.values.pitch);
+
+    imag.resize(src.values.values.size());
+
+    split_complex_values(src.values.values, real.values.values, imag.begin());
+}
+
+template <typename ComplexMatrix, typename RealMatrix, typename Array>
+void split_complex(const ComplexMatrix& src, RealMatrix& real, Array& imag, cusp::hyb_format)
+{
+    const size_t num_ell_values = src.ell.values.values.size();
+
+    real.resize(src.num_rows, src.num_cols, 0, src.coo.num_entries, 0);
+    real.ell.resize(src.ell.num_rows, src.ell.num_cols, src.ell.num_entries, 0);
+    real.ell.column_indices = src.ell.column_indices;
+    real.ell.values.resize(src.ell.values.num_rows, src.ell.values.num_cols, src.ell.values.pitch);
+    real.coo.row_indices    = src.coo.row_indices;
+    real.coo.column_indices = src.coo.column_indices;
+    real.num_entries        = src.num_entries;
+
+    imag.resize(num_ell_values + src.coo.values.size());
+
+    split_complex_values(src.ell.values.values, real.ell.values.values, imag.begin());
+    split_complex_values(src.coo.values,        real.coo.values,        imag.begin() + num_ell_values);
+}
+
+// real matrix + imaginary parts -> complex matrix
+template <typename RealMatrix, typename Array, typename ComplexMatrix>
+void merge_complex(const RealMatrix& real, const Array& imag, ComplexMatrix& dst, cusp::csr_format)
+{
+    dst.resize(real.num_rows, real.num_cols, real.num_entries);
+    dst.row_offsets    = real.row_offsets;
+    dst.column_indices = real.column_indices;
+
+    merge_complex_values(real.values, imag.begin(), dst.values);
+}
+
+template <typename RealMatrix, typename Array, typename ComplexMatrix>
+void merge_complex(const RealMatrix& real, const Array& imag, ComplexMatrix& dst, cusp::ell_format)
+{
+    dst.resize(real.num_rows, real.num_cols, real.num_entries, 0);
+    dst.column_indices = real.column_indices;
+    dst.values.resize(real.values.num_rows, real.values.num_cols, real.values.pitch);
+
+    merge_complex_values(real.values.values, imag.begin(), dst.values.values);
+}
+
+template <typename RealMatrix, typename Array, typename ComplexMatrix>
+void merge_complex(const RealMatrix& real, const Array& imag, ComplexMatrix& dst, cusp::hyb_format)
+{
+    const size_t num_ell_values = real.ell.values.values.size();
+
+    dst.resize(real.num_rows, real.num_cols, 0, real.coo.num_entries, 0);
+    dst.ell.resize(real.ell.num_rows, real.ell.num_cols, real.ell.num_entries, 0);
+    dst.ell.column_indices = real.ell.column_indices;
+    dst.ell.values.resize(real.ell.values.num_rows, real.ell.values.num_cols, real.ell.values.pitch);
+    dst.coo.row_indices    = real.coo.row_indices;
+    dst.coo.column_indices = real.coo.column_indices;
+    dst.num_entries        = real.num_entries;
+
+    merge_complex_values(real.ell.values.values, imag.begin(),                  dst.ell.values.values);
+    merge_complex_values(real.coo.values,        imag.begin() + num_ell_values, dst.coo.values);
+}
+
+// assignment of a split_complex_matrix, possibly in another memory space
+template <typename SourceType, typename Matrix>
+void assign_split_complex(const SourceType& src, cusp::split_complex_matrix<Matrix>& dst, cusp::split_complex_format)
+{
+    dst.real = src.real;
+    dst.imag = src.imag;
+    dst.resize(src.num_rows, src.num_cols, src.num_entries);
+}
+
+// assignment of another matrix, converted to the complex container first
+template <typename SourceType, typename Matrix, typename Format>
+void assign_split_complex(const SourceType& src, cusp::split_complex_matrix<Matrix>& dst, Format)
+{
+    typedef typename cusp::split_complex_matrix<Matrix>::complex_matrix_type ComplexMatrix;
+
+    ComplexMatrix tmp(src);
+
+    cusp::detail::split_complex(tmp, dst.real, dst.imag, typename Matrix::format());
+    dst.resize(tmp.num_rows, tmp.num_cols, tmp.num_entries);
+}
+
+} // end namespace detail
+
+//////////////////
+// Constructors //
+//////////////////
+
+// construct from a different matrix
+template <typename Matrix>
+template <typename MatrixType>
+split_complex_matrix<Matrix>
+    ::split_complex_matrix(const MatrixType& matrix)
+    {
+        cusp::detail::assign_split_complex(matrix, *this, typename MatrixType::format());
+    }
+
+//////////////////////
+// Member Functions //
+//////////////////////
+
+// assignment from another matrix
+template <typename Matrix>
+template <typename MatrixType>
+    split_complex_matrix<Matrix>&
+    split_complex_matrix<Matrix>
+    ::operator=(const MatrixType& matrix)
+    {
+        cusp::detail::assign_split_complex(matrix, *this, typename MatrixType::format());
+
+        return *this;
+    }
+
+template <typename Matrix>
+template <typename MatrixType>
+    void
+    split_complex_matrix<Matrix>
+    ::merge(MatrixType& matrix) const
+    {
+        complex_matrix_type tmp;
+
+        cusp::detail::merge_complex(real, imag, tmp, typename Matrix::format());
+
+        cusp::convert(tmp, matrix);
+    }
+
+} // end namespace cusp
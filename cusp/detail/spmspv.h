@@ -0,0 +1,366 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/exception.h>
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/device/spmv/semiring.h>
+
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/gather.h>
+#include <thrust/inner_product.h>
+#include <thrust/reduce.h>
+#include <thrust/scan.h>
+#include <thrust/scatter.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+// Products of a CSR matrix with a sparse vector (SpMSpV).
+//
+// y = A x is computed by rows (pull): the positions of the entries of x
+// are scattered to a dense array and every row sums its entries whose
+// column is stored in x.  y = A^T x, the product of the CSC matrix A^T,
+// is computed by columns (push): the rows of A named by x are expanded,
+// sorted by column and reduced, which costs only the edges of the
+// frontier.  Once the frontier has more than 1/SPMSPV_ALPHA of the
+// entries of A, sorting them costs more than a pass over the matrix, and
+// the pattern is scattered to flags while the values are summed by the
+// dense transposed product, as in the bottom-up steps of a BFS.
+//
+// y stores the structural pattern of the product: y[i] is stored when
+// some stored A(i,j) meets a stored x[j], even if the sum vanishes.  The
+// indices of y are sorted.  The push product also takes the semirings of
+// the SpMV kernels, e.g. (+, min) relaxes the out-edges of a frontier of
+// shortest paths.
+
+namespace cusp
+{
+namespace detail
+{
+
+const size_t SPMSPV_ALPHA = 14;
+
+template <typename IndexType>
+struct spmspv_row_length
+{
+    const IndexType * row_offsets;
+
+    spmspv_row_length(const IndexType * row_offsets) : row_offsets(row_offsets) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType i) const
+    {
+        return row_offsets[i + 1] - row_offsets[i];
+    }
+};
+
+// (stored, sum) of row i, where position[j] is one past the entry of x
+// with index j, or zero when x[j] is not stored
+template <typename IndexType, typename MatrixValueType, typename ValueType>
+struct spmspv_pull_row
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const MatrixValueType * matrix_values;
+    const IndexType * position;
+    const ValueType * x;
+
+    spmspv_pull_row(const IndexType * row_offsets, const IndexType * column_indices, const MatrixValueType * matrix_values,
+                    const IndexType * position, const ValueType * x)
+        : row_offsets(row_offsets), column_indices(column_indices), matrix_values(matrix_values), position(position), x(x) {}
+
+    __host__ __device__
+    thrust::tuple<bool,ValueType> operator()(const IndexType i) const
+    {
+        bool stored = false;
+        ValueType sum = 0;
+
+        for (IndexType jj = row_offsets[i]; jj < row_offsets[i + 1]; jj++)
+        {
+            const IndexType k = position[column_indices[jj]];
+
+            if (k != 0)
+            {
+                stored = true;
+                sum += ValueType(matrix_values[jj]) * x[k - 1];
+            }
+        }
+
+        return thrust::make_tuple(stored, sum);
+    }
+};
+
+// flag the columns of the rows of A named by x
+template <typename IndexType>
+struct spmspv_flag_columns
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    bool * flags;
+
+    spmspv_flag_columns(const IndexType * row_offsets, const IndexType * column_indices, bool * flags)
+        : row_offsets(row_offsets), column_indices(column_indices), flags(flags) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        for (IndexType jj = row_offsets[i]; jj < row_offsets[i + 1]; jj++)
+            flags[column_indices[jj]] = true;
+    }
+};
+
+template <typename ValueType, typename Semiring>
+struct spmspv_combine
+{
+    Semiring semiring;
+
+    spmspv_combine(Semiring semiring) : semiring(semiring) {}
+
+    __host__ __device__
+    ValueType operator()(const ValueType a, const ValueType b) const
+    {
+        return semiring.combine(a, b);
+    }
+};
+
+template <typename ValueType, typename Semiring>
+struct spmspv_reduce
+{
+    Semiring semiring;
+
+    spmspv_reduce(Semiring semiring) : semiring(semiring) {}
+
+    __host__ __device__
+    ValueType operator()(const ValueType a, const ValueType b) const
+    {
+        return semiring.reduce(a, b);
+    }
+};
+
+// positions of the entries of the rows of A named by rows: entry e of
+// the expansion lies in row rows[owners[e]] and is entry entries[e] of A
+template <typename Matrix, typename Array1, typename Array2>
+void spmspv_expand(const Matrix& A, const Array1& rows, const size_t num_entries,
+                   Array2& owners, Array2& entries)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    const size_t F = rows.size();
+    const size_t E = num_entries;
+
+    cusp::array1d<IndexType,MemorySpace> offsets(F + 1);
+    thrust::transform(rows.begin(), rows.end(), offsets.begin(),
+                      spmspv_row_length<IndexType>(thrust::raw_pointer_cast(&A.row_offsets[0])));
+    offsets[F] = 0;
+    thrust::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+
+    // entry e of row f is entry e + shift[f] of the matrix
+    cusp::array1d<IndexType,MemorySpace> shift(F);
+    thrust::transform(thrust::make_permutation_iterator(A.row_offsets.begin(), rows.begin()),
+                      thrust::make_permutation_iterator(A.row_offsets.begin(), rows.end()),
+                      offsets.begin(),
+                      shift.begin(),
+                      thrust::minus<IndexType>());
+
+    owners.resize(E);
+    cusp::detail::offsets_to_indices(offsets, owners);
+
+    entries.resize(E);
+    thrust::transform(thrust::counting_iterator<IndexType>(0),
+                      thrust::counting_iterator<IndexType>(E),
+                      thrust::make_permutation_iterator(shift.begin(), owners.begin()),
+                      entries.begin(),
+                      thrust::plus<IndexType>());
+}
+
+// store the entries of a dense vector whose flag is set
+template <typename Array1, typename Array2, typename SparseVector>
+void spmspv_compact(const Array1& flags, const Array2& dense, SparseVector& y)
+{
+    typedef typename SparseVector::index_type IndexType;
+
+    const size_t N = flags.size();
+    const size_t num_entries = thrust::count(flags.begin(), flags.end(), true);
+
+    y.resize(N, num_entries);
+
+    thrust::copy_if(thrust::counting_iterator<IndexType>(0),
+                    thrust::counting_iterator<IndexType>(N),
+                    flags.begin(), y.indices.begin(), thrust::identity<bool>());
+    thrust::copy_if(dense.begin(), dense.end(),
+                    flags.begin(), y.values.begin(), thrust::identity<bool>());
+}
+
+// y = A x by rows
+template <typename Matrix, typename SparseVector1, typename SparseVector2>
+void spmspv_pull(const Matrix& A, const SparseVector1& x, SparseVector2& y)
+{
+    typedef typename Matrix::index_type         IndexType;
+    typedef typename Matrix::value_type         MatrixValueType;
+    typedef typename SparseVector2::value_type  ValueType;
+    typedef typename Matrix::memory_space       MemorySpace;
+
+    if (A.num_entries == 0 || x.num_entries == 0)
+    {
+        y.resize(A.num_rows, 0);
+        return;
+    }
+
+    cusp::array1d<IndexType,MemorySpace> position(A.num_cols, IndexType(0));
+    thrust::scatter(thrust::counting_iterator<IndexType>(1),
+                    thrust::counting_iterator<IndexType>(x.num_entries + 1),
+                    x.indices.begin(), position.begin());
+
+    cusp::array1d<ValueType,MemorySpace> x_values(x.values);
+
+    cusp::array1d<bool,MemorySpace>      flags(A.num_rows);
+    cusp::array1d<ValueType,MemorySpace> sums(A.num_rows);
+
+    thrust::transform(thrust::counting_iterator<IndexType>(0),
+                      thrust::counting_iterator<IndexType>(A.num_rows),
+                      thrust::make_zip_iterator(thrust::make_tuple(flags.begin(), sums.begin())),
+                      spmspv_pull_row<IndexType,MatrixValueType,ValueType>
+                          (thrust::raw_pointer_cast(&A.row_offsets[0]),
+                           thrust::raw_pointer_cast(&A.column_indices[0]),
+                           thrust::raw_pointer_cast(&A.values[0]),
+                           thrust::raw_pointer_cast(&position[0]),
+                           thrust::raw_pointer_cast(&x_values[0])));
+
+    spmspv_compact(flags, sums, y);
+}
+
+// y = A^T x by columns
+template <typename Matrix, typename SparseVector1, typename SparseVector2, typename Semiring>
+void spmspv_push(const Matrix& A, const SparseVector1& x, SparseVector2& y, const size_t frontier_edges,
+                 Semiring semiring)
+{
+    typedef typename Matrix::index_type         IndexType;
+    typedef typename SparseVector2::value_type  ValueType;
+    typedef typename Matrix::memory_space       MemorySpace;
+
+    const size_t E = frontier_edges;
+
+    cusp::array1d<IndexType,MemorySpace> owners;
+    cusp::array1d<IndexType,MemorySpace> entries;
+    cusp::detail::spmspv_expand(A, x.indices, E, owners, entries);
+
+    cusp::array1d<IndexType,MemorySpace> columns(E);
+    cusp::array1d<ValueType,MemorySpace> products(E);
+    cusp::array1d<ValueType,MemorySpace> x_values(x.values);
+
+    thrust::gather(entries.begin(), entries.end(), A.column_indices.begin(), columns.begin());
+    thrust::transform(thrust::make_permutation_iterator(A.values.begin(), entries.begin()),
+                      thrust::make_permutation_iterator(A.values.begin(), entries.end()),
+                      thrust::make_permutation_iterator(x_values.begin(), owners.begin()),
+                      products.begin(),
+                      spmspv_combine<ValueType,Semiring>(semiring));
+
+    thrust::sort_by_key(columns.begin(), columns.end(), products.begin());
+
+    const size_t num_entries = thrust::inner_product(columns.begin(), columns.end() - 1,
+                                                     columns.begin() + 1,
+                                                     size_t(1),
+                                                     thrust::plus<size_t>(),
+                                                     thrust::not_equal_to<IndexType>());
+
+    y.resize(A.num_cols, num_entries);
+
+    thrust::reduce_by_key(columns.begin(), columns.end(), products.begin(),
+                          y.indices.begin(), y.values.begin(),
+                          thrust::equal_to<IndexType>(),
+                          spmspv_reduce<ValueType,Semiring>(semiring));
+}
+
+template <typename Matrix, typename SparseVector1, typename SparseVector2>
+void spmspv_push(const Matrix& A, const SparseVector1& x, SparseVector2& y, const size_t frontier_edges)
+{
+    typedef typename SparseVector2::value_type ValueType;
+
+    cusp::detail::spmspv_push(A, x, y, frontier_edges, cusp::detail::device::spmv_plus_times<ValueType>());
+}
+
+// y = A^T x with a dense accumulator
+template <typename Matrix, typename SparseVector1, typename SparseVector2>
+void spmspv_push_dense(const Matrix& A, const SparseVector1& x, SparseVector2& y)
+{
+    typedef typename Matrix::index_type         IndexType;
+    typedef typename SparseVector2::value_type  ValueType;
+    typedef typename Matrix::memory_space       MemorySpace;
+
+    cusp::array1d<bool,MemorySpace> flags(A.num_cols, false);
+    thrust::for_each(x.indices.begin(), x.indices.end(),
+                     spmspv_flag_columns<IndexType>(thrust::raw_pointer_cast(&A.row_offsets[0]),
+                                                    thrust::raw_pointer_cast(&A.column_indices[0]),
+                                                    thrust::raw_pointer_cast(&flags[0])));
+
+    cusp::array1d<ValueType,MemorySpace> x_dense(A.num_rows, ValueType(0));
+    cusp::array1d<ValueType,MemorySpace> y_dense(A.num_cols);
+    thrust::scatter(x.values.begin(), x.values.end(), x.indices.begin(), x_dense.begin());
+
+    cusp::multiply_transpose(A, x_dense, y_dense);
+
+    spmspv_compact(flags, y_dense, y);
+}
+
+template <typename Matrix, typename SparseVector1, typename SparseVector2>
+void spmspv(const Matrix& A, const SparseVector1& x, SparseVector2& y)
+{
+    if (x.length != A.num_cols)
+        throw cusp::invalid_input_exception("sparse vector dimensions are incompatible");
+
+    cusp::detail::spmspv_pull(A, x, y);
+}
+
+template <typename Matrix, typename SparseVector1, typename SparseVector2>
+void spmspv_transpose(const Matrix& A, const SparseVector1& x, SparseVector2& y)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    if (x.length != A.num_rows)
+        throw cusp::invalid_input_exception("sparse vector dimensions are incompatible");
+
+    if (A.num_entries == 0 || x.num_entries == 0)
+    {
+        y.resize(A.num_cols, 0);
+        return;
+    }
+
+    // the entries of A in the rows named by x
+    const size_t frontier_edges =
+        thrust::transform_reduce(x.indices.begin(), x.indices.end(),
+                                 spmspv_row_length<IndexType>(thrust::raw_pointer_cast(&A.row_offsets[0])),
+                                 IndexType(0), thrust::plus<IndexType>());
+
+    if (frontier_edges == 0)
+        y.resize(A.num_cols, 0);
+    else if (frontier_edges > A.num_entries / SPMSPV_ALPHA)
+        cusp::detail::spmspv_push_dense(A, x, y);
+    else
+        cusp::detail::spmspv_push(A, x, y, frontier_edges);
+}
+
+} // end namespace detail
+} // end namespace cusp
@@ -0,0 +1,218 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/format.h>
+
+#include <thrust/device_ptr.h>
+
+#include <cstddef>
+
+// The one-dimensional arrays that hold the storage of a container.
+//
+// for_each_storage_array(A, op) calls op(array) for each array1d (or
+// array1d_view) of A, e.g. the row offsets, column indices and values of
+// a CSR matrix, and for_each_storage_range(A, op) calls op(ptr, bytes)
+// for the nonempty ones.  Operators without storage of their own, such
+// as a linear_operator or a transpose_view, have no arrays.
+
+namespace cusp
+{
+namespace detail
+{
+
+template <typename Array, typename Operation>
+void for_each_storage_array(const Array& A, Operation& op, cusp::array1d_format)
+{
+    op(A);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::array2d_format)
+{
+    op(A.values);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::coo_format)
+{
+    op(A.row_indices);
+    op(A.column_indices);
+    op(A.values);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::csr_format)
+{
+    op(A.row_offsets);
+    op(A.column_indices);
+    op(A.values);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::dia_format)
+{
+    op(A.diagonal_offsets);
+    op(A.values.values);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::ell_format)
+{
+    op(A.column_indices.values);
+    op(A.values.values);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::hyb_format)
+{
+    for_each_storage_array(A.ell, op, cusp::ell_format());
+    for_each_storage_array(A.coo, op, cusp::coo_format());
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::bsr_format)
+{
+    op(A.row_offsets);
+    op(A.column_indices);
+    op(A.values);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::sell_format)
+{
+    op(A.row_permutation);
+    op(A.slice_offsets);
+    op(A.column_indices);
+    op(A.values);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::jds_format)
+{
+    op(A.row_permutation);
+    op(A.diagonal_offsets);
+    op(A.column_indices);
+    op(A.values);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::csr16_format)
+{
+    op(A.row_offsets);
+    op(A.row_bases);
+    op(A.column_offsets);
+    op(A.values);
+    for_each_storage_array(A.overflow, op, cusp::coo_format());
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::dia_coo_format)
+{
+    for_each_storage_array(A.dia, op, cusp::dia_format());
+    for_each_storage_array(A.coo, op, cusp::coo_format());
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::split_complex_format)
+{
+    for_each_storage_array(A.real, op, typename Matrix::real_matrix_type::format());
+    op(A.imag);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::symmetric_csr_format)
+{
+    op(A.row_offsets);
+    op(A.column_indices);
+    op(A.values);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::batched_csr_format)
+{
+    op(A.row_offsets);
+    op(A.column_indices);
+    op(A.values.values);
+}
+
+// only the selected format is populated, the others are empty
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::auto_format)
+{
+    for_each_storage_array(A.csr, op, cusp::csr_format());
+    for_each_storage_array(A.dia, op, cusp::dia_format());
+    for_each_storage_array(A.ell, op, cusp::ell_format());
+    for_each_storage_array(A.hyb, op, cusp::hyb_format());
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix&, Operation&, cusp::transpose_format)
+{
+    // a view of another matrix
+}
+
+// the derived formats of a format_cache, empty until they are used
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix& A, Operation& op, cusp::cached_format)
+{
+    for_each_storage_array(A.hyb_matrix,       op, cusp::hyb_format());
+    for_each_storage_array(A.transpose_matrix, op, cusp::csr_format());
+    op(A.diagonal_values);
+}
+
+template <typename Matrix, typename Operation>
+void for_each_storage_array(const Matrix&, Operation&, cusp::unknown_format)
+{
+    // no storage of its own
+}
+
+template <typename MatrixOrVector, typename Operation>
+void for_each_storage_array(const MatrixOrVector& A, Operation& op)
+{
+    for_each_storage_array(A, op, typename MatrixOrVector::format());
+}
+
+// adapts an operation on (ptr, bytes) to the arrays of a container
+template <typename Operation>
+struct storage_range_op
+{
+    Operation op;
+
+    storage_range_op(Operation op) : op(op) {}
+
+    template <typename Array>
+    void operator()(const Array& a)
+    {
+        typedef typename Array::value_type ValueType;
+
+        if (a.size() > 0)
+            op(thrust::raw_pointer_cast(&a[0]), a.size() * sizeof(ValueType));
+    }
+};
+
+template <typename MatrixOrVector, typename Operation>
+void for_each_storage_range(const MatrixOrVector& A, Operation op)
+{
+    storage_range_op<Operation> range_op(op);
+
+    for_each_storage_array(A, range_op);
+}
+
+} // end namespace detail
+} // end namespace cusp
+
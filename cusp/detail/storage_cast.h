@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+// Matrix values may be stored in a narrower type than the vectors of a
+// product, e.g. cusp::half values with float vectors (see cusp/half.h).
+// The SpMV kernels load the stored value and convert it to the compute
+// type with storage_cast before they combine it with x.  Types without a
+// specialization of storage_traits are converted with a plain cast.
+//
+// The compute type of a real matrix applied to complex vectors is the
+// real type of the vectors, e.g. float for cusp::half or float values and
+// cusp::complex<float> vectors, so that each entry is multiplied with
+// x[j] as a real scalar (two multiplications) rather than promoted to a
+// complex value (four multiplications and two additions).
+
+namespace cusp
+{
+
+template <typename ValueType> struct complex;
+
+namespace detail
+{
+
+// the type of the matrix values in a product with ValueType vectors
+template <typename ValueType, typename StorageType>
+struct storage_operand
+{
+    typedef ValueType type;
+};
+
+template <typename RealType, typename StorageType>
+struct storage_operand<cusp::complex<RealType>, StorageType>
+{
+    typedef RealType type;
+};
+
+template <typename RealType, typename StorageType>
+struct storage_operand<cusp::complex<RealType>, cusp::complex<StorageType> >
+{
+    typedef cusp::complex<RealType> type;
+};
+
+template <typename StorageType>
+struct storage_traits
+{
+    template <typename ValueType>
+    __host__ __device__
+    static ValueType convert(const StorageType& value)
+    {
+        return ValueType(value);
+    }
+};
+
+template <typename ValueType, typename StorageType>
+__host__ __device__
+typename storage_operand<ValueType,StorageType>::type storage_cast(const StorageType& value)
+{
+    typedef typename storage_operand<ValueType,StorageType>::type OperandType;
+
+    return storage_traits<StorageType>::template convert<OperandType>(value);
+}
+
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,218 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cuda_runtime_api.h>
+
+#include <thrust/copy.h>
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/inner_product.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+
+#if THRUST_VERSION >= 100800 && THRUST_DEVICE_SYSTEM == THRUST_DEVICE_SYSTEM_CUDA
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/system/cuda/execution_policy.h>
+#define CUSP_STREAM_AWARE_THRUST
+#endif
+
+#if defined(_MSC_VER)
+#define CUSP_THREAD_LOCAL __declspec(thread)
+#else
+#define CUSP_THREAD_LOCAL __thread
+#endif
+
+namespace cusp
+{
+namespace detail
+{
+
+// Each host thread has its own current stream on which Cusp issues
+// device work.  The default is the legacy default stream (0).
+inline cudaStream_t& current_stream_reference(void)
+{
+    static CUSP_THREAD_LOCAL cudaStream_t stream = 0;
+    return stream;
+}
+
+inline cudaStream_t current_stream(void)
+{
+    return current_stream_reference();
+}
+
+inline void set_current_stream(cudaStream_t stream)
+{
+    current_stream_reference() = stream;
+}
+
+// Stream-aware wrappers for the Thrust algorithms used by Cusp.  With
+// Thrust v1.8 and newer, device iterators are processed on the current
+// stream.  Older versions of Thrust have no means to select a stream and
+// issue the work on the default stream, which is still correctly ordered
+// with respect to other (blocking) streams.
+namespace streamed
+{
+
+// The System argument selects the backend: work on device iterators is
+// issued on the current stream, everything else is forwarded unchanged.
+namespace system
+{
+
+template <typename System, typename InputIterator, typename UnaryFunction>
+void for_each(System, InputIterator first, InputIterator last, UnaryFunction f)
+{
+    thrust::for_each(first, last, f);
+}
+
+template <typename System, typename InputIterator, typename OutputIterator, typename UnaryFunction>
+OutputIterator transform(System, InputIterator first, InputIterator last, OutputIterator result, UnaryFunction op)
+{
+    return thrust::transform(first, last, result, op);
+}
+
+template <typename System, typename InputIterator1, typename InputIterator2, typename OutputIterator, typename BinaryFunction>
+OutputIterator transform(System, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, OutputIterator result, BinaryFunction op)
+{
+    return thrust::transform(first1, last1, first2, result, op);
+}
+
+template <typename System, typename InputIterator, typename OutputIterator>
+OutputIterator copy(System, InputIterator first, InputIterator last, OutputIterator result)
+{
+    return thrust::copy(first, last, result);
+}
+
+template <typename System, typename ForwardIterator, typename T>
+void fill(System, ForwardIterator first, ForwardIterator last, const T& value)
+{
+    thrust::fill(first, last, value);
+}
+
+template <typename System, typename InputIterator1, typename InputIterator2, typename OutputType>
+OutputType inner_product(System, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, OutputType init)
+{
+    return thrust::inner_product(first1, last1, first2, init);
+}
+
+template <typename System, typename InputIterator, typename UnaryFunction, typename OutputType, typename BinaryFunction>
+OutputType transform_reduce(System, InputIterator first, InputIterator last, UnaryFunction unary_op, OutputType init, BinaryFunction binary_op)
+{
+    return thrust::transform_reduce(first, last, unary_op, init, binary_op);
+}
+
+#if defined(CUSP_STREAM_AWARE_THRUST)
+template <typename InputIterator, typename UnaryFunction>
+void for_each(thrust::device_system_tag, InputIterator first, InputIterator last, UnaryFunction f)
+{
+    thrust::for_each(thrust::cuda::par.on(current_stream()), first, last, f);
+}
+
+template <typename InputIterator, typename OutputIterator, typename UnaryFunction>
+OutputIterator transform(thrust::device_system_tag, InputIterator first, InputIterator last, OutputIterator result, UnaryFunction op)
+{
+    return thrust::transform(thrust::cuda::par.on(current_stream()), first, last, result, op);
+}
+
+template <typename InputIterator1, typename InputIterator2, typename OutputIterator, typename BinaryFunction>
+OutputIterator transform(thrust::device_system_tag, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, OutputIterator result, BinaryFunction op)
+{
+    return thrust::transform(thrust::cuda::par.on(current_stream()), first1, last1, first2, result, op);
+}
+
+template <typename InputIterator, typename OutputIterator>
+OutputIterator copy(thrust::device_system_tag, InputIterator first, InputIterator last, OutputIterator result)
+{
+    return thrust::copy(thrust::cuda::par.on(current_stream()), first, last, result);
+}
+
+template <typename ForwardIterator, typename T>
+void fill(thrust::device_system_tag, ForwardIterator first, ForwardIterator last, const T& value)
+{
+    thrust::fill(thrust::cuda::par.on(current_stream()), first, last, value);
+}
+
+template <typename InputIterator1, typename InputIterator2, typename OutputType>
+OutputType inner_product(thrust::device_system_tag, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, OutputType init)
+{
+    return thrust::inner_product(thrust::cuda::par.on(current_stream()), first1, last1, first2, init);
+}
+
+template <typename InputIterator, typename UnaryFunction, typename OutputType, typename BinaryFunction>
+OutputType transform_reduce(thrust::device_system_tag, InputIterator first, InputIterator last, UnaryFunction unary_op, OutputType init, BinaryFunction binary_op)
+{
+    return thrust::transform_reduce(thrust::cuda::par.on(current_stream()), first, last, unary_op, init, binary_op);
+}
+
+#define CUSP_ITERATOR_SYSTEM(Iterator) typename thrust::iterator_system<Iterator>::type
+#else
+// older versions of Thrust cannot select a stream
+#define CUSP_ITERATOR_SYSTEM(Iterator) thrust::detail::false_type
+#endif
+
+} // end namespace system
+
+template <typename InputIterator, typename UnaryFunction>
+void for_each(InputIterator first, InputIterator last, UnaryFunction f)
+{
+    system::for_each(CUSP_ITERATOR_SYSTEM(InputIterator)(), first, last, f);
+}
+
+template <typename InputIterator, typename OutputIterator, typename UnaryFunction>
+OutputIterator transform(InputIterator first, InputIterator last, OutputIterator result, UnaryFunction op)
+{
+    return system::transform(CUSP_ITERATOR_SYSTEM(InputIterator)(), first, last, result, op);
+}
+
+template <typename InputIterator1, typename InputIterator2, typename OutputIterator, typename BinaryFunction>
+OutputIterator transform(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, OutputIterator result, BinaryFunction op)
+{
+    return system::transform(CUSP_ITERATOR_SYSTEM(InputIterator1)(), first1, last1, first2, result, op);
+}
+
+template <typename InputIterator, typename OutputIterator>
+OutputIterator copy(InputIterator first, InputIterator last, OutputIterator result)
+{
+    return system::copy(CUSP_ITERATOR_SYSTEM(InputIterator)(), first, last, result);
+}
+
+template <typename ForwardIterator, typename T>
+void fill(ForwardIterator first, ForwardIterator last, const T& value)
+{
+    system::fill(CUSP_ITERATOR_SYSTEM(ForwardIterator)(), first, last, value);
+}
+
+template <typename InputIterator1, typename InputIterator2, typename OutputType>
+OutputType inner_product(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, OutputType init)
+{
+    return system::inner_product(CUSP_ITERATOR_SYSTEM(InputIterator1)(), first1, last1, first2, init);
+}
+
+template <typename InputIterator, typename UnaryFunction, typename OutputType, typename BinaryFunction>
+OutputType transform_reduce(InputIterator first, InputIterator last, UnaryFunction unary_op, OutputType init, BinaryFunction binary_op)
+{
+    return system::transform_reduce(CUSP_ITERATOR_SYSTEM(InputIterator)(), first, last, unary_op, init, binary_op);
+}
+
+#undef CUSP_ITERATOR_SYSTEM
+
+} // end namespace streamed
+} // end namespace detail
+} // end namespace cusp
+
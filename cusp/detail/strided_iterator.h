@@ -0,0 +1,63 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <thrust/functional.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+
+// Iterators over every stride-th element of a range, e.g. a column of a
+// row-major array2d.  Element n of the strided range is first[stride * n].
+
+namespace cusp
+{
+namespace detail
+{
+
+template <typename DifferenceType>
+struct stride_functor : public thrust::unary_function<DifferenceType,DifferenceType>
+{
+    DifferenceType stride;
+
+    stride_functor(const DifferenceType stride) : stride(stride) {}
+
+    __host__ __device__
+    DifferenceType operator()(const DifferenceType n) const
+    {
+        return stride * n;
+    }
+};
+
+template <typename Iterator>
+struct strided_iterator
+{
+    typedef typename thrust::iterator_difference<Iterator>::type                                 difference_type;
+    typedef thrust::transform_iterator< stride_functor<difference_type>,
+                                        thrust::counting_iterator<difference_type> >               index_iterator;
+    typedef thrust::permutation_iterator<Iterator, index_iterator>                              type;
+
+    static type make(Iterator first, const difference_type stride)
+    {
+        return type(first, index_iterator(thrust::counting_iterator<difference_type>(0), stride_functor<difference_type>(stride)));
+    }
+};
+
+} // end namespace detail
+} // end namespace cusp
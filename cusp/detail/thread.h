@@ -0,0 +1,98 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/exception.h>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Minimal portable host thread, which runs function(argument) until it
+// is joined.  A thread must be joined exactly once.
+
+namespace cusp
+{
+namespace detail
+{
+
+class host_thread
+{
+    public:
+    typedef void (*function_type)(void *);
+
+    host_thread(function_type function, void * argument)
+        : function(function), argument(argument)
+    {
+#if defined(_WIN32)
+        handle = CreateThread(0, 0, entry, this, 0, 0);
+
+        if (handle == 0)
+            throw cusp::runtime_exception("unable to start host thread");
+#else
+        if (pthread_create(&thread, 0, entry, this) != 0)
+            throw cusp::runtime_exception("unable to start host thread");
+#endif
+    }
+
+    void join(void)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(handle, INFINITE);
+        CloseHandle(handle);
+#else
+        pthread_join(thread, 0);
+#endif
+    }
+
+    private:
+    function_type function;
+    void * argument;
+
+#if defined(_WIN32)
+    HANDLE handle;
+
+    static DWORD WINAPI entry(LPVOID self)
+    {
+        host_thread * t = static_cast<host_thread *>(self);
+        t->function(t->argument);
+        return 0;
+    }
+#else
+    pthread_t thread;
+
+    static void * entry(void * self)
+    {
+        host_thread * t = static_cast<host_thread *>(self);
+        t->function(t->argument);
+        return 0;
+    }
+#endif
+
+    // not copyable
+    host_thread(const host_thread&);
+    host_thread& operator=(const host_thread&);
+};
+
+} // end namespace detail
+} // end namespace cusp
+
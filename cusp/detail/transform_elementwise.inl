@@ -0,0 +1,450 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/convert.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/format.h>
+
+#include <cusp/detail/dense_to_sparse.h>
+
+#include <thrust/count.h>
+#include <thrust/copy.h>
+#include <thrust/for_each.h>
+#include <thrust/remove.h>
+#include <thrust/scan.h>
+#include <thrust/transform.h>
+#include <thrust/tuple.h>
+
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// number of entries of row i of op(A,B) with the union or intersection of
+// the sorted rows of A and B, stored in Cp[i]
+template <typename IndexType, bool Intersection>
+struct csr_pattern_count_functor
+{
+    const IndexType * Ap;
+    const IndexType * Aj;
+    const IndexType * Bp;
+    const IndexType * Bj;
+          IndexType * Cp;
+
+    csr_pattern_count_functor(const IndexType * Ap, const IndexType * Aj,
+                              const IndexType * Bp, const IndexType * Bj,
+                                    IndexType * Cp)
+        : Ap(Ap), Aj(Aj), Bp(Bp), Bj(Bj), Cp(Cp) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType a = Ap[i], a_end = Ap[i + 1];
+        IndexType b = Bp[i], b_end = Bp[i + 1];
+        IndexType count = 0;
+
+        while (a < a_end && b < b_end)
+        {
+            const IndexType Aj_a = Aj[a];
+            const IndexType Bj_b = Bj[b];
+
+            if (!Intersection || Aj_a == Bj_b)
+                count++;
+
+            if (Aj_a <= Bj_b) a++;
+            if (Bj_b <= Aj_a) b++;
+        }
+
+        if (!Intersection)
+            count += (a_end - a) + (b_end - b);
+
+        Cp[i] = count;
+    }
+};
+
+// row i of C = op(A,B), an entry missing in A or B is taken as zero
+template <typename IndexType, typename ValueType1, typename ValueType2, typename ValueType3,
+          typename BinaryFunction, bool Intersection>
+struct csr_transform_elementwise_functor
+{
+    const IndexType  * Ap;
+    const IndexType  * Aj;
+    const ValueType1 * Ax;
+    const IndexType  * Bp;
+    const IndexType  * Bj;
+    const ValueType2 * Bx;
+    const IndexType  * Cp;
+          IndexType  * Cj;
+          ValueType3 * Cx;
+    BinaryFunction op;
+
+    csr_transform_elementwise_functor(const IndexType * Ap, const IndexType * Aj, const ValueType1 * Ax,
+                                      const IndexType * Bp, const IndexType * Bj, const ValueType2 * Bx,
+                                      const IndexType * Cp,       IndexType * Cj,       ValueType3 * Cx,
+                                      BinaryFunction op)
+        : Ap(Ap), Aj(Aj), Ax(Ax), Bp(Bp), Bj(Bj), Bx(Bx), Cp(Cp), Cj(Cj), Cx(Cx), op(op) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType a = Ap[i], a_end = Ap[i + 1];
+        IndexType b = Bp[i], b_end = Bp[i + 1];
+        IndexType c = Cp[i];
+
+        while (a < a_end && b < b_end)
+        {
+            const IndexType Aj_a = Aj[a];
+            const IndexType Bj_b = Bj[b];
+
+            if (Aj_a == Bj_b)
+            {
+                Cj[c] = Aj_a;
+                Cx[c] = op(Ax[a++], Bx[b++]);
+                c++;
+            }
+            else if (Aj_a < Bj_b)
+            {
+                if (!Intersection)
+                {
+                    Cj[c] = Aj_a;
+                    Cx[c] = op(Ax[a], ValueType2(0));
+                    c++;
+                }
+                a++;
+            }
+            else
+            {
+                if (!Intersection)
+                {
+                    Cj[c] = Bj_b;
+                    Cx[c] = op(ValueType1(0), Bx[b]);
+                    c++;
+                }
+                b++;
+            }
+        }
+
+        if (!Intersection)
+        {
+            for (; a < a_end; a++, c++)
+            {
+                Cj[c] = Aj[a];
+                Cx[c] = op(Ax[a], ValueType2(0));
+            }
+
+            for (; b < b_end; b++, c++)
+            {
+                Cj[c] = Bj[b];
+                Cx[c] = op(ValueType1(0), Bx[b]);
+            }
+        }
+    }
+};
+
+template <typename Matrix1, typename Matrix2, typename Matrix3, typename BinaryFunction, bool Intersection>
+void csr_transform_elementwise(const Matrix1& A, const Matrix2& B, Matrix3& C, BinaryFunction op,
+                               thrust::detail::integral_constant<bool,Intersection>)
+{
+    typedef typename Matrix3::index_type   IndexType;
+    typedef typename Matrix1::value_type   ValueType1;
+    typedef typename Matrix2::value_type   ValueType2;
+    typedef typename Matrix3::value_type   ValueType3;
+    typedef typename Matrix3::memory_space MemorySpace;
+
+    const size_t num_rows = A.num_rows;
+
+    cusp::array1d<IndexType,MemorySpace> row_offsets(num_rows + 1);
+    row_offsets[num_rows] = 0;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     csr_pattern_count_functor<IndexType,Intersection>
+                        (thrust::raw_pointer_cast(&A.row_offsets[0]), thrust::raw_pointer_cast(&A.column_indices[0]),
+                         thrust::raw_pointer_cast(&B.row_offsets[0]), thrust::raw_pointer_cast(&B.column_indices[0]),
+                         thrust::raw_pointer_cast(&row_offsets[0])));
+
+    thrust::exclusive_scan(row_offsets.begin(), row_offsets.end(), row_offsets.begin());
+
+    C.resize(A.num_rows, A.num_cols, row_offsets[num_rows]);
+    cusp::copy(row_offsets, C.row_offsets);
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     csr_transform_elementwise_functor<IndexType,ValueType1,ValueType2,ValueType3,BinaryFunction,Intersection>
+                        (thrust::raw_pointer_cast(&A.row_offsets[0]), thrust::raw_pointer_cast(&A.column_indices[0]), thrust::raw_pointer_cast(&A.values[0]),
+                         thrust::raw_pointer_cast(&B.row_offsets[0]), thrust::raw_pointer_cast(&B.column_indices[0]), thrust::raw_pointer_cast(&B.values[0]),
+                         thrust::raw_pointer_cast(&C.row_offsets[0]), thrust::raw_pointer_cast(&C.column_indices[0]), thrust::raw_pointer_cast(&C.values[0]),
+                         op));
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3, typename BinaryFunction, typename Pattern>
+void transform_elementwise(const Matrix1& A, const Matrix2& B, Matrix3& C, BinaryFunction op, Pattern,
+                           cusp::csr_format, cusp::csr_format, cusp::csr_format)
+{
+    cusp::detail::csr_transform_elementwise(A, B, C, op,
+        thrust::detail::integral_constant<bool, thrust::detail::is_same<Pattern,cusp::intersection_pattern>::value>());
+}
+
+// other formats are transformed in CSR and converted
+template <typename Matrix1, typename Matrix2, typename Matrix3, typename BinaryFunction, typename Pattern,
+          typename Format1, typename Format2, typename Format3>
+void transform_elementwise(const Matrix1& A, const Matrix2& B, Matrix3& C, BinaryFunction op, Pattern,
+                           Format1, Format2, Format3)
+{
+    typedef typename Matrix3::index_type   IndexType;
+    typedef typename Matrix3::memory_space MemorySpace;
+
+    cusp::csr_matrix<IndexType,typename Matrix1::value_type,MemorySpace> A_(A);
+    cusp::csr_matrix<IndexType,typename Matrix2::value_type,MemorySpace> B_(B);
+    cusp::csr_matrix<IndexType,typename Matrix3::value_type,MemorySpace> C_;
+
+    cusp::detail::transform_elementwise(A_, B_, C_, op, Pattern(),
+                                        cusp::csr_format(), cusp::csr_format(), cusp::csr_format());
+
+    cusp::convert(C_, C);
+}
+
+// values of the stored entries
+template <typename Matrix, typename UnaryFunction>
+void transform_values(Matrix& A, UnaryFunction op, cusp::coo_format)
+{
+    thrust::transform(A.values.begin(), A.values.end(), A.values.begin(), op);
+}
+
+template <typename Matrix, typename UnaryFunction>
+void transform_values(Matrix& A, UnaryFunction op, cusp::csr_format)
+{
+    thrust::transform(A.values.begin(), A.values.end(), A.values.begin(), op);
+}
+
+// predicate(i, j, A(i,j)) of a tuple (i, j, A(i,j))
+template <typename Predicate, bool Keep>
+struct filter_tuple_predicate
+{
+    Predicate predicate;
+
+    filter_tuple_predicate(Predicate predicate) : predicate(predicate) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    bool operator()(const Tuple& t) const
+    {
+        return predicate(thrust::get<0>(t), thrust::get<1>(t), thrust::get<2>(t)) == Keep;
+    }
+};
+
+// number of entries of row i kept by the predicate, stored in Bp[i]
+template <typename IndexType, typename ValueType, typename Predicate>
+struct csr_filter_count_functor
+{
+    const IndexType * Ap;
+    const IndexType * Aj;
+    const ValueType * Ax;
+          IndexType * Bp;
+    Predicate predicate;
+
+    csr_filter_count_functor(const IndexType * Ap, const IndexType * Aj, const ValueType * Ax,
+                                   IndexType * Bp, Predicate predicate)
+        : Ap(Ap), Aj(Aj), Ax(Ax), Bp(Bp), predicate(predicate) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType count = 0;
+
+        for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+            if (predicate(i, Aj[jj], Ax[jj]))
+                count++;
+
+        Bp[i] = count;
+    }
+};
+
+// the entries of row i kept by the predicate
+template <typename IndexType, typename ValueType1, typename ValueType2, typename Predicate>
+struct csr_filter_functor
+{
+    const IndexType  * Ap;
+    const IndexType  * Aj;
+    const ValueType1 * Ax;
+    const IndexType  * Bp;
+          IndexType  * Bj;
+          ValueType2 * Bx;
+    Predicate predicate;
+
+    csr_filter_functor(const IndexType * Ap, const IndexType * Aj, const ValueType1 * Ax,
+                       const IndexType * Bp,       IndexType * Bj,       ValueType2 * Bx,
+                       Predicate predicate)
+        : Ap(Ap), Aj(Aj), Ax(Ax), Bp(Bp), Bj(Bj), Bx(Bx), predicate(predicate) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType n = Bp[i];
+
+        for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+        {
+            if (predicate(i, Aj[jj], Ax[jj]))
+            {
+                Bj[n] = Aj[jj];
+                Bx[n] = Ax[jj];
+                n++;
+            }
+        }
+    }
+};
+
+template <typename Matrix1, typename Matrix2, typename Predicate>
+void filter(const Matrix1& A, Matrix2& B, Predicate predicate, cusp::coo_format, cusp::coo_format)
+{
+    filter_tuple_predicate<Predicate,true> keep(predicate);
+
+    const size_t num_entries =
+        thrust::count_if(thrust::make_zip_iterator(thrust::make_tuple(A.row_indices.begin(), A.column_indices.begin(), A.values.begin())),
+                         thrust::make_zip_iterator(thrust::make_tuple(A.row_indices.end(),   A.column_indices.end(),   A.values.end())),
+                         keep);
+
+    B.resize(A.num_rows, A.num_cols, num_entries);
+
+    thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(A.row_indices.begin(), A.column_indices.begin(), A.values.begin())),
+                    thrust::make_zip_iterator(thrust::make_tuple(A.row_indices.end(),   A.column_indices.end(),   A.values.end())),
+                    thrust::make_zip_iterator(thrust::make_tuple(B.row_indices.begin(), B.column_indices.begin(), B.values.begin())),
+                    keep);
+}
+
+template <typename Matrix1, typename Matrix2, typename Predicate>
+void filter(const Matrix1& A, Matrix2& B, Predicate predicate, cusp::csr_format, cusp::csr_format)
+{
+    typedef typename Matrix2::index_type   IndexType;
+    typedef typename Matrix1::value_type   ValueType1;
+    typedef typename Matrix2::value_type   ValueType2;
+    typedef typename Matrix2::memory_space MemorySpace;
+
+    const size_t num_rows = A.num_rows;
+
+    cusp::array1d<IndexType,MemorySpace> row_offsets(num_rows + 1);
+    row_offsets[num_rows] = 0;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     csr_filter_count_functor<IndexType,ValueType1,Predicate>
+                        (thrust::raw_pointer_cast(&A.row_offsets[0]), thrust::raw_pointer_cast(&A.column_indices[0]), thrust::raw_pointer_cast(&A.values[0]),
+                         thrust::raw_pointer_cast(&row_offsets[0]), predicate));
+
+    thrust::exclusive_scan(row_offsets.begin(), row_offsets.end(), row_offsets.begin());
+
+    B.resize(A.num_rows, A.num_cols, row_offsets[num_rows]);
+    cusp::copy(row_offsets, B.row_offsets);
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     csr_filter_functor<IndexType,ValueType1,ValueType2,Predicate>
+                        (thrust::raw_pointer_cast(&A.row_offsets[0]), thrust::raw_pointer_cast(&A.column_indices[0]), thrust::raw_pointer_cast(&A.values[0]),
+                         thrust::raw_pointer_cast(&B.row_offsets[0]), thrust::raw_pointer_cast(&B.column_indices[0]), thrust::raw_pointer_cast(&B.values[0]),
+                         predicate));
+}
+
+// compact the entries of a dense array2d
+template <typename Matrix1, typename Matrix2, typename Predicate>
+void filter(const Matrix1& A, Matrix2& B, Predicate predicate, cusp::array2d_format, cusp::coo_format)
+{
+    cusp::detail::array2d_to_coo(A, B, predicate);
+}
+
+template <typename Matrix1, typename Matrix2, typename Predicate>
+void filter(const Matrix1& A, Matrix2& B, Predicate predicate, cusp::array2d_format, cusp::csr_format)
+{
+    cusp::detail::array2d_to_csr(A, B, predicate);
+}
+
+// COO entries are removed in place
+template <typename Matrix, typename Predicate>
+void filter(Matrix& A, Predicate predicate, cusp::coo_format)
+{
+    filter_tuple_predicate<Predicate,false> drop(predicate);
+
+    const size_t num_entries =
+        thrust::remove_if(thrust::make_zip_iterator(thrust::make_tuple(A.row_indices.begin(), A.column_indices.begin(), A.values.begin())),
+                          thrust::make_zip_iterator(thrust::make_tuple(A.row_indices.end(),   A.column_indices.end(),   A.values.end())),
+                          drop)
+        - thrust::make_zip_iterator(thrust::make_tuple(A.row_indices.begin(), A.column_indices.begin(), A.values.begin()));
+
+    A.resize(A.num_rows, A.num_cols, num_entries);
+}
+
+template <typename Matrix, typename Predicate>
+void filter(Matrix& A, Predicate predicate, cusp::csr_format)
+{
+    Matrix B;
+    cusp::detail::filter(A, B, predicate, cusp::csr_format(), cusp::csr_format());
+    A.swap(B);
+}
+
+} // end namespace detail
+
+template <typename Matrix1, typename Matrix2, typename Matrix3, typename BinaryFunction>
+void transform_elementwise(const Matrix1& A, const Matrix2& B, Matrix3& C, BinaryFunction op)
+{
+    cusp::transform_elementwise(A, B, C, op, cusp::union_pattern());
+}
+
+template <typename Matrix1, typename Matrix2, typename Matrix3, typename BinaryFunction, typename Pattern>
+void transform_elementwise(const Matrix1& A, const Matrix2& B, Matrix3& C, BinaryFunction op, Pattern)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if(A.num_rows != B.num_rows || A.num_cols != B.num_cols)
+        throw cusp::invalid_input_exception("array dimensions do not match");
+
+    cusp::detail::transform_elementwise(A, B, C, op, Pattern(),
+            typename Matrix1::format(),
+            typename Matrix2::format(),
+            typename Matrix3::format());
+}
+
+template <typename Matrix, typename UnaryFunction>
+void transform_values(Matrix& A, UnaryFunction op)
+{
+    CUSP_PROFILE_SCOPED();
+
+    cusp::detail::transform_values(A, op, typename Matrix::format());
+}
+
+template <typename Matrix, typename Predicate>
+void filter(Matrix& A, Predicate predicate)
+{
+    CUSP_PROFILE_SCOPED();
+
+    cusp::detail::filter(A, predicate, typename Matrix::format());
+}
+
+template <typename Matrix1, typename Matrix2, typename Predicate>
+void filter(const Matrix1& A, Matrix2& B, Predicate predicate)
+{
+    CUSP_PROFILE_SCOPED();
+
+    cusp::detail::filter(A, B, predicate, typename Matrix1::format(), typename Matrix2::format());
+}
+
+} // end namespace cusp
@@ -14,6 +14,7 @@
  *  limitations under the License.
  */
 
+#include <cusp/detail/dispatch/dense_transpose.h>
 #include <cusp/detail/dispatch/transpose.h>
 
 #include <thrust/detail/type_traits.h>
@@ -73,6 +74,15 @@ void transpose(const MatrixType1& A, MatrixType2& At,
 
   At.resize(A.num_cols, A.num_rows);
 
+  // in the same orientation the rows of A become the rows of At, which
+  // the tiled kernels transpose in place of the index-mapped copy
+  if (thrust::detail::is_same<Orientation1, Orientation2>::value &&
+      cusp::detail::dispatch::transpose_dense(A.values, At.values,
+                                              cusp::detail::major_dimension(A.num_rows, A.num_cols, Orientation1()),
+                                              cusp::detail::minor_dimension(A.num_rows, A.num_cols, Orientation1()),
+                                              A.pitch, At.pitch))
+    return;
+
   thrust::counting_iterator<size_t> begin(0);
   thrust::counting_iterator<size_t> end(A.num_entries);
 
@@ -86,6 +96,26 @@ void transpose(const MatrixType1& A, MatrixType2& At,
 }
 
 
+// transpose_matrix_view, copy the referenced matrix
+template <typename MatrixType1,   typename MatrixType2,
+          typename MatrixFormat2>
+void transpose(const MatrixType1& A, MatrixType2& At,
+               cusp::transpose_format,
+               MatrixFormat2)
+{
+    cusp::convert(A.matrix, At);
+}
+
+// format_cache, copy the cached transpose
+template <typename MatrixType1,   typename MatrixType2,
+          typename MatrixFormat2>
+void transpose(const MatrixType1& A, MatrixType2& At,
+               cusp::cached_format,
+               MatrixFormat2)
+{
+    cusp::convert(A.transpose(), At);
+}
+
 // Default case uses CSR transpose
 template <typename MatrixType1,   typename MatrixType2,
           typename MatrixFormat1, typename MatrixFormat2>
@@ -0,0 +1,312 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/exception.h>
+
+#include <cusp/detail/device/cusparse.h>
+
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace cusp
+{
+namespace detail
+{
+
+// the level-scheduled solve launches one kernel per level, which does not
+// pay off when the levels hold fewer rows than this on average
+const size_t TRIANGULAR_SOLVE_MIN_AVERAGE_LEVEL_SIZE = 4;
+
+// x[i] <- (b[i] - sum_j T_ij x_j) / T_ii over the entries of row i strictly
+// inside the triangle, T_ii = 1 for a unit triangle.  x may alias b.
+template <typename IndexType, typename ValueType>
+struct triangular_solve_row
+{
+    const IndexType * row_begin;
+    const IndexType * row_end;
+    const IndexType * diagonal_positions;
+    const IndexType * column_indices;
+    const ValueType * values;
+    const ValueType * b;
+          ValueType * x;
+
+    triangular_solve_row(const IndexType * row_begin, const IndexType * row_end,
+                         const IndexType * diagonal_positions, const IndexType * column_indices,
+                         const ValueType * values, const ValueType * b, ValueType * x)
+        : row_begin(row_begin), row_end(row_end), diagonal_positions(diagonal_positions),
+          column_indices(column_indices), values(values), b(b), x(x) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        ValueType sum = b[i];
+
+        for (IndexType jj = row_begin[i]; jj < row_end[i]; jj++)
+            sum -= values[jj] * x[column_indices[jj]];
+
+        x[i] = diagonal_positions == 0 ? sum : sum / values[diagonal_positions[i]];
+    }
+};
+
+// all rows in order by a single thread, the argument is ignored
+template <typename IndexType, typename ValueType>
+struct triangular_solve_sequential
+{
+    triangular_solve_row<IndexType,ValueType> solve_row;
+    IndexType num_rows;
+    bool lower;
+
+    triangular_solve_sequential(const triangular_solve_row<IndexType,ValueType>& solve_row,
+                                const IndexType num_rows, const bool lower)
+        : solve_row(solve_row), num_rows(num_rows), lower(lower) {}
+
+    __host__ __device__
+    void operator()(const IndexType) const
+    {
+        if (lower)
+            for (IndexType i = 0; i < num_rows; i++)
+                solve_row(i);
+        else
+            for (IndexType i = num_rows; i > 0; i--)
+                solve_row(i - 1);
+    }
+};
+
+// apply a row functor to the rows of one level after the other
+template <typename IndexType, typename MemorySpace, typename Functor>
+void for_each_level(const cusp::triangular_solve_plan<IndexType,MemorySpace>& plan, Functor f)
+{
+    for (size_t l = 0; l < plan.num_levels(); l++)
+        thrust::for_each(plan.rows.begin() + plan.level_offsets[l],
+                         plan.rows.begin() + plan.level_offsets[l + 1],
+                         f);
+}
+
+template <typename Matrix, typename IndexType, typename MemorySpace, typename ValueType>
+triangular_solve_row<IndexType,ValueType>
+make_triangular_solve_row(const Matrix& T, const cusp::triangular_solve_plan<IndexType,MemorySpace>& plan,
+                          const ValueType * b, ValueType * x)
+{
+    return triangular_solve_row<IndexType,ValueType>
+        (thrust::raw_pointer_cast(&plan.row_begin[0]),
+         thrust::raw_pointer_cast(&plan.row_end[0]),
+         plan.unit ? 0 : thrust::raw_pointer_cast(&plan.diagonal_positions[0]),
+         T.num_entries == 0 ? 0 : thrust::raw_pointer_cast(&T.column_indices[0]),
+         T.num_entries == 0 ? 0 : thrust::raw_pointer_cast(&T.values[0]),
+         b, x);
+}
+
+template <typename IndexType, typename MemorySpace>
+void select_triangular_solve_algorithm(cusp::triangular_solve_plan<IndexType,MemorySpace>& plan, cusp::host_memory)
+{
+    plan.algorithm = cusp::triangular_solve_plan<IndexType,MemorySpace>::sequential;
+}
+
+template <typename IndexType, typename MemorySpace>
+void select_triangular_solve_algorithm(cusp::triangular_solve_plan<IndexType,MemorySpace>& plan, cusp::device_memory)
+{
+    if (plan.num_rows < TRIANGULAR_SOLVE_MIN_AVERAGE_LEVEL_SIZE * plan.num_levels())
+        plan.algorithm = cusp::triangular_solve_plan<IndexType,MemorySpace>::sequential;
+    else
+        plan.algorithm = cusp::triangular_solve_plan<IndexType,MemorySpace>::level_scheduled;
+}
+
+
+template <typename Matrix, typename Array1, typename Array2>
+bool vendor_triangular_solve(const Matrix& T, const Array1& b, Array2& x, const bool lower, const bool unit, cusp::host_memory)
+{
+    return false;
+}
+
+// cuSPARSE analyses and solves in one call, when it is the engine of this thread
+template <typename Matrix, typename Array1, typename Array2>
+bool vendor_triangular_solve(const Matrix& T, const Array1& b, Array2& x, const bool lower, const bool unit, cusp::device_memory)
+{
+    if (T.num_rows != T.num_cols)
+        throw cusp::invalid_input_exception("triangular solve requires a square matrix");
+
+    if (b.size() != T.num_rows || x.size() != T.num_rows)
+        throw cusp::invalid_input_exception("array dimensions do not match the triangular solve");
+
+    return cusp::detail::device::cusparse::triangular_solve(T, b, x, lower, unit);
+}
+
+} // end namespace detail
+
+template <typename Matrix,
+          typename IndexType,
+          typename MemorySpace>
+void triangular_solve_analyze(const Matrix& T,
+                              cusp::triangular_solve_plan<IndexType, MemorySpace>& plan,
+                              const bool lower,
+                              const bool unit)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (T.num_rows != T.num_cols)
+        throw cusp::invalid_input_exception("triangular solve requires a square matrix");
+
+    const size_t N = T.num_rows;
+
+    plan.num_rows       = N;
+    plan.num_entries    = T.num_entries;
+    plan.lower          = lower;
+    plan.unit           = unit;
+    plan.max_level_size = 0;
+
+    // the analysis only depends on the pattern, inspected on the host
+    cusp::array1d<IndexType,cusp::host_memory> row_offsets(T.row_offsets);
+    cusp::array1d<IndexType,cusp::host_memory> column_indices(T.column_indices);
+
+    cusp::array1d<IndexType,cusp::host_memory> row_begin(N);
+    cusp::array1d<IndexType,cusp::host_memory> row_end(N);
+    cusp::array1d<IndexType,cusp::host_memory> diagonal_positions(unit ? 0 : N);
+
+    for (size_t i = 0; i < N; i++)
+    {
+        const IndexType first = row_offsets[i];
+        const IndexType last  = row_offsets[i + 1];
+
+        for (IndexType jj = first + 1; jj < last; jj++)
+            if (column_indices[jj - 1] > column_indices[jj])
+                throw cusp::invalid_input_exception("triangular solve requires sorted column indices");
+
+        // first entry on or right of the diagonal
+        IndexType diag = first;
+        while (diag < last && column_indices[diag] < IndexType(i))
+            diag++;
+
+        const bool has_diagonal = diag < last && column_indices[diag] == IndexType(i);
+
+        if (!unit && !has_diagonal)
+            throw cusp::invalid_input_exception("triangular solve requires every diagonal entry to be stored");
+
+        row_begin[i] = lower ? first : (has_diagonal ? diag + 1 : diag);
+        row_end[i]   = lower ? diag  : last;
+
+        if (!unit)
+            diagonal_positions[i] = diag;
+    }
+
+    // level of every row: one more than the largest level of the rows it
+    // depends on, which precede (follow) it in a lower (upper) triangle
+    std::vector<IndexType> levels(N, 0);
+
+    size_t num_levels = N == 0 ? 0 : 1;
+
+    for (size_t n = 0; n < N; n++)
+    {
+        const size_t i = lower ? n : N - 1 - n;
+
+        IndexType level = 0;
+
+        for (IndexType jj = row_begin[i]; jj < row_end[i]; jj++)
+            level = std::max(level, IndexType(levels[column_indices[jj]] + 1));
+
+        levels[i]  = level;
+        num_levels = std::max(num_levels, size_t(level) + 1);
+    }
+
+    // counting sort of the rows by level
+    plan.level_offsets.resize(num_levels + 1);
+    thrust::fill(plan.level_offsets.begin(), plan.level_offsets.end(), IndexType(0));
+
+    for (size_t i = 0; i < N; i++)
+        plan.level_offsets[levels[i] + 1]++;
+
+    for (size_t l = 0; l < num_levels; l++)
+    {
+        plan.max_level_size = std::max(plan.max_level_size, size_t(plan.level_offsets[l + 1]));
+        plan.level_offsets[l + 1] += plan.level_offsets[l];
+    }
+
+    cusp::array1d<IndexType,cusp::host_memory> rows(N);
+    std::vector<IndexType> next(plan.level_offsets.begin(), plan.level_offsets.end() - 1);
+
+    for (size_t i = 0; i < N; i++)
+        rows[next[levels[i]]++] = i;
+
+    plan.rows               = rows;
+    plan.row_begin          = row_begin;
+    plan.row_end            = row_end;
+    plan.diagonal_positions = diagonal_positions;
+
+    cusp::detail::select_triangular_solve_algorithm(plan, MemorySpace());
+}
+
+template <typename Matrix,
+          typename IndexType,
+          typename MemorySpace,
+          typename Array1,
+          typename Array2>
+void triangular_solve(const Matrix& T,
+                      const cusp::triangular_solve_plan<IndexType, MemorySpace>& plan,
+                      const Array1& b,
+                            Array2& x)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix::value_type ValueType;
+
+    if (T.num_rows != plan.num_rows || T.num_cols != plan.num_rows || T.num_entries != plan.num_entries)
+        throw cusp::invalid_input_exception("matrix does not match the triangular solve plan");
+
+    if (b.size() != plan.num_rows || x.size() != plan.num_rows)
+        throw cusp::invalid_input_exception("array dimensions do not match the triangular solve plan");
+
+    if (plan.num_rows == 0)
+        return;
+
+    const ValueType * b_ptr = thrust::raw_pointer_cast(&b[0]);
+          ValueType * x_ptr = thrust::raw_pointer_cast(&x[0]);
+
+    cusp::detail::triangular_solve_row<IndexType,ValueType> solve_row =
+        cusp::detail::make_triangular_solve_row(T, plan, b_ptr, x_ptr);
+
+    if (plan.algorithm == cusp::triangular_solve_plan<IndexType,MemorySpace>::sequential)
+        thrust::for_each(plan.rows.begin(), plan.rows.begin() + 1,
+                         cusp::detail::triangular_solve_sequential<IndexType,ValueType>(solve_row, plan.num_rows, plan.lower));
+    else
+        cusp::detail::for_each_level(plan, solve_row);
+}
+
+template <typename Matrix,
+          typename Array1,
+          typename Array2>
+void triangular_solve(const Matrix& T,
+                      const Array1& b,
+                            Array2& x,
+                      const bool lower,
+                      const bool unit)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    if (cusp::detail::vendor_triangular_solve(T, b, x, lower, unit, MemorySpace()))
+        return;
+
+    cusp::triangular_solve_plan<IndexType,MemorySpace> plan;
+
+    cusp::triangular_solve_analyze(T, plan, lower, unit);
+    cusp::triangular_solve(T, plan, b, x);
+}
+
+} // end namespace cusp
+
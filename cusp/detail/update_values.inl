@@ -0,0 +1,206 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/convert.h>
+#include <cusp/copy.h>
+#include <cusp/exception.h>
+#include <cusp/format.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+
+#include <thrust/functional.h>
+#include <thrust/sequence.h>
+#include <thrust/transform.h>
+
+#include <thrust/iterator/constant_iterator.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// i < 0 ? 0 : src[i]
+template <typename IndexType, typename ValueType>
+struct gather_value_functor
+{
+    const ValueType * src;
+
+    gather_value_functor(const ValueType * src) : src(src) {}
+
+    __host__ __device__
+    ValueType operator()(const IndexType i) const
+    {
+        return i < 0 ? ValueType(0) : src[i];
+    }
+};
+
+// the matrix of the format of Matrix holding IndexType values in MemorySpace
+template <typename Matrix, typename IndexType, typename MemorySpace, typename Format = typename Matrix::format>
+struct index_valued_matrix {};
+
+template <typename Matrix, typename IndexType, typename MemorySpace>
+struct index_valued_matrix<Matrix,IndexType,MemorySpace,cusp::coo_format>
+{ typedef cusp::coo_matrix<typename Matrix::index_type,IndexType,MemorySpace> type; };
+template <typename Matrix, typename IndexType, typename MemorySpace>
+struct index_valued_matrix<Matrix,IndexType,MemorySpace,cusp::csr_format>
+{ typedef cusp::csr_matrix<typename Matrix::index_type,IndexType,MemorySpace> type; };
+template <typename Matrix, typename IndexType, typename MemorySpace>
+struct index_valued_matrix<Matrix,IndexType,MemorySpace,cusp::dia_format>
+{ typedef cusp::dia_matrix<typename Matrix::index_type,IndexType,MemorySpace> type; };
+template <typename Matrix, typename IndexType, typename MemorySpace>
+struct index_valued_matrix<Matrix,IndexType,MemorySpace,cusp::ell_format>
+{ typedef cusp::ell_matrix<typename Matrix::index_type,IndexType,MemorySpace> type; };
+template <typename Matrix, typename IndexType, typename MemorySpace>
+struct index_valued_matrix<Matrix,IndexType,MemorySpace,cusp::hyb_format>
+{ typedef cusp::hyb_matrix<typename Matrix::index_type,IndexType,MemorySpace> type; };
+
+// copy of the pattern of src whose values number its entries from 1
+template <typename Matrix, typename IndexValuedMatrix>
+void number_values(const Matrix& src, IndexValuedMatrix& S, cusp::csr_format)
+{
+    S.resize(src.num_rows, src.num_cols, src.num_entries);
+    cusp::copy(src.row_offsets,    S.row_offsets);
+    cusp::copy(src.column_indices, S.column_indices);
+    thrust::sequence(S.values.begin(), S.values.end(), typename IndexValuedMatrix::value_type(1));
+}
+
+template <typename Matrix, typename IndexValuedMatrix>
+void number_values(const Matrix& src, IndexValuedMatrix& S, cusp::coo_format)
+{
+    S.resize(src.num_rows, src.num_cols, src.num_entries);
+    cusp::copy(src.row_indices,    S.row_indices);
+    cusp::copy(src.column_indices, S.column_indices);
+    thrust::sequence(S.values.begin(), S.values.end(), typename IndexValuedMatrix::value_type(1));
+}
+
+// the stored values of a matrix, in the order of its value arrays
+template <typename Matrix>
+size_t num_stored_values(const Matrix& A, cusp::coo_format) { return A.values.size(); }
+template <typename Matrix>
+size_t num_stored_values(const Matrix& A, cusp::csr_format) { return A.values.size(); }
+template <typename Matrix>
+size_t num_stored_values(const Matrix& A, cusp::dia_format) { return A.values.values.size(); }
+template <typename Matrix>
+size_t num_stored_values(const Matrix& A, cusp::ell_format) { return A.values.values.size(); }
+template <typename Matrix>
+size_t num_stored_values(const Matrix& A, cusp::hyb_format) { return A.ell.values.values.size() + A.coo.values.size(); }
+
+// indices[offset + n] <- values[n] - 1
+template <typename Array1, typename Array2>
+void record_values(const Array1& values, Array2& indices, const size_t offset)
+{
+    typedef typename Array2::value_type IndexType;
+
+    thrust::transform(values.begin(), values.end(),
+                      thrust::constant_iterator<IndexType>(1),
+                      indices.begin() + offset,
+                      thrust::minus<IndexType>());
+}
+
+template <typename Matrix, typename Array>
+void record_values(const Matrix& T, Array& indices, cusp::coo_format) { record_values(T.values, indices, 0); }
+template <typename Matrix, typename Array>
+void record_values(const Matrix& T, Array& indices, cusp::csr_format) { record_values(T.values, indices, 0); }
+template <typename Matrix, typename Array>
+void record_values(const Matrix& T, Array& indices, cusp::dia_format) { record_values(T.values.values, indices, 0); }
+template <typename Matrix, typename Array>
+void record_values(const Matrix& T, Array& indices, cusp::ell_format) { record_values(T.values.values, indices, 0); }
+template <typename Matrix, typename Array>
+void record_values(const Matrix& T, Array& indices, cusp::hyb_format)
+{
+    record_values(T.ell.values.values, indices, 0);
+    record_values(T.coo.values,        indices, T.ell.values.values.size());
+}
+
+// values[n] <- src[indices[offset + n]], or 0 for padding
+template <typename Array1, typename Array2, typename Array3>
+void gather_values(const Array1& indices, const size_t offset, const Array2& src, Array3& values)
+{
+    typedef typename Array1::value_type IndexType;
+    typedef typename Array3::value_type ValueType;
+
+    const ValueType * src_ptr = src.size() == 0 ? 0 : thrust::raw_pointer_cast(&src[0]);
+
+    thrust::transform(indices.begin() + offset, indices.begin() + offset + values.size(),
+                      values.begin(),
+                      gather_value_functor<IndexType,ValueType>(src_ptr));
+}
+
+template <typename Matrix, typename Array1, typename Array2>
+void gather_values(Matrix& dst, const Array1& src, const Array2& indices, cusp::coo_format) { gather_values(indices, 0, src, dst.values); }
+template <typename Matrix, typename Array1, typename Array2>
+void gather_values(Matrix& dst, const Array1& src, const Array2& indices, cusp::csr_format) { gather_values(indices, 0, src, dst.values); }
+template <typename Matrix, typename Array1, typename Array2>
+void gather_values(Matrix& dst, const Array1& src, const Array2& indices, cusp::dia_format) { gather_values(indices, 0, src, dst.values.values); }
+template <typename Matrix, typename Array1, typename Array2>
+void gather_values(Matrix& dst, const Array1& src, const Array2& indices, cusp::ell_format) { gather_values(indices, 0, src, dst.values.values); }
+template <typename Matrix, typename Array1, typename Array2>
+void gather_values(Matrix& dst, const Array1& src, const Array2& indices, cusp::hyb_format)
+{
+    gather_values(indices, 0,                             src, dst.ell.values.values);
+    gather_values(indices, dst.ell.values.values.size(), src, dst.coo.values);
+}
+
+} // end namespace detail
+
+template <typename SourceType, typename DestinationType, typename IndexType, class MemorySpace>
+void convert(const SourceType& src, DestinationType& dst,
+             cusp::value_permutation<IndexType,MemorySpace>& permutation)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename cusp::detail::index_valued_matrix<SourceType,IndexType,MemorySpace>::type      SourcePattern;
+    typedef typename cusp::detail::index_valued_matrix<DestinationType,IndexType,MemorySpace>::type DestinationPattern;
+
+    cusp::convert(src, dst);
+
+    // convert the numbered pattern the same way
+    SourcePattern S;
+    cusp::detail::number_values(src, S, typename SourceType::format());
+
+    DestinationPattern T;
+    cusp::convert(S, T);
+
+    permutation.num_source_values = src.num_entries;
+    permutation.indices.resize(cusp::detail::num_stored_values(T, typename DestinationType::format()));
+
+    cusp::detail::record_values(T, permutation.indices, typename DestinationType::format());
+}
+
+template <typename DestinationType, typename Array, typename IndexType, class MemorySpace>
+void update_values(DestinationType& dst, const Array& src_values,
+                   const cusp::value_permutation<IndexType,MemorySpace>& permutation)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if (src_values.size() != permutation.num_source_values)
+        throw cusp::invalid_input_exception("source values do not match the value permutation");
+
+    if (cusp::detail::num_stored_values(dst, typename DestinationType::format()) != permutation.indices.size())
+        throw cusp::invalid_input_exception("destination matrix does not match the value permutation");
+
+    if (permutation.indices.size() == 0)
+        return;
+
+    cusp::detail::gather_values(dst, src_values, permutation.indices, typename DestinationType::format());
+}
+
+} // end namespace cusp
@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/blas.h>
+#include <cusp/detail/stream.h>
+
+#include <thrust/functional.h>
+#include <thrust/tuple.h>
+#include <thrust/iterator/zip_iterator.h>
+
+namespace cusp
+{
+namespace blas
+{
+namespace detail
+{
+
+// z[i] <- e[i], returns conj(w[i]) * z[i] where w[i] is read after z[i]
+// is written, so that w may alias z
+template <typename T>
+struct ASSIGN_DOTC : public thrust::unary_function<T,T>
+{
+    template <typename Tuple>
+    __host__ __device__
+    T operator()(Tuple t) const
+    {
+        const T value = thrust::get<1>(t);
+        thrust::get<0>(t) = value;
+        return conjugate<T>()(thrust::get<2>(t)) * value;
+    }
+};
+
+} // end namespace detail
+
+template <typename Array,
+          typename Expression>
+void assign(Array& z,
+            const Expression& e)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(z.size() * sizeof(typename Array::value_type));
+    detail::assert_same_dimensions(z, e);
+    cusp::detail::streamed::copy(e.begin(), e.end(), z.begin());
+}
+
+template <typename Array,
+          typename Expression>
+void assign(const Array& z,
+            const Expression& e)
+{
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(z.size() * sizeof(typename Array::value_type));
+    detail::assert_same_dimensions(z, e);
+    cusp::detail::streamed::copy(e.begin(), e.end(), z.begin());
+}
+
+template <typename Array1,
+          typename Expression,
+          typename Array2>
+typename Array1::value_type
+    assign_dotc(const Array1& z,
+                const Expression& e,
+                const Array2& w)
+{
+    typedef typename Array1::value_type ValueType;
+
+    CUSP_PROFILE_SCOPED();
+    CUSP_PROFILE_BYTES(2 * z.size() * sizeof(ValueType));
+    CUSP_PROFILE_FLOPS(2 * z.size());
+    detail::assert_same_dimensions(z, e, w);
+
+    // the const overloads write the storage of a view
+    typename Array1::iterator z_first = const_cast<Array1&>(z).begin();
+
+    return cusp::detail::streamed::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(z_first, e.begin(), w.begin())),
+                                                    thrust::make_zip_iterator(thrust::make_tuple(z_first, e.begin(), w.begin())) + z.size(),
+                                                    detail::ASSIGN_DOTC<ValueType>(),
+                                                    ValueType(0),
+                                                    thrust::plus<ValueType>());
+}
+
+template <typename Array,
+          typename Expression>
+typename Array::value_type
+    assign_dotc(const Array& z,
+                const Expression& e)
+{
+    return cusp::blas::assign_dotc(z, e, z);
+}
+
+} // end namespace blas
+} // end namespace cusp
+
@@ -14,14 +14,15 @@
  *  limitations under the License.
  */
 
+
 #include <cusp/format.h>
 #include <cusp/exception.h>
 
-#include <thrust/sort.h>
-#include <thrust/count.h>
-#include <thrust/extrema.h>
 #include <thrust/functional.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/iterator/counting_iterator.h>
 
+#include <algorithm>
 #include <sstream>
 
 namespace cusp
@@ -33,345 +34,494 @@ namespace detail
 // Helper functions and functors //
 ///////////////////////////////////
 
-template <typename IndexVector>
-thrust::pair<typename IndexVector::value_type, typename IndexVector::value_type>
-index_range(const IndexVector& indices)
+// The checks of the individual entries of a matrix are combined into one
+// transform_reduce over the positions of its arrays.  Each position yields
+// a verify_summary of the checks it fails, and the summaries are merged by
+// counting the violations of each check and keeping the first position
+// that violates it.  Each format numbers its checks from zero.
+
+const int max_verify_checks = 4;
+
+struct verify_summary
+{
+    size_t violations[max_verify_checks];
+    size_t first[max_verify_checks];
+    size_t count;                          // entries counted by the format, e.g. valid ELL entries
+
+    __host__ __device__
+    verify_summary(void) : count(0)
+    {
+        for (int i = 0; i < max_verify_checks; i++)
+        {
+            violations[i] = 0;
+            first[i]      = size_t(-1);
+        }
+    }
+
+    __host__ __device__
+    void fail(const int check, const size_t n)
+    {
+        violations[check] = 1;
+        first[check]      = n;
+    }
+};
+
+struct merge_verify_summary
+{
+    __host__ __device__
+    verify_summary operator()(const verify_summary& a, const verify_summary& b) const
+    {
+        verify_summary r;
+
+        for (int i = 0; i < max_verify_checks; i++)
+        {
+            r.violations[i] = a.violations[i] + b.violations[i];
+            r.first[i]      = a.first[i] < b.first[i] ? a.first[i] : b.first[i];
+        }
+
+        r.count = a.count + b.count;
+
+        return r;
+    }
+};
+
+template <typename Check>
+struct verify_position
 {
-//    // return a pair<> containing the min and max value in a range
-//    thrust::pair<typename IndexVector::const_iterator, typename IndexVector::const_iterator> iter = thrust::minmax_element(indices.begin(), indices.end());
-//    return thrust::make_pair(*iter.first, *iter.second);
-   
-    // WAR lack of const_iterator in array1d_view
-    return thrust::make_pair
-      (*thrust::min_element(indices.begin(), indices.end()),
-       *thrust::max_element(indices.begin(), indices.end()));
+    Check check;
+
+    verify_position(const Check& check) : check(check) {}
+
+    __host__ __device__
+    verify_summary operator()(const size_t n) const
+    {
+        verify_summary s;
+        check(s, n);
+        return s;
+    }
+};
+
+// run check at the positions [0, N) in the memory space of the matrix
+template <typename MemorySpace, typename Check>
+verify_summary verify_positions(const size_t N, const Check& check)
+{
+    return thrust::transform_reduce(thrust::counting_iterator<size_t, MemorySpace>(0),
+                                    thrust::counting_iterator<size_t, MemorySpace>(N),
+                                    verify_position<Check>(check),
+                                    verify_summary(),
+                                    merge_verify_summary());
 }
 
+template <typename Array>
+const typename Array::value_type * verify_pointer(const Array& a)
+{
+    return a.size() == 0 ? 0 : thrust::raw_pointer_cast(&a[0]);
+}
+
+// checks 0, 1 and 2: row bounds, row order, column bounds
 template <typename IndexType>
-struct is_ell_entry
+struct verify_coo_entries
 {
-    IndexType num_rows;
-    IndexType pitch;
-    IndexType invalid_index;
+    const IndexType * I;
+    const IndexType * J;
+    size_t num_rows;
+    size_t num_cols;
+    size_t num_entries;
 
-    is_ell_entry(IndexType num_rows, IndexType pitch, IndexType invalid_index)
-        : num_rows(num_rows), pitch(pitch), invalid_index(invalid_index) {}
+    verify_coo_entries(const IndexType * I, const IndexType * J, size_t num_rows, size_t num_cols, size_t num_entries)
+        : I(I), J(J), num_rows(num_rows), num_cols(num_cols), num_entries(num_entries) {}
 
-    template <typename Tuple>
     __host__ __device__
-    bool operator()(const Tuple& t) const
+    void operator()(verify_summary& s, const size_t n, const int base = 0) const
     {
-        IndexType n = thrust::get<0>(t);
-        IndexType j = thrust::get<1>(t);
-        return (n % pitch < num_rows) && (j != invalid_index);
+        const IndexType i = I[n];
+        const IndexType j = J[n];
+
+        if (i < 0 || static_cast<size_t>(i) >= num_rows)
+            s.fail(base + 0, n);
+
+        if (n + 1 < num_entries && i > I[n + 1])
+            s.fail(base + 1, n);
+
+        if (j < 0 || static_cast<size_t>(j) >= num_cols)
+            s.fail(base + 2, n);
     }
 };
 
+// checks 0, 1 and 2: first and last row offsets, offset order, column bounds
 template <typename IndexType>
-struct is_ell_entry_in_bounds
+struct verify_csr_entries
 {
-    IndexType num_rows;
-    IndexType num_cols;
-    IndexType pitch;
+    const IndexType * Ap;
+    const IndexType * Aj;
+    size_t num_rows;
+    size_t num_cols;
+    size_t num_entries;
+
+    verify_csr_entries(const IndexType * Ap, const IndexType * Aj, size_t num_rows, size_t num_cols, size_t num_entries)
+        : Ap(Ap), Aj(Aj), num_rows(num_rows), num_cols(num_cols), num_entries(num_entries) {}
+
+    __host__ __device__
+    void operator()(verify_summary& s, const size_t n) const
+    {
+        if (n <= num_rows)
+        {
+            if ((n == 0 && Ap[n] != IndexType(0)) || (n == num_rows && (Ap[n] < 0 || static_cast<size_t>(Ap[n]) != num_entries)))
+                s.fail(0, n);
+
+            if (n < num_rows && Ap[n] > Ap[n + 1])
+                s.fail(1, n);
+        }
+
+        if (n < num_entries)
+        {
+            const IndexType j = Aj[n];
+
+            if (j < 0 || static_cast<size_t>(j) >= num_cols)
+                s.fail(2, n);
+        }
+    }
+};
+
+// check 0: column bounds of the valid entries, which are counted
+template <typename IndexType>
+struct verify_ell_entries
+{
+    const IndexType * Aj;
+    size_t num_rows;
+    size_t num_cols;
+    size_t pitch;
     IndexType invalid_index;
 
-    is_ell_entry_in_bounds(IndexType num_rows, IndexType num_cols, IndexType pitch, IndexType invalid_index)
-        : num_rows(num_rows), num_cols(num_cols), pitch(pitch), invalid_index(invalid_index) {}
+    verify_ell_entries(const IndexType * Aj, size_t num_rows, size_t num_cols, size_t pitch, IndexType invalid_index)
+        : Aj(Aj), num_rows(num_rows), num_cols(num_cols), pitch(pitch), invalid_index(invalid_index) {}
 
-    template <typename Tuple>
     __host__ __device__
-    bool operator()(const Tuple& t) const
+    void operator()(verify_summary& s, const size_t n, const int base = 0) const
     {
-        IndexType n = thrust::get<0>(t);
-        IndexType j = thrust::get<1>(t);
-        return (n % pitch < num_rows) && (j != invalid_index) && (j >= 0) && (j < num_cols);
+        const IndexType j = Aj[n];
+
+        // entries of the padding rows are ignored
+        if (n % pitch < num_rows && j != invalid_index)
+        {
+            s.count++;
+
+            if (j < 0 || static_cast<size_t>(j) >= num_cols)
+                s.fail(base, n);
+        }
     }
 };
 
+// check 0 for the ELL part, checks 1 to 3 for the COO part, whose
+// positions follow those of the ELL part
+template <typename IndexType>
+struct verify_hyb_entries
+{
+    verify_ell_entries<IndexType> ell;
+    verify_coo_entries<IndexType> coo;
+    size_t ell_size;
 
-///////////////////////////////
-// Matrix-Specific Functions //
-///////////////////////////////
+    verify_hyb_entries(const verify_ell_entries<IndexType>& ell, const verify_coo_entries<IndexType>& coo, size_t ell_size)
+        : ell(ell), coo(coo), ell_size(ell_size) {}
 
-template <typename MatrixType, typename OutputStream>
-bool is_valid_matrix(const MatrixType& A,
-                     OutputStream& ostream,
-                     cusp::coo_format)
+    __host__ __device__
+    void operator()(verify_summary& s, const size_t n) const
+    {
+        if (n < ell_size)
+            ell(s, n, 0);
+        else
+            coo(s, n - ell_size, 1);
+    }
+};
+
+inline bool fail_validation(matrix_validation& report, const std::string& message,
+                            const size_t num_violations = 0, const size_t first_violation = 0)
 {
-    typedef typename MatrixType::index_type IndexType;
+    report.valid           = false;
+    report.message         = message;
+    report.num_violations  = num_violations;
+    report.first_violation = first_violation;
+    return false;
+}
+
+// report the first failed check of a summary, with its message
+inline bool report_checks(matrix_validation& report, const verify_summary& s, const char * messages[], const int num_checks)
+{
+    for (int i = 0; i < num_checks; i++)
+    {
+        if (s.violations[i] > 0)
+        {
+            std::ostringstream oss;
+            oss << messages[i] << " (" << s.violations[i] << " violations, the first at position " << s.first[i] << ")";
+            return fail_validation(report, oss.str(), s.violations[i], s.first[i]);
+        }
+    }
+
+    return true;
+}
 
+template <typename MatrixType>
+bool validate_coo_sizes(const MatrixType& A, matrix_validation& report)
+{
     // we could relax some of these conditions if necessary
     if (A.row_indices.size() != A.num_entries)
     {
-        ostream << "size of row_indices (" << A.row_indices.size() << ") "
-                << "should be equal to num_entries (" << A.num_entries << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "size of row_indices (" << A.row_indices.size() << ") "
+            << "should be equal to num_entries (" << A.num_entries << ")";
+        return fail_validation(report, oss.str());
     }
     
     if (A.column_indices.size() != A.num_entries)
     {
-        ostream << "size of column_indices (" << A.column_indices.size() << ") "
-                << "should be equal to num_entries (" << A.num_entries << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "size of column_indices (" << A.column_indices.size() << ") "
+            << "should be equal to num_entries (" << A.num_entries << ")";
+        return fail_validation(report, oss.str());
     }
     
     if (A.values.size() != A.num_entries)
     {
-        ostream << "size of values (" << A.column_indices.size() << ") "
-                << "should be equal to num_entries (" << A.num_entries << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "size of values (" << A.values.size() << ") "
+            << "should be equal to num_entries (" << A.num_entries << ")";
+        return fail_validation(report, oss.str());
     }
-   
-    if (A.num_entries > 0)
+
+    return true;
+}
+
+template <typename MatrixType>
+bool validate_ell_sizes(const MatrixType& A, matrix_validation& report)
+{
+    if (A.column_indices.num_rows != A.values.num_rows ||
+        A.column_indices.num_cols != A.values.num_cols)
     {
-        // check that row indices are within [0, num_rows)
-        thrust::pair<IndexType,IndexType> min_max_row = index_range(A.row_indices);
-        if (min_max_row.first < 0)
-        {
-            ostream << "row indices should be non-negative";
-            return false;
-        }
-        if (static_cast<size_t>(min_max_row.second) >= A.num_rows)
-        {
-            ostream << "row indices should be less than num_row (" << A.num_rows << ")";
-            return false;
-        }
-        
-        // check that row_indices is a non-decreasing sequence
-        if (!thrust::is_sorted(A.row_indices.begin(), A.row_indices.end()))
-        {
-            ostream << "row indices should form a non-decreasing sequence";
-            return false;
-        }
+        std::ostringstream oss;
+        oss << "shape of column_indices array (" << A.column_indices.num_rows << "," << A.column_indices.num_cols << ") ";
+        oss << "should agree with the values array (" << A.values.num_rows << "," << A.values.num_cols << ")";
+        return fail_validation(report, oss.str());
+    }
+    
+    if (A.num_rows > A.values.num_rows)
+    {
+        std::ostringstream oss;
+        oss << "number of rows in values array (" << A.values.num_rows << ") ";
+        oss << "should be >= num_rows (" << A.num_rows << ")";
+        return fail_validation(report, oss.str());
+    }
 
-        // check that column indices are within [0, num_cols)
-        thrust::pair<IndexType,IndexType> min_max_col = index_range(A.column_indices);
-        if (min_max_col.first < 0)
-        {
-            ostream << "column indices should be non-negative";
-            return false;
-        }
-        if (static_cast<size_t>(min_max_col.second) >= A.num_cols)
-        {
-            ostream << "column indices should be less than num_cols (" << A.num_cols << ")";
-            return false;
-        }
+    return true;
+}
+
+template <typename MatrixType>
+bool validate_ell_count(const MatrixType& A, matrix_validation& report, const size_t true_num_entries)
+{
+    if (A.num_entries != true_num_entries)
+    {
+        std::ostringstream oss;
+        oss << "number of valid column indices (" << true_num_entries << ") ";
+        oss << "should be == num_entries (" << A.num_entries << ")";
+        return fail_validation(report, oss.str(), A.num_entries > true_num_entries ? A.num_entries - true_num_entries : true_num_entries - A.num_entries);
     }
 
     return true;
 }
 
+template <typename MatrixType>
+verify_ell_entries<typename MatrixType::index_type> make_verify_ell_entries(const MatrixType& A)
+{
+    return verify_ell_entries<typename MatrixType::index_type>
+        (verify_pointer(A.column_indices.values), A.num_rows, A.num_cols, A.column_indices.pitch, MatrixType::invalid_index);
+}
 
-template <typename MatrixType, typename OutputStream>
-bool is_valid_matrix(const MatrixType& A,
-                     OutputStream& ostream,
+template <typename MatrixType>
+verify_coo_entries<typename MatrixType::index_type> make_verify_coo_entries(const MatrixType& A)
+{
+    return verify_coo_entries<typename MatrixType::index_type>
+        (verify_pointer(A.row_indices), verify_pointer(A.column_indices), A.num_rows, A.num_cols, A.num_entries);
+}
+
+
+///////////////////////////////
+// Matrix-Specific Functions //
+///////////////////////////////
+
+template <typename MatrixType>
+bool validate_matrix(const MatrixType& A,
+                     matrix_validation& report,
+                     cusp::coo_format)
+{
+    typedef typename MatrixType::memory_space MemorySpace;
+
+    if (!validate_coo_sizes(A, report))
+        return false;
+
+    static const char * checks[] = {"row indices should be in [0, num_rows)",
+                                    "row indices should form a non-decreasing sequence",
+                                    "column indices should be in [0, num_cols)"};
+
+    const verify_summary s = verify_positions<MemorySpace>(A.num_entries, make_verify_coo_entries(A));
+
+    return report_checks(report, s, checks, 3);
+}
+
+
+template <typename MatrixType>
+bool validate_matrix(const MatrixType& A,
+                     matrix_validation& report,
                      cusp::csr_format)
 {
-    typedef typename MatrixType::index_type IndexType;
+    typedef typename MatrixType::index_type   IndexType;
+    typedef typename MatrixType::memory_space MemorySpace;
 
     // we could relax some of these conditions if necessary
     
     if (A.row_offsets.size() != A.num_rows + 1)
     {
-        ostream << "size of row_offsets (" << A.row_offsets.size() << ") "
-                << "should be equal to num_rows + 1 (" << (A.num_rows + 1) << ")";
-        return false;
-    }
-    
-    if (A.row_offsets.front() != IndexType(0))
-    {
-        ostream << "first value in row_offsets (" << A.row_offsets.front() << ") "
-                << "should be equal to 0";
-        return false;
-    }
-
-    // TODO is this overly strict?
-    if (static_cast<size_t>(A.row_offsets.back()) != A.num_entries)
-    {
-        ostream << "last value in row_offsets (" << A.row_offsets.back() << ") "
-                << "should be equal to num_entries (" << A.num_entries << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "size of row_offsets (" << A.row_offsets.size() << ") "
+            << "should be equal to num_rows + 1 (" << (A.num_rows + 1) << ")";
+        return fail_validation(report, oss.str());
     }
     
     if (A.column_indices.size() != A.num_entries)
     {
-        ostream << "size of column_indices (" << A.column_indices.size() << ") "
-                << "should be equal to num_entries (" << A.num_entries << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "size of column_indices (" << A.column_indices.size() << ") "
+            << "should be equal to num_entries (" << A.num_entries << ")";
+        return fail_validation(report, oss.str());
     }
     
     if (A.values.size() != A.num_entries)
     {
-        ostream << "size of values (" << A.column_indices.size() << ") "
-                << "should be equal to num_entries (" << A.num_entries << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "size of values (" << A.values.size() << ") "
+            << "should be equal to num_entries (" << A.num_entries << ")";
+        return fail_validation(report, oss.str());
     }
 
-    // check that row_offsets is a non-decreasing sequence
-    if (!thrust::is_sorted(A.row_offsets.begin(), A.row_offsets.end()))
-    {
-        ostream << "row offsets should form a non-decreasing sequence";
-        return false;
-    }
+    static const char * checks[] = {"row_offsets should begin with 0 and end with num_entries",
+                                    "row offsets should form a non-decreasing sequence",
+                                    "column indices should be in [0, num_cols)"};
 
-    if (A.num_entries > 0)
-    {
-        // check that column indices are within [0, num_cols)
-        thrust::pair<IndexType,IndexType> min_max = index_range(A.column_indices);
+    const verify_csr_entries<IndexType> check(verify_pointer(A.row_offsets), verify_pointer(A.column_indices),
+                                              A.num_rows, A.num_cols, A.num_entries);
 
-        if (min_max.first < 0)
-        {
-            ostream << "column indices should be non-negative";
-            return false;
-        }
-        if (static_cast<size_t>(min_max.second) >= A.num_cols)
-        {
-            ostream << "column indices should be less than num_cols (" << A.num_cols << ")";
-            return false;
-        }
-    }
+    const verify_summary s = verify_positions<MemorySpace>(std::max<size_t>(A.num_rows + 1, A.num_entries), check);
 
-    return true;
+    return report_checks(report, s, checks, 3);
 }
 
 
-template <typename MatrixType, typename OutputStream>
-bool is_valid_matrix(const MatrixType& A,
-                     OutputStream& ostream,
+template <typename MatrixType>
+bool validate_matrix(const MatrixType& A,
+                     matrix_validation& report,
                      cusp::dia_format)
 {
     if (A.num_rows > A.values.num_rows)
     {
-        ostream << "number of rows in values array (" << A.values.num_rows << ") ";
-        ostream << "should be >= num_rows (" << A.num_rows << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "number of rows in values array (" << A.values.num_rows << ") ";
+        oss << "should be >= num_rows (" << A.num_rows << ")";
+        return fail_validation(report, oss.str());
     }
     
-    if (A.num_rows > A.values.num_rows)
+    if (A.diagonal_offsets.size() != A.values.num_cols)
     {
-        ostream << "number of rows in values array (" << A.values.num_rows << ") ";
-        ostream << "should be >= num_rows (" << A.num_rows << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "number of columns in values array (" << A.values.num_cols << ") ";
+        oss << "should be equal to the number of diagonals (" << A.diagonal_offsets.size() << ")";
+        return fail_validation(report, oss.str());
     }
 
     return true;
 }
 
-template <typename MatrixType, typename OutputStream>
-bool is_valid_matrix(const MatrixType& A,
-                     OutputStream& ostream,
+template <typename MatrixType>
+bool validate_matrix(const MatrixType& A,
+                     matrix_validation& report,
                      cusp::ell_format)
 {
-    typedef typename MatrixType::index_type IndexType;
-
-    const IndexType invalid_index = MatrixType::invalid_index;
+    typedef typename MatrixType::memory_space MemorySpace;
 
-    if (A.column_indices.num_rows != A.values.num_rows ||
-        A.column_indices.num_cols != A.values.num_cols)
-    {
-        ostream << "shape of column_indices array (" << A.column_indices.num_rows << "," << A.column_indices.num_cols << ") ";
-        ostream << "should agree with the values array (" << A.values.num_rows << "," << A.values.num_cols << ")";
+    if (!validate_ell_sizes(A, report))
         return false;
-    }
-    
-    if (A.num_rows > A.values.num_rows)
-    {
-        ostream << "number of rows in values array (" << A.values.num_rows << ") ";
-        ostream << "should be >= num_rows (" << A.num_rows << ")";
-        return false;
-    }
 
-    // count true number of entries in ell structure
-    size_t true_num_entries = 
-      thrust::count_if(thrust::make_zip_iterator
-                       (
-                           thrust::make_tuple(thrust::counting_iterator<IndexType>(0), 
-                                              A.column_indices.values.begin())
-                       ),
-                       thrust::make_zip_iterator
-                       (
-                           thrust::make_tuple(thrust::counting_iterator<IndexType>(0), 
-                                              A.column_indices.values.begin())
-                       ) + A.column_indices.values.size(),
-                       is_ell_entry<IndexType>(A.num_rows, A.column_indices.pitch, invalid_index));
+    static const char * checks[] = {"column indices should be in [0, num_cols)"};
 
-    if (A.num_entries != true_num_entries)
-    {
-        ostream << "number of valid column indices (" << true_num_entries << ") ";
-        ostream << "should be == num_entries (" << A.num_entries << ")";
-        return false;
-    }
-
-    if (A.num_entries > 0)
-    {
-        // check that column indices are in [0, num_cols)
-        size_t num_entries_in_bounds =
-          thrust::count_if(thrust::make_zip_iterator
-                           (
-                               thrust::make_tuple(thrust::counting_iterator<IndexType>(0), 
-                                                  A.column_indices.values.begin())
-                           ),
-                           thrust::make_zip_iterator
-                           (
-                               thrust::make_tuple(thrust::counting_iterator<IndexType>(0), 
-                                                  A.column_indices.values.begin())
-                           ) + A.column_indices.values.size(),
-                           is_ell_entry_in_bounds<IndexType>(A.num_rows, A.num_cols, A.column_indices.pitch, invalid_index));
-        if (num_entries_in_bounds != true_num_entries)
-        {
-            ostream << "matrix contains (" << (true_num_entries - num_entries_in_bounds) << ") out-of-bounds column indices";
-            return false;
-        }
-    }
+    const verify_summary s = verify_positions<MemorySpace>(A.column_indices.values.size(), make_verify_ell_entries(A));
 
-    return true;
+    return validate_ell_count(A, report, s.count) && report_checks(report, s, checks, 1);
 }
 
-template <typename MatrixType, typename OutputStream>
-bool is_valid_matrix(const MatrixType& A,
-                     OutputStream& ostream,
+template <typename MatrixType>
+bool validate_matrix(const MatrixType& A,
+                     matrix_validation& report,
                      cusp::hyb_format)
 {
+    typedef typename MatrixType::index_type   IndexType;
+    typedef typename MatrixType::memory_space MemorySpace;
+
     // make sure redundant shapes values agree
     if (A.num_rows != A.ell.num_rows || A.num_rows != A.coo.num_rows ||
         A.num_cols != A.ell.num_cols || A.num_cols != A.coo.num_cols)
     {
-        ostream << "matrix shape (" << A.num_rows << "," << A.num_cols << ") ";
-        ostream << "should be equal to shape of ELL part (" << A.ell.num_rows << "," << A.ell.num_cols << ") and ";
-        ostream << "COO part (" << A.coo.num_rows << "," << A.coo.num_cols << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "matrix shape (" << A.num_rows << "," << A.num_cols << ") ";
+        oss << "should be equal to shape of ELL part (" << A.ell.num_rows << "," << A.ell.num_cols << ") and ";
+        oss << "COO part (" << A.coo.num_rows << "," << A.coo.num_cols << ")";
+        return fail_validation(report, oss.str());
     }
 
     // check that num_entries = A.ell.num_entries + A.coo.num_entries
     if (A.num_entries != A.ell.num_entries + A.coo.num_entries)
     {
-        ostream << "num_entries (" << A.num_entries << ") ";
-        ostream << "should be equal to sum of ELL num_entries (" << A.ell.num_entries << ") and ";
-        ostream << "COO num_entries (" << A.coo.num_entries << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "num_entries (" << A.num_entries << ") ";
+        oss << "should be equal to sum of ELL num_entries (" << A.ell.num_entries << ") and ";
+        oss << "COO num_entries (" << A.coo.num_entries << ")";
+        return fail_validation(report, oss.str());
     }
 
-    return cusp::is_valid_matrix(A.ell, ostream) && cusp::is_valid_matrix(A.coo, ostream);
+    if (!validate_ell_sizes(A.ell, report) || !validate_coo_sizes(A.coo, report))
+        return false;
+
+    // both parts in one reduction
+    const size_t ell_size = A.ell.column_indices.values.size();
+
+    const verify_hyb_entries<IndexType> check(make_verify_ell_entries(A.ell), make_verify_coo_entries(A.coo), ell_size);
+
+    const verify_summary s = verify_positions<MemorySpace>(ell_size + A.coo.num_entries, check);
+
+    static const char * checks[] = {"column indices of the ELL part should be in [0, num_cols)",
+                                    "row indices of the COO part should be in [0, num_rows)",
+                                    "row indices of the COO part should form a non-decreasing sequence",
+                                    "column indices of the COO part should be in [0, num_cols)"};
+
+    return validate_ell_count(A.ell, report, s.count) && report_checks(report, s, checks, 4);
 }
 
 
-template <typename MatrixType, typename OutputStream>
-bool is_valid_matrix(const MatrixType& A,
-                     OutputStream& ostream,
+template <typename MatrixType>
+bool validate_matrix(const MatrixType& A,
+                     matrix_validation& report,
                      cusp::array2d_format)
 {
     if (A.num_rows * A.num_cols != A.num_entries)
     {
-        ostream << "product of matrix dimensions (" << A.num_rows << "," << A.num_cols << ") ";
-        ostream << "should equal num_entries (" << A.num_entries << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "product of matrix dimensions (" << A.num_rows << "," << A.num_cols << ") ";
+        oss << "should equal num_entries (" << A.num_entries << ")";
+        return fail_validation(report, oss.str());
     }
     
     if (A.num_entries != A.values.size())
     {
-        ostream << "num_entries (" << A.num_entries << ") ";
-        ostream << "should agree with size of values array (" << A.values.size() << ")";
-        return false;
+        std::ostringstream oss;
+        oss << "num_entries (" << A.num_entries << ") ";
+        oss << "should agree with size of values array (" << A.values.size() << ")";
+        return fail_validation(report, oss.str());
     }
     
     // TODO check .pitch
@@ -386,29 +536,41 @@ bool is_valid_matrix(const MatrixType& A,
 // Entry points //
 //////////////////
 
+template <typename MatrixType>
+matrix_validation validate_matrix(const MatrixType& A)
+{
+    matrix_validation report;
+
+    // dispatch on matrix format
+    detail::validate_matrix(A, report, typename MatrixType::format());
+
+    return report;
+}
+
 template <typename MatrixType>
 bool is_valid_matrix(const MatrixType& A)
 {
-    std::ostringstream oss;
-    return cusp::is_valid_matrix(A, oss);
+    return cusp::validate_matrix(A).valid;
 }
 
 template <typename MatrixType, typename OutputStream>
 bool is_valid_matrix(const MatrixType& A, OutputStream& ostream)
 {
-    // dispatch on matrix format
-    return detail::is_valid_matrix(A, ostream, typename MatrixType::format());
+    const matrix_validation report = cusp::validate_matrix(A);
+
+    if (!report.valid)
+        ostream << report.message;
+
+    return report.valid;
 }
 
 template <typename MatrixType>
 void assert_is_valid_matrix(const MatrixType& A)
 {
-    std::ostringstream oss;
-    bool is_valid = cusp::is_valid_matrix(A, oss);
+    const matrix_validation report = cusp::validate_matrix(A);
 
-    if (!is_valid)
-        throw cusp::format_exception(oss.str());
+    if (!report.valid)
+        throw cusp::format_exception(report.message);
 }
 
 } // end namespace cusp
-
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+namespace cusp
+{
+namespace detail
+{
+
+// host wall-clock time in milliseconds since an arbitrary origin
+inline double wall_clock_milliseconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, count;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&count);
+    return 1e3 * double(count.QuadPart) / double(frequency.QuadPart);
+#else
+    timeval t;
+    gettimeofday(&t, 0);
+    return 1e3 * double(t.tv_sec) + 1e-3 * double(t.tv_usec);
+#endif
+}
+
+} // end namespace detail
+} // end namespace cusp
+
@@ -0,0 +1,194 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file dia_coo_matrix.h
+ *  \brief Hybrid DIA/COO matrix format.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/coo_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/format.h>
+#include <cusp/detail/matrix_base.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p dia_coo_matrix : Hybrid DIA/COO matrix container
+ *
+ * The \p dia_coo_matrix splits a matrix into a \p dia_matrix holding
+ * its densely populated diagonals and a \p coo_matrix holding all other
+ * entries, in the way the \p hyb_matrix splits a matrix into ELL and COO
+ * portions.  The DIA format stores every occupied diagonal in full, so a
+ * few entries away from the main diagonals, e.g. from boundary conditions
+ * of a stencil, make a \p dia_matrix conversion fail or waste most of
+ * its storage.  In a \p dia_coo_matrix those entries cost one COO entry
+ * each.
+ *
+ * When converting to a \p dia_coo_matrix a diagonal is stored in the DIA
+ * portion if at least a fraction \p min_fill (default 0.5) of its
+ * \p num_rows slots are occupied.  Diagonals with fewer entries move less
+ * data per SpMV as COO entries than as a full DIA column.
+ *
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ * \note The \p coo entries must be sorted by row index.
+ * \note Conversions into a \p dia_coo_matrix use the \p min_fill of the
+ *  destination.
+ *
+ *  \code
+ *  #include <cusp/dia_coo_matrix.h>
+ *  #include <cusp/gallery/poisson.h>
+ *  ...
+ *
+ *  // 5-point Laplacian on a 100x100 grid
+ *  cusp::coo_matrix<int,float,cusp::host_memory> A;
+ *  cusp::gallery::poisson5pt(A, 100, 100);
+ *
+ *  // the five diagonals are stored in DIA format, no COO entries
+ *  cusp::dia_coo_matrix<int,float,cusp::device_memory> B(A);
+ *
+ *  // B.dia.diagonal_offsets.size() == 5
+ *  // B.coo.num_entries == 0
+ *
+ *  // store only diagonals that are at least 90% full
+ *  cusp::dia_coo_matrix<int,float,cusp::device_memory> C(A, 0.9f);
+ *  \endcode
+ *
+ *  \see \p dia_matrix
+ *  \see \p hyb_matrix
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class dia_coo_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::dia_coo_format>
+{
+  typedef cusp::detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::dia_coo_format> Parent;
+  public:
+    /*! rebind matrix to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::dia_coo_matrix<IndexType, ValueType, MemorySpace2> type; };
+
+    /*! type of the DIA portion
+     */
+    typedef typename cusp::dia_matrix<IndexType, ValueType, MemorySpace> dia_matrix_type;
+
+    /*! type of the COO portion
+     */
+    typedef typename cusp::coo_matrix<IndexType, ValueType, MemorySpace> coo_matrix_type;
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::dia_coo_matrix<IndexType, ValueType, MemorySpace> container;
+
+    /*! Smallest fraction of the \p num_rows slots of a diagonal that
+     *  must be occupied for the diagonal to be stored in the DIA portion.
+     */
+    float min_fill;
+
+    /*! Storage for the DIA portion.
+     */
+    dia_matrix_type dia;
+
+    /*! Storage for the COO portion.
+     */
+    coo_matrix_type coo;
+
+    /*! Construct an empty \p dia_coo_matrix.
+     */
+    dia_coo_matrix() : min_fill(0.5f) {}
+
+    /*! Construct a \p dia_coo_matrix with a specific shape and separation into DIA and COO portions.
+     *
+     *  \param num_rows Number of rows.
+     *  \param num_cols Number of columns.
+     *  \param num_dia_entries Number of nonzero matrix entries in the DIA portion.
+     *  \param num_coo_entries Number of nonzero matrix entries in the COO portion.
+     *  \param num_diagonals Number of diagonals in the DIA portion.
+     *  \param alignment Amount of padding used to align the DIA data structure (default 32).
+     */
+    dia_coo_matrix(size_t num_rows, size_t num_cols,
+                   size_t num_dia_entries, size_t num_coo_entries,
+                   size_t num_diagonals, size_t alignment = 32)
+    : Parent(num_rows, num_cols, num_dia_entries + num_coo_entries),
+      min_fill(0.5f),
+      dia(num_rows, num_cols, num_dia_entries, num_diagonals, alignment),
+      coo(num_rows, num_cols, num_coo_entries) {}
+
+    /*! Construct a \p dia_coo_matrix with the default \p min_fill from
+     *  another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    dia_coo_matrix(const MatrixType& matrix);
+
+    /*! Construct a \p dia_coo_matrix from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     *  \param min_fill Smallest fraction of occupied slots of a DIA diagonal.
+     */
+    template <typename MatrixType>
+    dia_coo_matrix(const MatrixType& matrix, float min_fill);
+
+    /*! Resize matrix dimensions and underlying storage
+     */
+    void resize(size_t num_rows, size_t num_cols,
+                size_t num_dia_entries, size_t num_coo_entries,
+                size_t num_diagonals, size_t alignment = 32)
+    {
+      Parent::resize(num_rows, num_cols, num_dia_entries + num_coo_entries);
+      dia.resize(num_rows, num_cols, num_dia_entries, num_diagonals, alignment);
+      coo.resize(num_rows, num_cols, num_coo_entries);
+    }
+
+    /*! Swap the contents of two \p dia_coo_matrix objects.
+     *
+     *  \param matrix Another \p dia_coo_matrix with the same IndexType and ValueType.
+     */
+    void swap(dia_coo_matrix& matrix)
+    {
+      Parent::swap(matrix);
+      thrust::swap(min_fill, matrix.min_fill);
+      dia.swap(matrix.dia);
+      coo.swap(matrix.coo);
+    }
+
+    /*! Assignment from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    dia_coo_matrix& operator=(const MatrixType& matrix);
+}; // class dia_coo_matrix
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/dia_coo_matrix.inl>
@@ -0,0 +1,300 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file distributed_array1d.h
+ *  \brief One-dimensional array partitioned across several devices
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/distribution.h>
+#include <cusp/memory.h>
+
+#include <thrust/detail/type_traits.h>
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace cusp
+{
+
+/*! \addtogroup arrays Arrays
+ */
+
+/*! \addtogroup array_containers Array Containers
+ *  \ingroup arrays
+ *  \{
+ */
+
+/*! \p scoped_distribution : distribute the arrays of size \c N that the
+ *  calling host thread constructs without an explicit distribution
+ *  according to a given distribution of size \c N, for the lifetime of
+ *  the object.
+ *
+ *  Arrays of other sizes are split evenly across all visible devices.
+ *  The previous distribution is restored on destruction, so scopes may
+ *  be nested.
+ *
+ *  The temporaries of the iterative solvers are distributed this way,
+ *  so that a solver may run on a \p distributed_csr_matrix whose vectors
+ *  are distributed.
+ *
+ *  \code
+ *  cusp::distributed_csr_matrix<int, float, cusp::distributed_memory> A(B, devices);
+ *
+ *  cusp::scoped_distribution scope(A.get_distribution());
+ *
+ *  cusp::distributed_array1d<float> x(A.num_rows, 0);
+ *  cusp::distributed_array1d<float> b(A.num_rows, 1);
+ *
+ *  cusp::krylov::cg(A, x, b);
+ *  \endcode
+ */
+class scoped_distribution
+{
+    public:
+    explicit scoped_distribution(const cusp::distribution& d);
+
+    ~scoped_distribution(void);
+
+    private:
+    cusp::distribution value;
+    const cusp::distribution * previous;
+
+    // not copyable
+    scoped_distribution(const scoped_distribution&);
+    scoped_distribution& operator=(const scoped_distribution&);
+};
+
+/*! \p distributed_iterator : position in a \p distributed_array1d.
+ *
+ *  The iterator only designates ranges of a distributed array for the
+ *  functions in \p cusp::blas, it cannot be dereferenced.
+ */
+template <typename Array>
+class distributed_iterator
+{
+    public:
+    typedef typename Array::value_type        value_type;
+    typedef std::ptrdiff_t                    difference_type;
+    typedef value_type *                      pointer;
+    typedef value_type &                      reference;
+    typedef std::random_access_iterator_tag   iterator_category;
+
+    distributed_iterator(Array * array, size_t index)
+        : m_array(array), m_index(index) {}
+
+    Array * array(void) const { return m_array; }
+    size_t  index(void) const { return m_index; }
+
+    distributed_iterator operator+(difference_type n) const { return distributed_iterator(m_array, m_index + n); }
+    distributed_iterator operator-(difference_type n) const { return distributed_iterator(m_array, m_index - n); }
+
+    difference_type operator-(const distributed_iterator& it) const { return difference_type(m_index) - difference_type(it.m_index); }
+
+    bool operator==(const distributed_iterator& it) const { return m_array == it.m_array && m_index == it.m_index; }
+    bool operator!=(const distributed_iterator& it) const { return !(*this == it); }
+
+    private:
+    Array * m_array;
+    size_t  m_index;
+};
+
+/*! \p distributed_array1d : One-dimensional array whose elements are
+ *  partitioned across several devices and processes.
+ *
+ * \tparam ValueType value_type of the array
+ *
+ *  Each range of the \p distribution is stored in a device array, the
+ *  slice, on the device of the range.  The functions in \p cusp::blas
+ *  process the slices concurrently on the default stream of each device.
+ *  Reductions such as \p cusp::blas::dot and \p cusp::blas::nrm2 reduce
+ *  each slice on its device and combine the partial results on the host
+ *  once all devices are done.  The arguments of a function must have the
+ *  same distribution.
+ *
+ *  A process only stores the slices of its own ranges.  With a
+ *  communicator of several processes the BLAS functions are collective:
+ *  every process calls them with its part of the same arrays, and the
+ *  partial results of a reduction are gathered from all processes and
+ *  combined in the order of their ranks, so every process obtains the
+ *  same value.
+ *
+ *  An array constructed from a size follows the current
+ *  \p scoped_distribution, so \p distributed_array1d and
+ *  <tt>cusp::array1d<ValueType, cusp::distributed_memory></tt> can be
+ *  used with algorithms and solvers that allocate temporary arrays in
+ *  the memory space of their operands.
+ *
+ *  \code
+ *  #include <cusp/distributed_array1d.h>
+ *  #include <cusp/blas.h>
+ *
+ *  // split 1000 values evenly across devices 0 and 1
+ *  std::vector<int> devices;
+ *  devices.push_back(0);
+ *  devices.push_back(1);
+ *
+ *  cusp::distribution d(1000, devices);
+ *
+ *  cusp::distributed_array1d<float> x(d, 1.0f);
+ *  cusp::distributed_array1d<float> y(d, 2.0f);
+ *
+ *  cusp::blas::axpy(x, y, 3.0f);          // y = 3 * x + y
+ *  float result = cusp::blas::dot(x, y);  // 5000
+ *
+ *  // copy to the host
+ *  cusp::array1d<float, cusp::host_memory> h;
+ *  y.gather(h);
+ *  \endcode
+ */
+template <typename ValueType>
+class distributed_array1d
+{
+    public:
+    typedef ValueType                                       value_type;
+    typedef size_t                                          size_type;
+    typedef cusp::distributed_memory                        memory_space;
+    typedef cusp::array1d_format                            format;
+    typedef cusp::array1d<ValueType,cusp::device_memory>    slice_type;
+    typedef distributed_iterator<distributed_array1d>       iterator;
+    typedef distributed_iterator<const distributed_array1d> const_iterator;
+
+    distributed_array1d(void);
+
+    /*! Construct an uninitialized array of \p n values.
+     */
+    explicit distributed_array1d(size_type n);
+
+    distributed_array1d(size_type n, const value_type& value);
+
+    /*! Construct an uninitialized array with the given distribution.
+     */
+    explicit distributed_array1d(const cusp::distribution& d);
+
+    distributed_array1d(const cusp::distribution& d, const value_type& value);
+
+    distributed_array1d(const distributed_array1d& a);
+
+    /*! Distribute a host or device array of all values, of which the
+     *  calling process keeps its ranges.
+     */
+    template <typename Array>
+    explicit distributed_array1d(const Array& a,
+                                 typename thrust::detail::enable_if<!thrust::detail::is_convertible<Array,size_type>::value>::type * = 0);
+
+    ~distributed_array1d(void);
+
+    distributed_array1d& operator=(const distributed_array1d& a);
+
+    /*! Distribute a host or device array.
+     */
+    template <typename Array>
+    distributed_array1d& operator=(const Array& a);
+
+    /*! Copy the values to a host or device array of size size().
+     *  Only the ranges of the calling process are written.
+     */
+    template <typename Array>
+    void gather(Array& a) const;
+
+    /*! Resize the array to \p n values.  The values are not preserved
+     *  unless the size is unchanged.
+     */
+    void resize(size_type n);
+
+    size_type size(void) const { return dist.size(); }
+    bool      empty(void) const { return size() == 0; }
+
+    const cusp::distribution& get_distribution(void) const { return dist; }
+
+    size_t num_partitions(void) const { return dist.num_partitions(); }
+
+    /*! values [begin(p), end(p)) of the distribution, for a range of
+     *  the calling process
+     */
+    slice_type&       slice(size_t p)       { return *slices[p]; }
+    const slice_type& slice(size_t p) const { return *slices[p]; }
+
+    /*! device storage for the partial results of the reductions of
+     *  slice \p p
+     */
+    slice_type& partials(size_t p) const { return *reduction[p]; }
+
+    iterator       begin(void)       { return iterator(this, 0); }
+    iterator       end(void)         { return iterator(this, size()); }
+    const_iterator begin(void) const { return const_iterator(this, 0); }
+    const_iterator end(void)   const { return const_iterator(this, size()); }
+
+    private:
+    cusp::distribution        dist;
+    std::vector<slice_type *> slices;
+    std::vector<slice_type *> reduction;
+
+    void allocate(const cusp::distribution& d);
+    void release(void);
+};
+
+/*! \p array1d with \p distributed_memory is a \p distributed_array1d.
+ */
+template <typename T>
+class array1d<T, cusp::distributed_memory> : public cusp::distributed_array1d<T>
+{
+    typedef cusp::distributed_array1d<T> Parent;
+
+    public:
+    typedef typename Parent::size_type  size_type;
+    typedef typename Parent::value_type value_type;
+
+    template<typename MemorySpace2>
+      struct rebind { typedef cusp::array1d<T, MemorySpace2> type; };
+
+    typedef cusp::array1d<T, cusp::distributed_memory> container;
+
+    array1d(void) : Parent() {}
+
+    explicit array1d(size_type n)
+        : Parent(n) {}
+
+    array1d(size_type n, const value_type& value)
+        : Parent(n, value) {}
+
+    explicit array1d(const cusp::distribution& d)
+        : Parent(d) {}
+
+    array1d(const cusp::distribution& d, const value_type& value)
+        : Parent(d, value) {}
+
+    template<typename Array>
+      array1d(const Array& a, typename thrust::detail::enable_if<!thrust::detail::is_convertible<Array,size_type>::value>::type * = 0)
+      : Parent(a) {}
+
+    template<typename Array>
+      array1d &operator=(const Array& a)
+      { Parent::operator=(a); return *this; }
+};
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/distributed_array1d.inl>
+
@@ -0,0 +1,255 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file distributed_csr_matrix.h
+ *  \brief CSR matrix partitioned by rows across several devices
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/distributed_array1d.h>
+#include <cusp/linear_operator.h>
+
+#include <cuda_runtime_api.h>
+
+#include <vector>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p distributed_csr_matrix : square sparse matrix whose rows are
+ *  partitioned across several devices and processes.
+ *
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ * \tparam MemorySpace Memory space of the vectors, \c cusp::device_memory
+ * (the default) or \c cusp::distributed_memory.
+ *
+ *  The rows are split into contiguous ranges with about the same number
+ *  of nonzeros.  Each range is stored on one device as two CSR
+ *  matrices:
+ *  - the local block holds the columns inside the row range of the
+ *    partition;
+ *  - the off-process block holds the remaining (halo) columns,
+ *    renumbered in the order of a precomputed list of halo columns.
+ *
+ *  With \c cusp::device_memory the matrix is a \p linear_operator whose
+ *  vectors reside on the home device, i.e. the device that is current
+ *  when the matrix is constructed.  Iterative solvers such as
+ *  \p cusp::krylov::cg and \p cusp::krylov::gmres therefore run on it
+ *  unmodified.  Only the matrix is distributed.  The vectors of the
+ *  solver and its BLAS operations stay on the home device.
+ *
+ *  A product y = A*x is issued asynchronously on the current stream:
+ *  - each partition copies its part of x from the home device with a
+ *    peer-to-peer copy and multiplies by its local block;
+ *  - at the same time, the halo values of x are gathered on the home
+ *    device and copied to the partition on a second stream;
+ *  - once they arrive, the partition adds the product of the
+ *    off-process block and copies its rows of y to the home device.
+ *
+ *  With \c cusp::distributed_memory the vectors are
+ *  \p distributed_array1d objects with the distribution of the rows,
+ *  see \p get_distribution.  Each partition multiplies its slice of x by
+ *  the local block, while the halo values are gathered on the devices
+ *  that own them and transferred directly between the devices.  The
+ *  work of a partition is issued on the default stream of its device,
+ *  like the BLAS functions of the distributed arrays.  Solvers that only
+ *  use \p array1d vectors and \p cusp::blas, such as \p cusp::krylov::cg
+ *  and \p cusp::krylov::bicgstab, run on such a matrix within a
+ *  \p scoped_distribution of its distribution, so the reductions of
+ *  the solver are distributed as well.
+ *
+ *  Peer access is enabled between the devices that exchange values
+ *  where supported.  Other copies are staged by the driver.
+ *
+ *  With a distribution over the processes of a \p communicator, e.g.
+ *  the nodes of a cluster (\p CUSP_USE_MPI), each process constructs
+ *  the matrix from the rows of its own partitions and the vectors must
+ *  be distributed.  The halo values that come from other processes are
+ *  determined once, on construction, and every product posts their
+ *  receives, stages the values that other processes need in pinned
+ *  host memory and sends them while the local blocks are multiplied.
+ *  Products and the BLAS functions of the vectors are then collective,
+ *  so \p cusp::krylov::cg runs on all processes at once.
+ *
+ *  \note The pool of \p CUSP_USE_CACHING_ALLOCATOR does not distinguish
+ *  devices, so it should not be enabled with more than one device.
+ *
+ *  \code
+ *  #include <cusp/distributed_csr_matrix.h>
+ *  #include <cusp/gallery/poisson.h>
+ *  #include <cusp/krylov/cg.h>
+ *
+ *  cusp::csr_matrix<int, float, cusp::host_memory> B;
+ *  cusp::gallery::poisson5pt(B, 1000, 1000);
+ *
+ *  // partition B across devices 0 and 1, with vectors on device 0
+ *  std::vector<int> devices;
+ *  devices.push_back(0);
+ *  devices.push_back(1);
+ *
+ *  cudaSetDevice(0);
+ *  cusp::distributed_csr_matrix<int, float> A(B, devices);
+ *
+ *  cusp::array1d<float, cusp::device_memory> x(A.num_rows, 0);
+ *  cusp::array1d<float, cusp::device_memory> b(A.num_rows, 1);
+ *
+ *  cusp::krylov::cg(A, x, b);
+ *
+ *  // distribute the vectors as well
+ *  cusp::distributed_csr_matrix<int, float, cusp::distributed_memory> D(B, devices);
+ *
+ *  cusp::scoped_distribution scope(D.get_distribution());
+ *
+ *  cusp::distributed_array1d<float> u(D.num_rows, 0);
+ *  cusp::distributed_array1d<float> f(D.num_rows, 1);
+ *
+ *  cusp::krylov::cg(D, u, f);
+ *
+ *  // one partition per process of an MPI job, on the device of
+ *  // its node that matches the rank of the process
+ *  cusp::communicator comm(MPI_COMM_WORLD);
+ *
+ *  cusp::csr_matrix<int, float, cusp::host_memory> rows;
+ *  cusp::distribution d;
+ *  cusp::io::read_matrix_market_file(rows, d, "A.mtx", comm, comm.rank() % num_devices);
+ *
+ *  cusp::distributed_csr_matrix<int, float, cusp::distributed_memory> M(rows, d);
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType, typename MemorySpace = cusp::device_memory>
+class distributed_csr_matrix : public cusp::linear_operator<ValueType, MemorySpace, IndexType>
+{
+    typedef cusp::linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+    struct halo_segment;
+    struct partition;
+
+    public:
+    /*! Construct a \p distributed_csr_matrix over all visible devices.
+     *
+     *  \param matrix A square sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    distributed_csr_matrix(const MatrixType& matrix);
+
+    /*! Construct a \p distributed_csr_matrix over the given devices.
+     *
+     *  \param matrix A square sparse or dense matrix.
+     *  \param devices The device of each partition.  A device may be
+     *  listed more than once.
+     */
+    template <typename MatrixType>
+    distributed_csr_matrix(const MatrixType& matrix, const std::vector<int>& devices);
+
+    /*! Construct the part of a \p distributed_csr_matrix that resides on
+     *  the calling process.  Collective on the communicator of the
+     *  distribution.
+     *
+     *  \param rows The rows of the partitions of the calling process in
+     *  the order of the partitions, with the columns of the whole
+     *  matrix, e.g. as read by \p cusp::io::read_matrix_market_file.
+     *  \param d The distribution of the rows.
+     */
+    template <typename MatrixType>
+    distributed_csr_matrix(const MatrixType& rows, const cusp::distribution& d);
+
+    ~distributed_csr_matrix(void);
+
+    /*! number of partitions
+     */
+    size_t num_partitions(void) const { return partitions.size(); }
+
+    /*! device of partition \p p
+     */
+    int device(size_t p) const;
+
+    /*! first row of partition \p p
+     */
+    IndexType row_begin(size_t p) const;
+
+    /*! one past the last row of partition \p p
+     */
+    IndexType row_end(size_t p) const;
+
+    /*! number of halo values of x needed by partition \p p, or 0 if it
+     *  resides on another process
+     */
+    size_t num_halo_columns(size_t p) const;
+
+    /*! device on which the vectors of the products reside, unless they
+     *  are distributed
+     */
+    int home_device(void) const { return home; }
+
+    /*! distribution of the rows, which distributed vectors must have
+     */
+    const cusp::distribution& get_distribution(void) const { return dist; }
+
+    /*! Compute y = A*x, where \p x and \p y reside on the home device or
+     *  are distributed like the rows.
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+
+    private:
+    int home;
+    cusp::distribution dist;
+    std::vector<partition *> partitions; // null on other processes
+
+    // values of this process that other processes import
+    std::vector<halo_segment *> exports;
+
+    // gathers x on the home device before the partitions read it
+    cudaEvent_t x_ready;
+
+    template <typename MatrixType>
+    void initialize(const MatrixType& matrix, const std::vector<int>& devices);
+
+    void build(const cusp::csr_matrix<IndexType,ValueType,cusp::host_memory>& A, const cusp::distribution& d);
+
+    void release(void);
+
+    template <typename VectorType1, typename VectorType2>
+    void multiply(const VectorType1& x, VectorType2& y, cusp::device_memory) const;
+
+    template <typename VectorType1, typename VectorType2>
+    void multiply(const VectorType1& x, VectorType2& y, cusp::distributed_memory) const;
+
+    // not copyable
+    distributed_csr_matrix(const distributed_csr_matrix&);
+    distributed_csr_matrix& operator=(const distributed_csr_matrix&);
+};
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/distributed_csr_matrix.inl>
+
@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file distribution.h
+ *  \brief Partition of indices across devices and processes
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/communicator.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace cusp
+{
+
+/*! \addtogroup arrays Arrays
+ */
+
+/*! \addtogroup array_containers Array Containers
+ *  \ingroup arrays
+ *  \{
+ */
+
+/*! \p distribution : partition of the indices [0, N) into contiguous
+ *  ranges, each of which resides on one device of one process.
+ *
+ *  Range \c p holds the indices [begin(p), end(p)) and is stored on
+ *  device(p) of process rank(p) of the communicator.  A device may hold
+ *  more than one range.  The distributions of a single process, which
+ *  all constructors but the last two create, have rank 0 throughout.
+ *
+ *  Every process of the communicator holds the same distribution; the
+ *  ranges of the calling process are those for which local(p) is true.
+ */
+class distribution
+{
+    public:
+    /*! Construct an empty distribution.
+     */
+    distribution(void);
+
+    /*! Split N indices evenly across all visible devices.
+     */
+    explicit distribution(size_t N);
+
+    /*! Split N indices evenly across the given devices.
+     */
+    distribution(size_t N, const std::vector<int>& devices);
+
+    /*! Construct a distribution from the device of each range and the
+     *  offsets of the ranges, where range \c p is [offsets[p], offsets[p+1]).
+     */
+    distribution(const std::vector<int>& devices, const std::vector<size_t>& offsets);
+
+    /*! Construct a distribution over the processes of a communicator
+     *  from the device, the offsets and the rank of each range.
+     */
+    distribution(const std::vector<int>& devices,
+                 const std::vector<size_t>& offsets,
+                 const std::vector<int>& ranks,
+                 const cusp::communicator& comm);
+
+    /*! Split N indices evenly across the processes of a communicator,
+     *  one range per process, which resides on the given device of the
+     *  process.  Collective on the communicator.
+     */
+    distribution(size_t N, int device, const cusp::communicator& comm);
+
+    /*! total number of indices
+     */
+    size_t size(void) const { return offsets.empty() ? 0 : offsets.back(); }
+
+    /*! number of ranges
+     */
+    size_t num_partitions(void) const { return devices.size(); }
+
+    int    device(size_t p) const { return devices[p]; }
+    size_t begin(size_t p)  const { return offsets[p]; }
+    size_t end(size_t p)    const { return offsets[p + 1]; }
+    int    rank(size_t p)   const { return ranks[p]; }
+
+    /*! whether range \p p resides on the calling process
+     */
+    bool local(size_t p) const { return ranks[p] == comm.rank(); }
+
+    /*! range that contains index \p i < size()
+     */
+    size_t owner(size_t i) const;
+
+    const cusp::communicator& get_communicator(void) const { return comm; }
+
+    bool operator==(const distribution& d) const
+    {
+        return devices == d.devices && offsets == d.offsets && ranks == d.ranks && comm == d.comm;
+    }
+    bool operator!=(const distribution& d) const { return !(*this == d); }
+
+    private:
+    std::vector<int>    devices;
+    std::vector<size_t> offsets;
+    std::vector<int>    ranks;
+    cusp::communicator  comm;
+
+    void validate(void) const;
+
+    void split(size_t N);
+};
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/distribution.inl>
@@ -0,0 +1,80 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+
+#include <cusp/krylov/detail/block_krylov.h>
+
+#include <thrust/copy.h>
+
+namespace cusp
+{
+namespace eigen
+{
+namespace detail
+{
+  // Column operations on the bases of the eigensolvers, which are
+  // contiguous column-major array2d's (pitch == num_rows) in the memory
+  // space of the matrix.  Products of bases and inner products between
+  // them are those of the block Krylov methods (detail_block).
+  namespace block = cusp::krylov::detail_block;
+
+  // V(:,c) of a contiguous column-major basis
+  template <typename Array2d>
+  typename Array2d::values_array_type::iterator column_begin(Array2d& V, size_t c)
+  {
+    return V.values.begin() + V.num_rows * c;
+  }
+
+  template <typename Array2d>
+  typename Array2d::values_array_type::iterator column_end(Array2d& V, size_t c)
+  {
+    return V.values.begin() + V.num_rows * (c + 1);
+  }
+
+  // V(:,first:first+U.num_cols) <- U
+  template <typename Array2d1, typename Array2d2>
+  void copy_columns(const Array2d1& U, Array2d2& V, size_t first)
+  {
+    thrust::copy(U.values.begin(), U.values.begin() + U.num_rows * U.num_cols, column_begin(V, first));
+  }
+
+  // norms[c] <- ||V(:,c)||
+  template <typename Array2d, typename HostArray1d>
+  void column_norms(Array2d& V, HostArray1d& norms)
+  {
+    norms.resize(V.num_cols);
+
+    for (size_t c = 0; c < V.num_cols; c++)
+      norms[c] = cusp::blas::nrm2(column_begin(V, c), column_end(V, c));
+  }
+
+  // V(:,c) <- alpha * V(:,c)
+  template <typename Array2d, typename ValueType>
+  void scale_column(Array2d& V, size_t c, ValueType alpha)
+  {
+    cusp::blas::scal(column_begin(V, c), column_end(V, c), alpha);
+  }
+
+} // end namespace detail
+} // end namespace eigen
+} // end namespace cusp
+
@@ -0,0 +1,244 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/copy.h>
+#include <cusp/detail/random.h>
+
+#include <cusp/eigen/detail/basis.h>
+#include <cusp/eigen/detail/symmetric_eigen.h>
+
+#include <thrust/copy.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cusp
+{
+namespace eigen
+{
+namespace detail
+{
+  // Orthogonalize V(:,j) against V(:,0:j) with classical Gram-Schmidt,
+  // applied twice, and store the coefficients V(:,0:j)^T V(:,j) in h.
+  // Returns the norm of the orthogonalized column, which is not scaled.
+  template <typename Array2d, typename HostArray2d>
+  typename Array2d::value_type orthogonalize(Array2d& V, size_t j, HostArray2d& h)
+  {
+    typedef typename Array2d::value_type ValueType;
+
+    h.resize(j, 1);
+    std::fill(h.values.begin(), h.values.end(), ValueType(0));
+
+    if (j > 0)
+    {
+      typename Array2d::view Q = block::columns(V, 0, j);
+      typename Array2d::view w = block::columns(V, j, j + 1);
+
+      HostArray2d c;
+
+      for (int pass = 0; pass < 2; pass++)
+      {
+        block::gram(Q, w, c);
+        block::combine(w, Q, c, ValueType(1), ValueType(-1));
+
+        for (size_t i = 0; i < j; i++)
+          h(i,0) += c(i,0);
+      }
+    }
+
+    return cusp::blas::nrm2(column_begin(V, j), column_end(V, j));
+  }
+
+  // V(:,j) <- a random unit vector orthogonal to V(:,0:j)
+  template <typename Array2d>
+  void random_column(Array2d& V, size_t j, size_t seed)
+  {
+    typedef typename Array2d::value_type ValueType;
+
+    cusp::detail::random_reals<ValueType> random(V.num_rows, seed);
+    thrust::copy(random.begin(), random.end(), column_begin(V, j));
+
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> h;
+    scale_column(V, j, ValueType(1) / orthogonalize(V, j, h));
+  }
+
+} // end namespace detail
+
+template <class LinearOperator,
+          class Array1d,
+          class Array2d>
+size_t lanczos(LinearOperator& A,
+               Array1d& eigenvalues,
+               Array2d& eigenvectors,
+               size_t k,
+               spectrum_end which)
+{
+    const size_t m = std::max<size_t>(2 * k + 1, 20);
+
+    return cusp::eigen::lanczos(A, eigenvalues, eigenvectors, k, which, m, 1e-5, 100);
+}
+
+template <class LinearOperator,
+          class Array1d,
+          class Array2d>
+size_t lanczos(LinearOperator& A,
+               Array1d& eigenvalues,
+               Array2d& eigenvectors,
+               size_t k,
+               spectrum_end which,
+               size_t m,
+               double tolerance,
+               size_t max_restarts)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    typedef cusp::array2d<ValueType,MemorySpace,cusp::column_major>       Block;
+    typedef cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> HostBlock;
+
+    namespace block = cusp::eigen::detail::block;
+
+    assert(A.num_rows == A.num_cols);        // sanity check
+
+    const size_t N = A.num_rows;
+
+    k = std::min(k, N);
+    m = std::min(std::max(m, k + 1), N);
+
+    cusp::array1d<ValueType,cusp::host_memory> h_eigenvalues(k);
+    Block X(N, k);
+
+    if (k == 0)
+    {
+        eigenvalues = h_eigenvalues;
+        cusp::copy(X, eigenvectors);
+        return 0;
+    }
+
+    const ValueType eps = std::numeric_limits<ValueType>::epsilon();
+
+    // Lanczos basis V(:,0:m+1) and projection H = V(:,0:m)^T A V(:,0:m)
+    Block V(N, m + 1);
+    HostBlock H(m, m, ValueType(0));
+
+    HostBlock h, Y;
+    cusp::array1d<ValueType,cusp::host_memory> theta;
+
+    detail::random_column(V, 0, 0);
+
+    // V(:,0:l) are the Ritz vectors kept by the last restart
+    size_t l = 0;
+    size_t converged = 0;
+
+    ValueType beta  = 0;
+    ValueType anorm = 0;
+
+    for (size_t restart = 0; ; restart++)
+    {
+        // extend the basis to m + 1 vectors
+        for (size_t j = l; j < m; j++)
+        {
+            typename Block::view v = block::columns(V, j, j + 1);
+            typename Block::view w = block::columns(V, j + 1, j + 2);
+
+            // V(:,j+1) <- A V(:,j), orthogonalized against the basis
+            block::multiply(A, v, w);
+            beta = detail::orthogonalize(V, j + 1, h);
+
+            ValueType sum = beta * beta;
+            for (size_t i = 0; i <= j; i++)
+            {
+                H(i,j) = H(j,i) = h(i,0);
+                sum += h(i,0) * h(i,0);
+            }
+
+            anorm = std::max(anorm, std::sqrt(sum));
+
+            if (beta > eps * anorm)
+            {
+                detail::scale_column(V, j + 1, ValueType(1) / beta);
+            }
+            else
+            {
+                // invariant subspace, continue with a new direction
+                // unless the basis spans the whole space
+                beta = 0;
+                if (j + 1 < N)
+                    detail::random_column(V, j + 1, j + 1);
+            }
+        }
+
+        // Ritz pairs, whose residual norms are |beta * Y(m-1,i)|
+        detail::symmetric_eigen(H, theta, Y);
+
+        const ValueType scale = std::max(std::abs(theta[0]), std::abs(theta[m - 1]));
+
+        converged = 0;
+        for (size_t i = 0; i < k; i++)
+            if (std::abs(beta * Y(m - 1, detail::wanted(which, m, i))) <= tolerance * scale)
+                converged++;
+
+        if (converged == k || restart >= max_restarts || m == N)
+            break;
+
+        // restart with the l Ritz vectors closest to the wanted end
+        l = std::min(m - 1, k + (m - k) / 2);
+
+        HostBlock Yl(m, l);
+        for (size_t c = 0; c < l; c++)
+            for (size_t i = 0; i < m; i++)
+                Yl(i,c) = Y(i, detail::wanted(which, m, c));
+
+        Block U(N, l);
+        block::combine(U, block::columns(V, 0, m), Yl, ValueType(0), ValueType(1));
+
+        // V(:,0:l) <- U, V(:,l) <- V(:,m)
+        detail::copy_columns(U, V, 0);
+        thrust::copy(detail::column_begin(V, m), detail::column_end(V, m), detail::column_begin(V, l));
+
+        std::fill(H.values.begin(), H.values.end(), ValueType(0));
+        for (size_t c = 0; c < l; c++)
+            H(c,c) = theta[detail::wanted(which, m, c)];
+    }
+
+    // the wanted Ritz pairs
+    HostBlock Yk(m, k);
+    for (size_t c = 0; c < k; c++)
+    {
+        h_eigenvalues[c] = theta[detail::wanted(which, m, c)];
+
+        for (size_t i = 0; i < m; i++)
+            Yk(i,c) = Y(i, detail::wanted(which, m, c));
+    }
+
+    block::combine(X, block::columns(V, 0, m), Yk, ValueType(0), ValueType(1));
+
+    eigenvalues = h_eigenvalues;
+    cusp::copy(X, eigenvectors);
+
+    return converged;
+}
+
+} // end namespace eigen
+} // end namespace cusp
+
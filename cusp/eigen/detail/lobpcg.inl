@@ -0,0 +1,299 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/copy.h>
+#include <cusp/exception.h>
+#include <cusp/linear_operator.h>
+
+#include <cusp/eigen/detail/basis.h>
+#include <cusp/eigen/detail/symmetric_eigen.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace cusp
+{
+namespace eigen
+{
+namespace detail
+{
+  // V(:,c) <- V(:,c) / ||V(:,c)||, AV(:,c) <- AV(:,c) / ||V(:,c)||
+  template <typename Array2d1, typename Array2d2>
+  void normalize_columns(Array2d1& V, Array2d2& AV)
+  {
+    typedef typename Array2d1::value_type ValueType;
+
+    cusp::array1d<ValueType,cusp::host_memory> norms;
+    column_norms(V, norms);
+
+    for (size_t c = 0; c < V.num_cols; c++)
+    {
+      if (norms[c] > ValueType(0))
+      {
+        scale_column(V,  c, ValueType(1) / norms[c]);
+        scale_column(AV, c, ValueType(1) / norms[c]);
+      }
+    }
+  }
+
+  // Rayleigh-Ritz procedure for an orthonormal basis Q and AQ = A Q.
+  // The k wanted Ritz values of the n = Q.num_cols Ritz values theta are
+  // stored in lambda, and the coefficients of the Ritz vectors in Y.
+  template <typename Array2d1, typename Array2d2, typename HostArray1d1,
+            typename HostArray1d2, typename HostArray2d>
+  void rayleigh_ritz(const Array2d1& Q, const Array2d2& AQ, spectrum_end which, size_t k,
+                     HostArray1d1& theta, HostArray1d2& lambda, HostArray2d& Y)
+  {
+    const size_t n = Q.num_cols;
+
+    HostArray2d G, Z;
+    block::gram(Q, AQ, G);
+    symmetric_eigen(G, theta, Z);
+
+    lambda.resize(k);
+    Y.resize(n, k);
+
+    for (size_t c = 0; c < k; c++)
+    {
+      lambda[c] = theta[wanted(which, n, c)];
+
+      for (size_t i = 0; i < n; i++)
+        Y(i,c) = Z(i, wanted(which, n, c));
+    }
+  }
+
+} // end namespace detail
+
+template <class LinearOperator,
+          class Array1d,
+          class Array2d>
+size_t lobpcg(LinearOperator& A,
+              Array1d& eigenvalues,
+              Array2d& X,
+              spectrum_end which)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    return cusp::eigen::lobpcg(A, eigenvalues, X, which, M);
+}
+
+template <class LinearOperator,
+          class Array1d,
+          class Array2d,
+          class Preconditioner>
+size_t lobpcg(LinearOperator& A,
+              Array1d& eigenvalues,
+              Array2d& X,
+              spectrum_end which,
+              Preconditioner& M)
+{
+    return cusp::eigen::lobpcg(A, eigenvalues, X, which, M, 1e-5, 500);
+}
+
+template <class LinearOperator,
+          class Array1d,
+          class Array2d,
+          class Preconditioner>
+size_t lobpcg(LinearOperator& A,
+              Array1d& eigenvalues,
+              Array2d& X,
+              spectrum_end which,
+              Preconditioner& M,
+              double tolerance,
+              size_t max_iterations)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    typedef cusp::array2d<ValueType,MemorySpace,cusp::column_major>       Block;
+    typedef cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> HostBlock;
+
+    namespace block = cusp::eigen::detail::block;
+
+    assert(A.num_rows == A.num_cols);        // sanity check
+
+    const size_t N = A.num_rows;
+    const size_t k = X.num_cols;
+
+    assert(X.num_rows == N);
+
+    cusp::array1d<ValueType,cusp::host_memory> lambda(k), theta, norms;
+
+    if (k == 0)
+    {
+        eigenvalues = lambda;
+        return 0;
+    }
+
+    // contiguous copies of the Ritz vectors X_ and of A X_
+    Block X_(N, k);
+    Block AX(N, k);
+    cusp::copy(X, X_);
+
+    HostBlock S, Y;
+
+    if (block::cholesky_qr(X_, S) != 0)
+        throw cusp::invalid_input_exception("lobpcg requires linearly independent starting vectors");
+
+    block::multiply(A, X_, AX);
+
+    // initial Ritz pairs in the span of X
+    {
+        Block Q(X_), AQ(AX);
+
+        detail::rayleigh_ritz(Q, AQ, which, k, theta, lambda, Y);
+
+        block::combine(X_, Q,  Y, ValueType(0), ValueType(1));
+        block::combine(AX, AQ, Y, ValueType(0), ValueType(1));
+    }
+
+    ValueType anorm = std::max(std::abs(theta[0]), std::abs(theta[k - 1]));
+
+    // preconditioned residuals W, search directions P, and the basis Q
+    Block R(N, k), Ra, W, AW, P, AP, Q, AQ, T;
+    HostBlock L(k, k, ValueType(0)), I, S_inv;
+
+    cusp::array1d<int,cusp::host_memory> h_active;
+    cusp::array1d<int,MemorySpace>       active;
+
+    bool has_P = false;
+    size_t converged = 0;
+
+    for (size_t iteration = 0; ; iteration++)
+    {
+        // R <- A X - X diag(lambda)
+        for (size_t c = 0; c < k; c++)
+            L(c,c) = lambda[c];
+
+        cusp::blas::copy(AX.values, R.values);
+        block::combine(R, X_, L, ValueType(1), ValueType(-1));
+
+        detail::column_norms(R, norms);
+
+        h_active.resize(0);
+        for (size_t c = 0; c < k; c++)
+            if (norms[c] > tolerance * anorm)
+                h_active.push_back(c);
+
+        converged = k - h_active.size();
+
+        if (h_active.size() == 0 || iteration >= max_iterations)
+            break;
+
+        const size_t a = h_active.size();
+
+        // W <- M R(:,active), AW <- A W
+        active = h_active;
+        block::gather(R, active, Ra);
+
+        W.resize(N, a);
+        AW.resize(N, a);
+        block::multiply(M, Ra, W);
+        block::multiply(A, W, AW);
+
+        detail::normalize_columns(W, AW);
+
+        if (has_P)
+            detail::normalize_columns(P, AP);
+
+        // orthonormal basis Q of [X W P] and AQ, dropping P when the
+        // basis is numerically dependent
+        size_t n = 0;
+        int status = 0;
+
+        for (;;)
+        {
+            n = k + a + (has_P ? k : 0);
+
+            Q.resize(N, n);
+            AQ.resize(N, n);
+
+            detail::copy_columns(X_, Q,  0);
+            detail::copy_columns(AX, AQ, 0);
+            detail::copy_columns(W,  Q,  k);
+            detail::copy_columns(AW, AQ, k);
+
+            if (has_P)
+            {
+                detail::copy_columns(P,  Q,  k + a);
+                detail::copy_columns(AP, AQ, k + a);
+            }
+
+            status = block::cholesky_qr(Q, S);
+
+            if (status == 0 || !has_P)
+                break;
+
+            has_P = false;
+        }
+
+        if (status != 0)
+            break;
+
+        // AQ <- AQ S^-1
+        I.resize(n, n);
+        std::fill(I.values.begin(), I.values.end(), ValueType(0));
+        for (size_t i = 0; i < n; i++)
+            I(i,i) = 1;
+
+        if (block::solve(S, I, S_inv) != 0)
+            break;
+
+        T.resize(N, n);
+        block::combine(T, AQ, S_inv, ValueType(0), ValueType(1));
+        AQ.swap(T);
+
+        // Ritz pairs in the span of [X W P]
+        detail::rayleigh_ritz(Q, AQ, which, k, theta, lambda, Y);
+
+        anorm = std::max(anorm, std::max(std::abs(theta[0]), std::abs(theta[n - 1])));
+
+        block::combine(X_, Q,  Y, ValueType(0), ValueType(1));
+        block::combine(AX, AQ, Y, ValueType(0), ValueType(1));
+
+        // P <- Q(:,k:n) Y(k:n,:), the part of the update of X that is
+        // orthogonal to its previous span
+        HostBlock Yp(n - k, k);
+        for (size_t c = 0; c < k; c++)
+            for (size_t i = k; i < n; i++)
+                Yp(i - k, c) = Y(i,c);
+
+        P.resize(N, k);
+        AP.resize(N, k);
+        block::combine(P,  block::columns(Q,  k, n), Yp, ValueType(0), ValueType(1));
+        block::combine(AP, block::columns(AQ, k, n), Yp, ValueType(0), ValueType(1));
+
+        has_P = true;
+    }
+
+    eigenvalues = lambda;
+    cusp::copy(X_, X);
+
+    return converged;
+}
+
+} // end namespace eigen
+} // end namespace cusp
+
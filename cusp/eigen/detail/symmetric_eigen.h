@@ -0,0 +1,152 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cusp
+{
+namespace eigen
+{
+
+/*! \p spectrum_end : end of the spectrum whose eigenpairs are wanted
+ */
+enum spectrum_end
+{
+    smallest, /*!< algebraically smallest eigenvalues */
+    largest   /*!< algebraically largest eigenvalues */
+};
+
+// Small dense eigenproblems of the eigensolvers.  The solvers project the
+// problem onto a basis of a few vectors stored in the memory space of the
+// matrix and solve the projected problem on the host.
+namespace detail
+{
+  // S = Q diag(theta) Q^T for a small symmetric host matrix S, with the
+  // eigenvalues in ascending order and orthonormal eigenvectors in the
+  // columns of Q (cyclic Jacobi method)
+  template <typename HostArray2d1, typename HostArray1d, typename HostArray2d2>
+  void symmetric_eigen(const HostArray2d1& S, HostArray1d& theta, HostArray2d2& Q)
+  {
+    typedef typename HostArray2d1::value_type ValueType;
+
+    const size_t n = S.num_rows;
+
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> T(n, n);
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> V(n, n, ValueType(0));
+
+    // only the upper triangle of S is referenced
+    ValueType norm = 0;
+    for (size_t j = 0; j < n; j++)
+    {
+      for (size_t i = 0; i <= j; i++)
+      {
+        T(i,j) = T(j,i) = S(i,j);
+        norm += (i == j ? 1 : 2) * S(i,j) * S(i,j);
+      }
+      V(j,j) = 1;
+    }
+
+    const ValueType eps = std::numeric_limits<ValueType>::epsilon();
+
+    for (int sweep = 0; sweep < 50; sweep++)
+    {
+      ValueType off = 0;
+      for (size_t j = 0; j < n; j++)
+        for (size_t i = 0; i < j; i++)
+          off += 2 * T(i,j) * T(i,j);
+
+      if (off <= eps * eps * norm)
+        break;
+
+      for (size_t p = 0; p < n; p++)
+      {
+        for (size_t q = p + 1; q < n; q++)
+        {
+          if (T(p,q) == ValueType(0))
+            continue;
+
+          // rotation in the (p,q) plane that annihilates T(p,q)
+          const ValueType tau = (T(q,q) - T(p,p)) / (2 * T(p,q));
+          const ValueType t   = (tau < 0 ? ValueType(-1) : ValueType(1)) / (std::abs(tau) + std::sqrt(tau * tau + 1));
+          const ValueType c   = 1 / std::sqrt(t * t + 1);
+          const ValueType s   = t * c;
+
+          for (size_t i = 0; i < n; i++)
+          {
+            const ValueType a = T(i,p);
+            const ValueType b = T(i,q);
+            T(i,p) = c * a - s * b;
+            T(i,q) = s * a + c * b;
+          }
+
+          for (size_t i = 0; i < n; i++)
+          {
+            const ValueType a = T(p,i);
+            const ValueType b = T(q,i);
+            T(p,i) = c * a - s * b;
+            T(q,i) = s * a + c * b;
+          }
+
+          for (size_t i = 0; i < n; i++)
+          {
+            const ValueType a = V(i,p);
+            const ValueType b = V(i,q);
+            V(i,p) = c * a - s * b;
+            V(i,q) = s * a + c * b;
+          }
+        }
+      }
+    }
+
+    // sort the eigenpairs
+    cusp::array1d<size_t,cusp::host_memory> order(n);
+    for (size_t i = 0; i < n; i++)
+      order[i] = i;
+
+    for (size_t i = 1; i < n; i++)
+      for (size_t j = i; j > 0 && T(order[j],order[j]) < T(order[j - 1],order[j - 1]); j--)
+        std::swap(order[j], order[j - 1]);
+
+    theta.resize(n);
+    Q.resize(n, n);
+
+    for (size_t j = 0; j < n; j++)
+    {
+      theta[j] = T(order[j],order[j]);
+
+      for (size_t i = 0; i < n; i++)
+        Q(i,j) = V(i,order[j]);
+    }
+  }
+
+  // index of the i-th wanted eigenvalue among n eigenvalues in ascending order
+  inline size_t wanted(const spectrum_end which, const size_t n, const size_t i)
+  {
+    return which == smallest ? i : n - 1 - i;
+  }
+
+} // end namespace detail
+} // end namespace eigen
+} // end namespace cusp
+
@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file lanczos.h
+ *  \brief Thick-restart Lanczos method for extreme eigenpairs
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/eigen/detail/symmetric_eigen.h>
+
+namespace cusp
+{
+namespace eigen
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup eigensolvers Eigensolvers
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p lanczos : Lanczos method with thick restarts
+ *
+ * Computes the \p k smallest or largest eigenpairs of the symmetric matrix
+ * \p A with a basis of at most max(2k+1, 20) vectors and up to 100
+ * restarts, to a relative tolerance of 1e-5.
+ */
+template <class LinearOperator,
+          class Array1d,
+          class Array2d>
+size_t lanczos(LinearOperator& A,
+               Array1d& eigenvalues,
+               Array2d& eigenvectors,
+               size_t k,
+               spectrum_end which);
+
+/*! \p lanczos : Lanczos method with thick restarts
+ *
+ * Computes the \p k smallest or largest eigenpairs of the symmetric matrix
+ * \p A.  A Lanczos basis of \p m vectors is built with full
+ * reorthogonalization, one sparse matrix-vector product per vector, and
+ * the eigenpairs of the projection of \p A onto the basis (the Ritz
+ * pairs) approximate those of \p A.  When the wanted Ritz pairs have not
+ * converged, the basis is restarted with the Ritz vectors closest to the
+ * wanted end of the spectrum (Wu and Simon's thick restart, which is
+ * equivalent to the implicitly restarted Lanczos method).  A Ritz pair
+ * (theta, x) has converged when \f$ ||A x - \theta x|| \f$ is at most
+ * \p tolerance times the largest Ritz value in magnitude, an estimate of
+ * \f$ ||A|| \f$.
+ *
+ * The basis is stored in the memory space of \p A and only the small
+ * projected eigenproblem is solved on the host.
+ *
+ * \param A symmetric matrix or \p linear_operator
+ * \param eigenvalues the \p k wanted eigenvalues, starting at the wanted end
+ * \param eigenvectors column-major \p array2d of the corresponding eigenvectors
+ * \param k number of wanted eigenpairs
+ * \param which \p cusp::eigen::smallest or \p cusp::eigen::largest
+ * \param m number of basis vectors, greater than \p k
+ * \param tolerance relative tolerance of the residuals
+ * \param max_restarts maximum number of restarts
+ * \return number of converged eigenpairs
+ *
+ * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam Array1d \p array1d
+ * \tparam Array2d column-major \p array2d
+ *
+ * \note The value type is \c float or \c double.  A single starting
+ * vector finds one eigenvector of each multiple eigenvalue, use \p lobpcg
+ * when multiplicities matter.
+ *
+ *  The following code snippet computes the 4 smallest eigenvalues of a
+ *  1d Poisson problem.
+ *
+ *  \code
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/eigen/lanczos.h>
+ *  #include <cusp/gallery/poisson.h>
+ *
+ *  int main(void)
+ *  {
+ *      cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *      cusp::gallery::poisson5pt(A, 100, 1);
+ *
+ *      cusp::array1d<float, cusp::host_memory> S;
+ *      cusp::array2d<float, cusp::device_memory, cusp::column_major> V;
+ *
+ *      cusp::eigen::lanczos(A, S, V, 4, cusp::eigen::smallest);
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ *
+ *  \see \p lobpcg
+ */
+template <class LinearOperator,
+          class Array1d,
+          class Array2d>
+size_t lanczos(LinearOperator& A,
+               Array1d& eigenvalues,
+               Array2d& eigenvectors,
+               size_t k,
+               spectrum_end which,
+               size_t m,
+               double tolerance,
+               size_t max_restarts);
+/*! \}
+ */
+
+} // end namespace eigen
+} // end namespace cusp
+
+#include <cusp/eigen/detail/lanczos.inl>
+
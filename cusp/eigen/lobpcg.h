@@ -0,0 +1,157 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file lobpcg.h
+ *  \brief Locally Optimal Block Preconditioned Conjugate Gradient method
+ *         for extreme eigenpairs
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/eigen/detail/symmetric_eigen.h>
+
+namespace cusp
+{
+namespace eigen
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup eigensolvers Eigensolvers
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p lobpcg : Locally Optimal Block Preconditioned Conjugate Gradient method
+ *
+ * Computes the smallest or largest eigenpairs of the symmetric matrix \p A
+ * without preconditioning, to a relative tolerance of 1e-5 in at most 500
+ * iterations.
+ */
+template <class LinearOperator,
+          class Array1d,
+          class Array2d>
+size_t lobpcg(LinearOperator& A,
+              Array1d& eigenvalues,
+              Array2d& X,
+              spectrum_end which);
+
+/*! \p lobpcg : Locally Optimal Block Preconditioned Conjugate Gradient method
+ *
+ * Computes the smallest or largest eigenpairs of the symmetric matrix \p A
+ * with preconditioner \p M, to a relative tolerance of 1e-5 in at most 500
+ * iterations.
+ */
+template <class LinearOperator,
+          class Array1d,
+          class Array2d,
+          class Preconditioner>
+size_t lobpcg(LinearOperator& A,
+              Array1d& eigenvalues,
+              Array2d& X,
+              spectrum_end which,
+              Preconditioner& M);
+
+/*! \p lobpcg : Locally Optimal Block Preconditioned Conjugate Gradient method
+ *
+ * Computes the k smallest or largest eigenpairs of the symmetric matrix
+ * \p A, where k is the number of columns of \p X (Knyazev's LOBPCG).  Each
+ * iteration applies the preconditioner to the residuals of the
+ * unconverged Ritz pairs, performs one sparse matrix times dense matrix
+ * product (SpMM) with them, and computes the Ritz pairs of \p A in the
+ * span of the current Ritz vectors, the preconditioned residuals and the
+ * previous search directions.  A Ritz pair (theta, x) has converged when
+ * \f$ ||A x - \theta x|| \f$ is at most \p tolerance times the largest
+ * Ritz value in magnitude, an estimate of \f$ ||A|| \f$.  Converged
+ * pairs remain in the basis but contribute no further residuals (soft
+ * locking).
+ *
+ * Unlike \p lanczos, the block finds all the eigenvectors of a multiple
+ * eigenvalue, and a preconditioner such as \p smoothed_aggregation,
+ * an approximation of the inverse of \p A, accelerates the convergence to
+ * the smallest eigenpairs of an SPD matrix.
+ *
+ * \param A symmetric matrix or \p linear_operator
+ * \param eigenvalues the k wanted eigenvalues, starting at the wanted end
+ * \param X column-major \p array2d of k linearly independent starting
+ *        vectors, overwritten with the corresponding eigenvectors
+ * \param which \p cusp::eigen::smallest or \p cusp::eigen::largest
+ * \param M preconditioner for A
+ * \param tolerance relative tolerance of the residuals
+ * \param max_iterations maximum number of iterations
+ * \return number of converged eigenpairs
+ *
+ * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam Array1d \p array1d
+ * \tparam Array2d column-major \p array2d
+ * \tparam Preconditioner is a matrix or subclass of \p linear_operator
+ *
+ * \note The value type is \c float or \c double, and 3k must not exceed
+ * the number of rows of \p A.  Iteration stops early if the basis
+ * becomes numerically dependent, which happens when the residuals have
+ * reached the precision of the value type.
+ *
+ *  The following code snippet computes the 4 smallest eigenpairs of a
+ *  2d Poisson problem with an algebraic multigrid preconditioner.
+ *
+ *  \code
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/eigen/lobpcg.h>
+ *  #include <cusp/gallery/poisson.h>
+ *  #include <cusp/precond/smoothed_aggregation.h>
+ *  #include <cusp/detail/random.h>
+ *
+ *  int main(void)
+ *  {
+ *      cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *      cusp::gallery::poisson5pt(A, 100, 100);
+ *
+ *      // random starting vectors
+ *      cusp::array2d<float, cusp::device_memory, cusp::column_major> X(A.num_rows, 4);
+ *      cusp::copy(cusp::detail::random_reals<float>(X.values.size()), X.values);
+ *
+ *      cusp::precond::smoothed_aggregation<int, float, cusp::device_memory> M(A);
+ *
+ *      cusp::array1d<float, cusp::host_memory> S;
+ *      cusp::eigen::lobpcg(A, S, X, cusp::eigen::smallest, M);
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ *
+ *  \see \p lanczos
+ */
+template <class LinearOperator,
+          class Array1d,
+          class Array2d,
+          class Preconditioner>
+size_t lobpcg(LinearOperator& A,
+              Array1d& eigenvalues,
+              Array2d& X,
+              spectrum_end which,
+              Preconditioner& M,
+              double tolerance,
+              size_t max_iterations);
+/*! \}
+ */
+
+} // end namespace eigen
+} // end namespace cusp
+
+#include <cusp/eigen/detail/lobpcg.inl>
+
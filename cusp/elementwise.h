@@ -22,6 +22,11 @@
 
 #include <cusp/detail/config.h>
 
+#include <cusp/array1d.h>
+#include <cusp/complex.h>
+
+#include <cstddef>
+
 namespace cusp
 {
 
@@ -30,15 +35,119 @@ namespace cusp
  *  \{
  */
 
-//// Uses Matrix1::value_type(0) and Matrix2::value_type(0) for values not present
-//template <typename Matrix1,
-//          typename Matrix2,
-//          typename Matrix3,
-//          typename BinaryFunction>
-//void transform_elementwise(const Matrix1& A,
-//                           const Matrix2& B,
-//                                 Matrix3& C,
-//                                 BinaryFunction op);
+/*! \p union_pattern : tag for a \p transform_elementwise whose result
+ *  holds the entries present in A or B
+ */
+struct union_pattern {};
+
+/*! \p intersection_pattern : tag for a \p transform_elementwise whose
+ *  result holds the entries present in both A and B
+ */
+struct intersection_pattern {};
+
+/*! \p transform_elementwise : Compute C(i,j) = op(A(i,j), B(i,j)) over the
+ *  union of the patterns of A and B
+ *
+ *  Uses Matrix1::value_type(0) and Matrix2::value_type(0) for values not
+ *  present.  Each row of C is merged from the sorted rows of A and B in a
+ *  single pass, \p csr_matrix operands are used directly while other
+ *  formats are converted to CSR first.
+ *
+ *  \code
+ *  // C <- max(A, B) entrywise
+ *  cusp::transform_elementwise(A, B, C, thrust::maximum<float>());
+ *  \endcode
+ */
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3,
+          typename BinaryFunction>
+void transform_elementwise(const Matrix1& A,
+                           const Matrix2& B,
+                                 Matrix3& C,
+                                 BinaryFunction op);
+
+/*! \p transform_elementwise : Compute C(i,j) = op(A(i,j), B(i,j)) over the
+ *  pattern selected by \p union_pattern or \p intersection_pattern
+ */
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3,
+          typename BinaryFunction,
+          typename Pattern>
+void transform_elementwise(const Matrix1& A,
+                           const Matrix2& B,
+                                 Matrix3& C,
+                                 BinaryFunction op,
+                                 Pattern pattern);
+
+/*! \p transform_values : Replace each stored value v of A by op(v)
+ *
+ *  Only the stored entries change, so A must be a \p coo_matrix or a
+ *  \p csr_matrix whose padding-free pattern carries no implicit zeros.
+ */
+template <typename Matrix,
+          typename UnaryFunction>
+void transform_values(Matrix& A,
+                      UnaryFunction op);
+
+/*! \p filter : Remove the entries of A for which predicate(i, j, A(i,j))
+ *  is false
+ *
+ *  \p coo_matrix entries are compacted in place, a \p csr_matrix is
+ *  counted and compacted row by row into new storage.
+ *
+ *  \code
+ *  // drop the entries with magnitude at most 1e-4
+ *  cusp::filter(A, cusp::drop_tolerance<float>(1e-4));
+ *  \endcode
+ */
+template <typename Matrix,
+          typename Predicate>
+void filter(Matrix& A,
+            Predicate predicate);
+
+/*! \p filter : Copy to B the entries of A for which predicate(i, j, A(i,j))
+ *  is true
+ *
+ *  A and B must have the same format, either COO or CSR, or A may be an
+ *  \p array2d, whose entries are then compacted into B without a sort.
+ *  With \p drop_tolerance this sparsifies a dense array in a single pass.
+ *
+ *  \code
+ *  cusp::array2d<float, cusp::device_memory> D(...);
+ *  cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *
+ *  // the entries of D with magnitude greater than 1e-4
+ *  cusp::filter(D, A, cusp::drop_tolerance<float>(1e-4));
+ *  \endcode
+ */
+template <typename Matrix1,
+          typename Matrix2,
+          typename Predicate>
+void filter(const Matrix1& A,
+                  Matrix2& B,
+            Predicate predicate);
+
+/*! \p drop_tolerance : predicate of \p filter that keeps the entries with
+ *  magnitude greater than \p tolerance
+ */
+template <typename ValueType>
+struct drop_tolerance
+{
+    typedef typename norm_type<ValueType>::type NormType;
+
+    NormType tolerance;
+
+    drop_tolerance(const NormType tolerance) : tolerance(tolerance) {}
+
+    template <typename IndexType>
+    __host__ __device__
+    bool operator()(const IndexType i, const IndexType j, const ValueType v) const
+    {
+        return cusp::abs(v) > tolerance;
+    }
+};
 
 /*! \p add : Compute the sum of two matrices
  */
@@ -57,6 +166,116 @@ template <typename Matrix1,
 void subtract(const Matrix1& A,
               const Matrix2& B,
                     Matrix3& C);
+
+/*! \p add : Compute C = alpha * A + beta * B
+ *
+ *  \p csr_matrix operands are added by a row-wise merge of their sorted
+ *  rows (see \p add_plan), other formats are converted to CSR first.
+ *  The pattern of C is the union of the patterns of A and B, including
+ *  entries whose sum is zero.
+ */
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3,
+          typename ScalarType>
+void add(const Matrix1& A,
+         const Matrix2& B,
+               Matrix3& C,
+         ScalarType alpha,
+         ScalarType beta);
+
+/*! \p add_plan : reusable pattern of the sum of two CSR matrices.
+ *
+ *  \p setup merges the rows of A and B once (symbolic phase): it counts
+ *  the union of the column indices of each row, scans the counts into the
+ *  row offsets of C and records the position in C of every entry of A and
+ *  B.  \p add then forms C = alpha * A + beta * B with two data-parallel
+ *  passes over the values (numeric phase), so that repeated sums of
+ *  matrices with fixed patterns, such as A - sigma * M in a shift-invert
+ *  loop, skip the merge.
+ *
+ *  The column indices of each row of A and B must be sorted and unique,
+ *  as produced by the Cusp conversions, and A, B and C must reside in
+ *  \p MemorySpace.
+ *
+ *  \tparam IndexType Type used for matrix indices (e.g. \c int).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or \c cusp::device_memory)
+ *
+ *  \code
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/elementwise.h>
+ *  ...
+ *
+ *  cusp::csr_matrix<int,float,cusp::device_memory> A, M, C;
+ *  ...
+ *
+ *  cusp::add_plan<int,cusp::device_memory> plan(A, M);
+ *
+ *  for (size_t k = 0; k < shifts.size(); k++)
+ *  {
+ *      // C <- A - sigma_k * M
+ *      plan.add(A, M, C, 1.0f, -shifts[k]);
+ *      ...
+ *  }
+ *  \endcode
+ */
+template <typename IndexType, class MemorySpace>
+class add_plan
+{
+    public:
+
+    /*! dimensions of the operands
+     */
+    size_t num_rows;
+    size_t num_cols;
+
+    /*! row offsets of the pattern of C
+     */
+    cusp::array1d<IndexType,MemorySpace> row_offsets;
+
+    /*! column indices of the pattern of C
+     */
+    cusp::array1d<IndexType,MemorySpace> column_indices;
+
+    /*! position in C of each entry of A
+     */
+    cusp::array1d<IndexType,MemorySpace> A_positions;
+
+    /*! position in C of each entry of B
+     */
+    cusp::array1d<IndexType,MemorySpace> B_positions;
+
+    /*! construct an empty \p add_plan
+     */
+    add_plan(void) : num_rows(0), num_cols(0) {}
+
+    /*! construct an \p add_plan for the patterns of \p A and \p B
+     */
+    template <typename Matrix1, typename Matrix2>
+    add_plan(const Matrix1& A, const Matrix2& B);
+
+    /*! merge the patterns of \p A and \p B
+     *
+     *  \throws cusp::invalid_input_exception when the dimensions differ
+     */
+    template <typename Matrix1, typename Matrix2>
+    void setup(const Matrix1& A, const Matrix2& B);
+
+    /*! number of entries of C
+     */
+    size_t num_entries(void) const { return column_indices.size(); }
+
+    /*! C <- alpha * A + beta * B for A and B with the patterns of \p setup
+     *
+     *  \p C is given the pattern of the plan unless its dimensions and
+     *  number of entries already match it.
+     *
+     *  \throws cusp::invalid_input_exception when the number of entries
+     *  of A or B differs from the plan
+     */
+    template <typename Matrix1, typename Matrix2, typename Matrix3, typename ScalarType>
+    void add(const Matrix1& A, const Matrix2& B, Matrix3& C, ScalarType alpha, ScalarType beta) const;
+};
 /*! \}
  */
 
@@ -82,5 +82,12 @@ namespace cusp
             runtime_exception(const MessageType& message) : exception(message) {}
     };
 
+    class implicit_copy_exception : public runtime_exception
+    {
+        public:
+            template <typename MessageType>
+            implicit_copy_exception(const MessageType& message) : runtime_exception(message) {}
+    };
+
 } // end namespace cusp
 
@@ -33,12 +33,26 @@ struct dense_format : public known_format {};
 struct array1d_format : public dense_format {};
 struct array2d_format : public dense_format {};
 
+struct sparse_vector_format : public known_format {};
+
 struct sparse_format : public known_format {};
 struct coo_format : public sparse_format {};
 struct csr_format : public sparse_format {};
 struct dia_format : public sparse_format {};
 struct ell_format : public sparse_format {};
 struct hyb_format : public sparse_format {};
+struct bsr_format : public sparse_format {};
+struct sell_format : public sparse_format {};
+struct jds_format : public sparse_format {};
+struct csr16_format : public sparse_format {};
+struct dia_coo_format : public sparse_format {};
+struct split_complex_format : public sparse_format {};
+struct symmetric_csr_format : public sparse_format {};
+struct batched_csr_format : public sparse_format {};
+
+struct auto_format : public known_format {};
+struct transpose_format : public known_format {};
+struct cached_format : public known_format {};
 
 } // end namespace cusp
 
@@ -0,0 +1,169 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file format_cache.h
+ *  \brief Derived formats of a matrix built once for repeated products
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/format.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/update_values.h>
+#include <cusp/detail/matrix_base.h>
+#include <cusp/detail/mutex.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_views Sparse Matrix Views
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p format_cache : a matrix together with the derived formats that
+ *  its products use, each built on first use and kept for later ones.
+ *
+ *  \p multiply with a vector, and the fused products of the solvers, use
+ *  a HYB copy of the matrix, \p multiply_transpose and \p transpose use
+ *  a CSR copy of the transpose (the CSC format of the matrix), and
+ *  \p diagonal returns the main diagonal.  Products with other operands
+ *  use the referenced matrix.  A cache can be given wherever the matrix
+ *  is expected, e.g. to a solver called many times with one matrix, so
+ *  that the conversions are paid once instead of in every call.
+ *
+ *  The cache records where each value of a derived format comes from.
+ *  When the values of the matrix change, \p update_values refreshes the
+ *  formats built so far with one gather each; when its pattern or shape
+ *  changes, \p invalidate discards them.  Neither may run concurrently
+ *  with a product, while products from several host threads may share
+ *  a cache.
+ *
+ *  \tparam MatrixType \p csr_matrix or \p coo_matrix, or a view of one
+ *
+ *  \note The referenced matrix must outlive the cache.
+ *
+ *  \code
+ *  #include <cusp/format_cache.h>
+ *  #include <cusp/krylov/cg.h>
+ *  ...
+ *  cusp::csr_matrix<int,float,cusp::device_memory> A;
+ *  ...
+ *  cusp::format_cache< cusp::csr_matrix<int,float,cusp::device_memory> > cache(A);
+ *
+ *  for (int step = 0; step < num_steps; step++)
+ *  {
+ *      // A is converted to HYB in the first solve only
+ *      cusp::krylov::cg(cache, x, b);
+ *
+ *      // after A.values is modified in place
+ *      cache.update_values();
+ *  }
+ *  \endcode
+ */
+template <typename MatrixType>
+class format_cache
+  : public cusp::detail::matrix_base<typename MatrixType::index_type,
+                                     typename MatrixType::value_type,
+                                     typename MatrixType::memory_space,
+                                     cusp::cached_format>
+{
+  typedef cusp::detail::matrix_base<typename MatrixType::index_type,
+                                    typename MatrixType::value_type,
+                                    typename MatrixType::memory_space,
+                                    cusp::cached_format> Parent;
+  public:
+    typedef typename MatrixType::index_type   IndexType;
+    typedef typename MatrixType::value_type   ValueType;
+    typedef typename MatrixType::memory_space MemorySpace;
+
+    /*! type of the referenced matrix
+     */
+    typedef MatrixType matrix_type;
+
+    typedef cusp::hyb_matrix<IndexType, ValueType, MemorySpace> hyb_matrix_type;
+    typedef cusp::csr_matrix<IndexType, ValueType, MemorySpace> csr_matrix_type;
+    typedef cusp::array1d<ValueType, MemorySpace>               diagonal_type;
+    typedef cusp::value_permutation<IndexType, MemorySpace>     permutation_type;
+
+    /*! The referenced matrix.
+     */
+    const MatrixType& matrix;
+
+    /*! Cache the derived formats of a matrix.  Nothing is built until the
+     *  first product.
+     *
+     *  \param matrix The matrix, which must outlive the cache.
+     */
+    format_cache(const MatrixType& matrix);
+
+    /*! HYB copy of the matrix, used by sparse matrix-vector products.
+     */
+    const hyb_matrix_type& hyb(void) const;
+
+    /*! CSR copy of the transpose of the matrix.
+     */
+    const csr_matrix_type& transpose(void) const;
+
+    /*! Main diagonal of the matrix.
+     */
+    const diagonal_type& diagonal(void) const;
+
+    /*! Refresh the formats built so far after the values of the matrix
+     *  changed in place, keeping its pattern.
+     */
+    void update_values(void);
+
+    /*! Discard the formats built so far, e.g. after the pattern or the
+     *  shape of the matrix changed.
+     */
+    void invalidate(void);
+
+    /*! The derived formats, empty until they are first used.  They are
+     *  filled by the accessors above and should not be modified.
+     */
+    mutable hyb_matrix_type  hyb_matrix;
+    mutable csr_matrix_type  transpose_matrix;
+    mutable diagonal_type    diagonal_values;
+
+  private:
+    mutable permutation_type hyb_permutation;
+    mutable permutation_type transpose_permutation;
+
+    mutable bool has_hyb;
+    mutable bool has_transpose;
+    mutable bool has_diagonal;
+
+    // serializes the threads that build a format at the same time
+    mutable cusp::detail::pool_mutex mutex;
+
+    // not copyable
+    format_cache(const format_cache&);
+    format_cache& operator=(const format_cache&);
+}; // class format_cache
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/format_cache.inl>
@@ -0,0 +1,107 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file galerkin_product.h
+ *  \brief Galerkin triple product R * A * P
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+namespace cusp
+{
+
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p galerkin_product : computes the coarse operator <tt>RAP = R * A * P</tt>
+ *
+ *  The product is formed in slabs of rows of RAP.  For each slab only the
+ *  rows of <tt>A * P</tt> referenced by the slab of R are computed, so the
+ *  intermediate <tt>A * P</tt> is never stored in full.  The number of
+ *  slabs is chosen such that each intermediate holds at most about 16M
+ *  products.
+ *
+ *  CSR inputs are used directly, other formats are converted to CSR.
+ *
+ * \param R restriction operator
+ * \param A fine level operator
+ * \param P prolongation operator
+ * \param RAP coarse level operator
+ *
+ * \tparam Matrix1 sparse matrix
+ * \tparam Matrix2 sparse matrix
+ * \tparam Matrix3 sparse matrix
+ * \tparam Matrix4 sparse matrix
+ *
+ *  \throws cusp::invalid_input_exception if the dimensions do not match.
+ */
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3,
+          typename Matrix4>
+void galerkin_product(const Matrix1& R,
+                      const Matrix2& A,
+                      const Matrix3& P,
+                            Matrix4& RAP);
+
+/*! \p galerkin_product : computes the coarse operator <tt>RAP = P^T * A * P</tt>
+ *
+ *  The restriction operator <tt>P^T</tt> is applied implicitly: each slab
+ *  of rows of <tt>P^T</tt> is formed from the entries of P in the
+ *  corresponding columns, so neither the full transpose nor the full
+ *  intermediate <tt>A * P</tt> is stored.
+ *
+ * \param A fine level operator
+ * \param P prolongation operator
+ * \param RAP coarse level operator
+ *
+ * \tparam Matrix1 sparse matrix
+ * \tparam Matrix2 sparse matrix
+ * \tparam Matrix3 sparse matrix
+ *
+ *  \code
+ *  #include <cusp/galerkin_product.h>
+ *  #include <cusp/csr_matrix.h>
+ *
+ *  ...
+ *
+ *  cusp::csr_matrix<int, float, cusp::device_memory> A, P, RAP;
+ *
+ *  // ... construct A and P
+ *
+ *  cusp::galerkin_product(A, P, RAP);
+ *  \endcode
+ *
+ *  \throws cusp::invalid_input_exception if the dimensions do not match.
+ */
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void galerkin_product(const Matrix1& A,
+                      const Matrix2& P,
+                            Matrix3& RAP);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/galerkin_product.inl>
+
@@ -23,38 +23,220 @@
 #include <cusp/detail/config.h>
 
 #include <cusp/coo_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/random.h>
+
+#include <thrust/adjacent_difference.h>
+#include <thrust/copy.h>
+#include <thrust/extrema.h>
+#include <thrust/for_each.h>
 #include <thrust/unique.h>
+#include <thrust/fill.h>
+#include <thrust/scan.h>
 #include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
 
-#include <stdlib.h> // XXX remove when we switch RNGs
+#include <cmath>
 
 namespace cusp
 {
 namespace gallery
 {
+namespace detail
+{
+
+template <typename IndexType>
+struct random_index_functor
+{
+    unsigned int extent;
+
+    random_index_functor(const unsigned int extent) : extent(extent) {}
+
+    __host__ __device__
+    IndexType operator()(const unsigned int value) const
+    {
+        return value % extent;
+    }
+};
+
+__host__ __device__
+inline unsigned long long random_gcd(unsigned long long a, unsigned long long b)
+{
+    while (b != 0)
+    {
+        const unsigned long long r = a % b;
+        a = b;
+        b = r;
+    }
+
+    return a;
+}
+
+// The permutation t -> (shift + stride * t) mod n of [0,n), n < 2^32,
+// given by 64 random bits.  stride is coprime to n, so the first k values
+// are k distinct integers for any k <= n.
+struct random_permutation
+{
+    unsigned long long n;
+    unsigned long long stride;
+    unsigned long long shift;
+
+    __host__ __device__
+    random_permutation(const unsigned long long n, const unsigned long long bits)
+        : n(n)
+    {
+        shift  = n == 0 ? 0 : (bits >> 32) % n;
+        stride = n <= 1 ? 1 : 1 + (bits & 0xffffffffull) % (n - 1);
+
+        while (random_gcd(stride, n) != 1)
+            stride = stride % (n - 1) + 1;
+    }
+
+    __host__ __device__
+    unsigned long long operator()(const unsigned long long t) const
+    {
+        return (shift + stride * t % n) % n;
+    }
+};
+
+// the column permutation of each row, keyed by the row index
+struct random_row_setup
+{
+    size_t num_cols;
+    cusp::detail::detail::random_integer_functor<size_t,unsigned long long> random;
+    unsigned long long * strides;
+    unsigned long long * shifts;
+
+    random_row_setup(const size_t num_cols, const size_t seed, unsigned long long * strides, unsigned long long * shifts)
+        : num_cols(num_cols), random(seed), strides(strides), shifts(shifts) {}
+
+    __host__ __device__
+    void operator()(const size_t row) const
+    {
+        const random_permutation p(num_cols, random(row));
+
+        strides[row] = p.stride;
+        shifts[row]  = p.shift;
+    }
+};
+
+// column of entry n of a row, the (n - row_offsets[row])-th value of the
+// permutation of the row
+template <typename IndexType>
+struct random_column_functor
+{
+    unsigned long long num_cols;
+    const IndexType * row_offsets;
+    const unsigned long long * strides;
+    const unsigned long long * shifts;
+
+    random_column_functor(const size_t num_cols, const IndexType * row_offsets,
+                          const unsigned long long * strides, const unsigned long long * shifts)
+        : num_cols(num_cols), row_offsets(row_offsets), strides(strides), shifts(shifts) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    IndexType operator()(const Tuple& t) const
+    {
+        const IndexType n   = thrust::get<0>(t);
+        const IndexType row = thrust::get<1>(t);
+        const unsigned long long k = n - row_offsets[row];
+
+        return IndexType((shifts[row] + strides[row] * k % num_cols) % num_cols);
+    }
+};
+
+// weight rank^-exponent of a row, the ranks being a random permutation
+// of the rows so that the long rows are scattered over the matrix
+struct power_law_weight
+{
+    random_permutation rank;
+    double exponent;
+
+    power_law_weight(const size_t num_rows, const double exponent, const size_t seed)
+        : rank(num_rows, cusp::detail::detail::random_integer_functor<size_t,unsigned long long>(seed)(num_rows)),
+          exponent(exponent) {}
+
+    __host__ __device__
+    double operator()(const size_t row) const
+    {
+        return pow(double(rank(row) + 1), -exponent);
+    }
+};
+
+// the number of entries in rows [0,row], rounded from the prefix sum of
+// the weights, so that the last row ends at exactly num_entries
+template <typename IndexType>
+struct power_law_bound
+{
+    size_t num_rows;
+    size_t num_entries;
+    double total;
+
+    power_law_bound(const size_t num_rows, const size_t num_entries, const double total)
+        : num_rows(num_rows), num_entries(num_entries), total(total) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    IndexType operator()(const Tuple& t) const
+    {
+        const size_t row    = thrust::get<0>(t);
+        const double weight = thrust::get<1>(t);
+
+        if (row + 1 == num_rows)
+            return IndexType(num_entries);
+
+        return IndexType(floor(double(num_entries) * (weight / total) + 0.5));
+    }
+};
+
+} // end namespace detail
+
 /*! \addtogroup gallery Matrix Gallery
  *  \ingroup gallery
  *  \{
  */
 
-// TODO use thrust RNGs, add seed parameter defaulting to num_rows ^ num_cols ^ num_samples
-// TODO document
+/*! \p random: Create a matrix with random entries at random positions.
+ *
+ *  \p num_samples positions are drawn uniformly with replacement, so the
+ *  matrix has at most \p num_samples entries.  The entries are equal to
+ *  one.  The matrix is generated in the memory space of \p output and is
+ *  a function of the dimensions and \p seed alone.
+ *
+ * \param num_rows number of rows
+ * \param num_cols number of columns
+ * \param num_samples number of positions to draw
+ * \param output matrix
+ * \param seed seed of the random generator
+ * \tparam MatrixType matrix container
+ */
 template <class MatrixType>
-void random(size_t num_rows, size_t num_cols, size_t num_samples, MatrixType& output)
+void random(size_t num_rows, size_t num_cols, size_t num_samples, MatrixType& output, size_t seed)
 {
-    typedef typename MatrixType::index_type IndexType;
-    typedef typename MatrixType::value_type ValueType;
+    CUSP_PROFILE_SCOPED();
 
-    cusp::coo_matrix<IndexType,ValueType,cusp::host_memory> coo(num_rows, num_cols, num_samples);
+    typedef typename MatrixType::index_type   IndexType;
+    typedef typename MatrixType::value_type   ValueType;
+    typedef typename MatrixType::memory_space MemorySpace;
 
-    srand(num_rows ^ num_cols ^ num_samples);
+    if (num_rows == 0 || num_cols == 0)
+        num_samples = 0;
 
-    for(size_t n = 0; n < num_samples; n++)
-    {
-        coo.row_indices[n]    = rand() % num_rows;
-        coo.column_indices[n] = rand() % num_cols;
-        coo.values[n]         = ValueType(1);
-    }
+    // the coordinates are generated, sorted and merged in the memory
+    // space of the output
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> coo(num_rows, num_cols, num_samples);
+
+    cusp::detail::random_integers<unsigned int> random(2 * num_samples, seed);
+
+    thrust::transform(random.begin(), random.begin() + num_samples, coo.row_indices.begin(),
+                      detail::random_index_functor<IndexType>(num_rows));
+    thrust::transform(random.begin() + num_samples, random.end(), coo.column_indices.begin(),
+                      detail::random_index_functor<IndexType>(num_cols));
+    thrust::fill(coo.values.begin(), coo.values.end(), ValueType(1));
 
     // sort indices by (row,column)
     coo.sort_by_row_and_column();
@@ -67,6 +249,141 @@ void random(size_t num_rows, size_t num_cols, size_t num_samples, MatrixType& ou
     
     output = coo;
 }
+
+/*! \p random with the seed <tt>num_rows ^ num_cols ^ num_samples</tt>
+ */
+template <class MatrixType>
+void random(size_t num_rows, size_t num_cols, size_t num_samples, MatrixType& output)
+{
+    cusp::gallery::random(num_rows, num_cols, num_samples, output, num_rows ^ num_cols ^ num_samples);
+}
+
+/*! \p random_rows: Create a random matrix with prescribed row lengths.
+ *
+ *  Row \c i of the matrix has exactly <tt>row_lengths[i]</tt> entries at
+ *  distinct columns, the columns of each row being the first values of a
+ *  random affine permutation of <tt>[0, num_cols)</tt>.  The entries are
+ *  equal to one.  Every entry is generated independently in the memory
+ *  space of \p output, hence large matrices are generated quickly on the
+ *  device.
+ *
+ * \param row_lengths number of entries of each row
+ * \param num_cols number of columns, less than 2^32
+ * \param output matrix
+ * \param seed seed of the random generator
+ * \tparam ArrayType array of integers
+ * \tparam MatrixType matrix container
+ *
+ * \throws cusp::invalid_input_exception if a row is longer than \p num_cols.
+ */
+template <class ArrayType, class MatrixType>
+void random_rows(const ArrayType& row_lengths, size_t num_cols, MatrixType& output, size_t seed = 0)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename MatrixType::index_type   IndexType;
+    typedef typename MatrixType::value_type   ValueType;
+    typedef typename MatrixType::memory_space MemorySpace;
+
+    const size_t num_rows = row_lengths.size();
+
+    if (num_rows == 0)
+    {
+        output = cusp::coo_matrix<IndexType,ValueType,MemorySpace>(0, num_cols, 0);
+        return;
+    }
+
+    cusp::array1d<IndexType,MemorySpace> row_offsets(num_rows + 1, IndexType(0));
+    thrust::copy(row_lengths.begin(), row_lengths.end(), row_offsets.begin() + 1);
+
+    if (size_t(*thrust::max_element(row_offsets.begin(), row_offsets.end())) > num_cols)
+        throw cusp::invalid_input_exception("row length exceeds the number of columns");
+
+    thrust::inclusive_scan(row_offsets.begin(), row_offsets.end(), row_offsets.begin());
+
+    const size_t num_entries = row_offsets[num_rows];
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> coo(num_rows, num_cols, num_entries);
+
+    cusp::detail::offsets_to_indices(row_offsets, coo.row_indices);
+
+    // a permutation of the columns per row
+    cusp::array1d<unsigned long long,MemorySpace> strides(num_rows);
+    cusp::array1d<unsigned long long,MemorySpace> shifts(num_rows);
+
+    thrust::for_each(thrust::counting_iterator<size_t>(0), thrust::counting_iterator<size_t>(num_rows),
+                     detail::random_row_setup(num_cols, seed,
+                                              thrust::raw_pointer_cast(&strides[0]),
+                                              thrust::raw_pointer_cast(&shifts[0])));
+
+    thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), coo.row_indices.begin())),
+                      thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(num_entries), coo.row_indices.end())),
+                      coo.column_indices.begin(),
+                      detail::random_column_functor<IndexType>(num_cols,
+                                                               thrust::raw_pointer_cast(&row_offsets[0]),
+                                                               thrust::raw_pointer_cast(&strides[0]),
+                                                               thrust::raw_pointer_cast(&shifts[0])));
+    thrust::fill(coo.values.begin(), coo.values.end(), ValueType(1));
+
+    coo.sort_by_row_and_column();
+
+    output = coo;
+}
+
+/*! \p random_power_law: Create a random matrix whose row lengths follow
+ *  a power law.
+ *
+ *  The rows are ranked in random order and row \c i of rank \c r gets a
+ *  share <tt>r^-exponent</tt> of exactly \p num_entries entries, so that
+ *  an exponent of 0 yields rows of (almost) equal length and larger
+ *  exponents concentrate the entries in a few long rows, as in web and
+ *  social network graphs.  The matrix is then generated by \p random_rows.
+ *
+ * \param num_rows number of rows
+ * \param num_cols number of columns
+ * \param num_entries number of entries
+ * \param exponent exponent of the power law, at least 0
+ * \param output matrix
+ * \param seed seed of the random generator
+ * \tparam MatrixType matrix container
+ *
+ * \throws cusp::invalid_input_exception if a row would be longer than
+ *  \p num_cols, e.g. for a large exponent.
+ */
+template <class MatrixType>
+void random_power_law(size_t num_rows, size_t num_cols, size_t num_entries, double exponent, MatrixType& output, size_t seed = 0)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename MatrixType::index_type   IndexType;
+    typedef typename MatrixType::memory_space MemorySpace;
+
+    if (exponent < 0)
+        throw cusp::invalid_input_exception("power law exponent must be nonnegative");
+
+    if (num_entries > num_rows * num_cols)
+        throw cusp::invalid_input_exception("number of entries exceeds the size of the matrix");
+
+    cusp::array1d<IndexType,MemorySpace> row_lengths(num_rows);
+
+    if (num_rows > 0)
+    {
+        cusp::array1d<double,MemorySpace> weights(num_rows);
+
+        thrust::transform(thrust::counting_iterator<size_t>(0), thrust::counting_iterator<size_t>(num_rows),
+                          weights.begin(), detail::power_law_weight(num_rows, exponent, seed));
+        thrust::inclusive_scan(weights.begin(), weights.end(), weights.begin());
+
+        const double total = weights[num_rows - 1];
+
+        thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<size_t>(0), weights.begin())),
+                          thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<size_t>(num_rows), weights.end())),
+                          row_lengths.begin(), detail::power_law_bound<IndexType>(num_rows, num_entries, total));
+        thrust::adjacent_difference(row_lengths.begin(), row_lengths.end(), row_lengths.begin());
+    }
+
+    cusp::gallery::random_rows(row_lengths, num_cols, output, seed);
+}
 /*! \}
  */
 
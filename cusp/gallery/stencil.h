@@ -23,6 +23,7 @@
 #include <cusp/detail/config.h>
 
 #include <cusp/array1d.h>
+#include <cusp/gallery/stencil_operator.h>
 
 namespace cusp
 {
@@ -15,6 +15,7 @@
  */
 
 #include <cusp/copy.h>
+#include <cusp/csr_matrix.h>
 #include <cusp/dia_matrix.h>
 
 #include <thrust/tuple.h>
@@ -22,6 +23,10 @@
 #include <thrust/scan.h>
 #include <thrust/count.h>
 #include <thrust/functional.h>
+#include <thrust/for_each.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
 
 namespace cusp
 {
@@ -133,6 +138,112 @@ struct fill_diagonal_entries
     }
 };
 
+// number of entries of a row of the stencil matrix
+template <typename IndexType, typename ValueType>
+struct stencil_row_length
+{
+    stencil_coefficients<ValueType> stencil;
+
+    stencil_row_length(const stencil_coefficients<ValueType>& stencil)
+        : stencil(stencil) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType row) const
+    {
+        IndexType length = 0;
+
+        for (int p = 0; p < stencil.num_points; p++)
+        {
+            IndexType column;
+
+            if (stencil.neighbor(row, p, column))
+                length++;
+        }
+
+        return length;
+    }
+};
+
+// write the entries of a row, given the row and its offset
+template <typename IndexType, typename ValueType>
+struct stencil_fill_row
+{
+    stencil_coefficients<ValueType> stencil;
+    IndexType * column_indices;
+    ValueType * values;
+
+    stencil_fill_row(const stencil_coefficients<ValueType>& stencil, IndexType * column_indices, ValueType * values)
+        : stencil(stencil), column_indices(column_indices), values(values) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(const Tuple& t) const
+    {
+        const IndexType row = thrust::get<0>(t);
+        IndexType offset    = thrust::get<1>(t);
+
+        for (int p = 0; p < stencil.num_points; p++)
+        {
+            IndexType column;
+
+            if (stencil.neighbor(row, p, column))
+            {
+                column_indices[offset] = column;
+                values[offset]         = stencil.values[p];
+                offset++;
+            }
+        }
+    }
+};
+
+// drop the points with zero values and order the rest by their offset,
+// so that the columns of every row are sorted
+template <typename ValueType>
+long stencil_point_offset(const stencil_coefficients<ValueType>& stencil, const int p)
+{
+    return stencil.offsets[p][0] + long(stencil.grid[0]) * (stencil.offsets[p][1] + long(stencil.grid[1]) * stencil.offsets[p][2]);
+}
+
+template <typename ValueType>
+void sort_stencil_points(stencil_coefficients<ValueType>& stencil)
+{
+    int num_points = 0;
+
+    for (int p = 0; p < stencil.num_points; p++)
+    {
+        if (stencil.values[p] == ValueType(0))
+            continue;
+
+        for (int d = 0; d < 3; d++)
+            stencil.offsets[num_points][d] = stencil.offsets[p][d];
+        stencil.values[num_points] = stencil.values[p];
+        num_points++;
+    }
+
+    stencil.num_points = num_points;
+
+    // insertion sort, stencils are small
+    for (int p = 1; p < num_points; p++)
+    {
+        const int       point[3] = { stencil.offsets[p][0], stencil.offsets[p][1], stencil.offsets[p][2] };
+        const ValueType value    = stencil.values[p];
+        const long      offset   = stencil_point_offset(stencil, p);
+
+        int q = p;
+
+        for (; q > 0 && stencil_point_offset(stencil, q - 1) > offset; q--)
+        {
+            for (int d = 0; d < 3; d++)
+                stencil.offsets[q][d] = stencil.offsets[q - 1][d];
+            stencil.values[q] = stencil.values[q - 1];
+        }
+
+        for (int d = 0; d < 3; d++)
+            stencil.offsets[q][d] = point[d];
+        stencil.values[q] = value;
+    }
+}
+
 } // end namespace detail
 
 template <typename IndexType,
@@ -185,7 +296,56 @@ void generate_matrix_from_stencil(      cusp::dia_matrix<IndexType,ValueType,Mem
     matrix.num_entries = matrix.values.values.size() - thrust::count(matrix.values.values.begin(), matrix.values.values.end(), ValueType(0));
 }
 
-// TODO add an entry point and make this the default path
+// The rows are independent, so the CSR matrix is written directly in its
+// memory space: one pass counts the entries of each row, a scan turns the
+// counts into row offsets and a second pass fills the rows in column order.
+template <typename IndexType,
+          typename ValueType,
+          typename MemorySpace,
+          typename StencilPoint,
+          typename GridDimension>
+void generate_matrix_from_stencil(      cusp::csr_matrix<IndexType,ValueType,MemorySpace>& matrix,
+                                  const cusp::array1d<StencilPoint,cusp::host_memory>& stencil,
+                                  const GridDimension& grid)
+{
+    CUSP_PROFILE_SCOPED();
+
+    detail::stencil_coefficients<ValueType> coefficients;
+
+    if (!detail::make_stencil_coefficients(stencil, grid, coefficients))
+    {
+        // too many points to pass by value
+        cusp::dia_matrix<IndexType,ValueType,MemorySpace> dia;
+        generate_matrix_from_stencil(dia, stencil, grid);
+        cusp::convert(dia, matrix);
+        return;
+    }
+
+    detail::sort_stencil_points(coefficients);
+
+    const IndexType num_rows = IndexType(coefficients.grid[0]) * coefficients.grid[1] * coefficients.grid[2];
+
+    matrix.resize(num_rows, num_rows, detail::stencil_num_entries(coefficients));
+
+    thrust::transform(thrust::counting_iterator<IndexType>(0),
+                      thrust::counting_iterator<IndexType>(num_rows),
+                      matrix.row_offsets.begin(),
+                      detail::stencil_row_length<IndexType,ValueType>(coefficients));
+    matrix.row_offsets[num_rows] = 0;
+
+    thrust::exclusive_scan(matrix.row_offsets.begin(), matrix.row_offsets.end(), matrix.row_offsets.begin());
+
+    if (matrix.num_entries == 0)
+        return;
+
+    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), matrix.row_offsets.begin())),
+                     thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(num_rows), matrix.row_offsets.end() - 1)),
+                     detail::stencil_fill_row<IndexType,ValueType>(coefficients,
+                                                                   thrust::raw_pointer_cast(&matrix.column_indices[0]),
+                                                                   thrust::raw_pointer_cast(&matrix.values[0])));
+}
+
+
 template <typename MatrixType,
           typename StencilPoint,
           typename GridDimension>
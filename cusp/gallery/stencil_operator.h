@@ -0,0 +1,181 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file stencil_operator.h
+ *  \brief Matrix-free operator of a grid stencil
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/linear_operator.h>
+
+namespace cusp
+{
+namespace gallery
+{
+namespace detail
+{
+
+// Stencil of up to MAX_POINTS points on a grid of up to three dimensions,
+// passed by value to the kernels.  Dimension 0 is contiguous and unused
+// dimensions have extent 1.
+template <typename ValueType>
+struct stencil_coefficients
+{
+    enum { MAX_POINTS = 32 };
+
+    int       num_points;
+    int       grid[3];
+    int       radius[3];                     // largest offset in each dimension
+    int       offsets[MAX_POINTS][3];
+    ValueType values[MAX_POINTS];
+
+    // column of point p in row, false when it lies outside of the grid
+    template <typename IndexType>
+    __host__ __device__
+    bool neighbor(const IndexType row, const int p, IndexType& column) const
+    {
+        const int i = row % grid[0] + offsets[p][0];
+        const int j = (row / grid[0]) % grid[1] + offsets[p][1];
+        const int k = row / grid[0] / grid[1] + offsets[p][2];
+
+        column = i + IndexType(grid[0]) * (j + IndexType(grid[1]) * k);
+
+        return i >= 0 && i < grid[0] && j >= 0 && j < grid[1] && k >= 0 && k < grid[2];
+    }
+
+    // row of the operator times x, points outside of the grid are skipped
+    template <typename IndexType>
+    __host__ __device__
+    ValueType row_product(const IndexType row, const ValueType * x) const
+    {
+        ValueType sum = 0;
+
+        for (int p = 0; p < num_points; p++)
+        {
+            IndexType column;
+
+            if (neighbor(row, p, column))
+                sum += values[p] * x[column];
+        }
+
+        return sum;
+    }
+};
+
+} // end namespace detail
+
+/*! \addtogroup gallery Matrix Gallery
+ *  \ingroup gallery
+ *  \{
+ */
+
+/*! \p stencil_operator : matrix-free operator of a stencil on a regular
+ *  grid of one, two or three dimensions.
+ *
+ *  The operator is the matrix that \p generate_matrix_from_stencil builds
+ *  from the same stencil and grid, but it stores only the stencil: the
+ *  product reads x and writes y and nothing else.  On the device a block
+ *  of threads loads a tile of x and its halo into shared memory once and
+ *  computes all stencil points of the tile from it.
+ *
+ *  The gallery generators also build a \p stencil_operator, e.g.
+ *  <tt>cusp::gallery::poisson5pt(A, m, n)</tt> for a \p stencil_operator
+ *  \c A, and it may be passed wherever a \p linear_operator is accepted.
+ *
+ *  \tparam ValueType Type used for the stencil values (e.g. \c float or \c double).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *  \tparam IndexType Type used for row indices (e.g. \c int).
+ *
+ *  \code
+ *  #include <cusp/gallery/poisson.h>
+ *  #include <cusp/gallery/stencil_operator.h>
+ *  #include <cusp/krylov/cg.h>
+ *  ...
+ *
+ *  cusp::gallery::stencil_operator<float, cusp::device_memory> A;
+ *  cusp::gallery::poisson7pt(A, 256, 256, 256);
+ *
+ *  cusp::array1d<float, cusp::device_memory> x(A.num_rows, 0);
+ *  cusp::array1d<float, cusp::device_memory> b(A.num_rows, 1);
+ *
+ *  cusp::default_monitor<float> monitor(b, 1000, 1e-6);
+ *  cusp::krylov::cg(A, x, b, monitor);
+ *  \endcode
+ */
+template <typename ValueType, typename MemorySpace, typename IndexType = int>
+class stencil_operator : public cusp::linear_operator<ValueType, MemorySpace, IndexType>
+{
+    typedef cusp::linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+    detail::stencil_coefficients<ValueType> stencil;
+
+public:
+    /*! construct an empty \p stencil_operator
+     */
+    stencil_operator(void);
+
+    /*! construct a \p stencil_operator from a stencil and a grid
+     *
+     * \param stencil stencil points, each a tuple of an offset tuple and a value
+     * \param grid extent of the grid in each dimension
+     * \tparam StencilPoint \c thrust::tuple of an index tuple and a value
+     * \tparam GridDimension \c thrust::tuple of one to three extents
+     *
+     *  \throws cusp::invalid_input_exception if the stencil has more than
+     *  32 points.
+     */
+    template <typename StencilPoint, typename GridDimension>
+    stencil_operator(const cusp::array1d<StencilPoint, cusp::host_memory>& stencil,
+                     const GridDimension& grid);
+
+    /*! number of points of the stencil
+     */
+    size_t num_points(void) const { return stencil.num_points; }
+
+    /*! apply the operator to vector \p x and store the result in \p y
+     *
+     * \param x input vector
+     * \param y ouput vector
+     * \tparam VectorType1 vector
+     * \tparam VectorType2 vector
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+};
+
+/*! \p generate_matrix_from_stencil : builds a \p stencil_operator, which
+ *  makes the gallery generators available for matrix-free operators.
+ */
+template <typename ValueType,
+          typename MemorySpace,
+          typename IndexType,
+          typename StencilPoint,
+          typename GridDimension>
+void generate_matrix_from_stencil(      cusp::gallery::stencil_operator<ValueType,MemorySpace,IndexType>& matrix,
+                                  const cusp::array1d<StencilPoint,cusp::host_memory>& stencil,
+                                  const GridDimension& grid);
+/*! \}
+ */
+
+} // end namespace gallery
+} // end namespace cusp
+
+#include <cusp/gallery/stencil_operator.inl>
@@ -0,0 +1,216 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/exception.h>
+#include <cusp/detail/device/spmv/stencil.h>
+
+#include <thrust/for_each.h>
+#include <thrust/tuple.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+namespace cusp
+{
+namespace gallery
+{
+namespace detail
+{
+
+// copy the components of a tuple of up to three integers
+template <typename Tuple, int i, int size>
+struct unpack_extents_helper
+{
+    static void unpack(const Tuple& t, int * output)
+    {
+        output[i] = thrust::get<i>(t);
+        unpack_extents_helper<Tuple, i + 1, size>::unpack(t, output);
+    }
+};
+
+template <typename Tuple, int size>
+struct unpack_extents_helper<Tuple, size, size>
+{
+    static void unpack(const Tuple& t, int * output) {}
+};
+
+template <typename Tuple>
+void unpack_extents(const Tuple& t, int * output)
+{
+    unpack_extents_helper<Tuple, 0, thrust::tuple_size<Tuple>::value>::unpack(t, output);
+}
+
+template <typename IndexType, typename ValueType>
+struct stencil_multiply_functor
+{
+    stencil_coefficients<ValueType> stencil;
+    const ValueType * x;
+          ValueType * y;
+
+    stencil_multiply_functor(const stencil_coefficients<ValueType>& stencil, const ValueType * x, ValueType * y)
+        : stencil(stencil), x(x), y(y) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(const Tuple& t) const
+    {
+        const IndexType row = thrust::get<0>(t);
+        y[row] = stencil.row_product(row, x);
+    }
+};
+
+template <typename IndexType, typename ValueType, typename VectorType1, typename VectorType2>
+void stencil_multiply(const stencil_coefficients<ValueType>& stencil, const VectorType1& x, VectorType2& y, cusp::host_memory)
+{
+    const IndexType num_rows = y.size();
+
+    thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), y.begin())),
+                     thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(num_rows), y.end())),
+                     stencil_multiply_functor<IndexType,ValueType>(stencil, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0])));
+}
+
+template <typename IndexType, typename ValueType, typename VectorType1, typename VectorType2>
+void stencil_multiply(const stencil_coefficients<ValueType>& stencil, const VectorType1& x, VectorType2& y, cusp::device_memory)
+{
+    cusp::detail::device::spmv_stencil<IndexType>(stencil, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]));
+}
+
+// the stencil and grid as stencil_coefficients, false when the stencil
+// has too many points
+template <typename StencilPoint, typename GridDimension, typename ValueType>
+bool make_stencil_coefficients(const cusp::array1d<StencilPoint, cusp::host_memory>& points,
+                               const GridDimension& grid,
+                               stencil_coefficients<ValueType>& stencil)
+{
+    if (points.size() > size_t(stencil_coefficients<ValueType>::MAX_POINTS))
+        return false;
+
+    stencil.num_points = points.size();
+
+    for (int d = 0; d < 3; d++)
+    {
+        stencil.grid[d]   = 1;
+        stencil.radius[d] = 0;
+    }
+
+    unpack_extents(grid, stencil.grid);
+
+    for (int p = 0; p < stencil.num_points; p++)
+    {
+        const StencilPoint point = points[p];
+
+        stencil.offsets[p][0] = stencil.offsets[p][1] = stencil.offsets[p][2] = 0;
+        unpack_extents(thrust::get<0>(point), stencil.offsets[p]);
+        stencil.values[p] = thrust::get<1>(point);
+
+        for (int d = 0; d < 3; d++)
+        {
+            const int r = stencil.offsets[p][d] < 0 ? -stencil.offsets[p][d] : stencil.offsets[p][d];
+            stencil.radius[d] = r > stencil.radius[d] ? r : stencil.radius[d];
+        }
+    }
+
+    return true;
+}
+
+// number of nonzero entries of the matrix of the stencil
+template <typename ValueType>
+size_t stencil_num_entries(const stencil_coefficients<ValueType>& stencil)
+{
+    size_t num_entries = 0;
+
+    for (int p = 0; p < stencil.num_points; p++)
+    {
+        size_t n = stencil.values[p] == ValueType(0) ? 0 : 1;
+
+        // rows whose point p stays inside of the grid
+        for (int d = 0; d < 3; d++)
+        {
+            const int r = stencil.offsets[p][d] < 0 ? -stencil.offsets[p][d] : stencil.offsets[p][d];
+            n *= stencil.grid[d] > r ? stencil.grid[d] - r : 0;
+        }
+
+        num_entries += n;
+    }
+
+    return num_entries;
+}
+
+} // end namespace detail
+
+
+// constructors
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    stencil_operator<ValueType,MemorySpace,IndexType>
+    ::stencil_operator(void)
+        : Parent()
+    {
+        stencil.num_points = 0;
+
+        for (int d = 0; d < 3; d++)
+        {
+            stencil.grid[d]   = d == 0 ? 0 : 1;
+            stencil.radius[d] = 0;
+        }
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template <typename StencilPoint, typename GridDimension>
+    stencil_operator<ValueType,MemorySpace,IndexType>
+    ::stencil_operator(const cusp::array1d<StencilPoint, cusp::host_memory>& points,
+                       const GridDimension& grid)
+        : Parent()
+    {
+        if (!detail::make_stencil_coefficients(points, grid, stencil))
+            throw cusp::invalid_input_exception("stencil_operator supports stencils of up to 32 points");
+
+        const size_t num_rows = size_t(stencil.grid[0]) * stencil.grid[1] * stencil.grid[2];
+
+        Parent::resize(num_rows, num_rows, detail::stencil_num_entries(stencil));
+    }
+
+// linear operator
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template <typename VectorType1, typename VectorType2>
+    void stencil_operator<ValueType,MemorySpace,IndexType>
+    ::operator()(const VectorType1& x, VectorType2& y) const
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (x.size() != Parent::num_cols || y.size() != Parent::num_rows)
+            throw cusp::invalid_input_exception("array dimensions do not match the stencil_operator");
+
+        if (Parent::num_rows == 0)
+            return;
+
+        detail::stencil_multiply<IndexType>(stencil, x, y, MemorySpace());
+    }
+
+template <typename ValueType,
+          typename MemorySpace,
+          typename IndexType,
+          typename StencilPoint,
+          typename GridDimension>
+void generate_matrix_from_stencil(      cusp::gallery::stencil_operator<ValueType,MemorySpace,IndexType>& matrix,
+                                  const cusp::array1d<StencilPoint,cusp::host_memory>& stencil,
+                                  const GridDimension& grid)
+{
+    matrix = cusp::gallery::stencil_operator<ValueType,MemorySpace,IndexType>(stencil, grid);
+}
+
+} // end namespace gallery
+} // end namespace cusp
+
@@ -0,0 +1,88 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file breadth_first_search.h
+ *  \brief Breadth-first search of a graph
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace graph
+{
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p breadth_first_search : computes the distance of every vertex of a
+ * graph from a source vertex.  The search is level-synchronous and
+ * direction-optimizing: small frontiers are expanded top-down along the
+ * edges of their vertices, while large frontiers are found bottom-up, by
+ * the unvisited vertices that have a neighbor in the frontier (Beamer,
+ * Asanovic and Patterson).  Both steps run in the memory space of the
+ * matrix.
+ *
+ * The search is represented by an array of levels.  Specifically,
+ * <tt>labels[i]</tt> is the number of edges of a shortest path from
+ * \p src to vertex \p i, or -1 if \p i is unreachable from \p src.
+ *
+ * \param G symmetric matrix that represents a graph
+ * \param src source vertex
+ * \param labels array to hold the levels
+ * \return the number of levels
+ *
+ * \tparam Matrix matrix
+ * \tparam Array array of a signed integer type
+ *
+ * \code
+ * #include <cusp/csr_matrix.h>
+ * #include <cusp/gallery/poisson.h>
+ * #include <cusp/graph/breadth_first_search.h>
+ *
+ * int main(void)
+ * {
+ *     cusp::csr_matrix<int, float, cusp::device_memory> G;
+ *     cusp::gallery::poisson5pt(G, 100, 100);
+ *
+ *     // distances from the corner of the grid
+ *     cusp::array1d<int, cusp::device_memory> labels;
+ *     size_t num_levels = cusp::graph::breadth_first_search(G, 0, labels);
+ *
+ *     return 0;
+ * }
+ * \endcode
+ *
+ *  \see http://en.wikipedia.org/wiki/Breadth-first_search
+ *  \see \p connected_components
+ */
+template <typename Matrix, typename Array>
+size_t breadth_first_search(const Matrix& G, const size_t src, Array& labels);
+
+/*! \}
+ */
+
+
+} // end namespace graph
+} // end namespace cusp
+
+#include <cusp/graph/detail/breadth_first_search.inl>
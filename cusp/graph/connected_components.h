@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file connected_components.h
+ *  \brief Connected components of a graph
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace graph
+{
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p connected_components : computes the connected components of a
+ * graph.  Every vertex starts as a tree of its own; trees are hooked onto
+ * the trees of smaller roots along the edges between them and flattened
+ * by pointer jumping until no edge joins two trees (Shiloach and Vishkin).
+ * Each step processes all vertices in parallel in the memory space of the
+ * matrix.
+ *
+ * The components are represented by an array of component indices in
+ * [0, num_components).  Specifically, <tt>components[i]</tt> is the
+ * component of vertex \p i, and the components are numbered in order of
+ * their smallest vertex.
+ *
+ * \param G symmetric matrix that represents a graph
+ * \param components array to hold the components
+ * \return the number of components
+ *
+ * \tparam Matrix matrix
+ * \tparam Array array
+ *
+ *  \see http://en.wikipedia.org/wiki/Connected_component_(graph_theory)
+ *  \see \p breadth_first_search
+ */
+template <typename Matrix, typename Array>
+size_t connected_components(const Matrix& G, Array& components);
+
+/*! \}
+ */
+
+
+} // end namespace graph
+} // end namespace cusp
+
+#include <cusp/graph/detail/connected_components.inl>
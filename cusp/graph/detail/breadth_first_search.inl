@@ -0,0 +1,241 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/spmspv.h>
+
+#include <thrust/copy.h>
+#include <thrust/fill.h>
+#include <thrust/functional.h>
+#include <thrust/gather.h>
+#include <thrust/scan.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/unique.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+
+namespace cusp
+{
+namespace graph
+{
+namespace detail
+{
+
+// Beamer's thresholds: go bottom-up when the frontier has more than
+// 1/BFS_ALPHA of the unexplored edges, go back top-down when it has
+// fewer than 1/BFS_BETA of the vertices
+const size_t BFS_ALPHA = 14;
+const size_t BFS_BETA  = 24;
+
+template <typename IndexType>
+struct vertex_degree
+{
+    const IndexType * row_offsets;
+
+    vertex_degree(const IndexType * row_offsets) : row_offsets(row_offsets) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType v) const
+    {
+        return row_offsets[v + 1] - row_offsets[v];
+    }
+};
+
+template <typename IndexType>
+struct is_unvisited
+{
+    __host__ __device__
+    bool operator()(const IndexType label) const
+    {
+        return label == -1;
+    }
+};
+
+// an unvisited vertex joins the next level at its first neighbor in the
+// frontier, other vertices read but never match the labels it writes
+template <typename IndexType>
+struct bottom_up_step
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    IndexType * labels;
+    IndexType level;
+
+    bottom_up_step(const IndexType * row_offsets, const IndexType * column_indices, IndexType * labels, const IndexType level)
+        : row_offsets(row_offsets), column_indices(column_indices), labels(labels), level(level) {}
+
+    __host__ __device__
+    bool operator()(const IndexType v) const
+    {
+        if (labels[v] != -1)
+            return false;
+
+        for (IndexType jj = row_offsets[v]; jj < row_offsets[v + 1]; jj++)
+        {
+            if (labels[column_indices[jj]] == level)
+            {
+                labels[v] = level + 1;
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+// next frontier from the unvisited neighbors of the frontier, whose
+// vertices have frontier_edges edges
+template <typename Matrix, typename Array>
+void top_down_step(const Matrix& G, Array& labels, Array& frontier, const typename Array::value_type level,
+                   const size_t frontier_edges)
+{
+    typedef typename Array::value_type   IndexType;
+    typedef typename Array::memory_space MemorySpace;
+
+    const size_t E = frontier_edges;
+
+    cusp::array1d<IndexType,MemorySpace> owners;
+    cusp::array1d<IndexType,MemorySpace> edges;
+    cusp::detail::spmspv_expand(G, frontier, E, owners, edges);
+
+    cusp::array1d<IndexType,MemorySpace> neighbors(E);
+    thrust::gather(edges.begin(), edges.end(), G.column_indices.begin(), neighbors.begin());
+
+    // the distinct unvisited neighbors
+    frontier.resize(E);
+    frontier.erase(thrust::copy_if(neighbors.begin(), neighbors.end(),
+                                   thrust::make_permutation_iterator(labels.begin(), neighbors.begin()),
+                                   frontier.begin(), is_unvisited<IndexType>()),
+                   frontier.end());
+
+    thrust::sort(frontier.begin(), frontier.end());
+    frontier.erase(thrust::unique(frontier.begin(), frontier.end()), frontier.end());
+
+    thrust::fill(thrust::make_permutation_iterator(labels.begin(), frontier.begin()),
+                 thrust::make_permutation_iterator(labels.begin(), frontier.end()),
+                 level + 1);
+}
+
+template <typename Matrix, typename Array>
+size_t breadth_first_search(const Matrix& G, const size_t src, Array& labels,
+                            cusp::csr_format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    const size_t N = G.num_rows;
+
+    cusp::array1d<IndexType,MemorySpace> levels(N, IndexType(-1));
+    cusp::array1d<IndexType,MemorySpace> frontier(1, IndexType(src));
+    cusp::array1d<bool,MemorySpace>      joined;
+
+    levels[src] = 0;
+
+    if (G.num_entries == 0)
+    {
+        labels.resize(N);
+        thrust::copy(levels.begin(), levels.end(), labels.begin());
+        return 1;
+    }
+
+    const vertex_degree<IndexType> degree(thrust::raw_pointer_cast(&G.row_offsets[0]));
+
+    size_t unexplored_edges = G.num_entries;
+    bool bottom_up = false;
+
+    IndexType level = 0;
+
+    for (; !frontier.empty(); level++)
+    {
+        const size_t frontier_edges = thrust::transform_reduce(frontier.begin(), frontier.end(), degree, IndexType(0), thrust::plus<IndexType>());
+
+        if (!bottom_up && frontier_edges > unexplored_edges / BFS_ALPHA)
+            bottom_up = true;
+        else if (bottom_up && frontier.size() < N / BFS_BETA)
+            bottom_up = false;
+
+        unexplored_edges -= frontier_edges;
+
+        if (bottom_up)
+        {
+            joined.resize(N);
+            thrust::transform(thrust::counting_iterator<IndexType>(0),
+                              thrust::counting_iterator<IndexType>(N),
+                              joined.begin(),
+                              bottom_up_step<IndexType>(thrust::raw_pointer_cast(&G.row_offsets[0]),
+                                                        thrust::raw_pointer_cast(&G.column_indices[0]),
+                                                        thrust::raw_pointer_cast(&levels[0]), level));
+
+            frontier.resize(N);
+            frontier.erase(thrust::copy_if(thrust::counting_iterator<IndexType>(0),
+                                           thrust::counting_iterator<IndexType>(N),
+                                           joined.begin(), frontier.begin(), thrust::identity<bool>()),
+                           frontier.end());
+        }
+        else
+        {
+            top_down_step(G, levels, frontier, level, frontier_edges);
+        }
+    }
+
+    labels.resize(N);
+    thrust::copy(levels.begin(), levels.end(), labels.begin());
+
+    return level;
+}
+
+template <typename Matrix, typename Array, typename Format>
+size_t breadth_first_search(const Matrix& G, const size_t src, Array& labels,
+                            Format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> G_csr(G);
+
+    return cusp::graph::detail::breadth_first_search(G_csr, src, labels, cusp::csr_format());
+}
+
+} // end namespace detail
+
+/////////////////
+// Entry Point //
+/////////////////
+
+template <typename Matrix, typename Array>
+size_t breadth_first_search(const Matrix& G, const size_t src, Array& labels)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if(G.num_rows != G.num_cols)
+        throw cusp::invalid_input_exception("matrix must be square");
+
+    if(src >= G.num_rows)
+        throw cusp::invalid_input_exception("source vertex is out of range");
+
+    return cusp::graph::detail::breadth_first_search(G, src, labels, typename Matrix::format());
+}
+
+} // end namespace graph
+} // end namespace cusp
+
@@ -0,0 +1,218 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/gather.h>
+#include <thrust/scan.h>
+#include <thrust/sequence.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/iterator/counting_iterator.h>
+
+namespace cusp
+{
+namespace graph
+{
+namespace detail
+{
+
+// Hook the tree of each vertex onto the smallest root of its neighbors.
+// Concurrent hooks of a root may overwrite each other, but every hook
+// points a root to a smaller vertex, so the parents remain a forest and
+// a lost hook is retried in the next pass.
+template <typename IndexType>
+struct hook_trees
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    IndexType * parents;
+
+    hook_trees(const IndexType * row_offsets, const IndexType * column_indices, IndexType * parents)
+        : row_offsets(row_offsets), column_indices(column_indices), parents(parents) {}
+
+    __host__ __device__
+    void operator()(const IndexType v) const
+    {
+        const IndexType root = parents[v];
+
+        IndexType smallest = root;
+
+        for (IndexType jj = row_offsets[v]; jj < row_offsets[v + 1]; jj++)
+        {
+            const IndexType r = parents[column_indices[jj]];
+
+            if (r < smallest)
+                smallest = r;
+        }
+
+        if (smallest < root && smallest < parents[root])
+            parents[root] = smallest;
+    }
+};
+
+// replace the parent of a vertex with its grandparent, false at a root
+// or a child of a root
+template <typename IndexType>
+struct jump_pointers
+{
+    IndexType * parents;
+
+    jump_pointers(IndexType * parents) : parents(parents) {}
+
+    __host__ __device__
+    bool operator()(const IndexType v) const
+    {
+        const IndexType parent      = parents[v];
+        const IndexType grandparent = parents[parent];
+
+        if (parent == grandparent)
+            return false;
+
+        parents[v] = grandparent;
+
+        return true;
+    }
+};
+
+// whether an edge of a vertex joins two trees
+template <typename IndexType>
+struct joins_trees
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const IndexType * parents;
+
+    joins_trees(const IndexType * row_offsets, const IndexType * column_indices, const IndexType * parents)
+        : row_offsets(row_offsets), column_indices(column_indices), parents(parents) {}
+
+    __host__ __device__
+    bool operator()(const IndexType v) const
+    {
+        for (IndexType jj = row_offsets[v]; jj < row_offsets[v + 1]; jj++)
+            if (parents[column_indices[jj]] != parents[v])
+                return true;
+
+        return false;
+    }
+};
+
+template <typename IndexType>
+struct is_root
+{
+    const IndexType * parents;
+
+    is_root(const IndexType * parents) : parents(parents) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType v) const
+    {
+        return parents[v] == v ? 1 : 0;
+    }
+};
+
+template <typename Matrix, typename Array>
+size_t connected_components(const Matrix& G, Array& components,
+                            cusp::csr_format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    const IndexType N = G.num_rows;
+
+    components.resize(N);
+
+    if (N == 0)
+        return 0;
+
+    cusp::array1d<IndexType,MemorySpace> parents(N);
+    thrust::sequence(parents.begin(), parents.end());
+
+    if (G.num_entries > 0)
+    {
+        const IndexType * row_offsets    = thrust::raw_pointer_cast(&G.row_offsets[0]);
+        const IndexType * column_indices = thrust::raw_pointer_cast(&G.column_indices[0]);
+        IndexType * P = thrust::raw_pointer_cast(&parents[0]);
+
+        const thrust::counting_iterator<IndexType> first(0);
+        const thrust::counting_iterator<IndexType> last(N);
+
+        do
+        {
+            thrust::for_each(first, last, hook_trees<IndexType>(row_offsets, column_indices, P));
+
+            // flatten the trees to stars
+            while (thrust::transform_reduce(first, last, jump_pointers<IndexType>(P), false, thrust::logical_or<bool>()));
+        }
+        while (thrust::transform_reduce(first, last, joins_trees<IndexType>(row_offsets, column_indices, P), false, thrust::logical_or<bool>()));
+    }
+
+    // number the roots in order
+    cusp::array1d<IndexType,MemorySpace> numbers(N);
+    thrust::transform(thrust::counting_iterator<IndexType>(0),
+                      thrust::counting_iterator<IndexType>(N),
+                      numbers.begin(),
+                      is_root<IndexType>(thrust::raw_pointer_cast(&parents[0])));
+
+    const size_t num_components = thrust::count(numbers.begin(), numbers.end(), IndexType(1));
+
+    thrust::exclusive_scan(numbers.begin(), numbers.end(), numbers.begin());
+
+    thrust::gather(parents.begin(), parents.end(), numbers.begin(), components.begin());
+
+    return num_components;
+}
+
+template <typename Matrix, typename Array, typename Format>
+size_t connected_components(const Matrix& G, Array& components,
+                            Format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> G_csr(G);
+
+    return cusp::graph::detail::connected_components(G_csr, components, cusp::csr_format());
+}
+
+} // end namespace detail
+
+/////////////////
+// Entry Point //
+/////////////////
+
+template <typename Matrix, typename Array>
+size_t connected_components(const Matrix& G, Array& components)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if(G.num_rows != G.num_cols)
+        throw cusp::invalid_input_exception("matrix must be square");
+
+    return cusp::graph::detail::connected_components(G, components, typename Matrix::format());
+}
+
+} // end namespace graph
+} // end namespace cusp
+
@@ -0,0 +1,142 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// Breadth-first level structures of host CSR graphs, which the orderings
+// use to find distant vertices and to split graphs into levels.  A
+// level structure is restricted to the vertices v with part[v] == p.
+
+namespace cusp
+{
+namespace graph
+{
+namespace detail
+{
+
+template <typename Matrix>
+struct degree_less
+{
+    typedef typename Matrix::index_type IndexType;
+
+    const Matrix& A;
+
+    degree_less(const Matrix& A) : A(A) {}
+
+    bool operator()(const IndexType i, const IndexType j) const
+    {
+        const IndexType di = A.row_offsets[i + 1] - A.row_offsets[i];
+        const IndexType dj = A.row_offsets[j + 1] - A.row_offsets[j];
+
+        return di < dj || (di == dj && i < j);
+    }
+};
+
+// vertices reachable from root in breadth-first order and the offsets
+// of their levels.  When sort_by_degree is set, the unvisited neighbors
+// of a vertex are visited in order of increasing degree (Cuthill-McKee).
+// visited must be all false, and is again on return.
+template <typename Matrix, typename IndexType>
+void breadth_first_levels(const Matrix& A, const IndexType root,
+                          const std::vector<IndexType>& part, const IndexType p,
+                          const bool sort_by_degree,
+                          std::vector<char>& visited,
+                          std::vector<IndexType>& vertices,
+                          std::vector<size_t>& level_offsets)
+{
+    vertices.assign(1, root);
+    level_offsets.assign(1, 0);
+
+    visited[root] = true;
+
+    for (size_t begin = 0; begin < vertices.size(); )
+    {
+        const size_t end = vertices.size();
+
+        level_offsets.push_back(end);
+
+        for (size_t n = begin; n < end; n++)
+        {
+            const IndexType v = vertices[n];
+            const size_t first = vertices.size();
+
+            for (IndexType jj = A.row_offsets[v]; jj < A.row_offsets[v + 1]; jj++)
+            {
+                const IndexType j = A.column_indices[jj];
+
+                if (!visited[j] && part[j] == p)
+                {
+                    visited[j] = true;
+                    vertices.push_back(j);
+                }
+            }
+
+            if (sort_by_degree)
+                std::sort(vertices.begin() + first, vertices.end(), degree_less<Matrix>(A));
+        }
+
+        begin = end;
+    }
+
+    for (size_t n = 0; n < vertices.size(); n++)
+        visited[vertices[n]] = false;
+}
+
+// a vertex of large eccentricity in the component of start (George and
+// Liu), and the level structure rooted at it
+template <typename Matrix, typename IndexType>
+IndexType pseudo_peripheral_vertex(const Matrix& A, const IndexType start,
+                                   const std::vector<IndexType>& part, const IndexType p,
+                                   std::vector<char>& visited,
+                                   std::vector<IndexType>& vertices,
+                                   std::vector<size_t>& level_offsets)
+{
+    IndexType root = start;
+
+    breadth_first_levels(A, root, part, p, false, visited, vertices, level_offsets);
+
+    std::vector<IndexType>  candidate_vertices;
+    std::vector<size_t> candidate_offsets;
+
+    while (true)
+    {
+        // the vertex of smallest degree in the last level
+        const size_t num_levels = level_offsets.size() - 1;
+
+        const IndexType candidate = *std::min_element(vertices.begin() + level_offsets[num_levels - 1],
+                                                      vertices.end(), degree_less<Matrix>(A));
+
+        breadth_first_levels(A, candidate, part, p, false, visited, candidate_vertices, candidate_offsets);
+
+        if (candidate_offsets.size() <= level_offsets.size())
+            break;
+
+        root = candidate;
+        vertices.swap(candidate_vertices);
+        level_offsets.swap(candidate_offsets);
+    }
+
+    return root;
+}
+
+} // end namespace detail
+} // end namespace graph
+} // end namespace cusp
+
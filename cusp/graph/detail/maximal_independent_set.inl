@@ -27,6 +27,10 @@
 //#include <cusp/print.h>
 
 #include <thrust/count.h>
+#include <thrust/fill.h>
+#include <thrust/remove.h>
+#include <thrust/scatter.h>
+#include <thrust/sequence.h>
 #include <thrust/transform.h>
 #include <thrust/transform_scan.h>
 #include <thrust/iterator/constant_iterator.h>
@@ -289,6 +293,141 @@ void compute_mis_states(const size_t k,
 
 
 
+// Priorities of the vertices of the frontier rounds, a hash of the index
+// (murmur3 finalizer) instead of a stored random array
+template <typename IndexType>
+__host__ __device__
+unsigned int mis_priority(const IndexType i)
+{
+    unsigned long long x = (unsigned long long) i;
+
+    unsigned int h = (unsigned int) (x ^ (x >> 32));
+
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+
+    return h;
+}
+
+// One round of an MIS(1) or MIS(2) for an undecided vertex: the largest
+// (state,priority,index) of its k-ring, read from the states of the
+// previous round, decides whether it joins the MIS (2), is a k-ring
+// neighbor of an MIS node (0) or remains undecided (1).  The k hops are
+// fused into a single traversal of the neighbors (of the neighbors).
+template <typename IndexType, typename NodeStateType>
+struct mis_frontier_round
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const NodeStateType * states;
+    size_t k;
+
+    mis_frontier_round(const IndexType * row_offsets, const IndexType * column_indices, const NodeStateType * states, const size_t k)
+        : row_offsets(row_offsets), column_indices(column_indices), states(states), k(k) {}
+
+    // keep the larger of (state,priority,index) of j and the best one
+    __host__ __device__
+    void update(const IndexType j, NodeStateType& state, unsigned int& priority, IndexType& index) const
+    {
+        const NodeStateType s = states[j];
+
+        if (s < state)
+            return;
+
+        const unsigned int p = mis_priority(j);
+
+        if (s > state || p > priority || (p == priority && j > index))
+        {
+            state = s; priority = p; index = j;
+        }
+    }
+
+    __host__ __device__
+    NodeStateType operator()(const IndexType i) const
+    {
+        NodeStateType state    = 1;
+        unsigned int  priority = mis_priority(i);
+        IndexType     index    = i;
+
+        for (IndexType jj = row_offsets[i]; jj < row_offsets[i + 1]; jj++)
+        {
+            const IndexType j = column_indices[jj];
+
+            update(j, state, priority, index);
+
+            if (k > 1)
+                for (IndexType ll = row_offsets[j]; ll < row_offsets[j + 1]; ll++)
+                    update(column_indices[ll], state, priority, index);
+
+            // an MIS node in the k-ring
+            if (state == 2)
+                return 0;
+        }
+
+        return index == i ? 2 : 1;
+    }
+};
+
+template <typename NodeStateType>
+struct is_decided_node
+{
+    __host__ __device__
+    bool operator()(const NodeStateType s) const
+    {
+        return s != 1;
+    }
+};
+
+// MIS(1) or MIS(2) states of a CSR graph.  Each round only processes the
+// vertices that are still undecided, whose list shrinks as the MIS nodes
+// and their k-ring neighbors are decided.
+template <typename Array1, typename Array2, typename Array3>
+void compute_mis_states_frontier(const size_t k,
+                                 const Array1& row_offsets,
+                                 const Array2& column_indices,
+                                       Array3& states)
+{
+    typedef typename Array1::value_type   IndexType;
+    typedef typename Array3::value_type   NodeStateType;
+    typedef typename Array1::memory_space MemorySpace;
+
+    const size_t N = states.size();
+
+    cusp::array1d<IndexType,MemorySpace> active(N);
+    thrust::sequence(active.begin(), active.end());
+
+    thrust::fill(states.begin(), states.end(), NodeStateType(1));
+
+    if (column_indices.empty())
+    {
+        thrust::fill(states.begin(), states.end(), NodeStateType(2));
+        return;
+    }
+
+    cusp::array1d<NodeStateType,MemorySpace> decisions(N);
+
+    const mis_frontier_round<IndexType,NodeStateType> round(thrust::raw_pointer_cast(&row_offsets[0]),
+                                                            thrust::raw_pointer_cast(&column_indices[0]),
+                                                            thrust::raw_pointer_cast(&states[0]), k);
+
+    while (!active.empty())
+    {
+        CUSP_PROFILE_SCOPED_DESC("maximal_independent_set round");
+
+        decisions.resize(active.size());
+
+        thrust::transform(active.begin(), active.end(), decisions.begin(), round);
+        thrust::scatter(decisions.begin(), decisions.end(), active.begin(), states.begin());
+
+        active.erase(thrust::remove_if(active.begin(), active.end(), decisions.begin(), is_decided_node<NodeStateType>()),
+                     active.end());
+    }
+}
+
+
 ////////////////
 // Host Paths //
 ////////////////
@@ -332,33 +471,72 @@ size_t maximal_independent_set(const Matrix& A, Array& stencil, size_t k,
 // Device Paths //
 //////////////////
 
+template <typename Array1, typename Array2>
+size_t mis_stencil(const Array1& states, Array2& stencil)
+{
+    typedef typename Array1::value_type NodeStateType;
+
+    // resize output
+    stencil.resize(states.size());
+
+    // mark all mis nodes
+    thrust::transform(states.begin(), states.end(), thrust::constant_iterator<NodeStateType>(2), stencil.begin(), thrust::equal_to<NodeStateType>());
+
+    // return the size of the MIS
+    return thrust::count(stencil.begin(), stencil.end(), typename Array2::value_type(true));
+}
+
+template <typename Matrix, typename Array>
+size_t maximal_independent_set(const Matrix& A, Array& stencil, size_t k,
+                               cusp::csr_format, cusp::device_memory)
+{
+    typedef typename Matrix::memory_space MemorySpace;
+    typedef unsigned char NodeStateType;
+
+    cusp::array1d<NodeStateType,MemorySpace> states(A.num_rows);
+
+    if (k <= 2)
+    {
+        compute_mis_states_frontier(k, A.row_offsets, A.column_indices, states);
+    }
+    else
+    {
+        cusp::coo_matrix<typename Matrix::index_type,typename Matrix::value_type,MemorySpace> A_coo(A);
+        return maximal_independent_set(A_coo, stencil, k, cusp::coo_format(), cusp::device_memory());
+    }
+
+    return mis_stencil(states, stencil);
+}
+
 template <typename Matrix, typename Array>
 size_t maximal_independent_set(const Matrix& A, Array& stencil, size_t k,
                                cusp::coo_format, cusp::device_memory)
 {
     typedef typename Matrix::index_type   IndexType;
-    typedef typename Matrix::value_type   ValueType;
     typedef typename Matrix::memory_space MemorySpace;
     typedef unsigned int  RandomType;
     typedef unsigned char NodeStateType;
         
     const IndexType N = A.num_rows;
     
-    cusp::array1d<RandomType,MemorySpace> random_values(N);
-    cusp::copy(cusp::detail::random_integers<RandomType>(N), random_values);
-
     cusp::array1d<NodeStateType,MemorySpace> states(N, 1);
 
-    compute_mis_states(k, A.row_indices, A.column_indices, random_values, states);
-    
-    // resize output
-    stencil.resize(N);
+    if (k <= 2)
+    {
+        cusp::array1d<IndexType,MemorySpace> row_offsets(N + 1);
+        cusp::detail::indices_to_offsets(A.row_indices, row_offsets);
 
-    // mark all mis nodes
-    thrust::transform(states.begin(), states.end(), thrust::constant_iterator<NodeStateType>(2), stencil.begin(), thrust::equal_to<NodeStateType>());
+        compute_mis_states_frontier(k, row_offsets, A.column_indices, states);
+    }
+    else
+    {
+        cusp::array1d<RandomType,MemorySpace> random_values(N);
+        cusp::copy(cusp::detail::random_integers<RandomType>(N), random_values);
 
-    // return the size of the MIS
-    return thrust::count(stencil.begin(), stencil.end(), typename Array::value_type(true));
+        compute_mis_states(k, A.row_indices, A.column_indices, random_values, states);
+    }
+
+    return mis_stencil(states, stencil);
 }
 
 
@@ -380,6 +558,19 @@ size_t maximal_independent_set(const Matrix& A, Array& stencil, size_t k,
   return cusp::graph::maximal_independent_set(A_csr, stencil, k);
 }
 
+template <typename Matrix, typename Array, typename Format>
+size_t maximal_independent_set(const Matrix& A, Array& stencil, size_t k,
+                               Format, cusp::device_memory)
+{
+  typedef typename Matrix::index_type   IndexType;
+  typedef typename Matrix::value_type   ValueType;
+
+  // convert matrix to CSR format and compute on the device
+  cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> A_csr(A);
+
+  return cusp::graph::maximal_independent_set(A_csr, stencil, k);
+}
+
 } // end namespace detail
 
 /////////////////
@@ -0,0 +1,203 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/graph/detail/level_structure.h>
+
+#include <thrust/copy.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace cusp
+{
+namespace graph
+{
+namespace detail
+{
+
+// vertices of a part, which are all labeled with the same part index
+template <typename IndexType>
+struct dissection_part
+{
+    std::vector<IndexType> vertices;
+    bool separator;
+};
+
+////////////////
+// Host Paths //
+////////////////
+
+template <typename Matrix, typename Array>
+void nested_dissection(const Matrix& A, Array& permutation, size_t leaf_size,
+                       cusp::csr_format, cusp::host_memory)
+{
+  typedef typename Matrix::index_type IndexType;
+  typedef dissection_part<IndexType>  Part;
+
+  const IndexType N = A.num_rows;
+
+  std::vector<IndexType> part(N, 0);
+  std::vector<char> visited(N, false);
+  IndexType num_parts = 1;
+
+  std::vector<IndexType> order;
+  order.reserve(N);
+
+  std::vector<IndexType> vertices;
+  std::vector<size_t>    level_offsets;
+
+  // parts that remain to be ordered, the next one last
+  std::vector<Part> parts(1);
+  parts[0].separator = false;
+  for (IndexType i = 0; i < N; i++)
+    parts[0].vertices.push_back(i);
+
+  while (!parts.empty())
+  {
+    Part current;
+    current.vertices.swap(parts.back().vertices);
+    current.separator = parts.back().separator;
+    parts.pop_back();
+
+    const std::vector<IndexType>& S = current.vertices;
+
+    if (S.empty())
+      continue;
+
+    if (current.separator || S.size() <= leaf_size)
+    {
+      order.insert(order.end(), S.begin(), S.end());
+      continue;
+    }
+
+    const IndexType p = part[S[0]];
+
+    pseudo_peripheral_vertex(A, S[0], part, p, visited, vertices, level_offsets);
+
+    const size_t num_levels = level_offsets.size() - 1;
+
+    if (vertices.size() < S.size())
+    {
+      // split into the connected components
+      std::vector<Part> components;
+
+      for (size_t n = 0; n < S.size(); n++)
+      {
+        if (part[S[n]] != p)
+          continue;
+
+        breadth_first_levels(A, S[n], part, p, false, visited, vertices, level_offsets);
+
+        for (size_t m = 0; m < vertices.size(); m++)
+          part[vertices[m]] = num_parts;
+
+        num_parts++;
+
+        components.push_back(Part());
+        components.back().vertices.swap(vertices);
+        components.back().separator = false;
+      }
+
+      parts.insert(parts.end(), components.rbegin(), components.rend());
+      continue;
+    }
+
+    Part first, second, separator;
+    first.separator     = false;
+    second.separator    = false;
+    separator.separator = true;
+
+    if (num_levels >= 3)
+    {
+      // the level that contains the median vertex, with a level on
+      // either side
+      size_t middle = 1;
+
+      while (middle + 2 < num_levels && level_offsets[middle + 1] <= S.size() / 2)
+        middle++;
+
+      first.vertices.assign    (vertices.begin(),                             vertices.begin() + level_offsets[middle]);
+      separator.vertices.assign(vertices.begin() + level_offsets[middle],     vertices.begin() + level_offsets[middle + 1]);
+      second.vertices.assign   (vertices.begin() + level_offsets[middle + 1], vertices.end());
+    }
+    else
+    {
+      // too dense to be separated
+      order.insert(order.end(), S.begin(), S.end());
+      continue;
+    }
+
+    for (size_t n = 0; n < first.vertices.size(); n++)
+      part[first.vertices[n]] = num_parts;
+    for (size_t n = 0; n < second.vertices.size(); n++)
+      part[second.vertices[n]] = num_parts + 1;
+    for (size_t n = 0; n < separator.vertices.size(); n++)
+      part[separator.vertices[n]] = num_parts + 2;
+
+    num_parts += 3;
+
+    parts.push_back(separator);
+    parts.push_back(second);
+    parts.push_back(first);
+  }
+
+  permutation.resize(N);
+  thrust::copy(order.begin(), order.end(), permutation.begin());
+}
+
+//////////////////
+// General Path //
+//////////////////
+
+template <typename Matrix, typename Array,
+          typename Format, typename MemorySpace>
+void nested_dissection(const Matrix& A, Array& permutation, size_t leaf_size,
+                       Format, MemorySpace)
+{
+  typedef typename Matrix::index_type   IndexType;
+  typedef typename Matrix::value_type   ValueType;
+
+  // convert matrix to CSR format and compute on the host
+  cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> A_csr(A);
+
+  cusp::graph::nested_dissection(A_csr, permutation, leaf_size);
+}
+
+} // end namespace detail
+
+/////////////////
+// Entry Point //
+/////////////////
+
+template <typename Matrix, typename Array>
+void nested_dissection(const Matrix& A, Array& permutation, size_t leaf_size)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if(A.num_rows != A.num_cols)
+        throw cusp::invalid_input_exception("matrix must be square");
+
+    cusp::graph::detail::nested_dissection(A, permutation, std::max<size_t>(leaf_size, 1),
+                                           typename Matrix::format(), typename Matrix::memory_space());
+}
+
+} // end namespace graph
+} // end namespace cusp
+
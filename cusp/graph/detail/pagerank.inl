@@ -0,0 +1,191 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/transpose.h>
+#include <cusp/detail/format_utils.h>
+
+#include <thrust/copy.h>
+#include <thrust/fill.h>
+#include <thrust/functional.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+namespace cusp
+{
+namespace graph
+{
+namespace detail
+{
+
+// 1 / out-degree of the source of an edge
+template <typename IndexType, typename ValueType>
+struct inverse_out_degree
+{
+    const IndexType * row_offsets;
+
+    inverse_out_degree(const IndexType * row_offsets) : row_offsets(row_offsets) {}
+
+    __host__ __device__
+    ValueType operator()(const IndexType i) const
+    {
+        return ValueType(1) / ValueType(row_offsets[i + 1] - row_offsets[i]);
+    }
+};
+
+// rank of a vertex without out-edges
+template <typename IndexType, typename ValueType>
+struct dangling_rank
+{
+    const IndexType * row_offsets;
+    const ValueType * ranks;
+
+    dangling_rank(const IndexType * row_offsets, const ValueType * ranks)
+        : row_offsets(row_offsets), ranks(ranks) {}
+
+    __host__ __device__
+    ValueType operator()(const IndexType i) const
+    {
+        return row_offsets[i + 1] == row_offsets[i] ? ranks[i] : ValueType(0);
+    }
+};
+
+template <typename ValueType>
+struct rank_change
+{
+    template <typename Tuple>
+    __host__ __device__
+    ValueType operator()(const Tuple& t) const
+    {
+        const ValueType d = thrust::get<0>(t) - thrust::get<1>(t);
+
+        return d < ValueType(0) ? -d : d;
+    }
+};
+
+template <typename Matrix, typename Array>
+size_t pagerank(const Matrix& G, Array& ranks,
+                const double damping, const double tolerance, const size_t max_iterations,
+                cusp::csr_format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Array::value_type    ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    const size_t N = G.num_rows;
+
+    ranks.resize(N);
+
+    if (N == 0)
+        return 0;
+
+    const IndexType * row_offsets = thrust::raw_pointer_cast(&G.row_offsets[0]);
+
+    // P(j,i) = 1 / out-degree(i) for every edge i -> j
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> P;
+    {
+        cusp::csr_matrix<IndexType,ValueType,MemorySpace> S(N, N, G.num_entries);
+        thrust::copy(G.row_offsets.begin(),    G.row_offsets.end(),    S.row_offsets.begin());
+        thrust::copy(G.column_indices.begin(), G.column_indices.end(), S.column_indices.begin());
+
+        cusp::array1d<IndexType,MemorySpace> sources(G.num_entries);
+        cusp::detail::offsets_to_indices(G.row_offsets, sources);
+        thrust::transform(sources.begin(), sources.end(), S.values.begin(),
+                          inverse_out_degree<IndexType,ValueType>(row_offsets));
+
+        cusp::transpose(S, P);
+    }
+
+    cusp::array1d<ValueType,MemorySpace> x(N, ValueType(1) / ValueType(N));
+    cusp::array1d<ValueType,MemorySpace> y(N);
+
+    const ValueType d(damping);
+
+    size_t iteration = 0;
+
+    while (iteration < max_iterations)
+    {
+        const ValueType dangling =
+            thrust::transform_reduce(thrust::counting_iterator<IndexType>(0),
+                                     thrust::counting_iterator<IndexType>(N),
+                                     dangling_rank<IndexType,ValueType>(row_offsets, thrust::raw_pointer_cast(&x[0])),
+                                     ValueType(0), thrust::plus<ValueType>());
+
+        // y <- d * P x + (1 - d + d * dangling) / N
+        thrust::fill(y.begin(), y.end(), (ValueType(1) - d + d * dangling) / ValueType(N));
+        cusp::multiply(P, x, y, d, ValueType(1));
+
+        const ValueType change =
+            thrust::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(y.begin(), x.begin())),
+                                     thrust::make_zip_iterator(thrust::make_tuple(y.end(),   x.end())),
+                                     rank_change<ValueType>(),
+                                     ValueType(0), thrust::plus<ValueType>());
+
+        x.swap(y);
+        iteration++;
+
+        if (change < ValueType(tolerance))
+            break;
+    }
+
+    thrust::copy(x.begin(), x.end(), ranks.begin());
+
+    return iteration;
+}
+
+template <typename Matrix, typename Array, typename Format>
+size_t pagerank(const Matrix& G, Array& ranks,
+                const double damping, const double tolerance, const size_t max_iterations,
+                Format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> G_csr(G);
+
+    return cusp::graph::detail::pagerank(G_csr, ranks, damping, tolerance, max_iterations, cusp::csr_format());
+}
+
+} // end namespace detail
+
+/////////////////
+// Entry Point //
+/////////////////
+
+template <typename Matrix, typename Array>
+size_t pagerank(const Matrix& G, Array& ranks,
+                const double damping, const double tolerance, const size_t max_iterations)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if(G.num_rows != G.num_cols)
+        throw cusp::invalid_input_exception("matrix must be square");
+
+    if(!(damping >= 0 && damping < 1))
+        throw cusp::invalid_input_exception("damping factor must be in [0, 1)");
+
+    return cusp::graph::detail::pagerank(G, ranks, damping, tolerance, max_iterations, typename Matrix::format());
+}
+
+} // end namespace graph
+} // end namespace cusp
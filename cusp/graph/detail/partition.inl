@@ -0,0 +1,721 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/detail/format_utils.h>
+#include <cusp/graph/detail/level_structure.h>
+#include <cusp/graph/maximal_independent_set.h>
+#include <cusp/graph/vertex_coloring.h>
+
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/fill.h>
+#include <thrust/functional.h>
+#include <thrust/gather.h>
+#include <thrust/inner_product.h>
+#include <thrust/reduce.h>
+#include <thrust/remove.h>
+#include <thrust/scan.h>
+#include <thrust/scatter.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace cusp
+{
+namespace graph
+{
+namespace detail
+{
+
+// coarsening stops at this many vertices per part
+const size_t PARTITION_COARSE_VERTICES_PER_PART = 20;
+const size_t PARTITION_MAX_LEVELS               = 64;
+const size_t PARTITION_MATCHING_ROUNDS          = 4;
+const size_t PARTITION_REFINEMENT_PASSES        = 8;
+
+// a graph of the hierarchy: the pattern of the matrix without diagonal,
+// whose values are the edge weights, the vertex weights, and the vertex
+// of the next coarser graph that contains each vertex
+template <typename IndexType, typename MemorySpace>
+struct partition_level
+{
+    cusp::csr_matrix<IndexType,IndexType,MemorySpace> G;
+    cusp::array1d<IndexType,MemorySpace> vertex_weights;
+    cusp::array1d<IndexType,MemorySpace> aggregates;
+};
+
+template <typename IndexType>
+struct partition_is_loop
+{
+    template <typename Tuple>
+    __host__ __device__
+    bool operator()(const Tuple& t) const
+    {
+        return thrust::get<0>(t) == thrust::get<1>(t);
+    }
+};
+
+// heaviest unmatched neighbor of an unmatched vertex whose weight with
+// the vertex does not exceed max_vertex_weight, ties are broken by the
+// priorities of the round
+template <typename IndexType>
+struct partition_match_candidate
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const IndexType * edge_weights;
+    const IndexType * vertex_weights;
+    const IndexType * match;
+    IndexType unmatched;
+    IndexType max_vertex_weight;
+    unsigned int seed;
+
+    partition_match_candidate(const IndexType * row_offsets, const IndexType * column_indices,
+                              const IndexType * edge_weights, const IndexType * vertex_weights,
+                              const IndexType * match, const IndexType unmatched,
+                              const IndexType max_vertex_weight, const unsigned int seed)
+        : row_offsets(row_offsets), column_indices(column_indices),
+          edge_weights(edge_weights), vertex_weights(vertex_weights),
+          match(match), unmatched(unmatched), max_vertex_weight(max_vertex_weight), seed(seed) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType v) const
+    {
+        if (match[v] != unmatched)
+            return unmatched;
+
+        IndexType    best          = unmatched;
+        IndexType    best_weight   = 0;
+        unsigned int best_priority = 0;
+
+        for (IndexType jj = row_offsets[v]; jj < row_offsets[v + 1]; jj++)
+        {
+            const IndexType u = column_indices[jj];
+
+            if (match[u] != unmatched || vertex_weights[v] + vertex_weights[u] > max_vertex_weight)
+                continue;
+
+            const IndexType    w = edge_weights[jj];
+            const unsigned int p = mis_priority(u) ^ seed;
+
+            if (best == unmatched || w > best_weight || (w == best_weight && p > best_priority))
+            {
+                best = u; best_weight = w; best_priority = p;
+            }
+        }
+
+        return best;
+    }
+};
+
+// vertices that chose each other are matched
+template <typename IndexType>
+struct partition_match_accept
+{
+    const IndexType * candidates;
+    const IndexType * match;
+    IndexType unmatched;
+
+    partition_match_accept(const IndexType * candidates, const IndexType * match, const IndexType unmatched)
+        : candidates(candidates), match(match), unmatched(unmatched) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType v) const
+    {
+        if (match[v] != unmatched)
+            return match[v];
+
+        const IndexType c = candidates[v];
+
+        return (c != unmatched && candidates[c] == v) ? c : unmatched;
+    }
+};
+
+// the smaller vertex of a pair, and every unmatched vertex, represents a
+// coarse vertex
+template <typename IndexType>
+struct partition_is_leader
+{
+    const IndexType * match;
+    IndexType unmatched;
+
+    partition_is_leader(const IndexType * match, const IndexType unmatched)
+        : match(match), unmatched(unmatched) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType v) const
+    {
+        const IndexType m = match[v];
+
+        return (m == unmatched || v <= m) ? 1 : 0;
+    }
+};
+
+// coarse vertex of v from the inclusive scan of the leaders
+template <typename IndexType>
+struct partition_aggregate
+{
+    const IndexType * match;
+    const IndexType * leaders;
+    IndexType unmatched;
+
+    partition_aggregate(const IndexType * match, const IndexType * leaders, const IndexType unmatched)
+        : match(match), leaders(leaders), unmatched(unmatched) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType v) const
+    {
+        const IndexType m = match[v];
+
+        return leaders[(m == unmatched || v <= m) ? v : m] - 1;
+    }
+};
+
+// part of v after a refinement pass: the neighboring part in the
+// direction of the pass that reduces the cut most and has room for v, or
+// one that keeps the cut and is lighter than the part of v
+template <typename IndexType>
+struct partition_refine
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const IndexType * edge_weights;
+    const IndexType * vertex_weights;
+    const IndexType * parts;
+    const IndexType * part_weights;
+    IndexType max_part_weight;
+    bool upward;
+
+    partition_refine(const IndexType * row_offsets, const IndexType * column_indices,
+                     const IndexType * edge_weights, const IndexType * vertex_weights,
+                     const IndexType * parts, const IndexType * part_weights,
+                     const IndexType max_part_weight, const bool upward)
+        : row_offsets(row_offsets), column_indices(column_indices),
+          edge_weights(edge_weights), vertex_weights(vertex_weights),
+          parts(parts), part_weights(part_weights),
+          max_part_weight(max_part_weight), upward(upward) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType v) const
+    {
+        const IndexType p = parts[v];
+        const IndexType w = vertex_weights[v];
+
+        IndexType internal = 0;
+
+        for (IndexType jj = row_offsets[v]; jj < row_offsets[v + 1]; jj++)
+            if (parts[column_indices[jj]] == p)
+                internal += edge_weights[jj];
+
+        IndexType best      = p;
+        IndexType best_gain = 0;
+
+        for (IndexType jj = row_offsets[v]; jj < row_offsets[v + 1]; jj++)
+        {
+            const IndexType q = parts[column_indices[jj]];
+
+            if (q == p || (upward ? q < p : q > p) || part_weights[q] + w > max_part_weight)
+                continue;
+
+            // each neighboring part is evaluated at its first neighbor
+            bool seen = false;
+            for (IndexType kk = row_offsets[v]; kk < jj && !seen; kk++)
+                seen = parts[column_indices[kk]] == q;
+
+            if (seen)
+                continue;
+
+            IndexType external = 0;
+            for (IndexType kk = jj; kk < row_offsets[v + 1]; kk++)
+                if (parts[column_indices[kk]] == q)
+                    external += edge_weights[kk];
+
+            const IndexType gain = external - internal;
+
+            if (gain > best_gain ||
+                (gain == 0 && best == p && part_weights[q] + w < part_weights[p]))
+            {
+                best = q; best_gain = gain;
+            }
+        }
+
+        return best;
+    }
+};
+
+// weight of the edges of v to other parts
+template <typename IndexType>
+struct partition_cut
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const IndexType * edge_weights;
+    const IndexType * parts;
+
+    partition_cut(const IndexType * row_offsets, const IndexType * column_indices,
+                  const IndexType * edge_weights, const IndexType * parts)
+        : row_offsets(row_offsets), column_indices(column_indices),
+          edge_weights(edge_weights), parts(parts) {}
+
+    __host__ __device__
+    size_t operator()(const IndexType v) const
+    {
+        size_t cut = 0;
+
+        for (IndexType jj = row_offsets[v]; jj < row_offsets[v + 1]; jj++)
+            if (parts[column_indices[jj]] != parts[v])
+                cut += edge_weights[jj];
+
+        return cut;
+    }
+};
+
+// sums of the weights of the vertices of every part
+template <typename Array1, typename Array2, typename Array3>
+void partition_part_weights(const Array1& parts, const Array2& vertex_weights, Array3& part_weights)
+{
+    typedef typename Array1::value_type   IndexType;
+    typedef typename Array1::memory_space MemorySpace;
+
+    cusp::array1d<IndexType,MemorySpace> keys(parts);
+    cusp::array1d<IndexType,MemorySpace> weights(vertex_weights);
+
+    thrust::sort_by_key(keys.begin(), keys.end(), weights.begin());
+
+    cusp::array1d<IndexType,MemorySpace> ids(keys.size());
+    cusp::array1d<IndexType,MemorySpace> sums(keys.size());
+
+    const size_t num_ids = thrust::reduce_by_key(keys.begin(), keys.end(), weights.begin(),
+                                                 ids.begin(), sums.begin()).first - ids.begin();
+
+    thrust::fill(part_weights.begin(), part_weights.end(), IndexType(0));
+    thrust::scatter(sums.begin(), sums.begin() + num_ids, ids.begin(), part_weights.begin());
+}
+
+// graph of A: its pattern without the diagonal and with unit weights
+template <typename Matrix, typename IndexType, typename MemorySpace>
+void partition_graph(const Matrix& A, partition_level<IndexType,MemorySpace>& level)
+{
+    typedef typename Matrix::value_type ValueType;
+
+    const cusp::csr_matrix<IndexType,ValueType,MemorySpace> B(A);
+
+    cusp::array1d<IndexType,MemorySpace> rows(B.num_entries);
+    cusp::array1d<IndexType,MemorySpace> columns(B.column_indices);
+    cusp::detail::offsets_to_indices(B.row_offsets, rows);
+
+    const size_t num_edges =
+        thrust::remove_if(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin())),
+                          thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   columns.end())),
+                          partition_is_loop<IndexType>())
+        - thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin()));
+
+    rows.resize(num_edges);
+
+    level.G.resize(B.num_rows, B.num_rows, num_edges);
+    cusp::detail::indices_to_offsets(rows, level.G.row_offsets);
+    thrust::copy(columns.begin(), columns.begin() + num_edges, level.G.column_indices.begin());
+    thrust::fill(level.G.values.begin(), level.G.values.end(), IndexType(1));
+
+    level.vertex_weights.resize(B.num_rows);
+    thrust::fill(level.vertex_weights.begin(), level.vertex_weights.end(), IndexType(1));
+}
+
+// Heavy-edge matching of fine.G and the contracted graph.  Returns false,
+// and leaves coarse unchanged, when the matching would not reduce the
+// graph substantially.
+template <typename IndexType, typename MemorySpace>
+bool partition_coarsen(partition_level<IndexType,MemorySpace>& fine,
+                       partition_level<IndexType,MemorySpace>& coarse,
+                       const IndexType max_vertex_weight)
+{
+    CUSP_PROFILE_SCOPED();
+
+    const IndexType N = fine.G.num_rows;
+    const IndexType unmatched = N;
+
+    if (fine.G.num_entries == 0)
+        return false;
+
+    cusp::array1d<IndexType,MemorySpace> vertices(N);
+    thrust::sequence(vertices.begin(), vertices.end());
+
+    cusp::array1d<IndexType,MemorySpace> match(N, unmatched);
+    cusp::array1d<IndexType,MemorySpace> candidates(N);
+
+    const IndexType * row_offsets    = thrust::raw_pointer_cast(&fine.G.row_offsets[0]);
+    const IndexType * column_indices = thrust::raw_pointer_cast(&fine.G.column_indices[0]);
+    const IndexType * edge_weights   = thrust::raw_pointer_cast(&fine.G.values[0]);
+    const IndexType * vertex_weights = thrust::raw_pointer_cast(&fine.vertex_weights[0]);
+
+    size_t num_unmatched = N;
+
+    for (size_t round = 0; round < PARTITION_MATCHING_ROUNDS && num_unmatched > 1; round++)
+    {
+        thrust::transform(vertices.begin(), vertices.end(), candidates.begin(),
+                          partition_match_candidate<IndexType>(row_offsets, column_indices, edge_weights, vertex_weights,
+                                                               thrust::raw_pointer_cast(&match[0]), unmatched,
+                                                               max_vertex_weight, mis_priority(IndexType(round))));
+
+        thrust::transform(vertices.begin(), vertices.end(), match.begin(),
+                          partition_match_accept<IndexType>(thrust::raw_pointer_cast(&candidates[0]),
+                                                            thrust::raw_pointer_cast(&match[0]), unmatched));
+
+        const size_t previous = num_unmatched;
+        num_unmatched = thrust::count(match.begin(), match.end(), unmatched);
+
+        if (num_unmatched == previous)
+            break;
+    }
+
+    // leaders[v] is the number of coarse vertices up to v
+    cusp::array1d<IndexType,MemorySpace> leaders(N);
+    thrust::transform(vertices.begin(), vertices.end(), leaders.begin(),
+                      partition_is_leader<IndexType>(thrust::raw_pointer_cast(&match[0]), unmatched));
+    thrust::inclusive_scan(leaders.begin(), leaders.end(), leaders.begin());
+
+    const IndexType num_coarse = leaders[N - 1];
+
+    if (size_t(num_coarse) * 10 > size_t(N) * 9)
+        return false;
+
+    fine.aggregates.resize(N);
+    thrust::transform(vertices.begin(), vertices.end(), fine.aggregates.begin(),
+                      partition_aggregate<IndexType>(thrust::raw_pointer_cast(&match[0]),
+                                                     thrust::raw_pointer_cast(&leaders[0]), unmatched));
+
+    // edges between the coarse vertices, whose weights are summed
+    {
+        const size_t M = fine.G.num_entries;
+
+        cusp::array1d<IndexType,MemorySpace> fine_rows(M);
+        cusp::detail::offsets_to_indices(fine.G.row_offsets, fine_rows);
+
+        cusp::array1d<IndexType,MemorySpace> rows(M);
+        cusp::array1d<IndexType,MemorySpace> columns(M);
+        cusp::array1d<IndexType,MemorySpace> weights(fine.G.values);
+
+        thrust::gather(fine_rows.begin(), fine_rows.end(), fine.aggregates.begin(), rows.begin());
+        thrust::gather(fine.G.column_indices.begin(), fine.G.column_indices.end(), fine.aggregates.begin(), columns.begin());
+
+        const size_t num_edges =
+            thrust::remove_if(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin(), weights.begin())),
+                              thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   columns.end(),   weights.end())),
+                              partition_is_loop<IndexType>())
+            - thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin(), weights.begin()));
+
+        rows.resize(num_edges);
+        columns.resize(num_edges);
+        weights.resize(num_edges);
+
+        cusp::detail::sort_by_row_and_column(rows, columns, weights, num_coarse, num_coarse);
+
+        cusp::array1d<IndexType,MemorySpace> coarse_rows(num_edges);
+
+        coarse.G.resize(num_coarse, num_coarse, num_edges);
+
+        const size_t num_coarse_edges =
+            thrust::reduce_by_key(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), columns.begin())),
+                                  thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   columns.end())),
+                                  weights.begin(),
+                                  thrust::make_zip_iterator(thrust::make_tuple(coarse_rows.begin(), coarse.G.column_indices.begin())),
+                                  coarse.G.values.begin()).second - coarse.G.values.begin();
+
+        coarse_rows.resize(num_coarse_edges);
+        coarse.G.resize(num_coarse, num_coarse, num_coarse_edges);
+        cusp::detail::indices_to_offsets(coarse_rows, coarse.G.row_offsets);
+    }
+
+    // weights of the coarse vertices
+    {
+        cusp::array1d<IndexType,MemorySpace> keys(fine.aggregates);
+        cusp::array1d<IndexType,MemorySpace> weights(fine.vertex_weights);
+        cusp::array1d<IndexType,MemorySpace> ids(num_coarse);
+
+        thrust::sort_by_key(keys.begin(), keys.end(), weights.begin());
+
+        coarse.vertex_weights.resize(num_coarse);
+        thrust::reduce_by_key(keys.begin(), keys.end(), weights.begin(), ids.begin(), coarse.vertex_weights.begin());
+    }
+
+    return true;
+}
+
+// parts [base, base + count) and the vertices that they hold
+template <typename IndexType>
+struct partition_range
+{
+    IndexType base;
+    IndexType count;
+    std::vector<IndexType> vertices;
+};
+
+// Recursive bisection of a host graph into num_parts parts.  A range
+// [base, base + count) of parts holds the vertices labeled base, which
+// are ordered by breadth-first level structures from pseudo-peripheral
+// vertices, one connected component after the other, and split where
+// the weight of the first count / 2 parts is reached.
+template <typename IndexType>
+void partition_bisect(const cusp::csr_matrix<IndexType,IndexType,cusp::host_memory>& G,
+                      const cusp::array1d<IndexType,cusp::host_memory>& vertex_weights,
+                      const IndexType num_parts,
+                      std::vector<IndexType>& part)
+{
+    const IndexType N = G.num_rows;
+    const IndexType ordered = num_parts; // label of the vertices that were ordered
+
+    part.assign(N, IndexType(0));
+
+    std::vector<char>      visited(N, false);
+    std::vector<IndexType> vertices;
+    std::vector<size_t>    level_offsets;
+    std::vector<IndexType> order;
+
+    typedef partition_range<IndexType> range;
+
+    std::vector<range> ranges(1);
+    ranges[0].base  = 0;
+    ranges[0].count = num_parts;
+    for (IndexType i = 0; i < N; i++)
+        ranges[0].vertices.push_back(i);
+
+    while (!ranges.empty())
+    {
+        range current;
+        current.base  = ranges.back().base;
+        current.count = ranges.back().count;
+        current.vertices.swap(ranges.back().vertices);
+        ranges.pop_back();
+
+        const std::vector<IndexType>& S = current.vertices;
+
+        if (current.count <= 1 || S.empty())
+            continue;
+
+        order.clear();
+
+        for (size_t n = 0; n < S.size(); n++)
+        {
+            if (part[S[n]] != current.base)
+                continue;
+
+            pseudo_peripheral_vertex(G, S[n], part, current.base, visited, vertices, level_offsets);
+
+            for (size_t m = 0; m < vertices.size(); m++)
+                part[vertices[m]] = ordered;
+
+            order.insert(order.end(), vertices.begin(), vertices.end());
+        }
+
+        const IndexType first_count = current.count / 2;
+
+        size_t total = 0;
+        for (size_t n = 0; n < order.size(); n++)
+            total += vertex_weights[order[n]];
+
+        // a vertex belongs to the first half when its center is below the target
+        const size_t target = (total * first_count) / current.count;
+
+        range first, second;
+        first.base   = current.base;
+        first.count  = first_count;
+        second.base  = current.base + first_count;
+        second.count = current.count - first_count;
+
+        size_t weight = 0;
+        size_t n = 0;
+
+        for (; n < order.size() && 2 * weight + vertex_weights[order[n]] <= 2 * target; n++)
+        {
+            weight += vertex_weights[order[n]];
+            part[order[n]] = first.base;
+            first.vertices.push_back(order[n]);
+        }
+
+        for (; n < order.size(); n++)
+        {
+            part[order[n]] = second.base;
+            second.vertices.push_back(order[n]);
+        }
+
+        ranges.push_back(second);
+        ranges.push_back(first);
+    }
+}
+
+// boundary refinement of the parts of level
+template <typename IndexType, typename MemorySpace, typename Array>
+void partition_refine_level(const partition_level<IndexType,MemorySpace>& level,
+                            const IndexType num_parts, const IndexType max_part_weight,
+                            Array& parts)
+{
+    CUSP_PROFILE_SCOPED();
+
+    const IndexType N = level.G.num_rows;
+
+    if (level.G.num_entries == 0)
+        return;
+
+    cusp::array1d<IndexType,MemorySpace> vertices(N);
+    thrust::sequence(vertices.begin(), vertices.end());
+
+    cusp::array1d<IndexType,MemorySpace> part_weights(num_parts);
+    cusp::array1d<IndexType,MemorySpace> new_parts(N);
+
+    // passes without a move in a row
+    size_t idle = 0;
+
+    for (size_t pass = 0; pass < 2 * PARTITION_REFINEMENT_PASSES && idle < 2; pass++)
+    {
+        partition_part_weights(parts, level.vertex_weights, part_weights);
+
+        thrust::transform(vertices.begin(), vertices.end(), new_parts.begin(),
+                          partition_refine<IndexType>(thrust::raw_pointer_cast(&level.G.row_offsets[0]),
+                                                      thrust::raw_pointer_cast(&level.G.column_indices[0]),
+                                                      thrust::raw_pointer_cast(&level.G.values[0]),
+                                                      thrust::raw_pointer_cast(&level.vertex_weights[0]),
+                                                      thrust::raw_pointer_cast(&parts[0]),
+                                                      thrust::raw_pointer_cast(&part_weights[0]),
+                                                      max_part_weight, pass % 2 == 0));
+
+        const size_t num_moves = thrust::inner_product(parts.begin(), parts.end(), new_parts.begin(), size_t(0),
+                                                       thrust::plus<size_t>(), thrust::not_equal_to<IndexType>());
+
+        parts.swap(new_parts);
+
+        idle = num_moves == 0 ? idle + 1 : 0;
+    }
+}
+
+} // end namespace detail
+
+/////////////////
+// Entry Point //
+/////////////////
+
+template <typename Matrix, typename Array>
+size_t partition(const Matrix& A, size_t num_parts, Array& parts, float imbalance)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::memory_space MemorySpace;
+    typedef detail::partition_level<IndexType,MemorySpace> Level;
+
+    if(A.num_rows != A.num_cols)
+        throw cusp::invalid_input_exception("matrix must be square");
+
+    if(num_parts == 0)
+        throw cusp::invalid_input_exception("number of parts must be positive");
+
+    const IndexType N = A.num_rows;
+
+    if (num_parts == 1 || N == 0)
+    {
+        parts.resize(N);
+        thrust::fill(parts.begin(), parts.end(), 0);
+        return 0;
+    }
+
+    const size_t coarse_size = std::max<size_t>(num_parts * detail::PARTITION_COARSE_VERTICES_PER_PART, 100);
+
+    // aggregates that are too heavy cannot be balanced
+    const IndexType max_vertex_weight = IndexType((3 * size_t(N)) / (2 * coarse_size)) + 1;
+    const IndexType max_part_weight   = IndexType((1.0f + std::max(imbalance, 0.0f)) * float(N) / float(num_parts)) + 1;
+
+    std::vector<Level> levels;
+    levels.reserve(detail::PARTITION_MAX_LEVELS);
+
+    levels.push_back(Level());
+    detail::partition_graph(A, levels.back());
+
+    while (levels.size() < detail::PARTITION_MAX_LEVELS && size_t(levels.back().G.num_rows) > coarse_size)
+    {
+        levels.push_back(Level());
+
+        if (!detail::partition_coarsen(levels[levels.size() - 2], levels.back(), max_vertex_weight))
+        {
+            levels.pop_back();
+            break;
+        }
+    }
+
+    // initial partition of the coarsest graph
+    cusp::array1d<IndexType,MemorySpace> level_parts;
+    {
+        const cusp::csr_matrix<IndexType,IndexType,cusp::host_memory> G(levels.back().G);
+        const cusp::array1d<IndexType,cusp::host_memory> vertex_weights(levels.back().vertex_weights);
+
+        std::vector<IndexType> part;
+        detail::partition_bisect(G, vertex_weights, IndexType(num_parts), part);
+
+        level_parts = cusp::array1d<IndexType,cusp::host_memory>(part.begin(), part.end());
+    }
+
+    detail::partition_refine_level(levels.back(), IndexType(num_parts), max_part_weight, level_parts);
+
+    // projection and refinement
+    for (size_t l = levels.size() - 1; l > 0; l--)
+    {
+        const Level& fine = levels[l - 1];
+
+        cusp::array1d<IndexType,MemorySpace> fine_parts(fine.G.num_rows);
+        thrust::gather(fine.aggregates.begin(), fine.aggregates.end(), level_parts.begin(), fine_parts.begin());
+
+        level_parts.swap(fine_parts);
+
+        detail::partition_refine_level(fine, IndexType(num_parts), max_part_weight, level_parts);
+    }
+
+    parts.resize(N);
+    thrust::copy(level_parts.begin(), level_parts.end(), parts.begin());
+
+    const Level& finest = levels[0];
+
+    if (finest.G.num_entries == 0)
+        return 0;
+
+    cusp::array1d<IndexType,MemorySpace> vertices(N);
+    thrust::sequence(vertices.begin(), vertices.end());
+
+    // every edge is stored in both of its rows
+    return thrust::transform_reduce(vertices.begin(), vertices.end(),
+                                    detail::partition_cut<IndexType>(thrust::raw_pointer_cast(&finest.G.row_offsets[0]),
+                                                                     thrust::raw_pointer_cast(&finest.G.column_indices[0]),
+                                                                     thrust::raw_pointer_cast(&finest.G.values[0]),
+                                                                     thrust::raw_pointer_cast(&level_parts[0])),
+                                    size_t(0), thrust::plus<size_t>()) / 2;
+}
+
+template <typename Array1, typename Array2, typename Array3>
+void partition_permutation(const Array1& parts, Array2& permutation, Array3& part_offsets)
+{
+    // the parts are ordered like color classes
+    cusp::graph::coloring_permutation(parts, permutation, part_offsets);
+}
+
+} // end namespace graph
+} // end namespace cusp
@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/graph/detail/level_structure.h>
+
+#include <thrust/copy.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace cusp
+{
+namespace graph
+{
+namespace detail
+{
+
+////////////////
+// Host Paths //
+////////////////
+
+template <typename Matrix, typename Array>
+void reverse_cuthill_mckee(const Matrix& A, Array& permutation,
+                           cusp::csr_format, cusp::host_memory)
+{
+  typedef typename Matrix::index_type IndexType;
+
+  const IndexType N = A.num_rows;
+
+  const std::vector<IndexType> part(N, 0);
+  std::vector<char> visited(N, false);
+  std::vector<char> ordered(N, false);
+
+  std::vector<IndexType> order;
+  order.reserve(N);
+
+  std::vector<IndexType> vertices;
+  std::vector<size_t>    level_offsets;
+
+  // start each component at its vertex of smallest degree
+  std::vector<IndexType> starts(N);
+  for (IndexType i = 0; i < N; i++)
+    starts[i] = i;
+  std::sort(starts.begin(), starts.end(), degree_less<Matrix>(A));
+
+  for (IndexType n = 0; n < N; n++)
+  {
+    if (ordered[starts[n]])
+      continue;
+
+    const IndexType root = pseudo_peripheral_vertex(A, starts[n], part, IndexType(0), visited, vertices, level_offsets);
+
+    breadth_first_levels(A, root, part, IndexType(0), true, visited, vertices, level_offsets);
+
+    for (size_t k = 0; k < vertices.size(); k++)
+    {
+      ordered[vertices[k]] = true;
+      order.push_back(vertices[k]);
+    }
+  }
+
+  std::reverse(order.begin(), order.end());
+
+  permutation.resize(N);
+  thrust::copy(order.begin(), order.end(), permutation.begin());
+}
+
+//////////////////
+// General Path //
+//////////////////
+
+template <typename Matrix, typename Array,
+          typename Format, typename MemorySpace>
+void reverse_cuthill_mckee(const Matrix& A, Array& permutation,
+                           Format, MemorySpace)
+{
+  typedef typename Matrix::index_type   IndexType;
+  typedef typename Matrix::value_type   ValueType;
+
+  // convert matrix to CSR format and compute on the host
+  cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> A_csr(A);
+
+  cusp::graph::reverse_cuthill_mckee(A_csr, permutation);
+}
+
+} // end namespace detail
+
+/////////////////
+// Entry Point //
+/////////////////
+
+template <typename Matrix, typename Array>
+void reverse_cuthill_mckee(const Matrix& A, Array& permutation)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if(A.num_rows != A.num_cols)
+        throw cusp::invalid_input_exception("matrix must be square");
+
+    cusp::graph::detail::reverse_cuthill_mckee(A, permutation, typename Matrix::format(), typename Matrix::memory_space());
+}
+
+} // end namespace graph
+} // end namespace cusp
+
@@ -0,0 +1,157 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/sparse_vector.h>
+#include <cusp/detail/spmspv.h>
+#include <cusp/detail/device/spmv/semiring.h>
+
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/functional.h>
+#include <thrust/scatter.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/iterator/permutation_iterator.h>
+
+#include <limits>
+
+namespace cusp
+{
+namespace graph
+{
+namespace detail
+{
+
+template <typename ValueType>
+struct is_negative_weight
+{
+    __host__ __device__
+    bool operator()(const ValueType w) const
+    {
+        return w < ValueType(0);
+    }
+};
+
+template <typename Matrix, typename Array>
+size_t single_source_shortest_path(const Matrix& G, const size_t src, Array& distances,
+                                   cusp::csr_format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   WeightType;
+    typedef typename Array::value_type    ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    const size_t N = G.num_rows;
+
+    if (thrust::count_if(G.values.begin(), G.values.end(), is_negative_weight<WeightType>()) > 0)
+        throw cusp::invalid_input_exception("edge weights must be nonnegative");
+
+    const ValueType infinity = std::numeric_limits<ValueType>::max();
+
+    cusp::array1d<ValueType,MemorySpace> tentative(N, infinity);
+    tentative[src] = ValueType(0);
+
+    // vertices whose distance decreased in the last round
+    cusp::sparse_vector<IndexType,ValueType,MemorySpace> frontier(N, 1);
+    frontier.indices[0] = IndexType(src);
+    frontier.values[0]  = ValueType(0);
+
+    cusp::sparse_vector<IndexType,ValueType,MemorySpace> relaxed;
+    cusp::array1d<bool,MemorySpace>                      improved;
+
+    const cusp::detail::spmspv_row_length<IndexType> degree(thrust::raw_pointer_cast(&G.row_offsets[0]));
+
+    size_t round = 0;
+
+    for (; frontier.num_entries > 0; round++)
+    {
+        const size_t frontier_edges = thrust::transform_reduce(frontier.indices.begin(), frontier.indices.end(),
+                                                               degree, IndexType(0), thrust::plus<IndexType>());
+
+        if (frontier_edges == 0)
+        {
+            frontier.resize(N, 0);
+            continue;
+        }
+
+        // relaxed[j] = min_i (frontier[i] + G(i,j)) over the out-edges of the frontier
+        cusp::detail::spmspv_push(G, frontier, relaxed, frontier_edges,
+                                  cusp::detail::device::make_spmv_semiring(thrust::plus<ValueType>(),
+                                                                           thrust::minimum<ValueType>(),
+                                                                           infinity));
+
+        improved.resize(relaxed.num_entries);
+        thrust::transform(relaxed.values.begin(), relaxed.values.end(),
+                          thrust::make_permutation_iterator(tentative.begin(), relaxed.indices.begin()),
+                          improved.begin(),
+                          thrust::less<ValueType>());
+
+        const size_t num_improved = thrust::count(improved.begin(), improved.end(), true);
+
+        frontier.resize(N, num_improved);
+        thrust::copy_if(relaxed.indices.begin(), relaxed.indices.end(), improved.begin(),
+                        frontier.indices.begin(), thrust::identity<bool>());
+        thrust::copy_if(relaxed.values.begin(), relaxed.values.end(), improved.begin(),
+                        frontier.values.begin(), thrust::identity<bool>());
+
+        thrust::scatter(frontier.values.begin(), frontier.values.end(), frontier.indices.begin(), tentative.begin());
+    }
+
+    distances.resize(N);
+    thrust::copy(tentative.begin(), tentative.end(), distances.begin());
+
+    return round;
+}
+
+template <typename Matrix, typename Array, typename Format>
+size_t single_source_shortest_path(const Matrix& G, const size_t src, Array& distances,
+                                   Format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> G_csr(G);
+
+    return cusp::graph::detail::single_source_shortest_path(G_csr, src, distances, cusp::csr_format());
+}
+
+} // end namespace detail
+
+/////////////////
+// Entry Point //
+/////////////////
+
+template <typename Matrix, typename Array>
+size_t single_source_shortest_path(const Matrix& G, const size_t src, Array& distances)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if(G.num_rows != G.num_cols)
+        throw cusp::invalid_input_exception("matrix must be square");
+
+    if(src >= G.num_rows)
+        throw cusp::invalid_input_exception("source vertex is out of range");
+
+    return cusp::graph::detail::single_source_shortest_path(G, src, distances, typename Matrix::format());
+}
+
+} // end namespace graph
+} // end namespace cusp
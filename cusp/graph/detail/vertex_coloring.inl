@@ -0,0 +1,263 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/detail/random.h>
+#include <cusp/detail/format_utils.h>
+#include <cusp/graph/maximal_independent_set.h>
+
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/extrema.h>
+#include <thrust/fill.h>
+#include <thrust/replace.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace cusp
+{
+namespace graph
+{
+namespace detail
+{
+
+// undecided MIS state (1) for the vertices without a color, the colored
+// vertices take no part (0)
+template <typename IndexType, typename NodeStateType>
+struct uncolored_state
+{
+    IndexType uncolored;
+
+    uncolored_state(const IndexType uncolored) : uncolored(uncolored) {}
+
+    __host__ __device__
+    NodeStateType operator()(const IndexType color) const
+    {
+        return color == uncolored ? 1 : 0;
+    }
+};
+
+template <typename NodeStateType>
+struct is_mis_node
+{
+    __host__ __device__
+    bool operator()(const NodeStateType s) const
+    {
+        return s == 2;
+    }
+};
+
+////////////////
+// Host Paths //
+////////////////
+
+template <typename Matrix, typename Array>
+size_t vertex_coloring(const Matrix& A, Array& colors, size_t k,
+                       cusp::csr_format, cusp::host_memory)
+{
+  typedef typename Matrix::index_type IndexType;
+
+  const IndexType N = A.num_rows;
+  const IndexType uncolored = N;
+
+  cusp::array1d<IndexType,cusp::host_memory> vertex_colors(N, uncolored);
+
+  // last vertex that visited a vertex and that found a color
+  std::vector<IndexType> visited(N, uncolored);
+  std::vector<IndexType> forbidden(N + 1, uncolored);
+
+  std::vector<IndexType> frontier;
+  std::vector<IndexType> next;
+
+  size_t num_colors = 0;
+
+  // give each vertex the smallest color of none of its k-ring neighbors
+  for(IndexType i = 0; i < N; i++)
+  {
+    visited[i] = i;
+    frontier.assign(1, i);
+
+    for(size_t ring = 0; ring < k && !frontier.empty(); ring++)
+    {
+      next.clear();
+
+      for(size_t n = 0; n < frontier.size(); n++)
+      {
+        const IndexType v = frontier[n];
+
+        for(IndexType jj = A.row_offsets[v]; jj < A.row_offsets[v + 1]; jj++)
+        {
+          const IndexType j = A.column_indices[jj];
+
+          if (visited[j] == i)
+            continue;
+
+          visited[j] = i;
+          forbidden[vertex_colors[j]] = i;
+          next.push_back(j);
+        }
+      }
+
+      frontier.swap(next);
+    }
+
+    IndexType color = 0;
+
+    while (forbidden[color] == i)
+      color++;
+
+    vertex_colors[i] = color;
+    num_colors = std::max(num_colors, size_t(color) + 1);
+  }
+
+  colors.resize(N);
+  thrust::copy(vertex_colors.begin(), vertex_colors.end(), colors.begin());
+
+  return num_colors;
+}
+
+//////////////////
+// Device Paths //
+//////////////////
+
+template <typename Matrix, typename Array>
+size_t vertex_coloring(const Matrix& A, Array& colors, size_t k,
+                       cusp::coo_format, cusp::device_memory)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::memory_space MemorySpace;
+    typedef unsigned int  RandomType;
+    typedef unsigned char NodeStateType;
+
+    const IndexType N = A.num_rows;
+    const IndexType uncolored = N;
+
+    cusp::array1d<RandomType,MemorySpace> random_values(N);
+    cusp::copy(cusp::detail::random_integers<RandomType>(N), random_values);
+
+    cusp::array1d<IndexType,MemorySpace>     vertex_colors(N, uncolored);
+    cusp::array1d<NodeStateType,MemorySpace> states(N);
+
+    size_t num_colors = 0;
+
+    // each color is an MIS(k) of the vertices without a color, whose
+    // k-rings still include the colored vertices
+    for(size_t num_colored = 0; num_colored < size_t(N); num_colors++)
+    {
+        thrust::transform(vertex_colors.begin(), vertex_colors.end(), states.begin(),
+                          uncolored_state<IndexType,NodeStateType>(uncolored));
+
+        compute_mis_states(k, A.row_indices, A.column_indices, random_values, states);
+
+        thrust::replace_if(vertex_colors.begin(), vertex_colors.end(), states.begin(),
+                           is_mis_node<NodeStateType>(), IndexType(num_colors));
+
+        num_colored += thrust::count(states.begin(), states.end(), NodeStateType(2));
+    }
+
+    colors.resize(N);
+    thrust::copy(vertex_colors.begin(), vertex_colors.end(), colors.begin());
+
+    return num_colors;
+}
+
+//////////////////
+// General Path //
+//////////////////
+
+template <typename Matrix, typename Array, typename Format>
+size_t vertex_coloring(const Matrix& A, Array& colors, size_t k,
+                       Format, cusp::host_memory)
+{
+  typedef typename Matrix::index_type   IndexType;
+  typedef typename Matrix::value_type   ValueType;
+
+  cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> A_csr(A);
+
+  return cusp::graph::vertex_coloring(A_csr, colors, k);
+}
+
+template <typename Matrix, typename Array, typename Format>
+size_t vertex_coloring(const Matrix& A, Array& colors, size_t k,
+                       Format, cusp::device_memory)
+{
+  typedef typename Matrix::index_type   IndexType;
+  typedef typename Matrix::value_type   ValueType;
+
+  cusp::coo_matrix<IndexType,ValueType,cusp::device_memory> A_coo(A);
+
+  return cusp::graph::vertex_coloring(A_coo, colors, k);
+}
+
+} // end namespace detail
+
+/////////////////
+// Entry Point //
+/////////////////
+
+template <typename Matrix, typename Array>
+size_t vertex_coloring(const Matrix& A, Array& colors, size_t k)
+{
+    CUSP_PROFILE_SCOPED();
+
+    if(A.num_rows != A.num_cols)
+        throw cusp::invalid_input_exception("matrix must be square");
+
+    if (k == 0 || A.num_rows == 0)
+    {
+        colors.resize(A.num_rows);
+        thrust::fill(colors.begin(), colors.end(), typename Array::value_type(0));
+        return A.num_rows == 0 ? 0 : 1;
+    }
+    else
+    {
+        return cusp::graph::detail::vertex_coloring(A, colors, k, typename Matrix::format(), typename Matrix::memory_space());
+    }
+}
+
+template <typename Array1, typename Array2, typename Array3>
+void coloring_permutation(const Array1& colors, Array2& permutation, Array3& color_offsets)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Array1::value_type   ColorType;
+    typedef typename Array2::memory_space MemorySpace;
+
+    const size_t N = colors.size();
+    const size_t num_colors = N == 0 ? 0 : size_t(*thrust::max_element(colors.begin(), colors.end())) + 1;
+
+    cusp::array1d<ColorType,MemorySpace> sorted_colors(colors);
+
+    permutation.resize(N);
+    thrust::sequence(permutation.begin(), permutation.end());
+
+    thrust::stable_sort_by_key(sorted_colors.begin(), sorted_colors.end(), permutation.begin());
+
+    color_offsets.resize(num_colors + 1);
+    cusp::detail::indices_to_offsets(sorted_colors, color_offsets);
+}
+
+} // end namespace graph
+} // end namespace cusp
+
@@ -0,0 +1,73 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file nested_dissection.h
+ *  \brief Nested dissection ordering of a graph
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace graph
+{
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p nested_dissection : computes a nested dissection ordering of a
+ * graph.  The graph is split recursively into two parts and a separator
+ * by the middle level of a breadth-first level structure rooted at a
+ * pseudo-peripheral vertex.  The first part, the second part and the
+ * separator are then ordered one after the other, until a part has at
+ * most \p leaf_size vertices.  Disconnected parts are split into their
+ * components.  The rows of the matrix therefore form blocks of nearby
+ * vertices, which read few distinct entries of \p x in a sparse
+ * matrix-vector product.
+ *
+ * The ordering is represented by an array that lists the vertices in
+ * their new order.  Specifically, <tt>permutation[i]</tt> is the vertex
+ * that becomes vertex \p i, as expected by \p cusp::permute.  The ordering
+ * is computed on the host.
+ *
+ * \param A symmetric matrix that represents a graph
+ * \param permutation array to hold the ordering
+ * \param leaf_size largest part that is not split further
+ *
+ * \tparam Matrix matrix
+ * \tparam Array array
+ *
+ *  \see http://en.wikipedia.org/wiki/Nested_dissection
+ *  \see \p reverse_cuthill_mckee
+ *  \see \p cusp::permute
+ */
+template <typename Matrix, typename Array>
+void nested_dissection(const Matrix& A, Array& permutation, size_t leaf_size = 64);
+
+/*! \}
+ */
+
+
+} // end namespace graph
+} // end namespace cusp
+
+#include <cusp/graph/detail/nested_dissection.inl>
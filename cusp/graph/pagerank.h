@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file pagerank.h
+ *  \brief PageRank of the vertices of a graph
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace graph
+{
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p pagerank : computes the PageRank of every vertex of a directed
+ * graph by power iteration.  A stored entry <tt>G(i,j)</tt> is an edge
+ * from vertex \p i to vertex \p j, and its value is ignored.  In every
+ * iteration a vertex passes the fraction \p damping of its rank evenly
+ * to its out-neighbors and the rest is spread over all vertices, as is
+ * the rank of the dangling vertices that have no out-edges.
+ *
+ * The transpose of \p G, scaled by the inverse out-degrees, is formed
+ * once in CSR format, so an iteration is a single matrix-vector product
+ * with the update of the teleportation term fused into it (see
+ * \p multiply(A,x,y,alpha,beta)).  The iteration stops once the ranks
+ * change by less than \p tolerance in the 1-norm.
+ *
+ * \param G matrix that represents a directed graph
+ * \param ranks array to hold the ranks, which sum to one
+ * \param damping probability of following an edge, in [0, 1)
+ * \param tolerance 1-norm of the change of the ranks at convergence
+ * \param max_iterations maximum number of iterations
+ * \return the number of iterations
+ *
+ * \tparam Matrix matrix
+ * \tparam Array array of a floating point type
+ *
+ * \code
+ * #include <cusp/csr_matrix.h>
+ * #include <cusp/gallery/random.h>
+ * #include <cusp/graph/pagerank.h>
+ *
+ * int main(void)
+ * {
+ *     cusp::csr_matrix<int, float, cusp::device_memory> G;
+ *     cusp::gallery::random(10000, 10000, 100000, G);
+ *
+ *     cusp::array1d<float, cusp::device_memory> ranks;
+ *     size_t iterations = cusp::graph::pagerank(G, ranks);
+ *
+ *     return 0;
+ * }
+ * \endcode
+ *
+ * \throws cusp::invalid_input_exception if \p G is not square or
+ *  \p damping is not in [0, 1)
+ *
+ *  \see http://en.wikipedia.org/wiki/PageRank
+ *  \see \p breadth_first_search
+ */
+template <typename Matrix, typename Array>
+size_t pagerank(const Matrix& G, Array& ranks,
+                const double damping = 0.85,
+                const double tolerance = 1e-6,
+                const size_t max_iterations = 100);
+
+/*! \}
+ */
+
+
+} // end namespace graph
+} // end namespace cusp
+
+#include <cusp/graph/detail/pagerank.inl>
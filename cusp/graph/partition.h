@@ -0,0 +1,141 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+
+/*! \file partition.h
+ *  \brief Multilevel k-way partitioning of a graph
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace graph
+{
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p partition : splits the vertices of a graph into \p num_parts parts
+ * of about the same size with few edges between the parts.  Rows that are
+ * placed on the same device by a distributed matrix then share most of
+ * their columns, which keeps the halos, and hence the communication of a
+ * distributed sparse matrix-vector product, small.
+ *
+ * The partitioner is multilevel.  The graph is coarsened by heavy-edge
+ * matchings, computed in parallel by rounds in which every unmatched
+ * vertex proposes to its heaviest unmatched neighbor and mutual proposals
+ * are matched, until it has a few vertices per part.  The coarsest graph
+ * is split by recursive bisection, each bisection growing a breadth-first
+ * level structure from a pseudo-peripheral vertex.  The partition is then
+ * projected back level by level and improved on each level by parallel
+ * boundary refinement, which moves vertices to the neighboring part that
+ * reduces the edge cut most without exceeding the allowed part size.
+ * Successive refinement passes alternate the direction of the moves
+ * between parts, so that adjacent vertices do not swap their parts.
+ * Coarsening and refinement run in the memory space of \p A, only the
+ * coarsest graph is bisected on the host.
+ *
+ * The partition is represented by an array of parts in [0, num_parts).
+ * Specifically, <tt>parts[i]</tt> is the part of vertex \p i.  The entries
+ * of \p A define the edges, their values are ignored, and the diagonal is
+ * skipped.
+ *
+ * \param A symmetric matrix that represents a graph
+ * \param num_parts number of parts
+ * \param parts array to hold the parts
+ * \param imbalance allowed relative excess of the size of a part over
+ * <tt>A.num_rows / num_parts</tt>
+ * \return the number of edges between different parts
+ *
+ * \tparam Matrix matrix
+ * \tparam Array array
+ *
+ *  \throws cusp::invalid_input_exception if \p num_parts is zero.
+ *
+ *  \see http://en.wikipedia.org/wiki/Graph_partition
+ *  \see \p partition_permutation
+ */
+template <typename Matrix, typename Array>
+size_t partition(const Matrix& A, size_t num_parts, Array& parts, float imbalance = 0.03f);
+
+/*! \p partition_permutation : orders the vertices by part.  On return
+ * the vertices of part \p p are
+ * <tt>permutation[part_offsets[p]], ..., permutation[part_offsets[p + 1] - 1]</tt>
+ * in increasing order.  Permuting the matrix with \p cusp::permute makes
+ * each part a block of consecutive rows, and \p part_offsets are then the
+ * offsets of a \p cusp::distribution of the permuted matrix.  Empty parts
+ * after the last part that occurs in \p parts have no offsets.
+ *
+ * \param parts parts of the vertices, e.g. from \p partition
+ * \param permutation array to hold the vertices ordered by part
+ * \param part_offsets array to hold the offsets of the parts
+ *
+ * \tparam Array1 array
+ * \tparam Array2 array
+ * \tparam Array3 array
+ *
+ * \code
+ * #include <cusp/csr_matrix.h>
+ * #include <cusp/distributed_csr_matrix.h>
+ * #include <cusp/permute.h>
+ * #include <cusp/graph/partition.h>
+ *
+ * int main(void)
+ * {
+ *     cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *     ...
+ *     std::vector<int> devices(4);
+ *     for (int d = 0; d < 4; d++)
+ *         devices[d] = d;
+ *
+ *     cusp::array1d<int, cusp::device_memory> parts;
+ *     cusp::graph::partition(A, devices.size(), parts);
+ *
+ *     cusp::array1d<int, cusp::device_memory> permutation;
+ *     cusp::array1d<int, cusp::device_memory> offsets;
+ *     cusp::graph::partition_permutation(parts, permutation, offsets);
+ *
+ *     cusp::array1d<int, cusp::host_memory> h_offsets(offsets);
+ *
+ *     // one part per device
+ *     cusp::csr_matrix<int, float, cusp::host_memory> B;
+ *     cusp::permute(A, permutation, B);
+ *
+ *     cusp::distribution d(devices, std::vector<size_t>(h_offsets.begin(), h_offsets.end()));
+ *     cusp::distributed_csr_matrix<int, float, cusp::distributed_memory> D(B, d);
+ *
+ *     return 0;
+ * }
+ * \endcode
+ */
+template <typename Array1, typename Array2, typename Array3>
+void partition_permutation(const Array1& parts, Array2& permutation, Array3& part_offsets);
+
+/*! \}
+ */
+
+
+} // end namespace graph
+} // end namespace cusp
+
+#include <cusp/graph/detail/partition.inl>
@@ -0,0 +1,90 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file reverse_cuthill_mckee.h
+ *  \brief Reverse Cuthill-McKee ordering of a graph
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+namespace cusp
+{
+namespace graph
+{
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p reverse_cuthill_mckee : computes the reverse Cuthill-McKee (RCM)
+ * ordering of a graph, which reduces the bandwidth of the matrix.  Each
+ * connected component is traversed breadth-first from a pseudo-peripheral
+ * vertex, visiting the neighbors of a vertex in order of increasing
+ * degree, and the resulting order is reversed.  Ordering the rows of a
+ * matrix with a small bandwidth keeps the entries of \p x that nearby
+ * rows of a sparse matrix-vector product read close together.
+ *
+ * The ordering is represented by an array that lists the vertices in
+ * their new order.  Specifically, <tt>permutation[i]</tt> is the vertex
+ * that becomes vertex \p i, as expected by \p cusp::permute.  The ordering
+ * is computed on the host.
+ *
+ * \param A symmetric matrix that represents a graph
+ * \param permutation array to hold the ordering
+ *
+ * \tparam Matrix matrix
+ * \tparam Array array
+ *
+ * \code
+ * #include <cusp/csr_matrix.h>
+ * #include <cusp/permute.h>
+ * #include <cusp/io/matrix_market.h>
+ * #include <cusp/graph/reverse_cuthill_mckee.h>
+ *
+ * int main(void)
+ * {
+ *     cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *     cusp::io::read_matrix_market_file(A, "mesh.mtx");
+ *
+ *     // reorder the matrix once during setup
+ *     cusp::array1d<int, cusp::device_memory> permutation;
+ *     cusp::graph::reverse_cuthill_mckee(A, permutation);
+ *
+ *     cusp::csr_matrix<int, float, cusp::device_memory> B;
+ *     cusp::permute(A, permutation, B);
+ *
+ *     return 0;
+ * }
+ * \endcode
+ *
+ *  \see http://en.wikipedia.org/wiki/Cuthill-McKee_algorithm
+ *  \see \p nested_dissection
+ *  \see \p cusp::permute
+ */
+template <typename Matrix, typename Array>
+void reverse_cuthill_mckee(const Matrix& A, Array& permutation);
+
+/*! \}
+ */
+
+
+} // end namespace graph
+} // end namespace cusp
+
+#include <cusp/graph/detail/reverse_cuthill_mckee.inl>
@@ -0,0 +1,97 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file shortest_path.h
+ *  \brief Shortest paths from a vertex of a weighted graph
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace graph
+{
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p single_source_shortest_path : computes the length of a shortest
+ * path from a source vertex to every vertex of a weighted graph.  A
+ * stored entry <tt>G(i,j)</tt> is an edge from vertex \p i to vertex
+ * \p j of weight <tt>G(i,j)</tt>.  The distances are relaxed by rounds of
+ * a frontier Bellman-Ford method: the vertices whose distance decreased
+ * in a round form a sparse vector, whose product with \p G in the
+ * (+, min) semiring (see \p multiply_transpose with \p sparse_vector
+ * operands) yields the tentative distances of their out-neighbors, and a
+ * neighbor joins the next frontier when its distance decreases.  Each
+ * round costs only the edges of the frontier, as the top-down steps of
+ * \p breadth_first_search, and runs in the memory space of the matrix.
+ *
+ * Specifically, <tt>distances[i]</tt> is the length of a shortest path
+ * from \p src to vertex \p i, or
+ * <tt>std::numeric_limits<ValueType>::max()</tt> if \p i is unreachable
+ * from \p src.  With unit weights the distances are the levels of a
+ * breadth-first search.
+ *
+ * \param G matrix that represents a weighted directed graph
+ * \param src source vertex
+ * \param distances array to hold the distances
+ * \return the number of rounds
+ *
+ * \tparam Matrix matrix
+ * \tparam Array array
+ *
+ * \code
+ * #include <cusp/csr_matrix.h>
+ * #include <cusp/gallery/random.h>
+ * #include <cusp/graph/shortest_path.h>
+ *
+ * int main(void)
+ * {
+ *     cusp::csr_matrix<int, float, cusp::device_memory> G;
+ *     cusp::gallery::random(10000, 10000, 100000, G);
+ *
+ *     // distances from vertex 0
+ *     cusp::array1d<float, cusp::device_memory> distances;
+ *     cusp::graph::single_source_shortest_path(G, 0, distances);
+ *
+ *     return 0;
+ * }
+ * \endcode
+ *
+ * \throws cusp::invalid_input_exception if \p G is not square, \p src
+ *  is out of range or an edge has a negative weight
+ *
+ *  \see http://en.wikipedia.org/wiki/Bellman-Ford_algorithm
+ *  \see \p breadth_first_search
+ */
+template <typename Matrix, typename Array>
+size_t single_source_shortest_path(const Matrix& G, const size_t src, Array& distances);
+
+/*! \}
+ */
+
+
+} // end namespace graph
+} // end namespace cusp
+
+#include <cusp/graph/detail/shortest_path.inl>
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file vertex_coloring.h
+ *  \brief Vertex coloring of a graph
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+namespace cusp
+{
+namespace graph
+{
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p vertex_coloring : computes a distance-k coloring of a graph.  In a
+ * distance-k coloring no two vertices that are joined by a path of \p k
+ * edges or less have the same color, so a distance-1 coloring is the
+ * standard coloring and a distance-2 coloring is a coloring of the columns
+ * of the matrix (no two columns of a color have an entry in the same
+ * row).  The vertices of a color may therefore be processed in parallel,
+ * e.g. by multicolor Gauss-Seidel smoothers and parallel ILU.
+ *
+ * The coloring is represented by an array of colors in [0, num_colors).
+ * Specifically, <tt>colors[i]</tt> is the color of vertex \p i.  On the
+ * device each color is a maximal independent set of the remaining
+ * vertices, computed with the random priorities of
+ * \p maximal_independent_set (Luby/Jones-Plassmann), on the host the
+ * vertices are colored greedily in order.
+ *
+ * \param A symmetric matrix that represents a graph
+ * \param colors array to hold the colors
+ * \param k distance of the coloring
+ * \return the number of colors
+ *
+ * \tparam Matrix matrix
+ * \tparam Array array
+ *
+ *  \see http://en.wikipedia.org/wiki/Graph_coloring
+ *  \see \p maximal_independent_set
+ */
+template <typename Matrix, typename Array>
+size_t vertex_coloring(const Matrix& A, Array& colors, size_t k = 1);
+
+/*! \p coloring_permutation : orders the vertices by color.  On return
+ * the vertices of color \p c are
+ * <tt>permutation[color_offsets[c]], ..., permutation[color_offsets[c + 1] - 1]</tt>
+ * in increasing order, so that \p permutation lists the color classes one
+ * after the other.
+ *
+ * \param colors colors of the vertices, e.g. from \p vertex_coloring
+ * \param permutation array to hold the vertices ordered by color
+ * \param color_offsets array to hold the offsets of the color classes
+ *
+ * \tparam Array1 array
+ * \tparam Array2 array
+ * \tparam Array3 array
+ *
+ * \code
+ * #include <cusp/csr_matrix.h>
+ * #include <cusp/gallery/poisson.h>
+ * #include <cusp/graph/vertex_coloring.h>
+ *
+ * int main(void)
+ * {
+ *     cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *     cusp::gallery::poisson5pt(A, 100, 100);
+ *
+ *     cusp::array1d<int, cusp::device_memory> colors;
+ *     size_t num_colors = cusp::graph::vertex_coloring(A, colors);
+ *
+ *     // color classes
+ *     cusp::array1d<int, cusp::device_memory> permutation;
+ *     cusp::array1d<int, cusp::device_memory> color_offsets;
+ *     cusp::graph::coloring_permutation(colors, permutation, color_offsets);
+ *
+ *     return 0;
+ * }
+ * \endcode
+ */
+template <typename Array1, typename Array2, typename Array3>
+void coloring_permutation(const Array1& colors, Array2& permutation, Array3& color_offsets);
+
+/*! \}
+ */
+
+
+} // end namespace graph
+} // end namespace cusp
+
+#include <cusp/graph/detail/vertex_coloring.inl>
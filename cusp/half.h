@@ -0,0 +1,108 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file half.h
+ *  \brief Half precision storage types for matrix values
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+#include <cusp/detail/storage_cast.h>
+
+#include <cuda_runtime_api.h>
+#include <cuda_fp16.h>
+
+#if CUDART_VERSION >= 11000
+#include <cuda_bf16.h>
+#define CUSP_HAS_BFLOAT16
+#endif
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p half : IEEE 754 binary16 storage type for matrix values.
+ *
+ *  A matrix with \p half values may be multiplied with \p float or
+ *  \p double vectors.  The SpMV kernels of the \p csr_matrix,
+ *  \p ell_matrix, \p coo_matrix and \p hyb_matrix formats load each
+ *  value in half precision and accumulate in the value type of the
+ *  vectors, which halves the memory traffic for the matrix values.
+ *
+ *  \code
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/half.h>
+ *  #include <cusp/multiply.h>
+ *
+ *  // values rounded to half precision
+ *  cusp::csr_matrix<int, cusp::half, cusp::device_memory> A(B);
+ *
+ *  cusp::array1d<float, cusp::device_memory> x(A.num_cols, 1);
+ *  cusp::array1d<float, cusp::device_memory> y(A.num_rows);
+ *
+ *  cusp::multiply(A, x, y);
+ *  \endcode
+ *
+ *  \note Half precision arithmetic is not supported, so such matrices
+ *  are only used as operands of products and conversions.
+ */
+typedef __half half;
+
+#if defined(CUSP_HAS_BFLOAT16)
+/*! \p bfloat16 : bfloat16 storage type for matrix values, with the
+ *  exponent range of \p float.  It is used like \p half and requires
+ *  CUDA 11.
+ */
+typedef __nv_bfloat16 bfloat16;
+#endif
+
+/*! \}
+ */
+
+namespace detail
+{
+
+template <>
+struct storage_traits<__half>
+{
+    template <typename ValueType>
+    __host__ __device__
+    static ValueType convert(const __half& value)
+    {
+        return ValueType(__half2float(value));
+    }
+};
+
+#if defined(CUSP_HAS_BFLOAT16)
+template <>
+struct storage_traits<__nv_bfloat16>
+{
+    template <typename ValueType>
+    __host__ __device__
+    static ValueType convert(const __nv_bfloat16& value)
+    {
+        return ValueType(__bfloat162float(value));
+    }
+};
+#endif
+
+} // end namespace detail
+} // end namespace cusp
+
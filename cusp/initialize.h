@@ -0,0 +1,174 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file initialize.h
+ *  \brief Early initialization of the device and warmup of kernels
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+#include <cusp/detail/thread.h>
+
+#include <string>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! Kernels that \p initialize loads ahead of their first use, combined
+ *  with bitwise or.  Each format names the kernels of \p cusp::multiply
+ *  for matrices in that format, both for small matrices and for matrices
+ *  that fill the device.
+ */
+enum warmup_kernels
+{
+    warmup_none = 0,
+    warmup_csr  = 1,
+    warmup_coo  = 2,
+    warmup_ell  = 4,
+    warmup_hyb  = 8,
+    warmup_dia  = 16,
+    warmup_blas = 32,    //!< the level 1 BLAS used by the Krylov solvers
+    warmup_all  = 63
+};
+
+/*! Timings of \p initialize, in seconds of host wall-clock time.
+ */
+struct initialize_report
+{
+    double context_seconds;          //!< creation of the context on the device
+    double first_multiply_seconds;   //!< first product, including the loading of its kernels (0 without a format)
+    double warmup_seconds;           //!< all warmed kernels, including the first product
+
+    /*! time from the start of \p initialize until the first product completed
+     */
+    double time_to_first_multiply(void) const
+    {
+        return context_seconds + first_multiply_seconds;
+    }
+};
+
+/*! \p initialize : create the context on the current device and load the
+ *  chosen kernels for the given index and value types.
+ *
+ *  The runtime creates the context, loads the modules of the kernels
+ *  and queries the occupancy of each kernel the first time they are
+ *  used, which dominates the run time of short jobs.  \p initialize does
+ *  this work up front with a product of a small and of a large matrix
+ *  in every chosen format, so that it can be measured and kept out of
+ *  the timings of the solve.  The occupancy results are cached per
+ *  kernel and device for the lifetime of the process.
+ *
+ *  The kernels run on a stream of their own and do not wait for the
+ *  work of other streams.  Use \p initializer to warm the kernels in the
+ *  background while the host reads the input.
+ *
+ *  \tparam IndexType index type of the matrices that will be multiplied
+ *  \tparam ValueType value type of the matrices that will be multiplied
+ *  \param kernels bitwise or of \p warmup_kernels
+ *  \return the timings of the initialization
+ *
+ *  \throws cusp::runtime_exception if the context cannot be created
+ *
+ *  \code
+ *  #include <cusp/initialize.h>
+ *  #include <cstdio>
+ *
+ *  int main(void)
+ *  {
+ *      cusp::initialize_report report =
+ *          cusp::initialize<int,double>(cusp::warmup_csr | cusp::warmup_blas);
+ *
+ *      std::printf("first SpMV after %f s\n", report.time_to_first_multiply());
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType>
+initialize_report initialize(unsigned int kernels = warmup_csr);
+
+/*! \p initializer : run \p initialize on a host thread of its own.
+ *
+ *  The thread initializes the device that is current when the object
+ *  is constructed.  Calls of the library by other threads meanwhile are
+ *  correct, they wait for the context to be created.  The destructor
+ *  waits for the thread to finish.
+ *
+ *  \code
+ *  #include <cusp/initialize.h>
+ *  #include <cusp/io/matrix_market.h>
+ *  #include <cusp/csr_matrix.h>
+ *
+ *  int main(void)
+ *  {
+ *      // warm the kernels while the matrix is read
+ *      cusp::initializer<int,double> init(cusp::warmup_csr | cusp::warmup_blas);
+ *
+ *      cusp::csr_matrix<int,double,cusp::host_memory> A;
+ *      cusp::io::read_matrix_market_file(A, "A.mtx");
+ *
+ *      cusp::initialize_report report = init.wait();
+ *
+ *      // ...
+ *  }
+ *  \endcode
+ */
+template <typename IndexType = int, typename ValueType = float>
+class initializer
+{
+    public:
+
+    /*! start the initialization of the current device
+     *  \param kernels bitwise or of \p warmup_kernels
+     */
+    explicit initializer(unsigned int kernels = warmup_csr);
+
+    /*! wait for the initialization to finish
+     */
+    ~initializer(void);
+
+    /*! wait for the initialization to finish and return its timings
+     *
+     *  \throws cusp::runtime_exception if the initialization failed
+     */
+    const initialize_report& wait(void);
+
+    private:
+    unsigned int kernels;
+    int device;
+    initialize_report report;
+    bool failed;
+    std::string error;
+    cusp::detail::host_thread * thread;
+
+    static void execute(void * self);
+
+    // not copyable
+    initializer(const initializer&);
+    initializer& operator=(const initializer&);
+};
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/initialize.inl>
@@ -0,0 +1,150 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file binary.h
+ *  \brief Binary file I/O of matrices and arrays
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace cusp
+{
+namespace io
+{
+
+/*! \addtogroup input_output Input/Output
+ *  \addtogroup binary Binary
+ *  \ingroup input_output
+ *  \{
+ */
+
+/*! \p write_binary_file : Write a matrix or array in the Cusp binary
+ *  format.
+ *
+ *  The file holds a versioned header with the shape, the format and the
+ *  index and value types of the container, followed by the raw arrays
+ *  of the container, each aligned to 4096 bytes.  \p array1d,
+ *  \p coo_matrix, \p csr_matrix, \p dia_matrix, \p ell_matrix and
+ *  \p hyb_matrix are stored as they are, other sparse formats are
+ *  stored as a \p csr_matrix.  Files are written in the byte order of
+ *  the host and are not portable across byte orders.
+ *
+ * \param mtx a matrix or array container in host or device memory
+ * \param filename file name of the binary file
+ * \tparam Matrix matrix container
+ *
+ * \note if the file already exists it will be overwritten
+ *
+ * \code
+ * #include <cusp/io/binary.h>
+ * #include <cusp/csr_matrix.h>
+ * #include <cusp/gallery/poisson.h>
+ *
+ * int main(void)
+ * {
+ *     cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *     cusp::gallery::poisson5pt(A, 1000, 1000);
+ *
+ *     cusp::io::write_binary_file(A, "A.cusp");
+ *
+ *     // load the arrays straight into device memory
+ *     cusp::csr_matrix<int, float, cusp::device_memory> B;
+ *     cusp::io::read_binary_file(B, "A.cusp");
+ *
+ *     return 0;
+ * }
+ * \endcode
+ *
+ * \see \p read_binary_file
+ */
+template <typename Matrix>
+void write_binary_file(const Matrix& mtx, const std::string& filename);
+
+/*! \p read_binary_file : Read a file in the Cusp binary format.
+ *
+ *  A container of the format of the file is filled without conversion:
+ *  host arrays are copied from a memory mapping of the file, device
+ *  arrays are streamed through pinned host buffers so that reading the
+ *  file overlaps the transfers, which are issued on the current stream.
+ *  Containers of other formats are converted from the format of the
+ *  file.  The index and value types of \p mtx must match those of the
+ *  file.  gzip and zstd-compressed files are decompressed while they are
+ *  read, which requires \c CUSP_USE_ZLIB or \c CUSP_USE_ZSTD.
+ *
+ * \param mtx a matrix or array container
+ * \param filename file name of the binary file
+ * \tparam Matrix matrix container
+ *
+ * \note any contents of \p mtx will be overwritten
+ *
+ * \see \p write_binary_file
+ */
+template <typename Matrix>
+void read_binary_file(Matrix& mtx, const std::string& filename);
+
+/*! \p write_binary_stream : Write a matrix or array in the Cusp binary
+ *  format to a stream.
+ *
+ *  The layout is that of \p write_binary_file, with the offsets taken
+ *  relative to the position of the stream when the container is
+ *  written, so several containers may be written one after another.
+ *  The stream must be seekable (e.g. a \c std::ofstream opened in
+ *  binary mode or a \c std::stringstream), since the header is
+ *  completed after the arrays are written.
+ *
+ * \param mtx a matrix or array container in host or device memory
+ * \param output binary stream to which the container is written
+ * \tparam Matrix matrix container
+ *
+ * \throws cusp::io_exception if the stream is not seekable or a write fails
+ *
+ * \see \p read_binary_stream
+ */
+template <typename Matrix>
+void write_binary_stream(const Matrix& mtx, std::ostream& output);
+
+/*! \p read_binary_stream : Read a container written by
+ *  \p write_binary_stream from a stream.
+ *
+ *  The stream is read sequentially and is left at the end of the
+ *  container, where the next container of the stream begins.  Formats
+ *  and types are handled as in \p read_binary_file.
+ *
+ * \param mtx a matrix or array container
+ * \param input binary stream from which the container is read
+ * \tparam Matrix matrix container
+ *
+ * \note any contents of \p mtx will be overwritten
+ *
+ * \see \p write_binary_stream
+ */
+template <typename Matrix>
+void read_binary_stream(Matrix& mtx, std::istream& input);
+
+/*! \}
+ */
+
+} //end namespace io
+} //end namespace cusp
+
+#include <cusp/io/detail/binary.inl>
@@ -0,0 +1,838 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/complex.h>
+#include <cusp/convert.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/format.h>
+#include <cusp/hyb_matrix.h>
+
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+#include <cusp/io/detail/compression.h>
+
+#include <thrust/detail/type_traits.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CUSP_IO_BINARY_MMAP
+#endif
+
+namespace cusp
+{
+namespace io
+{
+namespace detail
+{
+
+// Layout of a binary file: a binary_header, which lists the offset and
+// the size in bytes of each array of the container, followed by the
+// arrays at offsets that are multiples of BINARY_ALIGNMENT.  A reader
+// rejects files of other versions.
+
+typedef unsigned long long binary_size;
+
+const char         BINARY_MAGIC[8]   = {'C', 'U', 'S', 'P', 'B', 'I', 'N', '\0'};
+const unsigned int BINARY_VERSION    = 1;
+const binary_size  BINARY_ALIGNMENT  = 4096;
+const size_t       BINARY_MAX_ARRAYS = 8;
+
+// pinned host buffers of device transfers
+const size_t BINARY_STAGING_SIZE = 1 << 23;
+
+enum binary_format
+{
+    BINARY_ARRAY1D = 1,
+    BINARY_COO     = 2,
+    BINARY_CSR     = 3,
+    BINARY_DIA     = 4,
+    BINARY_ELL     = 5,
+    BINARY_HYB     = 6
+};
+
+enum binary_kind
+{
+    BINARY_OTHER    = 0,
+    BINARY_SIGNED   = 1,
+    BINARY_UNSIGNED = 2,
+    BINARY_FLOAT    = 3,
+    BINARY_COMPLEX  = 4
+};
+
+template <typename T> struct binary_type                        { static const unsigned int kind = BINARY_OTHER;    };
+template <>           struct binary_type<int>                   { static const unsigned int kind = BINARY_SIGNED;   };
+template <>           struct binary_type<long>                  { static const unsigned int kind = BINARY_SIGNED;   };
+template <>           struct binary_type<long long>             { static const unsigned int kind = BINARY_SIGNED;   };
+template <>           struct binary_type<unsigned int>          { static const unsigned int kind = BINARY_UNSIGNED; };
+template <>           struct binary_type<unsigned long>         { static const unsigned int kind = BINARY_UNSIGNED; };
+template <>           struct binary_type<unsigned long long>    { static const unsigned int kind = BINARY_UNSIGNED; };
+template <>           struct binary_type<float>                 { static const unsigned int kind = BINARY_FLOAT;    };
+template <>           struct binary_type<double>                { static const unsigned int kind = BINARY_FLOAT;    };
+template <>           struct binary_type<cusp::complex<float> > { static const unsigned int kind = BINARY_COMPLEX;  };
+template <>           struct binary_type<cusp::complex<double> >{ static const unsigned int kind = BINARY_COMPLEX;  };
+
+struct binary_header
+{
+    char         magic[8];
+    unsigned int version;
+    unsigned int format;
+    unsigned int index_kind;
+    unsigned int index_size;
+    unsigned int value_kind;
+    unsigned int value_size;
+
+    binary_size  num_rows;
+    binary_size  num_cols;
+    binary_size  num_entries;
+
+    // ELL and HYB: entries per row and pitch, DIA: diagonals and pitch,
+    // HYB: number of ELL and COO entries
+    binary_size  params[4];
+
+    binary_size  num_arrays;
+    binary_size  offsets[BINARY_MAX_ARRAYS];
+    binary_size  sizes[BINARY_MAX_ARRAYS];
+};
+
+template <typename IndexType, typename ValueType>
+binary_header make_binary_header(const binary_format format,
+                                 const size_t num_rows, const size_t num_cols, const size_t num_entries)
+{
+    binary_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+
+    header.version     = BINARY_VERSION;
+    header.format      = format;
+    header.index_kind  = binary_type<IndexType>::kind;
+    header.index_size  = sizeof(IndexType);
+    header.value_kind  = binary_type<ValueType>::kind;
+    header.value_size  = sizeof(ValueType);
+    header.num_rows    = num_rows;
+    header.num_cols    = num_cols;
+    header.num_entries = num_entries;
+
+    return header;
+}
+
+class binary_writer
+{
+    public:
+    binary_writer(const std::string& filename, const binary_header& header)
+        : header(header), stream(0), position(sizeof(binary_header))
+    {
+        file = std::fopen(filename.c_str(), "wb");
+
+        if (!file)
+            throw cusp::io_exception(std::string("unable to open file \"") + filename + std::string("\" for writing"));
+
+        // the header is written last, once the offsets are known
+        write_bytes(&this->header, sizeof(binary_header), cusp::host_memory());
+    }
+
+    // the offsets are relative to the current position of the stream,
+    // which must be seekable to rewrite the header
+    binary_writer(std::ostream& output, const binary_header& header)
+        : header(header), file(0), stream(&output), start(output.tellp()), position(sizeof(binary_header))
+    {
+        if (start == std::streampos(-1))
+            throw cusp::io_exception("binary streams must be seekable");
+
+        write_bytes(&this->header, sizeof(binary_header), cusp::host_memory());
+    }
+
+    ~binary_writer(void)
+    {
+        if (file)
+            std::fclose(file);
+    }
+
+    template <typename Array>
+    void write(const Array& a)
+    {
+        typedef typename Array::value_type T;
+
+        if (header.num_arrays == BINARY_MAX_ARRAYS)
+            throw cusp::io_exception("too many arrays for a binary file");
+
+        // pad to the next aligned offset
+        const binary_size offset = ((position + BINARY_ALIGNMENT - 1) / BINARY_ALIGNMENT) * BINARY_ALIGNMENT;
+        const std::vector<char> padding(offset - position, 0);
+
+        if (!padding.empty())
+            write_bytes(&padding[0], padding.size(), cusp::host_memory());
+
+        const size_t bytes = a.size() * sizeof(T);
+
+        header.offsets[header.num_arrays] = offset;
+        header.sizes[header.num_arrays]   = bytes;
+        header.num_arrays++;
+
+        if (bytes > 0)
+            write_bytes(thrust::raw_pointer_cast(&a[0]), bytes, typename Array::memory_space());
+
+        position = offset + bytes;
+    }
+
+    void close(void)
+    {
+        if (stream)
+        {
+            const std::streampos end = stream->tellp();
+
+            stream->seekp(start);
+            write_bytes(&header, sizeof(binary_header), cusp::host_memory());
+            stream->seekp(end);
+
+            if (!*stream)
+                fail();
+
+            stream = 0;
+            return;
+        }
+
+        if (std::fseek(file, 0, SEEK_SET) != 0 ||
+            std::fwrite(&header, sizeof(binary_header), 1, file) != 1)
+            fail();
+
+        const int status = std::fclose(file);
+        file = 0;
+
+        if (status != 0)
+            throw cusp::io_exception("unable to write binary file");
+    }
+
+    binary_header header;
+
+    private:
+    std::FILE * file;
+    std::ostream * stream;
+    std::streampos start;
+    binary_size position;
+
+    void fail(void)
+    {
+        throw cusp::io_exception("unable to write binary file");
+    }
+
+    void write_bytes(const void * data, const size_t bytes, cusp::host_memory)
+    {
+        if (stream)
+        {
+            if (!stream->write(static_cast<const char *>(data), bytes))
+                fail();
+        }
+        else if (std::fwrite(data, 1, bytes, file) != bytes)
+        {
+            fail();
+        }
+    }
+
+    // stage device arrays in pinned memory, writing one buffer while the
+    // next one is copied from the device
+    void write_bytes(const void * data, const size_t bytes, cusp::device_memory)
+    {
+        const cudaStream_t stream = cusp::detail::current_stream();
+
+        char * staging[2] = {0, 0};
+        cudaEvent_t copied[2] = {0, 0};
+
+        try
+        {
+            for (int k = 0; k < 2; k++)
+            {
+                cusp::detail::check_cuda(cudaMallocHost((void **) &staging[k], BINARY_STAGING_SIZE), "cudaMallocHost failed");
+                cusp::detail::check_cuda(cudaEventCreateWithFlags(&copied[k], cudaEventDisableTiming), "cudaEventCreate failed");
+            }
+
+            const char * source = static_cast<const char *>(data);
+            const size_t num_chunks = (bytes + BINARY_STAGING_SIZE - 1) / BINARY_STAGING_SIZE;
+
+            for (size_t n = 0; n <= num_chunks; n++)
+            {
+                if (n < num_chunks)
+                {
+                    const size_t size = std::min(BINARY_STAGING_SIZE, bytes - n * BINARY_STAGING_SIZE);
+
+                    cudaMemcpyAsync(staging[n % 2], source + n * BINARY_STAGING_SIZE, size, cudaMemcpyDeviceToHost, stream);
+                    cudaEventRecord(copied[n % 2], stream);
+                }
+
+                if (n > 0)
+                {
+                    const size_t size = std::min(BINARY_STAGING_SIZE, bytes - (n - 1) * BINARY_STAGING_SIZE);
+
+                    cusp::detail::check_cuda(cudaEventSynchronize(copied[(n - 1) % 2]), "device to host copy failed");
+                    write_bytes(staging[(n - 1) % 2], size, cusp::host_memory());
+                }
+            }
+        }
+        catch (...)
+        {
+            release_staging(staging, copied);
+            throw;
+        }
+
+        release_staging(staging, copied);
+    }
+
+    static void release_staging(char * staging[2], cudaEvent_t copied[2])
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            if (copied[k])
+            {
+                cudaEventSynchronize(copied[k]);
+                cudaEventDestroy(copied[k]);
+            }
+
+            if (staging[k])
+                cudaFreeHost(staging[k]);
+        }
+    }
+};
+
+class binary_reader
+{
+    public:
+    explicit binary_reader(const std::string& filename)
+        : file(0), map(0), map_size(0), stream(0), owns_stream(false), position(0)
+    {
+        decompressor * source = open_decompressor(filename);
+
+        // compressed files are read sequentially
+        if (source)
+        {
+            stream = new decompressing_streambuf(source);
+            owns_stream = true;
+
+            try
+            {
+                read_bytes(0, &header, sizeof(binary_header), cusp::host_memory());
+                check_header();
+            }
+            catch (...)
+            {
+                delete stream;
+                throw;
+            }
+
+            return;
+        }
+
+        file = std::fopen(filename.c_str(), "rb");
+
+        if (!file)
+            throw cusp::io_exception(std::string("unable to open file \"") + filename + std::string("\" for reading"));
+
+        try
+        {
+            if (std::fread(&header, sizeof(binary_header), 1, file) != 1)
+                throw cusp::io_exception("invalid binary file");
+
+            check_header();
+        }
+        catch (...)
+        {
+            std::fclose(file);
+            throw;
+        }
+
+#if defined(CUSP_IO_BINARY_MMAP)
+        struct stat status;
+
+        if (fstat(fileno(file), &status) == 0 && status.st_size > 0)
+        {
+            void * address = mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+
+            if (address != MAP_FAILED)
+            {
+                map      = static_cast<const char *>(address);
+                map_size = status.st_size;
+
+                madvise(address, map_size, MADV_SEQUENTIAL);
+            }
+        }
+#endif
+    }
+
+    // read sequentially from the current position of a stream, the
+    // offsets are relative to that position
+    explicit binary_reader(std::istream& input)
+        : file(0), map(0), map_size(0), stream(input.rdbuf()), owns_stream(false), position(0)
+    {
+        read_bytes(0, &header, sizeof(binary_header), cusp::host_memory());
+        check_header();
+    }
+
+    ~binary_reader(void)
+    {
+        if (stream)
+        {
+            if (owns_stream)
+                delete stream;
+            return;
+        }
+
+#if defined(CUSP_IO_BINARY_MMAP)
+        if (map)
+            munmap(const_cast<char *>(map), map_size);
+#endif
+        std::fclose(file);
+    }
+
+    const binary_header& get_header(void) const { return header; }
+
+    template <typename IndexType, typename ValueType>
+    void check_types(void) const
+    {
+        if (header.index_kind != binary_type<IndexType>::kind || header.index_size != sizeof(IndexType))
+            throw cusp::io_exception("index type of the binary file does not match");
+
+        if (header.value_kind != binary_type<ValueType>::kind || header.value_size != sizeof(ValueType))
+            throw cusp::io_exception("value type of the binary file does not match");
+    }
+
+    // fill array k of the file into a, which has the size of the array
+    template <typename Array>
+    void read(const size_t k, Array& a)
+    {
+        typedef typename Array::value_type T;
+
+        if (k >= header.num_arrays || header.sizes[k] != a.size() * sizeof(T))
+            throw cusp::io_exception("invalid binary file");
+
+        if (a.size() > 0)
+            read_bytes(header.offsets[k], thrust::raw_pointer_cast(&a[0]), header.sizes[k], typename Array::memory_space());
+    }
+
+    // skip the padding of the arrays that were not read, so that a stream
+    // is left at the end of the container
+    void finish(void)
+    {
+        binary_size end = sizeof(binary_header);
+
+        for (size_t k = 0; k < header.num_arrays; k++)
+            end = std::max(end, header.offsets[k] + header.sizes[k]);
+
+        if (stream)
+            skip_to(end);
+    }
+
+    private:
+    binary_header header;
+    std::FILE * file;
+    const char * map;
+    size_t map_size;
+
+    // sequential input (decompressed contents or a stream) and the
+    // offset of the next byte
+    std::streambuf * stream;
+    bool owns_stream;
+    binary_size position;
+
+    void skip_to(const binary_size offset)
+    {
+        // the arrays are read in order
+        if (offset < position)
+            throw cusp::io_exception("invalid binary file");
+
+        for (; position < offset; position++)
+            if (stream->sbumpc() == std::char_traits<char>::eof())
+                throw cusp::io_exception("unexpected end of binary file");
+    }
+
+    void check_header(void) const
+    {
+        if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+            throw cusp::io_exception("invalid binary file");
+
+        if (header.version != BINARY_VERSION)
+            throw cusp::io_exception("unsupported binary file version");
+
+        if (header.num_arrays > BINARY_MAX_ARRAYS)
+            throw cusp::io_exception("invalid binary file");
+    }
+
+    void read_bytes(const binary_size offset, void * data, const size_t bytes, cusp::host_memory)
+    {
+        if (stream)
+        {
+            // skip the padding up to the array
+            skip_to(offset);
+
+            if (size_t(stream->sgetn(static_cast<char *>(data), bytes)) != bytes)
+                throw cusp::io_exception("unexpected end of binary file");
+
+            position += bytes;
+        }
+        else if (map)
+        {
+            if (offset + bytes > map_size)
+                throw cusp::io_exception("unexpected end of binary file");
+
+            std::memcpy(data, map + offset, bytes);
+        }
+        else
+        {
+            if (std::fseek(file, long(offset), SEEK_SET) != 0 || std::fread(data, 1, bytes, file) != bytes)
+                throw cusp::io_exception("unexpected end of binary file");
+        }
+    }
+
+    // stream through pinned buffers, reading one buffer while the other
+    // one is copied to the device
+    void read_bytes(const binary_size offset, void * data, const size_t bytes, cusp::device_memory)
+    {
+        const cudaStream_t stream = cusp::detail::current_stream();
+
+        char * staging[2] = {0, 0};
+        cudaEvent_t copied[2] = {0, 0};
+
+        try
+        {
+            for (int k = 0; k < 2; k++)
+            {
+                cusp::detail::check_cuda(cudaMallocHost((void **) &staging[k], BINARY_STAGING_SIZE), "cudaMallocHost failed");
+                cusp::detail::check_cuda(cudaEventCreateWithFlags(&copied[k], cudaEventDisableTiming), "cudaEventCreate failed");
+            }
+
+            char * destination = static_cast<char *>(data);
+
+            for (size_t n = 0; n * BINARY_STAGING_SIZE < bytes; n++)
+            {
+                const size_t position = n * BINARY_STAGING_SIZE;
+                const size_t size = std::min(BINARY_STAGING_SIZE, bytes - position);
+
+                // the previous copy out of this buffer is complete
+                cusp::detail::check_cuda(cudaEventSynchronize(copied[n % 2]), "host to device copy failed");
+
+                read_bytes(offset + position, staging[n % 2], size, cusp::host_memory());
+
+                cudaMemcpyAsync(destination + position, staging[n % 2], size, cudaMemcpyHostToDevice, stream);
+                cudaEventRecord(copied[n % 2], stream);
+            }
+        }
+        catch (...)
+        {
+            release_staging(staging, copied);
+            throw;
+        }
+
+        release_staging(staging, copied);
+    }
+
+    static void release_staging(char * staging[2], cudaEvent_t copied[2])
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            if (copied[k])
+            {
+                cudaEventSynchronize(copied[k]);
+                cudaEventDestroy(copied[k]);
+            }
+
+            if (staging[k])
+                cudaFreeHost(staging[k]);
+        }
+    }
+};
+
+////////////
+// Writes //
+////////////
+
+template <typename Matrix, typename Target>
+void write_binary(const Matrix& mtx, Target& target, cusp::array1d_format)
+{
+    binary_writer writer(target, make_binary_header<int, typename Matrix::value_type>(BINARY_ARRAY1D, mtx.size(), 1, mtx.size()));
+    writer.write(mtx);
+    writer.close();
+}
+
+template <typename Matrix, typename Target>
+void write_binary(const Matrix& mtx, Target& target, cusp::coo_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    binary_writer writer(target, make_binary_header<IndexType,ValueType>(BINARY_COO, mtx.num_rows, mtx.num_cols, mtx.num_entries));
+    writer.write(mtx.row_indices);
+    writer.write(mtx.column_indices);
+    writer.write(mtx.values);
+    writer.close();
+}
+
+template <typename Matrix, typename Target>
+void write_binary(const Matrix& mtx, Target& target, cusp::csr_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    binary_writer writer(target, make_binary_header<IndexType,ValueType>(BINARY_CSR, mtx.num_rows, mtx.num_cols, mtx.num_entries));
+    writer.write(mtx.row_offsets);
+    writer.write(mtx.column_indices);
+    writer.write(mtx.values);
+    writer.close();
+}
+
+template <typename Matrix, typename Target>
+void write_binary(const Matrix& mtx, Target& target, cusp::dia_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    binary_writer writer(target, make_binary_header<IndexType,ValueType>(BINARY_DIA, mtx.num_rows, mtx.num_cols, mtx.num_entries));
+    writer.header.params[0] = mtx.values.num_cols;
+    writer.header.params[1] = mtx.values.pitch;
+    writer.write(mtx.diagonal_offsets);
+    writer.write(mtx.values.values);
+    writer.close();
+}
+
+template <typename Matrix, typename Target>
+void write_binary(const Matrix& mtx, Target& target, cusp::ell_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    binary_writer writer(target, make_binary_header<IndexType,ValueType>(BINARY_ELL, mtx.num_rows, mtx.num_cols, mtx.num_entries));
+    writer.header.params[0] = mtx.column_indices.num_cols;
+    writer.header.params[1] = mtx.column_indices.pitch;
+    writer.write(mtx.column_indices.values);
+    writer.write(mtx.values.values);
+    writer.close();
+}
+
+template <typename Matrix, typename Target>
+void write_binary(const Matrix& mtx, Target& target, cusp::hyb_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    binary_writer writer(target, make_binary_header<IndexType,ValueType>(BINARY_HYB, mtx.num_rows, mtx.num_cols, mtx.num_entries));
+    writer.header.params[0] = mtx.ell.column_indices.num_cols;
+    writer.header.params[1] = mtx.ell.column_indices.pitch;
+    writer.header.params[2] = mtx.ell.num_entries;
+    writer.header.params[3] = mtx.coo.num_entries;
+    writer.write(mtx.ell.column_indices.values);
+    writer.write(mtx.ell.values.values);
+    writer.write(mtx.coo.row_indices);
+    writer.write(mtx.coo.column_indices);
+    writer.write(mtx.coo.values);
+    writer.close();
+}
+
+// other sparse formats are stored as CSR
+template <typename Matrix, typename Target>
+void write_binary(const Matrix& mtx, Target& target, cusp::sparse_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> csr(mtx);
+
+    write_binary(csr, target, cusp::csr_format());
+}
+
+///////////
+// Reads //
+///////////
+
+template <typename Matrix>
+void read_binary(binary_reader& reader, Matrix& mtx, cusp::array1d_format)
+{
+    const binary_header& header = reader.get_header();
+
+    if (header.format != BINARY_ARRAY1D)
+        throw cusp::io_exception("binary file does not hold an array1d");
+
+    reader.check_types<int, typename Matrix::value_type>();
+
+    mtx.resize(header.num_entries);
+    reader.read(0, mtx);
+}
+
+template <typename Matrix>
+void read_binary(binary_reader& reader, Matrix& mtx, cusp::coo_format)
+{
+    const binary_header& header = reader.get_header();
+
+    mtx.resize(header.num_rows, header.num_cols, header.num_entries);
+    reader.read(0, mtx.row_indices);
+    reader.read(1, mtx.column_indices);
+    reader.read(2, mtx.values);
+}
+
+template <typename Matrix>
+void read_binary(binary_reader& reader, Matrix& mtx, cusp::csr_format)
+{
+    const binary_header& header = reader.get_header();
+
+    mtx.resize(header.num_rows, header.num_cols, header.num_entries);
+    reader.read(0, mtx.row_offsets);
+    reader.read(1, mtx.column_indices);
+    reader.read(2, mtx.values);
+}
+
+template <typename Matrix>
+void read_binary(binary_reader& reader, Matrix& mtx, cusp::dia_format)
+{
+    const binary_header& header = reader.get_header();
+
+    mtx.resize(header.num_rows, header.num_cols, header.num_entries, header.params[0]);
+    mtx.values.resize(header.num_rows, header.params[0], header.params[1]);
+    reader.read(0, mtx.diagonal_offsets);
+    reader.read(1, mtx.values.values);
+}
+
+template <typename Matrix>
+void read_binary(binary_reader& reader, Matrix& mtx, cusp::ell_format)
+{
+    const binary_header& header = reader.get_header();
+
+    mtx.resize(header.num_rows, header.num_cols, header.num_entries, header.params[0]);
+    mtx.column_indices.resize(header.num_rows, header.params[0], header.params[1]);
+    mtx.values.resize(header.num_rows, header.params[0], header.params[1]);
+    reader.read(0, mtx.column_indices.values);
+    reader.read(1, mtx.values.values);
+}
+
+template <typename Matrix>
+void read_binary(binary_reader& reader, Matrix& mtx, cusp::hyb_format)
+{
+    const binary_header& header = reader.get_header();
+
+    mtx.resize(header.num_rows, header.num_cols, header.params[2], header.params[3], header.params[0]);
+    mtx.ell.column_indices.resize(header.num_rows, header.params[0], header.params[1]);
+    mtx.ell.values.resize(header.num_rows, header.params[0], header.params[1]);
+    reader.read(0, mtx.ell.column_indices.values);
+    reader.read(1, mtx.ell.values.values);
+    reader.read(2, mtx.coo.row_indices);
+    reader.read(3, mtx.coo.column_indices);
+    reader.read(4, mtx.coo.values);
+}
+
+template <typename Format>
+binary_format binary_format_of(Format)        { return binary_format(0); }
+inline binary_format binary_format_of(cusp::coo_format) { return BINARY_COO; }
+inline binary_format binary_format_of(cusp::csr_format) { return BINARY_CSR; }
+inline binary_format binary_format_of(cusp::dia_format) { return BINARY_DIA; }
+inline binary_format binary_format_of(cusp::ell_format) { return BINARY_ELL; }
+inline binary_format binary_format_of(cusp::hyb_format) { return BINARY_HYB; }
+
+// read into a host container of the format of the file and convert
+template <typename IndexType, typename ValueType, typename Matrix>
+void read_binary_and_convert(binary_reader& reader, Matrix& mtx)
+{
+    switch (reader.get_header().format)
+    {
+        case BINARY_COO: { cusp::coo_matrix<IndexType,ValueType,cusp::host_memory> A; read_binary(reader, A, cusp::coo_format()); cusp::convert(A, mtx); break; }
+        case BINARY_CSR: { cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> A; read_binary(reader, A, cusp::csr_format()); cusp::convert(A, mtx); break; }
+        case BINARY_DIA: { cusp::dia_matrix<IndexType,ValueType,cusp::host_memory> A; read_binary(reader, A, cusp::dia_format()); cusp::convert(A, mtx); break; }
+        case BINARY_ELL: { cusp::ell_matrix<IndexType,ValueType,cusp::host_memory> A; read_binary(reader, A, cusp::ell_format()); cusp::convert(A, mtx); break; }
+        case BINARY_HYB: { cusp::hyb_matrix<IndexType,ValueType,cusp::host_memory> A; read_binary(reader, A, cusp::hyb_format()); cusp::convert(A, mtx); break; }
+        default:
+            throw cusp::io_exception("binary file does not hold a sparse matrix");
+    }
+}
+
+// formats without a layout of their own are converted
+template <typename Matrix>
+void read_binary(binary_reader& reader, Matrix& mtx, cusp::sparse_format)
+{
+    read_binary_and_convert<typename Matrix::index_type, typename Matrix::value_type>(reader, mtx);
+}
+
+template <typename Matrix, typename Format>
+void read_binary(binary_reader& reader, Matrix& mtx, Format format, cusp::sparse_format)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    reader.check_types<IndexType,ValueType>();
+
+    if (reader.get_header().format == binary_format_of(format))
+        read_binary(reader, mtx, format);
+    else
+        read_binary_and_convert<IndexType,ValueType>(reader, mtx);
+}
+
+template <typename Matrix, typename Format>
+void read_binary(binary_reader& reader, Matrix& mtx, Format format, cusp::dense_format)
+{
+    read_binary(reader, mtx, format);
+}
+
+} // end namespace detail
+
+template <typename Matrix>
+void write_binary_file(const Matrix& mtx, const std::string& filename)
+{
+    cusp::io::detail::write_binary(mtx, filename, typename Matrix::format());
+}
+
+template <typename Matrix>
+void read_binary_file(Matrix& mtx, const std::string& filename)
+{
+    typedef typename Matrix::format Format;
+
+    cusp::io::detail::binary_reader reader(filename);
+
+    cusp::io::detail::read_binary(reader, mtx, Format(), Format());
+}
+
+template <typename Matrix>
+void write_binary_stream(const Matrix& mtx, std::ostream& output)
+{
+    cusp::io::detail::write_binary(mtx, output, typename Matrix::format());
+}
+
+template <typename Matrix>
+void read_binary_stream(Matrix& mtx, std::istream& input)
+{
+    typedef typename Matrix::format Format;
+
+    cusp::io::detail::binary_reader reader(input);
+
+    cusp::io::detail::read_binary(reader, mtx, Format(), Format());
+
+    reader.finish();
+}
+
+} // end namespace io
+} // end namespace cusp
+
+#undef CUSP_IO_BINARY_MMAP
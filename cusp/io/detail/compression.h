@@ -0,0 +1,461 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/exception.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#if defined(CUSP_USE_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(CUSP_USE_ZSTD)
+#include <zstd.h>
+#endif
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#define CUSP_IO_DECOMPRESSION_THREAD
+#endif
+
+// Transparent reading of compressed files.
+//
+// Files are recognized by their magic number: gzip files are read with
+// zlib (CUSP_USE_ZLIB) and zstd files with libzstd (CUSP_USE_ZSTD), both of
+// which may consist of several concatenated members.  A decompressing
+// stream decompresses the file on a separate thread into a ring of
+// blocks, which the reader consumes while the next blocks are produced,
+// so decompression overlaps with parsing.  Without pthreads the blocks
+// are decompressed on demand.
+
+namespace cusp
+{
+namespace io
+{
+namespace detail
+{
+
+// produces the decompressed contents of a file, 0 bytes at the end
+class decompressor
+{
+    public:
+    virtual ~decompressor(void) {}
+    virtual size_t read(char * data, const size_t size) = 0;
+};
+
+// size of the compressed input read at once
+const size_t DECOMPRESSION_INPUT_SIZE = 1 << 20;
+
+// ring of decompressed blocks, which covers a block of parsed text
+const size_t DECOMPRESSION_BLOCK_SIZE = 1 << 22;
+const size_t DECOMPRESSION_NUM_BLOCKS = 8;
+
+#if defined(CUSP_USE_ZLIB)
+class gzip_decompressor : public decompressor
+{
+    public:
+    explicit gzip_decompressor(std::FILE * file)
+        : file(file), input(DECOMPRESSION_INPUT_SIZE), finished(false), member_ended(false)
+    {
+        std::memset(&stream, 0, sizeof(stream));
+
+        // accept gzip headers only
+        if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+        {
+            std::fclose(file);
+            throw cusp::io_exception("unable to initialize gzip decompression");
+        }
+    }
+
+    ~gzip_decompressor(void)
+    {
+        inflateEnd(&stream);
+        std::fclose(file);
+    }
+
+    size_t read(char * data, const size_t size)
+    {
+        stream.next_out  = reinterpret_cast<Bytef *>(data);
+        stream.avail_out = uInt(size);
+
+        while (stream.avail_out > 0 && !finished)
+        {
+            if (stream.avail_in == 0)
+            {
+                stream.next_in  = reinterpret_cast<Bytef *>(&input[0]);
+                stream.avail_in = uInt(std::fread(&input[0], 1, input.size(), file));
+
+                if (stream.avail_in == 0)
+                {
+                    if (!member_ended)
+                        throw cusp::io_exception("unexpected end of gzip file");
+
+                    finished = true;
+                    break;
+                }
+            }
+
+            member_ended = false;
+
+            const int status = inflate(&stream, Z_NO_FLUSH);
+
+            if (status == Z_STREAM_END)
+            {
+                // a further member may follow
+                member_ended = true;
+                inflateReset(&stream);
+            }
+            else if (status != Z_OK && status != Z_BUF_ERROR)
+            {
+                throw cusp::io_exception("invalid gzip file");
+            }
+        }
+
+        return size - stream.avail_out;
+    }
+
+    private:
+    std::FILE * file;
+    z_stream stream;
+    std::vector<char> input;
+    bool finished;
+    bool member_ended;
+};
+#endif
+
+#if defined(CUSP_USE_ZSTD)
+class zstd_decompressor : public decompressor
+{
+    public:
+    explicit zstd_decompressor(std::FILE * file)
+        : file(file), stream(ZSTD_createDStream()), input(ZSTD_DStreamInSize()), pending(0)
+    {
+        if (stream == 0)
+        {
+            std::fclose(file);
+            throw cusp::io_exception("unable to initialize zstd decompression");
+        }
+
+        ZSTD_initDStream(stream);
+
+        in.src  = &input[0];
+        in.size = 0;
+        in.pos  = 0;
+    }
+
+    ~zstd_decompressor(void)
+    {
+        ZSTD_freeDStream(stream);
+        std::fclose(file);
+    }
+
+    size_t read(char * data, const size_t size)
+    {
+        ZSTD_outBuffer out = {data, size, 0};
+
+        while (out.pos < out.size)
+        {
+            if (in.pos == in.size)
+            {
+                in.size = std::fread(&input[0], 1, input.size(), file);
+                in.pos  = 0;
+
+                if (in.size == 0)
+                {
+                    // the last frame must be complete
+                    if (pending != 0)
+                        throw cusp::io_exception("unexpected end of zstd file");
+
+                    break;
+                }
+            }
+
+            pending = ZSTD_decompressStream(stream, &out, &in);
+
+            if (ZSTD_isError(pending))
+                throw cusp::io_exception("invalid zstd file");
+        }
+
+        return out.pos;
+    }
+
+    private:
+    std::FILE * file;
+    ZSTD_DStream * stream;
+    std::vector<char> input;
+    ZSTD_inBuffer in;
+    size_t pending;
+};
+#endif
+
+// decompressor of a compressed file, 0 for files that are not compressed
+// or that cannot be opened
+inline decompressor * open_decompressor(const std::string& filename)
+{
+    std::FILE * file = std::fopen(filename.c_str(), "rb");
+
+    if (!file)
+        return 0;
+
+    unsigned char magic[4] = {0, 0, 0, 0};
+    const size_t size = std::fread(magic, 1, 4, file);
+
+    const bool gzip = size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+    const bool zstd = size >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd;
+
+    if (!gzip && !zstd)
+    {
+        std::fclose(file);
+        return 0;
+    }
+
+    std::rewind(file);
+
+#if defined(CUSP_USE_ZLIB)
+    if (gzip)
+        return new gzip_decompressor(file);
+#endif
+
+#if defined(CUSP_USE_ZSTD)
+    if (zstd)
+        return new zstd_decompressor(file);
+#endif
+
+    std::fclose(file);
+
+    if (gzip)
+        throw cusp::io_exception(std::string("reading gzip-compressed file \"") + filename + std::string("\" requires CUSP_USE_ZLIB"));
+    else
+        throw cusp::io_exception(std::string("reading zstd-compressed file \"") + filename + std::string("\" requires CUSP_USE_ZSTD"));
+}
+
+// stream buffer of the decompressed contents, which takes ownership of
+// the decompressor
+class decompressing_streambuf : public std::streambuf
+{
+    public:
+    explicit decompressing_streambuf(decompressor * source)
+        : source(source), blocks(DECOMPRESSION_NUM_BLOCKS * DECOMPRESSION_BLOCK_SIZE), sizes(DECOMPRESSION_NUM_BLOCKS, 0),
+          head(0), count(0), reading(false), finished(false), stopped(false)
+    {
+#if defined(CUSP_IO_DECOMPRESSION_THREAD)
+        pthread_mutex_init(&mutex, 0);
+        pthread_cond_init(&changed, 0);
+
+        if (pthread_create(&thread, 0, decompress_blocks, this) != 0)
+        {
+            pthread_cond_destroy(&changed);
+            pthread_mutex_destroy(&mutex);
+            delete source;
+            throw cusp::io_exception("unable to start decompression thread");
+        }
+#endif
+    }
+
+    ~decompressing_streambuf(void)
+    {
+#if defined(CUSP_IO_DECOMPRESSION_THREAD)
+        pthread_mutex_lock(&mutex);
+        stopped = true;
+        pthread_cond_broadcast(&changed);
+        pthread_mutex_unlock(&mutex);
+
+        pthread_join(thread, 0);
+
+        pthread_cond_destroy(&changed);
+        pthread_mutex_destroy(&mutex);
+#endif
+        delete source;
+    }
+
+    protected:
+    int_type underflow(void)
+    {
+        if (gptr() < egptr())
+            return traits_type::to_int_type(*gptr());
+
+#if defined(CUSP_IO_DECOMPRESSION_THREAD)
+        pthread_mutex_lock(&mutex);
+
+        // release the block that was read
+        if (reading)
+        {
+            head = (head + 1) % DECOMPRESSION_NUM_BLOCKS;
+            count--;
+            reading = false;
+            pthread_cond_broadcast(&changed);
+        }
+
+        while (count == 0 && !finished)
+            pthread_cond_wait(&changed, &mutex);
+
+        const bool available = count > 0;
+        const size_t size = sizes[head];
+        const std::string message = error;
+
+        reading = available;
+
+        pthread_mutex_unlock(&mutex);
+
+        if (!available)
+        {
+            if (!message.empty())
+                throw cusp::io_exception(message);
+
+            return traits_type::eof();
+        }
+#else
+        const size_t size = source->read(&blocks[0], DECOMPRESSION_BLOCK_SIZE);
+
+        if (size == 0)
+            return traits_type::eof();
+#endif
+
+        char * block = &blocks[head * DECOMPRESSION_BLOCK_SIZE];
+        setg(block, block, block + size);
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+    private:
+    decompressor * source;
+    std::vector<char> blocks;
+    std::vector<size_t> sizes;
+
+    // the filled blocks head, ..., head + count - 1, of which the reader
+    // is reading the first one
+    size_t head;
+    size_t count;
+    bool reading;
+    bool finished;
+    bool stopped;
+    std::string error;
+
+    // no copies
+    decompressing_streambuf(const decompressing_streambuf&);
+    decompressing_streambuf& operator=(const decompressing_streambuf&);
+
+#if defined(CUSP_IO_DECOMPRESSION_THREAD)
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+
+    static void * decompress_blocks(void * argument)
+    {
+        static_cast<decompressing_streambuf *>(argument)->decompress();
+        return 0;
+    }
+
+    void decompress(void)
+    {
+        pthread_mutex_lock(&mutex);
+
+        while (!finished)
+        {
+            while (count == DECOMPRESSION_NUM_BLOCKS && !stopped)
+                pthread_cond_wait(&changed, &mutex);
+
+            if (stopped)
+                break;
+
+            const size_t k = (head + count) % DECOMPRESSION_NUM_BLOCKS;
+
+            // the reader does not touch the free blocks
+            pthread_mutex_unlock(&mutex);
+
+            size_t size = 0;
+            std::string message;
+
+            try
+            {
+                size = source->read(&blocks[k * DECOMPRESSION_BLOCK_SIZE], DECOMPRESSION_BLOCK_SIZE);
+            }
+            catch (const std::exception& e)
+            {
+                message = e.what();
+            }
+
+            pthread_mutex_lock(&mutex);
+
+            if (size > 0)
+            {
+                sizes[k] = size;
+                count++;
+            }
+            else
+            {
+                error = message;
+                finished = true;
+            }
+
+            pthread_cond_broadcast(&changed);
+        }
+
+        pthread_mutex_unlock(&mutex);
+    }
+#endif
+};
+
+// input file stream which decompresses gzip and zstd files
+class input_file : public std::istream
+{
+    public:
+    explicit input_file(const std::string& filename)
+        : std::istream(0), compressed(0)
+    {
+        decompressor * source = open_decompressor(filename);
+
+        if (source)
+        {
+            compressed = new decompressing_streambuf(source);
+            rdbuf(compressed);
+
+            // rethrow errors of the decompressor instead of ending the input
+            exceptions(std::ios::badbit);
+        }
+        else if (file.open(filename.c_str(), std::ios::in))
+        {
+            rdbuf(&file);
+        }
+        else
+        {
+            setstate(std::ios::failbit);
+        }
+    }
+
+    ~input_file(void)
+    {
+        delete compressed;
+    }
+
+    private:
+    std::filebuf file;
+    decompressing_streambuf * compressed;
+};
+
+} // end namespace detail
+} // end namespace io
+} // end namespace cusp
+
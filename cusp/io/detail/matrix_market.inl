@@ -21,10 +21,25 @@
 #include <cusp/coo_matrix.h>
 #include <cusp/complex.h>
 #include <cusp/convert.h>
+#include <cusp/distribution.h>
 #include <cusp/exception.h>
+#include <cusp/symmetric_csr_matrix.h>
 
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+#include <cusp/io/detail/compression.h>
+#include <cusp/io/detail/text.h>
+
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/functional.h>
 #include <thrust/sort.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <string>
 #include <fstream>
@@ -110,21 +125,107 @@ void assign_complex(cusp::complex<ScalarType>& value, double real, double imag)
   value.imag(imag);
 }
 
-template <typename Stream, typename ScalarType>
-void write_value(Stream& output, const ScalarType& value)
+// number of values of an entry of a coordinate file
+inline int coordinate_num_values(const matrix_market_banner& banner)
 {
-  output << value;
+  if (banner.type == "pattern")
+    return 0;
+  else if (banner.type == "real" || banner.type == "integer")
+    return 1;
+  else if (banner.type == "complex")
+    return 2;
+  else
+    throw cusp::io_exception("invalid MatrixMarket data type");
 }
 
-template <typename Stream, typename ScalarType>
-void write_value(Stream& output, const cusp::complex<ScalarType>& value)
+// the entry lines of a buffer, split into one range per thread, and the
+// index of the first entry of each range
+struct coordinate_lines
 {
-  output << value.real() << " " << value.imag();
+  std::vector<const char *> bounds;
+  std::vector<size_t>       first;
+
+  coordinate_lines(const char * begin, const char * end)
+  {
+    const int num_parts = int(std::max<size_t>(1, std::min<size_t>(text_num_threads(), size_t(end - begin) >> 16)));
+
+    split_lines(begin, end, num_parts, bounds);
+
+    first.assign(num_parts + 1, 0);
+
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (int t = 0; t < num_parts; t++)
+      for (const char * p = bounds[t]; p < bounds[t + 1]; p = next_line(p, bounds[t + 1]))
+        first[t + 1] += is_entry_line(p, bounds[t + 1]);
+
+    for (int t = 0; t < num_parts; t++)
+      first[t + 1] += first[t];
+  }
+
+  int    num_parts(void)   const { return int(bounds.size()) - 1; }
+  size_t num_entries(void) const { return first.back(); }
+};
+
+// parse the first max_entries entries of the lines, as written in the
+// file (base-1 indices, not expanded)
+template <typename IndexType, typename ValueType>
+void parse_coordinate_lines(const coordinate_lines& lines, const int num_values, const size_t max_entries,
+                            IndexType * row_indices, IndexType * column_indices, ValueType * values)
+{
+  const int num_parts = lines.num_parts();
+
+  std::vector<int> invalid(num_parts, 0);
+
+#ifdef _OPENMP
+  #pragma omp parallel for
+#endif
+  for (int t = 0; t < num_parts; t++)
+  {
+    const char * end = lines.bounds[t + 1];
+
+    size_t n = lines.first[t];
+
+    for (const char * p = lines.bounds[t]; p < end && n < max_entries; p = next_line(p, end))
+    {
+      if (!is_entry_line(p, end))
+        continue;
+
+      size_t i, j;
+      double real = 1, imag = 0;
+
+      const char * q = p;
+
+      if (!parse_unsigned(q, end, i) ||
+          !parse_unsigned(q, end, j) ||
+          (num_values > 0 && !parse_double(q, end, real)) ||
+          (num_values > 1 && !parse_double(q, end, imag)))
+      {
+        invalid[t] = 1;
+        break;
+      }
+
+      row_indices[n]    = IndexType(i);
+      column_indices[n] = IndexType(j);
+      assign_complex(values[n], real, imag);
+
+      n++;
+    }
+  }
+
+  if (std::find(invalid.begin(), invalid.end(), 1) != invalid.end())
+    throw cusp::io_exception("invalid MatrixMarket entry");
 }
 
+// size of the blocks of text parsed at once
+const size_t COORDINATE_CHUNK_SIZE = 1 << 25;
 
-template <typename IndexType, typename ValueType, typename Stream>
-void read_coordinate_stream(cusp::coo_matrix<IndexType,ValueType,cusp::host_memory>& coo, Stream& input, const matrix_market_banner& banner)
+// entries of a device matrix that are staged for writing at a time
+const size_t COORDINATE_WRITE_CHUNK_ENTRIES = 1 << 22;
+
+template <typename Stream>
+void read_coordinate_size(Stream& input, size_t& num_rows, size_t& num_cols, size_t& num_entries)
 {
   // read file contents line by line
   std::string line;
@@ -142,64 +243,41 @@ void read_coordinate_stream(cusp::coo_matrix<IndexType,ValueType,cusp::host_memo
   if (tokens.size() != 3)
     throw cusp::io_exception("invalid MatrixMarket coordinate format");
 
-  size_t num_rows, num_cols, num_entries;
-
   std::istringstream(tokens[0]) >> num_rows;
   std::istringstream(tokens[1]) >> num_cols;
   std::istringstream(tokens[2]) >> num_entries;
-  
-  coo.resize(num_rows, num_cols, num_entries);
+}
 
-  size_t num_entries_read = 0;
+template <typename IndexType, typename ValueType, typename Stream>
+void read_coordinate_stream(cusp::coo_matrix<IndexType,ValueType,cusp::host_memory>& coo, Stream& input, const matrix_market_banner& banner,
+                            const bool expand_symmetric = true)
+{
+  size_t num_rows, num_cols, num_entries;
 
-  // read file contents
-  if (banner.type == "pattern")
-  {
-    while(num_entries_read < coo.num_entries && !input.eof())
-    {
-      input >> coo.row_indices[num_entries_read];
-      input >> coo.column_indices[num_entries_read];
-      num_entries_read++;
-    }
+  read_coordinate_size(input, num_rows, num_cols, num_entries);
+  
+  const int num_values = coordinate_num_values(banner);
 
-    std::fill(coo.values.begin(), coo.values.end(), ValueType(1));
-  } 
-  else if (banner.type == "real" || banner.type == "integer")
-  {
-    while(num_entries_read < coo.num_entries && !input.eof())
-    {
-      double real;
+  coo.resize(num_rows, num_cols, num_entries);
 
-      input >> coo.row_indices[num_entries_read];
-      input >> coo.column_indices[num_entries_read];
-      input >> real;
+  // parse the entries in blocks, so that a decompressing stream may
+  // produce the next block in the meantime
+  text_chunks<Stream> chunks(input, COORDINATE_CHUNK_SIZE);
+  size_t num_entries_read = 0;
 
-      coo.values[num_entries_read] = real;
-      num_entries_read++;
-    }
-  } 
-  else if (banner.type == "complex")
+  while (num_entries_read < num_entries && chunks.next())
   {
-    while(num_entries_read < coo.num_entries && !input.eof())
-    {
-      double real, imag;
+    coordinate_lines lines(chunks.begin(), chunks.end());
 
-      input >> coo.row_indices[num_entries_read];
-      input >> coo.column_indices[num_entries_read];
-      input >> real;
-      input >> imag;
+    const size_t count = std::min(lines.num_entries(), num_entries - num_entries_read);
 
-      assign_complex(coo.values[num_entries_read], real, imag);
+    parse_coordinate_lines(lines, num_values, count,
+                           &coo.row_indices[num_entries_read], &coo.column_indices[num_entries_read], &coo.values[num_entries_read]);
 
-      num_entries_read++;
-    }
-  }
-  else
-  {
-    throw cusp::io_exception("invalid MatrixMarket data type");
+    num_entries_read += count;
   }
 
-  if(num_entries_read != coo.num_entries)
+  if (num_entries_read != num_entries)
     throw cusp::io_exception("unexpected EOF while reading MatrixMarket entries");
 
   // check validity of row and column index data
@@ -224,7 +302,7 @@ void read_coordinate_stream(cusp::coo_matrix<IndexType,ValueType,cusp::host_memo
   }
 
   // expand symmetric formats to "general" format
-  if (banner.symmetry != "general")
+  if (banner.symmetry != "general" && (expand_symmetric || banner.symmetry != "symmetric"))
   {
     size_t off_diagonals = 0;
 
@@ -277,6 +355,279 @@ void read_coordinate_stream(cusp::coo_matrix<IndexType,ValueType,cusp::host_memo
   coo.sort_by_row_and_column();
 } 
 
+struct coordinate_off_diagonal
+{
+  template <typename Tuple>
+  __host__ __device__
+  bool operator()(const Tuple& t) const
+  {
+    return thrust::get<0>(t) != thrust::get<1>(t);
+  }
+};
+
+// pinned host arrays of the entries of one chunk
+template <typename IndexType, typename ValueType>
+struct coordinate_staging
+{
+  IndexType * row_indices;
+  IndexType * column_indices;
+  ValueType * values;
+  size_t      capacity;
+  cudaEvent_t copied;
+
+  coordinate_staging(void)
+    : row_indices(0), column_indices(0), values(0), capacity(0), copied(0) {}
+
+  ~coordinate_staging(void)
+  {
+    release();
+
+    if (copied)
+      cudaEventDestroy(copied);
+  }
+
+  // wait for the previous copy out of the arrays and make room for n entries
+  void reserve(const size_t n)
+  {
+    if (copied == 0)
+      cusp::detail::check_cuda(cudaEventCreateWithFlags(&copied, cudaEventDisableTiming), "cudaEventCreate failed");
+
+    cusp::detail::check_cuda(cudaEventSynchronize(copied), "host to device copy failed");
+
+    if (n <= capacity)
+      return;
+
+    release();
+
+    capacity = std::max(n, 2 * capacity);
+
+    cusp::detail::check_cuda(cudaMallocHost((void **) &row_indices,    capacity * sizeof(IndexType)), "cudaMallocHost failed");
+    cusp::detail::check_cuda(cudaMallocHost((void **) &column_indices, capacity * sizeof(IndexType)), "cudaMallocHost failed");
+    cusp::detail::check_cuda(cudaMallocHost((void **) &values,         capacity * sizeof(ValueType)), "cudaMallocHost failed");
+  }
+
+  void release(void)
+  {
+    if (row_indices)    cudaFreeHost(row_indices);
+    if (column_indices) cudaFreeHost(column_indices);
+    if (values)         cudaFreeHost(values);
+
+    row_indices    = 0;
+    column_indices = 0;
+    values         = 0;
+    capacity       = 0;
+  }
+};
+
+// Read the entries of a coordinate file into a device matrix.  The file
+// is parsed in chunks of lines into pinned staging arrays, which are
+// copied to the device while the next chunk is parsed, so the host holds
+// only a chunk of the file at a time.  The indices are then checked,
+// converted, expanded and sorted on the device.
+template <typename IndexType, typename ValueType, typename Stream>
+void read_coordinate_stream(cusp::coo_matrix<IndexType,ValueType,cusp::device_memory>& coo, Stream& input, const matrix_market_banner& banner)
+{
+  size_t num_rows, num_cols, num_entries;
+
+  read_coordinate_size(input, num_rows, num_cols, num_entries);
+
+  const int num_values = coordinate_num_values(banner);
+
+  if (banner.symmetry == "hermitian")
+    throw cusp::not_implemented_exception("MatrixMarket I/O does not currently support hermitian matrices");
+  if (banner.symmetry == "skew-symmetric")
+    throw cusp::not_implemented_exception("MatrixMarket I/O does not currently support skew-symmetric matrices");
+
+  coo.resize(num_rows, num_cols, num_entries);
+
+  const cudaStream_t stream = cusp::detail::current_stream();
+
+  coordinate_staging<IndexType,ValueType> staging[2];
+
+  text_chunks<Stream> chunks(input, COORDINATE_CHUNK_SIZE);
+  size_t num_entries_read = 0;
+
+  for (size_t chunk = 0; num_entries_read < num_entries && chunks.next(); chunk++)
+  {
+    coordinate_lines lines(chunks.begin(), chunks.end());
+
+    const size_t count = std::min(lines.num_entries(), num_entries - num_entries_read);
+
+    coordinate_staging<IndexType,ValueType>& s = staging[chunk % 2];
+    s.reserve(count);
+
+    parse_coordinate_lines(lines, num_values, count, s.row_indices, s.column_indices, s.values);
+
+    if (count > 0)
+    {
+      cudaMemcpyAsync(thrust::raw_pointer_cast(&coo.row_indices[0])    + num_entries_read, s.row_indices,    count * sizeof(IndexType), cudaMemcpyHostToDevice, stream);
+      cudaMemcpyAsync(thrust::raw_pointer_cast(&coo.column_indices[0]) + num_entries_read, s.column_indices, count * sizeof(IndexType), cudaMemcpyHostToDevice, stream);
+      cudaMemcpyAsync(thrust::raw_pointer_cast(&coo.values[0])         + num_entries_read, s.values,         count * sizeof(ValueType), cudaMemcpyHostToDevice, stream);
+    }
+
+    cudaEventRecord(s.copied, stream);
+
+    num_entries_read += count;
+  }
+
+  cusp::detail::check_cuda(cudaStreamSynchronize(stream), "host to device copy failed");
+
+  if (num_entries_read != num_entries)
+    throw cusp::io_exception("unexpected EOF while reading MatrixMarket entries");
+
+  // check validity of row and column index data
+  if (num_entries > 0)
+  {
+    const IndexType max_index = std::numeric_limits<IndexType>::max();
+
+    size_t min_row_index = cusp::detail::streamed::transform_reduce(coo.row_indices.begin(),    coo.row_indices.end(),    thrust::identity<IndexType>(), max_index,    thrust::minimum<IndexType>());
+    size_t max_row_index = cusp::detail::streamed::transform_reduce(coo.row_indices.begin(),    coo.row_indices.end(),    thrust::identity<IndexType>(), IndexType(0), thrust::maximum<IndexType>());
+    size_t min_col_index = cusp::detail::streamed::transform_reduce(coo.column_indices.begin(), coo.column_indices.end(), thrust::identity<IndexType>(), max_index,    thrust::minimum<IndexType>());
+    size_t max_col_index = cusp::detail::streamed::transform_reduce(coo.column_indices.begin(), coo.column_indices.end(), thrust::identity<IndexType>(), IndexType(0), thrust::maximum<IndexType>());
+
+    if (min_row_index < 1)            throw cusp::io_exception("found invalid row index (index < 1)");
+    if (min_col_index < 1)            throw cusp::io_exception("found invalid column index (index < 1)");
+    if (max_row_index > coo.num_rows) throw cusp::io_exception("found invalid row index (index > num_rows)");
+    if (max_col_index > coo.num_cols) throw cusp::io_exception("found invalid column index (index > num_columns)");
+  }
+
+  // convert base-1 indices to base-0
+  cusp::detail::streamed::transform(coo.row_indices.begin(), coo.row_indices.end(), thrust::constant_iterator<IndexType>(1),
+                                    coo.row_indices.begin(), thrust::minus<IndexType>());
+  cusp::detail::streamed::transform(coo.column_indices.begin(), coo.column_indices.end(), thrust::constant_iterator<IndexType>(1),
+                                    coo.column_indices.begin(), thrust::minus<IndexType>());
+
+  // expand symmetric formats to "general" format
+  if (banner.symmetry == "symmetric")
+  {
+    const size_t off_diagonals = thrust::count_if(thrust::make_zip_iterator(thrust::make_tuple(coo.row_indices.begin(), coo.column_indices.begin())),
+                                                  thrust::make_zip_iterator(thrust::make_tuple(coo.row_indices.end(),   coo.column_indices.end())),
+                                                  coordinate_off_diagonal());
+
+    cusp::coo_matrix<IndexType,ValueType,cusp::device_memory> general(num_rows, num_cols, num_entries + off_diagonals);
+
+    cusp::detail::streamed::copy(thrust::make_zip_iterator(thrust::make_tuple(coo.row_indices.begin(), coo.column_indices.begin(), coo.values.begin())),
+                                 thrust::make_zip_iterator(thrust::make_tuple(coo.row_indices.end(),   coo.column_indices.end(),   coo.values.end())),
+                                 thrust::make_zip_iterator(thrust::make_tuple(general.row_indices.begin(), general.column_indices.begin(), general.values.begin())));
+
+    // duplicate off-diagonals
+    thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(coo.column_indices.begin(), coo.row_indices.begin(), coo.values.begin())),
+                    thrust::make_zip_iterator(thrust::make_tuple(coo.column_indices.end(),   coo.row_indices.end(),   coo.values.end())),
+                    thrust::make_zip_iterator(thrust::make_tuple(coo.row_indices.begin(), coo.column_indices.begin())),
+                    thrust::make_zip_iterator(thrust::make_tuple(general.row_indices.begin() + num_entries,
+                                                                 general.column_indices.begin() + num_entries,
+                                                                 general.values.begin() + num_entries)),
+                    coordinate_off_diagonal());
+
+    coo.swap(general);
+  }
+
+  // sort indices by (row,column)
+  coo.sort_by_row_and_column();
+}
+
+// read the entries of the rows of the calling process, renumbered in the
+// order of its ranges, without storing the other entries
+template <typename IndexType, typename ValueType, typename Stream>
+void read_partitioned_coordinate_stream(cusp::coo_matrix<IndexType,ValueType,cusp::host_memory>& coo, Stream& input,
+                                        const matrix_market_banner& banner, const cusp::distribution& d)
+{
+  if (banner.storage != "coordinate")
+    throw cusp::io_exception("partitioned MatrixMarket reading requires coordinate format");
+
+  if (banner.type != "pattern" && banner.type != "real" && banner.type != "integer" && banner.type != "complex")
+    throw cusp::io_exception("invalid MatrixMarket data type");
+
+  if (banner.symmetry == "hermitian")
+    throw cusp::not_implemented_exception("MatrixMarket I/O does not currently support hermitian matrices");
+  if (banner.symmetry == "skew-symmetric")
+    throw cusp::not_implemented_exception("MatrixMarket I/O does not currently support skew-symmetric matrices");
+
+  size_t num_rows, num_cols, num_entries;
+
+  read_coordinate_size(input, num_rows, num_cols, num_entries);
+
+  if (num_rows != d.size())
+    throw cusp::invalid_input_exception("MatrixMarket rows do not match the distribution");
+
+  // first row of each range of the calling process in coo
+  std::vector<size_t> first(d.num_partitions(), 0);
+  size_t num_local_rows = 0;
+
+  for (size_t p = 0; p < d.num_partitions(); p++)
+  {
+    if (!d.local(p))
+      continue;
+
+    first[p] = num_local_rows;
+    num_local_rows += d.end(p) - d.begin(p);
+  }
+
+  std::vector<IndexType> row_indices;
+  std::vector<IndexType> column_indices;
+  std::vector<ValueType> values;
+
+  size_t num_entries_read = 0;
+
+  while(num_entries_read < num_entries && !input.eof())
+  {
+    size_t i, j;
+    double real = 1, imag = 0;
+
+    input >> i;
+    input >> j;
+
+    if (banner.type == "real" || banner.type == "integer")
+      input >> real;
+    else if (banner.type == "complex")
+      input >> real >> imag;
+
+    if (input.fail())
+      break;
+
+    num_entries_read++;
+
+    if (i < 1)        throw cusp::io_exception("found invalid row index (index < 1)");
+    if (j < 1)        throw cusp::io_exception("found invalid column index (index < 1)");
+    if (i > num_rows) throw cusp::io_exception("found invalid row index (index > num_rows)");
+    if (j > num_cols) throw cusp::io_exception("found invalid column index (index > num_columns)");
+
+    ValueType value;
+    assign_complex(value, real, imag);
+
+    // base-1 entry (i,j) and the mirrored entry of a symmetric matrix
+    for (int mirror = 0; mirror < 2; mirror++)
+    {
+      const size_t row    = (mirror ? j : i) - 1;
+      const size_t column = (mirror ? i : j) - 1;
+
+      const size_t p = d.owner(row);
+
+      if (d.local(p))
+      {
+        row_indices.push_back(IndexType(first[p] + row - d.begin(p)));
+        column_indices.push_back(IndexType(column));
+        values.push_back(value);
+      }
+
+      if (banner.symmetry != "symmetric" || i == j)
+        break;
+    }
+  }
+
+  if(num_entries_read != num_entries)
+    throw cusp::io_exception("unexpected EOF while reading MatrixMarket entries");
+
+  coo.resize(num_local_rows, num_cols, values.size());
+
+  std::copy(row_indices.begin(),    row_indices.end(),    coo.row_indices.begin());
+  std::copy(column_indices.begin(), column_indices.end(), coo.column_indices.begin());
+  std::copy(values.begin(),         values.end(),         coo.values.begin());
+
+  // sort indices by (row,column)
+  coo.sort_by_row_and_column();
+}
+
 template <typename ValueType, typename Stream>
 void read_array_stream(cusp::array2d<ValueType,cusp::host_memory>& mtx, Stream& input, const matrix_market_banner& banner)
 {
@@ -354,8 +705,93 @@ void read_array_stream(cusp::array2d<ValueType,cusp::host_memory>& mtx, Stream&
 
 
 
-template <typename IndexType, typename ValueType, typename Stream>
-void write_coordinate_stream(const cusp::coo_matrix<IndexType,ValueType,cusp::host_memory>& coo, Stream& output)
+// lines of the values of an array, one per line
+template <typename ValueType>
+struct value_lines
+{
+  const ValueType * values;
+
+  value_lines(const ValueType * values) : values(values) {}
+
+  void append(std::string& block, const size_t i, const int precision) const
+  {
+    append_value(block, values[i], precision);
+    block.push_back('\n');
+  }
+};
+
+// lines of the values of a column-major array, column after column
+template <typename ValueType>
+struct column_major_lines
+{
+  const ValueType * values;
+  size_t num_rows;
+  size_t pitch;
+
+  column_major_lines(const ValueType * values, const size_t num_rows, const size_t pitch)
+    : values(values), num_rows(num_rows), pitch(pitch) {}
+
+  void append(std::string& block, const size_t i, const int precision) const
+  {
+    append_value(block, values[(i / num_rows) * pitch + i % num_rows], precision);
+    block.push_back('\n');
+  }
+};
+
+// lines of the entries of coordinate arrays, with base-1 indices
+template <typename IndexType, typename ValueType>
+struct coordinate_entry_lines
+{
+  const IndexType * row_indices;
+  const IndexType * column_indices;
+  const ValueType * values;
+
+  coordinate_entry_lines(const IndexType * row_indices, const IndexType * column_indices, const ValueType * values)
+    : row_indices(row_indices), column_indices(column_indices), values(values) {}
+
+  void append(std::string& block, const size_t i, const int precision) const
+  {
+    append_unsigned(block, size_t(row_indices[i]    + 1));
+    block.push_back(' ');
+    append_unsigned(block, size_t(column_indices[i] + 1));
+    block.push_back(' ');
+    append_value(block, values[i], precision);
+    block.push_back('\n');
+  }
+};
+
+// format blocks of n lines concurrently and write them in order
+template <typename Lines, typename Stream>
+void write_lines(const Lines& lines, const size_t n, Stream& output, std::vector<std::string>& blocks)
+{
+  const size_t BLOCK_SIZE = 1 << 16;
+  const int    precision  = int(output.precision());
+  const int    num_parts  = int(blocks.size());
+
+  for(size_t base = 0; base < n; base += num_parts * BLOCK_SIZE)
+  {
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for(int t = 0; t < num_parts; t++)
+    {
+      const size_t block_begin = std::min<size_t>(base + t * BLOCK_SIZE, n);
+      const size_t block_end   = std::min<size_t>(block_begin + BLOCK_SIZE, n);
+
+      std::string& block = blocks[t];
+      block.clear();
+
+      for(size_t i = block_begin; i < block_end; i++)
+        lines.append(block, i, precision);
+    }
+
+    for(int t = 0; t < num_parts; t++)
+      output.write(blocks[t].data(), blocks[t].size());
+  }
+}
+
+template <typename ValueType, typename Stream>
+void write_coordinate_banner(Stream& output, const size_t num_rows, const size_t num_cols, const size_t num_entries)
 {
   bool is_complex = thrust::detail::is_same<ValueType, cusp::complex<typename norm_type<ValueType>::type> >::value;
 
@@ -364,32 +800,104 @@ void write_coordinate_stream(const cusp::coo_matrix<IndexType,ValueType,cusp::ho
   else
     output << "%%MatrixMarket matrix coordinate real general\n";
 
-  output << "\t" << coo.num_rows << "\t" << coo.num_cols << "\t" << coo.num_entries << "\n";
+  output << "\t" << num_rows << "\t" << num_cols << "\t" << num_entries << "\n";
+}
+
+template <typename IndexType, typename ValueType, typename Stream>
+void write_coordinate_stream(const cusp::coo_matrix<IndexType,ValueType,cusp::host_memory>& coo, Stream& output)
+{
+  write_coordinate_banner<ValueType>(output, coo.num_rows, coo.num_cols, coo.num_entries);
+
+  if (coo.num_entries == 0)
+    return;
+
+  std::vector<std::string> blocks(text_num_threads());
+
+  write_lines(coordinate_entry_lines<IndexType,ValueType>(thrust::raw_pointer_cast(&coo.row_indices[0]),
+                                                          thrust::raw_pointer_cast(&coo.column_indices[0]),
+                                                          thrust::raw_pointer_cast(&coo.values[0])),
+              coo.num_entries, output, blocks);
+}
+
+// Write the entries of a device matrix.  Chunks of entries are copied
+// into pinned staging arrays and a chunk is formatted and written while
+// the next one is copied, so the host holds only two chunks at a time.
+template <typename IndexType, typename ValueType, typename Stream>
+void write_coordinate_stream(const cusp::coo_matrix<IndexType,ValueType,cusp::device_memory>& coo, Stream& output)
+{
+  write_coordinate_banner<ValueType>(output, coo.num_rows, coo.num_cols, coo.num_entries);
+
+  const size_t num_entries = coo.num_entries;
+  const size_t num_chunks  = (num_entries + COORDINATE_WRITE_CHUNK_ENTRIES - 1) / COORDINATE_WRITE_CHUNK_ENTRIES;
+
+  const cudaStream_t stream = cusp::detail::current_stream();
 
-  for(size_t i = 0; i < coo.num_entries; i++)
+  coordinate_staging<IndexType,ValueType> staging[2];
+  std::vector<std::string> blocks(text_num_threads());
+
+  for (size_t chunk = 0; chunk <= num_chunks; chunk++)
   {
-    output << (coo.row_indices[i]    + 1) << " ";
-    output << (coo.column_indices[i] + 1) << " ";
-    cusp::io::detail::write_value(output, coo.values[i]);
-    output << "\n";
+    if (chunk < num_chunks)
+    {
+      const size_t first = chunk * COORDINATE_WRITE_CHUNK_ENTRIES;
+      const size_t count = std::min(COORDINATE_WRITE_CHUNK_ENTRIES, num_entries - first);
+
+      coordinate_staging<IndexType,ValueType>& s = staging[chunk % 2];
+      s.reserve(count);
+
+      cudaMemcpyAsync(s.row_indices,    thrust::raw_pointer_cast(&coo.row_indices[0])    + first, count * sizeof(IndexType), cudaMemcpyDeviceToHost, stream);
+      cudaMemcpyAsync(s.column_indices, thrust::raw_pointer_cast(&coo.column_indices[0]) + first, count * sizeof(IndexType), cudaMemcpyDeviceToHost, stream);
+      cudaMemcpyAsync(s.values,         thrust::raw_pointer_cast(&coo.values[0])         + first, count * sizeof(ValueType), cudaMemcpyDeviceToHost, stream);
+
+      cudaEventRecord(s.copied, stream);
+    }
+
+    if (chunk > 0)
+    {
+      const size_t first = (chunk - 1) * COORDINATE_WRITE_CHUNK_ENTRIES;
+      const size_t count = std::min(COORDINATE_WRITE_CHUNK_ENTRIES, num_entries - first);
+
+      coordinate_staging<IndexType,ValueType>& s = staging[(chunk - 1) % 2];
+
+      cusp::detail::check_cuda(cudaEventSynchronize(s.copied), "device to host copy failed");
+
+      write_lines(coordinate_entry_lines<IndexType,ValueType>(s.row_indices, s.column_indices, s.values),
+                  count, output, blocks);
+    }
   }
 }
 
-
+// a coordinate matrix in the memory space of mtx, without a copy when mtx
+// is one already
 template <typename Matrix, typename Stream, typename Format>
-void read_matrix_market_stream(Matrix& mtx, Stream& input, Format)
+void write_coordinate_matrix(const Matrix& mtx, Stream& output, Format)
+{
+  typedef typename Matrix::index_type   IndexType;
+  typedef typename Matrix::value_type   ValueType;
+  typedef typename Matrix::memory_space MemorySpace;
+
+  const cusp::coo_matrix<IndexType,ValueType,MemorySpace> coo(mtx);
+
+  write_coordinate_stream(coo, output);
+}
+
+template <typename Matrix, typename Stream>
+void write_coordinate_matrix(const Matrix& mtx, Stream& output, cusp::coo_format)
+{
+  write_coordinate_stream(mtx, output);
+}
+
+
+template <typename Matrix, typename Stream>
+void read_matrix_market_contents(Matrix& mtx, Stream& input, const matrix_market_banner& banner)
 {
-  // general case
   typedef typename Matrix::index_type IndexType;
   typedef typename Matrix::value_type ValueType;
 
-  // read banner 
-  matrix_market_banner banner;
-  read_matrix_market_banner(banner, input);
-
   if (banner.storage == "coordinate")
   {
-    cusp::coo_matrix<IndexType,ValueType,cusp::host_memory> temp;
+    // device matrices are assembled on the device
+    cusp::coo_matrix<IndexType,ValueType,typename Matrix::memory_space> temp;
 
     read_coordinate_stream(temp, input, banner);
 
@@ -405,6 +913,66 @@ void read_matrix_market_stream(Matrix& mtx, Stream& input, Format)
   }
 }
 
+template <typename Matrix, typename Stream, typename Format>
+void read_matrix_market_stream(Matrix& mtx, Stream& input, Format)
+{
+  // general case
+
+  // read banner 
+  matrix_market_banner banner;
+  read_matrix_market_banner(banner, input);
+
+  read_matrix_market_contents(mtx, input, banner);
+}
+
+template <typename Matrix, typename Stream>
+void read_matrix_market_stream(Matrix& mtx, Stream& input, cusp::symmetric_csr_format)
+{
+  // symmetric_csr_matrix case
+  typedef typename Matrix::index_type IndexType;
+  typedef typename Matrix::value_type ValueType;
+
+  // read banner 
+  matrix_market_banner banner;
+  read_matrix_market_banner(banner, input);
+
+  if (banner.storage != "coordinate" || banner.symmetry != "symmetric")
+  {
+    read_matrix_market_contents(mtx, input, banner);
+    return;
+  }
+
+  // read the stored triangle without expanding it
+  cusp::coo_matrix<IndexType,ValueType,cusp::host_memory> temp;
+
+  read_coordinate_stream(temp, input, banner, false);
+
+  if (temp.num_rows != temp.num_cols)
+    throw cusp::io_exception("symmetric MatrixMarket matrix must be square");
+
+  // MatrixMarket stores the lower triangle, move it to the upper triangle
+  size_t num_diagonal_entries = 0;
+
+  for(size_t n = 0; n < temp.num_entries; n++)
+  {
+    if (temp.row_indices[n] > temp.column_indices[n])
+      std::swap(temp.row_indices[n], temp.column_indices[n]);
+    else if (temp.row_indices[n] == temp.column_indices[n])
+      num_diagonal_entries++;
+  }
+
+  temp.sort_by_row_and_column();
+
+  cusp::symmetric_csr_matrix<IndexType,ValueType,cusp::host_memory>
+    symmetric(temp.num_rows, temp.num_cols, 2 * temp.num_entries - num_diagonal_entries, temp.num_entries);
+
+  cusp::detail::indices_to_offsets(temp.row_indices, symmetric.row_offsets);
+  cusp::copy(temp.column_indices, symmetric.column_indices);
+  cusp::copy(temp.values,         symmetric.values);
+
+  cusp::convert(symmetric, mtx);
+}
+
 template <typename Matrix, typename Stream>
 void read_matrix_market_stream(Matrix& mtx, Stream& input, cusp::array1d_format)
 {
@@ -421,13 +989,8 @@ void read_matrix_market_stream(Matrix& mtx, Stream& input, cusp::array1d_format)
 template <typename Matrix, typename Stream>
 void write_matrix_market_stream(const Matrix& mtx, Stream& output, cusp::sparse_format)
 {
-  // general sparse case
-  typedef typename Matrix::index_type IndexType;
-  typedef typename Matrix::value_type ValueType;
-
-  cusp::coo_matrix<IndexType,ValueType,cusp::host_memory> coo(mtx);
-
-  cusp::io::detail::write_coordinate_stream(coo, output);
+  // general sparse case, written from the memory space of the matrix
+  write_coordinate_matrix(mtx, output, typename Matrix::format());
 }
 
 template <typename Matrix, typename Stream>
@@ -444,11 +1007,13 @@ void write_matrix_market_stream(const Matrix& mtx, Stream& output, cusp::array1d
 
   output << "\t" << mtx.size() << "\t1\n";
 
-  for(size_t i = 0; i < mtx.size(); i++)
-  {
-    write_value(output, mtx[i]);
-    output << "\n";
-  }
+  if (mtx.size() == 0)
+    return;
+
+  const cusp::array1d<ValueType,cusp::host_memory> values(mtx);
+  std::vector<std::string> blocks(text_num_threads());
+
+  write_lines(value_lines<ValueType>(thrust::raw_pointer_cast(&values[0])), values.size(), output, blocks);
 }
 
 template <typename Matrix, typename Stream>
@@ -465,14 +1030,17 @@ void write_matrix_market_stream(const Matrix& mtx, Stream& output, cusp::array2d
 
   output << "\t" << mtx.num_rows << "\t" << mtx.num_cols << "\n";
 
-  for(size_t j = 0; j < mtx.num_cols; j++)
-  {
-    for(size_t i = 0; i < mtx.num_rows; i++)
-    {
-      write_value(output, mtx(i,j));
-      output << "\n";
-    }
-  }
+  // columns one after the other
+  const size_t num_values = mtx.num_rows * mtx.num_cols;
+
+  if (num_values == 0)
+    return;
+
+  const cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> dense(mtx);
+  std::vector<std::string> blocks(text_num_threads());
+
+  write_lines(column_major_lines<ValueType>(thrust::raw_pointer_cast(&dense.values[0]), dense.num_rows, dense.pitch),
+              num_values, output, blocks);
 }
 
 } // end namespace detail
@@ -481,7 +1049,7 @@ void write_matrix_market_stream(const Matrix& mtx, Stream& output, cusp::array2d
 template <typename Matrix>
 void read_matrix_market_file(Matrix& mtx, const std::string& filename)
 {
-  std::ifstream file(filename.c_str());
+  cusp::io::detail::input_file file(filename);
 
   if (!file)
     throw cusp::io_exception(std::string("unable to open file \"") + filename + std::string("\" for reading"));
@@ -489,10 +1057,10 @@ void read_matrix_market_file(Matrix& mtx, const std::string& filename)
 #ifdef __APPLE__
   // WAR OSX-specific issue using rdbuf
   std::stringstream file_string (std::stringstream::in | std::stringstream::out);
-  std::vector<char> buffer(file.rdbuf()->pubseekoff(0, std::ios::end,std::ios::in));
-  file.rdbuf()->pubseekpos(0, std::ios::in);
-  file.rdbuf()->sgetn(&buffer[0], buffer.size());
-  file_string.write(&buffer[0], buffer.size());
+  std::vector<char> buffer;
+  cusp::io::detail::read_remaining(file, buffer);
+  if (!buffer.empty())
+    file_string.write(&buffer[0], buffer.size());
 
   cusp::io::read_matrix_market_stream(mtx, file_string);
 #else
@@ -506,6 +1074,53 @@ void read_matrix_market_stream(Matrix& mtx, Stream& input)
   cusp::io::detail::read_matrix_market_stream(mtx, input, typename Matrix::format());
 }
 
+template <typename Matrix>
+void read_matrix_market_file(Matrix& mtx, const std::string& filename, const cusp::distribution& d)
+{
+  typedef typename Matrix::index_type IndexType;
+  typedef typename Matrix::value_type ValueType;
+
+  cusp::io::detail::input_file file(filename);
+
+  if (!file)
+    throw cusp::io_exception(std::string("unable to open file \"") + filename + std::string("\" for reading"));
+
+  cusp::io::detail::matrix_market_banner banner;
+  cusp::io::detail::read_matrix_market_banner(banner, file);
+
+  cusp::coo_matrix<IndexType,ValueType,cusp::host_memory> coo;
+  cusp::io::detail::read_partitioned_coordinate_stream(coo, file, banner, d);
+
+  cusp::convert(coo, mtx);
+}
+
+template <typename Matrix>
+void read_matrix_market_file(Matrix& mtx, cusp::distribution& d,
+                             const std::string& filename,
+                             const cusp::communicator& comm, int device)
+{
+  size_t num_rows, num_cols, num_entries;
+
+  {
+    cusp::io::detail::input_file file(filename);
+
+    if (!file)
+      throw cusp::io_exception(std::string("unable to open file \"") + filename + std::string("\" for reading"));
+
+    cusp::io::detail::matrix_market_banner banner;
+    cusp::io::detail::read_matrix_market_banner(banner, file);
+
+    if (banner.storage != "coordinate")
+      throw cusp::io_exception("partitioned MatrixMarket reading requires coordinate format");
+
+    cusp::io::detail::read_coordinate_size(file, num_rows, num_cols, num_entries);
+  }
+
+  d = cusp::distribution(num_rows, device, comm);
+
+  cusp::io::read_matrix_market_file(mtx, filename, d);
+}
+
 template <typename Matrix>
 void write_matrix_market_file(const Matrix& mtx, const std::string& filename)
 {
@@ -0,0 +1,514 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cusp/complex.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Text conversion of the entries of MatrixMarket files.
+//
+// The entries are read into memory in large blocks and the buffer is split
+// at line boundaries into one range per thread, which parses its lines
+// with the routines below instead of iostreams.  Decimal numbers with at
+// most 19 significant digits and a small exponent are converted exactly
+// with one floating point operation (Clinger's fast path), other numbers
+// are passed to strtod.  Writing formats blocks of entries in parallel,
+// with a similar fast path for the significant digits of floating point
+// values, and outputs them in order.
+
+namespace cusp
+{
+namespace io
+{
+namespace detail
+{
+
+// number of ranges of a buffer parsed concurrently
+inline size_t text_num_threads(void)
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// append the remaining contents of a stream to buffer
+template <typename Stream>
+void read_remaining(Stream& input, std::vector<char>& buffer)
+{
+    const size_t BLOCK_SIZE = 1 << 24;
+
+    while (input)
+    {
+        const size_t size = buffer.size();
+
+        buffer.resize(size + BLOCK_SIZE);
+        input.read(&buffer[size], BLOCK_SIZE);
+        buffer.resize(size + input.gcount());
+    }
+}
+
+// blocks of complete lines of a stream, the incomplete last line of a
+// block is carried over to the next one
+template <typename Stream>
+class text_chunks
+{
+    public:
+    text_chunks(Stream& input, const size_t chunk_size)
+        : input(input), chunk_size(chunk_size), length(0) {}
+
+    // read the next block, false at the end of the stream
+    bool next(void)
+    {
+        buffer.erase(buffer.begin(), buffer.begin() + length);
+        length = 0;
+
+        while (input)
+        {
+            const size_t carry = buffer.size();
+
+            buffer.resize(carry + chunk_size);
+            input.read(&buffer[carry], chunk_size);
+            buffer.resize(carry + input.gcount());
+
+            length = buffer.size();
+
+            if (!input)
+                break;
+
+            while (length > 0 && buffer[length - 1] != '\n')
+                length--;
+
+            // otherwise a line is longer than the block
+            if (length > 0)
+                break;
+        }
+
+        return length > 0;
+    }
+
+    const char * begin(void) const { return &buffer[0]; }
+    const char * end(void)   const { return &buffer[0] + length; }
+
+    private:
+    Stream& input;
+    const size_t chunk_size;
+    std::vector<char> buffer;
+    size_t length;
+};
+
+inline bool is_blank(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool is_digit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline const char * skip_blanks(const char * p, const char * end)
+{
+    while (p < end && is_blank(*p))
+        p++;
+
+    return p;
+}
+
+inline const char * next_line(const char * p, const char * end)
+{
+    const char * newline = static_cast<const char *>(std::memchr(p, '\n', end - p));
+
+    return newline == 0 ? end : newline + 1;
+}
+
+// whether the line at p holds an entry, i.e. is neither blank nor a comment
+inline bool is_entry_line(const char * p, const char * end)
+{
+    p = skip_blanks(p, end);
+
+    return p < end && *p != '\n' && *p != '%';
+}
+
+// [bounds[t], bounds[t+1]) <- ranges of [begin, end) that start at lines
+inline void split_lines(const char * begin, const char * end, const size_t num_parts,
+                        std::vector<const char *>& bounds)
+{
+    bounds.resize(num_parts + 1);
+    bounds[0] = begin;
+
+    for (size_t t = 1; t < num_parts; t++)
+    {
+        const char * p = begin + ((end - begin) / num_parts) * t;
+
+        p = std::max(p, bounds[t - 1]);
+
+        // the range starts after the newline that ends the previous one
+        bounds[t] = (p == begin) ? begin : next_line(p - 1, end);
+    }
+
+    bounds[num_parts] = end;
+}
+
+inline bool parse_unsigned(const char *& p, const char * end, size_t& value)
+{
+    p = skip_blanks(p, end);
+
+    if (p == end || !is_digit(*p))
+        return false;
+
+    value = 0;
+
+    while (p < end && is_digit(*p))
+        value = 10 * value + (*p++ - '0');
+
+    return true;
+}
+
+inline bool parse_double(const char *& p, const char * end, double& value)
+{
+    static const double powers_of_ten[] =
+        {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    p = skip_blanks(p, end);
+
+    const char * start = p;
+
+    bool negative = false;
+
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    unsigned long long mantissa = 0;
+    int  digits    = 0;     // significant digits in the mantissa
+    int  exponent  = 0;
+    bool any       = false;
+    bool truncated = false;
+
+    for (; p < end && is_digit(*p); p++)
+    {
+        any = true;
+
+        if (digits < 19)
+        {
+            mantissa = 10 * mantissa + (*p - '0');
+            digits  += mantissa != 0;
+        }
+        else
+        {
+            exponent++;
+            truncated |= *p != '0';
+        }
+    }
+
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && is_digit(*p); p++)
+        {
+            any = true;
+
+            if (digits < 19)
+            {
+                mantissa = 10 * mantissa + (*p - '0');
+                digits  += mantissa != 0;
+                exponent--;
+            }
+            else
+            {
+                truncated |= *p != '0';
+            }
+        }
+    }
+
+    if (any && p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char * q = p + 1;
+
+        bool negative_exponent = false;
+
+        if (q < end && (*q == '-' || *q == '+'))
+            negative_exponent = *q++ == '-';
+
+        if (q < end && is_digit(*q))
+        {
+            int e = 0;
+
+            for (; q < end && is_digit(*q); q++)
+                e = std::min(10 * e + (*q - '0'), 100000);
+
+            exponent += negative_exponent ? -e : e;
+            p = q;
+        }
+    }
+
+    if (any && !truncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+    {
+        value = double(mantissa);
+        value = exponent < 0 ? value / powers_of_ten[-exponent] : value * powers_of_ten[exponent];
+
+        if (negative)
+            value = -value;
+
+        return true;
+    }
+
+    // long mantissas, large exponents, inf and nan
+    const char * token_end = start;
+
+    while (token_end < end && !is_blank(*token_end) && *token_end != '\n')
+        token_end++;
+
+    if (token_end == start)
+        return false;
+
+    const std::string token(start, token_end);
+
+    char * parsed = 0;
+    value = std::strtod(token.c_str(), &parsed);
+
+    if (parsed == token.c_str())
+        return false;
+
+    p = start + (parsed - token.c_str());
+
+    return true;
+}
+
+inline void append_unsigned(std::string& out, size_t value)
+{
+    char digits[24];
+    int n = 0;
+
+    do
+    {
+        digits[n++] = char('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (n > 0)
+        out.push_back(digits[--n]);
+}
+
+inline void append_integer(std::string& out, const long long value)
+{
+    if (value < 0)
+    {
+        out.push_back('-');
+        append_unsigned(out, size_t(-(value + 1)) + 1);
+    }
+    else
+    {
+        append_unsigned(out, size_t(value));
+    }
+}
+
+// powers of ten that are exact in double precision
+inline double exact_power_of_ten(const int k)
+{
+    static const double powers[23] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                      1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                      1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    return powers[k];
+}
+
+// value / 10^k for |k| <= 22, scaled with one rounding
+inline double scale_by_power_of_ten(const double value, const int k)
+{
+    return k >= 0 ? value / exact_power_of_ten(k) : value * exact_power_of_ten(-k);
+}
+
+// Format value like "%.*g" without snprintf.  The significant digits are
+// those of value / 10^(exponent - precision + 1), which is computed with a
+// single rounding and then rounded to an integer.  Unless the quotient is
+// within its rounding error of a tie, this rounds the exact value in the
+// same way.  Returns false for near ties, and for precisions, magnitudes
+// and special values, which are left to snprintf.
+inline bool append_floating_fast(std::string& out, const double value, int precision)
+{
+    if (precision <= 0)
+        precision = 1;
+
+    if (precision > 15 || value != value || value - value != 0)
+        return false;
+
+    unsigned long long bits;
+    std::memcpy(&bits, &value, sizeof(double));
+
+    if (bits >> 63)
+        out.push_back('-');
+
+    if (value == 0)
+    {
+        out.push_back('0');
+        return true;
+    }
+
+    const double magnitude = value < 0 ? -value : value;
+    const double lower = exact_power_of_ten(precision - 1);
+    const double upper = exact_power_of_ten(precision);
+
+    // decimal exponent of the leading digit, corrected for log10 rounding
+    int exponent = int(std::floor(std::log10(magnitude)));
+    double scaled = 0;
+
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        const int shift = exponent - (precision - 1);
+
+        if (shift > 22 || shift < -22)
+            break;
+
+        scaled = scale_by_power_of_ten(magnitude, shift);
+
+        if (scaled >= upper)
+            exponent++;
+        else if (scaled < lower)
+            exponent--;
+        else
+            break;
+    }
+
+    double digits = std::floor(scaled);
+    const double fraction = scaled - digits;
+
+    // the quotient is off by at most half an ulp, i.e. 2^-53 * scaled
+    if (!(scaled >= lower && scaled < upper) || std::fabs(fraction - 0.5) <= scaled * 2.3e-16)
+    {
+        out.resize(out.size() - size_t(bits >> 63));
+        return false;
+    }
+
+    if (fraction > 0.5)
+        digits += 1;
+
+    if (digits >= upper)
+    {
+        digits = lower;
+        exponent++;
+    }
+
+    char buffer[16];
+    unsigned long long d = (unsigned long long) digits;
+
+    for (int n = precision - 1; n >= 0; n--)
+    {
+        buffer[n] = char('0' + d % 10);
+        d /= 10;
+    }
+
+    // significant digits without the trailing zeros
+    int length = precision;
+    while (length > 1 && buffer[length - 1] == '0')
+        length--;
+
+    if (exponent < -4 || exponent >= precision)
+    {
+        out.push_back(buffer[0]);
+
+        if (length > 1)
+        {
+            out.push_back('.');
+            out.append(buffer + 1, length - 1);
+        }
+
+        out.push_back('e');
+        out.push_back(exponent < 0 ? '-' : '+');
+
+        const int e = exponent < 0 ? -exponent : exponent;
+
+        if (e < 10)
+            out.push_back('0');
+
+        append_unsigned(out, size_t(e));
+    }
+    else if (exponent >= 0)
+    {
+        out.append(buffer, exponent + 1);
+
+        if (length > exponent + 1)
+        {
+            out.push_back('.');
+            out.append(buffer + exponent + 1, length - exponent - 1);
+        }
+    }
+    else
+    {
+        out.append("0.");
+        out.append(-exponent - 1, '0');
+        out.append(buffer, length);
+    }
+
+    return true;
+}
+
+// values are formatted like operator<< with the given precision
+inline void append_floating(std::string& out, const double value, const int precision)
+{
+    if (append_floating_fast(out, value, precision))
+        return;
+
+    char buffer[64];
+    const int n = snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+
+    out.append(buffer, std::min<size_t>(n, sizeof(buffer) - 1));
+}
+
+template <typename ValueType>
+void append_value(std::string& out, const ValueType& value, const int precision)
+{
+    std::ostringstream stream;
+    stream.precision(precision);
+    stream << value;
+
+    out += stream.str();
+}
+
+inline void append_value(std::string& out, const float  value, const int precision) { append_floating(out, value, precision); }
+inline void append_value(std::string& out, const double value, const int precision) { append_floating(out, value, precision); }
+
+inline void append_value(std::string& out, const int           value, const int) { append_integer(out, value); }
+inline void append_value(std::string& out, const long          value, const int) { append_integer(out, value); }
+inline void append_value(std::string& out, const long long     value, const int) { append_integer(out, value); }
+inline void append_value(std::string& out, const unsigned int  value, const int) { append_unsigned(out, value); }
+inline void append_value(std::string& out, const unsigned long value, const int) { append_unsigned(out, value); }
+
+template <typename ValueType>
+void append_value(std::string& out, const cusp::complex<ValueType>& value, const int precision)
+{
+    append_value(out, value.real(), precision);
+    out.push_back(' ');
+    append_value(out, value.imag(), precision);
+}
+
+} // end namespace detail
+} // end namespace io
+} // end namespace cusp
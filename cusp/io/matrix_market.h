@@ -26,6 +26,10 @@
 
 namespace cusp
 {
+
+class communicator;
+class distribution;
+
 namespace io
 {
 
@@ -42,6 +46,11 @@ namespace io
  * \tparam Matrix matrix container
  *
  * \note any contents of \p mtx will be overwritten
+ * \note "symmetric" matrices are expanded to full storage, except when
+ *  \p mtx is a \p symmetric_csr_matrix
+ * \note gzip and zstd-compressed files are decompressed on a separate
+ *  thread while they are parsed, which requires \c CUSP_USE_ZLIB or
+ *  \c CUSP_USE_ZSTD respectively
  *
  * \code
  * #include <cusp/io/matrix_market.h>
@@ -92,8 +101,75 @@ void read_matrix_market_file(Matrix& mtx, const std::string& filename);
 template <typename Matrix, typename Stream>
 void read_matrix_market_stream(Matrix& mtx, Stream& input);
 
+/*! \p read_matrix_market_file : Read the rows of a MatrixMarket file
+ *  that belong to the calling process.
+ *
+ * \param mtx a matrix container (e.g. \p csr_matrix or \p coo_matrix)
+ * \param filename file name of the MatrixMarket file
+ * \param d distribution of the rows of the file
+ * \tparam Matrix matrix container
+ *
+ *  \p mtx receives the rows [d.begin(p), d.end(p)) of the ranges \c p
+ *  of the calling process, one after the other, with the columns of
+ *  the file, as required by the constructor of
+ *  \p distributed_csr_matrix from a distribution.  The file must be in
+ *  coordinate format and is read as a stream, so no process stores the
+ *  entries of other processes.
+ *
+ * \note any contents of \p mtx will be overwritten
+ * \note "symmetric" matrices are expanded to full storage
+ *
+ * \see \p distribution
+ */
+template <typename Matrix>
+void read_matrix_market_file(Matrix& mtx, const std::string& filename, const cusp::distribution& d);
+
+/*! \p read_matrix_market_file : Split the rows of a MatrixMarket file
+ *  evenly across the processes of a communicator and read those of the
+ *  calling process.  Collective on the communicator.
+ *
+ * \param mtx a matrix container (e.g. \p csr_matrix or \p coo_matrix)
+ * \param d receives the distribution of the rows, one range per process
+ * \param filename file name of the MatrixMarket file
+ * \param comm processes that read the file
+ * \param device device of the range of the calling process
+ * \tparam Matrix matrix container
+ *
+ * \code
+ * #include <cusp/io/matrix_market.h>
+ * #include <cusp/csr_matrix.h>
+ * #include <cusp/distributed_csr_matrix.h>
+ *
+ * int main(int argc, char ** argv)
+ * {
+ *     MPI_Init(&argc, &argv);
+ *     {
+ *         cusp::communicator comm(MPI_COMM_WORLD);
+ *
+ *         cusp::csr_matrix<int, float, cusp::host_memory> rows;
+ *         cusp::distribution d;
+ *         cusp::io::read_matrix_market_file(rows, d, "A.mtx", comm, 0);
+ *
+ *         cusp::distributed_csr_matrix<int, float, cusp::distributed_memory> A(rows, d);
+ *     }
+ *     MPI_Finalize();
+ *
+ *     return 0;
+ * }
+ * \endcode
+ */
+template <typename Matrix>
+void read_matrix_market_file(Matrix& mtx, cusp::distribution& d,
+                             const std::string& filename,
+                             const cusp::communicator& comm, int device);
+
 
 /*! \p write_matrix_market_file : Write a MatrixMarket file
+ *
+ * Values are written with the precision of the stream.  Sparse matrices in
+ * device memory are converted to coordinate format on the device and
+ * copied to the host in chunks through pinned staging buffers, which are
+ * formatted in parallel while the next chunk is copied.
  *
  * \param mtx a matrix container (e.g. \p csr_matrix or \p coo_matrix)
  * \param filename file name of the MatrixMarket file
@@ -0,0 +1,180 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file jds_matrix.h
+ *  \brief Jagged diagonal (JDS) matrix format.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/format.h>
+#include <cusp/detail/matrix_base.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p jds_matrix : Jagged diagonal (JDS) matrix container
+ *
+ * The rows are sorted by decreasing length and stored column-major like
+ * an ELL matrix whose columns, the jagged diagonals, only extend over
+ * the rows that are long enough: diagonal \c n holds the \c n-th entry of
+ * every row with more than \c n entries.  Since these rows lead the
+ * order, each diagonal is contiguous and no storage is padded, unlike
+ * ELL and unlike the COO portion of HYB for matrices whose row lengths
+ * vary a lot.  \p row_permutation maps the position of a row in this
+ * order to its index in the matrix, and the product is scattered back
+ * through it.
+ *
+ * The \c n-th entry of the row at position \c k is stored at
+ * <tt>diagonal_offsets[n] + k</tt>, provided that this is less than
+ * <tt>diagonal_offsets[n+1]</tt>.
+ *
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ *  \code
+ *  #include <cusp/jds_matrix.h>
+ *  #include <cusp/csr_matrix.h>
+ *  ...
+ *
+ *  cusp::csr_matrix<int,float,cusp::host_memory> A = ...;
+ *
+ *  // sort the rows once, then multiply many times
+ *  cusp::jds_matrix<int,float,cusp::device_memory> B(A);
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class jds_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::jds_format>
+{
+  typedef cusp::detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::jds_format> Parent;
+  public:
+    /*! rebind matrix to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::jds_matrix<IndexType, ValueType, MemorySpace2> type; };
+
+    /*! type of row permutation and diagonal offsets arrays
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> index_array_type;
+
+    /*! type of column indices array
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> column_indices_array_type;
+
+    /*! type of values array
+     */
+    typedef typename cusp::array1d<ValueType, MemorySpace> values_array_type;
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::jds_matrix<IndexType, ValueType, MemorySpace> container;
+
+    /*! Matrix row stored at each position of the sorted order.
+     */
+    index_array_type row_permutation;
+
+    /*! Offset of the first entry of each jagged diagonal in
+     *  \p column_indices and \p values.
+     */
+    index_array_type diagonal_offsets;
+
+    /*! Storage for the column indices of the JDS data structure.
+     */
+    column_indices_array_type column_indices;
+
+    /*! Storage for the values of the JDS data structure.
+     */
+    values_array_type values;
+
+    /*! Construct an empty \p jds_matrix.
+     */
+    jds_matrix() : diagonal_offsets(1, IndexType(0)) {}
+
+    /*! Construct a \p jds_matrix with a specific shape and storage.
+     *
+     *  \param num_rows Number of rows.
+     *  \param num_cols Number of columns.
+     *  \param num_entries Number of nonzero matrix entries.
+     *  \param num_diagonals Number of jagged diagonals, i.e. the length
+     *  of the longest row.
+     */
+    jds_matrix(size_t num_rows, size_t num_cols, size_t num_entries, size_t num_diagonals)
+      : Parent(num_rows, num_cols, num_entries),
+        row_permutation(num_rows),
+        diagonal_offsets(num_diagonals + 1),
+        column_indices(num_entries),
+        values(num_entries) {}
+
+    /*! Construct a \p jds_matrix from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    jds_matrix(const MatrixType& matrix);
+
+    /*! Number of jagged diagonals.
+     */
+    size_t num_diagonals(void) const { return diagonal_offsets.size() - 1; }
+
+    /*! Resize matrix dimensions and underlying storage
+     */
+    void resize(size_t num_rows, size_t num_cols, size_t num_entries, size_t num_diagonals)
+    {
+      Parent::resize(num_rows, num_cols, num_entries);
+      row_permutation.resize(num_rows);
+      diagonal_offsets.resize(num_diagonals + 1);
+      column_indices.resize(num_entries);
+      values.resize(num_entries);
+    }
+
+    /*! Swap the contents of two \p jds_matrix objects.
+     *
+     *  \param matrix Another \p jds_matrix with the same IndexType and ValueType.
+     */
+    void swap(jds_matrix& matrix)
+    {
+      Parent::swap(matrix);
+      row_permutation.swap(matrix.row_permutation);
+      diagonal_offsets.swap(matrix.diagonal_offsets);
+      column_indices.swap(matrix.column_indices);
+      values.swap(matrix.values);
+    }
+
+    /*! Assignment from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    jds_matrix& operator=(const MatrixType& matrix);
+}; // class jds_matrix
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/jds_matrix.inl>
@@ -21,118 +21,247 @@
 
 #include <cusp/multiply.h>
 #include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/krylov/gmres.h>
+#include <cusp/krylov/detail/block_krylov.h>
 #include <cusp/detail/random.h>
 
+#include <thrust/for_each.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <cmath>
+
 namespace cusp
 {
 namespace krylov
 {
 
+// The Krylov basis is generated in the memory space of the matrix.  The
+// entries of the Hessenberg (or tridiagonal) matrix are reduced into a
+// copy of it in the same memory space, by the block Gram-Schmidt kernels
+// of GMRES, and read from there by the kernels that normalize the basis
+// vectors.  Hence a step costs a SpMV and a few kernels without waiting
+// for the device, and the small matrix is copied to the host once at the
+// end, where the basis is truncated at the first breakdown.
+namespace detail_arnoldi
+{
+    template <typename ValueType>
+    struct square_root
+    {
+        __host__ __device__
+        ValueType operator()(const ValueType x) const
+        {
+            return sqrt(x);
+        }
+    };
+
+    // w <- w / norm, or w <- 0 after a breakdown, so that the remaining
+    // steps work on zeros and the discarded entries stay finite
+    template <typename ValueType>
+    struct divide_by_norm
+    {
+        const ValueType * norm;
+        ValueType tolerance;
+
+        divide_by_norm(const ValueType * norm, const ValueType tolerance)
+            : norm(norm), tolerance(tolerance) {}
+
+        __host__ __device__
+        ValueType operator()(const ValueType x) const
+        {
+            return *norm < tolerance ? ValueType(0) : x / *norm;
+        }
+    };
+
+    // w <- w - alpha v1 - beta v0, where beta is absent in the first step
+    template <typename ValueType>
+    struct lanczos_subtract
+    {
+        const ValueType * alpha;
+        const ValueType * beta;
+
+        lanczos_subtract(const ValueType * alpha, const ValueType * beta)
+            : alpha(alpha), beta(beta) {}
+
+        template <typename Tuple>
+        __host__ __device__
+        void operator()(Tuple t) const
+        {
+            ValueType w = thrust::get<0>(t) - *alpha * thrust::get<1>(t);
+
+            if (beta != 0)
+                w = w - *beta * thrust::get<2>(t);
+
+            thrust::get<0>(t) = w;
+        }
+    };
+
+    // norm <- ||w||, w <- w / norm, where norm is a single element view
+    template <typename Array, typename View>
+    void normalize(Array& w, View norm, const double tolerance)
+    {
+        typedef typename Array::value_type ValueType;
+
+        detail_gmres::coefficients(detail_block::column_matrix(w.begin(), w.end()), 1, w, norm);
+
+        thrust::transform(norm.begin(), norm.end(), norm.begin(), square_root<ValueType>());
+        thrust::transform(w.begin(), w.end(), w.begin(),
+                          divide_by_norm<ValueType>(thrust::raw_pointer_cast(&norm[0]), ValueType(tolerance)));
+    }
+
+    // number of steps before the first subdiagonal entry below the tolerance
+    template <typename HostArray2d>
+    size_t breakdown(const HostArray2d& H, const double tolerance)
+    {
+        size_t j = 0;
+
+        while (j < H.num_cols && !(H(j + 1, j) < tolerance))
+            j++;
+
+        return j;
+    }
+} // end namespace detail_arnoldi
+
 template <typename Matrix, typename Array2d>
 void lanczos(const Matrix& A, Array2d& H, size_t k = 10)
 {
-	typedef typename Matrix::value_type   ValueType;
-	typedef typename Matrix::memory_space MemorySpace;
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
 
-	size_t N = A.num_cols;
-	size_t maxiter = std::min(N, k);
+    typedef typename cusp::array2d<ValueType,MemorySpace,cusp::column_major>::column_view Column;
+    typedef typename cusp::array1d<ValueType,MemorySpace>::view                       View;
 
-    // allocate workspace
-	cusp::array1d<ValueType,MemorySpace> v0(N);
-    cusp::array1d<ValueType,MemorySpace> v1(N);
-	cusp::array1d<ValueType,MemorySpace> w(N);
-    
-    // initialize starting vector to random values in [0,1)
-    cusp::copy(cusp::detail::random_reals<ValueType>(N), v1);
+    const double tolerance = 1e-10;
 
-	cusp::blas::scal(v1, ValueType(1) / cusp::blas::nrm2(v1));
+    const size_t N = A.num_cols;
+    const size_t maxiter = std::min(N, k);
 
-	Array2d H_(maxiter + 1, maxiter, 0);
+    if (maxiter == 0)
+    {
+        H.resize(0,0);
+        return;
+    }
 
-	ValueType alpha = 0.0, beta = 0.0;
+    // workspace [v0 v1 w], whose columns are rotated after each step
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> W(N, 3, ValueType(0));
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> H_(maxiter + 1, maxiter, ValueType(0));
 
-	size_t j;
+    size_t p0 = 0, p1 = 1, p2 = 2;
 
-	for(j = 0; j < maxiter; j++)
-	{
-		cusp::multiply(A, v1, w);
+    // initialize starting vector to random values in [0,1) and normalize
+    // it, using H_(0,0) for its norm until the first step overwrites it
+    Column v = W.column(p1);
+    cusp::copy(cusp::detail::random_reals<ValueType>(N), v);
+    detail_arnoldi::normalize(v, View(H_.values.begin(), H_.values.begin() + 1), tolerance);
 
-		if(j >= 1)
-		{
-			H_(j - 1, j) = beta;
-			cusp::blas::axpy(v0, w, -beta);
-		}
+    const ValueType * H_ptr = thrust::raw_pointer_cast(&H_.values[0]);
 
-		alpha = cusp::blas::dot(w, v1);
-		H_(j,j) = alpha;
+    for(size_t j = 0; j < maxiter; j++)
+    {
+        Column v0 = W.column(p0);
+        Column v1 = W.column(p1);
+        Column w  = W.column(p2);
 
-		cusp::blas::axpy(v1, w, -alpha);
+        cusp::multiply(A, v1, w);
 
-		beta = cusp::blas::nrm2(w);
-		H_(j + 1, j) = beta;
+        // H_(j,j) <- <w,v1>, w <- w - H_(j,j) v1 - H_(j,j-1) v0
+        View alpha(H_.column(j).begin() + j, H_.column(j).begin() + j + 1);
+        detail_gmres::coefficients(detail_block::columns(W, p1, p1 + 1), 1, w, alpha);
 
-		if(beta < 1e-10) break;
+        thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(w.begin(), v1.begin(), v0.begin())),
+                         thrust::make_zip_iterator(thrust::make_tuple(w.end(),   v1.end(),   v0.end())),
+                         detail_arnoldi::lanczos_subtract<ValueType>(H_ptr + j * H_.pitch + j,
+                                                                     j == 0 ? 0 : H_ptr + (j - 1) * H_.pitch + j));
 
-		cusp::blas::scal(w, ValueType(1) / beta);				
+        // H_(j+1,j) <- ||w||, w <- w / H_(j+1,j)
+        detail_arnoldi::normalize(w, View(H_.column(j).begin() + j + 1, H_.column(j).begin() + j + 2), tolerance);
 
         // [v0 v1  w] - > [v1  w v0]
-        v0.swap(v1);
-        v1.swap(w);
-	}
-
-	H.resize(j,j);
-	for(size_t row = 0; row < j; row++)
-		for(size_t col = 0; col < j; col++)
-			H(row,col) = H_(row,col);
-}
-
-template <typename Matrix, typename Array2d>
-void arnoldi(const Matrix& A, Array2d& H, size_t k = 10)
-{
-	typedef typename Matrix::value_type   ValueType;
-	typedef typename Matrix::memory_space MemorySpace;
-
-	size_t N = A.num_rows;
+        const size_t p = p0; p0 = p1; p1 = p2; p2 = p;
+    }
 
-	size_t maxiter = std::min(N, k);
+    // the only transfer to the host
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> H_host(H_);
 
-	Array2d H_(maxiter + 1, maxiter, 0);
+    const size_t j = detail_arnoldi::breakdown(H_host, tolerance);
 
-    // allocate workspace of k + 1 vectors
-    std::vector< cusp::array1d<ValueType,MemorySpace> > V(maxiter + 1);
-    for (size_t i = 0; i < maxiter + 1; i++)
-        V[i].resize(N);
-	
-    // initialize starting vector to random values in [0,1)
-    cusp::copy(cusp::detail::random_reals<ValueType>(N), V[0]);
+    H.resize(j,j);
+    for(size_t row = 0; row < j; row++)
+        for(size_t col = 0; col < j; col++)
+            H(row,col) = ValueType(0);
 
-    // normalize v0
-	cusp::blas::scal(V[0], ValueType(1) / cusp::blas::nrm2(V[0]));	
+    for(size_t col = 0; col < j; col++)
+    {
+        H(col,col) = H_host(col,col);
 
-	size_t j;
-
-	for(j = 0; j < maxiter; j++)
-	{
-		cusp::multiply(A, V[j], V[j + 1]);
-
-		for(size_t i = 0; i <= j; i++)
-		{
-			H_(i,j) = cusp::blas::dot(V[i], V[j + 1]);
-
-			cusp::blas::axpy(V[i], V[j + 1], -H_(i,j));
-		}
-
-		H_(j+1,j) = cusp::blas::nrm2(V[j + 1]);
-
-		if(H_(j+1,j) < 1e-10) break;
-
-		cusp::blas::scal(V[j + 1], ValueType(1) / H_(j+1,j));
-	}
+        if (col + 1 < j)
+        {
+            H(col + 1,col) = H_host(col + 1,col);
+            H(col,col + 1) = H_host(col + 1,col);
+        }
+    }
+}
 
-	H.resize(j,j);
-	for( size_t row = 0; row < j; row++ )
-		for( size_t col = 0; col < j; col++ )
-			H(row,col) = H_(row,col);
+template <typename Matrix, typename Array2d>
+void arnoldi(const Matrix& A, Array2d& H, size_t k = 10)
+{
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    typedef typename cusp::array2d<ValueType,MemorySpace,cusp::column_major>::column_view Column;
+    typedef typename cusp::array1d<ValueType,MemorySpace>::view                       View;
+
+    const double tolerance = 1e-10;
+
+    const size_t N = A.num_rows;
+    const size_t maxiter = std::min(N, k);
+
+    if (maxiter == 0)
+    {
+        H.resize(0,0);
+        return;
+    }
+
+    // workspace of k + 1 vectors
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> V(N, maxiter + 1, ValueType(0));
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> H_(maxiter + 1, maxiter, ValueType(0));
+    cusp::array1d<ValueType,MemorySpace> h(maxiter);
+
+    // initialize starting vector to random values in [0,1) and normalize
+    // it, using H_(0,0) for its norm until the first step overwrites it
+    Column v = V.column(0);
+    cusp::copy(cusp::detail::random_reals<ValueType>(N), v);
+    detail_arnoldi::normalize(v, View(H_.values.begin(), H_.values.begin() + 1), tolerance);
+
+    for(size_t j = 0; j < maxiter; j++)
+    {
+        Column v_j = V.column(j);
+        Column w   = V.column(j + 1);
+        Column h_j = H_.column(j);
+
+        cusp::multiply(A, v_j, w);
+
+        // H_(0:j,j) = V(0:j)^H w
+        // w -= V(0:j) * H_(0:j,j)
+        // repeated once (CGS2) to retain the orthogonality of MGS
+        detail_gmres::project(V, j + 1, w, h_j);
+        detail_gmres::project(V, j + 1, w, h);
+        cusp::blas::axpy(View(h.begin(), h.begin() + j + 1), View(h_j.begin(), h_j.begin() + j + 1), ValueType(1));
+
+        // H_(j+1,j) <- ||w||, w <- w / H_(j+1,j)
+        detail_arnoldi::normalize(w, View(h_j.begin() + j + 1, h_j.begin() + j + 2), tolerance);
+    }
+
+    // the only transfer to the host
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> H_host(H_);
+
+    const size_t j = detail_arnoldi::breakdown(H_host, tolerance);
+
+    H.resize(j,j);
+    for( size_t row = 0; row < j; row++ )
+        for( size_t col = 0; col < j; col++ )
+            H(row,col) = H_host(row,col);
 }
 
 } // end namespace krylov
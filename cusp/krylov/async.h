@@ -0,0 +1,176 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file async.h
+ *  \brief Krylov solves that proceed asynchronously to the caller
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/stream.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace krylov
+{
+namespace detail_async
+{
+class async_state;
+} // end namespace detail_async
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p solve_handle : handle to a solve that proceeds asynchronously
+ *
+ *  Returned by \p cg_async, \p bicgstab_async and \p gmres_async.  The
+ *  solve runs on a host thread of its own and issues its device work on
+ *  the given stream, so the caller may prepare the next system or issue
+ *  other device work meanwhile.  Copies of a handle refer to the same
+ *  solve.
+ *
+ *  The operands of the solve (matrix, vectors, monitor and
+ *  preconditioner) are used by reference and must neither be destroyed
+ *  nor accessed until the solve has finished.  The destructor of the
+ *  last handle waits for the solve, like a \c std::future returned by
+ *  \c std::async.
+ *
+ *  \code
+ *  cusp::default_monitor<float> monitor(b, 100, 1e-6);
+ *  cusp::identity_operator<float, cusp::device_memory> M(A.num_rows, A.num_rows);
+ *
+ *  cusp::krylov::solve_handle solve = cusp::krylov::cg_async(A, x, b, monitor, M, stream);
+ *
+ *  // assemble the next system while the solve proceeds
+ *
+ *  solve.wait();
+ *  std::cout << solve.iteration_count() << " iterations" << std::endl;
+ *  \endcode
+ *
+ *  \see \p scoped_stream
+ */
+class solve_handle
+{
+    public:
+
+    /*! construct a handle without a solve
+     */
+    solve_handle(void);
+
+    solve_handle(const solve_handle& other);
+
+    solve_handle& operator=(const solve_handle& other);
+
+    /*! waits for the solve when this is its last handle
+     */
+    ~solve_handle(void);
+
+    /*! whether the handle refers to a solve
+     */
+    bool valid(void) const;
+
+    /*! whether the solve has finished, without blocking
+     */
+    bool ready(void) const;
+
+    /*! block until the solve has finished.  An exception thrown by the
+     *  solve is rethrown as a \p runtime_exception with its message.
+     */
+    void wait(void) const;
+
+    /*! number of iterations of the finished solve (waits for the solve)
+     */
+    size_t iteration_count(void) const;
+
+    /*! whether the finished solve converged (waits for the solve)
+     */
+    bool converged(void) const;
+
+    /*! used by the \p *_async functions
+     */
+    explicit solve_handle(detail_async::async_state * state);
+
+    private:
+    detail_async::async_state * state;
+
+    void release(void);
+};
+
+/*! \p cg_async : issue \p cg(A,x,b,monitor,M,stream) and return without
+ *  waiting for it
+ *
+ *  \see \p cg
+ *  \see \p solve_handle
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+solve_handle cg_async(LinearOperator& A,
+                      Vector& x,
+                      Vector& b,
+                      Monitor& monitor,
+                      Preconditioner& M,
+                      cudaStream_t stream);
+
+/*! \p bicgstab_async : issue \p bicgstab(A,x,b,monitor,M,stream) and
+ *  return without waiting for it
+ *
+ *  \see \p bicgstab
+ *  \see \p solve_handle
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+solve_handle bicgstab_async(LinearOperator& A,
+                            Vector& x,
+                            Vector& b,
+                            Monitor& monitor,
+                            Preconditioner& M,
+                            cudaStream_t stream);
+
+/*! \p gmres_async : issue \p gmres(A,x,b,restart,monitor,M,stream) and
+ *  return without waiting for it
+ *
+ *  \see \p gmres
+ *  \see \p solve_handle
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+solve_handle gmres_async(LinearOperator& A,
+                         Vector& x,
+                         Vector& b,
+                         const size_t restart,
+                         Monitor& monitor,
+                         Preconditioner& M,
+                         cudaStream_t stream);
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/async.inl>
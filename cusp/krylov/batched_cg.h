@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file batched_cg.h
+ *  \brief Conjugate Gradient method for many independent systems
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p batched_cg : Conjugate Gradient method for a batch of independent
+ *  systems
+ *
+ * Solves the symmetric, positive-definite linear systems A_i x_i = b_i,
+ * i = 0, ..., num_systems - 1, which are stored as a single block-diagonal
+ * matrix A.  The rows of system i are given by the half-open range
+ * [system_offsets[i], system_offsets[i+1]).
+ *
+ * All systems advance together: each iteration performs a single
+ * matrix-vector multiplication with A and a fixed number of kernels that
+ * update every system at once, regardless of the number of systems.
+ * Systems that have converged are masked out of subsequent updates.
+ * This turns many small launch-bound solves into a single bandwidth-bound
+ * one.
+ *
+ * System i has converged when its residual satisfies
+ *      ||b_i - A_i x_i|| <= absolute_tolerance + relative_tolerance * ||b_i||
+ *
+ * \param A block-diagonal matrix of the linear systems
+ * \param x solutions of the systems, also used as the initial guess
+ * \param b right-hand sides of the systems
+ * \param system_offsets array of size num_systems + 1 delimiting the systems
+ * \param iteration_counts number of iterations performed by each system (output)
+ * \param iteration_limit maximum number of iterations of any system
+ * \param relative_tolerance determines convergence criteria
+ * \param absolute_tolerance determines convergence criteria
+ *
+ * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam Vector vector
+ * \tparam IndexArray1 array of integers
+ * \tparam IndexArray2 array of integers
+ *
+ *  The following code snippet demonstrates how to use \p batched_cg to
+ *  solve two 2x2 systems.
+ *
+ *  \code
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/krylov/batched_cg.h>
+ *
+ *  int main(void)
+ *  {
+ *      // block-diagonal matrix holding both systems
+ *      cusp::array2d<float, cusp::host_memory> M(4,4,0);
+ *      M(0,0) = 4; M(0,1) = 1; M(1,0) = 1; M(1,1) = 3;
+ *      M(2,2) = 2; M(2,3) = 1; M(3,2) = 1; M(3,3) = 2;
+ *
+ *      cusp::csr_matrix<int, float, cusp::device_memory> A(M);
+ *
+ *      cusp::array1d<int, cusp::device_memory> offsets(3);
+ *      offsets[0] = 0; offsets[1] = 2; offsets[2] = 4;
+ *
+ *      cusp::array1d<float, cusp::device_memory> x(4, 0);
+ *      cusp::array1d<float, cusp::device_memory> b(4, 1);
+ *
+ *      cusp::array1d<int, cusp::host_memory> iterations;
+ *
+ *      cusp::krylov::batched_cg(A, x, b, offsets, iterations);
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ */
+template <class LinearOperator,
+          class Vector,
+          class IndexArray1,
+          class IndexArray2>
+void batched_cg(LinearOperator& A,
+                Vector& x,
+                Vector& b,
+                const IndexArray1& system_offsets,
+                IndexArray2& iteration_counts,
+                size_t iteration_limit = 500,
+                double relative_tolerance = 1e-5,
+                double absolute_tolerance = 0);
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/batched_cg.inl>
+
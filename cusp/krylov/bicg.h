@@ -37,9 +37,10 @@ namespace krylov
  * Solves the linear system A x = b using the default convergence criteria.
  */
 template <class LinearOperator,
+          class TransposeOperator,
           class Vector>
 void bicg(LinearOperator& A,
-	  LinearOperator& At,
+	  TransposeOperator& At,
 	  Vector& x,
 	  Vector& b);
 
@@ -48,10 +49,11 @@ void bicg(LinearOperator& A,
  * Solves the linear system A x = b without preconditioning.
  */
 template <class LinearOperator,
+          class TransposeOperator,
           class Vector,
           class Monitor>
 void bicg(LinearOperator& A,
-	  LinearOperator& At,
+	  TransposeOperator& At,
 	  Vector& x,
 	  Vector& b,
 	  Monitor& monitor);
@@ -69,6 +71,8 @@ void bicg(LinearOperator& A,
  * \param Mt conjugate tranpose of the preconditioner for A
  *
  * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam TransposeOperator is a matrix, subclass of \p linear_operator or
+ *  \p transpose_matrix_view
  * \tparam Vector vector
  * \tparam Monitor is a monitor such as \p default_monitor or \p verbose_monitor
  * \tparam Preconditioner is a matrix or subclass of \p linear_operator
@@ -111,15 +115,25 @@ void bicg(LinearOperator& A,
  *  }
  *  \endcode
  *
+ *  For a real nonsymmetric matrix, a \p transpose_matrix_view of \p A
+ *  can be passed as \p At to apply the transpose without storing it:
+ *
+ *  \code
+ *  cusp::transpose_matrix_view< cusp::csr_matrix<int, float, cusp::device_memory> > At(A);
+ *  cusp::krylov::bicg(A, At, x, b, monitor, M, M);
+ *  \endcode
+ *
  *  \see \p default_monitor
  *  \see \p verbose_monitor
+ *  \see \p transpose_view
  */
 template <class LinearOperator,
+          class TransposeOperator,
           class Vector,
           class Monitor,
           class Preconditioner>
   void bicg(LinearOperator& A,
-	    LinearOperator& At,
+	    TransposeOperator& At,
 	    Vector& x,
 	    Vector& b,
 	    Monitor& monitor,
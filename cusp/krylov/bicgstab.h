@@ -22,6 +22,9 @@
 
 #include <cusp/detail/config.h>
 
+#include <cusp/array1d.h>
+#include <cusp/stream.h>
+
 namespace cusp
 {
 namespace krylov
@@ -117,6 +120,80 @@ void bicgstab(LinearOperator& A,
               Vector& b,
               Monitor& monitor,
               Preconditioner& M);
+
+/*! \p bicgstab : issue all device work of the solve on a given CUDA stream
+ *
+ *  Equivalent to calling \p bicgstab(A,x,b,monitor,M) within a
+ *  \p scoped_stream.  Independent solves issued on different streams
+ *  may execute concurrently.
+ *
+ *  \see \p scoped_stream
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void bicgstab(LinearOperator& A,
+              Vector& x,
+              Vector& b,
+              Monitor& monitor,
+              Preconditioner& M,
+              cudaStream_t stream);
+
+/*! \p bicgstab_solver : BiConjugate Gradient Stabilized method with a
+ *  persistent workspace
+ *
+ *  The work vectors are allocated once and reused for every subsequent
+ *  solve of the same (or a smaller) size.
+ *
+ *  \tparam ValueType scalar type of the linear systems
+ *  \tparam MemorySpace memory space of the linear systems
+ *
+ *  \see \p bicgstab
+ *  \see \p cg_solver
+ */
+template <typename ValueType, typename MemorySpace>
+class bicgstab_solver
+{
+    cusp::array1d<ValueType,MemorySpace> y;
+    cusp::array1d<ValueType,MemorySpace> p;
+    cusp::array1d<ValueType,MemorySpace> r;
+    cusp::array1d<ValueType,MemorySpace> r_star;
+    cusp::array1d<ValueType,MemorySpace> s;
+    cusp::array1d<ValueType,MemorySpace> Mp;
+    cusp::array1d<ValueType,MemorySpace> AMp;
+    cusp::array1d<ValueType,MemorySpace> Ms;
+    cusp::array1d<ValueType,MemorySpace> AMs;
+
+    public:
+
+    /*! construct a \p bicgstab_solver with an empty workspace
+     */
+    bicgstab_solver(void) {}
+
+    /*! construct a \p bicgstab_solver with a workspace for \p N unknowns
+     */
+    bicgstab_solver(size_t N);
+
+    /*! resize the workspace for \p N unknowns
+     */
+    void resize(size_t N);
+
+    /*! solve A x = b using the default convergence criteria
+     */
+    template <class LinearOperator, class Vector>
+    void solve(LinearOperator& A, Vector& x, Vector& b);
+
+    /*! solve A x = b without preconditioning
+     */
+    template <class LinearOperator, class Vector, class Monitor>
+    void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor);
+
+    /*! solve A x = b with preconditioner \p M
+     */
+    template <class LinearOperator, class Vector, class Monitor, class Preconditioner>
+    void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor, Preconditioner& M);
+};
 /*! \}
  */
 
@@ -0,0 +1,170 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file bicgstabl.h
+ *  \brief Biconjugate Gradient Stabilized (BiCGStab(l)) method
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p bicgstabl : BiCGStab(l) method
+ *
+ * Solves the linear system A x = b using the default convergence criteria.
+ */
+template <class LinearOperator,
+          class Vector>
+void bicgstabl(LinearOperator& A,
+               Vector& x,
+               Vector& b,
+               const size_t l);
+
+/*! \p bicgstabl : BiCGStab(l) method
+ *
+ * Solves the linear system A x = b without preconditioning.
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor>
+void bicgstabl(LinearOperator& A,
+               Vector& x,
+               Vector& b,
+               const size_t l,
+               Monitor& monitor);
+
+/*! \p bicgstabl : BiCGStab(l) method
+ *
+ * Solves the linear system A x = b with right preconditioner \p M.
+ *
+ * A cycle performs l BiCG steps followed by a minimal residual
+ * polynomial of degree l, instead of the degree 1 polynomial of
+ * \p bicgstab, whose real roots stall on matrices with eigenvalues far
+ * from the real axis, such as those of convection-dominated problems.
+ * The residuals and search directions of a cycle are the columns of
+ * two contiguous column-major \p array2d: the BiCG steps update all
+ * columns in a single pass and the l x l least squares problem of the
+ * polynomial is formed with l batched reductions and solved on the
+ * host.  Each BiCG step, which counts as one iteration, costs two
+ * products with A and M.  l = 1 is equivalent to \p bicgstab, while
+ * l = 2 or 4 is common.
+ *
+ * \param A matrix of the linear system
+ * \param x approximate solution of the linear system
+ * \param b right-hand side of the linear system
+ * \param l degree of the minimal residual polynomial
+ * \param monitor montiors iteration and determines stopping conditions
+ * \param M preconditioner for A
+ *
+ * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam Vector vector
+ * \tparam Monitor is a monitor such as \p default_monitor or \p verbose_monitor
+ * \tparam Preconditioner is a matrix or subclass of \p linear_operator
+ *
+ * \note The workspace holds 2 l + 5 vectors.  The small dense solve is
+ * real-valued, so the value type is \c float or \c double.
+ *
+ *  \see \p bicgstab
+ *  \see \p idrs
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void bicgstabl(LinearOperator& A,
+               Vector& x,
+               Vector& b,
+               const size_t l,
+               Monitor& monitor,
+               Preconditioner& M);
+
+/*! \p bicgstabl_solver : BiCGStab(l) method with a persistent workspace
+ *
+ *  The work vectors are allocated once and reused for every subsequent
+ *  solve of the same (or a smaller) size and degree.
+ *
+ *  \tparam ValueType scalar type of the linear systems
+ *  \tparam MemorySpace memory space of the linear systems
+ *
+ *  \see \p bicgstabl
+ *  \see \p bicgstab_solver
+ */
+template <typename ValueType, typename MemorySpace>
+class bicgstabl_solver
+{
+    size_t l;
+
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> R;  // residuals
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> U;  // search directions
+    cusp::array1d<ValueType,MemorySpace> r_star;
+    cusp::array1d<ValueType,MemorySpace> y;                     // preconditioned update of x
+    cusp::array1d<ValueType,MemorySpace> t;
+    cusp::array1d<ValueType,MemorySpace> h;
+    cusp::array1d<ValueType,cusp::host_memory> hHost;
+
+    public:
+
+    /*! construct a \p bicgstabl_solver with an empty workspace and
+     *  degree 2
+     */
+    bicgstabl_solver(void) : l(2) {}
+
+    /*! construct a \p bicgstabl_solver with a workspace for \p N unknowns
+     *  and degree \p l
+     */
+    bicgstabl_solver(size_t N, size_t l);
+
+    /*! resize the workspace for \p N unknowns and degree \p l
+     */
+    void resize(size_t N, size_t l);
+
+    /*! solve A x = b using the default convergence criteria
+     */
+    template <class LinearOperator, class Vector>
+    void solve(LinearOperator& A, Vector& x, Vector& b);
+
+    /*! solve A x = b without preconditioning
+     */
+    template <class LinearOperator, class Vector, class Monitor>
+    void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor);
+
+    /*! solve A x = b with preconditioner \p M
+     */
+    template <class LinearOperator, class Vector, class Monitor, class Preconditioner>
+    void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor, Preconditioner& M);
+};
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/bicgstabl.inl>
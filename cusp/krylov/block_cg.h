@@ -0,0 +1,142 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file block_cg.h
+ *  \brief Block Conjugate Gradient method for multiple right-hand sides
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p block_cg : Block Conjugate Gradient method
+ *
+ * Solves the symmetric, positive-definite linear system A X = B
+ * using the default convergence criteria.
+ */
+template <class LinearOperator,
+          class Matrix>
+void block_cg(LinearOperator& A,
+              Matrix& X,
+              Matrix& B);
+
+/*! \p block_cg : Block Conjugate Gradient method
+ *
+ * Solves the symmetric, positive-definite linear system A X = B
+ * without preconditioning.
+ */
+template <class LinearOperator,
+          class Matrix,
+          class Monitor>
+void block_cg(LinearOperator& A,
+              Matrix& X,
+              Matrix& B,
+              Monitor& monitor);
+
+/*! \p block_cg : Block Conjugate Gradient method
+ *
+ * Solves the symmetric, positive-definite linear system A X = B, where
+ * each column of B is a right-hand side, with preconditioner \p M.
+ *
+ * All columns share one block Krylov space (O'Leary's block CG), so each
+ * iteration performs a single sparse matrix times dense matrix product
+ * (SpMM) with A and the inner products of the method become small dense
+ * matrix products P^H Q.  Columns are tracked separately by the monitor;
+ * once a column converges it is removed (deflated) from the block and
+ * the iteration is restarted with the remaining columns.
+ *
+ * \param A matrix of the linear system
+ * \param X approximate solutions of the linear system, one per column
+ * \param B right-hand sides of the linear system, one per column
+ * \param monitor monitors iteration and determines stopping conditions
+ * \param M preconditioner for A
+ *
+ * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam Matrix \p array2d
+ * \tparam Monitor is a monitor such as \p block_monitor
+ * \tparam Preconditioner is a matrix or subclass of \p linear_operator
+ *
+ * \note The right-hand sides must be linearly independent, and the small
+ * dense factorizations are real-valued, so the value type is \c float
+ * or \c double.  Iteration stops early if the block becomes singular.
+ *
+ *  The following code snippet demonstrates how to use \p block_cg to
+ *  solve a 10x10 Poisson problem with 8 right-hand sides.
+ *
+ *  \code
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/monitor.h>
+ *  #include <cusp/krylov/block_cg.h>
+ *  #include <cusp/gallery/poisson.h>
+ *
+ *  int main(void)
+ *  {
+ *      cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *      cusp::gallery::poisson5pt(A, 10, 10);
+ *
+ *      cusp::array2d<float, cusp::host_memory, cusp::column_major> H(A.num_rows, 8);
+ *      for (size_t i = 0; i < H.num_rows; i++)
+ *          for (size_t j = 0; j < H.num_cols; j++)
+ *              H(i,j) = (i % (j + 2)) + 1;
+ *
+ *      cusp::array2d<float, cusp::device_memory, cusp::column_major> X(A.num_rows, 8, 0);
+ *      cusp::array2d<float, cusp::device_memory, cusp::column_major> B(H);
+ *
+ *      // set stopping criteria for each column:
+ *      //  iteration_limit    = 100
+ *      //  relative_tolerance = 1e-6
+ *      cusp::block_monitor<float> monitor(B, 100, 1e-6);
+ *
+ *      // set preconditioner (identity)
+ *      cusp::identity_operator<float, cusp::device_memory> M(A.num_rows, A.num_rows);
+ *
+ *      // solve the linear systems A X = B
+ *      cusp::krylov::block_cg(A, X, B, monitor, M);
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ *
+ *  \see \p block_monitor
+ */
+template <class LinearOperator,
+          class Matrix,
+          class Monitor,
+          class Preconditioner>
+void block_cg(LinearOperator& A,
+              Matrix& X,
+              Matrix& B,
+              Monitor& monitor,
+              Preconditioner& M);
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/block_cg.inl>
+
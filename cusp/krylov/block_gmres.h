@@ -0,0 +1,148 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file block_gmres.h
+ *  \brief Block Generalized Minimum Residual method for multiple right-hand sides
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p block_gmres : Block GMRES method
+ *
+ * Solves the nonsymmetric, linear system A X = B
+ * using the default convergence criteria.
+ */
+template <class LinearOperator,
+          class Matrix>
+void block_gmres(LinearOperator& A,
+                 Matrix& X,
+                 Matrix& B,
+                 const size_t restart);
+
+/*! \p block_gmres : Block GMRES method
+ *
+ * Solves the nonsymmetric, linear system A X = B without preconditioning.
+ */
+template <class LinearOperator,
+          class Matrix,
+          class Monitor>
+void block_gmres(LinearOperator& A,
+                 Matrix& X,
+                 Matrix& B,
+                 const size_t restart,
+                 Monitor& monitor);
+
+/*! \p block_gmres : Block GMRES method
+ *
+ * Solves the nonsymmetric, linear system A X = B, where each column of B
+ * is a right-hand side, with right preconditioner \p M.
+ *
+ * The columns share one block Krylov space.  Each Arnoldi step performs
+ * a single sparse matrix times dense matrix product (SpMM) with A, and
+ * block Gram-Schmidt reduces the inner products against the basis to
+ * small dense matrix products V^H W.  The block Hessenberg least squares
+ * problem is solved on the host with Householder reflections, which also
+ * gives an estimate of the residual of every column after each step.
+ * The method is restarted after \p restart steps, or earlier when every
+ * estimate meets the tolerance of its column.  Columns that have
+ * converged at a restart are removed from the block (deflated).
+ *
+ * \param A matrix of the linear system
+ * \param X approximate solutions of the linear system, one per column
+ * \param B right-hand sides of the linear system, one per column
+ * \param restart the method every restart block steps
+ * \param monitor monitors iteration and determines stopping conditions
+ * \param M preconditioner for A
+ *
+ * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam Matrix \p array2d
+ * \tparam Monitor is a monitor such as \p block_monitor
+ * \tparam Preconditioner is a matrix or subclass of \p linear_operator
+ *
+ * \note The right-hand sides must be linearly independent, and the small
+ * dense factorizations are real-valued, so the value type is \c float
+ * or \c double.  The basis holds (restart + 1) blocks of as many columns
+ * as there are unconverged right-hand sides.
+ *
+ *  The following code snippet demonstrates how to use \p block_gmres to
+ *  solve a 10x10 Poisson problem with 8 right-hand sides.
+ *
+ *  \code
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/monitor.h>
+ *  #include <cusp/krylov/block_gmres.h>
+ *  #include <cusp/gallery/poisson.h>
+ *
+ *  int main(void)
+ *  {
+ *      cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *      cusp::gallery::poisson5pt(A, 10, 10);
+ *
+ *      cusp::array2d<float, cusp::host_memory, cusp::column_major> H(A.num_rows, 8);
+ *      for (size_t i = 0; i < H.num_rows; i++)
+ *          for (size_t j = 0; j < H.num_cols; j++)
+ *              H(i,j) = (i % (j + 2)) + 1;
+ *
+ *      cusp::array2d<float, cusp::device_memory, cusp::column_major> X(A.num_rows, 8, 0);
+ *      cusp::array2d<float, cusp::device_memory, cusp::column_major> B(H);
+ *
+ *      // set stopping criteria for each column:
+ *      //  iteration_limit    = 100
+ *      //  relative_tolerance = 1e-6
+ *      cusp::block_monitor<float> monitor(B, 100, 1e-6);
+ *
+ *      // solve the linear systems A X = B, restarting every 10 steps
+ *      cusp::krylov::block_gmres(A, X, B, 10, monitor);
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ *
+ *  \see \p block_monitor
+ */
+template <class LinearOperator,
+          class Matrix,
+          class Monitor,
+          class Preconditioner>
+void block_gmres(LinearOperator& A,
+                 Matrix& X,
+                 Matrix& B,
+                 const size_t restart,
+                 Monitor& monitor,
+                 Preconditioner& M);
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/block_gmres.inl>
+
@@ -22,6 +22,9 @@
 
 #include <cusp/detail/config.h>
 
+#include <cusp/array1d.h>
+#include <cusp/stream.h>
+
 namespace cusp
 {
 namespace krylov
@@ -123,6 +126,86 @@ void cg(LinearOperator& A,
         Vector& b,
         Monitor& monitor,
         Preconditioner& M);
+
+/*! \p cg : issue all device work of the solve on a given CUDA stream
+ *
+ *  Equivalent to calling \p cg(A,x,b,monitor,M) within a
+ *  \p scoped_stream.  Independent solves issued on different streams
+ *  may execute concurrently.
+ *
+ *  \see \p scoped_stream
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void cg(LinearOperator& A,
+        Vector& x,
+        Vector& b,
+        Monitor& monitor,
+        Preconditioner& M,
+        cudaStream_t stream);
+
+/*! \p cg_solver : Conjugate Gradient method with a persistent workspace
+ *
+ *  \p cg allocates its work vectors on every call.  A \p cg_solver
+ *  allocates them once and reuses them for every subsequent solve of the
+ *  same (or a smaller) size, which avoids the allocation cost when many
+ *  small systems are solved in succession.
+ *
+ *  \tparam ValueType scalar type of the linear systems
+ *  \tparam MemorySpace memory space of the linear systems
+ *
+ *  \code
+ *  cusp::krylov::cg_solver<float, cusp::device_memory> solver(A.num_rows);
+ *
+ *  for (int step = 0; step < num_steps; step++)
+ *  {
+ *      cusp::default_monitor<float> monitor(b, 100, 1e-6);
+ *      solver.solve(A, x, b, monitor);
+ *  }
+ *  \endcode
+ *
+ *  \see \p cg
+ */
+template <typename ValueType, typename MemorySpace>
+class cg_solver
+{
+    cusp::array1d<ValueType,MemorySpace> y;
+    cusp::array1d<ValueType,MemorySpace> z;
+    cusp::array1d<ValueType,MemorySpace> r;
+    cusp::array1d<ValueType,MemorySpace> p;
+
+    public:
+
+    /*! construct a \p cg_solver with an empty workspace
+     */
+    cg_solver(void) {}
+
+    /*! construct a \p cg_solver with a workspace for \p N unknowns
+     */
+    cg_solver(size_t N);
+
+    /*! resize the workspace for \p N unknowns
+     */
+    void resize(size_t N);
+
+    /*! solve A x = b using the default convergence criteria
+     */
+    template <class LinearOperator, class Vector>
+    void solve(LinearOperator& A, Vector& x, Vector& b);
+
+    /*! solve A x = b without preconditioning
+     */
+    template <class LinearOperator, class Vector, class Monitor>
+    void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor);
+
+    /*! solve A x = b with preconditioner \p M.  \p b is only read and
+     *  may be of another vector type than \p x.
+     */
+    template <class LinearOperator, class Vector1, class Vector2, class Monitor, class Preconditioner>
+    void solve(LinearOperator& A, Vector1& x, const Vector2& b, Monitor& monitor, Preconditioner& M);
+};
 /*! \}
  */
 
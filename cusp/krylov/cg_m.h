@@ -77,6 +77,37 @@ void cg_m(LinearOperator& A,
           VectorType2& b,
           VectorType3& sigma,
           Monitor& monitor);
+
+/*! \p cg_m : Multi-mass Conjugate Gradient method
+ * 
+ * Solves the symmetric, positive-definited linear system (A+\sigma) x = b
+ * for some set of constant shifts \p sigma for the price of the smallest shift
+ *
+ * \param A matrix of the linear system
+ * \param x solutions of the system
+ * \param b right-hand side of the linear system
+ * \param sigma array of shifts
+ * \param monitor monitors interation and determines stoppoing conditions
+ * \param freeze_converged_shifts stop updating the solution of a shift once
+ *        its residual \f$ \zeta^\sigma r \f$ satisfies \p monitor.tolerance()
+ *
+ * The iteration continues until the monitor is satisfied by the residual of
+ * the unshifted system.  When \p freeze_converged_shifts is set, the solutions
+ * of the converged shifts are left untouched, which saves memory traffic when
+ * the shifts converge at different rates.  Testing the shifts costs a
+ * transfer of the \f$ \zeta^\sigma \f$ to the host per iteration.
+ */
+template <class LinearOperator,
+          class VectorType1,
+          class VectorType2,
+          class VectorType3,
+          class Monitor>
+void cg_m(LinearOperator& A,
+          VectorType1& x,
+          VectorType2& b,
+          VectorType3& sigma,
+          Monitor& monitor,
+          bool freeze_converged_shifts);
 /*! \}
  */
 
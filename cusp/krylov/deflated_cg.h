@@ -0,0 +1,155 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file deflated_cg.h
+ *  \brief Deflated Conjugate Gradient method with subspace recycling
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p deflated_cg_solver : Deflated Conjugate Gradient method that
+ *  recycles a Krylov subspace across a sequence of linear systems
+ *
+ *  Solves a sequence of symmetric, positive-definite linear systems
+ *  A_i x_i = b_i, where the matrices change slowly (e.g. the time steps
+ *  or Newton steps of a simulation).  The solver keeps a deflation
+ *  space W of up to \p num_vectors columns in a column-major
+ *  \p array2d.  At the start of each solve W is projected out of the
+ *  initial residual and every search direction is kept A-orthogonal to
+ *  W (Saad, Yeung, Erhel and Guyomarc'h), which removes the eigenvalues
+ *  captured by W from the convergence of CG.
+ *
+ *  After each solve W is refreshed by a Rayleigh-Ritz procedure on the
+ *  space spanned by W and the first \p num_directions search directions
+ *  of the solve, whose products with A are already known: the Ritz
+ *  vectors of the smallest Ritz values become the new W.  The products
+ *  with W, the projections and the Rayleigh-Ritz procedure use the block
+ *  operations of the block Krylov methods, so each iteration adds a
+ *  single reduction of k inner products and a single update of p.
+ *
+ *  \tparam ValueType scalar type of the linear systems
+ *  \tparam MemorySpace memory space of the linear systems
+ *
+ *  \note The small dense eigenvalue problem is real-valued, so the value
+ *  type is \c float or \c double.  The first solve of a sequence, and
+ *  any solve of a different size, runs as plain preconditioned CG.
+ *
+ *  \code
+ *  cusp::krylov::deflated_cg_solver<float, cusp::device_memory> solver(8);
+ *
+ *  for (int step = 0; step < num_steps; step++)
+ *  {
+ *      // update A and b
+ *      cusp::default_monitor<float> monitor(b, 100, 1e-6);
+ *      solver.solve(A, x, b, monitor);
+ *  }
+ *  \endcode
+ *
+ *  \see \p cg_solver
+ */
+template <typename ValueType, typename MemorySpace>
+class deflated_cg_solver
+{
+    typedef cusp::array2d<ValueType,MemorySpace,cusp::column_major> Array2d;
+
+    size_t max_vectors;
+    size_t max_directions;
+    size_t num_vectors;
+
+    // [W, P] and [A W, A P], the deflation space followed by the
+    // search directions recorded during the current solve
+    Array2d basis;
+    Array2d basis_A;
+
+    Array2d R;
+    Array2d Z;
+    Array2d P;
+    Array2d T;
+    cusp::array1d<ValueType,MemorySpace> y;
+
+    template <class LinearOperator>
+    void update_deflation_space(LinearOperator& A, size_t num_recorded);
+
+    public:
+
+    /*! construct a \p deflated_cg_solver with an empty deflation space
+     *
+     *  \param num_vectors maximum number of columns of the deflation space
+     *  \param num_directions number of search directions recorded in each
+     *  solve to refresh the deflation space (0 selects 2 * \p num_vectors)
+     */
+    deflated_cg_solver(size_t num_vectors = 8, size_t num_directions = 0);
+
+    /*! number of columns of the current deflation space
+     */
+    size_t deflation_size(void) const { return num_vectors; }
+
+    /*! copy the current deflation space to \p W
+     */
+    template <class Matrix>
+    void get_deflation_space(Matrix& W) const;
+
+    /*! replace the deflation space by the (linearly independent) columns
+     *  of \p W, e.g. approximate eigenvectors known beforehand
+     */
+    template <class Matrix>
+    void set_deflation_space(const Matrix& W);
+
+    /*! discard the deflation space, e.g. when the matrices of the
+     *  sequence change abruptly
+     */
+    void clear(void) { num_vectors = 0; }
+
+    /*! solve A x = b using the default convergence criteria
+     */
+    template <class LinearOperator, class Vector>
+    void solve(LinearOperator& A, Vector& x, Vector& b);
+
+    /*! solve A x = b without preconditioning
+     */
+    template <class LinearOperator, class Vector, class Monitor>
+    void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor);
+
+    /*! solve A x = b with preconditioner \p M and refresh the deflation
+     *  space.  \p b is only read and may be of another vector type than
+     *  \p x.
+     */
+    template <class LinearOperator, class Vector1, class Vector2, class Monitor, class Preconditioner>
+    void solve(LinearOperator& A, Vector1& x, const Vector2& b, Monitor& monitor, Preconditioner& M);
+};
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/deflated_cg.inl>
@@ -0,0 +1,358 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/exception.h>
+#include <cusp/detail/mutex.h>
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/thread.h>
+
+#include <cusp/krylov/cg.h>
+#include <cusp/krylov/bicgstab.h>
+#include <cusp/krylov/gmres.h>
+
+#include <cuda_runtime_api.h>
+
+#include <exception>
+#include <string>
+
+namespace cusp
+{
+namespace krylov
+{
+namespace detail_async
+{
+
+// a solve together with its operands
+class async_task
+{
+    public:
+    virtual ~async_task(void) {}
+    virtual void run(void) = 0;
+    virtual size_t iteration_count(void) const = 0;
+    virtual bool converged(void) const = 0;
+};
+
+template <typename Monitor>
+class monitored_task : public async_task
+{
+    protected:
+    Monitor& monitor;
+
+    public:
+    monitored_task(Monitor& monitor) : monitor(monitor) {}
+
+    size_t iteration_count(void) const { return monitor.iteration_count(); }
+    bool converged(void) const { return monitor.converged(); }
+};
+
+template <typename LinearOperator, typename Vector, typename Monitor, typename Preconditioner>
+class cg_task : public monitored_task<Monitor>
+{
+    LinearOperator& A;
+    Vector& x;
+    Vector& b;
+    Preconditioner& M;
+    cudaStream_t stream;
+
+    public:
+    cg_task(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor, Preconditioner& M, cudaStream_t stream)
+        : monitored_task<Monitor>(monitor), A(A), x(x), b(b), M(M), stream(stream) {}
+
+    void run(void) { cusp::krylov::cg(A, x, b, this->monitor, M, stream); }
+};
+
+template <typename LinearOperator, typename Vector, typename Monitor, typename Preconditioner>
+class bicgstab_task : public monitored_task<Monitor>
+{
+    LinearOperator& A;
+    Vector& x;
+    Vector& b;
+    Preconditioner& M;
+    cudaStream_t stream;
+
+    public:
+    bicgstab_task(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor, Preconditioner& M, cudaStream_t stream)
+        : monitored_task<Monitor>(monitor), A(A), x(x), b(b), M(M), stream(stream) {}
+
+    void run(void) { cusp::krylov::bicgstab(A, x, b, this->monitor, M, stream); }
+};
+
+template <typename LinearOperator, typename Vector, typename Monitor, typename Preconditioner>
+class gmres_task : public monitored_task<Monitor>
+{
+    LinearOperator& A;
+    Vector& x;
+    Vector& b;
+    size_t restart;
+    Preconditioner& M;
+    cudaStream_t stream;
+
+    public:
+    gmres_task(LinearOperator& A, Vector& x, Vector& b, size_t restart, Monitor& monitor, Preconditioner& M, cudaStream_t stream)
+        : monitored_task<Monitor>(monitor), A(A), x(x), b(b), restart(restart), M(M), stream(stream) {}
+
+    void run(void) { cusp::krylov::gmres(A, x, b, restart, this->monitor, M, stream); }
+};
+
+// State shared by the handles of a solve and its worker thread.  The
+// worker runs the task on the device that was current for the caller and
+// records an exception thrown by the task, which wait() rethrows.
+class async_state
+{
+    async_task * task;
+    int device;
+
+    cusp::detail::pool_mutex mutex;
+    size_t references;
+    bool finished;
+    bool failed;
+    std::string error;
+
+    cusp::detail::pool_mutex join_mutex;
+    cusp::detail::host_thread * thread;
+    bool joined;
+
+    static void execute(void * self)
+    {
+        async_state * s = static_cast<async_state *>(self);
+
+        bool failed = false;
+        std::string error;
+
+        try
+        {
+            cusp::detail::scoped_device scope(s->device);
+            s->task->run();
+        }
+        catch (std::exception& e)
+        {
+            failed = true;
+            error  = e.what();
+        }
+        catch (...)
+        {
+            failed = true;
+            error  = "unknown exception in asynchronous solve";
+        }
+
+        cusp::detail::pool_lock lock(s->mutex);
+        s->failed   = failed;
+        s->error    = error;
+        s->finished = true;
+    }
+
+    void join(void)
+    {
+        cusp::detail::pool_lock lock(join_mutex);
+
+        if (!joined)
+        {
+            thread->join();
+            joined = true;
+        }
+    }
+
+    public:
+
+    // takes ownership of the task
+    async_state(async_task * task)
+        : task(task), device(0), references(1), finished(false), failed(false), thread(0), joined(false)
+    {
+        cudaGetDevice(&device);
+
+        try
+        {
+            thread = new cusp::detail::host_thread(execute, this);
+        }
+        catch (...)
+        {
+            delete task;
+            throw;
+        }
+    }
+
+    ~async_state(void)
+    {
+        join();
+        delete thread;
+        delete task;
+    }
+
+    void acquire(void)
+    {
+        cusp::detail::pool_lock lock(mutex);
+        references++;
+    }
+
+    // true when the last reference was released
+    bool release(void)
+    {
+        cusp::detail::pool_lock lock(mutex);
+        return --references == 0;
+    }
+
+    bool ready(void)
+    {
+        cusp::detail::pool_lock lock(mutex);
+        return finished;
+    }
+
+    void wait(void)
+    {
+        join();
+
+        if (failed)
+            throw cusp::runtime_exception(error);
+    }
+
+    size_t iteration_count(void)
+    {
+        wait();
+        return task->iteration_count();
+    }
+
+    bool converged(void)
+    {
+        wait();
+        return task->converged();
+    }
+
+    private:
+    // not copyable
+    async_state(const async_state&);
+    async_state& operator=(const async_state&);
+};
+
+} // end namespace detail_async
+
+inline solve_handle::solve_handle(void)
+    : state(0)
+{}
+
+inline solve_handle::solve_handle(detail_async::async_state * state)
+    : state(state)
+{}
+
+inline solve_handle::solve_handle(const solve_handle& other)
+    : state(other.state)
+{
+    if (state)
+        state->acquire();
+}
+
+inline solve_handle& solve_handle::operator=(const solve_handle& other)
+{
+    if (other.state)
+        other.state->acquire();
+
+    release();
+    state = other.state;
+
+    return *this;
+}
+
+inline solve_handle::~solve_handle(void)
+{
+    release();
+}
+
+inline void solve_handle::release(void)
+{
+    if (state && state->release())
+        delete state;
+
+    state = 0;
+}
+
+inline bool solve_handle::valid(void) const
+{
+    return state != 0;
+}
+
+inline bool solve_handle::ready(void) const
+{
+    return state == 0 || state->ready();
+}
+
+inline void solve_handle::wait(void) const
+{
+    if (state)
+        state->wait();
+}
+
+inline size_t solve_handle::iteration_count(void) const
+{
+    return state ? state->iteration_count() : 0;
+}
+
+inline bool solve_handle::converged(void) const
+{
+    return state ? state->converged() : false;
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+solve_handle cg_async(LinearOperator& A,
+                      Vector& x,
+                      Vector& b,
+                      Monitor& monitor,
+                      Preconditioner& M,
+                      cudaStream_t stream)
+{
+    typedef detail_async::cg_task<LinearOperator,Vector,Monitor,Preconditioner> Task;
+
+    return solve_handle(new detail_async::async_state(new Task(A, x, b, monitor, M, stream)));
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+solve_handle bicgstab_async(LinearOperator& A,
+                            Vector& x,
+                            Vector& b,
+                            Monitor& monitor,
+                            Preconditioner& M,
+                            cudaStream_t stream)
+{
+    typedef detail_async::bicgstab_task<LinearOperator,Vector,Monitor,Preconditioner> Task;
+
+    return solve_handle(new detail_async::async_state(new Task(A, x, b, monitor, M, stream)));
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+solve_handle gmres_async(LinearOperator& A,
+                         Vector& x,
+                         Vector& b,
+                         const size_t restart,
+                         Monitor& monitor,
+                         Preconditioner& M,
+                         cudaStream_t stream)
+{
+    typedef detail_async::gmres_task<LinearOperator,Vector,Monitor,Preconditioner> Task;
+
+    return solve_handle(new detail_async::async_state(new Task(A, x, b, restart, monitor, M, stream)));
+}
+
+} // end namespace krylov
+} // end namespace cusp
+
@@ -0,0 +1,323 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/copy.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+
+#include <thrust/binary_search.h>
+#include <thrust/fill.h>
+#include <thrust/find.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/reduce.h>
+#include <thrust/scatter.h>
+#include <thrust/transform.h>
+
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <cmath>
+
+namespace cusp
+{
+namespace krylov
+{
+
+// functors used by batched_cg.  Per-system quantities (alpha, beta, ...)
+// are stored in arrays of size num_systems and looked up through the
+// system index of each row.
+namespace detail_batched
+{
+  // conj(x) * y
+  template <typename ValueType>
+    struct DOTC : public thrust::unary_function<thrust::tuple<ValueType,ValueType>, ValueType>
+  {
+    template <typename Tuple>
+    __host__ __device__
+      ValueType operator()(const Tuple& t) const
+    {
+      return cusp::blas::detail::conjugate<ValueType>()(thrust::get<0>(t)) * thrust::get<1>(t);
+    }
+  };
+
+  // tolerance <- absolute_tolerance + relative_tolerance * ||b||
+  template <typename ValueType, typename Real>
+    struct KERNEL_TOLERANCE : public thrust::unary_function<ValueType, Real>
+  {
+    Real relative_tolerance;
+    Real absolute_tolerance;
+
+    KERNEL_TOLERANCE(Real _relative_tolerance, Real _absolute_tolerance)
+      : relative_tolerance(_relative_tolerance), absolute_tolerance(_absolute_tolerance)
+    {}
+
+    __host__ __device__
+      Real operator()(const ValueType& bb) const
+    {
+      return absolute_tolerance + relative_tolerance * sqrt(abs(bb));
+    }
+  };
+
+  // active <- ||r|| > tolerance
+  template <typename ValueType, typename Real>
+    struct KERNEL_ACTIVE : public thrust::binary_function<ValueType, Real, int>
+  {
+    __host__ __device__
+      int operator()(const ValueType& rr, const Real& tolerance) const
+    {
+      return sqrt(abs(rr)) > tolerance;
+    }
+  };
+
+  // alpha <- <r,r> / <p,Ap> for active systems, 0 otherwise
+  template <typename ValueType>
+    struct KERNEL_ALPHA
+  {
+    template <typename Tuple>
+    __host__ __device__
+      void operator()(Tuple t)
+    {
+      // (alpha, rr, pAp, active)
+      thrust::get<0>(t) = thrust::get<3>(t) ? ValueType(thrust::get<1>(t) / thrust::get<2>(t)) : ValueType(0);
+    }
+  };
+
+  // beta <- <r_{i+1},r_{i+1}> / <r_i,r_i> and convergence test for active systems
+  template <typename ValueType, typename IndexType>
+    struct KERNEL_BETA
+  {
+    IndexType iteration_limit;
+
+    KERNEL_BETA(IndexType _iteration_limit) : iteration_limit(_iteration_limit) {}
+
+    template <typename Tuple>
+    __host__ __device__
+      void operator()(Tuple t)
+    {
+      // (beta, rr, rr_new, tolerance, active, iterations)
+      if (thrust::get<4>(t))
+      {
+        const ValueType rr_new = thrust::get<2>(t);
+
+        thrust::get<0>(t) = rr_new / thrust::get<1>(t);
+        thrust::get<1>(t) = rr_new;
+
+        const IndexType iterations = thrust::get<5>(t) + 1;
+
+        thrust::get<5>(t) = iterations;
+        thrust::get<4>(t) = (sqrt(abs(rr_new)) > thrust::get<3>(t)) && iterations < iteration_limit;
+      }
+      else
+      {
+        thrust::get<0>(t) = ValueType(0);
+      }
+    }
+  };
+
+  // x <- x + alpha * p, r <- r - alpha * Ap
+  template <typename ValueType, typename IndexType>
+    struct KERNEL_XR
+  {
+    const ValueType * alpha;
+
+    KERNEL_XR(const ValueType * _alpha) : alpha(_alpha) {}
+
+    template <typename Tuple>
+    __host__ __device__
+      void operator()(Tuple t)
+    {
+      // (x, r, p, Ap, system)
+      const ValueType a = alpha[thrust::get<4>(t)];
+
+      thrust::get<0>(t) += a * thrust::get<2>(t);
+      thrust::get<1>(t) -= a * thrust::get<3>(t);
+    }
+  };
+
+  // p <- r + beta * p
+  template <typename ValueType, typename IndexType>
+    struct KERNEL_P
+  {
+    const ValueType * beta;
+
+    KERNEL_P(const ValueType * _beta) : beta(_beta) {}
+
+    template <typename Tuple>
+    __host__ __device__
+      void operator()(Tuple t)
+    {
+      // (p, r, system)
+      thrust::get<0>(t) = thrust::get<1>(t) + beta[thrust::get<2>(t)] * thrust::get<0>(t);
+    }
+  };
+
+  // result[s] <- <x_s, y_s> for every system s
+  //
+  // When some systems are empty, reduce_by_key produces fewer than
+  // num_systems sums, which are scattered to their systems.
+  template <typename Array1, typename Array2, typename IndexArray, typename Array3>
+  void segmented_dotc(const Array1& x, const Array2& y,
+                      const IndexArray& row_system, bool has_empty_systems,
+                      IndexArray& keys, Array3& sums, Array3& result)
+  {
+    typedef typename Array3::value_type ValueType;
+
+    if (has_empty_systems)
+    {
+      thrust::pair<typename IndexArray::iterator, typename Array3::iterator> last =
+        thrust::reduce_by_key(row_system.begin(), row_system.end(),
+                              thrust::make_transform_iterator(thrust::make_zip_iterator(thrust::make_tuple(x.begin(), y.begin())), DOTC<ValueType>()),
+                              keys.begin(), sums.begin());
+
+      thrust::fill(result.begin(), result.end(), ValueType(0));
+      thrust::scatter(sums.begin(), last.second, keys.begin(), result.begin());
+    }
+    else
+    {
+      thrust::reduce_by_key(row_system.begin(), row_system.end(),
+                            thrust::make_transform_iterator(thrust::make_zip_iterator(thrust::make_tuple(x.begin(), y.begin())), DOTC<ValueType>()),
+                            keys.begin(), result.begin());
+    }
+  }
+
+} // end namespace detail_batched
+
+template <class LinearOperator,
+          class Vector,
+          class IndexArray1,
+          class IndexArray2>
+void batched_cg(LinearOperator& A,
+                Vector& x,
+                Vector& b,
+                const IndexArray1& system_offsets,
+                IndexArray2& iteration_counts,
+                size_t iteration_limit,
+                double relative_tolerance,
+                double absolute_tolerance)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+    typedef typename IndexArray1::value_type      IndexType;
+    typedef typename norm_type<ValueType>::type   Real;
+
+    assert(A.num_rows == A.num_cols);        // sanity check
+
+    if (system_offsets.size() == 0)
+        throw cusp::invalid_input_exception("system_offsets must contain at least one entry");
+
+    const size_t N = A.num_rows;
+    const size_t S = system_offsets.size() - 1;
+
+    cusp::array1d<IndexType,MemorySpace> offsets(system_offsets);
+
+    if (offsets[0] != 0 || size_t(offsets[S]) != N)
+        throw cusp::invalid_input_exception("system_offsets must partition the rows of A");
+
+    iteration_counts.resize(S);
+
+    // system index of each row
+    cusp::array1d<IndexType,MemorySpace> row_system(N);
+    thrust::upper_bound(offsets.begin() + 1, offsets.end(),
+                        thrust::counting_iterator<IndexType>(0),
+                        thrust::counting_iterator<IndexType>(N),
+                        row_system.begin());
+
+    // empty systems require an extra scatter in each segmented reduction
+    cusp::array1d<IndexType,MemorySpace> lengths(S);
+    thrust::transform(offsets.begin() + 1, offsets.end(), offsets.begin(), lengths.begin(), thrust::minus<IndexType>());
+    const bool has_empty_systems = thrust::find(lengths.begin(), lengths.end(), IndexType(0)) != lengths.end();
+
+    // allocate workspace
+    cusp::array1d<ValueType,MemorySpace> y(N);
+    cusp::array1d<ValueType,MemorySpace> r(N);
+    cusp::array1d<ValueType,MemorySpace> p(N);
+
+    cusp::array1d<IndexType,MemorySpace> keys(S);
+    cusp::array1d<ValueType,MemorySpace> sums(S);
+
+    cusp::array1d<ValueType,MemorySpace> rr(S);
+    cusp::array1d<ValueType,MemorySpace> rr_new(S);
+    cusp::array1d<ValueType,MemorySpace> pAp(S);
+    cusp::array1d<ValueType,MemorySpace> alpha(S);
+    cusp::array1d<ValueType,MemorySpace> beta(S);
+    cusp::array1d<Real,MemorySpace>      tolerance(S);
+    cusp::array1d<int,MemorySpace>       active(S);
+    cusp::array1d<IndexType,MemorySpace> iterations(S, IndexType(0));
+
+    // y <- Ax
+    cusp::multiply(A, x, y);
+
+    // r <- b - A*x
+    cusp::blas::axpby(b, y, r, ValueType(1), ValueType(-1));
+
+    // p <- r
+    cusp::blas::copy(r, p);
+
+    // tolerance <- absolute_tolerance + relative_tolerance * ||b_s||
+    detail_batched::segmented_dotc(b, b, row_system, has_empty_systems, keys, sums, rr);
+    thrust::transform(rr.begin(), rr.end(), tolerance.begin(),
+                      detail_batched::KERNEL_TOLERANCE<ValueType,Real>(relative_tolerance, absolute_tolerance));
+
+    // rr <- <r_s, r_s>
+    detail_batched::segmented_dotc(r, r, row_system, has_empty_systems, keys, sums, rr);
+    thrust::transform(rr.begin(), rr.end(), tolerance.begin(), active.begin(),
+                      detail_batched::KERNEL_ACTIVE<ValueType,Real>());
+
+    size_t num_active = thrust::reduce(active.begin(), active.end());
+
+    for (size_t i = 0; num_active > 0 && i < iteration_limit; i++)
+    {
+        // y <- Ap
+        cusp::multiply(A, p, y);
+
+        // alpha <- <r,r>/<y,p>
+        detail_batched::segmented_dotc(p, y, row_system, has_empty_systems, keys, sums, pAp);
+        thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(alpha.begin(), rr.begin(), pAp.begin(), active.begin())),
+                         thrust::make_zip_iterator(thrust::make_tuple(alpha.begin(), rr.begin(), pAp.begin(), active.begin())) + S,
+                         detail_batched::KERNEL_ALPHA<ValueType>());
+
+        // x <- x + alpha * p, r <- r - alpha * y
+        thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(x.begin(), r.begin(), p.begin(), y.begin(), row_system.begin())),
+                         thrust::make_zip_iterator(thrust::make_tuple(x.begin(), r.begin(), p.begin(), y.begin(), row_system.begin())) + N,
+                         detail_batched::KERNEL_XR<ValueType,IndexType>(thrust::raw_pointer_cast(&alpha[0])));
+
+        // beta <- <r_{i+1},r_{i+1}>/<r,r>
+        detail_batched::segmented_dotc(r, r, row_system, has_empty_systems, keys, sums, rr_new);
+        thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(beta.begin(), rr.begin(), rr_new.begin(), tolerance.begin(), active.begin(), iterations.begin())),
+                         thrust::make_zip_iterator(thrust::make_tuple(beta.begin(), rr.begin(), rr_new.begin(), tolerance.begin(), active.begin(), iterations.begin())) + S,
+                         detail_batched::KERNEL_BETA<ValueType,IndexType>(IndexType(iteration_limit)));
+
+        // p <- r + beta*p
+        thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(p.begin(), r.begin(), row_system.begin())),
+                         thrust::make_zip_iterator(thrust::make_tuple(p.begin(), r.begin(), row_system.begin())) + N,
+                         detail_batched::KERNEL_P<ValueType,IndexType>(thrust::raw_pointer_cast(&beta[0])));
+
+        // a single synchronization per iteration for all systems
+        num_active = thrust::reduce(active.begin(), active.end());
+    }
+
+    cusp::copy(iterations, iteration_counts);
+}
+
+} // end namespace krylov
+} // end namespace cusp
+
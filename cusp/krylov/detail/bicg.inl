@@ -18,6 +18,7 @@
 #include <cusp/array1d.h>
 #include <cusp/blas.h>
 #include <cusp/multiply.h>
+#include <cusp/prefetch.h>
 #include <cusp/monitor.h>
 #include <cusp/linear_operator.h>
 
@@ -29,9 +30,10 @@ namespace krylov
 {
 
 template <class LinearOperator,
+          class TransposeOperator,
           class Vector>
 void bicg(LinearOperator& A,
-	  LinearOperator& At,
+	  TransposeOperator& At,
 	  Vector& x,
 	  Vector& b)
 {
@@ -43,10 +45,11 @@ void bicg(LinearOperator& A,
 }
 
 template <class LinearOperator,
+          class TransposeOperator,
           class Vector,
           class Monitor>
 void bicg(LinearOperator& A,
-	  LinearOperator& At,
+	  TransposeOperator& At,
 	  Vector& x,
 	  Vector& b,
 	  Monitor& monitor)
@@ -60,11 +63,12 @@ void bicg(LinearOperator& A,
 }
 
 template <class LinearOperator,
+          class TransposeOperator,
           class Vector,
           class Monitor,
           class Preconditioner>
 void bicg(LinearOperator& A,
-	  LinearOperator& At,
+	  TransposeOperator& At,
 	  Vector& x,
 	  Vector& b,
 	  Monitor& monitor,
@@ -73,6 +77,9 @@ void bicg(LinearOperator& A,
 {
     CUSP_PROFILE_SCOPED();
 
+    // migrate operands in managed memory to the device
+    cusp::detail::prefetch_solve(A, x, b);
+
     typedef typename LinearOperator::value_type   ValueType;
     typedef typename LinearOperator::memory_space MemorySpace;
 
@@ -18,6 +18,7 @@
 #include <cusp/array1d.h>
 #include <cusp/blas.h>
 #include <cusp/multiply.h>
+#include <cusp/prefetch.h>
 #include <cusp/monitor.h>
 #include <cusp/linear_operator.h>
 
@@ -67,26 +68,64 @@ void bicgstab(LinearOperator& A,
               Monitor& monitor,
               Preconditioner& M)
 {
-    CUSP_PROFILE_SCOPED();
-
     typedef typename LinearOperator::value_type   ValueType;
     typedef typename LinearOperator::memory_space MemorySpace;
 
-    assert(A.num_rows == A.num_cols);        // sanity check
+    cusp::krylov::bicgstab_solver<ValueType,MemorySpace> solver(A.num_rows);
+
+    solver.solve(A, x, b, monitor, M);
+}
+
+template <typename ValueType, typename MemorySpace>
+bicgstab_solver<ValueType,MemorySpace>::bicgstab_solver(size_t N)
+    : y(N), p(N), r(N), r_star(N), s(N), Mp(N), AMp(N), Ms(N), AMs(N)
+{}
+
+template <typename ValueType, typename MemorySpace>
+void bicgstab_solver<ValueType,MemorySpace>::resize(size_t N)
+{
+    y.resize(N);
+    p.resize(N);
+    r.resize(N);
+    r_star.resize(N);
+    s.resize(N);
+    Mp.resize(N);
+    AMp.resize(N);
+    Ms.resize(N);
+    AMs.resize(N);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector>
+void bicgstab_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b)
+{
+    cusp::default_monitor<ValueType> monitor(b);
+
+    solve(A, x, b, monitor);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector, class Monitor>
+void bicgstab_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor)
+{
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    solve(A, x, b, monitor, M);
+}
 
-    const size_t N = A.num_rows;
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector, class Monitor, class Preconditioner>
+void bicgstab_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor, Preconditioner& M)
+{
+    CUSP_PROFILE_SCOPED();
 
-    // allocate workspace
-    cusp::array1d<ValueType,MemorySpace> y(N);
+    // migrate operands in managed memory to the device
+    cusp::detail::prefetch_solve(A, x, b);
+
+    assert(A.num_rows == A.num_cols);        // sanity check
 
-    cusp::array1d<ValueType,MemorySpace>   p(N);
-    cusp::array1d<ValueType,MemorySpace>   r(N);
-    cusp::array1d<ValueType,MemorySpace>   r_star(N);
-    cusp::array1d<ValueType,MemorySpace>   s(N);
-    cusp::array1d<ValueType,MemorySpace>  Mp(N);
-    cusp::array1d<ValueType,MemorySpace> AMp(N);
-    cusp::array1d<ValueType,MemorySpace>  Ms(N);
-    cusp::array1d<ValueType,MemorySpace> AMs(N);
+    // reuse workspace
+    resize(A.num_rows);
 
     // y <- Ax
     cusp::multiply(A, x, y);
@@ -128,8 +167,9 @@ void bicgstab(LinearOperator& A,
         // AMs = A*Ms
         cusp::multiply(A, Ms, AMs);
 
-        // omega = (AMs, s) / (AMs, AMs)
-        ValueType omega = blas::dotc(AMs, s) / blas::dotc(AMs, AMs);
+        // omega = (AMs, s) / (AMs, AMs), both products in one pass
+        thrust::tuple<ValueType,ValueType> AMs_dots = blas::dotc_n(AMs, s, AMs, AMs);
+        ValueType omega = thrust::get<0>(AMs_dots) / thrust::get<1>(AMs_dots);
         
         // x_{j+1} = x_j + alpha*M*p_j + omega*M*s_j
         blas::axpbypcz(x, Mp, Ms, x, ValueType(1), alpha, omega);
@@ -149,6 +189,22 @@ void bicgstab(LinearOperator& A,
     }
 }
 
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void bicgstab(LinearOperator& A,
+              Vector& x,
+              Vector& b,
+              Monitor& monitor,
+              Preconditioner& M,
+              cudaStream_t stream)
+{
+    cusp::scoped_stream scope(stream);
+
+    cusp::krylov::bicgstab(A, x, b, monitor, M);
+}
+
 } // end namespace krylov
 } // end namespace cusp
 
@@ -18,6 +18,9 @@
 #include <cusp/blas.h>
 #include <cusp/multiply.h>
 #include <cusp/monitor.h>
+#include <cusp/vector_expression.h>
+
+#include <cusp/detail/device/krylov_m.h>
 
 #include <thrust/copy.h>
 #include <thrust/fill.h>
@@ -161,70 +164,6 @@ namespace detail_m
     }
   };
 
-  // computes new s
-  template <typename ScalarType>
-    struct KERNEL_XS
-  {
-    int N;
-    const ScalarType *rp_beta_0_s;
-    const ScalarType *rp_chi_0_s;
-    const ScalarType *rp_rho_0_s;
-    const ScalarType *rp_zeta_0_s;
-    const ScalarType *rp_alpha_1_s;
-    const ScalarType *rp_rho_1_s;
-    const ScalarType *rp_zeta_1_s;
-    const ScalarType *rp_r_0;
-    const ScalarType *rp_r_1;
-    const ScalarType *rp_w_1;
-
-    KERNEL_XS(int _N, const ScalarType *_rp_beta_0_s,
-              const ScalarType *_rp_chi_0_s,
-              const ScalarType *_rp_rho_0_s,
-              const ScalarType *_rp_zeta_0_s,
-              const ScalarType *_rp_alpha_1_s,
-              const ScalarType *_rp_rho_1_s,
-              const ScalarType *_rp_zeta_1_s,
-              const ScalarType *_rp_r_0,
-              const ScalarType *_rp_r_1,
-              const ScalarType *_rp_w_1) :
-	     N(_N),
-             rp_beta_0_s(_rp_beta_0_s),
-             rp_chi_0_s(_rp_chi_0_s),
-             rp_rho_0_s(_rp_rho_0_s),
-             rp_zeta_0_s(_rp_zeta_0_s),
-             rp_alpha_1_s(_rp_alpha_1_s),
-             rp_rho_1_s(_rp_rho_1_s),
-             rp_zeta_1_s(_rp_zeta_1_s),
-             rp_r_0(_rp_r_0),
-             rp_r_1(_rp_r_1),
-             rp_w_1(_rp_w_1)
-   {}
-
-    template <typename Tuple>
-    __host__ __device__
-      void operator()(Tuple t)
-    {
-      int index = thrust::get<2>(t);
-      int N_s = index / N;
-      int N_n = index % N;
-      
-      // return the transformed result
-      ScalarType z1s = rp_zeta_1_s[N_s];
-      ScalarType b0s = rp_beta_0_s[N_s];
-      ScalarType c0s = rp_chi_0_s[N_s];
-      ScalarType w1 = rp_w_1[N_n];
-      ScalarType s_0 = thrust::get<0>(t);
-
-      thrust::get<1>(t) = thrust::get<1>(t)-b0s*s_0
-	                    +c0s*rp_rho_0_s[N_s]*z1s*w1;
-      thrust::get<0>(t) = z1s*rp_rho_1_s[N_s]*rp_r_1[N_n]
-	      +rp_alpha_1_s[N_s]*
-	      (s_0-c0s*rp_rho_0_s[N_s]
-	       /b0s*(z1s*w1-rp_zeta_0_s[N_s]*rp_r_0[N_n]));
-	    
-    }
-  };
-
   // computes new x
   template <typename ScalarType>
     struct KERNEL_X : thrust::binary_function<int, ScalarType, ScalarType>
@@ -395,8 +334,58 @@ namespace trans_m
                 beta_0, alpha_0);
   }
 
+  // compute x^\sigma, s^\sigma of all shifts
+  template <typename ScalarType>
+  void compute_xs_m(const int N, const int N_s,
+                const ScalarType *beta_0_s, const ScalarType *chi_0_s,
+                const ScalarType *rho_0_s, const ScalarType *zeta_0_s,
+                const ScalarType *alpha_1_s, const ScalarType *rho_1_s,
+                const ScalarType *zeta_1_s,
+                const ScalarType *r_0, const ScalarType *r_1,
+                const ScalarType *w_1, ScalarType *s_0_s, ScalarType *x,
+                cusp::host_memory)
+  {
+    for (int s = 0; s < N_s; s++)
+    {
+      const ScalarType z1s = zeta_1_s[s];
+      const ScalarType b0s = beta_0_s[s];
+      const ScalarType crs = chi_0_s[s]*rho_0_s[s];
+      const ScalarType z0s = zeta_0_s[s];
+      const ScalarType a1s = alpha_1_s[s];
+      const ScalarType r1s = rho_1_s[s];
+
+      ScalarType *s_s = s_0_s + size_t(s) * N;
+      ScalarType *x_s = x + size_t(s) * N;
+
+      for (int i = 0; i < N; i++)
+      {
+        const ScalarType s_0 = s_s[i];
+        const ScalarType w1 = w_1[i];
+
+        x_s[i] = x_s[i]-b0s*s_0+crs*z1s*w1;
+        s_s[i] = z1s*r1s*r_1[i]+a1s*(s_0-crs/b0s*(z1s*w1-z0s*r_0[i]));
+      }
+    }
+  }
+
+  // on the device, a tile of shifts is updated per block
+  // (see cusp/detail/device/krylov_m.h)
+  template <typename ScalarType>
+  void compute_xs_m(const int N, const int N_s,
+                const ScalarType *beta_0_s, const ScalarType *chi_0_s,
+                const ScalarType *rho_0_s, const ScalarType *zeta_0_s,
+                const ScalarType *alpha_1_s, const ScalarType *rho_1_s,
+                const ScalarType *zeta_1_s,
+                const ScalarType *r_0, const ScalarType *r_1,
+                const ScalarType *w_1, ScalarType *s_0_s, ScalarType *x,
+                cusp::device_memory)
+  {
+    cusp::detail::device::bicgstab_m_xs(N, N_s, (const int *) 0,
+                    beta_0_s, chi_0_s, rho_0_s, zeta_0_s,
+                    alpha_1_s, rho_1_s, zeta_1_s, r_0, r_1, w_1, s_0_s, x);
+  }
+
   // compute x^\sigma, s^\sigma
-  // uses detail_m::KERNEL_XS
   template <typename Array1, typename Array2, typename Array3, typename Array4,
 	   typename Array5, typename Array6, typename Array7, typename Array8,
 	   typename Array9, typename Array10, typename Array11,typename Array12>
@@ -419,27 +408,21 @@ namespace trans_m
     size_t N_t = s_0_s.end()-s_0_s.begin();
     assert (N_t == N*N_s);
 
-    // counting iterators to pass to thrust::transform
-    thrust::counting_iterator<int> count(0);
-
-    // get raw pointers for passing to kernels
-    typedef typename Array1::value_type   ScalarType;
-    const ScalarType *raw_ptr_beta_0_s  = thrust::raw_pointer_cast(beta_0_s.data());
-    const ScalarType *raw_ptr_chi_0_s   = thrust::raw_pointer_cast(chi_0_s.data());
-    const ScalarType *raw_ptr_rho_0_s   = thrust::raw_pointer_cast(rho_0_s.data());
-    const ScalarType *raw_ptr_zeta_0_s  = thrust::raw_pointer_cast(zeta_0_s.data());
-    const ScalarType *raw_ptr_alpha_1_s = thrust::raw_pointer_cast(alpha_1_s.data());
-    const ScalarType *raw_ptr_rho_1_s   = thrust::raw_pointer_cast(rho_1_s.data());
-    const ScalarType *raw_ptr_zeta_1_s  = thrust::raw_pointer_cast(zeta_1_s.data());
-    const ScalarType *raw_ptr_r_0       = thrust::raw_pointer_cast(r_0.data());
-    const ScalarType *raw_ptr_r_1       = thrust::raw_pointer_cast(r_1.data());
-    const ScalarType *raw_ptr_w_1       = thrust::raw_pointer_cast(w_1.data());
-
     // compute x
-    thrust::for_each(
-    thrust::make_zip_iterator(thrust::make_tuple(s_0_s.begin(),x.begin(),count)),
-    thrust::make_zip_iterator(thrust::make_tuple(s_0_s.begin(),x.begin(),count))+N_t,
-    cusp::krylov::detail_m::KERNEL_XS<ScalarType>(N, raw_ptr_beta_0_s, raw_ptr_chi_0_s, raw_ptr_rho_0_s, raw_ptr_zeta_0_s, raw_ptr_alpha_1_s, raw_ptr_rho_1_s, raw_ptr_zeta_1_s, raw_ptr_r_0, raw_ptr_r_1, raw_ptr_w_1));
+    cusp::krylov::trans_m::compute_xs_m(int(N), int(N_s),
+		    thrust::raw_pointer_cast(beta_0_s.data()),
+		    thrust::raw_pointer_cast(chi_0_s.data()),
+		    thrust::raw_pointer_cast(rho_0_s.data()),
+		    thrust::raw_pointer_cast(zeta_0_s.data()),
+		    thrust::raw_pointer_cast(alpha_1_s.data()),
+		    thrust::raw_pointer_cast(rho_1_s.data()),
+		    thrust::raw_pointer_cast(zeta_1_s.data()),
+		    thrust::raw_pointer_cast(r_0.data()),
+		    thrust::raw_pointer_cast(r_1.data()),
+		    thrust::raw_pointer_cast(w_1.data()),
+		    thrust::raw_pointer_cast(s_0_s.data()),
+		    thrust::raw_pointer_cast(x.data()),
+		    typename Array11::memory_space());
   }
 
   template <typename InputIterator1, typename InputIterator2,
@@ -692,13 +675,11 @@ void bicgstab_m(LinearOperator& A,
     cusp::multiply(A,w_1,Aw);
 
     // compute chi_0
-    chi_0 = cusp::blas::dotc(Aw,w_1)/cusp::blas::dotc(Aw,Aw);
-
-    // compute new residual
-    cusp::krylov::trans_m::compute_r_1_m(w_1,Aw,r_1,chi_0);
+    thrust::tuple<ValueType,ValueType> Aw_dots = cusp::blas::dotc_n(Aw,w_1,Aw,Aw);
+    chi_0 = thrust::get<0>(Aw_dots)/thrust::get<1>(Aw_dots);
 
-    // compute the new delta
-    delta_1 = cusp::blas::dotc(w_0,r_1);
+    // compute new residual and the new delta in one pass
+    delta_1 = cusp::blas::assign_dotc(r_1, w_1 - chi_0 * Aw, w_0);
  
     // compute new alpha
     alpha_0 = -beta_0*delta_1/delta_0/chi_0;
@@ -0,0 +1,293 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/prefetch.h>
+#include <cusp/monitor.h>
+#include <cusp/linear_operator.h>
+
+#include <cusp/krylov/gmres.h>
+#include <cusp/krylov/detail/block_krylov.h>
+
+namespace blas = cusp::blas;
+
+namespace cusp
+{
+namespace krylov
+{
+namespace detail_bicgstabl
+{
+  // the values of the columns [first, last) of a column-major array2d as
+  // one vector, so that an update of several columns is a single pass
+  template <typename Array2d>
+  typename cusp::array1d_view<typename Array2d::values_array_type::iterator>
+  column_values(Array2d& V, size_t first, size_t last)
+  {
+    return cusp::make_array1d_view(V.values.begin() + V.pitch * first,
+                                   V.values.begin() + V.pitch * last);
+  }
+} // end namespace detail_bicgstabl
+
+template <class LinearOperator,
+          class Vector>
+void bicgstabl(LinearOperator& A,
+               Vector& x,
+               Vector& b,
+               const size_t l)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+
+    cusp::default_monitor<ValueType> monitor(b);
+
+    cusp::krylov::bicgstabl(A, x, b, l, monitor);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor>
+void bicgstabl(LinearOperator& A,
+               Vector& x,
+               Vector& b,
+               const size_t l,
+               Monitor& monitor)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    cusp::krylov::bicgstabl(A, x, b, l, monitor, M);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void bicgstabl(LinearOperator& A,
+               Vector& x,
+               Vector& b,
+               const size_t l,
+               Monitor& monitor,
+               Preconditioner& M)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    cusp::krylov::bicgstabl_solver<ValueType,MemorySpace> solver(A.num_rows, l);
+
+    solver.solve(A, x, b, monitor, M);
+}
+
+template <typename ValueType, typename MemorySpace>
+bicgstabl_solver<ValueType,MemorySpace>::bicgstabl_solver(size_t N, size_t l)
+    : l(0)
+{
+    resize(N, l);
+}
+
+template <typename ValueType, typename MemorySpace>
+void bicgstabl_solver<ValueType,MemorySpace>::resize(size_t N, size_t l)
+{
+    this->l = l;
+
+    if (R.num_rows != N || R.num_cols != l + 1)
+        R.resize(N, l + 1);
+    if (U.num_rows != N || U.num_cols != l + 1)
+        U.resize(N, l + 1);
+    r_star.resize(N);
+    y.resize(N);
+    t.resize(N);
+
+    // the columns of the Gram matrix of the residuals, then gamma and -gamma
+    h.resize(l * (l + 1) + 2 * l);
+    hHost.resize(l * (l + 1) + 2 * l);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector>
+void bicgstabl_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b)
+{
+    cusp::default_monitor<ValueType> monitor(b);
+
+    solve(A, x, b, monitor);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector, class Monitor>
+void bicgstabl_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor)
+{
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    solve(A, x, b, monitor, M);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector, class Monitor, class Preconditioner>
+void bicgstabl_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor, Preconditioner& M)
+{
+    CUSP_PROFILE_SCOPED();
+
+    // migrate operands in managed memory to the device
+    cusp::detail::prefetch_solve(A, x, b);
+
+    namespace block = cusp::krylov::detail_block;
+    using detail_bicgstabl::column_values;
+
+    typedef typename cusp::array2d<ValueType,MemorySpace,cusp::column_major>::column_view Column;
+    typedef typename cusp::array1d<ValueType,MemorySpace>::view                       View;
+
+    assert(A.num_rows == A.num_cols);        // sanity check
+
+    if (l == 0)
+        throw cusp::invalid_input_exception("bicgstabl_solver requires a positive degree l");
+
+    // reuse workspace
+    resize(A.num_rows, l);
+
+    const size_t L = l;
+
+    // R(0) <- b - A*x
+    Column r = R.column(0);
+    cusp::multiply(A, x, r);
+    blas::axpby(b, r, r, ValueType(1), ValueType(-1));
+
+    // r_star <- r, U <- 0, y <- 0
+    blas::copy(r, r_star);
+    blas::fill(U.values, ValueType(0));
+    blas::fill(y, ValueType(0));
+
+    View gamma(h.begin() + L * (L + 1), h.begin() + L * (L + 1) + L);
+    View minus_gamma(h.begin() + L * (L + 1) + L, h.end());
+
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> G(L, L);
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> c(L, 1);
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> g;
+
+    ValueType sigma = 1;
+    ValueType omega = 1;
+
+    bool finished = monitor.finished(r);
+
+    while (!finished)
+    {
+        sigma = -omega * sigma;
+
+        // BiCG part
+        for (size_t j = 0; j < L; j++)
+        {
+            ValueType rho  = blas::dotc(r_star, R.column(j));
+            ValueType beta = rho / sigma;
+
+            // U(0:j) <- R(0:j) - beta * U(0:j), in one pass
+            View U_j = column_values(U, 0, j + 1);
+            blas::axpby(column_values(R, 0, j + 1), U_j, U_j, ValueType(1), -beta);
+
+            // U(j+1) <- A*M*U(j)
+            Column u_j = U.column(j);
+            Column u = U.column(j + 1);
+            cusp::multiply(M, u_j, t);
+            cusp::multiply(A, t, u);
+
+            sigma = blas::dotc(r_star, u);
+
+            ValueType alpha = rho / sigma;
+
+            // R(0:j) <- R(0:j) - alpha * U(1:j+1), in one pass
+            View R_j = column_values(R, 0, j + 1);
+            blas::axpy(column_values(U, 1, j + 2), R_j, -alpha);
+
+            // R(j+1) <- A*M*R(j)
+            Column r_j = R.column(j);
+            Column s = R.column(j + 1);
+            cusp::multiply(M, r_j, t);
+            cusp::multiply(A, t, s);
+
+            // y <- y + alpha * U(0)
+            blas::axpy(U.column(0), y, alpha);
+
+            ++monitor;
+
+            if (monitor.finished(r))
+            {
+                finished = true;
+                break;
+            }
+        }
+
+        if (finished)
+            break;
+
+        // MR part: gamma minimizes || R(0) - R(1:L) gamma ||
+        // h(j-1) <- R(0:L)^H R(j), the columns of the Gram matrix
+        for (size_t j = 1; j <= L; j++)
+        {
+            View h_j(h.begin() + (j - 1) * (L + 1), h.begin() + j * (L + 1));
+            detail_gmres::coefficients(R, L + 1, R.column(j), h_j);
+        }
+        blas::copy(h, hHost);
+
+        for (size_t j = 0; j < L; j++)
+        {
+            for (size_t i = 0; i < L; i++)
+                G(i,j) = hHost[j * (L + 1) + i + 1];
+
+            c(j,0) = cusp::blas::detail::conjugate<ValueType>()(hHost[j * (L + 1)]);
+        }
+
+        if (block::solve(G, c, g) != 0)
+            throw cusp::runtime_exception("bicgstabl breakdown: the residuals of a cycle are linearly dependent");
+
+        for (size_t j = 0; j < L; j++)
+        {
+            hHost[L * (L + 1) + j]     =  g(j,0);
+            hHost[L * (L + 1) + L + j] = -g(j,0);
+        }
+        blas::copy(hHost, h);
+
+        omega = g(L - 1,0);
+
+        typename cusp::array2d<ValueType,MemorySpace,cusp::column_major>::view R_0 = block::columns(R, 0, L);
+        typename cusp::array2d<ValueType,MemorySpace,cusp::column_major>::view R_1 = block::columns(R, 1, L + 1);
+        typename cusp::array2d<ValueType,MemorySpace,cusp::column_major>::view U_1 = block::columns(U, 1, L + 1);
+
+        // U(0) <- U(0) - U(1:L) gamma
+        Column u = U.column(0);
+        detail_gmres::subtract(U_1, L, gamma, u);
+
+        // y <- y + R(0:L-1) gamma
+        detail_gmres::subtract(R_0, L, minus_gamma, y);
+
+        // R(0) <- R(0) - R(1:L) gamma
+        detail_gmres::subtract(R_1, L, gamma, r);
+
+        if (omega == ValueType(0))
+            throw cusp::runtime_exception("bicgstabl breakdown: omega = 0");
+
+        finished = monitor.finished(r);
+    }
+
+    // x <- x + M*y
+    cusp::multiply(M, y, t);
+    blas::axpy(t, x, ValueType(1));
+}
+
+} // end namespace krylov
+} // end namespace cusp
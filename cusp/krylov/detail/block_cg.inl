@@ -0,0 +1,176 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/copy.h>
+#include <cusp/multiply.h>
+#include <cusp/monitor.h>
+#include <cusp/linear_operator.h>
+
+#include <cusp/krylov/detail/block_krylov.h>
+
+namespace blas = cusp::blas;
+
+namespace cusp
+{
+namespace krylov
+{
+
+template <class LinearOperator,
+          class Matrix>
+void block_cg(LinearOperator& A,
+              Matrix& X,
+              Matrix& B)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+
+    cusp::block_monitor<ValueType> monitor(B);
+
+    cusp::krylov::block_cg(A, X, B, monitor);
+}
+
+template <class LinearOperator,
+          class Matrix,
+          class Monitor>
+void block_cg(LinearOperator& A,
+              Matrix& X,
+              Matrix& B,
+              Monitor& monitor)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    cusp::krylov::block_cg(A, X, B, monitor, M);
+}
+
+template <class LinearOperator,
+          class Matrix,
+          class Monitor,
+          class Preconditioner>
+void block_cg(LinearOperator& A,
+              Matrix& X,
+              Matrix& B,
+              Monitor& monitor,
+              Preconditioner& M)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    typedef cusp::array2d<ValueType,MemorySpace,cusp::column_major>       Block;
+    typedef cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> HostBlock;
+
+    assert(A.num_rows == A.num_cols);        // sanity check
+
+    const size_t N = A.num_rows;
+    const size_t k = B.num_cols;
+
+    // contiguous column-major copies of the solutions and residuals,
+    // accessed through the columns that have not converged (active)
+    Block X_(N, k);
+    Block R(N, k);
+    Block Y(N, k);
+
+    cusp::copy(X, X_);
+    cusp::copy(B, R);
+
+    // R <- B - A*X
+    detail_block::multiply(A, X_, Y);
+    blas::axpy(Y.values, R.values, ValueType(-1));
+
+    cusp::array1d<int,cusp::host_memory> h_active;
+    cusp::array1d<int,MemorySpace>       active;
+
+    Block Rm, Z, P, Q;
+    HostBlock rz, rz_new, pq, alpha, beta;
+
+    while (!monitor.finished(R))
+    {
+        // deflate converged columns, which restarts the iteration
+        cusp::array1d<int,cusp::host_memory> h_next;
+        for (size_t j = 0; j < k; j++)
+            if (!monitor.converged(j))
+                h_next.push_back(j);
+
+        const bool restart = h_next.size() != h_active.size();
+
+        if (restart)
+        {
+            h_active = h_next;
+            active   = h_active;
+        }
+
+        const size_t m = h_active.size();
+        const int * map = thrust::raw_pointer_cast(&active[0]);
+
+        // Z <- M*R(:,active)
+        detail_block::gather(R, active, Rm);
+        Z.resize(N, m);
+        detail_block::multiply(M, Rm, Z);
+
+        // rz <- R^H Z
+        detail_block::gram(Rm, Z, rz_new);
+
+        if (restart)
+        {
+            // P <- Z
+            P = Z;
+        }
+        else
+        {
+            // beta <- rz_old^-1 rz
+            if (detail_block::solve(rz, rz_new, beta) != 0)
+                break;
+
+            // P <- Z + P beta
+            Y.resize(N, m);
+            blas::copy(Z.values, Y.values);
+            detail_block::combine(Y, P, beta, ValueType(1), ValueType(1));
+            P.swap(Y);
+        }
+
+        rz = rz_new;
+
+        // Q <- A*P
+        Q.resize(N, m);
+        detail_block::multiply(A, P, Q);
+
+        // alpha <- (P^H Q)^-1 rz
+        detail_block::gram(P, Q, pq);
+
+        if (detail_block::solve(pq, rz, alpha) != 0)
+            break;
+
+        // X <- X + P alpha
+        detail_block::combine(X_, P, alpha, ValueType(1), ValueType(1), map);
+
+        // R <- R - Q alpha
+        detail_block::combine(R, Q, alpha, ValueType(1), ValueType(-1), map);
+
+        ++monitor;
+    }
+
+    cusp::copy(X_, X);
+}
+
+} // end namespace krylov
+} // end namespace cusp
+
@@ -0,0 +1,318 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/copy.h>
+#include <cusp/multiply.h>
+#include <cusp/monitor.h>
+#include <cusp/linear_operator.h>
+
+#include <cusp/krylov/detail/block_krylov.h>
+
+#include <cmath>
+
+namespace blas = cusp::blas;
+
+namespace cusp
+{
+namespace krylov
+{
+namespace detail_block
+{
+  // Apply the Householder reflection I - tau v v^T, which acts on rows
+  // [first, first + v.size()), to column j of the host matrix A.
+  template <typename ValueType, typename HostArray2d>
+  void apply_householder(const HostArray2d& V, const cusp::array1d<ValueType,cusp::host_memory>& tau,
+                         const size_t q, const size_t first, HostArray2d& A, const size_t j)
+  {
+    if (tau[q] == ValueType(0))
+      return;
+
+    const size_t L = V.num_rows;
+
+    ValueType dot = 0;
+    for (size_t i = 0; i < L; i++)
+      dot += V(i,q) * A(first + i, j);
+
+    dot *= tau[q];
+
+    for (size_t i = 0; i < L; i++)
+      A(first + i, j) -= dot * V(i,q);
+  }
+
+  // Compute the Householder reflection that annihilates rows
+  // [first + 1, first + L) of column q of A.
+  template <typename ValueType, typename HostArray2d>
+  void make_householder(HostArray2d& A, const size_t q, const size_t first,
+                        HostArray2d& V, cusp::array1d<ValueType,cusp::host_memory>& tau)
+  {
+    const size_t L = V.num_rows;
+
+    ValueType norm = 0;
+    for (size_t i = 0; i < L; i++)
+      norm += A(first + i, q) * A(first + i, q);
+    norm = std::sqrt(norm);
+
+    if (norm == ValueType(0))
+    {
+      tau[q] = 0;
+      return;
+    }
+
+    const ValueType alpha = A(first, q) > ValueType(0) ? -norm : norm;
+
+    ValueType v_norm = 0;
+    for (size_t i = 0; i < L; i++)
+    {
+      V(i,q) = A(first + i, q);
+      if (i == 0)
+        V(i,q) -= alpha;
+      v_norm += V(i,q) * V(i,q);
+    }
+
+    tau[q] = ValueType(2) / v_norm;
+
+    A(first, q) = alpha;
+    for (size_t i = 1; i < L; i++)
+      A(first + i, q) = 0;
+  }
+} // end namespace detail_block
+
+template <class LinearOperator,
+          class Matrix>
+void block_gmres(LinearOperator& A,
+                 Matrix& X,
+                 Matrix& B,
+                 const size_t restart)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+
+    cusp::block_monitor<ValueType> monitor(B);
+
+    cusp::krylov::block_gmres(A, X, B, restart, monitor);
+}
+
+template <class LinearOperator,
+          class Matrix,
+          class Monitor>
+void block_gmres(LinearOperator& A,
+                 Matrix& X,
+                 Matrix& B,
+                 const size_t restart,
+                 Monitor& monitor)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    cusp::krylov::block_gmres(A, X, B, restart, monitor, M);
+}
+
+template <class LinearOperator,
+          class Matrix,
+          class Monitor,
+          class Preconditioner>
+void block_gmres(LinearOperator& A,
+                 Matrix& X,
+                 Matrix& B,
+                 const size_t restart,
+                 Monitor& monitor,
+                 Preconditioner& M)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    typedef cusp::array2d<ValueType,MemorySpace,cusp::column_major>       Block;
+    typedef cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> HostBlock;
+
+    assert(A.num_rows == A.num_cols);        // sanity check
+    assert(restart > 0);
+
+    const size_t N = A.num_rows;
+    const size_t k = B.num_cols;
+    const size_t s = restart;
+
+    // contiguous column-major copies of the solutions and right-hand sides
+    Block X_(N, k);
+    Block B_(N, k);
+    Block R(N, k);
+    Block Y(N, k);
+
+    cusp::copy(X, X_);
+    cusp::copy(B, B_);
+
+    // R <- B - A*X
+    detail_block::multiply(A, X_, Y);
+    blas::copy(B_.values, R.values);
+    blas::axpy(Y.values, R.values, ValueType(-1));
+
+    while (!monitor.finished(R))
+    {
+        // deflate converged columns
+        cusp::array1d<int,cusp::host_memory> h_active;
+        for (size_t j = 0; j < k; j++)
+            if (!monitor.converged(j))
+                h_active.push_back(j);
+
+        cusp::array1d<int,MemorySpace> active(h_active);
+
+        const size_t m = h_active.size();
+
+        // block Arnoldi basis [V_0, ..., V_s], block Hessenberg matrix H
+        // and least squares right-hand side G
+        Block V(N, (s + 1) * m);
+        Block W(N, m);
+        Block Z(N, m);
+
+        HostBlock H((s + 1) * m, s * m, ValueType(0));
+        HostBlock G((s + 1) * m, m, ValueType(0));
+
+        // Householder reflections triangularizing H, one per column
+        HostBlock Hv(m + 1, s * m, ValueType(0));
+        cusp::array1d<ValueType,cusp::host_memory> tau(s * m, ValueType(0));
+
+        // V_0 S_0 <- R(:,active), G(0:m,:) <- S_0
+        {
+            typename Block::view V0 = detail_block::columns(V, 0, m);
+            detail_block::gather(R, active, V0);
+
+            HostBlock S0;
+            if (detail_block::cholesky_qr(V0, S0) != 0)
+                break;
+
+            for (size_t j = 0; j < m; j++)
+                for (size_t i = 0; i <= j; i++)
+                    G(i,j) = S0(i,j);
+        }
+
+        size_t j = 0;
+
+        while (j < s && monitor.iteration_count() < monitor.iteration_limit())
+        {
+            typename Block::view Vj = detail_block::columns(V, j * m, (j + 1) * m);
+            typename Block::view Vp = detail_block::columns(V, 0, (j + 1) * m);
+
+            // W <- A*M*V_j
+            detail_block::multiply(M, Vj, Z);
+            detail_block::multiply(A, Z, W);
+
+            // block Gram-Schmidt against V_0, ..., V_j, twice
+            HostBlock h1, h2;
+            detail_block::gram(Vp, W, h1);
+            detail_block::combine(W, Vp, h1, ValueType(1), ValueType(-1));
+            detail_block::gram(Vp, W, h2);
+            detail_block::combine(W, Vp, h2, ValueType(1), ValueType(-1));
+
+            for (size_t c = 0; c < m; c++)
+                for (size_t i = 0; i < (j + 1) * m; i++)
+                    H(i, j * m + c) = h1(i,c) + h2(i,c);
+
+            // V_{j+1} S <- W.  Dependent columns mean the block Krylov space
+            // is (nearly) invariant, so the subdiagonal block is dropped.
+            HostBlock S;
+            const bool breakdown = detail_block::cholesky_qr(W, S) != 0;
+
+            if (!breakdown)
+            {
+                typename Block::view Vj1 = detail_block::columns(V, (j + 1) * m, (j + 2) * m);
+                blas::copy(W.values, Vj1.values);
+
+                for (size_t c = 0; c < m; c++)
+                    for (size_t i = 0; i <= c; i++)
+                        H((j + 1) * m + i, j * m + c) = S(i,c);
+            }
+
+            // triangularize the new block column of H and update G
+            for (size_t c = 0; c < m; c++)
+                for (size_t q = 0; q < j * m; q++)
+                    detail_block::apply_householder(Hv, tau, q, q, H, j * m + c);
+
+            for (size_t c = 0; c < m; c++)
+            {
+                const size_t q = j * m + c;
+
+                detail_block::make_householder(H, q, q, Hv, tau);
+
+                for (size_t d = c + 1; d < m; d++)
+                    detail_block::apply_householder(Hv, tau, q, q, H, j * m + d);
+
+                for (size_t d = 0; d < m; d++)
+                    detail_block::apply_householder(Hv, tau, q, q, G, d);
+            }
+
+            ++monitor;
+            ++j;
+
+            if (breakdown)
+                break;
+
+            // the least squares residual of column c is G((j*m):(j+1)*m, c)
+            bool converged = true;
+            for (size_t c = 0; c < m; c++)
+            {
+                ValueType r_norm = 0;
+                for (size_t i = j * m; i < (j + 1) * m; i++)
+                    r_norm += G(i,c) * G(i,c);
+
+                if (std::sqrt(r_norm) > monitor.tolerance(h_active[c]))
+                    converged = false;
+            }
+
+            if (converged)
+                break;
+        }
+
+        if (j == 0)
+            break;
+
+        // solve the triangular system H(0:jm,0:jm) C = G(0:jm,:)
+        const size_t n = j * m;
+
+        HostBlock C(n, m);
+        for (size_t c = 0; c < m; c++)
+        {
+            for (int i = n - 1; i >= 0; i--)
+            {
+                ValueType sum = G(i,c);
+                for (size_t l = i + 1; l < n; l++)
+                    sum -= H(i,l) * C(l,c);
+
+                C(i,c) = H(i,i) == ValueType(0) ? ValueType(0) : sum / H(i,i);
+            }
+        }
+
+        // X(:,active) <- X(:,active) + M*V C
+        detail_block::combine(W, detail_block::columns(V, 0, n), C, ValueType(0), ValueType(1));
+        detail_block::multiply(M, W, Z);
+        detail_block::scatter_add(Z, active, X_);
+
+        // R <- B - A*X
+        detail_block::multiply(A, X_, Y);
+        blas::copy(B_.values, R.values);
+        blas::axpy(Y.values, R.values, ValueType(-1));
+    }
+
+    cusp::copy(X_, X);
+}
+
+} // end namespace krylov
+} // end namespace cusp
+
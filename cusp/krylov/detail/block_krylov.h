@@ -0,0 +1,464 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/format.h>
+#include <cusp/multiply.h>
+#include <cusp/detail/lu.h>
+
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/reduce.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+
+#include <cmath>
+
+namespace cusp
+{
+namespace krylov
+{
+
+// Building blocks of the block Krylov methods.  Blocks of vectors are
+// column-major array2d's (or views) in the memory space of the solver.
+// Inner products between blocks are computed with a single reduction
+// into a small matrix that is copied to the host, where the small dense
+// algebra (factorizations, triangular solves) is done.  Blocks are then
+// updated with small matrices of coefficients in a single pass.
+namespace detail_block
+{
+  template <typename IndexType>
+    struct KERNEL_SEGMENT : public thrust::unary_function<IndexType,IndexType>
+  {
+    IndexType N;
+
+    KERNEL_SEGMENT(IndexType _N) : N(_N) {}
+
+    __host__ __device__
+      IndexType operator()(IndexType i) const
+    {
+      return i / N;
+    }
+  };
+
+  // conj(U(row,i)) * V(row,j) for the linear index t = (j * p + i) * N + row
+  template <typename ValueType, typename IndexType>
+    struct KERNEL_GRAM : public thrust::unary_function<IndexType,ValueType>
+  {
+    const ValueType * U;
+    const ValueType * V;
+    IndexType N;
+    IndexType p;
+    IndexType u_pitch;
+    IndexType v_pitch;
+
+    KERNEL_GRAM(const ValueType * _U, const ValueType * _V, IndexType _N, IndexType _p, IndexType _u_pitch, IndexType _v_pitch)
+      : U(_U), V(_V), N(_N), p(_p), u_pitch(_u_pitch), v_pitch(_v_pitch) {}
+
+    __host__ __device__
+      ValueType operator()(IndexType t) const
+    {
+      const IndexType c   = t / N;
+      const IndexType row = t - c * N;
+      const IndexType j   = c / p;
+      const IndexType i   = c - j * p;
+
+      return cusp::blas::detail::conjugate<ValueType>()(U[i * u_pitch + row]) * V[j * v_pitch + row];
+    }
+  };
+
+  // Y(row,map[j]) <- a * Y(row,map[j]) + b * sum_i P(row,i) * W(i,j)
+  template <typename ValueType, typename IndexType>
+    struct KERNEL_COMBINE
+  {
+    ValueType * Y;
+    const ValueType * P;
+    const ValueType * W;
+    const IndexType * map;
+    IndexType N;
+    IndexType p;
+    IndexType y_pitch;
+    IndexType p_pitch;
+    ValueType a;
+    ValueType b;
+
+    KERNEL_COMBINE(ValueType * _Y, const ValueType * _P, const ValueType * _W, const IndexType * _map,
+                   IndexType _N, IndexType _p, IndexType _y_pitch, IndexType _p_pitch, ValueType _a, ValueType _b)
+      : Y(_Y), P(_P), W(_W), map(_map), N(_N), p(_p), y_pitch(_y_pitch), p_pitch(_p_pitch), a(_a), b(_b) {}
+
+    __host__ __device__
+      void operator()(IndexType t) const
+    {
+      const IndexType j   = t / N;
+      const IndexType row = t - j * N;
+
+      ValueType sum = 0;
+      for (IndexType i = 0; i < p; i++)
+        sum = sum + P[i * p_pitch + row] * W[j * p + i];
+
+      ValueType& y = Y[(map ? map[j] : j) * y_pitch + row];
+
+      // Y need not be initialized when a is zero
+      if (a == ValueType(0))
+        y = b * sum;
+      else
+        y = a * y + b * sum;
+    }
+  };
+
+  // Y(row,j) <- X(row,map[j])
+  template <typename ValueType, typename IndexType>
+    struct KERNEL_GATHER
+  {
+    ValueType * Y;
+    const ValueType * X;
+    const IndexType * map;
+    IndexType N;
+    IndexType y_pitch;
+    IndexType x_pitch;
+
+    KERNEL_GATHER(ValueType * _Y, const ValueType * _X, const IndexType * _map, IndexType _N, IndexType _y_pitch, IndexType _x_pitch)
+      : Y(_Y), X(_X), map(_map), N(_N), y_pitch(_y_pitch), x_pitch(_x_pitch) {}
+
+    __host__ __device__
+      void operator()(IndexType t) const
+    {
+      const IndexType j   = t / N;
+      const IndexType row = t - j * N;
+
+      Y[j * y_pitch + row] = X[map[j] * x_pitch + row];
+    }
+  };
+
+  // Y(row,map[j]) <- Y(row,map[j]) + X(row,j)
+  template <typename ValueType, typename IndexType>
+    struct KERNEL_SCATTER_ADD
+  {
+    ValueType * Y;
+    const ValueType * X;
+    const IndexType * map;
+    IndexType N;
+    IndexType y_pitch;
+    IndexType x_pitch;
+
+    KERNEL_SCATTER_ADD(ValueType * _Y, const ValueType * _X, const IndexType * _map, IndexType _N, IndexType _y_pitch, IndexType _x_pitch)
+      : Y(_Y), X(_X), map(_map), N(_N), y_pitch(_y_pitch), x_pitch(_x_pitch) {}
+
+    __host__ __device__
+      void operator()(IndexType t) const
+    {
+      const IndexType j   = t / N;
+      const IndexType row = t - j * N;
+
+      Y[map[j] * y_pitch + row] = Y[map[j] * y_pitch + row] + X[j * x_pitch + row];
+    }
+  };
+
+  template <typename Array>
+  typename Array::value_type * raw_values(Array& A)
+  {
+    return thrust::raw_pointer_cast(&A.values[0]);
+  }
+
+  template <typename Array>
+  const typename Array::value_type * raw_values(const Array& A)
+  {
+    return thrust::raw_pointer_cast(&A.values[0]);
+  }
+
+  // view of the columns [first, last) of a column-major array2d
+  template <typename Array2d>
+  typename Array2d::view columns(Array2d& V, size_t first, size_t last)
+  {
+    return cusp::make_array2d_view(V.num_rows, last - first, V.pitch,
+                                   cusp::make_array1d_view(V.values.begin() + V.pitch * first,
+                                                           V.values.begin() + V.pitch * last),
+                                   cusp::column_major());
+  }
+
+  template <typename Array2d>
+  typename Array2d::const_view columns(const Array2d& V, size_t first, size_t last)
+  {
+    return cusp::make_array2d_view(V.num_rows, last - first, V.pitch,
+                                   cusp::make_array1d_view(V.values.begin() + V.pitch * first,
+                                                           V.values.begin() + V.pitch * last),
+                                   cusp::column_major());
+  }
+
+  // view of the vector [first, last) as a single column
+  template <typename Iterator>
+  cusp::array2d_view<cusp::array1d_view<Iterator>,cusp::column_major> column_matrix(Iterator first, Iterator last)
+  {
+    const size_t N = last - first;
+
+    return cusp::make_array2d_view(N, 1, N, cusp::make_array1d_view(first, last), cusp::column_major());
+  }
+
+  // y <- A x for views of single columns.  The views are copied into the
+  // parameters, which cusp::multiply can then take by non-const
+  // reference, so callers may pass temporary views.
+  template <typename LinearOperator, typename Vector1, typename Vector2>
+  void multiply_vector(LinearOperator& A, Vector1 x, Vector2 y)
+  {
+    cusp::multiply(A, x, y);
+  }
+
+  // Y <- A X, one SpMM for sparse matrices or one multiply per column
+  // for other operators (e.g. preconditioners)
+  template <typename LinearOperator, typename Array2d1, typename Array2d2>
+  void multiply_columns(LinearOperator& A, const Array2d1& X, Array2d2& Y)
+  {
+    for (size_t j = 0; j < X.num_cols; j++)
+      multiply_vector(A,
+                      cusp::make_array1d_view(X.values.begin() + X.pitch * j, X.values.begin() + X.pitch * j + X.num_rows),
+                      cusp::make_array1d_view(Y.values.begin() + Y.pitch * j, Y.values.begin() + Y.pitch * j + Y.num_rows));
+  }
+
+  template <typename LinearOperator, typename Array2d1, typename Array2d2>
+  void multiply(LinearOperator& A, const Array2d1& X, Array2d2& Y, cusp::sparse_format)
+  {
+    cusp::multiply(A, X, Y);
+  }
+
+  template <typename LinearOperator, typename Array2d1, typename Array2d2>
+  void multiply(LinearOperator& A, const Array2d1& X, Array2d2& Y, cusp::known_format)
+  {
+    multiply_columns(A, X, Y);
+  }
+
+  template <typename LinearOperator, typename Array2d1, typename Array2d2>
+  void multiply(LinearOperator& A, const Array2d1& X, Array2d2& Y, cusp::unknown_format)
+  {
+    multiply_columns(A, X, Y);
+  }
+
+  template <typename LinearOperator, typename Array2d1, typename Array2d2>
+  void multiply(LinearOperator& A, const Array2d1& X, Array2d2& Y)
+  {
+    if (X.num_cols == 0)
+      return;
+
+    multiply(A, X, Y, typename LinearOperator::format());
+  }
+
+  // W <- U^H V, where W is a host column-major matrix
+  template <typename Array2d1, typename Array2d2, typename HostArray2d>
+  void gram(const Array2d1& U, const Array2d2& V, HostArray2d& W)
+  {
+    typedef typename Array2d1::value_type   ValueType;
+    typedef typename Array2d1::memory_space MemorySpace;
+    typedef size_t                          IndexType;
+
+    const IndexType N = U.num_rows;
+    const IndexType p = U.num_cols;
+    const IndexType q = V.num_cols;
+
+    W.resize(p, q);
+
+    if (p == 0 || q == 0)
+      return;
+
+    cusp::array1d<ValueType,MemorySpace> w(p * q);
+
+    thrust::reduce_by_key(thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0), KERNEL_SEGMENT<IndexType>(N)),
+                          thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(N * p * q), KERNEL_SEGMENT<IndexType>(N)),
+                          thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0),
+                                                          KERNEL_GRAM<ValueType,IndexType>(raw_values(U), raw_values(V), N, p, U.pitch, V.pitch)),
+                          thrust::make_discard_iterator(),
+                          w.begin());
+
+    cusp::array1d<ValueType,cusp::host_memory> h_w(w);
+
+    for (size_t j = 0; j < q; j++)
+      for (size_t i = 0; i < p; i++)
+        W(i,j) = h_w[j * p + i];
+  }
+
+  // Y(:,map[j]) <- a * Y(:,map[j]) + b * P W(:,j), for a host matrix W.
+  // Y must not overlap P.  A null map addresses the columns of Y directly.
+  template <typename Array2d1, typename Array2d2, typename HostArray2d, typename ValueType>
+  void combine(Array2d1& Y, const Array2d2& P, const HostArray2d& W, ValueType a, ValueType b,
+               const int * map = 0)
+  {
+    typedef typename Array2d1::memory_space MemorySpace;
+    typedef int                             IndexType;
+
+    const IndexType N = Y.num_rows;
+    const IndexType p = W.num_rows;
+    const IndexType q = W.num_cols;
+
+    if (N == 0 || q == 0)
+      return;
+
+    cusp::array1d<ValueType,cusp::host_memory> h_w(p * q);
+
+    for (IndexType j = 0; j < q; j++)
+      for (IndexType i = 0; i < p; i++)
+        h_w[j * p + i] = W(i,j);
+
+    cusp::array1d<ValueType,MemorySpace> w(h_w);
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(N * q),
+                     KERNEL_COMBINE<ValueType,IndexType>(raw_values(Y), p ? raw_values(P) : 0, thrust::raw_pointer_cast(&w[0]), map,
+                                                         N, p, Y.pitch, P.pitch, a, b));
+  }
+
+  // Y(:,j) <- X(:,map[j])
+  template <typename Array2d1, typename Array2d2, typename IndexArray>
+  void gather(const Array2d1& X, const IndexArray& map, Array2d2& Y)
+  {
+    typedef typename Array2d1::value_type ValueType;
+    typedef int                           IndexType;
+
+    const IndexType N = X.num_rows;
+    const IndexType q = map.size();
+
+    Y.resize(N, q);
+
+    if (N == 0 || q == 0)
+      return;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(N * q),
+                     KERNEL_GATHER<ValueType,IndexType>(raw_values(Y), raw_values(X), thrust::raw_pointer_cast(&map[0]),
+                                                        N, Y.pitch, X.pitch));
+  }
+
+  // Y(:,map[j]) <- Y(:,map[j]) + X(:,j)
+  template <typename Array2d1, typename Array2d2, typename IndexArray>
+  void scatter_add(const Array2d1& X, const IndexArray& map, Array2d2& Y)
+  {
+    typedef typename Array2d1::value_type ValueType;
+    typedef int                           IndexType;
+
+    const IndexType N = X.num_rows;
+    const IndexType q = map.size();
+
+    if (N == 0 || q == 0)
+      return;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(N * q),
+                     KERNEL_SCATTER_ADD<ValueType,IndexType>(raw_values(Y), raw_values(X), thrust::raw_pointer_cast(&map[0]),
+                                                             N, Y.pitch, X.pitch));
+  }
+
+  // X <- S^-1 B for small host matrices.  Returns -1 if S is singular.
+  template <typename HostArray2d1, typename HostArray2d2, typename HostArray2d3>
+  int solve(const HostArray2d1& S, const HostArray2d2& B, HostArray2d3& X)
+  {
+    typedef typename HostArray2d1::value_type ValueType;
+
+    cusp::array2d<ValueType,cusp::host_memory,cusp::row_major> LU(S);
+    cusp::array1d<int,cusp::host_memory> pivot(S.num_rows);
+
+    if (cusp::detail::lu_factor(LU, pivot) != 0)
+      return -1;
+
+    X.resize(B.num_rows, B.num_cols);
+
+    cusp::array1d<ValueType,cusp::host_memory> b(B.num_rows);
+    cusp::array1d<ValueType,cusp::host_memory> x(B.num_rows);
+
+    for (size_t j = 0; j < B.num_cols; j++)
+    {
+      for (size_t i = 0; i < B.num_rows; i++)
+        b[i] = B(i,j);
+
+      if (cusp::detail::lu_solve(LU, pivot, b, x) != 0)
+        return -1;
+
+      for (size_t i = 0; i < B.num_rows; i++)
+        X(i,j) = x[i];
+    }
+
+    return 0;
+  }
+
+  // Orthonormalize the columns of V in place, V = Q S with upper
+  // triangular S (a host column-major matrix).  Cholesky QR is applied
+  // twice, which restores orthogonality to working precision for blocks
+  // that are not too ill-conditioned.  Returns -1 if the columns of V are
+  // numerically dependent.
+  template <typename Array2d, typename HostArray2d>
+  int cholesky_qr(Array2d& V, HostArray2d& S)
+  {
+    typedef typename Array2d::value_type   ValueType;
+    typedef typename Array2d::memory_space MemorySpace;
+
+    const size_t m = V.num_cols;
+
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> T(V.num_rows, m);
+
+    S.resize(m, m);
+    thrust::fill(S.values.begin(), S.values.end(), ValueType(0));
+    for (size_t i = 0; i < m; i++)
+      S(i,i) = 1;
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+      // G = V^H V = L L^H
+      cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> G;
+      gram(V, V, G);
+
+      cusp::array2d<ValueType,cusp::host_memory,cusp::row_major> L(G);
+      if (cusp::detail::cholesky_factor(L) != 0)
+        return -1;
+
+      // C = L^-H, by inverting the lower triangular L one column at a time
+      cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> C(m, m, ValueType(0));
+
+      for (size_t j = 0; j < m; j++)
+      {
+        // solve L c = e_j, then C(j,:) = c^T
+        for (size_t i = j; i < m; i++)
+        {
+          ValueType sum = (i == j) ? ValueType(1) : ValueType(0);
+
+          for (size_t k = j; k < i; k++)
+            sum -= L(i,k) * C(j,k);
+
+          C(j,i) = sum / L(i,i);
+        }
+      }
+
+      // V <- V C
+      combine(T, V, C, ValueType(0), ValueType(1));
+      cusp::blas::copy(T.values, V.values);
+
+      // S <- L^H S
+      cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> LS(m, m, ValueType(0));
+      for (size_t j = 0; j < m; j++)
+        for (size_t i = 0; i <= j; i++)
+          for (size_t k = i; k <= j; k++)
+            LS(i,j) += L(k,i) * S(k,j);
+      S = LS;
+    }
+
+    return 0;
+  }
+
+} // end namespace detail_block
+} // end namespace krylov
+} // end namespace cusp
+
@@ -18,6 +18,7 @@
 #include <cusp/array1d.h>
 #include <cusp/blas.h>
 #include <cusp/multiply.h>
+#include <cusp/prefetch.h>
 #include <cusp/monitor.h>
 #include <cusp/linear_operator.h>
 
@@ -67,26 +68,62 @@ void cg(LinearOperator& A,
         Monitor& monitor,
         Preconditioner& M)
 {
-    CUSP_PROFILE_SCOPED();
-
     typedef typename LinearOperator::value_type   ValueType;
     typedef typename LinearOperator::memory_space MemorySpace;
 
-    assert(A.num_rows == A.num_cols);        // sanity check
+    cusp::krylov::cg_solver<ValueType,MemorySpace> solver(A.num_rows);
 
-    const size_t N = A.num_rows;
+    solver.solve(A, x, b, monitor, M);
+}
 
-    // allocate workspace
-    cusp::array1d<ValueType,MemorySpace> y(N);
-    cusp::array1d<ValueType,MemorySpace> z(N);
-    cusp::array1d<ValueType,MemorySpace> r(N);
-    cusp::array1d<ValueType,MemorySpace> p(N);
-        
-    // y <- Ax
-    cusp::multiply(A, x, y);
+template <typename ValueType, typename MemorySpace>
+cg_solver<ValueType,MemorySpace>::cg_solver(size_t N)
+    : y(N), z(N), r(N), p(N)
+{}
+
+template <typename ValueType, typename MemorySpace>
+void cg_solver<ValueType,MemorySpace>::resize(size_t N)
+{
+    y.resize(N);
+    z.resize(N);
+    r.resize(N);
+    p.resize(N);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector>
+void cg_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b)
+{
+    cusp::default_monitor<ValueType> monitor(b);
+
+    solve(A, x, b, monitor);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector, class Monitor>
+void cg_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor)
+{
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    solve(A, x, b, monitor, M);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector1, class Vector2, class Monitor, class Preconditioner>
+void cg_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector1& x, const Vector2& b, Monitor& monitor, Preconditioner& M)
+{
+    CUSP_PROFILE_SCOPED();
+
+    // migrate operands in managed memory to the device
+    cusp::detail::prefetch_solve(A, x, b);
+
+    assert(A.num_rows == A.num_cols);        // sanity check
 
+    // reuse workspace
+    resize(A.num_rows);
+        
     // r <- b - A*x
-    blas::axpby(b, y, r, ValueType(1), ValueType(-1));
+    cusp::residual(A, x, b, r);
    
     // z <- M*r
     cusp::multiply(M, r, z);
@@ -129,6 +166,22 @@ void cg(LinearOperator& A,
     }
 }
 
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void cg(LinearOperator& A,
+        Vector& x,
+        Vector& b,
+        Monitor& monitor,
+        Preconditioner& M,
+        cudaStream_t stream)
+{
+    cusp::scoped_stream scope(stream);
+
+    cusp::krylov::cg(A, x, b, monitor, M);
+}
+
 } // end namespace krylov
 } // end namespace cusp
 
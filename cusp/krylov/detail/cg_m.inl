@@ -19,6 +19,9 @@
 #include <cusp/blas.h>
 #include <cusp/multiply.h>
 #include <cusp/monitor.h>
+#include <cusp/vector_expression.h>
+
+#include <cusp/detail/device/krylov_m.h>
 
 #include <thrust/copy.h>
 #include <thrust/fill.h>
@@ -29,6 +32,8 @@
 
 #include <thrust/iterator/transform_iterator.h>
 
+#include <cmath>
+
 /*
  * The point of these routines is to solve systems of the type
  *
@@ -111,41 +116,6 @@ namespace detail_m
     }
   };
 
-  // computes new x
-  template <typename ScalarType>
-    struct KERNEL_XP
-  {
-    int N;
-    const ScalarType *alpha_0_s;
-    const ScalarType *beta_0_s;
-    const ScalarType *z_1_s;
-    const ScalarType *r_0;
-
-    KERNEL_XP(int _N, const ScalarType *_alpha_0_s, const ScalarType *_beta_0_s,
-		    const ScalarType *_z_1_s, const ScalarType *_r_0) :
-	            N(_N), alpha_0_s(_alpha_0_s),
-	            beta_0_s(_beta_0_s), z_1_s(_z_1_s), r_0(_r_0) {}
-
-    template <typename Tuple>
-    __host__ __device__
-      void operator()(Tuple t)
-    {
-      // return the transformed result
-      ScalarType x = thrust::get<0>(t);
-      ScalarType p_0 = thrust::get<1>(t);
-      int index = thrust::get<2>(t);
-
-      int N_s = index / N;
-      int N_i = index % N;
-      
-      x = x-beta_0_s[N_s]*p_0;
-      p_0 = z_1_s[N_s]*r_0[N_i]+alpha_0_s[N_s]*p_0;
-
-      thrust::get<0>(t) = x;
-      thrust::get<1>(t) = p_0;
-    }
-  };
-
   // like blas::copy, but copies the same array many times into a larger array
   template <typename ScalarType>
     struct KERNEL_VCOPY : thrust::unary_function<int, ScalarType>
@@ -277,10 +247,46 @@ namespace trans_m
                 beta_0, alpha_0);
   }
 
-  // compute x^\sigma, p^\sigma
-  // this is currently done by calling two different kernels... this is likely
-  // not optimal
-  // uses detail_m::KERNEL_XP
+  // compute x^\sigma, p^\sigma of num_shifts shifts, those listed in
+  // active or all shifts when active is null
+  template <typename ScalarType>
+  void compute_xp_m(const int N, const int num_shifts, const int *active,
+                const ScalarType *alpha_0_s, const ScalarType *z_1_s,
+                const ScalarType *beta_0_s, const ScalarType *r_0,
+                ScalarType *x_0_s, ScalarType *p_0_s, cusp::host_memory)
+  {
+    for (int k = 0; k < num_shifts; k++)
+    {
+      const int s = active == 0 ? k : active[k];
+      const ScalarType alpha = alpha_0_s[s];
+      const ScalarType beta  = beta_0_s[s];
+      const ScalarType z     = z_1_s[s];
+
+      ScalarType *x = x_0_s + size_t(s) * N;
+      ScalarType *p = p_0_s + size_t(s) * N;
+
+      for (int i = 0; i < N; i++)
+      {
+        const ScalarType p_i = p[i];
+        x[i] = x[i] - beta * p_i;
+        p[i] = z * r_0[i] + alpha * p_i;
+      }
+    }
+  }
+
+  // on the device, a tile of shifts is updated per block
+  // (see cusp/detail/device/krylov_m.h)
+  template <typename ScalarType>
+  void compute_xp_m(const int N, const int num_shifts, const int *active,
+                const ScalarType *alpha_0_s, const ScalarType *z_1_s,
+                const ScalarType *beta_0_s, const ScalarType *r_0,
+                ScalarType *x_0_s, ScalarType *p_0_s, cusp::device_memory)
+  {
+    cusp::detail::device::cg_m_xp(N, num_shifts, active, alpha_0_s, beta_0_s,
+                    z_1_s, r_0, x_0_s, p_0_s);
+  }
+
+  // compute x^\sigma, p^\sigma of all shifts
   template <typename Array1, typename Array2, typename Array3,
             typename Array4, typename Array5, typename Array6>
   void compute_xp_m(const Array1& alpha_0_s, const Array2& z_1_s,
@@ -295,21 +301,70 @@ namespace trans_m
     size_t N_t = x_0_s.end()-x_0_s.begin();
     assert (N_t == N*N_s);
 
-    // counting iterators to pass to thrust::transform
-    thrust::counting_iterator<int> counter(0);
+    // compute new x,p
+    cusp::krylov::trans_m::compute_xp_m(int(N), int(N_s), (const int *) 0,
+		    thrust::raw_pointer_cast(alpha_0_s.data()),
+		    thrust::raw_pointer_cast(z_1_s.data()),
+		    thrust::raw_pointer_cast(beta_0_s.data()),
+		    thrust::raw_pointer_cast(r_0.data()),
+		    thrust::raw_pointer_cast(x_0_s.data()),
+		    thrust::raw_pointer_cast(p_0_s.data()),
+		    typename Array5::memory_space());
+  }
 
-    // get raw pointers for passing to kernels
-    typedef typename Array1::value_type   ScalarType;
-    const ScalarType *raw_ptr_alpha_0_s = thrust::raw_pointer_cast(alpha_0_s.data());
-    const ScalarType *raw_ptr_z_1_s     = thrust::raw_pointer_cast(z_1_s.data());
-    const ScalarType *raw_ptr_beta_0_s  = thrust::raw_pointer_cast(beta_0_s.data());
-    const ScalarType *raw_ptr_r_0       = thrust::raw_pointer_cast(r_0.data());
+  // compute x^\sigma, p^\sigma of the shifts listed in active
+  template <typename Array1, typename Array2, typename Array3,
+            typename Array4, typename Array5, typename Array6,
+            typename Array7>
+  void compute_xp_m(const Array1& alpha_0_s, const Array2& z_1_s,
+                const Array3& beta_0_s, const Array4& r_0,
+                Array5& x_0_s, Array6& p_0_s, const Array7& active)
+  {
+    // sanity check
+    cusp::blas::detail::assert_same_dimensions(alpha_0_s,z_1_s,beta_0_s);
+    cusp::blas::detail::assert_same_dimensions(x_0_s,p_0_s);
+    size_t N = r_0.end()-r_0.begin();
+    size_t N_s = alpha_0_s.end()-alpha_0_s.begin();
+    size_t N_t = x_0_s.end()-x_0_s.begin();
+    assert (N_t == N*N_s);
+
+    if (active.size() == 0)
+      return;
 
     // compute new x,p
-    thrust::for_each(
-    thrust::make_zip_iterator(thrust::make_tuple(x_0_s.begin(),p_0_s.begin(),counter)),
-    thrust::make_zip_iterator(thrust::make_tuple(x_0_s.begin(),p_0_s.begin(),counter))+N_t,
-    cusp::krylov::detail_m::KERNEL_XP<ScalarType>(N,raw_ptr_alpha_0_s,raw_ptr_beta_0_s,raw_ptr_z_1_s,raw_ptr_r_0));
+    cusp::krylov::trans_m::compute_xp_m(int(N), int(active.size()),
+		    thrust::raw_pointer_cast(active.data()),
+		    thrust::raw_pointer_cast(alpha_0_s.data()),
+		    thrust::raw_pointer_cast(z_1_s.data()),
+		    thrust::raw_pointer_cast(beta_0_s.data()),
+		    thrust::raw_pointer_cast(r_0.data()),
+		    thrust::raw_pointer_cast(x_0_s.data()),
+		    thrust::raw_pointer_cast(p_0_s.data()),
+		    typename Array5::memory_space());
+  }
+
+  // remove the shifts whose residual norm |\zeta^\sigma| ||r|| satisfies the
+  // tolerance from the list of updated shifts, returns whether it changed
+  template <typename Array1, typename Array2, typename NormType>
+  bool drop_converged_shifts(const Array1& z_1_s, Array2& active,
+                NormType r_norm, NormType tolerance)
+  {
+    typedef typename Array1::value_type ScalarType;
+
+    cusp::array1d<ScalarType,cusp::host_memory> z(z_1_s);
+    cusp::array1d<int,cusp::host_memory>        shifts(active);
+    cusp::array1d<int,cusp::host_memory>        remaining;
+
+    using std::abs;
+    for (size_t k = 0; k < shifts.size(); k++)
+      if (abs(z[shifts[k]]) * r_norm > tolerance)
+        remaining.push_back(shifts[k]);
+
+    if (remaining.size() == shifts.size())
+      return false;
+
+    active = remaining;
+    return true;
   }
 
   template <typename Array1, typename Array2, typename Array3>
@@ -404,6 +459,22 @@ void cg_m(LinearOperator& A,
           VectorType2& b,
           VectorType3& sigma,
           Monitor& monitor)
+{
+    return cg_m(A, x, b, sigma, monitor, false);
+}
+
+// CG-M routine that optionally stops updating converged shifts
+template <class LinearOperator,
+          class VectorType1,
+          class VectorType2,
+          class VectorType3,
+          class Monitor>
+void cg_m(LinearOperator& A,
+          VectorType1& x,
+          VectorType2& b,
+          VectorType3& sigma,
+          Monitor& monitor,
+          bool freeze_converged_shifts)
 {
   //
   // This bit is initialization of the solver.
@@ -412,6 +483,7 @@ void cg_m(LinearOperator& A,
   // shorthand for typenames
   typedef typename LinearOperator::value_type   ValueType;
   typedef typename LinearOperator::memory_space MemorySpace;
+  typedef typename norm_type<ValueType>::type   NormType;
 
   // sanity checking
   const size_t N = A.num_rows;
@@ -466,6 +538,16 @@ void cg_m(LinearOperator& A,
   // set up initial value of p_0 and p_0^\sigma
   cusp::krylov::trans_m::vectorize_copy(b,p_0_s);
   cusp::blas::copy(b,p_0);
+
+  // shifts whose x^\sigma, p^\sigma are still updated
+  cusp::array1d<int,MemorySpace> active;
+  if (freeze_converged_shifts)
+  {
+    cusp::array1d<int,cusp::host_memory> all_shifts(N_s);
+    for (size_t s = 0; s < N_s; s++)
+      all_shifts[s] = int(s);
+    active = all_shifts;
+  }
   
   //
   // Initialization is done. Solve iteratively
@@ -485,15 +567,14 @@ void cg_m(LinearOperator& A,
     // compute \beta_0
     beta_0 = -rsq_0/pAp;
 
-    // compute the new residual
-    cusp::blas::axpy(Ap,r_0,beta_0);
+    // compute the new residual and (r_{i+1},r_{i+1}) in one pass
+    rsq_1 = cusp::blas::assign_dotc(r_0, r_0 + beta_0 * Ap);
 
     // compute \zeta_1^\sigma, \beta_0^\sigma
     cusp::krylov::trans_m::compute_zb_m(z_0_s, z_m1_s, sigma, z_1_s, beta_0_s,
 		    beta_m1, beta_0, alpha_0);
 
     // compute \alpha_0
-    rsq_1 = cusp::blas::dotc(r_0,r_0);
     alpha_0 = rsq_1/rsq_0;
     cusp::krylov::trans_m::xpay(r_0,p_0,alpha_0);
     
@@ -502,8 +583,23 @@ void cg_m(LinearOperator& A,
                                       alpha_0_s, beta_0, alpha_0);
 
     // compute x_0^\sigma, p_0^\sigma
-    cusp::krylov::trans_m::compute_xp_m(alpha_0_s, z_1_s, beta_0_s, r_0,
-                                      x, p_0_s);
+    if (freeze_converged_shifts)
+    {
+      cusp::krylov::trans_m::compute_xp_m(alpha_0_s, z_1_s, beta_0_s, r_0,
+                                        x, p_0_s, active);
+
+      // the residual of a shift is r^\sigma = \zeta^\sigma r
+      using std::abs;
+      using std::sqrt;
+      cusp::krylov::trans_m::drop_converged_shifts(z_1_s, active,
+                                        NormType(sqrt(abs(rsq_1))),
+                                        NormType(monitor.tolerance()));
+    }
+    else
+    {
+      cusp::krylov::trans_m::compute_xp_m(alpha_0_s, z_1_s, beta_0_s, r_0,
+                                        x, p_0_s);
+    }
 
     // recycle \zeta_i^\sigma
     cusp::krylov::trans_m::doublecopy(z_1_s,z_0_s,z_m1_s);
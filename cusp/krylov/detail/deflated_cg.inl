@@ -0,0 +1,353 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/copy.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/prefetch.h>
+#include <cusp/monitor.h>
+#include <cusp/linear_operator.h>
+#include <cusp/detail/lu.h>
+
+#include <cusp/eigen/detail/symmetric_eigen.h>
+#include <cusp/krylov/detail/block_krylov.h>
+
+#include <thrust/copy.h>
+#include <thrust/fill.h>
+
+#include <algorithm>
+
+namespace blas = cusp::blas;
+
+namespace cusp
+{
+namespace krylov
+{
+namespace detail_deflation
+{
+
+  // S <- (S + S^H) / 2, which removes the rounding errors of the
+  // projected matrices W^H A W
+  template <typename HostArray2d>
+  void symmetrize(HostArray2d& S)
+  {
+    typedef typename HostArray2d::value_type ValueType;
+
+    for (size_t j = 0; j < S.num_cols; j++)
+      for (size_t i = 0; i < j; i++)
+      {
+        const ValueType s = (S(i,j) + S(j,i)) / ValueType(2);
+        S(i,j) = s;
+        S(j,i) = s;
+      }
+  }
+
+  // mu <- G^-1 c for the LU factorization of G = W^H A W
+  template <typename HostArray2d1, typename HostArray1d, typename HostArray2d2, typename HostArray2d3>
+  void coefficients(const HostArray2d1& LU, const HostArray1d& pivot, const HostArray2d2& c, HostArray2d3& mu)
+  {
+    typedef typename HostArray2d1::value_type ValueType;
+
+    const size_t k = c.num_rows;
+
+    cusp::array1d<ValueType,cusp::host_memory> rhs(k);
+    cusp::array1d<ValueType,cusp::host_memory> sol(k);
+
+    for (size_t i = 0; i < k; i++)
+      rhs[i] = c(i,0);
+
+    cusp::detail::lu_solve(LU, pivot, rhs, sol);
+
+    mu.resize(k, 1);
+    for (size_t i = 0; i < k; i++)
+      mu(i,0) = sol[i];
+  }
+
+  // S_inv <- S^-1 for an upper triangular S
+  template <typename HostArray2d1, typename HostArray2d2>
+  void invert_upper(const HostArray2d1& S, HostArray2d2& S_inv)
+  {
+    typedef typename HostArray2d1::value_type ValueType;
+
+    const size_t n = S.num_rows;
+
+    S_inv.resize(n, n);
+    thrust::fill(S_inv.values.begin(), S_inv.values.end(), ValueType(0));
+
+    for (size_t j = 0; j < n; j++)
+    {
+      S_inv(j,j) = ValueType(1) / S(j,j);
+
+      for (size_t i = j; i-- > 0; )
+      {
+        ValueType sum = 0;
+
+        for (size_t l = i + 1; l <= j; l++)
+          sum += S(i,l) * S_inv(l,j);
+
+        S_inv(i,j) = -sum / S(i,i);
+      }
+    }
+  }
+
+} // end namespace detail_deflation
+
+template <typename ValueType, typename MemorySpace>
+deflated_cg_solver<ValueType,MemorySpace>::deflated_cg_solver(size_t k, size_t m)
+    : max_vectors(k), max_directions(m ? m : 2 * k), num_vectors(0)
+{}
+
+template <typename ValueType, typename MemorySpace>
+template <class Matrix>
+void deflated_cg_solver<ValueType,MemorySpace>::get_deflation_space(Matrix& W) const
+{
+    cusp::copy(detail_block::columns(basis, 0, num_vectors), W);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class Matrix>
+void deflated_cg_solver<ValueType,MemorySpace>::set_deflation_space(const Matrix& W)
+{
+    if (W.num_cols > max_vectors)
+        throw cusp::invalid_input_exception("deflation space has more columns than the solver keeps");
+
+    basis.resize(W.num_rows, max_vectors + max_directions);
+    basis_A.resize(W.num_rows, max_vectors + max_directions);
+
+    Array2d V(W);
+    thrust::copy(V.values.begin(), V.values.end(), basis.values.begin());
+
+    num_vectors = W.num_cols;
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector>
+void deflated_cg_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b)
+{
+    cusp::default_monitor<ValueType> monitor(b);
+
+    solve(A, x, b, monitor);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector, class Monitor>
+void deflated_cg_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor)
+{
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    solve(A, x, b, monitor, M);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector1, class Vector2, class Monitor, class Preconditioner>
+void deflated_cg_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector1& x, const Vector2& b, Monitor& monitor, Preconditioner& M)
+{
+    typedef cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> HostArray2d;
+
+    CUSP_PROFILE_SCOPED();
+
+    // migrate operands in managed memory to the device
+    cusp::detail::prefetch_solve(A, x, b);
+
+    assert(A.num_rows == A.num_cols);        // sanity check
+
+    const size_t N = A.num_rows;
+
+    // the deflation space is only recycled by systems of the same size
+    if (basis.num_rows != N)
+        num_vectors = 0;
+
+    basis.resize(N, max_vectors + max_directions);
+    basis_A.resize(N, max_vectors + max_directions);
+    R.resize(N, 1);
+    Z.resize(N, 1);
+    P.resize(N, 1);
+    T.resize(N, 1);
+    y.resize(N);
+
+    typename Array2d::column_view r = R.column(0);
+    typename Array2d::column_view z = Z.column(0);
+    typename Array2d::column_view p = P.column(0);
+    typename Array2d::column_view t = T.column(0);
+
+    // G = W^H A W for the current matrix, factored once per solve
+    cusp::array2d<ValueType,cusp::host_memory,cusp::row_major> LU;
+    cusp::array1d<int,cusp::host_memory> pivot(num_vectors);
+    HostArray2d G, c, mu;
+
+    if (num_vectors > 0)
+    {
+        typename Array2d::view W0  = detail_block::columns(basis,   0, num_vectors);
+        typename Array2d::view AW0 = detail_block::columns(basis_A, 0, num_vectors);
+
+        detail_block::multiply(A, W0, AW0);
+        detail_block::gram(W0, AW0, G);
+        detail_deflation::symmetrize(G);
+
+        LU = G;
+
+        // W has become (numerically) dependent, fall back to plain CG
+        if (cusp::detail::lu_factor(LU, pivot) != 0)
+            num_vectors = 0;
+    }
+
+    const size_t k = num_vectors;
+
+    typename Array2d::view W  = detail_block::columns(basis,   0, k);
+    typename Array2d::view AW = detail_block::columns(basis_A, 0, k);
+
+    // r <- b - A*x
+    cusp::residual(A, x, b, r);
+
+    if (k > 0)
+    {
+        // x <- x + W G^-1 W^H r and r <- r - A W G^-1 W^H r, so that r
+        // is orthogonal to W
+        detail_block::gram(W, R, c);
+        detail_deflation::coefficients(LU, pivot, c, mu);
+        detail_block::combine(T, W,  mu, ValueType(0), ValueType(1));
+        detail_block::combine(R, AW, mu, ValueType(1), ValueType(-1));
+        blas::axpy(t, x, ValueType(1));
+    }
+
+    // z <- M*r
+    cusp::multiply(M, r, z);
+
+    // p <- z - W G^-1 (A W)^H z
+    blas::copy(z, p);
+
+    if (k > 0)
+    {
+        detail_block::gram(AW, Z, c);
+        detail_deflation::coefficients(LU, pivot, c, mu);
+        detail_block::combine(P, W, mu, ValueType(1), ValueType(-1));
+    }
+
+    // rz = <r^H, z>
+    ValueType rz = blas::dotc(r, z);
+
+    size_t num_recorded = 0;
+
+    while (!monitor.finished(r))
+    {
+        // y <- Ap
+        cusp::multiply(A, p, y);
+
+        // keep the first directions for the next deflation space
+        if (num_recorded < max_directions)
+        {
+            typename Array2d::column_view p_j  = basis.column(k + num_recorded);
+            typename Array2d::column_view Ap_j = basis_A.column(k + num_recorded);
+
+            blas::copy(p, p_j);
+            blas::copy(y, Ap_j);
+
+            num_recorded++;
+        }
+
+        // alpha <- <r,z>/<y,p>
+        ValueType alpha =  rz / blas::dotc(y, p);
+
+        // x <- x + alpha * p
+        blas::axpy(p, x, alpha);
+
+        // r <- r - alpha * y
+        blas::axpy(y, r, -alpha);
+
+        // z <- M*r
+        cusp::multiply(M, r, z);
+
+        ValueType rz_old = rz;
+
+        // rz = <r^H, z>
+        rz = blas::dotc(r, z);
+
+        // beta <- <r_{i+1},r_{i+1}>/<r,r>
+        ValueType beta = rz / rz_old;
+
+        // p <- z + beta*p - W G^-1 (A W)^H z
+        blas::axpby(z, p, p, ValueType(1), beta);
+
+        if (k > 0)
+        {
+            detail_block::gram(AW, Z, c);
+            detail_deflation::coefficients(LU, pivot, c, mu);
+            detail_block::combine(P, W, mu, ValueType(1), ValueType(-1));
+        }
+
+        ++monitor;
+    }
+
+    update_deflation_space(A, num_recorded);
+}
+
+// Rayleigh-Ritz procedure on span [W, P], where P holds the recorded
+// search directions and [A W, A P] is known from the solve
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator>
+void deflated_cg_solver<ValueType,MemorySpace>::update_deflation_space(LinearOperator& A, size_t num_recorded)
+{
+    typedef cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> HostArray2d;
+
+    if (num_recorded == 0)
+        return;
+
+    const size_t n = num_vectors + num_recorded;
+
+    // Q S = [W, P] and A Q = [A W, A P] S^-1
+    Array2d Q(detail_block::columns(basis, 0, n));
+    HostArray2d S;
+
+    // keep the current deflation space if the directions are dependent
+    if (detail_block::cholesky_qr(Q, S) != 0)
+        return;
+
+    HostArray2d S_inv;
+    detail_deflation::invert_upper(S, S_inv);
+
+    Array2d AQ(basis.num_rows, n);
+    detail_block::combine(AQ, detail_block::columns(basis_A, 0, n), S_inv, ValueType(0), ValueType(1));
+
+    // Q^H A Q = V diag(theta) V^H with ascending Ritz values theta
+    HostArray2d F;
+    detail_block::gram(Q, AQ, F);
+    detail_deflation::symmetrize(F);
+
+    cusp::array1d<ValueType,cusp::host_memory> theta;
+    HostArray2d V;
+    cusp::eigen::detail::symmetric_eigen(F, theta, V);
+
+    // W <- Q V(:,0:k), the Ritz vectors of the smallest Ritz values
+    const size_t k = std::min(max_vectors, n);
+
+    HostArray2d Y(n, k);
+    for (size_t j = 0; j < k; j++)
+        for (size_t i = 0; i < n; i++)
+            Y(i,j) = V(i,j);
+
+    typename Array2d::view W = detail_block::columns(basis, 0, k);
+    detail_block::combine(W, Q, Y, ValueType(0), ValueType(1));
+
+    num_vectors = k;
+}
+
+} // end namespace krylov
+} // end namespace cusp
+
@@ -0,0 +1,218 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/blas.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/prefetch.h>
+#include <cusp/monitor.h>
+#include <cusp/linear_operator.h>
+
+#include <cusp/krylov/gmres.h>
+
+#include <cmath>
+
+namespace blas = cusp::blas;
+namespace cusp
+{
+  namespace krylov
+  {
+    template <class LinearOperator,
+	      class Vector>
+    void fgmres(LinearOperator& A,
+		Vector& x,
+		Vector& b,
+		const size_t restart)
+    {
+      typedef typename LinearOperator::value_type   ValueType;
+      cusp::default_monitor<ValueType> monitor(b);
+      cusp::krylov::fgmres(A, x, b, restart, monitor);
+    }
+
+    template <class LinearOperator,
+	      class Vector,
+	      class Monitor>
+    void fgmres(LinearOperator& A,
+		Vector& x,
+		Vector& b,
+		const size_t restart,
+		Monitor& monitor)
+    {
+      typedef typename LinearOperator::value_type   ValueType;
+      typedef typename LinearOperator::memory_space MemorySpace;
+      cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+      cusp::krylov::fgmres(A, x, b, restart, monitor, M);
+    }
+
+    template <class LinearOperator,
+	      class Vector,
+	      class Monitor,
+	      class Preconditioner>
+    void fgmres(LinearOperator& A,
+		Vector& x,
+		Vector& b,
+		const size_t restart,
+		Monitor& monitor,
+		Preconditioner& M)
+    {
+      typedef typename LinearOperator::value_type   ValueType;
+      typedef typename LinearOperator::memory_space MemorySpace;
+      cusp::krylov::fgmres_solver<ValueType,MemorySpace> solver(A.num_rows, restart);
+      solver.solve(A, x, b, monitor, M);
+    }
+
+    template <typename ValueType, typename MemorySpace>
+    fgmres_solver<ValueType,MemorySpace>::fgmres_solver(size_t N, size_t restart)
+      : restart(0)
+    {
+      resize(N, restart);
+    }
+
+    template <typename ValueType, typename MemorySpace>
+    void fgmres_solver<ValueType,MemorySpace>::resize(size_t N, size_t restart)
+    {
+      const size_t R = restart;
+      this->restart = restart;
+      //device workspace
+      if (V.num_rows != N || V.num_cols != R+1)
+	V.resize(N, R+1);                          //Arnoldi basis
+      if (Z.num_rows != N || Z.num_cols != R)
+	Z.resize(N, R);                            //preconditioned basis
+      h.resize(2*(R+1));                           //projection coefficients of both block Gram-Schmidt passes
+      hHost.resize(2*(R+1));
+      //HOST WORKSPACE
+      if (H.num_rows != R+1 || H.num_cols != R)
+	H.resize(R+1, R);                          //Hessenberg matrix
+      s.resize(R+1);
+      cs.resize(R);
+      sn.resize(R);
+      resid.resize(1);
+    }
+
+    template <typename ValueType, typename MemorySpace>
+    template <class LinearOperator, class Vector>
+    void fgmres_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b)
+    {
+      cusp::default_monitor<ValueType> monitor(b);
+      solve(A, x, b, monitor);
+    }
+
+    template <typename ValueType, typename MemorySpace>
+    template <class LinearOperator, class Vector, class Monitor>
+    void fgmres_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor)
+    {
+      cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+      solve(A, x, b, monitor, M);
+    }
+
+    template <typename ValueType, typename MemorySpace>
+    template <class LinearOperator, class Vector1, class Vector2, class Monitor, class Preconditioner>
+    void fgmres_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector1& x, const Vector2& b, Monitor& monitor, Preconditioner& M)
+    {
+      CUSP_PROFILE_SCOPED();
+
+      // migrate operands in managed memory to the device
+      cusp::detail::prefetch_solve(A, x, b);
+
+      assert(A.num_rows == A.num_cols);        // sanity check
+      if (restart == 0)
+	throw cusp::invalid_input_exception("fgmres_solver requires a positive restart length");
+      //reuse workspace
+      resize(A.num_rows, restart);
+      const int R = restart;
+      int i, j, k;
+      NormType beta = 0;
+      // the Arnoldi and preconditioned vectors are formed in place in the columns of V and Z //
+      typedef typename cusp::array2d<ValueType,MemorySpace,cusp::column_major>::column_view Column;
+      // the coefficients of both Gram-Schmidt passes share one copy to the host //
+      typename cusp::array1d<ValueType,MemorySpace>::view h1(h.begin(), h.begin() + R+1);
+      typename cusp::array1d<ValueType,MemorySpace>::view h2(h.begin() + R+1, h.end());
+      do{
+	// compute initial residual and its norm //
+	Column v = V.column(0);
+	cusp::residual(A, x, b, v);                  // V(0) = b - A*x    //
+	beta = blas::nrm2(v);                        // beta = norm(V(0)) //
+	//s = 0 //
+	blas::fill(s,ValueType(0.0));
+	s[0] = beta;
+	i = -1;
+	resid[0] = s[0];
+	if (monitor.finished(resid)){
+	  break;
+	}
+	blas::scal(v, ValueType(1.0/beta));          // V(0) = V(0)/beta  //
+
+	do{
+	  ++i;
+	  ++monitor;
+
+	  // Z(i) = M*V(i), where M may differ in every step //
+	  Column v_i = V.column(i);
+	  Column z = Z.column(i);
+	  cusp::multiply(M,v_i,z);
+	  // V(i+1) = A*Z(i) //
+	  Column w = V.column(i+1);
+	  cusp::multiply(A,z,w);
+
+	  // H(0:i,i) = V(0:i)^H V(i+1)    //
+	  // V(i+1) -= V(0:i) * H(0:i,i)   //
+	  // repeated once (CGS2) to retain the orthogonality of MGS //
+	  detail_gmres::project(V, i+1, w, h1);
+	  detail_gmres::project(V, i+1, w, h2);
+	  blas::copy(h, hHost);
+	  for (k = 0; k <= i; k++){
+	    H(k, i) = hHost[k] + hHost[R+1+k];
+	  }
+
+	  H(i+1,i) = blas::nrm2(w);
+	  // V(i+1) = V(i+1) / H(i+1, i), unless the space is invariant //
+	  if (H(i+1,i) != ValueType(0)){
+	    blas::scal(w,ValueType(1.0)/H(i+1,i));
+	  }
+
+	  PlaneRotation(H,cs,sn,s,i);
+
+	  resid[0] = std::abs(s[i+1]);
+
+	  //check convergence condition
+	  if (monitor.finished(resid)){
+	    break;
+	  }
+	}while (i+1 < R && monitor.iteration_count()+1 <= monitor.iteration_limit());
+
+
+	// solve upper triangular system in place //
+	for (j = i; j >= 0; j--){
+	  s[j] /= H(j,j);
+	  //S(0:j) = s(0:j) - s[j] H(0:j,j)
+	  for (k = j-1; k >= 0; k--){
+	    s[k] -= H(k,j) * s[j];
+	  }
+	}
+
+	// update the solution //
+	//copy -s to gpu
+	for (j = 0; j <= i; j++){
+	  s[j] = -s[j];
+	}
+	blas::copy(s,h1);
+	// x = x - Z(1:N,0:i)*(-s(0:i)) in a single pass over Z //
+	detail_gmres::subtract(Z, i+1, h1, x);
+      } while (!monitor.finished(resid));
+    }
+  } // end namespace krylov
+} // end namespace cusp
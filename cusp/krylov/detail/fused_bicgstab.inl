@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/monitor.h>
+#include <cusp/linear_operator.h>
+#include <cusp/prefetch.h>
+#include <cusp/krylov/bicgstab.h>
+
+#include <cusp/detail/device/fused_bicgstab.h>
+
+#include <algorithm>
+
+namespace cusp
+{
+namespace krylov
+{
+namespace detail
+{
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void fused_bicgstab(LinearOperator& A,
+                    Vector& x,
+                    Vector& b,
+                    Monitor& monitor,
+                    Preconditioner& M,
+                    const size_t check_interval,
+                    cusp::host_memory)
+{
+    // scalars live on the host anyway
+    cusp::krylov::bicgstab(A, x, b, monitor, M);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void fused_bicgstab(LinearOperator& A,
+                    Vector& x,
+                    Vector& b,
+                    Monitor& monitor,
+                    Preconditioner& M,
+                    const size_t check_interval,
+                    cusp::device_memory)
+{
+    cusp::detail::device::fused_bicgstab(A, x, b, monitor, M, check_interval);
+}
+
+} // end namespace detail
+
+template <class LinearOperator,
+          class Vector>
+void fused_bicgstab(LinearOperator& A,
+                    Vector& x,
+                    Vector& b)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+
+    cusp::default_monitor<ValueType> monitor(b);
+
+    cusp::krylov::fused_bicgstab(A, x, b, monitor);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor>
+void fused_bicgstab(LinearOperator& A,
+                    Vector& x,
+                    Vector& b,
+                    Monitor& monitor)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    cusp::krylov::fused_bicgstab(A, x, b, monitor, M);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void fused_bicgstab(LinearOperator& A,
+                    Vector& x,
+                    Vector& b,
+                    Monitor& monitor,
+                    Preconditioner& M,
+                    size_t check_interval)
+{
+    CUSP_PROFILE_SCOPED();
+
+    // migrate operands in managed memory to the device
+    cusp::detail::prefetch_solve(A, x, b);
+
+    assert(A.num_rows == A.num_cols);        // sanity check
+
+    cusp::krylov::detail::fused_bicgstab(A, x, b, monitor, M, std::max<size_t>(check_interval, 1),
+                                         typename LinearOperator::memory_space());
+}
+
+} // end namespace krylov
+} // end namespace cusp
@@ -0,0 +1,153 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/prefetch.h>
+#include <cusp/monitor.h>
+#include <cusp/linear_operator.h>
+
+#include <cusp/krylov/gmres.h>
+
+namespace blas = cusp::blas;
+namespace cusp
+{
+  namespace krylov
+  {
+    template <class LinearOperator,
+	      class Vector>
+    void gcr(LinearOperator& A,
+	     Vector& x,
+	     Vector& b,
+	     const size_t restart)
+    {
+      typedef typename LinearOperator::value_type   ValueType;
+      cusp::default_monitor<ValueType> monitor(b);
+      cusp::krylov::gcr(A, x, b, restart, monitor);
+    }
+
+    template <class LinearOperator,
+	      class Vector,
+	      class Monitor>
+    void gcr(LinearOperator& A,
+	     Vector& x,
+	     Vector& b,
+	     const size_t restart,
+	     Monitor& monitor)
+    {
+      typedef typename LinearOperator::value_type   ValueType;
+      typedef typename LinearOperator::memory_space MemorySpace;
+      cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+      cusp::krylov::gcr(A, x, b, restart, monitor, M);
+    }
+
+    template <class LinearOperator,
+	      class Vector,
+	      class Monitor,
+	      class Preconditioner>
+    void gcr(LinearOperator& A,
+	     Vector& x,
+	     Vector& b,
+	     const size_t restart,
+	     Monitor& monitor,
+	     Preconditioner& M)
+    {
+      CUSP_PROFILE_SCOPED();
+
+      // migrate operands in managed memory to the device
+      cusp::detail::prefetch_solve(A, x, b);
+
+      typedef typename LinearOperator::value_type   ValueType;
+      typedef typename LinearOperator::memory_space MemorySpace;
+      typedef typename norm_type<ValueType>::type   NormType;
+
+      assert(A.num_rows == A.num_cols);        // sanity check
+
+      if (restart == 0)
+	throw cusp::invalid_input_exception("gcr requires a positive restart length");
+
+      const size_t N = A.num_rows;
+      const int R = restart;
+
+      // search directions P and their products Q = A P, with orthonormal Q
+      cusp::array2d<ValueType,MemorySpace,cusp::column_major> P(N, R);
+      cusp::array2d<ValueType,MemorySpace,cusp::column_major> Q(N, R);
+      cusp::array1d<ValueType,MemorySpace> r(N);
+      cusp::array1d<ValueType,MemorySpace> z(N);
+      cusp::array1d<ValueType,MemorySpace> q(N);
+      cusp::array1d<ValueType,MemorySpace> h(R);
+
+      int k = R;
+
+      while (true)
+      {
+	// restart from the true residual r = b - A x
+	if (k == R)
+	{
+	  cusp::multiply(A, x, r);
+	  blas::axpby(b, r, r, ValueType(1), ValueType(-1));
+	  k = 0;
+	}
+
+	if (monitor.finished(r))
+	  break;
+
+	++monitor;
+
+	// z = M r, q = A z
+	cusp::multiply(M, r, z);
+	cusp::multiply(A, z, q);
+
+	// q -= Q(0:k) h, z -= P(0:k) h with h = Q(0:k)^H q, twice (CGS2)
+	for (int pass = 0; k > 0 && pass < 2; pass++)
+	{
+	  detail_gmres::coefficients(Q, k, q, h);
+	  detail_gmres::subtract(Q, k, h, q);
+	  detail_gmres::subtract(P, k, h, z);
+	}
+
+	const NormType q_norm = blas::nrm2(q);
+
+	// A z lies in the span of the previous products, restart
+	if (q_norm == NormType(0))
+	{
+	  if (k == 0)
+	    throw cusp::runtime_exception("gcr breakdown: A M r = 0 for a nonzero residual");
+
+	  k = R;
+	  continue;
+	}
+
+	blas::scal(q, ValueType(1) / ValueType(q_norm));
+	blas::scal(z, ValueType(1) / ValueType(q_norm));
+
+	// x += alpha z, r -= alpha q minimizes the residual norm along q
+	const ValueType alpha = blas::dotc(q, r);
+
+	blas::axpy(z, x,  alpha);
+	blas::axpy(q, r, -alpha);
+
+	blas::copy(z, P.column(k));
+	blas::copy(q, Q.column(k));
+	k++;
+      }
+    }
+  } // end namespace krylov
+} // end namespace cusp
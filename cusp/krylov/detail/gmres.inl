@@ -15,15 +15,142 @@
  */
 #include <cusp/array1d.h>
 #include <cusp/blas.h>
+#include <cusp/exception.h>
 #include <cusp/multiply.h>
+#include <cusp/prefetch.h>
 #include <cusp/monitor.h>
 #include <cusp/linear_operator.h>
 
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/reduce.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <cstddef>
+
 namespace blas = cusp::blas;
 namespace cusp
 {
   namespace krylov
   {    
+    // Block (classical) Gram-Schmidt against the first k columns of the
+    // column-major Arnoldi basis V.  Both h = V^H w and w = w - V h touch
+    // every column in a single pass, so an Arnoldi step costs a constant
+    // number of reductions instead of one per basis vector.
+    namespace detail_gmres
+    {
+      template <typename IndexType>
+	struct KERNEL_COLUMN : public thrust::unary_function<IndexType,IndexType>
+      {
+	IndexType N;
+
+	KERNEL_COLUMN(IndexType _N) : N(_N) {}
+
+	__host__ __device__
+	  IndexType operator()(IndexType i) const
+	{
+	  return i / N;
+	}
+      };
+
+      // conj(V(row,j)) * w(row) for the linear index i = j * N + row
+      template <typename ValueType, typename IndexType>
+	struct KERNEL_VHW : public thrust::unary_function<IndexType,ValueType>
+      {
+	const ValueType * V;
+	const ValueType * w;
+	IndexType N;
+	IndexType pitch;
+
+	KERNEL_VHW(const ValueType * _V, const ValueType * _w, IndexType _N, IndexType _pitch)
+	  : V(_V), w(_w), N(_N), pitch(_pitch) {}
+
+	__host__ __device__
+	  ValueType operator()(IndexType i) const
+	{
+	  const IndexType j   = i / N;
+	  const IndexType row = i - j * N;
+
+	  return cusp::blas::detail::conjugate<ValueType>()(V[j * pitch + row]) * w[row];
+	}
+      };
+
+      // w(row) <- w(row) - sum_j V(row,j) * h(j)
+      template <typename ValueType, typename IndexType>
+	struct KERNEL_W_MINUS_VH
+      {
+	const ValueType * V;
+	const ValueType * h;
+	IndexType num_cols;
+	IndexType pitch;
+
+	KERNEL_W_MINUS_VH(const ValueType * _V, const ValueType * _h, IndexType _num_cols, IndexType _pitch)
+	  : V(_V), h(_h), num_cols(_num_cols), pitch(_pitch) {}
+
+	template <typename Tuple>
+	__host__ __device__
+	  void operator()(Tuple t) const
+	{
+	  const IndexType row = thrust::get<1>(t);
+
+	  ValueType sum = 0;
+	  for (IndexType j = 0; j < num_cols; j++)
+	    sum = sum + V[j * pitch + row] * h[j];
+
+	  thrust::get<0>(t) = thrust::get<0>(t) - sum;
+	}
+      };
+
+      // h(0:k) <- V(:,0:k)^H w
+      template <typename Array2d, typename Array1, typename Array2>
+      void coefficients(const Array2d& V, const int k, const Array1& w, Array2& h)
+      {
+	// linear indices into V run up to k * pitch, past the range of index_type
+	typedef std::ptrdiff_t IndexType;
+	typedef typename Array2d::value_type ValueType;
+
+	const IndexType N = V.num_rows;
+
+	const ValueType * V_ptr = thrust::raw_pointer_cast(&V.values[0]);
+	const ValueType * w_ptr = thrust::raw_pointer_cast(&w[0]);
+
+	thrust::reduce_by_key(thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0), KERNEL_COLUMN<IndexType>(N)),
+			      thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(k * N), KERNEL_COLUMN<IndexType>(N)),
+			      thrust::make_transform_iterator(thrust::counting_iterator<IndexType>(0), KERNEL_VHW<ValueType,IndexType>(V_ptr, w_ptr, N, V.pitch)),
+			      thrust::make_discard_iterator(),
+			      h.begin());
+      }
+
+      // w <- w - V(:,0:k) h(0:k)
+      template <typename Array2d, typename Array1, typename Array2>
+      void subtract(const Array2d& V, const int k, const Array2& h, Array1& w)
+      {
+	// linear indices into V run up to k * pitch, past the range of index_type
+	typedef std::ptrdiff_t IndexType;
+	typedef typename Array2d::value_type ValueType;
+
+	const IndexType N = V.num_rows;
+
+	const ValueType * V_ptr = thrust::raw_pointer_cast(&V.values[0]);
+	const ValueType * h_ptr = thrust::raw_pointer_cast(&h[0]);
+
+	thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(w.begin(), thrust::counting_iterator<IndexType>(0))),
+			 thrust::make_zip_iterator(thrust::make_tuple(w.begin(), thrust::counting_iterator<IndexType>(0))) + N,
+			 KERNEL_W_MINUS_VH<ValueType,IndexType>(V_ptr, h_ptr, k, V.pitch));
+      }
+
+      // h(0:k) <- V(:,0:k)^H w, w <- w - V(:,0:k) h(0:k)
+      template <typename Array2d, typename Array1, typename Array2>
+      void project(const Array2d& V, const int k, Array1& w, Array2& h)
+      {
+	coefficients(V, k, w, h);
+	subtract(V, k, h, w);
+      }
+    } // end namespace detail_gmres
+
     template <typename ValueType> 
     void ApplyPlaneRotation(ValueType& dx,
 			    ValueType& dy,
@@ -110,32 +237,84 @@ namespace cusp
     {
       typedef typename LinearOperator::value_type   ValueType;
       typedef typename LinearOperator::memory_space MemorySpace;
-      typedef typename norm_type<ValueType>::type NormType;
+      cusp::krylov::gmres_solver<ValueType,MemorySpace> solver(A.num_rows, restart);
+      solver.solve(A, x, b, monitor, M);
+    }
+
+    template <typename ValueType, typename MemorySpace>
+    gmres_solver<ValueType,MemorySpace>::gmres_solver(size_t N, size_t restart)
+      : restart(0)
+    {
+      resize(N, restart);
+    }
+
+    template <typename ValueType, typename MemorySpace>
+    void gmres_solver<ValueType,MemorySpace>::resize(size_t N, size_t restart)
+    {
+      const size_t R = restart;
+      this->restart = restart;
+      //device workspace
+      V0.resize(N);                                //A times the last Arnoldi vector
+      if (V.num_rows != N || V.num_cols != R+1)
+	V.resize(N, R+1);                          //Arnoldi matrix
+      sDev.resize(R+1);                            //duplicate copy of s on GPU
+      h.resize(2*(R+1));                           //projection coefficients of both block Gram-Schmidt passes
+      hHost.resize(2*(R+1));
+      //HOST WORKSPACE
+      if (H.num_rows != R+1 || H.num_cols != R)
+	H.resize(R+1, R);                          //Hessenberg matrix
+      s.resize(R+1);
+      cs.resize(R);
+      sn.resize(R);
+      resid.resize(1);
+    }
+
+    template <typename ValueType, typename MemorySpace>
+    template <class LinearOperator, class Vector>
+    void gmres_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b)
+    {
+      cusp::default_monitor<ValueType> monitor(b);
+      solve(A, x, b, monitor);
+    }
+
+    template <typename ValueType, typename MemorySpace>
+    template <class LinearOperator, class Vector, class Monitor>
+    void gmres_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor)
+    {
+      cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+      solve(A, x, b, monitor, M);
+    }
+
+    template <typename ValueType, typename MemorySpace>
+    template <class LinearOperator, class Vector, class Monitor, class Preconditioner>
+    void gmres_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor, Preconditioner& M)
+    {
+      CUSP_PROFILE_SCOPED();
+
+      // migrate operands in managed memory to the device
+      cusp::detail::prefetch_solve(A, x, b);
+
       assert(A.num_rows == A.num_cols);        // sanity check
-      const size_t N = A.num_rows;
+      if (restart == 0)
+	throw cusp::invalid_input_exception("gmres_solver requires a positive restart length");
+      //reuse workspace
+      resize(A.num_rows, restart);
       const int R = restart;
       int i, j, k;
       NormType beta = 0;
-      cusp::array1d<NormType,cusp::host_memory> resid(1);
-      //allocate workspace
-      cusp::array1d<ValueType,MemorySpace> w(N);
-      cusp::array1d<ValueType,MemorySpace> V0(N); //Arnoldi matrix pos 0
-      cusp::array2d<ValueType,MemorySpace,cusp::column_major> V(N,R+1,ValueType(0.0)); //Arnoldi matrix
-      //duplicate copy of s on GPU
-      cusp::array1d<ValueType,MemorySpace> sDev(R+1);
-      //HOST WORKSPACE
-      cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> H(R+1, R); //Hessenberg matrix
-      cusp::array1d<ValueType,cusp::host_memory> s(R+1);
-      cusp::array1d<ValueType,cusp::host_memory> cs(R);
-      cusp::array1d<ValueType,cusp::host_memory> sn(R);
+      // the Arnoldi vectors are formed in place in the columns of V //
+      typedef typename cusp::array2d<ValueType,MemorySpace,cusp::column_major>::column_view Column;
+      // the coefficients of both Gram-Schmidt passes share one copy to the host //
+      typename cusp::array1d<ValueType,MemorySpace>::view h1(h.begin(), h.begin() + R+1);
+      typename cusp::array1d<ValueType,MemorySpace>::view h2(h.begin() + R+1, h.end());
       do{
 	// compute initial residual and its norm //
-	cusp::multiply(A, x, w);                     // V(0) = A*x        //
-	blas::axpy(b,w,ValueType(-1));               // V(0) = V(0) - b   //
-	cusp::multiply(M,w,w);                       // V(0) = M*V(0)     //
-	beta = blas::nrm2(w);                        // beta = norm(V(0)) //
-	blas::scal(w, ValueType(-1.0/beta));         // V(0) = -V(0)/beta //
-	blas::copy(w,V.column(0));
+	Column v = V.column(0);
+	cusp::multiply(A, x, v);                     // V(0) = A*x        //
+	blas::axpy(b,v,ValueType(-1));               // V(0) = V(0) - b   //
+	cusp::multiply(M,v,v);                       // V(0) = M*V(0)     //
+	beta = blas::nrm2(v);                        // beta = norm(V(0)) //
+	blas::scal(v, ValueType(-1.0/beta));         // V(0) = -V(0)/beta //
 	//s = 0 //
 	blas::fill(s,ValueType(0.0));
 	s[0] = beta;
@@ -150,22 +329,25 @@ namespace cusp
 	  ++monitor;
 	  
 	  //apply preconditioner
-	  //can't pass in ref to column in V so need to use copy (w)
-	  cusp::multiply(A,w,V0);
+	  Column v_i = V.column(i);
+	  cusp::multiply(A,v_i,V0);
 	  //V(i+1) = A*w = M*A*V(i)    //
+	  Column w = V.column(i+1);
 	  cusp::multiply(M,V0,w);
 	  
+	  // H(0:i,i) = V(0:i)^H V(i+1)    //
+	  // V(i+1) -= V(0:i) * H(0:i,i)   //
+	  // repeated once (CGS2) to retain the orthogonality of MGS //
+	  detail_gmres::project(V, i+1, w, h1);
+	  detail_gmres::project(V, i+1, w, h2);
+	  blas::copy(h, hHost);
 	  for (k = 0; k <= i; k++){
-	    //  H(k,i) = <V(i+1),V(k)>    //
-	    H(k, i) = blas::dotc(w, V.column(k));
-	    // V(i+1) -= H(k, i) * V(k)  //
-	    blas::axpy(V.column(k),w,-H(k,i));
+	    H(k, i) = hHost[k] + hHost[R+1+k];
 	  }
 	  
 	  H(i+1,i) = blas::nrm2(w);   
 	  // V(i+1) = V(i+1) / H(i+1, i) //
 	  blas::scal(w,ValueType(1.0)/H(i+1,i));
-	  blas::copy(w,V.column(i+1));
 	  
 	  PlaneRotation(H,cs,sn,s,i);
 	  
@@ -189,14 +371,31 @@ namespace cusp
 	
 	// update the solution //
 	
-	//copy s to gpu 
-	blas::copy(s,sDev);
-	// x= V(1:N,0:i)*s(0:i)+x //
+	//copy -s to gpu 
 	for (j = 0; j <= i; j++){
-	  // x = x + s[j] * V(j) //
-	  blas::axpy(V.column(j),x,s[j]);
+	  s[j] = -s[j];
 	}
+	blas::copy(s,sDev);
+	// x = x - V(1:N,0:i)*(-s(0:i)) in a single pass over V //
+	detail_gmres::subtract(V, i+1, sDev, x);
       } while (!monitor.finished(resid));
     }
+
+    template <class LinearOperator,
+	      class Vector,
+	      class Monitor,
+	      class Preconditioner>
+    void gmres(LinearOperator& A,
+	       Vector& x,
+	       Vector& b,
+	       const size_t restart,
+	       Monitor& monitor,
+	       Preconditioner& M,
+	       cudaStream_t stream)
+    {
+      cusp::scoped_stream scope(stream);
+
+      cusp::krylov::gmres(A, x, b, restart, monitor, M);
+    }
   } // end namespace krylov
 } // end namespace cusp
@@ -0,0 +1,355 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/copy.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/prefetch.h>
+#include <cusp/monitor.h>
+#include <cusp/linear_operator.h>
+#include <cusp/detail/random.h>
+
+#include <cusp/krylov/gmres.h>
+#include <cusp/krylov/detail/block_krylov.h>
+
+#include <thrust/transform.h>
+#include <thrust/tuple.h>
+
+#include <cmath>
+
+namespace blas = cusp::blas;
+
+namespace cusp
+{
+namespace krylov
+{
+namespace detail_idrs
+{
+  // maps [0,1) to [-1,1)
+  template <typename ValueType>
+  struct KERNEL_SYMMETRIC_RANDOM : public thrust::unary_function<ValueType,ValueType>
+  {
+    __host__ __device__
+    ValueType operator()(const ValueType& x) const
+    {
+      return ValueType(2) * x - ValueType(1);
+    }
+  };
+
+  // x(k:n) <- L(k:n,k:n)^-1 b(k:n) for the lower triangular part of L
+  template <typename HostArray2d, typename HostArray1, typename HostArray2>
+  void forward_substitution(const HostArray2d& L, const size_t k, const size_t n, const HostArray1& b, HostArray2& x)
+  {
+    typedef typename HostArray2d::value_type ValueType;
+
+    for (size_t i = k; i < n; i++)
+    {
+      ValueType sum = b[i];
+
+      for (size_t j = k; j < i; j++)
+        sum -= L(i,j) * x[j];
+
+      x[i] = sum / L(i,i);
+    }
+  }
+} // end namespace detail_idrs
+
+template <class LinearOperator,
+          class Vector>
+void idrs(LinearOperator& A,
+          Vector& x,
+          Vector& b,
+          const size_t s)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+
+    cusp::default_monitor<ValueType> monitor(b);
+
+    cusp::krylov::idrs(A, x, b, s, monitor);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor>
+void idrs(LinearOperator& A,
+          Vector& x,
+          Vector& b,
+          const size_t s,
+          Monitor& monitor)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    cusp::krylov::idrs(A, x, b, s, monitor, M);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void idrs(LinearOperator& A,
+          Vector& x,
+          Vector& b,
+          const size_t s,
+          Monitor& monitor,
+          Preconditioner& M)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    cusp::krylov::idrs_solver<ValueType,MemorySpace> solver(A.num_rows, s);
+
+    solver.solve(A, x, b, monitor, M);
+}
+
+template <typename ValueType, typename MemorySpace>
+idrs_solver<ValueType,MemorySpace>::idrs_solver(size_t N, size_t s)
+    : s(0)
+{
+    resize(N, s);
+}
+
+template <typename ValueType, typename MemorySpace>
+void idrs_solver<ValueType,MemorySpace>::resize(size_t N, size_t s)
+{
+    this->s = s;
+
+    if (P.num_rows != N || P.num_cols != s)
+    {
+        // random shadow space with orthonormal columns
+        P.resize(N, s);
+
+        cusp::copy(cusp::detail::random_reals<ValueType>(P.values.size()), P.values);
+        thrust::transform(P.values.begin(), P.values.end(), P.values.begin(), detail_idrs::KERNEL_SYMMETRIC_RANDOM<ValueType>());
+
+        cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> S;
+        cusp::krylov::detail_block::cholesky_qr(P, S);
+    }
+    if (U.num_rows != N || U.num_cols != s)
+        U.resize(N, s);
+    if (G.num_rows != N || G.num_cols != s)
+        G.resize(N, s);
+    r.resize(N);
+    v.resize(N);
+    t.resize(N);
+
+    // coefficients c and -c of a step, or the inner products with P
+    h.resize(2 * s);
+    hHost.resize(2 * s);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector>
+void idrs_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b)
+{
+    cusp::default_monitor<ValueType> monitor(b);
+
+    solve(A, x, b, monitor);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector, class Monitor>
+void idrs_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor)
+{
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    solve(A, x, b, monitor, M);
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class LinearOperator, class Vector, class Monitor, class Preconditioner>
+void idrs_solver<ValueType,MemorySpace>::solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor, Preconditioner& M)
+{
+    CUSP_PROFILE_SCOPED();
+
+    // migrate operands in managed memory to the device
+    cusp::detail::prefetch_solve(A, x, b);
+
+    namespace block = cusp::krylov::detail_block;
+
+    typedef typename norm_type<ValueType>::type NormType;
+    typedef typename cusp::array2d<ValueType,MemorySpace,cusp::column_major>::column_view Column;
+    typedef typename cusp::array1d<ValueType,MemorySpace>::view                       View;
+
+    assert(A.num_rows == A.num_cols);        // sanity check
+
+    if (s == 0)
+        throw cusp::invalid_input_exception("idrs_solver requires a positive shadow space dimension s");
+
+    // reuse workspace
+    resize(A.num_rows, s);
+
+    const size_t S = s;
+
+    // keeps the residual reduction of a minimal residual step from being
+    // too small, see "Maintaining convergence properties of BiCGstab
+    // methods in finite precision arithmetic" by Sleijpen and van der Vorst
+    const NormType kappa = 0.7;
+
+    // r <- b - A*x
+    cusp::multiply(A, x, r);
+    blas::axpby(b, r, r, ValueType(1), ValueType(-1));
+
+    blas::fill(U.values, ValueType(0));
+    blas::fill(G.values, ValueType(0));
+
+    // Mh = P^H G, lower triangular by the biorthogonalization
+    cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> Mh(S, S, ValueType(0));
+    for (size_t i = 0; i < S; i++)
+        Mh(i,i) = 1;
+
+    cusp::array1d<ValueType,cusp::host_memory> f(S);
+    cusp::array1d<ValueType,cusp::host_memory> c(S);
+    cusp::array1d<ValueType,cusp::host_memory> mu(S);
+
+    ValueType omega = 1;
+
+    bool finished = monitor.finished(r);
+
+    while (!finished)
+    {
+        // f = P^H r
+        detail_gmres::coefficients(P, S, r, h);
+        blas::copy(h, hHost);
+        for (size_t i = 0; i < S; i++)
+            f[i] = hHost[i];
+
+        for (size_t k = 0; k < S; k++)
+        {
+            // c = Mh(k:S,k:S)^-1 f(k:S)
+            detail_idrs::forward_substitution(Mh, k, S, f, c);
+
+            for (size_t i = k; i < S; i++)
+            {
+                hHost[i - k]     =  c[i];
+                hHost[S + i - k] = -c[i];
+            }
+            blas::copy(hHost, h);
+
+            View c_dev(h.begin(), h.begin() + (S - k));
+            View minus_c_dev(h.begin() + S, h.begin() + (2 * S - k));
+
+            // v = r - G(:,k:S) c
+            blas::copy(r, v);
+            detail_gmres::subtract(block::columns(G, k, S), S - k, c_dev, v);
+
+            // U(:,k) = U(:,k:S) c + omega M v
+            cusp::multiply(M, v, t);
+            blas::scal(t, omega);
+            detail_gmres::subtract(block::columns(U, k, S), S - k, minus_c_dev, t);
+
+            Column u = U.column(k);
+            Column g = G.column(k);
+            blas::copy(t, u);
+
+            // G(:,k) = A U(:,k)
+            cusp::multiply(A, t, g);
+
+            // mu = P^H G(:,k) gives both the coefficients that make G(:,k)
+            // orthogonal to P(:,0:k) and the new column of Mh
+            detail_gmres::coefficients(P, S, g, h);
+            blas::copy(h, hHost);
+            for (size_t i = 0; i < S; i++)
+                mu[i] = hHost[i];
+
+            if (k > 0)
+            {
+                // a = Mh(0:k,0:k)^-1 mu(0:k)
+                detail_idrs::forward_substitution(Mh, 0, k, mu, c);
+
+                for (size_t i = 0; i < k; i++)
+                    hHost[i] = c[i];
+                blas::copy(hHost, h);
+
+                // G(:,k) -= G(:,0:k) a, U(:,k) -= U(:,0:k) a
+                detail_gmres::subtract(block::columns(G, 0, k), k, h, g);
+                detail_gmres::subtract(block::columns(U, 0, k), k, h, u);
+            }
+
+            for (size_t i = k; i < S; i++)
+            {
+                ValueType sum = mu[i];
+
+                for (size_t j = 0; j < k; j++)
+                    sum -= c[j] * Mh(i,j);
+
+                Mh(i,k) = sum;
+            }
+
+            if (Mh(k,k) == ValueType(0))
+                throw cusp::runtime_exception("idrs breakdown: P^H A U is singular");
+
+            // r -= beta G(:,k), x += beta U(:,k) makes r orthogonal to P(:,0:k+1)
+            ValueType beta = f[k] / Mh(k,k);
+
+            blas::axpy(g, r, -beta);
+            blas::axpy(u, x,  beta);
+
+            ++monitor;
+
+            if (monitor.finished(r))
+            {
+                finished = true;
+                break;
+            }
+
+            for (size_t i = k + 1; i < S; i++)
+                f[i] -= beta * Mh(i,k);
+        }
+
+        if (finished)
+            break;
+
+        // enter the next subspace with a minimal residual step
+        cusp::multiply(M, r, v);
+        cusp::multiply(A, v, t);
+
+        thrust::tuple<ValueType,ValueType,ValueType> dots = blas::dotc_n(t, r, t, t, r, r);
+
+        const ValueType tr    = thrust::get<0>(dots);
+        const NormType  t_norm = std::sqrt(std::abs(thrust::get<1>(dots)));
+        const NormType  r_norm = std::sqrt(std::abs(thrust::get<2>(dots)));
+
+        if (t_norm == NormType(0))
+            throw cusp::runtime_exception("idrs breakdown: A M r = 0");
+
+        const NormType rho = std::abs(tr) / (t_norm * r_norm);
+
+        if (rho == NormType(0))
+            throw cusp::runtime_exception("idrs breakdown: omega = 0");
+
+        omega = tr / ValueType(t_norm * t_norm);
+
+        if (rho < kappa)
+            omega = omega * ValueType(kappa / rho);
+
+        blas::axpy(t, r, -omega);
+        blas::axpy(v, x,  omega);
+
+        ++monitor;
+
+        finished = monitor.finished(r);
+    }
+}
+
+} // end namespace krylov
+} // end namespace cusp
@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/complex.h>
+#include <cusp/exception.h>
+
+#include <cusp/krylov/detail/block_krylov.h>
+
+#include <thrust/copy.h>
+
+#include <cmath>
+#include <limits>
+
+namespace cusp
+{
+namespace krylov
+{
+
+template <typename ValueType, typename MemorySpace>
+initial_guess_projector<ValueType,MemorySpace>::initial_guess_projector(size_t k)
+    : max_vectors(k), num_vectors(0)
+{}
+
+template <typename ValueType, typename MemorySpace>
+template <class Vector1, class Vector2>
+void initial_guess_projector<ValueType,MemorySpace>::add(const Vector1& x, const Vector2& b)
+{
+    typedef typename cusp::norm_type<ValueType>::type                      NormType;
+    typedef cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> HostArray2d;
+
+    const size_t N = b.size();
+
+    if (x.size() != N)
+        throw cusp::invalid_input_exception("solution and right-hand side have different sizes");
+
+    if (max_vectors == 0)
+        return;
+
+    // one more column than kept holds the new pair
+    if (X.num_rows != N)
+    {
+        num_vectors = 0;
+        X.resize(N, max_vectors + 1);
+        B.resize(N, max_vectors + 1);
+    }
+
+    const size_t q = num_vectors;
+
+    typename Array2d::column_view x_q = X.column(q);
+    typename Array2d::column_view b_q = B.column(q);
+
+    blas::copy(x, x_q);
+    blas::copy(b, b_q);
+
+    const NormType norm_b = blas::nrm2(b_q);
+
+    if (norm_b == NormType(0))
+        return;
+
+    if (q > 0)
+    {
+        typename Array2d::view X0 = detail_block::columns(X, 0, q);
+        typename Array2d::view B0 = detail_block::columns(B, 0, q);
+        typename Array2d::view Xq = detail_block::columns(X, q, q + 1);
+        typename Array2d::view Bq = detail_block::columns(B, q, q + 1);
+
+        // b_q <- b_q - B0 B0^H b_q and x_q <- x_q - X0 B0^H b_q, with two
+        // passes of classical Gram-Schmidt
+        for (int pass = 0; pass < 2; pass++)
+        {
+            HostArray2d c;
+            detail_block::gram(B0, Bq, c);
+            detail_block::combine(Bq, B0, c, ValueType(1), ValueType(-1));
+            detail_block::combine(Xq, X0, c, ValueType(1), ValueType(-1));
+        }
+    }
+
+    const NormType norm = blas::nrm2(b_q);
+
+    // b is (numerically) in the span of the kept right-hand sides
+    if (norm <= std::sqrt(std::numeric_limits<NormType>::epsilon()) * norm_b)
+        return;
+
+    blas::scal(b_q, ValueType(1) / ValueType(norm));
+    blas::scal(x_q, ValueType(1) / ValueType(norm));
+
+    num_vectors++;
+
+    // discard the oldest pair, the remaining right-hand sides are still
+    // orthonormal
+    if (num_vectors > max_vectors)
+    {
+        Array2d T(detail_block::columns(X, 1, num_vectors));
+        thrust::copy(T.values.begin(), T.values.end(), X.values.begin());
+
+        T = detail_block::columns(B, 1, num_vectors);
+        thrust::copy(T.values.begin(), T.values.end(), B.values.begin());
+
+        num_vectors--;
+    }
+}
+
+template <typename ValueType, typename MemorySpace>
+template <class Vector1, class Vector2>
+void initial_guess_projector<ValueType,MemorySpace>::guess(const Vector1& b, Vector2& x) const
+{
+    typedef cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> HostArray2d;
+
+    if (num_vectors == 0)
+        return;
+
+    if (b.size() != X.num_rows || x.size() != X.num_rows)
+        throw cusp::invalid_input_exception("linear system has another size than the kept solutions");
+
+    // c <- B^H b and x <- X c
+    HostArray2d c;
+    detail_block::gram(detail_block::columns(B, 0, num_vectors), detail_block::column_matrix(b.begin(), b.end()), c);
+
+    cusp::array2d_view<cusp::array1d_view<typename Vector2::iterator>,cusp::column_major> x_ =
+        detail_block::column_matrix(x.begin(), x.end());
+
+    detail_block::combine(x_, detail_block::columns(X, 0, num_vectors), c, ValueType(0), ValueType(1));
+}
+
+} // end namespace krylov
+} // end namespace cusp
+
@@ -0,0 +1,195 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/monitor.h>
+#include <cusp/linear_operator.h>
+
+#include <cusp/krylov/cg.h>
+#include <cusp/krylov/gmres.h>
+
+#include <thrust/transform.h>
+
+namespace blas = cusp::blas;
+
+namespace cusp
+{
+namespace krylov
+{
+namespace detail_refinement
+{
+  // r_low <- LowType(alpha * r), in the precision of r
+  template <typename ValueType, typename LowType>
+  struct KERNEL_SCALED_CAST : public thrust::unary_function<ValueType,LowType>
+  {
+    ValueType alpha;
+
+    KERNEL_SCALED_CAST(ValueType alpha) : alpha(alpha) {}
+
+    __host__ __device__
+    LowType operator()(const ValueType& r) const
+    {
+      return LowType(alpha * r);
+    }
+  };
+
+  // x <- x + alpha * d, in the precision of x
+  template <typename ValueType, typename LowType>
+  struct KERNEL_CORRECT : public thrust::binary_function<ValueType,LowType,ValueType>
+  {
+    ValueType alpha;
+
+    KERNEL_CORRECT(ValueType alpha) : alpha(alpha) {}
+
+    __host__ __device__
+    ValueType operator()(const ValueType& x, const LowType& d) const
+    {
+      return x + alpha * ValueType(d);
+    }
+  };
+} // end namespace detail_refinement
+
+template <typename Preconditioner>
+template <typename MatrixType, typename Vector>
+void refinement_cg<Preconditioner>::operator()(MatrixType& A, Vector& r, Vector& d)
+{
+  typedef typename MatrixType::value_type ValueType;
+
+  blas::fill(d, ValueType(0));
+
+  cusp::default_monitor<ValueType> monitor(r, iteration_limit, tolerance);
+  cusp::krylov::cg(A, d, r, monitor, M);
+}
+
+template <typename Preconditioner>
+template <typename MatrixType, typename Vector>
+void refinement_gmres<Preconditioner>::operator()(MatrixType& A, Vector& r, Vector& d)
+{
+  typedef typename MatrixType::value_type ValueType;
+
+  blas::fill(d, ValueType(0));
+
+  cusp::default_monitor<ValueType> monitor(r, iteration_limit, tolerance);
+  cusp::krylov::gmres(A, d, r, restart, monitor, M);
+}
+
+template <typename Preconditioner>
+template <typename MatrixType, typename Vector>
+void refinement_preconditioner<Preconditioner>::operator()(MatrixType& A, Vector& r, Vector& d)
+{
+  cusp::multiply(M, r, d);
+}
+
+template <typename LowMatrixType>
+template <typename MatrixType>
+iterative_refinement_solver<LowMatrixType>::iterative_refinement_solver(const MatrixType& A)
+{
+  setup(A);
+}
+
+template <typename LowMatrixType>
+template <typename MatrixType>
+void iterative_refinement_solver<LowMatrixType>::setup(const MatrixType& A)
+{
+  CUSP_PROFILE_SCOPED();
+
+  if (A.num_rows != A.num_cols)
+    throw cusp::invalid_input_exception("iterative_refinement requires a square matrix");
+
+  A_low = A;
+
+  r_low.resize(A.num_rows);
+  d_low.resize(A.num_rows);
+}
+
+template <typename LowMatrixType>
+template <class MatrixType, class Vector, class Monitor>
+void iterative_refinement_solver<LowMatrixType>::solve(MatrixType& A, Vector& x, Vector& b, Monitor& monitor)
+{
+  cusp::identity_operator<LowValueType,MemorySpace> M(A_low.num_rows, A_low.num_cols);
+  cusp::krylov::refinement_cg< cusp::identity_operator<LowValueType,MemorySpace> > inner(M);
+  solve(A, x, b, monitor, inner);
+}
+
+template <typename LowMatrixType>
+template <class MatrixType, class Vector, class Monitor, class InnerSolver>
+void iterative_refinement_solver<LowMatrixType>::solve(MatrixType& A, Vector& x, Vector& b, Monitor& monitor, InnerSolver& inner)
+{
+  CUSP_PROFILE_SCOPED();
+
+  typedef typename MatrixType::value_type   ValueType;
+  typedef typename MatrixType::memory_space MemorySpace2;
+
+  if (A.num_rows != A_low.num_rows || A.num_cols != A_low.num_cols)
+    throw cusp::invalid_input_exception("iterative_refinement matrix does not match the solver setup");
+
+  const size_t N = A.num_rows;
+
+  cusp::array1d<ValueType,MemorySpace2> r(N);
+
+  // r <- b - A x
+  cusp::residual(A, x, b, r);
+
+  while (!monitor.finished(r))
+  {
+    const ValueType norm_r = monitor.residual_norm();
+
+    // r_low <- r / ||r||, so that the rounded residual stays in the range
+    // of the low precision however small r becomes
+    thrust::transform(r.begin(), r.end(), r_low.begin(),
+                      detail_refinement::KERNEL_SCALED_CAST<ValueType,LowValueType>(ValueType(1) / norm_r));
+
+    // A_low d_low = r_low
+    inner(A_low, r_low, d_low);
+
+    // x <- x + ||r|| d_low
+    thrust::transform(x.begin(), x.end(), d_low.begin(), x.begin(),
+                      detail_refinement::KERNEL_CORRECT<ValueType,LowValueType>(norm_r));
+
+    ++monitor;
+
+    // r <- b - A x
+    cusp::residual(A, x, b, r);
+  }
+}
+
+template <class MatrixType, class Vector, class Monitor>
+void iterative_refinement(MatrixType& A, Vector& x, Vector& b, Monitor& monitor)
+{
+  typedef typename MatrixType::index_type   IndexType;
+  typedef typename MatrixType::memory_space MemorySpace;
+
+  cusp::krylov::iterative_refinement_solver< cusp::csr_matrix<IndexType,float,MemorySpace> > solver(A);
+  solver.solve(A, x, b, monitor);
+}
+
+template <class MatrixType, class Vector, class Monitor, class InnerSolver>
+void iterative_refinement(MatrixType& A, Vector& x, Vector& b, Monitor& monitor, InnerSolver& inner)
+{
+  typedef typename MatrixType::index_type   IndexType;
+  typedef typename MatrixType::memory_space MemorySpace;
+
+  cusp::krylov::iterative_refinement_solver< cusp::csr_matrix<IndexType,float,MemorySpace> > solver(A);
+  solver.solve(A, x, b, monitor, inner);
+}
+
+} // end namespace krylov
+} // end namespace cusp
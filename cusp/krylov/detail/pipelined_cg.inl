@@ -0,0 +1,220 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/multiply.h>
+#include <cusp/prefetch.h>
+#include <cusp/monitor.h>
+#include <cusp/linear_operator.h>
+
+#include <cusp/detail/stream.h>
+
+#include <thrust/functional.h>
+#include <thrust/tuple.h>
+#include <thrust/iterator/zip_iterator.h>
+
+namespace cusp
+{
+namespace krylov
+{
+namespace detail_pipelined
+{
+  // (conj(r) * u, conj(w) * u)
+  template <typename ValueType>
+    struct KERNEL_GAMMA_DELTA : public thrust::unary_function< thrust::tuple<ValueType,ValueType,ValueType>, thrust::tuple<ValueType,ValueType> >
+  {
+    template <typename Tuple>
+    __host__ __device__
+      thrust::tuple<ValueType,ValueType> operator()(const Tuple& t) const
+    {
+      const ValueType u = thrust::get<1>(t);
+
+      return thrust::make_tuple(cusp::blas::detail::conjugate<ValueType>()(thrust::get<0>(t)) * u,
+                                cusp::blas::detail::conjugate<ValueType>()(thrust::get<2>(t)) * u);
+    }
+  };
+
+  template <typename ValueType>
+    struct KERNEL_GAMMA_DELTA_SUM : public thrust::binary_function< thrust::tuple<ValueType,ValueType>, thrust::tuple<ValueType,ValueType>, thrust::tuple<ValueType,ValueType> >
+  {
+    __host__ __device__
+      thrust::tuple<ValueType,ValueType> operator()(const thrust::tuple<ValueType,ValueType>& a,
+                                                    const thrust::tuple<ValueType,ValueType>& b) const
+    {
+      return thrust::make_tuple(thrust::get<0>(a) + thrust::get<0>(b),
+                                thrust::get<1>(a) + thrust::get<1>(b));
+    }
+  };
+
+  // all eight vector recurrences of an iteration in a single pass
+  //
+  //   z <- n + beta z,  q <- m + beta q,  s <- w + beta s,  p <- u + beta p
+  //   x <- x + alpha p, r <- r - alpha s, u <- u - alpha q, w <- w - alpha z
+  template <typename ValueType>
+    struct KERNEL_UPDATE
+  {
+    ValueType alpha;
+    ValueType beta;
+
+    KERNEL_UPDATE(ValueType _alpha, ValueType _beta) : alpha(_alpha), beta(_beta) {}
+
+    template <typename Tuple>
+    __host__ __device__
+      void operator()(Tuple t)
+    {
+      // (z, q, s, p, x, r, u, w, n, m)
+      const ValueType z = thrust::get<8>(t) + beta * thrust::get<0>(t);
+      const ValueType q = thrust::get<9>(t) + beta * thrust::get<1>(t);
+      const ValueType s = thrust::get<7>(t) + beta * thrust::get<2>(t);
+      const ValueType p = thrust::get<6>(t) + beta * thrust::get<3>(t);
+
+      thrust::get<0>(t) = z;
+      thrust::get<1>(t) = q;
+      thrust::get<2>(t) = s;
+      thrust::get<3>(t) = p;
+
+      thrust::get<4>(t) = thrust::get<4>(t) + alpha * p;
+      thrust::get<5>(t) = thrust::get<5>(t) - alpha * s;
+      thrust::get<6>(t) = thrust::get<6>(t) - alpha * q;
+      thrust::get<7>(t) = thrust::get<7>(t) - alpha * z;
+    }
+  };
+} // end namespace detail_pipelined
+
+template <class LinearOperator,
+          class Vector>
+void pipelined_cg(LinearOperator& A,
+                  Vector& x,
+                  Vector& b)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+
+    cusp::default_monitor<ValueType> monitor(b);
+
+    cusp::krylov::pipelined_cg(A, x, b, monitor);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor>
+void pipelined_cg(LinearOperator& A,
+                  Vector& x,
+                  Vector& b,
+                  Monitor& monitor)
+{
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    cusp::identity_operator<ValueType,MemorySpace> M(A.num_rows, A.num_cols);
+
+    cusp::krylov::pipelined_cg(A, x, b, monitor, M);
+}
+
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void pipelined_cg(LinearOperator& A,
+                  Vector& x,
+                  Vector& b,
+                  Monitor& monitor,
+                  Preconditioner& M)
+{
+    CUSP_PROFILE_SCOPED();
+
+    // migrate operands in managed memory to the device
+    cusp::detail::prefetch_solve(A, x, b);
+
+    typedef typename LinearOperator::value_type   ValueType;
+    typedef typename LinearOperator::memory_space MemorySpace;
+
+    assert(A.num_rows == A.num_cols);        // sanity check
+
+    const size_t N = A.num_rows;
+
+    // allocate workspace
+    cusp::array1d<ValueType,MemorySpace> r(N);
+    cusp::array1d<ValueType,MemorySpace> u(N);
+    cusp::array1d<ValueType,MemorySpace> w(N);
+    cusp::array1d<ValueType,MemorySpace> m(N);
+    cusp::array1d<ValueType,MemorySpace> n(N);
+    cusp::array1d<ValueType,MemorySpace> z(N, ValueType(0));
+    cusp::array1d<ValueType,MemorySpace> q(N, ValueType(0));
+    cusp::array1d<ValueType,MemorySpace> s(N, ValueType(0));
+    cusp::array1d<ValueType,MemorySpace> p(N, ValueType(0));
+
+    // r <- b - A*x
+    cusp::multiply(A, x, w);
+    cusp::blas::axpby(b, w, r, ValueType(1), ValueType(-1));
+
+    // u <- M*r
+    cusp::multiply(M, r, u);
+
+    // w <- A*u
+    cusp::multiply(A, u, w);
+
+    ValueType gamma_old = 0;
+    ValueType alpha     = 0;
+
+    bool first_iteration = true;
+
+    while (!monitor.finished(r))
+    {
+        // m <- M*w, n <- A*m
+        //
+        // neither depends on gamma and delta below: they are issued first
+        // such that the reduction completes behind them
+        cusp::multiply(M, w, m);
+        cusp::multiply(A, m, n);
+
+        // gamma <- <r,u>, delta <- <w,u> in a single reduction
+        thrust::tuple<ValueType,ValueType> gamma_delta =
+            cusp::detail::streamed::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(r.begin(), u.begin(), w.begin())),
+                                                     thrust::make_zip_iterator(thrust::make_tuple(r.begin(), u.begin(), w.begin())) + N,
+                                                     detail_pipelined::KERNEL_GAMMA_DELTA<ValueType>(),
+                                                     thrust::make_tuple(ValueType(0), ValueType(0)),
+                                                     detail_pipelined::KERNEL_GAMMA_DELTA_SUM<ValueType>());
+
+        const ValueType gamma = thrust::get<0>(gamma_delta);
+        const ValueType delta = thrust::get<1>(gamma_delta);
+
+        ValueType beta;
+
+        if (first_iteration)
+        {
+            beta  = 0;
+            alpha = gamma / delta;
+        }
+        else
+        {
+            beta  = gamma / gamma_old;
+            alpha = gamma / (delta - beta * gamma / alpha);
+        }
+
+        gamma_old       = gamma;
+        first_iteration = false;
+
+        cusp::detail::streamed::for_each(thrust::make_zip_iterator(thrust::make_tuple(z.begin(), q.begin(), s.begin(), p.begin(), x.begin(), r.begin(), u.begin(), w.begin(), n.begin(), m.begin())),
+                                         thrust::make_zip_iterator(thrust::make_tuple(z.begin(), q.begin(), s.begin(), p.begin(), x.begin(), r.begin(), u.begin(), w.begin(), n.begin(), m.begin())) + N,
+                                         detail_pipelined::KERNEL_UPDATE<ValueType>(alpha, beta));
+
+        ++monitor;
+    }
+}
+
+} // end namespace krylov
+} // end namespace cusp
@@ -0,0 +1,175 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file fgmres.h
+ *  \brief Flexible Generalized Minimum Residual (FGMRES) method
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+
+namespace cusp
+{
+   namespace krylov
+   {
+
+      /*! \addtogroup iterative_solvers Iterative Solvers
+       *  \addtogroup krylov_methods Krylov Methods
+       *  \ingroup iterative_solvers
+       *  \{
+       */
+
+      /*! \p fgmres : Flexible GMRES method
+       *
+       * Solves the nonsymmetric, linear system A x = b
+       * using the default convergence criteria.
+       */
+     template <class LinearOperator, class Vector>
+       void fgmres(LinearOperator& A,
+		   Vector& x,
+		   Vector& b,
+		   const size_t restart);
+
+      /*! \p fgmres : Flexible GMRES method
+       *
+       * Solves the nonsymmetric, linear system A x = b without preconditioning.
+       */
+      template <class LinearOperator,
+	        class Vector,
+                class Monitor>
+	void fgmres(LinearOperator& A,
+		    Vector& x,
+		    Vector& b,
+		    const size_t restart,
+		    Monitor& monitor);
+
+      /*! \p fgmres : Flexible GMRES method
+       *
+       * Solves the nonsymmetric, linear system A x = b
+       * with a right preconditioner \p M that may change from one
+       * application to the next, such as a multigrid cycle with an
+       * iterative coarse solve or an inner Krylov method.
+       *
+       * Unlike \p gmres, the preconditioned vectors M v are kept in a
+       * second basis Z next to the Arnoldi basis V, and the update of
+       * x is formed from Z.  Both bases are contiguous column-major
+       * \p array2d, so an Arnoldi step orthogonalizes against all
+       * previous columns with two passes of block Gram-Schmidt.  The
+       * monitor sees the norm of the unpreconditioned residual b - A x.
+       *
+       * \param A matrix of the linear system
+       * \param x approximate solution of the linear system
+       * \param b right-hand side of the linear system
+       * \param restart the method every restart inner iterations
+       * \param monitor montiors iteration and determines stopping conditions
+       * \param M preconditioner for A
+       *
+       * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+       * \tparam Vector vector
+       * \tparam Monitor is a monitor such as \p default_monitor or \p verbose_monitor
+       * \tparam Preconditioner is a matrix or subclass of \p linear_operator
+       *
+       * \note The workspace holds 2 * restart + 1 vectors, restart - 1
+       * more than \p gmres.
+       *
+       *  \see \p gmres
+       *  \see \p gcr
+       */
+      template <class LinearOperator,
+               class Vector,
+               class Monitor,
+               class Preconditioner>
+                  void fgmres(LinearOperator& A,
+                        Vector& x,
+                        Vector& b,
+                        const size_t restart,
+                        Monitor& monitor,
+                        Preconditioner& M);
+
+      /*! \p fgmres_solver : Flexible GMRES method with a persistent workspace
+       *
+       *  The workspace follows \p gmres_solver, with the preconditioned
+       *  basis Z in addition to the Arnoldi basis, and is reused for
+       *  every subsequent solve of the same (or a smaller) size and
+       *  restart length.
+       *
+       *  \tparam ValueType scalar type of the linear systems
+       *  \tparam MemorySpace memory space of the linear systems
+       *
+       *  \see \p fgmres
+       *  \see \p gmres_solver
+       */
+      template <typename ValueType, typename MemorySpace>
+      class fgmres_solver
+      {
+        typedef typename norm_type<ValueType>::type NormType;
+
+        size_t restart;
+
+        cusp::array2d<ValueType,MemorySpace,cusp::column_major> V;
+        cusp::array2d<ValueType,MemorySpace,cusp::column_major> Z;
+        cusp::array1d<ValueType,MemorySpace> h;
+        cusp::array1d<ValueType,cusp::host_memory> hHost;
+        cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> H;
+        cusp::array1d<ValueType,cusp::host_memory> s;
+        cusp::array1d<ValueType,cusp::host_memory> cs;
+        cusp::array1d<ValueType,cusp::host_memory> sn;
+        cusp::array1d<NormType,cusp::host_memory> resid;
+
+        public:
+
+        /*! construct a \p fgmres_solver with an empty workspace and
+         *  restart length 30
+         */
+        fgmres_solver(void) : restart(30) {}
+
+        /*! construct a \p fgmres_solver with a workspace for \p N unknowns
+         *  and restart length \p restart
+         */
+        fgmres_solver(size_t N, size_t restart);
+
+        /*! resize the workspace for \p N unknowns and restart length \p restart
+         */
+        void resize(size_t N, size_t restart);
+
+        /*! solve A x = b using the default convergence criteria
+         */
+        template <class LinearOperator, class Vector>
+        void solve(LinearOperator& A, Vector& x, Vector& b);
+
+        /*! solve A x = b without preconditioning
+         */
+        template <class LinearOperator, class Vector, class Monitor>
+        void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor);
+
+        /*! solve A x = b with the variable preconditioner \p M.  \p b is
+         *  only read and may be of another vector type than \p x.
+         */
+        template <class LinearOperator, class Vector1, class Vector2, class Monitor, class Preconditioner>
+        void solve(LinearOperator& A, Vector1& x, const Vector2& b, Monitor& monitor, Preconditioner& M);
+      };
+      /*! \}
+      */
+
+   } // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/fgmres.inl>
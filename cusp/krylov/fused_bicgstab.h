@@ -0,0 +1,107 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file fused_bicgstab.h
+ *  \brief Biconjugate Gradient Stabilized method without per-iteration synchronization
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p fused_bicgstab : Biconjugate Gradient Stabilized method with fused kernels
+ *
+ * Solves the linear system A x = b using the default convergence criteria.
+ */
+template <class LinearOperator,
+          class Vector>
+void fused_bicgstab(LinearOperator& A,
+                    Vector& x,
+                    Vector& b);
+
+/*! \p fused_bicgstab : Biconjugate Gradient Stabilized method with fused kernels
+ *
+ * Solves the linear system A x = b without preconditioning.
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor>
+void fused_bicgstab(LinearOperator& A,
+                    Vector& x,
+                    Vector& b,
+                    Monitor& monitor);
+
+/*! \p fused_bicgstab : Biconjugate Gradient Stabilized method with fused kernels
+ *
+ * Solves the linear system A x = b with preconditioner \p M.
+ *
+ * Computes the iterates of \p bicgstab, but in device memory the scalars
+ * of the iteration are kept on the device, the inner products are fused
+ * with the vector updates and <tt>(t,s)</tt> and <tt>(t,t)</tt> share
+ * one pass, such that no iteration synchronizes with the host.  Besides
+ * the two products with \p A and \p M, an iteration reads and writes
+ * the vectors in five passes.  The residual is passed to \p monitor
+ * only every \p check_interval iterations, so up to
+ * <tt>check_interval - 1</tt> iterations may be performed after
+ * convergence, and the early exit of \p bicgstab on a converged
+ * intermediate residual is omitted.  The iteration limit of the monitor
+ * is never exceeded.  In host memory \p fused_bicgstab is equivalent to
+ * \p bicgstab.
+ *
+ * \param A matrix of the linear system
+ * \param x approximate solution of the linear system
+ * \param b right-hand side of the linear system
+ * \param monitor montiors iteration and determines stopping conditions
+ * \param M preconditioner for A
+ * \param check_interval number of iterations between convergence checks
+ *
+ * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam Vector vector
+ * \tparam Monitor is a monitor such as \p default_monitor or \p verbose_monitor
+ * \tparam Preconditioner is a matrix or subclass of \p linear_operator
+ *
+ *  \see \p bicgstab
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void fused_bicgstab(LinearOperator& A,
+                    Vector& x,
+                    Vector& b,
+                    Monitor& monitor,
+                    Preconditioner& M,
+                    size_t check_interval = 8);
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/fused_bicgstab.inl>
@@ -0,0 +1,116 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file fused_cg.h
+ *  \brief Conjugate Gradient method without per-iteration synchronization
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p fused_cg : Conjugate Gradient method with fused kernels
+ *
+ * Solves the symmetric, positive-definite linear system A x = b
+ * using the default convergence criteria.
+ */
+template <class LinearOperator,
+          class Vector>
+void fused_cg(LinearOperator& A,
+              Vector& x,
+              Vector& b);
+
+/*! \p fused_cg : Conjugate Gradient method with fused kernels
+ *
+ * Solves the symmetric, positive-definite linear system A x = b without preconditioning.
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor>
+void fused_cg(LinearOperator& A,
+              Vector& x,
+              Vector& b,
+              Monitor& monitor);
+
+/*! \p fused_cg : Conjugate Gradient method with fused kernels
+ *
+ * Solves the symmetric, positive-definite linear system A x = b
+ * with preconditioner \p M.
+ *
+ * Computes the same iterates as \p cg, but in device memory the scalars
+ * of the iteration are kept on the device and the vector updates are
+ * fused with the inner products, such that no iteration synchronizes
+ * with the host.  The residual is passed to \p monitor only every
+ * \p check_interval iterations, so up to <tt>check_interval - 1</tt>
+ * iterations may be performed after convergence.  The iteration limit of
+ * the monitor is never exceeded.  In host memory \p fused_cg is
+ * equivalent to \p cg.
+ *
+ * When \p capture_iterations is \c true the device work of a block of
+ * \p check_interval iterations is captured into a CUDA graph once and
+ * replayed for the later blocks, which replaces the launches of a block
+ * by a single one.  The first block runs directly, as do blocks that
+ * would exceed the iteration limit.  This requires \p A and \p M to be
+ * applied without synchronizing with the host, e.g. a
+ * \p smoothed_aggregation preconditioner with the V-cycle and stored
+ * restriction; otherwise the capture fails and all blocks run directly.
+ *
+ * \param A matrix of the linear system
+ * \param x approximate solution of the linear system
+ * \param b right-hand side of the linear system
+ * \param monitor montiors iteration and determines stopping conditions
+ * \param M preconditioner for A
+ * \param check_interval number of iterations between convergence checks
+ * \param capture_iterations replay blocks of iterations as a CUDA graph
+ *
+ * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam Vector vector
+ * \tparam Monitor is a monitor such as \p default_monitor or \p verbose_monitor
+ * \tparam Preconditioner is a matrix or subclass of \p linear_operator
+ *
+ *  \see \p cg
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void fused_cg(LinearOperator& A,
+              Vector& x,
+              Vector& b,
+              Monitor& monitor,
+              Preconditioner& M,
+              size_t check_interval = 8,
+              bool capture_iterations = false);
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/fused_cg.inl>
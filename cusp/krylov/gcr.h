@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file gcr.h
+ *  \brief Generalized Conjugate Residual (GCR) method
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+   namespace krylov
+   {
+
+      /*! \addtogroup iterative_solvers Iterative Solvers
+       *  \addtogroup krylov_methods Krylov Methods
+       *  \ingroup iterative_solvers
+       *  \{
+       */
+
+      /*! \p gcr : GCR method
+       *
+       * Solves the nonsymmetric, linear system A x = b
+       * using the default convergence criteria.
+       */
+     template <class LinearOperator, class Vector>
+       void gcr(LinearOperator& A,
+		Vector& x,
+		Vector& b,
+		const size_t restart);
+
+      /*! \p gcr : GCR method
+       *
+       * Solves the nonsymmetric, linear system A x = b without preconditioning.
+       */
+      template <class LinearOperator,
+	        class Vector,
+                class Monitor>
+	void gcr(LinearOperator& A,
+		 Vector& x,
+		 Vector& b,
+		 const size_t restart,
+		 Monitor& monitor);
+
+      /*! \p gcr : GCR method
+       *
+       * Solves the nonsymmetric, linear system A x = b
+       * with a right preconditioner \p M that may change from one
+       * application to the next.
+       *
+       * Each step preconditions the current residual, z = M r, and
+       * makes q = A z orthonormal to the previous products A p with two
+       * passes of block Gram-Schmidt, applying the same combination to
+       * z.  The search directions p and their products A p are kept as
+       * the columns of two contiguous column-major \p array2d.  Since
+       * the residual is updated in every step, the monitor sees the
+       * true residual norm without a least squares solve, and x is
+       * available at any iteration.  After \p restart directions the
+       * residual is recomputed and the directions are discarded.
+       *
+       * \param A matrix of the linear system
+       * \param x approximate solution of the linear system
+       * \param b right-hand side of the linear system
+       * \param restart the method after restart directions
+       * \param monitor montiors iteration and determines stopping conditions
+       * \param M preconditioner for A
+       *
+       * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+       * \tparam Vector vector
+       * \tparam Monitor is a monitor such as \p default_monitor or \p verbose_monitor
+       * \tparam Preconditioner is a matrix or subclass of \p linear_operator
+       *
+       * \note The workspace holds 2 * restart + 3 vectors.
+       *
+       *  \see \p fgmres
+       */
+      template <class LinearOperator,
+               class Vector,
+               class Monitor,
+               class Preconditioner>
+                  void gcr(LinearOperator& A,
+                        Vector& x,
+                        Vector& b,
+                        const size_t restart,
+                        Monitor& monitor,
+                        Preconditioner& M);
+      /*! \}
+      */
+
+   } // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/gcr.inl>
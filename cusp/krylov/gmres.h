@@ -22,6 +22,10 @@
 
 #include <cusp/detail/config.h>
 
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/stream.h>
+
 namespace cusp
 {
    namespace krylov
@@ -125,6 +129,87 @@ namespace cusp
                         const size_t restart,
                         Monitor& monitor,
                         Preconditioner& M);
+
+      /*! \p gmres : issue all device work of the solve on a given CUDA stream
+       *
+       *  Equivalent to calling \p gmres(A,x,b,restart,monitor,M) within a
+       *  \p scoped_stream.
+       *
+       *  \see \p scoped_stream
+       */
+      template <class LinearOperator,
+               class Vector,
+               class Monitor,
+               class Preconditioner>
+                  void gmres(LinearOperator& A,
+                        Vector& x,
+                        Vector& b,
+                        const size_t restart,
+                        Monitor& monitor,
+                        Preconditioner& M,
+                        cudaStream_t stream);
+
+      /*! \p gmres_solver : GMRES method with a persistent workspace
+       *
+       *  The Arnoldi basis and the remaining work arrays are allocated
+       *  once and reused for every subsequent solve of the same (or a
+       *  smaller) size and restart length.
+       *
+       *  \tparam ValueType scalar type of the linear systems
+       *  \tparam MemorySpace memory space of the linear systems
+       *
+       *  \see \p gmres
+       *  \see \p cg_solver
+       */
+      template <typename ValueType, typename MemorySpace>
+      class gmres_solver
+      {
+        typedef typename norm_type<ValueType>::type NormType;
+
+        size_t restart;
+
+        cusp::array1d<ValueType,MemorySpace> V0;
+        cusp::array2d<ValueType,MemorySpace,cusp::column_major> V;
+        cusp::array1d<ValueType,MemorySpace> sDev;
+        cusp::array1d<ValueType,MemorySpace> h;
+        cusp::array1d<ValueType,cusp::host_memory> hHost;
+        cusp::array2d<ValueType,cusp::host_memory,cusp::column_major> H;
+        cusp::array1d<ValueType,cusp::host_memory> s;
+        cusp::array1d<ValueType,cusp::host_memory> cs;
+        cusp::array1d<ValueType,cusp::host_memory> sn;
+        cusp::array1d<NormType,cusp::host_memory> resid;
+
+        public:
+
+        /*! construct a \p gmres_solver with an empty workspace and
+         *  restart length 30
+         */
+        gmres_solver(void) : restart(30) {}
+
+        /*! construct a \p gmres_solver with a workspace for \p N unknowns
+         *  and restart length \p restart
+         */
+        gmres_solver(size_t N, size_t restart);
+
+        /*! resize the workspace for \p N unknowns and restart length \p restart
+         */
+        void resize(size_t N, size_t restart);
+
+        /*! solve A x = b using the default convergence criteria
+         */
+        template <class LinearOperator, class Vector>
+        void solve(LinearOperator& A, Vector& x, Vector& b);
+
+        /*! solve A x = b without preconditioning
+         */
+        template <class LinearOperator, class Vector, class Monitor>
+        void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor);
+
+        /*! solve A x = b with preconditioner \p M
+         */
+        template <class LinearOperator, class Vector, class Monitor, class Preconditioner>
+        void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor, Preconditioner& M);
+      };
       /*! \}
       */
 
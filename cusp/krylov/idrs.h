@@ -0,0 +1,171 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file idrs.h
+ *  \brief Induced Dimension Reduction (IDR(s)) method
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p idrs : IDR(s) method
+ *
+ * Solves the linear system A x = b using the default convergence criteria.
+ */
+template <class LinearOperator,
+          class Vector>
+void idrs(LinearOperator& A,
+          Vector& x,
+          Vector& b,
+          const size_t s);
+
+/*! \p idrs : IDR(s) method
+ *
+ * Solves the linear system A x = b without preconditioning.
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor>
+void idrs(LinearOperator& A,
+          Vector& x,
+          Vector& b,
+          const size_t s,
+          Monitor& monitor);
+
+/*! \p idrs : IDR(s) method
+ *
+ * Solves the linear system A x = b with right preconditioner \p M.
+ *
+ * The variant with biorthogonalization of van Gijzen and Sonneveld.
+ * The residuals are forced into nested subspaces of shrinking
+ * dimension, each orthogonal to the s columns of a random shadow
+ * space P.  A cycle costs s + 1 products with A and M, each of which
+ * counts as one iteration, and needs at most N + N / s products in
+ * exact arithmetic.  The shadow space, the search directions U and
+ * their products G = A U are the columns of contiguous column-major
+ * \p array2d, so the inner products with P of a step are one batched
+ * reduction and a vector is updated against several columns in a
+ * single pass.  s = 1 is mathematically equivalent to \p bicgstab,
+ * while s = 4 is a common choice.
+ *
+ * \param A matrix of the linear system
+ * \param x approximate solution of the linear system
+ * \param b right-hand side of the linear system
+ * \param s dimension of the shadow space
+ * \param monitor montiors iteration and determines stopping conditions
+ * \param M preconditioner for A
+ *
+ * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam Vector vector
+ * \tparam Monitor is a monitor such as \p default_monitor or \p verbose_monitor
+ * \tparam Preconditioner is a matrix or subclass of \p linear_operator
+ *
+ * \note The workspace holds 3 s + 3 vectors.  The small dense algebra is
+ * real-valued, so the value type is \c float or \c double.
+ *
+ *  \see \p bicgstab
+ *  \see \p bicgstabl
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void idrs(LinearOperator& A,
+          Vector& x,
+          Vector& b,
+          const size_t s,
+          Monitor& monitor,
+          Preconditioner& M);
+
+/*! \p idrs_solver : IDR(s) method with a persistent workspace
+ *
+ *  The work vectors and the shadow space are allocated once and reused
+ *  for every subsequent solve of the same (or a smaller) size and
+ *  shadow space dimension.
+ *
+ *  \tparam ValueType scalar type of the linear systems
+ *  \tparam MemorySpace memory space of the linear systems
+ *
+ *  \see \p idrs
+ *  \see \p bicgstab_solver
+ */
+template <typename ValueType, typename MemorySpace>
+class idrs_solver
+{
+    size_t s;
+
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> P;  // shadow space
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> U;  // search directions
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> G;  // A U
+    cusp::array1d<ValueType,MemorySpace> r;
+    cusp::array1d<ValueType,MemorySpace> v;
+    cusp::array1d<ValueType,MemorySpace> t;
+    cusp::array1d<ValueType,MemorySpace> h;
+    cusp::array1d<ValueType,cusp::host_memory> hHost;
+
+    public:
+
+    /*! construct a \p idrs_solver with an empty workspace
+     */
+    idrs_solver(void) : s(0) {}
+
+    /*! construct a \p idrs_solver with a workspace for \p N unknowns
+     *  and shadow space dimension \p s
+     */
+    idrs_solver(size_t N, size_t s);
+
+    /*! resize the workspace for \p N unknowns and shadow space dimension \p s
+     */
+    void resize(size_t N, size_t s);
+
+    /*! solve A x = b using the default convergence criteria
+     */
+    template <class LinearOperator, class Vector>
+    void solve(LinearOperator& A, Vector& x, Vector& b);
+
+    /*! solve A x = b without preconditioning
+     */
+    template <class LinearOperator, class Vector, class Monitor>
+    void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor);
+
+    /*! solve A x = b with preconditioner \p M
+     */
+    template <class LinearOperator, class Vector, class Monitor, class Preconditioner>
+    void solve(LinearOperator& A, Vector& x, Vector& b, Monitor& monitor, Preconditioner& M);
+};
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/idrs.inl>
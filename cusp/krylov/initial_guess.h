@@ -0,0 +1,123 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file initial_guess.h
+ *  \brief Initial guesses from the solutions of previous linear systems
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array2d.h>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p initial_guess_projector : initial guesses for a sequence of linear
+ *  systems from the solutions of the previous systems
+ *
+ *  Keeps the solutions x_i and right-hand sides b_i of the last
+ *  \p num_vectors systems and computes the initial guess of the next
+ *  system from them (Fischer's projection method).  The pairs are kept
+ *  with orthonormal right-hand sides B, and the solutions X transformed
+ *  alike, so that for A X = B the initial guess
+ *
+ *      x_0 = X B^H b
+ *
+ *  minimizes || b - A x_0 || over the span of the previous solutions.
+ *  Computing it takes a single batched reduction of B^H b and a single
+ *  pass over X.  When the systems share the matrix A this is exact, and
+ *  when A changes slowly between the systems x_0 is still a good
+ *  starting point for \p cg, \p gmres and the other Krylov methods.
+ *
+ *  \tparam ValueType scalar type of the linear systems
+ *  \tparam MemorySpace memory space of the linear systems
+ *
+ *  \code
+ *  cusp::krylov::initial_guess_projector<float, cusp::device_memory> projector(8);
+ *
+ *  for (int step = 0; step < num_steps; step++)
+ *  {
+ *      // update b
+ *      projector.guess(b, x);
+ *
+ *      cusp::default_monitor<float> monitor(b, 100, 1e-6);
+ *      cusp::krylov::cg(A, x, b, monitor);
+ *
+ *      projector.add(x, b);
+ *  }
+ *  \endcode
+ *
+ *  \note Once \p num_vectors pairs are kept, adding a pair discards the
+ *  oldest one.  Pairs whose right-hand side is (numerically) in the span
+ *  of the kept ones are not added.
+ *
+ *  \see \p deflated_cg_solver
+ */
+template <typename ValueType, typename MemorySpace>
+class initial_guess_projector
+{
+    typedef cusp::array2d<ValueType,MemorySpace,cusp::column_major> Array2d;
+
+    size_t max_vectors;
+    size_t num_vectors;
+
+    Array2d X;
+    Array2d B;
+
+    public:
+
+    /*! construct an \p initial_guess_projector without previous solutions
+     *
+     *  \param num_vectors maximum number of solutions that are kept
+     */
+    initial_guess_projector(size_t num_vectors = 8);
+
+    /*! number of solutions that are kept
+     */
+    size_t size(void) const { return num_vectors; }
+
+    /*! discard all solutions, e.g. when the matrices change abruptly
+     */
+    void clear(void) { num_vectors = 0; }
+
+    /*! keep the solution \p x of the system A x = \p b
+     */
+    template <class Vector1, class Vector2>
+    void add(const Vector1& x, const Vector2& b);
+
+    /*! initial guess \p x for the system A x = \p b.  \p x is left
+     *  unchanged when no solutions are kept.
+     */
+    template <class Vector1, class Vector2>
+    void guess(const Vector1& b, Vector2& x) const;
+};
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/initial_guess.inl>
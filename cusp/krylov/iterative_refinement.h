@@ -0,0 +1,230 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file iterative_refinement.h
+ *  \brief Mixed-precision iterative refinement
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p refinement_cg : inner solve of \p iterative_refinement with the
+ *  preconditioned CG method in the precision of the inner system.
+ *
+ *  Each call starts from a zero correction and stops after reducing the
+ *  residual of the inner system by \p tolerance or after
+ *  \p iteration_limit iterations.
+ *
+ *  \tparam Preconditioner is a matrix or subclass of \p linear_operator
+ *  for vectors of the inner precision
+ */
+template <typename Preconditioner>
+struct refinement_cg
+{
+    Preconditioner& M;
+    double tolerance;
+    size_t iteration_limit;
+
+    refinement_cg(Preconditioner& M, double tolerance = 1e-4, size_t iteration_limit = 100)
+        : M(M), tolerance(tolerance), iteration_limit(iteration_limit) {}
+
+    /*! d <- approximate solution of A d = r
+     */
+    template <typename MatrixType, typename Vector>
+    void operator()(MatrixType& A, Vector& r, Vector& d);
+};
+
+/*! \p refinement_gmres : inner solve of \p iterative_refinement with the
+ *  preconditioned GMRES method in the precision of the inner system.
+ *
+ *  \see \p refinement_cg
+ */
+template <typename Preconditioner>
+struct refinement_gmres
+{
+    Preconditioner& M;
+    size_t restart;
+    double tolerance;
+    size_t iteration_limit;
+
+    refinement_gmres(Preconditioner& M, size_t restart = 30, double tolerance = 1e-4, size_t iteration_limit = 100)
+        : M(M), restart(restart), tolerance(tolerance), iteration_limit(iteration_limit) {}
+
+    /*! d <- approximate solution of A d = r
+     */
+    template <typename MatrixType, typename Vector>
+    void operator()(MatrixType& A, Vector& r, Vector& d);
+};
+
+/*! \p refinement_preconditioner : inner solve of \p iterative_refinement
+ *  with a single application d = M r, such as one cycle of a
+ *  \p smoothed_aggregation hierarchy built on the inner matrix.
+ */
+template <typename Preconditioner>
+struct refinement_preconditioner
+{
+    Preconditioner& M;
+
+    refinement_preconditioner(Preconditioner& M) : M(M) {}
+
+    /*! d <- M r
+     */
+    template <typename MatrixType, typename Vector>
+    void operator()(MatrixType& A, Vector& r, Vector& d);
+};
+
+/*! \p iterative_refinement_solver : mixed-precision iterative refinement
+ *
+ *  Solves A x = b, where A, x and b hold values of a high precision such
+ *  as \c double, by corrections computed in the lower precision of
+ *  \p LowMatrixType, such as \c float.  A refinement step
+ *
+ *    - computes the residual r = b - A x in high precision with the fused
+ *      residual product,
+ *    - rounds r / ||r|| to the low precision,
+ *    - solves A d = r / ||r|| approximately with the low precision copy
+ *      of A,
+ *    - and updates x <- x + ||r|| d in high precision.
+ *
+ *  The inner solve thus runs at the bandwidth of the low precision
+ *  matrix, while the refined solution reaches the accuracy of the high
+ *  precision residual, as long as the inner solve reduces the residual
+ *  by a fixed factor (i.e. the condition number of A times the unit
+ *  roundoff of the low precision is well below one).  Each step counts
+ *  as one iteration of the monitor.
+ *
+ *  The low precision copy of A is converted once, when the solver is
+ *  constructed or \p setup is called, and reused for every solve.
+ *
+ *  \tparam LowMatrixType matrix type of the inner system, e.g.
+ *  \p csr_matrix<int,float,cusp::device_memory>
+ *
+ *  \code
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/monitor.h>
+ *  #include <cusp/krylov/iterative_refinement.h>
+ *  #include <cusp/gallery/poisson.h>
+ *
+ *  int main(void)
+ *  {
+ *      cusp::csr_matrix<int, double, cusp::device_memory> A;
+ *      cusp::gallery::poisson5pt(A, 100, 100);
+ *
+ *      cusp::array1d<double, cusp::device_memory> x(A.num_rows, 0);
+ *      cusp::array1d<double, cusp::device_memory> b(A.num_rows, 1);
+ *
+ *      // float copy of A, converted once
+ *      cusp::krylov::iterative_refinement_solver< cusp::csr_matrix<int, float, cusp::device_memory> > solver(A);
+ *
+ *      // inner CG in float, each solve reduces its residual by 1e-4
+ *      cusp::identity_operator<float, cusp::device_memory> M(A.num_rows, A.num_rows);
+ *      cusp::krylov::refinement_cg< cusp::identity_operator<float, cusp::device_memory> > inner(M, 1e-4, 1000);
+ *
+ *      // refine to a relative residual of 1e-12
+ *      cusp::default_monitor<double> monitor(b, 20, 1e-12);
+ *      solver.solve(A, x, b, monitor, inner);
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ *
+ *  \see \p refinement_cg
+ *  \see \p refinement_gmres
+ *  \see \p refinement_preconditioner
+ */
+template <typename LowMatrixType>
+class iterative_refinement_solver
+{
+    typedef typename LowMatrixType::value_type   LowValueType;
+    typedef typename LowMatrixType::memory_space MemorySpace;
+
+    LowMatrixType A_low;
+    cusp::array1d<LowValueType,MemorySpace> r_low;
+    cusp::array1d<LowValueType,MemorySpace> d_low;
+
+    public:
+
+    /*! construct an \p iterative_refinement_solver without a matrix
+     */
+    iterative_refinement_solver(void) {}
+
+    /*! construct an \p iterative_refinement_solver for the matrix \p A
+     */
+    template <typename MatrixType>
+    iterative_refinement_solver(const MatrixType& A);
+
+    /*! convert \p A to the low precision, e.g. after its values changed
+     */
+    template <typename MatrixType>
+    void setup(const MatrixType& A);
+
+    /*! low precision copy of the matrix, for instance to build a
+     *  preconditioner of the inner solve
+     */
+    LowMatrixType& low_precision_matrix(void) { return A_low; }
+
+    /*! solve A x = b with the CG method as inner solve
+     */
+    template <class MatrixType, class Vector, class Monitor>
+    void solve(MatrixType& A, Vector& x, Vector& b, Monitor& monitor);
+
+    /*! solve A x = b with the inner solve \p inner, which is called as
+     *  inner(A_low, r, d) for low precision vectors r and d
+     */
+    template <class MatrixType, class Vector, class Monitor, class InnerSolver>
+    void solve(MatrixType& A, Vector& x, Vector& b, Monitor& monitor, InnerSolver& inner);
+};
+
+/*! \p iterative_refinement : solves A x = b with corrections from the CG
+ *  method in single precision
+ *
+ *  Converts \p A to a \c float \p csr_matrix and calls
+ *  \p iterative_refinement_solver::solve.  Use the solver class to
+ *  reuse the conversion across solves.
+ */
+template <class MatrixType, class Vector, class Monitor>
+void iterative_refinement(MatrixType& A, Vector& x, Vector& b, Monitor& monitor);
+
+/*! \p iterative_refinement : solves A x = b with corrections from the
+ *  inner solve \p inner in single precision
+ */
+template <class MatrixType, class Vector, class Monitor, class InnerSolver>
+void iterative_refinement(MatrixType& A, Vector& x, Vector& b, Monitor& monitor, InnerSolver& inner);
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/iterative_refinement.inl>
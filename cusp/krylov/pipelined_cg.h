@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file pipelined_cg.h
+ *  \brief Pipelined Conjugate Gradient method
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+namespace cusp
+{
+namespace krylov
+{
+
+/*! \addtogroup iterative_solvers Iterative Solvers
+ *  \addtogroup krylov_methods Krylov Methods
+ *  \ingroup iterative_solvers
+ *  \{
+ */
+
+/*! \p pipelined_cg : Pipelined Conjugate Gradient method
+ *
+ * Solves the symmetric, positive-definite linear system A x = b
+ * using the default convergence criteria.
+ */
+template <class LinearOperator,
+          class Vector>
+void pipelined_cg(LinearOperator& A,
+                  Vector& x,
+                  Vector& b);
+
+/*! \p pipelined_cg : Pipelined Conjugate Gradient method
+ *
+ * Solves the symmetric, positive-definite linear system A x = b without preconditioning.
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor>
+void pipelined_cg(LinearOperator& A,
+                  Vector& x,
+                  Vector& b,
+                  Monitor& monitor);
+
+/*! \p pipelined_cg : Pipelined Conjugate Gradient method
+ *
+ * Solves the symmetric, positive-definite linear system A x = b
+ * with preconditioner \p M.
+ *
+ * \p pipelined_cg is a rearrangement of preconditioned CG due to Ghysels
+ * and Vanroose in which both inner products of an iteration are computed
+ * in a single reduction.  The reduction does not depend on the
+ * preconditioner application and matrix-vector product of the same
+ * iteration, which may therefore proceed while the reduction is in
+ * flight.  The price is three additional vectors and a somewhat larger
+ * rounding error in the recurrence for the residual.
+ *
+ * \param A matrix of the linear system 
+ * \param x approximate solution of the linear system
+ * \param b right-hand side of the linear system
+ * \param monitor montiors iteration and determines stopping conditions
+ * \param M preconditioner for A
+ *
+ * \tparam LinearOperator is a matrix or subclass of \p linear_operator
+ * \tparam Vector vector
+ * \tparam Monitor is a monitor such as \p default_monitor or \p verbose_monitor
+ * \tparam Preconditioner is a matrix or subclass of \p linear_operator
+ *
+ * \note \p A and \p M must be symmetric and positive-definite.
+ *
+ * \see P. Ghysels and W. Vanroose, "Hiding global synchronization latency
+ * in the preconditioned Conjugate Gradient algorithm", Parallel Computing
+ * 40 (2014).
+ *
+ *  \see \p cg
+ */
+template <class LinearOperator,
+          class Vector,
+          class Monitor,
+          class Preconditioner>
+void pipelined_cg(LinearOperator& A,
+                  Vector& x,
+                  Vector& b,
+                  Monitor& monitor,
+                  Preconditioner& M);
+/*! \}
+ */
+
+} // end namespace krylov
+} // end namespace cusp
+
+#include <cusp/krylov/detail/pipelined_cg.inl>
@@ -48,7 +48,7 @@ class linear_operator : public cusp::detail::matrix_base<IndexType,ValueType,Mem
 template <typename ValueType, typename MemorySpace, typename IndexType=int>
 class identity_operator : public linear_operator<ValueType,MemorySpace,IndexType>
 {       
-    typedef linear_operator<ValueType,MemorySpace> Parent;
+    typedef linear_operator<ValueType,MemorySpace,IndexType> Parent;
     public:
 
     identity_operator() 
@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file managed_allocator.h
+ *  \brief Device allocator of unified (managed) memory
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <thrust/device_malloc_allocator.h>
+#include <thrust/device_ptr.h>
+
+#include <cuda_runtime_api.h>
+
+#include <cstddef>
+#include <new>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p managed_allocator : a device allocator that obtains unified memory
+ *  with \p cudaMallocManaged.
+ *
+ *  Arrays in managed memory are device arrays that may be larger than
+ *  the memory of the device: their pages migrate on demand between the
+ *  host and the device, and pages that have not been used recently are
+ *  evicted to the host when the device runs out of memory.  On entry,
+ *  \p cusp::multiply and the Krylov solvers prefetch managed operands to
+ *  the current device (see \p cusp::prefetch), and a CSR matrix that does
+ *  not fit into the memory of the device is multiplied in blocks of rows
+ *  whose transfer overlaps with the product of the previous block.
+ *
+ *  The allocator is selected by passing \p cusp::managed_memory in place
+ *  of the memory space.
+ *
+ *  \code
+ *  cusp::csr_matrix<int, float, cusp::managed_memory> A;
+ *  cusp::io::read_matrix_market_file(A, "huge.mtx");
+ *
+ *  cusp::array1d<float, cusp::managed_memory> x(A.num_cols, 1);
+ *  cusp::array1d<float, cusp::managed_memory> y(A.num_rows);
+ *
+ *  cusp::multiply(A, x, y);
+ *  \endcode
+ *
+ *  \throws std::bad_alloc if the memory cannot be allocated
+ */
+template <typename T>
+class managed_allocator : public thrust::device_malloc_allocator<T>
+{
+    typedef thrust::device_malloc_allocator<T> super_t;
+
+    public:
+
+    typedef typename super_t::pointer   pointer;
+    typedef typename super_t::size_type size_type;
+
+    template <typename U>
+    struct rebind { typedef managed_allocator<U> other; };
+
+    managed_allocator(void) {}
+
+    managed_allocator(const managed_allocator&) : super_t() {}
+
+    template <typename U>
+    managed_allocator(const managed_allocator<U>&) {}
+
+    pointer allocate(size_type n)
+    {
+        void * ptr = 0;
+
+        if (n == 0)
+            return pointer(static_cast<T*>(0));
+
+        if (cudaMallocManaged(&ptr, n * sizeof(T), cudaMemAttachGlobal) != cudaSuccess)
+        {
+            cudaGetLastError(); // clear the error
+            throw std::bad_alloc();
+        }
+
+        return pointer(static_cast<T*>(ptr));
+    }
+
+    void deallocate(pointer p, size_type)
+    {
+        if (p.get() != 0)
+            cudaFree(p.get());
+    }
+};
+
+template <typename T1, typename T2>
+bool operator==(const managed_allocator<T1>&, const managed_allocator<T2>&) { return true; }
+
+template <typename T1, typename T2>
+bool operator!=(const managed_allocator<T1>&, const managed_allocator<T2>&) { return false; }
+
+/*! \}
+ */
+
+} // end namespace cusp
@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file masked_multiply.h
+ *  \brief Matrix multiplication restricted to a mask
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+namespace cusp
+{
+
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p masked_multiply : Computes the entries of a product that lie in
+ *  a mask.
+ *
+ *  When \p B is a vector, \p mask selects the rows of y = A x that are
+ *  computed, either as a \c bool array of size \p A.num_rows or as an
+ *  array of distinct row indices.  The other entries of \p y are not
+ *  written, so an iteration that retires rows (the converged shifts of
+ *  \p cg_m, the decided vertices of a maximal independent set) only
+ *  pays for the active ones.  \p y must have \p A.num_rows entries.
+ *
+ *  When \p B is a sparse matrix, \p mask is a sparse matrix \p M and
+ *  C = M .* (A B): only the entries in the pattern of \p M are computed,
+ *  each as the dot product of a row of \p A with a column of \p B, and
+ *  the values of \p M are ignored.  \p C stores the entries of the
+ *  pattern that meet some product A(i,k) B(k,j), even if their sum
+ *  vanishes.  This serves triangle counting (C = L .* (L L^T)) and the
+ *  symbolic steps of ILU(k) without forming A B.  The column indices of
+ *  each row of \p A must be sorted.
+ *
+ *  Formats other than CSR are converted to CSR.
+ *
+ * \param A input matrix
+ * \param B input vector or sparse matrix
+ * \param C output vector or sparse matrix
+ * \param mask rows (vector product) or pattern (matrix product) to compute
+ *
+ *  \code
+ *  // y[i] <- (A x)[i] for the rows i with active[i] == true
+ *  cusp::masked_multiply(A, x, y, active);
+ *
+ *  // number of triangles of a graph with lower triangle L
+ *  cusp::coo_matrix<int,float,cusp::device_memory> C;
+ *  cusp::masked_multiply(L, Lt, C, L);
+ *  float triangles = thrust::reduce(C.values.begin(), C.values.end());
+ *  \endcode
+ *
+ *  \throws cusp::invalid_input_exception if the dimensions are incompatible
+ */
+template <typename Matrix,
+          typename MatrixOrVector1,
+          typename MatrixOrVector2,
+          typename Mask>
+void masked_multiply(const Matrix&          A,
+                     const MatrixOrVector1& B,
+                           MatrixOrVector2& C,
+                     const Mask&            mask);
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/masked_multiply.inl>
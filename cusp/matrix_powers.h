@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file matrix_powers.h
+ *  \brief Powers x, A x, ..., A^s x of a matrix applied to a vector
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array2d.h>
+
+namespace cusp
+{
+
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p matrix_powers : Computes the vectors x, A x, A^2 x, ..., A^s x.
+ *
+ *  Column k of \p V is set to A^k x, and \p V is resized to
+ *  \p A.num_rows by s + 1.  This is the monomial basis of s-step
+ *  Krylov methods and the basis from which polynomial smoothers form
+ *  p(A) x.
+ *
+ *  When the entries of a CSR or DIA matrix lie in a band |i - j| <= w,
+ *  the rows are split into tiles and each tile computes all s products
+ *  in a single pass: the entries of x within s w rows of the tile (its
+ *  ghost zone) are gathered into fast memory, and step k evaluates the
+ *  rows within (s - k) w of the tile, on which the later steps depend.
+ *  The rows of a tile and of its ghost zone are read s times while they
+ *  are in the cache instead of streaming the matrix from memory s times,
+ *  at the cost of evaluating the ghost rows in the neighbouring tiles
+ *  as well.  Other formats, and bands too wide for a tile, apply
+ *  \p cusp::multiply s times.
+ *
+ * \param A square matrix
+ * \param x input vector with \p A.num_cols entries
+ * \param s number of products
+ * \param V output array with column-major orientation
+ *
+ *  \code
+ *  // basis of the Krylov space of dimension 5
+ *  cusp::array2d<float,cusp::device_memory,cusp::column_major> V;
+ *  cusp::matrix_powers(A, x, 4, V);
+ *  \endcode
+ *
+ *  \throws cusp::invalid_input_exception if \p A is not square or the
+ *  size of \p x does not match \p A
+ */
+template <typename Matrix,
+          typename Vector,
+          typename ValueType,
+          typename MemorySpace>
+void matrix_powers(const Matrix& A,
+                   const Vector& x,
+                   const size_t  s,
+                   cusp::array2d<ValueType,MemorySpace,cusp::column_major>& V);
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/matrix_powers.inl>
@@ -36,6 +36,30 @@ namespace cusp
   typedef thrust::detail::default_device_space_tag device_memory;
   typedef thrust::any_space_tag                    any_memory;
 #endif
+
+  // arrays whose elements are partitioned across several devices,
+  // see cusp::distributed_array1d
+  struct distributed_memory {};
+
+  template <typename T>
+  class pinned_allocator;
+
+  // page-locked host memory, see cusp::pinned_allocator
+  //
+  // Like any allocator passed in place of a memory space it is rebound to
+  // the value type, so that cusp::array1d<float, cusp::pinned_memory> is
+  // a host array in page-locked memory.
+  typedef pinned_allocator<char> pinned_memory;
+
+  template <typename T>
+  class managed_allocator;
+
+  // unified memory that migrates between the host and the device on
+  // demand, see cusp::managed_allocator and cusp::prefetch
+  //
+  // cusp::array1d<float, cusp::managed_memory> is a device array that
+  // may exceed the memory of the device.
+  typedef managed_allocator<char> managed_memory;
    
   template<typename T, typename MemorySpace>
   struct default_memory_allocator;
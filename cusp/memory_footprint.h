@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file memory_footprint.h
+ *  \brief Storage of containers and peak device memory usage
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p memory_footprint : bytes of storage allocated by an array or
+ * matrix.
+ *
+ * The footprint is the sum of the capacities of the arrays that hold
+ * the entries of \p A, e.g. the row offsets, column indices and values
+ * of a CSR matrix, in whichever memory space they reside.  A view
+ * reports the storage it refers to, and operators without storage of
+ * their own, such as a \p linear_operator, report zero.
+ *
+ * \code
+ * #include <cusp/csr_matrix.h>
+ * #include <cusp/memory_footprint.h>
+ * #include <cusp/gallery/poisson.h>
+ *
+ * cusp::csr_matrix<int, float, cusp::device_memory> A;
+ * cusp::gallery::poisson5pt(A, 100, 100);
+ *
+ * // 10001 row offsets, 49600 column indices and values
+ * size_t bytes = cusp::memory_footprint(A);
+ * \endcode
+ */
+template <typename MatrixOrVector>
+size_t memory_footprint(const MatrixOrVector& A);
+
+/*! \p device_memory_statistics : device memory held by the allocators
+ * of Cusp.
+ *
+ * Allocations of the default device allocator and of the
+ * \p caching_device_allocator are counted, the latter with the size
+ * class of each block.  Blocks retained by the cache after they are
+ * freed do not count as in use.
+ */
+struct device_memory_statistics
+{
+    /*! bytes currently allocated
+     */
+    size_t bytes_in_use;
+
+    /*! largest value of \p bytes_in_use since the program started or
+     *  \p reset_device_memory_peak was called
+     */
+    size_t peak_bytes_in_use;
+};
+
+/*! \p get_device_memory_statistics : current device memory usage and
+ * its high-water mark.
+ *
+ * The high-water mark of each \p CUSP_PROFILE_SCOPED scope is also
+ * reported by the profiler when \p CUSP_PROFILE_ENABLED is defined.
+ *
+ * \code
+ * cusp::reset_device_memory_peak();
+ *
+ * cusp::precond::aggregation::smoothed_aggregation<int, float, cusp::device_memory> M(A);
+ *
+ * size_t setup_peak = cusp::get_device_memory_statistics().peak_bytes_in_use;
+ * \endcode
+ */
+inline device_memory_statistics get_device_memory_statistics(void);
+
+/*! \p reset_device_memory_peak : restart the high-water mark from the
+ * bytes currently in use.
+ */
+inline void reset_device_memory_peak(void);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/memory_footprint.inl>
@@ -22,8 +22,13 @@
 
 #include <cusp/detail/config.h>
 
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
 #include <cusp/blas.h>
+#include <cusp/detail/wall_clock.h>
+#include <cusp/detail/device/async_norm.h>
 
+#include <algorithm>
 #include <limits>
 #include <iostream>
 #include <iomanip>
@@ -339,5 +344,518 @@ class convergence_monitor : public default_monitor<ValueType>
 /*! \}
  */
 
-} // end namespace cusp
+/*! \p async_monitor : Implements the convergence criteria of
+ * \p default_monitor without synchronizing with the device every
+ * iteration.
+ *
+ * \p default_monitor computes the residual norm of every iteration on the
+ * host, so each iteration waits for the device to finish.  Every
+ * \p check_interval iterations, \p async_monitor instead enqueues the norm
+ * of a device residual on the current stream, together with a copy to
+ * pinned host memory, and tests it once it has arrived, which is usually
+ * by one of the next iterations.  A norm that is still in flight when
+ * the next one is due is waited for.  The solver therefore stops at most
+ * 2 * check_interval - 1 iterations after the residual first satisfied
+ * the tolerance, and \p residual_norm() is the norm of the residual that
+ * was tested, not necessarily that of the last iteration.  When the
+ * iteration limit is reached the norm of the final residual is computed
+ * synchronously.  Residuals in host memory are tested every
+ * \p check_interval iterations on the host.
+ *
+ * \tparam ValueType scalar type used in the solver (e.g. \c float or \c cusp::complex<double>).
+ *
+ *  \code
+ *  // test the residual every 10 iterations, without blocking the host
+ *  cusp::async_monitor<float> monitor(b, 1000, 1e-6, 0, 10);
+ *
+ *  cusp::krylov::cg(A, x, b, monitor);
+ *  \endcode
+ *
+ *  \see \p default_monitor
+ */
+template <typename ValueType>
+class async_monitor : public default_monitor<ValueType>
+{
+    typedef cusp::default_monitor<ValueType> super;
+
+    public:
+    typedef typename norm_type<ValueType>::type Real;
+
+    /*! Construct an \p async_monitor for a given right-hand-side \p b
+     *
+     *  \param b right-hand-side of the linear system A x = b
+     *  \param iteration_limit maximum number of solver iterations to allow
+     *  \param relative_tolerance determines convergence criteria
+     *  \param absolute_tolerance determines convergence criteria
+     *  \param check_interval number of iterations between residual tests
+     *
+     *  \tparam VectorType vector
+     */
+    template <typename Vector>
+    async_monitor(const Vector& b, size_t iteration_limit = 500, Real relative_tolerance = 1e-5, Real absolute_tolerance = 0,
+                  size_t check_interval = 10)
+        : super(b, iteration_limit, relative_tolerance, absolute_tolerance),
+          check_interval_(check_interval > 0 ? check_interval : 1),
+          checked_iteration_(size_t(-1))
+    {}
+
+    /*! applies convergence criteria to determine whether iteration is finished
+     *
+     *  \param r residual vector of the linear system (r = b - A x)
+     *  \tparam Vector vector
+     */
+    template <typename Vector>
+    bool finished(const Vector& r)
+    {
+        return finished(r, typename Vector::memory_space());
+    }
+
+    /*! number of iterations between residual tests
+     */
+    size_t check_interval() const { return check_interval_; }
+
+    protected:
+
+    size_t check_interval_;
+    size_t checked_iteration_;
+    cusp::detail::device::async_norm<ValueType> norm;
+
+    // solvers that test several vectors per iteration test the first one
+    bool check_due()
+    {
+        if (super::iteration_count() % check_interval_ != 0 || super::iteration_count() == checked_iteration_)
+            return false;
+
+        checked_iteration_ = super::iteration_count();
+        return true;
+    }
+
+    template <typename Vector>
+    bool finished(const Vector& r, cusp::host_memory)
+    {
+        if (super::iteration_count() >= super::iteration_limit())
+            return super::finished(r);
+
+        return check_due() && super::finished(r);
+    }
+
+    template <typename Vector>
+    bool finished(const Vector& r, cusp::device_memory)
+    {
+        return test_async(r, (const ValueType *) 0);
+    }
+
+    // square is ||r||^2 when it was already enqueued in device memory
+    template <typename Vector>
+    bool test_async(const Vector& r, const ValueType * square)
+    {
+        // test a norm that arrived since the last iteration
+        if (norm.ready())
+        {
+            super::r_norm = norm.value();
+
+            if (super::converged())
+                return true;
+        }
+
+        if (super::iteration_count() >= super::iteration_limit())
+        {
+            norm.wait();
+            return super::finished(r);
+        }
+
+        if (!check_due())
+            return false;
+
+        // bound the delay of the test to one interval
+        if (norm.is_pending())
+        {
+            norm.wait();
+            super::r_norm = norm.value();
+
+            if (super::converged())
+                return true;
+        }
+
+        if (square)
+            norm.launch_copy(square);
+        else
+            norm.launch(r);
+
+        return false;
+    }
+};
+/*! \}
+ */
+
+/*! \p history_monitor : Records the residual norm and a timestamp of
+ * every iteration, for convergence histories of production-speed solves.
+ *
+ * The history is stored in buffers sized for \p iteration_limit + 1
+ * entries when the monitor is constructed, and nothing is printed while
+ * the solver runs: \p print() or the accessors report the history
+ * afterwards.  Residuals in host memory are tested every iteration, like
+ * \p default_monitor.  The norms of device residuals are reduced into a
+ * device buffer without synchronizing and, as with \p async_monitor, only
+ * tested every \p check_interval iterations; with the default interval of
+ * 1 the solver stops at most one iteration after \p default_monitor would.
+ *
+ * Timestamps are host wall-clock times in milliseconds since the monitor
+ * was constructed, taken when the solver tests the residual.  For device
+ * residuals this is when the iteration was issued, which may run ahead
+ * of the device by up to one \p check_interval.
+ *
+ * \tparam ValueType scalar type used in the solver (e.g. \c float or \c cusp::complex<double>).
+ *
+ *  \code
+ *  cusp::history_monitor<float> monitor(b, 1000, 1e-6, 0, 10);
+ *
+ *  cusp::krylov::cg(A, x, b, monitor);
+ *
+ *  cusp::array1d<float, cusp::host_memory> norms;
+ *  monitor.residual_history(norms);
+ *  monitor.print();
+ *  \endcode
+ *
+ *  \see \p async_monitor
+ *  \see \p convergence_monitor
+ */
+template <typename ValueType>
+class history_monitor : public async_monitor<ValueType>
+{
+    typedef cusp::default_monitor<ValueType> base;
+    typedef cusp::async_monitor<ValueType>   super;
+
+    public:
+    typedef typename norm_type<ValueType>::type Real;
+
+    /*! Construct a \p history_monitor for a given right-hand-side \p b
+     *
+     *  \param b right-hand-side of the linear system A x = b
+     *  \param iteration_limit maximum number of solver iterations to allow
+     *  \param relative_tolerance determines convergence criteria
+     *  \param absolute_tolerance determines convergence criteria
+     *  \param check_interval number of iterations between tests of device residuals
+     *
+     *  \tparam VectorType vector
+     */
+    template <typename Vector>
+    history_monitor(const Vector& b, size_t iteration_limit = 500, Real relative_tolerance = 1e-5, Real absolute_tolerance = 0,
+                    size_t check_interval = 1)
+        : super(b, iteration_limit, relative_tolerance, absolute_tolerance, check_interval),
+          iterations_(iteration_limit + 1),
+          norms_(iteration_limit + 1),
+          times_(iteration_limit + 1),
+          size_(0),
+          on_device_(false),
+          start_(cusp::detail::wall_clock_milliseconds())
+    {}
+
+    /*! applies convergence criteria to determine whether iteration is
+     *  finished, and records the residual of a new iteration
+     *
+     *  \param r residual vector of the linear system (r = b - A x)
+     *  \tparam Vector vector
+     */
+    template <typename Vector>
+    bool finished(const Vector& r)
+    {
+        return finished(r, typename Vector::memory_space());
+    }
+
+    /*! number of recorded iterations
+     */
+    size_t history_size() const { return size_; }
+
+    /*! iteration numbers of the recorded residuals
+     */
+    const cusp::array1d<size_t,cusp::host_memory>& iteration_history() const { return iterations_; }
+
+    /*! timestamps of the recorded residuals in milliseconds
+     */
+    const cusp::array1d<double,cusp::host_memory>& time_history() const { return times_; }
+
+    /*! copy the recorded residual norms to \p norms, which is resized to
+     *  \p history_size(); blocks until the norms of device residuals are
+     *  computed
+     */
+    template <typename Array>
+    void residual_history(Array& norms) const
+    {
+        cusp::array1d<Real,cusp::host_memory> host_norms(size_);
+
+        if (on_device_)
+        {
+            cusp::array1d<ValueType,cusp::host_memory> squares(squares_.begin(), squares_.begin() + size_);
+
+            using namespace std;
+            for (size_t i = 0; i < size_; i++)
+                host_norms[i] = sqrt(abs(squares[i]));
+        }
+        else
+        {
+            thrust::copy(norms_.begin(), norms_.begin() + size_, host_norms.begin());
+        }
+
+        norms = host_norms;
+    }
+
+    /*! print the recorded history
+     */
+    void print(void) const
+    {
+        cusp::array1d<Real,cusp::host_memory> norms;
+        residual_history(norms);
+
+        std::cout << "  Iteration Number  |  Time (ms)  | Residual Norm" << std::endl;
 
+        for (size_t i = 0; i < size_; i++)
+        {
+            std::cout << "       "  << std::setw(10) << iterations_[i];
+            std::cout << "   "      << std::setw(10) << std::fixed << std::setprecision(3) << times_[i];
+            std::cout << "       "  << std::setw(10) << std::scientific << norms[i] << std::endl;
+        }
+    }
+
+    protected:
+
+    cusp::array1d<size_t,cusp::host_memory> iterations_;
+    cusp::array1d<Real,cusp::host_memory>   norms_;
+    cusp::array1d<double,cusp::host_memory> times_;
+    cusp::array1d<ValueType,cusp::device_memory> squares_;
+    size_t size_;
+    bool on_device_;
+    double start_;
+
+    // the slot of a new iteration, or -1 when it was already recorded
+    size_t record(void)
+    {
+        const size_t iteration = base::iteration_count();
+
+        if (size_ == iterations_.size() || (size_ > 0 && iterations_[size_ - 1] >= iteration))
+            return size_t(-1);
+
+        iterations_[size_] = iteration;
+        times_[size_] = cusp::detail::wall_clock_milliseconds() - start_;
+
+        return size_++;
+    }
+
+    template <typename Vector>
+    bool finished(const Vector& r, cusp::host_memory)
+    {
+        const bool done = base::finished(r);
+
+        const size_t slot = record();
+        if (slot != size_t(-1))
+            norms_[slot] = base::residual_norm();
+
+        return done;
+    }
+
+    template <typename Vector>
+    bool finished(const Vector& r, cusp::device_memory)
+    {
+        if (!on_device_)
+        {
+            squares_.resize(iterations_.size());
+            on_device_ = true;
+        }
+
+        const size_t slot = record();
+
+        if (slot == size_t(-1))
+            return super::test_async(r, (const ValueType *) 0);
+
+        ValueType * square = thrust::raw_pointer_cast(&squares_[slot]);
+        super::norm.reduce(r, square);
+
+        return super::test_async(r, square);
+    }
+};
+/*! \}
+ */
+
+/*! \p block_monitor : Implements convergence criteria for iterative
+ * solvers with multiple right-hand sides, such as \p block_cg and
+ * \p block_gmres.
+ *
+ * Convergence is tracked per column: column j of the residual has converged
+ * when
+ *      ||B(:,j) - A X(:,j)|| <= absolute_tolerance + relative_tolerance * ||B(:,j)||
+ * Block solvers query \p converged(j) to deflate converged columns from
+ * the iteration.
+ *
+ * \tparam ValueType scalar type used in the solver (e.g. \c float or \c double).
+ *
+ *  \code
+ *  // right-hand sides stored as the columns of B
+ *  cusp::array2d<float, cusp::device_memory, cusp::column_major> X(A.num_rows, 16, 0);
+ *  cusp::array2d<float, cusp::device_memory, cusp::column_major> B(A.num_rows, 16);
+ *  ... // fill B with linearly independent right-hand sides
+ *
+ *  cusp::block_monitor<float> monitor(B, 100, 1e-6);
+ *
+ *  cusp::krylov::block_cg(A, X, B, monitor);
+ *
+ *  std::cout << monitor.num_converged() << " of " << monitor.num_columns();
+ *  std::cout << " columns converged" << std::endl;
+ *  \endcode
+ *
+ *  \see \p default_monitor
+ */
+template <typename ValueType>
+class block_monitor
+{
+    public:
+    typedef typename norm_type<ValueType>::type Real;
+
+    /*! Construct a \p block_monitor for the right-hand sides \p B
+     *
+     *  \param B right-hand sides of the linear systems A X = B, one per column
+     *  \param iteration_limit maximum number of solver iterations to allow
+     *  \param relative_tolerance determines convergence criteria
+     *  \param absolute_tolerance determines convergence criteria
+     *
+     *  \tparam Matrix \p array2d or \p array2d_view
+     */
+    template <typename Matrix>
+    block_monitor(const Matrix& B, size_t iteration_limit = 500, Real relative_tolerance = 1e-5, Real absolute_tolerance = 0)
+        : b_norms(B.num_cols),
+          r_norms(B.num_cols, std::numeric_limits<Real>::max()),
+          relative_tolerance_(relative_tolerance),
+          absolute_tolerance_(absolute_tolerance),
+          iteration_limit_(iteration_limit),
+          iteration_count_(0)
+    {
+        column_norms(B, b_norms);
+    }
+
+    /*! increment the iteration count
+     */
+    void operator++(void) {  ++iteration_count_; } // prefix increment
+
+    /*! applies convergence criteria to determine whether iteration is finished
+     *
+     *  \param R residuals of the linear systems (R = B - A X), one per column
+     *  \tparam Matrix \p array2d or \p array2d_view
+     */
+    template <typename Matrix>
+    bool finished(const Matrix& R)
+    {
+        column_norms(R, r_norms);
+
+        return converged() || iteration_count() >= iteration_limit();
+    }
+
+    /*! whether the last tested residuals of all columns satisfy the
+     *  convergence tolerance
+     */
+    bool converged() const
+    {
+        return num_converged() == num_columns();
+    }
+
+    /*! whether the last tested residual of column \p j satisfies the
+     *  convergence tolerance
+     */
+    bool converged(size_t j) const
+    {
+        return residual_norm(j) <= tolerance(j);
+    }
+
+    /*! number of columns whose last tested residual satisfies the
+     *  convergence tolerance
+     */
+    size_t num_converged() const
+    {
+        size_t count = 0;
+
+        for (size_t j = 0; j < num_columns(); j++)
+            if (converged(j))
+                count++;
+
+        return count;
+    }
+
+    /*! number of right-hand sides
+     */
+    size_t num_columns() const { return b_norms.size(); }
+
+    /*! Euclidean norm of last residual of column \p j
+     */
+    Real residual_norm(size_t j) const { return r_norms[j]; }
+
+    /*! largest Euclidean norm of the last residuals
+     */
+    Real residual_norm() const
+    {
+        Real r_norm = 0;
+
+        for (size_t j = 0; j < num_columns(); j++)
+            r_norm = std::max(r_norm, r_norms[j]);
+
+        return r_norm;
+    }
+
+    /*! number of iterations
+     */
+    size_t iteration_count() const { return iteration_count_; }
+
+    /*! maximum number of iterations
+     */
+    size_t iteration_limit() const { return iteration_limit_; }
+
+    /*! relative tolerance
+     */
+    Real relative_tolerance() const { return relative_tolerance_; }
+
+    /*! absolute tolerance
+     */
+    Real absolute_tolerance() const { return absolute_tolerance_; }
+
+    /*! tolerance of column \p j
+     *
+     *  Equal to absolute_tolerance() + relative_tolerance() * ||B(:,j)||
+     */
+    Real tolerance(size_t j) const { return absolute_tolerance() + relative_tolerance() * b_norms[j]; }
+
+    protected:
+
+    cusp::array1d<Real,cusp::host_memory> b_norms;
+    cusp::array1d<Real,cusp::host_memory> r_norms;
+    Real relative_tolerance_;
+    Real absolute_tolerance_;
+
+    size_t iteration_limit_;
+    size_t iteration_count_;
+
+    private:
+
+    template <typename Matrix>
+    static void column_norms(const Matrix& R, cusp::array1d<Real,cusp::host_memory>& norms)
+    {
+        column_norms(R, norms, typename Matrix::orientation());
+    }
+
+    template <typename Matrix>
+    static void column_norms(const Matrix& R, cusp::array1d<Real,cusp::host_memory>& norms, cusp::column_major)
+    {
+        for (size_t j = 0; j < R.num_cols; j++)
+            norms[j] = cusp::blas::nrm2(cusp::make_array1d_view(R.values.begin() + R.pitch * j,
+                                                                R.values.begin() + R.pitch * j + R.num_rows));
+    }
+
+    template <typename Matrix>
+    static void column_norms(const Matrix& R, cusp::array1d<Real,cusp::host_memory>& norms, cusp::row_major)
+    {
+        // columns of a row-major array are strided, so copy them first
+        cusp::array2d<typename Matrix::value_type, typename Matrix::memory_space, cusp::column_major> C(R);
+
+        column_norms(C, norms, cusp::column_major());
+    }
+};
+/*! \}
+ */
+
+} // end namespace cusp
@@ -22,6 +22,8 @@
 
 #include <cusp/detail/config.h>
 
+#include <cusp/stream.h>
+
 namespace cusp
 {
 
@@ -35,6 +37,34 @@ namespace cusp
  * \p multiply can be used with dense matrices, sparse matrices, and user-defined
  * \p linear_operator objects.
  *
+ * Dense products of \p array2d operands in device memory, of either
+ * orientation, use tiled device kernels.  Defining \p CUSP_USE_CUBLAS
+ * before including any Cusp header (and linking with cuBLAS) delegates
+ * the \c float and \c double dense products to cuBLAS instead.
+ *
+ * Likewise \p CUSP_USE_CUSPARSE (and linking with cuSPARSE) delegates
+ * the products of device \p csr_matrix operands with \c int indices and
+ * \c float or \c double values to cuSPARSE, which may be selected per
+ * call or for all threads with the functions of \p sparse_engine.h.
+ *
+ * In host memory, defining \p CUSP_USE_CBLAS (and linking with a CBLAS
+ * library) delegates the \c float and \c double dense products to the
+ * library, and \p CUSP_USE_MKL delegates the dense products and the
+ * products of \p csr_matrix with \p MKL_INT indices to Intel MKL.
+ * Setting the environment variable \c CUSP_HOST_VENDOR to \c 0 selects
+ * the built-in loops at run time.
+ *
+ * Operands in \p cusp::managed_memory are prefetched to the device on
+ * entry.  A managed \p csr_matrix that exceeds three quarters of the
+ * memory of the device is multiplied in blocks of rows instead, each of
+ * which is prefetched while the previous block is multiplied.
+ *
+ * The product of a sparse matrix with a \p sparse_vector is a
+ * \p sparse_vector holding the structural pattern of the product.  It is
+ * computed by the rows of the CSR matrix; \p multiply_transpose
+ * computes it by columns instead, which only visits the rows named by
+ * the vector.
+ *
  * \param A input matrix
  * \param B input matrix or vector
  * \param C output matrix or vector
@@ -82,6 +112,196 @@ template <typename LinearOperator,
 void multiply(LinearOperator&  A,
               MatrixOrVector1& B,
               MatrixOrVector2& C);
+
+/*! \p multiply : Implements matrix-matrix and matrix-vector multiplication
+ *  on a given CUDA stream.
+ *
+ *  Equivalent to calling \p multiply(A,B,C) within a \p scoped_stream.
+ *
+ * \param A input matrix
+ * \param B input matrix or vector
+ * \param C output matrix or vector
+ * \param stream CUDA stream on which device work is issued
+ *
+ * \see \p scoped_stream
+ */
+template <typename LinearOperator,
+          typename MatrixOrVector1,
+          typename MatrixOrVector2>
+void multiply(LinearOperator&  A,
+              MatrixOrVector1& B,
+              MatrixOrVector2& C,
+              cudaStream_t     stream);
+
+/*! \p spgemm_workspace : workspace budget of a sparse matrix-matrix
+ *  product and the memory it used, see
+ *  \p multiply(A,B,C,workspace).
+ */
+struct spgemm_workspace
+{
+    /*! Bytes of device memory the product may use beyond its operands
+     *  and result, or zero to size the workspace from the free memory of
+     *  the device.
+     */
+    size_t budget_bytes;
+
+    /*! Peak device memory held by Cusp's allocators during the product,
+     *  above what was in use when it started.  This includes the result
+     *  and copies of operands in other formats (see
+     *  \p get_device_memory_statistics).
+     */
+    size_t peak_bytes;
+
+    /*! Number of slabs (blocks of rows of A) the product was split into.
+     */
+    size_t num_slabs;
+
+    explicit spgemm_workspace(const size_t budget_bytes = 0)
+        : budget_bytes(budget_bytes), peak_bytes(0), num_slabs(0) {}
+};
+
+/*! \p multiply : Computes the sparse matrix-matrix product C = A * B
+ *  within a workspace budget.
+ *
+ *  The rows of A are split into slabs whose intermediate storage fits in
+ *  \p workspace.budget_bytes: the intermediate products of the
+ *  expand-sort-contract method, or the hash tables of the rows whose
+ *  products exceed shared memory.  A row that does not fit by itself forms
+ *  a slab of its own.  Consecutive slabs of hash tables alternate between
+ *  the current stream and a second stream, each with half of the budget.
+ *  On return \p workspace holds the peak memory the product used and the
+ *  number of slabs.  Products on the host ignore the budget.
+ *
+ * \param A input sparse matrix
+ * \param B input sparse matrix
+ * \param C output sparse matrix
+ * \param workspace budget of the product, updated with its usage
+ *
+ *  \code
+ *  // allow at most 256 MB of temporaries
+ *  cusp::spgemm_workspace workspace(256 << 20);
+ *
+ *  cusp::multiply(A, B, C, workspace);
+ *
+ *  std::cout << workspace.peak_bytes << " bytes in " << workspace.num_slabs << " slabs" << std::endl;
+ *  \endcode
+ */
+template <typename Matrix1,
+          typename Matrix2,
+          typename Matrix3>
+void multiply(const Matrix1& A,
+              const Matrix2& B,
+                    Matrix3& C,
+              cusp::spgemm_workspace& workspace);
+
+/*! \p multiply : Computes y = alpha * A * x + beta * y
+ *
+ *  The update of \p y is fused into the sparse matrix-vector product,
+ *  so each row of the product is scaled and combined with \p y before it
+ *  is stored, and \p y makes a single pass through memory.  The device
+ *  kernels of the CSR, DIA, ELL and JDS formats apply the update in registers;
+ *  other formats and user-defined \p linear_operator objects compute the
+ *  product into a temporary and combine it afterwards.  As in the BLAS,
+ *  \p y is not read when \p beta is zero.
+ *
+ * \param A input matrix
+ * \param x input vector
+ * \param y input and output vector
+ * \param alpha scale factor of the product
+ * \param beta scale factor of \p y
+ *
+ *  \code
+ *  // y <- 2 * A * x - y, equivalent to
+ *  //   cusp::multiply(A, x, t); cusp::blas::axpby(t, y, y, 2, -1);
+ *  cusp::multiply(A, x, y, 2.0f, -1.0f);
+ *  \endcode
+ */
+template <typename LinearOperator,
+          typename Vector1,
+          typename Vector2,
+          typename ScalarType>
+void multiply(LinearOperator& A,
+              Vector1&        x,
+              Vector2&        y,
+              ScalarType      alpha,
+              ScalarType      beta);
+
+/*! \p residual : Computes the residual r = b - A * x
+ *
+ *  Equivalent to \p multiply(A,x,r) followed by
+ *  \p blas::axpby(b,r,r,1,-1), with the subtraction fused into the
+ *  matrix-vector product as in \p multiply(A,x,y,alpha,beta).
+ *  \p r may alias \p b but not \p x.
+ *
+ * \param A input matrix
+ * \param x approximate solution
+ * \param b right-hand side
+ * \param r output residual vector
+ *
+ *  \code
+ *  // r <- b - A * x
+ *  cusp::residual(A, x, b, r);
+ *  \endcode
+ */
+template <typename LinearOperator,
+          typename Vector1,
+          typename Vector2,
+          typename Vector3>
+void residual(LinearOperator& A,
+              Vector1&        x,
+              Vector2&        b,
+              Vector3&        r);
+
+/*! \p multiply_transpose : Computes the matrix-vector product y = A^T x
+ *  without forming the transpose of \p A.
+ *
+ *  The entries of \p A are visited in their storage order and each
+ *  product A(i,j) * x[i] is added to y[j].  On the device this uses
+ *  atomic additions (sm_20 and later); the CSR, COO, ELL and HYB formats
+ *  have dedicated kernels and other formats are converted to COO.  On
+ *  earlier targets the products are sorted by column and reduced instead.
+ *
+ *  With \p sparse_vector operands, the rows of \p A named by \p x are
+ *  expanded and their products are sorted by column and reduced.  When
+ *  they hold a large part of the entries of \p A, the product is summed
+ *  by the dense kernel instead.
+ *
+ * \param A input matrix, dense or sparse
+ * \param x input vector of size \p A.num_rows
+ * \param y output vector of size \p A.num_cols
+ *
+ * \note The result of the atomic kernels may differ in rounding between
+ *  calls, since the order of the additions to y[j] is not fixed.
+ *
+ *  \code
+ *  // compute y = A^T x, equivalent to
+ *  //   cusp::transpose(A, At); cusp::multiply(At, x, y);
+ *  cusp::multiply_transpose(A, x, y);
+ *  \endcode
+ *
+ * \see \p transpose
+ */
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& x,
+                              Vector2& y);
+
+/*! \p multiply_transpose : Computes y = A^T x on a given CUDA stream.
+ *
+ *  Equivalent to calling \p multiply_transpose(A,x,y) within a
+ *  \p scoped_stream.
+ *
+ * \see \p scoped_stream
+ */
+template <typename Matrix,
+          typename Vector1,
+          typename Vector2>
+void multiply_transpose(const Matrix&  A,
+                        const Vector1& x,
+                              Vector2& y,
+                        cudaStream_t   stream);
 /*! \}
  */
 
@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file no_copy.h
+ *  \brief Forbid the implicit copies of operands made by Cusp algorithms
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/detail/implicit_copy.h>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p scoped_no_copy : throw \p cusp::implicit_copy_exception, for the
+ *  lifetime of the object, whenever a Cusp algorithm would copy an
+ *  operand of the calling host thread.
+ *
+ *  Algorithms copy operands that are not stored the way they consume
+ *  them: a sparse matrix product converts matrices that are not in CSR
+ *  format, and device kernels stage vectors that are not contiguous in
+ *  device memory, e.g. strided views, through contiguous temporaries.
+ *  Views of external buffers are consumed in place when no such copy is
+ *  needed, which a \p scoped_no_copy verifies.  Scopes may be nested.
+ *
+ *  \code
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/multiply.h>
+ *  #include <cusp/no_copy.h>
+ *  ...
+ *  // wrap buffers owned by another library
+ *  cusp::csr_matrix_view<IndexArray,IndexArray,ValueArray> A(...);
+ *
+ *  {
+ *      cusp::scoped_no_copy guard;
+ *      cusp::multiply(A, x, y);    // throws rather than copy A, x or y
+ *  }
+ *  \endcode
+ */
+class scoped_no_copy
+{
+    public:
+    scoped_no_copy(void)
+    {
+        cusp::detail::no_copy_depth_reference()++;
+    }
+
+    ~scoped_no_copy(void)
+    {
+        cusp::detail::no_copy_depth_reference()--;
+    }
+
+    private:
+    // not copyable
+    scoped_no_copy(const scoped_no_copy&);
+    scoped_no_copy& operator=(const scoped_no_copy&);
+};
+/*! \}
+ */
+
+} // end namespace cusp
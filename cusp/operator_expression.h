@@ -0,0 +1,266 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file operator_expression.h
+ *  \brief Lazy sums, products, shifts and scalings of linear operators
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/exception.h>
+#include <cusp/linear_operator.h>
+#include <cusp/multiply.h>
+
+namespace cusp
+{
+
+/*! \addtogroup linear_operators Linear Operators
+ *  \{
+ */
+
+/*! Operator expressions combine matrices and linear operators without
+ *  forming the result: \p shift(A, sigma) is A - sigma I, \p scale(alpha, A)
+ *  is alpha A, \p sum(A, B) is A + B and \p compose(M, A) is M A.  An
+ *  expression is a \p linear_operator, so it may be passed to \p multiply
+ *  and to the iterative solvers, and its product is evaluated from the
+ *  products of its operands.  Where the operand is a matrix in a built-in
+ *  format, the shift, the scaling and the second term of a sum are applied
+ *  in the epilogue of the SpMV kernel, so they cost no extra pass over the
+ *  vectors.  Shift-invert and continuation loops update \p sigma or
+ *  \p alpha in place instead of building a new matrix for every shift.
+ *
+ *  Matrices are referenced and must outlive the expression, while nested
+ *  expressions are held by value, so that e.g. \p compose(M, shift(A, s))
+ *  may be stored.
+ *
+ *  \code
+ *  #include <cusp/operator_expression.h>
+ *  ...
+ *
+ *  // solve (A - sigma I) x = b for several shifts
+ *  cusp::shifted_operator< cusp::csr_matrix<int,float,cusp::device_memory> > S = cusp::shift(A, 0.0f);
+ *
+ *  for (size_t i = 0; i < shifts.size(); i++)
+ *  {
+ *      S.sigma = shifts[i];
+ *      cusp::default_monitor<float> monitor(b, 100, 1e-6);
+ *      cusp::krylov::gmres(S, x, b, 20, monitor);
+ *  }
+ *  \endcode
+ */
+
+template <typename Operator> class shifted_operator;
+template <typename Operator> class scaled_operator;
+template <typename Operator1, typename Operator2> class sum_operator;
+template <typename Operator1, typename Operator2> class composed_operator;
+
+namespace detail
+{
+
+// operands are referenced, except for expressions
+template <typename Operator>
+struct operator_operand { typedef const Operator& type; };
+
+template <typename Operator>
+struct operator_operand< cusp::shifted_operator<Operator> > { typedef cusp::shifted_operator<Operator> type; };
+
+template <typename Operator>
+struct operator_operand< cusp::scaled_operator<Operator> > { typedef cusp::scaled_operator<Operator> type; };
+
+template <typename Operator1, typename Operator2>
+struct operator_operand< cusp::sum_operator<Operator1,Operator2> > { typedef cusp::sum_operator<Operator1,Operator2> type; };
+
+template <typename Operator1, typename Operator2>
+struct operator_operand< cusp::composed_operator<Operator1,Operator2> > { typedef cusp::composed_operator<Operator1,Operator2> type; };
+
+} // end namespace detail
+
+/*! \p shifted_operator : A - sigma I
+ */
+template <typename Operator>
+class shifted_operator
+  : public cusp::linear_operator<typename Operator::value_type, typename Operator::memory_space, typename Operator::index_type>
+{
+    typedef cusp::linear_operator<typename Operator::value_type, typename Operator::memory_space, typename Operator::index_type> Parent;
+
+  public:
+    typedef typename Operator::value_type ValueType;
+
+    typename cusp::detail::operator_operand<Operator>::type A;
+
+    /*! the shift
+     */
+    ValueType sigma;
+
+    shifted_operator(const Operator& A, const ValueType sigma)
+      : Parent(A.num_rows, A.num_cols, A.num_entries), A(A), sigma(sigma)
+    {
+        if (A.num_rows != A.num_cols)
+            throw cusp::invalid_input_exception("a shifted operator must be square");
+    }
+
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const
+    {
+        // y <- A x - sigma x
+        cusp::detail::multiply_axpby(A, x, x, y, ValueType(1), -sigma, typename Operator::format());
+    }
+};
+
+/*! \p scaled_operator : alpha A
+ */
+template <typename Operator>
+class scaled_operator
+  : public cusp::linear_operator<typename Operator::value_type, typename Operator::memory_space, typename Operator::index_type>
+{
+    typedef cusp::linear_operator<typename Operator::value_type, typename Operator::memory_space, typename Operator::index_type> Parent;
+
+  public:
+    typedef typename Operator::value_type ValueType;
+
+    typename cusp::detail::operator_operand<Operator>::type A;
+
+    /*! the scaling
+     */
+    ValueType alpha;
+
+    scaled_operator(const ValueType alpha, const Operator& A)
+      : Parent(A.num_rows, A.num_cols, A.num_entries), A(A), alpha(alpha) {}
+
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const
+    {
+        // y <- alpha A x, y is not read
+        cusp::detail::multiply_axpby(A, x, y, y, alpha, ValueType(0), typename Operator::format());
+    }
+};
+
+/*! \p sum_operator : A + B
+ */
+template <typename Operator1, typename Operator2>
+class sum_operator
+  : public cusp::linear_operator<typename Operator1::value_type, typename Operator1::memory_space, typename Operator1::index_type>
+{
+    typedef cusp::linear_operator<typename Operator1::value_type, typename Operator1::memory_space, typename Operator1::index_type> Parent;
+
+  public:
+    typedef typename Operator1::value_type ValueType;
+
+    typename cusp::detail::operator_operand<Operator1>::type A;
+    typename cusp::detail::operator_operand<Operator2>::type B;
+
+    sum_operator(const Operator1& A, const Operator2& B)
+      : Parent(A.num_rows, A.num_cols, A.num_entries + B.num_entries), A(A), B(B)
+    {
+        if (A.num_rows != B.num_rows || A.num_cols != B.num_cols)
+            throw cusp::invalid_input_exception("the operands of a sum must have the same shape");
+    }
+
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const
+    {
+        // y <- A x, y <- B x + y
+        cusp::multiply(A, x, y);
+        cusp::detail::multiply_axpby(B, x, y, y, ValueType(1), ValueType(1), typename Operator2::format());
+    }
+};
+
+/*! \p composed_operator : M A, i.e. A is applied first
+ */
+template <typename Operator1, typename Operator2>
+class composed_operator
+  : public cusp::linear_operator<typename Operator1::value_type, typename Operator1::memory_space, typename Operator1::index_type>
+{
+    typedef cusp::linear_operator<typename Operator1::value_type, typename Operator1::memory_space, typename Operator1::index_type> Parent;
+
+  public:
+    typedef typename Operator1::value_type   ValueType;
+    typedef typename Operator1::memory_space MemorySpace;
+
+    typename cusp::detail::operator_operand<Operator1>::type M;
+    typename cusp::detail::operator_operand<Operator2>::type A;
+
+    composed_operator(const Operator1& M, const Operator2& A)
+      : Parent(M.num_rows, A.num_cols, M.num_entries + A.num_entries), M(M), A(A)
+    {
+        if (M.num_cols != A.num_rows)
+            throw cusp::invalid_input_exception("the operands of a product have incompatible shapes");
+    }
+
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const
+    {
+        // y <- M (A x)
+        temp.resize(A.num_rows);
+        cusp::multiply(A, x, temp);
+        cusp::multiply(M, temp, y);
+    }
+
+  private:
+    mutable cusp::array1d<ValueType,MemorySpace> temp;
+};
+
+/*! \p shift : returns the lazy operator A - sigma I
+ *
+ * \param A square matrix or linear operator
+ * \param sigma the shift
+ */
+template <typename Operator>
+shifted_operator<Operator> shift(const Operator& A, const typename Operator::value_type sigma)
+{
+    return shifted_operator<Operator>(A, sigma);
+}
+
+/*! \p scale : returns the lazy operator alpha A
+ *
+ * \param alpha the scaling
+ * \param A matrix or linear operator
+ */
+template <typename Operator>
+scaled_operator<Operator> scale(const typename Operator::value_type alpha, const Operator& A)
+{
+    return scaled_operator<Operator>(alpha, A);
+}
+
+/*! \p sum : returns the lazy operator A + B
+ *
+ * \param A matrix or linear operator
+ * \param B matrix or linear operator of the same shape
+ */
+template <typename Operator1, typename Operator2>
+sum_operator<Operator1,Operator2> sum(const Operator1& A, const Operator2& B)
+{
+    return sum_operator<Operator1,Operator2>(A, B);
+}
+
+/*! \p compose : returns the lazy operator M A, which applies A first
+ *
+ * \param M matrix or linear operator, e.g. a preconditioner
+ * \param A matrix or linear operator with \p M.num_cols rows
+ */
+template <typename Operator1, typename Operator2>
+composed_operator<Operator1,Operator2> compose(const Operator1& M, const Operator2& A)
+{
+    return composed_operator<Operator1,Operator2>(M, A);
+}
+/*! \}
+ */
+
+} // end namespace cusp
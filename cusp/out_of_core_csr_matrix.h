@@ -0,0 +1,170 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file out_of_core_csr_matrix.h
+ *  \brief Operator of a host CSR matrix that is streamed to the device
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/linear_operator.h>
+#include <cusp/memory.h>
+#include <cusp/detail/row_statistics.h>
+
+#include <cuda_runtime_api.h>
+
+#include <vector>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ *  \{
+ */
+
+/*! \p out_of_core_csr_matrix : a device operator of a CSR matrix in host
+ *  memory, for matrices that exceed the memory of the device.
+ *
+ *  The rows of the matrix are split into panels whose row offsets, column
+ *  indices and values fit into a device buffer.  A product copies the
+ *  panels to the device with \p cusp::copy_async, each on one of several
+ *  streams with a buffer of its own, and multiplies each panel once it
+ *  has arrived, so that the transfer of one panel overlaps the product of
+ *  the previous one.  The product therefore runs at the bandwidth of the
+ *  host interconnect rather than that of device memory.
+ *
+ *  The operator works on device vectors and may be passed wherever a
+ *  \p linear_operator is accepted, e.g. to \p cusp::krylov::cg.  Its
+ *  product is ordered with the other work of the current stream (see
+ *  \p scoped_stream) without synchronizing the host.
+ *
+ *  \tparam MatrixType Type of the referenced \p csr_matrix (or view) in
+ *  host memory.
+ *
+ *  \note The referenced matrix must outlive the operator.  Panels overlap
+ *  with the product only when the matrix resides in page-locked memory
+ *  (\p cusp::pinned_memory), since the driver stages the transfers of
+ *  pageable memory.  \p cusp::io::read_binary_file reads a matrix from
+ *  the Cusp binary format into pinned memory without conversion.
+ *
+ *  \code
+ *  #include <cusp/out_of_core_csr_matrix.h>
+ *  #include <cusp/io/binary.h>
+ *  #include <cusp/krylov/cg.h>
+ *  ...
+ *
+ *  typedef cusp::csr_matrix<int, float, cusp::pinned_memory> HostMatrix;
+ *
+ *  HostMatrix A_host;
+ *  cusp::io::read_binary_file(A_host, "huge.cusp");
+ *
+ *  // panels of at most 256 MB on each of two streams
+ *  cusp::out_of_core_csr_matrix<HostMatrix> A(A_host, 512 << 20);
+ *
+ *  cusp::array1d<float, cusp::device_memory> x(A.num_rows, 0);
+ *  cusp::array1d<float, cusp::device_memory> b(A.num_rows, 1);
+ *
+ *  cusp::default_monitor<float> monitor(b, 1000, 1e-6);
+ *  cusp::krylov::cg(A, x, b, monitor);
+ *  \endcode
+ */
+template <typename MatrixType>
+class out_of_core_csr_matrix
+  : public cusp::linear_operator<typename MatrixType::value_type,
+                                 cusp::device_memory,
+                                 typename MatrixType::index_type>
+{
+    typedef cusp::linear_operator<typename MatrixType::value_type,
+                                  cusp::device_memory,
+                                  typename MatrixType::index_type> Parent;
+
+    typedef typename MatrixType::row_offsets_array_type::value_type    OffsetType;
+    typedef typename MatrixType::column_indices_array_type::value_type IndexType;
+    typedef typename MatrixType::values_array_type::value_type         ValueType;
+
+    struct panel_buffer
+    {
+        cusp::array1d<OffsetType, cusp::device_memory> row_offsets;
+        cusp::array1d<IndexType,  cusp::device_memory> column_indices;
+        cusp::array1d<ValueType,  cusp::device_memory> values;
+    };
+
+public:
+    /*! type of the referenced matrix
+     */
+    typedef MatrixType matrix_type;
+
+    /*! The referenced matrix.
+     */
+    const MatrixType& matrix;
+
+    /*! construct the operator of a host matrix
+     *
+     * \param matrix CSR matrix in host memory
+     * \param buffer_bytes device memory of the panel buffers of all
+     * streams, by default a quarter of the memory of the current device
+     * \param num_streams number of streams, and of panels in flight
+     *
+     * \throws cusp::invalid_input_exception if \p num_streams is zero
+     * \throws cusp::runtime_exception if the streams cannot be created
+     */
+    out_of_core_csr_matrix(const MatrixType& matrix, size_t buffer_bytes = 0, size_t num_streams = 2);
+
+    ~out_of_core_csr_matrix(void);
+
+    /*! number of row panels of the matrix
+     */
+    size_t num_panels(void) const { return panel_rows.size() - 1; }
+
+    /*! first row of panel \p i, or the number of rows for \p i = \p num_panels()
+     */
+    size_t panel_begin(const size_t i) const { return panel_rows[i]; }
+
+    /*! apply the operator to device vector \p x and store the result in \p y
+     *
+     * \param x input vector
+     * \param y ouput vector
+     * \tparam VectorType1 vector
+     * \tparam VectorType2 vector
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+
+private:
+    std::vector<size_t> panel_rows;
+    std::vector<size_t> panel_offsets;
+    std::vector<cusp::detail::row_statistics> panel_statistics;
+
+    mutable std::vector<panel_buffer> buffers;
+    std::vector<cudaStream_t> streams;
+    std::vector<cudaEvent_t>  events;
+    cudaEvent_t start;
+
+    void release(void);
+
+    // not copyable
+    out_of_core_csr_matrix(const out_of_core_csr_matrix&);
+    out_of_core_csr_matrix& operator=(const out_of_core_csr_matrix&);
+};
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/out_of_core_csr_matrix.inl>
@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file permute.h
+ *  \brief Symmetric permutation of a matrix
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+namespace cusp
+{
+
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p permute : reorder the rows and columns of a square matrix
+ *
+ * Computes <tt>B = P A P^T</tt>, i.e. <tt>B(i,j) = A(permutation[i], permutation[j])</tt>,
+ * where \p permutation lists the rows of \p A in their new order, as
+ * computed by \p reverse_cuthill_mckee, \p nested_dissection and
+ * \p coloring_permutation.  The rows of \p B are gathered from \p A and
+ * their columns renumbered and sorted in the memory space of \p B, so a
+ * device matrix is permuted on the device.  Vectors are permuted
+ * accordingly with <tt>y[i] = x[permutation[i]]</tt>, e.g. with
+ * \p thrust::gather.
+ *
+ * \param A input matrix
+ * \param permutation new order of the rows and columns
+ * \param B output matrix (permutation of A)
+ *
+ * \tparam MatrixType1 matrix
+ * \tparam Array array
+ * \tparam MatrixType2 matrix
+ *
+ *  \code
+ *  #include <cusp/permute.h>
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/gallery/poisson.h>
+ *  #include <cusp/graph/reverse_cuthill_mckee.h>
+ *
+ *  int main(void)
+ *  {
+ *      cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *      cusp::gallery::poisson5pt(A, 100, 100);
+ *
+ *      cusp::array1d<int, cusp::device_memory> permutation;
+ *      cusp::graph::reverse_cuthill_mckee(A, permutation);
+ *
+ *      // B = P A P^T
+ *      cusp::csr_matrix<int, float, cusp::device_memory> B;
+ *      cusp::permute(A, permutation, B);
+ *
+ *      return 0;
+ *  }
+ *  \endcode
+ */
+template <typename MatrixType1, typename Array, typename MatrixType2>
+void permute(const MatrixType1& A, const Array& permutation, MatrixType2& B);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/permute.inl>
@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file pinned_allocator.h
+ *  \brief Host allocator of page-locked memory
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cuda_runtime_api.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p pinned_allocator : a host allocator that obtains page-locked
+ *  (pinned) memory with \p cudaMallocHost.
+ *
+ *  Transfers between pinned host memory and the device run at the full
+ *  bandwidth of the bus and, when issued with \p cusp::copy_async, are
+ *  asynchronous with respect to the host, so that they overlap with
+ *  kernels on other streams.  Arrays in pinned memory are host arrays in
+ *  every other respect.  Since page-locked memory is a limited resource
+ *  and its allocation is expensive, it is best reserved for the staging
+ *  buffers of transfers.
+ *
+ *  The allocator is selected by passing \p cusp::pinned_memory in place
+ *  of the memory space.
+ *
+ *  \code
+ *  cusp::array1d<float, cusp::pinned_memory> b_host(N);
+ *  cusp::array1d<float, cusp::device_memory> b(N);
+ *
+ *  cusp::copy_async(b_host, b, stream);
+ *  \endcode
+ *
+ *  \throws std::bad_alloc if the memory cannot be allocated
+ */
+template <typename T>
+class pinned_allocator : public std::allocator<T>
+{
+    typedef std::allocator<T> super_t;
+
+    public:
+
+    typedef T *         pointer;
+    typedef std::size_t size_type;
+
+    template <typename U>
+    struct rebind { typedef pinned_allocator<U> other; };
+
+    pinned_allocator(void) {}
+
+    pinned_allocator(const pinned_allocator&) : super_t() {}
+
+    template <typename U>
+    pinned_allocator(const pinned_allocator<U>&) {}
+
+    pointer allocate(size_type n, const void * = 0)
+    {
+        void * ptr = 0;
+
+        if (n == 0)
+            return pointer(0);
+
+        if (cudaMallocHost(&ptr, n * sizeof(T)) != cudaSuccess)
+        {
+            cudaGetLastError(); // clear the error
+            throw std::bad_alloc();
+        }
+
+        return static_cast<pointer>(ptr);
+    }
+
+    void deallocate(pointer p, size_type)
+    {
+        if (p != 0)
+            cudaFreeHost(p);
+    }
+};
+
+template <typename T1, typename T2>
+bool operator==(const pinned_allocator<T1>&, const pinned_allocator<T2>&) { return true; }
+
+template <typename T1, typename T2>
+bool operator!=(const pinned_allocator<T1>&, const pinned_allocator<T2>&) { return false; }
+
+/*! \}
+ */
+
+} // end namespace cusp
@@ -0,0 +1,63 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file precompiled.h
+ *  \brief Declarations of the instantiations of the Cusp library
+ *
+ *  Including this header after, or instead of, the Cusp headers it
+ *  covers tells the compiler that the library built in \c library/
+ *  already defines the common instantiations, so they are not compiled
+ *  again in every translation unit.  Link the program with \c libcusp.
+ *
+ *  The library instantiates, for \c int and \c long indices and \c float,
+ *  \c double, \c cusp::complex<float> and \c cusp::complex<double> values
+ *  in host and device memory:
+ *
+ *  - the COO, CSR, DIA, ELL and HYB containers
+ *  - \p cusp::multiply of each format with \p cusp::array1d vectors
+ *  - \p cusp::convert between the formats and between memory spaces
+ *  - \p cusp::precond::smoothed_aggregation of a CSR matrix (real values)
+ *
+ *  Other instantiations are compiled by the caller as usual.
+ *
+ *  \code
+ *  #include <cusp/precompiled.h>
+ *  #include <cusp/krylov/cg.h>
+ *  ...
+ *  $ scons -C library
+ *  $ nvcc solve.cu -Llibrary -lcusp
+ *  \endcode
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/detail/precompiled.h>
+
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_CONTAINERS, extern template, cusp::host_memory)
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_CONTAINERS, extern template, cusp::device_memory)
+
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_MULTIPLY, extern template, cusp::host_memory)
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_MULTIPLY, extern template, cusp::device_memory)
+
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_CONVERT, extern template, cusp::host_memory)
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_CONVERT, extern template, cusp::device_memory)
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_TRANSFER, extern template, cusp::device_memory)
+
+CUSP_PRECOMPILED_REAL_TYPES(CUSP_PRECOMPILED_AGGREGATION, extern template, cusp::host_memory)
+CUSP_PRECOMPILED_REAL_TYPES(CUSP_PRECOMPILED_AGGREGATION, extern template, cusp::device_memory)
@@ -0,0 +1,187 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file additive_schwarz.h
+ *  \brief Restricted additive Schwarz preconditioner.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/linear_operator.h>
+#include <cusp/precond/ilu.h>
+
+#include <cuda_runtime_api.h>
+
+#include <vector>
+
+namespace cusp
+{
+namespace precond
+{
+
+/*! \addtogroup preconditioners Preconditioners
+ *  \ingroup preconditioners
+ *  \{
+ */
+
+/*! \p additive_schwarz : restricted additive Schwarz domain decomposition
+ *
+ *  The rows of \c A are split into consecutive blocks, the subdomains.
+ *  Each subdomain is extended by the rows within \p overlap steps of its
+ *  block in the graph of \c A.  A local preconditioner
+ *  \p LocalPreconditioner is built for the submatrix of \c A on those
+ *  rows, e.g. \p ilu0, \p scaled_bridson_ainv or
+ *  \p smoothed_aggregation.  It is constructed from a
+ *  <tt>cusp::csr_matrix<IndexType, ValueType, MemorySpace></tt>.
+ *
+ *  Applying the preconditioner restricts \c x to every extended
+ *  subdomain and applies its local preconditioner.  Only the rows of its
+ *  own block are written to \c y (restricted additive weighting), so the
+ *  subdomains are independent and the application needs neither a sum
+ *  over the overlaps nor any global reduction.  Without overlap the
+ *  preconditioner is block Jacobi with approximately inverted blocks.
+ *
+ *  In \c device_memory every subdomain is applied on a stream of its own,
+ *  which waits for the current stream (see \p cusp::scoped_stream) and
+ *  is waited for by it, so the subdomains run concurrently.  The local
+ *  preconditioners must issue their work on the current stream.
+ *
+ *  \tparam ValueType Type used for matrix values (e.g. \c float or \c double).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *  \tparam LocalPreconditioner Preconditioner of the subdomains,
+ *  \p ilu0 by default.
+ *  \tparam IndexType Type used for indices (e.g. \c int).
+ *
+ *  \code
+ *  #include <cusp/precond/additive_schwarz.h>
+ *  #include <cusp/precond/smoothed_aggregation.h>
+ *  #include <cusp/krylov/gmres.h>
+ *  ...
+ *
+ *  // 8 subdomains with one layer of overlap and ILU(0) on each
+ *  cusp::precond::additive_schwarz<float, cusp::device_memory> M(A, 8, 1);
+ *
+ *  cusp::krylov::gmres(A, x, b, 30, monitor, M);
+ *
+ *  // AMG on each subdomain
+ *  typedef cusp::precond::smoothed_aggregation<int, float, cusp::device_memory> AMG;
+ *  cusp::precond::additive_schwarz<float, cusp::device_memory, AMG> N(A, 4, 2);
+ *  \endcode
+ */
+template <typename ValueType, typename MemorySpace,
+          typename LocalPreconditioner = cusp::precond::ilu0<ValueType, MemorySpace>,
+          typename IndexType = int>
+class additive_schwarz : public linear_operator<ValueType, MemorySpace, IndexType>
+{
+    typedef linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+    struct subdomain
+    {
+        LocalPreconditioner * M;
+
+        // rows of A in the subdomain, in increasing order, and the part
+        // [local_begin, local_begin + num_owned) of them that lies in the
+        // block starting at row_begin
+        cusp::array1d<IndexType, MemorySpace> rows;
+        size_t row_begin;
+        size_t local_begin;
+        size_t num_owned;
+
+        // restriction of x and local correction
+        cusp::array1d<ValueType, MemorySpace> x;
+        cusp::array1d<ValueType, MemorySpace> y;
+
+        // device_memory only
+        cudaStream_t stream;
+        cudaEvent_t  done;
+    };
+
+    std::vector<subdomain *> subdomains;
+    size_t overlap;
+
+    cudaEvent_t ready; // x is available to the subdomain streams
+
+    template <typename MatrixType>
+    void setup(const MatrixType& A, const std::vector<size_t>& offsets);
+
+    void release(void);
+
+    // not copyable
+    additive_schwarz(const additive_schwarz&);
+    additive_schwarz& operator=(const additive_schwarz&);
+
+public:
+    /*! construct an \p additive_schwarz preconditioner with
+     *  \p num_subdomains blocks of about the same number of entries.
+     *
+     * \param A matrix to precondition
+     * \param num_subdomains number of subdomains
+     * \param overlap number of layers of rows added to each subdomain
+     * \tparam MatrixType matrix
+     */
+    template <typename MatrixType>
+    additive_schwarz(const MatrixType& A, size_t num_subdomains, size_t overlap = 0);
+
+    /*! construct an \p additive_schwarz preconditioner with the blocks
+     *  <tt>[offsets[k], offsets[k+1])</tt>.
+     *
+     * \param A matrix to precondition
+     * \param offsets increasing block offsets from 0 to \c A.num_rows
+     * \param overlap number of layers of rows added to each subdomain
+     * \tparam MatrixType matrix
+     *
+     *  \throws cusp::invalid_input_exception if the offsets do not
+     *  partition the rows of \p A.
+     */
+    template <typename MatrixType, typename OffsetType, typename OffsetSpace>
+    additive_schwarz(const MatrixType& A, const cusp::array1d<OffsetType, OffsetSpace>& offsets, size_t overlap = 0);
+
+    ~additive_schwarz(void);
+
+    /*! number of subdomains
+     */
+    size_t num_subdomains(void) const { return subdomains.size(); }
+
+    /*! number of rows of subdomain \p k, including the overlap
+     */
+    size_t subdomain_size(size_t k) const;
+
+    /*! local preconditioner of subdomain \p k
+     */
+    const LocalPreconditioner& local_preconditioner(size_t k) const;
+
+    /*! apply the preconditioner to vector \p x and store the result in \p y
+     *
+     * \param x input vector
+     * \param y ouput vector
+     * \tparam VectorType1 vector
+     * \tparam VectorType2 vector
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+};
+/*! \}
+ */
+
+} // end namespace precond
+} // end namespace cusp
+
+#include <cusp/precond/detail/additive_schwarz.inl>
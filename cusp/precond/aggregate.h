@@ -43,6 +43,26 @@ namespace precond
 	void standard_aggregation(const cusp::csr_matrix<IndexType,ValueType,cusp::host_memory>& C,
 					ArrayType& aggregates);
 
+namespace detail
+{
+	/*  Parallel pairwise aggregation (as in AGMG).  Every pass matches the
+	 *  nodes, then the aggregates of the previous pass, with their
+	 *  strongest neighbor by rounds of handshaking, so the aggregates hold
+	 *  at most 2^num_passes nodes.  Nodes without off-diagonal connections
+	 *  are left unaggregated (-1).
+	 */
+	template <typename Matrix, typename Array>
+	void pairwise_aggregation(const Matrix& C, Array& aggregates, const size_t num_passes = 2);
+
+	/*  Size-bounded MIS(2) aggregation.  The nodes of a distance-2 maximal
+	 *  independent set are roots, the other nodes join their strongest
+	 *  neighboring aggregate with fewer than max_aggregate_size nodes in
+	 *  parallel rounds.  max_aggregate_size = 0 does not bound the size.
+	 */
+	template <typename Matrix, typename Array>
+	void mis_aggregation(const Matrix& C, Array& aggregates, const size_t max_aggregate_size = 0);
+
+} // end namespace detail
 } // end namespace precond
 } // end namespace cusp
 
@@ -22,6 +22,7 @@
 
 #include <cusp/detail/config.h>
 
+#include <cusp/array1d.h>
 #include <cusp/linear_operator.h>
 #include <cusp/hyb_matrix.h>
 
@@ -48,14 +49,17 @@ namespace precond
  *  This preconditioner will only work for SPD matrices. 
  *
  */
-template <typename ValueType, typename MemorySpace>
-class scaled_bridson_ainv : public linear_operator<ValueType, MemorySpace>
+template <typename ValueType, typename MemorySpace, typename IndexType = int>
+class scaled_bridson_ainv : public linear_operator<ValueType, MemorySpace, IndexType>
 {       
-    typedef linear_operator<ValueType, MemorySpace> Parent;
+    typedef linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+    // intermediate product of the two factors, kept between applications
+    mutable cusp::array1d<ValueType, MemorySpace> temp;
 
 public:
-    cusp::hyb_matrix<int, ValueType, MemorySpace> w;
-    cusp::hyb_matrix<int, ValueType, MemorySpace> w_t;
+    cusp::hyb_matrix<IndexType, ValueType, MemorySpace> w;
+    cusp::hyb_matrix<IndexType, ValueType, MemorySpace> w_t;
 
     /*! construct a \p ainv preconditioner
      *
@@ -98,14 +102,17 @@ public:
  *  This preconditioner will only work for SPD matrices. 
  */
 
-template <typename ValueType, typename MemorySpace>
-class bridson_ainv : public linear_operator<ValueType, MemorySpace>
+template <typename ValueType, typename MemorySpace, typename IndexType = int>
+class bridson_ainv : public linear_operator<ValueType, MemorySpace, IndexType>
 {       
-    typedef linear_operator<ValueType, MemorySpace> Parent;
+    typedef linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+    // intermediate product of the two factors, kept between applications
+    mutable cusp::array1d<ValueType, MemorySpace> temp;
 
 public:
-    cusp::hyb_matrix<int, ValueType, MemorySpace> w;
-    cusp::hyb_matrix<int, ValueType, MemorySpace> w_t;
+    cusp::hyb_matrix<IndexType, ValueType, MemorySpace> w;
+    cusp::hyb_matrix<IndexType, ValueType, MemorySpace> w_t;
     cusp::array1d<ValueType, MemorySpace> diagonals;
 
     /*! construct a \p ainv preconditioner
@@ -145,14 +152,17 @@ public:
  *  are about the same, but build time is 2x higher.
  */
 
-template <typename ValueType, typename MemorySpace>
-class nonsym_bridson_ainv : public linear_operator<ValueType, MemorySpace>
+template <typename ValueType, typename MemorySpace, typename IndexType = int>
+class nonsym_bridson_ainv : public linear_operator<ValueType, MemorySpace, IndexType>
 {       
-    typedef linear_operator<ValueType, MemorySpace> Parent;
+    typedef linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+    // intermediate product of the two factors, kept between applications
+    mutable cusp::array1d<ValueType, MemorySpace> temp;
 
 public:
-    cusp::hyb_matrix<int, ValueType, MemorySpace> w_t;
-    cusp::hyb_matrix<int, ValueType, MemorySpace> z;
+    cusp::hyb_matrix<IndexType, ValueType, MemorySpace> w_t;
+    cusp::hyb_matrix<IndexType, ValueType, MemorySpace> z;
     cusp::array1d<ValueType, MemorySpace> diagonals;
 
     /*! construct a \p ainv preconditioner
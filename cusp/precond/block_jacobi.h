@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file block_jacobi.h
+ *  \brief Block diagonal preconditioner.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/linear_operator.h>
+
+namespace cusp
+{
+namespace precond
+{
+
+/*! \addtogroup preconditioners Preconditioners
+ *  \ingroup preconditioners
+ *  \{
+ */
+
+/*! \p block_jacobi : block diagonal preconditioner
+ *
+ *  Given a matrix \c A and a partition of its rows into consecutive
+ *  blocks, the block Jacobi preconditioner extracts the diagonal blocks
+ *  \c D_k of \c A, inverts them and implements <tt>y = D^-1 x</tt> for the
+ *  block diagonal matrix \c D.  For matrices with a block structure, e.g.
+ *  the degrees of freedom of a node in a \p bsr_matrix, it is considerably
+ *  stronger than the \p diagonal preconditioner at a similar cost.
+ *
+ *  The blocks are stored as dense matrices.  At setup every block is
+ *  factored and inverted by one thread with partial pivoting, and the
+ *  preconditioner is applied by one thread per row, hence the blocks are
+ *  meant to be small (say, up to 16 rows).
+ *
+ *  \tparam ValueType Type used for matrix values (e.g. \c float or \c double).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *  \tparam IndexType Type used for indices (e.g. \c int).
+ *
+ *  \code
+ *  #include <cusp/precond/block_jacobi.h>
+ *  ...
+ *
+ *  // A is a bsr_matrix with 3x3 blocks
+ *  cusp::precond::block_jacobi<float, cusp::device_memory> M(A, A.block_size);
+ *
+ *  // solve
+ *  cusp::krylov::gmres(A, x, b, 30, monitor, M);
+ *  \endcode
+ *
+ *  \throws cusp::runtime_exception at setup if a diagonal block is singular.
+ */
+template <typename ValueType, typename MemorySpace, typename IndexType = int>
+class block_jacobi : public linear_operator<ValueType, MemorySpace, IndexType>
+{
+    typedef linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+    cusp::array1d<IndexType, MemorySpace> block_offsets;  // first row of each block
+    cusp::array1d<IndexType, MemorySpace> value_offsets;  // first value of each block
+    cusp::array1d<IndexType, MemorySpace> row_blocks;     // block of each row
+    cusp::array1d<ValueType, MemorySpace> inverses;       // row-major inverse blocks
+    size_t block_size;                                    // rows of all but the last block, or 0
+
+    template <typename MatrixType, typename ArrayType>
+    void setup(const MatrixType& A, const ArrayType& offsets);
+
+public:
+    /*! construct a \p block_jacobi preconditioner with blocks of
+     *  \p block_size rows, the last block possibly smaller.
+     *
+     * \param A matrix to precondition
+     * \param block_size number of rows of the blocks
+     * \tparam MatrixType matrix
+     */
+    template <typename MatrixType>
+    block_jacobi(const MatrixType& A, size_t block_size);
+
+    /*! construct a \p block_jacobi preconditioner with variable blocks,
+     *  block \c k holding the rows <tt>[offsets[k], offsets[k+1])</tt>.
+     *
+     * \param A matrix to precondition
+     * \param offsets increasing block offsets from 0 to \c A.num_rows
+     * \tparam MatrixType matrix
+     *
+     *  \throws cusp::invalid_input_exception if the offsets do not
+     *  partition the rows of \p A.
+     */
+    template <typename MatrixType, typename OffsetType, typename OffsetSpace>
+    block_jacobi(const MatrixType& A, const cusp::array1d<OffsetType, OffsetSpace>& offsets);
+
+    /*! number of diagonal blocks
+     */
+    size_t num_blocks(void) const { return block_offsets.empty() ? 0 : block_offsets.size() - 1; }
+
+    /*! apply the preconditioner to vector \p x and store the result in \p y
+     *
+     * \param x input vector
+     * \param y ouput vector
+     * \tparam VectorType1 vector
+     * \tparam VectorType2 vector
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+};
+/*! \}
+ */
+
+} // end namespace precond
+} // end namespace cusp
+
+#include <cusp/precond/detail/block_jacobi.inl>
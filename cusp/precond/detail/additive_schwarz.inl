@@ -0,0 +1,358 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+
+/*! \file additive_schwarz.inl
+ *  \brief Inline file for additive_schwarz.h
+ */
+
+#include <cusp/copy.h>
+#include <cusp/exception.h>
+#include <cusp/stream.h>
+
+#include <cusp/detail/scoped_device.h>
+#include <cusp/detail/stream.h>
+
+#include <thrust/detail/type_traits.h>
+#include <thrust/iterator/permutation_iterator.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace cusp
+{
+namespace precond
+{
+namespace detail
+{
+
+template <typename MemorySpace>
+struct additive_schwarz_streams
+    : thrust::detail::integral_constant<bool, thrust::detail::is_same<MemorySpace, cusp::device_memory>::value> {};
+
+// Rows within overlap steps of the rows [row_begin, row_end) in the graph
+// of A, in increasing order.  mark[i] == stamp flags the rows that were
+// found; it is reused between the subdomains.
+template <typename IndexType, typename ValueType>
+void additive_schwarz_extend(const cusp::csr_matrix<IndexType, ValueType, cusp::host_memory>& A,
+                             const size_t row_begin, const size_t row_end, const size_t overlap,
+                             const size_t stamp, std::vector<size_t>& mark, std::vector<IndexType>& rows)
+{
+    rows.clear();
+
+    for (size_t i = row_begin; i < row_end; i++)
+    {
+        mark[i] = stamp;
+        rows.push_back(IndexType(i));
+    }
+
+    // breadth first search, one level per layer of overlap
+    size_t level_begin = 0;
+
+    for (size_t level = 0; level < overlap; level++)
+    {
+        const size_t level_end = rows.size();
+
+        for (size_t n = level_begin; n < level_end; n++)
+        {
+            const IndexType i = rows[n];
+
+            for (IndexType jj = A.row_offsets[i]; jj < A.row_offsets[i + 1]; jj++)
+            {
+                const IndexType j = A.column_indices[jj];
+
+                if (mark[j] != stamp)
+                {
+                    mark[j] = stamp;
+                    rows.push_back(j);
+                }
+            }
+        }
+
+        if (level_end == rows.size())
+            break;
+
+        level_begin = level_end;
+    }
+
+    std::sort(rows.begin(), rows.end());
+}
+
+// A(rows, rows) for the rows marked with stamp, local[i] is the position
+// of row i in rows.  The numbering is increasing, so the columns of the
+// block are sorted when those of A are.
+template <typename IndexType, typename ValueType>
+void additive_schwarz_extract(const cusp::csr_matrix<IndexType, ValueType, cusp::host_memory>& A,
+                              const std::vector<IndexType>& rows, const size_t stamp,
+                              const std::vector<size_t>& mark, std::vector<IndexType>& local,
+                              cusp::csr_matrix<IndexType, ValueType, cusp::host_memory>& block)
+{
+    const size_t n = rows.size();
+
+    for (size_t k = 0; k < n; k++)
+        local[rows[k]] = IndexType(k);
+
+    size_t num_entries = 0;
+
+    for (size_t k = 0; k < n; k++)
+        for (IndexType jj = A.row_offsets[rows[k]]; jj < A.row_offsets[rows[k] + 1]; jj++)
+            if (mark[A.column_indices[jj]] == stamp)
+                num_entries++;
+
+    block.resize(n, n, num_entries);
+
+    size_t nnz = 0;
+    block.row_offsets[0] = 0;
+
+    for (size_t k = 0; k < n; k++)
+    {
+        for (IndexType jj = A.row_offsets[rows[k]]; jj < A.row_offsets[rows[k] + 1]; jj++)
+        {
+            const IndexType j = A.column_indices[jj];
+
+            if (mark[j] == stamp)
+            {
+                block.column_indices[nnz] = local[j];
+                block.values[nnz]         = A.values[jj];
+                nnz++;
+            }
+        }
+
+        block.row_offsets[k + 1] = IndexType(nnz);
+    }
+}
+
+} // end namespace detail
+
+
+// constructors
+template <typename ValueType, typename MemorySpace, typename LocalPreconditioner, typename IndexType>
+    template <typename MatrixType>
+    additive_schwarz<ValueType,MemorySpace,LocalPreconditioner,IndexType>
+    ::additive_schwarz(const MatrixType& A, size_t num_subdomains, size_t overlap)
+        : Parent(A.num_rows, A.num_cols, 0), overlap(overlap), ready(0)
+    {
+        if (num_subdomains == 0)
+            throw cusp::invalid_input_exception("number of subdomains must be positive");
+
+        const cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> B(A);
+
+        num_subdomains = std::max<size_t>(1, std::min<size_t>(num_subdomains, B.num_rows));
+
+        // split the rows into blocks with about the same number of entries
+        std::vector<size_t> offsets(num_subdomains + 1, 0);
+        offsets[num_subdomains] = B.num_rows;
+
+        for (size_t k = 1; k < num_subdomains; k++)
+        {
+            if (B.num_entries == 0)
+            {
+                offsets[k] = (k * B.num_rows) / num_subdomains;
+            }
+            else
+            {
+                const IndexType target = IndexType((k * B.num_entries) / num_subdomains);
+                offsets[k] = std::lower_bound(B.row_offsets.begin(), B.row_offsets.end(), target) - B.row_offsets.begin();
+            }
+
+            // blocks are never empty
+            offsets[k] = std::min<size_t>(std::max<size_t>(offsets[k], offsets[k - 1] + 1), B.num_rows - (num_subdomains - k));
+        }
+
+        setup(B, offsets);
+    }
+
+template <typename ValueType, typename MemorySpace, typename LocalPreconditioner, typename IndexType>
+    template <typename MatrixType, typename OffsetType, typename OffsetSpace>
+    additive_schwarz<ValueType,MemorySpace,LocalPreconditioner,IndexType>
+    ::additive_schwarz(const MatrixType& A, const cusp::array1d<OffsetType, OffsetSpace>& offsets, size_t overlap)
+        : Parent(A.num_rows, A.num_cols, 0), overlap(overlap), ready(0)
+    {
+        const cusp::array1d<OffsetType,cusp::host_memory> h_offsets(offsets);
+
+        if (h_offsets.size() < 2 || h_offsets[0] != 0 || size_t(h_offsets.back()) != A.num_rows)
+            throw cusp::invalid_input_exception("subdomain offsets must range from 0 to the number of rows");
+
+        for (size_t k = 0; k + 1 < h_offsets.size(); k++)
+            if (h_offsets[k + 1] <= h_offsets[k])
+                throw cusp::invalid_input_exception("subdomain offsets must be increasing");
+
+        setup(cusp::csr_matrix<IndexType,ValueType,cusp::host_memory>(A),
+              std::vector<size_t>(h_offsets.begin(), h_offsets.end()));
+    }
+
+template <typename ValueType, typename MemorySpace, typename LocalPreconditioner, typename IndexType>
+    additive_schwarz<ValueType,MemorySpace,LocalPreconditioner,IndexType>
+    ::~additive_schwarz(void)
+    {
+        release();
+    }
+
+template <typename ValueType, typename MemorySpace, typename LocalPreconditioner, typename IndexType>
+    template <typename MatrixType>
+    void additive_schwarz<ValueType,MemorySpace,LocalPreconditioner,IndexType>
+    ::setup(const MatrixType& A, const std::vector<size_t>& offsets)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (A.num_rows != A.num_cols)
+            throw cusp::invalid_input_exception("matrix must be square");
+
+        const bool streams = detail::additive_schwarz_streams<MemorySpace>::value;
+        const size_t num_subdomains = offsets.size() - 1;
+
+        // row marks and local numbering, shared by the subdomains
+        std::vector<size_t>    mark(A.num_rows, num_subdomains);
+        std::vector<IndexType> local(A.num_rows);
+        std::vector<IndexType> rows;
+
+        try
+        {
+            if (streams)
+                cusp::detail::check_cuda(cudaEventCreateWithFlags(&ready, cudaEventDisableTiming), "cudaEventCreate failed");
+
+            for (size_t k = 0; k < num_subdomains; k++)
+            {
+                subdomain * s = new subdomain;
+                s->M      = 0;
+                s->stream = 0;
+                s->done   = 0;
+                subdomains.push_back(s);
+
+                detail::additive_schwarz_extend(A, offsets[k], offsets[k + 1], overlap, k, mark, rows);
+
+                s->rows        = cusp::array1d<IndexType,cusp::host_memory>(rows.begin(), rows.end());
+                s->row_begin   = offsets[k];
+                s->local_begin = std::lower_bound(rows.begin(), rows.end(), IndexType(offsets[k])) - rows.begin();
+                s->num_owned   = offsets[k + 1] - offsets[k];
+
+                s->x.resize(rows.size());
+                s->y.resize(rows.size());
+
+                {
+                    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> block;
+                    detail::additive_schwarz_extract(A, rows, k, mark, local, block);
+
+                    const cusp::csr_matrix<IndexType,ValueType,MemorySpace> local_block(block);
+                    s->M = new LocalPreconditioner(local_block);
+
+                    Parent::num_entries += block.num_entries;
+                }
+
+                if (streams)
+                {
+                    cusp::detail::check_cuda(cudaStreamCreateWithFlags(&s->stream, cudaStreamNonBlocking), "cudaStreamCreate failed");
+                    cusp::detail::check_cuda(cudaEventCreateWithFlags(&s->done, cudaEventDisableTiming), "cudaEventCreate failed");
+                }
+            }
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+template <typename ValueType, typename MemorySpace, typename LocalPreconditioner, typename IndexType>
+    void additive_schwarz<ValueType,MemorySpace,LocalPreconditioner,IndexType>
+    ::release(void)
+    {
+        for (size_t k = 0; k < subdomains.size(); k++)
+        {
+            subdomain * s = subdomains[k];
+
+            if (s->stream != 0)
+                cudaStreamDestroy(s->stream);
+            if (s->done != 0)
+                cudaEventDestroy(s->done);
+
+            delete s->M;
+            delete s;
+        }
+
+        subdomains.clear();
+
+        if (ready != 0)
+        {
+            cudaEventDestroy(ready);
+            ready = 0;
+        }
+    }
+
+template <typename ValueType, typename MemorySpace, typename LocalPreconditioner, typename IndexType>
+    size_t additive_schwarz<ValueType,MemorySpace,LocalPreconditioner,IndexType>
+    ::subdomain_size(size_t k) const
+    {
+        return subdomains.at(k)->rows.size();
+    }
+
+template <typename ValueType, typename MemorySpace, typename LocalPreconditioner, typename IndexType>
+    const LocalPreconditioner& additive_schwarz<ValueType,MemorySpace,LocalPreconditioner,IndexType>
+    ::local_preconditioner(size_t k) const
+    {
+        return *subdomains.at(k)->M;
+    }
+
+// linear operator
+template <typename ValueType, typename MemorySpace, typename LocalPreconditioner, typename IndexType>
+    template <typename VectorType1, typename VectorType2>
+    void additive_schwarz<ValueType,MemorySpace,LocalPreconditioner,IndexType>
+    ::operator()(const VectorType1& x, VectorType2& y) const
+    {
+        CUSP_PROFILE_SCOPED();
+
+        const bool streams = detail::additive_schwarz_streams<MemorySpace>::value;
+        const cudaStream_t caller = cusp::detail::current_stream();
+
+        // the subdomains start once x is ready on the caller's stream
+        if (streams)
+            cudaEventRecord(ready, caller);
+
+        for (size_t k = 0; k < subdomains.size(); k++)
+        {
+            subdomain& s = *subdomains[k];
+
+            if (streams)
+                cudaStreamWaitEvent(s.stream, ready, 0);
+
+            cusp::scoped_stream scope(streams ? s.stream : caller);
+
+            // x_k <- R_k x
+            cusp::detail::streamed::copy(thrust::make_permutation_iterator(x.begin(), s.rows.begin()),
+                                         thrust::make_permutation_iterator(x.begin(), s.rows.end()),
+                                         s.x.begin());
+
+            (*s.M)(s.x, s.y);
+
+            // only the rows of the block are kept, so the blocks of y are
+            // written by one subdomain each
+            cusp::detail::streamed::copy(s.y.begin() + s.local_begin,
+                                         s.y.begin() + (s.local_begin + s.num_owned),
+                                         y.begin() + s.row_begin);
+
+            if (streams)
+                cudaEventRecord(s.done, s.stream);
+        }
+
+        // y is complete once every subdomain is done
+        if (streams)
+            for (size_t k = 0; k < subdomains.size(); k++)
+                cudaStreamWaitEvent(caller, subdomains[k]->done, 0);
+    }
+
+} // end namespace precond
+} // end namespace cusp
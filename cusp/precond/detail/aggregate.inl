@@ -15,13 +15,23 @@
  */
 
 #include <cusp/coo_matrix.h>
+#include <cusp/complex.h>
+#include <cusp/copy.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/detail/format_utils.h>
 #include <cusp/graph/maximal_independent_set.h>
 #include <cusp/detail/device/generalized_spmv/coo_flat.h>
 
 #include <thrust/count.h>
+#include <thrust/extrema.h>
 #include <thrust/fill.h>
+#include <thrust/for_each.h>
 #include <thrust/scan.h>
 #include <thrust/gather.h>
+#include <thrust/reduce.h>
+#include <thrust/remove.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
 #include <thrust/transform.h>
 #include <thrust/iterator/zip_iterator.h>
 #include <thrust/iterator/constant_iterator.h>
@@ -266,6 +276,789 @@ void standard_aggregation(const Matrix& C,
     standard_aggregation(C, aggregates, typename Matrix::format(), typename Matrix::memory_space());
 }
 
+/////////////////////////////////
+// Pairwise and MIS aggregation //
+/////////////////////////////////
+
+// Node states of the parallel aggregations
+//   pairwise : partner[i] >= 0 matched, -1 unmatched, -2 isolated
+//   mis      : aggregates[i] >= 0 aggregated, -1 isolated, -2 unassigned
+
+// pseudorandom priority of the edge (a,b), a < b
+template <typename IndexType>
+__host__ __device__
+unsigned int edge_priority(const IndexType a, const IndexType b)
+{
+    unsigned int h = (unsigned int) a * 2654435761u ^ (unsigned int) b * 2246822519u;
+
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+
+    return h;
+}
+
+// Edges (a,b) with a < b are ordered by weight, then by a pseudorandom
+// priority and by their indices, so that both endpoints of an edge rank
+// it identically.  Without the priority, ties on uniform weights would
+// be broken by index and matching would advance as a single wavefront.
+template <typename WeightType, typename IndexType>
+__host__ __device__
+bool stronger_edge(const WeightType w1, const IndexType a1, const IndexType b1,
+                   const WeightType w2, const IndexType a2, const IndexType b2)
+{
+    if (w1 != w2) return w1 > w2;
+
+    const unsigned int p1 = edge_priority(a1, b1);
+    const unsigned int p2 = edge_priority(a2, b2);
+
+    if (p1 != p2) return p1 > p2;
+    if (a1 != a2) return a1 < a2;
+    return b1 < b2;
+}
+
+template <typename ValueType>
+struct aggregation_weight
+{
+    typedef typename cusp::norm_type<ValueType>::type WeightType;
+
+    __host__ __device__
+    WeightType operator()(const ValueType& v) const
+    {
+        return cusp::abs(v);
+    }
+};
+
+// a node without off-diagonal connections is left unaggregated (-1),
+// as in standard_aggregation
+template <typename IndexType>
+struct aggregation_isolated_functor
+{
+    const IndexType * Ap;
+    const IndexType * Aj;
+          IndexType * state;
+    IndexType isolated;
+    IndexType free;
+
+    aggregation_isolated_functor(const IndexType * Ap, const IndexType * Aj, IndexType * state,
+                                 const IndexType isolated, const IndexType free)
+        : Ap(Ap), Aj(Aj), state(state), isolated(isolated), free(free) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType s = isolated;
+
+        for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+            if (Aj[jj] != i)
+                s = free;
+
+        state[i] = s;
+    }
+};
+
+// choice[i] <- strongest unmatched neighbor of an unmatched node i
+template <typename IndexType, typename WeightType>
+struct pairwise_choose_functor
+{
+    const IndexType  * Ap;
+    const IndexType  * Aj;
+    const WeightType * Aw;
+    const IndexType  * partner;
+          IndexType  * choice;
+
+    pairwise_choose_functor(const IndexType * Ap, const IndexType * Aj, const WeightType * Aw,
+                            const IndexType * partner, IndexType * choice)
+        : Ap(Ap), Aj(Aj), Aw(Aw), partner(partner), choice(choice) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType  best   = -1;
+        WeightType best_w = 0;
+
+        if (partner[i] == -1)
+        {
+            for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+            {
+                const IndexType j = Aj[jj];
+
+                if (j == i || partner[j] != -1)
+                    continue;
+
+                const WeightType w = Aw[jj];
+
+                if (best == -1 ||
+                    stronger_edge(w,      thrust::min(i, j),    thrust::max(i, j),
+                                  best_w, thrust::min(i, best), thrust::max(i, best)))
+                {
+                    best   = j;
+                    best_w = w;
+                }
+            }
+        }
+
+        choice[i] = best;
+    }
+};
+
+// i and j are matched when they chose each other
+template <typename IndexType>
+struct pairwise_match_functor
+{
+    const IndexType * choice;
+          IndexType * partner;
+
+    pairwise_match_functor(const IndexType * choice, IndexType * partner)
+        : choice(choice), partner(partner) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        const IndexType j = choice[i];
+
+        if (j != -1 && choice[j] == i)
+            partner[i] = j;
+    }
+};
+
+// the lower node of a pair, or an unmatched node, represents an aggregate
+template <typename IndexType>
+struct pairwise_representative
+{
+    const IndexType * partner;
+
+    pairwise_representative(const IndexType * partner) : partner(partner) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType i) const
+    {
+        const IndexType p = partner[i];
+        return (p != -2 && (p < 0 || i < p)) ? 1 : 0;
+    }
+};
+
+template <typename IndexType>
+struct pairwise_number_functor
+{
+    const IndexType * partner;
+    const IndexType * ids;
+          IndexType * aggregates;
+
+    pairwise_number_functor(const IndexType * partner, const IndexType * ids, IndexType * aggregates)
+        : partner(partner), ids(ids), aggregates(aggregates) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        const IndexType p = partner[i];
+
+        if (p == -2)
+            aggregates[i] = -1;
+        else
+            aggregates[i] = ids[p < 0 ? i : thrust::min(i, p)];
+    }
+};
+
+template <typename IndexType>
+struct is_matched
+{
+    __host__ __device__
+    bool operator()(const IndexType p) const
+    {
+        return p >= 0;
+    }
+};
+
+template <typename IndexType>
+struct is_self_or_unaggregated
+{
+    template <typename Tuple>
+    __host__ __device__
+    bool operator()(const Tuple& t) const
+    {
+        const IndexType a = thrust::get<0>(t);
+        const IndexType b = thrust::get<1>(t);
+        return a < 0 || b < 0 || a == b;
+    }
+};
+
+// Match the nodes of the graph (Ap, Aj, Aw) in pairs by rounds of
+// handshaking: every unmatched node chooses its strongest unmatched
+// neighbor and mutual choices are matched.  The strongest remaining edge
+// is always mutual, so each round makes progress, and nodes that are
+// still unmatched after max_rounds remain singletons.  Returns the number of
+// aggregates (pairs and unmatched nodes).
+template <typename Array1, typename Array2, typename Array3, typename Array4>
+size_t pairwise_match(const size_t num_rows,
+                      const Array1& Ap, const Array2& Aj, const Array3& Aw,
+                      Array4& aggregates, const bool exclude_isolated)
+{
+    typedef typename Array4::value_type   IndexType;
+    typedef typename Array4::memory_space MemorySpace;
+
+    const size_t max_rounds = 8;
+
+    aggregates.resize(num_rows);
+
+    if (num_rows == 0)
+        return 0;
+
+    const IndexType  * Ap_ptr = thrust::raw_pointer_cast(&Ap[0]);
+    const IndexType  * Aj_ptr = Aj.empty() ? 0 : thrust::raw_pointer_cast(&Aj[0]);
+    const typename Array3::value_type * Aw_ptr = Aw.empty() ? 0 : thrust::raw_pointer_cast(&Aw[0]);
+
+    cusp::array1d<IndexType,MemorySpace> partner(num_rows);
+    cusp::array1d<IndexType,MemorySpace> choice(num_rows);
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     aggregation_isolated_functor<IndexType>(Ap_ptr, Aj_ptr, thrust::raw_pointer_cast(&partner[0]),
+                                                             exclude_isolated ? IndexType(-2) : IndexType(-1), IndexType(-1)));
+
+    size_t num_matched = 0;
+
+    for (size_t round = 0; round < max_rounds; round++)
+    {
+        thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                         thrust::counting_iterator<IndexType>(num_rows),
+                         pairwise_choose_functor<IndexType,typename Array3::value_type>
+                            (Ap_ptr, Aj_ptr, Aw_ptr, thrust::raw_pointer_cast(&partner[0]), thrust::raw_pointer_cast(&choice[0])));
+
+        thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                         thrust::counting_iterator<IndexType>(num_rows),
+                         pairwise_match_functor<IndexType>(thrust::raw_pointer_cast(&choice[0]), thrust::raw_pointer_cast(&partner[0])));
+
+        const size_t matched = thrust::count_if(partner.begin(), partner.end(), is_matched<IndexType>());
+
+        if (matched == num_matched)
+            break;
+
+        num_matched = matched;
+    }
+
+    // number the aggregates by their representatives
+    cusp::array1d<IndexType,MemorySpace> ids(num_rows);
+    thrust::transform(thrust::counting_iterator<IndexType>(0),
+                      thrust::counting_iterator<IndexType>(num_rows),
+                      ids.begin(),
+                      pairwise_representative<IndexType>(thrust::raw_pointer_cast(&partner[0])));
+
+    const IndexType last = ids[num_rows - 1];
+    thrust::exclusive_scan(ids.begin(), ids.end(), ids.begin());
+    const size_t num_aggregates = ids[num_rows - 1] + last;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     pairwise_number_functor<IndexType>(thrust::raw_pointer_cast(&partner[0]),
+                                                        thrust::raw_pointer_cast(&ids[0]),
+                                                        thrust::raw_pointer_cast(&aggregates[0])));
+
+    return num_aggregates;
+}
+
+// Graph of the aggregates, whose edge (a,b) sums the weights of the edges
+// between the nodes of a and the nodes of b.
+template <typename Array1, typename Array2, typename Array3, typename Array4,
+          typename Array5, typename Array6, typename Array7>
+void aggregate_graph(const Array1& Ap, const Array2& Aj, const Array3& Aw,
+                     const Array4& aggregates, const size_t num_aggregates,
+                     Array5& Gp, Array6& Gj, Array7& Gw)
+{
+    typedef typename Array2::value_type   IndexType;
+    typedef typename Array3::value_type   WeightType;
+    typedef typename Array2::memory_space MemorySpace;
+
+    const size_t num_entries = Aj.size();
+
+    cusp::array1d<IndexType,MemorySpace> rows(num_entries);
+    cusp::detail::offsets_to_indices(Ap, rows);
+
+    cusp::array1d<IndexType,MemorySpace>  I(num_entries);
+    cusp::array1d<IndexType,MemorySpace>  J(num_entries);
+    cusp::array1d<WeightType,MemorySpace> W(Aw);
+
+    thrust::gather(rows.begin(), rows.end(), aggregates.begin(), I.begin());
+    thrust::gather(Aj.begin(),   Aj.end(),   aggregates.begin(), J.begin());
+
+    const size_t num_edges =
+        thrust::remove_if(thrust::make_zip_iterator(thrust::make_tuple(I.begin(), J.begin(), W.begin())),
+                          thrust::make_zip_iterator(thrust::make_tuple(I.end(),   J.end(),   W.end())),
+                          is_self_or_unaggregated<IndexType>())
+        - thrust::make_zip_iterator(thrust::make_tuple(I.begin(), J.begin(), W.begin()));
+
+    I.resize(num_edges);
+    J.resize(num_edges);
+    W.resize(num_edges);
+
+    cusp::detail::sort_by_row_and_column(I, J, W, num_aggregates, num_aggregates);
+
+    cusp::array1d<IndexType,MemorySpace> GI(num_edges);
+    Gj.resize(num_edges);
+    Gw.resize(num_edges);
+
+    const size_t num_coarse_edges =
+        thrust::reduce_by_key(thrust::make_zip_iterator(thrust::make_tuple(I.begin(), J.begin())),
+                              thrust::make_zip_iterator(thrust::make_tuple(I.end(),   J.end())),
+                              W.begin(),
+                              thrust::make_zip_iterator(thrust::make_tuple(GI.begin(), Gj.begin())),
+                              Gw.begin()).second - Gw.begin();
+
+    GI.resize(num_coarse_edges);
+    Gj.resize(num_coarse_edges);
+    Gw.resize(num_coarse_edges);
+
+    Gp.resize(num_aggregates + 1);
+    cusp::detail::indices_to_offsets(GI, Gp);
+}
+
+template <typename IndexType>
+struct compose_aggregates
+{
+    const IndexType * coarse;
+
+    compose_aggregates(const IndexType * coarse) : coarse(coarse) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType a) const
+    {
+        return a < 0 ? a : coarse[a];
+    }
+};
+
+// Pairwise aggregation of the graph (Ap, Aj, Aw) (Notay, AGMG): the
+// first pass matches nodes, every further pass matches the aggregates of
+// the previous one through their graph, so that num_passes passes yield
+// aggregates of at most 2^num_passes nodes.
+template <typename Array1, typename Array2, typename Array3, typename Array4>
+size_t pairwise_aggregation(const size_t num_rows,
+                            const Array1& Ap, const Array2& Aj, const Array3& Aw,
+                            Array4& aggregates, const size_t num_passes)
+{
+    typedef typename Array4::value_type   IndexType;
+    typedef typename Array3::value_type   WeightType;
+    typedef typename Array4::memory_space MemorySpace;
+
+    size_t num_aggregates = pairwise_match(num_rows, Ap, Aj, Aw, aggregates, true);
+
+    cusp::array1d<IndexType,MemorySpace>  node_aggregates(aggregates);
+    cusp::array1d<IndexType,MemorySpace>  Gp;
+    cusp::array1d<IndexType,MemorySpace>  Gj;
+    cusp::array1d<WeightType,MemorySpace> Gw;
+
+    for (size_t pass = 1; pass < num_passes && num_aggregates > 1; pass++)
+    {
+        cusp::array1d<IndexType,MemorySpace>  Hp;
+        cusp::array1d<IndexType,MemorySpace>  Hj;
+        cusp::array1d<WeightType,MemorySpace> Hw;
+
+        if (pass == 1)
+            aggregate_graph(Ap, Aj, Aw, node_aggregates, num_aggregates, Hp, Hj, Hw);
+        else
+            aggregate_graph(Gp, Gj, Gw, node_aggregates, num_aggregates, Hp, Hj, Hw);
+
+        cusp::array1d<IndexType,MemorySpace> coarse_aggregates;
+        const size_t num_coarse = pairwise_match(num_aggregates, Hp, Hj, Hw, coarse_aggregates, false);
+
+        if (num_coarse == num_aggregates)
+            break;
+
+        thrust::transform(aggregates.begin(), aggregates.end(), aggregates.begin(),
+                          compose_aggregates<IndexType>(thrust::raw_pointer_cast(&coarse_aggregates[0])));
+
+        node_aggregates.swap(coarse_aggregates);
+        Gp.swap(Hp);
+        Gj.swap(Hj);
+        Gw.swap(Hw);
+
+        num_aggregates = num_coarse;
+    }
+
+    return num_aggregates;
+}
+
+// request[i] <- strongest neighboring aggregate of an unassigned node i
+// that has room for another node, or -1
+template <typename IndexType, typename WeightType>
+struct mis_join_functor
+{
+    const IndexType  * Ap;
+    const IndexType  * Aj;
+    const WeightType * Aw;
+    const IndexType  * aggregates;
+    const IndexType  * sizes;
+          IndexType  * request;
+    IndexType max_size;
+
+    mis_join_functor(const IndexType * Ap, const IndexType * Aj, const WeightType * Aw,
+                     const IndexType * aggregates, const IndexType * sizes, IndexType * request,
+                     const IndexType max_size)
+        : Ap(Ap), Aj(Aj), Aw(Aw), aggregates(aggregates), sizes(sizes), request(request), max_size(max_size) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType  best   = -1;
+        WeightType best_w = 0;
+
+        if (aggregates[i] == -2)
+        {
+            for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+            {
+                const IndexType a = aggregates[Aj[jj]];
+
+                if (a < 0 || sizes[a] >= max_size)
+                    continue;
+
+                const WeightType w = Aw[jj];
+
+                if (best == -1 || w > best_w || (w == best_w && a < best))
+                {
+                    best   = a;
+                    best_w = w;
+                }
+            }
+        }
+
+        request[i] = best;
+    }
+};
+
+// The requests are sorted by aggregate and ranked within each aggregate,
+// an aggregate accepts the requests that fit below max_size.
+template <typename IndexType>
+struct mis_accept_functor
+{
+    const IndexType * keys;
+    const IndexType * nodes;
+    const IndexType * ranks;
+    const IndexType * sizes;
+          IndexType * aggregates;
+    IndexType max_size;
+
+    mis_accept_functor(const IndexType * keys, const IndexType * nodes, const IndexType * ranks,
+                       const IndexType * sizes, IndexType * aggregates, const IndexType max_size)
+        : keys(keys), nodes(nodes), ranks(ranks), sizes(sizes), aggregates(aggregates), max_size(max_size) {}
+
+    __host__ __device__
+    void operator()(const IndexType k) const
+    {
+        const IndexType a = keys[k];
+
+        if (a >= 0 && sizes[a] + ranks[k] < max_size)
+            aggregates[nodes[k]] = a;
+    }
+};
+
+// the last request of each aggregate updates its size
+template <typename IndexType>
+struct mis_size_functor
+{
+    const IndexType * keys;
+    const IndexType * ranks;
+          IndexType * sizes;
+    IndexType num_requests;
+    IndexType max_size;
+
+    mis_size_functor(const IndexType * keys, const IndexType * ranks, IndexType * sizes,
+                     const IndexType num_requests, const IndexType max_size)
+        : keys(keys), ranks(ranks), sizes(sizes), num_requests(num_requests), max_size(max_size) {}
+
+    __host__ __device__
+    void operator()(const IndexType k) const
+    {
+        const IndexType a = keys[k];
+
+        if (a >= 0 && (k + 1 == num_requests || keys[k + 1] != a))
+            sizes[a] = thrust::min(max_size, sizes[a] + ranks[k] + 1);
+    }
+};
+
+// an unassigned node without a lower unassigned neighbor starts a new
+// aggregate, the lowest unassigned node always does
+template <typename IndexType>
+struct mis_promote_functor
+{
+    const IndexType * Ap;
+    const IndexType * Aj;
+    const IndexType * aggregates;
+          IndexType * flags;
+
+    mis_promote_functor(const IndexType * Ap, const IndexType * Aj, const IndexType * aggregates, IndexType * flags)
+        : Ap(Ap), Aj(Aj), aggregates(aggregates), flags(flags) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType flag = aggregates[i] == -2 ? 1 : 0;
+
+        for (IndexType jj = Ap[i]; flag && jj < Ap[i + 1]; jj++)
+        {
+            const IndexType j = Aj[jj];
+
+            if (j < i && aggregates[j] == -2)
+                flag = 0;
+        }
+
+        flags[i] = flag;
+    }
+};
+
+template <typename IndexType>
+struct mis_root_functor
+{
+    const IndexType * flags;
+    const IndexType * ids;
+          IndexType * aggregates;
+    IndexType offset;
+
+    mis_root_functor(const IndexType * flags, const IndexType * ids, IndexType * aggregates, const IndexType offset)
+        : flags(flags), ids(ids), aggregates(aggregates), offset(offset) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        if (flags[i])
+            aggregates[i] = offset + ids[i];
+    }
+};
+
+// a node of the MIS starts an aggregate unless it is isolated
+template <typename IndexType>
+struct mis_root_flag
+{
+    template <typename T>
+    __host__ __device__
+    IndexType operator()(const T in_mis, const IndexType aggregate) const
+    {
+        return (in_mis && aggregate == -2) ? 1 : 0;
+    }
+};
+
+template <typename IndexType>
+struct is_unassigned
+{
+    __host__ __device__
+    bool operator()(const IndexType a) const
+    {
+        return a == -2;
+    }
+};
+
+// Size-bounded MIS(2) aggregation: the nodes of a distance-2 maximal
+// independent set become roots and the remaining nodes join their
+// strongest neighboring aggregate, at most max_size nodes each, in
+// parallel rounds.  When a round places no node, unassigned local minima
+// are promoted to new roots.  max_size = 0 does not bound the aggregates.
+template <typename Matrix, typename Array1, typename Array2, typename Array3, typename Array4>
+size_t mis_aggregation(const Matrix& C,
+                       const Array1& Ap, const Array2& Aj, const Array3& Aw,
+                       Array4& aggregates, const size_t max_aggregate_size)
+{
+    typedef typename Array4::value_type   IndexType;
+    typedef typename Array3::value_type   WeightType;
+    typedef typename Array4::memory_space MemorySpace;
+
+    const size_t num_rows = C.num_rows;
+    const IndexType max_size = max_aggregate_size == 0 ? IndexType(num_rows) : IndexType(max_aggregate_size);
+
+    aggregates.resize(num_rows);
+
+    if (num_rows == 0)
+        return 0;
+
+    const IndexType  * Ap_ptr = thrust::raw_pointer_cast(&Ap[0]);
+    const IndexType  * Aj_ptr = Aj.empty() ? 0 : thrust::raw_pointer_cast(&Aj[0]);
+    const WeightType * Aw_ptr = Aw.empty() ? 0 : thrust::raw_pointer_cast(&Aw[0]);
+          IndexType  * agg_ptr = thrust::raw_pointer_cast(&aggregates[0]);
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     aggregation_isolated_functor<IndexType>(Ap_ptr, Aj_ptr, agg_ptr, IndexType(-1), IndexType(-2)));
+
+    // roots of the MIS(2) that are not isolated
+    cusp::array1d<IndexType,MemorySpace> flags(num_rows);
+    cusp::graph::maximal_independent_set(C, flags, 2);
+    thrust::transform(flags.begin(), flags.end(), aggregates.begin(), flags.begin(), mis_root_flag<IndexType>());
+
+    cusp::array1d<IndexType,MemorySpace> ids(num_rows);
+    cusp::array1d<IndexType,MemorySpace> sizes;
+    size_t num_aggregates = 0;
+
+    cusp::array1d<IndexType,MemorySpace> request(num_rows);
+    cusp::array1d<IndexType,MemorySpace> nodes(num_rows);
+    cusp::array1d<IndexType,MemorySpace> ranks(num_rows);
+
+    bool promote = true;
+
+    while (true)
+    {
+        if (promote)
+        {
+            // flags mark the new roots
+            const IndexType last = flags[num_rows - 1];
+            thrust::exclusive_scan(flags.begin(), flags.end(), ids.begin());
+            const size_t num_roots = ids[num_rows - 1] + last;
+
+            thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                             thrust::counting_iterator<IndexType>(num_rows),
+                             mis_root_functor<IndexType>(thrust::raw_pointer_cast(&flags[0]), thrust::raw_pointer_cast(&ids[0]),
+                                                         agg_ptr, IndexType(num_aggregates)));
+
+            num_aggregates += num_roots;
+            sizes.resize(num_aggregates, IndexType(1));
+        }
+
+        const size_t num_unassigned = thrust::count_if(aggregates.begin(), aggregates.end(), is_unassigned<IndexType>());
+
+        if (num_unassigned == 0)
+            break;
+
+        // one round of joins
+        thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                         thrust::counting_iterator<IndexType>(num_rows),
+                         mis_join_functor<IndexType,WeightType>(Ap_ptr, Aj_ptr, Aw_ptr, agg_ptr,
+                                                                thrust::raw_pointer_cast(&sizes[0]),
+                                                                thrust::raw_pointer_cast(&request[0]), max_size));
+
+        thrust::sequence(nodes.begin(), nodes.end());
+        thrust::stable_sort_by_key(request.begin(), request.end(), nodes.begin());
+        thrust::exclusive_scan_by_key(request.begin(), request.end(),
+                                      thrust::constant_iterator<IndexType>(1),
+                                      ranks.begin());
+
+        thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                         thrust::counting_iterator<IndexType>(num_rows),
+                         mis_accept_functor<IndexType>(thrust::raw_pointer_cast(&request[0]), thrust::raw_pointer_cast(&nodes[0]),
+                                                       thrust::raw_pointer_cast(&ranks[0]), thrust::raw_pointer_cast(&sizes[0]),
+                                                       agg_ptr, max_size));
+
+        thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                         thrust::counting_iterator<IndexType>(num_rows),
+                         mis_size_functor<IndexType>(thrust::raw_pointer_cast(&request[0]), thrust::raw_pointer_cast(&ranks[0]),
+                                                     thrust::raw_pointer_cast(&sizes[0]), IndexType(num_rows), max_size));
+
+        promote = thrust::count_if(aggregates.begin(), aggregates.end(), is_unassigned<IndexType>()) == num_unassigned;
+
+        if (promote)
+            thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                             thrust::counting_iterator<IndexType>(num_rows),
+                             mis_promote_functor<IndexType>(Ap_ptr, Aj_ptr, agg_ptr, thrust::raw_pointer_cast(&flags[0])));
+    }
+
+    return num_aggregates;
+}
+
+// rows of C as CSR arrays with the magnitudes of the values as weights
+template <typename Matrix, typename Array1, typename Array2>
+void aggregation_graph(const Matrix& C, Array1& row_offsets, Array2& weights, cusp::coo_format)
+{
+    row_offsets.resize(C.num_rows + 1);
+    cusp::detail::indices_to_offsets(C.row_indices, row_offsets);
+
+    weights.resize(C.num_entries);
+    thrust::transform(C.values.begin(), C.values.end(), weights.begin(), aggregation_weight<typename Matrix::value_type>());
+}
+
+template <typename Matrix, typename Array1, typename Array2>
+void aggregation_graph(const Matrix& C, Array1& row_offsets, Array2& weights, cusp::csr_format)
+{
+    cusp::copy(C.row_offsets, row_offsets);
+
+    weights.resize(C.num_entries);
+    thrust::transform(C.values.begin(), C.values.end(), weights.begin(), aggregation_weight<typename Matrix::value_type>());
+}
+
+template <typename Matrix, typename Array>
+void pairwise_aggregation(const Matrix& C, Array& aggregates, const size_t num_passes,
+                          cusp::coo_format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::memory_space MemorySpace;
+    typedef typename aggregation_weight<typename Matrix::value_type>::WeightType WeightType;
+
+    cusp::array1d<IndexType,MemorySpace>  row_offsets;
+    cusp::array1d<WeightType,MemorySpace> weights;
+    aggregation_graph(C, row_offsets, weights, cusp::coo_format());
+
+    pairwise_aggregation(C.num_rows, row_offsets, C.column_indices, weights, aggregates, num_passes);
+}
+
+template <typename Matrix, typename Array>
+void pairwise_aggregation(const Matrix& C, Array& aggregates, const size_t num_passes,
+                          cusp::csr_format)
+{
+    typedef typename Matrix::memory_space MemorySpace;
+    typedef typename aggregation_weight<typename Matrix::value_type>::WeightType WeightType;
+
+    cusp::array1d<WeightType,MemorySpace> weights(C.num_entries);
+    thrust::transform(C.values.begin(), C.values.end(), weights.begin(), aggregation_weight<typename Matrix::value_type>());
+
+    pairwise_aggregation(C.num_rows, C.row_offsets, C.column_indices, weights, aggregates, num_passes);
+}
+
+template <typename Matrix, typename Array, typename Format>
+void pairwise_aggregation(const Matrix& C, Array& aggregates, const size_t num_passes,
+                          Format)
+{
+    cusp::csr_matrix<typename Matrix::index_type,typename Matrix::value_type,typename Matrix::memory_space> C_csr(C);
+    pairwise_aggregation(C_csr, aggregates, num_passes, cusp::csr_format());
+}
+
+template <typename Matrix, typename Array>
+void pairwise_aggregation(const Matrix& C, Array& aggregates, const size_t num_passes)
+{
+    CUSP_PROFILE_SCOPED();
+
+    pairwise_aggregation(C, aggregates, num_passes, typename Matrix::format());
+}
+
+template <typename Matrix, typename Array>
+void mis_aggregation(const Matrix& C, Array& aggregates, const size_t max_aggregate_size,
+                     cusp::coo_format)
+{
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::memory_space MemorySpace;
+    typedef typename aggregation_weight<typename Matrix::value_type>::WeightType WeightType;
+
+    cusp::array1d<IndexType,MemorySpace>  row_offsets;
+    cusp::array1d<WeightType,MemorySpace> weights;
+    aggregation_graph(C, row_offsets, weights, cusp::coo_format());
+
+    mis_aggregation(C, row_offsets, C.column_indices, weights, aggregates, max_aggregate_size);
+}
+
+template <typename Matrix, typename Array>
+void mis_aggregation(const Matrix& C, Array& aggregates, const size_t max_aggregate_size,
+                     cusp::csr_format)
+{
+    typedef typename Matrix::memory_space MemorySpace;
+    typedef typename aggregation_weight<typename Matrix::value_type>::WeightType WeightType;
+
+    cusp::array1d<WeightType,MemorySpace> weights(C.num_entries);
+    thrust::transform(C.values.begin(), C.values.end(), weights.begin(), aggregation_weight<typename Matrix::value_type>());
+
+    mis_aggregation(C, C.row_offsets, C.column_indices, weights, aggregates, max_aggregate_size);
+}
+
+template <typename Matrix, typename Array, typename Format>
+void mis_aggregation(const Matrix& C, Array& aggregates, const size_t max_aggregate_size,
+                     Format)
+{
+    cusp::csr_matrix<typename Matrix::index_type,typename Matrix::value_type,typename Matrix::memory_space> C_csr(C);
+    mis_aggregation(C_csr, aggregates, max_aggregate_size, cusp::csr_format());
+}
+
+template <typename Matrix, typename Array>
+void mis_aggregation(const Matrix& C, Array& aggregates, const size_t max_aggregate_size)
+{
+    CUSP_PROFILE_SCOPED();
+
+    mis_aggregation(C, aggregates, max_aggregate_size, typename Matrix::format());
+}
+
 } // end namespace detail
 } // end namespace precond
 } // end namespace cusp
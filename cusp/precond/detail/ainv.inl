@@ -23,6 +23,7 @@
 #include <cusp/transpose.h>
 #include <cusp/multiply.h>
 #include <cusp/csr_matrix.h>
+#include <cusp/detail/device/multiply.h>
 
 #include <map>
 #include <vector>
@@ -231,17 +232,49 @@ public:
   }
 }; // end struct ainv_matrix_row
 
+// Sparse vector in a dense buffer of the matrix dimension, which is
+// allocated once and reset in time proportional to the number of entries.
 template<typename IndexType, typename ValueType>
-void vector_scalar(std::map<IndexType, ValueType> &vec, ValueType scalar)
+class ainv_sparse_vector
 {
-    for (typename std::map<IndexType, ValueType>::iterator vec_iter = vec.begin(); vec_iter != vec.end(); ++vec_iter) {
-      vec_iter->second *= scalar;
+  std::vector<ValueType> values; // zero outside of the pattern
+  std::vector<char> stored;
+
+public:
+
+  std::vector<IndexType> indices; // pattern in the order of insertion
+
+  ainv_sparse_vector(size_t n) : values(n, ValueType(0)), stored(n, 0) { }
+
+  void clear() {
+    for (size_t k = 0; k < indices.size(); k++) {
+      values[indices[k]] = ValueType(0);
+      stored[indices[k]] = 0;
     }
-}
+    indices.clear();
+  }
+
+  bool has_entry_at_index(IndexType i) const { return stored[i] != 0; }
+
+  ValueType operator[](IndexType i) const { return values[i]; }
+
+  void add_to_value(IndexType i, ValueType addend) {
+    if (!stored[i]) {
+      stored[i] = 1;
+      indices.push_back(i);
+    }
+    values[i] += addend;
+  }
+
+  void mult_by_scalar(ValueType scalar) {
+    for (size_t k = 0; k < indices.size(); k++)
+      values[indices[k]] *= scalar;
+  }
+};
 
 
 template<typename IndexType, typename ValueType>
-void matrix_vector_product(const csr_matrix<IndexType, ValueType, host_memory> &A, const detail::ainv_matrix_row<IndexType, ValueType> &x, std::map<IndexType, ValueType> &b)
+void matrix_vector_product(const csr_matrix<IndexType, ValueType, host_memory> &A, const detail::ainv_matrix_row<IndexType, ValueType> &x, detail::ainv_sparse_vector<IndexType, ValueType> &b)
 {
     b.clear();
 
@@ -252,44 +285,20 @@ void matrix_vector_product(const csr_matrix<IndexType, ValueType, host_memory> &
         IndexType row_start = A.row_offsets[row];
         IndexType row_end = A.row_offsets[row+1];
 
-        for (IndexType row_j = row_start; row_j < row_end; row_j++) {
-            IndexType col = A.column_indices[row_j];
-            ValueType Aij = A.values[row_j];
-
-            ValueType product = Aij * x_i;
-
-            // add to b if it's not already in b
-            typename std::map<IndexType, ValueType>::iterator b_iter = b.find(col);
-            if (b_iter == b.end())
-                b[col] = product;
-            else 
-                b_iter->second += product;
-        }
+        for (IndexType row_j = row_start; row_j < row_end; row_j++)
+            b.add_to_value(A.column_indices[row_j], A.values[row_j] * x_i);
     }
-
 }
 
 
 template<typename IndexType, typename ValueType>
-ValueType dot_product(const detail::ainv_matrix_row<IndexType, ValueType> &a, const std::map<IndexType, ValueType> &b) 
+ValueType dot_product(const detail::ainv_matrix_row<IndexType, ValueType> &a, const detail::ainv_sparse_vector<IndexType, ValueType> &b) 
 {
-    typename detail::ainv_matrix_row<IndexType, ValueType>::const_iterator a_iter = a.begin();
-    typename std::map<IndexType, ValueType>::const_iterator b_iter = b.begin();
-
     ValueType sum = 0;
-    while (a_iter != a.end() && b_iter != b.end()) {
-        IndexType a_ind = a_iter->first;
-        IndexType b_ind = b_iter->first;
-        if (a_ind == b_ind) {
-            sum += a_iter->second.value * b_iter->second;
-            ++a_iter;
-            ++b_iter;
-        }
-        else if (a_ind < b_ind) 
-            ++a_iter;
-        else 
-            ++b_iter;
-    }
+
+    for (typename detail::ainv_matrix_row<IndexType, ValueType>::const_iterator a_iter = a.begin(); a_iter != a.end(); ++a_iter)
+        if (b.has_entry_at_index(a_iter->first))
+            sum += a_iter->second.value * b[a_iter->first];
 
     return sum;
 }
@@ -339,6 +348,42 @@ void vector_add_inplace_drop(detail::ainv_matrix_row<IndexType, ValueType> &resu
     }
 }
 
+// steps with fewer updates than this are not worth a parallel region
+const int AINV_MIN_PARALLEL_UPDATES = 32;
+
+// factor[i] += -u_i / p * factor[j] for the rows i > j with u_i != 0.  Each
+// update writes a different row and only reads row j, hence the updates
+// of one step are independent and run in parallel under OpenMP, with the
+// same result as in order.
+template<typename IndexType, typename ValueType, typename MatrixType, typename ToleranceType>
+void ainv_update_factor(std::vector<detail::ainv_matrix_row<IndexType, ValueType> > &factor,
+                        const detail::ainv_sparse_vector<IndexType, ValueType> &u, IndexType j, ValueType p,
+                        const MatrixType &host_A, ToleranceType drop_tolerance, int nonzero_per_row, bool lin_dropping, int lin_param,
+                        std::vector<IndexType> &targets)
+{
+    targets.clear();
+
+    for (size_t k = 0; k < u.indices.size(); k++)
+      if (u.indices[k] > j)
+        targets.push_back(u.indices[k]);
+
+    const int num_targets = (int) targets.size();
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) if (num_targets >= AINV_MIN_PARALLEL_UPDATES)
+#endif
+    for (int t = 0; t < num_targets; t++) {
+      IndexType i = targets[t];
+      int row_count = nonzero_per_row;
+      if (lin_dropping) {
+        row_count = lin_param + (int) (host_A.row_offsets[i+1] - host_A.row_offsets[i]); 
+        if (row_count < 1) row_count = 1;
+      }
+
+      detail::vector_add_inplace_drop(factor[i], -u[i]/p, factor[j], (ValueType) drop_tolerance, row_count);
+    }
+}
+
 template<typename IndexTypeA, typename ValueTypeA, typename IndexTypeB, typename ValueTypeB, typename MemorySpaceB>
 void convert_to_device_csr(const std::vector<detail::ainv_matrix_row<IndexTypeA, ValueTypeA> > &src, cusp::hyb_matrix<IndexTypeB, ValueTypeB, MemorySpaceB> &dst)
 {
@@ -346,7 +391,7 @@ void convert_to_device_csr(const std::vector<detail::ainv_matrix_row<IndexTypeA,
     IndexTypeA nnz = 0;
     IndexTypeA n = src.size();
 
-    int i;
+    IndexTypeA i;
     for (i=0; i < n; i++)
       nnz += src[i].size();
 
@@ -373,15 +418,30 @@ void convert_to_device_csr(const std::vector<detail::ainv_matrix_row<IndexTypeA,
 
 
 
+// y <- D A x, host path
+template<typename MatrixType, typename VectorType1, typename VectorType2, typename VectorType3>
+void ainv_scaled_multiply(const MatrixType &A, const VectorType1 &x, const VectorType2 &diagonals, VectorType3 &y, cusp::host_memory)
+{
+    cusp::multiply(A, x, y);
+    cusp::blas::xmy(y, diagonals, y);
+}
+
+// device path, the scaling is the epilogue of the SpMV kernel
+template<typename MatrixType, typename VectorType1, typename VectorType2, typename VectorType3>
+void ainv_scaled_multiply(const MatrixType &A, const VectorType1 &x, const VectorType2 &diagonals, VectorType3 &y, cusp::device_memory)
+{
+    cusp::detail::device::multiply_scale(A, x, diagonals, y, typename MatrixType::format());
+}
+
 } // end namespace detail
 
 
 // constructor
-template <typename ValueType, typename MemorySpace>
+template <typename ValueType, typename MemorySpace, typename IndexType>
     template<typename MatrixTypeA>
-    nonsym_bridson_ainv<ValueType,MemorySpace>
+    nonsym_bridson_ainv<ValueType,MemorySpace,IndexType>
     ::nonsym_bridson_ainv(const MatrixTypeA & A, ValueType drop_tolerance, int nonzero_per_row, bool lin_dropping, int lin_param)
-        : linear_operator<ValueType,MemorySpace>(A.num_rows, A.num_cols, A.num_rows)
+        : linear_operator<ValueType,MemorySpace,IndexType>(A.num_rows, A.num_cols, A.num_rows)
     {
         typename MatrixTypeA::index_type n = A.num_rows;
         MatrixTypeA At;
@@ -402,7 +462,8 @@ template <typename ValueType, typename MemorySpace>
           z_factor[i].insert(i, (typename MatrixTypeA::value_type)1); 
         }
 
-        typename std::map<typename MatrixTypeA::index_type, typename MatrixTypeA::value_type> u, l;
+        detail::ainv_sparse_vector<typename MatrixTypeA::index_type, typename MatrixTypeA::value_type> u(n), l(n);
+        std::vector<typename MatrixTypeA::index_type> targets;
 
         for (j=0; j < n; j++)
         {
@@ -413,61 +474,43 @@ template <typename ValueType, typename MemorySpace>
           host_diagonals[j] = (ValueType) (1.0/p);
 
           // for i = j+1 to n, skipping where u_i == 0
-          // this should be a O(1)-time operation, since u is a sparse vector
-          for (typename std::map<typename MatrixTypeA::index_type,typename MatrixTypeA::value_type>::const_iterator u_iter = u.upper_bound(j); u_iter != u.end(); ++u_iter) {
-            i = u_iter->first;
-            int row_count = nonzero_per_row;
-            if (lin_dropping) {
-              row_count = lin_param + (int) (host_A.row_offsets[i+1] - host_A.row_offsets[i]); 
-              if (row_count < 1) row_count = 1;
-            }
-
-            detail::vector_add_inplace_drop(z_factor[i], -u_iter->second/p, z_factor[j], drop_tolerance, row_count);
-          }
-
-          for (typename std::map<typename MatrixTypeA::index_type,typename MatrixTypeA::value_type>::const_iterator l_iter = l.upper_bound(j); l_iter != l.end(); ++l_iter) {
-            i = l_iter->first;
-            int row_count = nonzero_per_row;
-            if (lin_dropping) {
-              row_count = lin_param + (int) (host_A.row_offsets[i+1] - host_A.row_offsets[i]); 
-              if (row_count < 1) row_count = 1;
-            }
-
-            detail::vector_add_inplace_drop(wt_factor[i], -l_iter->second/p, wt_factor[j], drop_tolerance, row_count);
-          }
+          detail::ainv_update_factor(z_factor, u, j, p, host_A, drop_tolerance, nonzero_per_row, lin_dropping, lin_param, targets);
 
+          // for i = j+1 to n, skipping where l_i == 0
+          detail::ainv_update_factor(wt_factor, l, j, p, host_A, drop_tolerance, nonzero_per_row, lin_dropping, lin_param, targets);
         }
 
         // copy w_factor into w, w_t
         diagonals = host_diagonals;
 
         // convert wt to csr
-        typename cusp::hyb_matrix<int, ValueType, MemorySpace> w;
+        typename cusp::hyb_matrix<IndexType, ValueType, MemorySpace> w;
         detail::convert_to_device_csr(wt_factor, w);
         cusp::transpose(w, w_t);
         detail::convert_to_device_csr(z_factor, z);
     }
         
 // linear operator
-template <typename ValueType, typename MemorySpace>
+template <typename ValueType, typename MemorySpace, typename IndexType>
     template <typename VectorType1, typename VectorType2>
-    void nonsym_bridson_ainv<ValueType, MemorySpace>
+    void nonsym_bridson_ainv<ValueType,MemorySpace,IndexType>
     ::operator()(const VectorType1& x, VectorType2& y) const
     {
-        VectorType2 temp1(x.size()), temp2(x.size());
-        cusp::multiply(z, x, temp1);
-        cusp::blas::xmy(temp1, diagonals, temp2);
-        cusp::multiply(w_t, temp2, y);
+        temp.resize(x.size());
+
+        // temp <- D z x
+        detail::ainv_scaled_multiply(z, x, diagonals, temp, MemorySpace());
+        cusp::multiply(w_t, temp, y);
     }
 
 
 
 // constructor
-template <typename ValueType, typename MemorySpace>
+template <typename ValueType, typename MemorySpace, typename IndexType>
     template<typename MatrixTypeA>
-    bridson_ainv<ValueType,MemorySpace>
+    bridson_ainv<ValueType,MemorySpace,IndexType>
     ::bridson_ainv(const MatrixTypeA & A, ValueType drop_tolerance, int nonzero_per_row, bool lin_dropping, int lin_param)
-        : linear_operator<ValueType,MemorySpace>(A.num_rows, A.num_cols, A.num_rows)
+        : linear_operator<ValueType,MemorySpace,IndexType>(A.num_rows, A.num_cols, A.num_rows)
     {
         typename MatrixTypeA::index_type n = A.num_rows;
   
@@ -484,7 +527,8 @@ template <typename ValueType, typename MemorySpace>
           w_factor[i].insert(i, (typename MatrixTypeA::value_type)1); 
         }
 
-        typename std::map<typename MatrixTypeA::index_type, typename MatrixTypeA::value_type> u;
+        detail::ainv_sparse_vector<typename MatrixTypeA::index_type, typename MatrixTypeA::value_type> u(n);
+        std::vector<typename MatrixTypeA::index_type> targets;
 
         for (j=0; j < n; j++)
         {
@@ -493,18 +537,7 @@ template <typename ValueType, typename MemorySpace>
           host_diagonals[j] = (ValueType) (1.0/p);
 
           // for i = j+1 to n, skipping where u_i == 0
-          // this should be a O(1)-time operation, since u is a sparse vector
-          for (typename std::map<typename MatrixTypeA::index_type,typename MatrixTypeA::value_type>::const_iterator u_iter = u.upper_bound(j); u_iter != u.end(); ++u_iter) {
-            i = u_iter->first;
-            int row_count = nonzero_per_row;
-            if (lin_dropping) {
-              row_count = lin_param + (int) (host_A.row_offsets[i+1] - host_A.row_offsets[i]); 
-              if (row_count < 1) row_count = 1;
-            }
-
-            detail::vector_add_inplace_drop(w_factor[i], -u_iter->second/p, w_factor[j], drop_tolerance, row_count);
-          }
-
+          detail::ainv_update_factor(w_factor, u, j, p, host_A, drop_tolerance, nonzero_per_row, lin_dropping, lin_param, targets);
         }
 
         // copy diagonal & w_factor into w, w_t
@@ -514,26 +547,27 @@ template <typename ValueType, typename MemorySpace>
     }
         
 // linear operator
-template <typename ValueType, typename MemorySpace>
+template <typename ValueType, typename MemorySpace, typename IndexType>
     template <typename VectorType1, typename VectorType2>
-    void bridson_ainv<ValueType, MemorySpace>
+    void bridson_ainv<ValueType,MemorySpace,IndexType>
     ::operator()(const VectorType1& x, VectorType2& y) const
     {
-        VectorType2 temp1(x.size()), temp2(x.size());
-        cusp::multiply(w, x, temp1);
-        cusp::blas::xmy(temp1, diagonals, temp2);
-        cusp::multiply(w_t, temp2, y);
+        temp.resize(x.size());
+
+        // temp <- D w x
+        detail::ainv_scaled_multiply(w, x, diagonals, temp, MemorySpace());
+        cusp::multiply(w_t, temp, y);
     }
 
 
 
 
 // constructor
-template <typename ValueType, typename MemorySpace>
+template <typename ValueType, typename MemorySpace, typename IndexType>
     template<typename MatrixTypeA>
-    scaled_bridson_ainv<ValueType,MemorySpace>
+    scaled_bridson_ainv<ValueType,MemorySpace,IndexType>
     ::scaled_bridson_ainv(const MatrixTypeA & A, ValueType drop_tolerance, int nonzero_per_row, bool lin_dropping, int lin_param)
-        : linear_operator<ValueType,MemorySpace>(A.num_rows, A.num_cols, A.num_rows)
+        : linear_operator<ValueType,MemorySpace,IndexType>(A.num_rows, A.num_cols, A.num_rows)
     {
         typename MatrixTypeA::index_type n = A.num_rows;
   
@@ -548,27 +582,18 @@ template <typename ValueType, typename MemorySpace>
           w_factor[i].insert(i, (typename MatrixTypeA::value_type)1); 
         }
 
-        typename std::map<typename MatrixTypeA::index_type, typename MatrixTypeA::value_type> u;
+        detail::ainv_sparse_vector<typename MatrixTypeA::index_type, typename MatrixTypeA::value_type> u(n);
+        std::vector<typename MatrixTypeA::index_type> targets;
 
         for (j=0; j < n; j++) {
           cusp::precond::detail::matrix_vector_product(host_A, w_factor[j], u);
           typename MatrixTypeA::value_type p = detail::dot_product(w_factor[j], u);
 
-          detail::vector_scalar(u, (typename MatrixTypeA::value_type) (1.0/sqrt((ValueType) p)));
+          u.mult_by_scalar((typename MatrixTypeA::value_type) (1.0/sqrt((ValueType) p)));
           w_factor[j].mult_by_scalar((typename MatrixTypeA::value_type) (1.0/sqrt((ValueType) p)));
 
           // for i = j+1 to n, skipping where u_i == 0
-          // this should be a O(1)-time operation, since u is a sparse vector
-          for (typename std::map<typename MatrixTypeA::index_type,typename MatrixTypeA::value_type>::const_iterator u_iter = u.upper_bound(j); u_iter != u.end(); ++u_iter) {
-            i = u_iter->first;
-            int row_count = nonzero_per_row;
-            if (lin_dropping) {
-              row_count = lin_param + (int) (host_A.row_offsets[i+1] - host_A.row_offsets[i]); 
-              if (row_count < 1) row_count = 1;
-            }
-            detail::vector_add_inplace_drop(w_factor[i], -u_iter->second, w_factor[j], drop_tolerance, row_count);
-          }
-
+          detail::ainv_update_factor(w_factor, u, j, (typename MatrixTypeA::value_type) 1, host_A, drop_tolerance, nonzero_per_row, lin_dropping, lin_param, targets);
         }
 
         // copy w_factor into w:
@@ -576,14 +601,15 @@ template <typename ValueType, typename MemorySpace>
         cusp::transpose(w, w_t);
     }
 
-template <typename ValueType, typename MemorySpace>
+template <typename ValueType, typename MemorySpace, typename IndexType>
     template <typename VectorType1, typename VectorType2>
-    void scaled_bridson_ainv<ValueType, MemorySpace>
+    void scaled_bridson_ainv<ValueType,MemorySpace,IndexType>
     ::operator()(const VectorType1& x, VectorType2& y) const
     {
-        VectorType2 temp1(x.size());
-        cusp::multiply(w, x, temp1);
-        cusp::multiply(w_t, temp1, y);
+        temp.resize(x.size());
+
+        cusp::multiply(w, x, temp);
+        cusp::multiply(w_t, temp, y);
     }
 
 } // end namespace precond
@@ -0,0 +1,380 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file block_jacobi.inl
+ *  \brief Inline file for block_jacobi.h
+ */
+
+#include <cusp/complex.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/exception.h>
+
+#include <cusp/detail/fixed_size.h>
+
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+namespace cusp
+{
+namespace precond
+{
+namespace detail
+{
+
+// entry (i,j) of A into its diagonal block, entries between blocks are dropped
+template <typename IndexType, typename ValueType>
+struct block_jacobi_extract
+{
+    const IndexType * row_blocks;
+    const IndexType * block_offsets;
+    const IndexType * value_offsets;
+          ValueType * blocks;
+
+    block_jacobi_extract(const IndexType * row_blocks, const IndexType * block_offsets,
+                         const IndexType * value_offsets, ValueType * blocks)
+        : row_blocks(row_blocks), block_offsets(block_offsets),
+          value_offsets(value_offsets), blocks(blocks) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(const Tuple& t) const
+    {
+        const IndexType i = thrust::get<0>(t);
+        const IndexType j = thrust::get<1>(t);
+        const IndexType b = row_blocks[i];
+
+        if (row_blocks[j] != b)
+            return;
+
+        const IndexType first = block_offsets[b];
+        const IndexType n     = block_offsets[b + 1] - first;
+
+        blocks[value_offsets[b] + (i - first) * n + (j - first)] = thrust::get<2>(t);
+    }
+};
+
+// Inverse of block b from its LU factorization with partial pivoting, in
+// place of the block.  Returns 1 when the block is singular.
+template <typename IndexType, typename ValueType>
+struct block_jacobi_invert
+{
+    const IndexType * block_offsets;
+    const IndexType * value_offsets;
+          IndexType * pivots;
+          ValueType * blocks;
+          ValueType * inverses;
+
+    block_jacobi_invert(const IndexType * block_offsets, const IndexType * value_offsets,
+                        IndexType * pivots, ValueType * blocks, ValueType * inverses)
+        : block_offsets(block_offsets), value_offsets(value_offsets),
+          pivots(pivots), blocks(blocks), inverses(inverses) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    int operator()(const Tuple& t) const
+    {
+        const IndexType b     = thrust::get<0>(t);
+        const IndexType first = thrust::get<1>(t);
+        const IndexType n     = block_offsets[b + 1] - first;
+
+        ValueType * LU  = blocks   + value_offsets[b];
+        ValueType * Inv = inverses + value_offsets[b];
+        IndexType * p   = pivots   + first;
+
+        // P LU = D_b
+        for (IndexType k = 0; k < n; k++)
+        {
+            IndexType r = k;
+
+            for (IndexType i = k + 1; i < n; i++)
+                if (cusp::abs(LU[i * n + k]) > cusp::abs(LU[r * n + k]))
+                    r = i;
+
+            p[k] = r;
+
+            if (LU[r * n + k] == ValueType(0))
+                return 1;
+
+            if (r != k)
+                for (IndexType j = 0; j < n; j++)
+                {
+                    const ValueType temp = LU[k * n + j];
+                    LU[k * n + j] = LU[r * n + j];
+                    LU[r * n + j] = temp;
+                }
+
+            for (IndexType i = k + 1; i < n; i++)
+            {
+                const ValueType l = LU[i * n + k] / LU[k * n + k];
+                LU[i * n + k] = l;
+
+                for (IndexType j = k + 1; j < n; j++)
+                    LU[i * n + j] -= l * LU[k * n + j];
+            }
+        }
+
+        // column c of the inverse solves LU x = P e_c
+        for (IndexType c = 0; c < n; c++)
+        {
+            for (IndexType i = 0; i < n; i++)
+                Inv[i * n + c] = i == c ? ValueType(1) : ValueType(0);
+
+            for (IndexType k = 0; k < n; k++)
+            {
+                const ValueType temp = Inv[k * n + c];
+                Inv[k * n + c]    = Inv[p[k] * n + c];
+                Inv[p[k] * n + c] = temp;
+            }
+
+            for (IndexType i = 0; i < n; i++)
+                for (IndexType j = 0; j < i; j++)
+                    Inv[i * n + c] -= LU[i * n + j] * Inv[j * n + c];
+
+            for (IndexType i = n; i > 0; i--)
+            {
+                for (IndexType j = i; j < n; j++)
+                    Inv[(i - 1) * n + c] -= LU[(i - 1) * n + j] * Inv[j * n + c];
+
+                Inv[(i - 1) * n + c] /= LU[(i - 1) * n + (i - 1)];
+            }
+        }
+
+        return 0;
+    }
+};
+
+// y[i] <- row i of the inverse of block b times x, unrolled for blocks of
+// BLOCK_SIZE rows unless BLOCK_SIZE is 0
+template <int BLOCK_SIZE, typename IndexType, typename ValueType>
+struct block_jacobi_apply
+{
+    const IndexType * block_offsets;
+    const IndexType * value_offsets;
+    const ValueType * inverses;
+    const ValueType * x;
+          ValueType * y;
+
+    block_jacobi_apply(const IndexType * block_offsets, const IndexType * value_offsets,
+                       const ValueType * inverses, const ValueType * x, ValueType * y)
+        : block_offsets(block_offsets), value_offsets(value_offsets),
+          inverses(inverses), x(x), y(y) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(const Tuple& t) const
+    {
+        const IndexType i     = thrust::get<0>(t);
+        const IndexType b     = thrust::get<1>(t);
+        const IndexType first = block_offsets[b];
+        const IndexType n     = block_offsets[b + 1] - first;
+
+        const ValueType * row = inverses + value_offsets[b] + (i - first) * n;
+
+        if (BLOCK_SIZE != 0 && n == BLOCK_SIZE)
+        {
+            y[i] = cusp::detail::fixed_dot<BLOCK_SIZE>::apply(row, x, first, ValueType(0));
+            return;
+        }
+
+        ValueType sum = 0;
+
+        for (IndexType j = 0; j < n; j++)
+            sum += row[j] * x[first + j];
+
+        y[i] = sum;
+    }
+};
+
+template <typename IndexType, typename ValueType, typename Array1, typename Array2>
+struct block_jacobi_apply_launch
+{
+    const Array1&     row_blocks;
+    const Array1&     block_offsets;
+    const Array1&     value_offsets;
+    const Array2&     inverses;
+    const ValueType * x;
+          ValueType * y;
+
+    block_jacobi_apply_launch(const Array1& row_blocks, const Array1& block_offsets, const Array1& value_offsets,
+                              const Array2& inverses, const ValueType * x, ValueType * y)
+        : row_blocks(row_blocks), block_offsets(block_offsets), value_offsets(value_offsets),
+          inverses(inverses), x(x), y(y) {}
+
+    // one thread per row
+    template <int BLOCK_SIZE>
+    void apply(void)
+    {
+        thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), row_blocks.begin())),
+                         thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(row_blocks.size()), row_blocks.end())),
+                         block_jacobi_apply<BLOCK_SIZE,IndexType,ValueType>(thrust::raw_pointer_cast(&block_offsets[0]),
+                                                                            thrust::raw_pointer_cast(&value_offsets[0]),
+                                                                            thrust::raw_pointer_cast(&inverses[0]),
+                                                                            x, y));
+    }
+};
+
+} // end namespace detail
+
+
+// constructors
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template <typename MatrixType>
+    block_jacobi<ValueType,MemorySpace,IndexType>
+    ::block_jacobi(const MatrixType& A, size_t block_size)
+        : linear_operator<ValueType,MemorySpace,IndexType>(A.num_rows, A.num_cols, 0)
+    {
+        if (block_size == 0)
+            throw cusp::invalid_input_exception("block size must be positive");
+
+        const size_t num_blocks = (A.num_rows + block_size - 1) / block_size;
+
+        cusp::array1d<IndexType,cusp::host_memory> offsets(num_blocks + 1);
+
+        for (size_t k = 0; k < num_blocks; k++)
+            offsets[k] = k * block_size;
+        offsets[num_blocks] = A.num_rows;
+
+        setup(A, offsets);
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template <typename MatrixType, typename OffsetType, typename OffsetSpace>
+    block_jacobi<ValueType,MemorySpace,IndexType>
+    ::block_jacobi(const MatrixType& A, const cusp::array1d<OffsetType, OffsetSpace>& offsets)
+        : linear_operator<ValueType,MemorySpace,IndexType>(A.num_rows, A.num_cols, 0)
+    {
+        setup(A, offsets);
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template <typename MatrixType, typename ArrayType>
+    void block_jacobi<ValueType,MemorySpace,IndexType>
+    ::setup(const MatrixType& A, const ArrayType& offsets)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (A.num_rows != A.num_cols)
+            throw cusp::invalid_input_exception("matrix must be square");
+
+        const cusp::array1d<IndexType,cusp::host_memory> h_offsets(offsets);
+
+        if (h_offsets.empty() || h_offsets[0] != 0 || size_t(h_offsets.back()) != A.num_rows)
+            throw cusp::invalid_input_exception("block offsets must range from 0 to the number of rows");
+
+        const size_t num_blocks = h_offsets.size() - 1;
+
+        // the layout of the blocks is computed on the host
+        cusp::array1d<IndexType,cusp::host_memory> h_value_offsets(num_blocks + 1);
+        cusp::array1d<IndexType,cusp::host_memory> h_row_blocks(A.num_rows);
+
+        h_value_offsets[0] = 0;
+
+        for (size_t k = 0; k < num_blocks; k++)
+        {
+            const IndexType n = h_offsets[k + 1] - h_offsets[k];
+
+            if (n <= 0)
+                throw cusp::invalid_input_exception("block offsets must be increasing");
+
+            h_value_offsets[k + 1] = h_value_offsets[k] + n * n;
+
+            for (IndexType i = h_offsets[k]; i < h_offsets[k + 1]; i++)
+                h_row_blocks[i] = k;
+        }
+
+        block_offsets = h_offsets;
+        value_offsets = h_value_offsets;
+        row_blocks    = h_row_blocks;
+
+        // blocks of equal size, except for a smaller last block
+        block_size = num_blocks == 0 ? 0 : h_offsets[1] - h_offsets[0];
+
+        for (size_t k = 1; k < num_blocks && block_size != 0; k++)
+        {
+            const size_t n = h_offsets[k + 1] - h_offsets[k];
+
+            if (n > block_size || (n < block_size && k + 1 < num_blocks))
+                block_size = 0;
+        }
+
+        Parent::num_entries = h_value_offsets[num_blocks];
+
+        if (num_blocks == 0)
+            return;
+
+        // dense diagonal blocks
+        cusp::array1d<ValueType,MemorySpace> blocks(h_value_offsets[num_blocks], ValueType(0));
+
+        {
+            cusp::coo_matrix<IndexType,ValueType,MemorySpace> C(A);
+
+            thrust::for_each(thrust::make_zip_iterator(thrust::make_tuple(C.row_indices.begin(), C.column_indices.begin(), C.values.begin())),
+                             thrust::make_zip_iterator(thrust::make_tuple(C.row_indices.end(),   C.column_indices.end(),   C.values.end())),
+                             detail::block_jacobi_extract<IndexType,ValueType>(thrust::raw_pointer_cast(&row_blocks[0]),
+                                                                               thrust::raw_pointer_cast(&block_offsets[0]),
+                                                                               thrust::raw_pointer_cast(&value_offsets[0]),
+                                                                               thrust::raw_pointer_cast(&blocks[0])));
+        }
+
+        // one thread per block
+        cusp::array1d<IndexType,MemorySpace> pivots(A.num_rows);
+        inverses.resize(blocks.size());
+
+        const int num_singular_blocks =
+            thrust::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), block_offsets.begin())),
+                                     thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(num_blocks), block_offsets.end() - 1)),
+                                     detail::block_jacobi_invert<IndexType,ValueType>(thrust::raw_pointer_cast(&block_offsets[0]),
+                                                                                      thrust::raw_pointer_cast(&value_offsets[0]),
+                                                                                      thrust::raw_pointer_cast(&pivots[0]),
+                                                                                      thrust::raw_pointer_cast(&blocks[0]),
+                                                                                      thrust::raw_pointer_cast(&inverses[0])),
+                                     0,
+                                     thrust::plus<int>());
+
+        if (num_singular_blocks > 0)
+            throw cusp::runtime_exception("singular diagonal block in block Jacobi preconditioner");
+    }
+
+// linear operator
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template <typename VectorType1, typename VectorType2>
+    void block_jacobi<ValueType,MemorySpace,IndexType>
+    ::operator()(const VectorType1& x, VectorType2& y) const
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (row_blocks.empty())
+            return;
+
+        typedef cusp::array1d<IndexType,MemorySpace> IndexArray;
+        typedef cusp::array1d<ValueType,MemorySpace> ValueArray;
+
+        // unroll the rows of uniform blocks of the common sizes
+        detail::block_jacobi_apply_launch<IndexType,ValueType,IndexArray,ValueArray>
+            launch(row_blocks, block_offsets, value_offsets, inverses,
+                   thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]));
+
+        cusp::detail::dispatch_fixed_size(block_size, launch);
+    }
+
+} // end namespace precond
+} // end namespace cusp
+
@@ -57,6 +57,15 @@ template <typename ValueType, typename MemorySpace>
         thrust::transform(diagonal_reciprocals.begin(), diagonal_reciprocals.end(),
                           diagonal_reciprocals.begin(), detail::reciprocal<ValueType>());
     }
+
+template <typename ValueType, typename MemorySpace>
+    template<typename MatrixType>
+    diagonal<ValueType,MemorySpace>
+    ::diagonal(const MatrixType& A, cusp::detail::diagonal_cache<ValueType,MemorySpace>& cache)
+        : linear_operator<ValueType,MemorySpace>(A.num_rows, A.num_cols, A.num_rows),
+          diagonal_reciprocals(cache.inverse_diagonal(A))
+    {
+    }
         
 // linear operator
 template <typename ValueType, typename MemorySpace>
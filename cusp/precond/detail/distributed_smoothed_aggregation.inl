@@ -0,0 +1,1114 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/convert.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/transpose.h>
+#include <cusp/precond/aggregate.h>
+#include <cusp/precond/smooth.h>
+#include <cusp/precond/strength.h>
+
+#include <cusp/detail/scoped_device.h>
+
+#include <thrust/copy.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace cusp
+{
+namespace precond
+{
+namespace detail
+{
+
+// Merge consecutive ranges of a distribution into num_groups ranges,
+// each of which resides on the device and process of its first range.
+inline cusp::distribution distributed_consolidate(const cusp::distribution& d, const size_t num_groups)
+{
+    const size_t num_parts = d.num_partitions();
+    const size_t group     = (num_parts + num_groups - 1) / num_groups;
+
+    std::vector<int>    devices;
+    std::vector<int>    ranks;
+    std::vector<size_t> offsets;
+
+    for (size_t p = 0; p < num_parts; p += group)
+    {
+        devices.push_back(d.device(p));
+        ranks.push_back(d.rank(p));
+        offsets.push_back(d.begin(p));
+    }
+
+    offsets.push_back(d.size());
+
+    return cusp::distribution(devices, offsets, ranks, d.get_communicator());
+}
+
+// The distribution with the ranges of d whose sizes are the counts of
+// the local ranges, which are exchanged with the other processes.
+inline cusp::distribution distributed_coarse_distribution(const cusp::distribution& d, std::vector<size_t> counts)
+{
+    const cusp::communicator& comm = d.get_communicator();
+    const size_t num_parts = d.num_partitions();
+
+    if (comm.size() > 1)
+    {
+        // (range, count) of every local range
+        std::vector<size_t> local;
+
+        for (size_t p = 0; p < num_parts; p++)
+        {
+            if (!d.local(p))
+                continue;
+
+            local.push_back(p);
+            local.push_back(counts[p]);
+        }
+
+        std::vector< std::vector<size_t> > send(comm.size(), local), recv;
+        comm.alltoallv(send, recv);
+
+        for (size_t r = 0; r < recv.size(); r++)
+            for (size_t k = 0; k + 1 < recv[r].size(); k += 2)
+                counts[recv[r][k]] = recv[r][k + 1];
+    }
+
+    std::vector<int>    devices(num_parts);
+    std::vector<int>    ranks(num_parts);
+    std::vector<size_t> offsets(num_parts + 1, 0);
+
+    for (size_t p = 0; p < num_parts; p++)
+    {
+        devices[p]     = d.device(p);
+        ranks[p]       = d.rank(p);
+        offsets[p + 1] = offsets[p] + counts[p];
+    }
+
+    return cusp::distribution(devices, offsets, ranks, comm);
+}
+
+template <typename IndexType, typename ValueType>
+void distributed_assign_rows(cusp::csr_matrix<IndexType,ValueType,cusp::host_memory>& A, const size_t num_cols,
+                             const std::vector<IndexType>& offsets,
+                             const std::vector<IndexType>& columns,
+                             const std::vector<ValueType>& values)
+{
+    A.resize(offsets.size() - 1, num_cols, columns.size());
+
+    std::copy(offsets.begin(), offsets.end(), A.row_offsets.begin());
+    std::copy(columns.begin(), columns.end(), A.column_indices.begin());
+    std::copy(values.begin(),  values.end(),  A.values.begin());
+}
+
+// Copy the values of src to dst, which has another distribution of the
+// same indices.  Values within the process are copied between the
+// devices, values of other processes are staged on the host.  Collective
+// on the communicator of the distributions.
+template <typename ValueType>
+void distributed_redistribute(const cusp::distributed_array1d<ValueType>& src, cusp::distributed_array1d<ValueType>& dst)
+{
+    const cusp::distribution& from = src.get_distribution();
+    const cusp::distribution& to   = dst.get_distribution();
+    const cusp::communicator& comm = from.get_communicator();
+
+    std::vector< std::vector<ValueType> > send(comm.size()), recv;
+
+    for (size_t p = 0; p < from.num_partitions(); p++)
+    {
+        if (!from.local(p) || from.begin(p) == from.end(p))
+            continue;
+
+        for (size_t q = to.owner(from.begin(p)); q < to.num_partitions() && to.begin(q) < from.end(p); q++)
+        {
+            const size_t begin = std::max(from.begin(p), to.begin(q));
+            const size_t end   = std::min(from.end(p),   to.end(q));
+
+            if (begin >= end)
+                continue;
+
+            if (to.local(q))
+            {
+                cusp::detail::check_cuda(cudaMemcpyPeer(thrust::raw_pointer_cast(&dst.slice(q)[0]) + (begin - to.begin(q)),   to.device(q),
+                                                        thrust::raw_pointer_cast(&src.slice(p)[0]) + (begin - from.begin(p)), from.device(p),
+                                                        (end - begin) * sizeof(ValueType)),
+                                         "cudaMemcpyPeer failed");
+            }
+            else
+            {
+                cusp::detail::scoped_device scope(from.device(p));
+
+                cusp::array1d<ValueType,cusp::host_memory> values(end - begin);
+                thrust::copy(src.slice(p).begin() + (begin - from.begin(p)), src.slice(p).begin() + (end - from.begin(p)), values.begin());
+
+                std::vector<ValueType>& message = send[to.rank(q)];
+                message.insert(message.end(), values.begin(), values.end());
+            }
+        }
+    }
+
+    if (comm.size() == 1)
+        return;
+
+    comm.alltoallv(send, recv);
+
+    // the messages hold the values in the order of the ranges
+    std::vector<size_t> position(comm.size(), 0);
+
+    for (size_t p = 0; p < from.num_partitions(); p++)
+    {
+        if (from.local(p) || from.begin(p) == from.end(p))
+            continue;
+
+        for (size_t q = to.owner(from.begin(p)); q < to.num_partitions() && to.begin(q) < from.end(p); q++)
+        {
+            const size_t begin = std::max(from.begin(p), to.begin(q));
+            const size_t end   = std::min(from.end(p),   to.end(q));
+
+            if (begin >= end || !to.local(q))
+                continue;
+
+            const int r = from.rank(p);
+
+            cusp::detail::scoped_device scope(to.device(q));
+
+            thrust::copy(recv[r].begin() + position[r], recv[r].begin() + position[r] + (end - begin),
+                         dst.slice(q).begin() + (begin - to.begin(q)));
+
+            position[r] += end - begin;
+        }
+    }
+}
+
+// Move the rows of the local ranges of 'from', in the order of the
+// ranges, to the local ranges of 'to', each of which is a union of
+// consecutive ranges of 'from'.  Collective on the communicator.
+template <typename IndexType, typename ValueType>
+void distributed_redistribute_rows(const cusp::csr_matrix<IndexType,ValueType,cusp::host_memory>& rows,
+                                   const cusp::distribution& from,
+                                   const cusp::distribution& to,
+                                         cusp::csr_matrix<IndexType,ValueType,cusp::host_memory>& result)
+{
+    const cusp::communicator& comm = from.get_communicator();
+
+    // first row of each local range in rows
+    std::vector<size_t> first(from.num_partitions(), 0);
+
+    for (size_t p = 0, position = 0; p < from.num_partitions(); p++)
+    {
+        if (!from.local(p))
+            continue;
+
+        first[p]  = position;
+        position += from.end(p) - from.begin(p);
+    }
+
+    // rows for other processes: the length of each row, then its columns
+    std::vector< std::vector<IndexType> > send_index(comm.size()), recv_index;
+    std::vector< std::vector<ValueType> > send_values(comm.size()), recv_values;
+
+    for (size_t p = 0; p < from.num_partitions(); p++)
+    {
+        if (!from.local(p) || from.begin(p) == from.end(p))
+            continue;
+
+        const size_t q = to.owner(from.begin(p));
+
+        if (to.local(q))
+            continue;
+
+        std::vector<IndexType>& index  = send_index[to.rank(q)];
+        std::vector<ValueType>& values = send_values[to.rank(q)];
+
+        for (size_t i = first[p]; i < first[p] + (from.end(p) - from.begin(p)); i++)
+        {
+            index.push_back(rows.row_offsets[i + 1] - rows.row_offsets[i]);
+            index.insert(index.end(),   rows.column_indices.begin() + rows.row_offsets[i], rows.column_indices.begin() + rows.row_offsets[i + 1]);
+            values.insert(values.end(), rows.values.begin()         + rows.row_offsets[i], rows.values.begin()         + rows.row_offsets[i + 1]);
+        }
+    }
+
+    if (comm.size() > 1)
+    {
+        comm.alltoallv(send_index,  recv_index);
+        comm.alltoallv(send_values, recv_values);
+    }
+
+    std::vector<size_t> index_position(comm.size(), 0);
+    std::vector<size_t> value_position(comm.size(), 0);
+
+    std::vector<IndexType> offsets(1, IndexType(0));
+    std::vector<IndexType> columns;
+    std::vector<ValueType> values;
+
+    for (size_t p = 0; p < from.num_partitions(); p++)
+    {
+        if (from.begin(p) == from.end(p) || !to.local(to.owner(from.begin(p))))
+            continue;
+
+        const size_t num_rows = from.end(p) - from.begin(p);
+
+        if (from.local(p))
+        {
+            for (size_t i = first[p]; i < first[p] + num_rows; i++)
+            {
+                columns.insert(columns.end(), rows.column_indices.begin() + rows.row_offsets[i], rows.column_indices.begin() + rows.row_offsets[i + 1]);
+                values.insert(values.end(),   rows.values.begin()         + rows.row_offsets[i], rows.values.begin()         + rows.row_offsets[i + 1]);
+                offsets.push_back(IndexType(columns.size()));
+            }
+        }
+        else
+        {
+            const int r = from.rank(p);
+
+            for (size_t i = 0; i < num_rows; i++)
+            {
+                const size_t length = recv_index[r][index_position[r]++];
+
+                columns.insert(columns.end(), recv_index[r].begin()  + index_position[r], recv_index[r].begin()  + index_position[r] + length);
+                values.insert(values.end(),   recv_values[r].begin() + value_position[r], recv_values[r].begin() + value_position[r] + length);
+                offsets.push_back(IndexType(columns.size()));
+
+                index_position[r] += length;
+                value_position[r] += length;
+            }
+        }
+    }
+
+    distributed_assign_rows(result, rows.num_cols, offsets, columns, values);
+}
+
+// The rows of the prolongator that belong to the halo columns of each
+// local range, with global coarse columns.  P holds the prolongator of
+// every local range with the coarse columns of the range, and the rows
+// of other processes are requested from their owners.
+template <typename IndexType, typename ValueType>
+void distributed_halo_prolongator(const cusp::distribution& d,
+                                  const cusp::distribution& dc,
+                                  const std::vector< cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> >& P,
+                                  const std::vector< std::vector<IndexType> >& halo,
+                                        std::vector< cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> >& P_halo)
+{
+    const cusp::communicator& comm = d.get_communicator();
+    const int num_procs = comm.size();
+
+    // the sorted halo columns requested from each process
+    std::vector< std::vector<IndexType> > requests(num_procs), received;
+
+    for (size_t p = 0; p < d.num_partitions(); p++)
+        for (size_t k = 0; k < halo[p].size(); k++)
+            if (!d.local(d.owner(halo[p][k])))
+                requests[d.rank(d.owner(halo[p][k]))].push_back(halo[p][k]);
+
+    for (int r = 0; r < num_procs; r++)
+    {
+        std::sort(requests[r].begin(), requests[r].end());
+        requests[r].erase(std::unique(requests[r].begin(), requests[r].end()), requests[r].end());
+    }
+
+    // the replies: the length of each row, then its global coarse columns
+    std::vector< std::vector<IndexType> > reply_index(num_procs), index;
+    std::vector< std::vector<ValueType> > reply_values(num_procs), values;
+
+    if (num_procs > 1)
+    {
+        comm.alltoallv(requests, received);
+
+        for (int r = 0; r < num_procs; r++)
+        {
+            for (size_t k = 0; k < received[r].size(); k++)
+            {
+                const size_t q = d.owner(received[r][k]);
+                const size_t i = received[r][k] - d.begin(q);
+
+                reply_index[r].push_back(P[q].row_offsets[i + 1] - P[q].row_offsets[i]);
+
+                for (IndexType jj = P[q].row_offsets[i]; jj < P[q].row_offsets[i + 1]; jj++)
+                {
+                    reply_index[r].push_back(IndexType(P[q].column_indices[jj] + dc.begin(q)));
+                    reply_values[r].push_back(P[q].values[jj]);
+                }
+            }
+        }
+
+        comm.alltoallv(reply_index,  index);
+        comm.alltoallv(reply_values, values);
+    }
+
+    // position of the row of each request in the replies
+    std::vector< std::vector<size_t> > index_offsets(num_procs), value_offsets(num_procs);
+
+    for (int r = 0; r < num_procs; r++)
+    {
+        for (size_t k = 0, pos = 0, vpos = 0; k < requests[r].size(); k++)
+        {
+            index_offsets[r].push_back(pos);
+            value_offsets[r].push_back(vpos);
+
+            const size_t length = index[r][pos];
+            pos  += length + 1;
+            vpos += length;
+        }
+    }
+
+    P_halo.resize(d.num_partitions());
+
+    for (size_t p = 0; p < d.num_partitions(); p++)
+    {
+        if (!d.local(p))
+            continue;
+
+        std::vector<IndexType> offsets(1, IndexType(0));
+        std::vector<IndexType> columns;
+        std::vector<ValueType> row_values;
+
+        for (size_t k = 0; k < halo[p].size(); k++)
+        {
+            const IndexType j = halo[p][k];
+            const size_t    q = d.owner(j);
+
+            if (d.local(q))
+            {
+                const size_t i = j - d.begin(q);
+
+                for (IndexType jj = P[q].row_offsets[i]; jj < P[q].row_offsets[i + 1]; jj++)
+                {
+                    columns.push_back(IndexType(P[q].column_indices[jj] + dc.begin(q)));
+                    row_values.push_back(P[q].values[jj]);
+                }
+            }
+            else
+            {
+                const int    r = d.rank(q);
+                const size_t m = std::lower_bound(requests[r].begin(), requests[r].end(), j) - requests[r].begin();
+
+                const size_t pos    = index_offsets[r][m];
+                const size_t vpos   = value_offsets[r][m];
+                const size_t length = index[r][pos];
+
+                columns.insert(columns.end(),       index[r].begin()  + pos + 1, index[r].begin()  + pos + 1 + length);
+                row_values.insert(row_values.end(), values[r].begin() + vpos,    values[r].begin() + vpos + length);
+            }
+
+            offsets.push_back(IndexType(columns.size()));
+        }
+
+        distributed_assign_rows(P_halo[p], dc.size(), offsets, columns, row_values);
+    }
+}
+
+// rho(D^-1 A) of a distributed matrix by the power method, with Dinv
+// holding the reciprocals of the diagonal
+template <typename Matrix, typename ValueType>
+ValueType distributed_estimate_rho_Dinv_A(const Matrix& A, const cusp::distributed_array1d<ValueType>& Dinv,
+                                          const size_t num_iterations = 20)
+{
+    const cusp::distribution& d = Dinv.get_distribution();
+
+    cusp::distributed_array1d<ValueType> x(d);
+    cusp::distributed_array1d<ValueType> y(d);
+
+    // a start vector that does not depend on the distribution
+    for (size_t p = 0; p < d.num_partitions(); p++)
+    {
+        if (!d.local(p))
+            continue;
+
+        cusp::array1d<ValueType,cusp::host_memory> v(d.end(p) - d.begin(p));
+
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = ValueType(((d.begin(p) + i) * 2654435761u) % 1021 + 1);
+
+        cusp::detail::scoped_device scope(d.device(p));
+        x.slice(p) = v;
+    }
+
+    ValueType norm = cusp::blas::nrm2(x);
+    ValueType rho  = 0;
+
+    if (norm == ValueType(0))
+        return rho;
+
+    cusp::blas::scal(x, ValueType(1) / norm);
+
+    for (size_t k = 0; k < num_iterations; k++)
+    {
+        A(x, y);
+        cusp::blas::xmy(Dinv, y, y);
+
+        rho = cusp::blas::nrm2(y);
+
+        if (rho == ValueType(0))
+            break;
+
+        cusp::blas::copy(y, x);
+        cusp::blas::scal(x, ValueType(1) / rho);
+    }
+
+    return rho;
+}
+
+// allocate the array with a given distribution
+template <typename ValueType>
+void distributed_allocate(cusp::distributed_array1d<ValueType>& a, const cusp::distribution& d)
+{
+    cusp::scoped_distribution scope(d);
+
+    a.resize(d.size());
+}
+
+} // end namespace detail
+
+// transfer operators of one partition, on its device
+template <typename IndexType, typename ValueType>
+struct distributed_smoothed_aggregation<IndexType,ValueType>::transfer
+{
+    int device;
+    cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> P; // rows of the partition x its aggregates
+    cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> R; // P^T
+
+    transfer(void) : device(0) {}
+};
+
+template <typename IndexType, typename ValueType>
+struct distributed_smoothed_aggregation<IndexType,ValueType>::level
+{
+    cusp::distribution dist;            // rows of A
+    size_t num_entries;                 // of the whole matrix
+    DistributedMatrix * A;              // null on the coarsest level
+
+    std::vector<transfer *> transfers;  // null for the partitions of other processes
+    cusp::distribution coarse_dist;     // the aggregates of each partition
+    bool consolidated;                  // the next level has fewer partitions than coarse_dist
+
+    DistributedArray Dinv;              // smoother_weight / (rho(D^-1 A) D)
+    DistributedArray x;
+    DistributedArray b;
+    DistributedArray residual;
+    DistributedArray coarse_b;          // restricted residual, if consolidated
+    DistributedArray coarse_x;          // coarse correction, if consolidated
+
+    level(void) : num_entries(0), A(0), consolidated(false) {}
+};
+
+//////////////////
+// Constructors //
+//////////////////
+
+template <typename IndexType, typename ValueType>
+template <typename MatrixType>
+distributed_smoothed_aggregation<IndexType,ValueType>
+    ::distributed_smoothed_aggregation(const MatrixType& A, const std::vector<int>& devices, const amg_options& options)
+    : Parent(A.num_rows, A.num_cols, A.num_entries), options(options), LU(0)
+{
+    HostMatrix rows;
+    cusp::convert(A, rows);
+
+    try
+    {
+        levels.push_back(new level);
+        levels.back()->A    = new DistributedMatrix(rows, devices);
+        levels.back()->dist = levels.back()->A->get_distribution();
+
+        setup(rows);
+    }
+    catch (...)
+    {
+        release();
+        throw;
+    }
+}
+
+template <typename IndexType, typename ValueType>
+template <typename MatrixType>
+distributed_smoothed_aggregation<IndexType,ValueType>
+    ::distributed_smoothed_aggregation(const MatrixType& rows, const cusp::distribution& d, const amg_options& options)
+    : Parent(d.size(), d.size(), 0), options(options), LU(0)
+{
+    HostMatrix A;
+    cusp::convert(rows, A);
+
+    try
+    {
+        levels.push_back(new level);
+        levels.back()->A    = new DistributedMatrix(A, d);
+        levels.back()->dist = d;
+
+        Parent::resize(d.size(), d.size(), levels.back()->A->num_entries);
+
+        setup(A);
+    }
+    catch (...)
+    {
+        release();
+        throw;
+    }
+}
+
+template <typename IndexType, typename ValueType>
+distributed_smoothed_aggregation<IndexType,ValueType>
+    ::~distributed_smoothed_aggregation(void)
+{
+    release();
+}
+
+///////////
+// Setup //
+///////////
+
+// rows holds the rows of the local partitions of the current level
+// with global columns, it is replaced by those of each coarse level
+template <typename IndexType, typename ValueType>
+void distributed_smoothed_aggregation<IndexType,ValueType>
+    ::setup(HostMatrix& rows)
+{
+    levels[0]->num_entries = levels[0]->A->num_entries;
+
+    // the constant near-nullspace candidate
+    DistributedArray B(levels[0]->dist, ValueType(1));
+
+    while (levels.back()->dist.size() > options.coarse_size && levels.size() < options.max_levels)
+    {
+        level& L = *levels.back();
+
+        if (L.A == 0)
+            L.A = new DistributedMatrix(rows, L.dist);
+
+        extend_hierarchy(rows, B);
+
+        // the aggregation did not coarsen the level
+        if (levels.back() == &L)
+            break;
+    }
+
+    setup_coarse(rows);
+
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        level& L = *levels[i];
+
+        detail::distributed_allocate(L.x, L.dist);
+        detail::distributed_allocate(L.b, L.dist);
+
+        if (i + 1 < levels.size())
+            detail::distributed_allocate(L.residual, L.dist);
+    }
+}
+
+template <typename IndexType, typename ValueType>
+void distributed_smoothed_aggregation<IndexType,ValueType>
+    ::extend_hierarchy(HostMatrix& rows, DistributedArray& B)
+{
+    level& L = *levels.back();
+
+    const cusp::distribution& d    = L.dist;
+    const cusp::communicator& comm = d.get_communicator();
+    const size_t num_parts = d.num_partitions();
+
+    // first row of each local partition in rows
+    std::vector<size_t> first(num_parts, 0);
+
+    for (size_t p = 0, position = 0; p < num_parts; p++)
+    {
+        if (!d.local(p))
+            continue;
+
+        first[p]  = position;
+        position += d.end(p) - d.begin(p);
+    }
+
+    // Dinv <- D^-1
+    detail::distributed_allocate(L.Dinv, d);
+
+    for (size_t p = 0; p < num_parts; p++)
+    {
+        if (!d.local(p) || d.begin(p) == d.end(p))
+            continue;
+
+        cusp::array1d<ValueType,cusp::host_memory> dinv(d.end(p) - d.begin(p), ValueType(0));
+
+        for (size_t i = 0; i < dinv.size(); i++)
+            for (IndexType jj = rows.row_offsets[first[p] + i]; jj < rows.row_offsets[first[p] + i + 1]; jj++)
+                if (size_t(rows.column_indices[jj]) == d.begin(p) + i && rows.values[jj] != ValueType(0))
+                    dinv[i] = ValueType(1) / rows.values[jj];
+
+        cusp::detail::scoped_device scope(d.device(p));
+        L.Dinv.slice(p) = dinv;
+    }
+
+    const ValueType rho_DinvA = detail::distributed_estimate_rho_Dinv_A(*L.A, L.Dinv);
+
+    // aggregate the local block of each partition and smooth its
+    // tentative prolongator with the local block
+    std::vector<HostMatrix> P_host(num_parts);
+    std::vector< cusp::array1d<ValueType,cusp::host_memory> > B_host(num_parts);
+    std::vector<size_t> counts(num_parts, 0);
+
+    L.transfers.assign(num_parts, 0);
+
+    for (size_t p = 0; p < num_parts; p++)
+    {
+        if (!d.local(p))
+            continue;
+
+        L.transfers[p] = new transfer;
+        transfer& t = *L.transfers[p];
+        t.device = d.device(p);
+
+        const size_t num_rows = d.end(p) - d.begin(p);
+
+        if (num_rows == 0)
+            continue;
+
+        std::vector<IndexType> offsets(1, IndexType(0));
+        std::vector<IndexType> columns;
+        std::vector<ValueType> values;
+
+        for (size_t i = first[p]; i < first[p] + num_rows; i++)
+        {
+            for (IndexType jj = rows.row_offsets[i]; jj < rows.row_offsets[i + 1]; jj++)
+            {
+                const size_t j = rows.column_indices[jj];
+
+                if (d.begin(p) <= j && j < d.end(p))
+                {
+                    columns.push_back(IndexType(j - d.begin(p)));
+                    values.push_back(rows.values[jj]);
+                }
+            }
+
+            offsets.push_back(IndexType(columns.size()));
+        }
+
+        HostMatrix A_local;
+        detail::distributed_assign_rows(A_local, num_rows, offsets, columns, values);
+
+        cusp::detail::scoped_device scope(t.device);
+
+        cusp::coo_matrix<IndexType,ValueType,cusp::device_memory> A_dev(A_local);
+        cusp::coo_matrix<IndexType,ValueType,cusp::device_memory> S;
+        cusp::precond::symmetric_strength_of_connection(A_dev, S, options.theta);
+
+        cusp::array1d<IndexType,cusp::device_memory> aggregates(num_rows);
+        cusp::precond::standard_aggregation(S, aggregates);
+
+        cusp::coo_matrix<IndexType,ValueType,cusp::device_memory> T;
+        cusp::coo_matrix<IndexType,ValueType,cusp::device_memory> P;
+        cusp::array1d<ValueType,cusp::device_memory> B_coarse;
+        detail::fit_candidates(aggregates, B.slice(p), T, B_coarse);
+
+        cusp::precond::smooth_prolongator(A_dev, T, P, ValueType(options.prolongator_weight), rho_DinvA);
+
+        t.P = P;
+        cusp::transpose(t.P, t.R);
+
+        P_host[p] = t.P;
+        B_host[p] = B_coarse;
+        counts[p] = t.P.num_cols;
+    }
+
+    cusp::distribution dc = detail::distributed_coarse_distribution(d, counts);
+
+    if (dc.size() == 0 || dc.size() >= d.size())
+    {
+        for (size_t p = 0; p < num_parts; p++)
+        {
+            if (L.transfers[p] == 0)
+                continue;
+
+            cusp::detail::scoped_device scope(L.transfers[p]->device);
+            delete L.transfers[p];
+        }
+
+        L.transfers.clear();
+
+        return;
+    }
+
+    L.coarse_dist = dc;
+
+    // the smoother weight
+    cusp::blas::scal(L.Dinv, ValueType(options.smoother_weight) / rho_DinvA);
+
+    // the sorted halo columns of each partition
+    std::vector< std::vector<IndexType> > halo(num_parts);
+
+    for (size_t p = 0; p < num_parts; p++)
+    {
+        if (!d.local(p))
+            continue;
+
+        const size_t num_rows = d.end(p) - d.begin(p);
+
+        for (IndexType jj = rows.row_offsets[first[p]]; jj < rows.row_offsets[first[p] + num_rows]; jj++)
+        {
+            const size_t j = rows.column_indices[jj];
+
+            if (j < d.begin(p) || d.end(p) <= j)
+                halo[p].push_back(IndexType(j));
+        }
+
+        std::sort(halo[p].begin(), halo[p].end());
+        halo[p].erase(std::unique(halo[p].begin(), halo[p].end()), halo[p].end());
+    }
+
+    std::vector<HostMatrix> P_halo;
+    detail::distributed_halo_prolongator(d, dc, P_host, halo, P_halo);
+
+    // coarse rows of each partition: R_p * (A_p * P), where A_p holds the
+    // rows of the partition with the local columns followed by the halo
+    // columns and P the matching rows of the prolongator
+    std::vector<IndexType> coarse_offsets(1, IndexType(0));
+    std::vector<IndexType> coarse_columns;
+    std::vector<ValueType> coarse_values;
+
+    for (size_t p = 0; p < num_parts; p++)
+    {
+        if (!d.local(p) || d.begin(p) == d.end(p))
+            continue;
+
+        const size_t num_rows = d.end(p) - d.begin(p);
+
+        std::vector<IndexType> offsets(1, IndexType(0));
+        std::vector<IndexType> columns;
+        std::vector<ValueType> values;
+
+        for (size_t i = first[p]; i < first[p] + num_rows; i++)
+        {
+            for (IndexType jj = rows.row_offsets[i]; jj < rows.row_offsets[i + 1]; jj++)
+            {
+                const size_t j = rows.column_indices[jj];
+
+                if (d.begin(p) <= j && j < d.end(p))
+                    columns.push_back(IndexType(j - d.begin(p)));
+                else
+                    columns.push_back(IndexType(num_rows + (std::lower_bound(halo[p].begin(), halo[p].end(), IndexType(j)) - halo[p].begin())));
+
+                values.push_back(rows.values[jj]);
+            }
+
+            offsets.push_back(IndexType(columns.size()));
+        }
+
+        HostMatrix A_ext;
+        detail::distributed_assign_rows(A_ext, num_rows + halo[p].size(), offsets, columns, values);
+
+        offsets.assign(1, IndexType(0));
+        columns.clear();
+        values.clear();
+
+        const HostMatrix& P_p = P_host[p];
+
+        for (size_t i = 0; i < num_rows; i++)
+        {
+            for (IndexType jj = P_p.row_offsets[i]; jj < P_p.row_offsets[i + 1]; jj++)
+            {
+                columns.push_back(IndexType(P_p.column_indices[jj] + dc.begin(p)));
+                values.push_back(P_p.values[jj]);
+            }
+
+            offsets.push_back(IndexType(columns.size()));
+        }
+
+        for (size_t k = 0; k < halo[p].size(); k++)
+        {
+            const HostMatrix& H = P_halo[p];
+
+            columns.insert(columns.end(), H.column_indices.begin() + H.row_offsets[k], H.column_indices.begin() + H.row_offsets[k + 1]);
+            values.insert(values.end(),   H.values.begin()         + H.row_offsets[k], H.values.begin()         + H.row_offsets[k + 1]);
+            offsets.push_back(IndexType(columns.size()));
+        }
+
+        HostMatrix P_ext;
+        detail::distributed_assign_rows(P_ext, dc.size(), offsets, columns, values);
+
+        cusp::detail::scoped_device scope(d.device(p));
+
+        cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> A_dev(A_ext);
+        cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> P_dev(P_ext);
+        cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> AP;
+        cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> RAP;
+
+        cusp::multiply(A_dev, P_dev, AP);
+        cusp::multiply(L.transfers[p]->R, AP, RAP);
+
+        HostMatrix RAP_host(RAP);
+
+        for (size_t i = 0; i < RAP_host.num_rows; i++)
+        {
+            coarse_columns.insert(coarse_columns.end(), RAP_host.column_indices.begin() + RAP_host.row_offsets[i], RAP_host.column_indices.begin() + RAP_host.row_offsets[i + 1]);
+            coarse_values.insert(coarse_values.end(),   RAP_host.values.begin()         + RAP_host.row_offsets[i], RAP_host.values.begin()         + RAP_host.row_offsets[i + 1]);
+            coarse_offsets.push_back(IndexType(coarse_columns.size()));
+        }
+    }
+
+    HostMatrix coarse_rows;
+    detail::distributed_assign_rows(coarse_rows, dc.size(), coarse_offsets, coarse_columns, coarse_values);
+
+    DistributedArray B_coarse(dc);
+
+    for (size_t p = 0; p < num_parts; p++)
+    {
+        if (!d.local(p) || B_host[p].empty())
+            continue;
+
+        cusp::detail::scoped_device scope(d.device(p));
+        B_coarse.slice(p) = B_host[p];
+    }
+
+    // move small levels onto fewer partitions, the coarsest onto one
+    cusp::distribution next = dc;
+
+    if (dc.size() <= options.coarse_size || levels.size() + 1 >= options.max_levels)
+        next = detail::distributed_consolidate(dc, 1);
+    else if (dc.num_partitions() > 1 && dc.size() < options.consolidation_size * dc.num_partitions())
+        next = detail::distributed_consolidate(dc, std::max<size_t>(1, dc.size() / std::max<size_t>(1, options.consolidation_size)));
+
+    std::vector<size_t> num_entries;
+    comm.allgather(size_t(coarse_rows.num_entries), num_entries);
+
+    levels.push_back(new level);
+    levels.back()->dist        = next;
+    levels.back()->num_entries = std::accumulate(num_entries.begin(), num_entries.end(), size_t(0));
+
+    if (next != dc)
+    {
+        L.consolidated = true;
+        detail::distributed_allocate(L.coarse_b, dc);
+        detail::distributed_allocate(L.coarse_x, dc);
+
+        HostMatrix moved;
+        detail::distributed_redistribute_rows(coarse_rows, dc, next, moved);
+        rows.swap(moved);
+
+        DistributedArray B_moved(next);
+        detail::distributed_redistribute(B_coarse, B_moved);
+        B = B_moved;
+    }
+    else
+    {
+        rows.swap(coarse_rows);
+        B = B_coarse;
+    }
+}
+
+// factor the coarsest matrix on a single device
+template <typename IndexType, typename ValueType>
+void distributed_smoothed_aggregation<IndexType,ValueType>
+    ::setup_coarse(const HostMatrix& rows)
+{
+    const level& L = *levels.back();
+
+    solve_dist = L.dist.num_partitions() == 1 ? L.dist : detail::distributed_consolidate(L.dist, 1);
+
+    HostMatrix moved;
+    const HostMatrix * coarse = &rows;
+
+    if (solve_dist != L.dist)
+    {
+        detail::distributed_redistribute_rows(rows, L.dist, solve_dist, moved);
+        coarse = &moved;
+
+        detail::distributed_allocate(solve_b, solve_dist);
+        detail::distributed_allocate(solve_x, solve_dist);
+    }
+
+    if (!solve_dist.local(0))
+        return;
+
+    cusp::detail::scoped_device scope(solve_dist.device(0));
+
+    cusp::array2d<ValueType,cusp::host_memory> coarse_dense(*coarse);
+    LU = new cusp::detail::lu_solver<ValueType, cusp::device_memory>(coarse_dense);
+}
+
+template <typename IndexType, typename ValueType>
+void distributed_smoothed_aggregation<IndexType,ValueType>
+    ::release(void)
+{
+    if (LU != 0)
+    {
+        cusp::detail::scoped_device scope(solve_dist.device(0));
+        delete LU;
+        LU = 0;
+    }
+
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        level * L = levels[i];
+
+        for (size_t p = 0; p < L->transfers.size(); p++)
+        {
+            if (L->transfers[p] == 0)
+                continue;
+
+            cusp::detail::scoped_device scope(L->transfers[p]->device);
+            delete L->transfers[p];
+        }
+
+        delete L->A;
+        delete L;
+    }
+
+    levels.clear();
+}
+
+///////////
+// Cycle //
+///////////
+
+// x <- x + Dinv (b - A x)
+template <typename IndexType, typename ValueType>
+void distributed_smoothed_aggregation<IndexType,ValueType>
+    ::jacobi_sweep(level& L, const DistributedArray& b, DistributedArray& x)
+{
+    (*L.A)(x, L.residual);
+    cusp::blas::axpby(b, L.residual, L.residual, ValueType(1), ValueType(-1));
+    cusp::blas::xmy(L.Dinv, L.residual, L.residual);
+    cusp::blas::axpy(L.residual, x, ValueType(1));
+}
+
+template <typename IndexType, typename ValueType>
+void distributed_smoothed_aggregation<IndexType,ValueType>
+    ::cycle(const size_t i, const DistributedArray& b, DistributedArray& x)
+{
+    if (i + 1 == levels.size())
+    {
+        // coarsest level
+        if (solve_dist == levels[i]->dist)
+        {
+            if (LU != 0)
+            {
+                cusp::detail::scoped_device scope(solve_dist.device(0));
+                (*LU)(b.slice(0), x.slice(0));
+            }
+        }
+        else
+        {
+            detail::distributed_redistribute(b, solve_b);
+
+            if (LU != 0)
+            {
+                cusp::detail::scoped_device scope(solve_dist.device(0));
+                (*LU)(solve_b.slice(0), solve_x.slice(0));
+            }
+
+            detail::distributed_redistribute(solve_x, x);
+        }
+
+        return;
+    }
+
+    level& L = *levels[i];
+    level& N = *levels[i + 1];
+
+    const cusp::distribution& d = L.dist;
+
+    // presmooth from a zero initial guess
+    if (options.presmooth_sweeps == 0)
+        cusp::blas::fill(x, ValueType(0));
+    else
+        cusp::blas::xmy(L.Dinv, b, x);
+
+    for (size_t k = 1; k < options.presmooth_sweeps; k++)
+        jacobi_sweep(L, b, x);
+
+    // residual <- b - A x
+    (*L.A)(x, L.residual);
+    cusp::blas::axpby(b, L.residual, L.residual, ValueType(1), ValueType(-1));
+
+    DistributedArray& coarse_b = L.consolidated ? L.coarse_b : N.b;
+    DistributedArray& coarse_x = L.consolidated ? L.coarse_x : N.x;
+
+    // restriction and prolongation are local to the partitions
+    for (size_t p = 0; p < d.num_partitions(); p++)
+    {
+        if (!d.local(p) || d.begin(p) == d.end(p))
+            continue;
+
+        cusp::detail::scoped_device scope(d.device(p));
+        cusp::multiply(L.transfers[p]->R, L.residual.slice(p), coarse_b.slice(p));
+    }
+
+    if (L.consolidated)
+        detail::distributed_redistribute(L.coarse_b, N.b);
+
+    cycle(i + 1, N.b, N.x);
+
+    if (L.consolidated)
+        detail::distributed_redistribute(N.x, L.coarse_x);
+
+    for (size_t p = 0; p < d.num_partitions(); p++)
+    {
+        if (!d.local(p) || d.begin(p) == d.end(p))
+            continue;
+
+        cusp::detail::scoped_device scope(d.device(p));
+        cusp::multiply(L.transfers[p]->P, coarse_x.slice(p), x.slice(p), ValueType(1), ValueType(1));
+    }
+
+    for (size_t k = 0; k < options.postsmooth_sweeps; k++)
+        jacobi_sweep(L, b, x);
+}
+
+template <typename IndexType, typename ValueType>
+template <typename Array1, typename Array2>
+void distributed_smoothed_aggregation<IndexType,ValueType>
+    ::operator()(const Array1& b, Array2& x)
+{
+    CUSP_PROFILE_SCOPED();
+
+    const DistributedArray& b_ = b;
+          DistributedArray& x_ = x;
+
+    if (b_.get_distribution() != levels[0]->dist || x_.get_distribution() != levels[0]->dist)
+        throw cusp::invalid_input_exception("vectors do not match the distribution of the hierarchy");
+
+    cycle(0, b_, x_);
+}
+
+template <typename IndexType, typename ValueType>
+double distributed_smoothed_aggregation<IndexType,ValueType>
+    ::operator_complexity(void) const
+{
+    double nnz = 0;
+
+    for (size_t i = 0; i < levels.size(); i++)
+        nnz += levels[i]->num_entries;
+
+    return nnz / levels[0]->num_entries;
+}
+
+template <typename IndexType, typename ValueType>
+double distributed_smoothed_aggregation<IndexType,ValueType>
+    ::grid_complexity(void) const
+{
+    double nodes = 0;
+
+    for (size_t i = 0; i < levels.size(); i++)
+        nodes += levels[i]->dist.size();
+
+    return nodes / levels[0]->dist.size();
+}
+
+} // end namespace precond
+} // end namespace cusp
+
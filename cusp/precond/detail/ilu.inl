@@ -0,0 +1,327 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file ilu.inl
+ *  \brief Inline file for ilu.h
+ */
+
+#include <cusp/copy.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/transpose.h>
+#include <cusp/triangular_solve.h>
+#include <cusp/detail/format_utils.h>
+
+#include <thrust/count.h>
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/remove.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <cmath>
+
+namespace cusp
+{
+namespace precond
+{
+namespace detail
+{
+
+// entries (i,j) above the main diagonal
+struct is_upper_entry
+{
+    template <typename Tuple>
+    __host__ __device__
+    bool operator()(const Tuple& t) const
+    {
+        return thrust::get<1>(t) > thrust::get<0>(t);
+    }
+};
+
+template <typename ValueType>
+struct is_not_positive
+{
+    __host__ __device__
+    bool operator()(const ValueType v) const
+    {
+        // also true for NaN
+        return !(v > ValueType(0));
+    }
+};
+
+template <typename ValueType>
+struct is_zero_pivot
+{
+    __host__ __device__
+    bool operator()(const ValueType v) const
+    {
+        return v == ValueType(0);
+    }
+};
+
+// CSR copy of A (or of its lower triangle) with sorted column indices
+template <typename MatrixType, typename IndexType, typename ValueType, typename MemorySpace>
+void sorted_csr_copy(const MatrixType& A, cusp::csr_matrix<IndexType,ValueType,MemorySpace>& B, const bool lower_triangle)
+{
+    if (A.num_rows != A.num_cols)
+        throw cusp::invalid_input_exception("matrix must be square");
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> C(A);
+
+    cusp::detail::sort_by_row_and_column(C.row_indices, C.column_indices, C.values);
+
+    if (lower_triangle)
+    {
+        const size_t num_entries =
+            thrust::remove_if(thrust::make_zip_iterator(thrust::make_tuple(C.row_indices.begin(), C.column_indices.begin(), C.values.begin())),
+                              thrust::make_zip_iterator(thrust::make_tuple(C.row_indices.end(),   C.column_indices.end(),   C.values.end())),
+                              is_upper_entry())
+            - thrust::make_zip_iterator(thrust::make_tuple(C.row_indices.begin(), C.column_indices.begin(), C.values.begin()));
+
+        C.resize(C.num_rows, C.num_cols, num_entries);
+    }
+
+    B = C;
+}
+
+// ILU(0) of row i, given the factored rows it depends on (IKJ variant)
+template <typename IndexType, typename ValueType>
+struct ilu0_factor_row
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const IndexType * diagonal_positions;
+          ValueType * values;
+
+    ilu0_factor_row(const IndexType * row_offsets, const IndexType * column_indices,
+                    const IndexType * diagonal_positions, ValueType * values)
+        : row_offsets(row_offsets), column_indices(column_indices),
+          diagonal_positions(diagonal_positions), values(values) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        const IndexType row_end = row_offsets[i + 1];
+
+        for (IndexType kk = row_offsets[i]; kk < diagonal_positions[i]; kk++)
+        {
+            const IndexType k = column_indices[kk];
+
+            // l_ik <- a_ik / u_kk
+            const ValueType l_ik = values[kk] / values[diagonal_positions[k]];
+            values[kk] = l_ik;
+
+            // a_ij <- a_ij - l_ik * u_kj for the entries (i,j) with j > k
+            IndexType jj = kk + 1;
+
+            for (IndexType ll = diagonal_positions[k] + 1; ll < row_offsets[k + 1] && jj < row_end; ll++)
+            {
+                const IndexType j = column_indices[ll];
+
+                while (jj < row_end && column_indices[jj] < j)
+                    jj++;
+
+                if (jj < row_end && column_indices[jj] == j)
+                    values[jj] -= l_ik * values[ll];
+            }
+        }
+    }
+};
+
+// IC(0) of row i of the lower triangle, whose diagonal entry is last
+template <typename IndexType, typename ValueType>
+struct ic0_factor_row
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const IndexType * diagonal_positions;
+          ValueType * values;
+
+    ic0_factor_row(const IndexType * row_offsets, const IndexType * column_indices,
+                   const IndexType * diagonal_positions, ValueType * values)
+        : row_offsets(row_offsets), column_indices(column_indices),
+          diagonal_positions(diagonal_positions), values(values) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        const IndexType row_start = row_offsets[i];
+
+        ValueType sum_squares = 0;
+
+        for (IndexType kk = row_start; kk < diagonal_positions[i]; kk++)
+        {
+            const IndexType k = column_indices[kk];
+
+            // l_ik <- (a_ik - sum_{j < k} l_ij l_kj) / l_kk
+            ValueType l_ik = values[kk];
+
+            IndexType jj = row_start;
+
+            for (IndexType ll = row_offsets[k]; ll < diagonal_positions[k] && jj < kk; ll++)
+            {
+                const IndexType j = column_indices[ll];
+
+                while (jj < kk && column_indices[jj] < j)
+                    jj++;
+
+                if (jj < kk && column_indices[jj] == j)
+                    l_ik -= values[jj] * values[ll];
+            }
+
+            l_ik /= values[diagonal_positions[k]];
+
+            values[kk]   = l_ik;
+            sum_squares += l_ik * l_ik;
+        }
+
+        // l_ii <- sqrt(a_ii - sum_{j < i} l_ij^2), NaN when not positive
+        values[diagonal_positions[i]] = sqrt(values[diagonal_positions[i]] - sum_squares);
+    }
+};
+
+} // end namespace detail
+
+
+///////////
+// ILU(0) //
+///////////
+
+// constructor
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template<typename MatrixType>
+    ilu0<ValueType,MemorySpace,IndexType>
+    ::ilu0(const MatrixType& A)
+        : linear_operator<ValueType,MemorySpace,IndexType>(A.num_rows, A.num_cols, A.num_entries)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        detail::sorted_csr_copy(A, LU, false);
+
+        if (LU.num_rows == 0)
+            return;
+
+        // the lower solve skips the diagonal, which belongs to U
+        cusp::triangular_solve_analyze(LU, lower_plan, true,  true);
+        cusp::triangular_solve_analyze(LU, upper_plan, false, false);
+
+        const cusp::array1d<IndexType,MemorySpace>& diagonal_positions = upper_plan.diagonal_positions;
+
+        // rows of a level of L only depend on rows of earlier levels
+        cusp::detail::for_each_level(lower_plan,
+                                     detail::ilu0_factor_row<IndexType,ValueType>(thrust::raw_pointer_cast(&LU.row_offsets[0]),
+                                                                                  thrust::raw_pointer_cast(&LU.column_indices[0]),
+                                                                                  thrust::raw_pointer_cast(&diagonal_positions[0]),
+                                                                                  thrust::raw_pointer_cast(&LU.values[0])));
+
+        const size_t num_zero_pivots =
+            thrust::count_if(thrust::make_permutation_iterator(LU.values.begin(), diagonal_positions.begin()),
+                             thrust::make_permutation_iterator(LU.values.begin(), diagonal_positions.end()),
+                             detail::is_zero_pivot<ValueType>());
+
+        if (num_zero_pivots > 0)
+            throw cusp::runtime_exception("zero pivot in incomplete LU factorization");
+    }
+        
+// linear operator
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template <typename VectorType1, typename VectorType2>
+    void ilu0<ValueType,MemorySpace,IndexType>
+    ::operator()(const VectorType1& x, VectorType2& y) const
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (LU.num_rows == 0)
+            return;
+
+        // y <- L^-1 x
+        cusp::triangular_solve(LU, lower_plan, x, y);
+
+        // y <- U^-1 y
+        cusp::triangular_solve(LU, upper_plan, y, y);
+    }
+
+
+///////////
+// IC(0) //
+///////////
+
+// constructor
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template<typename MatrixType>
+    ic0<ValueType,MemorySpace,IndexType>
+    ::ic0(const MatrixType& A)
+        : linear_operator<ValueType,MemorySpace,IndexType>(A.num_rows, A.num_cols, A.num_entries)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        detail::sorted_csr_copy(A, L, true);
+
+        if (L.num_rows == 0)
+            return;
+
+        cusp::triangular_solve_analyze(L, lower_plan, true, false);
+
+        const cusp::array1d<IndexType,MemorySpace>& L_diagonal_positions = lower_plan.diagonal_positions;
+
+        cusp::detail::for_each_level(lower_plan,
+                                     detail::ic0_factor_row<IndexType,ValueType>(thrust::raw_pointer_cast(&L.row_offsets[0]),
+                                                                                 thrust::raw_pointer_cast(&L.column_indices[0]),
+                                                                                 thrust::raw_pointer_cast(&L_diagonal_positions[0]),
+                                                                                 thrust::raw_pointer_cast(&L.values[0])));
+
+        const size_t num_bad_pivots =
+            thrust::count_if(thrust::make_permutation_iterator(L.values.begin(), L_diagonal_positions.begin()),
+                             thrust::make_permutation_iterator(L.values.begin(), L_diagonal_positions.end()),
+                             detail::is_not_positive<ValueType>());
+
+        if (num_bad_pivots > 0)
+            throw cusp::runtime_exception("nonpositive pivot in incomplete Cholesky factorization");
+
+        // L^T is read by rows in the backward solve
+        {
+            cusp::csr_matrix<IndexType,ValueType,MemorySpace> T;
+            cusp::transpose(L, T);
+            detail::sorted_csr_copy(T, L_t, false);
+        }
+
+        cusp::triangular_solve_analyze(L_t, upper_plan, false, false);
+    }
+    }
+        
+// linear operator
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template <typename VectorType1, typename VectorType2>
+    void ic0<ValueType,MemorySpace,IndexType>
+    ::operator()(const VectorType1& x, VectorType2& y) const
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (L.num_rows == 0)
+            return;
+
+        // y <- L^-1 x
+        cusp::triangular_solve(L, lower_plan, x, y);
+
+        // y <- L^-T y
+        cusp::triangular_solve(L_t, upper_plan, y, y);
+    }
+
+} // end namespace precond
+} // end namespace cusp
+
@@ -0,0 +1,174 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file polynomial.inl
+ *  \brief Inline file for polynomial.h
+ */
+
+#include <cusp/blas.h>
+#include <cusp/convert.h>
+#include <cusp/exception.h>
+#include <cusp/matrix_powers.h>
+#include <cusp/relaxation/chebyshev.h>
+#include <cusp/detail/format_utils.h>
+
+#include <thrust/functional.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+
+#include <vector>
+
+namespace cusp
+{
+namespace precond
+{
+namespace detail
+{
+
+// q <- q (c0 + c1 t), for coefficients stored lowest degree first
+inline void polynomial_multiply_linear(std::vector<double>& q, const double c0, const double c1)
+{
+    q.push_back(0);
+
+    for (size_t i = q.size() - 1; i > 0; i--)
+        q[i] = c0 * q[i] + c1 * q[i - 1];
+
+    q[0] = c0 * q[0];
+}
+
+// residual polynomial (1 - omega t)^(degree + 1)
+inline void neumann_residual_polynomial(const size_t degree, const double omega, std::vector<double>& q)
+{
+    q.assign(1, 1.0);
+
+    for (size_t k = 0; k <= degree; k++)
+        polynomial_multiply_linear(q, 1.0, -omega);
+}
+
+// residual polynomial T_{degree+1}(s(t)) / T_{degree+1}(s(0)) with
+// s(t) = (b + a - 2 t) / (b - a), which maps [a,b] onto [-1,1]
+inline void chebyshev_residual_polynomial(const size_t degree, const double a, const double b, std::vector<double>& q)
+{
+    const double alpha =  (b + a) / (b - a);
+    const double beta  = -2.0 / (b - a);
+
+    // T_{k+1} = 2 s T_k - T_{k-1}
+    std::vector<double> T0(1, 1.0);
+    std::vector<double> T1(T0);
+    polynomial_multiply_linear(T1, alpha, beta);
+
+    for (size_t k = 1; k <= degree; k++)
+    {
+        std::vector<double> T2(T1);
+        polynomial_multiply_linear(T2, 2 * alpha, 2 * beta);
+
+        for (size_t i = 0; i < T0.size(); i++)
+            T2[i] -= T0[i];
+
+        T0.swap(T1);
+        T1.swap(T2);
+    }
+
+    // q(0) = 1
+    q.resize(T1.size());
+    for (size_t i = 0; i < T1.size(); i++)
+        q[i] = T1[i] / T1[0];
+}
+
+} // end namespace detail
+
+
+// constructor
+template <typename ValueType, typename MemorySpace>
+    template<typename MatrixType>
+    polynomial<ValueType,MemorySpace>
+    ::polynomial(const MatrixType& A,
+                 const size_t degree,
+                 const polynomial_type type,
+                 const ValueType lower,
+                 const ValueType upper,
+                 const size_t power_iterations)
+        : linear_operator<ValueType,MemorySpace>(A.num_rows, A.num_cols, A.num_entries), rho(0)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (!(upper > 0) || (type == chebyshev && !(lower >= 0 && lower < upper)))
+            throw cusp::invalid_input_exception("polynomial preconditioner requires 0 <= lower < upper");
+
+        if (power_iterations < 2)
+            throw cusp::invalid_input_exception("polynomial preconditioner requires two or more power iterations");
+
+        cusp::array1d<ValueType, MemorySpace> diagonal;
+        cusp::detail::extract_diagonal(A, diagonal);
+
+        diagonal_reciprocals.resize(diagonal.size());
+        thrust::transform(thrust::make_constant_iterator(ValueType(1)),
+                          thrust::make_constant_iterator(ValueType(1)) + diagonal.size(),
+                          diagonal.begin(), diagonal_reciprocals.begin(), thrust::divides<ValueType>());
+
+        rho = cusp::relaxation::detail::chebyshev_spectral_radius(A, diagonal, power_iterations);
+
+        // scale the rows of A by D^-1
+        cusp::convert(A, scaled_matrix);
+        {
+            cusp::array1d<int, MemorySpace> row_indices(scaled_matrix.num_entries);
+            cusp::detail::offsets_to_indices(scaled_matrix.row_offsets, row_indices);
+
+            thrust::transform(scaled_matrix.values.begin(), scaled_matrix.values.end(),
+                              thrust::make_permutation_iterator(diagonal_reciprocals.begin(), row_indices.begin()),
+                              scaled_matrix.values.begin(), thrust::multiplies<ValueType>());
+        }
+
+        // p(t) = (1 - q(t)) / t, the damped Jacobi iteration when rho vanishes
+        std::vector<double> q;
+
+        if (rho == ValueType(0))
+            detail::neumann_residual_polynomial(0, 1.0, q);
+        else if (type == neumann)
+            detail::neumann_residual_polynomial(degree, 1.0 / (upper * rho), q);
+        else
+            detail::chebyshev_residual_polynomial(degree, lower * rho, upper * rho, q);
+
+        coefficients.resize(q.size() - 1);
+        for (size_t k = 0; k < coefficients.size(); k++)
+            coefficients[k] = ValueType(-q[k + 1]);
+    }
+
+// linear operator
+template <typename ValueType, typename MemorySpace>
+    template <typename VectorType1, typename VectorType2>
+    void polynomial<ValueType, MemorySpace>
+    ::operator()(const VectorType1& x, VectorType2& y) const
+    {
+        CUSP_PROFILE_SCOPED();
+
+        const size_t degree = coefficients.size() - 1;
+
+        z.resize(x.size());
+        cusp::blas::xmy(diagonal_reciprocals, x, z);
+
+        cusp::matrix_powers(scaled_matrix, z, degree, powers);
+
+        cusp::blas::axpby(powers.column(0), powers.column(0), y, coefficients[0], ValueType(0));
+
+        for (size_t k = 1; k <= degree; k++)
+            cusp::blas::axpy(powers.column(k), y, coefficients[k]);
+    }
+
+} // end namespace precond
+} // end namespace cusp
@@ -0,0 +1,870 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cusp/blas.h>
+#include <cusp/copy.h>
+#include <cusp/elementwise.h>
+#include <cusp/exception.h>
+#include <cusp/galerkin_product.h>
+#include <cusp/multiply.h>
+#include <cusp/monitor.h>
+#include <cusp/transpose.h>
+#include <cusp/graph/maximal_independent_set.h>
+#include <cusp/precond/strength.h>
+
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/multigrid.h>
+
+#include <thrust/count.h>
+#include <thrust/for_each.h>
+#include <thrust/gather.h>
+#include <thrust/scan.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/counting_iterator.h>
+
+#include <iostream>
+#include <set>
+#include <utility>
+
+namespace cusp
+{
+namespace precond
+{
+namespace detail
+{
+
+// states of the points during the coarsening, the splitting of a level
+// holds the final ones
+const int RS_F_POINT   = 0;
+const int RS_C_POINT   = 1;
+const int RS_UNDECIDED = 2;
+
+// points that influence no other point are F-points, the others are undecided
+template <typename IndexType>
+struct pmis_initial_state
+{
+    const IndexType * STp;
+
+    pmis_initial_state(const IndexType * STp) : STp(STp) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType i) const
+    {
+        return STp[i + 1] == STp[i] ? RS_F_POINT : RS_UNDECIDED;
+    }
+};
+
+// An undecided point joins C if its measure exceeds that of all undecided
+// neighbors in S + S^T.  The measure is the number of points it influences
+// (the length of its row of S^T), ties are broken by the priorities of the
+// rounds of maximal_independent_set.
+template <typename IndexType>
+struct pmis_select_functor
+{
+    const IndexType * Sp;
+    const IndexType * Sj;
+    const IndexType * STp;
+    const IndexType * STj;
+    const IndexType * states;
+
+    pmis_select_functor(const IndexType * Sp, const IndexType * Sj, const IndexType * STp, const IndexType * STj, const IndexType * states)
+        : Sp(Sp), Sj(Sj), STp(STp), STj(STj), states(states) {}
+
+    // the measure of i is below that of j
+    __host__ __device__
+    bool precedes(const IndexType i, const IndexType j) const
+    {
+        const IndexType mi = STp[i + 1] - STp[i];
+        const IndexType mj = STp[j + 1] - STp[j];
+
+        if (mi != mj)
+            return mi < mj;
+
+        const unsigned int pi = cusp::graph::detail::mis_priority(i);
+        const unsigned int pj = cusp::graph::detail::mis_priority(j);
+
+        if (pi != pj)
+            return pi < pj;
+
+        return i < j;
+    }
+
+    __host__ __device__
+    IndexType operator()(const IndexType i) const
+    {
+        if (states[i] != RS_UNDECIDED)
+            return states[i];
+
+        for (IndexType jj = Sp[i]; jj < Sp[i + 1]; jj++)
+            if (states[Sj[jj]] == RS_UNDECIDED && precedes(i, Sj[jj]))
+                return RS_UNDECIDED;
+
+        for (IndexType jj = STp[i]; jj < STp[i + 1]; jj++)
+            if (states[STj[jj]] == RS_UNDECIDED && precedes(i, STj[jj]))
+                return RS_UNDECIDED;
+
+        return RS_C_POINT;
+    }
+};
+
+// undecided points that strongly depend on a C-point become F-points
+template <typename IndexType>
+struct pmis_fine_functor
+{
+    const IndexType * Sp;
+    const IndexType * Sj;
+    const IndexType * states;
+
+    pmis_fine_functor(const IndexType * Sp, const IndexType * Sj, const IndexType * states)
+        : Sp(Sp), Sj(Sj), states(states) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType i) const
+    {
+        if (states[i] == RS_UNDECIDED)
+            for (IndexType jj = Sp[i]; jj < Sp[i + 1]; jj++)
+                if (states[Sj[jj]] == RS_C_POINT)
+                    return RS_F_POINT;
+
+        return states[i];
+    }
+};
+
+// Rounds of PMIS until every point is decided.  Each round reads the
+// states of the previous one, so that the points are decided in parallel.
+// The largest undecided measure joins C in every round.
+template <typename Matrix, typename Array>
+void pmis_rounds(const Matrix& S, const Matrix& ST, Array& states)
+{
+    typedef typename Matrix::index_type IndexType;
+
+    const size_t N = states.size();
+
+    Array next(N);
+
+    while (thrust::count(states.begin(), states.end(), IndexType(RS_UNDECIDED)) > 0)
+    {
+        CUSP_PROFILE_SCOPED_DESC("pmis round");
+
+        thrust::transform(thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(N), next.begin(),
+                          pmis_select_functor<IndexType>(raw_pointer(S.row_offsets),  raw_pointer(S.column_indices),
+                                                         raw_pointer(ST.row_offsets), raw_pointer(ST.column_indices),
+                                                         raw_pointer(states)));
+        states.swap(next);
+
+        thrust::transform(thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(N), next.begin(),
+                          pmis_fine_functor<IndexType>(raw_pointer(S.row_offsets), raw_pointer(S.column_indices), raw_pointer(states)));
+        states.swap(next);
+    }
+}
+
+// First pass of the classical coarsening on host CSR matrices: the
+// undecided point of largest measure joins C, the points that depend on it
+// become F-points and the measures of the undecided points they depend on
+// grow, while those of the points the new C-point depends on shrink.
+template <typename Matrix, typename Array>
+void rs_first_pass(const Matrix& S, const Matrix& ST, Array& states)
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef std::pair<IndexType,IndexType> Entry;   // (measure, point)
+
+    const IndexType N = S.num_rows;
+
+    std::vector<IndexType> measure(N);
+    std::set<Entry> queue;
+
+    for (IndexType i = 0; i < N; i++)
+    {
+        measure[i] = ST.row_offsets[i + 1] - ST.row_offsets[i];
+
+        if (measure[i] == 0)
+        {
+            states[i] = RS_F_POINT;
+        }
+        else
+        {
+            states[i] = RS_UNDECIDED;
+            queue.insert(Entry(measure[i], i));
+        }
+    }
+
+    while (!queue.empty())
+    {
+        const IndexType i = (--queue.end())->second;
+        queue.erase(--queue.end());
+
+        states[i] = RS_C_POINT;
+
+        for (IndexType jj = ST.row_offsets[i]; jj < ST.row_offsets[i + 1]; jj++)
+        {
+            const IndexType j = ST.column_indices[jj];
+
+            if (states[j] != RS_UNDECIDED)
+                continue;
+
+            states[j] = RS_F_POINT;
+            queue.erase(Entry(measure[j], j));
+
+            for (IndexType kk = S.row_offsets[j]; kk < S.row_offsets[j + 1]; kk++)
+            {
+                const IndexType k = S.column_indices[kk];
+
+                if (states[k] == RS_UNDECIDED)
+                {
+                    queue.erase(Entry(measure[k], k));
+                    queue.insert(Entry(++measure[k], k));
+                }
+            }
+        }
+
+        for (IndexType jj = S.row_offsets[i]; jj < S.row_offsets[i + 1]; jj++)
+        {
+            const IndexType j = S.column_indices[jj];
+
+            if (states[j] == RS_UNDECIDED)
+            {
+                queue.erase(Entry(measure[j], j));
+                queue.insert(Entry(--measure[j], j));
+            }
+        }
+    }
+}
+
+// splitting[i] <- 1 if point i is a C-point of the strength matrix S
+template <typename Matrix, typename Array>
+void ruge_stuben_splitting(const Matrix& S, Array& splitting,
+                           const ruge_stuben_options::coarsening_type coarsening)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    const size_t N = S.num_rows;
+
+    Matrix ST;
+    cusp::transpose(S, ST);
+
+    splitting.resize(N);
+
+    if (coarsening == ruge_stuben_options::hmis)
+    {
+        cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> S_host(S);
+        cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> ST_host(ST);
+        cusp::array1d<IndexType,cusp::host_memory> states(N);
+
+        rs_first_pass(S_host, ST_host, states);
+
+        splitting = states;
+    }
+    else
+    {
+        thrust::transform(thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(N), splitting.begin(),
+                          pmis_initial_state<IndexType>(raw_pointer(ST.row_offsets)));
+    }
+
+    pmis_rounds(S, ST, splitting);
+}
+
+// Direct interpolation of the F-points from their strong C-neighbors, with
+// the negative and positive connections scaled separately.  The weights are
+// written in the order of the entries of A, C-points keep their diagonal
+// entry with a unit weight.
+template <typename IndexType, typename ValueType>
+struct direct_interpolation_functor
+{
+    const IndexType * Ap;
+    const IndexType * Aj;
+    const ValueType * Ax;
+    const bool      * strong;
+    const IndexType * splitting;
+          ValueType * weights;
+          bool      * keep;
+
+    direct_interpolation_functor(const IndexType * Ap, const IndexType * Aj, const ValueType * Ax, const bool * strong,
+                                 const IndexType * splitting, ValueType * weights, bool * keep)
+        : Ap(Ap), Aj(Aj), Ax(Ax), strong(strong), splitting(splitting), weights(weights), keep(keep) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        if (splitting[i] == RS_C_POINT)
+        {
+            for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+            {
+                keep[jj]    = Aj[jj] == i;
+                weights[jj] = ValueType(1);
+            }
+            return;
+        }
+
+        ValueType diagonal = 0;
+        ValueType negative = 0, negative_C = 0;
+        ValueType positive = 0, positive_C = 0;
+
+        for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+        {
+            const IndexType j = Aj[jj];
+            const ValueType a = Ax[jj];
+
+            if (j == i)
+            {
+                diagonal += a;
+                continue;
+            }
+
+            const bool interpolatory = strong[jj] && splitting[j] == RS_C_POINT;
+
+            if (a < 0)
+            {
+                negative += a;
+                if (interpolatory) negative_C += a;
+            }
+            else
+            {
+                positive += a;
+                if (interpolatory) positive_C += a;
+            }
+        }
+
+        const ValueType alpha = negative_C == 0 ? ValueType(0) : negative / negative_C;
+        ValueType beta = 0;
+
+        // without positive C-neighbors the positive connections are lumped
+        if (positive_C == 0)
+            diagonal += positive;
+        else
+            beta = positive / positive_C;
+
+        for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+        {
+            const IndexType j = Aj[jj];
+            const ValueType a = Ax[jj];
+
+            const bool interpolatory = j != i && strong[jj] && splitting[j] == RS_C_POINT && diagonal != 0;
+
+            keep[jj]    = interpolatory;
+            weights[jj] = interpolatory ? -(a < 0 ? alpha : beta) * a / diagonal : ValueType(0);
+        }
+    }
+};
+
+// a if its sign is opposite to that of the diagonal d, zero otherwise
+template <typename ValueType>
+__host__ __device__
+ValueType opposite_sign_part(const ValueType a, const ValueType d)
+{
+    return a * d < 0 ? a : ValueType(0);
+}
+
+// beta[k] <- sum of abar_kj over the strong C-neighbors j of an F-point k,
+// where abar_kj is the part of a_kj of sign opposite to the diagonal.  The
+// entries that contribute form the matrix Abar.
+template <typename IndexType, typename ValueType>
+struct extended_i_coarse_functor
+{
+    const IndexType * Ap;
+    const IndexType * Aj;
+    const ValueType * Ax;
+    const bool      * strong;
+    const IndexType * splitting;
+    const ValueType * diagonal;
+          ValueType * beta;
+          bool      * keep;
+
+    extended_i_coarse_functor(const IndexType * Ap, const IndexType * Aj, const ValueType * Ax, const bool * strong,
+                              const IndexType * splitting, const ValueType * diagonal, ValueType * beta, bool * keep)
+        : Ap(Ap), Aj(Aj), Ax(Ax), strong(strong), splitting(splitting), diagonal(diagonal), beta(beta), keep(keep) {}
+
+    __host__ __device__
+    void operator()(const IndexType k) const
+    {
+        ValueType sum = 0;
+
+        for (IndexType jj = Ap[k]; jj < Ap[k + 1]; jj++)
+        {
+            const ValueType abar = splitting[k] == RS_F_POINT && strong[jj] && splitting[Aj[jj]] == RS_C_POINT ?
+                                   opposite_sign_part(Ax[jj], diagonal[k]) : ValueType(0);
+
+            keep[jj] = abar != 0;
+            sum += abar;
+        }
+
+        beta[k] = sum;
+    }
+};
+
+// Rows of A_C and Z of the extended+i interpolation of an F-point i,
+//
+//   A_C(i,j) = -a_ij / d_i                      strong C-neighbors j
+//   Z(i,k)   = -a_ik / ((beta_k + abar_ki) d_i)  strong F-neighbors k
+//
+// so that its row of P is that of A_C + Z * Abar.  The denominators
+// beta_k + abar_ki sum abar_kl over the strong C-neighbors l of k and i
+// (the MM-ext+i form), weak connections and strong F-neighbors with a
+// zero denominator are lumped into d_i.  C-points are injected by unit
+// rows of A_C.
+template <typename IndexType, typename ValueType>
+struct extended_i_fine_functor
+{
+    const IndexType * Ap;
+    const IndexType * Aj;
+    const ValueType * Ax;
+    const bool      * strong;
+    const IndexType * splitting;
+    const ValueType * diagonal;
+    const ValueType * beta;
+          ValueType * c_values;
+          bool      * c_keep;
+          ValueType * z_values;
+          bool      * z_keep;
+
+    extended_i_fine_functor(const IndexType * Ap, const IndexType * Aj, const ValueType * Ax, const bool * strong,
+                            const IndexType * splitting, const ValueType * diagonal, const ValueType * beta,
+                            ValueType * c_values, bool * c_keep, ValueType * z_values, bool * z_keep)
+        : Ap(Ap), Aj(Aj), Ax(Ax), strong(strong), splitting(splitting), diagonal(diagonal), beta(beta),
+          c_values(c_values), c_keep(c_keep), z_values(z_values), z_keep(z_keep) {}
+
+    // abar_ki, found in row k
+    __host__ __device__
+    ValueType abar(const IndexType k, const IndexType i) const
+    {
+        for (IndexType kk = Ap[k]; kk < Ap[k + 1]; kk++)
+            if (Aj[kk] == i)
+                return opposite_sign_part(Ax[kk], diagonal[k]);
+
+        return ValueType(0);
+    }
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        if (splitting[i] == RS_C_POINT)
+        {
+            for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+            {
+                c_keep[jj]   = Aj[jj] == i;
+                c_values[jj] = ValueType(1);
+                z_keep[jj]   = false;
+                z_values[jj] = ValueType(0);
+            }
+            return;
+        }
+
+        ValueType d = 0;
+
+        for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+        {
+            const IndexType j = Aj[jj];
+            const ValueType a = Ax[jj];
+
+            if (j != i && strong[jj] && splitting[j] == RS_C_POINT)
+                continue;
+
+            if (j != i && strong[jj])
+            {
+                const ValueType abar_ji = abar(j, i);
+                const ValueType denominator = beta[j] + abar_ji;
+
+                d += denominator == 0 ? a : a * abar_ji / denominator;
+            }
+            else
+            {
+                d += a;
+            }
+        }
+
+        for (IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+        {
+            const IndexType j = Aj[jj];
+            const ValueType a = Ax[jj];
+
+            c_keep[jj]   = false;
+            c_values[jj] = ValueType(0);
+            z_keep[jj]   = false;
+            z_values[jj] = ValueType(0);
+
+            if (j == i || !strong[jj] || d == 0)
+                continue;
+
+            if (splitting[j] == RS_C_POINT)
+            {
+                c_keep[jj]   = true;
+                c_values[jj] = -a / d;
+            }
+            else
+            {
+                const ValueType denominator = beta[j] + abar(j, i);
+
+                if (denominator != 0)
+                {
+                    z_keep[jj]   = true;
+                    z_values[jj] = -a / (denominator * d);
+                }
+            }
+        }
+    }
+};
+
+// P <- interpolation from the C-points of splitting, in the coarse numbering
+template <typename Matrix, typename Array1, typename Array2>
+void ruge_stuben_prolongator(const Matrix& A, const Array1& strong, const Array2& splitting, Matrix& P,
+                             const ruge_stuben_options::interpolation_type interpolation)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename Matrix::index_type   IndexType;
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    const size_t N = A.num_rows;
+
+    // the fine numbering of the columns of P
+    Matrix W;
+
+    if (interpolation == ruge_stuben_options::direct)
+    {
+        cusp::array1d<ValueType,MemorySpace> weights(A.num_entries);
+        cusp::array1d<bool,MemorySpace>      keep(A.num_entries);
+
+        thrust::for_each(thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(N),
+                         direct_interpolation_functor<IndexType,ValueType>
+                           (raw_pointer(A.row_offsets), raw_pointer(A.column_indices), raw_pointer(A.values),
+                            raw_pointer(strong), raw_pointer(splitting), raw_pointer(weights), raw_pointer(keep)));
+
+        compact_flagged_entries(A, keep, weights, W);
+    }
+    else
+    {
+        cusp::array1d<ValueType,MemorySpace> diagonal;
+        cusp::detail::extract_diagonal(A, diagonal);
+
+        cusp::array1d<ValueType,MemorySpace> beta(N);
+        cusp::array1d<bool,MemorySpace>      abar_keep(A.num_entries);
+
+        thrust::for_each(thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(N),
+                         extended_i_coarse_functor<IndexType,ValueType>
+                           (raw_pointer(A.row_offsets), raw_pointer(A.column_indices), raw_pointer(A.values),
+                            raw_pointer(strong), raw_pointer(splitting), raw_pointer(diagonal),
+                            raw_pointer(beta), raw_pointer(abar_keep)));
+
+        cusp::array1d<ValueType,MemorySpace> c_values(A.num_entries);
+        cusp::array1d<bool,MemorySpace>      c_keep(A.num_entries);
+        cusp::array1d<ValueType,MemorySpace> z_values(A.num_entries);
+        cusp::array1d<bool,MemorySpace>      z_keep(A.num_entries);
+
+        thrust::for_each(thrust::counting_iterator<IndexType>(0), thrust::counting_iterator<IndexType>(N),
+                         extended_i_fine_functor<IndexType,ValueType>
+                           (raw_pointer(A.row_offsets), raw_pointer(A.column_indices), raw_pointer(A.values),
+                            raw_pointer(strong), raw_pointer(splitting), raw_pointer(diagonal), raw_pointer(beta),
+                            raw_pointer(c_values), raw_pointer(c_keep), raw_pointer(z_values), raw_pointer(z_keep)));
+
+        Matrix A_C, Z, Abar, ZAbar;
+        compact_flagged_entries(A, c_keep,    c_values, A_C);
+        compact_flagged_entries(A, z_keep,    z_values, Z);
+        compact_flagged_entries(A, abar_keep, A.values, Abar);
+
+        // distance-two interpolation through the strong F-neighbors
+        cusp::multiply(Z, Abar, ZAbar);
+        cusp::add(A_C, ZAbar, W);
+    }
+
+    // every column is a C-point, whose coarse index is the number of
+    // C-points before it, so the columns of each row remain sorted
+    cusp::array1d<IndexType,MemorySpace> coarse_index(N);
+    thrust::exclusive_scan(splitting.begin(), splitting.end(), coarse_index.begin());
+
+    cusp::array1d<IndexType,MemorySpace> columns(W.num_entries);
+    thrust::gather(W.column_indices.begin(), W.column_indices.end(), coarse_index.begin(), columns.begin());
+
+    W.column_indices.swap(columns);
+    W.num_cols = thrust::count(splitting.begin(), splitting.end(), IndexType(RS_C_POINT));
+
+    P.swap(W);
+}
+
+} // end namespace detail
+
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename MatrixType>
+ruge_stuben<IndexType,ValueType,MemorySpace>::ruge_stuben(const MatrixType& A, const ruge_stuben_options& options)
+    : options(options)
+{
+  CUSP_PROFILE_SCOPED();
+
+  setup(A);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename MatrixType>
+void ruge_stuben<IndexType,ValueType,MemorySpace>::setup(const MatrixType& A)
+{
+  CUSP_PROFILE_SCOPED();
+
+  if (options.max_levels == 0)
+    throw cusp::invalid_input_exception("ruge_stuben requires max_levels > 0");
+
+  if (A.num_rows != A.num_cols)
+    throw cusp::invalid_input_exception("matrix must be square");
+
+  levels.reserve(options.max_levels); // avoid reallocations which force matrix copies
+
+  levels.push_back(level());
+  levels.back().A_ = A; // copy
+
+  while (levels.back().A_.num_rows > options.coarse_size && levels.size() < options.max_levels)
+  {
+    // stop when the coarsening stalls
+    if (!extend_hierarchy())
+      break;
+  }
+
+  // the coarsest matrix is factored on the host
+  cusp::array2d<ValueType,cusp::host_memory> coarse_dense(levels.back().A_);
+  LU = cusp::detail::lu_solver<ValueType, MemorySpace>(coarse_dense);
+
+  for (size_t lvl = 0; lvl < levels.size(); lvl++)
+    detail::setup_fine_matrix(levels[lvl].A, levels[lvl].A_, 1);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+bool ruge_stuben<IndexType,ValueType,MemorySpace>::extend_hierarchy(void)
+{
+  CUSP_PROFILE_SCOPED();
+
+  const SetupMatrixType& A = levels.back().A_;
+
+  // compute strength of connection matrix
+  cusp::array1d<bool,MemorySpace> strong;
+  detail::classical_strong_connections(A, strong, options.theta);
+
+  SetupMatrixType S;
+  detail::compact_flagged_entries(A, strong, A.values, S);
+
+  // split the points into C-points and F-points
+  cusp::array1d<IndexType,MemorySpace> splitting;
+  detail::ruge_stuben_splitting(S, splitting, options.coarsening);
+
+  const size_t num_coarse = thrust::count(splitting.begin(), splitting.end(), IndexType(detail::RS_C_POINT));
+
+  if (num_coarse == 0 || num_coarse == A.num_rows)
+    return false;
+
+  // compute prolongation and restriction operators
+  SetupMatrixType P;
+  detail::ruge_stuben_prolongator(A, strong, splitting, P, options.interpolation);
+
+  SetupMatrixType R;
+  cusp::transpose(P, R);
+
+  // construct Galerkin product R*A*P
+  SetupMatrixType RAP;
+  cusp::galerkin_product(R, A, P, RAP);
+
+  setup_smoother(levels.size() - 1);
+
+  level& L = levels.back();
+  L.splitting.swap(splitting);
+  detail::setup_fine_matrix( L.P, P, 1 );
+  detail::setup_fine_matrix( L.R, R, 1 );
+  L.residual.resize(A.num_rows);
+
+  levels.push_back(level());
+  levels.back().A_.swap(RAP);
+  levels.back().x.resize(levels.back().A_.num_rows);
+  levels.back().b.resize(levels.back().A_.num_rows);
+
+  return true;
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+void ruge_stuben<IndexType,ValueType,MemorySpace>::setup_smoother(const size_t i)
+{
+  CUSP_PROFILE_SCOPED();
+
+  level& L = levels[i];
+
+  if (options.smoother == ruge_stuben_options::jacobi)
+  {
+    //  4/3 * 1/rho is a good default, where rho is the spectral radius of D^-1(A)
+    const ValueType rho_DinvA = cusp::detail::estimate_rho_Dinv_A(L.A_, L.rho_state);
+    L.jacobi_smoother = cusp::relaxation::jacobi<ValueType, MemorySpace>(L.A_, ValueType(options.smoother_weight) / rho_DinvA);
+  }
+  else
+  {
+    L.gauss_seidel_smoother = cusp::relaxation::gauss_seidel<ValueType, MemorySpace, IndexType>(L.A_);
+  }
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void ruge_stuben<IndexType,ValueType,MemorySpace>::operator()(const Array1& b, Array2& x)
+{
+  CUSP_PROFILE_SCOPED();
+
+  // the smoothers may exchange their result with the storage of x, a
+  // view keeps that of the caller in place
+  cusp::array1d_view<typename Array2::iterator> x_view(x.begin(), x.end());
+
+  // perform 1 V-cycle
+  _solve(b, x_view, 0);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void ruge_stuben<IndexType,ValueType,MemorySpace>::solve(const Array1& b, Array2& x)
+{
+  CUSP_PROFILE_SCOPED();
+
+  cusp::default_monitor<ValueType> monitor(b);
+
+  solve(b, x, monitor);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2, typename Monitor>
+void ruge_stuben<IndexType,ValueType,MemorySpace>::solve(const Array1& b, Array2& x, Monitor& monitor)
+{
+  CUSP_PROFILE_SCOPED();
+
+  const size_t n = levels[0].A.num_rows;
+
+  // use simple iteration
+  update.resize(n);
+  residual.resize(n);
+
+  // compute initial residual
+  cusp::residual(levels[0].A, x, b, residual);
+
+  while(!monitor.finished(residual))
+  {
+      _solve(residual, update, 0);
+
+      // x += M * r
+      cusp::blas::axpy(update, x, ValueType(1.0));
+
+      // update residual
+      cusp::residual(levels[0].A, x, b, residual);
+      ++monitor;
+  }
+}
+
+// one V-cycle on level i from a zero initial guess
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void ruge_stuben<IndexType,ValueType,MemorySpace>::_solve(const Array1& b, Array2& x, const size_t i)
+{
+  CUSP_PROFILE_SCOPED_NAME(cusp::detail::profiler::intern("ruge_stuben level", i));
+
+  if (i + 1 == levels.size())
+  {
+    // coarse grid solve, resident in MemorySpace
+    LU(b, x);
+    return;
+  }
+
+  level& L = levels[i];
+
+  // presmooth, the first sweep ignores the initial x
+  if (options.presmooth_sweeps == 0)
+  {
+    cusp::blas::fill(x, ValueType(0));
+  }
+  else if (options.smoother == ruge_stuben_options::jacobi)
+  {
+    L.jacobi_smoother.presmooth(L.A, b, x, options.presmooth_sweeps);
+  }
+  else
+  {
+    L.gauss_seidel_smoother.presmooth(L.A, b, x);
+    for (size_t k = 1; k < options.presmooth_sweeps; k++)
+      L.gauss_seidel_smoother.postsmooth(L.A, b, x);
+  }
+
+  // compute residual <- b - A*x
+  cusp::residual(L.A, x, b, L.residual);
+
+  // restrict to coarse grid
+  cusp::multiply(L.R, L.residual, levels[i + 1].b);
+
+  // compute coarse grid solution
+  _solve(levels[i + 1].b, levels[i + 1].x, i + 1);
+
+  // apply coarse grid correction x <- x + P * x_coarse
+  cusp::detail::prolong_and_correct(L.P, levels[i + 1].x, x);
+
+  // postsmooth
+  if (options.smoother == ruge_stuben_options::jacobi)
+  {
+    L.jacobi_smoother.postsmooth(L.A, b, x, options.postsmooth_sweeps);
+  }
+  else
+  {
+    for (size_t k = 0; k < options.postsmooth_sweeps; k++)
+      L.gauss_seidel_smoother.postsmooth(L.A, b, x);
+  }
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+void ruge_stuben<IndexType,ValueType,MemorySpace>
+::print( void )
+{
+	IndexType num_levels = levels.size();
+
+	std::cout << "\tNumber of Levels:\t" << num_levels << std::endl;
+	std::cout << "\tOperator Complexity:\t" << operator_complexity() << std::endl;
+	std::cout << "\tGrid Complexity:\t" << grid_complexity() << std::endl;
+	std::cout << "\tlevel\tunknowns\tnonzeros:\t" << std::endl;
+
+	IndexType nnz = 0;
+
+	for(size_t index = 0; index < levels.size(); index++)
+		nnz += levels[index].A.num_entries;
+
+	for(size_t index = 0; index < levels.size(); index++)
+	{
+		double percent = (double)levels[index].A.num_entries / nnz;
+		std::cout << "\t" << index << "\t" << levels[index].A.num_cols << "\t\t" \
+              << levels[index].A.num_entries << " \t[" << 100*percent << "%]" << std::endl;
+	}
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+double ruge_stuben<IndexType,ValueType,MemorySpace>
+::operator_complexity( void )
+{
+	size_t nnz = 0;
+
+	for(size_t index = 0; index < levels.size(); index++)
+		nnz += levels[index].A.num_entries;
+
+	return (double) nnz / (double) levels[0].A.num_entries;
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+double ruge_stuben<IndexType,ValueType,MemorySpace>
+::grid_complexity( void )
+{
+	size_t unknowns = 0;
+	for(size_t index = 0; index < levels.size(); index++)
+		unknowns += levels[index].A.num_rows;
+
+	return (double) unknowns / (double) levels[0].A.num_rows;
+}
+
+} // end namespace precond
+} // end namespace cusp
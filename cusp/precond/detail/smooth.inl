@@ -19,10 +19,14 @@
 #include <cusp/csr_matrix.h>
 #include <cusp/elementwise.h>
 
+#include <cusp/detail/format_utils.h>
 #include <cusp/detail/spectral_radius.h>
 
+#include <thrust/extrema.h>
 #include <thrust/fill.h>
+#include <thrust/for_each.h>
 #include <thrust/gather.h>
+#include <thrust/scan.h>
 #include <thrust/transform.h>
 #include <thrust/iterator/zip_iterator.h>
 #include <thrust/iterator/constant_iterator.h>
@@ -35,6 +39,20 @@ namespace precond
 namespace detail
 {
 
+template <typename T>
+struct scaled_inverse
+{
+    const T lambda;
+
+    scaled_inverse(const T lambda) : lambda(lambda) {}
+
+    __host__ __device__
+    T operator()(const T& x) const
+    {
+        return lambda / x;
+    }
+};
+
 template <typename T>
 struct scaled_multiply
 {
@@ -49,18 +67,304 @@ struct scaled_multiply
     }
 };
 
+// Fused smoothing P = T - lambda D^-1 S T for a tentative prolongator
+// with few entries per row (one per candidate).  Row i of P only gathers
+// the rows of T of the neighbors of i, so it is formed directly in a
+// workspace slot bounded by the entries of those rows, with its columns
+// kept sorted by insertion, and then compacted.  This replaces the SpGEMM
+// and the subtraction, or the global sort, of the general paths.
+#define CUSP_PROLONGATOR_ROW_LIMIT 256
+
+// bound[i] <- entries of T(i,:) and of the rows T(j,:) of the neighbors j of i
+template <typename IndexType>
+struct prolongator_bound_functor
+{
+    const IndexType * Sp;
+    const IndexType * Sj;
+    const IndexType * Tp;
+          IndexType * bound;
+
+    prolongator_bound_functor(const IndexType * Sp, const IndexType * Sj, const IndexType * Tp, IndexType * bound)
+        : Sp(Sp), Sj(Sj), Tp(Tp), bound(bound) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        IndexType b = Tp[i + 1] - Tp[i];
+
+        for (IndexType jj = Sp[i]; jj < Sp[i + 1]; jj++)
+        {
+            const IndexType j = Sj[jj];
+            b += Tp[j + 1] - Tp[j];
+        }
+
+        bound[i] = b;
+    }
+};
+
+// row i of P in the workspace slot Wj[Wp[i]:], Wx[Wp[i]:], count[i] <- its length
+template <typename IndexType, typename ValueType>
+struct prolongator_row_functor
+{
+    const IndexType * Sp;
+    const IndexType * Sj;
+    const ValueType * Sx;
+    const IndexType * Tp;
+    const IndexType * Tj;
+    const ValueType * Tx;
+    const ValueType * Dinv;
+    const IndexType * Wp;
+          IndexType * Wj;
+          ValueType * Wx;
+          IndexType * count;
+
+    prolongator_row_functor(const IndexType * Sp, const IndexType * Sj, const ValueType * Sx,
+                            const IndexType * Tp, const IndexType * Tj, const ValueType * Tx,
+                            const ValueType * Dinv, const IndexType * Wp, IndexType * Wj, ValueType * Wx,
+                            IndexType * count)
+        : Sp(Sp), Sj(Sj), Sx(Sx), Tp(Tp), Tj(Tj), Tx(Tx), Dinv(Dinv), Wp(Wp), Wj(Wj), Wx(Wx), count(count) {}
+
+    __host__ __device__
+    void accumulate(const IndexType base, IndexType& n, const IndexType col, const ValueType v) const
+    {
+        IndexType m = n;
+
+        while (m > 0 && Wj[base + m - 1] > col)
+            m--;
+
+        if (m > 0 && Wj[base + m - 1] == col)
+        {
+            Wx[base + m - 1] += v;
+            return;
+        }
+
+        for (IndexType k = n; k > m; k--)
+        {
+            Wj[base + k] = Wj[base + k - 1];
+            Wx[base + k] = Wx[base + k - 1];
+        }
+
+        Wj[base + m] = col;
+        Wx[base + m] = v;
+        n++;
+    }
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        const IndexType base = Wp[i];
+        const ValueType scale = -Dinv[i];
+        IndexType n = 0;
+
+        for (IndexType tt = Tp[i]; tt < Tp[i + 1]; tt++)
+            accumulate(base, n, Tj[tt], Tx[tt]);
+
+        for (IndexType jj = Sp[i]; jj < Sp[i + 1]; jj++)
+        {
+            const IndexType j = Sj[jj];
+            const ValueType s = scale * Sx[jj];
+
+            for (IndexType tt = Tp[j]; tt < Tp[j + 1]; tt++)
+                accumulate(base, n, Tj[tt], s * Tx[tt]);
+        }
+
+        count[i] = n;
+    }
+};
+
+// copy row i of P from the workspace, with its row index unless Pi is null
+template <typename IndexType, typename ValueType>
+struct prolongator_compact_functor
+{
+    const IndexType * Wp;
+    const IndexType * Wj;
+    const ValueType * Wx;
+    const IndexType * Pp;
+          IndexType * Pi;
+          IndexType * Pj;
+          ValueType * Px;
+
+    prolongator_compact_functor(const IndexType * Wp, const IndexType * Wj, const ValueType * Wx,
+                                const IndexType * Pp, IndexType * Pi, IndexType * Pj, ValueType * Px)
+        : Wp(Wp), Wj(Wj), Wx(Wx), Pp(Pp), Pi(Pi), Pj(Pj), Px(Px) {}
+
+    __host__ __device__
+    void operator()(const IndexType i) const
+    {
+        const IndexType base = Wp[i];
+
+        for (IndexType n = 0; n < Pp[i + 1] - Pp[i]; n++)
+        {
+            if (Pi != 0) Pi[Pp[i] + n] = i;
+            Pj[Pp[i] + n] = Wj[base + n];
+            Px[Pp[i] + n] = Wx[base + n];
+        }
+    }
+};
+
+template <typename Array>
+typename Array::value_type * smooth_pointer(Array& a)
+{
+    return a.empty() ? 0 : thrust::raw_pointer_cast(&a[0]);
+}
+
+template <typename Array>
+const typename Array::value_type * smooth_pointer(const Array& a)
+{
+    return a.empty() ? 0 : thrust::raw_pointer_cast(&a[0]);
+}
+
+// Returns false, leaving P untouched, when a row of P may exceed
+// CUSP_PROLONGATOR_ROW_LIMIT entries.  P_row_indices is filled for COO.
+template <typename Array1, typename Array2, typename Array3, typename Array4, typename Array5, typename Array6,
+          typename Matrix, typename Array7, typename Array8>
+bool fused_smooth_prolongator(const size_t num_rows, const size_t num_cols,
+                              const Array1& Sp, const Array2& Sj, const Array3& Sx,
+                              const Array4& Tp, const Array5& Tj, const Array6& Tx,
+                              const Array3& Dinv,
+                              Matrix& P, Array7& P_row_offsets, Array8* P_row_indices)
+{
+    typedef typename Array2::value_type   IndexType;
+    typedef typename Array3::value_type   ValueType;
+    typedef typename Array2::memory_space MemorySpace;
+
+    cusp::array1d<IndexType,MemorySpace> Wp(num_rows + 1);
+    Wp[num_rows] = 0;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     prolongator_bound_functor<IndexType>(smooth_pointer(Sp), smooth_pointer(Sj), smooth_pointer(Tp), smooth_pointer(Wp)));
+
+    if (num_rows > 0 && *thrust::max_element(Wp.begin(), Wp.end() - 1) > IndexType(CUSP_PROLONGATOR_ROW_LIMIT))
+        return false;
+
+    thrust::exclusive_scan(Wp.begin(), Wp.end(), Wp.begin());
+
+    cusp::array1d<IndexType,MemorySpace> Wj(Wp[num_rows]);
+    cusp::array1d<ValueType,MemorySpace> Wx(Wp[num_rows]);
+
+    P_row_offsets.resize(num_rows + 1);
+    P_row_offsets[num_rows] = 0;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     prolongator_row_functor<IndexType,ValueType>
+                        (smooth_pointer(Sp), smooth_pointer(Sj), smooth_pointer(Sx),
+                         smooth_pointer(Tp), smooth_pointer(Tj), smooth_pointer(Tx),
+                         smooth_pointer(Dinv), smooth_pointer(Wp), smooth_pointer(Wj), smooth_pointer(Wx),
+                         smooth_pointer(P_row_offsets)));
+
+    thrust::exclusive_scan(P_row_offsets.begin(), P_row_offsets.end(), P_row_offsets.begin());
+
+    const size_t num_entries = P_row_offsets[num_rows];
+
+    P.num_rows    = num_rows;
+    P.num_cols    = num_cols;
+    P.num_entries = num_entries;
+
+    if (P_row_indices != 0)
+        P_row_indices->resize(num_entries);
+    P.column_indices.resize(num_entries);
+    P.values.resize(num_entries);
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     prolongator_compact_functor<IndexType,ValueType>
+                        (smooth_pointer(Wp), smooth_pointer(Wj), smooth_pointer(Wx),
+                         smooth_pointer(P_row_offsets), P_row_indices == 0 ? 0 : smooth_pointer(*P_row_indices),
+                         smooth_pointer(P.column_indices), smooth_pointer(P.values)));
+
+    return true;
+}
+
+// lambda D^-1 with lambda = omega / rho(D^-1 S), from the diagonal D of S
+// unless it is null
+template <typename MatrixType, typename ValueType, typename Array>
+void scaled_inverse_diagonal(const MatrixType& S, const ValueType omega, const ValueType rho_Dinv_S, const Array* diagonal, Array& Dinv)
+{
+    const ValueType lambda = omega / (rho_Dinv_S == 0.0 ? estimate_rho_Dinv_A(S) : rho_Dinv_S);
+
+    if (diagonal == 0)
+    {
+        cusp::detail::extract_diagonal(S, Dinv);
+        thrust::transform(Dinv.begin(), Dinv.end(), Dinv.begin(), scaled_inverse<ValueType>(lambda));
+    }
+    else
+    {
+        thrust::transform(diagonal->begin(), diagonal->end(), Dinv.begin(), scaled_inverse<ValueType>(lambda));
+    }
+}
+
+template <typename MatrixType, typename ValueType>
+bool fused_smooth_prolongator(const MatrixType& S, const MatrixType& T, MatrixType& P,
+                              const ValueType omega, const ValueType rho_Dinv_S,
+                              const cusp::array1d<ValueType,typename MatrixType::memory_space>* diagonal,
+                              cusp::csr_format)
+{
+    typedef typename MatrixType::index_type   IndexType;
+    typedef typename MatrixType::memory_space MemorySpace;
+
+    cusp::array1d<ValueType,MemorySpace> Dinv(S.num_rows);
+    scaled_inverse_diagonal(S, omega, rho_Dinv_S, diagonal, Dinv);
+
+    MatrixType P_;
+
+    if (!fused_smooth_prolongator(S.num_rows, T.num_cols,
+                                  S.row_offsets, S.column_indices, S.values,
+                                  T.row_offsets, T.column_indices, T.values, Dinv,
+                                  P_, P_.row_offsets, (cusp::array1d<IndexType,MemorySpace> *) 0))
+        return false;
+
+    P.swap(P_);
+    return true;
+}
+
+template <typename MatrixType, typename ValueType>
+bool fused_smooth_prolongator(const MatrixType& S, const MatrixType& T, MatrixType& P,
+                              const ValueType omega, const ValueType rho_Dinv_S,
+                              const cusp::array1d<ValueType,typename MatrixType::memory_space>* diagonal,
+                              cusp::coo_format)
+{
+    typedef typename MatrixType::index_type   IndexType;
+    typedef typename MatrixType::memory_space MemorySpace;
+
+    cusp::array1d<IndexType,MemorySpace> S_row_offsets(S.num_rows + 1);
+    cusp::array1d<IndexType,MemorySpace> T_row_offsets(T.num_rows + 1);
+    cusp::detail::indices_to_offsets(S.row_indices, S_row_offsets);
+    cusp::detail::indices_to_offsets(T.row_indices, T_row_offsets);
+
+    cusp::array1d<ValueType,MemorySpace> Dinv(S.num_rows);
+    scaled_inverse_diagonal(S, omega, rho_Dinv_S, diagonal, Dinv);
+
+    MatrixType P_;
+    cusp::array1d<IndexType,MemorySpace> P_row_offsets;
+
+    if (!fused_smooth_prolongator(S.num_rows, T.num_cols,
+                                  S_row_offsets, S.column_indices, S.values,
+                                  T_row_offsets, T.column_indices, T.values, Dinv,
+                                  P_, P_row_offsets, &P_.row_indices))
+        return false;
+
+    P.swap(P_);
+    return true;
+}
+
 template <typename MatrixType, typename ValueType>
 void smooth_prolongator(const MatrixType& S,
                         const MatrixType& T,
                         MatrixType& P,
                         const ValueType omega,
                         const ValueType rho_Dinv_S,
+                        const cusp::array1d<ValueType,cusp::device_memory>* diagonal,
                         cusp::device_memory)
 {
     CUSP_PROFILE_SCOPED();
 
     typedef typename MatrixType::index_type IndexType;
 
+    if (fused_smooth_prolongator(S, T, P, omega, rho_Dinv_S, diagonal, typename MatrixType::format()))
+        return;
+
     // TODO handle case with unaggregated nodes more gracefully
     if (T.num_entries == T.num_rows) {
 
@@ -77,8 +381,11 @@ void smooth_prolongator(const MatrixType& S,
 
         // temp <- D^-1
         {
-            cusp::array1d<ValueType, cusp::device_memory> D(S.num_rows);
-            cusp::detail::extract_diagonal(S, D);
+            cusp::array1d<ValueType, cusp::device_memory> D_;
+            if (diagonal == 0)
+                cusp::detail::extract_diagonal(S, D_);
+            const cusp::array1d<ValueType, cusp::device_memory>& D = diagonal == 0 ? D_ : *diagonal;
+
             thrust::transform(temp.values.begin(), temp.values.begin() + S.num_entries,
                               thrust::make_permutation_iterator(D.begin(), S.row_indices.begin()),
                               temp.values.begin(),
@@ -116,8 +423,10 @@ void smooth_prolongator(const MatrixType& S,
 
     } else {
 
-        cusp::array1d<ValueType, cusp::device_memory> D(S.num_rows);
-        cusp::detail::extract_diagonal(S, D);
+        cusp::array1d<ValueType, cusp::device_memory> D_;
+        if (diagonal == 0)
+            cusp::detail::extract_diagonal(S, D_);
+        const cusp::array1d<ValueType, cusp::device_memory>& D = diagonal == 0 ? D_ : *diagonal;
 
         // create D_inv_S by copying S then scaling
         MatrixType D_inv_S(S);
@@ -143,14 +452,20 @@ void smooth_prolongator(const MatrixType& S,
                         MatrixType& P,
                         const ValueType omega,
                         const ValueType rho_Dinv_S,
+                        const cusp::array1d<ValueType,cusp::host_memory>* diagonal,
                         cusp::host_memory)
 {
     CUSP_PROFILE_SCOPED();
 
     typedef typename MatrixType::index_type IndexType;
 
-    cusp::array1d<ValueType, cusp::host_memory> D(S.num_rows);
-    cusp::detail::extract_diagonal(S, D);
+    if (fused_smooth_prolongator(S, T, P, omega, rho_Dinv_S, diagonal, typename MatrixType::format()))
+        return;
+
+    cusp::array1d<ValueType, cusp::host_memory> D_;
+    if (diagonal == 0)
+        cusp::detail::extract_diagonal(S, D_);
+    const cusp::array1d<ValueType, cusp::host_memory>& D = diagonal == 0 ? D_ : *diagonal;
 
     // create D_inv_S by copying S then scaling
     MatrixType D_inv_S(S);
@@ -173,14 +488,16 @@ void smooth_prolongator(const MatrixType& S,
     cusp::subtract( T, temp, P );
 }
 
+// diagonal is the main diagonal of S, which is extracted when it is null
 template <typename MatrixType, typename ValueType>
 void smooth_prolongator(const MatrixType& S,
                         const MatrixType& T,
                         MatrixType& P,
                         const ValueType omega = 4.0/3.0,
-                        const ValueType rho_Dinv_S = 0.0)
+                        const ValueType rho_Dinv_S = 0.0,
+                        const cusp::array1d<ValueType,typename MatrixType::memory_space>* diagonal = 0)
 {
-    smooth_prolongator(S, T, P, omega, rho_Dinv_S, typename MatrixType::memory_space());
+    smooth_prolongator(S, T, P, omega, rho_Dinv_S, diagonal, typename MatrixType::memory_space());
 }
 
 } // end namespace detail
@@ -15,9 +15,14 @@
  */
 
 #include <cusp/blas.h>
+#include <cusp/copy.h>
 #include <cusp/elementwise.h>
+#include <cusp/galerkin_product.h>
+#include <cusp/exception.h>
+#include <cusp/memory_footprint.h>
 #include <cusp/multiply.h>
 #include <cusp/monitor.h>
+#include <cusp/spgemm.h>
 #include <cusp/transpose.h>
 #include <cusp/graph/maximal_independent_set.h>
 #include <cusp/precond/diagonal.h>
@@ -25,14 +30,31 @@
 #include <cusp/precond/smooth.h>
 #include <cusp/precond/strength.h>
 #include <cusp/krylov/arnoldi.h>
+#include <cusp/io/binary.h>
 
 #include <cusp/detail/format_utils.h>
 #include <cusp/detail/spectral_radius.h>
-
+#include <cusp/detail/stream.h>
+#include <cusp/detail/memory_tracker.h>
+#include <cusp/detail/multigrid.h>
+#include <cusp/detail/timer.h>
+
+#include <thrust/binary_search.h>
+#include <thrust/copy.h>
+#include <thrust/count.h>
 #include <thrust/extrema.h>
+#include <thrust/for_each.h>
 #include <thrust/transform.h>
 #include <thrust/gather.h>
 #include <thrust/reduce.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <cstring>
 
 namespace cusp
 {
@@ -42,36 +64,30 @@ namespace detail
 {
 
 
-template <typename MatrixType>
-struct Dinv_A : public cusp::linear_operator<typename MatrixType::value_type, typename MatrixType::memory_space>
-{
-    const MatrixType& A;
-    const cusp::precond::diagonal<typename MatrixType::value_type, typename MatrixType::memory_space> Dinv;
-
-    Dinv_A(const MatrixType& A)
-        : A(A), Dinv(A),
-          cusp::linear_operator<typename MatrixType::value_type, typename MatrixType::memory_space>(A.num_rows, A.num_cols, A.num_entries + A.num_rows)
-          {}
-
-    template <typename Array1, typename Array2>
-    void operator()(const Array1& x, Array2& y) const
-    {
-        cusp::multiply(A,x,y);
-        cusp::multiply(Dinv,y,y);
-    }
-};
-
 template <typename MatrixType>
 double estimate_rho_Dinv_A(const MatrixType& A)
 {
     typedef typename MatrixType::value_type   ValueType;
     typedef typename MatrixType::memory_space MemorySpace;
 
-    Dinv_A<MatrixType> Dinv_A(A);
+    cusp::detail::rho_Dinv_A_state<ValueType,MemorySpace> state;
 
-    return cusp::detail::ritz_spectral_radius(Dinv_A, 8);
+    return cusp::detail::estimate_rho_Dinv_A(A, state);
 }
 
+// Chebyshev coefficients of the polynomial smoother from rho(D^-1 A).
+// Since rho(A) <= max |D| rho(D^-1 A) for symmetric positive definite A,
+// the bound replaces a separate estimate of rho(A).
+template <typename State, typename Array, typename ArrayType>
+void polynomial_coefficients(const State& state, const Array& diagonal, ArrayType& coef)
+{
+    typedef typename ArrayType::value_type ValueType;
+
+    const ValueType d_max = thrust::transform_reduce(diagonal.begin(), diagonal.end(),
+                                                     cusp::detail::absolute<ValueType>(), ValueType(0), thrust::maximum<ValueType>());
+
+    cusp::relaxation::detail::chebyshev_polynomial_coefficients(ValueType(state.rho * d_max), coef);
+}
 
 template <typename T>
 struct square : thrust::unary_function<T,T>
@@ -97,6 +113,207 @@ struct not_negative_one
   }
 };
 
+// aggregate the strength of connection graph C as selected by the options
+template <typename MatrixType, typename ArrayType>
+void select_aggregates(const MatrixType& C, ArrayType& aggregates, const amg_options& options)
+{
+  switch (options.aggregation)
+  {
+    case amg_options::pairwise:
+      detail::pairwise_aggregation(C, aggregates, options.pairwise_passes);
+      break;
+    case amg_options::mis:
+      detail::mis_aggregation(C, aggregates, options.max_aggregate_size);
+      break;
+    default:
+      detail::standard_aggregation(C, aggregates);
+  }
+}
+
+template <typename IndexType>
+struct candidate_row_length
+{
+    IndexType num_candidates;
+
+    candidate_row_length(const IndexType num_candidates) : num_candidates(num_candidates) {}
+
+    __host__ __device__
+    IndexType operator()(const IndexType aggregate) const
+    {
+        return aggregate < 0 ? 0 : num_candidates;
+    }
+};
+
+// Thin QR factorization B_a = Q_a R_a of the rows of the candidates B
+// that belong to aggregate a, by modified Gram-Schmidt.  Q_a fills the
+// k entries of the rows of T of the nodes of a, in columns a*k + c, and
+// R_a the rows a*k .. a*k + k - 1 of the coarse candidates (column-major
+// with pitch num_aggregates * k).  A column that vanishes on a is left
+// zero in Q and R.
+template <typename IndexType, typename ValueType>
+struct fit_candidates_functor
+{
+    const IndexType * offsets;        // nodes of aggregate a are nodes[offsets[a]:offsets[a+1]]
+    const IndexType * nodes;
+    const ValueType * B;
+    IndexType B_row_stride;
+    IndexType B_col_stride;
+    IndexType num_candidates;
+    const IndexType * Tp;
+          IndexType * Tj;
+          ValueType * Tx;
+          ValueType * R;
+    IndexType R_pitch;
+
+    fit_candidates_functor(const IndexType * offsets, const IndexType * nodes,
+                           const ValueType * B, const IndexType B_row_stride, const IndexType B_col_stride,
+                           const IndexType num_candidates,
+                           const IndexType * Tp, IndexType * Tj, ValueType * Tx,
+                           ValueType * R, const IndexType R_pitch)
+        : offsets(offsets), nodes(nodes), B(B), B_row_stride(B_row_stride), B_col_stride(B_col_stride),
+          num_candidates(num_candidates), Tp(Tp), Tj(Tj), Tx(Tx), R(R), R_pitch(R_pitch) {}
+
+    __host__ __device__
+    void operator()(const IndexType a) const
+    {
+        const IndexType k = num_candidates;
+
+        for (IndexType c = 0; c < k; c++)
+        {
+            for (IndexType n = offsets[a]; n < offsets[a + 1]; n++)
+            {
+                const IndexType i = nodes[n];
+                Tj[Tp[i] + c] = a * k + c;
+                Tx[Tp[i] + c] = B[i * B_row_stride + c * B_col_stride];
+            }
+
+            // orthogonalize against the previous columns
+            for (IndexType p = 0; p < c; p++)
+            {
+                ValueType r = 0;
+                for (IndexType n = offsets[a]; n < offsets[a + 1]; n++)
+                    r += Tx[Tp[nodes[n]] + p] * Tx[Tp[nodes[n]] + c];
+
+                for (IndexType n = offsets[a]; n < offsets[a + 1]; n++)
+                    Tx[Tp[nodes[n]] + c] -= r * Tx[Tp[nodes[n]] + p];
+
+                R[c * R_pitch + a * k + p] = r;
+                R[p * R_pitch + a * k + c] = 0;
+            }
+
+            ValueType norm = 0;
+            for (IndexType n = offsets[a]; n < offsets[a + 1]; n++)
+                norm += Tx[Tp[nodes[n]] + c] * Tx[Tp[nodes[n]] + c];
+            norm = sqrt(norm);
+
+            if (norm != ValueType(0))
+                for (IndexType n = offsets[a]; n < offsets[a + 1]; n++)
+                    Tx[Tp[nodes[n]] + c] /= norm;
+
+            R[c * R_pitch + a * k + c] = norm;
+        }
+    }
+};
+
+// Tentative prolongator T = Q and coarse candidates R of the k candidates
+// B(i,c) = B[i * B_row_stride + c * B_col_stride], with one fused
+// factorization per aggregate.  T holds k entries in each aggregated row.
+template <typename Array1, typename ValueType, typename Matrix, typename Array2>
+void fit_candidates(const Array1& aggregates,
+                    const ValueType * B, const size_t B_row_stride, const size_t B_col_stride,
+                    const size_t num_candidates,
+                    Matrix& T,
+                    Array2& R)
+{
+    typedef typename Array1::value_type   IndexType;
+    typedef typename Array1::memory_space MemorySpace;
+
+    const size_t num_rows = aggregates.size();
+    const IndexType k = num_candidates;
+
+    IndexType num_aggregates = num_rows == 0 ? 0 : *thrust::max_element(aggregates.begin(), aggregates.end()) + 1;
+
+    // the nodes ordered by aggregate, unaggregated nodes (-1) first
+    cusp::array1d<IndexType,MemorySpace> keys(aggregates);
+    cusp::array1d<IndexType,MemorySpace> nodes(num_rows);
+    thrust::sequence(nodes.begin(), nodes.end());
+    thrust::stable_sort_by_key(keys.begin(), keys.end(), nodes.begin());
+
+    const size_t num_unaggregated = thrust::count(keys.begin(), keys.end(), IndexType(-1));
+
+    cusp::array1d<IndexType,MemorySpace> offsets(num_aggregates + 1);
+    thrust::lower_bound(keys.begin(), keys.end(),
+                        thrust::counting_iterator<IndexType>(0),
+                        thrust::counting_iterator<IndexType>(num_aggregates + 1),
+                        offsets.begin());
+
+    T.resize(num_rows, num_aggregates * k, (num_rows - num_unaggregated) * k);
+
+    thrust::transform(aggregates.begin(), aggregates.end(), T.row_offsets.begin(), candidate_row_length<IndexType>(k));
+    T.row_offsets[num_rows] = 0;
+    thrust::exclusive_scan(T.row_offsets.begin(), T.row_offsets.begin() + num_rows + 1, T.row_offsets.begin());
+
+    R.resize(num_aggregates * k, k);
+
+    if (num_aggregates == 0)
+        return;
+
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_aggregates),
+                     fit_candidates_functor<IndexType,ValueType>
+                        (thrust::raw_pointer_cast(&offsets[0]), thrust::raw_pointer_cast(&nodes[0]),
+                         B, B_row_stride, B_col_stride, k,
+                         thrust::raw_pointer_cast(&T.row_offsets[0]),
+                         thrust::raw_pointer_cast(&T.column_indices[0]),
+                         thrust::raw_pointer_cast(&T.values[0]),
+                         thrust::raw_pointer_cast(&R.values[0]), R.pitch));
+}
+
+// a single candidate B, T(i,a) = B(i) / ||B_a|| and R(a) = ||B_a||
+template <typename Array1,
+typename Array2,
+typename MatrixType,
+typename Array3>
+void fit_candidates(const Array1& aggregates,
+                    const Array2& B,
+                    MatrixType& Q_,
+                    Array3& R,
+                    cusp::array1d_format)
+{
+    typedef typename MatrixType::index_type   IndexType;
+    typedef typename MatrixType::value_type   ValueType;
+    typedef typename MatrixType::memory_space MemorySpace;
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> Q;
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> R_;
+
+    fit_candidates(aggregates, B.empty() ? 0 : thrust::raw_pointer_cast(&B[0]), 1, 0, 1, Q, R_);
+
+    R = R_.values;
+
+    // copy/convert Q to output matrix Q_
+    Q_ = Q;
+}
+
+template <typename Array, typename Orientation>
+struct candidate_strides {};
+
+template <typename Array>
+struct candidate_strides<Array,cusp::row_major>
+{
+    static size_t row(const Array& B) { return B.pitch; }
+    static size_t col(const Array& B) { return 1; }
+};
+
+template <typename Array>
+struct candidate_strides<Array,cusp::column_major>
+{
+    static size_t row(const Array& B) { return 1; }
+    static size_t col(const Array& B) { return B.pitch; }
+};
+
+// B.num_cols candidates, e.g. the rigid body modes for elasticity.  R
+// receives the coarse candidates, B.num_cols of them per aggregate.
 template <typename Array1,
 typename Array2,
 typename MatrixType,
@@ -104,87 +321,654 @@ typename Array3>
 void fit_candidates(const Array1& aggregates,
                     const Array2& B,
                     MatrixType& Q_,
-                    Array3& R)
+                    Array3& R,
+                    cusp::array2d_format)
 {
-    typedef typename MatrixType::index_type IndexType;
-    typedef typename MatrixType::value_type ValueType;
+    typedef typename MatrixType::index_type   IndexType;
+    typedef typename MatrixType::value_type   ValueType;
     typedef typename MatrixType::memory_space MemorySpace;
+    typedef candidate_strides<Array2,typename Array2::orientation> Strides;
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> Q;
+    cusp::array2d<ValueType,MemorySpace,cusp::column_major> R_;
+
+    fit_candidates(aggregates, B.values.empty() ? 0 : thrust::raw_pointer_cast(&B.values[0]),
+                   Strides::row(B), Strides::col(B), B.num_cols, Q, R_);
 
+    R = R_;
+
+    // copy/convert Q to output matrix Q_
+    Q_ = Q;
+}
+
+template <typename Array1,
+typename Array2,
+typename MatrixType,
+typename Array3>
+void fit_candidates(const Array1& aggregates,
+                    const Array2& B,
+                    MatrixType& Q_,
+                    Array3& R)
+{
     CUSP_PROFILE_SCOPED();
-    IndexType num_unaggregated = thrust::count(aggregates.begin(), aggregates.end(), -1.0);
-    IndexType num_aggregates = *thrust::max_element(aggregates.begin(), aggregates.end()) + 1;
 
-    cusp::coo_matrix<IndexType,ValueType,MemorySpace> Q;
-    Q.resize(aggregates.size(), num_aggregates, aggregates.size()-num_unaggregated);
-    R.resize(num_aggregates);
+    fit_candidates(aggregates, B, Q_, R, typename Array2::format());
+}
+
+template <typename T>
+struct scaled_reciprocal : thrust::unary_function<T,T>
+{
+    T scale;
+
+    scaled_reciprocal(T scale) : scale(scale) {}
+
+    __host__ __device__
+    T operator()(const T& x) const { return scale / x; }
+};
 
-    // gather values into Q
-    thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(0), aggregates.begin(), B.begin())),
-                    thrust::make_zip_iterator(thrust::make_tuple(thrust::counting_iterator<IndexType>(aggregates.size()), aggregates.end(), B.end())),
-                    aggregates.begin(),
-                    thrust::make_zip_iterator(thrust::make_tuple(Q.row_indices.begin(), Q.column_indices.begin(), Q.values.begin())),
-                    not_negative_one<IndexType>());
+// B(i) * (r(i) - (A * D^-1 * r)(i))
+template <typename T>
+struct tentative_restriction_functor
+{
+    template <typename Tuple>
+    __host__ __device__
+    T operator()(const Tuple& t) const
+    {
+        return thrust::get<0>(t) * (thrust::get<1>(t) - thrust::get<2>(t));
+    }
+};
 
-    // compute norm over each aggregate
+// B(i) * r(i), a row of T^T r
+template <typename T>
+struct aggregate_restriction_functor
+{
+    template <typename Tuple>
+    __host__ __device__
+    T operator()(const Tuple& t) const
     {
-        // compute Qt
-        cusp::coo_matrix<IndexType,ValueType,MemorySpace> Qt;
-        cusp::transpose(Q, Qt);
-
-        // compute sum of squares for each column of Q (rows of Qt)
-        cusp::array1d<IndexType, MemorySpace> temp(num_aggregates);
-        thrust::reduce_by_key(Qt.row_indices.begin(), Qt.row_indices.end(),
-                              thrust::make_transform_iterator(Qt.values.begin(), square<ValueType>()),
-                              temp.begin(),
-                              R.begin());
-
-        // compute square root of each column sum
-        thrust::transform(R.begin(), R.end(), R.begin(), sqrt_functor<ValueType>());
+        return thrust::get<0>(t) * thrust::get<1>(t);
     }
+};
 
-    // rescale columns of Q
-    thrust::transform(Q.values.begin(), Q.values.end(),
-                      thrust::make_permutation_iterator(R.begin(), Q.column_indices.begin()),
-                      Q.values.begin(),
-                      thrust::divides<ValueType>());
+// x(i) + B(i) / B_coarse(j) * x_coarse(j), where node i belongs to aggregate j
+template <typename T>
+struct aggregate_prolongation_functor
+{
+    template <typename Tuple>
+    __host__ __device__
+    T operator()(const Tuple& t) const
+    {
+        return thrust::get<0>(t) + thrust::get<1>(t) / thrust::get<2>(t) * thrust::get<3>(t);
+    }
+};
 
-    // copy/convert Q to output matrix Q_
-    Q_ = Q;
+// permutation lists the aggregated rows ordered by aggregate, so that
+// products with T^T reduce to a segmented sum over the aggregates
+template <typename Array1, typename Array2>
+void setup_aggregate_permutation(const Array1& aggregates, Array2& permutation)
+{
+    typedef typename Array1::value_type IndexType;
+    typedef typename Array1::memory_space MemorySpace;
+
+    cusp::array1d<IndexType,MemorySpace> keys(aggregates);
+    cusp::array1d<IndexType,MemorySpace> rows(aggregates.size());
+    thrust::sequence(rows.begin(), rows.end());
+    thrust::sort_by_key(keys.begin(), keys.end(), rows.begin());
+
+    // unaggregated nodes (marked w/ -1) sort first and do not contribute
+    const size_t num_unaggregated = thrust::count(keys.begin(), keys.end(), IndexType(-1));
+
+    permutation.resize(aggregates.size() - num_unaggregated);
+    thrust::copy(rows.begin() + num_unaggregated, rows.end(), permutation.begin());
+}
+
+// Prepare the restriction P^T = T^T (I - lambda * A * D^-1) of a symmetric A
+// without forming it: Dinv holds lambda / D for the diagonal D of A and
+// permutation orders the rows by aggregate as in setup_aggregate_permutation.
+template <typename Array1, typename ValueType, typename Array2, typename Array3, typename Array4>
+void setup_implicit_restriction(const Array1& aggregates,
+                                const ValueType lambda,
+                                const Array2& diagonal,
+                                Array3& permutation,
+                                Array4& Dinv)
+{
+    CUSP_PROFILE_SCOPED();
+
+    Dinv.resize(diagonal.size());
+    thrust::transform(diagonal.begin(), diagonal.end(), Dinv.begin(), scaled_reciprocal<ValueType>(lambda));
+
+    setup_aggregate_permutation(aggregates, permutation);
+}
+
+// T(i,j) - lambda / D(i) * (A*T)(i,j), where T(i,j) = B(i) / B_coarse(j) if
+// node i belongs to aggregate j and zero otherwise
+template <typename T>
+struct smoothed_prolongator_functor
+{
+    template <typename Tuple>
+    __host__ __device__
+    T operator()(const Tuple& t) const
+    {
+        const T T_ij = thrust::get<0>(t) == thrust::get<1>(t) ? thrust::get<2>(t) / thrust::get<3>(t) : T(0);
+
+        return T_ij - thrust::get<4>(t) * thrust::get<5>(t);
+    }
+};
+
+template <typename Matrix>
+void setup_level_matrix(Matrix& dst, Matrix& src){dst.swap(src);}
+
+template <typename Matrix1, typename Matrix2>
+void setup_level_matrix(Matrix1& dst, Matrix2& src){dst = src;}
+
+// the finest solve matrix is stored in blocks of amg_options::block_size
+template <typename Matrix1, typename Matrix2>
+void setup_fine_matrix(Matrix1& dst, const Matrix2& src, size_t block_size){dst = src;}
+
+template <typename IndexType, typename ValueType, typename MemorySpace, typename Matrix2>
+void setup_fine_matrix(cusp::bsr_matrix<IndexType,ValueType,MemorySpace>& dst, const Matrix2& src, size_t block_size)
+{
+  dst.block_size = block_size;
+  cusp::convert(src, dst);
+}
+
+// Layout of a saved hierarchy: an amg_stream_header, the spectral radius
+// estimates of the levels but the coarsest, the containers of every level
+// and the LU factors of the coarsest matrix.  The containers follow one
+// another in the stream, each in the binary format of cusp::io.
+const char         AMG_STREAM_MAGIC[8]  = {'C', 'U', 'S', 'P', 'A', 'M', 'G', '\0'};
+const unsigned int AMG_STREAM_VERSION   = 5;
+
+struct amg_stream_header
+{
+    char               magic[8];
+    unsigned int       version;
+    unsigned int       index_size;
+    unsigned int       value_size;
+    unsigned long long num_levels;
+    amg_options        options;
+};
+
+} // end namespace detail
+
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+smoothed_aggregation<IndexType,ValueType,MemorySpace>::smoothed_aggregation(void)
+    : cycle_applied(false), has_resetup_state(false)
+{
 }
 
-template <typename Matrix>
-void setup_level_matrix(Matrix& dst, Matrix& src){dst.swap(src);}
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename MatrixType>
+smoothed_aggregation<IndexType,ValueType,MemorySpace>::smoothed_aggregation(const MatrixType& A, const ValueType theta)
+{
+  CUSP_PROFILE_SCOPED();
+
+  options.theta = theta;
+
+  setup(A);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename MatrixType>
+smoothed_aggregation<IndexType,ValueType,MemorySpace>::smoothed_aggregation(const MatrixType& A, const amg_options& options)
+    : options(options)
+{
+  CUSP_PROFILE_SCOPED();
+
+  setup(A);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename MatrixType>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>::setup(const MatrixType& A)
+{
+  CUSP_PROFILE_SCOPED();
+
+  if (options.max_levels == 0)
+    throw cusp::invalid_input_exception("smoothed_aggregation requires max_levels > 0");
+
+  has_resetup_state = false;
+
+  levels.reserve(options.max_levels); // avoid reallocations which force matrix copies
+
+  levels.push_back(typename smoothed_aggregation<IndexType,ValueType,MemorySpace>::level());
+  levels.back().A_ = A; // copy
+  levels.back().B.resize(A.num_rows, ValueType(1.0));
+
+  while (levels.back().A_.num_rows > options.coarse_size && levels.size() < options.max_levels)
+  {
+    if (options.collect_timings)
+    {
+      cusp::detail::device_memory_tracker& tracker = cusp::detail::get_device_memory_tracker();
+      const size_t outer_peak = tracker.open_window();
+      cusp::detail::timer t;
+      t.unpause();
+      extend_hierarchy();
+      t.stop();
+      timings.push_back(t.milliseconds);
+      peaks.push_back(tracker.close_window(outer_peak));
+    }
+    else
+    {
+      extend_hierarchy();
+    }
+  }
+
+  setup_solve();
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>::setup_solve(const bool factor_coarse)
+{
+  CUSP_PROFILE_SCOPED();
+
+  if (factor_coarse)
+  {
+    cusp::detail::device_memory_tracker& tracker = cusp::detail::get_device_memory_tracker();
+    size_t outer_peak = 0;
+    cusp::detail::timer t;
+    if (options.collect_timings)
+    {
+      outer_peak = tracker.open_window();
+      t.unpause();
+    }
+
+    // the only transfer of the setup: the coarsest matrix (at most
+    // options.coarse_size rows) is factored on the host
+    // TODO make lu_solver accept sparse input
+    cusp::array2d<ValueType,cusp::host_memory> coarse_dense(levels.back().A_);
+    LU = cusp::detail::lu_solver<ValueType, MemorySpace>(coarse_dense);
+
+    if (options.collect_timings)
+    {
+      t.stop();
+      timings.push_back(t.milliseconds);
+      peaks.push_back(tracker.close_window(outer_peak));
+    }
+  }
+
+  // Setup solve matrix for each level, the finest from the copy in ValueType
+  detail::setup_fine_matrix( levels[0].A, levels[0].A_, options.block_size );
+  for( size_t lvl = 1; lvl < levels.size(); lvl++ )
+    detail::setup_level_matrix( levels[lvl].A, levels[lvl].A_ );
+
+  // allocate the K-cycle workspace once, the coarsest level is solved directly
+  if (options.cycle == amg_options::K_cycle)
+  {
+    for( size_t lvl = 1; lvl + 1 < levels.size(); lvl++ )
+    {
+      levels[lvl].k_residual.resize(levels[lvl].A.num_rows);
+      levels[lvl].k_update.resize(levels[lvl].A.num_rows);
+      levels[lvl].k_product.resize(levels[lvl].A.num_rows);
+    }
+  }
+
+  // a captured cycle refers to the arrays of the previous hierarchy
+  cycle_graph.reset();
+  cycle_applied = false;
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename MatrixType>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>::resetup(const MatrixType& A)
+{
+  CUSP_PROFILE_SCOPED();
+
+  typedef cusp::csr_matrix<IndexType,ValueType,MemorySpace> CsrMatrix;
+
+  if (A.num_rows != levels[0].A_.num_rows || A.num_cols != levels[0].A_.num_cols)
+    throw cusp::invalid_input_exception("matrix dimensions do not match the smoothed_aggregation hierarchy");
+
+  if (A.num_entries != levels[0].A_.num_entries)
+    throw cusp::invalid_input_exception("matrix sparsity pattern does not match the smoothed_aggregation hierarchy");
+
+  timings.clear();
+  peaks.clear();
+
+  levels[0].A_ = A; // copy
+
+  cusp::detail::device_memory_tracker& tracker = cusp::detail::get_device_memory_tracker();
+
+  for (size_t i = 0; i + 1 < levels.size(); i++)
+  {
+    size_t outer_peak = 0;
+    cusp::detail::timer t;
+    if (options.collect_timings)
+    {
+      outer_peak = tracker.open_window();
+      t.unpause();
+    }
+
+    level& L = levels[i];
+    resetup_state& S = L.state;
+
+    // the values of A_ were replaced
+    L.diagonal.invalidate();
+    const cusp::array1d<ValueType,MemorySpace>& D = L.diagonal.diagonal(L.A_);
+
+    cusp::detail::galerkin_csr_input<SetupMatrixType> A_csr(L.A_);
+
+    if (!has_resetup_state)
+    {
+      // the tentative prolongator only depends on the aggregates and B
+      SetupMatrixType T;
+      cusp::array1d<ValueType,MemorySpace> B_coarse;
+      detail::fit_candidates(L.aggregates, L.B, T, B_coarse);
+      S.T = T;
+
+      if (!options.unsmoothed_aggregation)
+        cusp::spgemm_symbolic(A_csr(), S.T, S.AT_plan);
+    }
+
+    // compute spectral radius of diag(A)^-1 * A, warm-started from the last setup
+    ValueType rho_DinvA = cusp::detail::estimate_rho_Dinv_A(L.A_, D, L.rho_state);
+
+    CsrMatrix RAP;
+
+    if (options.unsmoothed_aggregation)
+    {
+      // P = T, which is applied from the aggregates and B
+      cusp::galerkin_product(A_csr(), S.T, RAP);
+    }
+    else
+    {
+      const ValueType lambda = ValueType(options.prolongator_weight) / rho_DinvA;
+
+      // Dinv <- lambda * D^-1
+      L.Dinv.resize(D.size());
+      thrust::transform(D.begin(), D.end(), L.Dinv.begin(), detail::scaled_reciprocal<ValueType>(lambda));
+
+      // P <- T - lambda * D^-1 * A * T on the pattern of A * T
+      cusp::spgemm_numeric(A_csr(), S.T, S.AT_plan, S.P);
+      {
+        cusp::array1d<IndexType,MemorySpace> rows(S.P.num_entries);
+        cusp::detail::offsets_to_indices(S.P.row_offsets, rows);
+
+        thrust::transform
+          (thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(L.aggregates.begin(),     rows.begin()),
+                                                        S.P.column_indices.begin(),
+                                                        thrust::make_permutation_iterator(L.B.begin(),              rows.begin()),
+                                                        thrust::make_permutation_iterator(levels[i + 1].B.begin(),  S.P.column_indices.begin()),
+                                                        thrust::make_permutation_iterator(L.Dinv.begin(),           rows.begin()),
+                                                        S.P.values.begin())),
+           thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(L.aggregates.begin(),     rows.end()),
+                                                        S.P.column_indices.end(),
+                                                        thrust::make_permutation_iterator(L.B.begin(),              rows.end()),
+                                                        thrust::make_permutation_iterator(levels[i + 1].B.begin(),  S.P.column_indices.end()),
+                                                        thrust::make_permutation_iterator(L.Dinv.begin(),           rows.end()),
+                                                        S.P.values.end())),
+           S.P.values.begin(),
+           detail::smoothed_prolongator_functor<ValueType>());
+      }
+
+      if (!has_resetup_state)
+      {
+        // R = P^T as a permutation of the values of P
+        cusp::csr_matrix<IndexType,IndexType,MemorySpace> P_index(S.P.num_rows, S.P.num_cols, S.P.num_entries);
+        thrust::copy(S.P.row_offsets.begin(),    S.P.row_offsets.end(),    P_index.row_offsets.begin());
+        thrust::copy(S.P.column_indices.begin(), S.P.column_indices.end(), P_index.column_indices.begin());
+        thrust::sequence(P_index.values.begin(), P_index.values.end());
+
+        cusp::csr_matrix<IndexType,IndexType,MemorySpace> R_index;
+        cusp::transpose(P_index, R_index);
+
+        S.R.resize(R_index.num_rows, R_index.num_cols, R_index.num_entries);
+        S.R.row_offsets.swap(R_index.row_offsets);
+        S.R.column_indices.swap(R_index.column_indices);
+        S.R_permutation.swap(R_index.values);
+
+        cusp::spgemm_symbolic(A_csr(), S.P, S.AP_plan);
+      }
+
+      thrust::gather(S.R_permutation.begin(), S.R_permutation.end(), S.P.values.begin(), S.R.values.begin());
+
+      // construct Galerkin product R*A*P
+      cusp::spgemm_numeric(A_csr(), S.P, S.AP_plan, S.AP);
+
+      if (!has_resetup_state)
+        cusp::spgemm_symbolic(S.R, S.AP, S.RAP_plan);
+
+      cusp::spgemm_numeric(S.R, S.AP, S.RAP_plan, RAP);
+
+      // the CSR transfer operators are kept for the next call
+      L.P = S.P;
+      if (options.store_restriction)
+        L.R = S.R;
+    }
+
+    setup_smoother(i, rho_DinvA);
+
+    detail::setup_level_matrix( levels[i + 1].A_, RAP );
+
+    if (options.collect_timings)
+    {
+      t.stop();
+      timings.push_back(t.milliseconds);
+      peaks.push_back(tracker.close_window(outer_peak));
+    }
+  }
+
+  has_resetup_state = true;
+
+  setup_solve();
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>::save(std::ostream& output) const
+{
+  CUSP_PROFILE_SCOPED();
+
+  if (levels.empty())
+    throw cusp::invalid_input_exception("cannot save an empty smoothed_aggregation hierarchy");
+
+  const bool implicit_restriction = !options.unsmoothed_aggregation && !options.store_restriction && !options.transpose_prolongator;
+
+  detail::amg_stream_header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, detail::AMG_STREAM_MAGIC, sizeof(detail::AMG_STREAM_MAGIC));
+
+  header.version    = detail::AMG_STREAM_VERSION;
+  header.index_size = sizeof(IndexType);
+  header.value_size = sizeof(ValueType);
+  header.num_levels = levels.size();
+  header.options    = options;
+
+  if (!output.write(reinterpret_cast<const char *>(&header), sizeof(header)))
+    throw cusp::io_exception("unable to write smoothed_aggregation hierarchy");
+
+  cusp::array1d<ValueType,cusp::host_memory> rho(levels.size() - 1);
+  for (size_t i = 0; i + 1 < levels.size(); i++)
+    rho[i] = levels[i].rho_state.rho;
+
+  cusp::io::write_binary_stream(rho, output);
+
+  for (size_t i = 0; i < levels.size(); i++)
+  {
+    const level& L = levels[i];
+
+    // setup_solve() moves the coarse matrices into the solve matrices
+    // when both are of the same type
+    if (L.A_.num_rows == 0 && L.A.num_rows != 0)
+      cusp::io::write_binary_stream(L.A, output);
+    else
+      cusp::io::write_binary_stream(L.A_, output);
+    cusp::io::write_binary_stream(L.B,  output);
+
+    if (i + 1 == levels.size())
+      break;
+
+    cusp::io::write_binary_stream(L.aggregates, output);
+
+    if (options.unsmoothed_aggregation)
+    {
+      cusp::io::write_binary_stream(L.permutation, output);
+    }
+    else
+    {
+      cusp::io::write_binary_stream(L.P, output);
+
+      if (options.store_restriction)
+        cusp::io::write_binary_stream(L.R, output);
+
+      if (implicit_restriction)
+      {
+        cusp::io::write_binary_stream(L.permutation, output);
+        cusp::io::write_binary_stream(L.Dinv, output);
+      }
+    }
+
+    // Ritz vector of rho, which warm-starts the estimate of resetup()
+    cusp::io::write_binary_stream(L.rho_state.x, output);
+  }
+
+  cusp::io::write_binary_stream(LU.factors().values, output);
+  cusp::io::write_binary_stream(LU.pivots(), output);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>::load(std::istream& input)
+{
+  CUSP_PROFILE_SCOPED();
+
+  detail::amg_stream_header header;
+
+  if (!input.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    throw cusp::io_exception("unexpected end of smoothed_aggregation hierarchy");
+
+  if (std::memcmp(header.magic, detail::AMG_STREAM_MAGIC, sizeof(detail::AMG_STREAM_MAGIC)) != 0)
+    throw cusp::io_exception("invalid smoothed_aggregation hierarchy");
+
+  if (header.version != detail::AMG_STREAM_VERSION)
+    throw cusp::io_exception("unsupported smoothed_aggregation hierarchy version");
+
+  if (header.index_size != sizeof(IndexType) || header.value_size != sizeof(ValueType))
+    throw cusp::io_exception("index or value type of the smoothed_aggregation hierarchy does not match");
+
+  if (header.num_levels == 0)
+    throw cusp::io_exception("invalid smoothed_aggregation hierarchy");
+
+  const amg_options& saved = header.options;
+  const bool implicit_restriction = !saved.unsmoothed_aggregation && !saved.store_restriction && !saved.transpose_prolongator;
+
+  // read everything before the current hierarchy is replaced
+  cusp::array1d<ValueType,cusp::host_memory> rho;
+  cusp::io::read_binary_stream(rho, input);
+
+  if (rho.size() + 1 != header.num_levels)
+    throw cusp::io_exception("invalid smoothed_aggregation hierarchy");
+
+  std::vector<level> loaded(header.num_levels);
+
+  for (size_t i = 0; i < loaded.size(); i++)
+  {
+    level& L = loaded[i];
+
+    cusp::io::read_binary_stream(L.A_, input);
+    cusp::io::read_binary_stream(L.B,  input);
+
+    if (i + 1 == loaded.size())
+      break;
+
+    cusp::io::read_binary_stream(L.aggregates, input);
+
+    if (saved.unsmoothed_aggregation)
+    {
+      cusp::io::read_binary_stream(L.permutation, input);
+    }
+    else
+    {
+      cusp::io::read_binary_stream(L.P, input);
+
+      if (saved.store_restriction)
+        cusp::io::read_binary_stream(L.R, input);
+
+      if (implicit_restriction)
+      {
+        cusp::io::read_binary_stream(L.permutation, input);
+        cusp::io::read_binary_stream(L.Dinv, input);
+      }
+    }
+
+    cusp::io::read_binary_stream(L.rho_state.x, input);
+    L.rho_state.rho = rho[i];
+  }
+
+  const size_t N = loaded.back().A_.num_rows;
+
+  cusp::array2d<ValueType,cusp::host_memory> factors(N, N);
+  cusp::array1d<ValueType,cusp::host_memory> values;
+  cusp::array1d<int,cusp::host_memory> pivots;
+  cusp::io::read_binary_stream(values, input);
+  cusp::io::read_binary_stream(pivots, input);
+
+  if (values.size() != factors.values.size() || pivots.size() != N)
+    throw cusp::io_exception("invalid smoothed_aggregation hierarchy");
+
+  factors.values.swap(values);
+
+  levels.swap(loaded);
+  options = saved;
+  LU = cusp::detail::lu_solver<ValueType, MemorySpace>(factors, pivots);
+  timings.clear();
+  peaks.clear();
+  has_resetup_state = false;
+
+  // the smoothers and workspace follow from the stored estimates
+  for (size_t i = 0; i + 1 < levels.size(); i++)
+  {
+    level& L = levels[i];
+
+    setup_smoother(i, L.rho_state.rho);
 
-template <typename Matrix1, typename Matrix2>
-void setup_level_matrix(Matrix1& dst, Matrix2& src){dst = src;}
+    L.residual.resize(L.A_.num_rows);
 
-} // end namespace detail
+    if (implicit_restriction)
+    {
+      L.temp1.resize(L.A_.num_rows);
+      L.temp2.resize(L.A_.num_rows);
+    }
+  }
 
+  for (size_t i = 1; i < levels.size(); i++)
+  {
+    levels[i].x.resize(levels[i].A_.num_rows);
+    levels[i].b.resize(levels[i].A_.num_rows);
+  }
+
+  setup_solve(false);
+}
 
 template <typename IndexType, typename ValueType, typename MemorySpace>
-template <typename MatrixType>
-smoothed_aggregation<IndexType,ValueType,MemorySpace>::smoothed_aggregation(const MatrixType& A, const ValueType theta)
-    : theta(theta)
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>::setup_smoother(const size_t i, const ValueType rho_DinvA)
 {
   CUSP_PROFILE_SCOPED();
 
-  levels.reserve(20); // avoid reallocations which force matrix copies
-
-  levels.push_back(typename smoothed_aggregation<IndexType,ValueType,MemorySpace>::level());
-  levels.back().A_ = A; // copy
-  levels.back().B.resize(A.num_rows, ValueType(1.0));
-
-  while (levels.back().A_.num_rows > 100)
-    extend_hierarchy();
+  level& L = levels[i];
 
-  // TODO make lu_solver accept sparse input
-  cusp::array2d<ValueType,cusp::host_memory> coarse_dense(levels.back().A_);
-  LU = cusp::detail::lu_solver<ValueType, cusp::host_memory>(coarse_dense);
+  const cusp::array1d<ValueType,MemorySpace>& D = L.diagonal.diagonal(L.A_);
 
-  // Setup solve matrix for each level
-  levels[0].A = A;
-  for( size_t lvl = 1; lvl < levels.size(); lvl++ )
-    detail::setup_level_matrix( levels[lvl].A, levels[lvl].A_ );
+  if (options.smoother == amg_options::jacobi)
+  {
+    //  4/3 * 1/rho is a good default, where rho is the spectral radius of D^-1(A)
+    ValueType omega = ValueType(options.smoother_weight) / rho_DinvA;
+    L.jacobi_smoother = cusp::relaxation::jacobi<ValueType, MemorySpace>(L.A_, omega, D);
+  }
+  else if (options.smoother == amg_options::gauss_seidel)
+  {
+    L.gauss_seidel_smoother = cusp::relaxation::gauss_seidel<ValueType, MemorySpace, IndexType>(L.A_, cusp::relaxation::symmetric_sweep, ValueType(1), D);
+  }
+  else if (options.smoother == amg_options::chebyshev)
+  {
+    L.chebyshev_smoother = cusp::relaxation::chebyshev<ValueType, MemorySpace>(L.A_, 3, 1.0/30.0, 1.1, 0, D);
+    L.chebyshev_smoother.set_spectral_radius(rho_DinvA);
+  }
+  else
+  {
+    cusp::array1d<ValueType,cusp::host_memory> coef;
+    detail::polynomial_coefficients(L.rho_state, D, coef);
+    L.polynomial_smoother = cusp::relaxation::polynomial<ValueType, MemorySpace>(L.A_,coef);
+  }
 }
 
 template <typename IndexType, typename ValueType, typename MemorySpace>
@@ -192,58 +976,79 @@ void smoothed_aggregation<IndexType,ValueType,MemorySpace>::extend_hierarchy(voi
 {
   CUSP_PROFILE_SCOPED();
 
-  cusp::array1d<IndexType,MemorySpace> aggregates;
+  cusp::array1d<IndexType,MemorySpace> aggregates(levels.back().A_.num_rows);
+  cusp::blas::fill(aggregates,IndexType(0));
+
+  // the one extraction of the diagonal of this level
+  const cusp::array1d<ValueType,MemorySpace>& D = levels.back().diagonal.diagonal(levels.back().A_);
+
+  if (options.theta == 0)
+  {
+    // every connection is strong, aggregate A itself instead of a copy
+    detail::select_aggregates(levels.back().A_, aggregates, options);
+  }
+  else
   {
     // compute stength of connection matrix
     SetupMatrixType C;
-    detail::symmetric_strength_of_connection(levels.back().A_, C, theta);
+    detail::symmetric_strength_of_connection(levels.back().A_, C, ValueType(options.theta), D);
 
     // compute aggregates
-    aggregates.resize(C.num_rows);
-    cusp::blas::fill(aggregates,IndexType(0));
-    detail::standard_aggregation(C, aggregates);
+    detail::select_aggregates(C, aggregates, options);
   }
 
-  // compute spectral radius of diag(C)^-1 * C
-  ValueType rho_DinvA = detail::estimate_rho_Dinv_A(levels.back().A_);
+  // compute spectral radius of diag(A)^-1 * A, shared by the prolongator
+  // smoothing and the smoother setup and kept on the level for resetup
+  ValueType rho_DinvA = cusp::detail::estimate_rho_Dinv_A(levels.back().A_, D, levels.back().rho_state);
 
   SetupMatrixType P;
   cusp::array1d<ValueType,MemorySpace>  B_coarse;
-  {
-    // compute tenative prolongator and coarse nullspace vector
-    SetupMatrixType 				T;
-    detail::fit_candidates(aggregates, levels.back().B, T, B_coarse);
-  
-    // compute prolongation operator
-    detail::smooth_prolongator(levels.back().A_, T, P, ValueType(4.0/3.0), rho_DinvA);  // TODO if C != A then compute rho_Dinv_C
-  }
 
-  // compute restriction operator (transpose of prolongator)
-  SetupMatrixType R;
-  cusp::transpose(P,R);
+  // compute tenative prolongator and coarse nullspace vector
+  SetupMatrixType T;
+  detail::fit_candidates(aggregates, levels.back().B, T, B_coarse);
+
+  // compute prolongation operator, unsmoothed aggregation applies P = T
+  // from the aggregates and B instead
+  if (!options.unsmoothed_aggregation)
+    detail::smooth_prolongator(levels.back().A_, T, P, ValueType(options.prolongator_weight), rho_DinvA, &D);  // TODO if C != A then compute rho_Dinv_C
 
   // construct Galerkin product R*A*P
   SetupMatrixType RAP;
+
+  if (options.unsmoothed_aggregation)
+  {
+    cusp::galerkin_product(levels.back().A_, T, RAP);
+
+    detail::setup_aggregate_permutation(aggregates, levels.back().permutation);
+  }
+  else if (options.store_restriction)
+  {
+    // compute restriction operator (transpose of prolongator)
+    SetupMatrixType R;
+    cusp::transpose(P,R);
+
+    cusp::galerkin_product(R, levels.back().A_, P, RAP);
+
+    detail::setup_level_matrix( levels.back().R, R );
+  }
+  else if (options.transpose_prolongator)
+  {
+    cusp::galerkin_product(levels.back().A_, P, RAP);
+  }
+  else
   {
-    // TODO test speed of R * (A * P) vs. (R * A) * P
-    SetupMatrixType AP;
-    cusp::multiply(levels.back().A_, P, AP);
-    cusp::multiply(R, AP, RAP);
+    cusp::galerkin_product(levels.back().A_, P, RAP);
+
+    const ValueType lambda = ValueType(options.prolongator_weight) / rho_DinvA;
+    detail::setup_implicit_restriction(aggregates, lambda, D, levels.back().permutation, levels.back().Dinv);
+    levels.back().temp1.resize(levels.back().A_.num_rows);
+    levels.back().temp2.resize(levels.back().A_.num_rows);
   }
 
-  #ifndef USE_POLY_SMOOTHER
-  //  4/3 * 1/rho is a good default, where rho is the spectral radius of D^-1(A)
-  ValueType omega = ValueType(4.0/3.0) / rho_DinvA;
-  levels.back().smoother = cusp::relaxation::jacobi<ValueType, MemorySpace>(levels.back().A_, omega);
-  #else
-  cusp::array1d<ValueType,cusp::host_memory> coef;
-  ValueType rho = cusp::detail::ritz_spectral_radius_symmetric(levels.back().A_, 8);
-  cusp::relaxation::detail::chebyshev_polynomial_coefficients(rho,coef);
-  levels.back().smoother = cusp::relaxation::polynomial<ValueType, MemorySpace>(levels.back().A_,coef);
-  #endif
+  setup_smoother(levels.size() - 1, rho_DinvA);
 
   levels.back().aggregates.swap(aggregates);
-  detail::setup_level_matrix( levels.back().R, R );
   detail::setup_level_matrix( levels.back().P, P );
   levels.back().residual.resize(levels.back().A_.num_rows);
 
@@ -263,8 +1068,114 @@ void smoothed_aggregation<IndexType,ValueType,MemorySpace>::operator()(const Arr
 {
   CUSP_PROFILE_SCOPED();
 
-  // perform 1 V-cycle
-  _solve(b, x, 0);
+  typedef thrust::detail::integral_constant<bool,
+            thrust::detail::is_same<typename Array1::value_type, ValueType>::value &&
+            thrust::detail::is_same<typename Array2::value_type, ValueType>::value> same_precision;
+
+  // perform 1 cycle
+  if (options.capture_cycle && cycle_capturable())
+    captured_apply(b, x);
+  else
+    apply(b, x, same_precision());
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+bool smoothed_aggregation<IndexType,ValueType,MemorySpace>::cycle_capturable(void) const
+{
+  // the implicit restriction and the K-cycle read results on the host
+  return thrust::detail::is_same<MemorySpace,cusp::device_memory>::value &&
+         cusp::detail::device::captured_graph::supported() &&
+         options.cycle != amg_options::K_cycle &&
+         ((options.store_restriction && !options.unsmoothed_aggregation) || levels.size() == 1) &&
+         !cusp::detail::device::is_capturing();
+}
+
+// The graph reads graph_b and writes graph_x, which b and x of any
+// precision are copied from and to on the current stream.  The smoothers
+// exchange graph_x with their workspace while the cycle is captured, so
+// that afterwards it holds the array the graph writes its result to.
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::captured_apply(const Array1& b, Array2& x)
+{
+  CUSP_PROFILE_SCOPED();
+
+  const size_t n = levels[0].A.num_rows;
+
+  graph_b.resize(n);
+  graph_x.resize(n);
+
+  cusp::detail::streamed::copy(b.begin(), b.end(), graph_b.begin());
+
+  // the first cycle after a setup computes what the kernels cache on
+  // first use (e.g. the row statistics of CSR), which requires transfers
+  // to the host and cannot be captured
+  if (cycle_applied && !cycle_graph.ready() && !cycle_graph.failed())
+  {
+    cycle_graph.begin_capture();
+
+    try
+    {
+      _solve(graph_b, graph_x, 0);
+    }
+    catch (...)
+    {
+      cycle_graph.end_capture();
+      throw;
+    }
+
+    // on failure the cycle is applied directly from now on
+    cycle_graph.end_capture();
+  }
+
+  if (cycle_graph.ready())
+    cycle_graph.launch();
+  else
+    _solve(graph_b, graph_x, 0);
+
+  cycle_applied = true;
+
+  cusp::detail::streamed::copy(graph_x.begin(), graph_x.end(), x.begin());
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::apply(const Array1& b, Array2& x, thrust::detail::true_type)
+{
+  // the smoothers may exchange their result with the storage of x, a
+  // view keeps that of the caller in place
+  cusp::array1d_view<typename Array2::iterator> x_view(x.begin(), x.end());
+
+  _solve(b, x_view, 0);
+}
+
+// b and x are in a different precision than the hierarchy: the finest
+// smoother and residual read b as it is and the cycle builds x in ValueType,
+// which is converted once at the end
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::apply(const Array1& b, Array2& x, thrust::detail::false_type)
+{
+  CUSP_PROFILE_SCOPED();
+
+  // allocated by the first call only
+  mixed_x.resize(levels[0].A.num_rows);
+
+  if (levels.size() == 1)
+  {
+    mixed_b.resize(levels[0].A.num_rows);
+    thrust::copy(b.begin(), b.end(), mixed_b.begin());
+    LU(mixed_b, mixed_x);
+  }
+  else
+  {
+    level_cycle(b, mixed_x, 0, options.cycle, false);
+  }
+
+  thrust::copy(mixed_x.begin(), mixed_x.end(), x.begin());
 }
 
 template <typename IndexType, typename ValueType, typename MemorySpace>
@@ -286,13 +1197,26 @@ void smoothed_aggregation<IndexType,ValueType,MemorySpace>::solve(const Array1&
 
   const size_t n = levels[0].A.num_rows;
 
+  if (options.solver == amg_options::cg)
+  {
+    cg_workspace.solve(levels[0].A, x, b, monitor, *this);
+    return;
+  }
+
+  if (options.solver == amg_options::gmres)
+  {
+    // no-op unless n or the restart length changed
+    gmres_workspace.resize(n, options.gmres_restart);
+    gmres_workspace.solve(levels[0].A, x, b, monitor, *this);
+    return;
+  }
+
   // use simple iteration
-  cusp::array1d<ValueType,MemorySpace> update(n);
-  cusp::array1d<ValueType,MemorySpace> residual(n);
+  update.resize(n);
+  residual.resize(n);
 
   // compute initial residual
-  cusp::multiply(levels[0].A, x, residual);
-  cusp::blas::axpby(b, residual, residual, ValueType(1.0), ValueType(-1.0));
+  cusp::residual(levels[0].A, x, b, residual);
 
   while(!monitor.finished(residual))
   {   
@@ -302,8 +1226,7 @@ void smoothed_aggregation<IndexType,ValueType,MemorySpace>::solve(const Array1&
       cusp::blas::axpy(update, x, ValueType(1.0));
 
       // update residual
-      cusp::multiply(levels[0].A, x, residual);
-      cusp::blas::axpby(b, residual, residual, ValueType(1.0), ValueType(-1.0));
+      cusp::residual(levels[0].A, x, b, residual);
       ++monitor;
   }   
 }
@@ -312,40 +1235,339 @@ template <typename IndexType, typename ValueType, typename MemorySpace>
 template <typename Array1, typename Array2>
 void smoothed_aggregation<IndexType,ValueType,MemorySpace>
 ::_solve(const Array1& b, Array2& x, const size_t i)
+{
+  _solve(b, x, i, options.cycle, false);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::_solve(const Array1& b, Array2& x, const size_t i,
+         const typename amg_options::cycle_type cycle, const bool initial_guess)
 {
   CUSP_PROFILE_SCOPED();
 
   if (i + 1 == levels.size())
   {
-    // coarse grid solve
-    // TODO streamline
-    cusp::array1d<ValueType,cusp::host_memory> temp_b(b);
-    cusp::array1d<ValueType,cusp::host_memory> temp_x(x.size());
-    LU(temp_b, temp_x);
-    x = temp_x;
+    // coarse grid solve, resident in MemorySpace
+    LU(b, x);
   }
   else
   {
-    // presmooth
-    levels[i].smoother.presmooth(levels[i].A, b, x);
+    level_cycle(b, x, i, cycle, initial_guess);
+  }
+}
+
+// one cycle on level i, which is not the coarsest
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::level_cycle(const Array1& b, Array2& x, const size_t i,
+              const typename amg_options::cycle_type cycle, const bool initial_guess)
+{
+  // each level is a scope of its own, which holds the scopes of the
+  // products and of the coarser levels
+  CUSP_PROFILE_SCOPED_NAME(cusp::detail::profiler::intern("smoothed_aggregation level", i));
+
+  // presmooth
+  presmooth(i, b, x, initial_guess);
 
+  if (!options.unsmoothed_aggregation && !options.store_restriction && options.transpose_prolongator)
+  {
+    // restrict b - A*x to the coarse grid, the residual is not stored
+    cusp::detail::residual_and_restrict(levels[i].A, x, b, levels[i].P, levels[i].residual, levels[i + 1].b);
+  }
+  else
+  {
     // compute residual <- b - A*x
-    cusp::multiply(levels[i].A, x, levels[i].residual);
-    cusp::blas::axpby(b, levels[i].residual, levels[i].residual, ValueType(1.0), ValueType(-1.0));
+    cusp::residual(levels[i].A, x, b, levels[i].residual);
 
     // restrict to coarse grid
-    cusp::multiply(levels[i].R, levels[i].residual, levels[i + 1].b);
+    restrict_residual(i, levels[i].residual, levels[i + 1].b);
+  }
+
+  // compute coarse grid solution
+  coarse_correction(i, cycle);
 
-    // compute coarse grid solution
-    _solve(levels[i + 1].b, levels[i + 1].x, i + 1);
+  // apply coarse grid correction x <- x + P * x_coarse
+  prolong_correction(i, levels[i + 1].x, x);
 
-    // apply coarse grid correction 
-    cusp::multiply(levels[i].P, levels[i + 1].x, levels[i].residual);
-    cusp::blas::axpy(levels[i].residual, x, ValueType(1.0));
+  // postsmooth
+  postsmooth(i, b, x);
+}
+
+// levels[i+1].x <- approximate solution of A[i+1] x = levels[i+1].b
+template <typename IndexType, typename ValueType, typename MemorySpace>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::coarse_correction(const size_t i, const typename amg_options::cycle_type cycle)
+{
+  CUSP_PROFILE_SCOPED();
+
+  level& C = levels[i + 1];
+
+  // the coarsest level is solved exactly, further visits are redundant
+  if (i + 2 == levels.size())
+  {
+    _solve(C.b, C.x, i + 1, cycle, false);
+    return;
+  }
+
+  switch (cycle)
+  {
+    case amg_options::V_cycle:
+      _solve(C.b, C.x, i + 1, amg_options::V_cycle, false);
+      break;
+
+    case amg_options::W_cycle:
+      _solve(C.b, C.x, i + 1, amg_options::W_cycle, false);
+      _solve(C.b, C.x, i + 1, amg_options::W_cycle, true);
+      break;
+
+    case amg_options::F_cycle:
+      _solve(C.b, C.x, i + 1, amg_options::F_cycle, false);
+      _solve(C.b, C.x, i + 1, amg_options::V_cycle, true);
+      break;
+
+    case amg_options::K_cycle:
+      krylov_correction(i);
+      break;
+  }
+}
+
+// Two steps of flexible CG on level i+1 preconditioned by K-cycles, the
+// second step is skipped when the first reduces the residual enough.
+template <typename IndexType, typename ValueType, typename MemorySpace>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::krylov_correction(const size_t i)
+{
+  CUSP_PROFILE_SCOPED();
+
+  typedef typename cusp::norm_type<ValueType>::type NormType;
+
+  const NormType tolerance = 0.25;
+
+  level& C = levels[i + 1];
+
+  // c1 <- M^-1 b, v <- A c1
+  _solve(C.b, C.x, i + 1, amg_options::K_cycle, false);
+  cusp::multiply(C.A, C.x, C.k_product);
+
+  const ValueType rho1   = cusp::blas::dotc(C.x, C.k_product);
+  const ValueType alpha1 = cusp::blas::dotc(C.x, C.b);
+
+  if (rho1 == ValueType(0))
+    return;
+
+  // r <- b - (alpha1 / rho1) v
+  cusp::blas::axpby(C.b, C.k_product, C.k_residual, ValueType(1), -alpha1 / rho1);
+
+  if (cusp::blas::nrm2(C.k_residual) <= tolerance * cusp::blas::nrm2(C.b))
+  {
+    cusp::blas::scal(C.x, alpha1 / rho1);
+    return;
+  }
+
+  // c2 <- M^-1 r
+  _solve(C.k_residual, C.k_update, i + 1, amg_options::K_cycle, false);
+
+  const ValueType gamma  = cusp::blas::dotc(C.k_update, C.k_product);
+  const ValueType alpha2 = cusp::blas::dotc(C.k_update, C.k_residual);
+
+  // v <- A c2
+  cusp::multiply(C.A, C.k_update, C.k_product);
+
+  const ValueType beta = cusp::blas::dotc(C.k_update, C.k_product);
+  const ValueType rho2 = beta - gamma * gamma / rho1;
+
+  if (rho2 == ValueType(0))
+  {
+    cusp::blas::scal(C.x, alpha1 / rho1);
+    return;
+  }
+
+  // x <- (alpha1 / rho1 - gamma * alpha2 / (rho1 * rho2)) c1 + (alpha2 / rho2) c2
+  cusp::blas::axpby(C.x, C.k_update, C.x,
+                    alpha1 / rho1 - gamma * alpha2 / (rho1 * rho2),
+                    alpha2 / rho2);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::presmooth(const size_t i, const Array1& b, Array2& x, const bool initial_guess)
+{
+  CUSP_PROFILE_SCOPED();
+
+  if (initial_guess)
+  {
+    level& L = levels[i];
+
+    // the Jacobi sweeps alternate between x and a buffer of the smoother
+    if (options.smoother == amg_options::jacobi)
+    {
+      L.jacobi_smoother.postsmooth(L.A, b, x, options.presmooth_sweeps);
+      return;
+    }
+
+    for (size_t k = 0; k < options.presmooth_sweeps; k++)
+    {
+      if (options.smoother == amg_options::gauss_seidel)
+        L.gauss_seidel_smoother.postsmooth(L.A, b, x);
+      else if (options.smoother == amg_options::chebyshev)
+        L.chebyshev_smoother.postsmooth(L.A, b, x);
+      else
+        L.polynomial_smoother.postsmooth(L.A, b, x);
+    }
+
+    return;
+  }
+
+  // the first sweep ignores the initial x
+  if (options.presmooth_sweeps == 0)
+  {
+    cusp::blas::fill(x, ValueType(0));
+    return;
+  }
+
+  level& L = levels[i];
+
+  if (options.smoother == amg_options::jacobi)
+  {
+    L.jacobi_smoother.presmooth(L.A, b, x, options.presmooth_sweeps);
+  }
+  else if (options.smoother == amg_options::gauss_seidel)
+  {
+    L.gauss_seidel_smoother.presmooth(L.A, b, x);
+    for (size_t k = 1; k < options.presmooth_sweeps; k++)
+      L.gauss_seidel_smoother.postsmooth(L.A, b, x);
+  }
+  else if (options.smoother == amg_options::chebyshev)
+  {
+    L.chebyshev_smoother.presmooth(L.A, b, x);
+    for (size_t k = 1; k < options.presmooth_sweeps; k++)
+      L.chebyshev_smoother.postsmooth(L.A, b, x);
+  }
+  else
+  {
+    L.polynomial_smoother.presmooth(L.A, b, x);
+    for (size_t k = 1; k < options.presmooth_sweeps; k++)
+      L.polynomial_smoother.postsmooth(L.A, b, x);
+  }
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::postsmooth(const size_t i, const Array1& b, Array2& x)
+{
+  CUSP_PROFILE_SCOPED();
+
+  level& L = levels[i];
+
+  if (options.smoother == amg_options::jacobi)
+  {
+    L.jacobi_smoother.postsmooth(L.A, b, x, options.postsmooth_sweeps);
+    return;
+  }
+
+  for (size_t k = 0; k < options.postsmooth_sweeps; k++)
+  {
+    if (options.smoother == amg_options::gauss_seidel)
+      L.gauss_seidel_smoother.postsmooth(L.A, b, x);
+    else if (options.smoother == amg_options::chebyshev)
+      L.chebyshev_smoother.postsmooth(L.A, b, x);
+    else
+      L.polynomial_smoother.postsmooth(L.A, b, x);
+  }
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::restrict_residual(const size_t i, const Array1& r, Array2& b)
+{
+  CUSP_PROFILE_SCOPED();
+
+  level& L = levels[i];
+
+  if (options.unsmoothed_aggregation)
+  {
+    // b <- T^T r, where T(j,aggregates[j]) = B[j] / B_coarse[aggregates[j]]
+    thrust::reduce_by_key
+      (thrust::make_permutation_iterator(L.aggregates.begin(), L.permutation.begin()),
+       thrust::make_permutation_iterator(L.aggregates.begin(), L.permutation.end()),
+       thrust::make_transform_iterator
+         (thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(L.B.begin(), L.permutation.begin()),
+                                                       thrust::make_permutation_iterator(r.begin(),   L.permutation.begin()))),
+          detail::aggregate_restriction_functor<ValueType>()),
+       thrust::make_discard_iterator(),
+       b.begin());
+
+    thrust::transform(b.begin(), b.end(), levels[i + 1].B.begin(), b.begin(), thrust::divides<ValueType>());
+    return;
+  }
+
+  if (options.store_restriction)
+  {
+    cusp::multiply(L.R, r, b);
+    return;
+  }
 
-    // postsmooth
-    levels[i].smoother.postsmooth(levels[i].A, b, x);
+  if (options.transpose_prolongator)
+  {
+    cusp::multiply_transpose(L.P, r, b);
+    return;
+  }
+
+  // temp2 <- A * (lambda * D^-1) * r
+  thrust::transform(r.begin(), r.end(), L.Dinv.begin(), L.temp1.begin(), thrust::multiplies<ValueType>());
+  cusp::multiply(L.A, L.temp1, L.temp2);
+
+  // b <- T^T (r - temp2), where T(j,aggregates[j]) = B[j] / B_coarse[aggregates[j]]
+  thrust::reduce_by_key
+    (thrust::make_permutation_iterator(L.aggregates.begin(), L.permutation.begin()),
+     thrust::make_permutation_iterator(L.aggregates.begin(), L.permutation.end()),
+     thrust::make_transform_iterator
+       (thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(L.B.begin(),     L.permutation.begin()),
+                                                     thrust::make_permutation_iterator(r.begin(),       L.permutation.begin()),
+                                                     thrust::make_permutation_iterator(L.temp2.begin(), L.permutation.begin()))),
+        detail::tentative_restriction_functor<ValueType>()),
+     thrust::make_discard_iterator(),
+     b.begin());
+
+  thrust::transform(b.begin(), b.end(), levels[i + 1].B.begin(), b.begin(), thrust::divides<ValueType>());
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+template <typename Array1, typename Array2>
+void smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::prolong_correction(const size_t i, const Array1& x_coarse, Array2& x)
+{
+  CUSP_PROFILE_SCOPED();
+
+  level& L = levels[i];
+
+  if (!options.unsmoothed_aggregation)
+  {
+    cusp::detail::prolong_and_correct(L.P, x_coarse, x);
+    return;
   }
+
+  // x <- x + T x_coarse over the aggregated rows, each of which reads the
+  // entry of its aggregate
+  const cusp::array1d<ValueType,MemorySpace>& B_coarse = levels[i + 1].B;
+
+  thrust::transform
+    (thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(x.begin(),   L.permutation.begin()),
+                                                  thrust::make_permutation_iterator(L.B.begin(), L.permutation.begin()),
+                                                  thrust::make_permutation_iterator(B_coarse.begin(), thrust::make_permutation_iterator(L.aggregates.begin(), L.permutation.begin())),
+                                                  thrust::make_permutation_iterator(x_coarse.begin(), thrust::make_permutation_iterator(L.aggregates.begin(), L.permutation.begin())))),
+     thrust::make_zip_iterator(thrust::make_tuple(thrust::make_permutation_iterator(x.begin(),   L.permutation.end()),
+                                                  thrust::make_permutation_iterator(L.B.begin(), L.permutation.end()),
+                                                  thrust::make_permutation_iterator(B_coarse.begin(), thrust::make_permutation_iterator(L.aggregates.begin(), L.permutation.end())),
+                                                  thrust::make_permutation_iterator(x_coarse.begin(), thrust::make_permutation_iterator(L.aggregates.begin(), L.permutation.end())))),
+     thrust::make_permutation_iterator(x.begin(), L.permutation.begin()),
+     detail::aggregate_prolongation_functor<ValueType>());
 }
 
 template <typename IndexType, typename ValueType, typename MemorySpace>
@@ -357,6 +1579,7 @@ void smoothed_aggregation<IndexType,ValueType,MemorySpace>
 	std::cout << "\tNumber of Levels:\t" << num_levels << std::endl;
 	std::cout << "\tOperator Complexity:\t" << operator_complexity() << std::endl;
 	std::cout << "\tGrid Complexity:\t" << grid_complexity() << std::endl;
+	std::cout << "\tMemory:\t\t\t" << memory_footprint() / 1e6 << " MB" << std::endl;
 	std::cout << "\tlevel\tunknowns\tnonzeros:\t" << std::endl;
 
 	IndexType nnz = 0;
@@ -368,8 +1591,13 @@ void smoothed_aggregation<IndexType,ValueType,MemorySpace>
   	{
 		double percent = (double)levels[index].A.num_entries / nnz;
 		std::cout << "\t" << index << "\t" << levels[index].A.num_cols << "\t\t" \
-              << levels[index].A.num_entries << " \t[" << 100*percent << "%]" \
-              << std::endl;
+              << levels[index].A.num_entries << " \t[" << 100*percent << "%]";
+		std::cout << "\t" << level_bytes(index) / 1e6 << " MB";
+		if (index < timings.size())
+			std::cout << "\t" << timings[index] << " ms";
+		if (index < peaks.size())
+			std::cout << "\t(peak " << peaks[index] / 1e6 << " MB)";
+		std::cout << std::endl;
 	}
 } 
 
@@ -385,6 +1613,49 @@ double smoothed_aggregation<IndexType,ValueType,MemorySpace>
 	return (double) nnz / (double) levels[0].A.num_entries;
 } 
 
+template <typename IndexType, typename ValueType, typename MemorySpace>
+const std::vector<double>& smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::setup_timings( void ) const
+{
+	return timings;
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+const std::vector<size_t>& smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::setup_peak_bytes( void ) const
+{
+	return peaks;
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+size_t smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::level_bytes( const size_t i ) const
+{
+	const level& L = levels[i];
+	const resetup_state& S = L.state;
+
+	return cusp::memory_footprint(L.A_) + cusp::memory_footprint(L.R) +
+	       cusp::memory_footprint(L.A)  + cusp::memory_footprint(L.P) +
+	       cusp::memory_footprint(L.aggregates) + cusp::memory_footprint(L.B) +
+	       cusp::memory_footprint(L.x) + cusp::memory_footprint(L.b) + cusp::memory_footprint(L.residual) +
+	       cusp::memory_footprint(L.permutation) + cusp::memory_footprint(L.Dinv) +
+	       cusp::memory_footprint(L.temp1) + cusp::memory_footprint(L.temp2) +
+	       cusp::memory_footprint(L.k_residual) + cusp::memory_footprint(L.k_update) + cusp::memory_footprint(L.k_product) +
+	       cusp::memory_footprint(S.T) + cusp::memory_footprint(S.P) + cusp::memory_footprint(S.R) +
+	       cusp::memory_footprint(S.R_permutation) + cusp::memory_footprint(S.AP);
+}
+
+template <typename IndexType, typename ValueType, typename MemorySpace>
+size_t smoothed_aggregation<IndexType,ValueType,MemorySpace>
+::memory_footprint( void ) const
+{
+	size_t bytes = 0;
+	for(size_t index = 0; index < levels.size(); index++)
+		bytes += level_bytes(index);
+
+	return bytes;
+}
+
 template <typename IndexType, typename ValueType, typename MemorySpace>
 double smoothed_aggregation<IndexType,ValueType,MemorySpace>
 ::grid_complexity( void )
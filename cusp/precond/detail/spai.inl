@@ -0,0 +1,273 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+
+/*! \file spai.inl
+ *  \brief Inline file for spai.h
+ */
+
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+
+#include <thrust/functional.h>
+#include <thrust/scan.h>
+#include <thrust/sequence.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+
+namespace cusp
+{
+namespace precond
+{
+namespace detail
+{
+
+// workspace of the normal equations of row i
+template <typename IndexType>
+struct spai_work_size
+{
+    const IndexType * row_offsets;
+
+    spai_work_size(const IndexType * row_offsets) : row_offsets(row_offsets) {}
+
+    __host__ __device__
+    size_t operator()(const IndexType i) const
+    {
+        const size_t n = row_offsets[i + 1] - row_offsets[i];
+
+        return n * n;
+    }
+};
+
+// Row i of M on the pattern of row i of P, the least squares solution of
+// A(J,:)^T m = e_i.  Returns 1 when the normal equations are singular.
+template <typename IndexType, typename ValueType>
+struct spai_row
+{
+    const IndexType * A_row_offsets;
+    const IndexType * A_column_indices;
+    const ValueType * A_values;
+    const IndexType * P_row_offsets;
+    const IndexType * P_column_indices;
+    const size_t    * work_offsets;
+          ValueType * work;
+          ValueType * values;
+
+    spai_row(const IndexType * A_row_offsets, const IndexType * A_column_indices, const ValueType * A_values,
+             const IndexType * P_row_offsets, const IndexType * P_column_indices,
+             const size_t * work_offsets, ValueType * work, ValueType * values)
+        : A_row_offsets(A_row_offsets), A_column_indices(A_column_indices), A_values(A_values),
+          P_row_offsets(P_row_offsets), P_column_indices(P_column_indices),
+          work_offsets(work_offsets), work(work), values(values) {}
+
+    // A(r,:) A(s,:)^T by a merge of the sorted rows
+    __host__ __device__
+    ValueType row_product(const IndexType r, const IndexType s) const
+    {
+        IndexType p = A_row_offsets[r], p_end = A_row_offsets[r + 1];
+        IndexType q = A_row_offsets[s], q_end = A_row_offsets[s + 1];
+
+        ValueType sum = 0;
+
+        while (p < p_end && q < q_end)
+        {
+            const IndexType cp = A_column_indices[p];
+            const IndexType cq = A_column_indices[q];
+
+            if (cp < cq)
+                p++;
+            else if (cq < cp)
+                q++;
+            else
+                sum += A_values[p++] * A_values[q++];
+        }
+
+        return sum;
+    }
+
+    // A(r,c), which is zero outside the pattern of A
+    __host__ __device__
+    ValueType entry(const IndexType r, const IndexType c) const
+    {
+        IndexType lo = A_row_offsets[r];
+        IndexType hi = A_row_offsets[r + 1];
+
+        while (lo < hi)
+        {
+            const IndexType mid = lo + (hi - lo) / 2;
+
+            if (A_column_indices[mid] < c)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        return (lo < A_row_offsets[r + 1] && A_column_indices[lo] == c) ? A_values[lo] : ValueType(0);
+    }
+
+    __host__ __device__
+    int operator()(const IndexType i) const
+    {
+        const IndexType   first = P_row_offsets[i];
+        const IndexType   n     = P_row_offsets[i + 1] - first;
+        const IndexType * J     = P_column_indices + first;
+
+        ValueType * G = work + work_offsets[i];
+        ValueType * m = values + first;
+
+        // lower triangle of A(J,:) A(J,:)^T and the right-hand side A(J,i)
+        for (IndexType a = 0; a < n; a++)
+        {
+            for (IndexType b = 0; b <= a; b++)
+                G[a * n + b] = row_product(J[a], J[b]);
+
+            m[a] = entry(J[a], i);
+        }
+
+        // G = L D L^T in place, with the unit diagonal of L implied
+        for (IndexType k = 0; k < n; k++)
+        {
+            ValueType d = G[k * n + k];
+
+            for (IndexType j = 0; j < k; j++)
+                d -= G[k * n + j] * G[k * n + j] * G[j * n + j];
+
+            if (!(d > ValueType(0)))
+                return 1;
+
+            G[k * n + k] = d;
+
+            for (IndexType r = k + 1; r < n; r++)
+            {
+                ValueType l = G[r * n + k];
+
+                for (IndexType j = 0; j < k; j++)
+                    l -= G[r * n + j] * G[k * n + j] * G[j * n + j];
+
+                G[r * n + k] = l / d;
+            }
+        }
+
+        for (IndexType a = 0; a < n; a++)
+            for (IndexType j = 0; j < a; j++)
+                m[a] -= G[a * n + j] * m[j];
+
+        for (IndexType a = 0; a < n; a++)
+            m[a] /= G[a * n + a];
+
+        for (IndexType a = n; a > 0; a--)
+            for (IndexType j = a; j < n; j++)
+                m[a - 1] -= G[j * n + (a - 1)] * m[j];
+
+        return 0;
+    }
+};
+
+} // end namespace detail
+
+
+// constructor
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template <typename MatrixType>
+    spai<ValueType,MemorySpace,IndexType>
+    ::spai(const MatrixType& A, size_t pattern_power)
+        : linear_operator<ValueType,MemorySpace,IndexType>(A.num_rows, A.num_cols, 0)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (A.num_rows != A.num_cols)
+            throw cusp::invalid_input_exception("matrix must be square");
+
+        const cusp::csr_matrix<IndexType,ValueType,MemorySpace> B(A);
+
+        const IndexType N = B.num_rows;
+
+        // pattern of A^pattern_power
+        cusp::csr_matrix<IndexType,ValueType,MemorySpace> P;
+
+        if (pattern_power == 0)
+        {
+            P.resize(N, N, N);
+            thrust::sequence(P.row_offsets.begin(), P.row_offsets.end());
+            thrust::sequence(P.column_indices.begin(), P.column_indices.end());
+        }
+        else
+        {
+            P = B;
+
+            for (size_t k = 1; k < pattern_power; k++)
+            {
+                cusp::csr_matrix<IndexType,ValueType,MemorySpace> Q;
+                cusp::multiply(P, B, Q);
+                P.swap(Q);
+            }
+        }
+
+        M.resize(N, N, P.num_entries);
+        M.row_offsets    = P.row_offsets;
+        M.column_indices = P.column_indices;
+
+        Parent::num_entries = M.num_entries;
+
+        if (N == 0)
+            return;
+
+        if (B.num_entries == 0)
+            throw cusp::runtime_exception("singular least squares problem in SPAI preconditioner");
+
+        cusp::array1d<IndexType,MemorySpace> rows(N);
+        thrust::sequence(rows.begin(), rows.end());
+
+        cusp::array1d<size_t,MemorySpace> work_offsets(N + 1);
+        work_offsets[0] = 0;
+        thrust::transform(rows.begin(), rows.end(), work_offsets.begin() + 1,
+                          detail::spai_work_size<IndexType>(thrust::raw_pointer_cast(&M.row_offsets[0])));
+        thrust::inclusive_scan(work_offsets.begin() + 1, work_offsets.end(), work_offsets.begin() + 1);
+
+        cusp::array1d<ValueType,MemorySpace> work(work_offsets[N]);
+
+        // one thread per row
+        const int num_singular_rows =
+            thrust::transform_reduce(rows.begin(), rows.end(),
+                                     detail::spai_row<IndexType,ValueType>(thrust::raw_pointer_cast(&B.row_offsets[0]),
+                                                                           thrust::raw_pointer_cast(&B.column_indices[0]),
+                                                                           thrust::raw_pointer_cast(&B.values[0]),
+                                                                           thrust::raw_pointer_cast(&M.row_offsets[0]),
+                                                                           thrust::raw_pointer_cast(&M.column_indices[0]),
+                                                                           thrust::raw_pointer_cast(&work_offsets[0]),
+                                                                           thrust::raw_pointer_cast(&work[0]),
+                                                                           thrust::raw_pointer_cast(&M.values[0])),
+                                     0,
+                                     thrust::plus<int>());
+
+        if (num_singular_rows > 0)
+            throw cusp::runtime_exception("singular least squares problem in SPAI preconditioner");
+    }
+
+// linear operator
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    template <typename VectorType1, typename VectorType2>
+    void spai<ValueType,MemorySpace,IndexType>
+    ::operator()(const VectorType1& x, VectorType2& y) const
+    {
+        CUSP_PROFILE_SCOPED();
+
+        cusp::multiply(M, x, y);
+    }
+
+} // end namespace precond
+} // end namespace cusp
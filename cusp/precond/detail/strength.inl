@@ -18,13 +18,21 @@
 #include <cusp/copy.h>
 #include <cusp/array1d.h>
 #include <cusp/convert.h>
+#include <cusp/coo_matrix.h>
 #include <cusp/csr_matrix.h>
 #include <cusp/detail/format_utils.h>
 
+#include <thrust/copy.h>
 #include <thrust/count.h>
+#include <thrust/for_each.h>
 #include <thrust/functional.h>
+#include <thrust/scan.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/counting_iterator.h>
 #include <thrust/iterator/zip_iterator.h>
-#include <thrust/iterator/permutation_iterator.h>
+
+#include <algorithm>
+
 
 namespace cusp
 {
@@ -40,152 +48,263 @@ ValueType absolute_value(const ValueType& x)
   return (x < 0) ? -x : x;
 }
 
-////////////////
-// Host Paths //
-////////////////
+///////////////////
+// Generic Paths //
+///////////////////
 
-template <typename Matrix1, typename Matrix2>
-void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, const double theta,
-                                      cusp::csr_format, cusp::host_memory,
-                                      cusp::csr_format, cusp::host_memory)
+template <typename ValueType>
+struct strength_absolute : public thrust::unary_function<ValueType,ValueType>
 {
-  typedef typename Matrix1::index_type IndexType;
-  typedef typename Matrix1::value_type ValueType;
+  __host__ __device__
+  ValueType operator()(const ValueType& x) const
+  {
+    return absolute_value(x);
+  }
+};
 
-  // extract matrix diagonal
-  cusp::array1d<ValueType,cusp::host_memory> diagonal;
-  cusp::detail::extract_diagonal(A, diagonal);
+// d[i] <- |A(i,i)|, found by scanning row i of A
+template <typename IndexType, typename ValueType>
+struct strength_diagonal_functor
+{
+  const IndexType * Ap;
+  const IndexType * Aj;
+  const ValueType * Ax;
+        ValueType * d;
 
-  IndexType num_entries = 0;
-  
-  // count num_entries in output
-  for(size_t i = 0; i < A.num_rows; i++)
+  strength_diagonal_functor(const IndexType * Ap, const IndexType * Aj, const ValueType * Ax, ValueType * d)
+    : Ap(Ap), Aj(Aj), Ax(Ax), d(d) {}
+
+  __host__ __device__
+  void operator()(const IndexType i) const
   {
-    const ValueType Aii = diagonal[i];
+    ValueType Aii = 0;
 
-    for(IndexType jj = A.row_offsets[i]; jj < A.row_offsets[i + 1]; jj++)
+    for(IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
     {
-      const IndexType   j = A.column_indices[jj];
-      const ValueType Aij = A.values[jj];
-      const ValueType Ajj = diagonal[j];
-
-      //  |A(i,j)| >= theta * sqrt(|A(i,i)|*|A(j,j)|)
-      if(Aij*Aij >= (theta * theta) * absolute_value(Aii * Ajj))
-        num_entries++;
+      if(Aj[jj] == i)
+      {
+        Aii = Ax[jj];
+        break;
+      }
     }
+
+    d[i] = absolute_value(Aii);
   }
-  
-  // resize output
-  S.resize(A.num_rows, A.num_cols, num_entries);
+};
+
+// Sp[i] <- number of strong connections of row i, where
+//   |A(i,j)| >= theta * sqrt(|A(i,i)|*|A(j,j)|)
+// is tested squared to eliminate the sqrt()
+template <typename IndexType, typename ValueType>
+struct strength_count_functor
+{
+  const IndexType * Ap;
+  const IndexType * Aj;
+  const ValueType * Ax;
+  const ValueType * d;
+        IndexType * Sp;
+  ValueType theta2;
+
+  strength_count_functor(const IndexType * Ap, const IndexType * Aj, const ValueType * Ax,
+                         const ValueType * d, IndexType * Sp, const ValueType theta2)
+    : Ap(Ap), Aj(Aj), Ax(Ax), d(d), Sp(Sp), theta2(theta2) {}
+
+  __host__ __device__
+  void operator()(const IndexType i) const
+  {
+    const ValueType threshold = theta2 * d[i];
+    IndexType count = 0;
 
-  // reset counter for second pass
-  num_entries = 0;
+    for(IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+    {
+      const ValueType Aij = Ax[jj];
 
-  // copy strong connections to output
-  for(size_t i = 0; i < A.num_rows; i++)
+      if(Aij * Aij >= threshold * d[Aj[jj]])
+        count++;
+    }
+
+    Sp[i] = count;
+  }
+};
+
+// copy the strong connections of row i to S, and the row index to Si
+// unless Si is null (CSR output)
+template <typename IndexType, typename ValueType1, typename ValueType2>
+struct strength_compact_functor
+{
+  const IndexType  * Ap;
+  const IndexType  * Aj;
+  const ValueType1 * Ax;
+  const ValueType1 * d;
+  const IndexType  * Sp;
+        IndexType  * Si;
+        IndexType  * Sj;
+        ValueType2 * Sx;
+  ValueType1 theta2;
+
+  strength_compact_functor(const IndexType * Ap, const IndexType * Aj, const ValueType1 * Ax, const ValueType1 * d,
+                           const IndexType * Sp, IndexType * Si, IndexType * Sj, ValueType2 * Sx,
+                           const ValueType1 theta2)
+    : Ap(Ap), Aj(Aj), Ax(Ax), d(d), Sp(Sp), Si(Si), Sj(Sj), Sx(Sx), theta2(theta2) {}
+
+  __host__ __device__
+  void operator()(const IndexType i) const
   {
-    const ValueType Aii = diagonal[i];
-  
-    S.row_offsets[i] = num_entries;
+    const ValueType1 threshold = theta2 * d[i];
+    IndexType n = Sp[i];
 
-    for(IndexType jj = A.row_offsets[i]; jj < A.row_offsets[i + 1]; jj++)
+    for(IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
     {
-      const IndexType   j = A.column_indices[jj];
-      const ValueType Aij = A.values[jj];
-      const ValueType Ajj = diagonal[j];
-      
-      //  |A(i,j)| >= theta * sqrt(|A(i,i)|*|A(j,j)|)
-      if(Aij*Aij >= (theta * theta) * absolute_value(Aii * Ajj))
+      const IndexType   j = Aj[jj];
+      const ValueType1 Aij = Ax[jj];
+
+      if(Aij * Aij >= threshold * d[j])
       {
-        S.column_indices[num_entries] =   j;
-        S.values[num_entries]         = Aij;
-        num_entries++;
+        if(Si != 0) Si[n] = i;
+        Sj[n] = j;
+        Sx[n] = Aij;
+        n++;
       }
     }
   }
-    
-  S.row_offsets[S.num_rows] = num_entries;
+};
+
+template <typename Array>
+typename Array::value_type * raw_pointer(Array& a)
+{
+  return a.empty() ? 0 : thrust::raw_pointer_cast(&a[0]);
 }
 
-//////////////////
-// Device Paths //
-//////////////////
+template <typename Array>
+const typename Array::value_type * raw_pointer(const Array& a)
+{
+  return a.empty() ? 0 : thrust::raw_pointer_cast(&a[0]);
+}
 
-/* none for now */
+// Classify the entries of the rows of A and compact the strong ones into
+// S in one fused count / scan / compact sequence.  S_row_offsets holds
+// the row offsets of S on return, S_row_indices (COO) is filled
+// when present.  The diagonal of A is found in its rows unless it is
+// given in A_diagonal.
+template <typename Array1, typename Array2, typename Array3, typename Array4, typename Array5, typename Array6, typename Array7,
+          typename Array8>
+void compact_strong_connections(const size_t num_rows, const size_t num_cols,
+                                const Array1& A_row_offsets, const Array2& A_column_indices, const Array3& A_values,
+                                const double theta, const Array8* A_diagonal,
+                                Array4& S_row_offsets, Array5* S_row_indices, Array6& S_column_indices, Array7& S_values)
+{
+  typedef typename Array2::value_type   IndexType;
+  typedef typename Array3::value_type   ValueType;
+  typedef typename Array3::memory_space MemorySpace;
 
-///////////////////
-// Generic Paths //
-///////////////////
+  const ValueType theta2 = ValueType(theta * theta);
 
-template <typename ValueType>
-struct is_strong_connection
+  // |A(j,j)| is looked up for every column j, rows past the diagonal read zero
+  cusp::array1d<ValueType,MemorySpace> diagonal(std::max(num_rows, num_cols), ValueType(0));
+
+  if (A_diagonal != 0)
+    thrust::transform(A_diagonal->begin(), A_diagonal->begin() + num_rows, diagonal.begin(), strength_absolute<ValueType>());
+  else
+    thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                     thrust::counting_iterator<IndexType>(num_rows),
+                     strength_diagonal_functor<IndexType,ValueType>
+                       (raw_pointer(A_row_offsets), raw_pointer(A_column_indices), raw_pointer(A_values), raw_pointer(diagonal)));
+
+  S_row_offsets.resize(num_rows + 1);
+  S_row_offsets[num_rows] = 0;
+
+  thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                   thrust::counting_iterator<IndexType>(num_rows),
+                   strength_count_functor<IndexType,ValueType>
+                     (raw_pointer(A_row_offsets), raw_pointer(A_column_indices), raw_pointer(A_values),
+                      raw_pointer(diagonal), raw_pointer(S_row_offsets), theta2));
+
+  thrust::exclusive_scan(S_row_offsets.begin(), S_row_offsets.end(), S_row_offsets.begin());
+
+  const size_t num_entries = S_row_offsets[num_rows];
+
+  if (S_row_indices != 0)
+    S_row_indices->resize(num_entries);
+  S_column_indices.resize(num_entries);
+  S_values.resize(num_entries);
+
+  thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                   thrust::counting_iterator<IndexType>(num_rows),
+                   strength_compact_functor<IndexType,ValueType,typename Array7::value_type>
+                     (raw_pointer(A_row_offsets), raw_pointer(A_column_indices), raw_pointer(A_values), raw_pointer(diagonal),
+                      raw_pointer(S_row_offsets), S_row_indices == 0 ? 0 : raw_pointer(*S_row_indices),
+                      raw_pointer(S_column_indices), raw_pointer(S_values), theta2));
+}
+
+template <typename Matrix1, typename Matrix2, typename Array, typename Diagonal, typename MemorySpace>
+void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, Array* S_row_offsets, const double theta, const Diagonal* diagonal,
+                                      cusp::csr_format, MemorySpace,
+                                      cusp::csr_format, MemorySpace)
 {
-  ValueType theta;
+  S.resize(A.num_rows, A.num_cols, 0);
 
-  is_strong_connection(const ValueType theta) : theta(theta) {}
+  compact_strong_connections(A.num_rows, A.num_cols, A.row_offsets, A.column_indices, A.values, theta, diagonal,
+                             S.row_offsets, (cusp::array1d<typename Matrix2::index_type,MemorySpace> *) 0, S.column_indices, S.values);
 
-  template <typename Tuple>
-    __host__ __device__
-  bool operator()(const Tuple& t) const
-  {
-    ValueType Aij = thrust::get<0>(t);
-    ValueType Aii = thrust::get<1>(t);
-    ValueType Ajj = thrust::get<2>(t);
+  S.num_entries = S.values.size();
 
-    // square everything to eliminate the sqrt()
-    return (Aij * Aij) >= (theta * theta) * absolute_value(Aii * Ajj);
-  }
-};
+  if (S_row_offsets != 0)
+    cusp::copy(S.row_offsets, *S_row_offsets);
+}
 
-template <typename Matrix1, typename Matrix2, typename MemorySpace>
-void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, const double theta,
+template <typename Matrix1, typename Matrix2, typename Array, typename Diagonal, typename MemorySpace>
+void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, Array* S_row_offsets, const double theta, const Diagonal* diagonal,
                                       cusp::coo_format, MemorySpace,
                                       cusp::coo_format, MemorySpace)
 {
   typedef typename Matrix1::index_type IndexType;
-  typedef typename Matrix1::value_type ValueType;
 
-  cusp::array1d<ValueType,MemorySpace> diagonal;
-  cusp::detail::extract_diagonal(A, diagonal);
+  // the rows of A are sorted, so they are processed like CSR rows
+  cusp::array1d<IndexType,MemorySpace> A_row_offsets(A.num_rows + 1);
+  cusp::detail::indices_to_offsets(A.row_indices, A_row_offsets);
+
+  cusp::array1d<IndexType,MemorySpace> row_offsets;
 
-  is_strong_connection<ValueType> pred(theta);
+  S.resize(A.num_rows, A.num_cols, 0);
 
-  // compute number of entries in output
-  IndexType num_entries = thrust::count_if
-    (thrust::make_zip_iterator(thrust::make_tuple
-       (A.values.begin(),
-        thrust::make_permutation_iterator(diagonal.begin(), A.row_indices.begin()),
-        thrust::make_permutation_iterator(diagonal.begin(), A.column_indices.begin()))),
-     thrust::make_zip_iterator(thrust::make_tuple
-       (A.values.begin(),
-        thrust::make_permutation_iterator(diagonal.begin(), A.row_indices.begin()),
-        thrust::make_permutation_iterator(diagonal.begin(), A.column_indices.begin()))) + A.num_entries,
-     pred);
+  compact_strong_connections(A.num_rows, A.num_cols, A_row_offsets, A.column_indices, A.values, theta, diagonal,
+                             row_offsets, &S.row_indices, S.column_indices, S.values);
 
-  // this is just zipping up (A[i,j],A[i,i],A[j,j]) and applying is_strong_connection to each tuple
+  S.num_entries = S.values.size();
 
-  // resize output
-  S.resize(A.num_rows, A.num_cols, num_entries);
+  if (S_row_offsets != 0)
+    cusp::copy(row_offsets, *S_row_offsets);
+}
 
-  // copy strong connections to output
-  thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(A.row_indices.begin(), A.column_indices.begin(), A.values.begin())),
-                  thrust::make_zip_iterator(thrust::make_tuple(A.row_indices.begin(), A.column_indices.begin(), A.values.begin())) + A.num_entries,
-                  thrust::make_zip_iterator(thrust::make_tuple
-                    (A.values.begin(),
-                     thrust::make_permutation_iterator(diagonal.begin(), A.row_indices.begin()),
-                     thrust::make_permutation_iterator(diagonal.begin(), A.column_indices.begin()))),
-                  thrust::make_zip_iterator(thrust::make_tuple(S.row_indices.begin(), S.column_indices.begin(), S.values.begin())),
-                  pred);
+// row offsets of the pattern of S
+template <typename Matrix, typename Array>
+void strength_row_offsets(const Matrix& S, Array& row_offsets, cusp::csr_format)
+{
+  cusp::copy(S.row_offsets, row_offsets);
+}
+
+template <typename Matrix, typename Array>
+void strength_row_offsets(const Matrix& S, Array& row_offsets, cusp::coo_format)
+{
+  row_offsets.resize(S.num_rows + 1);
+  cusp::detail::indices_to_offsets(S.row_indices, row_offsets);
+}
+
+template <typename Matrix, typename Array, typename Format>
+void strength_row_offsets(const Matrix& S, Array& row_offsets, Format)
+{
+  cusp::csr_matrix<typename Matrix::index_type,typename Matrix::value_type,typename Array::memory_space> S_csr(S);
+  cusp::copy(S_csr.row_offsets, row_offsets);
 }
 
 //////////////////
 // Default Path //
 //////////////////
 
-template <typename Matrix1, typename Matrix2,
+template <typename Matrix1, typename Matrix2, typename Array, typename Diagonal,
           typename Format1, typename MemorySpace1,
           typename Format2, typename MemorySpace2>
-void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, const double theta,
+void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, Array* S_row_offsets, const double theta, const Diagonal* diagonal,
                                       Format1, MemorySpace1,
                                       Format2, MemorySpace2)
 {
@@ -194,11 +313,16 @@ void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, const double
   typedef typename Matrix2::index_type IndexType2;
   typedef typename Matrix2::value_type ValueType2;
 
-  // do everything on the host using the CSR format
-  cusp::csr_matrix<IndexType1,ValueType1,cusp::host_memory> A_csr(A);
-  cusp::csr_matrix<IndexType2,ValueType2,cusp::host_memory> S_csr;
+  // compute S in CSR format in the memory space of A
+  cusp::csr_matrix<IndexType1,ValueType1,MemorySpace1> A_csr(A);
+  cusp::csr_matrix<IndexType2,ValueType2,MemorySpace1> S_csr;
+
+  symmetric_strength_of_connection(A_csr, S_csr, (Array *) 0, theta, diagonal,
+                                   cusp::csr_format(), MemorySpace1(),
+                                   cusp::csr_format(), MemorySpace1());
 
-  symmetric_strength_of_connection(A_csr, S_csr, theta);
+  if (S_row_offsets != 0)
+    cusp::copy(S_csr.row_offsets, *S_row_offsets);
 
   cusp::convert(S_csr, S);
 }
@@ -207,26 +331,150 @@ void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, const double
 // Entry Point //
 /////////////////
 
-template <typename Matrix1, typename Matrix2>
-void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, const double theta)
+template <typename Matrix1, typename Matrix2, typename Array, typename Diagonal>
+void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, Array* S_row_offsets, const double theta, const Diagonal* diagonal)
 {
-  CUSP_PROFILE_SCOPED();
-
   if (theta == 0.0)
   {
     // everything is a strong connection
     cusp::copy(A,S);
+
+    if (S_row_offsets != 0)
+      strength_row_offsets(S, *S_row_offsets, typename Matrix2::format());
   }
   else
   {
     // dispatch based on format and memory_space
     symmetric_strength_of_connection
-      (A, S, theta,
-       typename Matrix1::format(), typename Matrix1::memory_space(), 
+      (A, S, S_row_offsets, theta, diagonal,
+       typename Matrix1::format(), typename Matrix1::memory_space(),
        typename Matrix2::format(), typename Matrix2::memory_space());
   }
 }
 
+template <typename Matrix1, typename Matrix2>
+void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, const double theta)
+{
+  CUSP_PROFILE_SCOPED();
+
+  typedef cusp::array1d<typename Matrix2::index_type,typename Matrix2::memory_space> RowOffsets;
+  typedef cusp::array1d<typename Matrix1::value_type,typename Matrix1::memory_space> Diagonal;
+
+  symmetric_strength_of_connection(A, S, (RowOffsets *) 0, theta, (Diagonal *) 0);
+}
+
+template <typename Matrix1, typename Matrix2, typename Array>
+void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, Array& S_row_offsets, const double theta)
+{
+  CUSP_PROFILE_SCOPED();
+
+  typedef cusp::array1d<typename Matrix1::value_type,typename Matrix1::memory_space> Diagonal;
+
+  symmetric_strength_of_connection(A, S, &S_row_offsets, theta, (Diagonal *) 0);
+}
+
+template <typename Matrix1, typename Matrix2, typename Array>
+void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, const double theta, const Array& diagonal)
+{
+  CUSP_PROFILE_SCOPED();
+
+  typedef cusp::array1d<typename Matrix2::index_type,typename Matrix2::memory_space> RowOffsets;
+
+  symmetric_strength_of_connection(A, S, (RowOffsets *) 0, theta, &diagonal);
+}
+
+////////////////////////
+// Classical Strength //
+////////////////////////
+
+// strong[jj] <- -A(i,j) >= theta * max_{k != i} -A(i,k) for the entries of row i
+template <typename IndexType, typename ValueType, typename FlagType>
+struct classical_strength_functor
+{
+  const IndexType * Ap;
+  const IndexType * Aj;
+  const ValueType * Ax;
+        FlagType  * strong;
+  ValueType theta;
+
+  classical_strength_functor(const IndexType * Ap, const IndexType * Aj, const ValueType * Ax,
+                             FlagType * strong, const ValueType theta)
+    : Ap(Ap), Aj(Aj), Ax(Ax), strong(strong), theta(theta) {}
+
+  __host__ __device__
+  void operator()(const IndexType i) const
+  {
+    ValueType max_offdiagonal = 0;
+
+    for(IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+      if(Aj[jj] != i && -Ax[jj] > max_offdiagonal)
+        max_offdiagonal = -Ax[jj];
+
+    const ValueType threshold = theta * max_offdiagonal;
+
+    for(IndexType jj = Ap[i]; jj < Ap[i + 1]; jj++)
+      strong[jj] = Aj[jj] != i && max_offdiagonal > 0 && -Ax[jj] >= threshold;
+  }
+};
+
+template <typename Matrix, typename Array>
+void classical_strong_connections(const Matrix& A, Array& strong, const double theta)
+{
+  typedef typename Matrix::index_type IndexType;
+  typedef typename Matrix::value_type ValueType;
+
+  strong.resize(A.num_entries);
+
+  thrust::for_each(thrust::counting_iterator<IndexType>(0),
+                   thrust::counting_iterator<IndexType>(A.num_rows),
+                   classical_strength_functor<IndexType,ValueType,typename Array::value_type>
+                     (raw_pointer(A.row_offsets), raw_pointer(A.column_indices), raw_pointer(A.values),
+                      raw_pointer(strong), ValueType(theta)));
+}
+
+// B <- the entries of the CSR matrix A flagged in keep, with the given
+// values, in the order of A
+template <typename Matrix1, typename Array1, typename Array2, typename Matrix2>
+void compact_flagged_entries(const Matrix1& A, const Array1& keep, const Array2& values, Matrix2& B)
+{
+  typedef typename Matrix1::index_type   IndexType;
+  typedef typename Matrix1::memory_space MemorySpace;
+  typedef typename Array2::value_type    ValueType;
+
+  cusp::array1d<IndexType,MemorySpace> rows(A.num_entries);
+  cusp::detail::offsets_to_indices(A.row_offsets, rows);
+
+  const size_t num_entries = thrust::count(keep.begin(), keep.end(), true);
+
+  cusp::coo_matrix<IndexType,ValueType,MemorySpace> C(A.num_rows, A.num_cols, num_entries);
+
+  thrust::copy_if(thrust::make_zip_iterator(thrust::make_tuple(rows.begin(), A.column_indices.begin(), values.begin())),
+                  thrust::make_zip_iterator(thrust::make_tuple(rows.end(),   A.column_indices.end(),   values.end())),
+                  keep.begin(),
+                  thrust::make_zip_iterator(thrust::make_tuple(C.row_indices.begin(), C.column_indices.begin(), C.values.begin())),
+                  thrust::identity<bool>());
+
+  cusp::convert(C, B);
+}
+
+template <typename Matrix1, typename Matrix2>
+void classical_strength_of_connection(const Matrix1& A, Matrix2& S, const double theta)
+{
+  CUSP_PROFILE_SCOPED();
+
+  typedef typename Matrix1::index_type   IndexType;
+  typedef typename Matrix1::value_type   ValueType;
+  typedef typename Matrix1::memory_space MemorySpace;
+
+  // classify the rows of a CSR copy of A in its own memory space
+  cusp::csr_matrix<IndexType,ValueType,MemorySpace> A_csr(A);
+
+  cusp::array1d<bool,MemorySpace> strong;
+  classical_strong_connections(A_csr, strong, theta);
+
+  compact_flagged_entries(A_csr, strong, A_csr.values, S);
+}
+
 } // end namepace detail
 } // end namespace precond
 } // end namespace cusp
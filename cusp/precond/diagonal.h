@@ -26,6 +26,7 @@
 #include <cusp/detail/config.h>
 
 #include <cusp/linear_operator.h>
+#include <cusp/detail/diagonal_cache.h>
 
 namespace cusp
 {
@@ -88,6 +89,17 @@ public:
      */
     template<typename MatrixType>
     diagonal(const MatrixType& A);
+
+    /*! construct a \p diagonal preconditioner from the reciprocals held
+     *  by \p cache, which are extracted from \p A unless they are cached
+     *  already
+     *
+     * \param A matrix to precondition
+     * \param cache diagonal cache of \p A
+     * \tparam MatrixType matrix
+     */
+    template<typename MatrixType>
+    diagonal(const MatrixType& A, cusp::detail::diagonal_cache<ValueType,MemorySpace>& cache);
         
     /*! apply the preconditioner to vector \p x and store the result in \p y
      *
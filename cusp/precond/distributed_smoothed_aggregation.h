@@ -0,0 +1,197 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file distributed_smoothed_aggregation.h
+ *  \brief Smoothed aggregation hierarchy distributed across devices
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/csr_matrix.h>
+#include <cusp/distributed_array1d.h>
+#include <cusp/distributed_csr_matrix.h>
+#include <cusp/distribution.h>
+#include <cusp/linear_operator.h>
+#include <cusp/precond/smoothed_aggregation.h>
+
+#include <cusp/detail/lu.h>
+
+#include <vector>
+
+namespace cusp
+{
+namespace precond
+{
+
+/*! \addtogroup preconditioners Preconditioners
+ *  \ingroup preconditioners
+ *  \{
+ */
+
+/*! \p distributed_smoothed_aggregation : smoothed aggregation multigrid
+ *  whose levels are partitioned across several devices and processes,
+ *  for matrices that do not fit on a single device.
+ *
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ *
+ *  Every level is a \p distributed_csr_matrix with distributed vectors.
+ *  The hierarchy is built partition by partition, each on its own
+ *  device:
+ *  - the strength of connection and the aggregation only consider the
+ *    local block of the partition, so aggregates do not cross partition
+ *    boundaries and the coarse rows of a partition are its aggregates;
+ *  - the prolongator is smoothed with the local block, hence restriction
+ *    and prolongation never communicate;
+ *  - the Galerkin product of a partition multiplies its rows, including
+ *    the off-process columns, by the rows of the prolongator that belong
+ *    to its halo columns, which are imported from the owning partitions.
+ *
+ *  A coarse level whose partitions hold fewer than
+ *  \p amg_options::consolidation_size rows on average is consolidated:
+ *  consecutive partitions are merged onto the device of the first one,
+ *  so the bottom of the cycle involves fewer devices.  The coarsest
+ *  level is consolidated onto a single partition and solved directly.
+ *
+ *  The hierarchy applies a V-cycle with weighted Jacobi smoothing.  The
+ *  theta, max_levels, coarse_size, sweep and weight options hold as for
+ *  \p smoothed_aggregation, the other options are ignored.  The setup,
+ *  the cycle and the destruction are collective on the communicator of
+ *  the distribution.
+ *
+ *  \code
+ *  #include <cusp/precond/distributed_smoothed_aggregation.h>
+ *  #include <cusp/gallery/poisson.h>
+ *  #include <cusp/krylov/cg.h>
+ *
+ *  cusp::csr_matrix<int, double, cusp::host_memory> B;
+ *  cusp::gallery::poisson7pt(B, 200, 200, 200);
+ *
+ *  std::vector<int> devices;
+ *  devices.push_back(0);
+ *  devices.push_back(1);
+ *
+ *  cusp::precond::distributed_smoothed_aggregation<int, double> M(B, devices);
+ *
+ *  const cusp::distributed_csr_matrix<int, double, cusp::distributed_memory>& A = M.matrix();
+ *
+ *  cusp::scoped_distribution scope(A.get_distribution());
+ *
+ *  cusp::distributed_array1d<double> x(A.num_rows, 0);
+ *  cusp::distributed_array1d<double> b(A.num_rows, 1);
+ *
+ *  cusp::default_monitor<double> monitor(b, 100, 1e-8);
+ *  cusp::krylov::cg(A, x, b, monitor, M);
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType>
+class distributed_smoothed_aggregation : public cusp::linear_operator<ValueType, cusp::distributed_memory, IndexType>
+{
+    typedef cusp::linear_operator<ValueType, cusp::distributed_memory, IndexType>      Parent;
+    typedef cusp::csr_matrix<IndexType, ValueType, cusp::host_memory>                  HostMatrix;
+    typedef cusp::distributed_csr_matrix<IndexType, ValueType, cusp::distributed_memory> DistributedMatrix;
+    typedef cusp::distributed_array1d<ValueType>                                       DistributedArray;
+
+    struct transfer;
+    struct level;
+
+    public:
+    /*! Build a hierarchy of a matrix partitioned across the given devices,
+     *  as by the corresponding \p distributed_csr_matrix constructor.
+     *
+     *  \param A A square sparse or dense matrix.
+     *  \param devices The device of each partition of the finest level.
+     *  \param options Parameters of the setup and of the cycle.
+     */
+    template <typename MatrixType>
+    distributed_smoothed_aggregation(const MatrixType& A, const std::vector<int>& devices,
+                                     const amg_options& options = amg_options());
+
+    /*! Build the part of a hierarchy that resides on the calling process.
+     *  Collective on the communicator of the distribution.
+     *
+     *  \param rows The rows of the partitions of the calling process with
+     *  the columns of the whole matrix, as for \p distributed_csr_matrix.
+     *  \param d The distribution of the rows of the finest level.
+     *  \param options Parameters of the setup and of the cycle.
+     */
+    template <typename MatrixType>
+    distributed_smoothed_aggregation(const MatrixType& rows, const cusp::distribution& d,
+                                     const amg_options& options = amg_options());
+
+    ~distributed_smoothed_aggregation(void);
+
+    /*! the finest matrix, whose distribution the vectors of \p operator()
+     *  must have
+     */
+    const DistributedMatrix& matrix(void) const { return *levels[0]->A; }
+
+    /*! number of levels, including the coarsest
+     */
+    size_t num_levels(void) const { return levels.size(); }
+
+    /*! distribution of the rows of level \p i
+     */
+    const cusp::distribution& level_distribution(size_t i) const { return levels[i]->dist; }
+
+    /*! Apply one V-cycle to \p b, where \p b and \p x are distributed like
+     *  the rows of the finest matrix.
+     */
+    template <typename Array1, typename Array2>
+    void operator()(const Array1& b, Array2& x);
+
+    double operator_complexity(void) const;
+
+    double grid_complexity(void) const;
+
+    private:
+    std::vector<level *> levels;
+
+    amg_options options;
+
+    // the coarsest level on a single partition
+    cusp::distribution solve_dist;
+    DistributedArray solve_b;
+    DistributedArray solve_x;
+    cusp::detail::lu_solver<ValueType, cusp::device_memory> * LU; // null on other processes
+
+    void setup(HostMatrix& rows);
+
+    void extend_hierarchy(HostMatrix& rows, DistributedArray& B);
+
+    void setup_coarse(const HostMatrix& rows);
+
+    void release(void);
+
+    void jacobi_sweep(level& L, const DistributedArray& b, DistributedArray& x);
+
+    void cycle(const size_t i, const DistributedArray& b, DistributedArray& x);
+
+    // not copyable
+    distributed_smoothed_aggregation(const distributed_smoothed_aggregation&);
+    distributed_smoothed_aggregation& operator=(const distributed_smoothed_aggregation&);
+};
+/*! \}
+ */
+
+} // end namespace precond
+} // end namespace cusp
+
+#include <cusp/precond/detail/distributed_smoothed_aggregation.inl>
+
@@ -0,0 +1,180 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file ilu.h
+ *  \brief Incomplete LU and Cholesky preconditioners.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/linear_operator.h>
+#include <cusp/triangular_solve.h>
+
+namespace cusp
+{
+namespace precond
+{
+
+/*! \addtogroup preconditioners Preconditioners
+ *  \ingroup preconditioners
+ *  \{
+ */
+
+/*! \p ilu0 : incomplete LU factorization with zero fill-in
+ *
+ *  The factors \c L (unit lower triangular) and \c U (upper triangular)
+ *  have the sparsity pattern of \c A and are stored together in one CSR
+ *  matrix.  Applying the preconditioner solves <tt>L U y = x</tt>.
+ *
+ *  The rows of the triangular factors are grouped into levels once, at
+ *  setup by \p cusp::triangular_solve_analyze, such that the rows of a
+ *  level only depend on the rows of earlier levels.  The factorization
+ *  processes one level at a time with one thread per row, and the solves
+ *  use \p cusp::triangular_solve with the same analysis.
+ *  The number of levels bounds the parallelism: matrices from structured
+ *  grids in natural order have a few levels per grid line, while a
+ *  coloring (see \p cusp::graph::vertex_coloring and \p cusp::permute)
+ *  reduces the number of levels at the cost of a weaker factorization.
+ *
+ *  Every row of \c A must store its diagonal entry.
+ *
+ *  \tparam ValueType Type used for matrix values (e.g. \c float or \c double).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *  \tparam IndexType Type used for matrix indices (e.g. \c int).
+ *
+ *  \code
+ *  #include <cusp/precond/ilu.h>
+ *  #include <cusp/krylov/gmres.h>
+ *  ...
+ *
+ *  cusp::array1d<float, cusp::device_memory> x(A.num_rows, 0);
+ *  cusp::array1d<float, cusp::device_memory> b(A.num_rows, 1);
+ *
+ *  cusp::default_monitor<float> monitor(b, 100, 1e-6);
+ *
+ *  // setup preconditioner
+ *  cusp::precond::ilu0<float, cusp::device_memory> M(A);
+ *
+ *  // solve
+ *  cusp::krylov::gmres(A, x, b, 30, monitor, M);
+ *  \endcode
+ */
+template <typename ValueType, typename MemorySpace, typename IndexType = int>
+class ilu0 : public linear_operator<ValueType, MemorySpace, IndexType>
+{       
+    typedef linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+    cusp::csr_matrix<IndexType, ValueType, MemorySpace> LU;
+
+    cusp::triangular_solve_plan<IndexType, MemorySpace> lower_plan;
+    cusp::triangular_solve_plan<IndexType, MemorySpace> upper_plan;
+
+public:
+    /*! construct an \p ilu0 preconditioner
+     *
+     * \param A matrix to precondition
+     * \tparam MatrixType matrix
+     */
+    template<typename MatrixType>
+    ilu0(const MatrixType& A);
+        
+    /*! number of levels of the lower and the upper triangular solve
+     */
+    size_t num_lower_levels(void) const { return lower_plan.num_levels(); }
+    size_t num_upper_levels(void) const { return upper_plan.num_levels(); }
+
+    /*! apply the preconditioner to vector \p x and store the result in \p y
+     *
+     * \param x input vector
+     * \param y ouput vector
+     * \tparam VectorType1 vector
+     * \tparam VectorType2 vector
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+};
+
+/*! \p ic0 : incomplete Cholesky factorization with zero fill-in
+ *
+ *  The lower triangular factor \c L has the sparsity pattern of the lower
+ *  triangle of \c A, which must be symmetric positive definite.  Its
+ *  transpose is stored as well, so that applying the preconditioner, which
+ *  solves <tt>L L^T y = x</tt>, reads both factors by rows.  The
+ *  factorization and the solves are level-scheduled as in \p ilu0.
+ *
+ *  Setup throws \p cusp::runtime_exception when a pivot is not positive,
+ *  which may happen for SPD matrices that are not M-matrices.
+ *
+ *  \tparam ValueType Type used for matrix values (e.g. \c float or \c double).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *  \tparam IndexType Type used for matrix indices (e.g. \c int).
+ *
+ *  \code
+ *  // setup preconditioner
+ *  cusp::precond::ic0<float, cusp::device_memory> M(A);
+ *
+ *  // solve
+ *  cusp::krylov::cg(A, x, b, monitor, M);
+ *  \endcode
+ */
+template <typename ValueType, typename MemorySpace, typename IndexType = int>
+class ic0 : public linear_operator<ValueType, MemorySpace, IndexType>
+{       
+    typedef linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+    cusp::csr_matrix<IndexType, ValueType, MemorySpace> L;
+    cusp::csr_matrix<IndexType, ValueType, MemorySpace> L_t;
+
+    cusp::triangular_solve_plan<IndexType, MemorySpace> lower_plan;
+    cusp::triangular_solve_plan<IndexType, MemorySpace> upper_plan;
+
+public:
+    /*! construct an \p ic0 preconditioner
+     *
+     * \param A symmetric positive definite matrix to precondition
+     * \tparam MatrixType matrix
+     */
+    template<typename MatrixType>
+    ic0(const MatrixType& A);
+        
+    /*! number of levels of the lower and the upper triangular solve
+     */
+    size_t num_lower_levels(void) const { return lower_plan.num_levels(); }
+    size_t num_upper_levels(void) const { return upper_plan.num_levels(); }
+
+    /*! apply the preconditioner to vector \p x and store the result in \p y
+     *
+     * \param x input vector
+     * \param y ouput vector
+     * \tparam VectorType1 vector
+     * \tparam VectorType2 vector
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+};
+/*! \}
+ */
+
+} // end namespace precond
+} // end namespace cusp
+
+#include <cusp/precond/detail/ilu.inl>
+
@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file polynomial.h
+ *  \brief Polynomial preconditioner.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/linear_operator.h>
+
+namespace cusp
+{
+namespace precond
+{
+
+/*! \addtogroup preconditioners Preconditioners
+ *  \ingroup preconditioners
+ *  \{
+ */
+
+/*! \p polynomial : polynomial preconditioner of the Jacobi-scaled matrix
+ *
+ *  The preconditioner approximates A^-1 by <tt>p(D^-1 A) D^-1</tt>, where
+ *  \c D is the main diagonal of \c A and \c p is a polynomial of the given
+ *  degree chosen so that the residual polynomial <tt>q(t) = 1 - t p(t)</tt>
+ *  is small on the spectrum of <tt>D^-1 A</tt>:
+ *
+ *  - \c neumann: <tt>q(t) = (1 - t / (upper rho))^(degree + 1)</tt>, the
+ *    truncated Neumann series of the damped Jacobi iteration
+ *  - \c chebyshev: the shifted and scaled Chebyshev polynomial of degree
+ *    <tt>degree + 1</tt> on <tt>[lower rho, upper rho]</tt>
+ *
+ *  where \c rho is the spectral radius of <tt>D^-1 A</tt>, estimated at
+ *  setup with a few power iterations.  For symmetric \c A with a positive
+ *  diagonal the preconditioner is symmetric, and it is positive definite
+ *  when the spectrum lies below <tt>upper rho</tt>, so it may be used
+ *  with \p cg.
+ *
+ *  Unlike \p ainv or \p smoothed_aggregation, the preconditioner needs
+ *  neither a costly setup nor any global reduction when it is applied:
+ *  <tt>y = M x</tt> computes the powers of <tt>D^-1 A</tt> with
+ *  \p cusp::matrix_powers, one pass over the matrix for banded matrices,
+ *  and combines them with the coefficients of \c p.
+ *
+ *  \tparam ValueType Type used for matrix values (e.g. \c float or \c double).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ *  \code
+ *  #include <cusp/precond/polynomial.h>
+ *  ...
+ *
+ *  cusp::default_monitor<float> monitor(b, 100, 1e-6);
+ *
+ *  // setup preconditioner
+ *  typedef cusp::precond::polynomial<float, cusp::device_memory> Polynomial;
+ *  Polynomial M(A, 4, Polynomial::chebyshev);
+ *
+ *  // solve
+ *  cusp::krylov::cg(A, x, b, monitor, M);
+ *  \endcode
+ */
+template <typename ValueType, typename MemorySpace>
+class polynomial : public linear_operator<ValueType, MemorySpace>
+{
+    typedef linear_operator<ValueType, MemorySpace> Parent;
+
+    ValueType rho;
+    cusp::csr_matrix<int, ValueType, MemorySpace> scaled_matrix;        // D^-1 A
+    cusp::array1d<ValueType, MemorySpace> diagonal_reciprocals;
+    cusp::array1d<ValueType, cusp::host_memory> coefficients;          // p_0, ..., p_degree
+
+    mutable cusp::array1d<ValueType, MemorySpace> z;
+    mutable cusp::array2d<ValueType, MemorySpace, cusp::column_major> powers;
+
+public:
+    enum polynomial_type { neumann, chebyshev };
+
+    /*! construct a \p polynomial preconditioner
+     *
+     * \param A square matrix to precondition
+     * \param degree degree of the polynomial \c p
+     * \param type \c neumann or \c chebyshev
+     * \param lower lower end of the Chebyshev interval relative to \c rho
+     * \param upper upper end of the interval relative to \c rho
+     * \param power_iterations number of power iterations (at least 2)
+     *        that estimate \c rho
+     * \tparam MatrixType matrix
+     *
+     * \throws cusp::invalid_input_exception if the interval is empty or
+     *         \p power_iterations is less than 2
+     */
+    template<typename MatrixType>
+    polynomial(const MatrixType& A,
+               const size_t degree = 3,
+               const polynomial_type type = chebyshev,
+               const ValueType lower = 1.0/30.0,
+               const ValueType upper = 1.1,
+               const size_t power_iterations = 10);
+
+    /*! estimated spectral radius of <tt>D^-1 A</tt>
+     */
+    ValueType spectral_radius(void) const { return rho; }
+
+    /*! coefficients of \c p, lowest degree first
+     */
+    const cusp::array1d<ValueType, cusp::host_memory>& polynomial_coefficients(void) const { return coefficients; }
+
+    /*! apply the preconditioner to vector \p x and store the result in \p y
+     *
+     * \param x input vector
+     * \param y ouput vector
+     * \tparam VectorType1 vector
+     * \tparam VectorType2 vector
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+};
+/*! \}
+ */
+
+} // end namespace precond
+} // end namespace cusp
+
+#include <cusp/precond/detail/polynomial.inl>
@@ -0,0 +1,220 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file ruge_stuben.h
+ *  \brief Classical (Ruge-Stuben) algebraic multigrid preconditioner
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <vector>
+#include <cusp/linear_operator.h>
+
+#include <cusp/csr_matrix.h>
+#include <cusp/precond/smoothed_aggregation.h>
+#include <cusp/relaxation/gauss_seidel.h>
+#include <cusp/relaxation/jacobi.h>
+
+#include <cusp/detail/lu.h>
+#include <cusp/detail/spectral_radius.h>
+
+namespace cusp
+{
+namespace precond
+{
+
+/*! \addtogroup preconditioners Preconditioners
+ *  \ingroup preconditioners
+ *  \{
+ */
+
+/*! \p ruge_stuben_options : parameters of the \p ruge_stuben setup and
+ *  cycle.
+ *
+ *  \code
+ *  cusp::precond::ruge_stuben_options options;
+ *  options.coarsening    = cusp::precond::ruge_stuben_options::hmis;
+ *  options.interpolation = cusp::precond::ruge_stuben_options::direct;
+ *
+ *  cusp::precond::ruge_stuben<int, float, cusp::device_memory> M(A, options);
+ *  \endcode
+ */
+struct ruge_stuben_options
+{
+    enum coarsening_type { pmis, hmis };
+
+    enum interpolation_type { direct, extended_i };
+
+    enum smoother_type { jacobi, gauss_seidel };
+
+    /*! classical strength of connection threshold, A[i,j] is a strong
+     *  connection if -A[i,j] >= theta * max_{k != i} -A[i,k]
+     */
+    double theta;
+
+    /*! C/F splitting of the strength of connection graph.  \c pmis
+     *  selects C-points by parallel rounds of independent sets of S + S^T
+     *  weighted by the number of points each point influences (De Sterck,
+     *  Yang and Heys), on the host and on the device.  \c hmis starts
+     *  from the first pass of the classical coarsening, which runs on the
+     *  host with the whole matrix as its single subdomain, and completes
+     *  the splitting with the rounds of \c pmis.
+     */
+    coarsening_type coarsening;
+
+    /*! Interpolation from the C-points.  \c direct interpolates each
+     *  F-point from its strong C-neighbors.  \c extended_i also
+     *  interpolates from the strong C-neighbors of its strong F-neighbors,
+     *  which \c pmis coarsening needs for good convergence; it is formed
+     *  with one sparse matrix product per level (the MM-ext+i form of Li,
+     *  Sjogreen and Yang).
+     */
+    interpolation_type interpolation;
+
+    /*! maximum number of levels in the hierarchy, including the coarsest
+     */
+    size_t max_levels;
+
+    /*! levels with at most this many rows are solved directly
+     */
+    size_t coarse_size;
+
+    /*! relaxation method applied on every level but the coarsest.
+     *  \c gauss_seidel applies a symmetric multicolor Gauss-Seidel sweep,
+     *  which requires the sparsity pattern of A to be symmetric.
+     */
+    smoother_type smoother;
+
+    /*! number of presmoothing sweeps
+     */
+    size_t presmooth_sweeps;
+
+    /*! number of postsmoothing sweeps
+     */
+    size_t postsmooth_sweeps;
+
+    /*! Jacobi smoother weight, scaled by 1 / rho(D^-1 A)
+     */
+    double smoother_weight;
+
+    ruge_stuben_options(void)
+        : theta(0.25), coarsening(pmis), interpolation(extended_i),
+          max_levels(20), coarse_size(100), smoother(jacobi),
+          presmooth_sweeps(1), postsmooth_sweeps(1), smoother_weight(4.0/3.0) {}
+};
+
+/*! \p ruge_stuben : classical algebraic multigrid preconditioner
+ *
+ *  Each level splits the points into C-points, which form the next
+ *  level, and F-points, which are interpolated from them.  The
+ *  prolongator P follows from the strong connections of A, the
+ *  restriction is R = P^T and the coarse matrix the Galerkin product
+ *  R A P.  Classical coarsening follows the strong couplings of
+ *  anisotropic and heterogeneous-coefficient problems, where smoothed
+ *  aggregation converges poorly.  The setup runs in \c MemorySpace except
+ *  for the first pass of \c hmis coarsening and the factorization of the
+ *  coarsest matrix.  The cycle is a V-cycle.
+ *
+ *  The matrix must store its diagonal.
+ *
+ *  \code
+ *  #include <cusp/precond/ruge_stuben.h>
+ *  #include <cusp/krylov/cg.h>
+ *  ...
+ *
+ *  cusp::precond::ruge_stuben<int, float, cusp::device_memory> M(A);
+ *
+ *  cusp::krylov::cg(A, x, b, monitor, M);
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType, typename MemorySpace>
+class ruge_stuben : public cusp::linear_operator<ValueType, MemorySpace, IndexType>
+{
+
+    typedef cusp::csr_matrix<IndexType,ValueType,MemorySpace> SetupMatrixType;
+    typedef typename amg_container<IndexType,ValueType,MemorySpace>::solve_type SolveMatrixType;
+
+    struct level
+    {
+        SetupMatrixType A_; // matrix
+        SolveMatrixType A;  // matrix
+        SolveMatrixType P;  // prolongation operator
+        SolveMatrixType R;  // restriction operator, P^T
+        cusp::array1d<IndexType,MemorySpace> splitting;       // 1 for the C-points, 0 for the F-points
+        cusp::array1d<ValueType,MemorySpace> x;               // per-level solution
+        cusp::array1d<ValueType,MemorySpace> b;               // per-level rhs
+        cusp::array1d<ValueType,MemorySpace> residual;        // per-level residual
+
+        // only the smoother selected by options.smoother is set up
+        cusp::relaxation::jacobi<ValueType,MemorySpace>     jacobi_smoother;
+        cusp::relaxation::gauss_seidel<ValueType,MemorySpace,IndexType> gauss_seidel_smoother;
+
+        cusp::detail::rho_Dinv_A_state<ValueType,MemorySpace> rho_state;
+    };
+
+    std::vector<level> levels;
+
+    cusp::detail::lu_solver<ValueType, MemorySpace> LU;
+
+    // workspace of solve(), reused across calls
+    cusp::array1d<ValueType,MemorySpace> update;
+    cusp::array1d<ValueType,MemorySpace> residual;
+
+    ruge_stuben_options options;
+
+    public:
+
+    template <typename MatrixType>
+    ruge_stuben(const MatrixType& A, const ruge_stuben_options& options = ruge_stuben_options());
+
+    /*! Apply one V-cycle to \p x, starting from a zero initial guess.
+     */
+    template <typename Array1, typename Array2>
+    void operator()(const Array1& x, Array2& y);
+
+    template <typename Array1, typename Array2>
+    void solve(const Array1& b, Array2& x);
+
+    template <typename Array1, typename Array2, typename Monitor>
+    void solve(const Array1& b, Array2& x, Monitor& monitor);
+
+    void print( void );
+
+    double operator_complexity( void );
+
+    double grid_complexity( void );
+
+    protected:
+
+    template <typename MatrixType>
+    void setup(const MatrixType& A);
+
+    bool extend_hierarchy(void);
+
+    void setup_smoother(const size_t i);
+
+    template <typename Array1, typename Array2>
+    void _solve(const Array1& b, Array2& x, const size_t i);
+};
+/*! \}
+ */
+
+} // end namespace precond
+} // end namespace cusp
+
+#include <cusp/precond/detail/ruge_stuben.inl>
@@ -23,16 +23,28 @@
 
 #include <cusp/detail/config.h>
 
+#include <istream>
+#include <ostream>
 #include <vector> // TODO replace with host_vector
+#include <thrust/detail/type_traits.h>
 #include <cusp/linear_operator.h>
 
+#include <cusp/bsr_matrix.h>
 #include <cusp/coo_matrix.h>
 #include <cusp/csr_matrix.h>
 #include <cusp/hyb_matrix.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/krylov/fgmres.h>
+#include <cusp/relaxation/chebyshev.h>
+#include <cusp/relaxation/gauss_seidel.h>
 #include <cusp/relaxation/jacobi.h>
 #include <cusp/relaxation/polynomial.h>
+#include <cusp/spgemm.h>
 
+#include <cusp/detail/diagonal_cache.h>
 #include <cusp/detail/lu.h>
+#include <cusp/detail/device/graph.h>
+#include <cusp/detail/spectral_radius.h>
 
 namespace cusp
 {
@@ -62,7 +74,198 @@ struct amg_container<IndexType,ValueType,cusp::device_memory>
 {
     // use COO on device
     typedef typename cusp::coo_matrix<IndexType,ValueType,cusp::device_memory> setup_type;
+#if defined(CUSP_AMG_USE_BSR_SOLVE)
+    // apply the cycle with BSR matrices, the finest level uses blocks of
+    // amg_options::block_size and the coarse levels 1x1 blocks
+    typedef typename cusp::bsr_matrix<IndexType,ValueType,cusp::device_memory> solve_type;
+#else
     typedef typename cusp::hyb_matrix<IndexType,ValueType,cusp::device_memory> solve_type;
+#endif
+};
+
+/*! \p amg_options : parameters of the \p smoothed_aggregation setup
+ *  and cycle.
+ *
+ *  The defaults reproduce the behavior of the \p smoothed_aggregation
+ *  constructor that only takes a strength threshold.
+ *
+ *  \code
+ *  cusp::precond::amg_options options;
+ *  options.coarse_size       = 500;
+ *  options.smoother          = cusp::precond::amg_options::polynomial;
+ *  options.store_restriction = false;
+ *  options.collect_timings   = true;
+ *
+ *  cusp::precond::smoothed_aggregation<int, float, cusp::device_memory> M(A, options);
+ *  \endcode
+ */
+struct amg_options
+{
+    enum smoother_type { jacobi, polynomial, gauss_seidel, chebyshev };
+
+    enum cycle_type { V_cycle, W_cycle, F_cycle, K_cycle };
+
+    enum aggregation_type { standard, pairwise, mis };
+
+    enum solver_type { stationary, cg, gmres };
+
+    /*! strength of connection threshold
+     */
+    double theta;
+
+    /*! Aggregation of the strength of connection graph.  \c standard
+     *  aggregates serially on the host and by MIS(2) on the device.
+     *  \c pairwise applies \c pairwise_passes passes of parallel pairwise
+     *  matching (as in AGMG), which bounds the aggregates to
+     *  2^pairwise_passes nodes.  \c mis aggregates around the nodes of a
+     *  distance-2 maximal independent set with at most
+     *  \c max_aggregate_size nodes per aggregate (0 for no bound).  Both
+     *  parallel methods run on the host and on the device.
+     */
+    aggregation_type aggregation;
+
+    /*! number of matching passes of \c pairwise aggregation
+     */
+    size_t pairwise_passes;
+
+    /*! bound on the aggregate size of \c mis aggregation, 0 for none
+     */
+    size_t max_aggregate_size;
+
+    /*! maximum number of levels in the hierarchy, including the coarsest
+     */
+    size_t max_levels;
+
+    /*! levels with at most this many rows are solved directly
+     */
+    size_t coarse_size;
+
+    /*! relaxation method applied on every level but the coarsest.
+     *  \c gauss_seidel applies a symmetric multicolor Gauss-Seidel sweep,
+     *  which requires the sparsity pattern of A to be symmetric.
+     *  \c chebyshev applies a degree 3 Chebyshev polynomial of D^-1 A
+     *  with the three-term recurrence.
+     */
+    smoother_type smoother;
+
+    /*! Multigrid cycle applied by \p solve and \p operator().
+     *  \c W_cycle visits each coarse level twice, \c F_cycle follows an
+     *  F-cycle on the coarse level by a V-cycle.  \c K_cycle accelerates
+     *  the coarse corrections of every level above the coarsest by up to
+     *  two steps of flexible CG (Notay and Vassilevski); it makes the
+     *  preconditioner vary slightly from one application to the next.
+     */
+    cycle_type cycle;
+
+    /*! Iteration applied by \p solve.  \c stationary adds one cycle of
+     *  the residual to x per step.  \c cg and \c gmres accelerate the
+     *  cycles by preconditioned CG and by restarted flexible GMRES with
+     *  \c gmres_restart vectors.  Both take the fine residual from their
+     *  recurrence rather than from a product with A, and keep their
+     *  vectors in the hierarchy from one call to the next.  \c cg
+     *  requires A to be symmetric positive definite and the cycle to be
+     *  symmetric (as many pre- as postsmoothing sweeps, not the
+     *  \c K_cycle), \c gmres holds for nonsymmetric A and any cycle at
+     *  the cost of 2 gmres_restart + 1 fine vectors.
+     */
+    solver_type solver;
+
+    /*! restart length of the \c gmres solver
+     */
+    size_t gmres_restart;
+
+    /*! number of presmoothing sweeps
+     */
+    size_t presmooth_sweeps;
+
+    /*! number of postsmoothing sweeps
+     */
+    size_t postsmooth_sweeps;
+
+    /*! Jacobi smoother weight, scaled by 1 / rho(D^-1 A)
+     */
+    double smoother_weight;
+
+    /*! prolongator smoothing weight, scaled by 1 / rho(D^-1 A)
+     */
+    double prolongator_weight;
+
+    /*! When \c true the restriction R = P^T is formed and stored on every
+     *  level.  Otherwise restriction is applied from the aggregates as
+     *  R r = T^T (r - w A D^-1 r), which saves the transpose at setup and
+     *  the storage of R at the cost of one additional product with A per
+     *  restriction.  The implicit form requires A to be symmetric.
+     */
+    bool store_restriction;
+
+    /*! When \c store_restriction is \c false, apply the restriction as
+     *  P^T r with \p multiply_transpose instead of from the aggregates.
+     *  This also holds for nonsymmetric A and costs one product with P
+     *  per restriction.  With CSR matrices the residual is restricted as
+     *  it is computed, without storing it on the fine level.
+     */
+    bool transpose_prolongator;
+
+    /*! When \c true the prolongator is the tentative prolongator T of
+     *  the aggregates, without smoothing, which has one entry per
+     *  aggregated row.  Neither P nor R is stored: restriction is a
+     *  segmented sum over the aggregates and prolongation a gather from
+     *  the aggregate of each row, both driven by the aggregates and the
+     *  candidates of the level.  This saves the transfer operators and
+     *  the products with them, and also holds for nonsymmetric A.  The
+     *  weaker interpolation suits aggressive coarsening with the
+     *  \c K_cycle.  \c store_restriction and \c transpose_prolongator
+     *  are ignored.
+     */
+    bool unsmoothed_aggregation;
+
+    /*! record the setup time of every level, see
+     *  \p smoothed_aggregation::setup_timings
+     */
+    bool collect_timings;
+
+    /*! Number of unknowns per node of the finest matrix (e.g. 3 for
+     *  elasticity in 3D).  Only used when the solve matrices are stored
+     *  in BSR format (\p CUSP_AMG_USE_BSR_SOLVE), in which case it must
+     *  divide the dimensions of the matrix.
+     */
+    size_t block_size;
+
+    /*! Capture the device work of a cycle into a CUDA graph and replay it
+     *  on later applications of \p operator(), which replaces the kernel
+     *  launches of every level by a single launch.  The first application
+     *  after a setup runs directly, the second is captured.  Cycles that
+     *  synchronize with the host are applied directly: those of host
+     *  hierarchies, of the \c K_cycle and of implicit restriction
+     *  (\c store_restriction is \c false or \c unsmoothed_aggregation
+     *  is \c true), as well as cycles applied
+     *  while the calling thread captures a graph of its own, which they
+     *  become part of.
+     */
+    bool capture_cycle;
+
+    /*! Average number of rows per partition below which a coarse level
+     *  of a \p distributed_smoothed_aggregation hierarchy is moved onto
+     *  fewer partitions, so that the small levels are not dominated by
+     *  communication.  The coarsest level always resides on a single
+     *  partition.  Ignored by \p smoothed_aggregation.
+     */
+    size_t consolidation_size;
+
+    amg_options(void)
+        : theta(0), aggregation(standard), pairwise_passes(2), max_aggregate_size(0),
+          max_levels(20), coarse_size(100),
+#ifndef USE_POLY_SMOOTHER
+          smoother(jacobi),
+#else
+          smoother(polynomial),
+#endif
+          cycle(V_cycle), solver(stationary), gmres_restart(20),
+          presmooth_sweeps(1), postsmooth_sweeps(1),
+          smoother_weight(4.0/3.0), prolongator_weight(4.0/3.0),
+          store_restriction(true), transpose_prolongator(false), unsmoothed_aggregation(false),
+          collect_timings(false), block_size(1),
+          capture_cycle(false), consolidation_size(10000) {}
 };
 
 /*! \p smoothed_aggregation : algebraic multigrid preconditoner based on
@@ -77,40 +280,153 @@ class smoothed_aggregation : public cusp::linear_operator<ValueType, MemorySpace
     typedef typename amg_container<IndexType,ValueType,MemorySpace>::setup_type SetupMatrixType;
     typedef typename amg_container<IndexType,ValueType,MemorySpace>::solve_type SolveMatrixType;
 
+    // sparsity patterns reused by resetup()
+    struct resetup_state
+    {
+        cusp::csr_matrix<IndexType,ValueType,MemorySpace> T;   // tentative prolongator
+        cusp::spgemm_plan<IndexType,MemorySpace> AT_plan;      // pattern of A*T, which is that of P
+        cusp::csr_matrix<IndexType,ValueType,MemorySpace> P;   // prolongator
+        cusp::csr_matrix<IndexType,ValueType,MemorySpace> R;   // transpose of P
+        cusp::array1d<IndexType,MemorySpace> R_permutation;    // R.values = P.values[R_permutation]
+        cusp::spgemm_plan<IndexType,MemorySpace> AP_plan;      // pattern of A*P
+        cusp::csr_matrix<IndexType,ValueType,MemorySpace> AP;  // A*P
+        cusp::spgemm_plan<IndexType,MemorySpace> RAP_plan;     // pattern of R*A*P
+    };
+
     struct level
     {
         SetupMatrixType A_; // matrix
-        SolveMatrixType R;  // restriction operator
+        SolveMatrixType R;  // restriction operator (empty unless options.store_restriction)
         SolveMatrixType A;  // matrix
-        SolveMatrixType P;  // prolongation operator
+        SolveMatrixType P;  // prolongation operator (empty if options.unsmoothed_aggregation)
         cusp::array1d<IndexType,MemorySpace> aggregates;      // aggregates
         cusp::array1d<ValueType,MemorySpace> B;               // near-nullspace candidates
         cusp::array1d<ValueType,MemorySpace> x;               // per-level solution
         cusp::array1d<ValueType,MemorySpace> b;               // per-level rhs
         cusp::array1d<ValueType,MemorySpace> residual;        // per-level residual
-        
-	#ifndef USE_POLY_SMOOTHER
-        cusp::relaxation::jacobi<ValueType,MemorySpace> smoother;
-	#else
-        cusp::relaxation::polynomial<ValueType,MemorySpace> smoother;
-	#endif
+
+        // implicit restriction (options.store_restriction == false and
+        // options.transpose_prolongator == false), the permutation is also
+        // set up if options.unsmoothed_aggregation
+        cusp::array1d<IndexType,MemorySpace> permutation;     // aggregated rows ordered by aggregate
+        cusp::array1d<ValueType,MemorySpace> Dinv;            // w / diag(A)
+        cusp::array1d<ValueType,MemorySpace> temp1;           // restriction workspace
+        cusp::array1d<ValueType,MemorySpace> temp2;           // restriction workspace
+
+        // K-cycle workspace (options.cycle == K_cycle)
+        cusp::array1d<ValueType,MemorySpace> k_residual;      // residual after the first step
+        cusp::array1d<ValueType,MemorySpace> k_update;        // second cycle
+        cusp::array1d<ValueType,MemorySpace> k_product;       // A times the last cycle
+
+        // only the smoother selected by options.smoother is set up
+        cusp::relaxation::jacobi<ValueType,MemorySpace>     jacobi_smoother;
+        cusp::relaxation::polynomial<ValueType,MemorySpace> polynomial_smoother;
+        cusp::relaxation::gauss_seidel<ValueType,MemorySpace,IndexType> gauss_seidel_smoother;
+        cusp::relaxation::chebyshev<ValueType,MemorySpace>    chebyshev_smoother;
+
+        // main diagonal of A_, extracted once per setup and shared by the
+        // strength of connection, the estimate of rho(D^-1 A), the
+        // prolongator smoothing and the smoother
+        cusp::detail::diagonal_cache<ValueType,MemorySpace> diagonal;
+
+        // estimate of rho(D^-1 A), warm-starts the estimate of resetup()
+        cusp::detail::rho_Dinv_A_state<ValueType,MemorySpace> rho_state;
+
+        resetup_state state;
     };
 
     std::vector<level> levels;
         
-    cusp::detail::lu_solver<ValueType, cusp::host_memory> LU;
+    cusp::detail::lu_solver<ValueType, MemorySpace> LU;
 
-    ValueType theta;
+    // workspace of solve(), reused across calls
+    cusp::array1d<ValueType,MemorySpace> update;
+    cusp::array1d<ValueType,MemorySpace> residual;
+    cusp::krylov::cg_solver<ValueType,MemorySpace> cg_workspace;
+    cusp::krylov::fgmres_solver<ValueType,MemorySpace> gmres_workspace;
+
+    // workspace of operator() for vectors of another precision
+    cusp::array1d<ValueType,MemorySpace> mixed_b;
+    cusp::array1d<ValueType,MemorySpace> mixed_x;
+
+    // cycle replayed by operator() (options.capture_cycle), which reads
+    // graph_b and writes graph_x
+    cusp::detail::device::captured_graph cycle_graph;
+    cusp::array1d<ValueType,MemorySpace> graph_b;
+    cusp::array1d<ValueType,MemorySpace> graph_x;
+    bool cycle_applied;   // since the last setup
+
+    amg_options options;
+
+    std::vector<double> timings;
+    std::vector<size_t> peaks;   // device memory high-water mark of each entry of timings
+
+    bool has_resetup_state;
 
     public:
 
+    /*! Construct an empty hierarchy, to be filled by \p load.
+     */
+    smoothed_aggregation(void);
+
     template <typename MatrixType>
     smoothed_aggregation(const MatrixType& A, const ValueType theta=0);
 
+    template <typename MatrixType>
+    smoothed_aggregation(const MatrixType& A, const amg_options& options);
+
+    /*! Recompute the hierarchy for a matrix with the sparsity pattern of
+     *  the matrix it was built for, reusing the aggregates and the near
+     *  nullspace candidates.  Only the values of the prolongator, the
+     *  Galerkin products, the spectral radius estimates, the smoothers and
+     *  the coarse factorization are recomputed.
+     *
+     *  The first call also computes the sparsity patterns of the products,
+     *  which later calls reuse, and keeps CSR copies of the transfer
+     *  operators for that purpose.
+     *
+     *  \throws cusp::invalid_input_exception if the dimensions or number
+     *  of entries of \p A differ from those of the original matrix.
+     */
+    template <typename MatrixType>
+    void resetup(const MatrixType& A);
+
+    /*! Write the hierarchy to a binary stream, so that a later run may
+     *  \p load it instead of repeating the setup.  The options, the
+     *  matrices, transfer operators, aggregates and candidates of every
+     *  level, the spectral radius estimates the smoothers were set up
+     *  with and the LU factors of the coarsest matrix are written in the
+     *  format of \p cusp::io::write_binary_stream.  The patterns kept
+     *  for \p resetup are not written.
+     *
+     *  \throws cusp::io_exception if the stream is not seekable or a
+     *  write fails.
+     */
+    void save(std::ostream& output) const;
+
+    /*! Replace the hierarchy by one written with \p save.  The smoothers
+     *  are set up from the stored spectral radius estimates and the
+     *  coarse solver from the stored factors, so neither is estimated or
+     *  factored again.  The stream must have been written by a hierarchy
+     *  of the same \c IndexType and \c ValueType.
+     *
+     *  \throws cusp::io_exception if the stream does not hold a
+     *  compatible hierarchy.
+     */
+    void load(std::istream& input);
+
     
+    /*! Apply one cycle to \p x.  The vectors may hold a value type other
+     *  than \c ValueType, for instance double vectors of a Krylov solve
+     *  preconditioned by a float hierarchy.  The hierarchy then reads \p x
+     *  directly and converts its result into \p y once per application.
+     */
     template <typename Array1, typename Array2>
     void operator()(const Array1& x, Array2& y);
 
+    /*! Solve A x = b with the hierarchy from the initial guess \p x, by
+     *  the iteration of \c amg_options::solver.
+     */
     template <typename Array1, typename Array2>
     void solve(const Array1& b, Array2& x);
 
@@ -123,12 +439,78 @@ class smoothed_aggregation : public cusp::linear_operator<ValueType, MemorySpace
 
     double grid_complexity( void );
 
+    /*! Setup time of every level in milliseconds, empty unless
+     *  \p amg_options::collect_timings is set.  Entry \c i covers the
+     *  construction of level \c i+1 from level \c i, the last entry the
+     *  factorization of the coarsest level.
+     */
+    const std::vector<double>& setup_timings( void ) const;
+
+    /*! Peak device memory in bytes held by Cusp's allocators during the
+     *  setup of every level, recorded with \p setup_timings and empty
+     *  unless \p amg_options::collect_timings is set.  The peaks include
+     *  the levels that were already built and the temporaries of the
+     *  Galerkin products, so they bound the memory the setup needs.
+     */
+    const std::vector<size_t>& setup_peak_bytes( void ) const;
+
+    /*! Bytes of the matrices, transfer operators and vectors of level
+     *  \p i, see \p cusp::memory_footprint.  Smoothers are not included.
+     */
+    size_t level_bytes( const size_t i ) const;
+
+    /*! Bytes of all levels, the sum of \p level_bytes.
+     */
+    size_t memory_footprint( void ) const;
+
     protected:
 
+    template <typename MatrixType>
+    void setup(const MatrixType& A);
+
+    void setup_solve(const bool factor_coarse = true);
+
+    void setup_smoother(const size_t i, const ValueType rho_DinvA);
+
     void extend_hierarchy(void);
 
+    template <typename Array1, typename Array2>
+    void presmooth(const size_t i, const Array1& b, Array2& x, const bool initial_guess);
+
+    template <typename Array1, typename Array2>
+    void postsmooth(const size_t i, const Array1& b, Array2& x);
+
+    template <typename Array1, typename Array2>
+    void restrict_residual(const size_t i, const Array1& r, Array2& b);
+
+    template <typename Array1, typename Array2>
+    void prolong_correction(const size_t i, const Array1& x_coarse, Array2& x);
+
     template <typename Array1, typename Array2>
     void _solve(const Array1& b, Array2& x, const size_t i);
+
+    template <typename Array1, typename Array2>
+    void _solve(const Array1& b, Array2& x, const size_t i,
+                const typename amg_options::cycle_type cycle, const bool initial_guess);
+
+    template <typename Array1, typename Array2>
+    void level_cycle(const Array1& b, Array2& x, const size_t i,
+                     const typename amg_options::cycle_type cycle, const bool initial_guess);
+
+    bool cycle_capturable(void) const;
+
+    template <typename Array1, typename Array2>
+    void captured_apply(const Array1& b, Array2& x);
+
+    template <typename Array1, typename Array2>
+    void apply(const Array1& b, Array2& x, thrust::detail::true_type);
+
+    template <typename Array1, typename Array2>
+    void apply(const Array1& b, Array2& x, thrust::detail::false_type);
+
+    void coarse_correction(const size_t i, const typename amg_options::cycle_type cycle);
+
+    void krylov_correction(const size_t i);
 };
 /*! \}
  */
@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file spai.h
+ *  \brief Sparse approximate inverse preconditioner
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/linear_operator.h>
+
+namespace cusp
+{
+namespace precond
+{
+
+/*! \addtogroup preconditioners Preconditioners
+ *  \ingroup preconditioners
+ *  \{
+ */
+
+/*! \p spai : sparse approximate inverse preconditioner
+ *
+ *  Computes a sparse matrix \c M that minimizes the Frobenius norm
+ *  <tt>|| M A - I ||</tt> over a fixed pattern, the pattern of
+ *  <tt>A^pattern_power</tt>, and implements <tt>y = M x</tt> with a single
+ *  sparse matrix-vector product.  The norm separates into one least
+ *  squares problem per row of \c M,
+ *
+ *    <tt>min || A(J,:)^T m - e_i ||</tt>
+ *
+ *  where \c J is the pattern of row \c i.  Whereas \p scaled_bridson_ainv
+ *  computes its factors in sequence, these problems are independent. At
+ *  setup each one is solved by one thread through its normal equations
+ *  <tt>A(J,:) A(J,:)^T m = A(J,i)</tt>, whose entries are the products of
+ *  pairs of rows of \c A, with a Cholesky factorization.  The setup is
+ *  thus parallel over the rows and needs <tt>|J|^2</tt> values of workspace
+ *  per row, which keeps the pattern power small for matrices whose rows
+ *  have many entries.
+ *
+ *  The columns of each row of \c A must be sorted.  The preconditioner
+ *  is not symmetric in general, so it is meant for GMRES, BiCGstab and
+ *  similar methods.
+ *
+ *  \tparam ValueType Type used for matrix values (e.g. \c float or \c double).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *  \tparam IndexType Type used for indices (e.g. \c int).
+ *
+ *  \code
+ *  #include <cusp/precond/spai.h>
+ *  #include <cusp/krylov/gmres.h>
+ *  ...
+ *
+ *  // approximate inverse on the pattern of A^2
+ *  cusp::precond::spai<float, cusp::device_memory> M(A, 2);
+ *
+ *  // solve
+ *  cusp::krylov::gmres(A, x, b, 30, monitor, M);
+ *  \endcode
+ *
+ *  \throws cusp::runtime_exception at setup if the rows of \c A in the
+ *  pattern of a row of \c M are linearly dependent.
+ */
+template <typename ValueType, typename MemorySpace, typename IndexType = int>
+class spai : public linear_operator<ValueType, MemorySpace, IndexType>
+{
+    typedef linear_operator<ValueType, MemorySpace, IndexType> Parent;
+
+    cusp::csr_matrix<IndexType, ValueType, MemorySpace> M;
+
+public:
+    /*! construct a \p spai preconditioner
+     *
+     * \param A matrix to precondition
+     * \param pattern_power power of \p A whose pattern \c M takes
+     * \tparam MatrixType matrix
+     */
+    template <typename MatrixType>
+    spai(const MatrixType& A, size_t pattern_power = 1);
+
+    /*! the approximate inverse
+     */
+    const cusp::csr_matrix<IndexType, ValueType, MemorySpace>& matrix(void) const { return M; }
+
+    /*! apply the preconditioner to vector \p x and store the result in \p y
+     *
+     * \param x input vector
+     * \param y ouput vector
+     * \tparam VectorType1 vector
+     * \tparam VectorType2 vector
+     */
+    template <typename VectorType1, typename VectorType2>
+    void operator()(const VectorType1& x, VectorType2& y) const;
+};
+/*! \}
+ */
+
+} // end namespace precond
+} // end namespace cusp
+
+#include <cusp/precond/detail/spai.inl>
@@ -37,6 +37,42 @@ namespace detail
 template <typename Matrix1, typename Matrix2>
 void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, const double theta = 0.0);
 
+/*  As above, and also return the row offsets of the pattern of S, so that
+ *  the aggregation of a COO strength matrix need not recompute them.
+ *
+ *  The CSR and COO formats are classified and compacted by one fused
+ *  count / scan / compact sequence over the rows of A in its own memory
+ *  space, which produces the offsets as a by-product.  Other formats are
+ *  converted to CSR first.
+ */
+template <typename Matrix1, typename Matrix2, typename Array>
+void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, Array& S_row_offsets, const double theta);
+
+/*  As the first, with the main diagonal of A given (e.g. by a
+ *  diagonal_cache shared with other setup steps) instead of found in
+ *  the rows of A.  The diagonal must be in the memory space of A.
+ */
+template <typename Matrix1, typename Matrix2, typename Array>
+void symmetric_strength_of_connection(const Matrix1& A, Matrix2& S, const double theta, const Array& diagonal);
+
+/*  Compute the classical (Ruge-Stuben) strength of connection matrix.
+ *  An off-diagonal connection A[i,j] is strong iff::
+ *
+ *     -A[i,j] >= theta * max_{k != i} -A[i,k]
+ *
+ *  Rows without negative off-diagonal entries have no strong connections
+ *  and the diagonal is never stored in S.  Unlike the symmetric measure
+ *  the test only involves row i, so S is not symmetric in general.
+ */
+template <typename Matrix1, typename Matrix2>
+void classical_strength_of_connection(const Matrix1& A, Matrix2& S, const double theta);
+
+/*  As above for a CSR matrix, flagging the strong entries of A in the
+ *  order of its values rather than compacting them.
+ */
+template <typename Matrix, typename Array>
+void classical_strong_connections(const Matrix& A, Array& strong, const double theta);
+
 } // end namepace detail
 } // end namespace precond
 } // end namespace cusp
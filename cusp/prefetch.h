@@ -0,0 +1,89 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file prefetch.h
+ *  \brief Migration hints for containers in managed memory
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/memory.h>
+#include <cusp/detail/stream.h>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p prefetch : migrate the storage of an array or matrix in managed
+ * memory to the current device.
+ *
+ * The migration is issued with \p cudaMemPrefetchAsync on the current
+ * stream (see \p scoped_stream), so that the kernels that follow on the
+ * stream find their operands resident instead of faulting on each page.
+ * \p cusp::multiply and the Krylov solvers prefetch their managed
+ * operands on entry, so explicit calls are only needed to move data
+ * ahead of time, e.g. while the host prepares the next operand.
+ *
+ * \note The call is a no-op unless \p A is a container in
+ * \p cusp::managed_memory (\p array1d, \p array2d, or a COO, CSR, DIA,
+ * ELL or HYB matrix), and on devices that do not support concurrent
+ * access to managed memory.  Views do not record how their storage was
+ * allocated and are never prefetched.
+ *
+ * \see \p managed_allocator
+ */
+template <typename MatrixOrVector>
+void prefetch(const MatrixOrVector& A);
+
+/*! \p prefetch : migrate the storage of an array or matrix in managed
+ * memory to \p device, or to the host when \p device is
+ * \p cudaCpuDeviceId, on the current stream.
+ */
+template <typename MatrixOrVector>
+void prefetch(const MatrixOrVector& A, int device);
+
+/*! \p prefetch : migrate the storage of an array or matrix in managed
+ * memory to \p device on \p stream.
+ */
+template <typename MatrixOrVector>
+void prefetch(const MatrixOrVector& A, int device, cudaStream_t stream);
+
+/*! \p advise_read_mostly : advise the driver that the storage of an array
+ * or matrix in managed memory is mostly read.
+ *
+ * Pages of read-mostly memory are duplicated rather than migrated, so
+ * that a matrix and the operand of its product may be read concurrently
+ * by the host and several devices.  A write to a page invalidates all
+ * other copies of it, hence the advice suits matrices that are assembled
+ * once, not vectors that are updated by every iteration.
+ *
+ * \note As with \p prefetch, the call is a no-op unless \p A is a
+ * container in \p cusp::managed_memory.
+ */
+template <typename MatrixOrVector>
+void advise_read_mostly(const MatrixOrVector& A);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/prefetch.inl>
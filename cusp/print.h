@@ -94,6 +94,70 @@ void print(const Printable& p);
 template <typename Printable, typename Stream>
 void print(const Printable& p, Stream& s);
 
+/*! \p print_window : print the entries of a sparse matrix in a window
+ *  of rows and columns
+ *
+ *  Only the entries with a row in <tt>[row_begin, row_end)</tt> and a
+ *  column in <tt>[column_begin, column_end)</tt> are selected, in the
+ *  memory space of the matrix, and copied to the host, so that a part of
+ *  a large device matrix is inspected at the cost of a few reductions.
+ *  CSR matrices are windowed in place, other formats are converted to COO
+ *  in their memory space first.
+ *
+ * \param A matrix
+ * \param row_begin first row of the window
+ * \param row_end end of the rows of the window
+ * \param column_begin first column of the window
+ * \param column_end end of the columns of the window
+ * \param s stream on which to write the output
+ *
+ * \tparam Matrix matrix type
+ * \tparam Stream output stream type
+ *
+ *  \code
+ *  // the 10x10 block at the top left corner of A
+ *  cusp::print_window(A, 0, 10, 0, 10, std::cout);
+ *  \endcode
+ */
+template <typename Matrix, typename Stream>
+void print_window(const Matrix& A,
+                  size_t row_begin, size_t row_end,
+                  size_t column_begin, size_t column_end,
+                  Stream& s);
+
+/*! \p print_window : print a window of a sparse matrix on std::cout
+ */
+template <typename Matrix>
+void print_window(const Matrix& A,
+                  size_t row_begin, size_t row_end,
+                  size_t column_begin, size_t column_end);
+
+/*! \p print_summary : print statistics of a sparse matrix
+ *
+ *  The statistics are computed by reductions in the memory space of the
+ *  matrix and only the results are copied to the host:
+ *   - the minimum, mean and maximum row length,
+ *   - a histogram of the row lengths in powers of two,
+ *   - the range of the absolute values of the entries,
+ *   - the number of rows that are diagonally dominant, i.e. where
+ *     <tt>|A(i,i)| >= sum_{j != i} |A(i,j)|</tt>.
+ *
+ *  Formats other than CSR are converted to CSR in their memory space.
+ *
+ * \param A matrix
+ * \param s stream on which to write the output
+ *
+ * \tparam Matrix matrix type
+ * \tparam Stream output stream type
+ */
+template <typename Matrix, typename Stream>
+void print_summary(const Matrix& A, Stream& s);
+
+/*! \p print_summary : print statistics of a sparse matrix on std::cout
+ */
+template <typename Matrix>
+void print_summary(const Matrix& A);
+
 template <typename Matrix>
 CUSP_DEPRECATED
 void print_matrix(const Matrix& matrix);
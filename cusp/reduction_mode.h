@@ -0,0 +1,109 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file reduction_mode.h
+ *  \brief Select reproducible BLAS reductions
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/detail/reduction_mode.h>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p current_reduction_mode : the summation of the BLAS reductions
+ *  issued by the calling host thread.
+ *
+ *  With \p fast_reduction, \p cusp::blas::dot, \p dotc, \p dotc_n and
+ *  \p nrm2 add their terms in the order of the reduction kernels (or of
+ *  the vendor BLAS), which depends on the launch configuration and on
+ *  the number of devices of a distributed array, so results may differ
+ *  in the last bits between runs on different hardware.
+ *
+ *  With \p reproducible_reduction, these functions accumulate their
+ *  terms in fixed exponent bins that are added exactly, so the result
+ *  does not depend on the order of the terms: it is bitwise identical
+ *  across runs, launch configurations, devices and partitionings of a
+ *  distributed array.  The result is as accurate as the fast
+ *  reduction, single precision values are accumulated in double
+ *  precision.  The device scalar variants (\p dot_async and friends)
+ *  and therefore the monitors and Krylov solvers follow the mode, but
+ *  the reductions of their own kernels in \p fused_cg, \p pipelined_cg,
+ *  the multi-shift solvers and the asynchronous monitor do not.  The
+ *  default is \p fast_reduction, unless the environment variable
+ *  \c CUSP_REPRODUCIBLE_REDUCTIONS is \c 1 or \c on.
+ */
+inline reduction_mode current_reduction_mode(void)
+{
+    return cusp::detail::current_reduction_mode();
+}
+
+/*! \p set_reduction_mode : select the mode of the host threads that do
+ *  not select one with a \p scoped_reduction_mode.  Should be called
+ *  before reductions are issued from other threads.
+ */
+inline void set_reduction_mode(reduction_mode mode)
+{
+    cusp::detail::default_reduction_mode_reference() = mode;
+}
+
+/*! \p scoped_reduction_mode : select the summation of the BLAS
+ *  reductions of the calling host thread for the lifetime of the object.
+ *
+ *  The previous selection is restored on destruction, so scopes may be
+ *  nested.  The following code snippet solves a system with residual
+ *  norms that do not depend on the device.
+ *
+ *  \code
+ *  {
+ *      cusp::scoped_reduction_mode scope(cusp::reproducible_reduction);
+ *      cusp::krylov::cg(A, x, b, monitor);
+ *  }
+ *  \endcode
+ */
+class scoped_reduction_mode
+{
+    public:
+    explicit scoped_reduction_mode(reduction_mode mode)
+        : previous(cusp::detail::thread_reduction_mode_reference())
+    {
+        cusp::detail::thread_reduction_mode_reference() = mode;
+    }
+
+    ~scoped_reduction_mode(void)
+    {
+        cusp::detail::thread_reduction_mode_reference() = previous;
+    }
+
+    private:
+    int previous;
+
+    // not copyable
+    scoped_reduction_mode(const scoped_reduction_mode&);
+    scoped_reduction_mode& operator=(const scoped_reduction_mode&);
+};
+/*! \}
+ */
+
+} // end namespace cusp
+
@@ -0,0 +1,90 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file chebyshev.h
+ *  \brief Chebyshev relaxation.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/linear_operator.h>
+
+namespace cusp
+{
+namespace relaxation
+{
+
+// Chebyshev polynomial smoother of D^-1 A, applied with the three-term
+// recurrence.  The polynomial targets the eigenvalues of D^-1 A in
+// [lower * rho, upper * rho], where rho is estimated at setup with a few
+// power iterations that stay in MemorySpace, or given by the caller
+// when power_iterations < 2.  Each degree costs one
+// product with A and one fused update of x and the search direction.
+template <typename ValueType, typename MemorySpace>
+class chebyshev
+{
+    size_t degree;
+    ValueType rho;
+    ValueType lower;
+    ValueType upper;
+    cusp::array1d<ValueType,MemorySpace> diagonal;
+    cusp::array1d<ValueType,MemorySpace> direction;
+    cusp::array1d<ValueType,MemorySpace> y;
+
+    template <typename VectorType1, typename VectorType2>
+    void update(const VectorType1& b, VectorType2& x, ValueType alpha, ValueType beta, bool zero_x);
+
+public:
+    chebyshev();
+
+    template <typename MatrixType>
+    chebyshev(const MatrixType& A, size_t degree=3, ValueType lower=1.0/30.0, ValueType upper=1.1, size_t power_iterations=10);
+
+    // with the main diagonal of A given, e.g. by a diagonal_cache
+    template <typename MatrixType, typename ArrayType>
+    chebyshev(const MatrixType& A, size_t degree, ValueType lower, ValueType upper, size_t power_iterations, const ArrayType& diagonal);
+
+    // estimated spectral radius of D^-1 A
+    ValueType spectral_radius(void) const { return rho; }
+
+    // use an estimate of the spectral radius of D^-1 A computed elsewhere
+    void set_spectral_radius(ValueType spectral_radius) { rho = spectral_radius; }
+
+    // ignores initial x
+    template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void presmooth(const MatrixType& A, const VectorType1& b, VectorType2& x);
+   
+    // smooths initial x
+    template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void postsmooth(const MatrixType& A, const VectorType1& b, VectorType2& x);
+
+    template <typename MatrixType, typename VectorType1, typename VectorType2>
+    void operator()(const MatrixType& A, const VectorType1& b, VectorType2& x);
+
+private:
+    template <typename MatrixType, typename VectorType1, typename VectorType2>
+    void apply(const MatrixType& A, const VectorType1& b, VectorType2& x, bool zero_x);
+};
+
+} // end namespace relaxation
+} // end namespace cusp
+
+#include <cusp/relaxation/detail/chebyshev.inl>
+
@@ -0,0 +1,275 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file chebyshev.inl
+ *  \brief Inline file for chebyshev.h
+ */
+
+#include <cusp/copy.h>
+#include <cusp/exception.h>
+#include <cusp/multiply.h>
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/random.h>
+#include <cusp/detail/stream.h>
+
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <cmath>
+
+namespace cusp
+{
+namespace relaxation
+{
+namespace detail
+{
+
+// (D^-1 y)^2
+template <typename ValueType>
+struct scaled_square
+{
+    template <typename Tuple>
+    __host__ __device__
+    ValueType operator()(const Tuple& t) const
+    {
+        const ValueType v = thrust::get<0>(t) / thrust::get<1>(t);
+        return v * v;
+    }
+};
+
+// x <- (D^-1 y) / norm
+template <typename ValueType>
+struct scaled_normalize
+{
+    ValueType norm;
+
+    scaled_normalize(ValueType norm) : norm(norm) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    ValueType operator()(const Tuple& t) const
+    {
+        return thrust::get<0>(t) / (thrust::get<1>(t) * norm);
+    }
+};
+
+// d <- alpha * d + beta * D^-1 (b - y)
+// x <- x + d
+template <typename ValueType>
+struct chebyshev_update_functor
+{
+    ValueType alpha;
+    ValueType beta;
+
+    chebyshev_update_functor(ValueType alpha, ValueType beta) : alpha(alpha), beta(beta) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    void operator()(Tuple t) const
+    {
+        const ValueType b    = thrust::get<2>(t);
+        const ValueType y    = thrust::get<3>(t);
+        const ValueType dinv = ValueType(1) / thrust::get<4>(t);
+
+        // the direction is not read in the first step
+        const ValueType d = alpha == ValueType(0) ? beta * dinv * (b - y)
+                                                  : alpha * thrust::get<1>(t) + beta * dinv * (b - y);
+
+        thrust::get<1>(t) = d;
+        thrust::get<0>(t) = thrust::get<0>(t) + d;
+    }
+};
+
+// spectral radius of D^-1 A from power iterations in the memory space of
+// the diagonal, only the norms are copied to the host
+template <typename MatrixType, typename ArrayType>
+double chebyshev_spectral_radius(const MatrixType& A, const ArrayType& diagonal, size_t k)
+{
+    CUSP_PROFILE_SCOPED();
+
+    typedef typename ArrayType::value_type   ValueType;
+    typedef typename ArrayType::memory_space MemorySpace;
+
+    const size_t N = A.num_rows;
+
+    if (k < 2)
+        return 0;
+
+    cusp::array1d<ValueType, MemorySpace> x(N);
+    cusp::array1d<ValueType, MemorySpace> y(N);
+
+    // initialize x to random values in [0,1)
+    cusp::copy(cusp::detail::random_reals<ValueType>(N), x);
+
+    double norm = 0;
+
+    for(size_t i = 0; i < k; i++)
+    {
+        cusp::multiply(A, x, y);
+
+        norm = std::sqrt((double) thrust::transform_reduce(thrust::make_zip_iterator(thrust::make_tuple(y.begin(), diagonal.begin())),
+                                                           thrust::make_zip_iterator(thrust::make_tuple(y.end(),   diagonal.end())),
+                                                           scaled_square<ValueType>(), ValueType(0), thrust::plus<ValueType>()));
+
+        if (norm == 0)
+            return 0;
+
+        // x has unit norm after the first iteration, so norm estimates rho
+        if (i + 1 == k)
+            break;
+
+        thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(y.begin(), diagonal.begin())),
+                          thrust::make_zip_iterator(thrust::make_tuple(y.end(),   diagonal.end())),
+                          x.begin(), scaled_normalize<ValueType>(ValueType(norm)));
+    }
+
+    return norm;
+}
+
+} // end namespace detail
+
+
+// constructor
+template <typename ValueType, typename MemorySpace>
+    chebyshev<ValueType,MemorySpace>
+    ::chebyshev() : degree(0), rho(0), lower(0), upper(0)
+    {
+    }
+
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType>
+    chebyshev<ValueType,MemorySpace>
+    ::chebyshev(const MatrixType& A, size_t degree, ValueType lower, ValueType upper, size_t power_iterations)
+        : degree(degree), lower(lower), upper(upper), direction(A.num_rows), y(A.num_rows)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (!(lower > 0 && lower < upper))
+            throw cusp::invalid_input_exception("chebyshev bounds must satisfy 0 < lower < upper");
+
+        // extract the main diagonal
+        cusp::detail::extract_diagonal(A, diagonal);
+
+        rho = detail::chebyshev_spectral_radius(A, diagonal, power_iterations);
+    }
+
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType, typename ArrayType>
+    chebyshev<ValueType,MemorySpace>
+    ::chebyshev(const MatrixType& A, size_t degree, ValueType lower, ValueType upper, size_t power_iterations, const ArrayType& D)
+        : degree(degree), lower(lower), upper(upper), diagonal(D), direction(A.num_rows), y(A.num_rows)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (!(lower > 0 && lower < upper))
+            throw cusp::invalid_input_exception("chebyshev bounds must satisfy 0 < lower < upper");
+
+        rho = detail::chebyshev_spectral_radius(A, diagonal, power_iterations);
+    }
+
+// d <- alpha * d + beta * D^-1 (b - A x), x <- x + d,
+// where A x = 0 when zero_x and A x = y otherwise
+template <typename ValueType, typename MemorySpace>
+template<typename VectorType1, typename VectorType2>
+    void chebyshev<ValueType,MemorySpace>
+    ::update(const VectorType1& b, VectorType2& x, ValueType alpha, ValueType beta, bool zero_x)
+    {
+        if (zero_x)
+            cusp::detail::streamed::for_each(thrust::make_zip_iterator(thrust::make_tuple(x.begin(), direction.begin(), b.begin(), thrust::constant_iterator<ValueType>(0), diagonal.begin())),
+                                             thrust::make_zip_iterator(thrust::make_tuple(x.end(),   direction.end(),   b.end(),   thrust::constant_iterator<ValueType>(0), diagonal.end())),
+                                             detail::chebyshev_update_functor<ValueType>(alpha, beta));
+        else
+            cusp::detail::streamed::for_each(thrust::make_zip_iterator(thrust::make_tuple(x.begin(), direction.begin(), b.begin(), y.begin(), diagonal.begin())),
+                                             thrust::make_zip_iterator(thrust::make_tuple(x.end(),   direction.end(),   b.end(),   y.end(),   diagonal.end())),
+                                             detail::chebyshev_update_functor<ValueType>(alpha, beta));
+    }
+
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void chebyshev<ValueType,MemorySpace>
+    ::apply(const MatrixType& A, const VectorType1& b, VectorType2& x, bool zero_x)
+    {
+        if (degree == 0 || rho == 0)
+            return;
+
+        // Chebyshev polynomial for the interval [lower*rho, upper*rho]
+        const ValueType theta = ValueType(0.5) * (upper + lower) * rho;
+        const ValueType delta = ValueType(0.5) * (upper - lower) * rho;
+        const ValueType sigma = theta / delta;
+
+        ValueType rho_old = ValueType(1) / sigma;
+
+        // d <- D^-1 (b - A x) / theta, x <- x + d
+        if (!zero_x)
+            cusp::multiply(A, x, y);
+
+        update(b, x, ValueType(0), ValueType(1) / theta, zero_x);
+
+        for (size_t i = 1; i < degree; i++)
+        {
+            const ValueType rho_new = ValueType(1) / (ValueType(2) * sigma - rho_old);
+
+            cusp::multiply(A, x, y);
+
+            update(b, x, rho_new * rho_old, ValueType(2) * rho_new / delta, false);
+
+            rho_old = rho_new;
+        }
+    }
+
+// linear_operator
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void chebyshev<ValueType,MemorySpace>
+    ::operator()(const MatrixType& A, const VectorType1& b, VectorType2& x)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        apply(A, b, x, false);
+    }
+
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void chebyshev<ValueType,MemorySpace>
+    ::presmooth(const MatrixType& A, const VectorType1& b, VectorType2& x)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        // x <- 0, the first step needs no product with A
+        cusp::detail::streamed::fill(x.begin(), x.end(), ValueType(0));
+
+        apply(A, b, x, true);
+    }
+
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void chebyshev<ValueType,MemorySpace>
+    ::postsmooth(const MatrixType& A, const VectorType1& b, VectorType2& x)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        apply(A, b, x, false);
+    }
+
+} // end namespace relaxation
+} // end namespace cusp
+
@@ -0,0 +1,204 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file gauss_seidel.inl
+ *  \brief Inline file for gauss_seidel.h
+ */
+
+#include <cusp/copy.h>
+#include <cusp/exception.h>
+#include <cusp/detail/format_utils.h>
+#include <cusp/detail/stream.h>
+#include <cusp/graph/vertex_coloring.h>
+
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/iterator/counting_iterator.h>
+
+namespace cusp
+{
+namespace relaxation
+{
+namespace detail
+{
+
+// x[i] <- x[i] + omega * (b[i] - A[i,:] x) / A[i,i] for row i = permutation[n]
+template <typename IndexType, typename ValueType>
+struct gauss_seidel_functor
+{
+    const IndexType * row_offsets;
+    const IndexType * column_indices;
+    const ValueType * values;
+    const ValueType * diagonal;
+    const IndexType * permutation;
+    const ValueType * b;
+          ValueType * x;
+    ValueType omega;
+
+    gauss_seidel_functor(const IndexType * row_offsets, const IndexType * column_indices, const ValueType * values,
+                         const ValueType * diagonal, const IndexType * permutation,
+                         const ValueType * b, ValueType * x, ValueType omega)
+        : row_offsets(row_offsets), column_indices(column_indices), values(values),
+          diagonal(diagonal), permutation(permutation), b(b), x(x), omega(omega) {}
+
+    __host__ __device__
+    void operator()(const IndexType n) const
+    {
+        const IndexType i = permutation[n];
+
+        ValueType residual = b[i];
+
+        for (IndexType jj = row_offsets[i]; jj < row_offsets[i + 1]; jj++)
+            residual -= values[jj] * x[column_indices[jj]];
+
+        x[i] += omega * residual / diagonal[i];
+    }
+};
+
+} // end namespace detail
+
+
+// constructor
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    gauss_seidel<ValueType,MemorySpace,IndexType>
+    ::gauss_seidel() : default_omega(0.0), default_sweep(symmetric_sweep)
+    {
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template<typename MatrixType>
+    gauss_seidel<ValueType,MemorySpace,IndexType>
+    ::gauss_seidel(const MatrixType& A, sweep_type sweep, ValueType omega)
+        : default_omega(omega), default_sweep(sweep), A_csr(A)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (A.num_rows != A.num_cols)
+            throw cusp::invalid_input_exception("matrix must be square");
+
+        // extract the main diagonal
+        cusp::detail::extract_diagonal(A_csr, diagonal);
+
+        color_rows();
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template<typename MatrixType, typename ArrayType>
+    gauss_seidel<ValueType,MemorySpace,IndexType>
+    ::gauss_seidel(const MatrixType& A, sweep_type sweep, ValueType omega, const ArrayType& D)
+        : default_omega(omega), default_sweep(sweep), A_csr(A), diagonal(D)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        if (A.num_rows != A.num_cols)
+            throw cusp::invalid_input_exception("matrix must be square");
+
+        color_rows();
+    }
+
+// order the rows by color
+template <typename ValueType, typename MemorySpace, typename IndexType>
+    void gauss_seidel<ValueType,MemorySpace,IndexType>
+    ::color_rows(void)
+    {
+        cusp::array1d<IndexType,MemorySpace> colors(A_csr.num_rows);
+        cusp::array1d<IndexType,MemorySpace> offsets;
+
+        cusp::graph::vertex_coloring(A_csr, colors);
+        cusp::graph::coloring_permutation(colors, permutation, offsets);
+
+        cusp::copy(offsets, color_offsets);
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template<typename VectorType1, typename VectorType2>
+    void gauss_seidel<ValueType,MemorySpace,IndexType>
+    ::relax_color(const size_t color, const VectorType1& b, VectorType2& x, ValueType omega)
+    {
+        const IndexType begin = color_offsets[color];
+        const IndexType end   = color_offsets[color + 1];
+
+        cusp::detail::streamed::for_each(thrust::counting_iterator<IndexType>(begin),
+                                         thrust::counting_iterator<IndexType>(end),
+                                         detail::gauss_seidel_functor<IndexType,ValueType>
+                                            (thrust::raw_pointer_cast(&A_csr.row_offsets[0]),
+                                             thrust::raw_pointer_cast(&A_csr.column_indices[0]),
+                                             thrust::raw_pointer_cast(&A_csr.values[0]),
+                                             thrust::raw_pointer_cast(&diagonal[0]),
+                                             thrust::raw_pointer_cast(&permutation[0]),
+                                             thrust::raw_pointer_cast(&b[0]),
+                                             thrust::raw_pointer_cast(&x[0]),
+                                             omega));
+    }
+
+// linear_operator
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void gauss_seidel<ValueType,MemorySpace,IndexType>
+    ::operator()(const MatrixType& A, const VectorType1& b, VectorType2& x)
+    {
+        gauss_seidel<ValueType,MemorySpace,IndexType>::operator()(A,b,x,default_sweep,default_omega);
+    }
+
+// override default sweep and omega
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void gauss_seidel<ValueType,MemorySpace,IndexType>
+    ::operator()(const MatrixType&, const VectorType1& b, VectorType2& x, sweep_type sweep, ValueType omega)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        // nothing to relax
+        if (A_csr.num_entries == 0)
+            return;
+
+        if (sweep == forward_sweep || sweep == symmetric_sweep)
+            for (size_t color = 0; color < num_colors(); color++)
+                relax_color(color, b, x, omega);
+
+        if (sweep == backward_sweep || sweep == symmetric_sweep)
+            for (size_t color = num_colors(); color > 0; color--)
+                relax_color(color - 1, b, x, omega);
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void gauss_seidel<ValueType,MemorySpace,IndexType>
+    ::presmooth(const MatrixType& A, const VectorType1& b, VectorType2& x)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        // x <- 0 
+        cusp::detail::streamed::fill(x.begin(), x.end(), ValueType(0));
+
+        gauss_seidel<ValueType,MemorySpace,IndexType>::operator()(A,b,x,default_sweep,default_omega);
+    }
+
+template <typename ValueType, typename MemorySpace, typename IndexType>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void gauss_seidel<ValueType,MemorySpace,IndexType>
+    ::postsmooth(const MatrixType& A, const VectorType1& b, VectorType2& x)
+    {
+        CUSP_PROFILE_SCOPED();
+
+        gauss_seidel<ValueType,MemorySpace,IndexType>::operator()(A,b,x,default_sweep,default_omega);
+    }
+
+
+} // end namespace relaxation
+} // end namespace cusp
+
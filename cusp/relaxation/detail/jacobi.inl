@@ -20,7 +20,10 @@
 
 #include <cusp/multiply.h>
 #include <cusp/detail/format_utils.h>
+#include <cusp/detail/stream.h>
+#include <cusp/detail/device/multiply.h>
 
+#include <thrust/copy.h>
 #include <thrust/functional.h>
 #include <thrust/transform.h>
 #include <thrust/iterator/zip_iterator.h>
@@ -66,6 +69,42 @@ struct jacobi_postsmooth_functor
     }
 };
 
+// y <- x + omega * D^-1 * (b - A*x), host path
+template <typename MatrixType, typename VectorType1, typename VectorType2, typename VectorType3, typename VectorType4, typename ValueType>
+void jacobi_sweep(const MatrixType& A, const VectorType1& x, const VectorType2& b, const VectorType3& diagonal, VectorType4& y, ValueType omega,
+                  cusp::host_memory)
+{
+    // y <- A*x
+    cusp::multiply(A, x, y);
+
+    // y <- x + omega * D^-1 * (b - y)
+    thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(x.begin(), diagonal.begin(), b.begin(), y.begin())),
+                      thrust::make_zip_iterator(thrust::make_tuple(x.end(),   diagonal.end(),   b.end(),   y.end())),
+                      y.begin(),
+                      jacobi_postsmooth_functor<ValueType>(omega));
+}
+
+// device path, the update is the epilogue of the SpMV kernel
+template <typename MatrixType, typename VectorType1, typename VectorType2, typename VectorType3, typename VectorType4, typename ValueType>
+void jacobi_sweep(const MatrixType& A, const VectorType1& x, const VectorType2& b, const VectorType3& diagonal, VectorType4& y, ValueType omega,
+                  cusp::device_memory)
+{
+    cusp::detail::device::multiply_jacobi(A, x, b, diagonal, y, omega, typename MatrixType::format());
+}
+
+// x <- y, where the storage is exchanged when the types agree
+template <typename Array>
+void jacobi_result(Array& y, Array& x)
+{
+    x.swap(y);
+}
+
+template <typename Array1, typename Array2>
+void jacobi_result(Array1& y, Array2& x)
+{
+    cusp::detail::streamed::copy(y.begin(), y.end(), x.begin());
+}
+
 } // end namespace detail
 
 
@@ -88,6 +127,14 @@ template<typename MatrixType>
         cusp::detail::extract_diagonal(A, diagonal);
     }
 
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType, typename ArrayType>
+    jacobi<ValueType,MemorySpace>
+    ::jacobi(const MatrixType& A, ValueType omega, const ArrayType& D)
+        : default_omega(omega), diagonal(D), temp(A.num_rows)
+    {
+    }
+
 // linear_operator
 template <typename ValueType, typename MemorySpace>
 template<typename MatrixType, typename VectorType1, typename VectorType2>
@@ -105,45 +152,75 @@ template<typename MatrixType, typename VectorType1, typename VectorType2>
     {
         CUSP_PROFILE_SCOPED();
 
-        // y <- A*x
-        cusp::multiply(A, x, temp);
-        
-        // x <- x + omega * D^-1 * (b - y)
-        thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(x.begin(), diagonal.begin(), b.begin(), temp.begin())),
-                          thrust::make_zip_iterator(thrust::make_tuple(x.end(),   diagonal.end(),   b.end(),   temp.end())),
-                          x.begin(),
-                          detail::jacobi_postsmooth_functor<ValueType>(omega));
+        sweep(A, b, x, omega, 1);
     }
 
+// ping-pong between x and temp, x <- x + omega * D^-1 * (b - A*x)
 template <typename ValueType, typename MemorySpace>
 template<typename MatrixType, typename VectorType1, typename VectorType2>
     void jacobi<ValueType,MemorySpace>
-    ::presmooth(const MatrixType&, const VectorType1& b, VectorType2& x)
+    ::sweep(const MatrixType& A, const VectorType1& b, VectorType2& x, ValueType omega, size_t sweeps)
+    {
+        if (sweeps == 0 || A.num_rows == 0)
+            return;
+
+        temp.resize(A.num_rows);
+
+        for (size_t k = 0; k < sweeps; k++)
+        {
+            if (k % 2 == 0)
+                detail::jacobi_sweep(A, x, b, diagonal, temp, omega, MemorySpace());
+            else
+                detail::jacobi_sweep(A, temp, b, diagonal, x, omega, MemorySpace());
+        }
+
+        if (sweeps % 2 == 1)
+            detail::jacobi_result(temp, x);
+    }
+
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void jacobi<ValueType,MemorySpace>
+    ::presmooth(const MatrixType& A, const VectorType1& b, VectorType2& x)
+    {
+        presmooth(A, b, x, 1);
+    }
+
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void jacobi<ValueType,MemorySpace>
+    ::presmooth(const MatrixType& A, const VectorType1& b, VectorType2& x, size_t sweeps)
     {
         CUSP_PROFILE_SCOPED();
         
+        if (sweeps == 0)
+            return;
+
         // x <- omega * D^-1 * b 
-        thrust::transform(b.begin(), b.end(),
-                          diagonal.begin(),
-                          x.begin(),
-                          detail::jacobi_presmooth_functor<ValueType>(default_omega));
+        cusp::detail::streamed::transform(b.begin(), b.end(),
+                                          diagonal.begin(),
+                                          x.begin(),
+                                          detail::jacobi_presmooth_functor<ValueType>(default_omega));
+
+        sweep(A, b, x, default_omega, sweeps - 1);
     }
 
 template <typename ValueType, typename MemorySpace>
 template<typename MatrixType, typename VectorType1, typename VectorType2>
     void jacobi<ValueType,MemorySpace>
     ::postsmooth(const MatrixType& A, const VectorType1& b, VectorType2& x)
+    {
+        postsmooth(A, b, x, 1);
+    }
+
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void jacobi<ValueType,MemorySpace>
+    ::postsmooth(const MatrixType& A, const VectorType1& b, VectorType2& x, size_t sweeps)
     {
         CUSP_PROFILE_SCOPED();
 
-        // y <- A*x
-        cusp::multiply(A, x, temp);
-        
-        // x <- x + omega * D^-1 * (b - y)
-        thrust::transform(thrust::make_zip_iterator(thrust::make_tuple(x.begin(), diagonal.begin(), b.begin(), temp.begin())),
-                          thrust::make_zip_iterator(thrust::make_tuple(x.end(),   diagonal.end(),   b.end(),   temp.end())),
-                          x.begin(),
-                          detail::jacobi_postsmooth_functor<ValueType>(default_omega));
+        sweep(A, b, x, default_omega, sweeps);
     }
 
 
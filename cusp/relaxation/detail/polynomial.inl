@@ -18,6 +18,7 @@
  *  \brief Inline file for polynomial.h
  */
 
+#include <cusp/matrix_powers.h>
 #include <cusp/multiply.h>
 #include <cusp/detail/format_utils.h>
 
@@ -87,10 +88,26 @@ template<typename MatrixType, typename VectorType>
 	size_t N = A.num_rows;
 
 	residual.resize(N);
-	y.resize(N);
 	h.resize(N);
     }
 
+// evaluate the polynomial from the powers of A, which are computed with a
+// single pass over A when its band is narrow
+template <typename ValueType, typename MemorySpace>
+template<typename MatrixType, typename VectorType1, typename VectorType2, typename VectorType3>
+    void polynomial<ValueType,MemorySpace>
+    ::apply_polynomial(const MatrixType& A, const VectorType1& r, const VectorType2& coefficients, VectorType3& h)
+    {
+        const size_t degree = coefficients.size() - 1;
+
+        cusp::matrix_powers(A, r, degree, basis);
+
+        cusp::blas::axpby(basis.column(degree), basis.column(degree), h, ValueType(coefficients[0]), ValueType(0));
+
+        for( size_t i = 1; i <= degree; i++ )
+            cusp::blas::axpy(basis.column(degree - i), h, ValueType(coefficients[i]));
+    }
+
 // linear_operator
 template <typename ValueType, typename MemorySpace>
 template<typename MatrixType, typename VectorType1, typename VectorType2>
@@ -110,16 +127,7 @@ template<typename MatrixType, typename VectorType1, typename VectorType2>
         CUSP_PROFILE_SCOPED();
         
 	// Ignore the initial x and use b as the residual
-	ValueType scale_factor = default_coefficients[0];
-        cusp::blas::axpby(b, x, x, scale_factor, ValueType(0));
-
-	for( size_t i = 1; i<default_coefficients.size(); i++ )
-	{
-		scale_factor = default_coefficients[i];
-
-            	cusp::multiply(A, x, y);
-            	cusp::blas::axpby(y, b, x, ValueType(1.0), scale_factor);
-	}
+        apply_polynomial(A, b, default_coefficients, x);
     }
 
 template <typename ValueType, typename MemorySpace>
@@ -133,16 +141,7 @@ template<typename MatrixType, typename VectorType1, typename VectorType2>
         cusp::multiply(A, x, residual);
         cusp::blas::axpby(b, residual, residual, ValueType(1), ValueType(-1));
 
-	ValueType scale_factor = default_coefficients[0];
-        cusp::blas::axpby(residual, h, h, scale_factor, ValueType(0));
-
-	for( size_t i = 1; i<default_coefficients.size(); i++ )
-	{
-		scale_factor = default_coefficients[i];
-
-            	cusp::multiply(A, h, y);
-            	cusp::blas::axpby(y, residual, h, ValueType(1.0), scale_factor);
-	}
+        apply_polynomial(A, residual, default_coefficients, h);
 
         cusp::blas::axpy(h, x, ValueType(1.0));
     }
@@ -164,16 +163,7 @@ template<typename MatrixType, typename VectorType1, typename VectorType2, typena
             	cusp::blas::axpby(b, residual, residual, ValueType(1), ValueType(-1));
 	}
 
-	ValueType scale_factor = coefficients[0];
-        cusp::blas::axpby(residual, h, h, scale_factor, ValueType(0));
-
-	for( size_t i = 1; i<coefficients.size(); i++ )
-	{
-		scale_factor = coefficients[i];
-
-            	cusp::multiply(A, h, y);
-            	cusp::blas::axpby(y, residual, h, ValueType(1.0), scale_factor);
-	}
+        apply_polynomial(A, residual, coefficients, h);
 
         cusp::blas::axpy(h, x, ValueType(1.0));
     }
@@ -0,0 +1,89 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file gauss_seidel.h
+ *  \brief Multicolor Gauss-Seidel relaxation.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/linear_operator.h>
+
+namespace cusp
+{
+namespace relaxation
+{
+
+// order of the colors in a Gauss-Seidel sweep
+enum sweep_type { forward_sweep, backward_sweep, symmetric_sweep };
+
+// The rows of a color are independent in a distance-1 coloring of the
+// graph of A, so each color is relaxed in one parallel step and a sweep
+// visits the colors one after the other.  The coloring requires the
+// sparsity pattern of A to be symmetric.  A CSR copy of A is kept, hence
+// the matrix passed to the sweeps is ignored.
+template <typename ValueType, typename MemorySpace, typename IndexType = int>
+class gauss_seidel
+{
+    ValueType default_omega;
+    sweep_type default_sweep;
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> A_csr;
+    cusp::array1d<ValueType,MemorySpace> diagonal;
+    cusp::array1d<IndexType,MemorySpace> permutation;          // rows ordered by color
+    cusp::array1d<IndexType,cusp::host_memory> color_offsets;  // rows of each color in permutation
+
+    void color_rows(void);
+
+    template <typename VectorType1, typename VectorType2>
+    void relax_color(const size_t color, const VectorType1& b, VectorType2& x, ValueType omega);
+
+public:
+    gauss_seidel();
+
+    template <typename MatrixType>
+    gauss_seidel(const MatrixType& A, sweep_type sweep=symmetric_sweep, ValueType omega=1.0);
+
+    // with the main diagonal of A given, e.g. by a diagonal_cache
+    template <typename MatrixType, typename ArrayType>
+    gauss_seidel(const MatrixType& A, sweep_type sweep, ValueType omega, const ArrayType& diagonal);
+
+    size_t num_colors(void) const { return color_offsets.empty() ? 0 : color_offsets.size() - 1; }
+
+    // ignores initial x
+    template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void presmooth(const MatrixType& A, const VectorType1& b, VectorType2& x);
+   
+    // smooths initial x
+    template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void postsmooth(const MatrixType& A, const VectorType1& b, VectorType2& x);
+
+    template <typename MatrixType, typename VectorType1, typename VectorType2>
+    void operator()(const MatrixType& A, const VectorType1& b, VectorType2& x);
+        
+    template <typename MatrixType, typename VectorType1, typename VectorType2>
+    void operator()(const MatrixType& A, const VectorType1& b, VectorType2& x, sweep_type sweep, ValueType omega);
+};
+
+} // end namespace relaxation
+} // end namespace cusp
+
+#include <cusp/relaxation/detail/gauss_seidel.inl>
+
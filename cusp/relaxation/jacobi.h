@@ -29,6 +29,12 @@ namespace cusp
 namespace relaxation
 {
 
+// Each sweep computes x[i] + omega * (b[i] - (A x)[i]) / A[i,i] in the
+// epilogue of the SpMV kernel (CSR, DIA, ELL and HYB on the device), so
+// no product A*x is stored.  The sweeps alternate between x and an
+// internal buffer.  When x is an array1d of the same type as the buffer
+// the result of an odd number of sweeps is returned by exchanging the
+// storage of the two, otherwise it is copied to x.
 template <typename ValueType, typename MemorySpace>
 class jacobi
 {
@@ -36,20 +42,35 @@ class jacobi
     cusp::array1d<ValueType,MemorySpace> diagonal;
     cusp::array1d<ValueType,MemorySpace> temp;
 
+    template <typename MatrixType, typename VectorType1, typename VectorType2>
+    void sweep(const MatrixType& A, const VectorType1& b, VectorType2& x, ValueType omega, size_t sweeps);
+
 public:
     jacobi();
 
     template <typename MatrixType>
     jacobi(const MatrixType& A, ValueType omega=1.0);
+
+    // with the main diagonal of A given, e.g. by a diagonal_cache
+    template <typename MatrixType, typename ArrayType>
+    jacobi(const MatrixType& A, ValueType omega, const ArrayType& diagonal);
     
     // ignores initial x
     template<typename MatrixType, typename VectorType1, typename VectorType2>
     void presmooth(const MatrixType& A, const VectorType1& b, VectorType2& x);
    
+    // ignores initial x, applies the given number of sweeps
+    template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void presmooth(const MatrixType& A, const VectorType1& b, VectorType2& x, size_t sweeps);
+   
     // smooths initial x
     template<typename MatrixType, typename VectorType1, typename VectorType2>
     void postsmooth(const MatrixType& A, const VectorType1& b, VectorType2& x);
 
+    // smooths initial x, applies the given number of sweeps
+    template<typename MatrixType, typename VectorType1, typename VectorType2>
+    void postsmooth(const MatrixType& A, const VectorType1& b, VectorType2& x, size_t sweeps);
+
     template <typename MatrixType, typename VectorType1, typename VectorType2>
     void operator()(const MatrixType& A, const VectorType1& b, VectorType2& x);
         
@@ -22,6 +22,7 @@
 
 #include <cusp/detail/config.h>
 
+#include <cusp/array2d.h>
 #include <cusp/linear_operator.h>
 
 namespace cusp
@@ -36,7 +37,13 @@ class polynomial
     cusp::array1d<ValueType, cusp::host_memory> default_coefficients;
     cusp::array1d<ValueType, MemorySpace> residual;
     cusp::array1d<ValueType, MemorySpace> h;
-    cusp::array1d<ValueType, MemorySpace> y;
+
+    // the powers r, A r, ..., A^degree r
+    cusp::array2d<ValueType, MemorySpace, cusp::column_major> basis;
+
+    // h <- p(A) r for the coefficients of p from the highest degree down
+    template <typename MatrixType, typename VectorType1, typename VectorType2, typename VectorType3>
+    void apply_polynomial(const MatrixType& A, const VectorType1& r, const VectorType2& coefficients, VectorType3& h);
 
 public:
     polynomial();
@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file row_operations.h
+ *  \brief Row reductions and diagonal scaling of sparse matrices
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+namespace cusp
+{
+
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p row_sum : y[i] = sum_j A(i,j), a reduction of \p row_reduce
+ */
+struct row_sum {};
+
+/*! \p row_max_abs : y[i] = max_j |A(i,j)|, a reduction of \p row_reduce
+ */
+struct row_max_abs {};
+
+/*! \p row_norm2 : y[i] = sqrt(sum_j |A(i,j)|^2), a reduction of
+ *  \p row_reduce
+ */
+struct row_norm2 {};
+
+/*! \p row_reduce : reduce the stored entries of each row of a matrix
+ *
+ *  \param A \p coo_matrix, \p csr_matrix, \p dia_matrix, \p ell_matrix
+ *  or \p hyb_matrix (or a view)
+ *  \param y output array in the memory space of \p A, resized to
+ *  <tt>A.num_rows</tt>
+ *  \param op \p row_sum, \p row_max_abs or \p row_norm2
+ *
+ *  Rows without entries reduce to zero, and the padding of the ELL and
+ *  DIA formats is skipped.  The entries of a \p coo_matrix must be
+ *  sorted by row.  For a complex matrix, \p y may hold real values,
+ *  which \p row_max_abs requires.
+ *
+ *  \code
+ *  #include <cusp/row_operations.h>
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/gallery/poisson.h>
+ *
+ *  #include <thrust/transform.h>
+ *
+ *  struct reciprocal
+ *  {
+ *      __host__ __device__
+ *      float operator()(const float x) const { return x == 0 ? 1 : 1 / x; }
+ *  };
+ *
+ *  int main(void)
+ *  {
+ *      cusp::csr_matrix<int, float, cusp::device_memory> A;
+ *      cusp::gallery::poisson5pt(A, 10, 10);
+ *
+ *      // scale every row to a largest magnitude of one
+ *      cusp::array1d<float, cusp::device_memory> d;
+ *      cusp::row_reduce(A, d, cusp::row_max_abs());
+ *      thrust::transform(d.begin(), d.end(), d.begin(), reciprocal());
+ *      cusp::scale_rows(A, d);
+ *  }
+ *  \endcode
+ *
+ *  \see \p scale_rows
+ */
+template <typename Matrix, typename Array, typename RowReduction>
+void row_reduce(const Matrix& A, Array& y, RowReduction op);
+
+/*! \p scale_rows : A(i,j) <- d[i] * A(i,j), in place
+ *
+ *  \param A \p coo_matrix, \p csr_matrix, \p dia_matrix, \p ell_matrix
+ *  or \p hyb_matrix (or a view)
+ *  \param d row scaling factors in the memory space of \p A, of size
+ *  <tt>A.num_rows</tt>
+ *
+ *  The pattern of \p A is unchanged.
+ *
+ *  \throws cusp::invalid_input_exception if the size of \p d does not
+ *  match
+ *
+ *  \see \p scale_columns
+ */
+template <typename Matrix, typename Array>
+void scale_rows(Matrix& A, const Array& d);
+
+/*! \p scale_columns : A(i,j) <- A(i,j) * d[j], in place
+ *
+ *  \param A \p coo_matrix, \p csr_matrix, \p dia_matrix, \p ell_matrix
+ *  or \p hyb_matrix (or a view)
+ *  \param d column scaling factors in the memory space of \p A, of size
+ *  <tt>A.num_cols</tt>
+ *
+ *  Together with \p scale_rows this computes the two-sided
+ *  equilibration D_r A D_c.
+ *
+ *  \throws cusp::invalid_input_exception if the size of \p d does not
+ *  match
+ *
+ *  \see \p scale_rows
+ */
+template <typename Matrix, typename Array>
+void scale_columns(Matrix& A, const Array& d);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/row_operations.inl>
+
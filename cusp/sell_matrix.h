@@ -0,0 +1,215 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file sell_matrix.h
+ *  \brief Sliced ELLPACK (SELL-C-sigma) matrix format.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/format.h>
+#include <cusp/detail/matrix_base.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p sell_matrix : Sliced ELLPACK (SELL-C-sigma) matrix container
+ *
+ * The rows are partitioned into slices of \p slice_size (C) rows and each
+ * slice is stored in ELL format, padded only to the longest row of the
+ * slice.  To make the rows of a slice similar in length, the rows are
+ * sorted by decreasing length within windows of \p sorting_window (sigma)
+ * rows beforehand; \p row_permutation maps the position of a row in this
+ * order to its index in the matrix.
+ *
+ * The entries of slice \c s are stored column-major from
+ * <tt>slice_offsets[s]</tt>: the \c n-th entry of the \c r-th row of the
+ * slice is at <tt>slice_offsets[s] + n * slice_size + r</tt>.  The width
+ * of the slice is <tt>(slice_offsets[s+1] - slice_offsets[s]) / slice_size</tt>.
+ * Padding is marked by \p invalid_index in \p column_indices.
+ *
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ * \note The matrix entries within each row should be shifted to the left.
+ * \note \p sorting_window should be a multiple of \p slice_size.
+ * \note Conversions into a \p sell_matrix use the \p slice_size and
+ *  \p sorting_window of the destination.
+ *
+ *  \code
+ *  #include <cusp/sell_matrix.h>
+ *  #include <cusp/csr_matrix.h>
+ *  ...
+ *
+ *  cusp::csr_matrix<int,float,cusp::host_memory> A = ...;
+ *
+ *  // slices of 32 rows, rows sorted within windows of 1024 rows
+ *  cusp::sell_matrix<int,float,cusp::device_memory> B(A, 32, 1024);
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class sell_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::sell_format>
+{
+  typedef cusp::detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::sell_format> Parent;
+  public:
+    /*! rebind matrix to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::sell_matrix<IndexType, ValueType, MemorySpace2> type; };
+
+    /*! type of row permutation and slice offsets arrays
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> index_array_type;
+
+    /*! type of column indices array
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> column_indices_array_type;
+
+    /*! type of values array
+     */
+    typedef typename cusp::array1d<ValueType, MemorySpace> values_array_type;
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::sell_matrix<IndexType, ValueType, MemorySpace> container;
+
+    /*! Value used to pad the rows of the column_indices array.
+     */
+    const static IndexType invalid_index = static_cast<IndexType>(-1);
+
+    /*! Number of rows per slice (C).
+     */
+    size_t slice_size;
+
+    /*! Number of consecutive rows sorted by length (sigma).
+     */
+    size_t sorting_window;
+
+    /*! Matrix row stored at each position of the sliced layout.
+     */
+    index_array_type row_permutation;
+
+    /*! Offset of the first entry of each slice in \p column_indices
+     *  and \p values.
+     */
+    index_array_type slice_offsets;
+
+    /*! Storage for the column indices of the SELL data structure.
+     */
+    column_indices_array_type column_indices;
+
+    /*! Storage for the values of the SELL data structure.
+     */
+    values_array_type values;
+
+    /*! Construct an empty \p sell_matrix with the default slice parameters.
+     */
+    sell_matrix() : slice_size(32), sorting_window(1024) {}
+
+    /*! Construct a \p sell_matrix with a specific shape and storage.
+     *
+     *  \param num_rows Number of rows.
+     *  \param num_cols Number of columns.
+     *  \param num_entries Number of nonzero matrix entries.
+     *  \param num_stored_entries Number of stored entries, including padding.
+     *  \param slice_size Number of rows per slice.
+     *  \param sorting_window Number of consecutive rows sorted by length.
+     */
+    sell_matrix(size_t num_rows, size_t num_cols, size_t num_entries,
+                size_t num_stored_entries, size_t slice_size = 32, size_t sorting_window = 1024)
+      : Parent(num_rows, num_cols, num_entries),
+        slice_size(slice_size), sorting_window(sorting_window),
+        row_permutation(num_rows),
+        slice_offsets((num_rows + slice_size - 1) / slice_size + 1),
+        column_indices(num_stored_entries),
+        values(num_stored_entries) {}
+
+    /*! Construct a \p sell_matrix with the default slice parameters from
+     *  another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    sell_matrix(const MatrixType& matrix);
+
+    /*! Construct a \p sell_matrix from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     *  \param slice_size Number of rows per slice.
+     *  \param sorting_window Number of consecutive rows sorted by length.
+     */
+    template <typename MatrixType>
+    sell_matrix(const MatrixType& matrix, size_t slice_size, size_t sorting_window);
+
+    /*! Number of slices.
+     */
+    size_t num_slices(void) const { return slice_offsets.size() - 1; }
+
+    /*! Resize matrix dimensions and underlying storage
+     */
+    void resize(size_t num_rows, size_t num_cols, size_t num_entries,
+                size_t num_stored_entries, size_t slice_size, size_t sorting_window)
+    {
+      Parent::resize(num_rows, num_cols, num_entries);
+      this->slice_size     = slice_size;
+      this->sorting_window = sorting_window;
+      row_permutation.resize(num_rows);
+      slice_offsets.resize((num_rows + slice_size - 1) / slice_size + 1);
+      column_indices.resize(num_stored_entries);
+      values.resize(num_stored_entries);
+    }
+
+    /*! Swap the contents of two \p sell_matrix objects.
+     *
+     *  \param matrix Another \p sell_matrix with the same IndexType and ValueType.
+     */
+    void swap(sell_matrix& matrix)
+    {
+      Parent::swap(matrix);
+      thrust::swap(slice_size,     matrix.slice_size);
+      thrust::swap(sorting_window, matrix.sorting_window);
+      row_permutation.swap(matrix.row_permutation);
+      slice_offsets.swap(matrix.slice_offsets);
+      column_indices.swap(matrix.column_indices);
+      values.swap(matrix.values);
+    }
+
+    /*! Assignment from another matrix.  The slice parameters of this
+     *  matrix are retained unless \p matrix is a \p sell_matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    sell_matrix& operator=(const MatrixType& matrix);
+}; // class sell_matrix
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/sell_matrix.inl>
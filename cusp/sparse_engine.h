@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file sparse_engine.h
+ *  \brief Select the engine of the device sparse operations
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/detail/sparse_engine.h>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p cusparse_available : whether Cusp was built with cuSPARSE, i.e.
+ *  with \c CUSP_USE_CUSPARSE defined before including any Cusp header
+ *  (and linked with cuSPARSE).
+ */
+inline bool cusparse_available(void)
+{
+    return cusp::detail::cusparse_available();
+}
+
+/*! \p current_sparse_engine : the engine of the device sparse operations
+ *  issued by the calling host thread.
+ *
+ *  With \p cusparse_engine, the following operations on device
+ *  \p csr_matrix operands (and views) with \c int indices and \c float
+ *  or \c double values are forwarded to cuSPARSE:
+ *
+ *   - \p multiply of a matrix and a vector (SpMV), also the fused
+ *     y = alpha A x + beta z of the solvers,
+ *   - \p multiply of a matrix and an \p array2d (SpMM),
+ *   - \p multiply of two matrices into a \p csr_matrix (SpGEMM),
+ *   - \p transpose into a \p csr_matrix,
+ *   - \p triangular_solve without a plan.
+ *
+ *  The descriptors refer to the storage of the operands, nothing is
+ *  copied.  Other operands and operations, and all operations built
+ *  without cuSPARSE, use the built-in kernels.  The default engine is
+ *  \p cusparse_engine when it is available, unless the environment
+ *  variable \c CUSP_DEVICE_VENDOR is \c 0 or \c off.
+ */
+inline sparse_engine current_sparse_engine(void)
+{
+    return cusp::detail::current_sparse_engine();
+}
+
+/*! \p set_sparse_engine : select the engine of the host threads that do
+ *  not select one with a \p scoped_sparse_engine.  Should be called
+ *  before device operations are issued from other threads.
+ */
+inline void set_sparse_engine(sparse_engine engine)
+{
+    cusp::detail::default_sparse_engine_reference() = engine;
+}
+
+/*! \p scoped_sparse_engine : select the engine of the device sparse
+ *  operations of the calling host thread for the lifetime of the object.
+ *
+ *  The previous selection is restored on destruction, so scopes may be
+ *  nested.  The following code snippet compares both engines on one
+ *  product.
+ *
+ *  \code
+ *  {
+ *      cusp::scoped_sparse_engine scope(cusp::cusparse_engine);
+ *      cusp::multiply(A, x, y1);       // cuSPARSE
+ *  }
+ *  {
+ *      cusp::scoped_sparse_engine scope(cusp::builtin_engine);
+ *      cusp::multiply(A, x, y2);       // cusp/detail/device kernels
+ *  }
+ *  \endcode
+ */
+class scoped_sparse_engine
+{
+    public:
+    explicit scoped_sparse_engine(sparse_engine engine)
+        : previous(cusp::detail::thread_sparse_engine_reference())
+    {
+        cusp::detail::thread_sparse_engine_reference() = engine;
+    }
+
+    ~scoped_sparse_engine(void)
+    {
+        cusp::detail::thread_sparse_engine_reference() = previous;
+    }
+
+    private:
+    int previous;
+
+    // not copyable
+    scoped_sparse_engine(const scoped_sparse_engine&);
+    scoped_sparse_engine& operator=(const scoped_sparse_engine&);
+};
+/*! \}
+ */
+
+} // end namespace cusp
+
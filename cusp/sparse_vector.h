@@ -0,0 +1,168 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file sparse_vector.h
+ *  \brief Sparse vector container
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/format.h>
+#include <cusp/array1d.h>
+
+#include <thrust/swap.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p sparse_vector : Sparse vector container
+ *
+ * A vector of \c length entries of which the \c num_entries entries
+ * <tt>(indices[k], values[k])</tt> are stored.  The product of a
+ * \p csr_matrix with a \p sparse_vector is a \p sparse_vector.
+ *
+ * \tparam IndexType Type used for vector indices (e.g. \c int).
+ * \tparam ValueType Type used for vector values (e.g. \c float).
+ * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ * \note The vector should not contain duplicate indices.
+ *
+ *  The following code snippet demonstrates how to create a \p sparse_vector
+ *  of length 6 with 2 entries and multiply it by a matrix.
+ *
+ *  \code
+ *  #include <cusp/sparse_vector.h>
+ *  #include <cusp/multiply.h>
+ *  ...
+ *
+ *  // the vector [0 10 0 0 20 0]
+ *  cusp::sparse_vector<int,float,cusp::host_memory> x(6,2);
+ *  x.indices[0] = 1; x.values[0] = 10;
+ *  x.indices[1] = 4; x.values[1] = 20;
+ *
+ *  // y = A x, where A is a csr_matrix with 6 columns
+ *  cusp::sparse_vector<int,float,cusp::host_memory> y;
+ *  cusp::multiply(A, x, y);
+ *  \endcode
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class sparse_vector
+{
+  public:
+    typedef IndexType   index_type;
+    typedef ValueType   value_type;
+    typedef MemorySpace memory_space;
+    typedef cusp::sparse_vector_format format;
+
+    /*! rebind vector to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::sparse_vector<IndexType, ValueType, MemorySpace2> type; };
+
+    /*! type of \c indices array
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> indices_array_type;
+
+    /*! type of \c values array
+     */
+    typedef typename cusp::array1d<ValueType, MemorySpace> values_array_type;
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::sparse_vector<IndexType, ValueType, MemorySpace> container;
+
+    /*! Number of entries of the vector, stored or not.
+     */
+    size_t length;
+
+    /*! Number of stored entries.
+     */
+    size_t num_entries;
+
+    /*! Storage for the indices of the stored entries.
+     */
+    indices_array_type indices;
+
+    /*! Storage for the values of the stored entries.
+     */
+    values_array_type values;
+
+    /*! Construct an empty \p sparse_vector.
+     */
+    sparse_vector()
+      : length(0), num_entries(0) {}
+
+    /*! Construct a \p sparse_vector with a specific length and number of stored entries.
+     *
+     *  \param length Number of entries of the vector.
+     *  \param num_entries Number of stored entries.
+     */
+    sparse_vector(size_t length, size_t num_entries)
+      : length(length), num_entries(num_entries),
+        indices(num_entries), values(num_entries) {}
+
+    /*! Construct a \p sparse_vector from another \p sparse_vector.
+     *
+     *  \param vector Another \p sparse_vector, possibly in another memory space.
+     */
+    template <typename IndexType2, typename ValueType2, typename MemorySpace2>
+    sparse_vector(const sparse_vector<IndexType2,ValueType2,MemorySpace2>& vector);
+
+    /*! Resize the vector and underlying storage
+     */
+    void resize(size_t length, size_t num_entries)
+    {
+      this->length      = length;
+      this->num_entries = num_entries;
+      indices.resize(num_entries);
+      values.resize(num_entries);
+    }
+
+    /*! Swap the contents of two \p sparse_vector objects.
+     *
+     *  \param vector Another \p sparse_vector with the same IndexType and ValueType.
+     */
+    void swap(sparse_vector& vector)
+    {
+      thrust::swap(length,      vector.length);
+      thrust::swap(num_entries, vector.num_entries);
+      indices.swap(vector.indices);
+      values.swap(vector.values);
+    }
+
+    /*! Assignment from another \p sparse_vector.
+     *
+     *  \param vector Another \p sparse_vector, possibly in another memory space.
+     */
+    template <typename IndexType2, typename ValueType2, typename MemorySpace2>
+    sparse_vector& operator=(const sparse_vector<IndexType2,ValueType2,MemorySpace2>& vector);
+}; // class sparse_vector
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/sparse_vector.inl>
@@ -0,0 +1,166 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file spgemm.h
+ *  \brief Sparse matrix-matrix multiplication with a reusable structure
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+
+namespace cusp
+{
+
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p spgemm_plan : the sparsity pattern of a product <tt>C = A * B</tt>
+ *  of CSR matrices, computed by \p spgemm_symbolic and used by
+ *  \p spgemm_numeric to recompute C when only the values of A and B change.
+ *
+ *  The pattern contains every structurally nonzero entry of the product,
+ *  including entries whose value happens to cancel to zero.  The column
+ *  indices within each row are sorted.
+ *
+ *  \tparam IndexType Type used for matrix indices (e.g. \c int).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ */
+template <typename IndexType, typename MemorySpace>
+class spgemm_plan
+{
+    public:
+    typedef IndexType   index_type;
+    typedef MemorySpace memory_space;
+
+    /*! Number of rows of the product.
+     */
+    size_t num_rows;
+
+    /*! Number of columns of the product.
+     */
+    size_t num_cols;
+
+    /*! Number of entries of the product.
+     */
+    size_t num_entries;
+
+    /*! Number of entries of A the plan was built for.
+     */
+    size_t A_num_entries;
+
+    /*! Number of entries of B the plan was built for.
+     */
+    size_t B_num_entries;
+
+    /*! Row offsets of the product.
+     */
+    cusp::array1d<IndexType, MemorySpace> row_offsets;
+
+    /*! Column indices of the product.
+     */
+    cusp::array1d<IndexType, MemorySpace> column_indices;
+
+    /*! Construct an empty plan.
+     */
+    spgemm_plan(void)
+        : num_rows(0), num_cols(0), num_entries(0), A_num_entries(0), B_num_entries(0) {}
+};
+
+/*! \p spgemm_symbolic : computes the sparsity pattern of <tt>C = A * B</tt>
+ *
+ * \param A input CSR matrix
+ * \param B input CSR matrix
+ * \param plan the pattern of the product
+ *
+ * \tparam Matrix1 \p csr_matrix or \p csr_matrix_view
+ * \tparam Matrix2 \p csr_matrix or \p csr_matrix_view
+ * \tparam IndexType index type of the plan
+ * \tparam MemorySpace memory space of A, B and the plan
+ */
+template <typename Matrix1,
+          typename Matrix2,
+          typename IndexType,
+          typename MemorySpace>
+void spgemm_symbolic(const Matrix1& A,
+                     const Matrix2& B,
+                     cusp::spgemm_plan<IndexType, MemorySpace>& plan);
+
+/*! \p spgemm_numeric : computes <tt>C = A * B</tt> with the sparsity
+ *  pattern of \p plan.
+ *
+ *  A and B must have the sparsity patterns \p spgemm_symbolic was called
+ *  with; only their values may differ.  When C already has the size of
+ *  the product no memory is allocated and no sorting is performed.
+ *
+ * \param A input CSR matrix
+ * \param B input CSR matrix
+ * \param plan pattern computed by \p spgemm_symbolic
+ * \param C output CSR matrix
+ *
+ * \tparam Matrix1 \p csr_matrix or \p csr_matrix_view
+ * \tparam Matrix2 \p csr_matrix or \p csr_matrix_view
+ * \tparam Matrix3 \p csr_matrix
+ *
+ *  The following code snippet forms a Galerkin product whose values are
+ *  updated in a loop.
+ *
+ *  \code
+ *  #include <cusp/spgemm.h>
+ *  #include <cusp/csr_matrix.h>
+ *
+ *  ...
+ *
+ *  cusp::spgemm_plan<int, cusp::device_memory> AP_plan, RAP_plan;
+ *  cusp::csr_matrix<int, float, cusp::device_memory> AP, RAP;
+ *
+ *  cusp::spgemm_symbolic(A, P, AP_plan);
+ *  cusp::spgemm_numeric (A, P, AP_plan, AP);
+ *  cusp::spgemm_symbolic(R, AP, RAP_plan);
+ *
+ *  for (int step = 0; step < num_steps; step++)
+ *  {
+ *      // ... update the values of A
+ *
+ *      cusp::spgemm_numeric(A, P,  AP_plan,  AP);
+ *      cusp::spgemm_numeric(R, AP, RAP_plan, RAP);
+ *  }
+ *  \endcode
+ *
+ *  \throws cusp::invalid_input_exception if the dimensions of A or B do
+ *  not match the plan.
+ */
+template <typename Matrix1,
+          typename Matrix2,
+          typename IndexType,
+          typename MemorySpace,
+          typename Matrix3>
+void spgemm_numeric(const Matrix1& A,
+                    const Matrix2& B,
+                    const cusp::spgemm_plan<IndexType, MemorySpace>& plan,
+                          Matrix3& C);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/spgemm.inl>
+
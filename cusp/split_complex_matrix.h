@@ -0,0 +1,177 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file split_complex_matrix.h
+ *  \brief Complex matrix with separate arrays of real and imaginary parts.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/complex.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/format.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/detail/matrix_base.h>
+
+namespace cusp
+{
+namespace detail
+{
+
+// the container of the same format with complex values
+template <typename Matrix> struct complex_matrix_type;
+
+template <typename IndexType, typename RealType, class MemorySpace>
+struct complex_matrix_type< cusp::csr_matrix<IndexType,RealType,MemorySpace> >
+{ typedef cusp::csr_matrix<IndexType,cusp::complex<RealType>,MemorySpace> type; };
+
+template <typename IndexType, typename RealType, class MemorySpace>
+struct complex_matrix_type< cusp::ell_matrix<IndexType,RealType,MemorySpace> >
+{ typedef cusp::ell_matrix<IndexType,cusp::complex<RealType>,MemorySpace> type; };
+
+template <typename IndexType, typename RealType, class MemorySpace>
+struct complex_matrix_type< cusp::hyb_matrix<IndexType,RealType,MemorySpace> >
+{ typedef cusp::hyb_matrix<IndexType,cusp::complex<RealType>,MemorySpace> type; };
+
+} // end namespace detail
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p split_complex_matrix : complex matrix container that stores the
+ *  real and imaginary parts of its values in separate arrays
+ *
+ *  The matrix <tt>A = B + i C</tt> is stored as the real \p csr_matrix,
+ *  \p ell_matrix or \p hyb_matrix \p real, which holds the sparsity
+ *  pattern and \c B, and the array \p imag, which holds the entries of
+ *  \c C in the storage order of the values of \p real.  For a
+ *  \p hyb_matrix the imaginary parts of the ELL portion, padding included,
+ *  precede those of the COO portion.
+ *
+ *  The SpMV kernels of a \p split_complex_matrix load the two parts with
+ *  unit stride and accumulate the real and imaginary parts of each row in
+ *  real arithmetic, rather than loading and multiplying structures of two
+ *  values.  The vectors of a product hold \c cusp::complex values.
+ *
+ * \tparam Matrix \p csr_matrix, \p ell_matrix or \p hyb_matrix with real values.
+ *
+ *  \code
+ *  #include <cusp/split_complex_matrix.h>
+ *  #include <cusp/multiply.h>
+ *  ...
+ *  cusp::hyb_matrix<int, cusp::complex<double>, cusp::device_memory> A = ...;
+ *
+ *  cusp::split_complex_matrix< cusp::hyb_matrix<int, double, cusp::device_memory> > B(A);
+ *
+ *  cusp::multiply(B, x, y);
+ *  \endcode
+ */
+template <typename Matrix>
+class split_complex_matrix
+  : public detail::matrix_base<typename Matrix::index_type,
+                               cusp::complex<typename Matrix::value_type>,
+                               typename Matrix::memory_space,
+                               cusp::split_complex_format>
+{
+  typedef cusp::detail::matrix_base<typename Matrix::index_type,
+                                    cusp::complex<typename Matrix::value_type>,
+                                    typename Matrix::memory_space,
+                                    cusp::split_complex_format> Parent;
+  public:
+    /*! rebind matrix to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::split_complex_matrix<typename Matrix::template rebind<MemorySpace2>::type> type; };
+
+    /*! type of the real parts and the sparsity pattern
+     */
+    typedef Matrix real_matrix_type;
+
+    /*! type of the real and imaginary parts
+     */
+    typedef typename Matrix::value_type real_type;
+
+    /*! type of the array of imaginary parts
+     */
+    typedef typename cusp::array1d<real_type, typename Matrix::memory_space> imag_array_type;
+
+    /*! container of the same format with \c cusp::complex values
+     */
+    typedef typename cusp::detail::complex_matrix_type<Matrix>::type complex_matrix_type;
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::split_complex_matrix<Matrix> container;
+
+    /*! The sparsity pattern and real parts.
+     */
+    real_matrix_type real;
+
+    /*! The imaginary parts, in the storage order of the values of \p real.
+     */
+    imag_array_type imag;
+
+    /*! Construct an empty \p split_complex_matrix.
+     */
+    split_complex_matrix() {}
+
+    /*! Construct a \p split_complex_matrix from another matrix.
+     *  \param matrix A complex sparse or dense matrix, or another
+     *  \p split_complex_matrix.
+     */
+    template <typename MatrixType>
+    split_complex_matrix(const MatrixType& matrix);
+
+    /*! Swap the contents of two \p split_complex_matrix objects.
+     *  \param matrix Another \p split_complex_matrix of the same type.
+     */
+    void swap(split_complex_matrix& matrix)
+    {
+      Parent::swap(matrix);
+      real.swap(matrix.real);
+      imag.swap(matrix.imag);
+    }
+
+    /*! Assignment from another matrix.
+     *  \param matrix A complex sparse or dense matrix, or another
+     *  \p split_complex_matrix.
+     */
+    template <typename MatrixType>
+    split_complex_matrix& operator=(const MatrixType& matrix);
+
+    /*! Store this matrix, with its parts combined into \c cusp::complex
+     *  values, in another matrix.
+     *  \param matrix A complex sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    void merge(MatrixType& matrix) const;
+}; // class split_complex_matrix
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/split_complex_matrix.inl>
@@ -0,0 +1,107 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file stream.h
+ *  \brief Select the CUDA stream used by Cusp algorithms
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/detail/stream.h>
+
+namespace cusp
+{
+
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p current_stream : the CUDA stream on which the calling host thread
+ *  issues Cusp device work.
+ */
+inline cudaStream_t current_stream(void)
+{
+    return cusp::detail::current_stream();
+}
+
+/*! \p scoped_stream : issue all Cusp device work of the calling host
+ *  thread on a given CUDA stream for the lifetime of the object.
+ *
+ *  The previous stream is restored on destruction, so scopes may be
+ *  nested.  Each host thread has its own current stream.
+ *
+ *  \note Kernels launched by Cusp always honor the stream.  Thrust
+ *  algorithms (e.g. the reductions in \p cusp::blas) honor the stream
+ *  with Thrust v1.8 and newer and use the default stream otherwise.
+ *  Results returned to the host (e.g. \p cusp::blas::dot) synchronize
+ *  with the stream.
+ *
+ *  Cusp keeps no global state that would require the calls of different
+ *  host threads to be serialized: the current stream, the profiler
+ *  scopes and the temporary arenas are per thread, the caching pool and
+ *  the caches held by containers are guarded, and one-time device
+ *  queries are initialized once (see cusp/detail/mutex.h).  Hence \p cusp::multiply, \p cusp::blas
+ *  and the \p cusp::krylov solvers may be called concurrently from
+ *  several host threads, each on its own stream, also with a shared
+ *  (const) matrix.  Objects that are modified by a call, such as the
+ *  vectors of a solve, monitors, preconditioners and solvers with a
+ *  persistent workspace, must not be shared between concurrent calls.
+ *
+ *  The following code snippet demonstrates how to use \p scoped_stream
+ *  to run two independent solves concurrently.
+ *
+ *  \code
+ *  cudaStream_t s1, s2;
+ *  cudaStreamCreate(&s1);
+ *  cudaStreamCreate(&s2);
+ *
+ *  {
+ *      cusp::scoped_stream scope(s1);
+ *      cusp::multiply(A1, x1, y1);     // issued on s1
+ *  }
+ *
+ *  // equivalently
+ *  cusp::multiply(A2, x2, y2, s2);     // issued on s2
+ *  \endcode
+ */
+class scoped_stream
+{
+    public:
+    explicit scoped_stream(cudaStream_t stream)
+        : previous(cusp::detail::current_stream())
+    {
+        cusp::detail::set_current_stream(stream);
+    }
+
+    ~scoped_stream(void)
+    {
+        cusp::detail::set_current_stream(previous);
+    }
+
+    private:
+    cudaStream_t previous;
+
+    // not copyable
+    scoped_stream(const scoped_stream&);
+    scoped_stream& operator=(const scoped_stream&);
+};
+/*! \}
+ */
+
+} // end namespace cusp
+
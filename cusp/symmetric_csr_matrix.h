@@ -0,0 +1,189 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file symmetric_csr_matrix.h
+ *  \brief Compressed Sparse Row format for symmetric matrices.
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+#include <cusp/format.h>
+#include <cusp/detail/matrix_base.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_containers Sparse Matrix Containers
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p symmetric_csr_matrix : CSR matrix container for symmetric matrices
+ *
+ * Only the upper triangle, diagonal included, of a symmetric matrix is
+ * stored, in the layout of a \p csr_matrix.  This halves the storage, and
+ * the memory traffic of SpMV, of the matrix.  SpMV applies each stored
+ * off-diagonal entry A(i,j) twice, to y[i] and to y[j].
+ *
+ * Conversions into a \p symmetric_csr_matrix throw a
+ * \p format_conversion_exception if the source is not symmetric.
+ * \p read_matrix_market_file reads MatrixMarket files with "symmetric"
+ * banners directly, without expanding them.
+ *
+ * \tparam IndexType Type used for matrix indices (e.g. \c int).
+ * \tparam ValueType Type used for matrix values (e.g. \c float).
+ * \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ *
+ * \note The \p num_entries of a \p symmetric_csr_matrix is the number of
+ *  entries of the full matrix, \p num_stored_entries() the number of
+ *  entries in the upper triangle.
+ * \note The column indices of each row must be greater than or equal to
+ *  the row index.
+ *
+ *  \code
+ *  #include <cusp/symmetric_csr_matrix.h>
+ *  ...
+ *
+ *  // allocate storage for (3,3) matrix with 7 nonzeros, 5 of them stored
+ *  cusp::symmetric_csr_matrix<int,float,cusp::host_memory> A(3, 3, 7, 5);
+ *
+ *  // Initialize A to represent the following matrix
+ *  // [ 4 -1  0]
+ *  // [-1  4 -1]
+ *  // [ 0 -1  4]
+ *
+ *  A.row_offsets[0] = 0;  // first offset is always zero
+ *  A.row_offsets[1] = 2;
+ *  A.row_offsets[2] = 4;
+ *  A.row_offsets[3] = 5;  // last offset is always num_stored_entries
+ *
+ *  A.column_indices[0] = 0; A.values[0] =  4;
+ *  A.column_indices[1] = 1; A.values[1] = -1;
+ *  A.column_indices[2] = 1; A.values[2] =  4;
+ *  A.column_indices[3] = 2; A.values[3] = -1;
+ *  A.column_indices[4] = 2; A.values[4] =  4;
+ *  \endcode
+ *
+ *  \see \p csr_matrix
+ */
+template <typename IndexType, typename ValueType, class MemorySpace>
+class symmetric_csr_matrix : public detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::symmetric_csr_format>
+{
+  typedef cusp::detail::matrix_base<IndexType,ValueType,MemorySpace,cusp::symmetric_csr_format> Parent;
+  public:
+    /*! rebind matrix to a different MemorySpace
+     */
+    template<typename MemorySpace2>
+    struct rebind { typedef cusp::symmetric_csr_matrix<IndexType, ValueType, MemorySpace2> type; };
+
+    /*! type of row offsets indices array
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> row_offsets_array_type;
+
+    /*! type of column indices array
+     */
+    typedef typename cusp::array1d<IndexType, MemorySpace> column_indices_array_type;
+
+    /*! type of values array
+     */
+    typedef typename cusp::array1d<ValueType, MemorySpace> values_array_type;
+
+    /*! equivalent container type
+     */
+    typedef typename cusp::symmetric_csr_matrix<IndexType, ValueType, MemorySpace> container;
+
+    /*! Storage for the row offsets of the upper triangle.
+     */
+    row_offsets_array_type row_offsets;
+
+    /*! Storage for the column indices of the upper triangle.
+     */
+    column_indices_array_type column_indices;
+
+    /*! Storage for the values of the upper triangle.
+     */
+    values_array_type values;
+
+    /*! Construct an empty \p symmetric_csr_matrix.
+     */
+    symmetric_csr_matrix() {}
+
+    /*! Construct a \p symmetric_csr_matrix with a specific shape and number
+     *  of nonzero entries.
+     *
+     *  \param num_rows Number of rows.
+     *  \param num_cols Number of columns.
+     *  \param num_entries Number of nonzero entries of the full matrix.
+     *  \param num_stored_entries Number of nonzero entries in the upper triangle.
+     */
+    symmetric_csr_matrix(size_t num_rows, size_t num_cols, size_t num_entries, size_t num_stored_entries)
+      : Parent(num_rows, num_cols, num_entries),
+        row_offsets(num_rows + 1),
+        column_indices(num_stored_entries),
+        values(num_stored_entries) {}
+
+    /*! Construct a \p symmetric_csr_matrix from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    symmetric_csr_matrix(const MatrixType& matrix);
+
+    /*! Number of entries in the upper triangle.
+     */
+    size_t num_stored_entries(void) const { return values.size(); }
+
+    /*! Resize matrix dimensions and underlying storage
+     */
+    void resize(size_t num_rows, size_t num_cols, size_t num_entries, size_t num_stored_entries)
+    {
+      Parent::resize(num_rows, num_cols, num_entries);
+      row_offsets.resize(num_rows + 1);
+      column_indices.resize(num_stored_entries);
+      values.resize(num_stored_entries);
+    }
+
+    /*! Swap the contents of two \p symmetric_csr_matrix objects.
+     *
+     *  \param matrix Another \p symmetric_csr_matrix with the same IndexType and ValueType.
+     */
+    void swap(symmetric_csr_matrix& matrix)
+    {
+      Parent::swap(matrix);
+      row_offsets.swap(matrix.row_offsets);
+      column_indices.swap(matrix.column_indices);
+      values.swap(matrix.values);
+    }
+
+    /*! Assignment from another matrix.
+     *
+     *  \param matrix Another sparse or dense matrix.
+     */
+    template <typename MatrixType>
+    symmetric_csr_matrix& operator=(const MatrixType& matrix);
+}; // class symmetric_csr_matrix
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/symmetric_csr_matrix.inl>
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file transpose_view.h
+ *  \brief Transpose of a matrix without storage
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/format.h>
+#include <cusp/detail/matrix_base.h>
+
+namespace cusp
+{
+
+/*! \addtogroup sparse_matrices Sparse Matrices
+ */
+
+/*! \addtogroup sparse_matrix_views Sparse Matrix Views
+ *  \ingroup sparse_matrices
+ *  \{
+ */
+
+/*! \p transpose_matrix_view : the transpose of a matrix, referencing the
+ *  storage of the matrix.
+ *
+ *  A \p transpose_matrix_view of a \p csr_matrix is the matrix interpreted
+ *  in CSC format.  \p multiply with the view computes A^T x with
+ *  \p multiply_transpose, and \p multiply_transpose with the view computes
+ *  A x, so algorithms that need the transpose of a matrix (e.g. \p bicg)
+ *  can be given the view instead of a copy produced by \p transpose.
+ *  \p transpose of the view copies the referenced matrix.
+ *
+ * \tparam MatrixType Type of the referenced matrix, dense or sparse.
+ *
+ * \note The referenced matrix must outlive the view.
+ *
+ *  \code
+ *  #include <cusp/transpose_view.h>
+ *  #include <cusp/multiply.h>
+ *  ...
+ *
+ *  cusp::csr_matrix<int,float,cusp::device_memory> A;
+ *  ...
+ *
+ *  // y = A^T x
+ *  cusp::transpose_matrix_view< cusp::csr_matrix<int,float,cusp::device_memory> > At(A);
+ *  cusp::multiply(At, x, y);
+ *  \endcode
+ *
+ *  \see \p transpose_view
+ */
+template <typename MatrixType>
+class transpose_matrix_view
+  : public cusp::detail::matrix_base<typename MatrixType::index_type,
+                                     typename MatrixType::value_type,
+                                     typename MatrixType::memory_space,
+                                     cusp::transpose_format>
+{
+  typedef cusp::detail::matrix_base<typename MatrixType::index_type,
+                                    typename MatrixType::value_type,
+                                    typename MatrixType::memory_space,
+                                    cusp::transpose_format> Parent;
+  public:
+    /*! type of the referenced matrix
+     */
+    typedef MatrixType matrix_type;
+
+    /*! The referenced matrix.
+     */
+    const MatrixType& matrix;
+
+    /*! Construct the transpose of a matrix.
+     *
+     *  \param matrix The matrix to transpose.
+     */
+    transpose_matrix_view(const MatrixType& matrix)
+      : Parent(matrix.num_cols, matrix.num_rows, matrix.num_entries),
+        matrix(matrix) {}
+}; // class transpose_matrix_view
+
+/*! \p transpose_view : returns a \p transpose_matrix_view of a matrix
+ *
+ * \param A The matrix to transpose, which must outlive the view.
+ */
+template <typename MatrixType>
+transpose_matrix_view<MatrixType>
+transpose_view(const MatrixType& A)
+{
+  return transpose_matrix_view<MatrixType>(A);
+}
+/*! \}
+ */
+
+} // end namespace cusp
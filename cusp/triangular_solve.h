@@ -0,0 +1,216 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file triangular_solve.h
+ *  \brief Sparse triangular solve with a reusable analysis
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+
+namespace cusp
+{
+
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p triangular_solve_plan : the analysis of a sparse triangular matrix,
+ *  computed by \p triangular_solve_analyze and used by \p triangular_solve
+ *  to solve with the matrix any number of times.
+ *
+ *  The rows are grouped into levels such that the rows of a level only
+ *  depend on the rows of earlier levels.  The solve processes the levels
+ *  one after the other with one thread per row.  When the levels hold few
+ *  rows on average (e.g. a chain of dependencies as in a tridiagonal
+ *  matrix) the rows are solved in order by a single thread instead, which
+ *  saves one kernel launch per level.  In host memory the rows are always
+ *  solved in order.
+ *
+ *  \tparam IndexType Type used for matrix indices (e.g. \c int).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or cusp::device_memory)
+ */
+template <typename IndexType, typename MemorySpace>
+class triangular_solve_plan
+{
+    public:
+    typedef IndexType   index_type;
+    typedef MemorySpace memory_space;
+
+    enum algorithm_type { level_scheduled, sequential };
+
+    /*! Number of rows of the matrix.
+     */
+    size_t num_rows;
+
+    /*! Number of entries of the matrix the plan was built for.
+     */
+    size_t num_entries;
+
+    /*! Whether the lower or the upper triangle is solved with.
+     */
+    bool lower;
+
+    /*! Whether the diagonal is taken to be the identity.
+     */
+    bool unit;
+
+    /*! Algorithm selected by the analysis.
+     */
+    algorithm_type algorithm;
+
+    /*! Number of rows of the largest level.
+     */
+    size_t max_level_size;
+
+    /*! Range of the entries of each row strictly inside the triangle.
+     */
+    cusp::array1d<IndexType, MemorySpace> row_begin;
+    cusp::array1d<IndexType, MemorySpace> row_end;
+
+    /*! Position of the diagonal entry of each row, empty when \p unit.
+     */
+    cusp::array1d<IndexType, MemorySpace> diagonal_positions;
+
+    /*! Rows ordered by level.
+     */
+    cusp::array1d<IndexType, MemorySpace> rows;
+
+    /*! Offsets of the levels in \p rows.
+     */
+    cusp::array1d<IndexType, cusp::host_memory> level_offsets;
+
+    /*! Construct an empty plan.
+     */
+    triangular_solve_plan(void)
+        : num_rows(0), num_entries(0), lower(true), unit(false), algorithm(level_scheduled), max_level_size(0) {}
+
+    /*! Number of levels of the matrix.
+     */
+    size_t num_levels(void) const { return level_offsets.empty() ? 0 : level_offsets.size() - 1; }
+};
+
+/*! \p triangular_solve_analyze : analyzes the lower or upper triangle of
+ *  a square CSR matrix for \p triangular_solve.
+ *
+ *  Only the entries of the selected triangle are used: further entries,
+ *  such as the upper triangle of a matrix that stores both factors of an
+ *  LU factorization, are ignored.  The column indices of every row must
+ *  be sorted.  Unless \p unit is \c true every row must store its diagonal
+ *  entry.
+ *
+ * \param T input CSR matrix
+ * \param plan the analysis of \p T
+ * \param lower solve with the lower (\c true) or upper (\c false) triangle
+ * \param unit take the diagonal to be the identity
+ *
+ * \tparam Matrix \p csr_matrix or \p csr_matrix_view
+ * \tparam IndexType index type of the plan
+ * \tparam MemorySpace memory space of T and the plan
+ *
+ *  \throws cusp::invalid_input_exception if T is not square, its column
+ *  indices are not sorted or a required diagonal entry is missing.
+ */
+template <typename Matrix,
+          typename IndexType,
+          typename MemorySpace>
+void triangular_solve_analyze(const Matrix& T,
+                              cusp::triangular_solve_plan<IndexType, MemorySpace>& plan,
+                              const bool lower,
+                              const bool unit = false);
+
+/*! \p triangular_solve : solves <tt>T x = b</tt> with the triangle of
+ *  \p T analyzed by \p triangular_solve_analyze.
+ *
+ *  T must have the sparsity pattern the plan was computed for; only its
+ *  values may differ.  \p x may alias \p b.
+ *
+ * \param T input CSR matrix
+ * \param plan analysis computed by \p triangular_solve_analyze
+ * \param b right-hand side
+ * \param x solution
+ *
+ * \tparam Matrix \p csr_matrix or \p csr_matrix_view
+ * \tparam Array1 array
+ * \tparam Array2 array
+ *
+ *  \code
+ *  #include <cusp/triangular_solve.h>
+ *  #include <cusp/csr_matrix.h>
+ *
+ *  ...
+ *
+ *  cusp::triangular_solve_plan<int, cusp::device_memory> plan;
+ *  cusp::triangular_solve_analyze(L, plan, true);
+ *
+ *  for (int step = 0; step < num_steps; step++)
+ *  {
+ *      // ... update b
+ *
+ *      cusp::triangular_solve(L, plan, b, x);
+ *  }
+ *  \endcode
+ *
+ *  \throws cusp::invalid_input_exception if the dimensions of T, b or x
+ *  do not match the plan.
+ */
+template <typename Matrix,
+          typename IndexType,
+          typename MemorySpace,
+          typename Array1,
+          typename Array2>
+void triangular_solve(const Matrix& T,
+                      const cusp::triangular_solve_plan<IndexType, MemorySpace>& plan,
+                      const Array1& b,
+                            Array2& x);
+
+/*! \p triangular_solve : solves <tt>T x = b</tt> with the lower or upper
+ *  triangle of \p T.  Equivalent to \p triangular_solve_analyze followed
+ *  by one \p triangular_solve.  On the device, with the \p cusparse_engine
+ *  (see \p sparse_engine.h), cuSPARSE analyses and solves instead, which
+ *  does not check that the diagonal entries are present.
+ *
+ * \param T input CSR matrix
+ * \param b right-hand side
+ * \param x solution
+ * \param lower solve with the lower (\c true) or upper (\c false) triangle
+ * \param unit take the diagonal to be the identity
+ *
+ * \tparam Matrix \p csr_matrix or \p csr_matrix_view
+ * \tparam Array1 array
+ * \tparam Array2 array
+ */
+template <typename Matrix,
+          typename Array1,
+          typename Array2>
+void triangular_solve(const Matrix& T,
+                      const Array1& b,
+                            Array2& x,
+                      const bool lower,
+                      const bool unit = false);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/triangular_solve.inl>
+
@@ -0,0 +1,127 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file update_values.h
+ *  \brief Refresh the values of a converted matrix with a fixed pattern
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+
+/*! \addtogroup algorithms Algorithms
+ *  \ingroup algorithms
+ *  \{
+ */
+
+/*! \p value_permutation : position in the values of a source matrix of
+ *  each stored value of a matrix converted from it.
+ *
+ *  The stored values of the destination are taken in the order of its
+ *  value arrays: \c values of a \p coo_matrix or \p csr_matrix, the
+ *  padded \c values.values of an \p ell_matrix or \p dia_matrix, and
+ *  \c ell.values.values followed by \c coo.values for a \p hyb_matrix.
+ *  Padding is marked by -1.
+ *
+ *  \tparam IndexType Type used for indices (e.g. \c int).
+ *  \tparam MemorySpace A memory space (e.g. \c cusp::host_memory or \c cusp::device_memory)
+ *
+ *  \see \p update_values
+ */
+template <typename IndexType, class MemorySpace>
+class value_permutation
+{
+    public:
+
+    /*! source index of each stored destination value, or -1
+     */
+    cusp::array1d<IndexType,MemorySpace> indices;
+
+    /*! number of values of the source matrix
+     */
+    size_t num_source_values;
+
+    value_permutation(void) : num_source_values(0) {}
+};
+
+/*! \p convert : convert between matrix formats and record where each
+ *  value of the destination comes from
+ *
+ *  \param src source \p csr_matrix or \p coo_matrix
+ *  \param dst destination \p coo_matrix, \p csr_matrix, \p dia_matrix,
+ *  \p ell_matrix or \p hyb_matrix
+ *  \param permutation output map from the values of \p dst to the values
+ *  of \p src
+ *
+ *  The map depends only on the pattern of \p src, so it stays valid as
+ *  long as the pattern is unchanged.
+ *
+ *  \see \p update_values
+ */
+template <typename SourceType, typename DestinationType, typename IndexType, class MemorySpace>
+void convert(const SourceType& src, DestinationType& dst,
+             cusp::value_permutation<IndexType,MemorySpace>& permutation);
+
+/*! \p update_values : refresh the values of a converted matrix
+ *
+ *  Equivalent to <tt>cusp::convert(src, dst)</tt> for a source matrix
+ *  with the pattern recorded in \p permutation and the values
+ *  \p src_values, at the cost of a single gather instead of a
+ *  conversion.
+ *
+ *  \param dst matrix converted with \p permutation
+ *  \param src_values new values of the source matrix, in the memory
+ *  space of \p dst
+ *  \param permutation map recorded by \p convert
+ *
+ *  \throws cusp::invalid_input_exception when the sizes of \p dst or
+ *  \p src_values do not match \p permutation
+ *
+ *  \code
+ *  #include <cusp/csr_matrix.h>
+ *  #include <cusp/hyb_matrix.h>
+ *  #include <cusp/update_values.h>
+ *  ...
+ *
+ *  cusp::csr_matrix<int,float,cusp::device_memory> A;
+ *  cusp::hyb_matrix<int,float,cusp::device_memory> H;
+ *  cusp::value_permutation<int,cusp::device_memory> permutation;
+ *
+ *  // convert once, keeping the map of the values
+ *  cusp::convert(A, H, permutation);
+ *
+ *  // after each update of A.values
+ *  cusp::update_values(H, A.values, permutation);
+ *  \endcode
+ */
+template <typename DestinationType, typename Array, typename IndexType, class MemorySpace>
+void update_values(DestinationType& dst, const Array& src_values,
+                   const cusp::value_permutation<IndexType,MemorySpace>& permutation);
+
+/*! \}
+ */
+
+} // end namespace cusp
+
+#include <cusp/detail/update_values.inl>
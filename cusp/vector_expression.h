@@ -0,0 +1,342 @@
+/*
+ *  Copyright 2008-2009 NVIDIA Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file vector_expression.h
+ *  \brief Lazily evaluated arithmetic expressions of vectors
+ */
+
+#pragma once
+
+#include <cusp/detail/config.h>
+
+#include <cusp/array1d.h>
+
+#include <thrust/functional.h>
+#include <thrust/tuple.h>
+#include <thrust/detail/type_traits.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include <cstddef>
+
+namespace cusp
+{
+namespace blas
+{
+namespace detail
+{
+
+// y = alpha * x
+template <typename T>
+struct scale_by : public thrust::unary_function<T,T>
+{
+    T alpha;
+
+    scale_by(const T alpha) : alpha(alpha) {}
+
+    __host__ __device__
+    T operator()(const T x) const
+    {
+        return alpha * x;
+    }
+};
+
+// applies a binary function to the elements of a zipped pair
+template <typename BinaryFunction>
+struct zipped_binary_function
+    : public thrust::unary_function<typename BinaryFunction::first_argument_type,
+                                    typename BinaryFunction::result_type>
+{
+    typedef typename BinaryFunction::result_type result_type;
+
+    BinaryFunction f;
+
+    zipped_binary_function(BinaryFunction f) : f(f) {}
+
+    template <typename Tuple>
+    __host__ __device__
+    result_type operator()(const Tuple& t) const
+    {
+        return f(thrust::get<0>(t), thrust::get<1>(t));
+    }
+};
+
+} // end namespace detail
+
+/*! \addtogroup blas BLAS
+ *  \{
+ */
+
+/*! \p unary_expression : the elementwise application of a unary function
+ *  to a vector expression.
+ *
+ *  Vector expressions are built by the operators \c +, \c - and \c * of
+ *  \p array1d, \p array1d_view and other expressions with each other and
+ *  with scalars, after including \c <cusp/vector_expression.h>.  An
+ *  expression does not compute anything by itself: it is a view whose
+ *  elements are computed when they are read, so that evaluating an
+ *  expression of any number of vectors, e.g. with \p assign, reads each
+ *  vector once in a single transform of zipped iterators.  Expressions
+ *  may also be passed to the reductions \p dot, \p dotc, \p nrm1,
+ *  \p nrm2 and \p nrmmax.  An expression refers to the storage of its
+ *  vectors, which must outlive it.
+ *
+ *  \code
+ *  #include <cusp/vector_expression.h>
+ *
+ *  // z <- a * x + b * y - c * w in one pass
+ *  cusp::blas::assign(z, a * x + b * y - c * w);
+ *
+ *  // <x - y, x - y> without storing x - y
+ *  float d = cusp::blas::dotc(x - y, x - y);
+ *
+ *  // r <- r - alpha * Ap and rr <- <r,r> in one pass
+ *  float rr = cusp::blas::assign_dotc(r, r - alpha * Ap);
+ *  \endcode
+ */
+template <typename Operand, typename UnaryFunction>
+class unary_expression
+{
+    public:
+    typedef thrust::transform_iterator<UnaryFunction, typename Operand::iterator> iterator;
+    typedef iterator                                                             const_iterator;
+    typedef typename Operand::memory_space                                       memory_space;
+    typedef typename UnaryFunction::result_type                                  value_type;
+    typedef size_t                                                               size_type;
+    typedef cusp::array1d_format                                                 format;
+
+    unary_expression(const Operand& operand, UnaryFunction f)
+        : operand(operand), f(f) {}
+
+    size_type size(void) const { return operand.size(); }
+
+    iterator begin(void) const { return iterator(operand.begin(), f); }
+
+    iterator end(void) const { return begin() + size(); }
+
+    private:
+    Operand operand;
+    UnaryFunction f;
+};
+
+/*! \p binary_expression : the elementwise application of a binary
+ *  function to two vector expressions of the same size.
+ *
+ *  \see unary_expression
+ */
+template <typename Operand1, typename Operand2, typename BinaryFunction>
+class binary_expression
+{
+    typedef thrust::zip_iterator< thrust::tuple<typename Operand1::iterator, typename Operand2::iterator> > zip_iterator;
+    typedef cusp::blas::detail::zipped_binary_function<BinaryFunction>                                    zip_function;
+
+    public:
+    typedef thrust::transform_iterator<zip_function, zip_iterator> iterator;
+    typedef iterator                                              const_iterator;
+    typedef typename Operand1::memory_space                       memory_space;
+    typedef typename BinaryFunction::result_type                  value_type;
+    typedef size_t                                                size_type;
+    typedef cusp::array1d_format                                  format;
+
+    binary_expression(const Operand1& operand1, const Operand2& operand2, BinaryFunction f)
+        : operand1(operand1), operand2(operand2), f(f) {}
+
+    size_type size(void) const { return operand1.size(); }
+
+    iterator begin(void) const
+    {
+        return iterator(zip_iterator(thrust::make_tuple(operand1.begin(), operand2.begin())), zip_function(f));
+    }
+
+    iterator end(void) const { return begin() + size(); }
+
+    private:
+    Operand1 operand1;
+    Operand2 operand2;
+    BinaryFunction f;
+};
+
+/*! \p assign : evaluate a vector expression into an array (z = e)
+ *
+ *  The array may appear in the expression, since every element of the
+ *  result only depends on the elements at the same index.
+ */
+template <typename Array,
+          typename Expression>
+void assign(Array& z,
+            const Expression& e);
+
+/*! \p assign : evaluate a vector expression into an array (z = e)
+ */
+template <typename Array,
+          typename Expression>
+void assign(const Array& z,
+            const Expression& e);
+
+/*! \p assign_dotc : evaluate a vector expression into an array (z = e)
+ *  and return the conjugate dot product of the result with itself
+ *  (conjugate(z)^T * z), in a single pass.
+ */
+template <typename Array,
+          typename Expression>
+typename Array::value_type
+    assign_dotc(const Array& z,
+                const Expression& e);
+
+/*! \p assign_dotc : evaluate a vector expression into an array (z = e)
+ *  and return the conjugate dot product (conjugate(w)^T * z) of the
+ *  result with another vector, in a single pass.  \p w may be \p z.
+ */
+template <typename Array1,
+          typename Expression,
+          typename Array2>
+typename Array1::value_type
+    assign_dotc(const Array1& z,
+                const Expression& e,
+                const Array2& w);
+
+/*! \}
+ */
+
+namespace detail
+{
+
+// the arrays and expressions the operators apply to
+template <typename T>
+struct is_vector_operand : thrust::detail::false_type {};
+
+template <typename T, typename MemorySpace>
+struct is_vector_operand< cusp::array1d<T,MemorySpace> > : thrust::detail::true_type {};
+
+template <typename Iterator>
+struct is_vector_operand< cusp::array1d_view<Iterator> > : thrust::detail::true_type {};
+
+template <typename Operand, typename UnaryFunction>
+struct is_vector_operand< cusp::blas::unary_expression<Operand,UnaryFunction> > : thrust::detail::true_type {};
+
+template <typename Operand1, typename Operand2, typename BinaryFunction>
+struct is_vector_operand< cusp::blas::binary_expression<Operand1,Operand2,BinaryFunction> > : thrust::detail::true_type {};
+
+// operands are stored by value: containers as views of their storage,
+// views and expressions as they are
+template <typename T>
+struct vector_operand
+{
+    typedef T type;
+
+    static type make(const T& x) { return x; }
+};
+
+template <typename T, typename MemorySpace>
+struct vector_operand< cusp::array1d<T,MemorySpace> >
+{
+    typedef typename cusp::array1d<T,MemorySpace>::const_view type;
+
+    static type make(const cusp::array1d<T,MemorySpace>& x) { return type(x); }
+};
+
+// result types of the operators, undefined unless the arguments are operands
+template <typename A, typename B, template <typename> class BinaryFunction,
+          bool = is_vector_operand<A>::value && is_vector_operand<B>::value>
+struct binary_expression_type {};
+
+template <typename A, typename B, template <typename> class BinaryFunction>
+struct binary_expression_type<A,B,BinaryFunction,true>
+{
+    typedef typename vector_operand<A>::type        Operand1;
+    typedef typename vector_operand<B>::type        Operand2;
+    typedef typename Operand1::value_type           ValueType;
+    typedef BinaryFunction<ValueType>               Function;
+    typedef cusp::blas::binary_expression<Operand1, Operand2, Function> type;
+
+    static type make(const A& a, const B& b)
+    {
+        return type(vector_operand<A>::make(a), vector_operand<B>::make(b), Function());
+    }
+};
+
+template <typename A, template <typename> class UnaryFunction,
+          bool = is_vector_operand<A>::value>
+struct unary_expression_type {};
+
+template <typename A, template <typename> class UnaryFunction>
+struct unary_expression_type<A,UnaryFunction,true>
+{
+    typedef typename vector_operand<A>::type               Operand;
+    typedef typename Operand::value_type                   ValueType;
+    typedef UnaryFunction<ValueType>                       Function;
+    typedef cusp::blas::unary_expression<Operand, Function> type;
+
+    static type make(const A& a, const Function& f = Function())
+    {
+        return type(vector_operand<A>::make(a), f);
+    }
+};
+
+template <typename S, typename A,
+          bool = !is_vector_operand<S>::value && is_vector_operand<A>::value>
+struct scaled_expression_type {};
+
+template <typename S, typename A>
+struct scaled_expression_type<S,A,true> : unary_expression_type<A,scale_by> {};
+
+} // end namespace detail
+} // end namespace blas
+
+// The operators are found by argument-dependent lookup through the
+// namespace of the arrays at the leaves of an expression.
+
+template <typename A, typename B>
+typename cusp::blas::detail::binary_expression_type<A,B,thrust::plus>::type
+operator+(const A& a, const B& b)
+{
+    return cusp::blas::detail::binary_expression_type<A,B,thrust::plus>::make(a, b);
+}
+
+template <typename A, typename B>
+typename cusp::blas::detail::binary_expression_type<A,B,thrust::minus>::type
+operator-(const A& a, const B& b)
+{
+    return cusp::blas::detail::binary_expression_type<A,B,thrust::minus>::make(a, b);
+}
+
+template <typename A>
+typename cusp::blas::detail::unary_expression_type<A,thrust::negate>::type
+operator-(const A& a)
+{
+    return cusp::blas::detail::unary_expression_type<A,thrust::negate>::make(a);
+}
+
+template <typename S, typename A>
+typename cusp::blas::detail::scaled_expression_type<S,A>::type
+operator*(const S& alpha, const A& a)
+{
+    typedef cusp::blas::detail::scaled_expression_type<S,A> Expression;
+    return Expression::make(a, typename Expression::Function(typename Expression::ValueType(alpha)));
+}
+
+template <typename A, typename S>
+typename cusp::blas::detail::scaled_expression_type<S,A>::type
+operator*(const A& a, const S& alpha)
+{
+    typedef cusp::blas::detail::scaled_expression_type<S,A> Expression;
+    return Expression::make(a, typename Expression::Function(typename Expression::ValueType(alpha)));
+}
+
+} // end namespace cusp
+
+#include <cusp/detail/vector_expression.inl>
+
@@ -22,17 +22,90 @@
 
 #include <cusp/detail/config.h>
 
+#include <cstddef>
+#include <string>
+
 namespace cusp
 {
 
+/*! \addtogroup utilities Utilities
+ *  \{
+ */
+
+/*! \p matrix_validation : outcome of \p validate_matrix.
+ *
+ * A matrix that violates several requirements reports the first of
+ * them in the order in which they are checked.
+ */
+struct matrix_validation
+{
+    /*! true when \p A satisfies every requirement of its format
+     */
+    bool valid;
+
+    /*! the requirement \p A violates, empty when \p valid
+     */
+    std::string message;
+
+    /*! number of entries that violate the requirement, or the difference
+     *  of the counts that should agree (e.g. the valid entries of an ELL
+     *  matrix and its \p num_entries)
+     */
+    size_t num_violations;
+
+    /*! position of the first violating entry in its array, e.g. the
+     *  index of a column index, or zero when the requirement is not about
+     *  individual entries
+     */
+    size_t first_violation;
+
+    matrix_validation(void) : valid(true), num_violations(0), first_violation(0) {}
+};
+
+/*! \p validate_matrix : check the structure of a matrix.
+ *
+ * The index arrays of \p A are checked where they reside: bounds, order
+ * and the other per-entry requirements of a format are combined into a
+ * single parallel reduction, so that validating a device matrix takes
+ * one synchronization and no copies to the host.
+ *
+ * Requirements checked: the sizes of the arrays and, for
+ * - COO, row and column indices in bounds and rows non-decreasing
+ * - CSR, row offsets from 0 to \p num_entries, non-decreasing, and column
+ *   indices in bounds
+ * - DIA, one column of values per diagonal and enough rows
+ * - ELL, valid column indices in bounds and as many as \p num_entries
+ * - HYB, the shapes and entries of both parts, and the requirements of
+ *   each part
+ *
+ * \code
+ * cusp::matrix_validation report = cusp::validate_matrix(A);
+ *
+ * if (!report.valid)
+ *     std::cerr << report.message << ", the first at position " << report.first_violation << std::endl;
+ * \endcode
+ */
+template <typename MatrixType>
+matrix_validation validate_matrix(const MatrixType& A);
+
+/*! \p is_valid_matrix : true when \p validate_matrix accepts \p A
+ */
 template <typename MatrixType>
 bool is_valid_matrix(const MatrixType& A);
 
+/*! \p is_valid_matrix : as above, and write the violated requirement to
+ *  \p ostream
+ */
 template <typename MatrixType, typename OutputStream>
 bool is_valid_matrix(const MatrixType& A, OutputStream& ostream);
 
+/*! \p assert_is_valid_matrix : throw a \p cusp::format_exception with
+ *  the violated requirement unless \p A is valid
+ */
 template <typename MatrixType>
 void assert_is_valid_matrix(const MatrixType& A);
+/*! \}
+ */
 
 } // end namespace cusp
 
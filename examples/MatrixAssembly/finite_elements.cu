@@ -0,0 +1,43 @@
+#include <cusp/assembler.h>
+#include <cusp/print.h>
+
+// Assemble a matrix from element matrices on a fixed mesh.  The pattern
+// of the matrix and the position of each element entry are computed once,
+// after which each assembly is a scatter-add into the matrix values.
+
+int main(void)
+{
+    // 1d mesh of 4 linear elements on 5 nodes
+    int num_nodes    = 5;
+    int num_elements = 4;
+
+    cusp::array1d<int, cusp::device_memory> connectivity(2 * num_elements);
+
+    for (int e = 0; e < num_elements; e++)
+    {
+        connectivity[2 * e + 0] = e;
+        connectivity[2 * e + 1] = e + 1;
+    }
+
+    cusp::assembler<int, float, cusp::device_memory> assembler(num_nodes, 2, connectivity);
+
+    cusp::csr_matrix<int, float, cusp::device_memory> A;
+
+    cusp::array1d<float, cusp::device_memory> K(4 * num_elements);
+
+    for (int step = 1; step <= 2; step++)
+    {
+        // element stiffness matrices step * [1 -1; -1 1]
+        for (int e = 0; e < num_elements; e++)
+        {
+            K[4 * e + 0] =  step; K[4 * e + 1] = -step;
+            K[4 * e + 2] = -step; K[4 * e + 3] =  step;
+        }
+
+        assembler.assemble(K, A);
+
+        cusp::print(A);
+    }
+
+    return 0;
+}
@@ -0,0 +1,4 @@
+#include <cusp/detail/precompiled.h>
+
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_CONVERT, template, cusp::device_memory)
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_TRANSFER, template, cusp::device_memory)
@@ -0,0 +1,3 @@
+#include <cusp/detail/precompiled.h>
+
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_CONVERT, template, cusp::host_memory)
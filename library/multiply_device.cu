@@ -0,0 +1,4 @@
+#include <cusp/detail/precompiled.h>
+
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_CONTAINERS, template, cusp::device_memory)
+CUSP_PRECOMPILED_TYPES(CUSP_PRECOMPILED_MULTIPLY,   template, cusp::device_memory)
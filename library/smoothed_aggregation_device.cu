@@ -0,0 +1,3 @@
+#include <cusp/detail/precompiled.h>
+
+CUSP_PRECOMPILED_REAL_TYPES(CUSP_PRECOMPILED_AGGREGATION, template, cusp::device_memory)
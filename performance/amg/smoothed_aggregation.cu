@@ -3,6 +3,7 @@
 #include <cusp/gallery/poisson.h>
 #include <cusp/csr_matrix.h>
 
+#include <cstdlib>
 #include <iostream>
 
 #include "../timer.h"
@@ -33,7 +34,7 @@ int main(int argc, char ** argv)
     // create an empty sparse matrix structure
     cusp::coo_matrix<IndexType, ValueType, MemorySpace> A;
 
-    IndexType N = 1024;
+    IndexType N = (argc > 1) ? std::atoi(argv[1]) : 1024;
 
     // create 2D Poisson problem
     cusp::gallery::poisson5pt(A, N, N);
@@ -70,10 +71,18 @@ int main(int argc, char ** argv)
         cusp::default_monitor<ValueType> monitor(b, 1000, 1e-10);
 
         // setup preconditioner
+        cusp::precond::amg_options options;
+        options.collect_timings = true;
+
         timer t0;
-        cusp::precond::smoothed_aggregation<IndexType, ValueType, MemorySpace> M(A);
+        cusp::precond::smoothed_aggregation<IndexType, ValueType, MemorySpace> M(A, options);
         std::cout << "constructed hierarchy in " << t0.milliseconds_elapsed() << " ms " << std::endl;
 
+        // per-level setup times; with CUSP_PROFILE_ENABLED the profile lists
+        // every host <-> device conversion made during the setup
+        M.print();
+        CUSP_PROFILE_DUMP();
+
         // solve
         timer t1;
         cusp::krylov::cg(A, x, b, monitor, M);
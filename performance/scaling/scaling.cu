@@ -0,0 +1,717 @@
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/distributed_array1d.h>
+#include <cusp/distributed_csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/precond/smoothed_aggregation.h>
+#include <cusp/precond/distributed_smoothed_aggregation.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/gallery/random.h>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include <sys/time.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../suite/harness.h"
+
+// Strong and weak scaling of the host-parallel and multi-GPU paths.
+//
+// For each resource (OpenMP threads of the host_memory algorithms, or
+// devices of the distributed matrices) and each number of workers
+// p = 1, 2, 4, ..., max the benchmark times
+//
+//    spmv         y = A x
+//    spgemm       C = A A, host only since there is no multi-device SpGEMM
+//    amg_setup    smoothed aggregation setup
+//    cg           CG preconditioned by smoothed aggregation to 1e-8
+//
+// on gallery problems: poisson7pt, poisson27pt and a random matrix with
+// power-law row lengths (SpMV and SpGEMM only, as it is not SPD).
+// Strong scaling keeps the problem of --rows rows, weak scaling grows it
+// to p times --rows rows.  The parallel efficiency is
+//
+//    strong:  T(1) / (p T(p))
+//    weak:    (T(1) / n(1)) / (T(p) / n(p)) * p
+//
+// where n(p) is the number of rows of the problem with p workers, since
+// the stencil problems grow by whole grid planes.  Every case is timed
+// with the wall clock after synchronizing the devices it runs on, and the
+// results are written as JSON (schema "cusp-scaling/1") and CSV.
+
+typedef int    IndexType;
+typedef double ValueType;
+
+typedef cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> HostMatrix;
+
+typedef std::map<std::string, std::string> ArgumentMap;
+ArgumentMap args;
+
+void process_args(int argc, char ** argv)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+
+        if (arg.substr(0,2) != "--")
+            continue;
+
+        std::string::size_type n = arg.find('=',2);
+
+        if (n == std::string::npos)
+            args[arg.substr(2)] = std::string();              // (key)
+        else
+            args[arg.substr(2, n - 2)] = arg.substr(n + 1);   // (key,value)
+    }
+}
+
+void usage(int argc, char** argv)
+{
+    std::cout << "Usage:\n";
+    std::cout << "\t" << argv[0] << " [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "\t--resources=LIST      comma separated subset of threads,devices (default: both)\n";
+    std::cout << "\t--modes=LIST          comma separated subset of strong,weak (default: both)\n";
+    std::cout << "\t--problems=LIST       subset of poisson7pt,poisson27pt,power_law (default: all)\n";
+    std::cout << "\t--kernels=LIST        subset of spmv,spgemm,amg_setup,cg (default: all)\n";
+    std::cout << "\t--rows=N              rows of the strong problem and per worker of the weak one (default: 262144)\n";
+    std::cout << "\t--max_threads=N       most host threads (default: all OpenMP threads)\n";
+    std::cout << "\t--max_devices=N       most devices (default: all visible devices)\n";
+    std::cout << "\t--warmup=N            untimed runs of each case (default: 1)\n";
+    std::cout << "\t--repetitions=N       timed runs of each case (default: 5)\n";
+    std::cout << "\t--json=FILE           JSON results (default: scaling_results.json)\n";
+    std::cout << "\t--csv=FILE            CSV results (default: scaling_results.csv)\n";
+}
+
+std::set<std::string> selected(const std::string& key, const std::string& all)
+{
+    std::string list = args.count(key) ? args[key] : all;
+    std::set<std::string> items;
+
+    std::istringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        items.insert(item);
+
+    return items;
+}
+
+size_t size_arg(const std::string& key, size_t value)
+{
+    return args.count(key) ? size_t(atol(args[key].c_str())) : value;
+}
+
+// 1, 2, 4, ... and max itself
+std::vector<size_t> worker_counts(size_t max)
+{
+    std::vector<size_t> counts;
+
+    for (size_t p = 1; p < max; p *= 2)
+        counts.push_back(p);
+
+    counts.push_back(std::max<size_t>(1, max));
+
+    return counts;
+}
+
+size_t max_host_threads(void)
+{
+#if defined(_OPENMP)
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+void set_host_threads(size_t num_threads)
+{
+#if defined(_OPENMP)
+    omp_set_num_threads(int(num_threads));
+#endif
+}
+
+size_t max_devices(void)
+{
+    int count = 0;
+
+    if (cudaGetDeviceCount(&count) != cudaSuccess)
+        return 0;
+
+    return count;
+}
+
+////////////
+// Timing
+
+double wall_milliseconds(void)
+{
+    timeval t;
+    gettimeofday(&t, 0);
+    return 1e3 * t.tv_sec + 1e-3 * t.tv_usec;
+}
+
+void synchronize(const std::vector<int>& devices)
+{
+    int current = 0;
+    cudaGetDevice(&current);
+
+    for (size_t i = 0; i < devices.size(); i++)
+    {
+        cudaSetDevice(devices[i]);
+        cudaDeviceSynchronize();
+    }
+
+    cudaSetDevice(current);
+}
+
+// as time_repetitions, with the wall clock so that host work and the
+// work of several devices are timed alike
+template <typename Test>
+statistics time_wall_repetitions(Test& test, const benchmark_options& options, const std::vector<int>& devices)
+{
+    for (size_t i = 0; i < options.warmup; i++)
+    {
+        test.setup();
+        test();
+    }
+    synchronize(devices);
+
+    std::vector<double> samples;
+
+    for (size_t i = 0; i < options.repetitions; i++)
+    {
+        test.setup();
+        synchronize(devices);
+
+        const double start = wall_milliseconds();
+        test();
+        synchronize(devices);
+
+        samples.push_back(wall_milliseconds() - start);
+    }
+
+    return compute_statistics(samples);
+}
+
+/////////////
+// Results
+
+struct scaling_result
+{
+    std::string resource;     // threads or devices
+    std::string mode;         // strong or weak
+    std::string problem;      // poisson7pt, poisson27pt, power_law
+    std::string kernel;       // spmv, spgemm, amg_setup, cg
+    size_t workers;
+    size_t num_rows;
+    size_t num_entries;
+    size_t repetitions;
+    statistics milliseconds;
+    size_t iterations;        // CG iterations, 0 otherwise
+    double speedup;           // T(1) / T(p)
+    double efficiency;        // see above
+    bool   valid;             // false when the case could not be run
+
+    scaling_result(void)
+        : workers(0), num_rows(0), num_entries(0), repetitions(0), iterations(0),
+          speedup(0), efficiency(0), valid(true) {}
+};
+
+scaling_result make_result(const std::string& resource, const std::string& mode, const std::string& problem,
+                           const std::string& kernel, size_t workers, const HostMatrix& A)
+{
+    scaling_result r;
+    r.resource    = resource;
+    r.mode        = mode;
+    r.problem     = problem;
+    r.kernel      = kernel;
+    r.workers     = workers;
+    r.num_rows    = A.num_rows;
+    r.num_entries = A.num_entries;
+    return r;
+}
+
+template <typename Test>
+void run_case(scaling_result& r, Test& test, const benchmark_options& options, const std::vector<int>& devices)
+{
+    r.milliseconds = time_wall_repetitions(test, options, devices);
+    r.repetitions  = options.repetitions;
+
+    printf("  %-7s %-6s %-11s %-9s %3lu %12.4f ms (+- %.4f)\n",
+           r.resource.c_str(), r.mode.c_str(), r.problem.c_str(), r.kernel.c_str(),
+           (unsigned long) r.workers, r.milliseconds.median, r.milliseconds.stddev);
+}
+
+void skip_case(scaling_result& r, const char * reason)
+{
+    printf("  %-7s %-6s %-11s %-9s %3lu skipped: %s\n",
+           r.resource.c_str(), r.mode.c_str(), r.problem.c_str(), r.kernel.c_str(),
+           (unsigned long) r.workers, reason);
+    r.valid = false;
+}
+
+// speedup and efficiency of every case against the single worker case
+// of its series
+void compute_efficiencies(std::vector<scaling_result>& results)
+{
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        scaling_result& r = results[i];
+
+        for (size_t j = 0; j < results.size(); j++)
+        {
+            const scaling_result& base = results[j];
+
+            if (base.workers != 1 || base.resource != r.resource || base.mode != r.mode ||
+                base.problem != r.problem || base.kernel != r.kernel)
+                continue;
+
+            if (!r.valid || !base.valid || r.milliseconds.median <= 0 || base.num_rows == 0)
+                break;
+
+            r.speedup = base.milliseconds.median / r.milliseconds.median;
+
+            if (r.mode == "strong")
+                r.efficiency = r.speedup / r.workers;
+            else
+                r.efficiency = r.speedup * (double(r.num_rows) / double(base.num_rows)) / r.workers;
+
+            break;
+        }
+    }
+}
+
+bool write_json(const std::string& filename,
+                const device_description& device,
+                size_t host_threads,
+                size_t devices,
+                const benchmark_options& options,
+                const std::vector<scaling_result>& results)
+{
+    FILE * fid = fopen(filename.c_str(), "w");
+
+    if (!fid)
+        return false;
+
+    fprintf(fid, "{\n  \"schema\": \"cusp-scaling/1\",\n");
+    fprintf(fid, "  \"device\": {\"name\": %s, \"sm_version\": %d, \"peak_gbytes_per_second\": %.3f},\n",
+            json_string(device.name).c_str(), device.sm_version, device.peak_bandwidth);
+    fprintf(fid, "  \"host_threads\": %lu,\n  \"devices\": %lu,\n",
+            (unsigned long) host_threads, (unsigned long) devices);
+    fprintf(fid, "  \"value_type\": \"double\",\n");
+    fprintf(fid, "  \"warmup\": %lu,\n  \"repetitions\": %lu,\n", (unsigned long) options.warmup, (unsigned long) options.repetitions);
+    fprintf(fid, "  \"results\": [");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const scaling_result& r = results[i];
+
+        fprintf(fid, "%s\n    {\"resource\": %s, \"mode\": %s, \"problem\": %s, \"kernel\": %s, \"workers\": %lu, ", i ? "," : "",
+                json_string(r.resource).c_str(), json_string(r.mode).c_str(),
+                json_string(r.problem).c_str(), json_string(r.kernel).c_str(), (unsigned long) r.workers);
+        fprintf(fid, "\"num_rows\": %lu, \"num_entries\": %lu, \"valid\": %s",
+                (unsigned long) r.num_rows, (unsigned long) r.num_entries, r.valid ? "true" : "false");
+
+        if (r.valid)
+        {
+            fprintf(fid, ",\n     \"repetitions\": %lu, \"milliseconds\": {\"min\": %.6f, \"median\": %.6f, \"mean\": %.6f, \"stddev\": %.6f}",
+                    (unsigned long) r.repetitions, r.milliseconds.min, r.milliseconds.median, r.milliseconds.mean, r.milliseconds.stddev);
+            fprintf(fid, ",\n     \"speedup\": %.6f, \"efficiency\": %.6f, \"iterations\": %lu",
+                    r.speedup, r.efficiency, (unsigned long) r.iterations);
+        }
+
+        fprintf(fid, "}");
+    }
+
+    fprintf(fid, "\n  ]\n}\n");
+    fclose(fid);
+
+    return true;
+}
+
+bool write_csv(const std::string& filename,
+               const device_description& device,
+               const std::vector<scaling_result>& results)
+{
+    FILE * fid = fopen(filename.c_str(), "w");
+
+    if (!fid)
+        return false;
+
+    fprintf(fid, "device,resource,mode,problem,kernel,workers,num_rows,num_entries,valid,repetitions,"
+                 "ms_min,ms_median,ms_mean,ms_stddev,speedup,efficiency,iterations\n");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const scaling_result& r = results[i];
+
+        fprintf(fid, "%s,%s,%s,%s,%s,%lu,%lu,%lu,%d,%lu,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%lu\n",
+                csv_string(device.name).c_str(), r.resource.c_str(), r.mode.c_str(),
+                r.problem.c_str(), r.kernel.c_str(), (unsigned long) r.workers,
+                (unsigned long) r.num_rows, (unsigned long) r.num_entries,
+                r.valid ? 1 : 0, (unsigned long) r.repetitions,
+                r.milliseconds.min, r.milliseconds.median, r.milliseconds.mean, r.milliseconds.stddev,
+                r.speedup, r.efficiency, (unsigned long) r.iterations);
+    }
+
+    fclose(fid);
+
+    return true;
+}
+
+//////////////
+// Problems
+
+// a problem of about num_rows rows; false if it cannot be generated
+bool make_problem(const std::string& problem, size_t num_rows, HostMatrix& A)
+{
+    const size_t n = std::max<size_t>(2, size_t(std::floor(std::pow(double(num_rows), 1.0 / 3.0) + 0.5)));
+
+    try
+    {
+        if (problem == "poisson7pt")
+            cusp::gallery::poisson7pt(A, n, n, n);
+        else if (problem == "poisson27pt")
+            cusp::gallery::poisson27pt(A, n, n, n);
+        else if (problem == "power_law")
+            cusp::gallery::random_power_law(num_rows, num_rows, 16 * num_rows, 0.5, A);
+        else
+            return false;
+    }
+    catch (cusp::invalid_input_exception)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool is_spd(const std::string& problem)
+{
+    return problem != "power_law";
+}
+
+//////////////////
+// Host threads
+
+struct host_spmv_test
+{
+    const HostMatrix& A;
+    cusp::array1d<ValueType, cusp::host_memory> x, y;
+
+    host_spmv_test(const HostMatrix& A) : A(A), x(A.num_cols, ValueType(1)), y(A.num_rows, ValueType(0)) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::multiply(A, x, y); }
+};
+
+struct host_spgemm_test
+{
+    const HostMatrix& A;
+    HostMatrix C;
+
+    host_spgemm_test(const HostMatrix& A) : A(A) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::multiply(A, A, C); }
+};
+
+struct host_amg_setup_test
+{
+    const HostMatrix& A;
+
+    host_amg_setup_test(const HostMatrix& A) : A(A) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::precond::smoothed_aggregation<IndexType, ValueType, cusp::host_memory> M(A); }
+};
+
+template <typename Matrix, typename Preconditioner, typename Array>
+struct cg_test
+{
+    const Matrix& A;
+    Preconditioner& M;
+    Array x, b;
+    size_t iterations;
+
+    cg_test(const Matrix& A, Preconditioner& M)
+        : A(A), M(M), x(A.num_rows, ValueType(0)), b(A.num_rows, ValueType(1)), iterations(0) {}
+
+    // every solve starts from the same initial guess
+    void setup(void) { cusp::blas::fill(x, ValueType(0)); }
+
+    void operator()(void)
+    {
+        cusp::default_monitor<ValueType> monitor(b, 1000, 1e-8);
+        cusp::krylov::cg(A, x, b, monitor, M);
+        iterations = monitor.iteration_count();
+    }
+};
+
+void benchmark_threads(const std::string& mode, const std::string& problem, size_t workers, const HostMatrix& A,
+                       const std::set<std::string>& kernels, const benchmark_options& options,
+                       std::vector<scaling_result>& results)
+{
+    const std::vector<int> no_devices;
+
+    set_host_threads(workers);
+
+    if (kernels.count("spmv"))
+    {
+        scaling_result r = make_result("threads", mode, problem, "spmv", workers, A);
+        host_spmv_test test(A);
+        run_case(r, test, options, no_devices);
+        results.push_back(r);
+    }
+
+    if (kernels.count("spgemm"))
+    {
+        scaling_result r = make_result("threads", mode, problem, "spgemm", workers, A);
+        host_spgemm_test test(A);
+        run_case(r, test, options, no_devices);
+        results.push_back(r);
+    }
+
+    if (kernels.count("amg_setup"))
+    {
+        scaling_result r = make_result("threads", mode, problem, "amg_setup", workers, A);
+        if (is_spd(problem))
+        {
+            host_amg_setup_test test(A);
+            run_case(r, test, options, no_devices);
+        }
+        else
+        {
+            skip_case(r, "not SPD");
+        }
+        results.push_back(r);
+    }
+
+    if (kernels.count("cg"))
+    {
+        typedef cusp::precond::smoothed_aggregation<IndexType, ValueType, cusp::host_memory> Preconditioner;
+        typedef cusp::array1d<ValueType, cusp::host_memory> Array;
+
+        scaling_result r = make_result("threads", mode, problem, "cg", workers, A);
+        if (is_spd(problem))
+        {
+            Preconditioner M(A);
+            cg_test<HostMatrix, Preconditioner, Array> test(A, M);
+            run_case(r, test, options, no_devices);
+            r.iterations = test.iterations;
+        }
+        else
+        {
+            skip_case(r, "not SPD");
+        }
+        results.push_back(r);
+    }
+}
+
+/////////////
+// Devices
+
+typedef cusp::distributed_csr_matrix<IndexType, ValueType, cusp::distributed_memory> DistributedMatrix;
+
+struct device_spmv_test
+{
+    const DistributedMatrix& A;
+    cusp::distributed_array1d<ValueType> x, y;
+
+    // the vectors are distributed like the rows of A
+    device_spmv_test(const DistributedMatrix& A) : A(A), x(A.num_cols, ValueType(1)), y(A.num_rows, ValueType(0)) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::multiply(A, x, y); }
+};
+
+struct device_amg_setup_test
+{
+    const HostMatrix& A;
+    const std::vector<int>& devices;
+
+    device_amg_setup_test(const HostMatrix& A, const std::vector<int>& devices) : A(A), devices(devices) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::precond::distributed_smoothed_aggregation<IndexType, ValueType> M(A, devices); }
+};
+
+void benchmark_devices(const std::string& mode, const std::string& problem, size_t workers, const HostMatrix& A,
+                       const std::set<std::string>& kernels, const benchmark_options& options,
+                       std::vector<scaling_result>& results)
+{
+    std::vector<int> devices;
+    for (size_t i = 0; i < workers; i++)
+        devices.push_back(int(i));
+
+    cudaSetDevice(0);
+
+    if (kernels.count("spmv"))
+    {
+        scaling_result r = make_result("devices", mode, problem, "spmv", workers, A);
+        DistributedMatrix D(A, devices);
+        cusp::scoped_distribution scope(D.get_distribution());
+        device_spmv_test test(D);
+        run_case(r, test, options, devices);
+        results.push_back(r);
+    }
+
+    if (kernels.count("spgemm"))
+    {
+        scaling_result r = make_result("devices", mode, problem, "spgemm", workers, A);
+        skip_case(r, "no multi-device SpGEMM");
+        results.push_back(r);
+    }
+
+    if (kernels.count("amg_setup"))
+    {
+        scaling_result r = make_result("devices", mode, problem, "amg_setup", workers, A);
+        if (is_spd(problem))
+        {
+            device_amg_setup_test test(A, devices);
+            run_case(r, test, options, devices);
+        }
+        else
+        {
+            skip_case(r, "not SPD");
+        }
+        results.push_back(r);
+    }
+
+    if (kernels.count("cg"))
+    {
+        typedef cusp::precond::distributed_smoothed_aggregation<IndexType, ValueType> Preconditioner;
+        typedef cusp::distributed_array1d<ValueType> Array;
+
+        scaling_result r = make_result("devices", mode, problem, "cg", workers, A);
+        if (is_spd(problem))
+        {
+            Preconditioner M(A, devices);
+            cusp::scoped_distribution scope(M.matrix().get_distribution());
+            cg_test<DistributedMatrix, Preconditioner, Array> test(M.matrix(), M);
+            run_case(r, test, options, devices);
+            r.iterations = test.iterations;
+        }
+        else
+        {
+            skip_case(r, "not SPD");
+        }
+        results.push_back(r);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    process_args(argc, argv);
+
+    if (args.count("help"))
+    {
+        usage(argc, argv);
+        return 0;
+    }
+
+    const std::set<std::string> resources = selected("resources", "threads,devices");
+    const std::set<std::string> modes     = selected("modes",     "strong,weak");
+    const std::set<std::string> problems  = selected("problems",  "poisson7pt,poisson27pt,power_law");
+    const std::set<std::string> kernels   = selected("kernels",   "spmv,spgemm,amg_setup,cg");
+
+    const size_t rows = size_arg("rows", 262144);
+
+    benchmark_options options;
+    options.warmup      = size_arg("warmup", 1);
+    options.repetitions = size_arg("repetitions", 5);
+
+    const std::string json_file = args.count("json") ? args["json"] : "scaling_results.json";
+    const std::string csv_file  = args.count("csv")  ? args["csv"]  : "scaling_results.csv";
+
+    // before set_host_threads() lowers the OpenMP default
+    const size_t host_threads = max_host_threads();
+    const size_t num_devices  = max_devices();
+
+    std::map<std::string, size_t> max_workers;
+    max_workers["threads"] = std::min(host_threads, size_arg("max_threads", host_threads));
+    max_workers["devices"] = std::min(num_devices,  size_arg("max_devices", num_devices));
+
+    const device_description device = describe_device();
+
+    std::cout << "Scaling on " << max_workers["threads"] << " host threads and "
+              << max_workers["devices"] << " devices (" << device.name << ")\n\n";
+
+    std::vector<scaling_result> results;
+
+    for (std::set<std::string>::const_iterator resource = resources.begin(); resource != resources.end(); ++resource)
+    {
+        if (!max_workers.count(*resource) || max_workers[*resource] == 0)
+            continue;
+
+        const std::vector<size_t> counts = worker_counts(max_workers[*resource]);
+
+        for (std::set<std::string>::const_iterator mode = modes.begin(); mode != modes.end(); ++mode)
+        {
+            for (std::set<std::string>::const_iterator problem = problems.begin(); problem != problems.end(); ++problem)
+            {
+                HostMatrix A;
+
+                if (*mode == "strong" && !make_problem(*problem, rows, A))
+                {
+                    std::cerr << "ERROR: cannot generate problem \'" << *problem << "\'\n";
+                    continue;
+                }
+
+                for (size_t i = 0; i < counts.size(); i++)
+                {
+                    if (*mode == "weak" && !make_problem(*problem, rows * counts[i], A))
+                    {
+                        std::cerr << "ERROR: cannot generate problem \'" << *problem << "\'\n";
+                        break;
+                    }
+
+                    if (*resource == "threads")
+                        benchmark_threads(*mode, *problem, counts[i], A, kernels, options, results);
+                    else
+                        benchmark_devices(*mode, *problem, counts[i], A, kernels, options, results);
+                }
+            }
+        }
+    }
+
+    // leave the host algorithms with all threads
+    set_host_threads(host_threads);
+
+    compute_efficiencies(results);
+
+    std::cout << "\n resource | mode   | problem     | kernel    | workers | speedup | efficiency\n";
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const scaling_result& r = results[i];
+
+        if (r.valid)
+            printf(" %-8s | %-6s | %-11s | %-9s | %7lu | %7.2f | %9.1f%%\n",
+                   r.resource.c_str(), r.mode.c_str(), r.problem.c_str(), r.kernel.c_str(),
+                   (unsigned long) r.workers, r.speedup, 100.0 * r.efficiency);
+    }
+
+    if (!write_json(json_file, device, host_threads, num_devices, options, results))
+        std::cerr << "ERROR: cannot write " << json_file << "\n";
+    if (!write_csv(csv_file, device, results))
+        std::cerr << "ERROR: cannot write " << csv_file << "\n";
+
+    std::cout << "\nWrote " << json_file << " and " << csv_file << "\n";
+
+    return 0;
+}
@@ -0,0 +1,727 @@
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/monitor.h>
+#include <cusp/stream.h>
+#include <cusp/krylov/bicgstab.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/krylov/gmres.h>
+#include <cusp/precond/ainv.h>
+#include <cusp/precond/diagonal.h>
+#include <cusp/precond/smoothed_aggregation.h>
+
+#include <cusp/detail/device/arch.h>
+#include <cusp/detail/memory_tracker.h>
+#include <cusp/detail/scoped_device.h>
+
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../suite/harness.h"
+#include "../suite/manifest.h"
+
+// Convergence sweep over solver configurations.
+//
+// For each matrix of a manifest every combination of
+//
+//    solver           cg, bicgstab, gmres
+//    preconditioner   diagonal, ainv, smoothed_aggregation
+//    tolerance        relative residual tolerances
+//
+// is solved with b = 1 and x = 0.  A task is one (matrix, preconditioner,
+// solver) triple: the preconditioner is set up once and the solver then
+// runs to each tolerance.  Tasks are handed to a pool of worker threads,
+// each with its own non-blocking stream on one of the selected devices,
+// so that configurations run concurrently.  A matrix is read or generated
+// once and converted to CSR once per device; the copies are shared by all
+// of its tasks and released when the last one finishes.
+//
+// Every record carries the setup and solve times, measured on the host
+// after synchronizing the worker's stream, their sum (time-to-solution),
+// the iterations and the final residual norm.  Records are written as
+// JSON (schema "cusp-sweep/1") and CSV in the order of the tasks,
+// independently of the order in which the workers complete them.
+
+typedef cusp::device_memory MemorySpace;
+
+typedef std::map<std::string, std::string> ArgumentMap;
+ArgumentMap args;
+
+void process_args(int argc, char ** argv)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+
+        if (arg.substr(0,2) != "--")
+            continue;
+
+        std::string::size_type n = arg.find('=',2);
+
+        if (n == std::string::npos)
+            args[arg.substr(2)] = std::string();              // (key)
+        else
+            args[arg.substr(2, n - 2)] = arg.substr(n + 1);   // (key,value)
+    }
+}
+
+void usage(int argc, char** argv)
+{
+    std::cout << "Usage:\n";
+    std::cout << "\t" << argv[0] << " [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "\t--manifest=FILE         matrix collection (default: two Poisson problems)\n";
+    std::cout << "\t--solvers=LIST          comma separated subset of cg,bicgstab,gmres\n";
+    std::cout << "\t--preconditioners=LIST  comma separated subset of diagonal,ainv,smoothed_aggregation\n";
+    std::cout << "\t--tolerances=LIST       relative tolerances (default: 1e-6)\n";
+    std::cout << "\t--max_iterations=N      iteration limit of each solve (default: 1000)\n";
+    std::cout << "\t--restart=N             restart length of gmres (default: 50)\n";
+    std::cout << "\t--value_type=TYPE       float or double (default: double)\n";
+    std::cout << "\t--devices=LIST          CUDA devices (default: 0)\n";
+    std::cout << "\t--workers=N             concurrent configurations (default: 2 per device)\n";
+    std::cout << "\t--json=FILE             JSON results (default: sweep_results.json)\n";
+    std::cout << "\t--csv=FILE              CSV results (default: sweep_results.csv)\n";
+}
+
+std::vector<std::string> split_list(const std::string& list)
+{
+    std::vector<std::string> items;
+
+    std::istringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+
+    return items;
+}
+
+std::vector<std::string> list_argument(const std::string& key, const std::string& default_list)
+{
+    return split_list(args.count(key) ? args[key] : default_list);
+}
+
+bool is_known(const std::string& name, const char * known[], size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        if (name == known[i])
+            return true;
+
+    return false;
+}
+
+// elapsed host time, which includes the synchronizations of the solvers
+class wall_clock
+{
+    double start;
+
+    static double now(void)
+    {
+        timeval t;
+        gettimeofday(&t, 0);
+        return 1e3 * t.tv_sec + 1e-3 * t.tv_usec;
+    }
+
+    public:
+    wall_clock(void) : start(now()) {}
+
+    double milliseconds_elapsed(void) const { return now() - start; }
+};
+
+// wait for the work the calling thread issued on its stream
+inline void synchronize(void)
+{
+    cusp::detail::check_cuda(cudaStreamSynchronize(cusp::current_stream()), "cudaStreamSynchronize failed");
+}
+
+struct sweep_options
+{
+    std::vector<double> tolerances;
+    size_t max_iterations;
+    size_t restart;
+
+    sweep_options(void) : max_iterations(1000), restart(50) {}
+};
+
+struct sweep_task
+{
+    size_t matrix;                // index into the manifest
+    std::string preconditioner;
+    std::string solver;
+};
+
+struct sweep_result
+{
+    std::string matrix;
+    std::string solver;
+    std::string preconditioner;
+    double tolerance;
+    size_t num_rows;
+    size_t num_cols;
+    size_t num_entries;
+    int device;
+    size_t worker;
+    bool valid;                   // false when the configuration failed
+    std::string error;
+    bool converged;
+    size_t iterations;
+    double residual_norm;
+    double setup_ms;              // preconditioner setup, shared by the tolerances of a task
+    double solve_ms;
+
+    sweep_result(void)
+        : tolerance(0), num_rows(0), num_cols(0), num_entries(0), device(0), worker(0),
+          valid(true), converged(false), iterations(0), residual_norm(0), setup_ms(0), solve_ms(0) {}
+
+    double time_to_solution_ms(void) const { return setup_ms + solve_ms; }
+};
+
+// Matrices shared by the tasks.  The host copy is loaded by the first task
+// that needs the matrix and the device copies are converted by the first
+// task on each device.  Each entry has its own lock, so workers loading
+// different matrices do not wait for each other.
+template <typename ValueType>
+class matrix_cache
+{
+    public:
+    typedef cusp::csr_matrix<int, ValueType, cusp::host_memory> HostMatrix;
+    typedef cusp::csr_matrix<int, ValueType, MemorySpace>       DeviceMatrix;
+
+    private:
+    struct entry
+    {
+        cusp::detail::pool_mutex mutex;
+        const manifest_entry * source;
+        HostMatrix * host;
+        std::map<int, DeviceMatrix *> devices;
+        size_t remaining;         // tasks that have not released the matrix
+        std::string error;        // why the matrix could not be loaded
+
+        entry(void) : source(0), host(0), remaining(0) {}
+    };
+
+    std::vector<entry *> entries;
+
+    public:
+    matrix_cache(const std::vector<manifest_entry>& manifest, const std::vector<sweep_task>& tasks)
+        : entries(manifest.size())
+    {
+        for (size_t i = 0; i < manifest.size(); i++)
+        {
+            entries[i] = new entry;
+            entries[i]->source = &manifest[i];
+        }
+
+        for (size_t t = 0; t < tasks.size(); t++)
+            entries[tasks[t].matrix]->remaining++;
+    }
+
+    ~matrix_cache(void)
+    {
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            release_copies(*entries[i]);
+            delete entries[i];
+        }
+    }
+
+    // the copy of the matrix on the calling thread's device
+    const DeviceMatrix& acquire(size_t matrix, int device)
+    {
+        entry& e = *entries[matrix];
+        cusp::detail::pool_lock lock(e.mutex);
+
+        if (!e.error.empty())
+            throw cusp::runtime_exception(e.error);
+
+        if (!e.host)
+        {
+            HostMatrix * host = new HostMatrix;
+
+            try
+            {
+                load_matrix(*e.source, *host);
+            }
+            catch (std::exception& failure)
+            {
+                delete host;
+                e.error = std::string("unable to load matrix: ") + failure.what();
+                throw cusp::runtime_exception(e.error);
+            }
+
+            e.host = host;
+        }
+
+        if (!e.devices.count(device))
+        {
+            DeviceMatrix * A = new DeviceMatrix(*e.host);
+            synchronize(); // before other streams read the copy
+            e.devices[device] = A;
+        }
+
+        return *e.devices[device];
+    }
+
+    void release(size_t matrix)
+    {
+        entry& e = *entries[matrix];
+        cusp::detail::pool_lock lock(e.mutex);
+
+        if (--e.remaining == 0)
+            release_copies(e);
+    }
+
+    private:
+    static void release_copies(entry& e)
+    {
+        delete e.host;
+        e.host = 0;
+
+        for (typename std::map<int, DeviceMatrix *>::iterator i = e.devices.begin(); i != e.devices.end(); ++i)
+        {
+            cusp::detail::scoped_device scope(i->first);
+            delete i->second;
+        }
+        e.devices.clear();
+    }
+};
+
+template <typename ValueType>
+struct sweep_context
+{
+    const std::vector<manifest_entry>& manifest;
+    const std::vector<sweep_task>& tasks;
+    const sweep_options& options;
+    matrix_cache<ValueType> cache;
+
+    cusp::detail::pool_mutex mutex;   // guards next_task and results
+    size_t next_task;
+    std::vector< std::vector<sweep_result> > results;   // by task
+
+    sweep_context(const std::vector<manifest_entry>& manifest,
+                  const std::vector<sweep_task>& tasks,
+                  const sweep_options& options)
+        : manifest(manifest), tasks(tasks), options(options),
+          cache(manifest, tasks), next_task(0), results(tasks.size()) {}
+
+    bool pop(size_t& task)
+    {
+        cusp::detail::pool_lock lock(mutex);
+
+        if (next_task == tasks.size())
+            return false;
+
+        task = next_task++;
+        return true;
+    }
+
+    void record(size_t task, const std::vector<sweep_result>& r)
+    {
+        cusp::detail::pool_lock lock(mutex);
+
+        results[task] = r;
+
+        for (size_t i = 0; i < r.size(); i++)
+        {
+            if (r[i].valid)
+                printf("  %-16s %-20s %-9s tol %8.1e  %s after %5lu iterations  setup %9.2f ms  solve %9.2f ms  (worker %lu)\n",
+                       r[i].matrix.c_str(), r[i].preconditioner.c_str(), r[i].solver.c_str(), r[i].tolerance,
+                       r[i].converged ? "converged" : "diverged ", (unsigned long) r[i].iterations,
+                       r[i].setup_ms, r[i].solve_ms, (unsigned long) r[i].worker);
+            else
+                printf("  %-16s %-20s %-9s tol %8.1e  failed: %s\n",
+                       r[i].matrix.c_str(), r[i].preconditioner.c_str(), r[i].solver.c_str(), r[i].tolerance,
+                       r[i].error.c_str());
+        }
+        fflush(stdout);
+    }
+};
+
+template <typename Matrix, typename Preconditioner>
+void solve(const Matrix& A, Preconditioner& M, const std::string& solver,
+           const sweep_options& options, sweep_result& r)
+{
+    typedef typename Matrix::value_type ValueType;
+
+    cusp::array1d<ValueType, MemorySpace> x(A.num_rows, ValueType(0));
+    cusp::array1d<ValueType, MemorySpace> b(A.num_rows, ValueType(1));
+
+    cusp::default_monitor<ValueType> monitor(b, options.max_iterations, r.tolerance);
+
+    synchronize();
+    wall_clock clock;
+
+    if (solver == "cg")
+        cusp::krylov::cg(A, x, b, monitor, M);
+    else if (solver == "bicgstab")
+        cusp::krylov::bicgstab(A, x, b, monitor, M);
+    else if (solver == "gmres")
+        cusp::krylov::gmres(A, x, b, options.restart, monitor, M);
+    else
+        throw cusp::invalid_input_exception("unknown solver " + solver);
+
+    synchronize();
+
+    r.solve_ms      = clock.milliseconds_elapsed();
+    r.converged     = monitor.converged();
+    r.iterations    = monitor.iteration_count();
+    r.residual_norm = monitor.residual_norm();
+}
+
+template <typename Preconditioner, typename Matrix>
+void setup_and_solve(const Matrix& A, const std::string& solver,
+                     const sweep_options& options, std::vector<sweep_result>& results)
+{
+    wall_clock clock;
+
+    Preconditioner M(A);
+    synchronize();
+
+    const double setup_ms = clock.milliseconds_elapsed();
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        results[i].setup_ms = setup_ms;
+        solve(A, M, solver, options, results[i]);
+    }
+}
+
+template <typename ValueType>
+void run_task(sweep_context<ValueType>& context, size_t t, int device, size_t worker)
+{
+    typedef typename matrix_cache<ValueType>::DeviceMatrix DeviceMatrix;
+
+    const sweep_task& task = context.tasks[t];
+    const std::vector<double>& tolerances = context.options.tolerances;
+
+    std::vector<sweep_result> results(tolerances.size());
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        results[i].matrix         = context.manifest[task.matrix].name;
+        results[i].solver         = task.solver;
+        results[i].preconditioner = task.preconditioner;
+        results[i].tolerance      = tolerances[i];
+        results[i].device         = device;
+        results[i].worker         = worker;
+    }
+
+    try
+    {
+        const DeviceMatrix& A = context.cache.acquire(task.matrix, device);
+
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            results[i].num_rows    = A.num_rows;
+            results[i].num_cols    = A.num_cols;
+            results[i].num_entries = A.num_entries;
+        }
+
+        if (A.num_rows != A.num_cols)
+            throw cusp::invalid_input_exception("matrix is not square");
+
+        if (task.preconditioner == "diagonal")
+            setup_and_solve< cusp::precond::diagonal<ValueType, MemorySpace> >(A, task.solver, context.options, results);
+        else if (task.preconditioner == "ainv")
+            setup_and_solve< cusp::precond::bridson_ainv<ValueType, MemorySpace> >(A, task.solver, context.options, results);
+        else if (task.preconditioner == "smoothed_aggregation")
+            setup_and_solve< cusp::precond::smoothed_aggregation<int, ValueType, MemorySpace> >(A, task.solver, context.options, results);
+        else
+            throw cusp::invalid_input_exception("unknown preconditioner " + task.preconditioner);
+    }
+    catch (std::exception& e)
+    {
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            results[i].valid = false;
+            results[i].error = e.what();
+        }
+    }
+
+    context.cache.release(task.matrix);
+    context.record(t, results);
+}
+
+template <typename ValueType>
+struct worker_state
+{
+    sweep_context<ValueType> * context;
+    int device;
+    size_t id;
+    std::string error;            // why the worker could not start
+};
+
+template <typename ValueType>
+void * run_worker(void * argument)
+{
+    worker_state<ValueType>& w = *static_cast<worker_state<ValueType> *>(argument);
+
+    cudaStream_t stream;
+
+    if (cudaSetDevice(w.device) != cudaSuccess ||
+        cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking) != cudaSuccess)
+    {
+        w.error = "unable to create a stream on the device";
+        return 0;
+    }
+
+    {
+        cusp::scoped_stream scope(stream);
+
+        size_t task;
+        while (w.context->pop(task))
+            run_task(*w.context, task, w.device, w.id);
+    }
+
+    cudaStreamDestroy(stream);
+
+    return 0;
+}
+
+bool write_json(const std::string& filename,
+                const device_description& device,
+                const std::string& value_type,
+                const sweep_options& options,
+                const std::vector<sweep_result>& results)
+{
+    FILE * fid = fopen(filename.c_str(), "w");
+
+    if (!fid)
+        return false;
+
+    fprintf(fid, "{\n  \"schema\": \"cusp-sweep/1\",\n");
+    fprintf(fid, "  \"device\": {\"name\": %s, \"sm_version\": %d},\n", json_string(device.name).c_str(), device.sm_version);
+    fprintf(fid, "  \"value_type\": %s,\n", json_string(value_type).c_str());
+    fprintf(fid, "  \"max_iterations\": %lu,\n  \"restart\": %lu,\n", (unsigned long) options.max_iterations, (unsigned long) options.restart);
+    fprintf(fid, "  \"results\": [");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const sweep_result& r = results[i];
+
+        fprintf(fid, "%s\n    {\"matrix\": %s, \"solver\": %s, \"preconditioner\": %s, \"tolerance\": %.3e, ", i ? "," : "",
+                json_string(r.matrix).c_str(), json_string(r.solver).c_str(), json_string(r.preconditioner).c_str(), r.tolerance);
+        fprintf(fid, "\"num_rows\": %lu, \"num_cols\": %lu, \"num_entries\": %lu, \"device\": %d, \"worker\": %lu, \"valid\": %s",
+                (unsigned long) r.num_rows, (unsigned long) r.num_cols, (unsigned long) r.num_entries,
+                r.device, (unsigned long) r.worker, r.valid ? "true" : "false");
+
+        if (r.valid)
+            fprintf(fid, ",\n     \"converged\": %s, \"iterations\": %lu, \"residual_norm\": %.6e, "
+                         "\"setup_ms\": %.6f, \"solve_ms\": %.6f, \"time_to_solution_ms\": %.6f",
+                    r.converged ? "true" : "false", (unsigned long) r.iterations, r.residual_norm,
+                    r.setup_ms, r.solve_ms, r.time_to_solution_ms());
+        else
+            fprintf(fid, ", \"error\": %s", json_string(r.error).c_str());
+
+        fprintf(fid, "}");
+    }
+
+    fprintf(fid, "\n  ]\n}\n");
+    fclose(fid);
+
+    return true;
+}
+
+bool write_csv(const std::string& filename,
+               const device_description& device,
+               const std::string& value_type,
+               const std::vector<sweep_result>& results)
+{
+    FILE * fid = fopen(filename.c_str(), "w");
+
+    if (!fid)
+        return false;
+
+    fprintf(fid, "device_name,value_type,matrix,solver,preconditioner,tolerance,num_rows,num_cols,num_entries,"
+                 "device,worker,valid,converged,iterations,residual_norm,setup_ms,solve_ms,time_to_solution_ms,error\n");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const sweep_result& r = results[i];
+
+        fprintf(fid, "%s,%s,%s,%s,%s,%.3e,%lu,%lu,%lu,%d,%lu,%d,%d,%lu,%.6e,%.6f,%.6f,%.6f,%s\n",
+                csv_string(device.name).c_str(), value_type.c_str(), csv_string(r.matrix).c_str(),
+                r.solver.c_str(), r.preconditioner.c_str(), r.tolerance,
+                (unsigned long) r.num_rows, (unsigned long) r.num_cols, (unsigned long) r.num_entries,
+                r.device, (unsigned long) r.worker, r.valid ? 1 : 0, r.converged ? 1 : 0,
+                (unsigned long) r.iterations, r.residual_norm, r.setup_ms, r.solve_ms, r.time_to_solution_ms(),
+                csv_string(r.error).c_str());
+    }
+
+    fclose(fid);
+
+    return true;
+}
+
+template <typename ValueType>
+void run_sweep(const std::vector<manifest_entry>& manifest, const sweep_options& options,
+              const std::vector<std::string>& solvers, const std::vector<std::string>& preconditioners,
+              const std::vector<int>& devices, size_t num_workers)
+{
+    // matrices in manifest order, so that few of them are held at a time
+    std::vector<sweep_task> tasks;
+
+    for (size_t m = 0; m < manifest.size(); m++)
+        for (size_t p = 0; p < preconditioners.size(); p++)
+            for (size_t s = 0; s < solvers.size(); s++)
+            {
+                sweep_task task;
+                task.matrix         = m;
+                task.preconditioner = preconditioners[p];
+                task.solver         = solvers[s];
+                tasks.push_back(task);
+            }
+
+    // query the properties of the devices before the workers start
+    for (size_t d = 0; d < devices.size(); d++)
+    {
+        cusp::detail::scoped_device scope(devices[d]);
+        cusp::detail::device::arch::current_device_info();
+    }
+
+    sweep_context<ValueType> context(manifest, tasks, options);
+
+    std::vector< worker_state<ValueType> > workers(num_workers);
+    std::vector<pthread_t> threads(num_workers);
+    std::vector<bool> started(num_workers, false);
+
+    wall_clock clock;
+
+    for (size_t w = 0; w < num_workers; w++)
+    {
+        workers[w].context = &context;
+        workers[w].device  = devices[w % devices.size()];
+        workers[w].id      = w;
+
+        started[w] = pthread_create(&threads[w], 0, run_worker<ValueType>, &workers[w]) == 0;
+
+        if (!started[w])
+            std::cerr << "unable to start worker " << w << std::endl;
+    }
+
+    for (size_t w = 0; w < num_workers; w++)
+    {
+        if (started[w])
+            pthread_join(threads[w], 0);
+
+        if (!workers[w].error.empty())
+            std::cerr << "worker " << w << " on device " << workers[w].device << ": " << workers[w].error << std::endl;
+    }
+
+    std::cout << tasks.size() << " configurations in " << 1e-3 * clock.milliseconds_elapsed() << " seconds" << std::endl;
+
+    std::vector<sweep_result> results;
+
+    for (size_t t = 0; t < context.results.size(); t++)
+    {
+        if (context.results[t].empty())
+        {
+            // no worker could run the task
+            std::cerr << "configuration " << manifest[tasks[t].matrix].name << " " << tasks[t].preconditioner
+                      << " " << tasks[t].solver << " was not run" << std::endl;
+            continue;
+        }
+
+        results.insert(results.end(), context.results[t].begin(), context.results[t].end());
+    }
+
+    const device_description device = describe_device();
+    const std::string value_type = sizeof(ValueType) == 4 ? "float" : "double";
+    const std::string json = args.count("json") ? args["json"] : "sweep_results.json";
+    const std::string csv  = args.count("csv")  ? args["csv"]  : "sweep_results.csv";
+
+    if (!write_json(json, device, value_type, options, results))
+        std::cerr << "unable to write " << json << std::endl;
+    if (!write_csv(csv, device, value_type, results))
+        std::cerr << "unable to write " << csv << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    process_args(argc, argv);
+
+    if (args.count("help"))
+    {
+        usage(argc, argv);
+        return 0;
+    }
+
+    static const char * known_solvers[]         = {"cg", "bicgstab", "gmres"};
+    static const char * known_preconditioners[] = {"diagonal", "ainv", "smoothed_aggregation"};
+
+    const std::vector<std::string> solvers         = list_argument("solvers", "cg,bicgstab,gmres");
+    const std::vector<std::string> preconditioners = list_argument("preconditioners", "diagonal,ainv,smoothed_aggregation");
+
+    for (size_t i = 0; i < solvers.size(); i++)
+        if (!is_known(solvers[i], known_solvers, 3))
+        {
+            std::cerr << "ERROR: unknown solver " << solvers[i] << std::endl;
+            return 1;
+        }
+
+    for (size_t i = 0; i < preconditioners.size(); i++)
+        if (!is_known(preconditioners[i], known_preconditioners, 3))
+        {
+            std::cerr << "ERROR: unknown preconditioner " << preconditioners[i] << std::endl;
+            return 1;
+        }
+
+    sweep_options options;
+
+    const std::vector<std::string> tolerances = list_argument("tolerances", "1e-6");
+    for (size_t i = 0; i < tolerances.size(); i++)
+        options.tolerances.push_back(atof(tolerances[i].c_str()));
+
+    if (args.count("max_iterations")) options.max_iterations = atoi(args["max_iterations"].c_str());
+    if (args.count("restart"))        options.restart        = atoi(args["restart"].c_str());
+
+    std::vector<int> devices;
+
+    const std::vector<std::string> device_list = list_argument("devices", "0");
+    for (size_t i = 0; i < device_list.size(); i++)
+        devices.push_back(atoi(device_list[i].c_str()));
+
+    const size_t num_workers = args.count("workers") ? atoi(args["workers"].c_str()) : 2 * devices.size();
+
+    if (solvers.empty() || preconditioners.empty() || options.tolerances.empty() || devices.empty() || num_workers == 0)
+    {
+        usage(argc, argv);
+        return 1;
+    }
+
+    cudaSetDevice(devices[0]);
+
+    std::vector<manifest_entry> manifest;
+
+    try
+    {
+        manifest = args.count("manifest") ? read_manifest(args["manifest"]) : default_manifest();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    const std::string value_type = args.count("value_type") ? args["value_type"] : "double";
+
+    if (value_type == "float")
+        run_sweep<float>(manifest, options, solvers, preconditioners, devices, num_workers);
+    else if (value_type == "double")
+        run_sweep<double>(manifest, options, solvers, preconditioners, devices, num_workers);
+    else
+    {
+        std::cerr << "ERROR: Unsupported type \'" << value_type << "\'\n\n";
+        return 1;
+    }
+
+    return 0;
+}
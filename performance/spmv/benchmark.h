@@ -238,3 +238,64 @@ void test_hyb(HostMatrix& host_matrix)
     test_spmv("hyb_tex", host_matrix, test_matrix_on_host, test_matrix_on_device, cusp::detail::device::spmv_hyb_tex<DeviceMatrix,ValueType>);
 }
 
+
+template <typename HostMatrix>
+void test_csr16(HostMatrix& host_matrix)
+{
+    typedef typename HostMatrix::index_type IndexType;
+    typedef typename HostMatrix::value_type ValueType;
+
+    // convert HostMatrix to TestMatrix on host
+    cusp::csr16_matrix<IndexType, ValueType, cusp::host_memory> test_matrix_on_host(host_matrix);
+
+    // transfer TestMatrix to device
+    typedef typename cusp::csr16_matrix<IndexType, ValueType, cusp::device_memory> DeviceMatrix;
+    DeviceMatrix test_matrix_on_device(test_matrix_on_host);
+    
+    test_spmv("csr16",     host_matrix, test_matrix_on_host, test_matrix_on_device, cusp::detail::device::spmv_csr16    <DeviceMatrix,ValueType>);
+    test_spmv("csr16_tex", host_matrix, test_matrix_on_host, test_matrix_on_device, cusp::detail::device::spmv_csr16_tex<DeviceMatrix,ValueType>);
+}
+
+template <typename HostMatrix>
+void test_dia_coo(HostMatrix& host_matrix)
+{
+    typedef typename HostMatrix::index_type IndexType;
+    typedef typename HostMatrix::value_type ValueType;
+
+    // convert HostMatrix to TestMatrix on host
+    cusp::dia_coo_matrix<IndexType, ValueType, cusp::host_memory> test_matrix_on_host(host_matrix);
+
+    // transfer TestMatrix to device
+    typedef typename cusp::dia_coo_matrix<IndexType, ValueType, cusp::device_memory> DeviceMatrix;
+    DeviceMatrix test_matrix_on_device(test_matrix_on_host);
+    
+    test_spmv("dia_coo",     host_matrix, test_matrix_on_host, test_matrix_on_device, cusp::detail::device::spmv_dia_coo    <DeviceMatrix,ValueType>);
+    test_spmv("dia_coo_tex", host_matrix, test_matrix_on_host, test_matrix_on_device, cusp::detail::device::spmv_dia_coo_tex<DeviceMatrix,ValueType>);
+}
+
+template <typename HostMatrix>
+void test_symmetric_csr(HostMatrix& host_matrix)
+{
+    typedef typename HostMatrix::index_type IndexType;
+    typedef typename HostMatrix::value_type ValueType;
+        
+    // convert HostMatrix to TestMatrix on host
+    cusp::symmetric_csr_matrix<IndexType, ValueType, cusp::host_memory> test_matrix_on_host;
+
+    try
+    {
+        test_matrix_on_host = host_matrix;
+    }
+    catch (cusp::format_conversion_exception)
+    {
+        std::cout << "\tRefusing to convert to symmetric CSR format" << std::endl;
+        return;
+    }
+
+    // transfer TestMatrix to device
+    typedef typename cusp::symmetric_csr_matrix<IndexType, ValueType, cusp::device_memory> DeviceMatrix;
+    DeviceMatrix test_matrix_on_device(test_matrix_on_host);
+    
+    test_spmv("symmetric_csr",     host_matrix, test_matrix_on_host, test_matrix_on_device, cusp::detail::device::spmv_symmetric_csr    <DeviceMatrix,ValueType>);
+    test_spmv("symmetric_csr_tex", host_matrix, test_matrix_on_host, test_matrix_on_device, cusp::detail::device::spmv_symmetric_csr_tex<DeviceMatrix,ValueType>);
+}
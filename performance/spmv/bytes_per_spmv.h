@@ -5,6 +5,9 @@
 #include <cusp/dia_matrix.h>
 #include <cusp/ell_matrix.h>
 #include <cusp/hyb_matrix.h>
+#include <cusp/csr16_matrix.h>
+#include <cusp/dia_coo_matrix.h>
+#include <cusp/symmetric_csr_matrix.h>
     
 template <typename IndexType, typename ValueType>
 size_t bytes_per_spmv(const cusp::dia_matrix<IndexType,ValueType,cusp::host_memory>& mtx)
@@ -60,3 +63,35 @@ size_t bytes_per_spmv(const cusp::hyb_matrix<IndexType,ValueType,cusp::host_memo
     return bytes_per_spmv(mtx.ell) + bytes_per_spmv(mtx.coo);
 }
 
+template <typename IndexType, typename ValueType>
+size_t bytes_per_spmv(const cusp::csr16_matrix<IndexType,ValueType,cusp::host_memory>& mtx)
+{
+    typedef typename cusp::csr16_matrix<IndexType,ValueType,cusp::host_memory>::offset_type OffsetType;
+
+    size_t bytes = 0;
+    bytes += 3*sizeof(IndexType)  * mtx.num_rows;                    // row pointer and row base
+    bytes += 1*sizeof(OffsetType) * mtx.num_compressed_entries();    // column offset
+    bytes += 2*sizeof(ValueType)  * mtx.num_compressed_entries();    // A[i,j] and x[j]
+    bytes += 2*sizeof(ValueType)  * mtx.num_rows;                    // y[i] = y[i] + ...
+    return bytes + bytes_per_spmv(mtx.overflow);
+}
+
+template <typename IndexType, typename ValueType>
+size_t bytes_per_spmv(const cusp::dia_coo_matrix<IndexType,ValueType,cusp::host_memory>& mtx)
+{
+    return bytes_per_spmv(mtx.dia) + bytes_per_spmv(mtx.coo);
+}
+
+template <typename IndexType, typename ValueType>
+size_t bytes_per_spmv(const cusp::symmetric_csr_matrix<IndexType,ValueType,cusp::host_memory>& mtx)
+{
+    const size_t num_mirrored_entries = mtx.num_entries - mtx.num_stored_entries();
+
+    size_t bytes = 0;
+    bytes += 2*sizeof(IndexType) * mtx.num_rows;                // row pointer
+    bytes += 1*sizeof(IndexType) * mtx.num_stored_entries();    // column index
+    bytes += 2*sizeof(ValueType) * mtx.num_stored_entries();    // A[i,j] and x[j]
+    bytes += 2*sizeof(ValueType) * num_mirrored_entries;        // y[j] = y[j] + A[i,j] * x[i]
+    bytes += 2*sizeof(ValueType) * mtx.num_rows;                // y[i] = y[i] + ...
+    return bytes;
+}
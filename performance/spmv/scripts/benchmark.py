@@ -1,5 +1,25 @@
 #!/usr/bin/env python 
-import os,csv
+"""Run the SpMV benchmark over a suite of matrices, or compare two runs.
+
+    benchmark.py
+        run ../spmv on every matrix below, for float and double values
+
+    benchmark.py --compare baseline current [--threshold=0.05]
+                 [--alpha=0.01] [--kernels=csr_vector,hyb]
+        report the speedup of every (matrix, kernel) of current over
+        baseline, and exit with 1 if a kernel regressed
+
+A result file is either a benchmark_output.log written by ../spmv or a
+JSON file of performance/suite (schema cusp-benchmark/1).  A kernel
+regresses when it slowed down by more than the threshold (5% by default)
+and, when the files carry the spread of the timings, the slowdown is
+significant under Welch's t-test at level alpha.  --kernels restricts
+the failure to the listed kernels; all kernels are reported regardless.
+"""
+
+from __future__ import print_function
+
+import os,csv,sys,json,math
 
 device_id = '0'  # index of the device to use
 
@@ -101,6 +121,151 @@ def run_tests(value_type):
     write_csv('gbytes') #GBytes/s
 
 
-run_tests('float')
-run_tests('double')
+#####################
+# comparison of runs
+
+def load_log(filename):
+    """(matrix, kernel) -> timing of a benchmark_output.log"""
+    cases = {}
+    matrix = None
+    for line in open(filename):
+        tokens = dict( [tuple(part.split('=', 1)) for part in line.split()] )
+
+        if 'file' in tokens:
+            matrix = os.path.split(tokens['file'])[1] or 'poisson5pt'
+        elif 'kernel' in tokens and matrix is not None:
+            cases[(matrix, tokens['kernel'])] = {'mean' : float(tokens['msec']), 'stddev' : None, 'n' : 0}
+    return cases
+
+def load_json(filename):
+    """(matrix, suite/name) -> timing of a cusp-benchmark/1 result file"""
+    data = json.load(open(filename))
+    if data.get('schema') != 'cusp-benchmark/1':
+        raise ValueError('%s is not a cusp-benchmark/1 result file' % filename)
+
+    cases = {}
+    for r in data['results']:
+        if r['valid']:
+            ms = r['milliseconds']
+            kernel = r['name'] if r['suite'] == 'spmv' else r['suite'] + '/' + r['name']
+            cases[(r['matrix'], kernel)] = {'mean' : ms['mean'], 'stddev' : ms['stddev'], 'n' : r['repetitions']}
+    return cases
+
+def load_results(filename):
+    if filename.endswith('.json'):
+        return load_json(filename)
+    else:
+        return load_log(filename)
+
+def betacf(a, b, x):
+    """continued fraction of the incomplete beta function (Numerical Recipes)"""
+    qab, qap, qam = a + b, a + 1.0, a - 1.0
+    c, d = 1.0, 1.0 - qab * x / qap
+    d = 1.0 / (d if abs(d) > 1e-30 else 1e-30)
+    h = d
+    for m in range(1, 200):
+        m2 = 2 * m
+        aa = m * (b - m) * x / ((qam + m2) * (a + m2))
+        d = 1.0 + aa * d
+        d = 1.0 / (d if abs(d) > 1e-30 else 1e-30)
+        c = 1.0 + aa / c
+        c = c if abs(c) > 1e-30 else 1e-30
+        h *= d * c
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))
+        d = 1.0 + aa * d
+        d = 1.0 / (d if abs(d) > 1e-30 else 1e-30)
+        c = 1.0 + aa / c
+        c = c if abs(c) > 1e-30 else 1e-30
+        delta = d * c
+        h *= delta
+        if abs(delta - 1.0) < 1e-12:
+            break
+    return h
+
+def betai(a, b, x):
+    """regularized incomplete beta function I_x(a,b)"""
+    if x <= 0.0:
+        return 0.0
+    if x >= 1.0:
+        return 1.0
+    lbeta = math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) + a * math.log(x) + b * math.log(1.0 - x)
+    if x < (a + 1.0) / (a + b + 2.0):
+        return math.exp(lbeta) * betacf(a, b, x) / a
+    else:
+        return 1.0 - math.exp(lbeta) * betacf(b, a, 1.0 - x) / b
+
+def welch_p_value(a, b):
+    """two-sided p-value of Welch's t-test, None without the spread of both runs"""
+    if a['stddev'] is None or b['stddev'] is None or a['n'] < 2 or b['n'] < 2:
+        return None
+
+    va = a['stddev'] ** 2 / a['n']
+    vb = b['stddev'] ** 2 / b['n']
+    if va + vb == 0.0:
+        return 0.0 if a['mean'] != b['mean'] else 1.0
+
+    t = (b['mean'] - a['mean']) / math.sqrt(va + vb)
+    df = (va + vb) ** 2 / (va ** 2 / (a['n'] - 1) + vb ** 2 / (b['n'] - 1))
+    return betai(0.5 * df, 0.5, df / (df + t * t))
+
+def compare(baseline, current, threshold=0.05, alpha=0.01, kernels=None):
+    """print the speedups of current over baseline, return the number of regressions"""
+    old = load_results(baseline)
+    new = load_results(current)
+
+    print('%-24s %-22s %12s %12s %8s %8s' % ('matrix', 'kernel', 'baseline ms', 'current ms', 'speedup', 'p'))
+
+    regressions = 0
+    for key in sorted(set(old) & set(new)):
+        a, b = old[key], new[key]
+        if a['mean'] <= 0.0 or b['mean'] <= 0.0:
+            continue
+
+        speedup = a['mean'] / b['mean']
+        p = welch_p_value(a, b)
+        significant = p is None or p < alpha
+        watched = kernels is None or key[1] in kernels
+
+        status = ''
+        if b['mean'] > (1.0 + threshold) * a['mean'] and significant:
+            status = '  REGRESSION' if watched else '  slower'
+            regressions += watched
+        elif a['mean'] > (1.0 + threshold) * b['mean'] and significant:
+            status = '  faster'
+
+        print('%-24s %-22s %12.4f %12.4f %7.3fx %8s%s' % (key[0], key[1], a['mean'], b['mean'], speedup,
+                                                          '-' if p is None else '%.4f' % p, status))
+
+    for key in sorted(set(old) - set(new)):
+        print('%-24s %-22s missing from %s' % (key[0], key[1], current))
+
+    print('')
+    print('%d regression(s)' % regressions)
+    return regressions
+
+def compare_main(argv):
+    threshold, alpha, kernels, files = 0.05, 0.01, None, []
+    for arg in argv:
+        if arg.startswith('--threshold='):
+            threshold = float(arg.split('=', 1)[1])
+        elif arg.startswith('--alpha='):
+            alpha = float(arg.split('=', 1)[1])
+        elif arg.startswith('--kernels='):
+            kernels = set(arg.split('=', 1)[1].split(','))
+        elif arg != '--compare':
+            files.append(arg)
+
+    if len(files) != 2:
+        print(__doc__)
+        return 2
+
+    return 1 if compare(files[0], files[1], threshold, alpha, kernels) else 0
+
+
+if __name__ == '__main__':
+    if '--compare' in sys.argv[1:]:
+        sys.exit(compare_main(sys.argv[1:]))
+
+    run_tests('float')
+    run_tests('double')
  
@@ -11,6 +11,7 @@
 #include <limits>
 
 #include <cusp/multiply.h>
+#include <cusp/benchmark.h>
 #include <cusp/detail/device/spmv/csr_scalar.h>
 
 #include "bytes_per_spmv.h"
@@ -93,6 +94,16 @@ void test_all_formats(std::string& filename)
     test_dia(host_matrix);
     test_ell(host_matrix);
     test_hyb(host_matrix);
+    test_csr16(host_matrix);
+    test_dia_coo(host_matrix);
+    test_symmetric_csr(host_matrix);
+
+    // the formats among which cusp::auto_format_matrix selects, against
+    // the measured bandwidth of the device
+    cusp::csr_matrix<IndexType, ValueType, cusp::device_memory> device_matrix(host_matrix);
+
+    std::cout << "\n";
+    cusp::benchmark::print(cusp::benchmark::spmv_profile(device_matrix));
 }
 
 int main(int argc, char** argv)
@@ -0,0 +1,103 @@
+#include <cusp/csr_matrix.h>
+#include <cusp/array1d.h>
+#include <cusp/initialize.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+#include <sys/time.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+// Cold-start cost of a short job: the time from the start of the process
+// until the first SpMV has completed, which includes the creation of the
+// context, the loading of the kernels and their occupancy queries.  Each
+// run measures a single cold start, so run the program repeatedly, e.g.
+//
+//    for i in 1 2 3 4 5; do ./cold_start; done
+//    for i in 1 2 3 4 5; do ./cold_start --initialize; done
+//
+// With --initialize the kernels are warmed by cusp::initializer while the
+// host assembles the matrix.
+
+typedef int                                                       IndexType;
+typedef double                                                    ValueType;
+typedef cusp::csr_matrix<IndexType,ValueType,cusp::host_memory>   HostMatrix;
+typedef cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> DeviceMatrix;
+
+double wall_seconds(void)
+{
+    timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + 1e-6 * t.tv_usec;
+}
+
+double multiply_seconds(const DeviceMatrix& A,
+                        const cusp::array1d<ValueType,cusp::device_memory>& x,
+                              cusp::array1d<ValueType,cusp::device_memory>& y)
+{
+    const double start = wall_seconds();
+    cusp::multiply(A, x, y);
+    cudaDeviceSynchronize();
+    return wall_seconds() - start;
+}
+
+int main(int argc, char ** argv)
+{
+    const double start = wall_seconds();
+
+    bool warmup = false;
+    size_t N = 1000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--initialize") == 0)
+            warmup = true;
+        else
+            N = std::atoi(argv[i]);
+    }
+
+    cusp::initializer<IndexType,ValueType> * init = 0;
+
+    if (warmup)
+        init = new cusp::initializer<IndexType,ValueType>(cusp::warmup_csr);
+
+    // the host work of a job, e.g. reading its input
+    HostMatrix B;
+    cusp::gallery::poisson5pt(B, N, N);
+
+    const double assembled = wall_seconds();
+
+    if (init)
+    {
+        cusp::initialize_report report = init->wait();
+        delete init;
+
+        std::cout << "context creation     " << std::setw(10) << std::fixed << std::setprecision(2) << 1e3 * report.context_seconds        << " ms" << std::endl;
+        std::cout << "first warmup SpMV    " << std::setw(10) << std::fixed << std::setprecision(2) << 1e3 * report.first_multiply_seconds << " ms" << std::endl;
+        std::cout << "kernel warmup        " << std::setw(10) << std::fixed << std::setprecision(2) << 1e3 * report.warmup_seconds         << " ms" << std::endl;
+    }
+
+    const double initialized = wall_seconds();
+
+    DeviceMatrix A(B);
+    cusp::array1d<ValueType,cusp::device_memory> x(A.num_cols, ValueType(1));
+    cusp::array1d<ValueType,cusp::device_memory> y(A.num_rows);
+    cudaDeviceSynchronize();
+
+    const double transferred = wall_seconds();
+
+    const double first  = multiply_seconds(A, x, y);
+    const double second = multiply_seconds(A, x, y);
+
+    std::cout << "host assembly        " << std::setw(10) << std::fixed << std::setprecision(2) << 1e3 * (assembled - start)         << " ms" << std::endl;
+    std::cout << "wait for warmup      " << std::setw(10) << std::fixed << std::setprecision(2) << 1e3 * (initialized - assembled)   << " ms" << std::endl;
+    std::cout << "transfer to device   " << std::setw(10) << std::fixed << std::setprecision(2) << 1e3 * (transferred - initialized) << " ms" << std::endl;
+    std::cout << "first SpMV           " << std::setw(10) << std::fixed << std::setprecision(2) << 1e3 * first                       << " ms" << std::endl;
+    std::cout << "second SpMV          " << std::setw(10) << std::fixed << std::setprecision(2) << 1e3 * second                      << " ms" << std::endl;
+    std::cout << "time to first SpMV   " << std::setw(10) << std::fixed << std::setprecision(2) << 1e3 * (transferred + first - start) << " ms" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+// Timing, statistics and result files of the benchmark suite.
+//
+// Every case is run `warmup` times untimed and then `repetitions` times,
+// each repetition timed on its own with a pair of CUDA events, so the
+// results carry the spread of the timings as well as their center.  The
+// results are written as JSON (schema "cusp-benchmark/1") and as CSV
+// with one row per case; scripts/compare.py compares two JSON files.
+
+#include <cuda.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../timer.h"
+
+struct benchmark_options
+{
+    size_t warmup;
+    size_t repetitions;
+
+    benchmark_options(void) : warmup(2), repetitions(10) {}
+};
+
+struct statistics
+{
+    double min;
+    double median;
+    double mean;
+    double stddev;
+
+    statistics(void) : min(0), median(0), mean(0), stddev(0) {}
+};
+
+inline statistics compute_statistics(std::vector<double> samples)
+{
+    statistics s;
+
+    if (samples.empty())
+        return s;
+
+    std::sort(samples.begin(), samples.end());
+
+    const size_t n = samples.size();
+
+    s.min    = samples[0];
+    s.median = (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+
+    for (size_t i = 0; i < n; i++)
+        s.mean += samples[i];
+    s.mean /= n;
+
+    for (size_t i = 0; i < n; i++)
+        s.stddev += (samples[i] - s.mean) * (samples[i] - s.mean);
+    s.stddev = (n > 1) ? std::sqrt(s.stddev / (n - 1)) : 0.0;
+
+    return s;
+}
+
+// one benchmarked case; bytes and flops are per repetition
+struct benchmark_result
+{
+    std::string suite;        // spmv, spgemm, conversion, blas, solver, amg
+    std::string matrix;       // name of the manifest entry
+    std::string name;         // e.g. csr, coo->hyb, axpy, cg, setup
+    size_t num_rows;
+    size_t num_cols;
+    size_t num_entries;
+    size_t repetitions;
+    statistics milliseconds;
+    double bytes;
+    double flops;
+    size_t iterations;        // solver iterations, 0 otherwise
+    bool   valid;             // false when the case could not be run
+
+    benchmark_result(void)
+        : num_rows(0), num_cols(0), num_entries(0), repetitions(0),
+          bytes(0), flops(0), iterations(0), valid(true) {}
+
+    double gbytes_per_second(void) const
+    {
+        return milliseconds.median > 0 ? bytes / (1e6 * milliseconds.median) : 0.0;
+    }
+
+    double gflops_per_second(void) const
+    {
+        return milliseconds.median > 0 ? flops / (1e6 * milliseconds.median) : 0.0;
+    }
+};
+
+// Time test() after warming it up.  Test::setup(), when a case needs to
+// restore its inputs, runs before every call outside of the timed region.
+template <typename Test>
+statistics time_repetitions(Test& test, const benchmark_options& options)
+{
+    for (size_t i = 0; i < options.warmup; i++)
+    {
+        test.setup();
+        test();
+    }
+    cudaDeviceSynchronize();
+
+    std::vector<double> samples;
+
+    for (size_t i = 0; i < options.repetitions; i++)
+    {
+        test.setup();
+        cudaDeviceSynchronize();
+
+        timer t;
+        test();
+        samples.push_back(t.milliseconds_elapsed());
+    }
+
+    return compute_statistics(samples);
+}
+
+struct device_description
+{
+    std::string name;
+    int sm_version;
+    double peak_bandwidth;    // GB/s
+
+    device_description(void) : name("unknown"), sm_version(0), peak_bandwidth(0) {}
+};
+
+inline device_description describe_device(void)
+{
+    device_description d;
+
+    int device = 0;
+    cudaDeviceProp properties;
+
+    if (cudaGetDevice(&device) == cudaSuccess && cudaGetDeviceProperties(&properties, device) == cudaSuccess)
+    {
+        d.name = properties.name;
+        d.sm_version = 10 * properties.major + properties.minor;
+        // the memory clock is in kHz and the bus is double data rate
+        d.peak_bandwidth = 2.0 * 1e3 * properties.memoryClockRate * (properties.memoryBusWidth / 8) / 1e9;
+    }
+
+    return d;
+}
+
+inline std::string json_string(const std::string& s)
+{
+    std::string out = "\"";
+
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        const char c = s[i];
+
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if ((unsigned char) c < 0x20)
+        {
+            char escaped[8];
+            sprintf(escaped, "\\u%04x", (unsigned int) c);
+            out += escaped;
+        }
+        else
+        {
+            out += c;
+        }
+    }
+
+    return out + "\"";
+}
+
+// quoted, since names may contain commas, with quotes doubled
+inline std::string csv_string(const std::string& s)
+{
+    std::string out = "\"";
+
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        if (s[i] == '"')
+            out += '"';
+        out += s[i];
+    }
+
+    return out + "\"";
+}
+
+inline bool write_json(const std::string& filename,
+                       const device_description& device,
+                       const std::string& value_type,
+                       const benchmark_options& options,
+                       const std::vector<benchmark_result>& results)
+{
+    FILE * fid = fopen(filename.c_str(), "w");
+
+    if (!fid)
+        return false;
+
+    fprintf(fid, "{\n  \"schema\": \"cusp-benchmark/1\",\n");
+    fprintf(fid, "  \"device\": {\"name\": %s, \"sm_version\": %d, \"peak_gbytes_per_second\": %.3f},\n",
+            json_string(device.name).c_str(), device.sm_version, device.peak_bandwidth);
+    fprintf(fid, "  \"value_type\": %s,\n", json_string(value_type).c_str());
+    fprintf(fid, "  \"warmup\": %lu,\n  \"repetitions\": %lu,\n", (unsigned long) options.warmup, (unsigned long) options.repetitions);
+    fprintf(fid, "  \"results\": [");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const benchmark_result& r = results[i];
+
+        fprintf(fid, "%s\n    {\"suite\": %s, \"matrix\": %s, \"name\": %s, ", i ? "," : "",
+                json_string(r.suite).c_str(), json_string(r.matrix).c_str(), json_string(r.name).c_str());
+        fprintf(fid, "\"num_rows\": %lu, \"num_cols\": %lu, \"num_entries\": %lu, \"valid\": %s",
+                (unsigned long) r.num_rows, (unsigned long) r.num_cols, (unsigned long) r.num_entries, r.valid ? "true" : "false");
+
+        if (r.valid)
+        {
+            fprintf(fid, ",\n     \"repetitions\": %lu, \"milliseconds\": {\"min\": %.6f, \"median\": %.6f, \"mean\": %.6f, \"stddev\": %.6f}",
+                    (unsigned long) r.repetitions, r.milliseconds.min, r.milliseconds.median, r.milliseconds.mean, r.milliseconds.stddev);
+            fprintf(fid, ",\n     \"bytes\": %.0f, \"flops\": %.0f, \"gbytes_per_second\": %.6f, \"gflops_per_second\": %.6f, \"iterations\": %lu",
+                    r.bytes, r.flops, r.gbytes_per_second(), r.gflops_per_second(), (unsigned long) r.iterations);
+        }
+
+        fprintf(fid, "}");
+    }
+
+    fprintf(fid, "\n  ]\n}\n");
+    fclose(fid);
+
+    return true;
+}
+
+inline bool write_csv(const std::string& filename,
+                      const device_description& device,
+                      const std::string& value_type,
+                      const std::vector<benchmark_result>& results)
+{
+    FILE * fid = fopen(filename.c_str(), "w");
+
+    if (!fid)
+        return false;
+
+    fprintf(fid, "device,value_type,suite,matrix,name,num_rows,num_cols,num_entries,valid,repetitions,"
+                 "ms_min,ms_median,ms_mean,ms_stddev,gbytes_per_second,gflops_per_second,iterations\n");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const benchmark_result& r = results[i];
+
+        fprintf(fid, "%s,%s,%s,%s,%s,%lu,%lu,%lu,%d,%lu,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%lu\n",
+                csv_string(device.name).c_str(), value_type.c_str(), r.suite.c_str(),
+                csv_string(r.matrix).c_str(), csv_string(r.name).c_str(),
+                (unsigned long) r.num_rows, (unsigned long) r.num_cols, (unsigned long) r.num_entries,
+                r.valid ? 1 : 0, (unsigned long) r.repetitions,
+                r.milliseconds.min, r.milliseconds.median, r.milliseconds.mean, r.milliseconds.stddev,
+                r.gbytes_per_second(), r.gflops_per_second(), (unsigned long) r.iterations);
+    }
+
+    fclose(fid);
+
+    return true;
+}
+
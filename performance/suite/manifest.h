@@ -0,0 +1,118 @@
+#pragma once
+
+// Matrix collection manifests.
+//
+// Each line of a manifest names a matrix and where it comes from, either a
+// MatrixMarket file or one of the Poisson generators of cusp::gallery:
+//
+//    # name           source
+//    cant             ~/matrices/cant.mtx
+//    poisson5pt_1k    poisson5pt 1000 1000
+//    poisson27pt_100  poisson27pt 100 100 100
+//
+// Blank lines and lines starting with '#' are ignored.  A path starting
+// with '~/' is relative to $HOME, other relative paths are relative to the
+// directory of the manifest.
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/io/matrix_market.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct manifest_entry
+{
+    std::string name;
+    std::string source;               // path, or name of the generator
+    std::vector<size_t> dimensions;   // arguments of the generator
+
+    bool is_generated(void) const { return !dimensions.empty(); }
+};
+
+inline std::string resolve_path(const std::string& path, const std::string& manifest)
+{
+    if (path.substr(0, 2) == "~/" && std::getenv("HOME"))
+        return std::string(std::getenv("HOME")) + path.substr(1);
+
+    if (path.empty() || path[0] == '/')
+        return path;
+
+    const std::string::size_type slash = manifest.rfind('/');
+
+    return slash == std::string::npos ? path : manifest.substr(0, slash + 1) + path;
+}
+
+inline std::vector<manifest_entry> read_manifest(const std::string& filename)
+{
+    std::ifstream file(filename.c_str());
+
+    if (!file)
+        throw std::runtime_error("unable to open manifest " + filename);
+
+    std::vector<manifest_entry> entries;
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        std::istringstream words(line);
+        manifest_entry entry;
+
+        if (!(words >> entry.name) || entry.name[0] == '#')
+            continue;
+
+        if (!(words >> entry.source))
+            throw std::runtime_error("manifest entry " + entry.name + " has no source");
+
+        size_t dimension;
+        while (words >> dimension)
+            entry.dimensions.push_back(dimension);
+
+        if (!entry.is_generated())
+            entry.source = resolve_path(entry.source, filename);
+
+        entries.push_back(entry);
+    }
+
+    return entries;
+}
+
+// the suite's default collection, used when no manifest is given
+inline std::vector<manifest_entry> default_manifest(void)
+{
+    std::vector<manifest_entry> entries(2);
+
+    entries[0].name = "poisson5pt_512";
+    entries[0].source = "poisson5pt";
+    entries[0].dimensions.push_back(512);
+    entries[0].dimensions.push_back(512);
+
+    entries[1].name = "poisson27pt_64";
+    entries[1].source = "poisson27pt";
+    entries[1].dimensions.assign(3, 64);
+
+    return entries;
+}
+
+template <typename Matrix>
+void load_matrix(const manifest_entry& entry, Matrix& A)
+{
+    const std::vector<size_t>& d = entry.dimensions;
+
+    if (!entry.is_generated())
+        cusp::io::read_matrix_market_file(A, entry.source);
+    else if (entry.source == "poisson5pt" && d.size() == 2)
+        cusp::gallery::poisson5pt(A, d[0], d[1]);
+    else if (entry.source == "poisson9pt" && d.size() == 2)
+        cusp::gallery::poisson9pt(A, d[0], d[1]);
+    else if (entry.source == "poisson7pt" && d.size() == 3)
+        cusp::gallery::poisson7pt(A, d[0], d[1], d[2]);
+    else if (entry.source == "poisson27pt" && d.size() == 3)
+        cusp::gallery::poisson27pt(A, d[0], d[1], d[2]);
+    else
+        throw std::runtime_error("manifest entry " + entry.name + " has an unknown generator " + entry.source);
+}
+
@@ -0,0 +1,22 @@
+#!/usr/bin/env python
+"""Compare two result files of the benchmark suite.
+
+    compare.py baseline.json current.json [--threshold=0.05] [--alpha=0.01]
+               [--kernels=csr,hyb,blas/dot]
+
+Cases are matched by matrix and kernel, where the kernel of a SpMV case
+is its format and that of the other cases is suite/name.  See
+performance/spmv/scripts/benchmark.py, which implements the comparison,
+for when a case counts as a regression.  The exit status is 1 when a
+case regressed, so the script can gate a CI job.
+"""
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'spmv', 'scripts'))
+
+import benchmark
+
+if __name__ == '__main__':
+    sys.exit(benchmark.compare_main(sys.argv[1:]))
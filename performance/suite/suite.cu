@@ -0,0 +1,535 @@
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/exception.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/linear_operator.h>
+#include <cusp/sell_matrix.h>
+#include <cusp/jds_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/precond/smoothed_aggregation.h>
+
+#include <cusp/detail/operation_cost.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "harness.h"
+#include "manifest.h"
+
+// One harness for every benchmark of the library.  For each matrix of a
+// manifest the suite times
+//
+//    spmv         y = A x for every format the matrix converts to
+//    spgemm       C = A A in CSR
+//    conversion   CSR to each format, on the device
+//    blas         axpy, dot and nrm2 on vectors of the matrix's size
+//    solver       unpreconditioned CG to a relative tolerance of 1e-6
+//    amg          smoothed aggregation setup, and the preconditioned solve
+//
+// and writes the statistics of every case as JSON and CSV.  See usage().
+
+typedef cusp::device_memory MemorySpace;
+
+typedef std::map<std::string, std::string> ArgumentMap;
+ArgumentMap args;
+
+void process_args(int argc, char ** argv)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+
+        if (arg.substr(0,2) != "--")
+            continue;
+
+        std::string::size_type n = arg.find('=',2);
+
+        if (n == std::string::npos)
+            args[arg.substr(2)] = std::string();              // (key)
+        else
+            args[arg.substr(2, n - 2)] = arg.substr(n + 1);   // (key,value)
+    }
+}
+
+void usage(int argc, char** argv)
+{
+    std::cout << "Usage:\n";
+    std::cout << "\t" << argv[0] << " [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "\t--manifest=FILE       matrix collection (default: two Poisson problems)\n";
+    std::cout << "\t--suites=LIST         comma separated subset of spmv,spgemm,conversion,blas,solver,amg\n";
+    std::cout << "\t--value_type=TYPE     float or double (default: double)\n";
+    std::cout << "\t--warmup=N            untimed runs of each case (default: 2)\n";
+    std::cout << "\t--repetitions=N       timed runs of each case (default: 10)\n";
+    std::cout << "\t--device=N            CUDA device (default: 0)\n";
+    std::cout << "\t--json=FILE           JSON results (default: benchmark_results.json)\n";
+    std::cout << "\t--csv=FILE            CSV results (default: benchmark_results.csv)\n";
+}
+
+std::set<std::string> selected_suites(void)
+{
+    std::string list = args.count("suites") ? args["suites"] : "spmv,spgemm,conversion,blas,solver,amg";
+    std::set<std::string> suites;
+
+    std::istringstream stream(list);
+    std::string suite;
+    while (std::getline(stream, suite, ','))
+        suites.insert(suite);
+
+    return suites;
+}
+
+template <typename Matrix>
+benchmark_result make_result(const std::string& suite, const std::string& matrix,
+                             const std::string& name, const Matrix& A)
+{
+    benchmark_result r;
+    r.suite       = suite;
+    r.matrix      = matrix;
+    r.name        = name;
+    r.num_rows    = A.num_rows;
+    r.num_cols    = A.num_cols;
+    r.num_entries = A.num_entries;
+    return r;
+}
+
+template <typename Test>
+void run_case(benchmark_result& r, Test& test, const benchmark_options& options)
+{
+    r.milliseconds = time_repetitions(test, options);
+    r.repetitions  = options.repetitions;
+
+    printf("  %-10s %-22s %10.4f ms (+- %.4f) %7.1f GB/s %7.2f GFLOP/s\n",
+           r.suite.c_str(), r.name.c_str(), r.milliseconds.median, r.milliseconds.stddev,
+           r.gbytes_per_second(), r.gflops_per_second());
+}
+
+/////////
+// SpMV
+
+template <typename Matrix>
+struct spmv_test
+{
+    typedef typename Matrix::value_type ValueType;
+
+    const Matrix& A;
+    cusp::array1d<ValueType, MemorySpace> x, y;
+
+    spmv_test(const Matrix& A) : A(A), x(A.num_cols, 1), y(A.num_rows, 0) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::multiply(A, x, y); }
+};
+
+template <typename DeviceMatrix, typename HostMatrix>
+void benchmark_spmv(const std::string& format, const std::string& matrix, const HostMatrix& host,
+                    const benchmark_options& options, std::vector<benchmark_result>& results)
+{
+    benchmark_result r = make_result("spmv", matrix, format, host);
+
+    try
+    {
+        DeviceMatrix A(host);
+        spmv_test<DeviceMatrix> test(A);
+
+        const cusp::detail::operation_cost cost = cusp::detail::multiply_cost(A, test.x);
+        r.bytes = cost.bytes;
+        r.flops = cost.flops;
+
+        run_case(r, test, options);
+    }
+    catch (cusp::format_conversion_exception)
+    {
+        printf("  %-10s %-22s refusing to convert\n", "spmv", format.c_str());
+        r.valid = false;
+    }
+
+    results.push_back(r);
+}
+
+template <typename HostMatrix>
+void benchmark_spmv_formats(const std::string& matrix, const HostMatrix& host,
+                            const benchmark_options& options, std::vector<benchmark_result>& results)
+{
+    typedef typename HostMatrix::index_type IndexType;
+    typedef typename HostMatrix::value_type ValueType;
+
+    benchmark_spmv< cusp::coo_matrix <IndexType,ValueType,MemorySpace> >("coo",  matrix, host, options, results);
+    benchmark_spmv< cusp::csr_matrix <IndexType,ValueType,MemorySpace> >("csr",  matrix, host, options, results);
+    benchmark_spmv< cusp::dia_matrix <IndexType,ValueType,MemorySpace> >("dia",  matrix, host, options, results);
+    benchmark_spmv< cusp::ell_matrix <IndexType,ValueType,MemorySpace> >("ell",  matrix, host, options, results);
+    benchmark_spmv< cusp::hyb_matrix <IndexType,ValueType,MemorySpace> >("hyb",  matrix, host, options, results);
+    benchmark_spmv< cusp::sell_matrix<IndexType,ValueType,MemorySpace> >("sell", matrix, host, options, results);
+    benchmark_spmv< cusp::jds_matrix<IndexType,ValueType,MemorySpace> >("jds", matrix, host, options, results);
+}
+
+///////////
+// SpGEMM
+
+template <typename Matrix>
+struct spgemm_test
+{
+    const Matrix& A;
+    Matrix C;
+
+    spgemm_test(const Matrix& A) : A(A) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::multiply(A, A, C); }
+};
+
+// the products a_ik a_kj formed by C = A A, each a multiply and an add
+template <typename HostMatrix>
+double spgemm_products(const HostMatrix& A)
+{
+    double products = 0;
+
+    for (size_t i = 0; i < A.num_rows; i++)
+        for (size_t jj = A.row_offsets[i]; jj < A.row_offsets[i + 1]; jj++)
+            products += A.row_offsets[A.column_indices[jj] + 1] - A.row_offsets[A.column_indices[jj]];
+
+    return products;
+}
+
+template <typename HostMatrix>
+void benchmark_spgemm(const std::string& matrix, const HostMatrix& host,
+                      const benchmark_options& options, std::vector<benchmark_result>& results)
+{
+    typedef typename HostMatrix::index_type IndexType;
+    typedef typename HostMatrix::value_type ValueType;
+    typedef cusp::csr_matrix<IndexType,ValueType,MemorySpace> DeviceMatrix;
+
+    benchmark_result r = make_result("spgemm", matrix, "csr", host);
+
+    if (host.num_rows != host.num_cols)
+    {
+        r.valid = false;
+        results.push_back(r);
+        return;
+    }
+
+    DeviceMatrix A(host);
+    spgemm_test<DeviceMatrix> test(A);
+
+    r.flops = 2 * spgemm_products(host);
+
+    run_case(r, test, options);
+    results.push_back(r);
+}
+
+///////////////
+// Conversion
+
+template <typename DestinationMatrix, typename SourceMatrix>
+struct conversion_test
+{
+    const SourceMatrix& A;
+    DestinationMatrix B;
+
+    conversion_test(const SourceMatrix& A) : A(A) {}
+
+    void setup(void) {}
+    void operator()(void) { B = A; }
+};
+
+template <typename DestinationMatrix, typename HostMatrix>
+void benchmark_conversion(const std::string& format, const std::string& matrix, const HostMatrix& host,
+                          const benchmark_options& options, std::vector<benchmark_result>& results)
+{
+    typedef typename HostMatrix::index_type IndexType;
+    typedef typename HostMatrix::value_type ValueType;
+    typedef cusp::csr_matrix<IndexType,ValueType,MemorySpace> SourceMatrix;
+
+    benchmark_result r = make_result("conversion", matrix, "csr->" + format, host);
+
+    try
+    {
+        SourceMatrix A(host);
+        conversion_test<DestinationMatrix, SourceMatrix> test(A);
+        test();
+
+        // the source is read and the destination written once
+        r.bytes = cusp::detail::matrix_bytes(A, cusp::csr_format()) +
+                  cusp::detail::matrix_bytes(test.B, typename DestinationMatrix::format());
+
+        run_case(r, test, options);
+    }
+    catch (cusp::format_conversion_exception)
+    {
+        printf("  %-10s %-22s refusing to convert\n", "conversion", r.name.c_str());
+        r.valid = false;
+    }
+
+    results.push_back(r);
+}
+
+template <typename HostMatrix>
+void benchmark_conversions(const std::string& matrix, const HostMatrix& host,
+                           const benchmark_options& options, std::vector<benchmark_result>& results)
+{
+    typedef typename HostMatrix::index_type IndexType;
+    typedef typename HostMatrix::value_type ValueType;
+
+    benchmark_conversion< cusp::coo_matrix <IndexType,ValueType,MemorySpace> >("coo",  matrix, host, options, results);
+    benchmark_conversion< cusp::dia_matrix <IndexType,ValueType,MemorySpace> >("dia",  matrix, host, options, results);
+    benchmark_conversion< cusp::ell_matrix <IndexType,ValueType,MemorySpace> >("ell",  matrix, host, options, results);
+    benchmark_conversion< cusp::hyb_matrix <IndexType,ValueType,MemorySpace> >("hyb",  matrix, host, options, results);
+    benchmark_conversion< cusp::sell_matrix<IndexType,ValueType,MemorySpace> >("sell", matrix, host, options, results);
+    benchmark_conversion< cusp::jds_matrix<IndexType,ValueType,MemorySpace> >("jds", matrix, host, options, results);
+}
+
+/////////
+// BLAS1
+
+template <typename ValueType>
+struct axpy_test
+{
+    cusp::array1d<ValueType, MemorySpace> x, y;
+
+    axpy_test(size_t n) : x(n, 1), y(n, 0) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::blas::axpy(x, y, ValueType(1)); }
+};
+
+template <typename ValueType>
+struct dot_test
+{
+    cusp::array1d<ValueType, MemorySpace> x, y;
+
+    dot_test(size_t n) : x(n, 1), y(n, 1) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::blas::dot(x, y); }
+};
+
+template <typename ValueType>
+struct nrm2_test
+{
+    cusp::array1d<ValueType, MemorySpace> x;
+
+    nrm2_test(size_t n) : x(n, 1) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::blas::nrm2(x); }
+};
+
+template <typename HostMatrix>
+void benchmark_blas(const std::string& matrix, const HostMatrix& host,
+                    const benchmark_options& options, std::vector<benchmark_result>& results)
+{
+    typedef typename HostMatrix::value_type ValueType;
+
+    const size_t n = host.num_rows;
+
+    {
+        benchmark_result r = make_result("blas", matrix, "axpy", host);
+        axpy_test<ValueType> test(n);
+        r.bytes = 3.0 * n * sizeof(ValueType);
+        r.flops = 2.0 * n;
+        run_case(r, test, options);
+        results.push_back(r);
+    }
+    {
+        benchmark_result r = make_result("blas", matrix, "dot", host);
+        dot_test<ValueType> test(n);
+        r.bytes = 2.0 * n * sizeof(ValueType);
+        r.flops = 2.0 * n;
+        run_case(r, test, options);
+        results.push_back(r);
+    }
+    {
+        benchmark_result r = make_result("blas", matrix, "nrm2", host);
+        nrm2_test<ValueType> test(n);
+        r.bytes = 1.0 * n * sizeof(ValueType);
+        r.flops = 2.0 * n;
+        run_case(r, test, options);
+        results.push_back(r);
+    }
+}
+
+//////////////////
+// Solvers / AMG
+
+template <typename Matrix, typename Preconditioner>
+struct solve_test
+{
+    typedef typename Matrix::value_type ValueType;
+
+    const Matrix& A;
+    Preconditioner& M;
+    cusp::array1d<ValueType, MemorySpace> x, b;
+    size_t iterations;
+
+    solve_test(const Matrix& A, Preconditioner& M)
+        : A(A), M(M), x(A.num_rows), b(A.num_rows, 1), iterations(0) {}
+
+    // every solve starts from the same initial guess
+    void setup(void) { cusp::blas::fill(x, ValueType(0)); }
+
+    void operator()(void)
+    {
+        cusp::default_monitor<ValueType> monitor(b, 1000, 1e-6);
+        cusp::krylov::cg(A, x, b, monitor, M);
+        iterations = monitor.iteration_count();
+    }
+};
+
+template <typename Matrix>
+struct amg_setup_test
+{
+    typedef typename Matrix::index_type IndexType;
+    typedef typename Matrix::value_type ValueType;
+
+    const Matrix& A;
+
+    amg_setup_test(const Matrix& A) : A(A) {}
+
+    void setup(void) {}
+    void operator()(void) { cusp::precond::smoothed_aggregation<IndexType, ValueType, MemorySpace> M(A); }
+};
+
+template <typename HostMatrix>
+void benchmark_solvers(const std::string& matrix, const HostMatrix& host, const std::set<std::string>& suites,
+                       const benchmark_options& options, std::vector<benchmark_result>& results)
+{
+    typedef typename HostMatrix::index_type IndexType;
+    typedef typename HostMatrix::value_type ValueType;
+    typedef cusp::csr_matrix<IndexType,ValueType,MemorySpace> DeviceMatrix;
+
+    if (host.num_rows != host.num_cols)
+        return;
+
+    DeviceMatrix A(host);
+
+    if (suites.count("solver"))
+    {
+        benchmark_result r = make_result("solver", matrix, "cg", A);
+        cusp::identity_operator<ValueType, MemorySpace> M(A.num_rows, A.num_rows);
+        solve_test<DeviceMatrix, cusp::identity_operator<ValueType, MemorySpace> > test(A, M);
+        run_case(r, test, options);
+        r.iterations = test.iterations;
+        results.push_back(r);
+    }
+
+    if (suites.count("amg"))
+    {
+        {
+            benchmark_result r = make_result("amg", matrix, "setup", A);
+            amg_setup_test<DeviceMatrix> test(A);
+            run_case(r, test, options);
+            results.push_back(r);
+        }
+        {
+            typedef cusp::precond::smoothed_aggregation<IndexType, ValueType, MemorySpace> Preconditioner;
+
+            benchmark_result r = make_result("amg", matrix, "solve", A);
+            Preconditioner M(A);
+            solve_test<DeviceMatrix, Preconditioner> test(A, M);
+            run_case(r, test, options);
+            r.iterations = test.iterations;
+            results.push_back(r);
+        }
+    }
+}
+
+template <typename ValueType>
+void run_suite(const std::vector<manifest_entry>& manifest, const benchmark_options& options)
+{
+    typedef int IndexType;
+
+    const std::set<std::string> suites = selected_suites();
+    std::vector<benchmark_result> results;
+
+    for (size_t i = 0; i < manifest.size(); i++)
+    {
+        const std::string& matrix = manifest[i].name;
+
+        cusp::csr_matrix<IndexType, ValueType, cusp::host_memory> host;
+
+        try
+        {
+            load_matrix(manifest[i], host);
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "skipping " << matrix << ": " << e.what() << std::endl;
+            continue;
+        }
+
+        std::cout << matrix << " (" << host.num_rows << "," << host.num_cols << ") with "
+                  << host.num_entries << " entries" << std::endl;
+
+        if (suites.count("spmv"))       benchmark_spmv_formats(matrix, host, options, results);
+        if (suites.count("spgemm"))     benchmark_spgemm(matrix, host, options, results);
+        if (suites.count("conversion")) benchmark_conversions(matrix, host, options, results);
+        if (suites.count("blas"))       benchmark_blas(matrix, host, options, results);
+
+        if (suites.count("solver") || suites.count("amg"))
+            benchmark_solvers(matrix, host, suites, options, results);
+    }
+
+    const device_description device = describe_device();
+    const std::string value_type = sizeof(ValueType) == 4 ? "float" : "double";
+    const std::string json = args.count("json") ? args["json"] : "benchmark_results.json";
+    const std::string csv  = args.count("csv")  ? args["csv"]  : "benchmark_results.csv";
+
+    if (!write_json(json, device, value_type, options, results))
+        std::cerr << "unable to write " << json << std::endl;
+    if (!write_csv(csv, device, value_type, results))
+        std::cerr << "unable to write " << csv << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    process_args(argc, argv);
+
+    if (args.count("help"))
+    {
+        usage(argc, argv);
+        return 0;
+    }
+
+    cudaSetDevice(args.count("device") ? atoi(args["device"].c_str()) : 0);
+
+    benchmark_options options;
+    if (args.count("warmup"))      options.warmup      = atoi(args["warmup"].c_str());
+    if (args.count("repetitions")) options.repetitions = std::max(1, atoi(args["repetitions"].c_str()));
+
+    std::vector<manifest_entry> manifest;
+
+    try
+    {
+        manifest = args.count("manifest") ? read_manifest(args["manifest"]) : default_manifest();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    const std::string value_type = args.count("value_type") ? args["value_type"] : "double";
+
+    if (value_type == "float")
+        run_suite<float>(manifest, options);
+    else if (value_type == "double")
+        run_suite<double>(manifest, options);
+    else
+    {
+        std::cerr << "ERROR: Unsupported type \'" << value_type << "\'\n\n";
+        return 1;
+    }
+
+    return 0;
+}
+
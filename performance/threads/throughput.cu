@@ -0,0 +1,139 @@
+#include <cusp/csr_matrix.h>
+#include <cusp/array1d.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/stream.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/io/matrix_market.h>
+#include <cusp/krylov/cg.h>
+
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// Throughput of independent solves issued from several host threads.
+// Every thread uses its own stream and its own vectors and solves with
+// a shared (const) matrix, so the solves run without any serialization.
+
+typedef int                                             IndexType;
+typedef double                                          ValueType;
+typedef cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> DeviceMatrix;
+
+struct worker
+{
+    const DeviceMatrix * A;
+    size_t num_solves;
+    size_t num_iterations;
+};
+
+double wall_seconds(void)
+{
+    timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + 1e-6 * t.tv_usec;
+}
+
+void * solve_loop(void * arg)
+{
+    worker& w = *static_cast<worker *>(arg);
+
+    cudaStream_t stream;
+    cudaStreamCreate(&stream);
+
+    {
+        cusp::scoped_stream scope(stream);
+
+        const size_t N = w.A->num_rows;
+
+        cusp::array1d<ValueType, cusp::device_memory> x(N);
+        cusp::array1d<ValueType, cusp::device_memory> b(N, 1);
+
+        w.num_iterations = 0;
+
+        for (size_t i = 0; i < w.num_solves; i++)
+        {
+            cusp::blas::fill(x, ValueType(0));
+
+            cusp::default_monitor<ValueType> monitor(b, 100, 1e-5);
+            cusp::krylov::cg(*w.A, x, b, monitor);
+
+            w.num_iterations += monitor.iteration_count();
+        }
+
+        cudaStreamSynchronize(stream);
+    }
+
+    cudaStreamDestroy(stream);
+
+    return 0;
+}
+
+// solves per second with the given number of host threads
+double benchmark_threads(const DeviceMatrix& A, size_t num_threads, size_t solves_per_thread)
+{
+    std::vector<worker>    workers(num_threads);
+    std::vector<pthread_t> threads(num_threads);
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        workers[i].A          = &A;
+        workers[i].num_solves = solves_per_thread;
+    }
+
+    cudaDeviceSynchronize();
+
+    const double start = wall_seconds();
+
+    for (size_t i = 0; i < num_threads; i++)
+        pthread_create(&threads[i], 0, solve_loop, &workers[i]);
+
+    for (size_t i = 0; i < num_threads; i++)
+        pthread_join(threads[i], 0);
+
+    const double seconds = wall_seconds() - start;
+
+    return double(num_threads * solves_per_thread) / seconds;
+}
+
+int main(int argc, char** argv)
+{
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> H;
+
+    if (argc == 1)
+    {
+        // small systems, whose solves are dominated by launch latency
+        std::cout << "Using default matrix (5-pt Laplacian stencil)" << std::endl;
+        cusp::gallery::poisson5pt(H, 64, 64);
+    }
+    else
+    {
+        std::cout << "Reading matrix from file: " << argv[1] << std::endl;
+        cusp::io::read_matrix_market_file(H, std::string(argv[1]));
+    }
+
+    DeviceMatrix A(H);
+
+    const size_t solves_per_thread = 20;
+
+    // warm up
+    benchmark_threads(A, 1, 2);
+
+    const double base = benchmark_threads(A, 1, solves_per_thread);
+
+    std::cout << " threads | solves/s | speedup" << std::endl;
+
+    for (size_t num_threads = 1; num_threads <= 16; num_threads *= 2)
+    {
+        const double rate = num_threads == 1 ? base : benchmark_threads(A, num_threads, solves_per_thread);
+
+        std::cout << std::setw(8)  << num_threads << " | "
+                  << std::setw(8)  << std::fixed << std::setprecision(1) << rate << " | "
+                  << std::setw(7)  << std::setprecision(2) << rate / base << std::endl;
+    }
+
+    return 0;
+}
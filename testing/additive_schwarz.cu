@@ -0,0 +1,156 @@
+#include <unittest/unittest.h>
+
+#include <cusp/precond/additive_schwarz.h>
+#include <cusp/precond/block_jacobi.h>
+#include <cusp/precond/ilu.h>
+
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/stream.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/gmres.h>
+
+template <class MemorySpace>
+void TestAdditiveSchwarzWithoutOverlap(void)
+{
+    // ILU(0) of a tridiagonal block is exact, so without overlap the
+    // preconditioner inverts the blocks of the block diagonal of A
+    cusp::array2d<float, cusp::host_memory> D(7,7,0.0f);
+    for (int i = 0; i < 7; i++)
+    {
+        D(i,i) = 4.0f;
+        if (i > 0) D(i,i-1) = -1.0f;
+        if (i < 6) D(i,i+1) = -2.0f;
+    }
+
+    cusp::csr_matrix<int, float, MemorySpace> A(D);
+
+    cusp::array1d<int, cusp::host_memory> offsets(4);
+    offsets[0] = 0; offsets[1] = 2; offsets[2] = 5; offsets[3] = 7;
+
+    cusp::precond::additive_schwarz<float, MemorySpace> M(A, offsets);
+    cusp::precond::block_jacobi<float, MemorySpace>     J(A, offsets);
+
+    ASSERT_EQUAL(M.num_subdomains(), (size_t) 3);
+    ASSERT_EQUAL(M.subdomain_size(1), (size_t) 3);
+
+    cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(7);
+    cusp::array1d<float, MemorySpace> y1(7);
+    cusp::array1d<float, MemorySpace> y2(7);
+
+    cusp::multiply(M, x, y1);
+    cusp::multiply(J, x, y2);
+
+    ASSERT_ALMOST_EQUAL(y1, y2);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAdditiveSchwarzWithoutOverlap);
+
+template <class MemorySpace>
+void TestAdditiveSchwarzOverlap(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 12);
+
+    // one subdomain covers the matrix, whatever the overlap
+    {
+        cusp::precond::additive_schwarz<float, MemorySpace> M(A, 1, 2);
+        cusp::precond::ilu0<float, MemorySpace>             ILU(A);
+
+        ASSERT_EQUAL(M.subdomain_size(0), (size_t) A.num_rows);
+
+        cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(A.num_rows);
+        cusp::array1d<float, MemorySpace> y1(A.num_rows);
+        cusp::array1d<float, MemorySpace> y2(A.num_rows);
+
+        cusp::multiply(M,   x, y1);
+        cusp::multiply(ILU, x, y2);
+
+        ASSERT_ALMOST_EQUAL(y1, y2);
+    }
+
+    // the overlap adds rows to every subdomain
+    cusp::precond::additive_schwarz<float, MemorySpace> M0(A, 4, 0);
+    cusp::precond::additive_schwarz<float, MemorySpace> M1(A, 4, 1);
+
+    ASSERT_EQUAL(M0.num_subdomains(), (size_t) 4);
+    ASSERT_EQUAL(M1.num_subdomains(), (size_t) 4);
+
+    size_t rows0 = 0;
+    size_t rows1 = 0;
+    for (size_t k = 0; k < 4; k++)
+    {
+        rows0 += M0.subdomain_size(k);
+        rows1 += M1.subdomain_size(k);
+        ASSERT_EQUAL(M1.subdomain_size(k) > M0.subdomain_size(k), true);
+    }
+    ASSERT_EQUAL(rows0, (size_t) A.num_rows);
+    ASSERT_EQUAL(rows1 > rows0, true);
+
+    cusp::array1d<float, MemorySpace> b = unittest::random_samples<float>(A.num_rows);
+
+    size_t iterations;
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+        cusp::krylov::gmres(A, x, b, 30, monitor, M0);
+        ASSERT_EQUAL(monitor.converged(), true);
+        iterations = monitor.iteration_count();
+    }
+
+    // the overlap improves the preconditioner
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+        cusp::krylov::gmres(A, x, b, 30, monitor, M1);
+        ASSERT_EQUAL(monitor.converged(), true);
+        ASSERT_EQUAL(monitor.iteration_count() <= iterations, true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAdditiveSchwarzOverlap);
+
+void TestAdditiveSchwarzStream(void)
+{
+    cusp::csr_matrix<int, float, cusp::device_memory> A;
+    cusp::gallery::poisson5pt(A, 16, 16);
+
+    cusp::precond::additive_schwarz<float, cusp::device_memory> M(A, 8, 1);
+
+    cusp::array1d<float, cusp::device_memory> x = unittest::random_samples<float>(A.num_rows);
+    cusp::array1d<float, cusp::device_memory> y1(A.num_rows);
+    cusp::array1d<float, cusp::device_memory> y2(A.num_rows, 0.0f);
+
+    cusp::multiply(M, x, y1);
+
+    // the subdomains are ordered after the work of the caller's stream
+    cudaStream_t s;
+    cudaStreamCreate(&s);
+    {
+        cusp::scoped_stream scope(s);
+        cusp::multiply(M, x, y2);
+    }
+    cudaStreamSynchronize(s);
+    cudaStreamDestroy(s);
+
+    ASSERT_EQUAL(y1, y2);
+}
+DECLARE_UNITTEST(TestAdditiveSchwarzStream);
+
+void TestAdditiveSchwarzErrors(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 4, 4);
+
+    typedef cusp::precond::additive_schwarz<float, cusp::host_memory> Preconditioner;
+
+    ASSERT_THROWS((Preconditioner(A, 0)), cusp::invalid_input_exception);
+
+    cusp::array1d<int, cusp::host_memory> offsets(3);
+    offsets[0] = 0; offsets[1] = 8; offsets[2] = 15;
+    ASSERT_THROWS((Preconditioner(A, offsets)), cusp::invalid_input_exception);
+
+    offsets[1] = 0; offsets[2] = 16;
+    ASSERT_THROWS((Preconditioner(A, offsets)), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestAdditiveSchwarzErrors);
@@ -1,6 +1,8 @@
 #include <unittest/unittest.h>
 
 #include <cusp/precond/ainv.h>
+#include <cusp/blas.h>
+#include <cusp/multiply.h>
 
 #include <cusp/gallery/poisson.h>
 #include <cusp/krylov/cg.h>
@@ -56,6 +58,33 @@ void TestAINVHeap(void)
 }
 DECLARE_UNITTEST(TestAINVHeap);
 
+void TestAINVSparseVector(void)
+{
+  cusp::precond::detail::ainv_sparse_vector<int, float> v(10);
+
+  v.add_to_value(7, 1.0f);
+  v.add_to_value(2, 3.0f);
+  v.add_to_value(7, 1.0f);
+  v.mult_by_scalar(0.5f);
+
+  ASSERT_EQUAL(v.indices.size(), (size_t) 2);
+  ASSERT_EQUAL(v.has_entry_at_index(7), true);
+  ASSERT_EQUAL(v.has_entry_at_index(3), false);
+  ASSERT_EQUAL(v[7], 1.0f);
+  ASSERT_EQUAL(v[2], 1.5f);
+
+  // the buffer is reset for the next product
+  v.clear();
+  v.add_to_value(3, 2.0f);
+
+  ASSERT_EQUAL(v.indices.size(), (size_t) 1);
+  ASSERT_EQUAL(v.has_entry_at_index(7), false);
+  ASSERT_EQUAL(v[7], 0.0f);
+  ASSERT_EQUAL(v[3], 2.0f);
+}
+DECLARE_UNITTEST(TestAINVSparseVector);
+
+
 
 void TestAINVFactorization(void)
 {
@@ -258,3 +287,34 @@ void TestAINVConvergence(void)
 }
 DECLARE_UNITTEST(TestAINVConvergence);
 
+
+template <class MemorySpace>
+void TestAINVApply(void)
+{
+    typedef float ValueType;
+
+    cusp::csr_matrix<int,ValueType,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<ValueType,MemorySpace> x = unittest::random_samples<ValueType>(A.num_rows);
+    cusp::array1d<ValueType,MemorySpace> y(A.num_rows);
+    cusp::array1d<ValueType,MemorySpace> y_ref(A.num_rows);
+
+    cusp::precond::bridson_ainv<ValueType,MemorySpace> M(A, .1);
+
+    // y_ref <- W^T D W x, unfused
+    {
+        cusp::array1d<ValueType,MemorySpace> t1(A.num_rows), t2(A.num_rows);
+        cusp::multiply(M.w, x, t1);
+        cusp::blas::xmy(t1, M.diagonals, t2);
+        cusp::multiply(M.w_t, t2, y_ref);
+    }
+
+    cusp::multiply(M, x, y);
+    ASSERT_ALMOST_EQUAL(y, y_ref);
+
+    // the intermediate vector is reused
+    cusp::multiply(M, x, y);
+    ASSERT_ALMOST_EQUAL(y, y_ref);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAINVApply);
@@ -0,0 +1,140 @@
+#include <unittest/unittest.h>
+
+#include <cusp/analyze.h>
+
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/gallery/random.h>
+
+#include <cusp/detail/host/conversion_utils.h>
+
+template <typename Matrix>
+void TestAnalyzePoisson(void)
+{
+    // 4x3 grid: 4 corners with 3 entries, 6 edges with 4 and 2 interior points with 5
+    cusp::csr_matrix<int, float, cusp::host_memory> P;
+    cusp::gallery::poisson5pt(P, 4, 3);
+
+    Matrix A(P);
+
+    const cusp::matrix_analysis analysis = cusp::analyze(A);
+
+    ASSERT_EQUAL(analysis.num_rows,    (size_t) 12);
+    ASSERT_EQUAL(analysis.num_cols,    (size_t) 12);
+    ASSERT_EQUAL(analysis.num_entries, (size_t) 46);
+
+    ASSERT_EQUAL(analysis.row_length_histogram.size(), (size_t) 6);
+    ASSERT_EQUAL(analysis.row_length_histogram[2], (size_t) 0);
+    ASSERT_EQUAL(analysis.row_length_histogram[3], (size_t) 4);
+    ASSERT_EQUAL(analysis.row_length_histogram[4], (size_t) 6);
+    ASSERT_EQUAL(analysis.row_length_histogram[5], (size_t) 2);
+    ASSERT_EQUAL(analysis.min_row_length, (size_t) 3);
+    ASSERT_EQUAL(analysis.max_row_length, (size_t) 5);
+
+    // the bandwidth is the width of the grid
+    ASSERT_EQUAL(analysis.lower_bandwidth, (size_t) 4);
+    ASSERT_EQUAL(analysis.upper_bandwidth, (size_t) 4);
+    ASSERT_EQUAL(analysis.profile,         (size_t) (3 * 1 + 8 * 4));
+    ASSERT_EQUAL(analysis.num_diagonals,   (size_t) 5);
+
+    ASSERT_EQUAL(analysis.structurally_symmetric, true);
+    ASSERT_EQUAL(analysis.numerically_symmetric,  true);
+    ASSERT_EQUAL(analysis.num_dominant_rows, (size_t) 12);
+    ASSERT_EQUAL(analysis.min_abs_value, 1.0);
+    ASSERT_EQUAL(analysis.max_abs_value, 4.0);
+
+    // ELL storage at each width
+    ASSERT_EQUAL(analysis.ell_entries(4), (size_t) 44);
+    ASSERT_EQUAL(analysis.ell_padding(4), (size_t) 4);
+    ASSERT_EQUAL(analysis.ell_entries(5), (size_t) 46);
+    ASSERT_EQUAL(analysis.ell_padding(5), (size_t) 14);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestAnalyzePoisson);
+
+template <typename Matrix>
+void TestAnalyzeNonsymmetric(void)
+{
+    // structurally nonsymmetric
+    {
+        cusp::array2d<float, cusp::host_memory> D(3,3,0.0f);
+        D(0,0) =  1;  D(0,1) = -2;
+                      D(1,1) =  3;
+                      D(2,1) =  4;  D(2,2) = -5;
+
+        Matrix A(D);
+
+        const cusp::matrix_analysis analysis = cusp::analyze(A);
+
+        ASSERT_EQUAL(analysis.lower_bandwidth, (size_t) 1);
+        ASSERT_EQUAL(analysis.upper_bandwidth, (size_t) 1);
+        ASSERT_EQUAL(analysis.profile,         (size_t) 1);
+        ASSERT_EQUAL(analysis.num_diagonals,   (size_t) 3);
+
+        ASSERT_EQUAL(analysis.structurally_symmetric, false);
+        ASSERT_EQUAL(analysis.numerically_symmetric,  false);
+        ASSERT_EQUAL(analysis.num_dominant_rows, (size_t) 2);
+        ASSERT_EQUAL(analysis.min_abs_value, 1.0);
+        ASSERT_EQUAL(analysis.max_abs_value, 5.0);
+    }
+
+    // structurally symmetric only
+    {
+        cusp::array2d<float, cusp::host_memory> D(2,2);
+        D(0,0) = 1;  D(0,1) = 2;
+        D(1,0) = 3;  D(1,1) = 4;
+
+        Matrix A(D);
+
+        const cusp::matrix_analysis analysis = cusp::analyze(A);
+
+        ASSERT_EQUAL(analysis.structurally_symmetric, true);
+        ASSERT_EQUAL(analysis.numerically_symmetric,  false);
+    }
+
+    // rectangular with an empty row
+    {
+        cusp::array2d<float, cusp::host_memory> D(3,2,0.0f);
+        D(0,0) = 1;  D(0,1) = 2;
+        D(2,1) = 3;
+
+        Matrix A(D);
+
+        const cusp::matrix_analysis analysis = cusp::analyze(A);
+
+        ASSERT_EQUAL(analysis.row_length_histogram.size(), (size_t) 3);
+        ASSERT_EQUAL(analysis.row_length_histogram[0], (size_t) 1);
+        ASSERT_EQUAL(analysis.row_length_histogram[1], (size_t) 1);
+        ASSERT_EQUAL(analysis.row_length_histogram[2], (size_t) 1);
+        ASSERT_EQUAL(analysis.lower_bandwidth, (size_t) 1);
+        ASSERT_EQUAL(analysis.upper_bandwidth, (size_t) 1);
+        ASSERT_EQUAL(analysis.structurally_symmetric, false);
+        ASSERT_EQUAL(analysis.num_dominant_rows, (size_t) 0);
+    }
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestAnalyzeNonsymmetric);
+
+template <class MemorySpace>
+void TestAnalyzeHybEntriesPerRow(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::random_power_law(1000, 800, 20000, 0.5, A, 7);
+
+    const cusp::matrix_analysis analysis = cusp::analyze(A);
+
+    const cusp::csr_matrix<int, float, cusp::host_memory> B(A);
+
+    // the conversion to HYB chooses the same width
+    ASSERT_EQUAL(analysis.hyb_entries_per_row(), cusp::detail::host::compute_optimal_entries_per_row(B));
+    ASSERT_EQUAL(analysis.hyb_entries_per_row(3.0f, 0), cusp::detail::host::compute_optimal_entries_per_row(B, 3.0f, 0));
+    ASSERT_EQUAL(analysis.hyb_entries_per_row(1.5f, 0), cusp::detail::host::compute_optimal_entries_per_row(B, 1.5f, 0));
+
+    ASSERT_EQUAL(analysis.ell_entries(analysis.max_row_length), (size_t) B.num_entries);
+    ASSERT_EQUAL(analysis.ell_padding(0), (size_t) 0);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAnalyzeHybEntriesPerRow);
@@ -0,0 +1,116 @@
+#include <unittest/unittest.h>
+
+#include <cusp/any_matrix.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/cg.h>
+
+template <class Space>
+void TestAnyMatrixFormats(void)
+{
+    typedef cusp::any_matrix<float, Space> Matrix;
+
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 10, 12);
+
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 5) - 2;
+
+    cusp::array1d<float, cusp::host_memory> y(A.num_rows);
+    cusp::multiply(A, x, y);
+
+    Matrix M;
+    ASSERT_EQUAL(M.stored_format(), Matrix::csr);
+    ASSERT_EQUAL(M.num_rows, 0);
+
+    M = cusp::coo_matrix<int, float, cusp::host_memory>(A);
+    ASSERT_EQUAL(M.stored_format(), Matrix::coo);
+    ASSERT_EQUAL(M.num_rows,    A.num_rows);
+    ASSERT_EQUAL(M.num_cols,    A.num_cols);
+    ASSERT_EQUAL(M.num_entries, A.num_entries);
+
+    typename Matrix::format_type formats[5] = { Matrix::coo, Matrix::csr, Matrix::dia, Matrix::ell, Matrix::hyb };
+
+    for (int i = 0; i < 5; i++)
+    {
+        M.convert_to(formats[i]);
+        ASSERT_EQUAL(M.stored_format(), formats[i]);
+        ASSERT_EQUAL(M.num_entries,     A.num_entries);
+
+        cusp::array1d<float, Space> d_x(x);
+        cusp::array1d<float, Space> d_y(A.num_rows, 10);
+        cusp::multiply(M, d_x, d_y);
+
+        ASSERT_EQUAL(d_y, y);
+    }
+
+    // copies are deep and keep the format
+    Matrix N(M);
+    M.convert_to(Matrix::csr);
+    ASSERT_EQUAL(N.stored_format(), Matrix::hyb);
+    ASSERT_EQUAL(M.stored_format(), Matrix::csr);
+
+    N.swap(M);
+    ASSERT_EQUAL(N.stored_format(), Matrix::csr);
+    ASSERT_EQUAL(M.stored_format(), Matrix::hyb);
+
+    cusp::array2d<float, cusp::host_memory> B(M.template get<typename Matrix::hyb_matrix_type>());
+    cusp::array2d<float, cusp::host_memory> C(A);
+    ASSERT_EQUAL(B == C, true);
+
+    ASSERT_THROWS(M.template get<typename Matrix::csr_matrix_type>(), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAnyMatrixFormats);
+
+template <class Space>
+void TestAnyMatrixConstruct(void)
+{
+    typedef cusp::any_matrix<float, Space> Matrix;
+
+    cusp::array2d<float, cusp::host_memory> A(2, 3);
+    A(0,0) = 1;  A(0,1) = 0;  A(0,2) = 2;
+    A(1,0) = 0;  A(1,1) = 3;  A(1,2) = 0;
+
+    // other formats are stored as CSR
+    Matrix M(A);
+    ASSERT_EQUAL(M.stored_format(), Matrix::csr);
+    ASSERT_EQUAL(M.num_entries, 3);
+
+    Matrix N(cusp::ell_matrix<int, float, Space>(M.template get<typename Matrix::csr_matrix_type>()));
+    ASSERT_EQUAL(N.stored_format(), Matrix::ell);
+
+    cusp::array2d<float, cusp::host_memory> B(N.template get<typename Matrix::ell_matrix_type>());
+    ASSERT_EQUAL(B == A, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAnyMatrixConstruct);
+
+template <class Space>
+void TestAnyMatrixSelectFormat(void)
+{
+    typedef cusp::any_matrix<float, Space> Matrix;
+
+    cusp::coo_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    Matrix M(A);
+    ASSERT_EQUAL(M.stored_format(), Matrix::coo);
+
+    cusp::format_selection selection = M.select_format();
+
+    ASSERT_EQUAL(selection.format, cusp::select_format(A).format);
+    ASSERT_EQUAL(M.stored_format() != Matrix::coo, true);
+
+    // the solver is instantiated once for any format
+    cusp::array1d<float, Space> x(A.num_rows, 0);
+    cusp::array1d<float, Space> b(A.num_rows, 1);
+
+    cusp::default_monitor<float> monitor(b, 200, 1e-5);
+    cusp::krylov::cg(M, x, b, monitor);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAnyMatrixSelectFormat);
@@ -0,0 +1,68 @@
+#include <unittest/unittest.h>
+
+#include <cusp/detail/device/arch.h>
+
+void TestLaunchTuningTable(void)
+{
+    namespace arch = cusp::detail::device::arch;
+
+    // every compute capability maps to the newest row it satisfies
+    ASSERT_EQUAL(arch::tuning( 0).sm_version,  0);
+    ASSERT_EQUAL(arch::tuning(13).sm_version,  0);
+    ASSERT_EQUAL(arch::tuning(21).sm_version, 20);
+    ASSERT_EQUAL(arch::tuning(61).sm_version, 30);
+    ASSERT_EQUAL(arch::tuning(90).sm_version, 70);
+
+    for (int sm_version = 0; sm_version <= 100; sm_version++)
+    {
+        const arch::launch_tuning& t = arch::tuning(sm_version);
+
+        ASSERT_EQUAL(t.sm_version <= sm_version, true);
+        ASSERT_EQUAL(t.block_size % 32, (size_t) 0);
+        ASSERT_EQUAL(t.block_size >= 64 && t.block_size <= 1024, true);
+        ASSERT_EQUAL(t.grid_waves >= 1, true);
+    }
+}
+DECLARE_UNITTEST(TestLaunchTuningTable);
+
+void TestLaunchTuningCurrentDevice(void)
+{
+    namespace arch = cusp::detail::device::arch;
+
+    const arch::device_info& info = arch::current_device_info();
+
+    ASSERT_EQUAL(info.num_multiprocessors >= 1, true);
+    ASSERT_EQUAL(arch::block_size(), arch::tuning(info.sm_version).block_size);
+
+    // small matrices fill at most one block per multiprocessor
+    ASSERT_EQUAL(arch::small_launch_size(), info.num_multiprocessors * arch::block_size());
+
+    // the properties are cached
+    ASSERT_EQUAL(&arch::current_device_info(), &info);
+}
+DECLARE_UNITTEST(TestLaunchTuningCurrentDevice);
+
+__global__ void occupancy_test_kernel(int * x)
+{
+    x[threadIdx.x] = 0;
+}
+
+void TestOccupancyCache(void)
+{
+    namespace arch = cusp::detail::device::arch;
+
+    const size_t blocks = arch::max_active_blocks(occupancy_test_kernel, 128, 0);
+    const size_t size   = arch::occupancy_cache_size();
+
+    ASSERT_EQUAL(blocks >= 1, true);
+
+    // repeated queries are served by the cache
+    ASSERT_EQUAL(arch::max_active_blocks(occupancy_test_kernel, 128, 0), blocks);
+    ASSERT_EQUAL(arch::occupancy_cache_size(), size);
+
+    // other launch configurations are cached separately
+    arch::max_active_blocks(occupancy_test_kernel, 256, 0);
+    ASSERT_EQUAL(arch::occupancy_cache_size(), size + 1);
+}
+DECLARE_UNITTEST(TestOccupancyCache);
+
@@ -464,6 +464,32 @@ void TestArray1dViewZipIterator(void)
 DECLARE_HOST_DEVICE_UNITTEST(TestArray1dViewZipIterator);
 
 
+template <typename MemorySpace>
+void TestMakeStridedArray1dView(void)
+{
+  cusp::array1d<int, MemorySpace> A(7);
+  A[0] = 0; A[1] = 1; A[2] = 2; A[3] = 3; A[4] = 4; A[5] = 5; A[6] = 6;
+
+  // elements 1, 3 and 5
+  typename cusp::strided_array1d_view<typename cusp::array1d<int, MemorySpace>::iterator>::type
+    V = cusp::make_strided_array1d_view(A.begin() + 1, 3, 2);
+
+  ASSERT_EQUAL(V.size(), 3);
+  ASSERT_EQUAL(V[0], 1);
+  ASSERT_EQUAL(V[1], 3);
+  ASSERT_EQUAL(V[2], 5);
+
+  // the view references the underlying array
+  V[1] = 30;
+  ASSERT_EQUAL(A[3], 30);
+
+  cusp::array1d<int, MemorySpace> B(V);
+  ASSERT_EQUAL(B.size(), 3);
+  ASSERT_EQUAL(B[1], 30);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMakeStridedArray1dView);
+
+
 template <typename MemorySpace>
 void TestArray1dViewEquality(void)
 {
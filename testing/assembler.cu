@@ -0,0 +1,83 @@
+#include <unittest/unittest.h>
+
+#include <cusp/array2d.h>
+#include <cusp/assembler.h>
+#include <cusp/csr_matrix.h>
+
+// connectivity of an nx by ny grid of 4-node elements
+template <typename Array>
+void quad_mesh(Array& connectivity, int nx, int ny)
+{
+    connectivity.resize(4 * nx * ny);
+
+    for (int j = 0; j < ny; j++)
+        for (int i = 0; i < nx; i++)
+        {
+            int e = j * nx + i;
+            connectivity[4 * e + 0] = (j + 0) * (nx + 1) + i + 0;
+            connectivity[4 * e + 1] = (j + 0) * (nx + 1) + i + 1;
+            connectivity[4 * e + 2] = (j + 1) * (nx + 1) + i + 1;
+            connectivity[4 * e + 3] = (j + 1) * (nx + 1) + i + 0;
+        }
+}
+
+template <class Space>
+void TestAssembler(void)
+{
+    const int nx = 3, ny = 2, num_nodes = (nx + 1) * (ny + 1);
+
+    cusp::array1d<int, cusp::host_memory> connectivity;
+    quad_mesh(connectivity, nx, ny);
+
+    cusp::assembler<int, float, Space> assembler(num_nodes, 4, cusp::array1d<int, Space>(connectivity));
+
+    ASSERT_EQUAL(assembler.num_elements, (size_t) (nx * ny));
+
+    // 4 corner nodes with 4 neighbors, 6 edge nodes with 6 and 2 interior nodes with 9
+    ASSERT_EQUAL(assembler.num_entries(), (size_t) (4 * 4 + 6 * 6 + 2 * 9));
+
+    cusp::csr_matrix<int, float, Space> A;
+
+    for (int step = 1; step <= 2; step++)
+    {
+        cusp::array1d<float, cusp::host_memory> K(16 * nx * ny);
+        cusp::array2d<float, cusp::host_memory> expected(num_nodes, num_nodes, 0.0f);
+
+        for (int e = 0; e < nx * ny; e++)
+            for (int a = 0; a < 4; a++)
+                for (int b = 0; b < 4; b++)
+                {
+                    K[16 * e + 4 * a + b] = float(step * (e + 1) + 4 * a + b);
+                    expected(connectivity[4 * e + a], connectivity[4 * e + b]) += K[16 * e + 4 * a + b];
+                }
+
+        // the second step reuses the pattern of A
+        assembler.assemble(cusp::array1d<float, Space>(K), A);
+
+        ASSERT_EQUAL(A.num_rows,    (size_t) num_nodes);
+        ASSERT_EQUAL(A.num_entries, assembler.num_entries());
+
+        cusp::array2d<float, cusp::host_memory> result(A);
+        ASSERT_EQUAL(result.values, expected.values);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAssembler);
+
+void TestAssemblerInvalidInput(void)
+{
+    cusp::array1d<int, cusp::host_memory> connectivity(4);
+    connectivity[0] = 0; connectivity[1] = 1; connectivity[2] = 1; connectivity[3] = 2;
+
+    cusp::assembler<int, float, cusp::host_memory> assembler;
+
+    ASSERT_THROWS(assembler.setup(3, 3, connectivity), cusp::invalid_input_exception);
+    ASSERT_THROWS(assembler.setup(2, 2, connectivity), cusp::invalid_input_exception);
+
+    assembler.setup(3, 2, connectivity);
+
+    cusp::array1d<float, cusp::host_memory> K(7);
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+
+    ASSERT_THROWS(assembler.assemble(K, A), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestAssemblerInvalidInput);
@@ -0,0 +1,146 @@
+#include <unittest/unittest.h>
+#include <cusp/auto_format_matrix.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+// poisson5pt with a dense first row
+template <typename Matrix>
+void irregular_matrix(Matrix& matrix, size_t n)
+{
+    cusp::coo_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, n, n);
+
+    cusp::coo_matrix<int, float, cusp::host_memory> B(A.num_rows, A.num_cols, 0);
+    for (size_t i = 0; i < A.num_entries; i++)
+    {
+        if (A.row_indices[i] == 0)
+            continue;
+        B.row_indices.push_back(A.row_indices[i]);
+        B.column_indices.push_back(A.column_indices[i]);
+        B.values.push_back(A.values[i]);
+    }
+    for (size_t j = 0; j < A.num_cols; j++)
+    {
+        B.row_indices.push_back(0);
+        B.column_indices.push_back(j);
+        B.values.push_back(float(j % 5) + 1);
+    }
+    B.num_entries = B.values.size();
+    B.sort_by_row_and_column();
+
+    matrix = B;
+}
+
+template <class Space>
+void TestSelectFormat(void)
+{
+    cusp::csr_matrix<int, float, Space> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::format_selection selection = cusp::select_format(A);
+
+    ASSERT_EQUAL(selection.format,              cusp::format_selection::dia);
+    ASSERT_EQUAL(selection.num_diagonals,       5);
+    ASSERT_EQUAL(selection.max_entries_per_row, 5);
+    ASSERT_EQUAL(selection.admissible[cusp::format_selection::csr], true);
+    ASSERT_EQUAL(selection.admissible[cusp::format_selection::dia], true);
+    ASSERT_EQUAL(selection.admissible[cusp::format_selection::ell], true);
+    ASSERT_EQUAL(selection.admissible[cusp::format_selection::hyb], true);
+
+    cusp::coo_matrix<int, float, Space> B;
+    irregular_matrix(B, 10);
+
+    selection = cusp::select_format(B);
+
+    ASSERT_EQUAL(selection.format,              cusp::format_selection::csr);
+    ASSERT_EQUAL(selection.max_entries_per_row, 100);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSelectFormat);
+
+template <class Space>
+void TestSelectFormatMaxFill(void)
+{
+    cusp::csr_matrix<int, float, Space> A;
+    irregular_matrix(A, 120);
+
+    // 14400 rows with a dense row of 14400 entries exceeds 1M entries
+    cusp::format_selection selection = cusp::select_format(A);
+
+    ASSERT_EQUAL(selection.admissible[cusp::format_selection::dia], false);
+    ASSERT_EQUAL(selection.admissible[cusp::format_selection::ell], false);
+    ASSERT_EQUAL(selection.format == cusp::format_selection::csr ||
+                 selection.format == cusp::format_selection::hyb, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSelectFormatMaxFill);
+
+template <class Space>
+void TestAutoFormatMatrixConversion(void)
+{
+    cusp::array2d<float, cusp::host_memory> A(4, 4, 0);
+    A(0,0) = 10; A(0,1) =  20;
+    A(1,1) = 30; A(1,2) =  40;
+    A(2,2) = 50;
+    A(3,0) = 60; A(3,3) =  70;
+
+    cusp::auto_format_matrix<int, float, Space> B(A);
+
+    ASSERT_EQUAL(B.num_rows,    4);
+    ASSERT_EQUAL(B.num_cols,    4);
+    ASSERT_EQUAL(B.num_entries, 7);
+
+    cusp::array2d<float, cusp::host_memory> C(B);
+    ASSERT_EQUAL(C == A, true);
+
+    cusp::csr_matrix<int, float, Space> D(B);
+    cusp::array2d<float, cusp::host_memory> E(D);
+    ASSERT_EQUAL(E == A, true);
+
+    cusp::auto_format_matrix<int, float, cusp::host_memory> F(B);
+    ASSERT_EQUAL(F.selection.format, B.selection.format);
+
+    cusp::array2d<float, cusp::host_memory> G(F);
+    ASSERT_EQUAL(G == A, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAutoFormatMatrixConversion);
+
+template <class Space>
+void TestAutoFormatMatrixMultiply(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::csr_matrix<int, float, cusp::host_memory> B;
+    cusp::gallery::poisson5pt(A, 20, 20);
+    irregular_matrix(B, 20);
+
+    for (size_t n = 0; n < 4; n++)
+    {
+        const cusp::csr_matrix<int, float, cusp::host_memory>& M = n % 2 ? B : A;
+
+        cusp::array1d<float, cusp::host_memory> x(M.num_cols);
+        for (size_t i = 0; i < x.size(); i++)
+            x[i] = float(i % 7) - 3;
+
+        cusp::array1d<float, cusp::host_memory> y(M.num_rows, 0);
+        cusp::multiply(M, x, y);
+
+        cusp::format_selection_options options;
+        options.benchmark            = n >= 2;
+        options.benchmark_iterations = 2;
+
+        cusp::auto_format_matrix<int, float, Space> C(M, options);
+
+        ASSERT_EQUAL(C.selection.admissible[C.selection.format], true);
+
+        cusp::array1d<float, Space> d_x(x);
+        cusp::array1d<float, Space> d_y(M.num_rows, 10);
+        cusp::multiply(C, d_x, d_y);
+
+        cusp::array1d<float, cusp::host_memory> z(d_y);
+
+        ASSERT_ALMOST_EQUAL(z, y);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAutoFormatMatrixMultiply);
+
@@ -0,0 +1,91 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/krylov/batched_cg.h>
+
+template <class MemorySpace>
+void TestBatchedConjugateGradient(void)
+{
+    // three independent systems of different sizes, one of them empty
+    cusp::coo_matrix<int, float, cusp::host_memory> P0, P1;
+    cusp::gallery::poisson5pt(P0, 10, 10);
+    cusp::gallery::poisson5pt(P1,  7,  5);
+
+    const int N0 = P0.num_rows;
+    const int N1 = P1.num_rows;
+    const int N  = N0 + N1;
+
+    cusp::coo_matrix<int, float, cusp::host_memory> M(N, N, P0.num_entries + P1.num_entries);
+    for (size_t n = 0; n < P0.num_entries; n++)
+    {
+        M.row_indices[n] = P0.row_indices[n]; M.column_indices[n] = P0.column_indices[n]; M.values[n] = P0.values[n];
+    }
+    for (size_t n = 0; n < P1.num_entries; n++)
+    {
+        size_t m = P0.num_entries + n;
+        M.row_indices[m] = N0 + P1.row_indices[n]; M.column_indices[m] = N0 + P1.column_indices[n]; M.values[m] = P1.values[n];
+    }
+
+    cusp::csr_matrix<int, float, MemorySpace> A(M);
+
+    cusp::array1d<int, MemorySpace> offsets(4);
+    offsets[0] = 0; offsets[1] = N0; offsets[2] = N0; offsets[3] = N;
+
+    cusp::array1d<float, MemorySpace> x(N, 0.0f);
+    cusp::array1d<float, MemorySpace> b(N, 1.0f);
+
+    cusp::array1d<int, cusp::host_memory> iterations;
+
+    cusp::krylov::batched_cg(A, x, b, offsets, iterations, 100, 1e-4);
+
+    ASSERT_EQUAL(iterations.size(), 3);
+    ASSERT_EQUAL(iterations[0] > 0, true);
+    ASSERT_EQUAL(iterations[1],     0);
+    ASSERT_EQUAL(iterations[2] > 0, true);
+    ASSERT_EQUAL(iterations[2] <= iterations[0], true);
+
+    // check residual norm of each system
+    cusp::array1d<float, MemorySpace> residual(N, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(residual.begin(),      residual.begin() + N0) < 1e-4 * std::sqrt(float(N0)), true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual.begin() + N0, residual.end())        < 1e-4 * std::sqrt(float(N1)), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBatchedConjugateGradient);
+
+
+template <class MemorySpace>
+void TestBatchedConjugateGradientZeroResidual(void)
+{
+    cusp::array2d<float, MemorySpace> M(4,4,0.0f);
+    M(0,0) = 8; M(1,1) = 4;
+    M(2,2) = 2; M(2,3) = 1;
+    M(3,2) = 1; M(3,3) = 2;
+
+    cusp::csr_matrix<int, float, MemorySpace> A(M);
+
+    cusp::array1d<int, MemorySpace> offsets(3);
+    offsets[0] = 0; offsets[1] = 2; offsets[2] = 4;
+
+    // the first system is solved by the initial guess
+    cusp::array1d<float, MemorySpace> x(4, 1.0f);
+    cusp::array1d<float, MemorySpace> b(4);
+    cusp::multiply(A, x, b);
+    x[2] = 0; x[3] = 0;
+
+    cusp::array1d<int, cusp::host_memory> iterations;
+
+    cusp::krylov::batched_cg(A, x, b, offsets, iterations, 20, 1e-6);
+
+    ASSERT_EQUAL(iterations[0], 0);
+    ASSERT_EQUAL(x[0], 1.0f);
+    ASSERT_EQUAL(x[1], 1.0f);
+    ASSERT_ALMOST_EQUAL(x[2], 1.0f);
+    ASSERT_ALMOST_EQUAL(x[3], 1.0f);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBatchedConjugateGradientZeroResidual);
+
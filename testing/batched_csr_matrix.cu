@@ -0,0 +1,116 @@
+#include <unittest/unittest.h>
+
+#include <cusp/batched_csr_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+template <class MemorySpace>
+void TestBatchedCsrMatrixBasicConstructor(void)
+{
+    cusp::batched_csr_matrix<int, float, MemorySpace> A(3, 2, 5, 10);
+
+    ASSERT_EQUAL(A.num_rows,            30);
+    ASSERT_EQUAL(A.num_cols,            20);
+    ASSERT_EQUAL(A.num_entries,         50);
+    ASSERT_EQUAL(A.num_batches,         10);
+    ASSERT_EQUAL(A.batch_num_rows(),     3);
+    ASSERT_EQUAL(A.batch_num_cols(),     2);
+    ASSERT_EQUAL(A.batch_num_entries(),  5);
+    ASSERT_EQUAL(A.row_offsets.size(),    4);
+    ASSERT_EQUAL(A.column_indices.size(), 5);
+    ASSERT_EQUAL(A.values.num_rows,       5);
+    ASSERT_EQUAL(A.values.num_cols,      10);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBatchedCsrMatrixBasicConstructor);
+
+template <class MemorySpace>
+void TestBatchedCsrMatrixFromPattern(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> P;
+    cusp::gallery::poisson5pt(P, 3, 2);
+
+    cusp::batched_csr_matrix<int, float, MemorySpace> A(P, 4);
+
+    ASSERT_EQUAL(A.num_rows,    4 * P.num_rows);
+    ASSERT_EQUAL(A.num_cols,    4 * P.num_cols);
+    ASSERT_EQUAL(A.num_entries, 4 * P.num_entries);
+    ASSERT_EQUAL(A.row_offsets,    P.row_offsets);
+    ASSERT_EQUAL(A.column_indices, P.column_indices);
+
+    for (size_t k = 0; k < P.num_entries; k++)
+        for (size_t b = 0; b < 4; b++)
+            ASSERT_EQUAL(A.values(k, b), P.values[k]);
+
+    // copies keep the number of items
+    cusp::batched_csr_matrix<int, float, cusp::host_memory> B(A);
+
+    ASSERT_EQUAL(B.num_batches, 4);
+    ASSERT_EQUAL(B.num_rows, A.num_rows);
+    ASSERT_EQUAL(B.values.values, A.values.values);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBatchedCsrMatrixFromPattern);
+
+template <class MemorySpace>
+void TestBatchedCsrMatrixSwap(void)
+{
+    cusp::batched_csr_matrix<int, float, MemorySpace> A(1, 2, 3, 4);
+    cusp::batched_csr_matrix<int, float, MemorySpace> B(5, 6, 7, 8);
+
+    A.swap(B);
+
+    ASSERT_EQUAL(A.num_batches, 8);
+    ASSERT_EQUAL(A.batch_num_rows(), 5);
+    ASSERT_EQUAL(A.batch_num_cols(), 6);
+    ASSERT_EQUAL(B.num_batches, 4);
+    ASSERT_EQUAL(B.batch_num_entries(), 3);
+
+    A.resize(2, 2, 3, 0);
+
+    ASSERT_EQUAL(A.num_rows, 0);
+    ASSERT_EQUAL(A.batch_num_rows(), 2);
+    ASSERT_EQUAL(A.batch_num_cols(), 0);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBatchedCsrMatrixSwap);
+
+template <class MemorySpace>
+void TestBatchedCsrMatrixMultiply(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> P;
+    cusp::gallery::poisson5pt(P, 5, 4);
+
+    const size_t num_batches = 45;
+
+    cusp::batched_csr_matrix<int, float, cusp::host_memory> H(P, num_batches);
+
+    cusp::array1d<float, cusp::host_memory> x(num_batches * P.num_cols);
+    cusp::array1d<float, cusp::host_memory> reference(num_batches * P.num_rows);
+
+    for (size_t b = 0; b < num_batches; b++)
+    {
+        cusp::csr_matrix<int, float, cusp::host_memory> B(P);
+
+        for (size_t k = 0; k < P.num_entries; k++)
+            H.values(k, b) = B.values[k] = float((b + 5 * k) % 9) - 4.0f;
+
+        cusp::array1d<float, cusp::host_memory> xb(P.num_cols);
+        for (size_t i = 0; i < P.num_cols; i++)
+            xb[i] = x[b * P.num_cols + i] = float((3 * b + i) % 5);
+
+        cusp::array1d<float, cusp::host_memory> yb(P.num_rows);
+        cusp::multiply(B, xb, yb);
+
+        for (size_t i = 0; i < P.num_rows; i++)
+            reference[b * P.num_rows + i] = yb[i];
+    }
+
+    cusp::batched_csr_matrix<int, float, MemorySpace> A(H);
+    cusp::array1d<float, MemorySpace> d_x(x);
+    cusp::array1d<float, MemorySpace> y(A.num_rows, -1);
+
+    cusp::multiply(A, d_x, y);
+
+    ASSERT_EQUAL(y, reference);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBatchedCsrMatrixMultiply);
+
@@ -0,0 +1,167 @@
+#include <unittest/unittest.h>
+
+#include <cusp/batched_multiply.h>
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+#include <vector>
+
+template <class MemorySpace>
+void TestBatchedMultiplySmall(void)
+{
+    // the items [1 2; 0 3] and [4] with local column indices
+    cusp::array2d<float, cusp::host_memory> M(3, 2, 0);
+    M(0,0) = 1; M(0,1) = 2; M(1,1) = 3;
+    M(2,0) = 4;
+
+    cusp::csr_matrix<int, float, MemorySpace> A(M);
+
+    cusp::array1d<int, MemorySpace> offsets(3);
+    offsets[0] = 0; offsets[1] = 2; offsets[2] = 3;
+
+    cusp::array1d<float, MemorySpace> x(3);
+    x[0] = 1; x[1] = 2; x[2] = 3;
+
+    cusp::array1d<float, MemorySpace> y(3, -1);
+
+    cusp::batched_multiply(A, offsets, x, y);
+
+    ASSERT_EQUAL(y[0],  5.0f);
+    ASSERT_EQUAL(y[1],  6.0f);
+    ASSERT_EQUAL(y[2], 12.0f);
+
+    cusp::array1d<float, MemorySpace> z(4);
+    ASSERT_THROWS(cusp::batched_multiply(A, offsets, x, z), cusp::invalid_input_exception);
+    ASSERT_THROWS(cusp::batched_multiply(A, offsets, z, y), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBatchedMultiplySmall);
+
+template <class MemorySpace>
+void TestBatchedMultiplyConcatenated(void)
+{
+    // items of varying size, the rectangular ones drop their last column
+    const size_t num_items = 150;
+
+    std::vector< cusp::csr_matrix<int, float, cusp::host_memory> > items(num_items);
+
+    cusp::array1d<int, cusp::host_memory> row_offsets(num_items + 1, 0);
+    cusp::array1d<int, cusp::host_memory> column_offsets(num_items + 1, 0);
+
+    size_t num_entries = 0;
+
+    for (size_t b = 0; b < num_items; b++)
+    {
+        cusp::gallery::poisson5pt(items[b], 1 + b % 7, 1 + b % 5);
+
+        items[b].values[0] = b;
+        items[b].num_cols -= b % 2;
+
+        row_offsets[b + 1]    = row_offsets[b]    + items[b].num_rows;
+        column_offsets[b + 1] = column_offsets[b] + items[b].num_cols;
+        num_entries += items[b].num_entries;
+    }
+
+    // the column indices are local to the items
+    cusp::csr_matrix<int, float, cusp::host_memory> H(row_offsets[num_items], 7 * 5, num_entries);
+    H.row_offsets[0] = 0;
+
+    cusp::array1d<float, cusp::host_memory> x(column_offsets[num_items]);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = (i % 13) - 6.0f;
+
+    cusp::array1d<float, cusp::host_memory> reference(row_offsets[num_items], 0);
+
+    size_t n = 0;
+
+    for (size_t b = 0; b < num_items; b++)
+    {
+        const cusp::csr_matrix<int, float, cusp::host_memory>& B = items[b];
+
+        for (size_t i = 0; i < B.num_rows; i++)
+        {
+            float sum = 0;
+
+            for (int jj = B.row_offsets[i]; jj < B.row_offsets[i + 1]; jj++)
+            {
+                if ((size_t) B.column_indices[jj] >= B.num_cols)
+                    continue;
+
+                H.column_indices[n] = B.column_indices[jj];
+                H.values[n]         = B.values[jj];
+                n++;
+
+                sum += B.values[jj] * x[column_offsets[b] + B.column_indices[jj]];
+            }
+
+            H.row_offsets[row_offsets[b] + i + 1] = n;
+            reference[row_offsets[b] + i] = sum;
+        }
+    }
+
+    H.resize(H.num_rows, H.num_cols, n);
+
+    cusp::csr_matrix<int, float, MemorySpace> A(H);
+    cusp::array1d<int, MemorySpace> rows(row_offsets);
+    cusp::array1d<int, MemorySpace> columns(column_offsets);
+    cusp::array1d<float, MemorySpace> d_x(x);
+    cusp::array1d<float, MemorySpace> y(H.num_rows, -1);
+
+    cusp::batched_multiply(A, rows, columns, d_x, y);
+
+    ASSERT_EQUAL(y, reference);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBatchedMultiplyConcatenated);
+
+template <class MemorySpace, class Orientation>
+void _TestBatchedMultiplyUniform(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> P;
+    cusp::gallery::poisson5pt(P, 4, 3);
+
+    const size_t num_items = 70;
+
+    cusp::array2d<float, cusp::host_memory, Orientation> values(num_items, P.num_entries);
+    cusp::array1d<float, cusp::host_memory> x(num_items * P.num_cols);
+    cusp::array1d<float, cusp::host_memory> reference(num_items * P.num_rows);
+
+    for (size_t b = 0; b < num_items; b++)
+    {
+        cusp::csr_matrix<int, float, cusp::host_memory> B(P);
+
+        for (size_t n = 0; n < B.num_entries; n++)
+            values(b, n) = B.values[n] = float((b + 3 * n) % 11) - 5.0f;
+
+        cusp::array1d<float, cusp::host_memory> xb(P.num_cols);
+        for (size_t i = 0; i < P.num_cols; i++)
+            xb[i] = x[b * P.num_cols + i] = float((b * i) % 7);
+
+        cusp::array1d<float, cusp::host_memory> yb(P.num_rows);
+        cusp::multiply(B, xb, yb);
+
+        for (size_t i = 0; i < P.num_rows; i++)
+            reference[b * P.num_rows + i] = yb[i];
+    }
+
+    cusp::csr_matrix<int, float, MemorySpace> A(P);
+    cusp::array2d<float, MemorySpace, Orientation> d_values(values);
+    cusp::array1d<float, MemorySpace> d_x(x);
+    cusp::array1d<float, MemorySpace> y(reference.size(), -1);
+
+    cusp::batched_multiply_uniform(A, d_values, d_x, y);
+
+    ASSERT_EQUAL(y, reference);
+
+    cusp::array1d<float, MemorySpace> z(reference.size() + 1);
+    ASSERT_THROWS(cusp::batched_multiply_uniform(A, d_values, d_x, z), cusp::invalid_input_exception);
+}
+
+template <class MemorySpace>
+void TestBatchedMultiplyUniform(void)
+{
+    _TestBatchedMultiplyUniform<MemorySpace, cusp::row_major>();
+    _TestBatchedMultiplyUniform<MemorySpace, cusp::column_major>();
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBatchedMultiplyUniform);
+
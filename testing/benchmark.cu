@@ -0,0 +1,96 @@
+#include <unittest/unittest.h>
+
+#include <cusp/benchmark.h>
+#include <cusp/auto_format_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+#include <string>
+
+template <class Space>
+void TestStreamBandwidth(void)
+{
+    // a large enough buffer for clock() to resolve a pass on the host
+    double bandwidth = cusp::benchmark::stream_bandwidth<Space>(3 * (size_t(1) << 26), 3);
+
+    ASSERT_EQUAL(bandwidth > 0, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestStreamBandwidth);
+
+template <class Space>
+void TestSpMVProfile(void)
+{
+    cusp::csr_matrix<int, float, Space> A;
+    cusp::gallery::poisson5pt(A, 100, 100);
+
+    cusp::format_selection_options options;
+    options.benchmark_iterations = 20;
+
+    cusp::benchmark::spmv_profile_result profile = cusp::benchmark::spmv_profile(A, options);
+
+    ASSERT_EQUAL(profile.num_rows,    A.num_rows);
+    ASSERT_EQUAL(profile.num_cols,    A.num_cols);
+    ASSERT_EQUAL(profile.num_entries, A.num_entries);
+    ASSERT_EQUAL(profile.peak_bandwidth > 0, true);
+
+    // the selection was benchmarked and picked the fastest admissible format
+    const cusp::benchmark::spmv_format_profile& fastest = profile.formats[profile.selection.format];
+
+    ASSERT_EQUAL(fastest.admissible, true);
+
+    for (int i = 0; i < cusp::format_selection::num_formats; i++)
+    {
+        const cusp::benchmark::spmv_format_profile& format = profile.formats[i];
+
+        ASSERT_EQUAL(format.admissible, profile.selection.admissible[i]);
+
+        if (!format.admissible)
+            continue;
+
+        ASSERT_EQUAL(format.bytes,        profile.selection.bytes[i]);
+        ASSERT_EQUAL(format.milliseconds, profile.selection.milliseconds[i]);
+        ASSERT_EQUAL(fastest.milliseconds <= format.milliseconds, true);
+
+        if (format.milliseconds > 0)
+        {
+            ASSERT_ALMOST_EQUAL(format.bandwidth,  format.bytes / (1e6 * format.milliseconds));
+            ASSERT_ALMOST_EQUAL(format.gflops,     2.0 * A.num_entries / (1e6 * format.milliseconds));
+            ASSERT_ALMOST_EQUAL(format.efficiency, format.bandwidth / profile.peak_bandwidth);
+        }
+    }
+
+    ASSERT_EQUAL(std::string(cusp::benchmark::format_name(cusp::format_selection::dia)), "dia");
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSpMVProfile);
+
+template <class Space>
+void TestAutoFormatMatrixGivenSelection(void)
+{
+    cusp::csr_matrix<int, float, Space> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::format_selection selection = cusp::select_format(A);
+
+    // store a matrix of the same structure in an ELL format instead
+    selection.format = cusp::format_selection::ell;
+
+    cusp::auto_format_matrix<int, float, Space> B;
+    B.select(A, selection);
+
+    ASSERT_EQUAL(B.selection.format, cusp::format_selection::ell);
+    ASSERT_EQUAL(B.num_rows,    A.num_rows);
+    ASSERT_EQUAL(B.num_entries, A.num_entries);
+    ASSERT_EQUAL(B.ell.num_entries, A.num_entries);
+    ASSERT_EQUAL(B.csr.num_entries, 0);
+
+    cusp::array1d<float, Space> x(A.num_cols, 1.0f);
+    cusp::array1d<float, Space> y(A.num_rows);
+    cusp::array1d<float, Space> z(A.num_rows);
+
+    cusp::multiply(A, x, y);
+    cusp::multiply(B, x, z);
+
+    ASSERT_EQUAL(y, z);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAutoFormatMatrixGivenSelection);
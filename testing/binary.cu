@@ -0,0 +1,163 @@
+#include <unittest/unittest.h>
+
+#include <cusp/io/binary.h>
+#include <cusp/io/matrix_market.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/gallery/poisson.h>
+
+#include <sstream>
+#include <stdio.h>
+
+const char binary_file_name[] = "test_61930275465738.cusp";
+
+template <typename MemorySpace>
+void TestReadWriteBinaryFileArray1d(void)
+{
+  cusp::array1d<float, MemorySpace> a(5);
+  a[0] = 10; a[1] = 0; a[2] = 20; a[3] = -1.5; a[4] = 30;
+
+  cusp::io::write_binary_file(a, binary_file_name);
+
+  cusp::array1d<float, MemorySpace> b;
+  cusp::io::read_binary_file(b, binary_file_name);
+
+  remove(binary_file_name);
+
+  ASSERT_EQUAL(a, b);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestReadWriteBinaryFileArray1d);
+
+template <typename SparseMatrix>
+void ReadWriteBinaryFile(void)
+{
+  cusp::csr_matrix<int, float, cusp::host_memory> A;
+  cusp::gallery::poisson5pt(A, 7, 5);
+
+  SparseMatrix B(A);
+
+  cusp::io::write_binary_file(B, binary_file_name);
+
+  SparseMatrix C;
+  cusp::io::read_binary_file(C, binary_file_name);
+
+  // other formats are converted from the format of the file
+  cusp::csr_matrix<int, float, cusp::host_memory> D;
+  cusp::io::read_binary_file(D, binary_file_name);
+
+  remove(binary_file_name);
+
+  cusp::array2d<float, cusp::host_memory> expected(A);
+  cusp::array2d<float, cusp::host_memory> C_dense(C);
+  cusp::array2d<float, cusp::host_memory> D_dense(D);
+
+  ASSERT_EQUAL(C.num_entries, B.num_entries);
+  ASSERT_EQUAL(C_dense == expected, true);
+  ASSERT_EQUAL(D_dense == expected, true);
+}
+
+template <typename MemorySpace>
+void TestReadWriteBinaryFile(void)
+{
+  ReadWriteBinaryFile< cusp::coo_matrix<int, float, MemorySpace> >();
+  ReadWriteBinaryFile< cusp::csr_matrix<int, float, MemorySpace> >();
+  ReadWriteBinaryFile< cusp::dia_matrix<int, float, MemorySpace> >();
+  ReadWriteBinaryFile< cusp::ell_matrix<int, float, MemorySpace> >();
+  ReadWriteBinaryFile< cusp::hyb_matrix<int, float, MemorySpace> >();
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestReadWriteBinaryFile);
+
+template <typename MemorySpace>
+void TestReadWriteBinaryStream(void)
+{
+  cusp::csr_matrix<int, float, MemorySpace> A;
+  cusp::gallery::poisson5pt(A, 7, 5);
+
+  cusp::array1d<float, MemorySpace> a(5);
+  a[0] = 10; a[1] = 0; a[2] = 20; a[3] = -1.5; a[4] = 30;
+
+  cusp::array1d<float, MemorySpace> empty;
+
+  // several containers follow one another in a stream
+  std::stringstream stream;
+  cusp::io::write_binary_stream(A, stream);
+  cusp::io::write_binary_stream(empty, stream);
+  cusp::io::write_binary_stream(a, stream);
+
+  cusp::csr_matrix<int, float, MemorySpace> B;
+  cusp::array1d<float, MemorySpace> b;
+  cusp::array1d<float, MemorySpace> c(3);
+  cusp::io::read_binary_stream(B, stream);
+  cusp::io::read_binary_stream(c, stream);
+  cusp::io::read_binary_stream(b, stream);
+
+  ASSERT_EQUAL(B.num_rows,       A.num_rows);
+  ASSERT_EQUAL(B.num_cols,       A.num_cols);
+  ASSERT_EQUAL(B.row_offsets,    A.row_offsets);
+  ASSERT_EQUAL(B.column_indices, A.column_indices);
+  ASSERT_EQUAL(B.values,         A.values);
+  ASSERT_EQUAL(c.size(), (size_t) 0);
+  ASSERT_EQUAL(a, b);
+
+  // nothing is left in the stream
+  ASSERT_THROWS(cusp::io::read_binary_stream(b, stream), cusp::io_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestReadWriteBinaryStream);
+
+void TestReadWriteBinaryFileLarge(void)
+{
+  // several staging buffers of the device transfers
+  cusp::csr_matrix<int, double, cusp::host_memory> A;
+  cusp::gallery::poisson5pt(A, 700, 700);
+
+  cusp::csr_matrix<int, double, cusp::device_memory> B(A);
+  cusp::io::write_binary_file(B, binary_file_name);
+
+  cusp::csr_matrix<int, double, cusp::device_memory> C;
+  cusp::io::read_binary_file(C, binary_file_name);
+
+  cusp::csr_matrix<int, double, cusp::host_memory> D;
+  cusp::io::read_binary_file(D, binary_file_name);
+
+  remove(binary_file_name);
+
+  cusp::csr_matrix<int, double, cusp::host_memory> E(C);
+
+  ASSERT_EQUAL(E.row_offsets,    A.row_offsets);
+  ASSERT_EQUAL(E.column_indices, A.column_indices);
+  ASSERT_EQUAL(E.values,         A.values);
+  ASSERT_EQUAL(D.values,         A.values);
+}
+DECLARE_UNITTEST(TestReadWriteBinaryFileLarge);
+
+void TestReadBinaryFileInvalid(void)
+{
+  cusp::csr_matrix<int, float, cusp::host_memory> A;
+  cusp::gallery::poisson5pt(A, 4, 4);
+
+  cusp::io::write_binary_file(A, binary_file_name);
+
+  // types must match the file
+  cusp::csr_matrix<int, double, cusp::host_memory> B;
+  ASSERT_THROWS(cusp::io::read_binary_file(B, binary_file_name), cusp::io_exception);
+
+  cusp::array1d<float, cusp::host_memory> x;
+  ASSERT_THROWS(cusp::io::read_binary_file(x, binary_file_name), cusp::io_exception);
+
+  // other files are rejected
+  cusp::io::write_matrix_market_file(A, binary_file_name);
+
+  cusp::csr_matrix<int, float, cusp::host_memory> C;
+  ASSERT_THROWS(cusp::io::read_binary_file(C, binary_file_name), cusp::io_exception);
+
+  remove(binary_file_name);
+
+  ASSERT_THROWS(cusp::io::read_binary_file(C, binary_file_name), cusp::io_exception);
+}
+DECLARE_UNITTEST(TestReadBinaryFileInvalid);
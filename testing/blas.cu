@@ -2,6 +2,8 @@
 
 #include <cusp/blas.h>
 
+#include <cmath>
+
 
 template <class MemorySpace>
 void TestAxpy(void)
@@ -253,6 +255,40 @@ void TestDotc(void)
 DECLARE_HOST_DEVICE_UNITTEST(TestDotc);
 
 
+template <class MemorySpace>
+void TestDotcN(void)
+{
+    typedef typename cusp::array1d<float, MemorySpace>       Array;
+    typedef typename cusp::array1d<float, MemorySpace>::view View;
+
+    Array x(6);
+    Array y(6);
+    Array z(6);
+
+    x[0] =  7.0f;   y[0] =  0.0f;   z[0] =  1.0f;
+    x[1] =  5.0f;   y[1] = -2.0f;   z[1] =  2.0f;
+    x[2] =  4.0f;   y[2] =  0.0f;   z[2] = -1.0f;
+    x[3] = -3.0f;   y[3] =  5.0f;   z[3] =  0.0f;
+    x[4] =  0.0f;   y[4] =  6.0f;   z[4] =  3.0f;
+    x[5] =  4.0f;   y[5] =  1.0f;   z[5] =  1.0f;
+
+    thrust::tuple<float,float> two = cusp::blas::dotc_n(x, y, y, y);
+    ASSERT_EQUAL(thrust::get<0>(two), cusp::blas::dotc(x, y));
+    ASSERT_EQUAL(thrust::get<1>(two), cusp::blas::dotc(y, y));
+
+    thrust::tuple<float,float,float> three = cusp::blas::dotc_n(View(x), View(y), View(x), View(z), View(z), View(z));
+    ASSERT_EQUAL(thrust::get<0>(three), -21.0f);
+    ASSERT_EQUAL(thrust::get<1>(three), cusp::blas::dotc(x, z));
+    ASSERT_EQUAL(thrust::get<2>(three), cusp::blas::dotc(z, z));
+
+    // test size checking
+    Array w(3);
+    ASSERT_THROWS(cusp::blas::dotc_n(x, y, x, w), cusp::invalid_input_exception);
+    ASSERT_THROWS(cusp::blas::dotc_n(x, y, x, y, w, x), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDotcN);
+
+
 template <class MemorySpace>
 void TestFill(void)
 {
@@ -449,3 +485,105 @@ void TestScal(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestScal);
 
+
+template <class MemorySpace>
+void TestDeviceScalarBlas(void)
+{
+    typedef typename cusp::array1d<float, MemorySpace>       Array;
+    typedef typename cusp::array1d<float, MemorySpace>::view View;
+
+    Array x(4);
+    Array y(4);
+    Array z(4);
+
+    x[0] =  7.0f;   y[0] =  0.0f;
+    x[1] =  5.0f;   y[1] = -2.0f;
+    x[2] =  4.0f;   y[2] =  0.0f;
+    x[3] = -3.0f;   y[3] =  5.0f;
+
+    cusp::array1d<float, cusp::device_memory> scalars(6, 0.0f);
+    scalars[4] = 2.0f;
+    scalars[5] = -1.0f;
+
+    cusp::blas::dot_async(x, y, cusp::blas::make_device_scalar(scalars, 0));
+    cusp::blas::dotc_async(View(x), View(y), cusp::blas::make_device_scalar(scalars, 1));
+    cusp::blas::nrm2_async(y, cusp::blas::make_device_scalar(scalars, 2));
+    cusp::blas::nrmmax_async(x, cusp::blas::make_device_scalar(scalars, 3));
+
+    ASSERT_EQUAL(scalars[0], -25.0f);
+    ASSERT_EQUAL(scalars[1], -25.0f);
+    ASSERT_ALMOST_EQUAL(scalars[2], std::sqrt(29.0f));
+    ASSERT_EQUAL(scalars[3], 7.0f);
+
+    cusp::blas::device_scalar<float> alpha = cusp::blas::make_device_scalar(scalars, 4);
+    cusp::blas::device_scalar<float> beta  = cusp::blas::make_device_scalar(scalars, 5);
+
+    // z = 2 * x - y
+    cusp::blas::axpby(x, y, z, alpha, beta);
+
+    ASSERT_EQUAL(z[0],  14.0f);
+    ASSERT_EQUAL(z[1],  12.0f);
+    ASSERT_EQUAL(z[2],   8.0f);
+    ASSERT_EQUAL(z[3], -11.0f);
+
+    // y = 2 * x + y
+    cusp::blas::axpy(x, View(y), alpha);
+
+    ASSERT_EQUAL(y[0], 14.0f);
+    ASSERT_EQUAL(y[1],  8.0f);
+    ASSERT_EQUAL(y[2],  8.0f);
+    ASSERT_EQUAL(y[3], -1.0f);
+
+    // x = -1 * x
+    cusp::blas::scal(x, beta);
+
+    ASSERT_EQUAL(x[0], -7.0f);
+    ASSERT_EQUAL(x[1], -5.0f);
+    ASSERT_EQUAL(x[2], -4.0f);
+    ASSERT_EQUAL(x[3],  3.0f);
+
+    // test size checking
+    Array w(3);
+    ASSERT_THROWS(cusp::blas::dot_async(x, w, cusp::blas::make_device_scalar(scalars)), cusp::invalid_input_exception);
+    ASSERT_THROWS(cusp::blas::axpy(x, w, alpha), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDeviceScalarBlas);
+
+
+
+void TestHostVendorBlas(void)
+{
+    namespace vendor = cusp::detail::host::vendor;
+
+    typedef cusp::array1d<double, cusp::host_memory> Array;
+
+    Array x(1000), y(1000);
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        x[i] = double(int(i % 7) - 3) / 2;
+        y[i] = double(int(i % 5) - 2);
+    }
+
+    Array z[2];
+    double d[2], n[2];
+
+    // the built-in routines, then the vendor library when present
+    for(int pass = 0; pass < 2; pass++)
+    {
+        vendor::enable(pass == 1);
+
+        z[pass] = y;
+        cusp::blas::axpy(x, z[pass], 3.0);
+        cusp::blas::scal(z[pass], -0.5);
+
+        d[pass] = cusp::blas::dot(x, z[pass]);
+        n[pass] = cusp::blas::nrm2(z[pass]);
+    }
+
+    vendor::enable(true);
+
+    ASSERT_ALMOST_EQUAL(z[0], z[1]);
+    ASSERT_ALMOST_EQUAL(d[0], d[1]);
+    ASSERT_ALMOST_EQUAL(n[0], n[1]);
+}
+DECLARE_UNITTEST(TestHostVendorBlas);
@@ -0,0 +1,109 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/precond/diagonal.h>
+#include <cusp/krylov/block_gmres.h>
+
+// nonsymmetric D * A with positive diagonal D
+template <typename Matrix>
+void initialize_matrix(Matrix& A, int nx, int ny)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> H;
+    cusp::gallery::poisson5pt(H, nx, ny);
+
+    for (size_t i = 0; i < H.num_rows; i++)
+        for (int jj = H.row_offsets[i]; jj < H.row_offsets[i + 1]; jj++)
+            H.values[jj] *= 1.0f + 0.5f * (i % 3);
+
+    A = H;
+}
+
+// linearly independent right-hand sides
+template <typename Matrix>
+void initialize_rhs(Matrix& B)
+{
+    for (size_t i = 0; i < B.num_rows; i++)
+        for (size_t j = 0; j < B.num_cols; j++)
+            B(i,j) = float((i * (j + 1)) % (j + 5)) + 1.0f;
+}
+
+template <typename Matrix1, typename Array2d1, typename Array2d2>
+bool block_converged(const Matrix1& A, const Array2d1& X, const Array2d2& B, float tolerance)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> H(A);
+
+    for (size_t j = 0; j < B.num_cols; j++)
+    {
+        cusp::array1d<float, cusp::host_memory> x(X.num_rows);
+        cusp::array1d<float, cusp::host_memory> b(B.num_rows);
+        cusp::array1d<float, cusp::host_memory> r(B.num_rows);
+
+        for (size_t i = 0; i < X.num_rows; i++)
+        {
+            x[i] = X(i,j);
+            b[i] = B(i,j);
+        }
+
+        cusp::multiply(H, x, r);
+        cusp::blas::axpby(r, b, r, -1.0f, 1.0f);
+
+        if (cusp::blas::nrm2(r) > tolerance * cusp::blas::nrm2(b))
+            return false;
+    }
+
+    return true;
+}
+
+template <class MemorySpace>
+void TestBlockGeneralizedMinimumResidual(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    initialize_matrix(A, 10, 10);
+
+    cusp::array2d<float, cusp::host_memory, cusp::column_major> H(A.num_rows, 6);
+    initialize_rhs(H);
+
+    cusp::array2d<float, MemorySpace, cusp::column_major> X(A.num_rows, 6, 0.0f);
+    cusp::array2d<float, MemorySpace, cusp::column_major> B(H);
+
+    cusp::block_monitor<float> monitor(B, 100, 1e-4);
+
+    cusp::krylov::block_gmres(A, X, B, 10, monitor);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(monitor.num_converged(), 6);
+
+    cusp::array2d<float, cusp::host_memory, cusp::column_major> X_h(X);
+    ASSERT_EQUAL(block_converged(A, X_h, H, 1e-4), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBlockGeneralizedMinimumResidual);
+
+template <class MemorySpace>
+void TestBlockGeneralizedMinimumResidualPreconditioned(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    initialize_matrix(A, 12, 9);
+
+    // row-major right-hand sides are copied by the solver
+    cusp::array2d<float, cusp::host_memory> H(A.num_rows, 4);
+    initialize_rhs(H);
+
+    cusp::array2d<float, MemorySpace> X(A.num_rows, 4, 0.0f);
+    cusp::array2d<float, MemorySpace> B(H);
+
+    cusp::block_monitor<float> monitor(B, 100, 1e-4);
+    cusp::precond::diagonal<float, MemorySpace> M(A);
+
+    // short restarts exercise deflation of converged columns
+    cusp::krylov::block_gmres(A, X, B, 4, monitor, M);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+
+    cusp::array2d<float, cusp::host_memory> X_h(X);
+    ASSERT_EQUAL(block_converged(A, X_h, H, 1e-4), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBlockGeneralizedMinimumResidualPreconditioned);
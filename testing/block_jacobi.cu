@@ -0,0 +1,168 @@
+#include <unittest/unittest.h>
+
+#include <cusp/precond/block_jacobi.h>
+#include <cusp/precond/diagonal.h>
+
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/cg.h>
+
+template <class MemorySpace>
+void TestBlockJacobiBlockDiagonal(void)
+{
+    // blocks of 1, 2 and 3 rows; the 2x2 block requires pivoting
+    cusp::array2d<float, cusp::host_memory> D(6,6,0.0f);
+    D(0,0) = 4.0f;
+    D(1,1) = 0.0f; D(1,2) = 2.0f;
+    D(2,1) = 3.0f; D(2,2) = 1.0f;
+    D(3,3) = 4.0f; D(3,4) = 1.0f; D(3,5) = 0.5f;
+    D(4,3) = 1.0f; D(4,4) = 3.0f; D(4,5) = 1.0f;
+    D(5,3) = 0.5f; D(5,4) = 1.0f; D(5,5) = 2.0f;
+
+    cusp::csr_matrix<int, float, MemorySpace> A(D);
+
+    cusp::array1d<int, cusp::host_memory> offsets(4);
+    offsets[0] = 0; offsets[1] = 1; offsets[2] = 3; offsets[3] = 6;
+
+    cusp::precond::block_jacobi<float, MemorySpace> M(A, offsets);
+
+    ASSERT_EQUAL(M.num_blocks(), (size_t) 3);
+
+    // M is the inverse of the block diagonal A
+    cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(6);
+    cusp::array1d<float, MemorySpace> b(6);
+    cusp::array1d<float, MemorySpace> y(6);
+
+    cusp::multiply(A, x, b);
+    cusp::multiply(M, b, y);
+
+    ASSERT_ALMOST_EQUAL(y, x);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBlockJacobiBlockDiagonal);
+
+template <class MemorySpace>
+void TestBlockJacobiFixedSize(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 4, 5);
+
+    // blocks of one row reduce to the diagonal preconditioner
+    {
+        cusp::precond::block_jacobi<float, MemorySpace> M(A, 1);
+        cusp::precond::diagonal<float, MemorySpace>     D(A);
+
+        cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(A.num_rows);
+        cusp::array1d<float, MemorySpace> y1(A.num_rows);
+        cusp::array1d<float, MemorySpace> y2(A.num_rows);
+
+        cusp::multiply(M, x, y1);
+        cusp::multiply(D, x, y2);
+
+        ASSERT_EQUAL(M.num_blocks(), (size_t) 20);
+        ASSERT_ALMOST_EQUAL(y1, y2);
+    }
+
+    // the last block is smaller
+    {
+        cusp::precond::block_jacobi<float, MemorySpace> M(A, 8);
+
+        ASSERT_EQUAL(M.num_blocks(), (size_t) 3);
+        ASSERT_EQUAL(M.num_entries, (size_t) (8 * 8 + 8 * 8 + 4 * 4));
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBlockJacobiFixedSize);
+
+template <class MemorySpace>
+void TestBlockJacobiUnrolledBlockSizes(void)
+{
+    // 35 rows, so that most block sizes leave a smaller last block
+    cusp::coo_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 5, 7);
+
+    for (size_t block_size = 2; block_size <= 9; block_size++)
+    {
+        // the block diagonal part of A
+        cusp::coo_matrix<int, float, cusp::host_memory> D(A);
+
+        for (size_t n = 0; n < D.num_entries; n++)
+            if (D.row_indices[n] / block_size != D.column_indices[n] / block_size)
+                D.values[n] = 0.0f;
+
+        cusp::csr_matrix<int, float, MemorySpace> _A(A);
+        cusp::csr_matrix<int, float, MemorySpace> _D(D);
+
+        cusp::precond::block_jacobi<float, MemorySpace> M(_A, block_size);
+
+        // M is the inverse of D
+        cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(A.num_rows);
+        cusp::array1d<float, MemorySpace> b(A.num_rows);
+        cusp::array1d<float, MemorySpace> y(A.num_rows);
+
+        cusp::multiply(_D, x, b);
+        cusp::multiply(M, b, y);
+
+        ASSERT_ALMOST_EQUAL(y, x);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBlockJacobiUnrolledBlockSizes);
+
+template <class MemorySpace>
+void TestBlockJacobiConvergence(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 16, 16);
+
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    // a block per grid line is stronger than the diagonal
+    size_t diagonal_iterations;
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::precond::diagonal<float, MemorySpace> M(A);
+        cusp::default_monitor<float> monitor(b, 200, 1e-5);
+        cusp::krylov::cg(A, x, b, monitor, M);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+        diagonal_iterations = monitor.iteration_count();
+    }
+
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::precond::block_jacobi<float, MemorySpace> M(A, 16);
+        cusp::default_monitor<float> monitor(b, 200, 1e-5);
+        cusp::krylov::cg(A, x, b, monitor, M);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+        ASSERT_EQUAL(monitor.iteration_count() < diagonal_iterations, true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBlockJacobiConvergence);
+
+void TestBlockJacobiErrors(void)
+{
+    cusp::array2d<float, cusp::host_memory> D(4,4,1.0f);
+    cusp::csr_matrix<int, float, cusp::host_memory> A(D);
+
+    // singular block
+    ASSERT_THROWS((cusp::precond::block_jacobi<float, cusp::host_memory>(A, 2)), cusp::runtime_exception);
+
+    // offsets must partition the rows
+    cusp::array1d<int, cusp::host_memory> offsets(3);
+    offsets[0] = 0; offsets[1] = 2; offsets[2] = 3;
+
+    ASSERT_THROWS((cusp::precond::block_jacobi<float, cusp::host_memory>(A, offsets)), cusp::invalid_input_exception);
+
+    offsets[1] = 0; offsets[2] = 4;
+
+    ASSERT_THROWS((cusp::precond::block_jacobi<float, cusp::host_memory>(A, offsets)), cusp::invalid_input_exception);
+
+    // rectangular matrix
+    cusp::csr_matrix<int, float, cusp::host_memory> B(2, 3, 0);
+
+    ASSERT_THROWS((cusp::precond::block_jacobi<float, cusp::host_memory>(B, 1)), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestBlockJacobiErrors);
@@ -0,0 +1,72 @@
+#include <unittest/unittest.h>
+
+#include <cusp/graph/breadth_first_search.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/gallery/poisson.h>
+
+#include <algorithm>
+#include <stdlib.h>
+
+template <typename TestMatrix>
+void TestBreadthFirstSearch(void)
+{
+    typedef typename TestMatrix::memory_space MemorySpace;
+
+    // a path 0 - 1 - 2 - 3 and an isolated vertex 4
+    cusp::array2d<float, cusp::host_memory> D(5,5,0);
+    D(0,1) = 1; D(1,0) = 1;
+    D(1,2) = 1; D(2,1) = 1;
+    D(2,3) = 1; D(3,2) = 1;
+
+    TestMatrix A(D);
+
+    cusp::array1d<int, MemorySpace> labels;
+
+    ASSERT_EQUAL(cusp::graph::breadth_first_search(A, 1, labels), (size_t) 3);
+
+    ASSERT_EQUAL(labels[0],  1);
+    ASSERT_EQUAL(labels[1],  0);
+    ASSERT_EQUAL(labels[2],  1);
+    ASSERT_EQUAL(labels[3],  2);
+    ASSERT_EQUAL(labels[4], -1);
+
+    ASSERT_THROWS(cusp::graph::breadth_first_search(A, 5, labels), cusp::invalid_input_exception);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestBreadthFirstSearch);
+
+template <typename MemorySpace>
+void TestBreadthFirstSearchGrid(void)
+{
+    // a grid is searched both top-down and bottom-up
+    const int nx = 60, ny = 50;
+
+    cusp::csr_matrix<int, float, MemorySpace> G;
+    cusp::gallery::poisson5pt(G, nx, ny);
+
+    const int src = 20 * nx + 30;
+
+    cusp::array1d<int, MemorySpace> labels;
+    size_t num_levels = cusp::graph::breadth_first_search(G, src, labels);
+
+    cusp::array1d<int, cusp::host_memory> h_labels(labels);
+
+    int max_distance = 0;
+
+    for (int y = 0; y < ny; y++)
+    {
+        for (int x = 0; x < nx; x++)
+        {
+            const int distance = abs(x - 30) + abs(y - 20);
+            max_distance = std::max(max_distance, distance);
+
+            ASSERT_EQUAL(h_labels[y * nx + x], distance);
+        }
+    }
+
+    ASSERT_EQUAL(num_levels, (size_t) max_distance + 1);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBreadthFirstSearchGrid);
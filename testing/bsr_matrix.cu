@@ -0,0 +1,164 @@
+#include <unittest/unittest.h>
+#include <cusp/bsr_matrix.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+template <class Space>
+void TestBsrMatrixBasicConstructor(void)
+{
+    cusp::bsr_matrix<int, float, Space> matrix(4, 6, 3, 2);
+
+    ASSERT_EQUAL(matrix.num_rows,              4);
+    ASSERT_EQUAL(matrix.num_cols,              6);
+    ASSERT_EQUAL(matrix.num_entries,          12);
+    ASSERT_EQUAL(matrix.block_size,            2);
+    ASSERT_EQUAL(matrix.num_block_rows(),      2);
+    ASSERT_EQUAL(matrix.num_block_cols(),      3);
+    ASSERT_EQUAL(matrix.num_blocks(),          3);
+    ASSERT_EQUAL(matrix.row_offsets.size(),    3);
+    ASSERT_EQUAL(matrix.column_indices.size(), 3);
+    ASSERT_EQUAL(matrix.values.size(),        12);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBsrMatrixBasicConstructor);
+
+template <class Space>
+void TestBsrMatrixSwap(void)
+{
+    cusp::bsr_matrix<int, float, Space> A(4, 4, 2, 2);
+    cusp::bsr_matrix<int, float, Space> B(3, 3, 1, 3);
+
+    A.swap(B);
+
+    ASSERT_EQUAL(A.num_rows,     3);
+    ASSERT_EQUAL(A.num_entries,  9);
+    ASSERT_EQUAL(A.block_size,   3);
+    ASSERT_EQUAL(A.num_blocks(), 1);
+
+    ASSERT_EQUAL(B.num_rows,     4);
+    ASSERT_EQUAL(B.num_entries,  8);
+    ASSERT_EQUAL(B.block_size,   2);
+    ASSERT_EQUAL(B.num_blocks(), 2);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBsrMatrixSwap);
+
+template <class Space>
+void TestBsrMatrixConversion(void)
+{
+    // [10  0 |  0  0 | 20  0]
+    // [ 0 11 |  0  0 |  0 21]
+    // [------+-------+------]
+    // [ 0  0 | 30  0 |  0  0]
+    // [ 0  0 |  0  0 |  0  0]
+    cusp::array2d<float, cusp::host_memory> A(4, 6, 0);
+    A(0,0) = 10; A(0,4) = 20;
+    A(1,1) = 11; A(1,5) = 21;
+    A(2,2) = 30;
+
+    cusp::bsr_matrix<int, float, Space> B(A, 2);
+
+    ASSERT_EQUAL(B.block_size,   2);
+    ASSERT_EQUAL(B.num_blocks(), 3);
+    ASSERT_EQUAL(B.num_entries, 12);
+
+    cusp::bsr_matrix<int, float, cusp::host_memory> H(B);
+
+    ASSERT_EQUAL(H.block_size, 2);
+    ASSERT_EQUAL(H.row_offsets[0], 0);
+    ASSERT_EQUAL(H.row_offsets[1], 2);
+    ASSERT_EQUAL(H.row_offsets[2], 3);
+    ASSERT_EQUAL(H.column_indices[0], 0);
+    ASSERT_EQUAL(H.column_indices[1], 2);
+    ASSERT_EQUAL(H.column_indices[2], 1);
+
+    ASSERT_EQUAL(H.values[0],  10); ASSERT_EQUAL(H.values[1],   0);
+    ASSERT_EQUAL(H.values[2],   0); ASSERT_EQUAL(H.values[3],  11);
+    ASSERT_EQUAL(H.values[4],  20); ASSERT_EQUAL(H.values[5],   0);
+    ASSERT_EQUAL(H.values[6],   0); ASSERT_EQUAL(H.values[7],  21);
+    ASSERT_EQUAL(H.values[8],  30); ASSERT_EQUAL(H.values[9],   0);
+    ASSERT_EQUAL(H.values[10],  0); ASSERT_EQUAL(H.values[11],  0);
+
+    // convert back through CSR and COO
+    cusp::csr_matrix<int, float, Space> C(B);
+    cusp::coo_matrix<int, float, Space> D(B);
+
+    ASSERT_EQUAL(C.num_entries, 12);
+    ASSERT_EQUAL(D.num_entries, 12);
+
+    cusp::array2d<float, cusp::host_memory> E(C);
+    cusp::array2d<float, cusp::host_memory> F(D);
+    cusp::array2d<float, cusp::host_memory> G(B);
+
+    ASSERT_EQUAL(E == A, true);
+    ASSERT_EQUAL(F == A, true);
+    ASSERT_EQUAL(G == A, true);
+
+    // assignment keeps the block size of the destination
+    cusp::bsr_matrix<int, float, Space> I(4, 6, 0, 2);
+    I = C;
+
+    ASSERT_EQUAL(I.block_size,   2);
+    ASSERT_EQUAL(I.num_blocks(), 3);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBsrMatrixConversion);
+
+template <class Space>
+void TestBsrMatrixInvalidBlockSize(void)
+{
+    typedef cusp::bsr_matrix<int, float, Space> BsrMatrix;
+
+    cusp::csr_matrix<int, float, Space> A;
+    cusp::gallery::poisson5pt(A, 5, 5);
+
+    BsrMatrix B(4, 4, 0, 2);
+
+    ASSERT_THROWS(B = A, cusp::format_conversion_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBsrMatrixInvalidBlockSize);
+
+template <class Space>
+void TestBsrMatrixMultiply(void)
+{
+    // cover the specialized kernels and the generic one
+    for (size_t block_size = 1; block_size <= 8; block_size++)
+    {
+        cusp::csr_matrix<int, float, cusp::host_memory> A;
+        cusp::gallery::poisson5pt(A, 10, 3 * block_size);
+
+        cusp::bsr_matrix<int, float, Space> B(A, block_size);
+
+        ASSERT_EQUAL(B.block_size, block_size);
+
+        cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+        for (size_t i = 0; i < x.size(); i++)
+            x[i] = float(i % 7) - 3;
+
+        cusp::array1d<float, cusp::host_memory> y(A.num_rows, 0);
+        cusp::multiply(A, x, y);
+
+        cusp::array1d<float, Space> d_x(x);
+        cusp::array1d<float, Space> d_y(A.num_rows, 10);
+        cusp::multiply(B, d_x, d_y);
+
+        cusp::array1d<float, cusp::host_memory> z(d_y);
+
+        ASSERT_ALMOST_EQUAL(z, y);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBsrMatrixMultiply);
+
+void TestBsrMatrixRebind(void)
+{
+    typedef cusp::bsr_matrix<int, float, cusp::host_memory> HostMatrix;
+    typedef HostMatrix::rebind<cusp::device_memory>::type   DeviceMatrix;
+
+    HostMatrix   h_matrix(10,10,4,5);
+    DeviceMatrix d_matrix(h_matrix);
+
+    ASSERT_EQUAL(h_matrix.num_entries, d_matrix.num_entries);
+    ASSERT_EQUAL(d_matrix.block_size, 5);
+}
+DECLARE_UNITTEST(TestBsrMatrixRebind);
+
@@ -0,0 +1,115 @@
+#include <unittest/unittest.h>
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/caching_allocator.h>
+#include <cusp/detail/scoped_device.h>
+
+void TestCachingAllocatorReuse(void)
+{
+    typedef cusp::array1d<float, cusp::caching_device_allocator<float> > Array;
+
+    cusp::free_cached_memory();
+
+    {
+        Array x(1000, 1.0f);
+        ASSERT_EQUAL(cusp::get_caching_allocator_statistics().bytes_in_use >= 1000 * sizeof(float), true);
+    }
+
+    cusp::caching_allocator_statistics before = cusp::get_caching_allocator_statistics();
+    ASSERT_EQUAL(before.bytes_cached >= 1000 * sizeof(float), true);
+
+    {
+        // a request of the same size class is served from the cache
+        Array x(1000, 2.0f);
+        Array y(1000, 3.0f);
+
+        cusp::blas::axpy(x, y, 2.0f);
+        ASSERT_EQUAL(y[0],   7.0f);
+        ASSERT_EQUAL(y[999], 7.0f);
+
+        cusp::caching_allocator_statistics during = cusp::get_caching_allocator_statistics();
+        ASSERT_EQUAL(during.num_cache_hits > before.num_cache_hits, true);
+        ASSERT_EQUAL(during.bytes_cached < before.bytes_cached, true);
+        ASSERT_EQUAL(during.peak_bytes_in_use >= during.bytes_in_use, true);
+    }
+
+    cusp::free_cached_memory();
+    ASSERT_EQUAL(cusp::get_caching_allocator_statistics().bytes_cached, 0);
+}
+DECLARE_UNITTEST(TestCachingAllocatorReuse);
+
+void TestCachingAllocatorMemorySpace(void)
+{
+    typedef cusp::array1d<float, cusp::caching_device_allocator<float> > Array;
+
+    bool is_device = thrust::detail::is_same<Array::memory_space, cusp::device_memory>::value;
+    ASSERT_EQUAL(is_device, true);
+
+    // copies between caching and default device arrays
+    cusp::array1d<float, cusp::device_memory> a(5, 4.0f);
+    Array b(a);
+    cusp::array1d<float, cusp::host_memory> c(b);
+
+    ASSERT_EQUAL(c[0], 4.0f);
+    ASSERT_EQUAL(c[4], 4.0f);
+}
+DECLARE_UNITTEST(TestCachingAllocatorMemorySpace);
+
+void TestCachingAllocatorDevices(void)
+{
+    typedef cusp::array1d<float, cusp::caching_device_allocator<float> > Array;
+
+    int num_devices = 0;
+    cudaGetDeviceCount(&num_devices);
+
+    if (num_devices < 2)
+        return;
+
+    int device = 0;
+    cudaGetDevice(&device);
+    const int other = (device + 1) % num_devices;
+
+    cusp::free_cached_memory();
+
+    // a block freed on one device is not handed out on another
+    const float * freed = 0;
+    {
+        Array x(1000, 1.0f);
+        freed = thrust::raw_pointer_cast(&x[0]);
+    }
+
+    {
+        cusp::detail::scoped_device scope(other);
+
+        Array y(1000, 2.0f);
+        ASSERT_EQUAL(thrust::raw_pointer_cast(&y[0]) != freed, true);
+
+        cudaPointerAttributes attributes;
+        cudaPointerGetAttributes(&attributes, thrust::raw_pointer_cast(&y[0]));
+        ASSERT_EQUAL(attributes.device, other);
+
+        cusp::blas::scal(y, 3.0f);
+        ASSERT_EQUAL(y[999], 6.0f);
+    }
+
+    // a block of the other device freed while this device is current
+    {
+        Array * z = 0;
+        {
+            cusp::detail::scoped_device scope(other);
+            z = new Array(1000, 4.0f);
+        }
+        delete z;
+    }
+
+    {
+        Array x(1000, 5.0f);
+        ASSERT_EQUAL(thrust::raw_pointer_cast(&x[0]), freed);
+    }
+
+    cusp::free_cached_memory();
+    ASSERT_EQUAL(cusp::get_caching_allocator_statistics().bytes_cached, 0);
+}
+DECLARE_UNITTEST(TestCachingAllocatorDevices);
+
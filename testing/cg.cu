@@ -58,3 +58,65 @@ void TestConjugateGradientZeroResidual(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestConjugateGradientZeroResidual);
 
+
+template <class MemorySpace>
+void TestConjugateGradientSolver(void)
+{
+    cusp::krylov::cg_solver<float, MemorySpace> solver;
+
+    // the workspace follows the size of each system
+    for (int n = 10; n >= 5; n -= 5)
+    {
+        cusp::csr_matrix<int, float, MemorySpace> A;
+
+        cusp::gallery::poisson5pt(A, n, n);
+
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+        cusp::default_monitor<float> monitor(b, 20, 1e-4);
+
+        solver.solve(A, x, b, monitor);
+
+        // check residual norm
+        cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+        cusp::multiply(A, x, residual);
+        cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+        ASSERT_EQUAL(cusp::blas::nrm2(residual) < 1e-4 * cusp::blas::nrm2(b), true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestConjugateGradientSolver);
+
+
+void TestConjugateGradientOnStream(void)
+{
+    cusp::csr_matrix<int, float, cusp::device_memory> A;
+
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<float, cusp::device_memory> x(A.num_rows, 0.0f);
+    cusp::array1d<float, cusp::device_memory> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 20, 1e-4);
+    cusp::identity_operator<float, cusp::device_memory> M(A.num_rows, A.num_rows);
+
+    cudaStream_t stream;
+    cudaStreamCreate(&stream);
+
+    cusp::krylov::cg(A, x, b, monitor, M, stream);
+
+    // the previous stream is restored
+    ASSERT_EQUAL(cusp::current_stream() == 0, true);
+
+    cudaStreamSynchronize(stream);
+    cudaStreamDestroy(stream);
+
+    // check residual norm
+    cusp::array1d<float, cusp::device_memory> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 1e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_UNITTEST(TestConjugateGradientOnStream);
@@ -69,3 +69,37 @@ void TestConjugateGradientM(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestConjugateGradientM);
 
+
+template <class MemorySpace>
+void TestConjugateGradientMFreezeConvergedShifts(void)
+{
+    typedef float ValueType;
+
+    cusp::csr_matrix<int, ValueType, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    // more shifts than a tile of the device update, converging at different rates
+    size_t N_s = 40;
+    cusp::array1d<ValueType, MemorySpace> x(A.num_rows*N_s, ValueType(0));
+    cusp::array1d<ValueType, MemorySpace> y(A.num_rows*N_s, ValueType(0));
+    cusp::array1d<ValueType, MemorySpace> b(A.num_rows, ValueType(1));
+
+    cusp::array1d<ValueType, cusp::host_memory> h_sigma(N_s);
+    for (size_t i = 0; i < N_s; i++)
+        h_sigma[i] = ValueType(0.25) * ValueType(i * i) + ValueType(0.1);
+    cusp::array1d<ValueType, MemorySpace> sigma(h_sigma);
+
+    cusp::default_monitor<ValueType> monitor_x(b, 100, 1e-6);
+    cusp::krylov::cg_m(A, x, b, sigma, monitor_x, true);
+
+    check_residuals(A, x, b, sigma);
+
+    // freezing shifts does not change the iterations of the unshifted system
+    cusp::default_monitor<ValueType> monitor_y(b, 100, 1e-6);
+    cusp::krylov::cg_m(A, y, b, sigma, monitor_y, false);
+
+    ASSERT_EQUAL(monitor_x.iteration_count(), monitor_y.iteration_count());
+    ASSERT_ALMOST_EQUAL(cusp::blas::nrm2(y.begin(), y.begin() + A.num_rows),
+                 cusp::blas::nrm2(x.begin(), x.begin() + A.num_rows));
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestConjugateGradientMFreezeConvergedShifts);
@@ -0,0 +1,119 @@
+#include <unittest/unittest.h>
+
+#include <cusp/relaxation/chebyshev.h>
+
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+template <typename Matrix, typename Array>
+float residual_norm(const Matrix& A, const Array& b, const Array& x)
+{
+    Array r(A.num_rows);
+    cusp::multiply(A, x, r);
+    cusp::blas::axpby(b, r, r, 1.0f, -1.0f);
+    return cusp::blas::nrm2(r);
+}
+
+template <typename Matrix>
+void TestChebyshevRelaxation(void)
+{
+    typedef typename Matrix::memory_space Space;
+
+    cusp::csr_matrix<int, float, cusp::host_memory> M;
+    cusp::gallery::poisson5pt(M, 10, 10);
+
+    Matrix A(M);
+
+    cusp::relaxation::chebyshev<float, Space> relax(A);
+
+    // the spectral radius of D^-1 A is 1 + cos(pi / 11) = 1.959
+    ASSERT_EQUAL(relax.spectral_radius() > 1.5f,  true);
+    ASSERT_EQUAL(relax.spectral_radius() < 1.96f, true);
+
+    // reference recurrence on the host
+    const float lower = 1.0f / 30.0f;
+    const float upper = 1.1f;
+    const float rho   = relax.spectral_radius();
+    const float theta = 0.5f * (upper + lower) * rho;
+    const float delta = 0.5f * (upper - lower) * rho;
+    const float sigma = theta / delta;
+
+    cusp::array1d<float, cusp::host_memory> b = unittest::random_samples<float>(M.num_rows);
+    cusp::array1d<float, cusp::host_memory> x0 = unittest::random_samples<float>(M.num_rows);
+    cusp::array1d<float, cusp::host_memory> expected(x0);
+    cusp::array1d<float, cusp::host_memory> d(M.num_rows);
+    cusp::array1d<float, cusp::host_memory> y(M.num_rows);
+    
+    float rho_old = 1.0f / sigma;
+
+    for (size_t k = 0; k < 3; k++)
+    {
+        const float rho_new = k == 0 ? 0.0f : 1.0f / (2.0f * sigma - rho_old);
+
+        cusp::multiply(M, expected, y);
+
+        for (size_t i = 0; i < M.num_rows; i++)
+        {
+            // the diagonal of the 5-point stencil is 4
+            const float r = (b[i] - y[i]) / 4.0f;
+            d[i] = k == 0 ? r / theta : rho_new * rho_old * d[i] + 2.0f * rho_new / delta * r;
+            expected[i] += d[i];
+        }
+
+        if (k > 0)
+            rho_old = rho_new;
+    }
+
+    cusp::array1d<float, Space> x(x0);
+    relax(A, cusp::array1d<float, Space>(b), x);
+
+    ASSERT_ALMOST_EQUAL(x, expected);
+
+    // presmooth is postsmooth from a zero initial x
+    {
+        cusp::array1d<float, Space> x1(M.num_rows, 1.0f);
+        cusp::array1d<float, Space> x2(M.num_rows, 0.0f);
+
+        relax.presmooth(A, cusp::array1d<float, Space>(b), x1);
+        relax.postsmooth(A, cusp::array1d<float, Space>(b), x2);
+
+        ASSERT_ALMOST_EQUAL(x1, x2);
+    }
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestChebyshevRelaxation);
+
+template <class MemorySpace>
+void TestChebyshevRelaxationConvergence(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    cusp::array1d<float, MemorySpace> b = unittest::random_samples<float>(A.num_rows);
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+
+    cusp::relaxation::chebyshev<float, MemorySpace> relax(A);
+
+    const float norm_0 = cusp::blas::nrm2(b);
+
+    for (int i = 0; i < 20; i++)
+        relax(A, b, x);
+
+    ASSERT_EQUAL(residual_norm(A, b, x) < 0.5f * norm_0, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestChebyshevRelaxationConvergence);
+
+void TestChebyshevRelaxationBounds(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 4, 4);
+
+    ASSERT_THROWS((cusp::relaxation::chebyshev<float, cusp::host_memory>(A, 3, 1.0f, 0.5f)), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestChebyshevRelaxationBounds);
@@ -0,0 +1,95 @@
+#include <unittest/unittest.h>
+#include <cusp/column_blocked_matrix.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/random.h>
+
+template <class Space>
+void TestColumnBlockedMatrixPanels(void)
+{
+    // [10  0  0  0  0  0  0]
+    // [ 0 20  0  0  0  0 21]
+    // [30  0  0  0  0  0  0]
+    cusp::array2d<float, cusp::host_memory> A(3, 7, 0);
+    A(0,0) = 10;
+    A(1,1) = 20; A(1,6) = 21;
+    A(2,0) = 30;
+
+    // the panel of columns [2,4) is empty
+    cusp::column_blocked_matrix<int, float, Space> B(A, 2);
+
+    ASSERT_EQUAL(B.num_rows,     3);
+    ASSERT_EQUAL(B.num_cols,     7);
+    ASSERT_EQUAL(B.num_entries,  4);
+    ASSERT_EQUAL(B.panel_width,  2);
+    ASSERT_EQUAL(B.num_panels(), 2);
+
+    ASSERT_EQUAL(B.panel_columns[0], 0);
+    ASSERT_EQUAL(B.panel_columns[1], 6);
+    ASSERT_EQUAL(B.panels[0].num_cols,    2);
+    ASSERT_EQUAL(B.panels[0].num_entries, 3);
+    ASSERT_EQUAL(B.panels[1].num_cols,    1);
+    ASSERT_EQUAL(B.panels[1].num_entries, 1);
+
+    // column indices are relative to the panel
+    cusp::csr_matrix<int, float, cusp::host_memory> P(B.panels[1]);
+    ASSERT_EQUAL(P.row_offsets[0], 0);
+    ASSERT_EQUAL(P.row_offsets[1], 0);
+    ASSERT_EQUAL(P.row_offsets[2], 1);
+    ASSERT_EQUAL(P.row_offsets[3], 1);
+    ASSERT_EQUAL(P.column_indices[0], 0);
+    ASSERT_EQUAL(P.values[0], 21);
+
+    cusp::array1d<float, Space> x(7);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float(i + 1);
+
+    cusp::array1d<float, Space> y(3, -1);
+    cusp::multiply(B, x, y);
+
+    ASSERT_EQUAL(y[0],  10);
+    ASSERT_EQUAL(y[1], 187);
+    ASSERT_EQUAL(y[2],  30);
+
+    // an empty matrix stores zero
+    cusp::column_blocked_matrix<int, float, Space> C(cusp::array2d<float, cusp::host_memory>(3, 7, 0), 2);
+    cusp::multiply(C, x, y);
+
+    ASSERT_EQUAL(C.num_panels(), 0);
+    ASSERT_EQUAL(y[0], 0);
+    ASSERT_EQUAL(y[1], 0);
+    ASSERT_EQUAL(y[2], 0);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestColumnBlockedMatrixPanels);
+
+template <class Space>
+void TestColumnBlockedMatrixMultiply(void)
+{
+    cusp::coo_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::random(67, 20011, 3000, A);
+
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 7) - 3;
+
+    cusp::array1d<float, cusp::host_memory> y(A.num_rows, 0);
+    cusp::multiply(A, x, y);
+
+    // the default width holds the matrix in one panel
+    const size_t widths[] = {1, 100, 4096, 20011, 0};
+
+    for (size_t n = 0; n < 5; n++)
+    {
+        cusp::column_blocked_matrix<int, float, Space> B(A, widths[n]);
+
+        cusp::array1d<float, Space> d_x(x);
+        cusp::array1d<float, Space> d_y(A.num_rows, 10);
+        cusp::multiply(B, d_x, d_y);
+
+        cusp::array1d<float, cusp::host_memory> z(d_y);
+
+        ASSERT_ALMOST_EQUAL(z, y);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestColumnBlockedMatrixMultiply);
@@ -0,0 +1,154 @@
+#include <unittest/unittest.h>
+
+#include <cusp/io/binary.h>
+#include <cusp/io/matrix_market.h>
+
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/gallery/poisson.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+#if defined(CUSP_USE_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(CUSP_USE_ZSTD)
+#include <zstd.h>
+#endif
+
+const char plain_file_name[]      = "test_50183726495021.tmp";
+const char compressed_file_name[] = "test_50183726495021.cmp";
+
+std::vector<char> read_file_contents(const char * filename)
+{
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void write_file_contents(const char * filename, const char * data, const size_t size)
+{
+  std::ofstream file(filename, std::ios::out | std::ios::binary);
+  file.write(data, size);
+}
+
+#if defined(CUSP_USE_ZLIB)
+// compress the file as two gzip members
+void compress_gzip(const char * source, const char * destination)
+{
+  const std::vector<char> contents = read_file_contents(source);
+  const size_t half = contents.size() / 2;
+
+  gzFile file = gzopen(destination, "wb");
+  gzwrite(file, &contents[0], unsigned(half));
+  gzclose(file);
+
+  file = gzopen(destination, "ab");
+  gzwrite(file, &contents[0] + half, unsigned(contents.size() - half));
+  gzclose(file);
+}
+#endif
+
+#if defined(CUSP_USE_ZSTD)
+void compress_zstd(const char * source, const char * destination)
+{
+  const std::vector<char> contents = read_file_contents(source);
+
+  std::vector<char> compressed(ZSTD_compressBound(contents.size()));
+  const size_t size = ZSTD_compress(&compressed[0], compressed.size(), &contents[0], contents.size(), 1);
+
+  write_file_contents(destination, &compressed[0], size);
+}
+#endif
+
+template <typename MemorySpace, typename Compress>
+void ReadCompressedFiles(Compress compress)
+{
+  // large enough to take several blocks of the decompressor
+  cusp::csr_matrix<int, double, cusp::host_memory> A;
+  cusp::gallery::poisson5pt(A, 500, 500);
+
+  for (size_t n = 0; n < A.num_entries; n++)
+    A.values[n] = double(int(n % 1000) - 500) / 8;
+
+  // MatrixMarket
+  {
+    cusp::io::write_matrix_market_file(A, plain_file_name);
+    compress(plain_file_name, compressed_file_name);
+
+    cusp::csr_matrix<int, double, MemorySpace> B;
+    cusp::io::read_matrix_market_file(B, compressed_file_name);
+
+    ASSERT_EQUAL(B.row_offsets,    A.row_offsets);
+    ASSERT_EQUAL(B.column_indices, A.column_indices);
+    ASSERT_EQUAL(B.values,         A.values);
+  }
+
+  // binary
+  {
+    cusp::io::write_binary_file(A, plain_file_name);
+    compress(plain_file_name, compressed_file_name);
+
+    cusp::csr_matrix<int, double, MemorySpace> B;
+    cusp::io::read_binary_file(B, compressed_file_name);
+
+    ASSERT_EQUAL(B.row_offsets,    A.row_offsets);
+    ASSERT_EQUAL(B.column_indices, A.column_indices);
+    ASSERT_EQUAL(B.values,         A.values);
+  }
+
+  // truncated files
+  {
+    const std::vector<char> contents = read_file_contents(compressed_file_name);
+    write_file_contents(compressed_file_name, &contents[0], contents.size() / 2);
+
+    cusp::csr_matrix<int, double, MemorySpace> B;
+    ASSERT_THROWS(cusp::io::read_binary_file(B, compressed_file_name), cusp::io_exception);
+  }
+
+  remove(plain_file_name);
+  remove(compressed_file_name);
+}
+
+#if defined(CUSP_USE_ZLIB)
+template <typename MemorySpace>
+void TestReadGzipCompressedFiles(void)
+{
+  ReadCompressedFiles<MemorySpace>(compress_gzip);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestReadGzipCompressedFiles);
+#endif
+
+#if defined(CUSP_USE_ZSTD)
+template <typename MemorySpace>
+void TestReadZstdCompressedFiles(void)
+{
+  ReadCompressedFiles<MemorySpace>(compress_zstd);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestReadZstdCompressedFiles);
+#endif
+
+void TestReadCompressedFileUnsupported(void)
+{
+  // the magic numbers of the formats without their libraries
+  cusp::coo_matrix<int, float, cusp::host_memory> A;
+
+#if !defined(CUSP_USE_ZLIB)
+  const char gzip[] = {'\x1f', '\x8b', '\x08', '\x00'};
+  write_file_contents(compressed_file_name, gzip, sizeof(gzip));
+  ASSERT_THROWS(cusp::io::read_matrix_market_file(A, compressed_file_name), cusp::io_exception);
+#endif
+
+#if !defined(CUSP_USE_ZSTD)
+  const char zstd[] = {'\x28', '\xb5', '\x2f', '\xfd'};
+  write_file_contents(compressed_file_name, zstd, sizeof(zstd));
+  ASSERT_THROWS(cusp::io::read_matrix_market_file(A, compressed_file_name), cusp::io_exception);
+#endif
+
+  remove(compressed_file_name);
+}
+DECLARE_UNITTEST(TestReadCompressedFileUnsupported);
@@ -0,0 +1,74 @@
+#include <unittest/unittest.h>
+
+#include <cusp/graph/connected_components.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/gallery/poisson.h>
+
+template <typename TestMatrix>
+void TestConnectedComponents(void)
+{
+    typedef typename TestMatrix::memory_space MemorySpace;
+
+    // components {0, 3}, {1, 2, 4} and {5}
+    cusp::array2d<float, cusp::host_memory> D(6,6,0);
+    D(0,3) = 1; D(3,0) = 1;
+    D(1,4) = 1; D(4,1) = 1;
+    D(4,2) = 1; D(2,4) = 1;
+    D(5,5) = 1;
+
+    TestMatrix A(D);
+
+    cusp::array1d<int, MemorySpace> components;
+
+    ASSERT_EQUAL(cusp::graph::connected_components(A, components), (size_t) 3);
+
+    ASSERT_EQUAL(components[0], 0);
+    ASSERT_EQUAL(components[1], 1);
+    ASSERT_EQUAL(components[2], 1);
+    ASSERT_EQUAL(components[3], 0);
+    ASSERT_EQUAL(components[4], 1);
+    ASSERT_EQUAL(components[5], 2);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestConnectedComponents);
+
+template <typename MemorySpace>
+void TestConnectedComponentsGrids(void)
+{
+    // two grids whose vertices are interleaved
+    cusp::coo_matrix<int, float, cusp::host_memory> G;
+    cusp::gallery::poisson5pt(G, 40, 30);
+
+    const size_t N = G.num_rows;
+
+    cusp::coo_matrix<int, float, cusp::host_memory> H(2 * N, 2 * N, 2 * G.num_entries);
+
+    for (size_t n = 0; n < G.num_entries; n++)
+    {
+        H.row_indices[n]    = 2 * G.row_indices[n];
+        H.column_indices[n] = 2 * G.column_indices[n];
+        H.row_indices[G.num_entries + n]    = 2 * (N - 1 - G.row_indices[n]) + 1;
+        H.column_indices[G.num_entries + n] = 2 * (N - 1 - G.column_indices[n]) + 1;
+    }
+
+    H.sort_by_row_and_column();
+
+    cusp::csr_matrix<int, float, MemorySpace> A(H);
+
+    cusp::array1d<int, MemorySpace> components;
+
+    ASSERT_EQUAL(cusp::graph::connected_components(A, components), (size_t) 2);
+
+    cusp::array1d<int, cusp::host_memory> h_components(components);
+
+    for (size_t i = 0; i < 2 * N; i++)
+        ASSERT_EQUAL(h_components[i], int(i % 2));
+
+    // no vertices
+    cusp::csr_matrix<int, float, MemorySpace> E(0, 0, 0);
+    ASSERT_EQUAL(cusp::graph::connected_components(E, components), (size_t) 0);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestConnectedComponentsGrids);
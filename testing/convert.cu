@@ -370,6 +370,118 @@ void TestConvertCsrToEllMatrixHost(void)
 }
 DECLARE_UNITTEST(TestConvertCsrToEllMatrixHost);
 
+void TestConvertCsrToEllMatrixDevice(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> h_csr;
+    initialize_conversion_example(h_csr);
+
+    cusp::csr_matrix<int, float, cusp::device_memory> csr(h_csr);
+    cusp::ell_matrix<int, float, cusp::device_memory> ell;
+
+    // make ell with an alignment of 1
+    cusp::detail::device::convert(csr, ell, cusp::csr_format(), cusp::ell_format(), 3.0, 1);
+
+    cusp::ell_matrix<int, float, cusp::host_memory> expected;
+    cusp::detail::host::convert(h_csr, expected, cusp::csr_format(), cusp::ell_format(), 3.0, 1);
+
+    ASSERT_EQUAL(ell.num_rows,    expected.num_rows);
+    ASSERT_EQUAL(ell.num_cols,    expected.num_cols);
+    ASSERT_EQUAL(ell.num_entries, expected.num_entries);
+    ASSERT_EQUAL(ell.column_indices.num_cols, 3);
+    ASSERT_EQUAL(ell.column_indices.values, expected.column_indices.values);
+    ASSERT_EQUAL(ell.values.values,         expected.values.values);
+    
+    cusp::assert_is_valid_matrix(ell);
+}
+DECLARE_UNITTEST(TestConvertCsrToEllMatrixDevice);
+
+void TestConvertCsrToHybMatrixDevice(void)
+{
+    // rows of length 0, 1, ..., 9, repeated, and one long row
+    const int N = 200;
+
+    cusp::coo_matrix<int, float, cusp::host_memory> coo(N, N, 0);
+    for (int i = 0; i < N; i++)
+    {
+        const int length = (i == 17) ? N : i % 10;
+        for (int j = 0; j < length; j++)
+        {
+            coo.row_indices.push_back(i);
+            coo.column_indices.push_back((i + 3 * j) % N);
+            coo.values.push_back(float(i + j));
+        }
+    }
+    coo.num_entries = coo.values.size();
+    coo.sort_by_row_and_column();
+
+    cusp::csr_matrix<int, float, cusp::device_memory> csr(coo);
+    cusp::coo_matrix<int, float, cusp::device_memory> d_coo(coo);
+
+    for (size_t num_entries_per_row = 0; num_entries_per_row < 12; num_entries_per_row += 4)
+    {
+        cusp::hyb_matrix<int, float, cusp::device_memory> A;
+        cusp::hyb_matrix<int, float, cusp::device_memory> B;
+
+        cusp::detail::device::csr_to_hyb(csr,   A, num_entries_per_row);
+        cusp::detail::device::coo_to_hyb(d_coo, B, num_entries_per_row);
+
+        ASSERT_EQUAL(A.num_entries,                   B.num_entries);
+        ASSERT_EQUAL(A.ell.num_entries,               B.ell.num_entries);
+        ASSERT_EQUAL(A.ell.column_indices.values,     B.ell.column_indices.values);
+        ASSERT_EQUAL(A.ell.values.values,             B.ell.values.values);
+        ASSERT_EQUAL(A.coo.num_entries,               B.coo.num_entries);
+        ASSERT_EQUAL(A.coo.row_indices,               B.coo.row_indices);
+        ASSERT_EQUAL(A.coo.column_indices,            B.coo.column_indices);
+        ASSERT_EQUAL(A.coo.values,                    B.coo.values);
+
+        cusp::assert_is_valid_matrix(A);
+    }
+
+    // the ELL width chosen by the first conversion is cached with csr
+    cusp::hyb_matrix<int, float, cusp::device_memory> C(csr);
+    ASSERT_EQUAL(csr.row_statistics.is_hyb_valid(csr, 3.0, 4096, cusp::detail::device::compute_max_entries_per_row(csr)), true);
+    ASSERT_EQUAL(csr.row_statistics.hyb_entries_per_row, C.ell.column_indices.num_cols);
+
+    cusp::hyb_matrix<int, float, cusp::device_memory> D(csr);
+    ASSERT_EQUAL(D.ell.column_indices.values, C.ell.column_indices.values);
+    ASSERT_EQUAL(D.coo.values,                C.coo.values);
+}
+DECLARE_UNITTEST(TestConvertCsrToHybMatrixDevice);
+
+void TestConvertCsrWithStaleRowStatistics(void)
+{
+    // rows of lengths 1, 1 and 2
+    cusp::csr_matrix<int, float, cusp::device_memory> csr(3, 4, 4);
+    csr.row_offsets[0] = 0; csr.row_offsets[1] = 1; csr.row_offsets[2] = 2; csr.row_offsets[3] = 4;
+    csr.column_indices[0] = 0; csr.column_indices[1] = 1; csr.column_indices[2] = 2; csr.column_indices[3] = 3;
+    csr.values[0] = 1; csr.values[1] = 2; csr.values[2] = 3; csr.values[3] = 4;
+
+    // cache the row statistics and the HYB width
+    cusp::detail::get_row_statistics(csr);
+    cusp::hyb_matrix<int, float, cusp::device_memory> H(csr);
+
+    // move every entry to the last row in place, the shape is unchanged
+    csr.row_offsets[1] = 0; csr.row_offsets[2] = 0;
+
+    cusp::array2d<float, cusp::host_memory> expected(3, 4, 0);
+    expected(2,0) = 1; expected(2,1) = 2; expected(2,2) = 3; expected(2,3) = 4;
+
+    // the ELL width follows the row offsets, no entry is dropped
+    cusp::ell_matrix<int, float, cusp::device_memory> E(csr);
+    ASSERT_EQUAL(E.column_indices.num_cols, (size_t) 4);
+
+    cusp::array2d<float, cusp::host_memory> dense(E);
+    ASSERT_EQUAL(dense.values, expected.values);
+
+    // the cached HYB width is derived again for the new longest row
+    cusp::hyb_matrix<int, float, cusp::device_memory> G(csr);
+    ASSERT_EQUAL(csr.row_statistics.hyb_max_length, (size_t) 4);
+
+    dense = G;
+    ASSERT_EQUAL(dense.values, expected.values);
+}
+DECLARE_UNITTEST(TestConvertCsrWithStaleRowStatistics);
+
 template <class Matrix>
 void TestConversionFromArray1dTo(void)
 {
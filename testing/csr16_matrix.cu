@@ -0,0 +1,135 @@
+#include <unittest/unittest.h>
+#include <cusp/csr16_matrix.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/gallery/random.h>
+
+template <class Space>
+void TestCsr16MatrixBasicConstructor(void)
+{
+    cusp::csr16_matrix<int, float, Space> matrix(3, 100000, 4, 1);
+
+    ASSERT_EQUAL(matrix.num_rows,                 3);
+    ASSERT_EQUAL(matrix.num_cols,            100000);
+    ASSERT_EQUAL(matrix.num_entries,              4);
+    ASSERT_EQUAL(matrix.num_compressed_entries(), 3);
+    ASSERT_EQUAL(matrix.row_offsets.size(),       4);
+    ASSERT_EQUAL(matrix.row_bases.size(),         3);
+    ASSERT_EQUAL(matrix.column_offsets.size(),    3);
+    ASSERT_EQUAL(matrix.values.size(),            3);
+    ASSERT_EQUAL(matrix.overflow.num_entries,     1);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestCsr16MatrixBasicConstructor);
+
+template <class Space>
+void TestCsr16MatrixConversion(void)
+{
+    // [10  0  0 ...  0 20]     (20 at column 99999)
+    // [ 0 30 31 ...  0  0]
+    // [ 0  0  0 ... 40  0]     (40 at column 70000)
+    // [ 0  0  0 ...  0  0]
+    cusp::coo_matrix<int, float, cusp::host_memory> A(4, 100000, 5);
+    A.row_indices[0] = 0; A.column_indices[0] =     0; A.values[0] = 10;
+    A.row_indices[1] = 0; A.column_indices[1] = 99999; A.values[1] = 20;
+    A.row_indices[2] = 1; A.column_indices[2] =     1; A.values[2] = 30;
+    A.row_indices[3] = 1; A.column_indices[3] =     2; A.values[3] = 31;
+    A.row_indices[4] = 2; A.column_indices[4] = 70000; A.values[4] = 40;
+
+    cusp::csr16_matrix<int, float, Space> B(A);
+
+    ASSERT_EQUAL(B.num_entries,              5);
+    ASSERT_EQUAL(B.num_compressed_entries(), 4);
+    ASSERT_EQUAL(B.overflow.num_entries,     1);
+
+    cusp::csr16_matrix<int, float, cusp::host_memory> H(B);
+
+    ASSERT_EQUAL(H.row_offsets[0], 0);
+    ASSERT_EQUAL(H.row_offsets[1], 1);
+    ASSERT_EQUAL(H.row_offsets[2], 3);
+    ASSERT_EQUAL(H.row_offsets[3], 4);
+    ASSERT_EQUAL(H.row_offsets[4], 4);
+
+    ASSERT_EQUAL(H.row_bases[0],     0);
+    ASSERT_EQUAL(H.row_bases[1],     1);
+    ASSERT_EQUAL(H.row_bases[2], 70000);
+
+    ASSERT_EQUAL(H.column_offsets[0], 0); ASSERT_EQUAL(H.values[0], 10);
+    ASSERT_EQUAL(H.column_offsets[1], 0); ASSERT_EQUAL(H.values[1], 30);
+    ASSERT_EQUAL(H.column_offsets[2], 1); ASSERT_EQUAL(H.values[2], 31);
+    ASSERT_EQUAL(H.column_offsets[3], 0); ASSERT_EQUAL(H.values[3], 40);
+
+    ASSERT_EQUAL(H.overflow.row_indices[0],        0);
+    ASSERT_EQUAL(H.overflow.column_indices[0], 99999);
+    ASSERT_EQUAL(H.overflow.values[0],            20);
+
+    // convert back through CSR and COO
+    cusp::csr_matrix<int, float, Space> C(B);
+    cusp::coo_matrix<int, float, Space> D(B);
+
+    cusp::coo_matrix<int, float, cusp::host_memory> E(C);
+    cusp::coo_matrix<int, float, cusp::host_memory> F(D);
+
+    ASSERT_EQUAL(E.num_entries, 5);
+    ASSERT_EQUAL(F.num_entries, 5);
+    ASSERT_EQUAL(E.row_indices    == A.row_indices,    true);
+    ASSERT_EQUAL(E.column_indices == A.column_indices, true);
+    ASSERT_EQUAL(E.values         == A.values,         true);
+    ASSERT_EQUAL(F.row_indices    == A.row_indices,    true);
+    ASSERT_EQUAL(F.column_indices == A.column_indices, true);
+    ASSERT_EQUAL(F.values         == A.values,         true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestCsr16MatrixConversion);
+
+template <class Space>
+void TestCsr16MatrixMultiply(void)
+{
+    for (size_t n = 0; n < 2; n++)
+    {
+        cusp::csr_matrix<int, float, cusp::host_memory> A;
+
+        if (n == 0)
+            cusp::gallery::poisson5pt(A, 50, 40);
+        else
+            cusp::gallery::random(1000, 200000, 20000, A);
+
+        cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+        for (size_t i = 0; i < x.size(); i++)
+            x[i] = float(i % 7) - 3;
+
+        cusp::array1d<float, cusp::host_memory> y(A.num_rows, 0);
+        cusp::multiply(A, x, y);
+
+        cusp::csr16_matrix<int, float, Space> B(A);
+
+        ASSERT_EQUAL(B.num_entries, A.num_entries);
+
+        if (n == 0)
+            ASSERT_EQUAL(B.overflow.num_entries, 0);
+
+        cusp::array1d<float, Space> d_x(x);
+        cusp::array1d<float, Space> d_y(A.num_rows, 10);
+        cusp::multiply(B, d_x, d_y);
+
+        cusp::array1d<float, cusp::host_memory> z(d_y);
+
+        ASSERT_ALMOST_EQUAL(z, y);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestCsr16MatrixMultiply);
+
+void TestCsr16MatrixRebind(void)
+{
+    typedef cusp::csr16_matrix<int, float, cusp::host_memory> HostMatrix;
+    typedef HostMatrix::rebind<cusp::device_memory>::type     DeviceMatrix;
+
+    HostMatrix   h_matrix(10, 10, 50, 5);
+    DeviceMatrix d_matrix(h_matrix);
+
+    ASSERT_EQUAL(h_matrix.num_entries,              d_matrix.num_entries);
+    ASSERT_EQUAL(h_matrix.num_compressed_entries(), d_matrix.num_compressed_entries());
+    ASSERT_EQUAL(h_matrix.overflow.num_entries,     d_matrix.overflow.num_entries);
+}
+DECLARE_UNITTEST(TestCsr16MatrixRebind);
+
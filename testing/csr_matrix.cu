@@ -117,3 +117,31 @@ void TestCsrMatrixRebind(void)
 }
 DECLARE_UNITTEST(TestCsrMatrixRebind);
 
+
+template <class Space>
+void TestCsrMatrixRowStatistics(void)
+{
+    cusp::csr_matrix<int, float, Space> matrix(4, 6, 8);
+
+    matrix.row_offsets[0] = 0;
+    matrix.row_offsets[1] = 1;
+    matrix.row_offsets[2] = 1;
+    matrix.row_offsets[3] = 7;
+    matrix.row_offsets[4] = 8;
+
+    ASSERT_EQUAL(matrix.row_statistics.is_valid(matrix), false);
+
+    const cusp::detail::row_statistics& stats = cusp::detail::get_row_statistics(matrix);
+
+    ASSERT_EQUAL(matrix.row_statistics.is_valid(matrix), true);
+    ASSERT_EQUAL(stats.num_rows,    4);
+    ASSERT_EQUAL(stats.num_entries, 8);
+    ASSERT_EQUAL(stats.max_length,  6);
+    ASSERT_EQUAL(stats.mean,        2.0);
+    ASSERT_EQUAL(stats.variance,    5.5);
+
+    matrix.resize(5, 6, 8);
+    
+    ASSERT_EQUAL(matrix.row_statistics.is_valid(matrix), false);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestCsrMatrixRowStatistics);
@@ -1,7 +1,9 @@
 #include <unittest/unittest.h>
 
+#include <cusp/coo_matrix.h>
 #include <cusp/csr_matrix.h>
 #include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
 
 template <typename MemorySpace>
 void TestCsrMatrixView(void)
@@ -187,3 +189,62 @@ void TestMakeCsrMatrixView(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestMakeCsrMatrixView);
 
+
+
+template <typename MemorySpace>
+void TestCsrMatrixViewWideRowOffsets(void)
+{
+  typedef typename cusp::array1d<long long,MemorySpace>                 OffsetArray;
+  typedef typename cusp::array1d<int,MemorySpace>                       IndexArray;
+  typedef typename cusp::array1d<float,MemorySpace>                     ValueArray;
+  typedef typename cusp::array1d_view<typename OffsetArray::iterator>   OffsetView;
+  typedef typename cusp::array1d_view<typename IndexArray::iterator>    IndexView;
+  typedef typename cusp::array1d_view<typename ValueArray::iterator>    ValueView;
+  typedef typename cusp::csr_matrix_view<OffsetView,IndexView,ValueView> View;
+
+  for (size_t n = 0; n < 2; n++)
+  {
+    cusp::coo_matrix<int,float,cusp::host_memory> C;
+
+    if (n == 0)
+    {
+      cusp::gallery::poisson5pt(C, 20, 30);
+    }
+    else
+    {
+      // a long row among short ones, which selects the merge-path kernel on the device
+      const int N = 3000;
+      C.resize(N, N, 2 * N - 1);
+      for (int i = 0; i < N; i++) { C.row_indices[i] = i; C.column_indices[i] = i; C.values[i] = float(i % 5) + 1; }
+      for (int j = 0, k = N; j < N; j++)
+        if (j != 7) { C.row_indices[k] = 7; C.column_indices[k] = j; C.values[k] = -1; k++; }
+      C.sort_by_row_and_column();
+    }
+
+    cusp::csr_matrix<int,float,cusp::host_memory> M(C);
+
+    // 64-bit row offsets with 32-bit column indices
+    OffsetArray row_offsets(M.row_offsets);
+    IndexArray  column_indices(M.column_indices);
+    ValueArray  values(M.values);
+
+    cusp::array1d<float,cusp::host_memory> x(M.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+      x[i] = float(i % 7) - 3;
+
+    cusp::array1d<float,cusp::host_memory> reference(M.num_rows, 0);
+    cusp::multiply(M, x, reference);
+
+    cusp::array1d<float,MemorySpace> d_x(x);
+    cusp::array1d<float,MemorySpace> d_y(M.num_rows, 10);
+    View V(M.num_rows, M.num_cols, M.num_entries,
+           cusp::make_array1d_view(row_offsets),
+           cusp::make_array1d_view(column_indices),
+           cusp::make_array1d_view(values));
+    cusp::multiply(V, d_x, d_y);
+
+    ASSERT_EQUAL(d_y, reference);
+  }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestCsrMatrixViewWideRowOffsets);
+
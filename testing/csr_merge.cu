@@ -0,0 +1,80 @@
+#include <unittest/unittest.h>
+
+#include <cusp/detail/device/spmv/csr_merge.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/gallery/random.h>
+
+template <typename HostMatrix>
+void CompareCsrMergeSpMV(const HostMatrix& M)
+{
+    typedef typename HostMatrix::index_type IndexType;
+    typedef typename HostMatrix::value_type ValueType;
+
+    cusp::csr_matrix<IndexType,ValueType,cusp::device_memory> A(M);
+
+    cusp::array1d<ValueType, cusp::host_memory> x = unittest::random_integers<char>(M.num_cols);
+
+    // compute reference
+    cusp::array1d<ValueType, cusp::host_memory> reference(M.num_rows, 0);
+    cusp::multiply(M, x, reference);
+
+    cusp::array1d<ValueType, cusp::device_memory> d_x(x);
+    cusp::array1d<ValueType, cusp::device_memory> d_y(M.num_rows, 10);
+
+    cusp::detail::device::spmv_csr_merge(A, thrust::raw_pointer_cast(&d_x[0]), thrust::raw_pointer_cast(&d_y[0]));
+
+    ASSERT_EQUAL(d_y, reference);
+}
+
+template <typename IndexType>
+void _TestCsrMergeSpMV(void)
+{
+    typedef typename cusp::csr_matrix<IndexType,float,cusp::host_memory> HostMatrix;
+
+    {
+        cusp::array2d<float, cusp::host_memory> A(5,4);
+        A(0,0) = 13; A(0,1) = 80; A(0,2) =  0; A(0,3) =  0;
+        A(1,0) =  0; A(1,1) =  0; A(1,2) =  0; A(1,3) =  0;
+        A(2,0) = 55; A(2,1) =  0; A(2,2) = 24; A(2,3) = 42;
+        A(3,0) =  0; A(3,1) = 69; A(3,2) =  0; A(3,3) = 83;
+        A(4,0) =  0; A(4,1) =  0; A(4,2) = 27; A(4,3) =  0;
+
+        CompareCsrMergeSpMV(HostMatrix(A));
+    }
+
+    { HostMatrix M; cusp::gallery::poisson5pt(M,  10,  10);   CompareCsrMergeSpMV(M); }
+    { HostMatrix M; cusp::gallery::poisson5pt(M, 117, 113);   CompareCsrMergeSpMV(M); }
+    { HostMatrix M; cusp::gallery::random( 21,  23,   5, M);  CompareCsrMergeSpMV(M); }
+    { HostMatrix M; cusp::gallery::random(355, 378, 234, M);  CompareCsrMergeSpMV(M); }
+
+    // a few very long rows among many short or empty ones
+    {
+        const IndexType N = 2000;
+
+        cusp::coo_matrix<IndexType,float,cusp::host_memory> M(N, N, 3 * N + N / 2);
+
+        IndexType n = 0;
+        for (IndexType j = 0; j < N; j++, n++) { M.row_indices[n] =     8; M.column_indices[n] = j; M.values[n] = 1; }
+        for (IndexType j = 0; j < N; j++, n++) { M.row_indices[n] =  1000; M.column_indices[n] = j; M.values[n] = 2; }
+        for (IndexType j = 0; j < N; j++, n++) { M.row_indices[n] =  1002; M.column_indices[n] = j; M.values[n] = 3; }
+        for (IndexType i = 0; i < N; i += 2, n++) { M.row_indices[n] = i + 1; M.column_indices[n] = i; M.values[n] = 4; }
+
+        M.sort_by_row_and_column();
+
+        CompareCsrMergeSpMV(HostMatrix(M));
+    }
+}
+
+void TestCsrMergeSpMV(void)
+{
+    _TestCsrMergeSpMV<int>();
+    _TestCsrMergeSpMV<long long>();
+}
+DECLARE_UNITTEST(TestCsrMergeSpMV);
+
@@ -0,0 +1,147 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/precond/diagonal.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/krylov/deflated_cg.h>
+
+// right-hand side of step s of a sequence
+template <typename Array>
+void initialize_step_rhs(Array& b, size_t s)
+{
+    for (size_t i = 0; i < b.size(); i++)
+        b[i] = float((i * (s + 1)) % (s + 5)) + 1.0f;
+}
+
+template <typename Matrix, typename Array1, typename Array2>
+float relative_residual(const Matrix& A, const Array1& x, const Array2& b)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> H(A);
+    cusp::array1d<float, cusp::host_memory> x_h(x);
+    cusp::array1d<float, cusp::host_memory> b_h(b);
+    cusp::array1d<float, cusp::host_memory> r(b.size());
+
+    cusp::multiply(H, x_h, r);
+    cusp::blas::axpby(r, b_h, r, -1.0f, 1.0f);
+
+    return cusp::blas::nrm2(r) / cusp::blas::nrm2(b_h);
+}
+
+template <class MemorySpace>
+void TestDeflatedConjugateGradientSequence(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 16, 16);
+
+    cusp::krylov::deflated_cg_solver<float, MemorySpace> deflated(8, 24);
+    cusp::krylov::cg_solver<float, MemorySpace> plain(A.num_rows);
+
+    ASSERT_EQUAL(deflated.deflation_size(), (size_t) 0);
+
+    size_t deflated_iterations = 0;
+    size_t plain_iterations    = 0;
+
+    for (size_t s = 0; s < 6; s++)
+    {
+        cusp::array1d<float, MemorySpace> b(A.num_rows);
+        initialize_step_rhs(b, s);
+
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 200, 1e-5);
+        deflated.solve(A, x, b, monitor);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+        ASSERT_EQUAL(relative_residual(A, x, b) < 1e-4, true);
+        ASSERT_EQUAL(deflated.deflation_size(), (size_t) 8);
+
+        cusp::array1d<float, MemorySpace> x_plain(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor_plain(b, 200, 1e-5);
+        plain.solve(A, x_plain, b, monitor_plain);
+
+        // the first solve has no deflation space yet
+        if (s == 0)
+            ASSERT_EQUAL(monitor.iteration_count(), monitor_plain.iteration_count());
+
+        deflated_iterations += monitor.iteration_count();
+        plain_iterations    += monitor_plain.iteration_count();
+    }
+
+    ASSERT_EQUAL(deflated_iterations < plain_iterations, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDeflatedConjugateGradientSequence);
+
+template <class MemorySpace>
+void TestDeflatedConjugateGradientPreconditioned(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 12, 9);
+
+    cusp::precond::diagonal<float, MemorySpace> M(A);
+    cusp::krylov::deflated_cg_solver<float, MemorySpace> solver(4);
+
+    for (size_t s = 0; s < 3; s++)
+    {
+        cusp::array1d<float, MemorySpace> b(A.num_rows);
+        initialize_step_rhs(b, s);
+
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 200, 1e-5);
+        solver.solve(A, x, b, monitor, M);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+        ASSERT_EQUAL(relative_residual(A, x, b) < 1e-4, true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDeflatedConjugateGradientPreconditioned);
+
+template <class MemorySpace>
+void TestDeflatedConjugateGradientDeflationSpace(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::krylov::deflated_cg_solver<float, MemorySpace> solver(2);
+
+    // an exact solution in the deflation space is found by the projection
+    cusp::array2d<float, cusp::host_memory, cusp::column_major> W_h(A.num_rows, 2);
+    for (size_t i = 0; i < W_h.num_rows; i++)
+    {
+        W_h(i,0) = 1.0f;
+        W_h(i,1) = float(i % 7);
+    }
+
+    cusp::array1d<float, cusp::host_memory> x0(A.num_rows);
+    for (size_t i = 0; i < x0.size(); i++)
+        x0[i] = 2.0f * W_h(i,0) - W_h(i,1);
+
+    cusp::array1d<float, MemorySpace> x_exact(x0);
+    cusp::array1d<float, MemorySpace> b(A.num_rows);
+    cusp::multiply(A, x_exact, b);
+
+    cusp::array2d<float, MemorySpace, cusp::column_major> W(W_h);
+    solver.set_deflation_space(W);
+    ASSERT_EQUAL(solver.deflation_size(), (size_t) 2);
+
+    cusp::array2d<float, cusp::host_memory, cusp::column_major> V;
+    solver.get_deflation_space(V);
+    ASSERT_EQUAL(V == W_h, true);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::default_monitor<float> monitor(b, 100, 1e-5);
+    solver.solve(A, x, b, monitor);
+
+    ASSERT_EQUAL(monitor.iteration_count(), (size_t) 0);
+    ASSERT_ALMOST_EQUAL(cusp::array1d<float, cusp::host_memory>(x), x0);
+
+    solver.clear();
+    ASSERT_EQUAL(solver.deflation_size(), (size_t) 0);
+
+    cusp::array2d<float, MemorySpace, cusp::column_major> W3(A.num_rows, 3, 1.0f);
+    ASSERT_THROWS(solver.set_deflation_space(W3), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDeflatedConjugateGradientDeflationSpace);
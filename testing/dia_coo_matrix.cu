@@ -0,0 +1,152 @@
+#include <unittest/unittest.h>
+#include <cusp/dia_coo_matrix.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+template <class Space>
+void TestDiaCooMatrixBasicConstructor(void)
+{
+    cusp::dia_coo_matrix<int, float, Space> matrix(10, 10, 28, 2, 3);
+
+    ASSERT_EQUAL(matrix.num_rows,                      10);
+    ASSERT_EQUAL(matrix.num_cols,                      10);
+    ASSERT_EQUAL(matrix.num_entries,                   30);
+    ASSERT_EQUAL(matrix.min_fill,                    0.5f);
+    ASSERT_EQUAL(matrix.dia.num_entries,               28);
+    ASSERT_EQUAL(matrix.dia.diagonal_offsets.size(),    3);
+    ASSERT_EQUAL(matrix.dia.values.num_cols,            3);
+    ASSERT_EQUAL(matrix.coo.num_entries,                2);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDiaCooMatrixBasicConstructor);
+
+template <class Space>
+void TestDiaCooMatrixConversion(void)
+{
+    // tridiagonal matrix with two entries in opposite corners
+    // [ 2 -1  0  0  0  7]
+    // [-1  2 -1  0  0  0]
+    // [ 0 -1  2 -1  0  0]
+    // [ 0  0 -1  2 -1  0]
+    // [ 0  0  0 -1  2 -1]
+    // [ 8  0  0  0 -1  2]
+    cusp::array2d<float, cusp::host_memory> A(6, 6, 0);
+    for (int i = 0; i < 6; i++)
+    {
+        A(i,i) = 2;
+        if (i > 0) A(i,i-1) = -1;
+        if (i < 5) A(i,i+1) = -1;
+    }
+    A(0,5) = 7;
+    A(5,0) = 8;
+
+    cusp::dia_coo_matrix<int, float, Space> B(A);
+
+    ASSERT_EQUAL(B.num_entries,     18);
+    ASSERT_EQUAL(B.dia.num_entries, 16);
+    ASSERT_EQUAL(B.coo.num_entries,  2);
+
+    cusp::dia_coo_matrix<int, float, cusp::host_memory> H(B);
+
+    ASSERT_EQUAL(H.dia.diagonal_offsets.size(), 3);
+    ASSERT_EQUAL(H.dia.diagonal_offsets[0], -1);
+    ASSERT_EQUAL(H.dia.diagonal_offsets[1],  0);
+    ASSERT_EQUAL(H.dia.diagonal_offsets[2],  1);
+
+    ASSERT_EQUAL(H.coo.row_indices[0], 0); ASSERT_EQUAL(H.coo.column_indices[0], 5); ASSERT_EQUAL(H.coo.values[0], 7);
+    ASSERT_EQUAL(H.coo.row_indices[1], 5); ASSERT_EQUAL(H.coo.column_indices[1], 0); ASSERT_EQUAL(H.coo.values[1], 8);
+
+    // convert back through CSR and COO
+    cusp::csr_matrix<int, float, Space> C(B);
+    cusp::coo_matrix<int, float, Space> D(B);
+
+    cusp::array2d<float, cusp::host_memory> E(C);
+    cusp::array2d<float, cusp::host_memory> F(D);
+    cusp::array2d<float, cusp::host_memory> G(B);
+
+    ASSERT_EQUAL(C.num_entries, 18);
+    ASSERT_EQUAL(D.num_entries, 18);
+    ASSERT_EQUAL(E == A, true);
+    ASSERT_EQUAL(F == A, true);
+    ASSERT_EQUAL(G == A, true);
+
+    // every occupied diagonal in the DIA portion
+    cusp::dia_coo_matrix<int, float, Space> I(A, 0.0f);
+
+    ASSERT_EQUAL(I.dia.diagonal_offsets.size(), 5);
+    ASSERT_EQUAL(I.coo.num_entries,             0);
+
+    // every entry in the COO portion
+    cusp::dia_coo_matrix<int, float, Space> J(A, 2.0f);
+
+    ASSERT_EQUAL(J.dia.diagonal_offsets.size(),  0);
+    ASSERT_EQUAL(J.coo.num_entries,             18);
+
+    cusp::array2d<float, cusp::host_memory> K(J);
+    ASSERT_EQUAL(K == A, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDiaCooMatrixConversion);
+
+template <class Space>
+void TestDiaCooMatrixMultiply(void)
+{
+    // poisson5pt with periodic coupling of the first and last grid rows
+    const int n = 20;
+
+    cusp::coo_matrix<int, float, cusp::host_memory> P;
+    cusp::gallery::poisson5pt(P, n, n);
+
+    cusp::coo_matrix<int, float, cusp::host_memory> Q(P);
+    for (int j = 0; j < n; j++)
+    {
+        Q.row_indices.push_back(j);
+        Q.column_indices.push_back(n * (n - 1) + j);
+        Q.values.push_back(-1);
+    }
+    Q.num_entries = Q.values.size();
+    Q.sort_by_row_and_column();
+
+    cusp::csr_matrix<int, float, cusp::host_memory> A(Q);
+
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 7) - 3;
+
+    for (size_t m = 0; m < 2; m++)
+    {
+        cusp::dia_coo_matrix<int, float, Space> B(A, m == 0 ? 0.5f : 0.0f);
+
+        ASSERT_EQUAL(B.num_entries, A.num_entries);
+        ASSERT_EQUAL(B.coo.num_entries, m == 0 ? n : 0);
+        ASSERT_EQUAL(B.dia.diagonal_offsets.size(), m == 0 ? 5 : 6);
+
+        cusp::array1d<float, cusp::host_memory> y(A.num_rows, 0);
+        cusp::multiply(A, x, y);
+
+        cusp::array1d<float, Space> d_x(x);
+        cusp::array1d<float, Space> d_y(A.num_rows, 10);
+        cusp::multiply(B, d_x, d_y);
+
+        cusp::array1d<float, cusp::host_memory> z(d_y);
+
+        ASSERT_ALMOST_EQUAL(z, y);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDiaCooMatrixMultiply);
+
+void TestDiaCooMatrixRebind(void)
+{
+    typedef cusp::dia_coo_matrix<int, float, cusp::host_memory> HostMatrix;
+    typedef HostMatrix::rebind<cusp::device_memory>::type        DeviceMatrix;
+
+    HostMatrix   h_matrix(10, 10, 28, 2, 3);
+    DeviceMatrix d_matrix(h_matrix);
+
+    ASSERT_EQUAL(h_matrix.num_entries,     d_matrix.num_entries);
+    ASSERT_EQUAL(h_matrix.dia.num_entries, d_matrix.dia.num_entries);
+    ASSERT_EQUAL(h_matrix.coo.num_entries, d_matrix.coo.num_entries);
+}
+DECLARE_UNITTEST(TestDiaCooMatrixRebind);
+
@@ -56,3 +56,50 @@ void TestDiagonalPreconditioner(void)
 }
 DECLARE_SPARSE_MATRIX_UNITTEST(TestDiagonalPreconditioner);
 
+
+template <class MatrixType>
+void TestDiagonalCache(void)
+{
+    typedef typename MatrixType::memory_space Space;
+
+    cusp::array2d<float, Space> A(3,3);
+    A(0,0) = 2.0;  A(0,1) = 1.0;   A(0,2) = 0.0;
+    A(1,0) = 1.0;  A(1,1) = 4.0;   A(1,2) = 0.0;
+    A(2,0) = 0.0;  A(2,1) = 3.0;   A(2,2) = -0.5;
+
+    MatrixType M(A);
+
+    cusp::detail::diagonal_cache<float, Space> cache;
+
+    cusp::array1d<float, Space> diagonal = cache.diagonal(M);
+    ASSERT_EQUAL(diagonal.size(), 3);
+    ASSERT_EQUAL(diagonal[0],  2.0f);
+    ASSERT_EQUAL(diagonal[1],  4.0f);
+    ASSERT_EQUAL(diagonal[2], -0.5f);
+
+    // the preconditioner takes the reciprocals from the cache
+    cusp::precond::diagonal<float, Space> D(M, cache);
+
+    cusp::array1d<float, Space> input(3, 1.0);
+    cusp::array1d<float, Space> output(3, 0.0f);
+    D(input, output);
+
+    ASSERT_EQUAL(output[0],  0.50f);
+    ASSERT_EQUAL(output[1],  0.25f);
+    ASSERT_EQUAL(output[2], -2.00f);
+
+    // the cache holds its diagonal until it is invalidated
+    cusp::array2d<float, Space> A2(A);
+    for (size_t i = 0; i < A2.values.size(); i++)
+        A2.values[i] *= 2.0f;
+
+    MatrixType M2(A2);
+
+    ASSERT_EQUAL(cache.diagonal(M2)[1], 4.0f);
+
+    cache.invalidate();
+
+    ASSERT_EQUAL(cache.diagonal(M2)[1],         8.0f);
+    ASSERT_EQUAL(cache.inverse_diagonal(M2)[0], 0.25f);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestDiagonalCache);
@@ -0,0 +1,209 @@
+#include <unittest/unittest.h>
+
+#include <cusp/distributed_array1d.h>
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+
+// ranges on the current device, repeated to exercise the partitioning
+static cusp::distribution current_distribution(size_t N, size_t num_partitions)
+{
+    int device = 0;
+    cudaGetDevice(&device);
+
+    return cusp::distribution(N, std::vector<int>(num_partitions, device));
+}
+
+void TestDistribution(void)
+{
+    cusp::distribution d = current_distribution(10, 3);
+
+    ASSERT_EQUAL(d.size(),           (size_t) 10);
+    ASSERT_EQUAL(d.num_partitions(), (size_t)  3);
+    ASSERT_EQUAL(d.begin(0), (size_t)  0);
+    ASSERT_EQUAL(d.end(0),   (size_t)  3);
+    ASSERT_EQUAL(d.end(1),   (size_t)  6);
+    ASSERT_EQUAL(d.end(2),   (size_t) 10);
+
+    ASSERT_EQUAL(d == current_distribution(10, 3), true);
+    ASSERT_EQUAL(d != current_distribution(10, 2), true);
+
+    std::vector<int>    devices(2, d.device(0));
+    std::vector<size_t> offsets(3);
+    offsets[0] = 0; offsets[1] = 5; offsets[2] = 4;
+
+    ASSERT_THROWS(cusp::distribution(devices, offsets), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestDistribution);
+
+void TestDistributionCommunicator(void)
+{
+    int device = 0;
+    cudaGetDevice(&device);
+
+    cusp::communicator comm;
+
+    // one range per process
+    cusp::distribution d(10, device, comm);
+
+    ASSERT_EQUAL(d.num_partitions(), (size_t) comm.size());
+    ASSERT_EQUAL(d.size(),           (size_t) 10);
+    ASSERT_EQUAL(d.rank(comm.rank()), comm.rank());
+    ASSERT_EQUAL(d.local(comm.rank()), true);
+    ASSERT_EQUAL(d.device(comm.rank()), device);
+
+    cusp::distribution e = current_distribution(10, 3);
+
+    ASSERT_EQUAL(e.owner(0), (size_t) 0);
+    ASSERT_EQUAL(e.owner(3), (size_t) 1);
+    ASSERT_EQUAL(e.owner(9), (size_t) 2);
+    ASSERT_EQUAL(e.local(1), true);
+
+    // ranks must belong to the communicator
+    std::vector<int>    devices(2, device);
+    std::vector<size_t> offsets(3);
+    offsets[0] = 0; offsets[1] = 4; offsets[2] = 10;
+
+    ASSERT_THROWS(cusp::distribution(devices, offsets, std::vector<int>(2, comm.size()), comm), cusp::invalid_input_exception);
+
+    std::vector<int> numbers;
+    comm.allgather(comm.rank(), numbers);
+
+    ASSERT_EQUAL(numbers.size(), (size_t) comm.size());
+    ASSERT_EQUAL(numbers[comm.rank()], comm.rank());
+}
+DECLARE_UNITTEST(TestDistributionCommunicator);
+
+void TestDistributedArray1d(void)
+{
+    cusp::distributed_array1d<float> x(current_distribution(10, 3), 2.0f);
+
+    ASSERT_EQUAL(x.size(),             (size_t) 10);
+    ASSERT_EQUAL(x.num_partitions(),   (size_t)  3);
+    ASSERT_EQUAL(x.slice(0).size(),    (size_t)  3);
+    ASSERT_EQUAL(x.slice(2).size(),    (size_t)  4);
+
+    cusp::array1d<float, cusp::host_memory> h(10);
+    for (size_t i = 0; i < h.size(); i++)
+        h[i] = float(i);
+
+    x = h;
+
+    cusp::array1d<float, cusp::host_memory> result;
+    x.gather(result);
+    ASSERT_EQUAL(result, h);
+
+    // copies keep the distribution
+    cusp::distributed_array1d<float> y(x);
+    ASSERT_EQUAL(y.get_distribution() == x.get_distribution(), true);
+
+    y.gather(result);
+    ASSERT_EQUAL(result, h);
+}
+DECLARE_UNITTEST(TestDistributedArray1d);
+
+void TestScopedDistribution(void)
+{
+    cusp::distribution d = current_distribution(10, 3);
+
+    {
+        cusp::scoped_distribution scope(d);
+
+        cusp::array1d<float, cusp::distributed_memory> x(10);
+        cusp::array1d<float, cusp::distributed_memory> y(7);
+
+        ASSERT_EQUAL(x.get_distribution() == d, true);
+        ASSERT_EQUAL(y.get_distribution() == d, false);
+        ASSERT_EQUAL(y.size(), (size_t) 7);
+    }
+
+    cusp::array1d<float, cusp::distributed_memory> z(10);
+    ASSERT_EQUAL(z.get_distribution() == d, false);
+}
+DECLARE_UNITTEST(TestScopedDistribution);
+
+template <typename ValueType>
+void CompareDistributedBlas(size_t N, size_t num_partitions)
+{
+    cusp::array1d<ValueType, cusp::host_memory> hx(N);
+    cusp::array1d<ValueType, cusp::host_memory> hy(N);
+    cusp::array1d<ValueType, cusp::host_memory> hz(N);
+
+    for (size_t i = 0; i < N; i++)
+    {
+        hx[i] = ValueType((i % 5)) - ValueType(2);
+        hy[i] = ValueType((i % 3)) + ValueType(1);
+        hz[i] = ValueType((i % 7));
+    }
+
+    cusp::distribution d = current_distribution(N, num_partitions);
+
+    cusp::distributed_array1d<ValueType> x(d);
+    cusp::distributed_array1d<ValueType> y(d);
+    cusp::distributed_array1d<ValueType> z(d);
+
+    x = hx;
+    y = hy;
+    z = hz;
+
+    // reductions
+    ASSERT_ALMOST_EQUAL(cusp::blas::dot(x, y),  cusp::blas::dot(hx, hy));
+    ASSERT_ALMOST_EQUAL(cusp::blas::dotc(x, y), cusp::blas::dotc(hx, hy));
+    ASSERT_ALMOST_EQUAL(cusp::blas::nrm1(x),    cusp::blas::nrm1(hx));
+    ASSERT_ALMOST_EQUAL(cusp::blas::nrm2(x),    cusp::blas::nrm2(hx));
+    ASSERT_ALMOST_EQUAL(cusp::blas::nrmmax(x),  cusp::blas::nrmmax(hx));
+
+    cusp::array1d<ValueType, cusp::host_memory> result;
+
+    // vector updates
+    cusp::blas::axpy(x, y, ValueType(2));
+    cusp::blas::axpy(hx, hy, ValueType(2));
+    y.gather(result);
+    ASSERT_EQUAL(result, hy);
+
+    cusp::blas::axpby(x, y, z, ValueType(3), ValueType(-1));
+    cusp::blas::axpby(hx, hy, hz, ValueType(3), ValueType(-1));
+    z.gather(result);
+    ASSERT_EQUAL(result, hz);
+
+    cusp::blas::axpbypcz(x, y, z, z, ValueType(1), ValueType(2), ValueType(3));
+    cusp::blas::axpbypcz(hx, hy, hz, hz, ValueType(1), ValueType(2), ValueType(3));
+    z.gather(result);
+    ASSERT_EQUAL(result, hz);
+
+    cusp::blas::xmy(x, y, z);
+    cusp::blas::xmy(hx, hy, hz);
+    z.gather(result);
+    ASSERT_EQUAL(result, hz);
+
+    cusp::blas::scal(z, ValueType(4));
+    cusp::blas::scal(hz, ValueType(4));
+    z.gather(result);
+    ASSERT_EQUAL(result, hz);
+
+    cusp::blas::copy(x, z);
+    z.gather(result);
+    ASSERT_EQUAL(result, hx);
+
+    cusp::blas::fill(z, ValueType(7));
+    z.gather(result);
+    ASSERT_EQUAL(result, cusp::array1d<ValueType, cusp::host_memory>(N, ValueType(7)));
+}
+
+void TestDistributedBlas(void)
+{
+    CompareDistributedBlas<float>(   0, 2);
+    CompareDistributedBlas<float>(   5, 8);
+    CompareDistributedBlas<float>(1000, 3);
+    CompareDistributedBlas<double>(100000, 4);
+}
+DECLARE_UNITTEST(TestDistributedBlas);
+
+void TestDistributedBlasMismatch(void)
+{
+    cusp::distributed_array1d<float> x(current_distribution(10, 2), 1.0f);
+    cusp::distributed_array1d<float> y(current_distribution(10, 3), 1.0f);
+
+    ASSERT_THROWS(cusp::blas::dot(x, y), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestDistributedBlasMismatch);
+
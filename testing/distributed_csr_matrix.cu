@@ -0,0 +1,244 @@
+#include <unittest/unittest.h>
+
+#include <cusp/distributed_csr_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/multiply.h>
+
+// partitions on the current device, repeated to exercise the halo exchange
+static std::vector<int> current_devices(size_t num_partitions)
+{
+    int device = 0;
+    cudaGetDevice(&device);
+
+    return std::vector<int>(num_partitions, device);
+}
+
+void TestDistributedCsrMatrixPartition(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::distributed_csr_matrix<int, float> D(A, current_devices(3));
+
+    ASSERT_EQUAL(D.num_rows,       A.num_rows);
+    ASSERT_EQUAL(D.num_cols,       A.num_cols);
+    ASSERT_EQUAL(D.num_entries,    A.num_entries);
+    ASSERT_EQUAL(D.num_partitions(), (size_t) 3);
+
+    ASSERT_EQUAL(D.row_begin(0), 0);
+    ASSERT_EQUAL(D.row_end(0),   D.row_begin(1));
+    ASSERT_EQUAL(D.row_end(1),   D.row_begin(2));
+    ASSERT_EQUAL(D.row_end(2),   (int) A.num_rows);
+
+    // a 5-point stencil couples neighboring partitions through about one grid row
+    ASSERT_EQUAL(D.num_halo_columns(0) >= (size_t) 10 && D.num_halo_columns(0) <= (size_t) 11, true);
+    ASSERT_EQUAL(D.num_halo_columns(1) >= (size_t) 20 && D.num_halo_columns(1) <= (size_t) 22, true);
+    ASSERT_EQUAL(D.num_halo_columns(2) >= (size_t) 10 && D.num_halo_columns(2) <= (size_t) 11, true);
+}
+DECLARE_UNITTEST(TestDistributedCsrMatrixPartition);
+
+template <typename ValueType>
+void CompareDistributedCsrMatrixMultiply(size_t num_partitions)
+{
+    cusp::csr_matrix<int, ValueType, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 13, 17);
+
+    cusp::distributed_csr_matrix<int, ValueType> D(A, current_devices(num_partitions));
+
+    cusp::array1d<ValueType, cusp::host_memory> x(A.num_rows);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = ValueType((i % 7) + 1);
+
+    cusp::array1d<ValueType, cusp::host_memory> expected(A.num_rows);
+    cusp::multiply(A, x, expected);
+
+    cusp::array1d<ValueType, cusp::device_memory> d_x(x);
+    cusp::array1d<ValueType, cusp::device_memory> d_y(A.num_rows, ValueType(-1));
+
+    cusp::multiply(D, d_x, d_y);
+
+    cusp::array1d<ValueType, cusp::host_memory> y(d_y);
+    ASSERT_EQUAL(y, expected);
+
+    // repeated products reuse the halo buffers
+    cusp::multiply(D, d_x, d_y);
+
+    y = d_y;
+    ASSERT_EQUAL(y, expected);
+}
+
+void TestDistributedCsrMatrixMultiply(void)
+{
+    CompareDistributedCsrMatrixMultiply<float>(1);
+    CompareDistributedCsrMatrixMultiply<float>(2);
+    CompareDistributedCsrMatrixMultiply<float>(5);
+    CompareDistributedCsrMatrixMultiply<double>(4);
+}
+DECLARE_UNITTEST(TestDistributedCsrMatrixMultiply);
+
+void TestDistributedCsrMatrixConjugateGradient(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::distributed_csr_matrix<int, float> D(A, current_devices(3));
+
+    cusp::array1d<float, cusp::device_memory> x(A.num_rows, 0.0f);
+    cusp::array1d<float, cusp::device_memory> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 100, 1e-4);
+
+    cusp::krylov::cg(D, x, b, monitor);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+
+    // check residual norm with the undistributed matrix
+    cusp::csr_matrix<int, float, cusp::device_memory> B(A);
+    cusp::array1d<float, cusp::device_memory> residual(A.num_rows, 0.0f);
+    cusp::multiply(B, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 1e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_UNITTEST(TestDistributedCsrMatrixConjugateGradient);
+
+template <typename ValueType>
+void CompareDistributedCsrMatrixDistributedMultiply(size_t num_partitions)
+{
+    cusp::csr_matrix<int, ValueType, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 13, 17);
+
+    cusp::distributed_csr_matrix<int, ValueType, cusp::distributed_memory> D(A, current_devices(num_partitions));
+
+    cusp::array1d<ValueType, cusp::host_memory> x(A.num_rows);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = ValueType((i % 7) + 1);
+
+    cusp::array1d<ValueType, cusp::host_memory> expected(A.num_rows);
+    cusp::multiply(A, x, expected);
+
+    cusp::distributed_array1d<ValueType> d_x(D.get_distribution());
+    cusp::distributed_array1d<ValueType> d_y(D.get_distribution(), ValueType(-1));
+
+    d_x = x;
+
+    cusp::multiply(D, d_x, d_y);
+
+    cusp::array1d<ValueType, cusp::host_memory> y;
+    d_y.gather(y);
+    ASSERT_EQUAL(y, expected);
+
+    // repeated products reuse the halo buffers
+    cusp::multiply(D, d_x, d_y);
+
+    d_y.gather(y);
+    ASSERT_EQUAL(y, expected);
+
+    // the vectors must be distributed like the rows
+    cusp::distributed_array1d<ValueType> z(A.num_rows);
+
+    if (z.get_distribution() != D.get_distribution())
+        ASSERT_THROWS(cusp::multiply(D, d_x, z), cusp::invalid_input_exception);
+}
+
+void TestDistributedCsrMatrixDistributedMultiply(void)
+{
+    CompareDistributedCsrMatrixDistributedMultiply<float>(1);
+    CompareDistributedCsrMatrixDistributedMultiply<float>(2);
+    CompareDistributedCsrMatrixDistributedMultiply<float>(5);
+    CompareDistributedCsrMatrixDistributedMultiply<double>(4);
+}
+DECLARE_UNITTEST(TestDistributedCsrMatrixDistributedMultiply);
+
+void TestDistributedCsrMatrixDistributedConjugateGradient(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::distributed_csr_matrix<int, float, cusp::distributed_memory> D(A, current_devices(3));
+
+    // the temporaries of the solver follow the distribution of the rows
+    cusp::scoped_distribution scope(D.get_distribution());
+
+    cusp::distributed_array1d<float> x(A.num_rows, 0.0f);
+    cusp::distributed_array1d<float> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 100, 1e-4);
+
+    cusp::krylov::cg(D, x, b, monitor);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+
+    // check residual norm with the undistributed matrix
+    cusp::array1d<float, cusp::host_memory> h_x;
+    x.gather(h_x);
+
+    cusp::array1d<float, cusp::host_memory> h_b(A.num_rows, 1.0f);
+    cusp::array1d<float, cusp::host_memory> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, h_x, residual);
+    cusp::blas::axpby(residual, h_b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 1e-4 * cusp::blas::nrm2(h_b), true);
+}
+DECLARE_UNITTEST(TestDistributedCsrMatrixDistributedConjugateGradient);
+
+void TestDistributedCsrMatrixFromRows(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 9, 7);
+
+    std::vector<size_t> offsets;
+    offsets.push_back(0);
+    offsets.push_back(20);
+    offsets.push_back(21);
+    offsets.push_back(A.num_rows);
+
+    // the rows of all ranges of a single process
+    cusp::distribution d(current_devices(3), offsets);
+
+    cusp::distributed_csr_matrix<int, float, cusp::distributed_memory> D(A, d);
+
+    ASSERT_EQUAL(D.get_distribution() == d, true);
+    ASSERT_EQUAL(D.num_entries, A.num_entries);
+    ASSERT_EQUAL(D.row_begin(1), 20);
+    ASSERT_EQUAL(D.row_end(1),   21);
+
+    cusp::array1d<float, cusp::host_memory> x(A.num_rows);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float((i % 5) + 1);
+
+    cusp::array1d<float, cusp::host_memory> expected(A.num_rows);
+    cusp::multiply(A, x, expected);
+
+    cusp::distributed_array1d<float> d_x(d);
+    cusp::distributed_array1d<float> d_y(d);
+
+    d_x = x;
+
+    cusp::multiply(D, d_x, d_y);
+
+    cusp::array1d<float, cusp::host_memory> y;
+    d_y.gather(y);
+    ASSERT_EQUAL(y, expected);
+
+    // the rows must match the distribution
+    cusp::csr_matrix<int, float, cusp::host_memory> B(A.num_rows - 1, A.num_cols, 0);
+
+    ASSERT_THROWS((cusp::distributed_csr_matrix<int, float, cusp::distributed_memory>(B, d)), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestDistributedCsrMatrixFromRows);
+
+void TestDistributedCsrMatrixInvalidInput(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A(3, 4, 0);
+
+    ASSERT_THROWS((cusp::distributed_csr_matrix<int, float>(A, current_devices(1))), cusp::invalid_input_exception);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> B(4, 4, 0);
+
+    ASSERT_THROWS((cusp::distributed_csr_matrix<int, float>(B, std::vector<int>())), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestDistributedCsrMatrixInvalidInput);
+
@@ -0,0 +1,97 @@
+#include <unittest/unittest.h>
+
+#include <cusp/precond/distributed_smoothed_aggregation.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+
+// partitions on the current device, repeated to exercise the exchanges
+static std::vector<int> current_devices(size_t num_partitions)
+{
+    int device = 0;
+    cudaGetDevice(&device);
+
+    return std::vector<int>(num_partitions, device);
+}
+
+void TestDistributedSmoothedAggregationHierarchy(void)
+{
+    cusp::csr_matrix<int, double, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 60, 60);
+
+    cusp::precond::amg_options options;
+    options.coarse_size        = 40;
+    options.consolidation_size = 200;
+
+    cusp::precond::distributed_smoothed_aggregation<int, double> M(A, current_devices(4), options);
+
+    ASSERT_EQUAL(M.num_levels() >= 3, true);
+    ASSERT_EQUAL(M.level_distribution(0).num_partitions(), (size_t) 4);
+    ASSERT_EQUAL(M.level_distribution(0).size(), (size_t) A.num_rows);
+
+    // levels shrink and move onto fewer partitions, the coarsest onto one
+    for (size_t i = 1; i < M.num_levels(); i++)
+    {
+        ASSERT_EQUAL(M.level_distribution(i).size() < M.level_distribution(i - 1).size(), true);
+        ASSERT_EQUAL(M.level_distribution(i).num_partitions() <= M.level_distribution(i - 1).num_partitions(), true);
+    }
+
+    ASSERT_EQUAL(M.level_distribution(M.num_levels() - 1).num_partitions(), (size_t) 1);
+
+    ASSERT_EQUAL(M.operator_complexity() > 1.0, true);
+    ASSERT_EQUAL(M.grid_complexity()     > 1.0, true);
+}
+DECLARE_UNITTEST(TestDistributedSmoothedAggregationHierarchy);
+
+void TestDistributedSmoothedAggregationConjugateGradient(void)
+{
+    cusp::csr_matrix<int, double, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 50, 40);
+
+    cusp::precond::amg_options options;
+    options.coarse_size        = 30;
+    options.consolidation_size = 300;
+
+    for (size_t num_partitions = 1; num_partitions <= 3; num_partitions++)
+    {
+        cusp::precond::distributed_smoothed_aggregation<int, double> M(A, current_devices(num_partitions), options);
+
+        cusp::scoped_distribution scope(M.matrix().get_distribution());
+
+        cusp::distributed_array1d<double> x(A.num_rows, 0.0);
+        cusp::distributed_array1d<double> b(A.num_rows, 1.0);
+
+        cusp::default_monitor<double> monitor(b, 40, 1e-8);
+
+        cusp::krylov::cg(M.matrix(), x, b, monitor, M);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+
+        // check the solution with the undistributed matrix
+        cusp::array1d<double, cusp::host_memory> h_x;
+        x.gather(h_x);
+
+        cusp::array1d<double, cusp::host_memory> residual(A.num_rows);
+        cusp::multiply(A, h_x, residual);
+
+        for (size_t i = 0; i < residual.size(); i++)
+            ASSERT_ALMOST_EQUAL(residual[i], 1.0);
+    }
+}
+DECLARE_UNITTEST(TestDistributedSmoothedAggregationConjugateGradient);
+
+void TestDistributedSmoothedAggregationDistribution(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    cusp::precond::distributed_smoothed_aggregation<int, float> M(A, current_devices(2));
+
+    cusp::distributed_array1d<float> b(cusp::distribution(A.num_rows, current_devices(3)), 1.0f);
+    cusp::distributed_array1d<float> x(cusp::distribution(A.num_rows, current_devices(3)), 0.0f);
+
+    ASSERT_THROWS(M(b, x), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestDistributedSmoothedAggregationDistribution);
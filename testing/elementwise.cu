@@ -2,6 +2,9 @@
 
 #include <cusp/elementwise.h>
 
+#include <cusp/array2d.h>
+#include <cusp/copy.h>
+
 #include <cusp/coo_matrix.h>
 #include <cusp/csr_matrix.h>
 #include <cusp/dia_matrix.h>
@@ -10,6 +13,12 @@
 #include <cusp/gallery/poisson.h>
 #include <cusp/gallery/random.h>
 
+#include <thrust/fill.h>
+#include <thrust/functional.h>
+
+#include <algorithm>
+#include <cmath>
+
 template <typename Vector>
 void example_matrices(Vector& matrices)
 {
@@ -163,3 +172,230 @@ void TestSubtract(void)
 }
 DECLARE_SPARSE_MATRIX_UNITTEST(TestSubtract);
 
+
+template <typename SparseMatrix>
+void TestAddScaled(void)
+{
+    typedef cusp::array2d<float,cusp::host_memory> DenseMatrix;
+
+    thrust::host_vector< DenseMatrix > matrices;
+
+    example_matrices(matrices);
+
+    for(size_t i = 0; i < matrices.size(); i++)
+    {
+        for(size_t j = 0; j < matrices.size(); j++)
+        {
+            const DenseMatrix& A = matrices[i];
+            const DenseMatrix& B = matrices[j];
+
+            if (A.num_rows == B.num_rows && A.num_cols == B.num_cols)
+            {
+                DenseMatrix C(A.num_rows, A.num_cols);
+                for (size_t n = 0; n < C.values.size(); n++)
+                    C.values[n] = 2.0f * A.values[n] - 0.5f * B.values[n];
+
+                SparseMatrix _A(A), _B(B), _C;
+                cusp::add(_A, _B, _C, 2.0f, -0.5f);
+
+                ASSERT_EQUAL(C == DenseMatrix(_C), true);
+            }
+        }
+    }
+
+    SparseMatrix A = DenseMatrix(2,2,1);
+    SparseMatrix B = DenseMatrix(2,3,1);
+    SparseMatrix D;
+
+    ASSERT_THROWS(cusp::add(A,B,D,1.0f,1.0f), cusp::invalid_input_exception);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestAddScaled);
+
+template <class MemorySpace>
+void TestAddPlan(void)
+{
+    typedef cusp::csr_matrix<int,float,MemorySpace> Matrix;
+
+    cusp::array2d<float,cusp::host_memory> D;
+    cusp::gallery::random(24, 24, 150, D);
+
+    cusp::array2d<float,cusp::host_memory> E;
+    cusp::gallery::poisson5pt(E, 4, 6);
+
+    Matrix A(D), M(E), C;
+
+    cusp::add_plan<int,MemorySpace> plan(A, M);
+
+    // the union of the patterns
+    Matrix S;
+    cusp::add(A, M, S);
+    ASSERT_EQUAL(plan.num_entries() >= S.num_entries, true);
+
+    for (int k = 0; k < 3; k++)
+    {
+        const float sigma = 0.5f * k;
+
+        plan.add(A, M, C, 1.0f, -sigma);
+
+        cusp::array2d<float,cusp::host_memory> expected(D.num_rows, D.num_cols);
+        for (size_t n = 0; n < expected.values.size(); n++)
+            expected.values[n] = D.values[n] - sigma * E.values[n];
+
+        cusp::array2d<float,cusp::host_memory> result(C);
+        ASSERT_EQUAL(result == expected, true);
+        ASSERT_EQUAL(C.num_entries, plan.num_entries());
+    }
+
+    Matrix F(cusp::array2d<float,cusp::host_memory>(24, 24, 1));
+    ASSERT_THROWS(plan.add(F, M, C, 1.0f, 1.0f), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAddPlan);
+
+template <typename SparseMatrix>
+void TestTransformElementwise(void)
+{
+    typedef cusp::array2d<float,cusp::host_memory> DenseMatrix;
+
+    thrust::host_vector< DenseMatrix > matrices;
+
+    example_matrices(matrices);
+
+    for(size_t i = 0; i < matrices.size(); i++)
+    {
+        for(size_t j = 0; j < matrices.size(); j++)
+        {
+            const DenseMatrix& A = matrices[i];
+            const DenseMatrix& B = matrices[j];
+
+            if (A.num_rows == B.num_rows && A.num_cols == B.num_cols)
+            {
+                DenseMatrix C(A.num_rows, A.num_cols);
+                DenseMatrix D(A.num_rows, A.num_cols);
+                for (size_t n = 0; n < C.values.size(); n++)
+                {
+                    C.values[n] = std::max(A.values[n], B.values[n]);
+                    D.values[n] = A.values[n] * B.values[n];
+                }
+
+                SparseMatrix _A(A), _B(B), _C, _D;
+
+                cusp::transform_elementwise(_A, _B, _C, thrust::maximum<float>());
+                ASSERT_EQUAL(C == DenseMatrix(_C), true);
+
+                cusp::transform_elementwise(_A, _B, _D, thrust::multiplies<float>(), cusp::intersection_pattern());
+                ASSERT_EQUAL(D == DenseMatrix(_D), true);
+            }
+        }
+    }
+
+    SparseMatrix A = DenseMatrix(2,2,1);
+    SparseMatrix B = DenseMatrix(2,3,1);
+    SparseMatrix D;
+
+    ASSERT_THROWS(cusp::transform_elementwise(A,B,D,thrust::plus<float>()), cusp::invalid_input_exception);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestTransformElementwise);
+
+template <typename T>
+struct scale_by_two
+{
+    __host__ __device__
+    T operator()(const T& x) const { return T(2) * x; }
+};
+
+template <typename SparseMatrix>
+void TestTransformValues(void)
+{
+    typedef cusp::array2d<float,cusp::host_memory> DenseMatrix;
+
+    DenseMatrix A;
+    cusp::gallery::random(24, 24, 150, A);
+
+    SparseMatrix _A(A);
+    cusp::transform_values(_A, scale_by_two<float>());
+
+    for (size_t n = 0; n < A.values.size(); n++)
+        A.values[n] *= 2.0f;
+
+    ASSERT_EQUAL(A == DenseMatrix(_A), true);
+}
+DECLARE_SPARSE_FORMAT_UNITTEST(TestTransformValues, Coo, coo);
+DECLARE_SPARSE_FORMAT_UNITTEST(TestTransformValues, Csr, csr);
+
+template <typename SparseMatrix>
+void TestFilter(void)
+{
+    typedef cusp::array2d<float,cusp::host_memory> DenseMatrix;
+
+    DenseMatrix A(3,4);
+    A(0,0) =  1.0f; A(0,1) =  0.1f; A(0,2) =  0.0f; A(0,3) = -2.0f;
+    A(1,0) = -0.2f; A(1,1) =  3.0f; A(1,2) =  0.0f; A(1,3) =  0.0f;
+    A(2,0) =  0.0f; A(2,1) = -0.3f; A(2,2) =  0.5f; A(2,3) =  0.4f;
+
+    DenseMatrix B(A);
+    for (size_t n = 0; n < B.values.size(); n++)
+        if (std::abs(B.values[n]) <= 0.4f)
+            B.values[n] = 0.0f;
+
+    SparseMatrix _A(A), _B;
+
+    cusp::filter(_A, _B, cusp::drop_tolerance<float>(0.4f));
+    ASSERT_EQUAL(_B.num_entries, (size_t) 4);
+    ASSERT_EQUAL(B == DenseMatrix(_B), true);
+
+    cusp::filter(_A, cusp::drop_tolerance<float>(0.4f));
+    ASSERT_EQUAL(_A.num_entries, (size_t) 4);
+    ASSERT_EQUAL(B == DenseMatrix(_A), true);
+}
+DECLARE_SPARSE_FORMAT_UNITTEST(TestFilter, Coo, coo);
+DECLARE_SPARSE_FORMAT_UNITTEST(TestFilter, Csr, csr);
+
+template <typename SparseMatrix, typename Orientation>
+void TestFilterArray2dOrientation(void)
+{
+    typedef typename SparseMatrix::memory_space MemorySpace;
+    typedef cusp::array2d<float,cusp::host_memory> DenseMatrix;
+
+    DenseMatrix A(3,4);
+    A(0,0) =  1.0f; A(0,1) =  0.1f; A(0,2) =  0.0f; A(0,3) = -2.0f;
+    A(1,0) = -0.2f; A(1,1) =  3.0f; A(1,2) =  0.0f; A(1,3) =  0.0f;
+    A(2,0) =  0.0f; A(2,1) = -0.3f; A(2,2) =  0.5f; A(2,3) =  0.4f;
+
+    DenseMatrix B(A);
+    for (size_t n = 0; n < B.values.size(); n++)
+        if (std::abs(B.values[n]) <= 0.4f)
+            B.values[n] = 0.0f;
+
+    // the padding of the pitch is never kept
+    cusp::array2d<float, MemorySpace, Orientation> D;
+    D.resize(3, 4, 7);
+    thrust::fill(D.values.begin(), D.values.end(), 9.0f);
+    cusp::copy(A, D);
+
+    SparseMatrix _B;
+    cusp::filter(D, _B, cusp::drop_tolerance<float>(0.4f));
+    ASSERT_EQUAL(_B.num_entries, (size_t) 4);
+    ASSERT_EQUAL(B == DenseMatrix(_B), true);
+
+    SparseMatrix _C;
+    cusp::convert(D, _C);
+    ASSERT_EQUAL(_C.num_entries, (size_t) 9);
+    ASSERT_EQUAL(A == DenseMatrix(_C), true);
+
+    // entries are stored by row and column
+    cusp::coo_matrix<int, float, cusp::host_memory> C(_C);
+    bool sorted = true;
+    for (size_t n = 1; n < C.num_entries; n++)
+        sorted = sorted && (C.row_indices[n - 1] < C.row_indices[n] ||
+                            (C.row_indices[n - 1] == C.row_indices[n] && C.column_indices[n - 1] < C.column_indices[n]));
+    ASSERT_EQUAL(sorted, true);
+}
+
+template <typename SparseMatrix>
+void TestFilterArray2d(void)
+{
+    TestFilterArray2dOrientation<SparseMatrix, cusp::row_major>();
+    TestFilterArray2dOrientation<SparseMatrix, cusp::column_major>();
+}
+DECLARE_SPARSE_FORMAT_UNITTEST(TestFilterArray2d, Coo, coo);
+DECLARE_SPARSE_FORMAT_UNITTEST(TestFilterArray2d, Csr, csr);
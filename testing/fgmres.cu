@@ -0,0 +1,123 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/krylov/fgmres.h>
+#include <cusp/precond/diagonal.h>
+
+// a few CG iterations from a zero initial guess, a nonlinear preconditioner
+template <typename Matrix>
+struct inner_cg : public cusp::linear_operator<typename Matrix::value_type, typename Matrix::memory_space>
+{
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+    typedef cusp::linear_operator<ValueType,MemorySpace> Parent;
+
+    Matrix& A;
+    size_t iterations;
+    mutable cusp::array1d<ValueType,MemorySpace> b;
+    mutable cusp::array1d<ValueType,MemorySpace> x;
+
+    inner_cg(Matrix& A, size_t iterations)
+        : Parent(A.num_rows, A.num_cols), A(A), iterations(iterations), b(A.num_rows), x(A.num_rows) {}
+
+    template <typename Array1, typename Array2>
+    void operator()(const Array1& r, Array2& y) const
+    {
+        cusp::blas::copy(r, b);
+        cusp::blas::fill(x, ValueType(0));
+
+        cusp::default_monitor<ValueType> monitor(b, iterations, 0);
+        cusp::krylov::cg(A, x, b, monitor);
+
+        cusp::blas::copy(x, y);
+    }
+};
+
+template <class MemorySpace>
+void TestFlexibleGeneralizedMinimumResidual(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 100, 1e-4);
+
+    // restart before convergence
+    cusp::krylov::fgmres(A, x, b, 15, monitor);
+
+    // check residual norm
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 2e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFlexibleGeneralizedMinimumResidual);
+
+template <class MemorySpace>
+void TestFlexibleGeneralizedMinimumResidualVariablePreconditioner(void)
+{
+    typedef cusp::csr_matrix<int, float, MemorySpace> Matrix;
+
+    Matrix A;
+
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    inner_cg<Matrix> M(A, 4);
+
+    cusp::default_monitor<float> monitor(b, 60, 1e-4);
+
+    cusp::krylov::fgmres(A, x, b, 10, monitor, M);
+
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 2e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFlexibleGeneralizedMinimumResidualVariablePreconditioner);
+
+// rows scaled by 1 to 7, so that the matrix is nonsymmetric and needs the
+// diagonal preconditioner
+template <class MemorySpace>
+void TestFlexibleGeneralizedMinimumResidualPreconditioned(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> B;
+    cusp::gallery::poisson5pt(B, 10, 10);
+
+    for (size_t i = 0; i < B.num_rows; i++)
+        for (int jj = B.row_offsets[i]; jj < B.row_offsets[i + 1]; jj++)
+            B.values[jj] *= float(1 + i % 7);
+
+    cusp::csr_matrix<int, float, MemorySpace> A(B);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::precond::diagonal<float, MemorySpace> M(A);
+
+    cusp::default_monitor<float> monitor(b, 1000, 1e-5);
+
+    // short cycles run the Arnoldi steps and the update of x many times
+    cusp::krylov::fgmres(A, x, b, 5, monitor, M);
+
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(monitor.iteration_count() > 5, true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 1e-3 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFlexibleGeneralizedMinimumResidualPreconditioned);
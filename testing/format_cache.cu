@@ -0,0 +1,157 @@
+#include <unittest/unittest.h>
+
+#include <cusp/format_cache.h>
+#include <cusp/blas.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/transpose.h>
+#include <cusp/array1d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/memory_footprint.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/gallery/random.h>
+#include <cusp/krylov/cg.h>
+
+template <class Space>
+void TestFormatCacheMultiply(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> h_A;
+    cusp::gallery::random(50, 40, 300, h_A);
+
+    cusp::csr_matrix<int, float, Space> A(h_A);
+
+    cusp::array1d<float, Space> x(A.num_cols);
+    cusp::array1d<float, Space> z(A.num_rows);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 7) - 3;
+    for (size_t i = 0; i < z.size(); i++)
+        z[i] = float(i % 5) - 2;
+
+    cusp::format_cache< cusp::csr_matrix<int, float, Space> > cache(A);
+
+    ASSERT_EQUAL(cache.num_rows,    A.num_rows);
+    ASSERT_EQUAL(cache.num_cols,    A.num_cols);
+    ASSERT_EQUAL(cache.num_entries, A.num_entries);
+
+    // nothing is built before the first product
+    ASSERT_EQUAL(cache.hyb_matrix.num_entries,       (size_t) 0);
+    ASSERT_EQUAL(cache.transpose_matrix.num_entries, (size_t) 0);
+
+    cusp::array1d<float, Space> y(A.num_rows);
+    cusp::array1d<float, Space> w(A.num_cols);
+    cusp::array1d<float, Space> y_ref(A.num_rows);
+    cusp::array1d<float, Space> w_ref(A.num_cols);
+
+    for (int repeat = 0; repeat < 2; repeat++)
+    {
+        cusp::multiply(A, x, y_ref);
+        cusp::multiply(cache, x, y);
+        ASSERT_ALMOST_EQUAL(y, y_ref);
+
+        cusp::multiply_transpose(A, z, w_ref);
+        cusp::multiply_transpose(cache, z, w);
+        ASSERT_ALMOST_EQUAL(w, w_ref);
+
+        // the fused product y <- 2 A x - y
+        cusp::array1d<float, Space> v(z);
+        cusp::multiply(cache, x, v, 2.0f, -1.0f);
+        cusp::blas::axpby(y_ref, z, y_ref, 2.0f, -1.0f);
+        ASSERT_ALMOST_EQUAL(v, y_ref);
+
+        ASSERT_EQUAL(cache.hyb_matrix.num_entries,       A.num_entries);
+        ASSERT_EQUAL(cache.transpose_matrix.num_entries, A.num_entries);
+
+        // refresh the cached formats after the values change in place
+        cusp::blas::scal(A.values, 2.0f);
+        cache.update_values();
+    }
+
+    // the cached transpose is a CSR matrix
+    cusp::csr_matrix<int, float, Space> At;
+    cusp::csr_matrix<int, float, Space> At_ref;
+    cusp::transpose(cache, At);
+    cusp::transpose(A, At_ref);
+
+    ASSERT_EQUAL(At.row_offsets,    At_ref.row_offsets);
+    ASSERT_EQUAL(At.column_indices, At_ref.column_indices);
+    ASSERT_EQUAL(At.values,         At_ref.values);
+
+    // the cached formats count towards the footprint of the cache
+    ASSERT_EQUAL(cusp::memory_footprint(cache) > 0, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFormatCacheMultiply);
+
+template <class Space>
+void TestFormatCacheDiagonal(void)
+{
+    cusp::coo_matrix<int, float, Space> A;
+    cusp::gallery::poisson5pt(A, 4, 3);
+
+    cusp::format_cache< cusp::coo_matrix<int, float, Space> > cache(A);
+
+    cusp::array1d<float, Space> expected(A.num_rows, 4.0f);
+    ASSERT_EQUAL(cache.diagonal(), expected);
+
+    cusp::blas::fill(A.values, 1.0f);
+    cache.update_values();
+
+    cusp::blas::fill(expected, 1.0f);
+    ASSERT_EQUAL(cache.diagonal(), expected);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFormatCacheDiagonal);
+
+template <class Space>
+void TestFormatCacheInvalidate(void)
+{
+    cusp::csr_matrix<int, float, Space> A;
+    cusp::gallery::poisson5pt(A, 4, 4);
+
+    cusp::format_cache< cusp::csr_matrix<int, float, Space> > cache(A);
+
+    cusp::array1d<float, Space> x(A.num_cols, 1.0f);
+    cusp::array1d<float, Space> y(A.num_rows);
+    cusp::multiply(cache, x, y);
+
+    // a new pattern and shape
+    cusp::gallery::poisson5pt(A, 5, 3);
+    cache.invalidate();
+
+    ASSERT_EQUAL(cache.num_rows,    A.num_rows);
+    ASSERT_EQUAL(cache.num_entries, A.num_entries);
+    ASSERT_EQUAL(cache.hyb_matrix.num_entries, (size_t) 0);
+
+    cusp::array1d<float, Space> x2(A.num_cols, 1.0f);
+    cusp::array1d<float, Space> y2(A.num_rows);
+    cusp::array1d<float, Space> y2_ref(A.num_rows);
+
+    cusp::multiply(cache, x2, y2);
+    cusp::multiply(A, x2, y2_ref);
+
+    ASSERT_EQUAL(y2, y2_ref);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFormatCacheInvalidate);
+
+template <class Space>
+void TestFormatCacheSolve(void)
+{
+    cusp::csr_matrix<int, float, Space> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::format_cache< cusp::csr_matrix<int, float, Space> > cache(A);
+
+    cusp::array1d<float, Space> b(A.num_rows, 1.0f);
+
+    cusp::array1d<float, Space> x(A.num_rows, 0.0f);
+    cusp::default_monitor<float> monitor(b, 100, 1e-5f);
+    cusp::krylov::cg(cache, x, b, monitor);
+
+    cusp::array1d<float, Space> x_ref(A.num_rows, 0.0f);
+    cusp::default_monitor<float> monitor_ref(b, 100, 1e-5f);
+    cusp::krylov::cg(A, x_ref, b, monitor_ref);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_ALMOST_EQUAL(x, x_ref);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFormatCacheSolve);
+
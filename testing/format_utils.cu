@@ -74,6 +74,41 @@ void TestIndicesToOffsets(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestIndicesToOffsets);
 
+template <class Space>
+void TestOffsetsIndicesSkewed(void)
+{
+    // a long row, runs of empty rows and short rows, so that the merge
+    // path intervals split rows and span many rows
+    const int num_rows = 30000;
+
+    cusp::array1d<int, cusp::host_memory> row_lengths(num_rows, 0);
+    row_lengths[1] = 50000;
+    for (int i = 10000; i < num_rows; i += 7)
+        row_lengths[i] = i % 5;
+    row_lengths[num_rows - 1] = 3;
+
+    cusp::array1d<int, cusp::host_memory> offsets(num_rows + 1);
+    offsets[0] = 0;
+    for (int i = 0; i < num_rows; i++)
+        offsets[i + 1] = offsets[i] + row_lengths[i];
+
+    cusp::array1d<int, cusp::host_memory> expected(offsets[num_rows]);
+    for (int i = 0; i < num_rows; i++)
+        for (int k = offsets[i]; k < offsets[i + 1]; k++)
+            expected[k] = i;
+
+    cusp::array1d<int, Space> indices(expected.size(), -1);
+    cusp::detail::offsets_to_indices(cusp::array1d<int, Space>(offsets), indices);
+
+    ASSERT_EQUAL(indices, expected);
+
+    cusp::array1d<int, Space> result(num_rows + 1, -1);
+    cusp::detail::indices_to_offsets(indices, result);
+
+    ASSERT_EQUAL(result, offsets);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestOffsetsIndicesSkewed);
+
 template <class Matrix>
 void TestExtractDiagonal(void)
 {
@@ -139,3 +174,110 @@ void TestExtractDiagonal(void)
 }
 DECLARE_SPARSE_MATRIX_UNITTEST(TestExtractDiagonal);
 
+template <class Space>
+void TestExtractDiagonalPaddedFormats(void)
+{
+    typedef cusp::ell_matrix<int, float, cusp::host_memory> EllMatrix;
+    typedef cusp::hyb_matrix<int, float, cusp::host_memory> HybMatrix;
+
+    const int X = EllMatrix::invalid_index;
+
+    cusp::array1d<float, Space> expected(3);
+    expected[0] = 10.0;
+    expected[1] =  0.0;
+    expected[2] = 30.0;
+
+    // rows end at the first padded slot
+    {
+        EllMatrix A(3, 3, 4, 2);
+        A.column_indices(0,0) = 0; A.values(0,0) = 10;
+        A.column_indices(0,1) = 2; A.values(0,1) = 20;
+        A.column_indices(1,0) = X; A.values(1,0) =  0;
+        A.column_indices(1,1) = X; A.values(1,1) = 99;
+        A.column_indices(2,0) = 1; A.values(2,0) = 40;
+        A.column_indices(2,1) = 2; A.values(2,1) = 30;
+
+        cusp::array1d<float, Space> output;
+        cusp::detail::extract_diagonal(cusp::ell_matrix<int, float, Space>(A), output);
+
+        ASSERT_EQUAL(output, expected);
+    }
+
+    // the diagonal of row 2 spilled into the COO part
+    {
+        HybMatrix A(3, 3, 2, 2, 1);
+        A.ell.column_indices(0,0) = 0; A.ell.values(0,0) = 10;
+        A.ell.column_indices(1,0) = X; A.ell.values(1,0) =  0;
+        A.ell.column_indices(2,0) = 0; A.ell.values(2,0) = 40;
+
+        A.coo.row_indices[0] = 0; A.coo.column_indices[0] = 2; A.coo.values[0] = 20;
+        A.coo.row_indices[1] = 2; A.coo.column_indices[1] = 2; A.coo.values[1] = 30;
+
+        cusp::array1d<float, Space> output;
+        cusp::detail::extract_diagonal(cusp::hyb_matrix<int, float, Space>(A), output);
+
+        ASSERT_EQUAL(output, expected);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestExtractDiagonalPaddedFormats);
+
+
+// entries (i % 7, scale * (i * 5 % 11)) in reverse order, with each
+// (row, column) pair occurring twice
+template <typename IndexType, typename Space>
+void VerifySortByRowAndColumn(const IndexType scale, const size_t num_rows, const size_t num_cols)
+{
+    const size_t N = 154;
+
+    cusp::array1d<IndexType, cusp::host_memory> rows(N), columns(N);
+    cusp::array1d<int,       cusp::host_memory> values(N);
+
+    for (size_t i = 0; i < N; i++)
+    {
+        size_t n = (N - 1 - i) % 77;
+        rows[i]    = IndexType(n % 7);
+        columns[i] = IndexType(n * 5 % 11) * scale;
+        values[i]  = int(i);
+    }
+
+    cusp::array1d<IndexType, Space> I(rows), J(columns);
+    cusp::array1d<int,       Space> V(values);
+
+    if (num_rows == 0)
+        cusp::detail::sort_by_row_and_column(I, J, V);
+    else
+        cusp::detail::sort_by_row_and_column(I, J, V, num_rows, num_cols);
+
+    cusp::array1d<IndexType, cusp::host_memory> h_I(I), h_J(J);
+    cusp::array1d<int,       cusp::host_memory> h_V(V);
+
+    for (size_t i = 0; i < N; i++)
+    {
+        // the entries are a permutation of the input
+        ASSERT_EQUAL(h_I[i], rows[h_V[i]]);
+        ASSERT_EQUAL(h_J[i], columns[h_V[i]]);
+    }
+
+    for (size_t i = 1; i < N; i++)
+    {
+        bool ordered = h_I[i - 1] < h_I[i] || (h_I[i - 1] == h_I[i] && h_J[i - 1] < h_J[i]);
+        bool stable  = h_I[i - 1] == h_I[i] && h_J[i - 1] == h_J[i] && h_V[i - 1] < h_V[i];
+
+        ASSERT_EQUAL(ordered || stable, true);
+    }
+}
+
+template <class Space>
+void TestSortByRowAndColumn(void)
+{
+    // 32-bit keys, with the dimensions bounded by the indices
+    VerifySortByRowAndColumn<int, Space>(1, 0, 0);
+    VerifySortByRowAndColumn<int, Space>(1, 7, 11);
+
+    // 64-bit keys
+    VerifySortByRowAndColumn<int, Space>(100000, 1 << 30, 1000001);
+
+    // indices too wide for a packed key
+    VerifySortByRowAndColumn<long long, Space>(1ll << 40, 1ll << 30, (10ll << 40) + 1);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSortByRowAndColumn);
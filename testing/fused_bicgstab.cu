@@ -0,0 +1,88 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/precond/diagonal.h>
+#include <cusp/krylov/bicgstab.h>
+#include <cusp/krylov/fused_bicgstab.h>
+
+template <class MemorySpace>
+void TestFusedBiConjugateGradientStabilized(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 20, 1e-4);
+
+    cusp::krylov::fused_bicgstab(A, x, b, monitor);
+
+    // check residual norm
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 1e-4 * cusp::blas::nrm2(b), true);
+    ASSERT_EQUAL(monitor.iteration_count() <= monitor.iteration_limit(), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFusedBiConjugateGradientStabilized);
+
+
+template <class MemorySpace>
+void TestFusedBiConjugateGradientStabilizedMatchesBiCGStab(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    cusp::gallery::poisson5pt(A, 15, 17);
+
+    cusp::precond::diagonal<float, MemorySpace> M(A);
+
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+    cusp::array1d<float, MemorySpace> x0(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> x1(A.num_rows, 0.0f);
+
+    // a fixed number of iterations
+    cusp::default_monitor<float> monitor0(b, 10, 0.0f);
+    cusp::default_monitor<float> monitor1(b, 10, 0.0f);
+
+    cusp::krylov::bicgstab(A, x0, b, monitor0, M);
+    cusp::krylov::fused_bicgstab(A, x1, b, monitor1, M, 4);
+
+    ASSERT_EQUAL(monitor1.iteration_count(), 10);
+
+    cusp::blas::axpy(x0, x1, -1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(x1) < 1e-4 * cusp::blas::nrm2(x0), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFusedBiConjugateGradientStabilizedMatchesBiCGStab);
+
+
+template <class MemorySpace>
+void TestFusedBiConjugateGradientStabilizedZeroResidual(void)
+{
+    cusp::array2d<float, MemorySpace> M(2,2);
+    M(0,0) = 8; M(0,1) = 0;
+    M(1,0) = 0; M(1,1) = 4;
+
+    cusp::csr_matrix<int, float, MemorySpace> A(M);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 1.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows);
+
+    cusp::multiply(A, x, b);
+
+    cusp::default_monitor<float> monitor(b, 20, 0.0f);
+
+    cusp::krylov::fused_bicgstab(A, x, b, monitor);
+
+    ASSERT_EQUAL(monitor.converged(),        true);
+    ASSERT_EQUAL(monitor.iteration_count(),     0);
+    ASSERT_EQUAL(x[0], 1.0f);
+    ASSERT_EQUAL(x[1], 1.0f);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFusedBiConjugateGradientStabilizedZeroResidual);
+
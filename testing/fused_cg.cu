@@ -0,0 +1,117 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/precond/diagonal.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/krylov/fused_cg.h>
+
+template <class MemorySpace>
+void TestFusedConjugateGradient(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 20, 1e-4);
+    
+    cusp::krylov::fused_cg(A, x, b, monitor);
+
+    // check residual norm
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 1e-4 * cusp::blas::nrm2(b), true);
+    ASSERT_EQUAL(monitor.iteration_count() <= monitor.iteration_limit(), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFusedConjugateGradient);
+
+
+template <class MemorySpace>
+void TestFusedConjugateGradientMatchesCG(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    cusp::gallery::poisson5pt(A, 15, 17);
+
+    cusp::precond::diagonal<float, MemorySpace> M(A);
+
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+    cusp::array1d<float, MemorySpace> x0(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> x1(A.num_rows, 0.0f);
+
+    // a fixed number of iterations
+    cusp::default_monitor<float> monitor0(b, 12, 0.0f);
+    cusp::default_monitor<float> monitor1(b, 12, 0.0f);
+
+    cusp::krylov::cg(A, x0, b, monitor0, M);
+    cusp::krylov::fused_cg(A, x1, b, monitor1, M, 5);
+
+    ASSERT_EQUAL(monitor1.iteration_count(), 12);
+
+    cusp::blas::axpy(x0, x1, -1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(x1) < 1e-4 * cusp::blas::nrm2(x0), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFusedConjugateGradientMatchesCG);
+
+
+template <class MemorySpace>
+void TestFusedConjugateGradientCaptured(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    cusp::gallery::poisson5pt(A, 15, 17);
+
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+    cusp::array1d<float, MemorySpace> x0(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> x1(A.num_rows, 0.0f);
+
+    // blocks of 3 iterations are replayed from the second on, the last
+    // 2 iterations run directly
+    cusp::default_monitor<float> monitor0(b, 14, 0.0f);
+    cusp::default_monitor<float> monitor1(b, 14, 0.0f);
+
+    cusp::identity_operator<float, MemorySpace> M(A.num_rows, A.num_cols);
+
+    cusp::krylov::fused_cg(A, x0, b, monitor0, M, 3, false);
+    cusp::krylov::fused_cg(A, x1, b, monitor1, M, 3, true);
+
+    ASSERT_EQUAL(monitor1.iteration_count(), 14);
+
+    cusp::blas::axpy(x0, x1, -1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(x1) <= 1e-5 * cusp::blas::nrm2(x0), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFusedConjugateGradientCaptured);
+
+
+template <class MemorySpace>
+void TestFusedConjugateGradientZeroResidual(void)
+{
+    cusp::array2d<float, MemorySpace> M(2,2);
+    M(0,0) = 8; M(0,1) = 0;
+    M(1,0) = 0; M(1,1) = 4;
+
+    cusp::csr_matrix<int, float, MemorySpace> A(M);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 1.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows);
+
+    cusp::multiply(A, x, b);
+
+    cusp::default_monitor<float> monitor(b, 20, 0.0f);
+    
+    cusp::krylov::fused_cg(A, x, b, monitor);
+
+    ASSERT_EQUAL(monitor.converged(),        true);
+    ASSERT_EQUAL(monitor.iteration_count(),     0);
+    ASSERT_EQUAL(x[0], 1.0f);
+    ASSERT_EQUAL(x[1], 1.0f);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFusedConjugateGradientZeroResidual);
@@ -0,0 +1,95 @@
+#include <unittest/unittest.h>
+
+#include <cusp/galerkin_product.h>
+
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/transpose.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/gallery/random.h>
+
+template <typename Matrix>
+void ReferenceGalerkinProduct(const Matrix& R, const Matrix& A, const Matrix& P, cusp::array2d<float,cusp::host_memory>& RAP)
+{
+    cusp::array2d<float,cusp::host_memory> R_(R), A_(A), P_(P), AP;
+    cusp::multiply(A_, P_, AP);
+    cusp::multiply(R_, AP, RAP);
+}
+
+template <class MemorySpace>
+void TestGalerkinProduct(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 7, 6);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> P_host;
+    cusp::gallery::random(42, 9, 60, P_host);
+    for (size_t n = 0; n < P_host.num_entries; n++)
+        P_host.values[n] = float(n % 3 + 1);
+
+    cusp::csr_matrix<int, float, MemorySpace> P(P_host), R;
+    cusp::transpose(P, R);
+
+    cusp::array2d<float,cusp::host_memory> reference;
+    ReferenceGalerkinProduct(R, A, P, reference);
+
+    cusp::csr_matrix<int, float, MemorySpace> RAP;
+
+    cusp::galerkin_product(R, A, P, RAP);
+    ASSERT_EQUAL(reference == cusp::array2d<float,cusp::host_memory>(RAP), true);
+
+    // implicit restriction P^T
+    cusp::galerkin_product(A, P, RAP);
+    ASSERT_EQUAL(reference == cusp::array2d<float,cusp::host_memory>(RAP), true);
+
+    // other formats are converted
+    cusp::coo_matrix<int, float, MemorySpace> A_coo(A), P_coo(P), RAP_coo;
+    cusp::galerkin_product(A_coo, P_coo, RAP_coo);
+    ASSERT_EQUAL(reference == cusp::array2d<float,cusp::host_memory>(RAP_coo), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGalerkinProduct);
+
+template <class MemorySpace>
+void TestGalerkinProductSlabs(void)
+{
+    typedef cusp::csr_matrix<int, float, MemorySpace> Matrix;
+
+    Matrix A;
+    cusp::gallery::poisson5pt(A, 8, 8);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> P_host;
+    cusp::gallery::random(64, 13, 100, P_host);
+    for (size_t n = 0; n < P_host.num_entries; n++)
+        P_host.values[n] = float(n % 3 + 1);
+
+    Matrix P(P_host), R;
+    cusp::transpose(P, R);
+
+    cusp::array2d<float,cusp::host_memory> reference;
+    ReferenceGalerkinProduct(R, A, P, reference);
+
+    // a small capacity splits the product into one slab per coarse row
+    Matrix RAP;
+
+    cusp::detail::galerkin_product_csr(cusp::detail::galerkin_explicit_restriction<Matrix>(R), A, P, RAP, 1.0);
+    ASSERT_EQUAL(reference == cusp::array2d<float,cusp::host_memory>(RAP), true);
+
+    cusp::detail::galerkin_product_csr(cusp::detail::galerkin_implicit_restriction<Matrix>(P), A, P, RAP, 1.0);
+    ASSERT_EQUAL(reference == cusp::array2d<float,cusp::host_memory>(RAP), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGalerkinProductSlabs);
+
+void TestGalerkinProductDimensions(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A, P;
+    cusp::gallery::poisson5pt(A, 4, 4);
+    cusp::gallery::poisson5pt(P, 3, 3);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> RAP;
+
+    ASSERT_THROWS(cusp::galerkin_product(A, P, RAP),    cusp::invalid_input_exception);
+    ASSERT_THROWS(cusp::galerkin_product(P, A, P, RAP), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestGalerkinProductDimensions);
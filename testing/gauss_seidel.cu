@@ -0,0 +1,149 @@
+#include <unittest/unittest.h>
+
+#include <cusp/relaxation/gauss_seidel.h>
+
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/graph/vertex_coloring.h>
+
+// sequential Gauss-Seidel sweep over the rows in the given order
+template <typename Matrix, typename Array1, typename Array2, typename Array3>
+void gauss_seidel_reference(const Matrix& A, const Array1& b, Array2& x, const Array3& order)
+{
+    for (size_t n = 0; n < order.size(); n++)
+    {
+        const int i = order[n];
+
+        float residual = b[i];
+        float diagonal = 0;
+
+        for (int jj = A.row_offsets[i]; jj < A.row_offsets[i + 1]; jj++)
+        {
+            residual -= A.values[jj] * x[A.column_indices[jj]];
+
+            if (A.column_indices[jj] == i)
+                diagonal = A.values[jj];
+        }
+
+        x[i] += residual / diagonal;
+    }
+}
+
+template <typename Matrix>
+void TestGaussSeidelRelaxation(void)
+{
+    typedef typename Matrix::memory_space Space;
+
+    cusp::csr_matrix<int, float, cusp::host_memory> M;
+    cusp::gallery::poisson5pt(M, 10, 12);
+
+    Matrix A(M);
+
+    // the relaxation visits the colors of vertex_coloring in order
+    cusp::array1d<int, Space> colors;
+    cusp::array1d<int, Space> permutation;
+    cusp::array1d<int, Space> color_offsets;
+    cusp::graph::vertex_coloring(cusp::csr_matrix<int, float, Space>(A), colors);
+    cusp::graph::coloring_permutation(colors, permutation, color_offsets);
+
+    cusp::array1d<int, cusp::host_memory> forward(permutation);
+    cusp::array1d<int, cusp::host_memory> backward(forward.rbegin(), forward.rend());
+
+    cusp::array1d<float, cusp::host_memory> b = unittest::random_samples<float>(M.num_rows);
+    cusp::array1d<float, cusp::host_memory> x0(M.num_rows, -1.0f);
+
+    cusp::relaxation::gauss_seidel<float, Space> relax(A);
+
+    ASSERT_EQUAL(relax.num_colors(), color_offsets.size() - 1);
+
+    // forward sweep
+    {
+        cusp::array1d<float, cusp::host_memory> expected(x0);
+        gauss_seidel_reference(M, b, expected, forward);
+
+        cusp::array1d<float, Space> x(x0);
+        relax(A, cusp::array1d<float, Space>(b), x, cusp::relaxation::forward_sweep, 1.0f);
+
+        ASSERT_ALMOST_EQUAL(x, expected);
+    }
+
+    // backward sweep
+    {
+        cusp::array1d<float, cusp::host_memory> expected(x0);
+        gauss_seidel_reference(M, b, expected, backward);
+
+        cusp::array1d<float, Space> x(x0);
+        relax(A, cusp::array1d<float, Space>(b), x, cusp::relaxation::backward_sweep, 1.0f);
+
+        ASSERT_ALMOST_EQUAL(x, expected);
+    }
+
+    // symmetric sweep (default)
+    {
+        cusp::array1d<float, cusp::host_memory> expected(x0);
+        gauss_seidel_reference(M, b, expected, forward);
+        gauss_seidel_reference(M, b, expected, backward);
+
+        cusp::array1d<float, Space> x(x0);
+        relax(A, cusp::array1d<float, Space>(b), x);
+
+        ASSERT_ALMOST_EQUAL(x, expected);
+    }
+
+    // presmooth ignores the initial x
+    {
+        cusp::array1d<float, cusp::host_memory> expected(M.num_rows, 0.0f);
+        gauss_seidel_reference(M, b, expected, forward);
+        gauss_seidel_reference(M, b, expected, backward);
+
+        cusp::array1d<float, Space> x(x0);
+        relax.presmooth(A, cusp::array1d<float, Space>(b), x);
+
+        ASSERT_ALMOST_EQUAL(x, expected);
+    }
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestGaussSeidelRelaxation);
+
+template <class MemorySpace>
+void TestGaussSeidelRelaxationConvergence(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> r(A.num_rows);
+
+    cusp::relaxation::gauss_seidel<float, MemorySpace> relax(A);
+
+    relax(A, b, x);
+
+    cusp::multiply(A, x, r);
+    cusp::blas::axpby(b, r, r, 1.0f, -1.0f);
+    float norm_1 = cusp::blas::nrm2(r);
+
+    for (int i = 1; i < 20; i++)
+        relax(A, b, x);
+
+    cusp::multiply(A, x, r);
+    cusp::blas::axpby(b, r, r, 1.0f, -1.0f);
+    float norm_20 = cusp::blas::nrm2(r);
+
+    ASSERT_EQUAL(norm_20 < 0.5f * norm_1, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGaussSeidelRelaxationConvergence);
+
+void TestGaussSeidelRelaxationRectangular(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A(2, 3, 0);
+
+    ASSERT_THROWS((cusp::relaxation::gauss_seidel<float, cusp::host_memory>(A)), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestGaussSeidelRelaxationRectangular);
@@ -0,0 +1,88 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/krylov/gcr.h>
+
+// a few CG iterations from a zero initial guess, a nonlinear preconditioner
+template <typename Matrix>
+struct inner_cg : public cusp::linear_operator<typename Matrix::value_type, typename Matrix::memory_space>
+{
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+    typedef cusp::linear_operator<ValueType,MemorySpace> Parent;
+
+    Matrix& A;
+    size_t iterations;
+    mutable cusp::array1d<ValueType,MemorySpace> b;
+    mutable cusp::array1d<ValueType,MemorySpace> x;
+
+    inner_cg(Matrix& A, size_t iterations)
+        : Parent(A.num_rows, A.num_cols), A(A), iterations(iterations), b(A.num_rows), x(A.num_rows) {}
+
+    template <typename Array1, typename Array2>
+    void operator()(const Array1& r, Array2& y) const
+    {
+        cusp::blas::copy(r, b);
+        cusp::blas::fill(x, ValueType(0));
+
+        cusp::default_monitor<ValueType> monitor(b, iterations, 0);
+        cusp::krylov::cg(A, x, b, monitor);
+
+        cusp::blas::copy(x, y);
+    }
+};
+
+template <class MemorySpace>
+void TestGeneralizedConjugateResidual(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 100, 1e-4);
+
+    // restart before convergence
+    cusp::krylov::gcr(A, x, b, 15, monitor);
+
+    // check residual norm
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 2e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGeneralizedConjugateResidual);
+
+template <class MemorySpace>
+void TestGeneralizedConjugateResidualVariablePreconditioner(void)
+{
+    typedef cusp::csr_matrix<int, float, MemorySpace> Matrix;
+
+    Matrix A;
+
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    inner_cg<Matrix> M(A, 4);
+
+    cusp::default_monitor<float> monitor(b, 60, 1e-4);
+
+    cusp::krylov::gcr(A, x, b, 10, monitor, M);
+
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 2e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGeneralizedConjugateResidualVariablePreconditioner);
@@ -2,14 +2,21 @@
 
 #include <cusp/detail/device/generalized_spmv/coo_flat.h>
 #include <cusp/detail/device/generalized_spmv/csr_scalar.h>
+#include <cusp/detail/device/generalized_spmv/csr_vector.h>
+#include <cusp/detail/device/generalized_spmv/ell.h>
+#include <cusp/detail/device/generalized_spmv/hyb.h>
 
 #include <cusp/array1d.h>
 #include <cusp/coo_matrix.h>
 #include <cusp/csr_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
 #include <cusp/multiply.h>
 #include <cusp/gallery/poisson.h>
 #include <cusp/gallery/random.h>
 
+#include <algorithm>
+
 template <typename Matrix,
           typename Array1,
           typename Array2,
@@ -158,3 +165,130 @@ void TestCooGeneralizedSpMV(void)
 DECLARE_UNITTEST(TestCooGeneralizedSpMV);
 
 
+
+//////////////////////////////////////////
+// Semiring SpMV with the shared kernels //
+//////////////////////////////////////////
+
+template <typename Matrix,
+          typename Array1,
+          typename Array2,
+          typename Array3,
+          typename BinaryFunction1,
+          typename BinaryFunction2,
+          typename ValueType>
+void semiring_spmv(const Matrix& A, const Array1& x, const Array2& y, Array3& z,
+                   BinaryFunction1 combine, BinaryFunction2 reduce, ValueType identity,
+                   cusp::csr_format)
+{
+    cusp::detail::device::cuda::spmv_csr_vector
+        (A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), thrust::raw_pointer_cast(&z[0]),
+         combine, reduce, identity);
+}
+
+template <typename Matrix,
+          typename Array1,
+          typename Array2,
+          typename Array3,
+          typename BinaryFunction1,
+          typename BinaryFunction2,
+          typename ValueType>
+void semiring_spmv(const Matrix& A, const Array1& x, const Array2& y, Array3& z,
+                   BinaryFunction1 combine, BinaryFunction2 reduce, ValueType identity,
+                   cusp::ell_format)
+{
+    cusp::detail::device::cuda::spmv_ell_tex
+        (A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), thrust::raw_pointer_cast(&z[0]),
+         combine, reduce, identity);
+}
+
+template <typename Matrix,
+          typename Array1,
+          typename Array2,
+          typename Array3,
+          typename BinaryFunction1,
+          typename BinaryFunction2,
+          typename ValueType>
+void semiring_spmv(const Matrix& A, const Array1& x, const Array2& y, Array3& z,
+                   BinaryFunction1 combine, BinaryFunction2 reduce, ValueType identity,
+                   cusp::hyb_format)
+{
+    cusp::detail::device::cuda::spmv_hyb
+        (A, thrust::raw_pointer_cast(&x[0]), thrust::raw_pointer_cast(&y[0]), thrust::raw_pointer_cast(&z[0]),
+         combine, reduce, identity);
+}
+
+template <typename TestMatrix>
+void _TestSemiringSpMV(void)
+{
+  typedef typename TestMatrix::index_type   IndexType;
+  typedef typename TestMatrix::value_type   ValueType;
+  typedef typename TestMatrix::memory_space MemorySpace;
+
+  typedef typename cusp::coo_matrix<IndexType,ValueType,cusp::host_memory> HostMatrix;
+  cusp::array1d<HostMatrix, cusp::host_memory> matrices;
+
+  { HostMatrix M; cusp::gallery::poisson5pt(M,   5,   5);   matrices.push_back(M); }
+  { HostMatrix M; cusp::gallery::poisson5pt(M, 117, 113);   matrices.push_back(M); } 
+  { HostMatrix M; cusp::gallery::random( 21,  23,   5, M);  matrices.push_back(M); }
+  { HostMatrix M; cusp::gallery::random(129, 127,  40, M);  matrices.push_back(M); }
+  { HostMatrix M; cusp::gallery::random(512, 512, 276, M);  matrices.push_back(M); }
+
+  const ValueType infinity = 1e30f;
+
+  for(size_t i = 0; i < matrices.size(); i++)
+  {
+    HostMatrix& H = matrices[i];
+
+    // integer edge weights, so that the sums are exact
+    for(size_t n = 0; n < H.num_entries; n++)
+      H.values[n] = (H.row_indices[n] + 2 * H.column_indices[n]) % 7 + 1;
+
+    cusp::array1d<ValueType, cusp::host_memory> x = unittest::random_integers<char>(H.num_cols);
+    cusp::array1d<ValueType, cusp::host_memory> y = unittest::random_integers<char>(H.num_rows);
+
+    // min-plus reference: z[i] = min(y[i], min_j A(i,j) + x[j])
+    cusp::array1d<ValueType, cusp::host_memory> min_plus(y);
+    for(size_t n = 0; n < H.num_entries; n++)
+      min_plus[H.row_indices[n]] = std::min(min_plus[H.row_indices[n]], H.values[n] + x[H.column_indices[n]]);
+
+    // plus-times reference: z[i] = y[i] + A(i,:) x
+    cusp::array1d<ValueType, cusp::host_memory> plus_times(y);
+    for(size_t n = 0; n < H.num_entries; n++)
+      plus_times[H.row_indices[n]] += H.values[n] * x[H.column_indices[n]];
+
+    TestMatrix M = H;
+
+    cusp::array1d<ValueType, MemorySpace> _x(x);
+    cusp::array1d<ValueType, MemorySpace> _y(y);
+    cusp::array1d<ValueType, MemorySpace> _z(H.num_rows, -1);
+
+    semiring_spmv(M, _x, _y, _z, thrust::plus<ValueType>(), thrust::minimum<ValueType>(), infinity, typename TestMatrix::format());
+    ASSERT_EQUAL(_z, min_plus);
+
+    semiring_spmv(M, _x, _y, _z, thrust::multiplies<ValueType>(), thrust::plus<ValueType>(), ValueType(0), typename TestMatrix::format());
+    ASSERT_EQUAL(_z, plus_times);
+
+    // in place, z = y
+    semiring_spmv(M, _x, _y, _y, thrust::plus<ValueType>(), thrust::minimum<ValueType>(), infinity, typename TestMatrix::format());
+    ASSERT_EQUAL(_y, min_plus);
+  }
+}
+
+void TestCsrSemiringSpMV(void)
+{
+  _TestSemiringSpMV< cusp::csr_matrix<int,float,cusp::device_memory> >();
+}
+DECLARE_UNITTEST(TestCsrSemiringSpMV);
+
+void TestEllSemiringSpMV(void)
+{
+  _TestSemiringSpMV< cusp::ell_matrix<int,float,cusp::device_memory> >();
+}
+DECLARE_UNITTEST(TestEllSemiringSpMV);
+
+void TestHybSemiringSpMV(void)
+{
+  _TestSemiringSpMV< cusp::hyb_matrix<int,float,cusp::device_memory> >();
+}
+DECLARE_UNITTEST(TestHybSemiringSpMV);
@@ -0,0 +1,93 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/krylov/gmres.h>
+#include <cusp/precond/diagonal.h>
+
+template <class MemorySpace>
+void TestGeneralizedMinimumResidual(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 100, 1e-4);
+
+    // restart before convergence
+    cusp::krylov::gmres(A, x, b, 15, monitor);
+
+    // check residual norm
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 2e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGeneralizedMinimumResidual);
+
+
+template <class MemorySpace>
+void TestGeneralizedMinimumResidualSolver(void)
+{
+    // a default constructed solver has a usable restart length
+    cusp::krylov::gmres_solver<float, MemorySpace> solver;
+
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 100, 1e-4);
+
+    solver.solve(A, x, b, monitor);
+
+    // check residual norm
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 2e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGeneralizedMinimumResidualSolver);
+
+// rows scaled by 1 to 7, so that the matrix is nonsymmetric and needs the
+// diagonal preconditioner
+template <class MemorySpace>
+void TestGeneralizedMinimumResidualPreconditioned(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> B;
+    cusp::gallery::poisson5pt(B, 10, 10);
+
+    for (size_t i = 0; i < B.num_rows; i++)
+        for (int jj = B.row_offsets[i]; jj < B.row_offsets[i + 1]; jj++)
+            B.values[jj] *= float(1 + i % 7);
+
+    cusp::csr_matrix<int, float, MemorySpace> A(B);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::precond::diagonal<float, MemorySpace> M(A);
+
+    cusp::default_monitor<float> monitor(b, 1000, 1e-5);
+
+    // short cycles run the Arnoldi steps and the update of x many times
+    cusp::krylov::gmres(A, x, b, 5, monitor, M);
+
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(monitor.iteration_count() > 5, true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 1e-3 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGeneralizedMinimumResidualPreconditioned);
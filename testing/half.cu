@@ -0,0 +1,68 @@
+#include <unittest/unittest.h>
+
+#include <cusp/half.h>
+
+#include <cusp/copy.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+
+// The 5-point Laplacian and the input vector are exactly representable
+// in half precision, so the mixed product equals the float product.
+template <typename StorageMatrix, typename FloatMatrix>
+void CompareHalfStorageMultiply(void)
+{
+    typedef typename StorageMatrix::memory_space MemorySpace;
+
+    FloatMatrix A;
+    cusp::gallery::poisson5pt(A, 11, 9);
+
+    cusp::array1d<float, MemorySpace> x(A.num_cols);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 10) - 4;
+
+    cusp::array1d<float, MemorySpace> y_ref(A.num_rows);
+    cusp::multiply(A, x, y_ref);
+
+    // round the values to the storage type
+    StorageMatrix B;
+    cusp::copy(A, B);
+
+    cusp::array1d<float, MemorySpace> y(A.num_rows, 17.0f);
+    cusp::multiply(B, x, y);
+
+    ASSERT_EQUAL(y, y_ref);
+
+    // accumulation in double
+    cusp::array1d<double, MemorySpace> x_d(x);
+    cusp::array1d<double, MemorySpace> y_d(A.num_rows, 17.0);
+    cusp::multiply(B, x_d, y_d);
+
+    cusp::array1d<double, MemorySpace> y_ref_d(y_ref);
+    ASSERT_EQUAL(y_d, y_ref_d);
+}
+
+template <class MemorySpace>
+void TestHalfStorageMultiply(void)
+{
+    CompareHalfStorageMultiply< cusp::coo_matrix<int, cusp::half, MemorySpace>, cusp::coo_matrix<int, float, MemorySpace> >();
+    CompareHalfStorageMultiply< cusp::csr_matrix<int, cusp::half, MemorySpace>, cusp::csr_matrix<int, float, MemorySpace> >();
+    CompareHalfStorageMultiply< cusp::ell_matrix<int, cusp::half, MemorySpace>, cusp::ell_matrix<int, float, MemorySpace> >();
+    CompareHalfStorageMultiply< cusp::hyb_matrix<int, cusp::half, MemorySpace>, cusp::hyb_matrix<int, float, MemorySpace> >();
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestHalfStorageMultiply);
+
+#if defined(CUSP_HAS_BFLOAT16)
+template <class MemorySpace>
+void TestBfloat16StorageMultiply(void)
+{
+    CompareHalfStorageMultiply< cusp::csr_matrix<int, cusp::bfloat16, MemorySpace>, cusp::csr_matrix<int, float, MemorySpace> >();
+    CompareHalfStorageMultiply< cusp::hyb_matrix<int, cusp::bfloat16, MemorySpace>, cusp::hyb_matrix<int, float, MemorySpace> >();
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBfloat16StorageMultiply);
+#endif
+
@@ -0,0 +1,118 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/precond/diagonal.h>
+#include <cusp/krylov/bicgstab.h>
+#include <cusp/krylov/idrs.h>
+
+// 5-point convection-diffusion on an n x n grid with central differences,
+// where the cell Peclet number e > 1 moves the eigenvalues far from the
+// real axis
+template <typename MatrixType>
+void convection_diffusion(MatrixType& A, int n, float e)
+{
+    cusp::coo_matrix<int, float, cusp::host_memory> C(n * n, n * n, 5 * n * n - 4 * n);
+
+    int k = 0;
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            const int row = i * n + j;
+
+            if (i > 0)     { C.row_indices[k] = row; C.column_indices[k] = row - n; C.values[k++] = -1 - e; }
+            if (j > 0)     { C.row_indices[k] = row; C.column_indices[k] = row - 1; C.values[k++] = -1 - e; }
+                             C.row_indices[k] = row; C.column_indices[k] = row;     C.values[k++] =  4;
+            if (j < n - 1) { C.row_indices[k] = row; C.column_indices[k] = row + 1; C.values[k++] = -1 + e; }
+            if (i < n - 1) { C.row_indices[k] = row; C.column_indices[k] = row + n; C.values[k++] = -1 + e; }
+        }
+    }
+
+    A = C;
+}
+
+template <class MemorySpace>
+void TestInducedDimensionReduction(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 100, 1e-4);
+
+    cusp::krylov::idrs(A, x, b, 2, monitor);
+
+    // check residual norm
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 2e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestInducedDimensionReduction);
+
+template <class MemorySpace>
+void TestInducedDimensionReductionConvection(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    convection_diffusion(A, 16, 2.94f);
+
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    // BiCGStab for reference, each iteration costs two products with A
+    cusp::array1d<float, MemorySpace> x0(A.num_rows, 0.0f);
+    cusp::default_monitor<float> monitor0(b, 500, 1e-4);
+    cusp::krylov::bicgstab(A, x0, b, monitor0);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::default_monitor<float> monitor(b, 120, 1e-4);
+    cusp::krylov::idrs(A, x, b, 4, monitor);
+
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 2e-4 * cusp::blas::nrm2(b), true);
+
+    // an IDR(s) iteration costs one product
+    ASSERT_EQUAL(monitor.iteration_count() < 2 * monitor0.iteration_count(), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestInducedDimensionReductionConvection);
+
+template <class MemorySpace>
+void TestInducedDimensionReductionPreconditioned(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+
+    convection_diffusion(A, 16, 2.94f);
+    // scale the rows to make the diagonal preconditioner nontrivial
+    cusp::coo_matrix<int, float, cusp::host_memory> C(A);
+    for (size_t n = 0; n < C.num_entries; n++)
+        C.values[n] *= 1 + (C.row_indices[n] % 7);
+    A = C;
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::precond::diagonal<float, MemorySpace> M(A);
+
+    cusp::default_monitor<float> monitor(b, 120, 1e-4);
+    cusp::krylov::idrs(A, x, b, 4, monitor, M);
+
+    cusp::array1d<float, MemorySpace> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 2e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestInducedDimensionReductionPreconditioned);
@@ -0,0 +1,162 @@
+#include <unittest/unittest.h>
+
+#include <cusp/precond/ilu.h>
+
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/bicgstab.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/krylov/gmres.h>
+
+template <class MemorySpace>
+void TestILU0Tridiagonal(void)
+{
+    // ILU(0) of a tridiagonal matrix is its exact LU factorization
+    cusp::array2d<float, cusp::host_memory> D(5,5,0.0f);
+    for (int i = 0; i < 5; i++)
+    {
+        D(i,i) = 4.0f + i;
+        if (i > 0) D(i,i-1) = -1.0f;
+        if (i < 4) D(i,i+1) = -2.0f;
+    }
+
+    cusp::csr_matrix<int, float, MemorySpace> A(D);
+
+    cusp::precond::ilu0<float, MemorySpace> M(A);
+
+    ASSERT_EQUAL(M.num_lower_levels(), (size_t) 5);
+    ASSERT_EQUAL(M.num_upper_levels(), (size_t) 5);
+
+    cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(5);
+    cusp::array1d<float, MemorySpace> b(5);
+    cusp::array1d<float, MemorySpace> y(5);
+
+    cusp::multiply(A, x, b);
+    cusp::multiply(M, b, y);
+
+    ASSERT_ALMOST_EQUAL(y, x);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestILU0Tridiagonal);
+
+template <class MemorySpace>
+void TestIC0Tridiagonal(void)
+{
+    // IC(0) of a tridiagonal matrix is its exact Cholesky factorization
+    cusp::array2d<float, cusp::host_memory> D(5,5,0.0f);
+    for (int i = 0; i < 5; i++)
+    {
+        D(i,i) = 4.0f + i;
+        if (i > 0) D(i,i-1) = -1.0f;
+        if (i < 4) D(i,i+1) = -1.0f;
+    }
+
+    cusp::csr_matrix<int, float, MemorySpace> A(D);
+
+    cusp::precond::ic0<float, MemorySpace> M(A);
+
+    cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(5);
+    cusp::array1d<float, MemorySpace> b(5);
+    cusp::array1d<float, MemorySpace> y(5);
+
+    cusp::multiply(A, x, b);
+    cusp::multiply(M, b, y);
+
+    ASSERT_ALMOST_EQUAL(y, x);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestIC0Tridiagonal);
+
+template <class MemorySpace>
+void TestIncompleteFactorizationPoisson(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 30);
+
+    cusp::precond::ilu0<float, MemorySpace> ILU(A);
+    cusp::precond::ic0<float, MemorySpace>  IC(A);
+
+    // rows of the same antidiagonal of the grid form a level
+    ASSERT_EQUAL(ILU.num_lower_levels(), (size_t) (20 + 30 - 1));
+    ASSERT_EQUAL(IC.num_upper_levels(),  (size_t) (20 + 30 - 1));
+
+    // both factorizations agree for a symmetric matrix
+    {
+        cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(A.num_rows);
+        cusp::array1d<float, MemorySpace> y1(A.num_rows);
+        cusp::array1d<float, MemorySpace> y2(A.num_rows);
+
+        cusp::multiply(ILU, x, y1);
+        cusp::multiply(IC,  x, y2);
+
+        ASSERT_ALMOST_EQUAL(y1, y2);
+    }
+
+    cusp::array1d<float, MemorySpace> b = unittest::random_samples<float>(A.num_rows);
+
+    // unpreconditioned iterations
+    size_t iterations;
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+        cusp::krylov::cg(A, x, b, monitor);
+        ASSERT_EQUAL(monitor.converged(), true);
+        iterations = monitor.iteration_count();
+    }
+
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+        cusp::krylov::cg(A, x, b, monitor, IC);
+        ASSERT_EQUAL(monitor.converged(), true);
+        ASSERT_EQUAL(monitor.iteration_count() < iterations, true);
+    }
+
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+        cusp::krylov::bicgstab(A, x, b, monitor, ILU);
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+        cusp::krylov::gmres(A, x, b, 30, monitor, ILU);
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestIncompleteFactorizationPoisson);
+
+void TestIncompleteFactorizationErrors(void)
+{
+    // missing diagonal entry
+    {
+        cusp::array2d<float, cusp::host_memory> D(2,2,1.0f);
+        D(1,1) = 0.0f;
+        cusp::csr_matrix<int, float, cusp::host_memory> A(D);
+
+        ASSERT_THROWS((cusp::precond::ilu0<float, cusp::host_memory>(A)), cusp::invalid_input_exception);
+        ASSERT_THROWS((cusp::precond::ic0<float, cusp::host_memory>(A)),  cusp::invalid_input_exception);
+    }
+
+    // indefinite matrix
+    {
+        cusp::array2d<float, cusp::host_memory> D(2,2,2.0f);
+        D(0,0) = 1.0f;
+        D(1,1) = 1.0f;
+        cusp::csr_matrix<int, float, cusp::host_memory> A(D);
+
+        ASSERT_THROWS((cusp::precond::ic0<float, cusp::host_memory>(A)), cusp::runtime_exception);
+    }
+
+    // rectangular matrix
+    {
+        cusp::csr_matrix<int, float, cusp::host_memory> A(2, 3, 0);
+
+        ASSERT_THROWS((cusp::precond::ilu0<float, cusp::host_memory>(A)), cusp::invalid_input_exception);
+    }
+}
+DECLARE_UNITTEST(TestIncompleteFactorizationErrors);
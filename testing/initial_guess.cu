@@ -0,0 +1,129 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/array1d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/krylov/initial_guess.h>
+
+template <class MemorySpace>
+void TestInitialGuessProjector(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    const size_t N = A.num_rows;
+
+    cusp::array1d<float, cusp::host_memory> x1_h(N);
+    cusp::array1d<float, cusp::host_memory> x2_h(N);
+    cusp::array1d<float, cusp::host_memory> x3_h(N);
+    for (size_t i = 0; i < N; i++)
+    {
+        x1_h[i] = float(i % 5);
+        x2_h[i] = float((3 * i) % 7) - 2.0f;
+        x3_h[i] = 2.0f * x1_h[i] - x2_h[i];
+    }
+
+    cusp::array1d<float, MemorySpace> x1(x1_h), b1(N);
+    cusp::array1d<float, MemorySpace> x2(x2_h), b2(N);
+    cusp::array1d<float, MemorySpace> x3(x3_h), b3(N);
+    cusp::multiply(A, x1, b1);
+    cusp::multiply(A, x2, b2);
+    cusp::multiply(A, x3, b3);
+
+    cusp::krylov::initial_guess_projector<float, MemorySpace> projector(4);
+    ASSERT_EQUAL(projector.size(), (size_t) 0);
+
+    // no solutions are kept yet
+    cusp::array1d<float, MemorySpace> x(N, 1.0f);
+    projector.guess(b3, x);
+    ASSERT_EQUAL(x, cusp::array1d<float, MemorySpace>(N, 1.0f));
+
+    projector.add(x1, b1);
+    projector.add(x2, b2);
+    ASSERT_EQUAL(projector.size(), (size_t) 2);
+
+    // a dependent right-hand side is not kept
+    projector.add(x3, b3);
+    ASSERT_EQUAL(projector.size(), (size_t) 2);
+
+    // b3 = 2 b1 - b2 is in the span of the kept right-hand sides
+    projector.guess(b3, x);
+    ASSERT_ALMOST_EQUAL(cusp::array1d<float, cusp::host_memory>(x), x3_h);
+
+    projector.clear();
+    ASSERT_EQUAL(projector.size(), (size_t) 0);
+
+    cusp::array1d<float, MemorySpace> y(N + 1);
+    projector.add(x1, b1);
+    ASSERT_THROWS(projector.guess(y, y), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestInitialGuessProjector);
+
+template <class MemorySpace>
+void TestInitialGuessProjectorHistory(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 8, 8);
+
+    cusp::krylov::initial_guess_projector<float, MemorySpace> projector(2);
+
+    for (size_t s = 0; s < 4; s++)
+    {
+        cusp::array1d<float, cusp::host_memory> x_h(A.num_rows);
+        for (size_t i = 0; i < x_h.size(); i++)
+            x_h[i] = float((i * (s + 2)) % (s + 3));
+
+        cusp::array1d<float, MemorySpace> x(x_h), b(A.num_rows);
+        cusp::multiply(A, x, b);
+
+        projector.add(x, b);
+    }
+
+    // the oldest pairs are discarded
+    ASSERT_EQUAL(projector.size(), (size_t) 2);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestInitialGuessProjectorHistory);
+
+template <class MemorySpace>
+void TestInitialGuessProjectorSequence(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 16, 16);
+
+    cusp::krylov::initial_guess_projector<float, MemorySpace> projector(4);
+
+    size_t projected_iterations = 0;
+    size_t plain_iterations     = 0;
+
+    for (size_t s = 0; s < 5; s++)
+    {
+        // slowly varying right-hand sides
+        cusp::array1d<float, cusp::host_memory> b_h(A.num_rows);
+        for (size_t i = 0; i < b_h.size(); i++)
+            b_h[i] = 1.0f + 0.1f * float(s) * float(i % 4);
+
+        cusp::array1d<float, MemorySpace> b(b_h);
+
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        projector.guess(b, x);
+
+        cusp::default_monitor<float> monitor(b, 200, 1e-5);
+        cusp::krylov::cg(A, x, b, monitor);
+        ASSERT_EQUAL(monitor.converged(), true);
+
+        projector.add(x, b);
+
+        cusp::array1d<float, MemorySpace> x0(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor0(b, 200, 1e-5);
+        cusp::krylov::cg(A, x0, b, monitor0);
+
+        projected_iterations += monitor.iteration_count();
+        plain_iterations     += monitor0.iteration_count();
+    }
+
+    ASSERT_EQUAL(projected_iterations < plain_iterations, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestInitialGuessProjectorSequence);
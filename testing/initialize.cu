@@ -0,0 +1,52 @@
+#include <unittest/unittest.h>
+
+#include <cusp/initialize.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+void TestInitialize(void)
+{
+    cusp::initialize_report report = cusp::initialize<int,float>(cusp::warmup_all);
+
+    ASSERT_EQUAL(report.context_seconds        >= 0, true);
+    ASSERT_EQUAL(report.first_multiply_seconds >  0, true);
+    ASSERT_EQUAL(report.warmup_seconds >= report.first_multiply_seconds, true);
+    ASSERT_EQUAL(report.time_to_first_multiply() >= report.first_multiply_seconds, true);
+}
+DECLARE_UNITTEST(TestInitialize);
+
+void TestInitializeNone(void)
+{
+    cusp::initialize_report report = cusp::initialize<int,double>(cusp::warmup_none);
+
+    ASSERT_EQUAL(report.context_seconds >= 0, true);
+    ASSERT_EQUAL(report.first_multiply_seconds, 0.0);
+    ASSERT_EQUAL(report.warmup_seconds, 0.0);
+}
+DECLARE_UNITTEST(TestInitializeNone);
+
+void TestInitializer(void)
+{
+    cusp::initializer<int,float> init(cusp::warmup_csr | cusp::warmup_blas);
+
+    // the library is usable while the kernels are warmed
+    cusp::csr_matrix<int, float, cusp::device_memory> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<float, cusp::device_memory> x(A.num_cols, 1.0f);
+    cusp::array1d<float, cusp::device_memory> y(A.num_rows, 0.0f);
+    cusp::multiply(A, x, y);
+
+    const cusp::initialize_report& report = init.wait();
+
+    ASSERT_EQUAL(report.first_multiply_seconds > 0, true);
+
+    // a second wait returns the same timings
+    ASSERT_EQUAL(&init.wait(), &report);
+
+    ASSERT_EQUAL(y[0],  2.0f);
+    ASSERT_EQUAL(y[11], 0.0f);
+}
+DECLARE_UNITTEST(TestInitializer);
+
@@ -0,0 +1,108 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/linear_operator.h>
+#include <cusp/precond/smoothed_aggregation.h>
+#include <cusp/krylov/iterative_refinement.h>
+
+template <class Matrix, class Array>
+double relative_residual(Matrix& A, Array& x, Array& b)
+{
+    Array r(A.num_rows);
+    cusp::residual(A, x, b, r);
+    return cusp::blas::nrm2(r) / cusp::blas::nrm2(b);
+}
+
+template <class MemorySpace>
+void TestIterativeRefinement(void)
+{
+    cusp::csr_matrix<int, double, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<double, MemorySpace> x(A.num_rows, 0.0);
+    cusp::array1d<double, MemorySpace> b(A.num_rows, 1.0);
+
+    // well beyond the accuracy of a single precision solve
+    cusp::default_monitor<double> monitor(b, 20, 1e-10);
+    cusp::krylov::iterative_refinement(A, x, b, monitor);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(relative_residual(A, x, b) < 1e-10, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestIterativeRefinement);
+
+template <class MemorySpace>
+void TestIterativeRefinementGmres(void)
+{
+    typedef cusp::csr_matrix<int, float, MemorySpace> LowMatrix;
+    typedef cusp::identity_operator<float, MemorySpace> Identity;
+
+    cusp::csr_matrix<int, double, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<double, MemorySpace> x(A.num_rows, 0.0);
+    cusp::array1d<double, MemorySpace> b(A.num_rows, 1.0);
+
+    cusp::krylov::iterative_refinement_solver<LowMatrix> solver(A);
+
+    Identity M(A.num_rows, A.num_rows);
+    cusp::krylov::refinement_gmres<Identity> inner(M, 20, 1e-3, 100);
+
+    cusp::default_monitor<double> monitor(b, 20, 1e-10);
+    solver.solve(A, x, b, monitor, inner);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(relative_residual(A, x, b) < 1e-10, true);
+
+    // each step gains at least the three digits of the inner solve
+    ASSERT_EQUAL(monitor.iteration_count() <= 5, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestIterativeRefinementGmres);
+
+template <class MemorySpace>
+void TestIterativeRefinementMultigrid(void)
+{
+    typedef cusp::csr_matrix<int, float, MemorySpace> LowMatrix;
+    typedef cusp::precond::smoothed_aggregation<int, float, MemorySpace> Multigrid;
+
+    cusp::csr_matrix<int, double, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    cusp::array1d<double, MemorySpace> b(A.num_rows, 1.0);
+
+    // the cached float matrix serves both the hierarchy and two solves
+    cusp::krylov::iterative_refinement_solver<LowMatrix> solver(A);
+
+    Multigrid M(solver.low_precision_matrix());
+    cusp::krylov::refinement_preconditioner<Multigrid> inner(M);
+
+    for (int i = 0; i < 2; i++)
+    {
+        cusp::array1d<double, MemorySpace> x(A.num_rows, 0.0);
+
+        cusp::default_monitor<double> monitor(b, 100, 1e-10);
+        solver.solve(A, x, b, monitor, inner);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+        ASSERT_EQUAL(relative_residual(A, x, b) < 1e-10, true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestIterativeRefinementMultigrid);
+
+void TestIterativeRefinementDimensions(void)
+{
+    cusp::csr_matrix<int, double, cusp::host_memory> A, B;
+    cusp::gallery::poisson5pt(A, 4, 4);
+    cusp::gallery::poisson5pt(B, 5, 5);
+
+    cusp::array1d<double, cusp::host_memory> x(B.num_rows, 0.0);
+    cusp::array1d<double, cusp::host_memory> b(B.num_rows, 1.0);
+
+    cusp::krylov::iterative_refinement_solver< cusp::csr_matrix<int, float, cusp::host_memory> > solver(A);
+    cusp::default_monitor<double> monitor(b);
+
+    ASSERT_THROWS(solver.solve(B, x, b, monitor), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestIterativeRefinementDimensions);
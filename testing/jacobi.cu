@@ -8,6 +8,7 @@
 #include <cusp/dia_matrix.h>
 #include <cusp/ell_matrix.h>
 #include <cusp/hyb_matrix.h>
+#include <cusp/gallery/poisson.h>
 
 template <typename Matrix>
 void TestJacobiRelaxation(void)
@@ -74,3 +75,53 @@ void TestJacobiRelaxationWithWeighting(void)
 }
 DECLARE_SPARSE_MATRIX_UNITTEST(TestJacobiRelaxationWithWeighting);
 
+
+
+template <typename Matrix>
+void TestJacobiRelaxationSweeps(void)
+{
+    typedef typename Matrix::memory_space Space;
+    typedef typename cusp::array1d<float, Space>::view View;
+
+    cusp::csr_matrix<int, float, cusp::host_memory> M;
+    cusp::gallery::poisson5pt(M, 7, 9);
+
+    Matrix A(M);
+
+    cusp::array1d<float, Space> b = unittest::random_samples<float>(A.num_rows);
+    cusp::array1d<float, Space> x0 = unittest::random_samples<float>(A.num_rows);
+
+    cusp::relaxation::jacobi<float, Space> relax(A, 0.8f);
+
+    for (size_t sweeps = 0; sweeps < 4; sweeps++)
+    {
+        // one sweep at a time
+        cusp::array1d<float, Space> expected(x0);
+        for (size_t k = 0; k < sweeps; k++)
+            relax(A, b, expected);
+
+        // x is exchanged with the buffer of the smoother
+        cusp::array1d<float, Space> x1(x0);
+        relax.postsmooth(A, b, x1, sweeps);
+        ASSERT_ALMOST_EQUAL(x1, expected);
+
+        // the result is copied to a view
+        cusp::array1d<float, Space> x2(x0);
+        View x2_view(x2);
+        relax.postsmooth(A, b, x2_view, sweeps);
+        ASSERT_ALMOST_EQUAL(x2, expected);
+    }
+
+    // presmooth is a sweep from x = 0
+    {
+        cusp::array1d<float, Space> expected(A.num_rows, 0.0f);
+        relax(A, b, expected);
+        relax(A, b, expected);
+
+        cusp::array1d<float, Space> x(x0);
+        relax.presmooth(A, b, x, 2);
+
+        ASSERT_ALMOST_EQUAL(x, expected);
+    }
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestJacobiRelaxationSweeps);
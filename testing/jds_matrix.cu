@@ -0,0 +1,137 @@
+#include <unittest/unittest.h>
+#include <cusp/jds_matrix.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/random.h>
+
+template <class Space>
+void TestJdsMatrixBasicConstructor(void)
+{
+    cusp::jds_matrix<int, float, Space> matrix(5, 6, 8, 4);
+
+    ASSERT_EQUAL(matrix.num_rows,                5);
+    ASSERT_EQUAL(matrix.num_cols,                6);
+    ASSERT_EQUAL(matrix.num_entries,             8);
+    ASSERT_EQUAL(matrix.num_diagonals(),         4);
+    ASSERT_EQUAL(matrix.row_permutation.size(),  5);
+    ASSERT_EQUAL(matrix.diagonal_offsets.size(), 5);
+    ASSERT_EQUAL(matrix.column_indices.size(),   8);
+    ASSERT_EQUAL(matrix.values.size(),           8);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestJdsMatrixBasicConstructor);
+
+template <class Space>
+void TestJdsMatrixConversion(void)
+{
+    // [10  0  0  0  0  0]
+    // [20  0 21 22  0 23]
+    // [ 0  0  0  0  0  0]
+    // [ 0 30  0  0 31  0]
+    // [ 0  0  0  0  0 40]
+    cusp::array2d<float, cusp::host_memory> A(5, 6, 0);
+    A(0,0) = 10;
+    A(1,0) = 20; A(1,2) = 21; A(1,3) = 22; A(1,5) = 23;
+    A(3,1) = 30; A(3,4) = 31;
+    A(4,5) = 40;
+
+    cusp::jds_matrix<int, float, Space> B(A);
+
+    ASSERT_EQUAL(B.num_entries,     8);
+    ASSERT_EQUAL(B.num_diagonals(), 4);
+
+    cusp::jds_matrix<int, float, cusp::host_memory> H(B);
+
+    // rows sorted by decreasing length, ties in their original order
+    ASSERT_EQUAL(H.row_permutation[0], 1);
+    ASSERT_EQUAL(H.row_permutation[1], 3);
+    ASSERT_EQUAL(H.row_permutation[2], 0);
+    ASSERT_EQUAL(H.row_permutation[3], 4);
+    ASSERT_EQUAL(H.row_permutation[4], 2);
+
+    // diagonals of length 4, 2, 1 and 1
+    ASSERT_EQUAL(H.diagonal_offsets[0], 0);
+    ASSERT_EQUAL(H.diagonal_offsets[1], 4);
+    ASSERT_EQUAL(H.diagonal_offsets[2], 6);
+    ASSERT_EQUAL(H.diagonal_offsets[3], 7);
+    ASSERT_EQUAL(H.diagonal_offsets[4], 8);
+
+    ASSERT_EQUAL(H.column_indices[0], 0); ASSERT_EQUAL(H.values[0], 20);
+    ASSERT_EQUAL(H.column_indices[1], 1); ASSERT_EQUAL(H.values[1], 30);
+    ASSERT_EQUAL(H.column_indices[2], 0); ASSERT_EQUAL(H.values[2], 10);
+    ASSERT_EQUAL(H.column_indices[3], 5); ASSERT_EQUAL(H.values[3], 40);
+    ASSERT_EQUAL(H.column_indices[4], 2); ASSERT_EQUAL(H.values[4], 21);
+    ASSERT_EQUAL(H.column_indices[5], 4); ASSERT_EQUAL(H.values[5], 31);
+    ASSERT_EQUAL(H.column_indices[6], 3); ASSERT_EQUAL(H.values[6], 22);
+    ASSERT_EQUAL(H.column_indices[7], 5); ASSERT_EQUAL(H.values[7], 23);
+
+    // convert back through CSR and COO
+    cusp::csr_matrix<int, float, Space> C(B);
+    cusp::coo_matrix<int, float, Space> D(B);
+
+    ASSERT_EQUAL(C.num_entries, 8);
+    ASSERT_EQUAL(D.num_entries, 8);
+
+    cusp::array2d<float, cusp::host_memory> E(C);
+    cusp::array2d<float, cusp::host_memory> F(D);
+    cusp::array2d<float, cusp::host_memory> G(B);
+
+    ASSERT_EQUAL(E == A, true);
+    ASSERT_EQUAL(F == A, true);
+    ASSERT_EQUAL(G == A, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestJdsMatrixConversion);
+
+template <class Space>
+void TestJdsMatrixMultiply(void)
+{
+    cusp::coo_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::random(1003, 1001, 12000, A);
+
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 7) - 3;
+
+    cusp::array1d<float, cusp::host_memory> y(A.num_rows, 0);
+    cusp::multiply(A, x, y);
+
+    cusp::jds_matrix<int, float, Space> B(A);
+
+    cusp::array1d<float, Space> d_x(x);
+    cusp::array1d<float, Space> d_y(A.num_rows, 10);
+    cusp::multiply(B, d_x, d_y);
+
+    cusp::array1d<float, cusp::host_memory> z(d_y);
+
+    ASSERT_ALMOST_EQUAL(z, y);
+
+    // y <- 2 * A * x - y
+    cusp::array1d<float, cusp::host_memory> w(A.num_rows);
+    for (size_t i = 0; i < w.size(); i++)
+        w[i] = float(i % 5);
+
+    cusp::array1d<float, Space> d_w(w);
+    cusp::multiply(B, d_x, d_w, 2.0f, -1.0f);
+
+    for (size_t i = 0; i < w.size(); i++)
+        w[i] = 2.0f * y[i] - w[i];
+
+    cusp::array1d<float, cusp::host_memory> v(d_w);
+
+    ASSERT_ALMOST_EQUAL(v, w);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestJdsMatrixMultiply);
+
+void TestJdsMatrixRebind(void)
+{
+    typedef cusp::jds_matrix<int, float, cusp::host_memory> HostMatrix;
+    typedef HostMatrix::rebind<cusp::device_memory>::type   DeviceMatrix;
+
+    HostMatrix   h_matrix(10, 10, 50, 8);
+    DeviceMatrix d_matrix(h_matrix);
+
+    ASSERT_EQUAL(h_matrix.num_entries,     d_matrix.num_entries);
+    ASSERT_EQUAL(d_matrix.num_diagonals(), 8);
+}
+DECLARE_UNITTEST(TestJdsMatrixRebind);
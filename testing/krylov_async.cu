@@ -0,0 +1,111 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/linear_operator.h>
+#include <cusp/krylov/async.h>
+
+// a preconditioner that fails on first use
+template <typename ValueType, typename MemorySpace>
+struct failing_preconditioner : public cusp::linear_operator<ValueType, MemorySpace>
+{
+    typedef cusp::linear_operator<ValueType,MemorySpace> Parent;
+
+    failing_preconditioner(size_t N) : Parent(N, N) {}
+
+    template <typename Array1, typename Array2>
+    void operator()(const Array1& x, Array2& y) const
+    {
+        throw cusp::invalid_input_exception("preconditioner failed");
+    }
+};
+
+template <typename Matrix, typename Array>
+bool solved(const Matrix& A, const Array& x, const Array& b, float tolerance)
+{
+    Array residual(A.num_rows);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    return cusp::blas::nrm2(residual) < tolerance * cusp::blas::nrm2(b);
+}
+
+void TestKrylovAsync(void)
+{
+    typedef cusp::array1d<float, cusp::device_memory> Array;
+
+    cusp::csr_matrix<int, float, cusp::device_memory> A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    Array x1(A.num_rows, 0.0f), b1(A.num_rows, 1.0f);
+    Array x2(A.num_rows, 0.0f), b2(A.num_rows, 2.0f);
+    Array x3(A.num_rows, 0.0f), b3(A.num_rows, 3.0f);
+
+    cusp::default_monitor<float> monitor1(b1, 200, 1e-4);
+    cusp::default_monitor<float> monitor2(b2, 200, 1e-4);
+    cusp::default_monitor<float> monitor3(b3, 200, 1e-4);
+    cusp::identity_operator<float, cusp::device_memory> M(A.num_rows, A.num_rows);
+
+    cudaStream_t streams[3];
+    for (int i = 0; i < 3; i++)
+        cudaStreamCreate(&streams[i]);
+
+    // three solves proceed concurrently
+    cusp::krylov::solve_handle solve1 = cusp::krylov::cg_async(A, x1, b1, monitor1, M, streams[0]);
+    cusp::krylov::solve_handle solve2 = cusp::krylov::bicgstab_async(A, x2, b2, monitor2, M, streams[1]);
+    cusp::krylov::solve_handle solve3 = cusp::krylov::gmres_async(A, x3, b3, 50, monitor3, M, streams[2]);
+
+    ASSERT_EQUAL(solve1.valid(), true);
+
+    // the calling thread keeps its stream
+    ASSERT_EQUAL(cusp::current_stream() == 0, true);
+
+    solve1.wait();
+    solve2.wait();
+    solve3.wait();
+
+    ASSERT_EQUAL(solve1.ready(), true);
+    ASSERT_EQUAL(solve1.converged(), true);
+    ASSERT_EQUAL(solve1.iteration_count(), monitor1.iteration_count());
+    ASSERT_EQUAL(solve2.converged(), true);
+    ASSERT_EQUAL(solve3.converged(), true);
+
+    ASSERT_EQUAL(solved(A, x1, b1, 1e-4), true);
+    ASSERT_EQUAL(solved(A, x2, b2, 1e-4), true);
+    ASSERT_EQUAL(solved(A, x3, b3, 1e-4), true);
+
+    // copies refer to the same solve
+    cusp::krylov::solve_handle copy = solve1;
+    ASSERT_EQUAL(copy.iteration_count(), solve1.iteration_count());
+
+    for (int i = 0; i < 3; i++)
+        cudaStreamDestroy(streams[i]);
+}
+DECLARE_UNITTEST(TestKrylovAsync);
+
+void TestKrylovAsyncException(void)
+{
+    typedef cusp::array1d<float, cusp::device_memory> Array;
+
+    cusp::csr_matrix<int, float, cusp::device_memory> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    Array x(A.num_rows, 0.0f), b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 100, 1e-4);
+    failing_preconditioner<float, cusp::device_memory> M(A.num_rows);
+
+    cusp::krylov::solve_handle solve = cusp::krylov::cg_async(A, x, b, monitor, M, 0);
+
+    ASSERT_THROWS(solve.wait(), cusp::runtime_exception);
+    ASSERT_EQUAL(solve.ready(), true);
+
+    // a handle without a solve
+    cusp::krylov::solve_handle empty;
+    ASSERT_EQUAL(empty.valid(), false);
+    ASSERT_EQUAL(empty.ready(), true);
+    empty.wait();
+}
+DECLARE_UNITTEST(TestKrylovAsyncException);
@@ -0,0 +1,98 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/eigen/lanczos.h>
+
+#include <cmath>
+
+// ||A x - lambda x|| of each eigenpair
+template <typename Matrix, typename Array1d, typename Array2d>
+float max_eigen_residual(const Matrix& A, const Array1d& S, const Array2d& V)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> H(A);
+    cusp::array2d<float, cusp::host_memory, cusp::column_major> X(V);
+
+    float max_residual = 0;
+
+    for (size_t j = 0; j < X.num_cols; j++)
+    {
+        cusp::array1d<float, cusp::host_memory> x(X.num_rows);
+        cusp::array1d<float, cusp::host_memory> y(X.num_rows);
+
+        for (size_t i = 0; i < X.num_rows; i++)
+            x[i] = X(i,j);
+
+        cusp::multiply(H, x, y);
+        cusp::blas::axpy(x, y, -float(S[j]));
+
+        max_residual = std::max(max_residual, cusp::blas::nrm2(y) / cusp::blas::nrm2(x));
+    }
+
+    return max_residual;
+}
+
+template <class MemorySpace>
+void TestLanczosEigenpairs(void)
+{
+    // 1d Poisson problem, with eigenvalues 4 - 2 cos(i pi / (N + 1))
+    const size_t N = 50;
+
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, N, 1);
+
+    const float pi = 3.14159265358979f;
+
+    {
+        cusp::array1d<float, cusp::host_memory> S;
+        cusp::array2d<float, MemorySpace, cusp::column_major> V;
+
+        size_t converged = cusp::eigen::lanczos(A, S, V, 3, cusp::eigen::smallest, 20, 1e-4, 200);
+
+        ASSERT_EQUAL(converged, (size_t) 3);
+        ASSERT_EQUAL(S.size(), (size_t) 3);
+        ASSERT_EQUAL(V.num_rows, N);
+        ASSERT_EQUAL(V.num_cols, (size_t) 3);
+
+        for (size_t i = 0; i < 3; i++)
+            ASSERT_ALMOST_EQUAL(S[i], 4.0f - 2.0f * std::cos((i + 1) * pi / (N + 1)));
+
+        ASSERT_EQUAL(max_eigen_residual(A, S, V) < 1e-2f, true);
+    }
+
+    {
+        cusp::array1d<float, cusp::host_memory> S;
+        cusp::array2d<float, MemorySpace, cusp::column_major> V;
+
+        size_t converged = cusp::eigen::lanczos(A, S, V, 2, cusp::eigen::largest);
+
+        ASSERT_EQUAL(converged, (size_t) 2);
+
+        for (size_t i = 0; i < 2; i++)
+            ASSERT_ALMOST_EQUAL(S[i], 4.0f - 2.0f * std::cos((N - i) * pi / (N + 1)));
+
+        ASSERT_EQUAL(max_eigen_residual(A, S, V) < 1e-2f, true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestLanczosEigenpairs);
+
+template <class MemorySpace>
+void TestLanczosSmallMatrix(void)
+{
+    // the basis spans the whole space
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 3, 1);
+
+    cusp::array1d<float, cusp::host_memory> S;
+    cusp::array2d<float, MemorySpace, cusp::column_major> V;
+
+    size_t converged = cusp::eigen::lanczos(A, S, V, 3, cusp::eigen::largest);
+
+    ASSERT_EQUAL(converged, (size_t) 3);
+    ASSERT_ALMOST_EQUAL(S[0], 4.0f + std::sqrt(2.0f));
+    ASSERT_ALMOST_EQUAL(S[1], 4.0f);
+    ASSERT_ALMOST_EQUAL(S[2], 4.0f - std::sqrt(2.0f));
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestLanczosSmallMatrix);
@@ -0,0 +1,116 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/poisson.h>
+#include <cusp/array2d.h>
+#include <cusp/copy.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/precond/diagonal.h>
+#include <cusp/eigen/lobpcg.h>
+#include <cusp/detail/random.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// eigenvalues of the 2d Poisson problem on an n x n grid in ascending order
+std::vector<float> poisson_eigenvalues(size_t n)
+{
+    const double pi = 3.14159265358979;
+
+    std::vector<float> eigenvalues;
+
+    for (size_t i = 1; i <= n; i++)
+        for (size_t j = 1; j <= n; j++)
+            eigenvalues.push_back(4.0 - 2.0 * std::cos(i * pi / (n + 1)) - 2.0 * std::cos(j * pi / (n + 1)));
+
+    std::sort(eigenvalues.begin(), eigenvalues.end());
+
+    return eigenvalues;
+}
+
+template <typename Matrix, typename Array1d, typename Array2d>
+bool eigenpairs_converged(const Matrix& A, const Array1d& S, const Array2d& V, float tolerance)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> H(A);
+    cusp::array2d<float, cusp::host_memory, cusp::column_major> X(V);
+
+    for (size_t j = 0; j < X.num_cols; j++)
+    {
+        cusp::array1d<float, cusp::host_memory> x(X.num_rows);
+        cusp::array1d<float, cusp::host_memory> y(X.num_rows);
+
+        for (size_t i = 0; i < X.num_rows; i++)
+            x[i] = X(i,j);
+
+        cusp::multiply(H, x, y);
+        cusp::blas::axpy(x, y, -float(S[j]));
+
+        if (cusp::blas::nrm2(y) > tolerance * cusp::blas::nrm2(x))
+            return false;
+    }
+
+    return true;
+}
+
+template <class MemorySpace>
+void TestLOBPCGSmallest(void)
+{
+    // the second eigenvalue is double
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array2d<float, MemorySpace, cusp::column_major> X(A.num_rows, 4);
+    cusp::copy(cusp::detail::random_reals<float>(X.values.size()), X.values);
+
+    cusp::precond::diagonal<float, MemorySpace> M(A);
+
+    cusp::array1d<float, cusp::host_memory> S;
+    size_t converged = cusp::eigen::lobpcg(A, S, X, cusp::eigen::smallest, M, 1e-4, 500);
+
+    std::vector<float> expected = poisson_eigenvalues(10);
+
+    ASSERT_EQUAL(converged, (size_t) 4);
+    ASSERT_EQUAL(S.size(), (size_t) 4);
+
+    for (size_t i = 0; i < 4; i++)
+        ASSERT_ALMOST_EQUAL(S[i], expected[i]);
+
+    ASSERT_EQUAL(eigenpairs_converged(A, S, X, 1e-2f), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestLOBPCGSmallest);
+
+template <class MemorySpace>
+void TestLOBPCGLargest(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array2d<float, MemorySpace, cusp::column_major> X(A.num_rows, 3);
+    cusp::copy(cusp::detail::random_reals<float>(X.values.size(), 7), X.values);
+
+    cusp::array1d<float, cusp::host_memory> S;
+    size_t converged = cusp::eigen::lobpcg(A, S, X, cusp::eigen::largest);
+
+    std::vector<float> expected = poisson_eigenvalues(10);
+
+    ASSERT_EQUAL(converged, (size_t) 3);
+
+    for (size_t i = 0; i < 3; i++)
+        ASSERT_ALMOST_EQUAL(S[i], expected[expected.size() - 1 - i]);
+
+    ASSERT_EQUAL(eigenpairs_converged(A, S, X, 1e-2f), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestLOBPCGLargest);
+
+void TestLOBPCGDependentStartingVectors(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 4, 4);
+
+    cusp::array2d<float, cusp::host_memory, cusp::column_major> X(A.num_rows, 2, 1.0f);
+    cusp::array1d<float, cusp::host_memory> S;
+
+    ASSERT_THROWS(cusp::eigen::lobpcg(A, S, X, cusp::eigen::smallest), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestLOBPCGDependentStartingVectors);
@@ -65,3 +65,97 @@ void TestLUSolver(void)
 }
 DECLARE_UNITTEST(TestLUSolver);
 
+
+template <class MemorySpace>
+void TestLUSolverMemorySpace(void)
+{
+    cusp::array2d<float, cusp::host_memory> A(4,4);
+    A(0,0) = 0.83228434;  A(0,1) = 0.41106598;  A(0,2) = 0.72609841;  A(0,3) = 0.80428486;
+    A(1,0) = 0.00890590;  A(1,1) = 0.29940800;  A(1,2) = 0.60630740;  A(1,3) = 0.33654542;
+    A(2,0) = 0.22525064;  A(2,1) = 0.93054253;  A(2,2) = 0.37939225;  A(2,3) = 0.16235888;
+    A(3,0) = 0.83911960;  A(3,1) = 0.21176293;  A(3,2) = 0.21010691;  A(3,3) = 0.52911885;
+
+    cusp::array1d<float, MemorySpace> b(4);
+    b[0] = 1.31699541;
+    b[1] = 0.87768331;
+    b[2] = 1.18994714;
+    b[3] = 0.61914723;
+
+    cusp::array1d<float, MemorySpace> x(4, 0.0f);
+
+    cusp::detail::lu_solver<float, MemorySpace> lu(A);
+    lu(b, x);
+
+    ASSERT_EQUAL(std::fabs(0.21713221 - x[0]) < 1e-4, true);
+    ASSERT_EQUAL(std::fabs(0.80528582 - x[1]) < 1e-4, true);
+    ASSERT_EQUAL(std::fabs(0.98416811 - x[2]) < 1e-4, true);
+    ASSERT_EQUAL(std::fabs(0.11271028 - x[3]) < 1e-4, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestLUSolverMemorySpace);
+
+void TestBlockedLUFactor(void)
+{
+    // larger than one panel so that the trailing updates are exercised
+    const int n = 150;
+
+    cusp::array2d<double, cusp::host_memory> A(n, n);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            A(i,j) = (i == j) ? 4.0 : 1.0 / (1.0 + ((3 * i + 7 * j) % 11));
+
+    cusp::array1d<double, cusp::host_memory> x_true(n);
+    for (int i = 0; i < n; i++)
+        x_true[i] = 1.0 + (i % 5);
+
+    cusp::array1d<double, cusp::host_memory> b(n, 0.0);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            b[i] += A(i,j) * x_true[j];
+
+    cusp::array2d<double, cusp::host_memory> LU(A);
+    cusp::array1d<int, cusp::host_memory>    pivot(n);
+    cusp::array1d<double, cusp::host_memory> x(n);
+
+    ASSERT_EQUAL(cusp::detail::lu_factor(LU, pivot), 0);
+    cusp::detail::lu_solve(LU, pivot, b, x);
+
+    for (int i = 0; i < n; i++)
+        ASSERT_EQUAL(std::fabs(x[i] - x_true[i]) < 1e-10, true);
+}
+DECLARE_UNITTEST(TestBlockedLUFactor);
+
+void TestCholeskyFactorAndSolve(void)
+{
+    const int n = 100;
+
+    // symmetric positive definite (diagonally dominant)
+    cusp::array2d<double, cusp::host_memory> A(n, n);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            A(i,j) = (i == j) ? double(n) : 1.0 / (1.0 + i + j);
+
+    cusp::array1d<double, cusp::host_memory> b(n, 1.0);
+    cusp::array1d<double, cusp::host_memory> x(n);
+
+    cusp::array2d<double, cusp::host_memory> L(A);
+    ASSERT_EQUAL(cusp::detail::cholesky_factor(L), 0);
+    ASSERT_EQUAL(L(0,1), 0.0);
+
+    cusp::detail::cholesky_solve(L, b, x);
+
+    // check A x = b
+    for (int i = 0; i < n; i++)
+    {
+        double sum = 0.0;
+        for (int j = 0; j < n; j++)
+            sum += A(i,j) * x[j];
+        ASSERT_EQUAL(std::fabs(sum - 1.0) < 1e-10, true);
+    }
+
+    // an indefinite matrix is rejected
+    cusp::array2d<double, cusp::host_memory> B(2, 2);
+    B(0,0) = 1.0; B(0,1) = 2.0;
+    B(1,0) = 2.0; B(1,1) = 1.0;
+    ASSERT_EQUAL(cusp::detail::cholesky_factor(B), -1);
+}
+DECLARE_UNITTEST(TestCholeskyFactorAndSolve);
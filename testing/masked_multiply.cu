@@ -0,0 +1,145 @@
+#include <unittest/unittest.h>
+
+#include <cusp/masked_multiply.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/multiply.h>
+
+#include <cusp/gallery/poisson.h>
+
+template <typename Matrix>
+void TestMaskedMultiplyVector(void)
+{
+    typedef typename Matrix::memory_space MemorySpace;
+
+    cusp::csr_matrix<int, float, cusp::host_memory> P;
+    cusp::gallery::poisson5pt(P, 5, 4);
+
+    Matrix A(P);
+
+    cusp::array1d<float, MemorySpace> x(A.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 7) - 3.0f;
+
+    cusp::array1d<float, MemorySpace> y(A.num_rows);
+    cusp::multiply(A, x, y);
+
+    cusp::array1d<float, cusp::host_memory> expected(y);
+
+    // every third row
+    cusp::array1d<bool, MemorySpace> active(A.num_rows, false);
+    for (size_t i = 0; i < A.num_rows; i += 3)
+        active[i] = true;
+
+    {
+        cusp::array1d<float, MemorySpace> z(A.num_rows, -1.0f);
+        cusp::masked_multiply(A, x, z, active);
+
+        for (size_t i = 0; i < A.num_rows; i++)
+            ASSERT_EQUAL(z[i], i % 3 == 0 ? expected[i] : -1.0f);
+    }
+
+    {
+        cusp::array1d<int, MemorySpace> rows(3);
+        rows[0] = 7; rows[1] = 2; rows[2] = 19;
+
+        cusp::array1d<float, MemorySpace> z(A.num_rows, -1.0f);
+        cusp::masked_multiply(A, x, z, rows);
+
+        for (size_t i = 0; i < A.num_rows; i++)
+            ASSERT_EQUAL(z[i], (i == 2 || i == 7 || i == 19) ? expected[i] : -1.0f);
+    }
+
+    {
+        cusp::array1d<bool, MemorySpace> short_mask(A.num_rows - 1, true);
+        cusp::array1d<float, MemorySpace> z(A.num_rows);
+
+        ASSERT_THROWS(cusp::masked_multiply(A, x, z, short_mask), cusp::invalid_input_exception);
+    }
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestMaskedMultiplyVector);
+
+template <class MemorySpace>
+void TestMaskedMultiplyTriangles(void)
+{
+    // lower triangle of the complete graph on 4 vertices
+    cusp::coo_matrix<int, float, cusp::host_memory> L(4, 4, 6);
+    L.row_indices[0] = 1; L.column_indices[0] = 0;
+    L.row_indices[1] = 2; L.column_indices[1] = 0;
+    L.row_indices[2] = 2; L.column_indices[2] = 1;
+    L.row_indices[3] = 3; L.column_indices[3] = 0;
+    L.row_indices[4] = 3; L.column_indices[4] = 1;
+    L.row_indices[5] = 3; L.column_indices[5] = 2;
+    for (size_t n = 0; n < 6; n++)
+        L.values[n] = 1.0f;
+
+    cusp::coo_matrix<int, float, cusp::host_memory> Lt(4, 4, 6);
+    for (size_t n = 0; n < 6; n++)
+    {
+        Lt.row_indices[n]    = L.column_indices[n];
+        Lt.column_indices[n] = L.row_indices[n];
+        Lt.values[n]         = 1.0f;
+    }
+    Lt.sort_by_row_and_column();
+
+    cusp::csr_matrix<int, float, MemorySpace> A(L);
+    cusp::csr_matrix<int, float, MemorySpace> B(Lt);
+
+    // C = L .* (L L^T), the entries of the edges that close a triangle
+    cusp::coo_matrix<int, float, MemorySpace> C;
+    cusp::masked_multiply(A, B, C, A);
+
+    cusp::coo_matrix<int, float, cusp::host_memory> H(C);
+
+    ASSERT_EQUAL(H.num_rows,    (size_t) 4);
+    ASSERT_EQUAL(H.num_cols,    (size_t) 4);
+    ASSERT_EQUAL(H.num_entries, (size_t) 3);
+    ASSERT_EQUAL(H.row_indices[0], 2); ASSERT_EQUAL(H.column_indices[0], 1); ASSERT_EQUAL(H.values[0], 1.0f);
+    ASSERT_EQUAL(H.row_indices[1], 3); ASSERT_EQUAL(H.column_indices[1], 1); ASSERT_EQUAL(H.values[1], 1.0f);
+    ASSERT_EQUAL(H.row_indices[2], 3); ASSERT_EQUAL(H.column_indices[2], 2); ASSERT_EQUAL(H.values[2], 2.0f);
+
+    cusp::csr_matrix<int, float, MemorySpace> M(3, 4, 0);
+    ASSERT_THROWS(cusp::masked_multiply(A, B, C, M), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMaskedMultiplyTriangles);
+
+template <typename Matrix>
+void TestMaskedMultiplyMatrix(void)
+{
+    typedef typename Matrix::memory_space MemorySpace;
+
+    cusp::csr_matrix<int, float, cusp::host_memory> P;
+    cusp::gallery::poisson5pt(P, 4, 4);
+
+    Matrix A(P);
+    Matrix B(P);
+
+    // mask by the pattern of A
+    cusp::coo_matrix<int, float, MemorySpace> C;
+    cusp::masked_multiply(A, B, C, A);
+
+    cusp::array2d<float, cusp::host_memory> AB;
+    {
+        cusp::csr_matrix<int, float, MemorySpace> D;
+        cusp::multiply(A, B, D);
+        AB = D;
+    }
+
+    cusp::coo_matrix<int, float, cusp::host_memory> H(C);
+    cusp::coo_matrix<int, float, cusp::host_memory> M(P);
+
+    // every entry of the pattern meets a product through the diagonal
+    ASSERT_EQUAL(H.num_entries, M.num_entries);
+    ASSERT_EQUAL(H.row_indices,    M.row_indices);
+    ASSERT_EQUAL(H.column_indices, M.column_indices);
+
+    for (size_t n = 0; n < H.num_entries; n++)
+        ASSERT_EQUAL(H.values[n], AB(H.row_indices[n], H.column_indices[n]));
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestMaskedMultiplyMatrix);
@@ -2,11 +2,19 @@
 
 #include <cusp/io/matrix_market.h>
 
+#include <cusp/communicator.h>
+#include <cusp/distribution.h>
+
 #include <cusp/coo_matrix.h>
 #include <cusp/csr_matrix.h>
+#include <cusp/symmetric_csr_matrix.h>
 #include <cusp/array2d.h>
+#include <cusp/gallery/poisson.h>
 
+#include <sstream>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 const char random_file_name[] = "test_93298409283221.mtx";
 
@@ -144,6 +152,57 @@ void TestReadMatrixMarketFileCoordinatePatternSymmetric(void)
 }
 DECLARE_UNITTEST(TestReadMatrixMarketFileCoordinatePatternSymmetric);
 
+void TestReadMatrixMarketFilePartitioned(void)
+{
+  int device = 0;
+  cudaGetDevice(&device);
+
+  const char * filenames[] = {"data/test/coordinate_real_general.mtx",
+                              "data/test/coordinate_pattern_symmetric.mtx"};
+
+  for (size_t n = 0; n < 2; n++)
+  {
+    cusp::coo_matrix<int, float, cusp::host_memory> expected;
+    cusp::io::read_matrix_market_file(expected, filenames[n]);
+
+    // the ranges of a single process hold all rows
+    std::vector<size_t> offsets;
+    offsets.push_back(0);
+    offsets.push_back(expected.num_rows / 2);
+    offsets.push_back(expected.num_rows);
+
+    cusp::distribution d(std::vector<int>(2, device), offsets);
+
+    cusp::coo_matrix<int, float, cusp::host_memory> coo;
+    cusp::io::read_matrix_market_file(coo, filenames[n], d);
+
+    ASSERT_EQUAL(coo.num_rows,       expected.num_rows);
+    ASSERT_EQUAL(coo.num_cols,       expected.num_cols);
+    ASSERT_EQUAL(coo.row_indices,    expected.row_indices);
+    ASSERT_EQUAL(coo.column_indices, expected.column_indices);
+    ASSERT_EQUAL(coo.values,         expected.values);
+
+    // split the rows across the processes of a communicator
+    cusp::csr_matrix<int, float, cusp::host_memory> csr;
+    cusp::distribution e;
+    cusp::io::read_matrix_market_file(csr, e, filenames[n], cusp::communicator(), device);
+
+    ASSERT_EQUAL(e.num_partitions(), (size_t) 1);
+    ASSERT_EQUAL(e.size(),           expected.num_rows);
+    ASSERT_EQUAL(csr.num_entries,    expected.num_entries);
+
+    // the rows must match the distribution
+    cusp::distribution f(expected.num_rows + 1, std::vector<int>(1, device));
+    ASSERT_THROWS(cusp::io::read_matrix_market_file(coo, filenames[n], f), cusp::invalid_input_exception);
+  }
+
+  // dense files are not read by rows
+  cusp::coo_matrix<int, float, cusp::host_memory> dense;
+  cusp::distribution g(4, std::vector<int>(1, device));
+  ASSERT_THROWS(cusp::io::read_matrix_market_file(dense, "data/test/array_real_general.mtx", g), cusp::io_exception);
+}
+DECLARE_UNITTEST(TestReadMatrixMarketFilePartitioned);
+
 void TestReadMatrixMarketFileArrayRealGeneral(void)
 {
   // load matrix
@@ -186,6 +245,34 @@ void TestReadMatrixMarketFileToCsrMatrix(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestReadMatrixMarketFileToCsrMatrix);
 
+template <typename MemorySpace>
+void TestReadMatrixMarketFileToSymmetricCsrMatrix(void)
+{
+  // load matrix, only the 7 entries of the file are stored
+  cusp::symmetric_csr_matrix<int, float, MemorySpace> sym;
+  cusp::io::read_matrix_market_file(sym, "data/test/coordinate_pattern_symmetric.mtx");
+
+  ASSERT_EQUAL(sym.num_entries,          9);
+  ASSERT_EQUAL(sym.num_stored_entries(), 7);
+
+  // convert to array2d
+  cusp::array2d<float, cusp::host_memory> D(sym);
+
+  // expected result
+  cusp::array2d<float, cusp::host_memory> E(5, 5);
+  E(0,0) =  1.000e+00; E(0,1) =  0.000e+00; E(0,2) =  0.000e+00; E(0,3) =  0.000e+00; E(0,4) =  0.000e+00;
+  E(1,0) =  0.000e+00; E(1,1) =  1.000e+00; E(1,2) =  0.000e+00; E(1,3) =  1.000e+00; E(1,4) =  0.000e+00;
+  E(2,0) =  0.000e+00; E(2,1) =  0.000e+00; E(2,2) =  1.000e+00; E(2,3) =  0.000e+00; E(2,4) =  0.000e+00;
+  E(3,0) =  0.000e+00; E(3,1) =  1.000e+00; E(3,2) =  0.000e+00; E(3,3) =  1.000e+00; E(3,4) =  1.000e+00;
+  E(4,0) =  0.000e+00; E(4,1) =  0.000e+00; E(4,2) =  0.000e+00; E(4,3) =  1.000e+00; E(4,4) =  1.000e+00;
+
+  ASSERT_EQUAL(D == E, true);
+
+  // general files are checked for symmetry
+  ASSERT_THROWS(cusp::io::read_matrix_market_file(sym, "data/test/coordinate_real_general.mtx"), cusp::format_conversion_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestReadMatrixMarketFileToSymmetricCsrMatrix);
+
 template <typename MemorySpace>
 void TestWriteMatrixMarketFileCoordinateRealGeneral(void)
 {
@@ -240,3 +327,199 @@ void TestWriteMatrixMarketFileCoordinateComplexGeneral(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestWriteMatrixMarketFileCoordinateComplexGeneral);
 
+
+void TestMatrixMarketParseDouble(void)
+{
+  const char * numbers[] = {"0", "1", "-2.5", "+7.", ".125", "1e-3", "-0.1", "3.14159265358979323846",
+                            "6.02214076e23", "1.7976931348623157e308", "4.9e-324", "123456789012345678901234", "1E5"};
+
+  for (size_t n = 0; n < sizeof(numbers) / sizeof(numbers[0]); n++)
+  {
+    const char * p   = numbers[n];
+    const char * end = p + strlen(p);
+
+    double value = -1;
+
+    ASSERT_EQUAL(cusp::io::detail::parse_double(p, end, value), true);
+    ASSERT_EQUAL(value == strtod(numbers[n], 0), true);
+    ASSERT_EQUAL(p == end, true);
+  }
+
+  const char invalid[] = "x1";
+  const char * p = invalid;
+  double value;
+
+  ASSERT_EQUAL(cusp::io::detail::parse_double(p, invalid + 2, value), false);
+}
+DECLARE_UNITTEST(TestMatrixMarketParseDouble);
+
+void TestMatrixMarketFormatDouble(void)
+{
+  const double numbers[] = {0.0, -0.0, 1.0, -2.5, 0.125, 1e-3, 1e-5, -0.1, 3.14159265358979323846,
+                            6.02214076e23, 1.7976931348623157e308, 4.9e-324, 123456.5, 999999.95,
+                            0.00012345678, 1e15, 1e16, 2.5, 0.5, 1.0 / 3.0};
+
+  // as printf formats them, including ties and carries into the exponent
+  for (size_t n = 0; n < sizeof(numbers) / sizeof(numbers[0]); n++)
+  {
+    for (int precision = 0; precision <= 17; precision++)
+    {
+      std::string formatted;
+      cusp::io::detail::append_floating(formatted, numbers[n], precision);
+
+      char expected[64];
+      snprintf(expected, sizeof(expected), "%.*g", precision, numbers[n]);
+
+      ASSERT_EQUAL(formatted, std::string(expected));
+    }
+  }
+}
+DECLARE_UNITTEST(TestMatrixMarketFormatDouble);
+
+void TestReadMatrixMarketStreamCoordinateLayout(void)
+{
+  // comments, blank lines and CRLF line endings between the entries
+  std::stringstream input;
+  input << "%%MatrixMarket matrix coordinate real general\n"
+        << "% comment\n"
+        << "3 3 4\r\n"
+        << "1 1 1.5\r\n"
+        << "\n"
+        << "  2\t3  -2e1\n"
+        << "% another comment\n"
+        << "3 1 .25\n"
+        << "3 3 4";
+
+  cusp::coo_matrix<int, double, cusp::host_memory> coo;
+  cusp::io::read_matrix_market_stream(coo, input);
+
+  cusp::array2d<double, cusp::host_memory> D(coo);
+
+  ASSERT_EQUAL(coo.num_entries, (size_t) 4);
+  ASSERT_EQUAL(D(0,0),   1.5);
+  ASSERT_EQUAL(D(1,2), -20.0);
+  ASSERT_EQUAL(D(2,0),  0.25);
+  ASSERT_EQUAL(D(2,2),   4.0);
+
+  // missing entries and malformed entries
+  std::stringstream truncated("%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1.0\n");
+  ASSERT_THROWS(cusp::io::read_matrix_market_stream(coo, truncated), cusp::io_exception);
+
+  std::stringstream malformed("%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1.0\n2 x 1.0\n");
+  ASSERT_THROWS(cusp::io::read_matrix_market_stream(coo, malformed), cusp::io_exception);
+}
+DECLARE_UNITTEST(TestReadMatrixMarketStreamCoordinateLayout);
+
+void TestReadWriteMatrixMarketFileLarge(void)
+{
+  // large enough to be parsed and formatted in several blocks
+  cusp::coo_matrix<int, double, cusp::host_memory> A;
+  cusp::gallery::poisson5pt(A, 300, 300);
+
+  for (size_t n = 0; n < A.num_entries; n++)
+    A.values[n] = double(int(n % 1000) - 500) / 8;
+
+  cusp::io::write_matrix_market_file(A, random_file_name);
+
+  cusp::coo_matrix<int, double, cusp::host_memory> B;
+  cusp::io::read_matrix_market_file(B, random_file_name);
+
+  remove(random_file_name);
+
+  ASSERT_EQUAL(B.num_rows,       A.num_rows);
+  ASSERT_EQUAL(B.num_cols,       A.num_cols);
+  ASSERT_EQUAL(B.row_indices,    A.row_indices);
+  ASSERT_EQUAL(B.column_indices, A.column_indices);
+  ASSERT_EQUAL(B.values,         A.values);
+}
+DECLARE_UNITTEST(TestReadWriteMatrixMarketFileLarge);
+
+void TestWriteMatrixMarketStreamFromDeviceLarge(void)
+{
+  // large enough to be staged from the device in several chunks
+  cusp::coo_matrix<int, double, cusp::host_memory> A;
+  cusp::gallery::poisson5pt(A, 1000, 1000);
+
+  for (size_t n = 0; n < A.num_entries; n++)
+    A.values[n] = double(int(n % 1000) - 500) / 7;
+
+  cusp::csr_matrix<int, double, cusp::device_memory> B(A);
+
+  std::stringstream host_output;
+  std::stringstream device_output;
+  host_output.precision(17);
+  device_output.precision(17);
+
+  cusp::io::write_matrix_market_stream(A, host_output);
+  cusp::io::write_matrix_market_stream(B, device_output);
+
+  ASSERT_EQUAL(device_output.str() == host_output.str(), true);
+
+  cusp::coo_matrix<int, double, cusp::host_memory> C;
+  cusp::io::read_matrix_market_stream(C, device_output);
+
+  ASSERT_EQUAL(C.row_indices,    A.row_indices);
+  ASSERT_EQUAL(C.column_indices, A.column_indices);
+  ASSERT_EQUAL(C.values,         A.values);
+}
+DECLARE_UNITTEST(TestWriteMatrixMarketStreamFromDeviceLarge);
+
+void TestReadMatrixMarketStreamToDevice(void)
+{
+  // symmetric entries and the layout of the host reader
+  const std::string contents = "%%MatrixMarket matrix coordinate pattern symmetric\n"
+                               "% comment\n"
+                               "4 4 5\r\n"
+                               "1 1\n"
+                               "3 1\n"
+                               "\n"
+                               "  4\t2\n"
+                               "3 3\n"
+                               "4 3";
+
+  std::stringstream host_input(contents);
+  std::stringstream device_input(contents);
+
+  cusp::coo_matrix<int, float, cusp::host_memory>   A;
+  cusp::coo_matrix<int, float, cusp::device_memory> B;
+  cusp::io::read_matrix_market_stream(A, host_input);
+  cusp::io::read_matrix_market_stream(B, device_input);
+
+  ASSERT_EQUAL(B.num_entries,    (size_t) 8);
+  ASSERT_EQUAL(B.row_indices,    A.row_indices);
+  ASSERT_EQUAL(B.column_indices, A.column_indices);
+  ASSERT_EQUAL(B.values,         A.values);
+
+  std::stringstream truncated("%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1.0\n");
+  ASSERT_THROWS(cusp::io::read_matrix_market_stream(B, truncated), cusp::io_exception);
+
+  std::stringstream out_of_range("%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1.0\n3 1 1.0\n");
+  ASSERT_THROWS(cusp::io::read_matrix_market_stream(B, out_of_range), cusp::io_exception);
+}
+DECLARE_UNITTEST(TestReadMatrixMarketStreamToDevice);
+
+void TestReadMatrixMarketFileToDeviceLarge(void)
+{
+  // large enough to be copied to the device in several chunks
+  cusp::coo_matrix<int, double, cusp::host_memory> A;
+  cusp::gallery::poisson5pt(A, 1000, 1000);
+
+  for (size_t n = 0; n < A.num_entries; n++)
+    A.values[n] = double(int(n % 1000) - 500) / 8;
+
+  cusp::io::write_matrix_market_file(A, random_file_name);
+
+  cusp::csr_matrix<int, double, cusp::device_memory> B;
+  cusp::io::read_matrix_market_file(B, random_file_name);
+
+  remove(random_file_name);
+
+  cusp::csr_matrix<int, double, cusp::host_memory> C(A);
+
+  ASSERT_EQUAL(B.num_rows,       C.num_rows);
+  ASSERT_EQUAL(B.num_cols,       C.num_cols);
+  ASSERT_EQUAL(B.row_offsets,    C.row_offsets);
+  ASSERT_EQUAL(B.column_indices, C.column_indices);
+  ASSERT_EQUAL(B.values,         C.values);
+}
+DECLARE_UNITTEST(TestReadMatrixMarketFileToDeviceLarge);
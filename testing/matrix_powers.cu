@@ -0,0 +1,83 @@
+#include <unittest/unittest.h>
+
+#include <cusp/matrix_powers.h>
+
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/gallery/random.h>
+
+template <typename Matrix>
+void CompareMatrixPowers(const Matrix& A, const size_t s)
+{
+    typedef typename Matrix::value_type   ValueType;
+    typedef typename Matrix::memory_space MemorySpace;
+
+    cusp::array1d<ValueType, MemorySpace> x(A.num_rows);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = ValueType((i % 7) + 1) / ValueType(7);
+
+    cusp::array2d<ValueType, MemorySpace, cusp::column_major> V;
+    cusp::matrix_powers(A, x, s, V);
+
+    ASSERT_EQUAL(V.num_rows, A.num_rows);
+    ASSERT_EQUAL(V.num_cols, s + 1);
+
+    cusp::array1d<ValueType, MemorySpace> expected(x);
+    cusp::array1d<ValueType, MemorySpace> column(A.num_rows);
+
+    for (size_t k = 0; k <= s; k++)
+    {
+        thrust::copy(V.column(k).begin(), V.column(k).end(), column.begin());
+        ASSERT_ALMOST_EQUAL(column, expected);
+
+        cusp::array1d<ValueType, MemorySpace> y(A.num_rows);
+        cusp::multiply(A, expected, y);
+        expected.swap(y);
+    }
+}
+
+template <class MemorySpace>
+void TestMatrixPowers(void)
+{
+    // banded matrices spanning several tiles
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 30);
+
+    CompareMatrixPowers(A, 0);
+    CompareMatrixPowers(A, 1);
+    CompareMatrixPowers(A, 4);
+
+    cusp::dia_matrix<int, float, MemorySpace> B(A);
+    CompareMatrixPowers(B, 4);
+
+    // ghost zones wider than a tile use one product per step
+    CompareMatrixPowers(A, 15);
+
+    cusp::coo_matrix<int, float, MemorySpace> C(A);
+    CompareMatrixPowers(C, 3);
+
+    cusp::csr_matrix<int, float, MemorySpace> R;
+    cusp::gallery::random(300, 300, 1200, R);
+    CompareMatrixPowers(R, 3);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMatrixPowers);
+
+template <class MemorySpace>
+void TestMatrixPowersInvalidInput(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A(3, 4, 0);
+    cusp::array1d<float, MemorySpace> x(4, 1.0f);
+    cusp::array2d<float, MemorySpace, cusp::column_major> V;
+
+    ASSERT_THROWS(cusp::matrix_powers(A, x, 2, V), cusp::invalid_input_exception);
+
+    cusp::csr_matrix<int, float, MemorySpace> B(3, 3, 0);
+
+    ASSERT_THROWS(cusp::matrix_powers(B, x, 2, V), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMatrixPowersInvalidInput);
+
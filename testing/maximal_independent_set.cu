@@ -153,3 +153,40 @@ void TestMaximalIndependentSet(void)
 }
 DECLARE_SPARSE_MATRIX_UNITTEST(TestMaximalIndependentSet);
 
+
+template <class MemorySpace>
+void TestMaximalIndependentSetFrontier(void)
+{
+    cusp::coo_matrix<int,float,MemorySpace> A;
+    cusp::gallery::poisson9pt(A, 67, 61);
+    thrust::fill(A.values.begin(), A.values.end(), 1.0f);
+
+    cusp::csr_matrix<int,float,MemorySpace> B(A);
+
+    cusp::coo_matrix<int,float,MemorySpace> A2;
+    cusp::multiply(A, A, A2);
+
+    for (size_t k = 1; k <= 3; k++)
+    {
+        cusp::array1d<int,MemorySpace> coo_stencil;
+        cusp::array1d<int,MemorySpace> csr_stencil;
+
+        size_t coo_nodes = cusp::graph::maximal_independent_set(A, coo_stencil, k);
+        size_t csr_nodes = cusp::graph::maximal_independent_set(B, csr_stencil, k);
+
+        ASSERT_EQUAL(thrust::count(coo_stencil.begin(), coo_stencil.end(), 1), coo_nodes);
+        ASSERT_EQUAL(thrust::count(csr_stencil.begin(), csr_stencil.end(), 1), csr_nodes);
+
+        if (k == 1)
+        {
+            ASSERT_EQUAL(is_valid_mis(A, coo_stencil), true);
+            ASSERT_EQUAL(is_valid_mis(A, csr_stencil), true);
+        }
+        else if (k == 2)
+        {
+            ASSERT_EQUAL(is_valid_mis(A2, coo_stencil), true);
+            ASSERT_EQUAL(is_valid_mis(A2, csr_stencil), true);
+        }
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMaximalIndependentSetFrontier);
@@ -33,3 +33,125 @@ void TestMinimumSpace(void)
 }
 DECLARE_UNITTEST(TestMinimumSpace);
 
+
+#include <cusp/array1d.h>
+#include <cusp/copy.h>
+#include <cusp/stream.h>
+
+void TestPinnedMemory(void)
+{
+  typedef cusp::array1d<float, cusp::pinned_memory> PinnedArray;
+
+  // pinned arrays are host arrays
+  ASSERT_EQUAL(((bool) thrust::detail::is_same<PinnedArray::memory_space, cusp::host_memory>::value), true);
+
+  PinnedArray x(5, 1.0f);
+  x[2] = 3.0f;
+
+  cusp::array1d<float, cusp::host_memory> y(x);
+  ASSERT_EQUAL(y[1], 1.0f);
+  ASSERT_EQUAL(y[2], 3.0f);
+
+  x.resize(0);
+  x.resize(1000, 2.0f);
+  ASSERT_EQUAL(x[999], 2.0f);
+}
+DECLARE_UNITTEST(TestPinnedMemory);
+
+void TestCopyAsync(void)
+{
+  cudaStream_t stream;
+  cudaStreamCreate(&stream);
+
+  cusp::array1d<float, cusp::pinned_memory> h(100);
+  for (size_t i = 0; i < h.size(); i++)
+    h[i] = float(i);
+
+  cusp::array1d<float, cusp::device_memory> d1(100), d2(100);
+  cusp::array1d<float, cusp::pinned_memory> result(100, -1.0f);
+
+  // host -> device -> device -> host in stream order
+  cusp::copy_async(h, d1, stream);
+  cusp::copy_async(d1, d2, stream);
+  cusp::copy_async(d2, result, stream);
+  cudaStreamSynchronize(stream);
+
+  ASSERT_EQUAL(result, h);
+
+  // views and pageable memory on the current stream
+  cusp::array1d<float, cusp::host_memory> pageable(50, 0.0f);
+  cusp::copy_async(cusp::make_array1d_view(d2.begin() + 50, d2.end()), pageable);
+  cudaStreamSynchronize(cusp::current_stream());
+
+  ASSERT_EQUAL(pageable[0],  50.0f);
+  ASSERT_EQUAL(pageable[49], 99.0f);
+
+  // destinations are not resized
+  cusp::array1d<float, cusp::device_memory> small(10);
+  ASSERT_THROWS(cusp::copy_async(h, small, stream), cusp::invalid_input_exception);
+
+  cudaStreamDestroy(stream);
+}
+DECLARE_UNITTEST(TestCopyAsync);
+
+
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/prefetch.h>
+#include <cusp/gallery/poisson.h>
+
+void TestManagedMemory(void)
+{
+  typedef cusp::array1d<float, cusp::managed_memory> ManagedArray;
+
+  // managed arrays are device arrays
+  ASSERT_EQUAL(((bool) thrust::detail::is_same<ManagedArray::memory_space, cusp::device_memory>::value), true);
+  ASSERT_EQUAL(((bool) cusp::detail::is_managed<ManagedArray>::value), true);
+  ASSERT_EQUAL(((bool) cusp::detail::is_managed< cusp::array1d<float, cusp::device_memory> >::value), false);
+  ASSERT_EQUAL(((bool) cusp::detail::is_managed< ManagedArray::view >::value), false);
+
+  ManagedArray x(5, 1.0f);
+  x[2] = 3.0f;
+
+  cusp::array1d<float, cusp::host_memory> y(x);
+  ASSERT_EQUAL(y[1], 1.0f);
+  ASSERT_EQUAL(y[2], 3.0f);
+
+  x.resize(0);
+  x.resize(1000, 2.0f);
+  ASSERT_EQUAL(x[999], 2.0f);
+  ASSERT_EQUAL(cusp::detail::managed_bytes(x), 1000 * sizeof(float));
+
+  // hints never change the contents
+  cusp::prefetch(x);
+  cusp::prefetch(x, cudaCpuDeviceId);
+  cusp::advise_read_mostly(x);
+  cudaDeviceSynchronize();
+  ASSERT_EQUAL(x[0], 2.0f);
+}
+DECLARE_UNITTEST(TestManagedMemory);
+
+void TestManagedMemoryMultiply(void)
+{
+  cusp::csr_matrix<int, float, cusp::device_memory> A;
+  cusp::gallery::poisson5pt(A, 20, 30);
+
+  cusp::csr_matrix<int, float, cusp::managed_memory> M(A);
+  ASSERT_EQUAL(cusp::detail::managed_bytes(M),
+               (A.num_rows + 1 + A.num_entries) * sizeof(int) + A.num_entries * sizeof(float));
+  ASSERT_EQUAL(cusp::detail::fits_device_memory(M), true);
+
+  cusp::array1d<float, cusp::device_memory>  x(A.num_cols);
+  for (size_t i = 0; i < x.size(); i++)
+    x[i] = float(i % 7) - 3.0f;
+
+  cusp::array1d<float, cusp::managed_memory> x_managed(x);
+  cusp::array1d<float, cusp::device_memory>  y(A.num_rows);
+  cusp::array1d<float, cusp::managed_memory> y_managed(A.num_rows);
+
+  cusp::multiply(A, x, y);
+  cusp::multiply(M, x_managed, y_managed);
+
+  ASSERT_ALMOST_EQUAL(y_managed, y);
+}
+DECLARE_UNITTEST(TestManagedMemoryMultiply);
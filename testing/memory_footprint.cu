@@ -0,0 +1,75 @@
+#include <unittest/unittest.h>
+
+#include <cusp/memory_footprint.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/linear_operator.h>
+#include <cusp/caching_allocator.h>
+#include <cusp/gallery/poisson.h>
+
+template <class MemorySpace>
+void TestMemoryFootprint(void)
+{
+    cusp::array1d<float,MemorySpace> x(10);
+    ASSERT_EQUAL(cusp::memory_footprint(x), 10 * sizeof(float));
+
+    // the capacity is kept when an array shrinks
+    x.resize(4);
+    ASSERT_EQUAL(cusp::memory_footprint(x), 10 * sizeof(float));
+
+    cusp::array2d<double,MemorySpace> D(3, 5);
+    ASSERT_EQUAL(cusp::memory_footprint(D), 15 * sizeof(double));
+
+    cusp::csr_matrix<int,float,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+    ASSERT_EQUAL(cusp::memory_footprint(A), (A.num_rows + 1) * sizeof(int) + A.num_entries * (sizeof(int) + sizeof(float)));
+
+    cusp::coo_matrix<int,float,MemorySpace> B(A);
+    ASSERT_EQUAL(cusp::memory_footprint(B), B.num_entries * (2 * sizeof(int) + sizeof(float)));
+
+    cusp::hyb_matrix<int,float,MemorySpace> C(5, 5, 8, 3, 2, 1);
+    ASSERT_EQUAL(cusp::memory_footprint(C), 5 * 2 * (sizeof(int) + sizeof(float)) + 3 * (2 * sizeof(int) + sizeof(float)));
+
+    // views report the storage they refer to
+    typename cusp::array1d<float,MemorySpace>::view v(x);
+    ASSERT_EQUAL(cusp::memory_footprint(v), cusp::memory_footprint(x));
+
+    cusp::linear_operator<float,MemorySpace> L(4, 4);
+    ASSERT_EQUAL(cusp::memory_footprint(L), (size_t) 0);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMemoryFootprint);
+
+void TestDeviceMemoryStatistics(void)
+{
+    const size_t before = cusp::get_device_memory_statistics().bytes_in_use;
+
+    {
+        cusp::array1d<float,cusp::device_memory> x(1000);
+
+        cusp::device_memory_statistics stats = cusp::get_device_memory_statistics();
+        ASSERT_EQUAL(stats.bytes_in_use >= before + 1000 * sizeof(float), true);
+        ASSERT_EQUAL(stats.peak_bytes_in_use >= stats.bytes_in_use, true);
+    }
+
+    ASSERT_EQUAL(cusp::get_device_memory_statistics().bytes_in_use, before);
+
+    // the peak restarts from the memory in use
+    cusp::reset_device_memory_peak();
+    ASSERT_EQUAL(cusp::get_device_memory_statistics().peak_bytes_in_use, before);
+
+    // blocks of the caching allocator count with their size class
+    {
+        cusp::array1d<float,cusp::caching_device_allocator<float> > y(1000);
+        ASSERT_EQUAL(cusp::get_device_memory_statistics().bytes_in_use, before + 4096);
+    }
+
+    cusp::device_memory_statistics stats = cusp::get_device_memory_statistics();
+    ASSERT_EQUAL(stats.bytes_in_use, before);
+    ASSERT_EQUAL(stats.peak_bytes_in_use, before + 4096);
+}
+DECLARE_UNITTEST(TestDeviceMemoryStatistics);
+
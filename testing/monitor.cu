@@ -1,6 +1,9 @@
 #include <unittest/unittest.h>
 
 #include <cusp/monitor.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/cg.h>
 
 template <typename MemorySpace>
 void TestMonitorSimple(void)
@@ -61,3 +64,100 @@ void TestMonitorSimple(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestMonitorSimple);
 
+
+template <typename MemorySpace>
+void TestAsyncMonitorSimple(void)
+{
+    cusp::array1d<float,MemorySpace> b(2, 0);
+    b[0] = 10;
+
+    cusp::array1d<float,MemorySpace> r(b);
+
+    cusp::async_monitor<float> monitor(b, 7, 0.5, 1.0, 3);
+
+    ASSERT_EQUAL(monitor.check_interval(), (size_t) 3);
+    ASSERT_EQUAL(monitor.finished(r), false);
+
+    // the residual is only tested every third iteration
+    r[0] = 2;
+    ++monitor; ASSERT_EQUAL(monitor.finished(r), false);
+    ++monitor; ASSERT_EQUAL(monitor.finished(r), false);
+
+    // converged residuals are detected within two intervals
+    bool finished = false;
+    while (!finished && monitor.iteration_count() < 6)
+    {
+        ++monitor;
+        finished = monitor.finished(r);
+    }
+
+    ASSERT_EQUAL(finished, true);
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(monitor.residual_norm(), 2.0);
+
+    // the final residual is tested when the limit is reached
+    cusp::async_monitor<float> limited(b, 4, 0.0, 1.0, 3);
+    r[0] = 7;
+    limited.finished(r);
+    for (int i = 0; i < 3; i++) { ++limited; limited.finished(r); }
+    r[0] = 5;
+    ++limited;
+
+    ASSERT_EQUAL(limited.finished(r), true);
+    ASSERT_EQUAL(limited.iteration_count(), (size_t) 4);
+    ASSERT_EQUAL(limited.residual_norm(), 5.0);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAsyncMonitorSimple);
+
+template <typename MemorySpace>
+void TestAsyncMonitorSolve(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1);
+    cusp::array1d<float, MemorySpace> x0(A.num_rows, 0);
+    cusp::array1d<float, MemorySpace> x1(A.num_rows, 0);
+
+    cusp::default_monitor<float> monitor(b, 500, 1e-5);
+    cusp::async_monitor<float> async(b, 500, 1e-5, 0, 4);
+
+    cusp::krylov::cg(A, x0, b, monitor);
+    cusp::krylov::cg(A, x1, b, async);
+
+    ASSERT_EQUAL(async.converged(), true);
+    ASSERT_EQUAL(async.iteration_count() >= monitor.iteration_count(), true);
+    ASSERT_EQUAL(async.iteration_count() < monitor.iteration_count() + 2 * async.check_interval(), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestAsyncMonitorSolve);
+
+template <typename MemorySpace>
+void TestHistoryMonitor(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1);
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0);
+
+    cusp::history_monitor<float> monitor(b, 500, 1e-5);
+
+    cusp::krylov::cg(A, x, b, monitor);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+    ASSERT_EQUAL(monitor.history_size(), monitor.iteration_count() + 1);
+
+    cusp::array1d<float, cusp::host_memory> norms;
+    monitor.residual_history(norms);
+
+    ASSERT_EQUAL(norms.size(), monitor.history_size());
+    ASSERT_ALMOST_EQUAL(norms[0], cusp::blas::nrm2(b));
+    ASSERT_EQUAL(*thrust::min_element(norms.begin(), norms.end()) <= monitor.tolerance(), true);
+
+    for (size_t i = 0; i < monitor.history_size(); i++)
+    {
+        ASSERT_EQUAL(monitor.iteration_history()[i], i);
+        ASSERT_EQUAL(monitor.time_history()[i] >= (i ? monitor.time_history()[i - 1] : 0.0), true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestHistoryMonitor);
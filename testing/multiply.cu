@@ -4,7 +4,11 @@
 #define CUSP_USE_TEXTURE_MEMORY
 #endif
 
+#include <cusp/complex.h>
+#include <cusp/copy.h>
 #include <cusp/multiply.h>
+#include <cusp/no_copy.h>
+#include <cusp/transpose.h>
 
 #include <cusp/linear_operator.h>
 #include <cusp/print.h>
@@ -17,6 +21,13 @@
 #include <cusp/dia_matrix.h>
 #include <cusp/ell_matrix.h>
 #include <cusp/hyb_matrix.h>
+#include <cusp/sell_matrix.h>
+
+#include <cusp/detail/device/spmm/coo.h>
+#include <cusp/detail/device/spmv/csr_blocked.h>
+#include <cusp/detail/host/spmv.h>
+#include <cusp/detail/host/spmv_sell.h>
+#include <cusp/detail/operation_cost.h>
 
 /////////////////////////////////////////
 // Sparse Matrix-Matrix Multiplication //
@@ -111,6 +122,139 @@ void TestSparseMatrixMatrixMultiply(void)
 }
 DECLARE_SPARSE_MATRIX_UNITTEST(TestSparseMatrixMatrixMultiply);
 
+template <typename TestMatrix>
+void TestSparseMatrixMatrixMultiplyRowWork(void)
+{
+    // row i of A * B has 48 * (i + 1) intermediate products, so the rows
+    // span every work group of the device SpGEMM including the global one
+    cusp::array2d<float,cusp::host_memory> A(48,48,0.0f);
+    cusp::array2d<float,cusp::host_memory> B(48,48,0.0f);
+
+    for(size_t i = 0; i < 48; i++)
+    {
+        for(size_t j = 0; j <= i; j++)
+            A(i,j) = float((i + 2 * j) % 3 + 1);
+        for(size_t j = 0; j < 48; j++)
+            B(i,j) = float((3 * i + j) % 4 + 1);
+    }
+
+    CompareSparseMatrixMatrixMultiply<TestMatrix>(A, B);
+    CompareSparseMatrixMatrixMultiply<TestMatrix>(B, A);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestSparseMatrixMatrixMultiplyRowWork);
+
+template <typename TestMatrix>
+void TestSparseMatrixMatrixMultiplyWorkspaceBudget(void)
+{
+    typedef typename TestMatrix::memory_space MemorySpace;
+
+    // the same rows as above
+    cusp::array2d<float,cusp::host_memory> A(48,48,0.0f);
+    cusp::array2d<float,cusp::host_memory> B(48,48,0.0f);
+
+    for(size_t i = 0; i < 48; i++)
+    {
+        for(size_t j = 0; j <= i; j++)
+            A(i,j) = float((i + 2 * j) % 3 + 1);
+        for(size_t j = 0; j < 48; j++)
+            B(i,j) = float((3 * i + j) % 4 + 1);
+    }
+
+    cusp::array2d<float,cusp::host_memory> C;
+    cusp::multiply(A, B, C);
+
+    TestMatrix _A(A), _B(B), _C;
+
+    // without a budget
+    cusp::spgemm_workspace unbounded;
+    cusp::multiply(_A, _B, _C, unbounded);
+
+    ASSERT_EQUAL(C == cusp::array2d<float,cusp::host_memory>(_C), true);
+    ASSERT_EQUAL(unbounded.num_slabs, (size_t) 1);
+
+    // a budget below the workspace of any row splits the product as far as possible
+    cusp::spgemm_workspace bounded(1);
+    cusp::multiply(_A, _B, _C, bounded);
+
+    ASSERT_EQUAL(C == cusp::array2d<float,cusp::host_memory>(_C), true);
+
+    if (thrust::detail::is_convertible<MemorySpace, cusp::device_memory>::value)
+    {
+        ASSERT_EQUAL(bounded.num_slabs > 1, true);
+        ASSERT_EQUAL(unbounded.peak_bytes > 0, true);
+    }
+    else
+    {
+        ASSERT_EQUAL(bounded.num_slabs, (size_t) 1);
+    }
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestSparseMatrixMatrixMultiplyWorkspaceBudget);
+
+
+/////////////////////////////////////////////////
+// Sparse Matrix-Dense Matrix Multiplication   //
+/////////////////////////////////////////////////
+
+template <typename SparseMatrixType, typename Orientation>
+void CompareSparseMatrixDenseMatrixMultiply(const cusp::array2d<float,cusp::host_memory>& A, size_t num_vectors)
+{
+    typedef typename SparseMatrixType::memory_space MemorySpace;
+
+    cusp::array2d<float,cusp::host_memory,Orientation> X(A.num_cols, num_vectors);
+    for(size_t i = 0; i < X.num_rows; i++)
+        for(size_t j = 0; j < X.num_cols; j++)
+            X(i,j) = float((i + 3 * j) % 7) - 3;
+
+    // compute reference output
+    cusp::array2d<float,cusp::host_memory> X_dense(X);
+    cusp::array2d<float,cusp::host_memory> Y;
+    cusp::multiply(A, X_dense, Y);
+
+    SparseMatrixType _A(A);
+    cusp::array2d<float,MemorySpace,Orientation> _X(X);
+    cusp::array2d<float,MemorySpace,Orientation> _Y;
+
+    cusp::multiply(_A, _X, _Y);
+
+    ASSERT_EQUAL(_Y.num_rows, A.num_rows);
+    ASSERT_EQUAL(_Y.num_cols, num_vectors);
+    ASSERT_EQUAL(Y == cusp::array2d<float,cusp::host_memory>(_Y), true);
+}
+
+template <typename TestMatrix>
+void TestSparseMatrixDenseMatrixMultiply(void)
+{
+    cusp::array2d<float,cusp::host_memory> A(5,4);
+    A(0,0) = 13; A(0,1) = 80; A(0,2) =  0; A(0,3) =  0; 
+    A(1,0) =  0; A(1,1) = 27; A(1,2) =  0; A(1,3) =  0;
+    A(2,0) = 55; A(2,1) =  0; A(2,2) = 24; A(2,3) = 42;
+    A(3,0) =  0; A(3,1) = 69; A(3,2) =  0; A(3,3) = 83;
+    A(4,0) =  0; A(4,1) =  0; A(4,2) = 27; A(4,3) =  0;
+
+    cusp::array2d<float,cusp::host_memory> B;
+    cusp::gallery::poisson5pt(B, 8, 6);
+
+    // integer entries, so the results are exact
+    cusp::array2d<float,cusp::host_memory> C(40, 30, 0.0f);
+    for(size_t i = 0; i < C.num_rows; i++)
+        for(size_t j = i % 3; j < C.num_cols; j += 1 + i % 5)
+            C(i,j) = float((i + j) % 4) + 1;
+
+    // chunks of 1, 2, 4, 8 and more than 8 right-hand sides
+    const size_t num_vectors[] = {1, 2, 3, 4, 7, 8, 11};
+
+    for(size_t n = 0; n < sizeof(num_vectors) / sizeof(size_t); n++)
+    {
+        CompareSparseMatrixDenseMatrixMultiply<TestMatrix, cusp::row_major>   (A, num_vectors[n]);
+        CompareSparseMatrixDenseMatrixMultiply<TestMatrix, cusp::column_major>(A, num_vectors[n]);
+        CompareSparseMatrixDenseMatrixMultiply<TestMatrix, cusp::row_major>   (B, num_vectors[n]);
+        CompareSparseMatrixDenseMatrixMultiply<TestMatrix, cusp::column_major>(B, num_vectors[n]);
+        CompareSparseMatrixDenseMatrixMultiply<TestMatrix, cusp::row_major>   (C, num_vectors[n]);
+        CompareSparseMatrixDenseMatrixMultiply<TestMatrix, cusp::column_major>(C, num_vectors[n]);
+    }
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestSparseMatrixDenseMatrixMultiply);
+
 
 /////////////////////////////////////////
 // Sparse Matrix-Vector Multiplication //
@@ -217,6 +361,575 @@ void TestSparseMatrixVectorMultiply()
 }
 DECLARE_SPARSE_MATRIX_UNITTEST(TestSparseMatrixVectorMultiply);
 
+// ELL and DIA use wide loads when the pitch is a multiple of the vector
+// width, including the rows in the padding past num_rows
+template <typename ValueType, typename MemorySpace>
+void CompareEllDiaMatrixVectorMultiplyPitch(size_t alignment)
+{
+    cusp::csr_matrix<int, ValueType, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 7, 5);
+
+    cusp::array1d<ValueType, cusp::host_memory> x(A.num_cols);
+    cusp::array1d<ValueType, cusp::host_memory> y(A.num_rows);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = i % 10;
+
+    cusp::multiply(A, x, y);
+
+    {
+        cusp::ell_matrix<int, ValueType, cusp::host_memory> E(A);
+        cusp::ell_matrix<int, ValueType, MemorySpace> _P(E.num_rows, E.num_cols, E.num_entries, E.column_indices.num_cols, alignment);
+
+        // copying into arrays of the same shape preserves their pitch
+        cusp::copy(E.column_indices, _P.column_indices);
+        cusp::copy(E.values,         _P.values);
+
+        cusp::array1d<ValueType, MemorySpace> _x(x);
+        cusp::array1d<ValueType, MemorySpace> _y(A.num_rows, ValueType(-1));
+
+        cusp::multiply(_P, _x, _y);
+
+        ASSERT_EQUAL(_y, y);
+    }
+
+    {
+        cusp::dia_matrix<int, ValueType, cusp::host_memory> D(A);
+        cusp::dia_matrix<int, ValueType, MemorySpace> _P(D.num_rows, D.num_cols, D.num_entries, D.diagonal_offsets.size(), alignment);
+
+        cusp::copy(D.diagonal_offsets, _P.diagonal_offsets);
+        cusp::copy(D.values,           _P.values);
+
+        cusp::array1d<ValueType, MemorySpace> _x(x);
+        cusp::array1d<ValueType, MemorySpace> _y(A.num_rows, ValueType(-1));
+
+        cusp::multiply(_P, _x, _y);
+
+        ASSERT_EQUAL(_y, y);
+    }
+}
+
+template <class MemorySpace>
+void TestEllDiaMatrixVectorMultiplyPitch(void)
+{
+    CompareEllDiaMatrixVectorMultiplyPitch<float,  MemorySpace>(1);
+    CompareEllDiaMatrixVectorMultiplyPitch<float,  MemorySpace>(2);
+    CompareEllDiaMatrixVectorMultiplyPitch<float,  MemorySpace>(32);
+    CompareEllDiaMatrixVectorMultiplyPitch<double, MemorySpace>(1);
+    CompareEllDiaMatrixVectorMultiplyPitch<double, MemorySpace>(32);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestEllDiaMatrixVectorMultiplyPitch);
+
+
+// A real matrix applied to complex vectors equals the product with the
+// matrix promoted to complex values.
+template <typename RealMatrix, typename ComplexMatrix>
+void CompareRealMatrixComplexVectorMultiply(void)
+{
+    typedef typename RealMatrix::memory_space  MemorySpace;
+    typedef typename ComplexMatrix::value_type ValueType;
+
+    RealMatrix A;
+    cusp::gallery::poisson5pt(A, 11, 9);
+
+    ComplexMatrix B;
+    cusp::copy(A, B);
+
+    cusp::array1d<ValueType, MemorySpace> x(A.num_cols);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = ValueType(float(i % 10) - 4, float(i % 7) - 3);
+
+    cusp::array1d<ValueType, MemorySpace> y_ref(A.num_rows);
+    cusp::multiply(B, x, y_ref);
+
+    cusp::array1d<ValueType, MemorySpace> y(A.num_rows, ValueType(17));
+    cusp::multiply(A, x, y);
+
+    ASSERT_EQUAL(y, y_ref);
+}
+
+template <class MemorySpace>
+void TestRealMatrixComplexVectorMultiply(void)
+{
+    typedef cusp::complex<float> ComplexType;
+
+    CompareRealMatrixComplexVectorMultiply< cusp::coo_matrix<int, float, MemorySpace>, cusp::coo_matrix<int, ComplexType, MemorySpace> >();
+    CompareRealMatrixComplexVectorMultiply< cusp::csr_matrix<int, float, MemorySpace>, cusp::csr_matrix<int, ComplexType, MemorySpace> >();
+    CompareRealMatrixComplexVectorMultiply< cusp::dia_matrix<int, float, MemorySpace>, cusp::dia_matrix<int, ComplexType, MemorySpace> >();
+    CompareRealMatrixComplexVectorMultiply< cusp::ell_matrix<int, float, MemorySpace>, cusp::ell_matrix<int, ComplexType, MemorySpace> >();
+    CompareRealMatrixComplexVectorMultiply< cusp::hyb_matrix<int, float, MemorySpace>, cusp::hyb_matrix<int, ComplexType, MemorySpace> >();
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestRealMatrixComplexVectorMultiply);
+
+
+// HYB matrix of A with at most ell_width entries per row in the ELL part
+template <typename MemorySpace>
+void split_hyb(const cusp::csr_matrix<int, float, cusp::host_memory>& A,
+               cusp::hyb_matrix<int, float, MemorySpace>& result,
+               const size_t ell_width)
+{
+    const int X = cusp::ell_matrix<int, float, cusp::host_memory>::invalid_index;
+
+    size_t num_ell_entries = 0;
+    for(size_t i = 0; i < A.num_rows; i++)
+        num_ell_entries += std::min<size_t>(ell_width, A.row_offsets[i + 1] - A.row_offsets[i]);
+
+    cusp::hyb_matrix<int, float, cusp::host_memory> H(A.num_rows, A.num_cols, num_ell_entries, A.num_entries - num_ell_entries, ell_width);
+
+    size_t n = 0;
+    for(size_t i = 0; i < A.num_rows; i++)
+    {
+        for(size_t k = 0; k < ell_width; k++)
+        {
+            H.ell.column_indices(i,k) = X;
+            H.ell.values(i,k)         = 0;
+        }
+
+        for(int jj = A.row_offsets[i], k = 0; jj < A.row_offsets[i + 1]; jj++, k++)
+        {
+            if (size_t(k) < ell_width)
+            {
+                H.ell.column_indices(i,k) = A.column_indices[jj];
+                H.ell.values(i,k)         = A.values[jj];
+            }
+            else
+            {
+                H.coo.row_indices[n]    = i;
+                H.coo.column_indices[n] = A.column_indices[jj];
+                H.coo.values[n]         = A.values[jj];
+                n++;
+            }
+        }
+    }
+
+    result = H;
+}
+
+template <typename MemorySpace>
+void CompareHybMatrixVectorMultiply(const cusp::csr_matrix<int, float, cusp::host_memory>& A, const size_t ell_width)
+{
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = i % 10;
+
+    cusp::array1d<float, cusp::host_memory> y(A.num_rows);
+    cusp::array1d<float, cusp::host_memory> r(A.num_rows);
+    cusp::multiply(A, x, y);
+
+    // r <- x - A x
+    cusp::residual(A, x, x, r);
+
+    cusp::hyb_matrix<int, float, MemorySpace> H;
+    split_hyb(A, H, ell_width);
+
+    cusp::array1d<float, MemorySpace> _x(x);
+    cusp::array1d<float, MemorySpace> _y(A.num_rows, -1.0f);
+    cusp::array1d<float, MemorySpace> _r(A.num_rows, -1.0f);
+
+    cusp::multiply(H, _x, _y);
+    cusp::residual(H, _x, _x, _r);
+
+    ASSERT_EQUAL(_y, y);
+    ASSERT_EQUAL(_r, r);
+}
+
+template <typename MemorySpace>
+void CompareHybMatrixVectorMultiply(const size_t n, const size_t ell_width)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson9pt(A, n, n);
+
+    CompareHybMatrixVectorMultiply<MemorySpace>(A, ell_width);
+}
+
+template <class MemorySpace>
+void TestHybMatrixVectorMultiplySmallAndLarge(void)
+{
+    // the product of small matrices takes a single kernel on the device,
+    // larger ones the ELL and COO kernels
+    CompareHybMatrixVectorMultiply<MemorySpace>(  5, 3);
+    CompareHybMatrixVectorMultiply<MemorySpace>( 20, 0);
+    CompareHybMatrixVectorMultiply<MemorySpace>( 20, 9);
+    CompareHybMatrixVectorMultiply<MemorySpace>(400, 3);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestHybMatrixVectorMultiplySmallAndLarge);
+
+template <class MemorySpace>
+void TestHybMatrixVectorMultiplyFused(void)
+{
+    // a large matrix with few COO entries takes the fused kernel on the
+    // device: one row longer than the chunks of the COO reduction, a run
+    // of rows with a few COO entries, and rows without any
+    cusp::csr_matrix<int, float, cusp::host_memory> P;
+    cusp::gallery::poisson5pt(P, 300, 300);
+
+    std::vector<size_t> extra(P.num_rows, 0);
+    extra[1234] = 2000;
+    for(size_t i = 5000; i < 5100; i++)
+        extra[i] = 3;
+
+    size_t num_entries = P.num_entries;
+    for(size_t i = 0; i < P.num_rows; i++)
+        num_entries += extra[i];
+
+    cusp::csr_matrix<int, float, cusp::host_memory> A(P.num_rows, P.num_cols, num_entries);
+
+    A.row_offsets[0] = 0;
+
+    for(size_t i = 0, n = 0; i < P.num_rows; i++)
+    {
+        for(int jj = P.row_offsets[i]; jj < P.row_offsets[i + 1]; jj++, n++)
+        {
+            A.column_indices[n] = P.column_indices[jj];
+            A.values[n]         = P.values[jj];
+        }
+
+        for(size_t k = 0; k < extra[i]; k++, n++)
+        {
+            A.column_indices[n] = (7 * k) % P.num_cols;
+            A.values[n]         = 1;
+        }
+
+        A.row_offsets[i + 1] = n;
+    }
+
+    CompareHybMatrixVectorMultiply<MemorySpace>(A, 5);
+    CompareHybMatrixVectorMultiply<MemorySpace>(A, 4);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestHybMatrixVectorMultiplyFused);
+
+template <class MemorySpace>
+void TestCooMatrixVectorMultiplyLongRows(void)
+{
+    // rows that span many intervals of the segmented reduction, next to
+    // empty rows and rows that begin and end within one interval
+    const size_t lengths[] = {5000, 1, 0, 3, 700, 33, 0, 64, 2000, 31, 1, 4096, 0};
+    const size_t num_rows  = sizeof(lengths) / sizeof(size_t);
+    const size_t num_cols  = 5000;
+
+    size_t num_entries = 0;
+    for(size_t i = 0; i < num_rows; i++)
+        num_entries += lengths[i];
+
+    cusp::coo_matrix<int, float, cusp::host_memory> A(num_rows, num_cols, num_entries);
+
+    for(size_t i = 0, n = 0; i < num_rows; i++)
+    {
+        for(size_t k = 0; k < lengths[i]; k++, n++)
+        {
+            A.row_indices[n]    = i;
+            A.column_indices[n] = (7 * k) % num_cols;
+            A.values[n]         = 1 + (k % 3);
+        }
+    }
+
+    cusp::array1d<float, cusp::host_memory> x(num_cols);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = i % 10;
+
+    // integral sums are exact in any order
+    cusp::array1d<float, cusp::host_memory> y(num_rows);
+    cusp::multiply(A, x, y);
+
+    cusp::coo_matrix<int, float, MemorySpace> _A(A);
+    cusp::hyb_matrix<int, float, MemorySpace> _H(A);
+    cusp::array1d<float, MemorySpace> _x(x);
+    cusp::array1d<float, MemorySpace> _y(num_rows, -1.0f);
+    cusp::array1d<float, MemorySpace> _z(num_rows, -1.0f);
+
+    cusp::multiply(_A, _x, _y);
+    cusp::multiply(_H, _x, _z);
+
+    ASSERT_EQUAL(_y, y);
+    ASSERT_EQUAL(_z, y);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestCooMatrixVectorMultiplyLongRows);
+
+void CompareCsrMatrixVectorMultiplyRowBlocks(size_t entries_per_block)
+{
+    // rows of irregular length
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::random(300, 200, 3000, A);
+
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = i % 10;
+
+    cusp::array1d<float, cusp::host_memory> y(A.num_rows);
+    cusp::array1d<float, cusp::host_memory> r(A.num_rows);
+    cusp::multiply(A, x, y);
+
+    cusp::array1d<float, cusp::host_memory> b(A.num_rows, 1.0f);
+    cusp::residual(A, x, b, r);
+
+    cusp::csr_matrix<int, float, cusp::device_memory> _A(A);
+    cusp::array1d<float, cusp::device_memory> _x(x);
+    cusp::array1d<float, cusp::device_memory> _y(A.num_rows, -1.0f);
+    cusp::array1d<float, cusp::device_memory> _r(b);
+
+    cusp::detail::device::spmv_csr_row_blocks(_A,
+                                              thrust::raw_pointer_cast(&_x[0]),
+                                              thrust::raw_pointer_cast(&_y[0]),
+                                              cusp::detail::device::spmv_store<float>(),
+                                              entries_per_block);
+
+    // r <- b - A x, in place
+    cusp::detail::device::spmv_csr_row_blocks(_A,
+                                              thrust::raw_pointer_cast(&_x[0]),
+                                              thrust::raw_pointer_cast(&_r[0]),
+                                              cusp::detail::device::spmv_axpby<float>(-1.0f, 1.0f, thrust::raw_pointer_cast(&_r[0])),
+                                              entries_per_block);
+
+    cusp::array1d<float, cusp::host_memory> y_host(_y);
+    cusp::array1d<float, cusp::host_memory> r_host(_r);
+
+    ASSERT_ALMOST_EQUAL(y_host, y);
+    ASSERT_ALMOST_EQUAL(r_host, r);
+}
+
+void TestCsrMatrixVectorMultiplyRowBlocks(void)
+{
+    // the product of an oversubscribed managed matrix, with blocks of a
+    // single row, of a few rows, and of the whole matrix
+    CompareCsrMatrixVectorMultiplyRowBlocks(1);
+    CompareCsrMatrixVectorMultiplyRowBlocks(37);
+    CompareCsrMatrixVectorMultiplyRowBlocks(1 << 20);
+}
+DECLARE_UNITTEST(TestCsrMatrixVectorMultiplyRowBlocks);
+
+
+////////////////////////////////////////////////////
+// Transposed Sparse Matrix-Vector Multiplication //
+////////////////////////////////////////////////////
+
+template <typename SparseMatrixType, typename DenseMatrixType>
+void CompareSparseMatrixVectorMultiplyTranspose(DenseMatrixType A)
+{
+    typedef typename SparseMatrixType::memory_space MemorySpace;
+
+    // setup reference input
+    cusp::array1d<float, cusp::host_memory> x(A.num_rows);
+    cusp::array1d<float, cusp::host_memory> y(A.num_cols, 10);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = i % 10;
+
+    // compute reference output
+    DenseMatrixType At;
+    cusp::transpose(A, At);
+    cusp::multiply(At, x, y);
+
+    // dense matrix
+    {
+      cusp::array1d<float, cusp::host_memory> _y(A.num_cols, 10);
+
+      cusp::multiply_transpose(A, x, _y);
+
+      ASSERT_ALMOST_EQUAL(_y, y);
+    }
+
+    // test container
+    {
+      SparseMatrixType _A(A);
+      cusp::array1d<float, MemorySpace> _x(x);
+      cusp::array1d<float, MemorySpace> _y(A.num_cols, 10);
+
+      cusp::multiply_transpose(_A, _x, _y);
+
+      cusp::array1d<float, cusp::host_memory> z(_y);
+      ASSERT_ALMOST_EQUAL(z, y);
+    }
+
+    // test matrix view
+    {
+      SparseMatrixType _A(A);
+      cusp::array1d<float, MemorySpace> _x(x);
+      cusp::array1d<float, MemorySpace> _y(A.num_cols, 10);
+
+      typename SparseMatrixType::view _V(_A);
+      cusp::multiply_transpose(_V, _x, _y);
+
+      cusp::array1d<float, cusp::host_memory> z(_y);
+      ASSERT_ALMOST_EQUAL(z, y);
+    }
+}
+
+template <class TestMatrix>
+void TestSparseMatrixVectorMultiplyTranspose()
+{
+    cusp::array2d<float, cusp::host_memory> A(5,4);
+    A(0,0) = 13; A(0,1) = 80; A(0,2) =  0; A(0,3) =  0; 
+    A(1,0) =  0; A(1,1) = 27; A(1,2) =  0; A(1,3) =  0;
+    A(2,0) = 55; A(2,1) =  0; A(2,2) = 24; A(2,3) = 42;
+    A(3,0) =  0; A(3,1) = 69; A(3,2) =  0; A(3,3) = 83;
+    A(4,0) =  0; A(4,1) =  0; A(4,2) = 27; A(4,3) =  0;
+
+    cusp::array2d<float,cusp::host_memory> B(2,4);
+    B(0,0) = 0.0; B(0,1) = 2.0; B(0,2) = 3.0; B(0,3) = 4.0;
+    B(1,0) = 5.0; B(1,1) = 0.0; B(1,2) = 0.0; B(1,3) = 8.0;
+
+    cusp::array2d<float,cusp::host_memory> E(2,2);
+    E(0,0) = 0.0; E(0,1) = 0.0;
+    E(1,0) = 0.0; E(1,1) = 0.0;
+
+    cusp::array2d<float,cusp::host_memory> G;
+    cusp::gallery::poisson5pt(G, 4, 6);
+
+    cusp::array2d<float,cusp::host_memory> H;
+    cusp::gallery::random(40, 30, 200, H);
+
+    CompareSparseMatrixVectorMultiplyTranspose<TestMatrix>(A);
+    CompareSparseMatrixVectorMultiplyTranspose<TestMatrix>(B);
+    CompareSparseMatrixVectorMultiplyTranspose<TestMatrix>(E);
+    CompareSparseMatrixVectorMultiplyTranspose<TestMatrix>(G);
+    CompareSparseMatrixVectorMultiplyTranspose<TestMatrix>(H);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestSparseMatrixVectorMultiplyTranspose);
+
+
+/////////////////////////////////////////////////////////
+// Sparse Matrix-Vector Multiplication with an Epilogue //
+/////////////////////////////////////////////////////////
+
+template <typename SparseMatrixType, typename DenseMatrixType>
+void CompareSparseMatrixVectorMultiplyAxpby(DenseMatrixType A)
+{
+    typedef typename SparseMatrixType::memory_space MemorySpace;
+
+    // setup reference input
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    cusp::array1d<float, cusp::host_memory> b(A.num_rows);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = i % 10;
+    for(size_t i = 0; i < b.size(); i++)
+        b[i] = (i % 7) - 3.0f;
+
+    // compute reference output
+    cusp::array1d<float, cusp::host_memory> Ax(A.num_rows);
+    cusp::multiply(A, x, Ax);
+
+    cusp::array1d<float, cusp::host_memory> y_axpby(A.num_rows);
+    cusp::array1d<float, cusp::host_memory> y_scale(A.num_rows);
+    cusp::array1d<float, cusp::host_memory> r(A.num_rows);
+    for(size_t i = 0; i < Ax.size(); i++)
+    {
+        y_axpby[i] = 2.0f * Ax[i] - b[i];
+        y_scale[i] = 3.0f * Ax[i];
+        r[i]       = b[i] - Ax[i];
+    }
+
+    SparseMatrixType _A(A);
+    cusp::array1d<float, MemorySpace> _x(x);
+
+    // y <- alpha * A * x + beta * y
+    {
+      cusp::array1d<float, MemorySpace> _y(b);
+
+      cusp::multiply(_A, _x, _y, 2.0f, -1.0f);
+
+      ASSERT_EQUAL(_y, y_axpby);
+    }
+
+    // y is not read when beta is zero
+    {
+      cusp::array1d<float, MemorySpace> _y(A.num_rows, 10);
+
+      cusp::multiply(_A, _x, _y, 3.0f, 0.0f);
+
+      ASSERT_EQUAL(_y, y_scale);
+    }
+
+    // r <- b - A * x
+    {
+      cusp::array1d<float, MemorySpace> _b(b);
+      cusp::array1d<float, MemorySpace> _r(A.num_rows, 10);
+
+      cusp::residual(_A, _x, _b, _r);
+
+      ASSERT_EQUAL(_r, r);
+    }
+
+    // r may alias b
+    {
+      cusp::array1d<float, MemorySpace> _b(b);
+
+      cusp::residual(_A, _x, _b, _b);
+
+      ASSERT_EQUAL(_b, r);
+    }
+}
+
+template <class TestMatrix>
+void TestSparseMatrixVectorMultiplyAxpby()
+{
+    cusp::array2d<float, cusp::host_memory> A(5,4);
+    A(0,0) = 13; A(0,1) = 80; A(0,2) =  0; A(0,3) =  0; 
+    A(1,0) =  0; A(1,1) = 27; A(1,2) =  0; A(1,3) =  0;
+    A(2,0) = 55; A(2,1) =  0; A(2,2) = 24; A(2,3) = 42;
+    A(3,0) =  0; A(3,1) = 69; A(3,2) =  0; A(3,3) = 83;
+    A(4,0) =  0; A(4,1) =  0; A(4,2) = 27; A(4,3) =  0;
+
+    cusp::array2d<float,cusp::host_memory> E(2,2);
+    E(0,0) = 0.0; E(0,1) = 0.0;
+    E(1,0) = 0.0; E(1,1) = 0.0;
+    
+    cusp::array2d<float,cusp::host_memory> G;
+    cusp::gallery::poisson5pt(G, 4, 6);
+
+    // banded matrix with more diagonals than a DIA chunk
+    cusp::array2d<float,cusp::host_memory> H(300, 300, 0.0f);
+    for(size_t i = 0; i < H.num_rows; i++)
+        for(size_t j = 0; j < H.num_cols; j++)
+            if (i <= j + 150 && j <= i + 150)
+                H(i,j) = float((i + j) % 3);
+
+    CompareSparseMatrixVectorMultiplyAxpby<TestMatrix>(A);
+    CompareSparseMatrixVectorMultiplyAxpby<TestMatrix>(E);
+    CompareSparseMatrixVectorMultiplyAxpby<TestMatrix>(G);
+    CompareSparseMatrixVectorMultiplyAxpby<TestMatrix>(H);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestSparseMatrixVectorMultiplyAxpby);
+
+template <class MemorySpace>
+void TestDiaMatrixVectorMultiplyStencil(void)
+{
+    // offsets of the 27-point stencil within one band, in bands of
+    // the grid planes, and in one band per grid line
+    const size_t grids[][3] = {{6, 5, 4}, {20, 20, 20}, {300, 4, 4}};
+
+    for (size_t n = 0; n < 3; n++)
+    {
+        cusp::csr_matrix<int, float, cusp::host_memory> A;
+        cusp::gallery::poisson27pt(A, grids[n][0], grids[n][1], grids[n][2]);
+
+        cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+        for (size_t i = 0; i < x.size(); i++)
+            x[i] = float(i % 7) - 3;
+
+        cusp::array1d<float, cusp::host_memory> z(A.num_rows);
+        for (size_t i = 0; i < z.size(); i++)
+            z[i] = float(i % 5);
+
+        cusp::array1d<float, cusp::host_memory> y(A.num_rows);
+        cusp::multiply(A, x, y);
+
+        cusp::dia_matrix<int, float, MemorySpace> D(A);
+        cusp::array1d<float, MemorySpace> d_x(x);
+        cusp::array1d<float, MemorySpace> d_y(A.num_rows, 10);
+        cusp::multiply(D, d_x, d_y);
+
+        ASSERT_EQUAL(d_y, y);
+
+        // y <- 2 * A * x - z
+        cusp::array1d<float, MemorySpace> d_z(z);
+        cusp::multiply(D, d_x, d_z, 2.0f, -1.0f);
+
+        for (size_t i = 0; i < z.size(); i++)
+            z[i] = 2.0f * y[i] - z[i];
+
+        ASSERT_EQUAL(d_z, z);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDiaMatrixVectorMultiplyStencil);
+
 
 //////////////////////////////
 // General Linear Operators //
@@ -244,3 +957,466 @@ void TestMultiplyIdentityOperator(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestMultiplyIdentityOperator);
 
+template <class MemorySpace>
+void TestResidualIdentityOperator(void)
+{
+    cusp::array1d<float, MemorySpace> x(4);
+    cusp::array1d<float, MemorySpace> b(4);
+    cusp::array1d<float, MemorySpace> r(4);
+
+    x[0] =  7.0f;   b[0] =  0.0f; 
+    x[1] =  5.0f;   b[1] = -2.0f;
+    x[2] =  4.0f;   b[2] =  0.0f;
+    x[3] = -3.0f;   b[3] =  5.0f;
+
+    cusp::identity_operator<float, MemorySpace> A(4,4);
+    
+    cusp::residual(A, x, b, r);
+
+    ASSERT_EQUAL(r[0], -7.0f);
+    ASSERT_EQUAL(r[1], -7.0f);
+    ASSERT_EQUAL(r[2], -4.0f);
+    ASSERT_EQUAL(r[3],  8.0f);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestResidualIdentityOperator);
+
+
+
+////////////////////////////////////
+// Dense Matrix Multiplication    //
+////////////////////////////////////
+
+template <typename Matrix>
+void initialize_dense(Matrix& A, size_t num_rows, size_t num_cols, size_t seed)
+{
+    A.resize(num_rows, num_cols);
+
+    for(size_t i = 0; i < num_rows; i++)
+        for(size_t j = 0; j < num_cols; j++)
+            A(i,j) = float((i * 7 + j * 3 + seed) % 11) - 5;
+}
+
+template <typename MemorySpace, typename Orientation>
+void CompareDenseMatrixVectorMultiply(size_t num_rows, size_t num_cols)
+{
+    cusp::array2d<float, cusp::host_memory> A;
+    initialize_dense(A, num_rows, num_cols, 0);
+
+    cusp::array1d<float, cusp::host_memory> x(num_cols);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 5) - 2;
+
+    // reference output
+    cusp::array1d<float, cusp::host_memory> y(num_rows, 10);
+    cusp::multiply(A, x, y);
+
+    cusp::array2d<float, MemorySpace, Orientation> _A(A);
+    cusp::array1d<float, MemorySpace> _x(x);
+    cusp::array1d<float, MemorySpace> _y(num_rows, 10);
+
+    cusp::multiply(_A, _x, _y);
+
+    ASSERT_EQUAL(_y, y);
+}
+
+template <typename MemorySpace>
+void TestDenseMatrixVectorMultiply(void)
+{
+    // short rows, long rows, and more columns than a tile of x
+    size_t shapes[][2] = { {1, 1}, {5, 4}, {4, 17}, {33, 3}, {100, 40}, {7, 300}, {300, 7}, {0, 3}, {3, 0} };
+
+    for(size_t n = 0; n < sizeof(shapes) / sizeof(shapes[0]); n++)
+    {
+        CompareDenseMatrixVectorMultiply<MemorySpace, cusp::row_major>(shapes[n][0], shapes[n][1]);
+        CompareDenseMatrixVectorMultiply<MemorySpace, cusp::column_major>(shapes[n][0], shapes[n][1]);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDenseMatrixVectorMultiply);
+
+template <typename MemorySpace, typename OrientationA, typename OrientationB, typename OrientationC>
+void CompareDenseMatrixMatrixMultiply(size_t num_rows, size_t num_inner, size_t num_cols)
+{
+    cusp::array2d<float, cusp::host_memory> A, B, C;
+    initialize_dense(A, num_rows, num_inner, 0);
+    initialize_dense(B, num_inner, num_cols, 4);
+
+    // reference output
+    cusp::multiply(A, B, C);
+
+    cusp::array2d<float, MemorySpace, OrientationA> _A(A);
+    cusp::array2d<float, MemorySpace, OrientationB> _B(B);
+    cusp::array2d<float, MemorySpace, OrientationC> _C;
+
+    cusp::multiply(_A, _B, _C);
+
+    ASSERT_EQUAL(_C.num_rows, num_rows);
+    ASSERT_EQUAL(_C.num_cols, num_cols);
+    ASSERT_EQUAL(C == cusp::array2d<float, cusp::host_memory>(_C), true);
+}
+
+template <typename MemorySpace, typename OrientationA, typename OrientationB>
+void CompareDenseMatrixMatrixMultiply(size_t num_rows, size_t num_inner, size_t num_cols)
+{
+    CompareDenseMatrixMatrixMultiply<MemorySpace, OrientationA, OrientationB, cusp::row_major>(num_rows, num_inner, num_cols);
+    CompareDenseMatrixMatrixMultiply<MemorySpace, OrientationA, OrientationB, cusp::column_major>(num_rows, num_inner, num_cols);
+}
+
+template <typename MemorySpace>
+void TestDenseMatrixMatrixMultiply(void)
+{
+    // shapes that are smaller than, equal to, and straddle the tile size
+    size_t shapes[][3] = { {1, 1, 1}, {3, 2, 4}, {16, 16, 16}, {17, 33, 5}, {40, 7, 50}, {2, 100, 3}, {0, 3, 2}, {3, 0, 2} };
+
+    for(size_t n = 0; n < sizeof(shapes) / sizeof(shapes[0]); n++)
+    {
+        const size_t m = shapes[n][0], k = shapes[n][1], p = shapes[n][2];
+
+        CompareDenseMatrixMatrixMultiply<MemorySpace, cusp::row_major,    cusp::row_major   >(m, k, p);
+        CompareDenseMatrixMatrixMultiply<MemorySpace, cusp::row_major,    cusp::column_major>(m, k, p);
+        CompareDenseMatrixMatrixMultiply<MemorySpace, cusp::column_major, cusp::row_major   >(m, k, p);
+        CompareDenseMatrixMatrixMultiply<MemorySpace, cusp::column_major, cusp::column_major>(m, k, p);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestDenseMatrixMatrixMultiply);
+
+//////////////////////////////
+// Multithreaded Host Paths //
+//////////////////////////////
+
+// large enough for the host loops to run in parallel under OpenMP, with
+// integer values so that every product is exact
+template <typename SparseMatrixType>
+void CompareHostMatrixVectorMultiplyLarge(const cusp::csr_matrix<int, float, cusp::host_memory>& A,
+                                          const cusp::array1d<float, cusp::host_memory>& x,
+                                          const cusp::array1d<float, cusp::host_memory>& expected)
+{
+    SparseMatrixType B(A);
+
+    cusp::array1d<float, cusp::host_memory> y(A.num_rows, -1);
+    cusp::multiply(B, x, y);
+
+    ASSERT_EQUAL(y, expected);
+}
+
+void TestHostMatrixVectorMultiplyLarge(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 300, 200);
+
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = int(i % 7) - 3;
+
+    cusp::array1d<float, cusp::host_memory> expected(A.num_rows, 0);
+    for(size_t i = 0; i < A.num_rows; i++)
+        for(int jj = A.row_offsets[i]; jj < A.row_offsets[i + 1]; jj++)
+            expected[i] += A.values[jj] * x[A.column_indices[jj]];
+
+    CompareHostMatrixVectorMultiplyLarge< cusp::coo_matrix<int, float, cusp::host_memory> >(A, x, expected);
+    CompareHostMatrixVectorMultiplyLarge< cusp::csr_matrix<int, float, cusp::host_memory> >(A, x, expected);
+    CompareHostMatrixVectorMultiplyLarge< cusp::dia_matrix<int, float, cusp::host_memory> >(A, x, expected);
+    CompareHostMatrixVectorMultiplyLarge< cusp::ell_matrix<int, float, cusp::host_memory> >(A, x, expected);
+    CompareHostMatrixVectorMultiplyLarge< cusp::hyb_matrix<int, float, cusp::host_memory> >(A, x, expected);
+
+    // conversions back to CSR reproduce the matrix
+    cusp::dia_matrix<int, float, cusp::host_memory> D(A);
+    cusp::ell_matrix<int, float, cusp::host_memory> E(A);
+    cusp::coo_matrix<int, float, cusp::host_memory> C(A);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> A_D(D), A_E(E), A_C(C);
+
+    ASSERT_EQUAL(A_D.row_offsets, A.row_offsets); ASSERT_EQUAL(A_D.column_indices, A.column_indices); ASSERT_EQUAL(A_D.values, A.values);
+    ASSERT_EQUAL(A_E.row_offsets, A.row_offsets); ASSERT_EQUAL(A_E.column_indices, A.column_indices); ASSERT_EQUAL(A_E.values, A.values);
+    ASSERT_EQUAL(A_C.row_offsets, A.row_offsets); ASSERT_EQUAL(A_C.column_indices, A.column_indices); ASSERT_EQUAL(A_C.values, A.values);
+}
+DECLARE_UNITTEST(TestHostMatrixVectorMultiplyLarge);
+
+void TestHostMatrixMatrixMultiplyLarge(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 300, 200);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> C;
+    cusp::multiply(A, A, C);
+
+    // (A A) x = A (A x)
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = int(i % 5) - 2;
+
+    cusp::array1d<float, cusp::host_memory> Ax(A.num_rows), AAx(A.num_rows), Cx(A.num_rows);
+    cusp::multiply(A, x, Ax);
+    cusp::multiply(A, Ax, AAx);
+    cusp::multiply(C, x, Cx);
+
+    ASSERT_EQUAL(C.num_rows, A.num_rows);
+    ASSERT_EQUAL(C.row_offsets[C.num_rows], int(C.num_entries));
+    ASSERT_EQUAL(Cx, AAx);
+}
+DECLARE_UNITTEST(TestHostMatrixMatrixMultiplyLarge);
+
+void TestHostMatrixMatrixMultiplyCancellation(void)
+{
+    // the off-diagonal entries of A * A cancel and are dropped
+    cusp::array2d<float, cusp::host_memory> D(3,3);
+    D(0,0) = 1; D(0,1) =  1; D(0,2) = 0;
+    D(1,0) = 1; D(1,1) = -1; D(1,2) = 0;
+    D(2,0) = 0; D(2,1) =  0; D(2,2) = 3;
+
+    cusp::csr_matrix<int, float, cusp::host_memory> A(D), C;
+    cusp::multiply(A, A, C);
+
+    ASSERT_EQUAL(C.num_entries, 3);
+    ASSERT_EQUAL(C.row_offsets[0], 0);
+    ASSERT_EQUAL(C.row_offsets[1], 1);
+    ASSERT_EQUAL(C.row_offsets[2], 2);
+    ASSERT_EQUAL(C.row_offsets[3], 3);
+    ASSERT_EQUAL(C.column_indices[0], 0); ASSERT_EQUAL(C.values[0], 2);
+    ASSERT_EQUAL(C.column_indices[1], 1); ASSERT_EQUAL(C.values[1], 2);
+    ASSERT_EQUAL(C.column_indices[2], 2); ASSERT_EQUAL(C.values[2], 9);
+}
+DECLARE_UNITTEST(TestHostMatrixMatrixMultiplyCancellation);
+
+template <typename ValueType>
+void CompareHostSimdMatrixVectorMultiply(const cusp::detail::host::host_simd_isa isa)
+{
+    cusp::coo_matrix<int, ValueType, cusp::host_memory> C;
+    cusp::gallery::random(1003, 517, 12000, C);
+
+    for(size_t n = 0; n < C.num_entries; n++)
+        C.values[n] = ValueType(int(n % 13) - 6) / 4;
+
+    cusp::ell_matrix<int, ValueType, cusp::host_memory> E(C);
+    cusp::sell_matrix<int, ValueType, cusp::host_memory> S(C, 32, 128);
+
+    cusp::array1d<ValueType, cusp::host_memory> x(C.num_cols);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = ValueType(int(i % 9) - 4) / 3;
+
+    // reference from the scalar loops
+    cusp::array1d<ValueType, cusp::host_memory> expected(C.num_rows);
+    cusp::detail::host::spmv_ell(E, x, expected,
+                                 cusp::detail::zero_function<ValueType>(),
+                                 thrust::multiplies<ValueType>(),
+                                 thrust::plus<ValueType>());
+
+    cusp::array1d<ValueType, cusp::host_memory> y(C.num_rows, -1);
+    ASSERT_EQUAL(cusp::detail::host::spmv_ell_simd(E, x, y, isa), true);
+    ASSERT_ALMOST_EQUAL(y, expected);
+
+    cusp::array1d<ValueType, cusp::host_memory> z(C.num_rows, -1);
+    ASSERT_EQUAL(cusp::detail::host::spmv_sell_simd(S, x, z, isa), true);
+    ASSERT_ALMOST_EQUAL(z, expected);
+}
+
+void TestHostSimdMatrixVectorMultiply(void)
+{
+    namespace host = cusp::detail::host;
+
+    // every instruction set of this CPU
+    if (host::current_host_simd_isa() >= host::host_simd_avx2)
+    {
+        CompareHostSimdMatrixVectorMultiply<float >(host::host_simd_avx2);
+        CompareHostSimdMatrixVectorMultiply<double>(host::host_simd_avx2);
+    }
+
+    if (host::current_host_simd_isa() >= host::host_simd_avx512)
+    {
+        CompareHostSimdMatrixVectorMultiply<float >(host::host_simd_avx512);
+        CompareHostSimdMatrixVectorMultiply<double>(host::host_simd_avx512);
+    }
+
+    // other value types use the scalar loops
+    cusp::ell_matrix<int, int, cusp::host_memory> A(2, 2, 2, 1);
+    cusp::array1d<int, cusp::host_memory> x(2, 1), y(2);
+
+    ASSERT_EQUAL(host::spmv_ell_simd(A, x, y, host::host_simd_avx2), false);
+}
+DECLARE_UNITTEST(TestHostSimdMatrixVectorMultiply);
+
+template <typename ValueType>
+void CompareHostVendorMultiply(void)
+{
+    namespace vendor = cusp::detail::host::vendor;
+
+    cusp::csr_matrix<int, ValueType, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 30, 20);
+
+    cusp::array1d<ValueType, cusp::host_memory> x(A.num_cols);
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = ValueType(int(i % 7) - 3) / 2;
+
+    cusp::array2d<ValueType, cusp::host_memory, cusp::row_major>    B(A.num_cols, 3), D(7, 5);
+    cusp::array2d<ValueType, cusp::host_memory, cusp::column_major> E(5, 4);
+    for(size_t i = 0; i < B.num_rows; i++) for(size_t j = 0; j < B.num_cols; j++) B(i,j) = ValueType(int((i + 2 * j) % 5) - 2);
+    for(size_t i = 0; i < D.num_rows; i++) for(size_t j = 0; j < D.num_cols; j++) D(i,j) = ValueType(int((3 * i + j) % 7) - 3);
+    for(size_t i = 0; i < E.num_rows; i++) for(size_t j = 0; j < E.num_cols; j++) E(i,j) = ValueType(int((i + j) % 3) - 1);
+
+    cusp::array1d<ValueType, cusp::host_memory> y[2], t[2], u[2], w[2];
+    cusp::array2d<ValueType, cusp::host_memory, cusp::row_major> AB[2], DE[2];
+
+    // the built-in loops, then the vendor library when present
+    for(int pass = 0; pass < 2; pass++)
+    {
+        vendor::enable(pass == 1);
+
+        y[pass].resize(A.num_rows);
+        t[pass].resize(A.num_cols);
+        u[pass].resize(D.num_rows);
+        w[pass].resize(D.num_cols);
+
+        cusp::multiply(A, x, y[pass]);
+        cusp::multiply_transpose(A, x, t[pass]);
+        cusp::multiply(A, B, AB[pass]);
+        cusp::multiply(D, E, DE[pass]);
+
+        cusp::array1d<ValueType, cusp::host_memory> d(D.num_cols, 1), e(D.num_rows, 1);
+        cusp::multiply(D, d, u[pass]);
+        cusp::multiply_transpose(D, e, w[pass]);
+    }
+
+    vendor::enable(true);
+
+    ASSERT_ALMOST_EQUAL(y[0], y[1]);
+    ASSERT_ALMOST_EQUAL(t[0], t[1]);
+    ASSERT_ALMOST_EQUAL(u[0], u[1]);
+    ASSERT_ALMOST_EQUAL(w[0], w[1]);
+    ASSERT_ALMOST_EQUAL(AB[0].values, AB[1].values);
+    ASSERT_ALMOST_EQUAL(DE[0].values, DE[1].values);
+}
+
+void TestHostVendorMultiply(void)
+{
+    CompareHostVendorMultiply<float>();
+    CompareHostVendorMultiply<double>();
+
+    // other value types use the built-in loops
+    cusp::csr_matrix<int, int, cusp::host_memory> A(2, 2, 0);
+    cusp::array1d<int, cusp::host_memory> x(2, 1), y(2);
+
+    ASSERT_EQUAL(cusp::detail::host::vendor::csrmv(A, x, y), false);
+}
+DECLARE_UNITTEST(TestHostVendorMultiply);
+
+void TestMultiplyOperationCost(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 4, 4);
+
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols, 1);
+    cusp::array2d<float, cusp::host_memory> X(A.num_cols, 2, 1);
+
+    // offsets, entries and indices, x per entry, y read and written
+    const size_t bytes = 4 * (A.num_rows + 1) + 8 * A.num_entries + 4 * (A.num_entries + 2 * A.num_rows);
+
+    cusp::detail::operation_cost cost = cusp::detail::multiply_cost(A, x);
+    ASSERT_EQUAL(cost.bytes, bytes);
+    ASSERT_EQUAL(cost.flops, 2 * A.num_entries);
+
+    // the axpby form also reads z
+    cost = cusp::detail::multiply_axpby_cost(A, x);
+    ASSERT_EQUAL(cost.bytes, bytes + 4 * A.num_rows);
+    ASSERT_EQUAL(cost.flops, 2 * A.num_entries + 3 * A.num_rows);
+
+    // products with matrix operands have no model
+    cost = cusp::detail::multiply_cost(A, X);
+    ASSERT_EQUAL(cost.bytes, (size_t) 0);
+    ASSERT_EQUAL(cost.flops, (size_t) 0);
+
+    typedef cusp::hyb_matrix<int, float, cusp::host_memory> HybMatrix;
+    HybMatrix H(A);
+    ASSERT_EQUAL(cusp::detail::multiply_cost(H, x).flops, 2 * A.num_entries);
+    ASSERT_EQUAL(std::string(cusp::detail::multiply_profile_name(HybMatrix::format())), std::string("cusp::multiply<hyb>"));
+}
+DECLARE_UNITTEST(TestMultiplyOperationCost);
+
+template <class MemorySpace>
+void TestMultiplyStridedVectors(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 3, 4);
+
+    // x and y are columns of row-major arrays
+    cusp::array2d<float, MemorySpace, cusp::row_major> X(A.num_cols, 2, 0.0f);
+    cusp::array2d<float, MemorySpace, cusp::row_major> Y(A.num_rows, 3, -1.0f);
+
+    cusp::array1d<float, MemorySpace> x(A.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = X(i,1) = float(i % 5) - 2.0f;
+
+    cusp::array1d<float, MemorySpace> y(A.num_rows);
+    cusp::multiply(A, x, y);
+
+    typename cusp::array2d<float, MemorySpace, cusp::row_major>::column_view x_view(X.column(1));
+    typename cusp::array2d<float, MemorySpace, cusp::row_major>::column_view y_view(Y.column(1));
+    cusp::multiply(A, x_view, y_view);
+
+    for (size_t i = 0; i < y.size(); i++)
+    {
+        ASSERT_EQUAL(Y(i,0), -1.0f);
+        ASSERT_EQUAL(Y(i,1), y[i]);
+        ASSERT_EQUAL(Y(i,2), -1.0f);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMultiplyStridedVectors);
+
+template <class MemorySpace>
+void TestMultiplyScopedNoCopy(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 3, 3);
+
+    cusp::coo_matrix<int, float, MemorySpace> B(A);
+
+    cusp::array1d<float, MemorySpace> x(A.num_cols, 1.0f);
+    cusp::array1d<float, MemorySpace> y(A.num_rows);
+
+    cusp::scoped_no_copy guard;
+
+    // SpMV consumes the operands in place
+    cusp::multiply(A, x, y);
+    cusp::multiply(B, x, y);
+
+    // the generic SpMM converts the COO operand to CSR
+    cusp::csr_matrix<int, float, MemorySpace> C;
+    ASSERT_THROWS(cusp::multiply(A, B, C), cusp::implicit_copy_exception);
+    ASSERT_THROWS(cusp::multiply(A, A, B), cusp::implicit_copy_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMultiplyScopedNoCopy);
+
+void TestMultiplyScopedNoCopyStridedDeviceVector(void)
+{
+    cusp::csr_matrix<int, float, cusp::device_memory> A;
+    cusp::gallery::poisson5pt(A, 3, 3);
+
+    cusp::array2d<float, cusp::device_memory, cusp::row_major> X(A.num_cols, 2, 1.0f);
+    cusp::array1d<float, cusp::device_memory> y(A.num_rows);
+
+    cusp::array2d<float, cusp::device_memory, cusp::row_major>::column_view x(X.column(0));
+
+    cusp::scoped_no_copy guard;
+
+    // device kernels stage strided vectors through a copy
+    ASSERT_THROWS(cusp::multiply(A, x, y), cusp::implicit_copy_exception);
+}
+DECLARE_UNITTEST(TestMultiplyScopedNoCopyStridedDeviceVector);
+
+void TestDeviceSparseMatrixMatrixMultiplyExpandSortContract(void)
+{
+    // the CSR fallback of devices without the hash SpGEMM
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::csr_matrix<int, float, cusp::host_memory> B;
+    cusp::gallery::random(40, 30, 200, A);
+    cusp::gallery::random(30, 50, 300, B);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> C;
+    cusp::multiply(A, B, C);
+
+    cusp::csr_matrix<int, float, cusp::device_memory> _A(A), _B(B), _C;
+    cusp::detail::device::spmm_csr_esc(_A, _B, _C);
+
+    ASSERT_EQUAL(_C.num_rows, (size_t) 40);
+    ASSERT_EQUAL(_C.num_cols, (size_t) 50);
+    ASSERT_EQUAL(cusp::array2d<float, cusp::host_memory>(_C) == cusp::array2d<float, cusp::host_memory>(C), true);
+}
+DECLARE_UNITTEST(TestDeviceSparseMatrixMatrixMultiplyExpandSortContract);
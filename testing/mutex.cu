@@ -0,0 +1,47 @@
+#include <unittest/unittest.h>
+
+#include <cusp/detail/mutex.h>
+
+#include <stdexcept>
+
+static int once_calls = 0;
+
+static int count_once_call(void)
+{
+    return ++once_calls;
+}
+
+static int throw_once_call(void)
+{
+    throw std::runtime_error("initializer failed");
+}
+
+void TestInitializeOnce(void)
+{
+    static cusp::detail::once_value<int> value;
+
+    once_calls = 0;
+
+    ASSERT_EQUAL(cusp::detail::initialize_once(value, count_once_call), 1);
+    ASSERT_EQUAL(cusp::detail::initialize_once(value, count_once_call), 1);
+    ASSERT_EQUAL(once_calls, 1);
+
+    // the value is writable, as the switches of the vendor libraries
+    cusp::detail::initialize_once(value, count_once_call) = 5;
+    ASSERT_EQUAL(cusp::detail::initialize_once(value, count_once_call), 5);
+    ASSERT_EQUAL(once_calls, 1);
+}
+DECLARE_UNITTEST(TestInitializeOnce);
+
+void TestInitializeOnceRetry(void)
+{
+    static cusp::detail::once_value<int> value;
+
+    once_calls = 0;
+
+    // a throwing initializer leaves the value empty
+    ASSERT_THROWS(cusp::detail::initialize_once(value, throw_once_call), std::runtime_error);
+    ASSERT_EQUAL(cusp::detail::initialize_once(value, count_once_call), 1);
+}
+DECLARE_UNITTEST(TestInitializeOnceRetry);
+
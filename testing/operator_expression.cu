@@ -0,0 +1,132 @@
+#include <unittest/unittest.h>
+
+#include <cusp/operator_expression.h>
+
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/cg.h>
+#include <cusp/precond/diagonal.h>
+
+template <class MemorySpace>
+void TestOperatorExpressions(void)
+{
+    typedef cusp::csr_matrix<int, float, MemorySpace> CsrMatrix;
+    typedef cusp::dia_matrix<int, float, MemorySpace> DiaMatrix;
+
+    CsrMatrix A;
+    cusp::gallery::poisson5pt(A, 6, 5);
+    DiaMatrix B(A);
+
+    const size_t N = A.num_rows;
+
+    cusp::array1d<float, MemorySpace> x(N);
+    for (size_t i = 0; i < N; i++)
+        x[i] = float(i % 4) - 1.5f;
+
+    cusp::array1d<float, MemorySpace> Ax(N);
+    cusp::multiply(A, x, Ax);
+
+    cusp::array1d<float, MemorySpace> y(N);
+    cusp::array1d<float, MemorySpace> expected(N);
+
+    // A - sigma I
+    {
+        cusp::shifted_operator<CsrMatrix> S = cusp::shift(A, 0.5f);
+
+        ASSERT_EQUAL(S.num_rows, A.num_rows);
+        ASSERT_EQUAL(S.num_cols, A.num_cols);
+
+        cusp::multiply(S, x, y);
+        cusp::blas::axpby(Ax, x, expected, 1.0f, -0.5f);
+        ASSERT_ALMOST_EQUAL(y, expected);
+
+        // the shift is updated in place
+        S.sigma = -2.0f;
+        cusp::multiply(S, x, y);
+        cusp::blas::axpby(Ax, x, expected, 1.0f, 2.0f);
+        ASSERT_ALMOST_EQUAL(y, expected);
+    }
+
+    // alpha A
+    {
+        cusp::scaled_operator<DiaMatrix> S = cusp::scale(3.0f, B);
+        cusp::multiply(S, x, y);
+        cusp::blas::axpby(Ax, Ax, expected, 3.0f, 0.0f);
+        ASSERT_ALMOST_EQUAL(y, expected);
+    }
+
+    // A + B
+    {
+        cusp::sum_operator<CsrMatrix,DiaMatrix> S = cusp::sum(A, B);
+        cusp::multiply(S, x, y);
+        cusp::blas::axpby(Ax, Ax, expected, 1.0f, 1.0f);
+        ASSERT_ALMOST_EQUAL(y, expected);
+    }
+
+    // M A with a preconditioner
+    {
+        cusp::precond::diagonal<float, MemorySpace> M(A);
+
+        cusp::composed_operator<cusp::precond::diagonal<float, MemorySpace>,CsrMatrix> MA = cusp::compose(M, A);
+        cusp::multiply(MA, x, y);
+        cusp::blas::axpby(Ax, Ax, expected, 0.25f, 0.0f);
+        ASSERT_ALMOST_EQUAL(y, expected);
+    }
+
+    // nested expressions are held by value: 2 A (A - I) + A
+    {
+        cusp::array1d<float, MemorySpace> t(N);
+        cusp::blas::axpby(Ax, x, t, 1.0f, -1.0f);
+        cusp::multiply(A, t, expected);
+        cusp::blas::axpby(expected, Ax, expected, 2.0f, 1.0f);
+
+        cusp::sum_operator< cusp::composed_operator< cusp::scaled_operator<CsrMatrix>, cusp::shifted_operator<DiaMatrix> >, CsrMatrix >
+            E = cusp::sum(cusp::compose(cusp::scale(2.0f, A), cusp::shift(B, 1.0f)), A);
+
+        cusp::multiply(E, x, y);
+        ASSERT_ALMOST_EQUAL(y, expected);
+    }
+
+    // incompatible shapes
+    CsrMatrix C(N, N + 1, 0);
+
+    ASSERT_THROWS(cusp::shift(C, 1.0f), cusp::invalid_input_exception);
+    ASSERT_THROWS(cusp::sum(A, C), cusp::invalid_input_exception);
+    ASSERT_THROWS(cusp::compose(C, A), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestOperatorExpressions);
+
+template <class MemorySpace>
+void TestShiftedOperatorSolve(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    // A + I is symmetric positive definite
+    for (int k = 0; k < 3; k++)
+    {
+        const float sigma = -1.0f - k;
+
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 200, 1e-5);
+
+        cusp::shifted_operator< cusp::csr_matrix<int, float, MemorySpace> > S = cusp::shift(A, sigma);
+        cusp::krylov::cg(S, x, b, monitor);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+
+        // b - (A - sigma I) x
+        cusp::array1d<float, MemorySpace> r(A.num_rows);
+        cusp::multiply(A, x, r);
+        cusp::blas::axpbypcz(b, r, x, r, 1.0f, -1.0f, sigma);
+
+        ASSERT_EQUAL(cusp::blas::nrm2(r) < 2e-5 * cusp::blas::nrm2(b), true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestShiftedOperatorSolve);
+
@@ -0,0 +1,111 @@
+#include <unittest/unittest.h>
+
+#include <cusp/out_of_core_csr_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/gallery/random.h>
+#include <cusp/krylov/cg.h>
+
+template <typename HostMatrix>
+void CompareOutOfCoreMultiply(const HostMatrix& A, size_t buffer_bytes, size_t num_streams)
+{
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 7) - 3;
+
+    cusp::array1d<float, cusp::host_memory> y(A.num_rows, 0);
+    cusp::multiply(A, x, y);
+
+    cusp::out_of_core_csr_matrix<HostMatrix> B(A, buffer_bytes, num_streams);
+
+    ASSERT_EQUAL(B.num_rows,    A.num_rows);
+    ASSERT_EQUAL(B.num_cols,    A.num_cols);
+    ASSERT_EQUAL(B.num_entries, A.num_entries);
+    ASSERT_EQUAL(B.panel_begin(0), (size_t) 0);
+    ASSERT_EQUAL(B.panel_begin(B.num_panels()), (size_t) A.num_rows);
+
+    cusp::array1d<float, cusp::device_memory> d_x(x);
+    cusp::array1d<float, cusp::device_memory> d_y(A.num_rows, 10);
+
+    // repeated products reuse the panel buffers
+    cusp::multiply(B, d_x, d_y);
+    cusp::multiply(B, d_x, d_y);
+
+    cusp::array1d<float, cusp::host_memory> h_y(d_y);
+    ASSERT_ALMOST_EQUAL(h_y, y);
+}
+
+void TestOutOfCoreCsrMatrixMultiply(void)
+{
+    typedef cusp::csr_matrix<int, float, cusp::pinned_memory> PinnedMatrix;
+    typedef cusp::csr_matrix<int, float, cusp::host_memory>   PageableMatrix;
+
+    PageableMatrix A;
+    cusp::gallery::random(300, 200, 3000, A);
+
+    PinnedMatrix P(A);
+
+    // panels of single rows, of a few rows and of the whole matrix
+    CompareOutOfCoreMultiply(P, 1,         2);
+    CompareOutOfCoreMultiply(P, 1024,      2);
+    CompareOutOfCoreMultiply(P, 1024,      3);
+    CompareOutOfCoreMultiply(P, 1 << 20,   1);
+
+    // pageable memory is staged by the driver
+    CompareOutOfCoreMultiply(A, 2048,      2);
+
+    {
+        cusp::out_of_core_csr_matrix<PinnedMatrix> B(P, 1, 2);
+        ASSERT_EQUAL(B.num_panels(), (size_t) A.num_rows);
+    }
+    {
+        cusp::out_of_core_csr_matrix<PinnedMatrix> B(P, 1 << 20, 2);
+        ASSERT_EQUAL(B.num_panels(), (size_t) 1);
+    }
+
+    ASSERT_THROWS(cusp::out_of_core_csr_matrix<PinnedMatrix> B(P, 1024, 0), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestOutOfCoreCsrMatrixMultiply);
+
+void TestOutOfCoreCsrMatrixEmpty(void)
+{
+    typedef cusp::csr_matrix<int, float, cusp::host_memory> HostMatrix;
+
+    HostMatrix A(0, 0, 0);
+    cusp::out_of_core_csr_matrix<HostMatrix> B(A, 1024);
+
+    ASSERT_EQUAL(B.num_panels(), (size_t) 0);
+
+    cusp::array1d<float, cusp::device_memory> x(0), y(0);
+    cusp::multiply(B, x, y);
+}
+DECLARE_UNITTEST(TestOutOfCoreCsrMatrixEmpty);
+
+void TestOutOfCoreCsrMatrixConjugateGradient(void)
+{
+    typedef cusp::csr_matrix<int, float, cusp::pinned_memory> HostMatrix;
+
+    HostMatrix A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    // panels of about 1 KB on two streams
+    cusp::out_of_core_csr_matrix<HostMatrix> B(A, 2048);
+    ASSERT_EQUAL(B.num_panels() > 2, true);
+
+    cusp::array1d<float, cusp::device_memory> x(A.num_rows, 0.0f);
+    cusp::array1d<float, cusp::device_memory> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 100, 1e-5);
+    cusp::krylov::cg(B, x, b, monitor);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+
+    // check the residual with the product in device memory
+    cusp::csr_matrix<int, float, cusp::device_memory> D(A);
+    cusp::array1d<float, cusp::device_memory> r(A.num_rows);
+    cusp::residual(D, x, b, r);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(r) < 1e-4 * cusp::blas::nrm2(b), true);
+}
+DECLARE_UNITTEST(TestOutOfCoreCsrMatrixConjugateGradient);
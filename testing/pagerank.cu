@@ -0,0 +1,133 @@
+#include <unittest/unittest.h>
+
+#include <cusp/graph/pagerank.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/gallery/random.h>
+
+#include <cmath>
+
+// power iteration on the dense adjacency matrix
+template <typename Matrix>
+void reference_pagerank(const Matrix& D, cusp::array1d<double, cusp::host_memory>& ranks,
+                        const double damping, const size_t iterations)
+{
+    const size_t N = D.num_rows;
+
+    cusp::array1d<int, cusp::host_memory> degree(N, 0);
+
+    for (size_t i = 0; i < N; i++)
+        for (size_t j = 0; j < N; j++)
+            if (D(i,j) != 0)
+                degree[i]++;
+
+    ranks.resize(N);
+    cusp::array1d<double, cusp::host_memory> next(N);
+
+    for (size_t i = 0; i < N; i++)
+        ranks[i] = 1.0 / N;
+
+    for (size_t k = 0; k < iterations; k++)
+    {
+        double dangling = 0;
+
+        for (size_t i = 0; i < N; i++)
+            if (degree[i] == 0)
+                dangling += ranks[i];
+
+        for (size_t j = 0; j < N; j++)
+            next[j] = (1 - damping + damping * dangling) / N;
+
+        for (size_t i = 0; i < N; i++)
+            for (size_t j = 0; j < N; j++)
+                if (D(i,j) != 0)
+                    next[j] += damping * ranks[i] / degree[i];
+
+        ranks = next;
+    }
+}
+
+template <typename TestMatrix>
+void TestPageRank(void)
+{
+    typedef typename TestMatrix::memory_space MemorySpace;
+
+    // edges 0 -> 1, 0 -> 2, 1 -> 2, 2 -> 0, 2 -> 3, 4 -> 3, and a
+    // dangling vertex 3
+    cusp::array2d<float, cusp::host_memory> D(5,5,0);
+    D(0,1) = 1; D(0,2) = 1;
+    D(1,2) = 1;
+    D(2,0) = 1; D(2,3) = 1;
+    D(4,3) = 1;
+
+    TestMatrix A(D);
+
+    cusp::array1d<float, MemorySpace> ranks;
+    size_t iterations = cusp::graph::pagerank(A, ranks, 0.85, 1e-6, 200);
+
+    ASSERT_EQUAL(iterations < 200, true);
+
+    cusp::array1d<double, cusp::host_memory> reference;
+    reference_pagerank(D, reference, 0.85, 200);
+
+    cusp::array1d<float, cusp::host_memory> h_ranks(ranks);
+
+    float sum = 0;
+
+    for (size_t i = 0; i < 5; i++)
+    {
+        ASSERT_EQUAL(std::fabs(h_ranks[i] - reference[i]) < 1e-5, true);
+        sum += h_ranks[i];
+    }
+
+    ASSERT_EQUAL(std::fabs(sum - 1.0f) < 1e-5, true);
+
+    // vertex 4 has no in-edges and only receives the teleportation term,
+    // which includes the rank of the dangling vertex 3
+    ASSERT_EQUAL(std::fabs(h_ranks[4] - (0.15f + 0.85f * h_ranks[3]) / 5) < 1e-5, true);
+
+    ASSERT_THROWS(cusp::graph::pagerank(A, ranks, 1.0), cusp::invalid_input_exception);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestPageRank);
+
+template <typename MemorySpace>
+void TestPageRankRandom(void)
+{
+    cusp::coo_matrix<int, float, cusp::host_memory> G;
+    cusp::gallery::random(300, 300, 2000, G);
+
+    cusp::csr_matrix<int, float, MemorySpace> A(G);
+    cusp::array2d<float, cusp::host_memory> D(G);
+
+    cusp::array1d<double, MemorySpace> ranks;
+    cusp::graph::pagerank(A, ranks, 0.85, 1e-12, 500);
+
+    cusp::array1d<double, cusp::host_memory> reference;
+    reference_pagerank(D, reference, 0.85, 500);
+
+    cusp::array1d<double, cusp::host_memory> h_ranks(ranks);
+
+    for (size_t i = 0; i < 300; i++)
+        ASSERT_EQUAL(std::fabs(h_ranks[i] - reference[i]) < 1e-10, true);
+
+    // damping = 0 spreads the rank evenly
+    ASSERT_EQUAL(cusp::graph::pagerank(A, ranks, 0.0), (size_t) 1);
+    h_ranks = ranks;
+
+    for (size_t i = 0; i < 300; i++)
+        ASSERT_ALMOST_EQUAL(h_ranks[i], 1.0 / 300);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestPageRankRandom);
+
+void TestPageRankNonSquare(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A(3, 4, 0);
+    cusp::array1d<float, cusp::host_memory> ranks;
+
+    ASSERT_THROWS(cusp::graph::pagerank(A, ranks), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestPageRankNonSquare);
+
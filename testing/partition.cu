@@ -0,0 +1,128 @@
+#include <unittest/unittest.h>
+
+#include <cusp/graph/partition.h>
+
+#include <cusp/csr_matrix.h>
+#include <cusp/permute.h>
+#include <cusp/gallery/poisson.h>
+
+// number of edges between different parts, from the host
+template <typename MatrixType, typename ArrayType>
+size_t edge_cut(const MatrixType& A, const ArrayType& parts)
+{
+    typedef typename MatrixType::index_type IndexType;
+    typedef typename MatrixType::value_type ValueType;
+
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> csr(A);
+    cusp::array1d<int,cusp::host_memory> p(parts);
+
+    size_t cut = 0;
+
+    for (size_t i = 0; i < csr.num_rows; i++)
+        for (IndexType jj = csr.row_offsets[i]; jj < csr.row_offsets[i + 1]; jj++)
+            if (size_t(csr.column_indices[jj]) > i && p[i] != p[csr.column_indices[jj]])
+                cut++;
+
+    return cut;
+}
+
+template <class MemorySpace>
+void TestPartitionPoisson(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> G;
+    cusp::gallery::poisson5pt(G, 40, 40);
+
+    // a scattered numbering, which row blocks would partition badly
+    const int N = G.num_rows;
+    cusp::array1d<int, cusp::host_memory> scatter(N);
+    for (int i = 0; i < N; i++)
+        scatter[i] = (i * 7919) % N;
+
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::permute(G, scatter, A);
+
+    const size_t num_parts = 4;
+
+    cusp::array1d<int, MemorySpace> parts;
+    const size_t cut = cusp::graph::partition(A, num_parts, parts);
+
+    ASSERT_EQUAL(parts.size(), (size_t) N);
+    ASSERT_EQUAL(cut, edge_cut(A, parts));
+
+    // the parts are about as good as strips of the grid
+    ASSERT_EQUAL(cut <= 2 * 3 * 40, true);
+
+    cusp::array1d<int, MemorySpace> permutation;
+    cusp::array1d<int, MemorySpace> d_offsets;
+    cusp::graph::partition_permutation(parts, permutation, d_offsets);
+
+    cusp::array1d<int, cusp::host_memory> offsets(d_offsets);
+
+    ASSERT_EQUAL(offsets.size(), num_parts + 1);
+    ASSERT_EQUAL(offsets[0], 0);
+    ASSERT_EQUAL(offsets[num_parts], N);
+
+    cusp::array1d<int, cusp::host_memory> h_parts(parts);
+    cusp::array1d<int, cusp::host_memory> h_permutation(permutation);
+
+    for (size_t p = 0; p < num_parts; p++)
+    {
+        const int size = offsets[p + 1] - offsets[p];
+
+        ASSERT_EQUAL(size <= (11 * N) / (10 * int(num_parts)), true);
+
+        for (int n = offsets[p]; n < offsets[p + 1]; n++)
+            ASSERT_EQUAL(h_parts[h_permutation[n]], int(p));
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestPartitionPoisson);
+
+template <class MemorySpace>
+void TestPartitionDisconnected(void)
+{
+    // two grids without edges between them
+    cusp::csr_matrix<int, float, cusp::host_memory> G;
+    cusp::gallery::poisson5pt(G, 10, 10);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> H(200, 200, 2 * G.num_entries);
+    H.row_offsets[0] = 0;
+    for (int i = 0; i < 200; i++)
+    {
+        const int r = i % 100;
+        const int shift = i < 100 ? 0 : 100;
+
+        H.row_offsets[i + 1] = H.row_offsets[i] + (G.row_offsets[r + 1] - G.row_offsets[r]);
+
+        for (int jj = G.row_offsets[r], kk = H.row_offsets[i]; jj < G.row_offsets[r + 1]; jj++, kk++)
+        {
+            H.column_indices[kk] = G.column_indices[jj] + shift;
+            H.values[kk]         = G.values[jj];
+        }
+    }
+
+    cusp::csr_matrix<int, float, MemorySpace> A(H);
+
+    cusp::array1d<int, MemorySpace> parts;
+
+    // one part per component
+    ASSERT_EQUAL(cusp::graph::partition(A, 2, parts), (size_t) 0);
+
+    // a single part
+    ASSERT_EQUAL(cusp::graph::partition(A, 1, parts), (size_t) 0);
+    ASSERT_EQUAL(edge_cut(A, parts), (size_t) 0);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestPartitionDisconnected);
+
+void TestPartitionErrors(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 4, 4);
+
+    cusp::array1d<int, cusp::host_memory> parts;
+
+    ASSERT_THROWS(cusp::graph::partition(A, 0, parts), cusp::invalid_input_exception);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> B(3, 2, 0);
+    ASSERT_THROWS(cusp::graph::partition(B, 2, parts), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestPartitionErrors);
@@ -0,0 +1,80 @@
+#include <unittest/unittest.h>
+
+#include <cusp/permute.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/gallery/poisson.h>
+
+template <typename SparseMatrix>
+void TestPermute(void)
+{
+    typedef typename SparseMatrix::memory_space MemorySpace;
+
+    cusp::array2d<float, cusp::host_memory> D(4,4);
+    D(0,0) = 10;  D(0,1) =  0;  D(0,2) = 20;  D(0,3) =  0;
+    D(1,0) =  0;  D(1,1) = 30;  D(1,2) =  0;  D(1,3) = 40;
+    D(2,0) = 50;  D(2,1) =  0;  D(2,2) = 60;  D(2,3) = 70;
+    D(3,0) =  0;  D(3,1) = 80;  D(3,2) = 90;  D(3,3) =  0;
+
+    cusp::array1d<int, cusp::host_memory> P(4);
+    P[0] = 2; P[1] = 0; P[2] = 3; P[3] = 1;
+
+    SparseMatrix A(D);
+    SparseMatrix B;
+    cusp::permute(A, cusp::array1d<int, MemorySpace>(P), B);
+
+    cusp::array2d<float, cusp::host_memory> E(B);
+
+    ASSERT_EQUAL(B.num_entries, A.num_entries);
+
+    for (size_t i = 0; i < 4; i++)
+        for (size_t j = 0; j < 4; j++)
+            ASSERT_EQUAL(E(i,j), D(P[i],P[j]));
+
+    // the result is in the canonical order of the format
+    cusp::csr_matrix<int, float, cusp::host_memory> C(B);
+
+    for (size_t i = 0; i < 4; i++)
+        for (int jj = C.row_offsets[i] + 1; jj < C.row_offsets[i + 1]; jj++)
+            ASSERT_EQUAL(C.column_indices[jj - 1] < C.column_indices[jj], true);
+
+    // permutations of the wrong size
+    cusp::array1d<int, MemorySpace> Q(3, 0);
+    ASSERT_THROWS(cusp::permute(A, Q, B), cusp::invalid_input_exception);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestPermute);
+
+template <typename MemorySpace>
+void TestPermuteLarge(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, 40, 30);
+
+    for (size_t n = 0; n < A.num_entries; n++)
+        A.values[n] = float(n);
+
+    // reverse the order of the rows and swap them in pairs
+    const size_t N = A.num_rows;
+    cusp::array1d<int, cusp::host_memory> P(N);
+    for (size_t i = 0; i < N; i++)
+        P[i] = int(N - 1 - (i ^ 1));
+
+    cusp::csr_matrix<int, float, MemorySpace> B;
+    cusp::permute(cusp::csr_matrix<int, float, MemorySpace>(A), cusp::array1d<int, MemorySpace>(P), B);
+
+    // permuting by the inverse restores A
+    cusp::array1d<int, cusp::host_memory> Q(N);
+    for (size_t i = 0; i < N; i++)
+        Q[P[i]] = int(i);
+
+    cusp::csr_matrix<int, float, MemorySpace> C;
+    cusp::permute(B, cusp::array1d<int, MemorySpace>(Q), C);
+
+    ASSERT_EQUAL(C.row_offsets,    A.row_offsets);
+    ASSERT_EQUAL(C.column_indices, A.column_indices);
+    ASSERT_EQUAL(C.values,         A.values);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestPermuteLarge);
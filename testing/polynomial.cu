@@ -1,6 +1,7 @@
 #include <unittest/unittest.h>
 
 #include <cusp/relaxation/polynomial.h>
+#include <cusp/precond/polynomial.h>
 #include <cusp/detail/spectral_radius.h>
 
 #include <cusp/array2d.h>
@@ -9,6 +10,9 @@
 #include <cusp/dia_matrix.h>
 #include <cusp/ell_matrix.h>
 #include <cusp/hyb_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/cg.h>
 
 #include <thrust/sequence.h>
 
@@ -88,3 +92,94 @@ void TestChebyshevCoefficients(void)
     ASSERT_ALMOST_EQUAL(coef, expected);
 }
 DECLARE_UNITTEST(TestChebyshevCoefficients);
+
+
+template <class MemorySpace>
+void TestPolynomialPreconditioner(void)
+{
+    typedef cusp::precond::polynomial<double, MemorySpace> Polynomial;
+
+    cusp::csr_matrix<int, double, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<double, MemorySpace> x(A.num_rows);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = double(i % 5) - 2.0;
+
+    cusp::array1d<double, MemorySpace> Dinv(A.num_rows, 0.25);
+
+    for (int type = Polynomial::neumann; type <= Polynomial::chebyshev; type++)
+    {
+        Polynomial M(A, 3, typename Polynomial::polynomial_type(type));
+
+        ASSERT_EQUAL(M.num_rows, A.num_rows);
+        ASSERT_EQUAL(M.polynomial_coefficients().size(), (size_t) 4);
+
+        // the spectral radius of D^-1 A is below 2
+        ASSERT_EQUAL(M.spectral_radius() > 1.5 && M.spectral_radius() < 2.0 + 1e-6, true);
+
+        // y = p(D^-1 A) D^-1 x with Horner's rule
+        cusp::array1d<double, MemorySpace> z(A.num_rows);
+        cusp::blas::xmy(Dinv, x, z);
+
+        cusp::array1d<double, MemorySpace> expected(A.num_rows);
+        cusp::array1d<double, MemorySpace> t(A.num_rows);
+        cusp::blas::axpby(z, z, expected, M.polynomial_coefficients()[3], 0.0);
+
+        for (int k = 2; k >= 0; k--)
+        {
+            cusp::multiply(A, expected, t);
+            cusp::blas::xmy(Dinv, t, t);
+            cusp::blas::axpby(t, z, expected, 1.0, M.polynomial_coefficients()[k]);
+        }
+
+        cusp::array1d<double, MemorySpace> y(A.num_rows);
+        M(x, y);
+
+        ASSERT_ALMOST_EQUAL(y, expected);
+    }
+
+    // degree 0 of the Neumann series is damped Jacobi
+    Polynomial J(A, 0, Polynomial::neumann);
+    ASSERT_ALMOST_EQUAL(J.polynomial_coefficients()[0], 1.0 / (1.1 * J.spectral_radius()));
+
+    ASSERT_THROWS(Polynomial(A, 3, Polynomial::chebyshev, 1.0, 0.5), cusp::invalid_input_exception);
+    ASSERT_THROWS(Polynomial(A, 3, Polynomial::chebyshev, 0.1, 1.1, 1), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestPolynomialPreconditioner);
+
+template <class MemorySpace>
+void TestPolynomialPreconditionerCG(void)
+{
+    typedef cusp::precond::polynomial<float, MemorySpace> Polynomial;
+
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    size_t iterations[2];
+
+    for (int preconditioned = 0; preconditioned < 2; preconditioned++)
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+
+        if (preconditioned)
+        {
+            Polynomial M(A, 4, Polynomial::chebyshev);
+            cusp::krylov::cg(A, x, b, monitor, M);
+        }
+        else
+        {
+            cusp::krylov::cg(A, x, b, monitor);
+        }
+
+        ASSERT_EQUAL(monitor.converged(), true);
+        iterations[preconditioned] = monitor.iteration_count();
+    }
+
+    // each iteration applies a polynomial of degree 4
+    ASSERT_EQUAL(2 * iterations[1] < iterations[0], true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestPolynomialPreconditionerCG);
@@ -35,3 +35,56 @@ void TestPrintMatrix(void)
 }
 DECLARE_MATRIX_UNITTEST(TestPrintMatrix);
 
+
+template <typename Matrix>
+void TestPrintWindow(void)
+{
+    cusp::array2d<float, cusp::host_memory> A(4,4,0.0f);
+    A(0,0) = 11;  A(0,3) = 14;
+    A(1,1) = 22;  A(1,2) = 23;
+    A(2,1) = 32;  A(2,2) = 33;
+    A(3,0) = 41;  A(3,3) = 44;
+
+    Matrix M(A);
+
+    std::ostringstream oss;
+
+    // the central 2x2 block
+    cusp::print_window(M, 1, 3, 1, 3, oss);
+
+    ASSERT_EQUAL(oss.str().find("<4, 4>") != std::string::npos, true);
+    ASSERT_EQUAL(oss.str().find("with 4 entries\n") != std::string::npos, true);
+    ASSERT_EQUAL(oss.str().find("22") != std::string::npos, true);
+    ASSERT_EQUAL(oss.str().find("33") != std::string::npos, true);
+    ASSERT_EQUAL(oss.str().find("11") == std::string::npos, true);
+    ASSERT_EQUAL(oss.str().find("44") == std::string::npos, true);
+
+    // windows are clipped to the matrix
+    std::ostringstream empty;
+    cusp::print_window(M, 5, 10, 0, 4, empty);
+
+    ASSERT_EQUAL(empty.str().find("with 0 entries\n") != std::string::npos, true);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestPrintWindow);
+
+template <typename Matrix>
+void TestPrintSummary(void)
+{
+    cusp::array2d<float, cusp::host_memory> A(4,4,0.0f);
+    A(0,0) =  4;  A(0,1) = -1;  A(0,2) = -1;  A(0,3) = -1;
+    A(1,0) = -1;  A(1,1) =  1;
+    A(3,2) =  8;  A(3,3) = 0.5;
+
+    Matrix M(A);
+
+    std::ostringstream oss;
+    cusp::print_summary(M, oss);
+
+    // rows of length 4, 2, 0 and 2, two of which are diagonally dominant
+    ASSERT_EQUAL(oss.str().find("with 8 entries") != std::string::npos, true);
+    ASSERT_EQUAL(oss.str().find("min 0, mean 2, max 4") != std::string::npos, true);
+    ASSERT_EQUAL(oss.str().find("empty") != std::string::npos, true);
+    ASSERT_EQUAL(oss.str().find("min 0.5, max 8") != std::string::npos, true);
+    ASSERT_EQUAL(oss.str().find("dominant rows: 2 of 4") != std::string::npos, true);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestPrintSummary);
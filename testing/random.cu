@@ -1,13 +1,17 @@
 #include <unittest/unittest.h>
 
 #include <cusp/detail/random.h>
+#include <cusp/gallery/random.h>
 
 #include <cusp/array1d.h>
 #include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
 #include <thrust/sort.h>
 #include <thrust/unique.h>
 #include <thrust/extrema.h>
 
+#include <algorithm>
 #include <limits>
 
 #include <cusp/print.h>
@@ -114,3 +118,128 @@ struct TestRandomReals
 };
 SimpleUnitTest<TestRandomReals, unittest::type_list<float> > TestRandomRealsInstance;
 
+
+template <class MemorySpace>
+void TestGalleryRandom(void)
+{
+    cusp::coo_matrix<int, float, MemorySpace> A;
+    cusp::gallery::random(40, 30, 500, A);
+
+    cusp::coo_matrix<int, float, cusp::host_memory> B(A);
+
+    ASSERT_EQUAL(B.num_rows, 40);
+    ASSERT_EQUAL(B.num_cols, 30);
+    ASSERT_EQUAL(B.num_entries > 0 && B.num_entries <= 500, true);
+
+    // entries are in bounds, sorted and unique
+    for (size_t n = 0; n < B.num_entries; n++)
+    {
+        ASSERT_EQUAL(B.row_indices[n]    >= 0 && B.row_indices[n]    < 40, true);
+        ASSERT_EQUAL(B.column_indices[n] >= 0 && B.column_indices[n] < 30, true);
+        ASSERT_EQUAL(B.values[n], 1.0f);
+
+        if (n > 0)
+            ASSERT_EQUAL(B.row_indices[n - 1] < B.row_indices[n] ||
+                         (B.row_indices[n - 1] == B.row_indices[n] && B.column_indices[n - 1] < B.column_indices[n]), true);
+    }
+
+    // the same matrix is generated in either memory space
+    cusp::coo_matrix<int, float, cusp::host_memory> C;
+    cusp::gallery::random(40, 30, 500, C);
+
+    ASSERT_EQUAL(B.row_indices,    C.row_indices);
+    ASSERT_EQUAL(B.column_indices, C.column_indices);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGalleryRandom);
+
+
+void TestRandomIntegersPhilox(void)
+{
+    // known answers of Philox-2x32-10 for the counter 0 and the key 0
+    cusp::detail::random_integers<unsigned long long> random64(2);
+    cusp::detail::random_integers<unsigned int>       random32(2);
+
+    ASSERT_EQUAL(random64[0], 0x6cd10df2ff1dae59ull);
+    ASSERT_EQUAL(random32[0], 0xff1dae59u);
+
+    // the seed selects another sequence
+    cusp::detail::random_integers<unsigned int> seeded(2, 1);
+
+    ASSERT_EQUAL(random32[0] != seeded[0], true);
+    ASSERT_EQUAL(random32[1] != seeded[1], true);
+}
+DECLARE_UNITTEST(TestRandomIntegersPhilox);
+
+template <class MemorySpace>
+void TestGalleryRandomRows(void)
+{
+    cusp::array1d<int, cusp::host_memory> row_lengths(5);
+    row_lengths[0] = 3; row_lengths[1] = 0; row_lengths[2] = 7; row_lengths[3] = 1; row_lengths[4] = 4;
+
+    cusp::coo_matrix<int, float, MemorySpace> A;
+    cusp::gallery::random_rows(row_lengths, 7, A, 42);
+
+    cusp::coo_matrix<int, float, cusp::host_memory> B(A);
+
+    ASSERT_EQUAL(B.num_rows,    5);
+    ASSERT_EQUAL(B.num_cols,    7);
+    ASSERT_EQUAL(B.num_entries, 15);
+
+    // rows have exactly the requested lengths and distinct sorted columns
+    cusp::array1d<int, cusp::host_memory> counts(5, 0);
+
+    for (size_t n = 0; n < B.num_entries; n++)
+    {
+        ASSERT_EQUAL(B.column_indices[n] >= 0 && B.column_indices[n] < 7, true);
+        ASSERT_EQUAL(B.values[n], 1.0f);
+
+        counts[B.row_indices[n]]++;
+
+        if (n > 0 && B.row_indices[n - 1] == B.row_indices[n])
+            ASSERT_EQUAL(B.column_indices[n - 1] < B.column_indices[n], true);
+    }
+
+    ASSERT_EQUAL(counts, row_lengths);
+
+    // the same matrix is generated in either memory space
+    cusp::coo_matrix<int, float, cusp::host_memory> C;
+    cusp::gallery::random_rows(row_lengths, 7, C, 42);
+
+    ASSERT_EQUAL(B.column_indices, C.column_indices);
+
+    row_lengths[2] = 8;
+    ASSERT_THROWS(cusp::gallery::random_rows(row_lengths, 7, A), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGalleryRandomRows);
+
+template <class MemorySpace>
+void TestGalleryRandomPowerLaw(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::random_power_law(1000, 800, 20000, 0.5, A, 7);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> B(A);
+
+    ASSERT_EQUAL(B.num_rows,    1000);
+    ASSERT_EQUAL(B.num_cols,    800);
+    ASSERT_EQUAL(B.num_entries, 20000);
+
+    // the longest rows hold a large share of the entries
+    int max_length = 0;
+    for (size_t i = 0; i < B.num_rows; i++)
+        max_length = std::max(max_length, B.row_offsets[i + 1] - B.row_offsets[i]);
+
+    ASSERT_EQUAL(max_length > 100, true);
+
+    // an exponent of 0 yields rows of equal length
+    cusp::csr_matrix<int, float, MemorySpace> U;
+    cusp::gallery::random_power_law(100, 50, 1000, 0.0, U);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> V(U);
+
+    for (size_t i = 0; i < V.num_rows; i++)
+        ASSERT_EQUAL(V.row_offsets[i + 1] - V.row_offsets[i], 10);
+
+    ASSERT_THROWS(cusp::gallery::random_power_law(10, 10, 101, 0.0, U), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGalleryRandomPowerLaw);
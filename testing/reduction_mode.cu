@@ -0,0 +1,161 @@
+#include <unittest/unittest.h>
+
+#include <cusp/reduction_mode.h>
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/distributed_array1d.h>
+#include <cusp/detail/binned_sum.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+void TestReductionModeSelection(void)
+{
+    const cusp::reduction_mode initial = cusp::current_reduction_mode();
+
+    {
+        cusp::scoped_reduction_mode outer(cusp::reproducible_reduction);
+        ASSERT_EQUAL(cusp::current_reduction_mode(), cusp::reproducible_reduction);
+
+        {
+            cusp::scoped_reduction_mode inner(cusp::fast_reduction);
+            ASSERT_EQUAL(cusp::current_reduction_mode(), cusp::fast_reduction);
+        }
+
+        ASSERT_EQUAL(cusp::current_reduction_mode(), cusp::reproducible_reduction);
+
+        // a scope takes precedence over the default
+        cusp::set_reduction_mode(cusp::fast_reduction);
+        ASSERT_EQUAL(cusp::current_reduction_mode(), cusp::reproducible_reduction);
+    }
+
+    ASSERT_EQUAL(cusp::current_reduction_mode(), cusp::fast_reduction);
+
+    cusp::set_reduction_mode(initial);
+    ASSERT_EQUAL(cusp::current_reduction_mode(), initial);
+}
+DECLARE_UNITTEST(TestReductionModeSelection);
+
+void TestBinnedSumOrder(void)
+{
+    typedef cusp::detail::binned_sum Sum;
+
+    // terms of very different magnitudes, whose naive sums differ
+    const size_t N = 1000;
+    std::vector<double> terms(N);
+    for (size_t i = 0; i < N; i++)
+        terms[i] = (i % 2 ? -1.0 : 1.0) * std::ldexp(1.0 + double(i) / N, int(i % 61) - 30);
+
+    Sum forward;
+    for (size_t i = 0; i < N; i++)
+        forward = Sum::combine(forward, Sum::deposit(terms[i]));
+
+    // the same terms in reverse order, split into partial sums
+    for (size_t parts = 1; parts <= 7; parts++)
+    {
+        std::vector<Sum> partials(parts);
+        for (size_t i = N; i-- > 0;)
+            partials[i % parts] = Sum::combine(partials[i % parts], Sum::deposit(terms[i]));
+
+        Sum sum;
+        for (size_t p = 0; p < parts; p++)
+            sum = Sum::combine(partials[p], sum);
+
+        ASSERT_EQUAL(sum.value(), forward.value());
+    }
+
+    // cancellation is exact
+    Sum zero = Sum::combine(Sum::deposit(1e15), Sum::combine(Sum::deposit(1.0), Sum::deposit(-1e15)));
+    ASSERT_EQUAL(zero.value(), 1.0);
+
+    ASSERT_EQUAL(Sum().value(), 0.0);
+    ASSERT_EQUAL(Sum::deposit(1.0 / 0.0).value(), 1.0 / 0.0);
+}
+DECLARE_UNITTEST(TestBinnedSumOrder);
+
+template <class MemorySpace>
+void TestReproducibleReductions(void)
+{
+    typedef cusp::array1d<float, cusp::host_memory> HostArray;
+    typedef cusp::array1d<float, MemorySpace>       Array;
+
+    const size_t N = 10007;
+
+    HostArray hx = unittest::random_samples<float>(N);
+    HostArray hy = unittest::random_samples<float>(N);
+
+    for (size_t i = 0; i < N; i++)
+        hx[i] = std::ldexp(hx[i] - 0.5f, int(i % 23) - 11);
+
+    Array x(hx);
+    Array y(hy);
+
+    // the same terms in the opposite order
+    HostArray hrx(hx.rbegin(), hx.rend());
+    HostArray hry(hy.rbegin(), hy.rend());
+    Array rx(hrx);
+    Array ry(hry);
+
+    const float fast_dot  = cusp::blas::dot(x, y);
+    const float fast_nrm2 = cusp::blas::nrm2(x);
+
+    cusp::scoped_reduction_mode scope(cusp::reproducible_reduction);
+
+    const float dot  = cusp::blas::dot(x, y);
+    const float nrm2 = cusp::blas::nrm2(x);
+
+    ASSERT_EQUAL(cusp::blas::dot(rx, ry),  dot);
+    ASSERT_EQUAL(cusp::blas::dotc(rx, ry), dot);
+    ASSERT_EQUAL(cusp::blas::nrm2(rx),     nrm2);
+    ASSERT_EQUAL(thrust::get<0>(cusp::blas::dotc_n(rx, ry, x, x)), dot);
+    ASSERT_EQUAL(thrust::get<1>(cusp::blas::dotc_n(rx, ry, rx, rx)), cusp::blas::dotc(x, x));
+
+    // the host and the device agree bitwise
+    ASSERT_EQUAL(cusp::blas::dot(hx, hy), dot);
+    ASSERT_EQUAL(cusp::blas::nrm2(hx),    nrm2);
+
+    ASSERT_ALMOST_EQUAL(dot,  fast_dot);
+    ASSERT_ALMOST_EQUAL(nrm2, fast_nrm2);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestReproducibleReductions);
+
+void TestReproducibleDistributedReductions(void)
+{
+    typedef cusp::array1d<double, cusp::host_memory> HostArray;
+
+    const size_t N = 1000;
+
+    HostArray hx = unittest::random_samples<double>(N);
+    HostArray hy = unittest::random_samples<double>(N);
+
+    for (size_t i = 0; i < N; i++)
+        hx[i] = std::ldexp(hx[i] - 0.5, int(i % 41) - 20);
+
+    int device = 0;
+    cudaGetDevice(&device);
+
+    cusp::scoped_reduction_mode scope(cusp::reproducible_reduction);
+
+    const double dot  = cusp::blas::dot(hx, hy);
+    const double nrm2 = cusp::blas::nrm2(hx);
+
+    // the results do not depend on the number of partitions
+    for (size_t num_partitions = 1; num_partitions <= 5; num_partitions += 2)
+    {
+        cusp::distribution d(N, std::vector<int>(num_partitions, device));
+
+        cusp::distributed_array1d<double> x(d);
+        cusp::distributed_array1d<double> y(d);
+
+        x = hx;
+        y = hy;
+
+        ASSERT_EQUAL(cusp::blas::dot(x, y),  dot);
+        ASSERT_EQUAL(cusp::blas::dotc(x, y), dot);
+        ASSERT_EQUAL(cusp::blas::nrm2(x),    nrm2);
+    }
+}
+DECLARE_UNITTEST(TestReproducibleDistributedReductions);
+
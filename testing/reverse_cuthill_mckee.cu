@@ -0,0 +1,117 @@
+#include <unittest/unittest.h>
+
+#include <cusp/graph/reverse_cuthill_mckee.h>
+#include <cusp/graph/nested_dissection.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/permute.h>
+#include <cusp/gallery/poisson.h>
+
+#include <algorithm>
+#include <stdlib.h>
+
+template <typename ArrayType>
+bool is_permutation_of(const ArrayType& permutation, const size_t N)
+{
+    cusp::array1d<int, cusp::host_memory> p(permutation);
+
+    std::sort(p.begin(), p.end());
+
+    for (size_t i = 0; i < p.size(); i++)
+        if (p[i] != int(i))
+            return false;
+
+    return p.size() == N;
+}
+
+template <typename MatrixType>
+int bandwidth(const MatrixType& A)
+{
+    cusp::coo_matrix<int, float, cusp::host_memory> coo(A);
+
+    int b = 0;
+
+    for (size_t n = 0; n < coo.num_entries; n++)
+        b = std::max(b, abs(coo.row_indices[n] - coo.column_indices[n]));
+
+    return b;
+}
+
+// a 2d grid in random order
+void shuffled_grid(cusp::csr_matrix<int, float, cusp::host_memory>& A, const size_t nx, const size_t ny)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> G;
+    cusp::gallery::poisson5pt(G, nx, ny);
+
+    cusp::array1d<int, cusp::host_memory> P(G.num_rows);
+    for (size_t i = 0; i < P.size(); i++)
+        P[i] = int(i);
+
+    srand(13);
+    for (size_t i = P.size() - 1; i > 0; i--)
+        std::swap(P[i], P[rand() % (i + 1)]);
+
+    cusp::permute(G, P, A);
+}
+
+template <typename TestMatrix>
+void TestReverseCuthillMckee(void)
+{
+    typedef typename TestMatrix::memory_space MemorySpace;
+
+    cusp::csr_matrix<int, float, cusp::host_memory> G;
+    shuffled_grid(G, 40, 25);
+
+    TestMatrix A(G);
+
+    cusp::array1d<int, MemorySpace> permutation;
+    cusp::graph::reverse_cuthill_mckee(A, permutation);
+
+    ASSERT_EQUAL(is_permutation_of(permutation, A.num_rows), true);
+
+    TestMatrix B;
+    cusp::permute(A, permutation, B);
+
+    // the bandwidth of the grid in natural order is 25
+    ASSERT_EQUAL(bandwidth(B) <= 30, true);
+    ASSERT_EQUAL(bandwidth(A) > 100, true);
+
+    // disconnected and empty graphs
+    cusp::array2d<float, cusp::host_memory> D(5,5,0);
+    D(0,0) = 1; D(3,3) = 1; D(1,4) = 1; D(4,1) = 1;
+
+    cusp::graph::reverse_cuthill_mckee(TestMatrix(D), permutation);
+    ASSERT_EQUAL(is_permutation_of(permutation, 5), true);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestReverseCuthillMckee);
+
+template <typename TestMatrix>
+void TestNestedDissection(void)
+{
+    typedef typename TestMatrix::memory_space MemorySpace;
+
+    cusp::csr_matrix<int, float, cusp::host_memory> G;
+    shuffled_grid(G, 40, 25);
+
+    TestMatrix A(G);
+
+    cusp::array1d<int, MemorySpace> permutation;
+
+    cusp::graph::nested_dissection(A, permutation, 16);
+    ASSERT_EQUAL(is_permutation_of(permutation, A.num_rows), true);
+
+    // a single part
+    cusp::graph::nested_dissection(A, permutation, A.num_rows);
+    ASSERT_EQUAL(is_permutation_of(permutation, A.num_rows), true);
+
+    // disconnected and empty graphs
+    cusp::array2d<float, cusp::host_memory> D(5,5,0);
+    D(0,0) = 1; D(3,3) = 1; D(1,4) = 1; D(4,1) = 1;
+
+    cusp::graph::nested_dissection(TestMatrix(D), permutation, 1);
+    ASSERT_EQUAL(is_permutation_of(permutation, 5), true);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestNestedDissection);
@@ -0,0 +1,110 @@
+#include <unittest/unittest.h>
+
+#include <cusp/csr_matrix.h>
+#include <cusp/detail/device/row_binning.h>
+
+#include <thrust/fill.h>
+
+template <class MemorySpace>
+void TestRowBinningByLength(void)
+{
+    namespace device = cusp::detail::device;
+
+    // rows of length 0, 3, 1, 12, 300, 0, 9
+    const int lengths[7] = {0, 3, 1, 12, 300, 0, 9};
+
+    cusp::csr_matrix<int, float, cusp::host_memory> h_A(7, 300, 325);
+
+    h_A.row_offsets[0] = 0;
+    for (int i = 0; i < 7; i++)
+    {
+        h_A.row_offsets[i + 1] = h_A.row_offsets[i] + lengths[i];
+
+        for (int jj = h_A.row_offsets[i]; jj < h_A.row_offsets[i + 1]; jj++)
+        {
+            h_A.column_indices[jj] = jj - h_A.row_offsets[i];
+            h_A.values[jj]         = 1.0f;
+        }
+    }
+
+    cusp::csr_matrix<int, float, MemorySpace> A(h_A);
+
+    device::row_binning<int, MemorySpace> binning;
+
+    ASSERT_EQUAL(binning.is_valid(A), false);
+
+    const device::row_binning<int, MemorySpace>& bins = device::get_row_binning(A, binning);
+
+    ASSERT_EQUAL(&bins, &binning);
+    ASSERT_EQUAL(binning.is_valid(A), true);
+    ASSERT_EQUAL(binning.num_buckets(), (size_t) 4);
+
+    ASSERT_EQUAL(binning.bucket_size(device::empty_rows),  (size_t) 2);
+    ASSERT_EQUAL(binning.bucket_size(device::thread_rows), (size_t) 2);
+    ASSERT_EQUAL(binning.bucket_size(device::warp_rows),   (size_t) 2);
+    ASSERT_EQUAL(binning.bucket_size(device::block_rows),  (size_t) 1);
+
+    cusp::array1d<int, cusp::host_memory> empty(binning.bucket(device::empty_rows).begin(),  binning.bucket(device::empty_rows).end());
+    cusp::array1d<int, cusp::host_memory> thread(binning.bucket(device::thread_rows).begin(), binning.bucket(device::thread_rows).end());
+    cusp::array1d<int, cusp::host_memory> warp(binning.bucket(device::warp_rows).begin(),    binning.bucket(device::warp_rows).end());
+    cusp::array1d<int, cusp::host_memory> block(binning.bucket(device::block_rows).begin(),  binning.bucket(device::block_rows).end());
+
+    // rows of a bucket are in increasing order
+    ASSERT_EQUAL(empty[0],  0);
+    ASSERT_EQUAL(empty[1],  5);
+    ASSERT_EQUAL(thread[0], 1);
+    ASSERT_EQUAL(thread[1], 2);
+    ASSERT_EQUAL(warp[0],   3);
+    ASSERT_EQUAL(warp[1],   6);
+    ASSERT_EQUAL(block[0],  4);
+
+    // a matrix of another shape is binned again
+    A.resize(3, 3, 0);
+    thrust::fill(A.row_offsets.begin(), A.row_offsets.end(), 0);
+
+    ASSERT_EQUAL(binning.is_valid(A), false);
+
+    device::get_row_binning(A, binning);
+
+    ASSERT_EQUAL(binning.is_valid(A), true);
+    ASSERT_EQUAL(binning.bucket_size(device::empty_rows), (size_t) 3);
+    ASSERT_EQUAL(binning.bucket_size(device::block_rows), (size_t) 0);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestRowBinningByLength);
+
+template <class MemorySpace>
+void TestRowBinningBySize(void)
+{
+    namespace device = cusp::detail::device;
+
+    cusp::array1d<int, cusp::host_memory> h_sizes(6);
+    h_sizes[0] = 5; h_sizes[1] = 0; h_sizes[2] = 40; h_sizes[3] = 17; h_sizes[4] = 16; h_sizes[5] = 1;
+
+    cusp::array1d<int, MemorySpace> sizes(h_sizes);
+
+    // rows smaller than the first bound are in no bucket
+    const int bounds[2] = {1, 17};
+
+    device::row_binning<int, MemorySpace> binning;
+    device::bin_rows(sizes, bounds, 2, binning);
+
+    ASSERT_EQUAL(binning.num_buckets(), (size_t) 2);
+    ASSERT_EQUAL(binning.bucket_size(0), (size_t) 3);
+    ASSERT_EQUAL(binning.bucket_size(1), (size_t) 2);
+
+    cusp::array1d<int, cusp::host_memory> light(binning.bucket(0).begin(), binning.bucket(0).end());
+    cusp::array1d<int, cusp::host_memory> heavy(binning.bucket(1).begin(), binning.bucket(1).end());
+
+    ASSERT_EQUAL(light[0], 0);
+    ASSERT_EQUAL(light[1], 4);
+    ASSERT_EQUAL(light[2], 5);
+    ASSERT_EQUAL(heavy[0], 2);
+    ASSERT_EQUAL(heavy[1], 3);
+
+    const int decreasing[2] = {17, 1};
+
+    ASSERT_THROWS(device::bin_rows(sizes, decreasing, 2, binning), cusp::invalid_input_exception);
+    ASSERT_THROWS(device::bin_rows(sizes, bounds, 0, binning), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestRowBinningBySize);
+
@@ -0,0 +1,81 @@
+#include <unittest/unittest.h>
+
+#include <cusp/row_operations.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/convert.h>
+
+#include <cmath>
+
+template <typename Space>
+cusp::array2d<float, Space> row_operations_example(void)
+{
+    cusp::array2d<float, Space> A(4,4);
+    A(0,0) =  1.0;  A(0,1) = -2.0;  A(0,2) =  0.0;  A(0,3) =  0.0;
+    A(1,0) =  0.0;  A(1,1) =  0.0;  A(1,2) =  0.0;  A(1,3) =  0.0;
+    A(2,0) =  0.0;  A(2,1) =  3.0;  A(2,2) = -4.0;  A(2,3) =  0.0;
+    A(3,0) =  5.0;  A(3,1) =  0.0;  A(3,2) =  0.0;  A(3,3) = -1.0;
+    return A;
+}
+
+template <class Matrix>
+void TestRowReduce(void)
+{
+    typedef typename Matrix::memory_space Space;
+
+    Matrix A(row_operations_example<Space>());
+
+    cusp::array1d<float, Space> y;
+
+    cusp::row_reduce(A, y, cusp::row_sum());
+    ASSERT_EQUAL(y.size(), (size_t) 4);
+    ASSERT_EQUAL(y[0], -1.0f);
+    ASSERT_EQUAL(y[1],  0.0f);
+    ASSERT_EQUAL(y[2], -1.0f);
+    ASSERT_EQUAL(y[3],  4.0f);
+
+    cusp::row_reduce(A, y, cusp::row_max_abs());
+    ASSERT_EQUAL(y[0], 2.0f);
+    ASSERT_EQUAL(y[1], 0.0f);
+    ASSERT_EQUAL(y[2], 4.0f);
+    ASSERT_EQUAL(y[3], 5.0f);
+
+    cusp::row_reduce(A, y, cusp::row_norm2());
+    ASSERT_ALMOST_EQUAL(y[0], std::sqrt(5.0f));
+    ASSERT_EQUAL(y[1], 0.0f);
+    ASSERT_ALMOST_EQUAL(y[2], 5.0f);
+    ASSERT_ALMOST_EQUAL(y[3], std::sqrt(26.0f));
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestRowReduce);
+
+template <class Matrix>
+void TestScaleRowsAndColumns(void)
+{
+    typedef typename Matrix::memory_space Space;
+
+    cusp::array2d<float, cusp::host_memory> expected = row_operations_example<cusp::host_memory>();
+
+    cusp::array1d<float, cusp::host_memory> dr(4);
+    cusp::array1d<float, cusp::host_memory> dc(4);
+    dr[0] = 2.0;  dr[1] = 3.0;  dr[2] = 0.5;  dr[3] = -1.0;
+    dc[0] = 4.0;  dc[1] = 0.25; dc[2] = 2.0;  dc[3] =  3.0;
+
+    for (size_t i = 0; i < 4; i++)
+        for (size_t j = 0; j < 4; j++)
+            expected(i,j) *= dr[i] * dc[j];
+
+    Matrix A(row_operations_example<Space>());
+
+    cusp::scale_rows(A, cusp::array1d<float, Space>(dr));
+    cusp::scale_columns(A, cusp::array1d<float, Space>(dc));
+
+    cusp::array2d<float, cusp::host_memory> result(A);
+    ASSERT_EQUAL(result.values, expected.values);
+
+    // the factors must match the dimensions
+    ASSERT_THROWS((cusp::scale_rows(A, cusp::array1d<float, Space>(3))), cusp::invalid_input_exception);
+    ASSERT_THROWS((cusp::scale_columns(A, cusp::array1d<float, Space>(5))), cusp::invalid_input_exception);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestScaleRowsAndColumns);
+
@@ -0,0 +1,225 @@
+#include <unittest/unittest.h>
+
+#include <cusp/precond/ruge_stuben.h>
+
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+
+#include <cusp/gallery/diffusion.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/cg.h>
+
+#include <thrust/count.h>
+
+#include <vector>
+
+template <class MemorySpace>
+void TestClassicalStrengthOfConnection(void)
+{
+    cusp::array2d<float,cusp::host_memory> D(3,3);
+    D(0,0) =  4;  D(0,1) = -1;  D(0,2) = -3;
+    D(1,0) = -1;  D(1,1) =  4;  D(1,2) =  2;
+    D(2,0) = -2;  D(2,1) = -2;  D(2,2) =  4;
+
+    cusp::csr_matrix<int,float,MemorySpace> A(D);
+    cusp::csr_matrix<int,float,MemorySpace> S;
+
+    cusp::precond::detail::classical_strength_of_connection(A, S, 0.5);
+
+    // row 0: only -3 passes 0.5 * 3, row 1: the positive entry is never
+    // strong, row 2: both ties pass
+    cusp::array2d<float,cusp::host_memory> E(3,3,0);
+    E(0,2) = -3;
+    E(1,0) = -1;
+    E(2,0) = -2;  E(2,1) = -2;
+
+    ASSERT_EQUAL(S.num_entries, 4);
+    ASSERT_EQUAL(cusp::array2d<float,cusp::host_memory>(S).values, E.values);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestClassicalStrengthOfConnection);
+
+// C-points are not strongly connected and every F-point strongly depends
+// on a C-point
+template <typename Matrix, typename Array>
+void check_splitting(const Matrix& S, const Array& splitting)
+{
+    cusp::csr_matrix<int,float,cusp::host_memory> S_host(S);
+    cusp::array1d<int,cusp::host_memory> h_splitting(splitting);
+
+    for (size_t i = 0; i < S_host.num_rows; i++)
+    {
+        bool has_coarse_neighbor = false;
+
+        for (int jj = S_host.row_offsets[i]; jj < S_host.row_offsets[i + 1]; jj++)
+        {
+            const int j = S_host.column_indices[jj];
+
+            if (h_splitting[i] == 1)
+                ASSERT_EQUAL(h_splitting[j], 0);
+
+            has_coarse_neighbor = has_coarse_neighbor || h_splitting[j] == 1;
+        }
+
+        if (h_splitting[i] == 0)
+            ASSERT_EQUAL(has_coarse_neighbor, true);
+    }
+}
+
+template <class MemorySpace>
+void TestRugeStubenSplitting(void)
+{
+    typedef cusp::precond::ruge_stuben_options Options;
+
+    cusp::csr_matrix<int,float,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 12, 10);
+
+    cusp::csr_matrix<int,float,MemorySpace> S;
+    cusp::precond::detail::classical_strength_of_connection(A, S, 0.25);
+
+    cusp::array1d<int,MemorySpace> pmis;
+    cusp::precond::detail::ruge_stuben_splitting(S, pmis, Options::pmis);
+    check_splitting(S, pmis);
+
+    cusp::array1d<int,MemorySpace> hmis;
+    cusp::precond::detail::ruge_stuben_splitting(S, hmis, Options::hmis);
+    check_splitting(S, hmis);
+
+    // the splittings do not depend on the memory space
+    cusp::csr_matrix<int,float,cusp::host_memory> S_host(S);
+    cusp::array1d<int,cusp::host_memory> h_pmis;
+    cusp::precond::detail::ruge_stuben_splitting(S_host, h_pmis, Options::pmis);
+    ASSERT_EQUAL(h_pmis, cusp::array1d<int,cusp::host_memory>(pmis));
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestRugeStubenSplitting);
+
+template <class MemorySpace>
+void TestRugeStubenInterpolation(void)
+{
+    typedef cusp::precond::ruge_stuben_options Options;
+
+    // a graph Laplacian, whose zero row sums both interpolations preserve
+    cusp::csr_matrix<int,float,cusp::host_memory> L;
+    cusp::gallery::poisson5pt(L, 10, 10);
+
+    for (size_t i = 0; i < L.num_rows; i++)
+    {
+        float sum = 0;
+        for (int jj = L.row_offsets[i]; jj < L.row_offsets[i + 1]; jj++)
+            if (L.column_indices[jj] != (int) i)
+                sum += L.values[jj];
+        for (int jj = L.row_offsets[i]; jj < L.row_offsets[i + 1]; jj++)
+            if (L.column_indices[jj] == (int) i)
+                L.values[jj] = -sum;
+    }
+
+    cusp::csr_matrix<int,float,MemorySpace> A(L);
+
+    cusp::array1d<bool,MemorySpace> strong;
+    cusp::precond::detail::classical_strong_connections(A, strong, 0.25);
+
+    cusp::csr_matrix<int,float,MemorySpace> S;
+    cusp::precond::detail::compact_flagged_entries(A, strong, A.values, S);
+
+    cusp::array1d<int,MemorySpace> splitting;
+    cusp::precond::detail::ruge_stuben_splitting(S, splitting, Options::pmis);
+
+    const int num_coarse = thrust::count(splitting.begin(), splitting.end(), 1);
+
+    Options::interpolation_type interpolations[2] = { Options::direct, Options::extended_i };
+
+    for (int n = 0; n < 2; n++)
+    {
+        cusp::csr_matrix<int,float,MemorySpace> P;
+        cusp::precond::detail::ruge_stuben_prolongator(A, strong, splitting, P, interpolations[n]);
+
+        ASSERT_EQUAL(P.num_rows, A.num_rows);
+        ASSERT_EQUAL(P.num_cols, (size_t) num_coarse);
+
+        cusp::array1d<float,MemorySpace> ones(P.num_cols, 1.0f);
+        cusp::array1d<float,MemorySpace> y(P.num_rows);
+        cusp::multiply(P, ones, y);
+
+        ASSERT_ALMOST_EQUAL(y, cusp::array1d<float,MemorySpace>(P.num_rows, 1.0f));
+
+        // C-points are injected
+        cusp::csr_matrix<int,float,cusp::host_memory> P_host(P);
+        cusp::array1d<int,cusp::host_memory> h_splitting(splitting);
+
+        int coarse = 0;
+        for (size_t i = 0; i < P_host.num_rows; i++)
+        {
+            if (h_splitting[i] == 0)
+                continue;
+
+            ASSERT_EQUAL(P_host.row_offsets[i + 1] - P_host.row_offsets[i], 1);
+            ASSERT_EQUAL(P_host.column_indices[P_host.row_offsets[i]], coarse);
+            ASSERT_EQUAL(P_host.values[P_host.row_offsets[i]], 1.0f);
+            coarse++;
+        }
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestRugeStubenInterpolation);
+
+template <class MemorySpace>
+void TestRugeStuben(void)
+{
+    typedef int                 IndexType;
+    typedef float               ValueType;
+    typedef cusp::precond::ruge_stuben<IndexType,ValueType,MemorySpace> Preconditioner;
+    typedef cusp::precond::ruge_stuben_options Options;
+
+    // Poisson and a strongly anisotropic diffusion problem
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> problems[2];
+    cusp::gallery::poisson5pt(problems[0], 50, 50);
+    cusp::gallery::diffusion<cusp::gallery::FD>(problems[1], 50, 50, 0.001, 0.0);
+
+    std::vector<Options> configurations(4);
+    configurations[1].interpolation = Options::direct;
+    configurations[1].coarsening    = Options::hmis;
+    configurations[2].coarsening    = Options::hmis;
+    configurations[3].smoother      = Options::gauss_seidel;
+
+    for (size_t p = 0; p < 2; p++)
+    {
+        const cusp::csr_matrix<IndexType,ValueType,MemorySpace>& A = problems[p];
+
+        for (size_t n = 0; n < configurations.size(); n++)
+        {
+            configurations[n].coarse_size = 50;
+            Preconditioner M(A, configurations[n]);
+
+            ASSERT_EQUAL(M.grid_complexity() > 1.0, true);
+
+            cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+            cusp::array1d<ValueType,MemorySpace> x = unittest::random_samples<ValueType>(A.num_rows);
+
+            cusp::convergence_monitor<ValueType> monitor(b, 30, 1e-4);
+            cusp::krylov::cg(A, x, b, monitor, M);
+
+            ASSERT_EQUAL(monitor.converged(), true);
+        }
+    }
+
+    // as a solver
+    {
+        const cusp::csr_matrix<IndexType,ValueType,MemorySpace>& A = problems[0];
+
+        Preconditioner M(A);
+
+        cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+        cusp::array1d<ValueType,MemorySpace> x(A.num_rows, ValueType(0));
+
+        cusp::convergence_monitor<ValueType> monitor(b, 50, 1e-4);
+        M.solve(b, x, monitor);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+
+    // at least one level is required
+    Options options;
+    options.max_levels = 0;
+    ASSERT_THROWS(Preconditioner M(problems[0], options), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestRugeStuben);
@@ -0,0 +1,153 @@
+#include <unittest/unittest.h>
+#include <cusp/sell_matrix.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/random.h>
+
+template <class Space>
+void TestSellMatrixBasicConstructor(void)
+{
+    cusp::sell_matrix<int, float, Space> matrix(5, 6, 8, 12, 2, 4);
+
+    ASSERT_EQUAL(matrix.num_rows,               5);
+    ASSERT_EQUAL(matrix.num_cols,               6);
+    ASSERT_EQUAL(matrix.num_entries,            8);
+    ASSERT_EQUAL(matrix.slice_size,             2);
+    ASSERT_EQUAL(matrix.sorting_window,         4);
+    ASSERT_EQUAL(matrix.num_slices(),           3);
+    ASSERT_EQUAL(matrix.row_permutation.size(), 5);
+    ASSERT_EQUAL(matrix.slice_offsets.size(),   4);
+    ASSERT_EQUAL(matrix.column_indices.size(), 12);
+    ASSERT_EQUAL(matrix.values.size(),         12);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSellMatrixBasicConstructor);
+
+template <class Space>
+void TestSellMatrixConversion(void)
+{
+    // [10  0  0  0  0  0]
+    // [20  0 21 22  0 23]
+    // [ 0  0  0  0  0  0]
+    // [ 0 30  0  0 31  0]
+    // [ 0  0  0  0  0 40]
+    cusp::array2d<float, cusp::host_memory> A(5, 6, 0);
+    A(0,0) = 10;
+    A(1,0) = 20; A(1,2) = 21; A(1,3) = 22; A(1,5) = 23;
+    A(3,1) = 30; A(3,4) = 31;
+    A(4,5) = 40;
+
+    cusp::sell_matrix<int, float, Space> B(A, 2, 4);
+
+    ASSERT_EQUAL(B.num_entries,    8);
+    ASSERT_EQUAL(B.slice_size,     2);
+    ASSERT_EQUAL(B.sorting_window, 4);
+
+    cusp::sell_matrix<int, float, cusp::host_memory> H(B);
+
+    const int X = cusp::sell_matrix<int, float, cusp::host_memory>::invalid_index;
+
+    // rows sorted by length within [0,4) and [4,5)
+    ASSERT_EQUAL(H.row_permutation[0], 1);
+    ASSERT_EQUAL(H.row_permutation[1], 3);
+    ASSERT_EQUAL(H.row_permutation[2], 0);
+    ASSERT_EQUAL(H.row_permutation[3], 2);
+    ASSERT_EQUAL(H.row_permutation[4], 4);
+
+    // slices of width 4, 1 and 1
+    ASSERT_EQUAL(H.slice_offsets[0],  0);
+    ASSERT_EQUAL(H.slice_offsets[1],  8);
+    ASSERT_EQUAL(H.slice_offsets[2], 10);
+    ASSERT_EQUAL(H.slice_offsets[3], 12);
+
+    ASSERT_EQUAL(H.column_indices[0], 0); ASSERT_EQUAL(H.values[0], 20);
+    ASSERT_EQUAL(H.column_indices[1], 1); ASSERT_EQUAL(H.values[1], 30);
+    ASSERT_EQUAL(H.column_indices[2], 2); ASSERT_EQUAL(H.values[2], 21);
+    ASSERT_EQUAL(H.column_indices[3], 4); ASSERT_EQUAL(H.values[3], 31);
+    ASSERT_EQUAL(H.column_indices[4], 3); ASSERT_EQUAL(H.values[4], 22);
+    ASSERT_EQUAL(H.column_indices[5], X); ASSERT_EQUAL(H.values[5],  0);
+    ASSERT_EQUAL(H.column_indices[6], 5); ASSERT_EQUAL(H.values[6], 23);
+    ASSERT_EQUAL(H.column_indices[7], X); ASSERT_EQUAL(H.values[7],  0);
+    ASSERT_EQUAL(H.column_indices[8], 0); ASSERT_EQUAL(H.values[8], 10);
+    ASSERT_EQUAL(H.column_indices[9], X); ASSERT_EQUAL(H.values[9],  0);
+    ASSERT_EQUAL(H.column_indices[10], 5); ASSERT_EQUAL(H.values[10], 40);
+    ASSERT_EQUAL(H.column_indices[11], X); ASSERT_EQUAL(H.values[11],  0);
+
+    // convert back through CSR and COO
+    cusp::csr_matrix<int, float, Space> C(B);
+    cusp::coo_matrix<int, float, Space> D(B);
+
+    ASSERT_EQUAL(C.num_entries, 8);
+    ASSERT_EQUAL(D.num_entries, 8);
+
+    cusp::array2d<float, cusp::host_memory> E(C);
+    cusp::array2d<float, cusp::host_memory> F(D);
+    cusp::array2d<float, cusp::host_memory> G(B);
+
+    ASSERT_EQUAL(E == A, true);
+    ASSERT_EQUAL(F == A, true);
+    ASSERT_EQUAL(G == A, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSellMatrixConversion);
+
+template <class Space>
+void TestSellMatrixInvalidParameters(void)
+{
+    typedef cusp::sell_matrix<int, float, Space> SellMatrix;
+
+    cusp::csr_matrix<int, float, Space> A(2, 2, 0);
+    A.row_offsets[0] = 0; A.row_offsets[1] = 0; A.row_offsets[2] = 0;
+
+    SellMatrix B;
+    B.slice_size = 0;
+
+    ASSERT_THROWS(B = A, cusp::format_conversion_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSellMatrixInvalidParameters);
+
+template <class Space>
+void TestSellMatrixMultiply(void)
+{
+    cusp::coo_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::random(1003, 1001, 12000, A);
+
+    cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 7) - 3;
+
+    cusp::array1d<float, cusp::host_memory> y(A.num_rows, 0);
+    cusp::multiply(A, x, y);
+
+    const size_t slice_sizes[]     = {1, 32, 32, 128};
+    const size_t sorting_windows[] = {1,  1, 256, 128};
+
+    for (size_t n = 0; n < 4; n++)
+    {
+        cusp::sell_matrix<int, float, Space> B(A, slice_sizes[n], sorting_windows[n]);
+
+        cusp::array1d<float, Space> d_x(x);
+        cusp::array1d<float, Space> d_y(A.num_rows, 10);
+        cusp::multiply(B, d_x, d_y);
+
+        cusp::array1d<float, cusp::host_memory> z(d_y);
+
+        ASSERT_ALMOST_EQUAL(z, y);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSellMatrixMultiply);
+
+void TestSellMatrixRebind(void)
+{
+    typedef cusp::sell_matrix<int, float, cusp::host_memory> HostMatrix;
+    typedef HostMatrix::rebind<cusp::device_memory>::type    DeviceMatrix;
+
+    HostMatrix   h_matrix(10, 10, 50, 64, 4, 8);
+    DeviceMatrix d_matrix(h_matrix);
+
+    ASSERT_EQUAL(h_matrix.num_entries, d_matrix.num_entries);
+    ASSERT_EQUAL(d_matrix.slice_size,     4);
+    ASSERT_EQUAL(d_matrix.sorting_window, 8);
+}
+DECLARE_UNITTEST(TestSellMatrixRebind);
+
@@ -0,0 +1,87 @@
+#include <unittest/unittest.h>
+
+#include <cusp/graph/shortest_path.h>
+#include <cusp/graph/breadth_first_search.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/gallery/poisson.h>
+
+#include <thrust/fill.h>
+
+#include <limits>
+
+template <typename TestMatrix>
+void TestSingleSourceShortestPath(void)
+{
+    typedef typename TestMatrix::memory_space MemorySpace;
+
+    // the direct edge 0 -> 3 is longer than the path 0 -> 1 -> 2 -> 3,
+    // vertex 4 only has an edge to 0
+    cusp::array2d<float, cusp::host_memory> D(5,5,0);
+    D(0,1) = 1; D(0,3) = 7;
+    D(1,2) = 2; D(1,3) = 6;
+    D(2,3) = 1;
+    D(4,0) = 5;
+
+    TestMatrix A(D);
+
+    cusp::array1d<float, MemorySpace> distances;
+
+    ASSERT_EQUAL(cusp::graph::single_source_shortest_path(A, 0, distances), (size_t) 4);
+
+    ASSERT_EQUAL(distances[0], 0.0f);
+    ASSERT_EQUAL(distances[1], 1.0f);
+    ASSERT_EQUAL(distances[2], 3.0f);
+    ASSERT_EQUAL(distances[3], 4.0f);
+    ASSERT_EQUAL(distances[4], std::numeric_limits<float>::max());
+
+    cusp::graph::single_source_shortest_path(A, 4, distances);
+
+    ASSERT_EQUAL(distances[3], 9.0f);
+
+    ASSERT_THROWS(cusp::graph::single_source_shortest_path(A, 5, distances), cusp::invalid_input_exception);
+
+    D(2,1) = -1;
+    TestMatrix B(D);
+
+    ASSERT_THROWS(cusp::graph::single_source_shortest_path(B, 0, distances), cusp::invalid_input_exception);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestSingleSourceShortestPath);
+
+template <typename MemorySpace>
+void TestSingleSourceShortestPathGrid(void)
+{
+    // with unit weights the distances are the levels of a BFS
+    const int nx = 60, ny = 50;
+
+    cusp::csr_matrix<int, float, MemorySpace> G;
+    cusp::gallery::poisson5pt(G, nx, ny);
+
+    const int src = 20 * nx + 30;
+
+    cusp::array1d<int, MemorySpace> labels;
+    size_t num_levels = cusp::graph::breadth_first_search(G, src, labels);
+
+    thrust::fill(G.values.begin(), G.values.end(), 1.0f);
+
+    cusp::array1d<int, MemorySpace> distances;
+    size_t num_rounds = cusp::graph::single_source_shortest_path(G, src, distances);
+
+    ASSERT_EQUAL(num_rounds, num_levels);
+    ASSERT_EQUAL(distances, labels);
+
+    // doubling the weights doubles the distances
+    thrust::fill(G.values.begin(), G.values.end(), 2.0f);
+    cusp::graph::single_source_shortest_path(G, src, distances);
+
+    cusp::array1d<int, cusp::host_memory> h_labels(labels);
+    cusp::array1d<int, cusp::host_memory> h_distances(distances);
+
+    for (int i = 0; i < nx * ny; i++)
+        ASSERT_EQUAL(h_distances[i], 2 * h_labels[i]);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSingleSourceShortestPathGrid);
+
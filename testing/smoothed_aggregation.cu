@@ -13,6 +13,11 @@
 #include <cusp/krylov/cg.h>
 #include <cusp/print.h>
 
+#include <thrust/extrema.h>
+
+#include <sstream>
+#include <vector>
+
 template <class MemorySpace>
 void TestStandardAggregation(void)
 {
@@ -28,6 +33,95 @@ void TestStandardAggregation(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestStandardAggregation);
 
+template <typename Array>
+void check_aggregate_sizes(const Array& aggregates, const size_t max_size)
+{
+    cusp::array1d<int,cusp::host_memory> h_aggregates(aggregates);
+
+    const int num_aggregates = *thrust::max_element(h_aggregates.begin(), h_aggregates.end()) + 1;
+    std::vector<size_t> sizes(num_aggregates, 0);
+
+    for (size_t i = 0; i < h_aggregates.size(); i++)
+    {
+        ASSERT_EQUAL(h_aggregates[i] >= 0, true);
+        sizes[h_aggregates[i]]++;
+    }
+
+    for (int a = 0; a < num_aggregates; a++)
+    {
+        ASSERT_EQUAL(sizes[a] >= 1, true);
+        ASSERT_EQUAL(sizes[a] <= max_size, true);
+    }
+}
+
+template <class MemorySpace>
+void TestPairwiseAggregation(void)
+{
+    typedef typename cusp::precond::amg_container<int,float,MemorySpace>::setup_type SetupMatrixType;
+
+    SetupMatrixType A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<int,MemorySpace> aggregates(A.num_rows);
+
+    cusp::precond::detail::pairwise_aggregation(A, aggregates, 1);
+    check_aggregate_sizes(aggregates, 2);
+
+    cusp::precond::detail::pairwise_aggregation(A, aggregates, 2);
+    check_aggregate_sizes(aggregates, 4);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestPairwiseAggregation);
+
+template <class MemorySpace>
+void TestMisAggregation(void)
+{
+    typedef typename cusp::precond::amg_container<int,float,MemorySpace>::setup_type SetupMatrixType;
+
+    SetupMatrixType A;
+    cusp::gallery::poisson5pt(A, 10, 10);
+
+    cusp::array1d<int,MemorySpace> aggregates(A.num_rows);
+
+    cusp::precond::detail::mis_aggregation(A, aggregates, 0);
+    check_aggregate_sizes(aggregates, A.num_rows);
+
+    cusp::precond::detail::mis_aggregation(A, aggregates, 3);
+    check_aggregate_sizes(aggregates, 3);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMisAggregation);
+
+template <class MemorySpace>
+void TestSmoothedAggregationParallelAggregation(void)
+{
+    typedef cusp::precond::smoothed_aggregation<int,float,MemorySpace> Preconditioner;
+
+    cusp::coo_matrix<int,float,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 40, 40);
+
+    cusp::array1d<float,MemorySpace> b = unittest::random_samples<float>(A.num_rows);
+
+    cusp::precond::amg_options::aggregation_type methods[2] = { cusp::precond::amg_options::pairwise,
+                                                                cusp::precond::amg_options::mis };
+
+    for (int m = 0; m < 2; m++)
+    {
+        cusp::precond::amg_options options;
+        options.coarse_size        = 10;
+        options.aggregation        = methods[m];
+        options.max_aggregate_size = 9;
+
+        Preconditioner M(A, options);
+
+        cusp::array1d<float,MemorySpace> x(A.num_rows, 0.0f);
+
+        cusp::convergence_monitor<float> monitor(b, 60, 1e-4);
+        M.solve(b, x, monitor);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregationParallelAggregation);
+
 
 template <class MemorySpace>
 void TestEstimateRhoDinvA(void)
@@ -62,6 +156,28 @@ void TestEstimateRhoDinvA(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestEstimateRhoDinvA);
 
+template <class MemorySpace>
+void TestEstimateRhoDinvAWarmStart(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A; cusp::gallery::poisson5pt(A, 10, 10);
+    float rho = 1.9594929736144974;
+
+    cusp::detail::rho_Dinv_A_state<float, MemorySpace> state;
+
+    float cold = cusp::detail::estimate_rho_Dinv_A(A, state);
+    ASSERT_EQUAL((std::abs(cold - rho) / rho) < 0.1f, true);
+    ASSERT_EQUAL(state.x.size(), (size_t) A.num_rows);
+
+    // D^-1 A is unchanged, the Ritz vector of the last estimate is kept
+    cusp::blas::scal(A.values, 2.0f);
+
+    float warm = cusp::detail::estimate_rho_Dinv_A(A, state);
+    ASSERT_EQUAL(warm >= 0.999f * cold, true);
+    ASSERT_EQUAL(warm <= 1.001f * rho, true);
+    ASSERT_EQUAL(state.rho, warm);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestEstimateRhoDinvAWarmStart);
+
 
 template <typename MemorySpace>
 void TestFitCandidates(void)
@@ -135,6 +251,65 @@ void TestFitCandidates(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestFitCandidates);
 
+template <typename MemorySpace>
+void TestFitCandidatesMultiple(void)
+{
+    typedef typename cusp::precond::amg_container<int,float,MemorySpace>::setup_type SetupMatrixType;
+
+    // 1D elasticity-like candidates: constant and linear modes
+    cusp::array1d<int,cusp::host_memory> h_aggregates(7);
+    h_aggregates[0] = 0; h_aggregates[1] = 0; h_aggregates[2] = 0;
+    h_aggregates[3] = -1;
+    h_aggregates[4] = 1; h_aggregates[5] = 1; h_aggregates[6] = 1;
+
+    cusp::array2d<float,cusp::host_memory> h_B(7, 2);
+    for (int i = 0; i < 7; i++)
+    {
+        h_B(i,0) = 1.0f;
+        h_B(i,1) = float(i);
+    }
+
+    cusp::array1d<int,MemorySpace> aggregates(h_aggregates);
+    cusp::array2d<float,MemorySpace> B(h_B);
+
+    SetupMatrixType Q;
+    cusp::array2d<float,MemorySpace> R;
+
+    cusp::precond::detail::fit_candidates(aggregates, B, Q, R);
+
+    ASSERT_EQUAL(Q.num_rows,    (size_t) 7);
+    ASSERT_EQUAL(Q.num_cols,    (size_t) 4);
+    ASSERT_EQUAL(Q.num_entries, (size_t) 12);
+    ASSERT_EQUAL(R.num_rows,    (size_t) 4);
+    ASSERT_EQUAL(R.num_cols,    (size_t) 2);
+
+    // Q has orthonormal columns and Q R = B on the aggregated nodes
+    cusp::array2d<float,cusp::host_memory> h_Q(Q), h_R(R);
+
+    for (int a = 0; a < 4; a++)
+    {
+        for (int b = 0; b < 4; b++)
+        {
+            float dot = 0.0f;
+            for (int i = 0; i < 7; i++)
+                dot += h_Q(i,a) * h_Q(i,b);
+            ASSERT_ALMOST_EQUAL(dot, a == b ? 1.0f : 0.0f);
+        }
+    }
+
+    for (int i = 0; i < 7; i++)
+    {
+        for (int c = 0; c < 2; c++)
+        {
+            float v = 0.0f;
+            for (int a = 0; a < 4; a++)
+                v += h_Q(i,a) * h_R(a,c);
+            ASSERT_ALMOST_EQUAL(v, h_aggregates[i] < 0 ? 0.0f : h_B(i,c));
+        }
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestFitCandidatesMultiple);
+
 
 template <class MemorySpace>
 void TestSmoothProlongator(void)
@@ -270,6 +445,556 @@ void TestSmoothedAggregation(void)
 DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregation);
 
 
+template <class MemorySpace>
+void TestSmoothedAggregationOptions(void)
+{
+    typedef int                 IndexType;
+    typedef float               ValueType;
+    typedef cusp::precond::smoothed_aggregation<IndexType,ValueType,MemorySpace> Preconditioner;
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 50, 50);
+
+    cusp::precond::amg_options options;
+    options.max_levels        = 3;
+    options.coarse_size       = 10;
+    options.presmooth_sweeps  = 2;
+    options.postsmooth_sweeps = 2;
+    options.collect_timings   = true;
+
+    Preconditioner M1(A, options);
+
+    // two levels are coarsened and the third is factored
+    ASSERT_EQUAL(M1.setup_timings().size(), 3);
+
+    // implicit restriction gives the same cycle
+    options.store_restriction = false;
+    Preconditioner M2(A, options);
+
+    {
+        cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+        cusp::array1d<ValueType,MemorySpace> x1(A.num_rows, ValueType(0));
+        cusp::array1d<ValueType,MemorySpace> x2(A.num_rows, ValueType(0));
+
+        M1(b, x1);
+        M2(b, x2);
+
+        cusp::array1d<ValueType,cusp::host_memory> h1(x1);
+        cusp::array1d<ValueType,cusp::host_memory> h2(x2);
+
+        for (size_t i = 0; i < h1.size(); i++)
+            ASSERT_EQUAL(std::abs(h1[i] - h2[i]) <= 1e-3f * (1.0f + std::abs(h1[i])), true);
+    }
+
+    // restriction with the transpose of the stored prolongator
+    options.transpose_prolongator = true;
+    Preconditioner M3(A, options);
+    options.transpose_prolongator = false;
+
+    {
+        cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+        cusp::array1d<ValueType,MemorySpace> x1(A.num_rows, ValueType(0));
+        cusp::array1d<ValueType,MemorySpace> x3(A.num_rows, ValueType(0));
+
+        M1(b, x1);
+        M3(b, x3);
+
+        cusp::array1d<ValueType,cusp::host_memory> h1(x1);
+        cusp::array1d<ValueType,cusp::host_memory> h3(x3);
+
+        for (size_t i = 0; i < h1.size(); i++)
+            ASSERT_EQUAL(std::abs(h1[i] - h3[i]) <= 1e-3f * (1.0f + std::abs(h1[i])), true);
+    }
+
+    // polynomial smoother as preconditioner
+    {
+        options.smoother = cusp::precond::amg_options::polynomial;
+        Preconditioner M(A, options);
+
+        cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+        cusp::array1d<ValueType,MemorySpace> x = unittest::random_samples<ValueType>(A.num_rows);
+
+        cusp::convergence_monitor<ValueType> monitor(b, 20, 1e-4);
+        cusp::krylov::cg(A, x, b, monitor, M);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+
+    // Gauss-Seidel smoother as preconditioner
+    {
+        options.smoother = cusp::precond::amg_options::gauss_seidel;
+        Preconditioner M(A, options);
+
+        cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+        cusp::array1d<ValueType,MemorySpace> x = unittest::random_samples<ValueType>(A.num_rows);
+
+        cusp::convergence_monitor<ValueType> monitor(b, 20, 1e-4);
+        cusp::krylov::cg(A, x, b, monitor, M);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+
+    // Chebyshev smoother as preconditioner
+    {
+        options.smoother = cusp::precond::amg_options::chebyshev;
+        Preconditioner M(A, options);
+
+        cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+        cusp::array1d<ValueType,MemorySpace> x = unittest::random_samples<ValueType>(A.num_rows);
+
+        cusp::convergence_monitor<ValueType> monitor(b, 20, 1e-4);
+        cusp::krylov::cg(A, x, b, monitor, M);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+
+    // at least one level is required
+    options.max_levels = 0;
+    ASSERT_THROWS(Preconditioner M(A, options), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregationOptions);
+
+template <class MemorySpace>
+void TestSmoothedAggregationMemoryFootprint(void)
+{
+    typedef int                 IndexType;
+    typedef float               ValueType;
+    typedef cusp::precond::smoothed_aggregation<IndexType,ValueType,MemorySpace> Preconditioner;
+
+    cusp::csr_matrix<IndexType,ValueType,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 50, 50);
+
+    cusp::precond::amg_options options;
+    options.max_levels      = 3;
+    options.coarse_size     = 10;
+    options.collect_timings = true;
+
+    Preconditioner M(A, options);
+
+    // a peak is recorded with every timing
+    ASSERT_EQUAL(M.setup_peak_bytes().size(), M.setup_timings().size());
+
+    // the finest level holds at least the setup and solve copies of A
+    const size_t A_bytes = (A.num_rows + 1) * sizeof(IndexType) + A.num_entries * (sizeof(IndexType) + sizeof(ValueType));
+    ASSERT_EQUAL(M.level_bytes(0) >= 2 * A_bytes, true);
+
+    // one timing per level, the last one covers the coarse factorization
+    size_t total = 0;
+    for (size_t i = 0; i < M.setup_timings().size(); i++)
+    {
+        ASSERT_EQUAL(M.level_bytes(i) > 0, true);
+        total += M.level_bytes(i);
+    }
+    ASSERT_EQUAL(M.memory_footprint(), total);
+
+    // device setup peaks count the finest level, which is built first
+    if (thrust::detail::is_convertible<MemorySpace, cusp::device_memory>::value)
+        ASSERT_EQUAL(M.setup_peak_bytes()[0] >= A_bytes, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregationMemoryFootprint);
+
+
+template <class MemorySpace>
+void TestSmoothedAggregationUnsmoothed(void)
+{
+    typedef int                 IndexType;
+    typedef float               ValueType;
+    typedef cusp::precond::smoothed_aggregation<IndexType,ValueType,MemorySpace> Preconditioner;
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 50, 50);
+
+    cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+
+    cusp::precond::amg_options options;
+    options.coarse_size = 10;
+
+    Preconditioner M1(A, options);
+
+    options.unsmoothed_aggregation = true;
+    options.cycle                  = cusp::precond::amg_options::K_cycle;
+    Preconditioner M2(A, options);
+
+    // neither P nor R is stored on the finest level
+    ASSERT_EQUAL(M2.level_bytes(0) < M1.level_bytes(0), true);
+
+    // as preconditioner
+    {
+        cusp::array1d<ValueType,MemorySpace> x = unittest::random_samples<ValueType>(A.num_rows);
+
+        cusp::convergence_monitor<ValueType> monitor(b, 40, 1e-4);
+        cusp::krylov::cg(A, x, b, monitor, M2);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+
+    // resetup gives the cycle of a new hierarchy
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> A2(A);
+    cusp::blas::scal(A2.values, ValueType(2));
+
+    Preconditioner M3(A2, options);
+    M2.resetup(A2);
+
+    {
+        cusp::array1d<ValueType,MemorySpace> x2(A.num_rows, ValueType(0));
+        cusp::array1d<ValueType,MemorySpace> x3(A.num_rows, ValueType(0));
+
+        M2(b, x2);
+        M3(b, x3);
+
+        cusp::array1d<ValueType,cusp::host_memory> h2(x2);
+        cusp::array1d<ValueType,cusp::host_memory> h3(x3);
+
+        for (size_t i = 0; i < h2.size(); i++)
+            ASSERT_EQUAL(std::abs(h2[i] - h3[i]) <= 1e-3f * (1.0f + std::abs(h2[i])), true);
+    }
+
+    // and so does a saved hierarchy
+    {
+        std::stringstream stream;
+        M3.save(stream);
+
+        Preconditioner M4;
+        M4.load(stream);
+
+        cusp::array1d<ValueType,MemorySpace> x3(A.num_rows, ValueType(0));
+        cusp::array1d<ValueType,MemorySpace> x4(A.num_rows, ValueType(0));
+
+        M3(b, x3);
+        M4(b, x4);
+
+        ASSERT_EQUAL(x3, x4);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregationUnsmoothed);
+
+template <class MemorySpace>
+void TestSmoothedAggregationKrylovSolve(void)
+{
+    typedef int                 IndexType;
+    typedef float               ValueType;
+    typedef cusp::precond::smoothed_aggregation<IndexType,ValueType,MemorySpace> Preconditioner;
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 50, 50);
+
+    cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+
+    cusp::precond::amg_options options;
+    options.coarse_size = 10;
+
+    size_t stationary_iterations;
+    {
+        Preconditioner M(A, options);
+
+        cusp::array1d<ValueType,MemorySpace> x(A.num_rows, ValueType(0));
+        cusp::convergence_monitor<ValueType> monitor(b, 100, 1e-5);
+        M.solve(b, x, monitor);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+        stationary_iterations = monitor.iteration_count();
+    }
+
+    options.solver = cusp::precond::amg_options::cg;
+    {
+        Preconditioner M(A, options);
+
+        // the workspace is reused by the second solve
+        for (int solve = 0; solve < 2; solve++)
+        {
+            cusp::array1d<ValueType,MemorySpace> x(A.num_rows, ValueType(0));
+            cusp::convergence_monitor<ValueType> monitor(b, 100, 1e-5);
+            M.solve(b, x, monitor);
+
+            ASSERT_EQUAL(monitor.converged(), true);
+            ASSERT_EQUAL(monitor.iteration_count() <= stationary_iterations, true);
+
+            // the recurrence residual matches the true residual
+            cusp::array1d<ValueType,MemorySpace> r(A.num_rows);
+            cusp::residual(A, x, b, r);
+            ASSERT_EQUAL(cusp::blas::nrm2(r) <= 2e-5 * cusp::blas::nrm2(b), true);
+        }
+    }
+
+    // flexible GMRES also accepts the variable K-cycle
+    options.solver = cusp::precond::amg_options::gmres;
+    options.cycle  = cusp::precond::amg_options::K_cycle;
+    options.gmres_restart = 10;
+    {
+        Preconditioner M(A, options);
+
+        cusp::array1d<ValueType,MemorySpace> x(A.num_rows, ValueType(0));
+        cusp::convergence_monitor<ValueType> monitor(b, 100, 1e-5);
+        M.solve(b, x, monitor);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+        ASSERT_EQUAL(monitor.iteration_count() <= stationary_iterations, true);
+
+        cusp::array1d<ValueType,MemorySpace> r(A.num_rows);
+        cusp::residual(A, x, b, r);
+        ASSERT_EQUAL(cusp::blas::nrm2(r) <= 2e-5 * cusp::blas::nrm2(b), true);
+    }
+
+    options.gmres_restart = 0;
+    {
+        Preconditioner M(A, options);
+
+        cusp::array1d<ValueType,MemorySpace> x(A.num_rows, ValueType(0));
+        ASSERT_THROWS(M.solve(b, x), cusp::invalid_input_exception);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregationKrylovSolve);
+
+template <class MemorySpace>
+void TestSmoothedAggregationCycles(void)
+{
+    typedef int                 IndexType;
+    typedef float               ValueType;
+    typedef cusp::precond::smoothed_aggregation<IndexType,ValueType,MemorySpace> Preconditioner;
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 50, 50);
+
+    cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+
+    cusp::precond::amg_options::cycle_type cycles[4] = { cusp::precond::amg_options::V_cycle,
+                                                         cusp::precond::amg_options::W_cycle,
+                                                         cusp::precond::amg_options::F_cycle,
+                                                         cusp::precond::amg_options::K_cycle };
+
+    double V_rate = 1.0;
+
+    for (int c = 0; c < 4; c++)
+    {
+        cusp::precond::amg_options options;
+        options.coarse_size = 10;
+        options.cycle       = cycles[c];
+
+        Preconditioner M(A, options);
+
+        cusp::array1d<ValueType,MemorySpace> x(A.num_rows, ValueType(0));
+
+        cusp::convergence_monitor<ValueType> monitor(b, 40, 1e-4);
+        M.solve(b, x, monitor);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+
+        // the stronger cycles converge at least about as fast as the V-cycle
+        if (c == 0)
+            V_rate = monitor.geometric_rate();
+        else
+            ASSERT_EQUAL(monitor.geometric_rate() <= 1.1 * V_rate, true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregationCycles);
+
+
+template <class MemorySpace>
+void TestSmoothedAggregationMixedPrecision(void)
+{
+    typedef int                 IndexType;
+
+    cusp::coo_matrix<IndexType,double,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 50, 50);
+
+    // float hierarchy for a double system
+    cusp::precond::smoothed_aggregation<IndexType,float,MemorySpace> M(A);
+
+    cusp::array1d<double,MemorySpace> b = unittest::random_samples<double>(A.num_rows);
+    cusp::array1d<double,MemorySpace> x(A.num_rows, 0.0);
+
+    cusp::convergence_monitor<double> monitor(b, 40, 1e-10);
+    cusp::krylov::cg(A, x, b, monitor, M);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregationMixedPrecision);
+
+
+template <class MemorySpace>
+void TestSmoothedAggregationCaptureCycle(void)
+{
+    typedef int                 IndexType;
+    typedef float               ValueType;
+    typedef cusp::precond::smoothed_aggregation<IndexType,ValueType,MemorySpace> Preconditioner;
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 50, 50);
+
+    cusp::precond::amg_options options;
+    options.coarse_size = 10;
+
+    Preconditioner M1(A, options);
+
+    options.capture_cycle = true;
+    Preconditioner M2(A, options);
+
+    // the first application runs directly, the second is captured and
+    // the third replays the graph
+    for (int step = 0; step < 3; step++)
+    {
+        cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+        cusp::array1d<ValueType,MemorySpace> x1(A.num_rows, ValueType(0));
+        cusp::array1d<ValueType,MemorySpace> x2(A.num_rows, ValueType(0));
+
+        const ValueType * storage = thrust::raw_pointer_cast(&x2[0]);
+
+        M1(b, x1);
+        M2(b, x2);
+
+        // the cycle writes to the storage of the caller
+        ASSERT_EQUAL(thrust::raw_pointer_cast(&x2[0]) == storage, true);
+
+        ASSERT_EQUAL(x1, x2);
+    }
+
+    // as preconditioner, and after resetup, which discards the graph
+    {
+        cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+        cusp::array1d<ValueType,MemorySpace> x(A.num_rows, ValueType(0));
+
+        cusp::convergence_monitor<ValueType> monitor(b, 20, 1e-4);
+        cusp::krylov::cg(A, x, b, monitor, M2);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+
+        M2.resetup(A);
+
+        cusp::blas::fill(x, ValueType(0));
+
+        cusp::convergence_monitor<ValueType> monitor2(b, 20, 1e-4);
+        cusp::krylov::cg(A, x, b, monitor2, M2);
+
+        ASSERT_EQUAL(monitor2.converged(), true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregationCaptureCycle);
+
+
+template <class MemorySpace>
+void TestSmoothedAggregationResetup(void)
+{
+    typedef int                 IndexType;
+    typedef float               ValueType;
+    typedef cusp::precond::smoothed_aggregation<IndexType,ValueType,MemorySpace> Preconditioner;
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 50, 50);
+
+    // same pattern, scaled values
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> A2(A);
+    cusp::blas::scal(A2.values, ValueType(2));
+
+    Preconditioner M(A);
+    Preconditioner M2(A2);
+
+    cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+
+    for (int step = 0; step < 2; step++)
+    {
+        M.resetup(A2);
+
+        cusp::array1d<ValueType,MemorySpace> x1(A.num_rows, ValueType(0));
+        cusp::array1d<ValueType,MemorySpace> x2(A.num_rows, ValueType(0));
+
+        M(b, x1);
+        M2(b, x2);
+
+        cusp::array1d<ValueType,cusp::host_memory> h1(x1);
+        cusp::array1d<ValueType,cusp::host_memory> h2(x2);
+
+        for (size_t i = 0; i < h1.size(); i++)
+            ASSERT_EQUAL(std::abs(h1[i] - h2[i]) <= 1e-3f * (1.0f + std::abs(h1[i])), true);
+    }
+
+    // as preconditioner after resetup
+    {
+        cusp::array1d<ValueType,MemorySpace> x = unittest::random_samples<ValueType>(A.num_rows);
+
+        cusp::convergence_monitor<ValueType> monitor(b, 20, 1e-4);
+        cusp::krylov::cg(A2, x, b, monitor, M);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+
+    // the pattern must not change
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> B;
+    cusp::gallery::poisson5pt(B, 40, 40);
+    ASSERT_THROWS(M.resetup(B), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregationResetup);
+
+
+template <class MemorySpace>
+void TestSmoothedAggregationSaveLoad(void)
+{
+    typedef int                 IndexType;
+    typedef float               ValueType;
+    typedef cusp::precond::smoothed_aggregation<IndexType,ValueType,MemorySpace> Preconditioner;
+
+    cusp::coo_matrix<IndexType,ValueType,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 50, 50);
+
+    cusp::array1d<ValueType,MemorySpace> b = unittest::random_samples<ValueType>(A.num_rows);
+
+    std::vector<cusp::precond::amg_options> configurations(3);
+    configurations[1].smoother          = cusp::precond::amg_options::polynomial;
+    configurations[1].store_restriction = false;
+    configurations[2].smoother          = cusp::precond::amg_options::chebyshev;
+    configurations[2].cycle             = cusp::precond::amg_options::W_cycle;
+
+    for (size_t n = 0; n < configurations.size(); n++)
+    {
+        Preconditioner M(A, configurations[n]);
+
+        std::stringstream stream;
+        M.save(stream);
+
+        Preconditioner M2;
+        M2.load(stream);
+
+        ASSERT_EQUAL(M2.operator_complexity(), M.operator_complexity());
+        ASSERT_EQUAL(M2.grid_complexity(),     M.grid_complexity());
+
+        // the loaded hierarchy applies the same cycle
+        cusp::array1d<ValueType,MemorySpace> x1(A.num_rows, ValueType(0));
+        cusp::array1d<ValueType,MemorySpace> x2(A.num_rows, ValueType(0));
+
+        M(b, x1);
+        M2(b, x2);
+
+        ASSERT_EQUAL(x1, x2);
+
+        // and can be set up again for new values
+        cusp::coo_matrix<IndexType,ValueType,MemorySpace> A2(A);
+        cusp::blas::scal(A2.values, ValueType(2));
+        M2.resetup(A2);
+
+        cusp::array1d<ValueType,MemorySpace> x = unittest::random_samples<ValueType>(A.num_rows);
+        cusp::convergence_monitor<ValueType> monitor(b, 20, 1e-4);
+        cusp::krylov::cg(A2, x, b, monitor, M2);
+
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+
+    // streams of other types or contents are rejected
+    {
+        Preconditioner M(A);
+
+        std::stringstream stream;
+        M.save(stream);
+
+        cusp::precond::smoothed_aggregation<IndexType,double,MemorySpace> M2;
+        ASSERT_THROWS(M2.load(stream), cusp::io_exception);
+
+        std::stringstream garbage("not a hierarchy, not a hierarchy, not a hierarchy, not a hierarchy");
+        Preconditioner M3;
+        ASSERT_THROWS(M3.load(garbage), cusp::io_exception);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSmoothedAggregationSaveLoad);
+
+
 template <typename SparseMatrix>
 void TestSymmetricStrengthOfConnection(void)
 {
@@ -346,3 +1071,84 @@ void TestSymmetricStrengthOfConnection(void)
 }
 DECLARE_SPARSE_MATRIX_UNITTEST(TestSymmetricStrengthOfConnection);
 
+template <class SparseMatrix>
+void TestSymmetricStrengthOfConnectionRowOffsets(void)
+{
+  typedef typename SparseMatrix::index_type   IndexType;
+  typedef typename SparseMatrix::memory_space MemorySpace;
+  typedef cusp::array2d<float,cusp::host_memory> Matrix;
+
+  Matrix M(4,4);
+  M(0,0) =  3; M(0,1) =  0; M(0,2) =  1; M(0,3) =  2;
+  M(1,0) =  0; M(1,1) =  4; M(1,2) =  3; M(1,3) =  4;
+  M(2,0) = -1; M(2,1) = -3; M(2,2) =  5; M(2,3) =  5;
+  M(3,0) = -2; M(3,1) = -4; M(3,2) = -5; M(3,3) =  6;
+
+  SparseMatrix A = M;
+
+  for (int k = 0; k < 3; k++)
+  {
+    const double theta = 0.45 * k;
+
+    SparseMatrix S, S_reference;
+    cusp::array1d<IndexType,MemorySpace> row_offsets;
+
+    cusp::precond::detail::symmetric_strength_of_connection(A, S, row_offsets, theta);
+    cusp::precond::detail::symmetric_strength_of_connection(A, S_reference, theta);
+
+    ASSERT_EQUAL(Matrix(S) == Matrix(S_reference), true);
+
+    cusp::csr_matrix<IndexType,float,cusp::host_memory> S_csr(S);
+    cusp::array1d<IndexType,cusp::host_memory> expected(S_csr.row_offsets), result(row_offsets);
+    ASSERT_EQUAL(result, expected);
+  }
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestSymmetricStrengthOfConnectionRowOffsets);
+
+
+template <typename SparseMatrix>
+void TestResidualAndRestrict(void)
+{
+  typedef typename SparseMatrix::memory_space MemorySpace;
+
+  cusp::csr_matrix<int,float,cusp::host_memory> A_host;
+  cusp::gallery::poisson5pt(A_host, 6, 5);
+
+  // piecewise constant interpolation from aggregates of three rows
+  cusp::coo_matrix<int,float,cusp::host_memory> P_host(A_host.num_rows, (A_host.num_rows + 2) / 3, A_host.num_rows);
+  for (size_t i = 0; i < A_host.num_rows; i++)
+  {
+    P_host.row_indices[i]    = i;
+    P_host.column_indices[i] = i / 3;
+    P_host.values[i]         = 0.5f + float(i % 3);
+  }
+
+  SparseMatrix A(A_host);
+  SparseMatrix P(P_host);
+
+  cusp::array1d<float,MemorySpace> x = unittest::random_samples<float>(A.num_rows);
+  cusp::array1d<float,MemorySpace> b = unittest::random_samples<float>(A.num_rows);
+
+  // reference: b_coarse = P^T (b - A x)
+  cusp::array1d<float,MemorySpace> r(A.num_rows);
+  cusp::array1d<float,MemorySpace> expected(P.num_cols);
+  cusp::residual(A, x, b, r);
+  cusp::multiply_transpose(P, r, expected);
+
+  cusp::array1d<float,MemorySpace> workspace(A.num_rows);
+  cusp::array1d<float,MemorySpace> b_coarse(P.num_cols, -1.0f);
+  cusp::detail::residual_and_restrict(A, x, b, P, workspace, b_coarse);
+
+  ASSERT_ALMOST_EQUAL(b_coarse, expected);
+
+  // x <- x + P x_coarse
+  cusp::array1d<float,MemorySpace> x_coarse = unittest::random_samples<float>(P.num_cols);
+  cusp::array1d<float,MemorySpace> correction(A.num_rows);
+  cusp::multiply(P, x_coarse, correction);
+  cusp::blas::axpy(x, correction, 1.0f);
+
+  cusp::detail::prolong_and_correct(P, x_coarse, x);
+
+  ASSERT_ALMOST_EQUAL(x, correction);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestResidualAndRestrict);
@@ -0,0 +1,125 @@
+#include <unittest/unittest.h>
+
+#include <cusp/precond/spai.h>
+
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/krylov/bicgstab.h>
+#include <cusp/krylov/gmres.h>
+
+template <class MemorySpace>
+void TestSPAIFullPattern(void)
+{
+    // the pattern of A^4 is full, so M is the inverse of A
+    cusp::array2d<float, cusp::host_memory> D(5,5,0.0f);
+    for (int i = 0; i < 5; i++)
+    {
+        D(i,i) = 4.0f;
+        if (i > 0) D(i,i-1) = -1.0f;
+        if (i < 4) D(i,i+1) = -2.0f;
+    }
+    D(3,0) = 0.5f;
+
+    cusp::csr_matrix<int, float, MemorySpace> A(D);
+
+    cusp::precond::spai<float, MemorySpace> M(A, 4);
+
+    ASSERT_EQUAL(M.matrix().num_entries, (size_t) 25);
+
+    cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(5);
+    cusp::array1d<float, MemorySpace> b(5);
+    cusp::array1d<float, MemorySpace> y(5);
+
+    cusp::multiply(A, x, b);
+    cusp::multiply(M, b, y);
+
+    ASSERT_ALMOST_EQUAL(y, x);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSPAIFullPattern);
+
+template <class MemorySpace>
+void TestSPAIDiagonal(void)
+{
+    cusp::array2d<float, cusp::host_memory> D(4,4,0.0f);
+    D(0,0) = 2.0f; D(1,1) = -4.0f; D(2,2) = 0.5f; D(3,3) = 8.0f;
+
+    cusp::csr_matrix<int, float, MemorySpace> A(D);
+
+    cusp::precond::spai<float, MemorySpace> M(A);
+
+    cusp::array1d<float, cusp::host_memory> values(M.matrix().values);
+
+    ASSERT_ALMOST_EQUAL(values[0],  0.5f);
+    ASSERT_ALMOST_EQUAL(values[1], -0.25f);
+    ASSERT_ALMOST_EQUAL(values[2],  2.0f);
+    ASSERT_ALMOST_EQUAL(values[3],  0.125f);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSPAIDiagonal);
+
+template <class MemorySpace>
+void TestSPAIPoisson(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 30);
+
+    cusp::precond::spai<float, MemorySpace> M1(A);
+    cusp::precond::spai<float, MemorySpace> M2(A, 2);
+
+    ASSERT_EQUAL(M1.matrix().num_entries, A.num_entries);
+    ASSERT_EQUAL(M2.matrix().num_entries > A.num_entries, true);
+
+    cusp::array1d<float, MemorySpace> b = unittest::random_samples<float>(A.num_rows);
+
+    // unpreconditioned iterations
+    size_t iterations;
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+        cusp::krylov::gmres(A, x, b, 30, monitor);
+        ASSERT_EQUAL(monitor.converged(), true);
+        iterations = monitor.iteration_count();
+    }
+
+    size_t iterations1;
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+        cusp::krylov::gmres(A, x, b, 30, monitor, M1);
+        ASSERT_EQUAL(monitor.converged(), true);
+        ASSERT_EQUAL(monitor.iteration_count() < iterations, true);
+        iterations1 = monitor.iteration_count();
+    }
+
+    // a larger pattern is a better approximation
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+        cusp::krylov::gmres(A, x, b, 30, monitor, M2);
+        ASSERT_EQUAL(monitor.converged(), true);
+        ASSERT_EQUAL(monitor.iteration_count() <= iterations1, true);
+    }
+
+    {
+        cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+        cusp::default_monitor<float> monitor(b, 500, 1e-5);
+        cusp::krylov::bicgstab(A, x, b, monitor, M2);
+        ASSERT_EQUAL(monitor.converged(), true);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSPAIPoisson);
+
+void TestSPAIErrors(void)
+{
+    // rows 0 and 1 are equal
+    cusp::array2d<float, cusp::host_memory> D(2,2,1.0f);
+    cusp::csr_matrix<int, float, cusp::host_memory> A(D);
+
+    ASSERT_THROWS((cusp::precond::spai<float, cusp::host_memory>(A)), cusp::runtime_exception);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> B(3, 2, 0);
+    ASSERT_THROWS((cusp::precond::spai<float, cusp::host_memory>(B)), cusp::invalid_input_exception);
+}
+DECLARE_UNITTEST(TestSPAIErrors);
@@ -0,0 +1,138 @@
+#include <unittest/unittest.h>
+
+#include <cusp/sparse_engine.h>
+
+#include <cusp/array1d.h>
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/transpose.h>
+#include <cusp/triangular_solve.h>
+#include <cusp/gallery/poisson.h>
+
+void TestSparseEngineSelection(void)
+{
+    const cusp::sparse_engine initial = cusp::current_sparse_engine();
+
+    // without cuSPARSE the default is always the built-in engine
+    if (!cusp::cusparse_available())
+        ASSERT_EQUAL(initial, cusp::builtin_engine);
+
+    {
+        cusp::scoped_sparse_engine outer(cusp::cusparse_engine);
+        ASSERT_EQUAL(cusp::current_sparse_engine(), cusp::cusparse_engine);
+
+        {
+            cusp::scoped_sparse_engine inner(cusp::builtin_engine);
+            ASSERT_EQUAL(cusp::current_sparse_engine(), cusp::builtin_engine);
+        }
+
+        ASSERT_EQUAL(cusp::current_sparse_engine(), cusp::cusparse_engine);
+
+        // a scope takes precedence over the default
+        cusp::set_sparse_engine(cusp::builtin_engine);
+        ASSERT_EQUAL(cusp::current_sparse_engine(), cusp::cusparse_engine);
+    }
+
+    ASSERT_EQUAL(cusp::current_sparse_engine(), cusp::builtin_engine);
+
+    cusp::set_sparse_engine(initial);
+    ASSERT_EQUAL(cusp::current_sparse_engine(), initial);
+}
+DECLARE_UNITTEST(TestSparseEngineSelection);
+
+template <typename ValueType, typename Orientation>
+void CompareSparseEngineProducts(void)
+{
+    typedef cusp::csr_matrix<int, ValueType, cusp::device_memory> Matrix;
+    typedef cusp::array1d<ValueType, cusp::device_memory>          Vector;
+    typedef cusp::array2d<ValueType, cusp::device_memory, Orientation> Dense;
+
+    Matrix A;
+    cusp::gallery::poisson5pt(A, 6, 5);
+
+    // make A unsymmetric, its triangles remain diagonally dominant
+    cusp::array1d<ValueType, cusp::host_memory> values(A.values);
+    cusp::array1d<ValueType, cusp::host_memory> noise = unittest::random_samples<ValueType>(A.num_entries);
+    for (size_t n = 0; n < values.size(); n++)
+        values[n] += noise[n] / ValueType(10);
+    A.values = values;
+
+    Vector x = unittest::random_samples<ValueType>(A.num_cols);
+
+    cusp::array2d<ValueType, cusp::host_memory> B_host(A.num_cols, 3);
+    for (size_t i = 0; i < B_host.num_rows; i++)
+        for (size_t j = 0; j < B_host.num_cols; j++)
+            B_host(i,j) = ValueType(i + 2 * j) / ValueType(10);
+    Dense B(B_host);
+
+    Vector y[2];
+    Dense  C[2];
+    Matrix AA[2];
+    Matrix At[2];
+    Vector z[2];
+
+    const cusp::sparse_engine engines[2] = { cusp::builtin_engine, cusp::cusparse_engine };
+
+    for (int i = 0; i < 2; i++)
+    {
+        cusp::scoped_sparse_engine scope(engines[i]);
+
+        y[i].resize(A.num_rows);
+        cusp::multiply(A, x, y[i]);
+
+        C[i].resize(A.num_rows, B.num_cols);
+        cusp::multiply(A, B, C[i]);
+
+        cusp::multiply(A, A, AA[i]);
+
+        cusp::transpose(A, At[i]);
+
+        z[i].resize(A.num_rows);
+        cusp::triangular_solve(A, y[i], z[i], true);
+    }
+
+    ASSERT_ALMOST_EQUAL(y[1], y[0]);
+    ASSERT_ALMOST_EQUAL(C[1].values, C[0].values);
+    ASSERT_ALMOST_EQUAL(z[1], z[0]);
+
+    // compare the patterns and values of the sparse results
+    ASSERT_EQUAL(AA[1].row_offsets,    AA[0].row_offsets);
+    ASSERT_EQUAL(AA[1].column_indices, AA[0].column_indices);
+    ASSERT_ALMOST_EQUAL(AA[1].values,  AA[0].values);
+
+    ASSERT_EQUAL(At[1].num_rows,       At[0].num_rows);
+    ASSERT_EQUAL(At[1].row_offsets,    At[0].row_offsets);
+    ASSERT_EQUAL(At[1].column_indices, At[0].column_indices);
+    ASSERT_EQUAL(At[1].values,         At[0].values);
+}
+
+void TestSparseEngineProducts(void)
+{
+    CompareSparseEngineProducts<float,  cusp::column_major>();
+    CompareSparseEngineProducts<float,  cusp::row_major>();
+    CompareSparseEngineProducts<double, cusp::column_major>();
+}
+DECLARE_UNITTEST(TestSparseEngineProducts);
+
+void TestSparseEngineFallback(void)
+{
+    // index types other than int use the built-in kernels with either engine
+    cusp::csr_matrix<long, float, cusp::device_memory> A;
+    cusp::gallery::poisson5pt(A, 4, 4);
+
+    cusp::array1d<float, cusp::device_memory> x(A.num_cols, 1.0f);
+    cusp::array1d<float, cusp::device_memory> y(A.num_rows);
+
+    cusp::scoped_sparse_engine scope(cusp::cusparse_engine);
+
+    cusp::multiply(A, x, y);
+
+    // the rows of the 5-point stencil sum to the number of missing neighbors
+    cusp::array1d<float, cusp::host_memory> y_host(y);
+
+    ASSERT_EQUAL(y_host[0], 2.0f);
+    ASSERT_EQUAL(y_host[5], 0.0f);
+}
+DECLARE_UNITTEST(TestSparseEngineFallback);
+
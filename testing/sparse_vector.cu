@@ -0,0 +1,171 @@
+#include <unittest/unittest.h>
+
+#include <cusp/sparse_vector.h>
+
+#include <cusp/array1d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/transpose.h>
+
+#include <cusp/gallery/poisson.h>
+
+// the dense vector of a sparse vector
+template <typename SparseVector>
+cusp::array1d<float,cusp::host_memory> dense_vector(const SparseVector& x)
+{
+    const cusp::sparse_vector<int,float,cusp::host_memory> x_(x);
+
+    cusp::array1d<float,cusp::host_memory> v(x_.length, 0.0f);
+
+    for (size_t k = 0; k < x_.num_entries; k++)
+        v[x_.indices[k]] = x_.values[k];
+
+    return v;
+}
+
+template <class MemorySpace>
+void TestSparseVector(void)
+{
+    cusp::sparse_vector<int,float,MemorySpace> x(6,2);
+    x.indices[0] = 4; x.values[0] = 20.0f;
+    x.indices[1] = 1; x.values[1] = 10.0f;
+
+    cusp::sparse_vector<int,float,cusp::host_memory> y(x);
+
+    ASSERT_EQUAL(y.length,      (size_t) 6);
+    ASSERT_EQUAL(y.num_entries, (size_t) 2);
+    ASSERT_EQUAL(y.indices[0], 4);
+    ASSERT_EQUAL(y.values[1],  10.0f);
+
+    cusp::sparse_vector<int,float,MemorySpace> z;
+    z.swap(x);
+
+    ASSERT_EQUAL(x.length,      (size_t) 0);
+    ASSERT_EQUAL(x.num_entries, (size_t) 0);
+    ASSERT_EQUAL(z.length,      (size_t) 6);
+
+    z.resize(8, 3);
+
+    ASSERT_EQUAL(z.length,         (size_t) 8);
+    ASSERT_EQUAL(z.num_entries,    (size_t) 3);
+    ASSERT_EQUAL(z.indices.size(), (size_t) 3);
+    ASSERT_EQUAL(z.values.size(),  (size_t) 3);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSparseVector);
+
+template <class MemorySpace>
+void TestMultiplySparseVector(void)
+{
+    // A = [10  0 20  0]
+    //     [ 0  0  0  0]
+    //     [ 0 30  0 40]
+    //     [50  0 -5  0]
+    cusp::coo_matrix<int,float,cusp::host_memory> B(4,4,6);
+    B.row_indices[0] = 0; B.column_indices[0] = 0; B.values[0] = 10;
+    B.row_indices[1] = 0; B.column_indices[1] = 2; B.values[1] = 20;
+    B.row_indices[2] = 2; B.column_indices[2] = 1; B.values[2] = 30;
+    B.row_indices[3] = 2; B.column_indices[3] = 3; B.values[3] = 40;
+    B.row_indices[4] = 3; B.column_indices[4] = 0; B.values[4] = 50;
+    B.row_indices[5] = 3; B.column_indices[5] = 2; B.values[5] = -5;
+
+    cusp::csr_matrix<int,float,MemorySpace> A(B);
+
+    // x = [1 0 10 0]
+    cusp::sparse_vector<int,float,MemorySpace> x(4,2);
+    x.indices[0] = 2; x.values[0] = 10;
+    x.indices[1] = 0; x.values[1] =  1;
+
+    {
+        cusp::sparse_vector<int,float,MemorySpace> y;
+        cusp::multiply(A, x, y);
+
+        // the sum of row 3 vanishes but the entry is stored
+        cusp::sparse_vector<int,float,cusp::host_memory> h(y);
+        ASSERT_EQUAL(h.length,      (size_t) 4);
+        ASSERT_EQUAL(h.num_entries, (size_t) 2);
+        ASSERT_EQUAL(h.indices[0], 0); ASSERT_EQUAL(h.values[0], 210.0f);
+        ASSERT_EQUAL(h.indices[1], 3); ASSERT_EQUAL(h.values[1],   0.0f);
+    }
+
+    {
+        cusp::sparse_vector<int,float,MemorySpace> y;
+        cusp::multiply_transpose(A, x, y);
+
+        cusp::sparse_vector<int,float,cusp::host_memory> h(y);
+        ASSERT_EQUAL(h.length,      (size_t) 4);
+        ASSERT_EQUAL(h.num_entries, (size_t) 2);
+        ASSERT_EQUAL(h.indices[0], 0); ASSERT_EQUAL(h.values[0], 10.0f);
+        ASSERT_EQUAL(h.indices[1], 2); ASSERT_EQUAL(h.values[1], 20.0f);
+    }
+
+    {
+        // other formats use CSR
+        cusp::coo_matrix<int,float,MemorySpace> C(B);
+        cusp::sparse_vector<int,float,MemorySpace> y;
+        cusp::multiply(C, x, y);
+
+        ASSERT_EQUAL(y.num_entries, (size_t) 2);
+    }
+
+    {
+        cusp::sparse_vector<int,float,MemorySpace> empty(4,0);
+        cusp::sparse_vector<int,float,MemorySpace> y(4,4);
+        cusp::multiply(A, empty, y);
+
+        ASSERT_EQUAL(y.length,      (size_t) 4);
+        ASSERT_EQUAL(y.num_entries, (size_t) 0);
+    }
+
+    {
+        cusp::sparse_vector<int,float,MemorySpace> z(5,0);
+        cusp::sparse_vector<int,float,MemorySpace> y;
+
+        ASSERT_THROWS(cusp::multiply(A, z, y), cusp::invalid_input_exception);
+        ASSERT_THROWS(cusp::multiply_transpose(A, z, y), cusp::invalid_input_exception);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMultiplySparseVector);
+
+template <class MemorySpace>
+void TestMultiplySparseVectorFrontiers(void)
+{
+    cusp::csr_matrix<int,float,MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 10, 12);
+
+    cusp::csr_matrix<int,float,MemorySpace> At;
+    cusp::transpose(A, At);
+
+    // frontiers of 1, 5 and 60 vertices, the last uses the dense accumulator
+    const size_t sizes[3] = {1, 5, 60};
+
+    for (size_t n = 0; n < 3; n++)
+    {
+        cusp::sparse_vector<int,float,cusp::host_memory> h(A.num_cols, sizes[n]);
+
+        for (size_t k = 0; k < sizes[n]; k++)
+        {
+            h.indices[k] = (7 * k + 3) % A.num_cols;
+            h.values[k]  = float(k % 5) - 1.5f;
+        }
+
+        cusp::sparse_vector<int,float,MemorySpace> x(h);
+
+        cusp::array1d<float,MemorySpace> x_dense(dense_vector(x));
+        cusp::array1d<float,MemorySpace> y_dense(A.num_rows);
+
+        cusp::multiply(A, x_dense, y_dense);
+
+        cusp::sparse_vector<int,float,MemorySpace> y;
+        cusp::sparse_vector<int,float,MemorySpace> z;
+
+        cusp::multiply(A, x, y);
+        cusp::multiply_transpose(At, x, z);
+
+        ASSERT_EQUAL(dense_vector(y), cusp::array1d<float,cusp::host_memory>(y_dense));
+        ASSERT_EQUAL(dense_vector(z), cusp::array1d<float,cusp::host_memory>(y_dense));
+
+        ASSERT_EQUAL(y.indices, z.indices);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestMultiplySparseVectorFrontiers);
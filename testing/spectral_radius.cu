@@ -51,3 +51,35 @@ void TestEstimateSpectralRadius(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestEstimateSpectralRadius);
 
+
+template <class MemorySpace>
+void TestArnoldiLanczos(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A; cusp::gallery::poisson5pt(A, 4, 4);
+
+    cusp::array2d<float, cusp::host_memory> H;
+    cusp::array2d<float, cusp::host_memory> T;
+
+    cusp::krylov::arnoldi(A, H, 5);
+    cusp::krylov::lanczos(A, T, 5);
+
+    ASSERT_EQUAL(H.num_rows, 5);
+    ASSERT_EQUAL(H.num_cols, 5);
+    ASSERT_EQUAL(T.num_rows, 5);
+    ASSERT_EQUAL(T.num_cols, 5);
+
+    // the same starting vector yields the same (tridiagonal) matrix for symmetric A
+    for (size_t i = 0; i < 5; i++)
+    {
+        for (size_t j = 0; j < 5; j++)
+        {
+            if (i > j + 1)
+                ASSERT_EQUAL(H(i,j), 0.0f);
+            if (i > j + 1 || j > i + 1)
+                ASSERT_EQUAL(T(i,j), 0.0f);
+            else
+                ASSERT_ALMOST_EQUAL(H(i,j), T(i,j));
+        }
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestArnoldiLanczos);
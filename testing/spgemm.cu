@@ -0,0 +1,65 @@
+#include <unittest/unittest.h>
+
+#include <cusp/spgemm.h>
+
+#include <cusp/array2d.h>
+#include <cusp/blas.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/gallery/random.h>
+
+template <class MemorySpace>
+void TestSpgemmSymbolicNumeric(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 6, 5);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> P_host;
+    cusp::gallery::random(30, 12, 40, P_host);
+    cusp::csr_matrix<int, float, MemorySpace> P(P_host);
+
+    cusp::spgemm_plan<int, MemorySpace> plan;
+    cusp::spgemm_symbolic(A, P, plan);
+
+    ASSERT_EQUAL(plan.num_rows, 30);
+    ASSERT_EQUAL(plan.num_cols, 12);
+
+    cusp::csr_matrix<int, float, MemorySpace> C;
+    cusp::spgemm_numeric(A, P, plan, C);
+
+    cusp::array2d<float, cusp::host_memory> dA(A), dP(P);
+    cusp::array2d<float, cusp::host_memory> reference;
+    cusp::multiply(dA, dP, reference);
+
+    ASSERT_EQUAL(reference == cusp::array2d<float, cusp::host_memory>(C), true);
+
+    // change the values of A and reuse the plan
+    cusp::blas::scal(A.values, 2.0f);
+    A.values[0] = 0.0f;
+
+    cusp::spgemm_numeric(A, P, plan, C);
+
+    ASSERT_EQUAL(C.num_entries, plan.num_entries);
+
+    dA = A;
+    cusp::multiply(dA, dP, reference);
+
+    ASSERT_EQUAL(reference == cusp::array2d<float, cusp::host_memory>(C), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSpgemmSymbolicNumeric);
+
+template <class MemorySpace>
+void TestSpgemmNumericMismatch(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A, B, C;
+    cusp::gallery::poisson5pt(A, 4, 4);
+    cusp::gallery::poisson5pt(B, 3, 3);
+
+    cusp::spgemm_plan<int, MemorySpace> plan;
+    cusp::spgemm_symbolic(A, A, plan);
+
+    ASSERT_THROWS(cusp::spgemm_numeric(B, B, plan, C), cusp::invalid_input_exception);
+    ASSERT_THROWS(cusp::spgemm_symbolic(A, B, plan),   cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSpgemmNumericMismatch);
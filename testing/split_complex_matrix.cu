@@ -0,0 +1,126 @@
+#include <unittest/unittest.h>
+
+#include <cusp/split_complex_matrix.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+typedef cusp::complex<float> Complex;
+
+// poisson5pt with complex values and a long first row, so that the HYB
+// format has a COO part
+void split_complex_test_matrix(cusp::csr_matrix<int, Complex, cusp::host_memory>& matrix, size_t n)
+{
+    cusp::coo_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::poisson5pt(A, n, n);
+
+    cusp::coo_matrix<int, Complex, cusp::host_memory> B(A.num_rows, A.num_cols, 0);
+    for (size_t i = 0; i < A.num_entries; i++)
+    {
+        if (A.row_indices[i] == 0)
+            continue;
+        B.row_indices.push_back(A.row_indices[i]);
+        B.column_indices.push_back(A.column_indices[i]);
+        B.values.push_back(Complex(A.values[i], float(i % 3) - 1));
+    }
+    for (size_t j = 0; j < A.num_cols; j += 2)
+    {
+        B.row_indices.push_back(0);
+        B.column_indices.push_back(j);
+        B.values.push_back(Complex(float(j % 5) + 1, float(j % 4) - 2));
+    }
+    B.num_entries = B.values.size();
+    B.sort_by_row_and_column();
+
+    matrix = B;
+}
+
+template <typename RealMatrix, typename Space>
+void CompareSplitComplexMultiply(const cusp::csr_matrix<int, Complex, cusp::host_memory>& A)
+{
+    typedef cusp::split_complex_matrix<RealMatrix> Matrix;
+
+    cusp::array1d<Complex, cusp::host_memory> x(A.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = Complex(float(i % 7) - 3, float(i % 3));
+
+    cusp::array1d<Complex, cusp::host_memory> y(A.num_rows);
+    cusp::multiply(A, x, y);
+
+    Matrix B(A);
+
+    ASSERT_EQUAL(B.num_rows,    A.num_rows);
+    ASSERT_EQUAL(B.num_cols,    A.num_cols);
+    ASSERT_EQUAL(B.num_entries, A.num_entries);
+
+    cusp::array1d<Complex, Space> d_x(x);
+    cusp::array1d<Complex, Space> d_y(A.num_rows, Complex(10, 10));
+    cusp::multiply(B, d_x, d_y);
+
+    ASSERT_EQUAL(d_y, y);
+
+    // the parts combine into the original matrix
+    cusp::csr_matrix<int, Complex, cusp::host_memory> C;
+    B.merge(C);
+
+    ASSERT_EQUAL(C.row_offsets,    A.row_offsets);
+    ASSERT_EQUAL(C.column_indices, A.column_indices);
+    ASSERT_EQUAL(C.values,         A.values);
+}
+
+template <class Space>
+void TestSplitComplexMatrixMultiply(void)
+{
+    cusp::csr_matrix<int, Complex, cusp::host_memory> A;
+    split_complex_test_matrix(A, 20);
+
+    CompareSplitComplexMultiply<cusp::csr_matrix<int, float, Space>, Space>(A);
+    CompareSplitComplexMultiply<cusp::ell_matrix<int, float, Space>, Space>(A);
+    CompareSplitComplexMultiply<cusp::hyb_matrix<int, float, Space>, Space>(A);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSplitComplexMatrixMultiply);
+
+template <class Space>
+void TestSplitComplexMatrixHybParts(void)
+{
+    typedef cusp::split_complex_matrix< cusp::hyb_matrix<int, float, Space> > Matrix;
+
+    cusp::csr_matrix<int, Complex, cusp::host_memory> A;
+    split_complex_test_matrix(A, 10);
+
+    Matrix B(A);
+
+    // the imaginary parts of the ELL portion, padding included, come first
+    ASSERT_EQUAL(B.real.coo.num_entries > 0, true);
+    ASSERT_EQUAL(B.imag.size(), B.real.ell.values.values.size() + B.real.coo.num_entries);
+
+    // copies to another memory space keep both parts
+    cusp::split_complex_matrix< cusp::hyb_matrix<int, float, cusp::host_memory> > C(B);
+    ASSERT_EQUAL(C.imag, B.imag);
+
+    cusp::coo_matrix<int, Complex, cusp::host_memory> D;
+    C.merge(D);
+
+    cusp::array2d<Complex, cusp::host_memory> E(A);
+    cusp::array2d<Complex, cusp::host_memory> F(D);
+    ASSERT_EQUAL(E == F, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSplitComplexMatrixHybParts);
+
+template <class Space>
+void TestSplitComplexMatrixEmpty(void)
+{
+    cusp::csr_matrix<int, Complex, cusp::host_memory> A(0, 0, 0);
+
+    cusp::split_complex_matrix< cusp::csr_matrix<int, float, Space> > B(A);
+
+    cusp::array1d<Complex, Space> x;
+    cusp::array1d<Complex, Space> y;
+    cusp::multiply(B, x, y);
+
+    ASSERT_EQUAL(B.num_rows, 0);
+    ASSERT_EQUAL(B.imag.size(), 0);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSplitComplexMatrixEmpty);
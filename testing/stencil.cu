@@ -1,6 +1,8 @@
 #include <unittest/unittest.h>
 
 #include <cusp/gallery/stencil.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
 
 void TestGenerateMatrixFromStencil1d(void)
 {
@@ -75,3 +77,93 @@ void TestGenerateMatrixFromStencil2d(void)
 }
 DECLARE_UNITTEST(TestGenerateMatrixFromStencil2d);
 
+template <class MemorySpace>
+void TestGenerateMatrixFromStencilCsr(void)
+{
+    typedef int   IndexType;
+    typedef float ValueType;
+    typedef thrust::tuple<IndexType,IndexType>    StencilIndex;
+    typedef thrust::tuple<StencilIndex,ValueType> StencilPoint;
+
+    // unsorted points, one of which is zero
+    cusp::array1d<StencilPoint, cusp::host_memory> stencil;
+
+    stencil.push_back(StencilPoint(StencilIndex( 0,  2), 5));
+    stencil.push_back(StencilPoint(StencilIndex( 1,  0), 4));
+    stencil.push_back(StencilPoint(StencilIndex(-1, -1), 1));
+    stencil.push_back(StencilPoint(StencilIndex( 1,  1), 0));
+    stencil.push_back(StencilPoint(StencilIndex( 0,  0), 3));
+    stencil.push_back(StencilPoint(StencilIndex(-1,  0), 2));
+
+    cusp::csr_matrix<int, float, MemorySpace> matrix;
+    cusp::gallery::generate_matrix_from_stencil(matrix, stencil, StencilIndex(2,3));
+
+    cusp::csr_matrix<int, float, cusp::host_memory> R(matrix);
+
+    ASSERT_EQUAL(R.num_rows,    6);
+    ASSERT_EQUAL(R.num_entries, 16);
+
+    ASSERT_EQUAL(R.row_offsets[0], 0);
+    ASSERT_EQUAL(R.row_offsets[1], 3);
+    ASSERT_EQUAL(R.row_offsets[2], 6);
+    ASSERT_EQUAL(R.row_offsets[3], 8);
+    ASSERT_EQUAL(R.row_offsets[4], 11);
+    ASSERT_EQUAL(R.row_offsets[5], 13);
+    ASSERT_EQUAL(R.row_offsets[6], 16);
+
+    ASSERT_EQUAL(R.column_indices[0], 0); ASSERT_EQUAL(R.values[0], 3);
+    ASSERT_EQUAL(R.column_indices[1], 1); ASSERT_EQUAL(R.values[1], 4);
+    ASSERT_EQUAL(R.column_indices[2], 4); ASSERT_EQUAL(R.values[2], 5);
+    ASSERT_EQUAL(R.column_indices[3], 0); ASSERT_EQUAL(R.values[3], 2);
+    ASSERT_EQUAL(R.column_indices[4], 1); ASSERT_EQUAL(R.values[4], 3);
+    ASSERT_EQUAL(R.column_indices[5], 5); ASSERT_EQUAL(R.values[5], 5);
+    ASSERT_EQUAL(R.column_indices[6], 2); ASSERT_EQUAL(R.values[6], 3);
+    ASSERT_EQUAL(R.column_indices[7], 3); ASSERT_EQUAL(R.values[7], 4);
+    ASSERT_EQUAL(R.column_indices[8], 0); ASSERT_EQUAL(R.values[8], 1);
+    ASSERT_EQUAL(R.column_indices[9], 2); ASSERT_EQUAL(R.values[9], 2);
+    ASSERT_EQUAL(R.column_indices[10], 3); ASSERT_EQUAL(R.values[10], 3);
+    ASSERT_EQUAL(R.column_indices[11], 4); ASSERT_EQUAL(R.values[11], 3);
+    ASSERT_EQUAL(R.column_indices[12], 5); ASSERT_EQUAL(R.values[12], 4);
+    ASSERT_EQUAL(R.column_indices[13], 2); ASSERT_EQUAL(R.values[13], 1);
+    ASSERT_EQUAL(R.column_indices[14], 4); ASSERT_EQUAL(R.values[14], 2);
+    ASSERT_EQUAL(R.column_indices[15], 5); ASSERT_EQUAL(R.values[15], 3);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGenerateMatrixFromStencilCsr);
+
+template <class MemorySpace>
+void TestGenerateMatrixFromStencilCsr3d(void)
+{
+    typedef int   IndexType;
+    typedef float ValueType;
+    typedef thrust::tuple<IndexType,IndexType,IndexType> StencilIndex;
+    typedef thrust::tuple<StencilIndex,ValueType>        StencilPoint;
+
+    cusp::array1d<StencilPoint, cusp::host_memory> stencil;
+
+    stencil.push_back(StencilPoint(StencilIndex( 0,  0, -1), -1));
+    stencil.push_back(StencilPoint(StencilIndex( 0, -1,  0), -2));
+    stencil.push_back(StencilPoint(StencilIndex(-1,  0,  0), -3));
+    stencil.push_back(StencilPoint(StencilIndex( 0,  0,  0),  6));
+    stencil.push_back(StencilPoint(StencilIndex( 1,  0,  0), -4));
+    stencil.push_back(StencilPoint(StencilIndex( 0,  1,  0), -5));
+    stencil.push_back(StencilPoint(StencilIndex( 2,  1,  1), -6));
+
+    // the csr matrix matches the one converted from dia
+    cusp::dia_matrix<int, float, cusp::host_memory> dia;
+    cusp::gallery::generate_matrix_from_stencil(dia, stencil, StencilIndex(5,4,3));
+
+    cusp::csr_matrix<int, float, MemorySpace> matrix;
+    cusp::gallery::generate_matrix_from_stencil(matrix, stencil, StencilIndex(5,4,3));
+
+    cusp::csr_matrix<int, float, cusp::host_memory> E(dia);
+    cusp::csr_matrix<int, float, cusp::host_memory> R(matrix);
+
+    ASSERT_EQUAL(R.num_rows,    E.num_rows);
+    ASSERT_EQUAL(R.num_cols,    E.num_cols);
+    ASSERT_EQUAL(R.num_entries, E.num_entries);
+    ASSERT_EQUAL(R.row_offsets,    E.row_offsets);
+    ASSERT_EQUAL(R.column_indices, E.column_indices);
+    ASSERT_EQUAL(R.values,         E.values);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestGenerateMatrixFromStencilCsr3d);
+
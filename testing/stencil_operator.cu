@@ -0,0 +1,117 @@
+#include <unittest/unittest.h>
+
+#include <cusp/gallery/stencil_operator.h>
+#include <cusp/gallery/poisson.h>
+
+#include <cusp/csr_matrix.h>
+#include <cusp/monitor.h>
+#include <cusp/multiply.h>
+#include <cusp/krylov/cg.h>
+
+template <typename MemorySpace, typename Operator, typename Matrix>
+void CompareStencilOperator(const Operator& A, const Matrix& B)
+{
+    ASSERT_EQUAL(A.num_rows,    B.num_rows);
+    ASSERT_EQUAL(A.num_cols,    B.num_cols);
+    ASSERT_EQUAL(A.num_entries, B.num_entries);
+
+    cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(B.num_rows);
+    cusp::array1d<float, MemorySpace> y1(B.num_rows);
+    cusp::array1d<float, MemorySpace> y2(B.num_rows);
+
+    cusp::multiply(A, x, y1);
+    cusp::multiply(B, x, y2);
+
+    ASSERT_ALMOST_EQUAL(y1, y2);
+}
+
+template <class MemorySpace>
+void TestStencilOperatorPoisson(void)
+{
+    {
+        cusp::gallery::stencil_operator<float, MemorySpace> A;
+        cusp::csr_matrix<int, float, MemorySpace> B;
+        cusp::gallery::poisson5pt(A, 37, 19);
+        cusp::gallery::poisson5pt(B, 37, 19);
+        CompareStencilOperator<MemorySpace>(A, B);
+    }
+
+    {
+        cusp::gallery::stencil_operator<float, MemorySpace> A;
+        cusp::csr_matrix<int, float, MemorySpace> B;
+        cusp::gallery::poisson9pt(A, 40, 9);
+        cusp::gallery::poisson9pt(B, 40, 9);
+        CompareStencilOperator<MemorySpace>(A, B);
+    }
+
+    {
+        cusp::gallery::stencil_operator<float, MemorySpace> A;
+        cusp::csr_matrix<int, float, MemorySpace> B;
+        cusp::gallery::poisson7pt(A, 33, 10, 7);
+        cusp::gallery::poisson7pt(B, 33, 10, 7);
+        CompareStencilOperator<MemorySpace>(A, B);
+    }
+
+    {
+        cusp::gallery::stencil_operator<float, MemorySpace> A;
+        cusp::csr_matrix<int, float, MemorySpace> B;
+        cusp::gallery::poisson27pt(A, 5, 17, 9);
+        cusp::gallery::poisson27pt(B, 5, 17, 9);
+        CompareStencilOperator<MemorySpace>(A, B);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestStencilOperatorPoisson);
+
+template <class MemorySpace>
+void TestStencilOperatorGeneral(void)
+{
+    typedef thrust::tuple<int,int>            StencilIndex;
+    typedef thrust::tuple<StencilIndex,float> StencilPoint;
+
+    // asymmetric stencil of radius 2
+    cusp::array1d<StencilPoint, cusp::host_memory> stencil;
+    stencil.push_back(StencilPoint(StencilIndex(-2, -1), 1));
+    stencil.push_back(StencilPoint(StencilIndex(-1,  0), 2));
+    stencil.push_back(StencilPoint(StencilIndex( 0,  0), 3));
+    stencil.push_back(StencilPoint(StencilIndex( 1,  0), 4));
+    stencil.push_back(StencilPoint(StencilIndex( 0,  2), 5));
+
+    cusp::gallery::stencil_operator<float, MemorySpace> A(stencil, StencilIndex(35, 11));
+    cusp::csr_matrix<int, float, MemorySpace> B;
+    cusp::gallery::generate_matrix_from_stencil(B, stencil, StencilIndex(35, 11));
+
+    ASSERT_EQUAL(A.num_points(), (size_t) 5);
+    CompareStencilOperator<MemorySpace>(A, B);
+
+    // one dimension
+    typedef thrust::tuple<int>                  StencilIndex1d;
+    typedef thrust::tuple<StencilIndex1d,float> StencilPoint1d;
+
+    cusp::array1d<StencilPoint1d, cusp::host_memory> stencil1d;
+    stencil1d.push_back(StencilPoint1d(StencilIndex1d(-1), 1));
+    stencil1d.push_back(StencilPoint1d(StencilIndex1d( 0), 2));
+    stencil1d.push_back(StencilPoint1d(StencilIndex1d( 2), 3));
+
+    cusp::gallery::stencil_operator<float, MemorySpace> C(stencil1d, StencilIndex1d(100));
+    cusp::csr_matrix<int, float, MemorySpace> D;
+    cusp::gallery::generate_matrix_from_stencil(D, stencil1d, StencilIndex1d(100));
+
+    CompareStencilOperator<MemorySpace>(C, D);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestStencilOperatorGeneral);
+
+template <class MemorySpace>
+void TestStencilOperatorConjugateGradient(void)
+{
+    cusp::gallery::stencil_operator<float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 20);
+
+    cusp::array1d<float, MemorySpace> x(A.num_rows, 0.0f);
+    cusp::array1d<float, MemorySpace> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 200, 1e-5);
+    cusp::krylov::cg(A, x, b, monitor);
+
+    ASSERT_EQUAL(monitor.converged(), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestStencilOperatorConjugateGradient);
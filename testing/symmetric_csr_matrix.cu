@@ -0,0 +1,178 @@
+#include <unittest/unittest.h>
+#include <cusp/symmetric_csr_matrix.h>
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+#include <cstdlib>
+
+// symmetric matrix with random off-diagonal entries and a dense last row
+template <typename Matrix>
+void random_symmetric_matrix(Matrix& matrix, size_t n)
+{
+    cusp::coo_matrix<int, float, cusp::host_memory> A(n, n, 0);
+
+    srand(13);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        A.row_indices.push_back(i);
+        A.column_indices.push_back(i);
+        A.values.push_back(float(i % 5) + 4);
+    }
+    for (size_t k = 0; k < 4 * n; k++)
+    {
+        const int i = rand() % (n - 1);
+        const int j = rand() % (n - 1);
+        if (i == j)
+            continue;
+        A.row_indices.push_back(i); A.column_indices.push_back(j); A.values.push_back(float(k % 7) - 3);
+        A.row_indices.push_back(j); A.column_indices.push_back(i); A.values.push_back(float(k % 7) - 3);
+    }
+    for (size_t j = 0; j + 1 < n; j++)
+    {
+        A.row_indices.push_back(n - 1); A.column_indices.push_back(j);     A.values.push_back(1);
+        A.row_indices.push_back(j);     A.column_indices.push_back(n - 1); A.values.push_back(1);
+    }
+    A.num_entries = A.values.size();
+    A.sort_by_row_and_column();
+
+    // sum duplicate entries
+    cusp::csr_matrix<int, float, cusp::host_memory> B(A);
+    cusp::array2d<float, cusp::host_memory> C(n, n, 0);
+    for (size_t i = 0; i < n; i++)
+        for (int jj = B.row_offsets[i]; jj < B.row_offsets[i + 1]; jj++)
+            C(i, B.column_indices[jj]) += B.values[jj];
+
+    matrix = C;
+}
+
+template <class Space>
+void TestSymmetricCsrMatrixBasicConstructor(void)
+{
+    cusp::symmetric_csr_matrix<int, float, Space> matrix(3, 3, 7, 5);
+
+    ASSERT_EQUAL(matrix.num_rows,              3);
+    ASSERT_EQUAL(matrix.num_cols,              3);
+    ASSERT_EQUAL(matrix.num_entries,           7);
+    ASSERT_EQUAL(matrix.num_stored_entries(),  5);
+    ASSERT_EQUAL(matrix.row_offsets.size(),    4);
+    ASSERT_EQUAL(matrix.column_indices.size(), 5);
+    ASSERT_EQUAL(matrix.values.size(),         5);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSymmetricCsrMatrixBasicConstructor);
+
+template <class Space>
+void TestSymmetricCsrMatrixConversion(void)
+{
+    // [ 4 -1  0  2]
+    // [-1  4 -1  0]
+    // [ 0 -1  4  0]
+    // [ 2  0  0  0]
+    cusp::array2d<float, cusp::host_memory> A(4, 4, 0);
+    A(0,0) =  4; A(0,1) = -1; A(0,3) =  2;
+    A(1,0) = -1; A(1,1) =  4; A(1,2) = -1;
+    A(2,1) = -1; A(2,2) =  4;
+    A(3,0) =  2;
+
+    cusp::symmetric_csr_matrix<int, float, Space> B(A);
+
+    ASSERT_EQUAL(B.num_entries,          9);
+    ASSERT_EQUAL(B.num_stored_entries(), 6);
+
+    cusp::symmetric_csr_matrix<int, float, cusp::host_memory> H(B);
+
+    ASSERT_EQUAL(H.row_offsets[0], 0);
+    ASSERT_EQUAL(H.row_offsets[1], 3);
+    ASSERT_EQUAL(H.row_offsets[2], 5);
+    ASSERT_EQUAL(H.row_offsets[3], 6);
+    ASSERT_EQUAL(H.row_offsets[4], 6);
+
+    ASSERT_EQUAL(H.column_indices[0], 0); ASSERT_EQUAL(H.values[0],  4);
+    ASSERT_EQUAL(H.column_indices[1], 1); ASSERT_EQUAL(H.values[1], -1);
+    ASSERT_EQUAL(H.column_indices[2], 3); ASSERT_EQUAL(H.values[2],  2);
+    ASSERT_EQUAL(H.column_indices[3], 1); ASSERT_EQUAL(H.values[3],  4);
+    ASSERT_EQUAL(H.column_indices[4], 2); ASSERT_EQUAL(H.values[4], -1);
+    ASSERT_EQUAL(H.column_indices[5], 2); ASSERT_EQUAL(H.values[5],  4);
+
+    // convert back through CSR and COO
+    cusp::csr_matrix<int, float, Space> C(B);
+    cusp::coo_matrix<int, float, Space> D(B);
+
+    ASSERT_EQUAL(C.num_entries, 9);
+    ASSERT_EQUAL(D.num_entries, 9);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> E(C);
+    cusp::coo_matrix<int, float, cusp::host_memory> F(D);
+    cusp::coo_matrix<int, float, cusp::host_memory> G(A);
+
+    ASSERT_EQUAL(E.column_indices == G.column_indices, true);
+    ASSERT_EQUAL(E.values         == G.values,         true);
+    ASSERT_EQUAL(F.row_indices    == G.row_indices,    true);
+    ASSERT_EQUAL(F.column_indices == G.column_indices, true);
+    ASSERT_EQUAL(F.values         == G.values,         true);
+
+    // non-symmetric values and structure, non-square shape
+    cusp::array2d<float, cusp::host_memory> I(A);
+    I(1,0) = -2;
+    ASSERT_THROWS(cusp::convert(I, B), cusp::format_conversion_exception);
+
+    cusp::array2d<float, cusp::host_memory> K(A);
+    K(3,0) = 0;
+    ASSERT_THROWS(cusp::convert(K, B), cusp::format_conversion_exception);
+
+    cusp::array2d<float, cusp::host_memory> M(3, 4, 1);
+    ASSERT_THROWS(cusp::convert(M, B), cusp::format_conversion_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSymmetricCsrMatrixConversion);
+
+template <class Space>
+void TestSymmetricCsrMatrixMultiply(void)
+{
+    for (size_t n = 0; n < 2; n++)
+    {
+        cusp::csr_matrix<int, float, cusp::host_memory> A;
+
+        if (n == 0)
+            cusp::gallery::poisson5pt(A, 50, 40);
+        else
+            random_symmetric_matrix(A, 500);
+
+        cusp::array1d<float, cusp::host_memory> x(A.num_cols);
+        for (size_t i = 0; i < x.size(); i++)
+            x[i] = float(i % 7) - 3;
+
+        cusp::array1d<float, cusp::host_memory> y(A.num_rows, 0);
+        cusp::multiply(A, x, y);
+
+        cusp::symmetric_csr_matrix<int, float, Space> B(A);
+
+        ASSERT_EQUAL(B.num_entries, A.num_entries);
+        ASSERT_EQUAL(2 * B.num_stored_entries(), A.num_entries + A.num_rows);
+
+        cusp::array1d<float, Space> d_x(x);
+        cusp::array1d<float, Space> d_y(A.num_rows, 10);
+        cusp::multiply(B, d_x, d_y);
+
+        cusp::array1d<float, cusp::host_memory> z(d_y);
+
+        ASSERT_ALMOST_EQUAL(z, y);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestSymmetricCsrMatrixMultiply);
+
+void TestSymmetricCsrMatrixRebind(void)
+{
+    typedef cusp::symmetric_csr_matrix<int, float, cusp::host_memory> HostMatrix;
+    typedef HostMatrix::rebind<cusp::device_memory>::type              DeviceMatrix;
+
+    HostMatrix   h_matrix(10, 10, 50, 30);
+    DeviceMatrix d_matrix(h_matrix);
+
+    ASSERT_EQUAL(h_matrix.num_entries,          d_matrix.num_entries);
+    ASSERT_EQUAL(h_matrix.num_stored_entries(), d_matrix.num_stored_entries());
+}
+DECLARE_UNITTEST(TestSymmetricCsrMatrixRebind);
+
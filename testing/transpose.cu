@@ -1,6 +1,7 @@
 #include <unittest/unittest.h>
 
 #include <cusp/transpose.h>
+#include <cusp/copy.h>
 
 #include <cusp/array2d.h>
 #include <cusp/coo_matrix.h>
@@ -9,6 +10,8 @@
 #include <cusp/ell_matrix.h>
 #include <cusp/hyb_matrix.h>
 
+#include <algorithm>
+
 template <typename MatrixType>
 void initialize_matrix(MatrixType& matrix)
 {
@@ -110,6 +113,65 @@ void TestTransposeArray2dVariablePitch(void)
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestTransposeArray2dVariablePitch);
 
+template <typename Matrix1, typename Matrix2>
+void TestTransposeArray2dTiles(const size_t pitch1, const size_t pitch2)
+{
+  // several partial tiles in both dimensions
+  const size_t num_rows = 70;
+  const size_t num_cols = 45;
+
+  cusp::array2d<float, cusp::host_memory> H(num_rows, num_cols);
+  for (size_t i = 0; i < num_rows; i++)
+    for (size_t j = 0; j < num_cols; j++)
+      H(i,j) = float(i * num_cols + j);
+
+  Matrix1 A; A.resize(num_rows, num_cols, std::max(pitch1, cusp::detail::minor_dimension(num_rows, num_cols, typename Matrix1::orientation())));
+  Matrix2 B; B.resize(num_cols, num_rows, std::max(pitch2, cusp::detail::minor_dimension(num_cols, num_rows, typename Matrix2::orientation())));
+  Matrix2 C; C.resize(num_rows, num_cols, std::max(pitch2, cusp::detail::minor_dimension(num_rows, num_cols, typename Matrix2::orientation())));
+
+  cusp::copy(H, A);
+  cusp::transpose(A, B);
+  cusp::copy(A, C);
+
+  cusp::array2d<float, cusp::host_memory> B_h(B);
+  cusp::array2d<float, cusp::host_memory> C_h(C);
+
+  ASSERT_EQUAL(B_h.num_rows, num_cols);
+  ASSERT_EQUAL(B_h.num_cols, num_rows);
+
+  bool transposed = true;
+  bool copied     = true;
+
+  for (size_t i = 0; i < num_rows; i++)
+    for (size_t j = 0; j < num_cols; j++)
+    {
+      transposed = transposed && B_h(j,i) == H(i,j);
+      copied     = copied     && C_h(i,j) == H(i,j);
+    }
+
+  ASSERT_EQUAL(transposed, true);
+  ASSERT_EQUAL(copied,     true);
+}
+
+template <class Space>
+void TestTransposeArray2dTiled(void)
+{
+  typedef typename cusp::array2d<float, Space, cusp::row_major>    RowMajor;
+  typedef typename cusp::array2d<float, Space, cusp::column_major> ColumnMajor;
+
+  // packed and padded pitches
+  const size_t pitches[] = {0, 96};
+
+  for (size_t n = 0; n < 2; n++)
+  {
+    TestTransposeArray2dTiles<RowMajor,    RowMajor   >(pitches[n], pitches[1 - n]);
+    TestTransposeArray2dTiles<ColumnMajor, ColumnMajor>(pitches[n], pitches[1 - n]);
+    TestTransposeArray2dTiles<RowMajor,    ColumnMajor>(pitches[n], pitches[n]);
+    TestTransposeArray2dTiles<ColumnMajor, RowMajor   >(pitches[n], pitches[n]);
+  }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestTransposeArray2dTiled);
+
 template <class Matrix>
 void TestTranspose(void)
 {
@@ -117,3 +179,44 @@ void TestTranspose(void)
 }
 DECLARE_MATRIX_UNITTEST(TestTranspose);
 
+
+// rows of A^T shorter and longer than the rows sorted by a single thread
+template <class Matrix>
+void TestTransposeLongRows(void)
+{
+    const int N = 100;
+
+    // column 0 of A is full, column 1 has every third entry and row i
+    // has a single other entry in column 2 + i % 7
+    cusp::coo_matrix<int, float, cusp::host_memory> A(N, 9, N + N / 3 + 1 + N);
+
+    size_t n = 0;
+    for (int i = 0; i < N; i++)
+    {
+        A.row_indices[n] = i; A.column_indices[n] = 0;         A.values[n] = float(i);         n++;
+        if (i % 3 == 0)
+        {
+            A.row_indices[n] = i; A.column_indices[n] = 1;     A.values[n] = float(2 * i);     n++;
+        }
+        A.row_indices[n] = i; A.column_indices[n] = 2 + i % 7;  A.values[n] = float(3 * i + 1); n++;
+    }
+
+    Matrix A_test(A);
+    Matrix At;
+    cusp::transpose(A_test, At);
+
+    ASSERT_EQUAL(At.num_rows,    (size_t) 9);
+    ASSERT_EQUAL(At.num_entries, A.num_entries);
+
+    cusp::coo_matrix<int, float, cusp::host_memory> result(At);
+    ASSERT_EQUAL(result.is_sorted_by_row_and_column(), true);
+
+    cusp::array2d<float, cusp::host_memory> dense(A);
+    cusp::array2d<float, cusp::host_memory> dense_transpose(result);
+
+    for (int i = 0; i < N; i++)
+        for (int j = 0; j < 9; j++)
+            ASSERT_EQUAL(dense_transpose(j, i), dense(i, j));
+}
+DECLARE_SPARSE_FORMAT_UNITTEST(TestTransposeLongRows,Coo,coo);
+DECLARE_SPARSE_FORMAT_UNITTEST(TestTransposeLongRows,Csr,csr);
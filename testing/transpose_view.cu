@@ -0,0 +1,119 @@
+#include <unittest/unittest.h>
+
+#include <cusp/transpose_view.h>
+#include <cusp/transpose.h>
+#include <cusp/multiply.h>
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/gallery/poisson.h>
+#include <cusp/gallery/random.h>
+#include <cusp/krylov/bicg.h>
+
+template <class Space>
+void TestTransposeViewMultiply(void)
+{
+    cusp::csr_matrix<int, float, cusp::host_memory> A;
+    cusp::gallery::random(60, 40, 300, A);
+
+    cusp::csr_matrix<int, float, cusp::host_memory> At;
+    cusp::transpose(A, At);
+
+    cusp::array1d<float, cusp::host_memory> x(A.num_rows);
+    cusp::array1d<float, cusp::host_memory> z(A.num_cols);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = float(i % 7) - 3;
+    for (size_t i = 0; i < z.size(); i++)
+        z[i] = float(i % 5) - 2;
+
+    // reference results
+    cusp::array1d<float, cusp::host_memory> y(A.num_cols, 0);
+    cusp::array1d<float, cusp::host_memory> w(A.num_rows, 0);
+    cusp::multiply(At, x, y);
+    cusp::multiply(A, z, w);
+
+    cusp::csr_matrix<int, float, Space> B(A);
+    cusp::hyb_matrix<int, float, Space> C(A);
+
+    cusp::transpose_matrix_view< cusp::csr_matrix<int, float, Space> > Bt(B);
+    cusp::transpose_matrix_view< cusp::hyb_matrix<int, float, Space> > Ct = cusp::transpose_view(C);
+
+    ASSERT_EQUAL(Bt.num_rows,    A.num_cols);
+    ASSERT_EQUAL(Bt.num_cols,    A.num_rows);
+    ASSERT_EQUAL(Bt.num_entries, A.num_entries);
+
+    cusp::array1d<float, Space> d_x(x);
+    cusp::array1d<float, Space> d_z(z);
+
+    {
+        cusp::array1d<float, Space> d_y(A.num_cols, 10);
+        cusp::multiply(Bt, d_x, d_y);
+        cusp::array1d<float, cusp::host_memory> h_y(d_y);
+        ASSERT_ALMOST_EQUAL(h_y, y);
+    }
+    {
+        cusp::array1d<float, Space> d_y(A.num_cols, 10);
+        cusp::multiply(Ct, d_x, d_y);
+        cusp::array1d<float, cusp::host_memory> h_y(d_y);
+        ASSERT_ALMOST_EQUAL(h_y, y);
+    }
+    {
+        // the transpose of the view is the matrix
+        cusp::array1d<float, Space> d_w(A.num_rows, 10);
+        cusp::multiply_transpose(Bt, d_z, d_w);
+        cusp::array1d<float, cusp::host_memory> h_w(d_w);
+        ASSERT_ALMOST_EQUAL(h_w, w);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestTransposeViewMultiply);
+
+template <class Space>
+void TestTransposeViewTranspose(void)
+{
+    cusp::array2d<float, cusp::host_memory> A(3, 2);
+    A(0,0) = 10; A(0,1) =  0;
+    A(1,0) =  0; A(1,1) = 20;
+    A(2,0) = 30; A(2,1) = 40;
+
+    cusp::csr_matrix<int, float, Space> B(A);
+    cusp::transpose_matrix_view< cusp::csr_matrix<int, float, Space> > Bt(B);
+
+    // transposing the view copies the matrix
+    cusp::csr_matrix<int, float, Space> C;
+    cusp::transpose(Bt, C);
+
+    cusp::array2d<float, cusp::host_memory> D(C);
+    ASSERT_EQUAL(D == A, true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestTransposeViewTranspose);
+
+template <class Space>
+void TestBiConjugateGradientTransposeView(void)
+{
+    // nonsymmetric D * A with positive diagonal D
+    cusp::csr_matrix<int, float, cusp::host_memory> H;
+    cusp::gallery::poisson5pt(H, 10, 10);
+
+    for (size_t i = 0; i < H.num_rows; i++)
+        for (int jj = H.row_offsets[i]; jj < H.row_offsets[i + 1]; jj++)
+            H.values[jj] *= 1.0f + 0.5f * (i % 3);
+
+    cusp::csr_matrix<int, float, Space> A(H);
+    cusp::transpose_matrix_view< cusp::csr_matrix<int, float, Space> > At(A);
+
+    cusp::array1d<float, Space> x(A.num_rows, 0.0f);
+    cusp::array1d<float, Space> b(A.num_rows, 1.0f);
+
+    cusp::default_monitor<float> monitor(b, 100, 1e-4);
+    cusp::identity_operator<float, Space> M(A.num_rows, A.num_rows);
+
+    cusp::krylov::bicg(A, At, x, b, monitor, M, M);
+
+    // check residual norm
+    cusp::array1d<float, Space> residual(A.num_rows, 0.0f);
+    cusp::multiply(A, x, residual);
+    cusp::blas::axpby(residual, b, residual, -1.0f, 1.0f);
+
+    ASSERT_EQUAL(cusp::blas::nrm2(residual) < 1e-3 * cusp::blas::nrm2(b), true);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestBiConjugateGradientTransposeView);
@@ -0,0 +1,169 @@
+#include <unittest/unittest.h>
+
+#include <cusp/triangular_solve.h>
+
+#include <cusp/array2d.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+template <class MemorySpace>
+void TestTriangularSolveLower(void)
+{
+    cusp::array2d<float, cusp::host_memory> D(4,4,0.0f);
+    D(0,0) = 2.0f;
+    D(1,0) = 1.0f; D(1,1) = 4.0f;
+    D(2,2) = 1.0f;
+    D(3,0) = 3.0f; D(3,2) = -1.0f; D(3,3) = 5.0f;
+
+    cusp::csr_matrix<int, float, MemorySpace> L(D);
+
+    cusp::triangular_solve_plan<int, MemorySpace> plan;
+    cusp::triangular_solve_analyze(L, plan, true);
+
+    // rows 0 and 2 do not depend on other rows
+    ASSERT_EQUAL(plan.num_levels(), (size_t) 2);
+    ASSERT_EQUAL(plan.max_level_size, (size_t) 2);
+
+    cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(4);
+    cusp::array1d<float, MemorySpace> b(4);
+    cusp::array1d<float, MemorySpace> y(4);
+
+    cusp::multiply(L, x, b);
+    cusp::triangular_solve(L, plan, b, y);
+
+    ASSERT_ALMOST_EQUAL(y, x);
+
+    // in place
+    cusp::triangular_solve(L, plan, b, b);
+
+    ASSERT_ALMOST_EQUAL(b, x);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestTriangularSolveLower);
+
+template <class MemorySpace>
+void TestTriangularSolveTriangleOfGeneralMatrix(void)
+{
+    // only the selected triangle of A is used
+    cusp::array2d<float, cusp::host_memory> D(3,3);
+    D(0,0) = 2.0f; D(0,1) = 7.0f; D(0,2) = 8.0f;
+    D(1,0) = 1.0f; D(1,1) = 4.0f; D(1,2) = 9.0f;
+    D(2,0) = 3.0f; D(2,1) = 5.0f; D(2,2) = 6.0f;
+
+    cusp::csr_matrix<int, float, MemorySpace> A(D);
+
+    cusp::array1d<float, MemorySpace> b(3, 1.0f);
+    cusp::array1d<float, MemorySpace> x(3);
+
+    // upper, unit diagonal: x2 = 1, x1 = 1 - 9, x0 = 1 - 7 x1 - 8 x2
+    {
+        cusp::array1d<float, cusp::host_memory> expected(3);
+        expected[2] = 1.0f;
+        expected[1] = -8.0f;
+        expected[0] = 1.0f + 56.0f - 8.0f;
+
+        cusp::triangular_solve(A, b, x, false, true);
+
+        ASSERT_ALMOST_EQUAL(x, expected);
+    }
+
+    // lower: x0 = 1/2, x1 = (1 - x0) / 4, x2 = (1 - 3 x0 - 5 x1) / 6
+    {
+        cusp::array1d<float, cusp::host_memory> expected(3);
+        expected[0] = 0.5f;
+        expected[1] = 0.125f;
+        expected[2] = (1.0f - 1.5f - 0.625f) / 6.0f;
+
+        cusp::triangular_solve(A, b, x, true, false);
+
+        ASSERT_ALMOST_EQUAL(x, expected);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestTriangularSolveTriangleOfGeneralMatrix);
+
+template <class MemorySpace>
+void TestTriangularSolvePoisson(void)
+{
+    cusp::csr_matrix<int, float, MemorySpace> A;
+    cusp::gallery::poisson5pt(A, 20, 30);
+
+    cusp::array1d<float, MemorySpace> x = unittest::random_samples<float>(A.num_rows);
+    cusp::array1d<float, MemorySpace> y(A.num_rows);
+    cusp::array1d<float, MemorySpace> b(A.num_rows);
+
+    for (int lower = 0; lower < 2; lower++)
+    {
+        cusp::triangular_solve_plan<int, MemorySpace> plan;
+        cusp::triangular_solve_analyze(A, plan, lower == 1);
+
+        // one level per anti-diagonal of the grid
+        ASSERT_EQUAL(plan.num_levels(), (size_t) (20 + 30 - 1));
+        ASSERT_EQUAL(plan.max_level_size, (size_t) 20);
+
+        // b <- T x for the triangle T of A
+        cusp::array2d<float, cusp::host_memory> D(A);
+        for (size_t i = 0; i < D.num_rows; i++)
+            for (size_t j = 0; j < D.num_cols; j++)
+                if (lower ? j > i : j < i)
+                    D(i,j) = 0.0f;
+
+        cusp::csr_matrix<int, float, MemorySpace> T(D);
+        cusp::multiply(T, x, b);
+
+        cusp::triangular_solve(A, plan, b, y);
+
+        ASSERT_ALMOST_EQUAL(y, x);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestTriangularSolvePoisson);
+
+void TestTriangularSolveAlgorithm(void)
+{
+    // a chain of dependencies is solved by a single thread
+    cusp::csr_matrix<int, float, cusp::device_memory> A;
+    cusp::gallery::poisson5pt(A, 1, 100);
+
+    cusp::triangular_solve_plan<int, cusp::device_memory> chain;
+    cusp::triangular_solve_analyze(A, chain, true);
+
+    ASSERT_EQUAL(chain.num_levels(), (size_t) 100);
+    ASSERT_EQUAL(chain.algorithm, chain.sequential);
+
+    cusp::gallery::poisson5pt(A, 100, 100);
+
+    cusp::triangular_solve_plan<int, cusp::device_memory> grid;
+    cusp::triangular_solve_analyze(A, grid, true);
+
+    ASSERT_EQUAL(grid.algorithm, grid.level_scheduled);
+}
+DECLARE_UNITTEST(TestTriangularSolveAlgorithm);
+
+void TestTriangularSolveErrors(void)
+{
+    cusp::triangular_solve_plan<int, cusp::host_memory> plan;
+
+    // rectangular matrix
+    {
+        cusp::csr_matrix<int, float, cusp::host_memory> A(2, 3, 0);
+
+        ASSERT_THROWS(cusp::triangular_solve_analyze(A, plan, true), cusp::invalid_input_exception);
+    }
+
+    // missing diagonal entry, which a unit triangle does not need
+    {
+        cusp::array2d<float, cusp::host_memory> D(2,2,1.0f);
+        D(1,1) = 0.0f;
+        cusp::csr_matrix<int, float, cusp::host_memory> A(D);
+
+        ASSERT_THROWS(cusp::triangular_solve_analyze(A, plan, true), cusp::invalid_input_exception);
+
+        cusp::triangular_solve_analyze(A, plan, true, true);
+
+        // array dimensions
+        cusp::array1d<float, cusp::host_memory> b(3, 1.0f);
+        cusp::array1d<float, cusp::host_memory> x(3);
+
+        ASSERT_THROWS(cusp::triangular_solve(A, plan, b, x), cusp::invalid_input_exception);
+    }
+}
+DECLARE_UNITTEST(TestTriangularSolveErrors);
@@ -0,0 +1,68 @@
+#include <unittest/unittest.h>
+
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/dia_matrix.h>
+#include <cusp/ell_matrix.h>
+#include <cusp/hyb_matrix.h>
+#include <cusp/update_values.h>
+
+template <typename SourceMatrix, typename DestinationMatrix>
+void VerifyUpdateValues(void)
+{
+    typedef typename SourceMatrix::memory_space MemorySpace;
+
+    // a full first row and the diagonal, so that HYB has an ELL and a COO part
+    cusp::array2d<float, cusp::host_memory> D(6, 6, 0.0f);
+    for (int j = 0; j < 6; j++) D(0, j) = 1.0f;
+    for (int i = 0; i < 6; i++) D(i, i) = 2.0f;
+    D(3, 1) = 3.0f;
+
+    SourceMatrix A(D);
+
+    DestinationMatrix B;
+    cusp::value_permutation<int, MemorySpace> permutation;
+    cusp::convert(A, B, permutation);
+
+    ASSERT_EQUAL(permutation.num_source_values, A.num_entries);
+
+    {
+        cusp::array2d<float, cusp::host_memory> result(B);
+        ASSERT_EQUAL(result.values, D.values);
+    }
+
+    // new values on the same pattern
+    cusp::array1d<float, cusp::host_memory> values(A.num_entries);
+    for (size_t n = 0; n < A.num_entries; n++)
+        values[n] = float(n + 1);
+    A.values = values;
+
+    cusp::update_values(B, A.values, permutation);
+
+    DestinationMatrix C;
+    cusp::convert(A, C);
+
+    cusp::array2d<float, cusp::host_memory> result(B);
+    cusp::array2d<float, cusp::host_memory> expected(C);
+    ASSERT_EQUAL(result.values, expected.values);
+
+    // sizes must match the recorded map
+    cusp::array1d<float, MemorySpace> too_short(A.num_entries - 1);
+    ASSERT_THROWS(cusp::update_values(B, too_short, permutation), cusp::invalid_input_exception);
+}
+
+template <class MemorySpace>
+void TestUpdateValues(void)
+{
+    typedef cusp::csr_matrix<int, float, MemorySpace> CSR;
+    typedef cusp::coo_matrix<int, float, MemorySpace> COO;
+
+    VerifyUpdateValues< CSR, cusp::coo_matrix<int, float, MemorySpace> >();
+    VerifyUpdateValues< CSR, cusp::dia_matrix<int, float, MemorySpace> >();
+    VerifyUpdateValues< CSR, cusp::ell_matrix<int, float, MemorySpace> >();
+    VerifyUpdateValues< CSR, cusp::hyb_matrix<int, float, MemorySpace> >();
+    VerifyUpdateValues< COO, cusp::csr_matrix<int, float, MemorySpace> >();
+    VerifyUpdateValues< COO, cusp::hyb_matrix<int, float, MemorySpace> >();
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestUpdateValues);
@@ -0,0 +1,75 @@
+#include <unittest/unittest.h>
+
+#include <cusp/array1d.h>
+#include <cusp/blas.h>
+#include <cusp/vector_expression.h>
+
+template <class MemorySpace>
+void TestVectorExpressionAssign(void)
+{
+    typedef typename cusp::array1d<float, MemorySpace>       Array;
+    typedef typename cusp::array1d<float, MemorySpace>::view View;
+
+    Array x(4);
+    Array y(4);
+    Array w(4);
+    Array z(4);
+
+    x[0] =  7.0f;   y[0] =  0.0f;   w[0] =  1.0f;
+    x[1] =  5.0f;   y[1] = -2.0f;   w[1] =  2.0f;
+    x[2] =  4.0f;   y[2] =  0.0f;   w[2] = -1.0f;
+    x[3] = -3.0f;   y[3] =  5.0f;   w[3] =  0.0f;
+
+    // z = 2 * x + 3 * y - w
+    cusp::blas::assign(z, 2.0f * x + y * 3.0f - w);
+
+    ASSERT_EQUAL(z[0],  13.0f);
+    ASSERT_EQUAL(z[1],   2.0f);
+    ASSERT_EQUAL(z[2],   9.0f);
+    ASSERT_EQUAL(z[3],   9.0f);
+
+    // views and unary minus, with the output in the expression
+    cusp::blas::assign(View(z), -View(z) + x);
+
+    ASSERT_EQUAL(z[0],  -6.0f);
+    ASSERT_EQUAL(z[1],   3.0f);
+    ASSERT_EQUAL(z[2],  -5.0f);
+    ASSERT_EQUAL(z[3], -12.0f);
+
+    // expressions in reductions
+    ASSERT_EQUAL(cusp::blas::dotc(x - y, w), 17.0f);
+    ASSERT_EQUAL(cusp::blas::nrmmax(x - 2.0f * y), 13.0f);
+
+    // test size checking
+    Array v(3);
+    ASSERT_THROWS(cusp::blas::assign(v, x + y), cusp::invalid_input_exception);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestVectorExpressionAssign);
+
+template <class MemorySpace>
+void TestVectorExpressionAssignDotc(void)
+{
+    typedef typename cusp::array1d<float, MemorySpace> Array;
+
+    Array r(4);
+    Array p(4);
+    Array w(4);
+
+    r[0] =  1.0f;   p[0] =  1.0f;   w[0] =  1.0f;
+    r[1] =  2.0f;   p[1] =  0.0f;   w[1] =  0.0f;
+    r[2] =  3.0f;   p[2] = -1.0f;   w[2] =  2.0f;
+    r[3] =  4.0f;   p[3] =  2.0f;   w[3] = -1.0f;
+
+    // r = r - 2 * p, returns <r,r>
+    ASSERT_EQUAL(cusp::blas::assign_dotc(r, r - 2.0f * p), 30.0f);
+
+    ASSERT_EQUAL(r[0], -1.0f);
+    ASSERT_EQUAL(r[1],  2.0f);
+    ASSERT_EQUAL(r[2],  5.0f);
+    ASSERT_EQUAL(r[3],  0.0f);
+
+    // r = r + p, returns <w,r>
+    ASSERT_EQUAL(cusp::blas::assign_dotc(r, r + p, w), 6.0f);
+    ASSERT_EQUAL(cusp::blas::dotc(w, r), 6.0f);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestVectorExpressionAssignDotc);
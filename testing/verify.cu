@@ -105,6 +105,11 @@ void TestIsValidMatrixDia(void)
         M.values.num_rows = 2;
         ASSERT_EQUAL(cusp::is_valid_matrix(M), false);
     }
+    {
+        cusp::dia_matrix<int, float, MemorySpace> M(A);
+        M.diagonal_offsets.resize(M.diagonal_offsets.size() + 1);
+        ASSERT_EQUAL(cusp::is_valid_matrix(M), false);
+    }
 }
 DECLARE_HOST_DEVICE_UNITTEST(TestIsValidMatrixDia);
 
@@ -234,6 +239,75 @@ void TestIsValidMatrixArray2d(void)
 DECLARE_HOST_DEVICE_UNITTEST(TestIsValidMatrixArray2d);
 
 
+template <typename MemorySpace>
+void TestValidateMatrix(void)
+{
+    cusp::array2d<float, MemorySpace> A(3,3);
+    A(0,0) = 0;  A(0,1) = 1;  A(0,2) = 0;
+    A(1,0) = 1;  A(1,1) = 0;  A(1,2) = 1;
+    A(2,0) = 0;  A(2,1) = 1;  A(2,2) = 0;
+
+    // the entries are (0,1), (1,0), (1,2) and (2,1)
+    {
+        cusp::coo_matrix<int, float, MemorySpace> M(A);
+        cusp::matrix_validation report = cusp::validate_matrix(M);
+        ASSERT_EQUAL(report.valid, true);
+        ASSERT_EQUAL(report.message.empty(), true);
+    }
+
+    // the first violation is reported with the number of entries that fail it
+    {
+        cusp::coo_matrix<int, float, MemorySpace> M(A);
+        M.column_indices[1] = 3;
+        M.column_indices[3] = -1;
+        cusp::matrix_validation report = cusp::validate_matrix(M);
+        ASSERT_EQUAL(report.valid, false);
+        ASSERT_EQUAL(report.num_violations, (size_t) 2);
+        ASSERT_EQUAL(report.first_violation, (size_t) 1);
+    }
+    {
+        cusp::coo_matrix<int, float, MemorySpace> M(A);
+        M.row_indices[1] = 2;
+        M.column_indices[3] = 5;
+        cusp::matrix_validation report = cusp::validate_matrix(M);
+        ASSERT_EQUAL(report.valid, false);
+        ASSERT_EQUAL(report.message.find("non-decreasing") != std::string::npos, true);
+        ASSERT_EQUAL(report.num_violations, (size_t) 1);
+        ASSERT_EQUAL(report.first_violation, (size_t) 1);
+    }
+
+    // the last row offset is checked by the same reduction
+    {
+        cusp::csr_matrix<int, float, MemorySpace> M(A);
+        M.row_offsets[3] = 3;
+        cusp::matrix_validation report = cusp::validate_matrix(M);
+        ASSERT_EQUAL(report.valid, false);
+        ASSERT_EQUAL(report.first_violation, (size_t) 3);
+    }
+
+    // entries of the COO part of a HYB matrix follow those of the ELL part
+    {
+        cusp::hyb_matrix<int, float, MemorySpace> M(A);
+        ASSERT_EQUAL(cusp::validate_matrix(M).valid, true);
+    }
+    {
+        cusp::hyb_matrix<int, float, MemorySpace> M(3, 3, 3, 1, 1);
+        M.ell.column_indices(0,0) = 1;  M.ell.values(0,0) = 1;
+        M.ell.column_indices(1,0) = 0;  M.ell.values(1,0) = 1;
+        M.ell.column_indices(2,0) = 1;  M.ell.values(2,0) = 1;
+        M.coo.row_indices[0] = 1;  M.coo.column_indices[0] = 2;  M.coo.values[0] = 1;
+        ASSERT_EQUAL(cusp::validate_matrix(M).valid, true);
+
+        M.coo.column_indices[0] = 3;
+        cusp::matrix_validation report = cusp::validate_matrix(M);
+        ASSERT_EQUAL(report.valid, false);
+        ASSERT_EQUAL(report.message.find("COO part") != std::string::npos, true);
+        ASSERT_EQUAL(report.first_violation, (size_t) 0);
+    }
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestValidateMatrix);
+
+
 template <typename MatrixType>
 void TestAssertIsValidMatrix(void)
 {
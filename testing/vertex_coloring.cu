@@ -0,0 +1,138 @@
+#include <unittest/unittest.h>
+
+#include <cusp/graph/vertex_coloring.h>
+
+#include <cusp/array2d.h>
+#include <cusp/coo_matrix.h>
+#include <cusp/csr_matrix.h>
+#include <cusp/multiply.h>
+#include <cusp/gallery/poisson.h>
+
+// check whether no two adjacent vertices have the same color
+template <typename MatrixType, typename ArrayType>
+bool is_valid_coloring(const MatrixType& A, const ArrayType& colors, const size_t num_colors)
+{
+    typedef typename MatrixType::index_type IndexType;
+    typedef typename MatrixType::value_type ValueType;
+
+    cusp::csr_matrix<IndexType,ValueType,cusp::host_memory> csr(A);
+    cusp::array1d<int,cusp::host_memory> c(colors);
+
+    for (size_t i = 0; i < csr.num_rows; i++)
+    {
+        if (c[i] < 0 || size_t(c[i]) >= num_colors)
+        {
+            std::cout << "Node " << i << " has an invalid color" << std::endl;
+            return false;
+        }
+
+        for(IndexType jj = csr.row_offsets[i]; jj < csr.row_offsets[i + 1]; jj++)
+        {
+            size_t j = csr.column_indices[jj];
+
+            if (i != j && c[i] == c[j])
+            {
+                std::cout << "Node " << i << " has the color of node " << j << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template <typename TestMatrix, typename ExampleMatrix>
+void _TestVertexColoring(const ExampleMatrix& example_matrix)
+{
+    typedef typename TestMatrix::memory_space MemorySpace;
+
+    TestMatrix test_matrix(example_matrix);
+
+    cusp::array1d<int, MemorySpace> colors;
+
+    {
+        // distance-1 coloring
+        size_t num_colors = cusp::graph::vertex_coloring(test_matrix, colors);
+
+        ASSERT_EQUAL(is_valid_coloring(test_matrix, colors, num_colors), true);
+    }
+
+    {
+        // distance-2 coloring
+        size_t num_colors = cusp::graph::vertex_coloring(test_matrix, colors, 2);
+
+        cusp::coo_matrix<int,float,MemorySpace> A(example_matrix);
+        cusp::coo_matrix<int,float,MemorySpace> A2;
+        cusp::multiply(A, A, A2);
+
+        ASSERT_EQUAL(is_valid_coloring(A2, colors, num_colors), true);
+    }
+}
+
+template <typename TestMatrix>
+void TestVertexColoring(void)
+{
+    // linear graph
+    cusp::array2d<float,cusp::host_memory> A(4,4);
+    A(0,0) = 1; A(0,1) = 1; A(0,2) = 0; A(0,3) = 0;
+    A(1,0) = 1; A(1,1) = 1; A(1,2) = 1; A(1,3) = 0;
+    A(2,0) = 0; A(2,1) = 1; A(2,2) = 1; A(2,3) = 1;
+    A(3,0) = 0; A(3,1) = 0; A(3,2) = 1; A(3,3) = 1;
+
+    // complete graph
+    cusp::array2d<float,cusp::host_memory> B(6,6,1);
+
+    // empty graph
+    cusp::array2d<float,cusp::host_memory> C(6,6,0);
+
+    cusp::coo_matrix<int,float,cusp::host_memory> D;
+    cusp::gallery::poisson5pt(D, 13, 17);
+    thrust::fill(D.values.begin(), D.values.end(), 1.0f);
+
+    cusp::coo_matrix<int,float,cusp::host_memory> E;
+    cusp::gallery::poisson5pt(E, 105, 107);
+    thrust::fill(E.values.begin(), E.values.end(), 1.0f);
+
+    _TestVertexColoring<TestMatrix>(A);
+    _TestVertexColoring<TestMatrix>(B);
+    _TestVertexColoring<TestMatrix>(C);
+    _TestVertexColoring<TestMatrix>(D);
+    _TestVertexColoring<TestMatrix>(E);
+
+    // the complete graph takes one color per vertex, the empty graph one
+    TestMatrix complete(B);
+    TestMatrix empty(C);
+    cusp::array1d<int, typename TestMatrix::memory_space> colors;
+
+    ASSERT_EQUAL(cusp::graph::vertex_coloring(complete, colors), (size_t) 6);
+    ASSERT_EQUAL(cusp::graph::vertex_coloring(empty,    colors), (size_t) 1);
+}
+DECLARE_SPARSE_MATRIX_UNITTEST(TestVertexColoring);
+
+template <typename MemorySpace>
+void TestColoringPermutation(void)
+{
+    cusp::array1d<int, MemorySpace> colors(7);
+    colors[0] = 2; colors[1] = 0; colors[2] = 1; colors[3] = 0;
+    colors[4] = 2; colors[5] = 0; colors[6] = 1;
+
+    cusp::array1d<int, MemorySpace> permutation;
+    cusp::array1d<int, MemorySpace> color_offsets;
+    cusp::graph::coloring_permutation(colors, permutation, color_offsets);
+
+    ASSERT_EQUAL(permutation.size(), (size_t) 7);
+    ASSERT_EQUAL(permutation[0], 1);
+    ASSERT_EQUAL(permutation[1], 3);
+    ASSERT_EQUAL(permutation[2], 5);
+    ASSERT_EQUAL(permutation[3], 2);
+    ASSERT_EQUAL(permutation[4], 6);
+    ASSERT_EQUAL(permutation[5], 0);
+    ASSERT_EQUAL(permutation[6], 4);
+
+    ASSERT_EQUAL(color_offsets.size(), (size_t) 4);
+    ASSERT_EQUAL(color_offsets[0], 0);
+    ASSERT_EQUAL(color_offsets[1], 3);
+    ASSERT_EQUAL(color_offsets[2], 5);
+    ASSERT_EQUAL(color_offsets[3], 7);
+}
+DECLARE_HOST_DEVICE_UNITTEST(TestColoringPermutation);